@@ -24,7 +24,7 @@ DROP TABLE IF EXISTS `character_db_version`;
 /*!40101 SET @saved_cs_client     = @@character_set_client */;
 /*!40101 SET character_set_client = utf8 */;
 CREATE TABLE `character_db_version` (
-  `required_19002_02_character_whispers` bit(1) DEFAULT NULL
+  `required_19015_01_characters_instance_reserve` bit(1) DEFAULT NULL
 ) ENGINE=MyISAM DEFAULT CHARSET=utf8 ROW_FORMAT=FIXED COMMENT='Last applied sql update to DB';
 /*!40101 SET character_set_client = @saved_cs_client */;
 
@@ -1073,6 +1073,29 @@ LOCK TABLES `instance` WRITE;
 /*!40000 ALTER TABLE `instance` ENABLE KEYS */;
 UNLOCK TABLES;
 
+--
+-- Table structure for table `instance_reserve`
+--
+
+DROP TABLE IF EXISTS `instance_reserve`;
+/*!40101 SET @saved_cs_client     = @@character_set_client */;
+/*!40101 SET character_set_client = utf8 */;
+CREATE TABLE `instance_reserve` (
+  `next_id` int(11) unsigned NOT NULL DEFAULT '1' COMMENT 'first instance id not reserved by a world server yet'
+) ENGINE=InnoDB DEFAULT CHARSET=utf8;
+/*!40101 SET character_set_client = @saved_cs_client */;
+
+--
+-- Dumping data for table `instance_reserve`
+--
+
+LOCK TABLES `instance_reserve` WRITE;
+/*!40000 ALTER TABLE `instance_reserve` DISABLE KEYS */;
+INSERT INTO `instance_reserve` VALUES
+(1);
+/*!40000 ALTER TABLE `instance_reserve` ENABLE KEYS */;
+UNLOCK TABLES;
+
 --
 -- Table structure for table `instance_reset`
 --
@@ -25,7 +25,7 @@ DROP TABLE IF EXISTS `db_version`;
 CREATE TABLE `db_version` (
   `version` varchar(120) NOT NULL DEFAULT '',
   `creature_ai_version` varchar(120) DEFAULT NULL,
-  `required_19003_02_mangos_command` bit(1) DEFAULT NULL,
+  `required_19016_01_mangos_command` bit(1) DEFAULT NULL,
   PRIMARY KEY (`version`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8 ROW_FORMAT=FIXED COMMENT='Used DB version notes';
 /*!40101 SET character_set_client = @saved_cs_client */;
@@ -388,14 +388,20 @@ INSERT INTO `command` VALUES
 ('debug bg',3,'Syntax: .debug bg\r\n\r\nToggle debug mode for battlegrounds. In debug mode GM can start battleground with single player.'),
 ('debug getitemvalue',3,'Syntax: .debug getitemvalue #itemguid #field [int|hex|bit|float]\r\n\r\nGet the field #field of the item #itemguid in your inventroy.\r\n\r\nUse type arg for set output format: int (decimal number), hex (hex value), bit (bitstring), float. By default use integer output.'),
 ('debug getvalue',3,'Syntax: .debug getvalue #field [int|hex|bit|float]\r\n\r\nGet the field #field of the selected target. If no target is selected, get the content of your field.\r\n\r\nUse type arg for set output format: int (decimal number), hex (hex value), bit (bitstring), float. By default use integer output.'),
+('debug memory',3,'Syntax: .debug memory [csv]\r\n\r\nShow the live memory and allocations counted for the creatures, game objects, players, auras, packets, update data, query results, SQL storages, terrain, vmap and mmap data with the allocation rates since the last use of the command, and the resident memory of the process. With csv the counters are shown as comma separated lines.'),
 ('debug moditemvalue',3,'Syntax: .debug moditemvalue #guid #field [int|float| &= | |= | &=~ ] #value\r\n\r\nModify the field #field of the item #itemguid in your inventroy by value #value. \r\n\r\nUse type arg for set mode of modification: int (normal add/subtract #value as decimal number), float (add/subtract #value as float number), &= (bit and, set to 0 all bits in value if it not set to 1 in #value as hex number), |= (bit or, set to 1 all bits in value if it set to 1 in #value as hex number), &=~ (bit and not, set to 0 all bits in value if it set to 1 in #value as hex number). By default expect integer add/subtract.'),
 ('debug modvalue',3,'Syntax: .debug modvalue #field [int|float| &= | |= | &=~ ] #value\r\n\r\nModify the field #field of the selected target by value #value. If no target is selected, set the content of your field.\r\n\r\nUse type arg for set mode of modification: int (normal add/subtract #value as decimal number), float (add/subtract #value as float number), &= (bit and, set to 0 all bits in value if it not set to 1 in #value as hex number), |= (bit or, set to 1 all bits in value if it set to 1 in #value as hex number), &=~ (bit and not, set to 0 all bits in value if it set to 1 in #value as hex number). By default expect integer add/subtract.'),
+('debug netstats',3,'Syntax: .debug netstats [csv|reset]\r\n\r\nShow sent packets and bytes of the ten largest opcodes, the update packets before and after compression and the ten most changed update fields since the last reset or NetStats.DumpInterval dump. Field changes are sampled in 1 of NetStats.FieldSampleRate values blocks. With csv all counters are shown as comma separated lines, reset sets them to zero. Needs NetStats.Enable.'),
+('debug opcodestats',3,'Syntax: .debug opcodestats [csv|sessions|reset]\r\n\r\nShow the ten opcodes of the most handler time since the last reset with their calls per second, calls in map updates, maximum and 99th percentile handler time and received bytes. With csv all opcodes are shown as comma separated lines, sessions shows the sessions of the most handler time in one second, reset sets the counters to zero. Needs OpcodeStats.Enable.'),
 ('debug play cinematic',1,'Syntax: .debug play cinematic #cinematicid\r\n\r\nPlay cinematic #cinematicid for you. You stay at place while your mind fly.'),
 ('debug play sound',1,'Syntax: .debug play sound #soundid\r\n\r\nPlay sound with #soundid.\r\nSound will be play only for you. Other players do not hear this.'),
+('debug profile',3,'Syntax: .debug profile #seconds\r\n\r\nRecord the timed scopes of the world and map updates, opcode handlers and creature and player updates for #seconds, at most 60, and write them to a Chrome trace event file in LogsDir, which can be opened in chrome://tracing or Perfetto.'),
+('debug scripthooks',3,'Syntax: .debug scripthooks [reset]\r\n\r\nShow the ten most expensive script names since the last reset with the calls and microseconds of each script library hook they implement. Hooks a script does not implement are not called. With reset the counters are set to zero. Needs ScriptHookStats.Enable.'),
 ('debug setitemvalue',3,'Syntax: .debug setitemvalue #guid #field [int|hex|bit|float] #value\r\n\r\nSet the field #field of the item #itemguid in your inventroy to value #value.\r\n\r\nUse type arg for set input format: int (decimal number), hex (hex value), bit (bitstring), float. By default expect integer input format.'),
 ('debug setvalue',3,'Syntax: .debug setvalue #field [int|hex|bit|float] #value\r\n\r\nSet the field #field of the selected target to value #value. If no target is selected, set the content of your field.\r\n\r\nUse type arg for set input format: int (decimal number), hex (hex value), bit (bitstring), float. By default expect integer input format.'),
 ('debug spellcoefs',3,'Syntax: .debug spellcoefs #spellid\r\n\r\nShow default calculated and DB stored coefficients for direct/dot heal/damage.'),
 ('debug spellmods',3,'Syntax: .debug spellmods (flat|pct) #spellMaskBitIndex #spellModOp #value\r\n\r\nSet at client side spellmod affect for spell that have bit set with index #spellMaskBitIndex in spell family mask for values dependent from spellmod #spellModOp to #value.'),
+('debug spellstats',3,'Syntax: .debug spellstats [csv|reset]\r\n\r\nShow the ten most expensive spells since the last reset or SpellStats.DumpInterval dump with their selected targets and the calls and time of the cast stages, effect handlers and aura apply and remove. Times of nested stages are included in the outer ones. With csv all spells are shown as comma separated lines, reset sets the counters to zero. Needs SpellStats.Enable.'),
 ('delticket',2,'Syntax: .delticket all, .delticket #num, .delticket $character_name\r\n\r\nTo delete all tickets at server, $character_name to delete ticket of this character, #num to delete ticket #num.'),
 ('demorph',2,'Syntax: .demorph\r\n\r\nDemorph the selected player.'),
 ('die',3,'Syntax: .die\r\n\r\nKill the selected player. If no player is selected, it will kill you.'),
@@ -536,7 +542,7 @@ INSERT INTO `command` VALUES
 ('npc whisper',1,'Syntax: .npc whisper #playerguid #text\r\n\r\nMake the selected npc whisper #text to  #playerguid.'),
 ('npc yell',1,'Syntax: .npc yell #text\r\n\r\nMake the selected npc yells #text.'),
 ('pdump load',3,'Syntax: .pdump load $filename $account [$newname] [$newguid]\r\n\r\nLoad character dump from dump file into character list of $account with saved or $newname, with saved (or first free) or $newguid guid.'),
-('pdump write',3,'Syntax: .pdump write $filename $playerNameOrGUID\r\n\r\nWrite character dump with name/guid $playerNameOrGUID to file $filename.'),
+('pdump write',3,'Syntax: .pdump write $filename $playerNameOrGUID [binary]\r\n\r\nWrite character dump with name/guid $playerNameOrGUID to file $filename. With binary the dump is written in the binary format, .pdump load reads both formats. The dump holds the character as last saved to the database, for an online character the changes since its last save are missing.'),
 ('pinfo',2,'Syntax: .pinfo [$player_name]\r\n\r\nOutput account information for selected player or player find by $player_name.'),
 ('pool',2,'Syntax: .pool #pool_id\r\n\r\nPool information and full list creatures/gameobjects included in pool.'),
 ('pool list',2,'Syntax: .pool list\r\n\r\nList of pools with spawn in current map (only work in instances. Non-instanceable maps share pool system state os useless attempt get all pols at all continents.'),
@@ -576,6 +582,7 @@ INSERT INTO `command` VALUES
 ('send message',3,'Syntax: .send message $playername $message\r\n\r\nSend screen message to player from ADMINISTRATOR.'),
 ('send money',3,'Syntax: .send money #playername \"#subject\" \"#text\" #money\r\n\r\nSend mail with money to a player. Subject and mail text must be in quotes.'),
 ('server corpses',2,'Syntax: .server corpses\r\n\r\nTriggering corpses expire check in world.'),
+('server dbstats',2,'Syntax: .server dbstats [reset]\r\n\r\nShow per connection of the login, world and character databases the threads using it, the number of requests, their average and max time and latency histogram, and for async connections the queued requests. With reset the request counters are set to zero.'),
 ('server exit',4,'Syntax: .server exit\r\n\r\nTerminate mangosd NOW. Exit code 0.'),
 ('server idlerestart',3,'Syntax: .server idlerestart #delay\r\n\r\nRestart the server after #delay seconds if no active connections are present (no players). Use #exist_code or 2 as program exist code.'),
 ('server idlerestart cancel',3,'Syntax: .server idlerestart cancel\r\n\r\nCancel the restart/shutdown timer if any.'),
@@ -584,6 +591,7 @@ INSERT INTO `command` VALUES
 ('server info',0,'Syntax: .server info\r\n\r\nDisplay server version and the number of connected players.'),
 ('server log filter',4,'Syntax: .server log filter [($filtername|all) (on|off)]\r\n\r\nShow or set server log filters. If used \"all\" then all filters will be set to on/off state.'),
 ('server log level',4,'Syntax: .server log level [#level]\r\n\r\nShow or set server log level (0 - errors only, 1 - basic, 2 - detail, 3 - debug).'),
+('server mapstats',2,'Syntax: .server mapstats [csv]\r\n\r\nShow relocation notifies, visibility updates, objects created and destroyed at clients and time spent in visibility updates and player and creature relocations of every loaded map since its creation. With csv one comma separated line per map is shown.'),
 ('server motd',0,'Syntax: .server motd\r\n\r\nShow server Message of the day.'),
 ('server plimit',3,'Syntax: .server plimit [#num|-1|-2|-3|reset|player|moderator|gamemaster|administrator]\r\n\r\nWithout arg show current player amount and security level limitations for login to server, with arg set player linit ($num > 0) or securiti limitation ($num < 0 or security leme name. With `reset` sets player limit to the one in the config file'),
 ('server restart',3,'Syntax: .server restart #delay\r\n\r\nRestart the server after #delay seconds. Use #exist_code or 2 as program exist code.'),
@@ -591,6 +599,8 @@ INSERT INTO `command` VALUES
 ('server set motd',3,'Syntax: .server set motd $MOTD\r\n\r\nSet server Message of the day.'),
 ('server shutdown',3,'Syntax: .server shutdown #delay [#exit_code]\r\n\r\nShut the server down after #delay seconds. Use #exit_code or 0 as program exit code.'),
 ('server shutdown cancel',3,'Syntax: .server shutdown cancel\r\n\r\nCancel the restart/shutdown timer if any.'),
+('server terrainstats',2,'Syntax: .server terrainstats\r\n\r\nShow the loaded terrain, vmap and mmap grids of all maps, how many of them no map uses, their memory against Terrain.MemoryBudget and how many unused grids were used again or unloaded for the budget.'),
+('server tickstats',2,'Syntax: .server tickstats\r\n\r\nShow time spent in the world update stages: last, average and max time, calls over the stage budget and ticks the stage was deferred in.'),
 ('setskill',3,'Syntax: .setskill #skill #level [#max]\r\n\r\nSet a skill of id #skill with a current skill value of #level and a maximum value of #max (or equal current maximum if not provide) for the selected character. If no character is selected, you learn the skill.'),
 ('showarea',3,'Syntax: .showarea #areaid\r\n\r\nReveal the area of #areaid to the selected character. If no character is selected, reveal this area to you.'),
 ('stable',3,'Syntax: .stable\r\n\r\nShow your pet stable.'),
@@ -0,0 +1,7 @@
+ALTER TABLE character_db_version CHANGE COLUMN required_19002_02_character_whispers required_19015_01_characters_instance_reserve BIT;
+
+CREATE TABLE `instance_reserve` (
+  `next_id` int(11) unsigned NOT NULL DEFAULT '1' COMMENT 'first instance id not reserved by a world server yet'
+) ENGINE=InnoDB DEFAULT CHARSET=utf8;
+
+INSERT INTO `instance_reserve` SELECT IFNULL(MAX(`id`), 0) + 1 FROM `instance`;
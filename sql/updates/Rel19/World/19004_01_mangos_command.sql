@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19003_02_mangos_command required_19004_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('server tickstats',2,'Syntax: .server tickstats\r\n\r\nShow time spent in the world update stages: last, average and max time, calls over the stage budget and ticks the stage was deferred in.');
@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19004_01_mangos_command required_19005_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('server mapstats',2,'Syntax: .server mapstats [csv]\r\n\r\nShow relocation notifies, visibility updates, objects created and destroyed at clients and time spent in visibility updates and player and creature relocations of every loaded map since its creation. With csv one comma separated line per map is shown.');
@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19005_01_mangos_command required_19006_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('debug netstats',3,'Syntax: .debug netstats [csv|reset]\r\n\r\nShow sent packets and bytes of the ten largest opcodes, the update packets before and after compression and the ten most changed update fields since the last reset or NetStats.DumpInterval dump. Field changes are sampled in 1 of NetStats.FieldSampleRate values blocks. With csv all counters are shown as comma separated lines, reset sets them to zero. Needs NetStats.Enable.');
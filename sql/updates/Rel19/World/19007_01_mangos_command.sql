@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19006_01_mangos_command required_19007_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('server dbstats',2,'Syntax: .server dbstats [reset]\r\n\r\nShow per connection of the login, world and character databases the threads using it, the number of requests, their average and max time and latency histogram, and for async connections the queued requests. With reset the request counters are set to zero.');
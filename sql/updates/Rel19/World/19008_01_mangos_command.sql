@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19007_01_mangos_command required_19008_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('debug spellstats',3,'Syntax: .debug spellstats [csv|reset]\r\n\r\nShow the ten most expensive spells since the last reset or SpellStats.DumpInterval dump with their selected targets and the calls and time of the cast stages, effect handlers and aura apply and remove. Times of nested stages are included in the outer ones. With csv all spells are shown as comma separated lines, reset sets the counters to zero. Needs SpellStats.Enable.');
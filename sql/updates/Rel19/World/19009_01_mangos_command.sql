@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19008_01_mangos_command required_19009_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('server terrainstats',2,'Syntax: .server terrainstats\r\n\r\nShow the loaded terrain, vmap and mmap grids of all maps, how many of them no map uses, their memory against Terrain.MemoryBudget and how many unused grids were used again or unloaded for the budget.');
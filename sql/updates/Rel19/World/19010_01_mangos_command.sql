@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19009_01_mangos_command required_19010_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('debug profile',3,'Syntax: .debug profile #seconds\r\n\r\nRecord the timed scopes of the world and map updates, opcode handlers and creature and player updates for #seconds, at most 60, and write them to a Chrome trace event file in LogsDir, which can be opened in chrome://tracing or Perfetto.');
@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19010_01_mangos_command required_19011_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('debug opcodestats',3,'Syntax: .debug opcodestats [csv|sessions|reset]\r\n\r\nShow the ten opcodes of the most handler time since the last reset with their calls per second, calls in map updates, maximum and 99th percentile handler time and received bytes. With csv all opcodes are shown as comma separated lines, sessions shows the sessions of the most handler time in one second, reset sets the counters to zero. Needs OpcodeStats.Enable.');
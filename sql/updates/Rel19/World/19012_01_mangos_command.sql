@@ -0,0 +1,4 @@
+ALTER TABLE db_version CHANGE COLUMN required_19011_01_mangos_command required_19012_01_mangos_command BIT;
+
+INSERT INTO `command` VALUES
+('debug memory',3,'Syntax: .debug memory [csv]\r\n\r\nShow the live memory and allocations counted for the creatures, game objects, players, auras, packets, update data, query results, SQL storages, terrain, vmap and mmap data with the allocation rates since the last use of the command, and the resident memory of the process. With csv the counters are shown as comma separated lines.');
@@ -0,0 +1,6 @@
+ALTER TABLE db_version CHANGE COLUMN required_19012_01_mangos_command required_19013_01_mangos_command BIT;
+
+DELETE FROM `command` WHERE `name` IN ('pdump benchmark','pdump write');
+INSERT INTO `command` VALUES
+('pdump benchmark',3,'Syntax: .pdump benchmark [$playername] [#count]\r\n\r\nWrite the text and the binary character dump of the selected or named player #count times (10 by default) in memory and show the time and size of both formats.'),
+('pdump write',3,'Syntax: .pdump write $filename $playerNameOrGUID [binary]\r\n\r\nWrite character dump with name/guid $playerNameOrGUID to file $filename. With binary the dump is written in the binary format, .pdump load reads both formats.');
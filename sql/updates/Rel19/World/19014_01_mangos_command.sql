@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_19013_01_mangos_command required_19014_01_mangos_command BIT;
+
+DELETE FROM `command` WHERE `name` = 'debug scripthooks';
+INSERT INTO `command` VALUES
+('debug scripthooks',3,'Syntax: .debug scripthooks [reset]\r\n\r\nShow the ten most expensive script names since the last reset with the calls and microseconds of each script library hook they implement. Hooks a script does not implement are not called. With reset the counters are set to zero. Needs ScriptHookStats.Enable.');
@@ -0,0 +1,5 @@
+ALTER TABLE db_version CHANGE COLUMN required_19014_01_mangos_command required_19016_01_mangos_command BIT;
+
+DELETE FROM `command` WHERE `name` IN ('pdump benchmark','pdump write');
+INSERT INTO `command` VALUES
+('pdump write',3,'Syntax: .pdump write $filename $playerNameOrGUID [binary]\r\n\r\nWrite character dump with name/guid $playerNameOrGUID to file $filename. With binary the dump is written in the binary format, .pdump load reads both formats. The dump holds the character as last saved to the database, for an online character the changes since its last save are missing.');
@@ -0,0 +1,633 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/// \addtogroup benchmark Collision benchmark
+/// @{
+/// \file
+
+#include "Common.h"
+#include "Config/Config.h"
+#include "SystemConfig.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+#include "Util.h"
+#include "World.h"
+#include "GridMap.h"
+#include "MoveMap.h"
+#include "MoveMapSharedDefines.h"
+#include "PathFinder.h"
+#include "VMapFactory.h"
+#include "VMapDefinitions.h"
+#include "DynamicTree.h"
+#include "vmap/GameObjectModel.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/High_Res_Timer.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+DatabaseType WorldDatabase;                                 // the core links them, the benchmark reads no database
+DatabaseType CharacterDatabase;
+DatabaseType LoginDatabase;
+uint32 realmID = 0;
+
+extern void LoadGameObjectModelList();
+
+/// Kinds of measured queries, every kind runs over all queries of the set
+enum BenchmarkKind
+{
+    BENCH_MAP_HEIGHT,                                       // TerrainInfo::GetHeightStatic without vmaps, the .map data
+    BENCH_HEIGHT,                                           // TerrainInfo::GetHeightStatic with vmaps
+    BENCH_VMAP_HEIGHT,                                      // VMapManager2::getHeight
+    BENCH_VMAP_LOS,                                         // VMapManager2::isInLineOfSight
+    BENCH_VMAP_HITPOS,                                      // VMapManager2::getObjectHitPos
+    BENCH_DYN_HEIGHT,                                       // DynamicMapTree::getHeight
+    BENCH_DYN_LOS,                                          // DynamicMapTree::isInLineOfSight
+    BENCH_DYN_HITPOS,                                       // DynamicMapTree::getObjectHitPos
+    BENCH_PATH,                                             // the navmesh queries of PathFinder::calculate
+    MAX_BENCH_KINDS
+};
+
+static char const* const kindNames[MAX_BENCH_KINDS] =
+{
+    "mapheight", "height", "vmapheight", "los", "hitpos", "dynheight", "dynlos", "dynhitpos", "path"
+};
+
+/// One query of the set, height kinds use the start only
+struct BenchmarkQuery
+{
+    uint32 mapId;
+    float x1, y1, z1;
+    float x2, y2, z2;
+};
+
+typedef std::vector<BenchmarkQuery> QuerySet;
+
+/// Seeded random numbers, so a seed gives the same queries on every system
+class BenchmarkRandom
+{
+    public:
+        explicit BenchmarkRandom(uint32 seed) : m_state(uint64(seed) * UI64LIT(0x9E3779B97F4A7C15) + 1) {}
+
+        float Next(float min, float max)
+        {
+            // xorshift64*
+            m_state ^= m_state >> 12;
+            m_state ^= m_state << 25;
+            m_state ^= m_state >> 27;
+            uint32 value = uint32((m_state * UI64LIT(0x2545F4914F6CDD1D)) >> 40);
+            return min + (max - min) * (value / float(1 << 24));
+        }
+
+    private:
+        uint64 m_state;
+};
+
+/// Spawned gameobject models of a map
+struct BenchmarkDynamicMap
+{
+    BenchmarkDynamicMap() {}
+    ~BenchmarkDynamicMap()
+    {
+        for (std::vector<GameObjectModel*>::iterator itr = models.begin(); itr != models.end(); ++itr)
+        {
+            tree.remove(**itr);
+            delete *itr;
+        }
+    }
+
+    DynamicMapTree tree;
+    std::vector<GameObjectModel*> models;
+};
+
+typedef std::map<uint32, BenchmarkDynamicMap*> DynamicMaps;
+
+/// Print out the usage string for this program on the console.
+static void usage(char const* prog)
+{
+    sLog.outString("Usage: \n %s [<options>]\n"
+                   "    -c config_file   read DataDir and the vmap/mmap settings from config_file (default %s)\n\r"
+                   "    -m map_ids       comma separated maps of the random queries (default 0)\n\r"
+                   "    -n count         random queries per map (default 10000)\n\r"
+                   "    -s seed          seed of the random queries (default 1)\n\r"
+                   "    -r query_file    replay the queries of query_file instead of random ones\n\r"
+                   "    -w query_file    write the queries to query_file, to replay them with -r\n\r"
+                   "    -g count         gameobject models spawned per map for the dynamic tree (default 200)\n\r"
+                   "    -k kinds         comma separated query kinds (default all):\n\r"
+                   "                     mapheight, height, vmapheight, los, hitpos, dynheight, dynlos, dynhitpos, path\n\r"
+                   "    Query files hold a query per line: map_id x1 y1 z1 x2 y2 z2\n\r",
+                   prog, _MANGOSD_CONFIG);
+}
+
+/**
+ * @brief a random query on the ground of a grid with .map data, the end is up to 40 yards away
+ *
+ * @param terrain
+ * @param grids grids of the map with .map data, as x * MAX_NUMBER_OF_GRIDS + y
+ * @param rnd
+ * @param query
+ * @return bool false if no ground was found in some tries
+ */
+static bool RandomQuery(TerrainInfo* terrain, std::vector<uint32> const& grids, BenchmarkRandom& rnd, BenchmarkQuery& query)
+{
+    for (int tries = 0; tries < 32; ++tries)
+    {
+        uint32 grid = grids[uint32(rnd.Next(0.0f, float(grids.size()))) % grids.size()];
+        float gx = float(grid / MAX_NUMBER_OF_GRIDS);
+        float gy = float(grid % MAX_NUMBER_OF_GRIDS);
+
+        // the inverse of TerrainInfo::GetGrid
+        query.mapId = terrain->GetMapId();
+        query.x1 = (CENTER_GRID_ID - gx - rnd.Next(0.01f, 0.99f)) * SIZE_OF_GRIDS;
+        query.y1 = (CENTER_GRID_ID - gy - rnd.Next(0.01f, 0.99f)) * SIZE_OF_GRIDS;
+        query.z1 = terrain->GetHeightStatic(query.x1, query.y1, MAX_HEIGHT);
+        if (query.z1 <= INVALID_HEIGHT)
+            { continue; }
+
+        float angle = rnd.Next(0.0f, 2 * M_PI_F);
+        float dist = rnd.Next(1.0f, 40.0f);
+        query.x2 = query.x1 + dist * cos(angle);
+        query.y2 = query.y1 + dist * sin(angle);
+        query.z2 = terrain->GetHeightStatic(query.x2, query.y2, query.z1 + 10.0f);
+        if (query.z2 <= INVALID_HEIGHT)
+            { continue; }
+
+        // eye height, as the LOS checks of units
+        query.z1 += 2.0f;
+        query.z2 += 2.0f;
+        return true;
+    }
+
+    return false;
+}
+
+static bool GenerateQueries(std::vector<uint32> const& mapIds, uint32 count, uint32 seed, QuerySet& queries)
+{
+    BenchmarkRandom rnd(seed);
+
+    for (std::vector<uint32>::const_iterator itr = mapIds.begin(); itr != mapIds.end(); ++itr)
+    {
+        std::vector<uint32> grids;
+        for (uint32 x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+        {
+            for (uint32 y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+            {
+                char fileName[32];
+                snprintf(fileName, sizeof(fileName), "maps/%03u%02u%02u.map", *itr, x, y);
+                if (ACE_OS::access((sWorld.GetDataPath() + fileName).c_str(), R_OK) == 0)
+                    { grids.push_back(x * MAX_NUMBER_OF_GRIDS + y); }
+            }
+        }
+
+        if (grids.empty())
+        {
+            sLog.outError("Map %u has no .map files in %smaps", *itr, sWorld.GetDataPath().c_str());
+            return false;
+        }
+
+        TerrainInfo* terrain = sTerrainMgr.LoadTerrain(*itr);
+        uint32 generated = 0;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            BenchmarkQuery query;
+            if (RandomQuery(terrain, grids, rnd, query))
+            {
+                queries.push_back(query);
+                ++generated;
+            }
+        }
+
+        sLog.outString("Map %u: %u random queries over %u grids", *itr, generated, uint32(grids.size()));
+    }
+
+    return true;
+}
+
+static bool ReadQueries(char const* fileName, QuerySet& queries)
+{
+    std::ifstream file(fileName);
+    if (!file)
+    {
+        sLog.outError("Could not open query file %s", fileName);
+        return false;
+    }
+
+    std::string line;
+    uint32 lineNr = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNr;
+        if (line.empty() || line[0] == '#')
+            { continue; }
+
+        std::istringstream values(line);
+        BenchmarkQuery query;
+        if (!(values >> query.mapId >> query.x1 >> query.y1 >> query.z1 >> query.x2 >> query.y2 >> query.z2))
+        {
+            sLog.outError("Query file %s line %u is not map_id x1 y1 z1 x2 y2 z2", fileName, lineNr);
+            return false;
+        }
+
+        queries.push_back(query);
+    }
+
+    return true;
+}
+
+static bool WriteQueries(char const* fileName, QuerySet const& queries)
+{
+    FILE* file = fopen(fileName, "w");
+    if (!file)
+    {
+        sLog.outError("Could not create query file %s", fileName);
+        return false;
+    }
+
+    fprintf(file, "# map_id x1 y1 z1 x2 y2 z2\n");
+    for (QuerySet::const_iterator itr = queries.begin(); itr != queries.end(); ++itr)
+        { fprintf(file, "%u %.4f %.4f %.4f %.4f %.4f %.4f\n", itr->mapId, itr->x1, itr->y1, itr->z1, itr->x2, itr->y2, itr->z2); }
+
+    return fclose(file) == 0;
+}
+
+/// Loads the grids of all query points with their .map, vmap and mmap data, so no query measures loading
+static void LoadQueryGrids(QuerySet const& queries)
+{
+    for (QuerySet::const_iterator itr = queries.begin(); itr != queries.end(); ++itr)
+    {
+        TerrainInfo* terrain = sTerrainMgr.LoadTerrain(itr->mapId);
+        terrain->GetHeightStatic(itr->x1, itr->y1, itr->z1, false);
+        terrain->GetHeightStatic(itr->x2, itr->y2, itr->z2, false);
+    }
+}
+
+/// Reads the display ids of the gameobject models, LoadGameObjectModelList reads the same file
+static void ReadModelDisplayIds(std::vector<uint32>& displayIds)
+{
+    FILE* file = fopen((sWorld.GetDataPath() + "vmaps/" + VMAP::GAMEOBJECT_MODELS).c_str(), "rb");
+    if (!file)
+        { return; }
+
+    uint32 displayId, nameLength;
+    while (fread(&displayId, sizeof(uint32), 1, file) == 1 && fread(&nameLength, sizeof(uint32), 1, file) == 1)
+    {
+        // name and bounds
+        if (fseek(file, long(nameLength + 6 * sizeof(float)), SEEK_CUR) != 0)
+            { break; }
+        displayIds.push_back(displayId);
+    }
+
+    fclose(file);
+}
+
+/// Spawns the models at the starts of queries, the dynamic queries test them with the other queries
+static void SpawnModels(QuerySet const& queries, uint32 perMap, uint32 seed, DynamicMaps& maps)
+{
+    std::vector<uint32> displayIds;
+    ReadModelDisplayIds(displayIds);
+    if (displayIds.empty())
+    {
+        sLog.outError("No gameobject models in %svmaps/%s, the dynamic tree stays empty", sWorld.GetDataPath().c_str(), VMAP::GAMEOBJECT_MODELS);
+        return;
+    }
+
+    BenchmarkRandom rnd(seed);
+    for (QuerySet::const_iterator itr = queries.begin(); itr != queries.end(); ++itr)
+    {
+        BenchmarkDynamicMap*& map = maps[itr->mapId];
+        if (!map)
+            { map = new BenchmarkDynamicMap(); }
+
+        if (map->models.size() >= perMap)
+            { continue; }
+
+        uint32 displayId = displayIds[uint32(rnd.Next(0.0f, float(displayIds.size()))) % displayIds.size()];
+        G3D::Vector3 pos(itr->x1 + rnd.Next(-10.0f, 10.0f), itr->y1 + rnd.Next(-10.0f, 10.0f), itr->z1 - 2.0f);
+        if (GameObjectModel* model = GameObjectModel::construct(displayId, pos, rnd.Next(0.0f, 2 * M_PI_F), 1.0f))
+        {
+            map->tree.insert(*model);
+            map->models.push_back(model);
+        }
+    }
+
+    for (DynamicMaps::iterator itr = maps.begin(); itr != maps.end(); ++itr)
+    {
+        itr->second->tree.balance();
+        sLog.outString("Map %u: %u gameobject models spawned", itr->first, uint32(itr->second->models.size()));
+    }
+}
+
+/**
+ * @brief the navmesh queries PathFinder::calculate makes for a new path of a walking and swimming creature
+ *
+ * PathFinder needs a unit, this repeats its polygon search, sliced corridor search and straight path.
+ *
+ * @param query
+ * @return bool true if a complete path was found
+ */
+static bool FindPath(BenchmarkQuery const& query)
+{
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, mmap->GetLock(), false);
+
+    dtNavMesh const* navMesh;
+    dtNavMeshQuery* navQuery = const_cast<dtNavMeshQuery*>(mmap->GetThreadNavMeshQuery(query.mapId, navMesh));
+    if (!navQuery)
+        { return false; }
+
+    dtQueryFilter filter;
+    filter.setIncludeFlags(NAV_GROUND | NAV_WATER);
+    filter.setExcludeFlags(NAV_MAGMA | NAV_SLIME);
+
+    float startPoint[VERTEX_SIZE] = { query.y1, query.z1, query.x1 };
+    float endPoint[VERTEX_SIZE] = { query.y2, query.z2, query.x2 };
+    float extents[VERTEX_SIZE] = { 3.0f, 5.0f, 3.0f };
+    float closest[VERTEX_SIZE];
+
+    dtPolyRef startPoly = INVALID_POLYREF;
+    dtPolyRef endPoly = INVALID_POLYREF;
+    navQuery->findNearestPoly(startPoint, extents, &filter, &startPoly, closest);
+    navQuery->findNearestPoly(endPoint, extents, &filter, &endPoly, closest);
+    if (startPoly == INVALID_POLYREF || endPoly == INVALID_POLYREF)
+        { return false; }
+
+    dtPolyRef polys[MAX_PATH_LENGTH];
+    int polyCount = 0;
+    dtStatus status = navQuery->initSlicedFindPath(startPoly, endPoly, startPoint, endPoint, &filter);
+    if (dtStatusInProgress(status))
+        { navQuery->updateSlicedFindPath(MAX_PATH_SEARCH_ITERATIONS); }
+    if (dtStatusFailed(navQuery->finalizeSlicedFindPath(polys, &polyCount, MAX_PATH_LENGTH)) || !polyCount)
+        { return false; }
+
+    float points[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
+    int pointCount = 0;
+    status = navQuery->findStraightPath(startPoint, endPoint, polys, polyCount, points, NULL, NULL, &pointCount, MAX_POINT_PATH_LENGTH);
+
+    return dtStatusSucceed(status) && polys[polyCount - 1] == endPoly;
+}
+
+/**
+ * @brief runs one query of a kind
+ *
+ * @return bool the query hit: a valid height, a blocked sight, a hit position or a complete path
+ */
+static bool RunQuery(BenchmarkKind kind, BenchmarkQuery const& query, TerrainInfo const* terrain, DynamicMaps const& dynamicMaps)
+{
+    VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
+    float rx, ry, rz;
+
+    switch (kind)
+    {
+        case BENCH_MAP_HEIGHT:
+            return terrain->GetHeightStatic(query.x1, query.y1, query.z1, false) > INVALID_HEIGHT;
+        case BENCH_HEIGHT:
+            return terrain->GetHeightStatic(query.x1, query.y1, query.z1, true) > INVALID_HEIGHT;
+        case BENCH_VMAP_HEIGHT:
+            return vmgr->getHeight(query.mapId, query.x1, query.y1, query.z1, DEFAULT_HEIGHT_SEARCH) > INVALID_HEIGHT;
+        case BENCH_VMAP_LOS:
+            return !vmgr->isInLineOfSight(query.mapId, query.x1, query.y1, query.z1, query.x2, query.y2, query.z2);
+        case BENCH_VMAP_HITPOS:
+            return vmgr->getObjectHitPos(query.mapId, query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, rx, ry, rz, 0.0f);
+        case BENCH_PATH:
+            return FindPath(query);
+        default:
+            break;
+    }
+
+    DynamicMaps::const_iterator itr = dynamicMaps.find(query.mapId);
+    if (itr == dynamicMaps.end())
+        { return false; }
+
+    DynamicMapTree const& tree = itr->second->tree;
+    switch (kind)
+    {
+        case BENCH_DYN_HEIGHT:
+            return tree.getHeight(query.x1, query.y1, query.z1, DEFAULT_HEIGHT_SEARCH) > INVALID_HEIGHT;
+        case BENCH_DYN_LOS:
+            return !tree.isInLineOfSight(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2);
+        case BENCH_DYN_HITPOS:
+            return tree.getObjectHitPos(query.x1, query.y1, query.z1, query.x2, query.y2, query.z2, rx, ry, rz, 0.0f);
+        default:
+            return false;
+    }
+}
+
+static double Percentile(std::vector<ACE_hrtime_t> const& sorted, double part)
+{
+    size_t index = std::min(sorted.size() - 1, size_t(part * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+static void RunKind(BenchmarkKind kind, QuerySet const& queries, DynamicMaps const& dynamicMaps)
+{
+    std::vector<ACE_hrtime_t> latencies;
+    latencies.reserve(queries.size());
+
+    uint32 hits = 0;
+    ACE_hrtime_t total = 0;
+    ACE_High_Res_Timer timer;
+    for (QuerySet::const_iterator itr = queries.begin(); itr != queries.end(); ++itr)
+    {
+        TerrainInfo const* terrain = sTerrainMgr.LoadTerrain(itr->mapId);
+
+        timer.reset();
+        timer.start();
+        bool hit = RunQuery(kind, *itr, terrain, dynamicMaps);
+        timer.stop();
+
+        ACE_hrtime_t nanoseconds;
+        timer.elapsed_time(nanoseconds);
+        latencies.push_back(nanoseconds);
+        total += nanoseconds;
+        if (hit)
+            { ++hits; }
+    }
+
+    if (latencies.empty())
+        { return; }
+
+    std::sort(latencies.begin(), latencies.end());
+    double seconds = total / 1000000000.0;
+    sLog.outString("%-10s %9u %9u %10.1f %12.0f %9.2f %9.2f %9.2f %9.2f", kindNames[kind], uint32(latencies.size()), hits,
+                   seconds * 1000.0, seconds > 0.0 ? latencies.size() / seconds : 0.0,
+                   Percentile(latencies, 0.5), Percentile(latencies, 0.9), Percentile(latencies, 0.99), latencies.back() / 1000.0);
+}
+
+static bool ParseIds(char const* text, std::vector<uint32>& ids)
+{
+    Tokens tokens = StrSplit(text, ",");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        char* end;
+        unsigned long id = strtoul(itr->c_str(), &end, 10);
+        if (itr->empty() || *end)
+            { return false; }
+        ids.push_back(uint32(id));
+    }
+
+    return !ids.empty();
+}
+
+static bool ParseKinds(char const* text, bool* kinds)
+{
+    Tokens tokens = StrSplit(text, ",");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        int kind = 0;
+        while (kind < MAX_BENCH_KINDS && *itr != kindNames[kind])
+            { ++kind; }
+        if (kind == MAX_BENCH_KINDS)
+            { return false; }
+        kinds[kind] = true;
+    }
+
+    return !tokens.empty();
+}
+
+/// Launch the collision benchmark
+extern int main(int argc, char** argv)
+{
+    ///- Command line parsing
+    char const* cfg_file = _MANGOSD_CONFIG;
+    char const* readFile = NULL;
+    char const* writeFile = NULL;
+    std::vector<uint32> mapIds;
+    uint32 count = 10000;
+    uint32 seed = 1;
+    uint32 models = 200;
+    bool kinds[MAX_BENCH_KINDS];
+    bool kindsGiven = false;
+    std::fill(kinds, kinds + MAX_BENCH_KINDS, false);
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":c:m:n:s:r:w:g:k:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'c':
+                cfg_file = cmd_opts.opt_arg();
+                break;
+            case 'm':
+                if (!ParseIds(cmd_opts.opt_arg(), mapIds))
+                {
+                    sLog.outError("Runtime-Error: -m needs comma separated map ids");
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'n':
+                count = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 's':
+                seed = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'r':
+                readFile = cmd_opts.opt_arg();
+                break;
+            case 'w':
+                writeFile = cmd_opts.opt_arg();
+                break;
+            case 'g':
+                models = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'k':
+                if (!ParseKinds(cmd_opts.opt_arg(), kinds))
+                {
+                    sLog.outError("Runtime-Error: unknown query kind in %s", cmd_opts.opt_arg());
+                    usage(argv[0]);
+                    return 1;
+                }
+                kindsGiven = true;
+                break;
+            case ':':
+                sLog.outError("Runtime-Error: -%c option requires an input argument", cmd_opts.opt_opt());
+                usage(argv[0]);
+                return 1;
+            default:
+                sLog.outError("Runtime-Error: bad format of commandline arguments");
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!kindsGiven)
+        { std::fill(kinds, kinds + MAX_BENCH_KINDS, true); }
+    if (mapIds.empty())
+        { mapIds.push_back(0); }
+
+    if (!sConfig.SetSource(cfg_file))
+    {
+        sLog.outError("Could not find configuration file %s.", cfg_file);
+        return 1;
+    }
+
+    // DataDir and the vmap/mmap settings as the world server uses them, the vmap queries are measured anyway
+    sWorld.LoadConfigSettings();
+    VMAP::VMapFactory::createOrGetVMapManager()->setEnableLineOfSightCalc(true);
+    VMAP::VMapFactory::createOrGetVMapManager()->setEnableHeightCalc(true);
+
+    QuerySet queries;
+    if (readFile ? !ReadQueries(readFile, queries) : !GenerateQueries(mapIds, count, seed, queries))
+        { return 1; }
+
+    if (queries.empty())
+    {
+        sLog.outError("No queries to run");
+        return 1;
+    }
+
+    if (writeFile && !WriteQueries(writeFile, queries))
+        { return 1; }
+
+    sLog.outString("Loading the grids of %u queries...", uint32(queries.size()));
+    LoadQueryGrids(queries);
+
+    DynamicMaps dynamicMaps;
+    if (kinds[BENCH_DYN_HEIGHT] || kinds[BENCH_DYN_LOS] || kinds[BENCH_DYN_HITPOS])
+    {
+        LoadGameObjectModelList();
+        SpawnModels(queries, models, seed, dynamicMaps);
+    }
+
+    sLog.outString();
+    sLog.outString("%-10s %9s %9s %10s %12s %9s %9s %9s %9s", "kind", "queries", "hits", "total ms", "queries/s", "p50 us", "p90 us", "p99 us", "max us");
+    for (int kind = 0; kind < MAX_BENCH_KINDS; ++kind)
+    {
+        if (kinds[kind])
+            { RunKind(BenchmarkKind(kind), queries, dynamicMaps); }
+    }
+
+    for (DynamicMaps::iterator itr = dynamicMaps.begin(); itr != dynamicMaps.end(); ++itr)
+        { delete itr->second; }
+
+    return 0;
+}
+
+/// @}
@@ -0,0 +1,677 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/// \addtogroup benchmark Core benchmark
+/// @{
+/// \file
+
+#include "Common.h"
+#include "Config/Config.h"
+#include "SystemConfig.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+#include "Util.h"
+#include "World.h"
+#include "WorldPacket.h"
+#include "UpdateData.h"
+#include "UpdateMask.h"
+#include "UpdateFields.h"
+#include "ObjectGuid.h"
+#include "GuidHashSet.h"
+#include "DBCStores.h"
+#include "Utilities/EventProcessor.h"
+#include "LockedQueue.h"
+#include "Auth/AuthCrypt.h"
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+#include "Utilities/UnorderedMapSet.h"
+#include "Opcodes.h"
+#include "PlayerDump.h"
+#include "SharedDefines.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/High_Res_Timer.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <algorithm>
+
+DatabaseType WorldDatabase;                                 // the core links them, only the pdump kinds read a database
+DatabaseType CharacterDatabase;
+DatabaseType LoginDatabase;
+uint32 realmID = 0;
+
+/// Measured operations, every kind runs its operation the given number of times per round
+enum BenchmarkKind
+{
+    BENCH_BYTEBUFFER,                                       // WorldPacket appends and reads of a chat message
+    BENCH_UPDATEMASK,                                       // UpdateMask set, FindNextBit walk and Clear of player fields
+    BENCH_UPDATEDATA,                                       // UpdateData::BuildPacket of a compressed create packet
+    BENCH_EVENTS,                                           // EventProcessor adds, aborts and updates
+    BENCH_GUIDSET,                                          // GuidSet insert, find and erase
+    BENCH_GUIDVECTOR,                                       // the same on a sorted GuidVector
+    BENCH_GUIDHASH,                                         // the same on a GuidHashSet
+    BENCH_GUIDUNORDERED,                                    // the same on an UNORDERED_SET of guids
+    BENCH_AUTHCRYPT,                                        // AuthCrypt of a server and a client header
+    BENCH_SHA1,                                             // Sha1Hash of a 64 bytes block
+    BENCH_SRP6,                                             // BigNumber::ModExp of the SRP6 public key
+    BENCH_LOCKEDQUEUE,                                      // LockedQueue add and next of a packet pointer
+    BENCH_DBC,                                              // DBCStorage::LookupEntry of spells, needs the DBC files
+    BENCH_PDUMPTEXT,                                        // PlayerDumpWriter::GetDump of a character, needs the character database
+    BENCH_PDUMPBINARY,                                      // PlayerDumpWriter::GetBinaryDump of the same character
+    MAX_BENCH_KINDS
+};
+
+static char const* const kindNames[MAX_BENCH_KINDS] =
+{
+    "bytebuffer", "updatemask", "updatedata", "events", "guidset", "guidvector", "guidhash", "guidunordered",
+    "authcrypt", "sha1", "srp6", "lockedqueue", "dbc", "pdumptext", "pdumpbinary"
+};
+
+/// Output formats of the results
+enum BenchmarkFormat
+{
+    FORMAT_TEXT,
+    FORMAT_CSV
+};
+
+/// Guids per set of the guid container kinds, about the visible objects of a player
+static uint32 const GUIDS_PER_SET = 64;
+
+typedef UNORDERED_SET<ObjectGuid> GuidUnorderedSet;
+
+/// Character of the pdump kinds, set by -g
+static uint32 dumpGuid = 0;
+
+/// Seeded random numbers, so a seed gives the same operations on every system
+class BenchmarkRandom
+{
+    public:
+        explicit BenchmarkRandom(uint32 seed) : m_state(uint64(seed) * UI64LIT(0x9E3779B97F4A7C15) + 1) {}
+
+        uint32 Next()
+        {
+            // xorshift64*
+            m_state ^= m_state >> 12;
+            m_state ^= m_state << 25;
+            m_state ^= m_state >> 27;
+            return uint32((m_state * UI64LIT(0x2545F4914F6CDD1D)) >> 32);
+        }
+
+    private:
+        uint64 m_state;
+};
+
+/// Event of the events kind, counts its executions
+class BenchmarkEvent : public BasicEvent
+{
+    public:
+        explicit BenchmarkEvent(uint32& executed) : m_executed(executed) {}
+
+        bool Execute(uint64 /*e_time*/, uint32 /*p_time*/) override
+        {
+            ++m_executed;
+            return true;
+        }
+
+    private:
+        uint32& m_executed;
+};
+
+/// Print out the usage string for this program on the console.
+static void usage(char const* prog)
+{
+    sLog.outString("Usage: \n %s [<options>]\n"
+                   "    -c config_file   read DataDir and Compression from config_file (default %s)\n\r"
+                   "    -n count         operations per round (default 100000)\n\r"
+                   "    -r rounds        measured rounds, the best and the median are shown (default 5)\n\r"
+                   "    -s seed          seed of the random operations (default 1)\n\r"
+                   "    -f format        text or csv (default text)\n\r"
+                   "    -g guid          character of the pdump kinds, read from CharacterDatabaseInfo of the config\n\r"
+                   "    -k kinds         comma separated kinds (default all):\n\r"
+                   "                     bytebuffer, updatemask, updatedata, events, guidset, guidvector, guidhash,\n\r"
+                   "                     guidunordered, authcrypt, sha1, srp6, lockedqueue, dbc, pdumptext, pdumpbinary\n\r",
+                   prog, _MANGOSD_CONFIG);
+}
+
+static uint32 BenchByteBuffer(uint32 count, BenchmarkRandom& rnd)
+{
+    uint32 sum = 0;
+    std::string text = "a message of average length for a say";
+    ObjectGuid guid(HIGHGUID_PLAYER, (rnd.Next() & 0xFFFFFF) | 1);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        // the layout of a chat message
+        WorldPacket data(SMSG_MESSAGECHAT, 100);
+        data << uint8(CHAT_MSG_SAY);
+        data << uint32(LANG_UNIVERSAL);
+        data << guid;
+        data << uint32(0);
+        data << guid;
+        data << uint32(text.length() + 1);
+        data << text;
+        data << uint8(0);
+
+        uint8 type;
+        uint32 language, length;
+        ObjectGuid sender, target;
+        std::string message;
+        data >> type >> language >> sender;
+        data.read_skip<uint32>();
+        data >> target >> length >> message;
+        sum += type + length + uint32(message.size());
+    }
+
+    return sum;
+}
+
+static uint32 BenchUpdateMask(uint32 count, BenchmarkRandom& rnd)
+{
+    uint32 sum = 0;
+    uint32 indexes[32];
+    for (uint32 i = 0; i < 32; ++i)
+        { indexes[i] = rnd.Next() % PLAYER_END; }
+
+    UpdateMask mask;
+    mask.SetCount(PLAYER_END);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        // a few changed fields of a tick
+        for (uint32 j = 0; j < 8; ++j)
+            { mask.SetBit(indexes[(i + j) & 31]); }
+
+        for (uint32 index = mask.FindNextBit(0); index < PLAYER_END; index = mask.FindNextBit(index + 1))
+            { sum += index; }
+
+        mask.Clear();
+    }
+
+    return sum;
+}
+
+static uint32 BenchUpdateData(uint32 count, BenchmarkRandom& rnd)
+{
+    // a create block of about a creature
+    ByteBuffer block(400);
+    block << uint8(UPDATETYPE_CREATE_OBJECT);
+    block << ObjectGuid(HIGHGUID_UNIT, uint32(1), uint32(1)).WriteAsPacked();
+    for (uint32 i = 0; i < 96; ++i)
+        { block << uint32(i < 48 ? rnd.Next() & 0xFF : 0); }
+
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        UpdateData data;
+        for (uint32 j = 0; j < 4; ++j)
+            { data.AddUpdateBlock(block); }
+
+        WorldPacket packet;
+        data.BuildPacket(&packet);
+        sum += uint32(packet.size());
+    }
+
+    return sum;
+}
+
+static uint32 BenchEvents(uint32 count, BenchmarkRandom& rnd)
+{
+    uint32 executed = 0;
+    EventProcessor events;
+
+    // events of a unit per tick: some are due at once, some later and some are cancelled
+    for (uint32 i = 0; i < count; ++i)
+    {
+        BenchmarkEvent* event = new BenchmarkEvent(executed);
+        events.AddEvent(event, events.CalculateTime(rnd.Next() % 500));
+        if ((i & 7) == 0)
+            { event->to_Abort = true; }
+
+        if ((i & 15) == 15)
+            { events.Update(50); }
+    }
+
+    events.KillAllEvents(true);
+    return executed;
+}
+
+template<class Set>
+static bool Contains(Set const& container, ObjectGuid const& guid) { return container.find(guid) != container.end(); }
+
+static bool Contains(GuidHashSet const& container, ObjectGuid const& guid) { return container.contains(guid); }
+
+/**
+ * @brief the guid container operations of the visibility update, insert new guids, look up and erase old ones
+ *
+ * @param count operations
+ * @param rnd
+ * @param container GuidSet, GuidHashSet or GuidUnorderedSet
+ * @return uint32 found guids
+ */
+template<class Set>
+static uint32 RunGuidSet(uint32 count, BenchmarkRandom& rnd, Set& container)
+{
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        ObjectGuid guid(HIGHGUID_UNIT, 1, rnd.Next() % (GUIDS_PER_SET * 2) + 1);
+        if (Contains(container, guid))
+            { ++sum; }
+        if (container.size() < GUIDS_PER_SET)
+            { container.insert(guid); }
+        else
+            { container.erase(guid); }
+    }
+
+    return sum;
+}
+
+/// RunGuidSet on a sorted vector
+static uint32 RunGuidVector(uint32 count, BenchmarkRandom& rnd, GuidVector& container)
+{
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        ObjectGuid guid(HIGHGUID_UNIT, 1, rnd.Next() % (GUIDS_PER_SET * 2) + 1);
+        GuidVector::iterator itr = std::lower_bound(container.begin(), container.end(), guid);
+        bool found = itr != container.end() && *itr == guid;
+        if (found)
+            { ++sum; }
+        if (container.size() < GUIDS_PER_SET)
+        {
+            if (!found)
+                { container.insert(itr, guid); }
+        }
+        else if (found)
+            { container.erase(itr); }
+    }
+
+    return sum;
+}
+
+static uint32 BenchAuthCrypt(uint32 count, BenchmarkRandom& rnd)
+{
+    uint8 key[40];
+    for (uint32 i = 0; i < sizeof(key); ++i)
+        { key[i] = uint8(rnd.Next()); }
+
+    // both ends of a connection, so every header is decrypted again
+    AuthCrypt server, client;
+    server.SetKey(key, sizeof(key));
+    server.Init();
+    client.SetKey(key, sizeof(key));
+    client.Init();
+
+    uint32 sum = 0;
+    uint8 header[AuthCrypt::CRYPTED_RECV_LEN];
+    for (uint32 i = 0; i < count; ++i)
+    {
+        memset(header, uint8(i), sizeof(header));
+        server.EncryptSend(header, AuthCrypt::CRYPTED_SEND_LEN);
+        client.DecryptServerHeader(header);
+        client.EncryptClientHeader(header);
+        server.DecryptRecv(header, AuthCrypt::CRYPTED_RECV_LEN);
+        sum += header[0];
+    }
+
+    return sum;
+}
+
+static uint32 BenchSha1(uint32 count, BenchmarkRandom& rnd)
+{
+    uint8 block[64];
+    for (uint32 i = 0; i < sizeof(block); ++i)
+        { block[i] = uint8(rnd.Next()); }
+
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        Sha1Hash sha;
+        sha.UpdateData(block, sizeof(block));
+        sha.Finalize();
+        block[i % sizeof(block)] = sha.GetDigest()[0];
+        sum += block[i % sizeof(block)];
+    }
+
+    return sum;
+}
+
+static uint32 BenchSrp6(uint32 count, BenchmarkRandom& /*rnd*/)
+{
+    // the group of realmd, B = g^b mod N of every logon challenge
+    BigNumber N, g, b;
+    N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
+    g.SetDword(7);
+
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        b.SetRand(19 * 8);
+        BigNumber gmod = g.ModExp(b, N);
+        sum += gmod.AsByteArray(32)[0];
+    }
+
+    return sum;
+}
+
+static uint32 BenchLockedQueue(uint32 count, BenchmarkRandom& /*rnd*/)
+{
+    // the receive queue of a session without contention, a few packets per update
+    ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> queue;
+    WorldPacket packet;
+
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; i += 4)
+    {
+        for (uint32 j = 0; j < 4; ++j)
+            { queue.add(&packet); }
+
+        WorldPacket* next;
+        while (queue.next(next))
+            { ++sum; }
+    }
+
+    return sum;
+}
+
+static uint32 BenchDbc(uint32 count, BenchmarkRandom& rnd)
+{
+    uint32 sum = 0;
+    uint32 rows = sSpellStore.GetNumRows();
+    for (uint32 i = 0; i < count; ++i)
+    {
+        // most ids below the row count have an entry, the rest misses
+        if (SpellEntry const* spell = sSpellStore.LookupEntry(rnd.Next() % rows))
+            { sum += spell->Id; }
+    }
+
+    return sum;
+}
+
+/// the dumps of both formats make the same queries, the difference is the formatting of the rows
+static uint32 BenchPlayerDump(uint32 count, bool binary)
+{
+    uint32 sum = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        if (binary)
+        {
+            ByteBuffer dump;
+            PlayerDumpWriter().GetBinaryDump(dumpGuid, dump);
+            sum += dump.size();
+        }
+        else
+            { sum += PlayerDumpWriter().GetDump(dumpGuid).size(); }
+    }
+
+    return sum;
+}
+
+static uint32 RunOperations(BenchmarkKind kind, uint32 count, BenchmarkRandom& rnd)
+{
+    switch (kind)
+    {
+        case BENCH_BYTEBUFFER:
+            return BenchByteBuffer(count, rnd);
+        case BENCH_UPDATEMASK:
+            return BenchUpdateMask(count, rnd);
+        case BENCH_UPDATEDATA:
+            return BenchUpdateData(count, rnd);
+        case BENCH_EVENTS:
+            return BenchEvents(count, rnd);
+        case BENCH_GUIDSET:
+        {
+            GuidSet container;
+            return RunGuidSet(count, rnd, container);
+        }
+        case BENCH_GUIDVECTOR:
+        {
+            GuidVector container;
+            container.reserve(GUIDS_PER_SET);
+            return RunGuidVector(count, rnd, container);
+        }
+        case BENCH_GUIDHASH:
+        {
+            GuidHashSet container;
+            return RunGuidSet(count, rnd, container);
+        }
+        case BENCH_GUIDUNORDERED:
+        {
+            GuidUnorderedSet container;
+            return RunGuidSet(count, rnd, container);
+        }
+        case BENCH_AUTHCRYPT:
+            return BenchAuthCrypt(count, rnd);
+        case BENCH_SHA1:
+            return BenchSha1(count, rnd);
+        case BENCH_SRP6:
+            return BenchSrp6(count, rnd);
+        case BENCH_LOCKEDQUEUE:
+            return BenchLockedQueue(count, rnd);
+        case BENCH_DBC:
+            return BenchDbc(count, rnd);
+        case BENCH_PDUMPTEXT:
+            return BenchPlayerDump(count, false);
+        case BENCH_PDUMPBINARY:
+            return BenchPlayerDump(count, true);
+        default:
+            return 0;
+    }
+}
+
+static void RunKind(BenchmarkKind kind, uint32 count, uint32 rounds, uint32 seed, BenchmarkFormat format)
+{
+    // the modular exponentiation is some thousand times slower than the other operations
+    if (kind == BENCH_SRP6)
+        { count = std::max(count / 1000, uint32(1)); }
+    // a dump makes a query per table
+    else if (kind == BENCH_PDUMPTEXT || kind == BENCH_PDUMPBINARY)
+        { count = std::max(count / 10000, uint32(1)); }
+
+    std::vector<ACE_hrtime_t> times;
+    times.reserve(rounds);
+
+    uint32 check = 0;
+    ACE_High_Res_Timer timer;
+    for (uint32 round = 0; round < rounds; ++round)
+    {
+        BenchmarkRandom rnd(seed);
+
+        timer.reset();
+        timer.start();
+        check += RunOperations(kind, count, rnd);
+        timer.stop();
+
+        ACE_hrtime_t nanoseconds;
+        timer.elapsed_time(nanoseconds);
+        times.push_back(nanoseconds);
+    }
+
+    if (times.empty())
+        { return; }
+
+    std::sort(times.begin(), times.end());
+    double best = double(times.front()) / count;
+    double median = double(times[times.size() / 2]) / count;
+
+    // the check sum keeps the compiler from dropping the results, equal sums show the same work was done
+    if (format == FORMAT_CSV)
+        { sLog.outString("%s,%u,%u,%.1f,%.2f,%.2f,%u", kindNames[kind], count, rounds, times.back() / 1000000.0, best, median, check); }
+    else
+    {
+        sLog.outString("%-13s %10u %6u %10.1f %10.2f %10.2f %12.0f %10u", kindNames[kind], count, rounds, times.back() / 1000000.0,
+                       best, median, best > 0.0 ? 1000000000.0 / best : 0.0, check);
+    }
+}
+
+static bool ParseKinds(char const* text, bool* kinds)
+{
+    Tokens tokens = StrSplit(text, ",");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        int kind = 0;
+        while (kind < MAX_BENCH_KINDS && *itr != kindNames[kind])
+            { ++kind; }
+        if (kind == MAX_BENCH_KINDS)
+            { return false; }
+        kinds[kind] = true;
+    }
+
+    return !tokens.empty();
+}
+
+/// Launch the core benchmark
+extern int main(int argc, char** argv)
+{
+    ///- Command line parsing
+    char const* cfg_file = _MANGOSD_CONFIG;
+    bool cfgGiven = false;
+    uint32 count = 100000;
+    uint32 rounds = 5;
+    uint32 seed = 1;
+    BenchmarkFormat format = FORMAT_TEXT;
+    bool kinds[MAX_BENCH_KINDS];
+    bool kindsGiven = false;
+    std::fill(kinds, kinds + MAX_BENCH_KINDS, false);
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":c:n:r:s:f:g:k:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'c':
+                cfg_file = cmd_opts.opt_arg();
+                cfgGiven = true;
+                break;
+            case 'n':
+                count = std::max(uint32(atoi(cmd_opts.opt_arg())), uint32(1));
+                break;
+            case 'r':
+                rounds = std::max(uint32(atoi(cmd_opts.opt_arg())), uint32(1));
+                break;
+            case 's':
+                seed = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'f':
+                if (!strcmp(cmd_opts.opt_arg(), "csv"))
+                    { format = FORMAT_CSV; }
+                else if (strcmp(cmd_opts.opt_arg(), "text"))
+                {
+                    sLog.outError("Runtime-Error: unknown format %s", cmd_opts.opt_arg());
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'g':
+                dumpGuid = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'k':
+                if (!ParseKinds(cmd_opts.opt_arg(), kinds))
+                {
+                    sLog.outError("Runtime-Error: unknown kind in %s", cmd_opts.opt_arg());
+                    usage(argv[0]);
+                    return 1;
+                }
+                kindsGiven = true;
+                break;
+            case ':':
+                sLog.outError("Runtime-Error: -%c option requires an input argument", cmd_opts.opt_opt());
+                usage(argv[0]);
+                return 1;
+            default:
+                sLog.outError("Runtime-Error: bad format of commandline arguments");
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!kindsGiven)
+        { std::fill(kinds, kinds + MAX_BENCH_KINDS, true); }
+
+    // only the dbc kind needs files, the others run with the default settings
+    if (sConfig.SetSource(cfg_file))
+        { sWorld.LoadConfigSettings(); }
+    else if (cfgGiven)
+    {
+        sLog.outError("Could not find configuration file %s.", cfg_file);
+        return 1;
+    }
+    else
+        { sWorld.setConfig(CONFIG_UINT32_COMPRESSION, uint32(1)); }
+
+    if (kinds[BENCH_DBC])
+    {
+        // LoadDBCStores stops the process on missing files, so check one before
+        std::string spellDbc = sWorld.GetDataPath() + "dbc/Spell.dbc";
+        if (ACE_OS::access(spellDbc.c_str(), R_OK) == 0)
+            { LoadDBCStores(sWorld.GetDataPath()); }
+        else
+        {
+            sLog.outString("No %s, the dbc kind is skipped", spellDbc.c_str());
+            kinds[BENCH_DBC] = false;
+        }
+    }
+
+    bool dumpKinds = kinds[BENCH_PDUMPTEXT] || kinds[BENCH_PDUMPBINARY];
+    if (dumpKinds)
+    {
+        std::string dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo", "");
+        if (!dumpGuid)
+        {
+            sLog.outString("No character given by -g, the pdump kinds are skipped");
+            dumpKinds = false;
+        }
+        else if (dbstring.empty() || !CharacterDatabase.Initialize(dbstring.c_str()))
+        {
+            sLog.outString("Can not connect to the character database, the pdump kinds are skipped");
+            dumpKinds = false;
+        }
+
+        kinds[BENCH_PDUMPTEXT] = kinds[BENCH_PDUMPTEXT] && dumpKinds;
+        kinds[BENCH_PDUMPBINARY] = kinds[BENCH_PDUMPBINARY] && dumpKinds;
+    }
+
+    if (format == FORMAT_CSV)
+        { sLog.outString("kind,operations,rounds,worst_ms,best_ns_per_op,median_ns_per_op,check"); }
+    else
+    {
+        sLog.outString();
+        sLog.outString("%-13s %10s %6s %10s %10s %10s %12s %10s", "kind", "operations", "rounds", "worst ms", "best ns", "median ns", "best ops/s", "check");
+    }
+
+    for (int kind = 0; kind < MAX_BENCH_KINDS; ++kind)
+    {
+        if (kinds[kind])
+            { RunKind(BenchmarkKind(kind), count, rounds, seed, format); }
+    }
+
+    if (dumpKinds)
+        { CharacterDatabase.HaltDelayThread(); }
+
+    return 0;
+}
+
+/// @}
@@ -25,43 +25,190 @@
 #ifndef _GRIDREFMANAGER
 #define _GRIDREFMANAGER
 
-#include "Utilities/LinkedReference/RefManager.h"
+#include "GameSystem/GridReference.h"
 
-template<class OBJECT> class GridReference;
+#include <vector>
 
 template<class OBJECT>
 /**
- * @brief
+ * @brief The objects of one type in a grid cell (or the grids of a map)
+ *
+ * The references are kept in a dense array, each reference knows its slot.
+ * Linking appends. Unlinking moves the last reference into the freed slot,
+ * unless an iterator of the manager exists: then the slot is cleared and the
+ * array is compacted when the last iterator is gone, so a walk never sees a
+ * reference twice.
  *
  */
-class GridRefManager : public RefManager<GridRefManager<OBJECT>, OBJECT>
+class GridRefManager
 {
+        friend class GridReference<OBJECT>;
+
+        typedef std::vector<GridReference<OBJECT>*> ReferenceArray;
+
     public:
 
         /**
-         * @brief
+         * @brief Walks the array from the last slot down to the first
+         *
+         * Any reference may be unlinked during the walk, references not yet
+         * visited are then skipped. References linked during the walk are
+         * not visited.
          *
          */
-        typedef LinkedListHead::Iterator< GridReference<OBJECT> > iterator;
+        class iterator
+        {
+            public:
+                /**
+                 * @brief
+                 *
+                 */
+                iterator() : iManager(NULL), iPos(0) {}
+                /**
+                 * @brief
+                 *
+                 * @param manager
+                 * @param pos one past the slot of the current reference, 0 at end
+                 */
+                iterator(GridRefManager* manager, size_t pos) : iManager(manager), iPos(pos)
+                {
+                    ++iManager->iWalks;
+                    skipUnlinked();
+                }
+                /**
+                 * @brief
+                 *
+                 * @param other
+                 */
+                iterator(iterator const& other) : iManager(other.iManager), iPos(other.iPos)
+                {
+                    if (iManager)
+                        { ++iManager->iWalks; }
+                }
+                /**
+                 * @brief
+                 *
+                 */
+                ~iterator()
+                {
+                    if (iManager)
+                        { iManager->endWalk(); }
+                }
+
+                /**
+                 * @brief
+                 *
+                 * @param other
+                 * @return iterator
+                 */
+                iterator& operator=(iterator const& other)
+                {
+                    if (other.iManager)
+                        { ++other.iManager->iWalks; }
+                    if (iManager)
+                        { iManager->endWalk(); }
+
+                    iManager = other.iManager;
+                    iPos = other.iPos;
+                    return *this;
+                }
+
+                /**
+                 * @brief
+                 *
+                 * @return GridReference<OBJECT>
+                 */
+                GridReference<OBJECT>* operator->() const { return iManager->iRefs[iPos - 1]; }
+                /**
+                 * @brief
+                 *
+                 * @return GridReference<OBJECT>
+                 */
+                GridReference<OBJECT>& operator*() const { return *iManager->iRefs[iPos - 1]; }
+
+                /**
+                 * @brief
+                 *
+                 * @return iterator
+                 */
+                iterator& operator++()
+                {
+                    // the array only grows while iterators exist, except by clearReferences
+                    size_t size = iManager->iRefs.size();
+                    iPos = iPos - 1 < size ? iPos - 1 : size;
+                    skipUnlinked();
+                    return *this;
+                }
+                /**
+                 * @brief
+                 *
+                 * @param int
+                 * @return iterator
+                 */
+                iterator operator++(int)
+                {
+                    iterator tmp = *this;
+                    ++*this;
+                    return tmp;
+                }
+
+                /**
+                 * @brief
+                 *
+                 * @param other
+                 * @return bool
+                 */
+                bool operator==(iterator const& other) const { return iPos == other.iPos; }
+                /**
+                 * @brief
+                 *
+                 * @param other
+                 * @return bool
+                 */
+                bool operator!=(iterator const& other) const { return iPos != other.iPos; }
+
+            private:
+                void skipUnlinked()
+                {
+                    while (iPos > 0 && !iManager->iRefs[iPos - 1])
+                        { --iPos; }
+                }
+
+                GridRefManager* iManager; /**< TODO */
+                size_t iPos; /**< TODO */
+        };
 
         /**
          * @brief
          *
-         * @return GridReference<OBJECT>
          */
-        GridReference<OBJECT>* getFirst()
-        {
-            return (GridReference<OBJECT>*)RefManager<GridRefManager<OBJECT>, OBJECT>::getFirst();
-        }
-
+        GridRefManager() : iCount(0), iWalks(0) {}
         /**
          * @brief
          *
+         */
+        virtual ~GridRefManager() { clearReferences(); }
+
+        /**
+         * @brief the reference visited first
+         *
+         * @return GridReference<OBJECT>
+         */
+        GridReference<OBJECT>* getFirst() { return findLinked(iRefs.size()); }
+        /**
+         * @brief the reference visited last
+         *
          * @return GridReference<OBJECT>
          */
         GridReference<OBJECT>* getLast()
         {
-            return (GridReference<OBJECT>*)RefManager<GridRefManager<OBJECT>, OBJECT>::getLast();
+            for (typename ReferenceArray::const_iterator itr = iRefs.begin(); itr != iRefs.end(); ++itr)
+            {
+                if (*itr)
+                    { return *itr; }
+            }
+
+            return NULL;
         }
 
         /**
@@ -69,24 +216,120 @@ class GridRefManager : public RefManager<GridRefManager<OBJECT>, OBJECT>
          *
          * @return iterator
          */
-        iterator begin() { return iterator(getFirst()); }
+        iterator begin() { return iterator(this, iRefs.size()); }
         /**
          * @brief
          *
          * @return iterator
          */
-        iterator end() { return iterator(NULL); }
+        iterator end() { return iterator(this, 0); }
+
         /**
          * @brief
          *
-         * @return iterator
+         * @return bool
          */
-        iterator rbegin() { return iterator(getLast()); }
+        bool isEmpty() const { return iCount == 0; }
+        /**
+         * @brief
+         *
+         * @return uint32
+         */
+        uint32 getSize() const { return uint32(iCount); }
+
         /**
          * @brief
          *
-         * @return iterator
          */
-        iterator rend() { return iterator(NULL); }
+        void clearReferences()
+        {
+            for (typename ReferenceArray::const_iterator itr = iRefs.begin(); itr != iRefs.end(); ++itr)
+            {
+                if (*itr)
+                    { (*itr)->invalidate(); }
+            }
+
+            iRefs.clear();
+            iCount = 0;
+        }
+
+    private:
+
+        /**
+         * @brief the linked reference in the highest slot below pos
+         *
+         * @param pos
+         * @return GridReference<OBJECT>
+         */
+        GridReference<OBJECT>* findLinked(size_t pos) const
+        {
+            while (pos > 0)
+            {
+                if (GridReference<OBJECT>* ref = iRefs[--pos])
+                    { return ref; }
+            }
+
+            return NULL;
+        }
+
+        /**
+         * @brief called from GridReference::link()
+         *
+         * @param ref
+         */
+        void insertReference(GridReference<OBJECT>* ref)
+        {
+            ref->iIndex = iRefs.size();
+            iRefs.push_back(ref);
+            ++iCount;
+        }
+
+        /**
+         * @brief called from GridReference::unlink()
+         *
+         * @param ref
+         */
+        void removeReference(GridReference<OBJECT>* ref)
+        {
+            --iCount;
+
+            // moving a reference would let a walk visit it again or skip it
+            if (iWalks)
+            {
+                iRefs[ref->iIndex] = NULL;
+                return;
+            }
+
+            GridReference<OBJECT>* last = iRefs.back();
+            last->iIndex = ref->iIndex;
+            iRefs[ref->iIndex] = last;
+            iRefs.pop_back();
+        }
+
+        /**
+         * @brief an iterator is gone, compacts the slots cleared during the walks after the last one
+         *
+         */
+        void endWalk()
+        {
+            if (--iWalks || iCount == iRefs.size())
+                { return; }
+
+            size_t count = 0;
+            for (size_t i = 0; i < iRefs.size(); ++i)
+            {
+                if (GridReference<OBJECT>* ref = iRefs[i])
+                {
+                    ref->iIndex = count;
+                    iRefs[count++] = ref;
+                }
+            }
+
+            iRefs.resize(count);
+        }
+
+        ReferenceArray iRefs; /**< TODO */
+        size_t iCount; /**< linked references, iRefs has cleared slots during walks */
+        uint32 iWalks; /**< existing iterators */
 };
 #endif
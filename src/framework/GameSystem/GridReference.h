@@ -25,78 +25,120 @@
 #ifndef MANGOS_H_GRIDREFERENCE
 #define MANGOS_H_GRIDREFERENCE
 
-#include "Utilities/LinkedReference/Reference.h"
+#include "Platform/Define.h"
+
+#include <cassert>
+#include <cstddef>
 
 template<class OBJECT> class GridRefManager;
 
 template<class OBJECT>
 /**
- * @brief
+ * @brief Membership of an object in the dense array of a GridRefManager
+ *
+ * The reference knows its slot in the array of the manager, so unlinking is a
+ * swap with the last slot (or clearing the slot during walks) instead of a list walk.
  *
  */
-class MANGOS_DLL_SPEC GridReference : public Reference<GridRefManager<OBJECT>, OBJECT>
+class MANGOS_DLL_SPEC GridReference
 {
-    protected:
+        friend class GridRefManager<OBJECT>;
+
+    private:
+
+        GridRefManager<OBJECT>* iRefTo; /**< TODO */
+        OBJECT* iRefFrom; /**< TODO */
+        size_t iIndex; /**< slot in the array of iRefTo */
+
+        /**
+         * @brief Link is invalid due to destruction of the manager, iRefFrom must remain
+         *
+         */
+        void invalidate() { iRefTo = NULL; }
 
+    public:
         /**
          * @brief
          *
          */
-        void targetObjectBuildLink() override
+        GridReference()
+            : iRefTo(NULL), iRefFrom(NULL), iIndex(0)
         {
-            // called from link()
-            this->getTarget()->insertFirst(this);
-            this->getTarget()->incSize();
         }
 
         /**
          * @brief
          *
          */
-        void targetObjectDestroyLink() override
+        ~GridReference()
         {
-            // called from unlink()
-            if (this->isValid())
-                { this->getTarget()->decSize(); }
+            this->unlink();
         }
 
         /**
-         * @brief
+         * @brief Create new link
          *
+         * @param toObj
+         * @param fromObj
          */
-        void sourceObjectDestroyLink() override
+        void link(GridRefManager<OBJECT>* toObj, OBJECT* fromObj)
         {
-            // called from invalidate()
-            this->getTarget()->decSize();
+            assert(fromObj);                                // fromObj MUST not be NULL
+            if (isValid())
+                { unlink(); }
+
+            if (toObj != NULL)
+            {
+                iRefTo = toObj;
+                iRefFrom = fromObj;
+                toObj->insertReference(this);
+            }
         }
 
-    public:
         /**
-         * @brief
+         * @brief We don't need the reference anymore.
          *
          */
-        GridReference()
-            : Reference<GridRefManager<OBJECT>, OBJECT>()
+        void unlink()
         {
+            if (isValid())
+                { iRefTo->removeReference(this); }
+
+            iRefTo = NULL;
+            iRefFrom = NULL;
         }
 
         /**
          * @brief
          *
+         * @return bool
          */
-        ~GridReference()
+        bool isValid() const                                // Only check the iRefTo
         {
-            this->unlink();
+            return iRefTo != NULL;
         }
 
         /**
          * @brief
          *
+         * @return GridRefManager<OBJECT>
+         */
+        GridRefManager<OBJECT>* getTarget() const { return iRefTo; }
+        /**
+         * @brief
+         *
+         * @return OBJECT
+         */
+        OBJECT* getSource() const { return iRefFrom; }
+
+        /**
+         * @brief the reference visited after this one by the iterator of the manager
+         *
          * @return GridReference
          */
-        GridReference* next()
+        GridReference* next() const
         {
-            return (GridReference*)Reference<GridRefManager<OBJECT>, OBJECT>::next();
+            return isValid() ? iRefTo->findLinked(iIndex) : NULL;
         }
 };
 
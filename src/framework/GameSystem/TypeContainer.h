@@ -68,6 +68,42 @@ struct ContainerUnorderedMap< TypeList<H, T>, KEY_TYPE >
     ContainerUnorderedMap<T, KEY_TYPE> _TailElements; /**< TODO */
 };
 
+template<class SPECIFIC_TYPE, class OBJECT_TYPES, class KEY_TYPE>
+/**
+ * @brief compile time lookup of the map of SPECIFIC_TYPE in a ContainerUnorderedMap
+ *
+ * A type not in the list ends at the TypeNull specialization, which has no map.
+ *
+ */
+struct ContainerUnorderedMapIndex;
+
+template<class SPECIFIC_TYPE, class KEY_TYPE>
+struct ContainerUnorderedMapIndex<SPECIFIC_TYPE, TypeNull, KEY_TYPE>
+{
+    typedef UNORDERED_MAP<KEY_TYPE, SPECIFIC_TYPE*> Map;
+
+    static Map* Get(ContainerUnorderedMap<TypeNull, KEY_TYPE>& /*elements*/) { return NULL; }
+};
+
+template<class SPECIFIC_TYPE, class T, class KEY_TYPE>
+struct ContainerUnorderedMapIndex<SPECIFIC_TYPE, TypeList<SPECIFIC_TYPE, T>, KEY_TYPE>
+{
+    typedef UNORDERED_MAP<KEY_TYPE, SPECIFIC_TYPE*> Map;
+
+    static Map* Get(ContainerUnorderedMap<TypeList<SPECIFIC_TYPE, T>, KEY_TYPE>& elements) { return &elements._elements._element; }
+};
+
+template<class SPECIFIC_TYPE, class H, class T, class KEY_TYPE>
+struct ContainerUnorderedMapIndex<SPECIFIC_TYPE, TypeList<H, T>, KEY_TYPE>
+{
+    typedef UNORDERED_MAP<KEY_TYPE, SPECIFIC_TYPE*> Map;
+
+    static Map* Get(ContainerUnorderedMap<TypeList<H, T>, KEY_TYPE>& elements)
+    {
+        return ContainerUnorderedMapIndex<SPECIFIC_TYPE, T, KEY_TYPE>::Get(elements._TailElements);
+    }
+};
+
 template < class OBJECT_TYPES, class KEY_TYPE = OBJECT_HANDLE >
 /**
  * @brief
@@ -87,56 +123,14 @@ class TypeUnorderedMapContainer
          */
         bool insert(KEY_TYPE handle, SPECIFIC_TYPE* obj)
         {
-            return TypeUnorderedMapContainer::insert(i_elements, handle, obj);
-        }
-
-        template<class SPECIFIC_TYPE>
-        /**
-         * @brief
-         *
-         * @param handle
-         * @param
-         * @return bool
-         */
-        bool erase(KEY_TYPE handle, SPECIFIC_TYPE* /*obj*/)
-        {
-            return TypeUnorderedMapContainer::erase(i_elements, handle, (SPECIFIC_TYPE*)NULL);
-        }
-
-        template<class SPECIFIC_TYPE>
-        /**
-         * @brief
-         *
-         * @param hdl
-         * @param
-         * @return SPECIFIC_TYPE
-         */
-        SPECIFIC_TYPE* find(KEY_TYPE hdl, SPECIFIC_TYPE* /*obj*/)
-        {
-            return TypeUnorderedMapContainer::find(i_elements, hdl, (SPECIFIC_TYPE*)NULL);
-        }
-
-    private:
-
-        ContainerUnorderedMap<OBJECT_TYPES, KEY_TYPE> i_elements; /**< TODO */
+            typename Index<SPECIFIC_TYPE>::Map* elements = Index<SPECIFIC_TYPE>::Get(i_elements);
+            if (!elements)
+                { return false; }
 
-        // Helpers
-        template<class SPECIFIC_TYPE>
-        /**
-         * @brief Insert helpers
-         *
-         * @param ContainerUnorderedMap<SPECIFIC_TYPE
-         * @param elements
-         * @param handle
-         * @param obj
-         * @return bool
-         */
-        static bool insert(ContainerUnorderedMap<SPECIFIC_TYPE, KEY_TYPE>& elements, KEY_TYPE handle, SPECIFIC_TYPE* obj)
-        {
-            typename UNORDERED_MAP<KEY_TYPE, SPECIFIC_TYPE*>::iterator i = elements._element.find(handle);
-            if (i == elements._element.end())
+            typename Index<SPECIFIC_TYPE>::Map::iterator i = elements->find(handle);
+            if (i == elements->end())
             {
-                elements._element[handle] = obj;
+                (*elements)[handle] = obj;
                 return true;
             }
             else
@@ -150,180 +144,44 @@ class TypeUnorderedMapContainer
         /**
          * @brief
          *
-         * @param ContainerUnorderedMap<TypeNull
-         * @param
-         * @param KEY_TYPE
-         * @param
-         * @return bool
-         */
-        static bool insert(ContainerUnorderedMap<TypeNull, KEY_TYPE>& /*elements*/, KEY_TYPE /*handle*/, SPECIFIC_TYPE* /*obj*/)
-        {
-            return false;
-        }
-
-        template<class SPECIFIC_TYPE, class T>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<T
-         * @param
-         * @param KEY_TYPE
+         * @param handle
          * @param
          * @return bool
          */
-        static bool insert(ContainerUnorderedMap<T, KEY_TYPE>& /*elements*/, KEY_TYPE /*handle*/, SPECIFIC_TYPE* /*obj*/)
+        bool erase(KEY_TYPE handle, SPECIFIC_TYPE* /*obj*/)
         {
-            return false;
-        }
+            typename Index<SPECIFIC_TYPE>::Map* elements = Index<SPECIFIC_TYPE>::Get(i_elements);
+            if (!elements)
+                { return false; }
 
-        template<class SPECIFIC_TYPE, class H, class T>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<TypeList<H
-         * @param T>
-         * @param elements
-         * @param handle
-         * @param obj
-         * @return bool
-         */
-        static bool insert(ContainerUnorderedMap< TypeList<H, T>, KEY_TYPE >& elements, KEY_TYPE handle, SPECIFIC_TYPE* obj)
-        {
-            bool ret = TypeUnorderedMapContainer::insert(elements._elements, handle, obj);
-            return ret ? ret : TypeUnorderedMapContainer::insert(elements._TailElements, handle, obj);
+            elements->erase(handle);
+            return true;
         }
 
-        // Find helpers
         template<class SPECIFIC_TYPE>
         /**
          * @brief
          *
-         * @param ContainerUnorderedMap<SPECIFIC_TYPE
-         * @param elements
          * @param hdl
          * @param
          * @return SPECIFIC_TYPE
          */
-        static SPECIFIC_TYPE* find(ContainerUnorderedMap<SPECIFIC_TYPE, KEY_TYPE>& elements, KEY_TYPE hdl, SPECIFIC_TYPE* /*obj*/)
+        SPECIFIC_TYPE* find(KEY_TYPE hdl, SPECIFIC_TYPE* /*obj*/)
         {
-            typename UNORDERED_MAP<KEY_TYPE, SPECIFIC_TYPE*>::iterator i = elements._element.find(hdl);
-            if (i == elements._element.end())
+            typename Index<SPECIFIC_TYPE>::Map* elements = Index<SPECIFIC_TYPE>::Get(i_elements);
+            if (!elements)
                 { return NULL; }
-            else
-                { return i->second; }
-        }
-
-        template<class SPECIFIC_TYPE>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<TypeNull
-         * @param
-         * @param KEY_TYPE
-         * @param
-         * @return SPECIFIC_TYPE
-         */
-        static SPECIFIC_TYPE* find(ContainerUnorderedMap<TypeNull, KEY_TYPE>& /*elements*/, KEY_TYPE /*hdl*/, SPECIFIC_TYPE* /*obj*/)
-        {
-            return NULL;
-        }
-
-        template<class SPECIFIC_TYPE, class T>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<T
-         * @param
-         * @param KEY_TYPE
-         * @param
-         * @return SPECIFIC_TYPE
-         */
-        static SPECIFIC_TYPE* find(ContainerUnorderedMap<T, KEY_TYPE>& /*elements*/, KEY_TYPE /*hdl*/, SPECIFIC_TYPE* /*obj*/)
-        {
-            return NULL;
-        }
 
-        template<class SPECIFIC_TYPE, class H, class T>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<TypeList<H
-         * @param T>
-         * @param elements
-         * @param hdl
-         * @param
-         * @return SPECIFIC_TYPE
-         */
-        static SPECIFIC_TYPE* find(ContainerUnorderedMap< TypeList<H, T>, KEY_TYPE >& elements, KEY_TYPE hdl, SPECIFIC_TYPE* /*obj*/)
-        {
-            SPECIFIC_TYPE* ret = TypeUnorderedMapContainer::find(elements._elements, hdl, (SPECIFIC_TYPE*)NULL);
-            return ret ? ret : TypeUnorderedMapContainer::find(elements._TailElements, hdl, (SPECIFIC_TYPE*)NULL);
+            typename Index<SPECIFIC_TYPE>::Map::iterator i = elements->find(hdl);
+            return i != elements->end() ? i->second : NULL;
         }
 
-        // Erase helpers
-        template<class SPECIFIC_TYPE>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<SPECIFIC_TYPE
-         * @param elements
-         * @param handle
-         * @param
-         * @return bool
-         */
-        static bool erase(ContainerUnorderedMap<SPECIFIC_TYPE, KEY_TYPE>& elements, KEY_TYPE handle, SPECIFIC_TYPE* /*obj*/)
-        {
-            elements._element.erase(handle);
-
-            return true;
-        }
+    private:
 
         template<class SPECIFIC_TYPE>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<TypeNull
-         * @param
-         * @param KEY_TYPE
-         * @param
-         * @return bool
-         */
-        static bool erase(ContainerUnorderedMap<TypeNull, KEY_TYPE>& /*elements*/, KEY_TYPE /*handle*/, SPECIFIC_TYPE* /*obj*/)
-        {
-            return false;
-        }
+        struct Index : public ContainerUnorderedMapIndex<SPECIFIC_TYPE, OBJECT_TYPES, KEY_TYPE> {};
 
-        template<class SPECIFIC_TYPE, class T>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<T
-         * @param
-         * @param KEY_TYPE
-         * @param
-         * @return bool
-         */
-        static bool erase(ContainerUnorderedMap<T, KEY_TYPE>& /*elements*/, KEY_TYPE /*handle*/, SPECIFIC_TYPE* /*obj*/)
-        {
-            return false;
-        }
-
-        template<class SPECIFIC_TYPE, class H, class T>
-        /**
-         * @brief
-         *
-         * @param ContainerUnorderedMap<TypeList<H
-         * @param T>
-         * @param elements
-         * @param handle
-         * @param
-         * @return bool
-         */
-        static bool erase(ContainerUnorderedMap< TypeList<H, T>, KEY_TYPE >& elements, KEY_TYPE handle, SPECIFIC_TYPE* /*obj*/)
-        {
-            bool ret = TypeUnorderedMapContainer::erase(elements._elements, handle, (SPECIFIC_TYPE*)NULL);
-            return ret ? ret : TypeUnorderedMapContainer::erase(elements._TailElements, handle, (SPECIFIC_TYPE*)NULL);
-        }
+        ContainerUnorderedMap<OBJECT_TYPES, KEY_TYPE> i_elements; /**< TODO */
 };
 
 template<class OBJECT>
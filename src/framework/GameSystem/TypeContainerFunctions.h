@@ -29,194 +29,103 @@
  * Here you'll find a list of helper functions to make
  * the TypeContainer usefull.  Without it, its hard
  * to access or mutate the container.
+ *
+ * The list of a type is found by ContainerMapListIndex at compile time, once per
+ * type and type list, instead of the overload resolution of every helper at every
+ * level of the type list.
  */
 
 #include "Platform/Define.h"
 #include "Utilities/TypeList.h"
-#include <map>
 
-namespace MaNGOS
+template<class SPECIFIC_TYPE, class OBJECT_TYPES>
+/**
+ * @brief compile time lookup of the list of SPECIFIC_TYPE in a ContainerMapList
+ *
+ * A type not in the list ends at the TypeNull specialization, which has no list.
+ *
+ */
+struct ContainerMapListIndex;
+
+template<class SPECIFIC_TYPE>
+struct ContainerMapListIndex<SPECIFIC_TYPE, TypeNull>
 {
-    /* ContainerMapList Helpers */
-    template<class SPECIFIC_TYPE>
-    /**
-     * @brief count functions
-     *
-     * @param elements
-     * @param
-     * @return size_t
-     */
-    size_t Count(const ContainerMapList<SPECIFIC_TYPE>& elements, SPECIFIC_TYPE* /*fake*/)
-    {
-        return elements._element.getSize();
-    }
+    static GridRefManager<SPECIFIC_TYPE>* Get(ContainerMapList<TypeNull>& /*elements*/) { return NULL; }
+    static GridRefManager<SPECIFIC_TYPE> const* Get(ContainerMapList<TypeNull> const& /*elements*/) { return NULL; }
+};
 
-    template<class SPECIFIC_TYPE>
-    /**
-     * @brief
-     *
-     * @param
-     * @param
-     * @return size_t
-     */
-    size_t Count(const ContainerMapList<TypeNull>& /*elements*/, SPECIFIC_TYPE* /*fake*/)
-    {
-        return 0;
-    }
+template<class SPECIFIC_TYPE, class T>
+struct ContainerMapListIndex<SPECIFIC_TYPE, TypeList<SPECIFIC_TYPE, T> >
+{
+    static GridRefManager<SPECIFIC_TYPE>* Get(ContainerMapList<TypeList<SPECIFIC_TYPE, T> >& elements) { return &elements._elements._element; }
+    static GridRefManager<SPECIFIC_TYPE> const* Get(ContainerMapList<TypeList<SPECIFIC_TYPE, T> > const& elements) { return &elements._elements._element; }
+};
 
-    template<class SPECIFIC_TYPE, class T>
-    /**
-     * @brief
-     *
-     * @param
-     * @param
-     * @return size_t
-     */
-    size_t Count(const ContainerMapList<T>& /*elements*/, SPECIFIC_TYPE* /*fake*/)
+template<class SPECIFIC_TYPE, class H, class T>
+struct ContainerMapListIndex<SPECIFIC_TYPE, TypeList<H, T> >
+{
+    static GridRefManager<SPECIFIC_TYPE>* Get(ContainerMapList<TypeList<H, T> >& elements)
     {
-        return 0;
+        return ContainerMapListIndex<SPECIFIC_TYPE, T>::Get(elements._TailElements);
     }
 
-    template<class SPECIFIC_TYPE, class T>
-    /**
-     * @brief
-     *
-     * @param ContainerMapList<TypeList<SPECIFIC_TYPE
-     * @param elements
-     * @param fake
-     * @return size_t
-     */
-    size_t Count(const ContainerMapList<TypeList<SPECIFIC_TYPE, T> >& elements, SPECIFIC_TYPE* fake)
+    static GridRefManager<SPECIFIC_TYPE> const* Get(ContainerMapList<TypeList<H, T> > const& elements)
     {
-        return Count(elements._elements, fake);
+        return ContainerMapListIndex<SPECIFIC_TYPE, T>::Get(elements._TailElements);
     }
+};
 
-    template<class SPECIFIC_TYPE, class H, class T>
+namespace MaNGOS
+{
+    /* ContainerMapList Helpers */
+    template<class SPECIFIC_TYPE, class OBJECT_TYPES>
     /**
-     * @brief
+     * @brief count functions
      *
-     * @param ContainerMapList<TypeList<H
      * @param elements
-     * @param fake
-     * @return size_t
+     * @param
+     * @return size_t 0 for a type not in the list
      */
-    size_t Count(const ContainerMapList<TypeList<H, T> >& elements, SPECIFIC_TYPE* fake)
+    size_t Count(const ContainerMapList<OBJECT_TYPES>& elements, SPECIFIC_TYPE* /*fake*/)
     {
-        return Count(elements._TailElements, fake);
+        GridRefManager<SPECIFIC_TYPE> const* list = ContainerMapListIndex<SPECIFIC_TYPE, OBJECT_TYPES>::Get(elements);
+        return list ? list->getSize() : 0;
     }
 
-    // non-const insert functions
-    template<class SPECIFIC_TYPE>
+    template<class SPECIFIC_TYPE, class OBJECT_TYPES>
     /**
-     * @brief
+     * @brief non-const insert function
      *
      * @param elements
      * @param obj
-     * @return SPECIFIC_TYPE
+     * @return SPECIFIC_TYPE NULL for a type not in the list
      */
-    SPECIFIC_TYPE* Insert(ContainerMapList<SPECIFIC_TYPE>& elements, SPECIFIC_TYPE* obj)
+    SPECIFIC_TYPE* Insert(ContainerMapList<OBJECT_TYPES>& elements, SPECIFIC_TYPE* obj)
     {
-        // elements._element[hdl] = obj;
-        obj->GetGridRef().link(&elements._element, obj);
-        return obj;
-    }
+        GridRefManager<SPECIFIC_TYPE>* list = ContainerMapListIndex<SPECIFIC_TYPE, OBJECT_TYPES>::Get(elements);
+        if (!list)
+            { return NULL; }                                // a missed
 
-    template<class SPECIFIC_TYPE>
-    /**
-     * @brief
-     *
-     * @param
-     * @param
-     * @return SPECIFIC_TYPE
-     */
-    SPECIFIC_TYPE* Insert(ContainerMapList<TypeNull>& /*elements*/, SPECIFIC_TYPE* /*obj*/)
-    {
-        return NULL;
-    }
-
-    template<class SPECIFIC_TYPE, class T>
-    /**
-     * @brief this is a missed
-     *
-     * @param
-     * @param
-     * @return SPECIFIC_TYPE
-     */
-    SPECIFIC_TYPE* Insert(ContainerMapList<T>& /*elements*/, SPECIFIC_TYPE* /*obj*/)
-    {
-        return NULL;                                        // a missed
+        obj->GetGridRef().link(list, obj);
+        return obj;
     }
 
-    template<class SPECIFIC_TYPE, class H, class T>
+    template<class SPECIFIC_TYPE, class OBJECT_TYPES>
     /**
-     * @brief Recursion
+     * @brief non-const remove method
      *
-     * @param ContainerMapList<TypeList<H
      * @param elements
      * @param obj
-     * @return SPECIFIC_TYPE
+     * @return SPECIFIC_TYPE NULL for a type not in the list
      */
-    SPECIFIC_TYPE* Insert(ContainerMapList<TypeList<H, T> >& elements, SPECIFIC_TYPE* obj)
+    SPECIFIC_TYPE* Remove(ContainerMapList<OBJECT_TYPES>& elements, SPECIFIC_TYPE* obj)
     {
-        SPECIFIC_TYPE* t = Insert(elements._elements, obj);
-        return (t != NULL ? t : Insert(elements._TailElements, obj));
-    }
+        if (!ContainerMapListIndex<SPECIFIC_TYPE, OBJECT_TYPES>::Get(elements))
+            { return NULL; }                                // a missed
 
-    template<class SPECIFIC_TYPE>
-    /**
-     * @brief non-const remove method
-     *
-     * @param
-     * @param obj
-     * @return SPECIFIC_TYPE
-     */
-    SPECIFIC_TYPE* Remove(ContainerMapList<SPECIFIC_TYPE>& /*elements*/, SPECIFIC_TYPE* obj)
-    {
         obj->GetGridRef().unlink();
         return obj;
     }
-
-    template<class SPECIFIC_TYPE>
-    /**
-     * @brief
-     *
-     * @param
-     * @param
-     * @return SPECIFIC_TYPE
-     */
-    SPECIFIC_TYPE* Remove(ContainerMapList<TypeNull>& /*elements*/, SPECIFIC_TYPE* /*obj*/)
-    {
-        return NULL;
-    }
-
-    template<class SPECIFIC_TYPE, class T>
-    /**
-     * @brief this is a missed
-     *
-     * @param
-     * @param
-     * @return SPECIFIC_TYPE
-     */
-    SPECIFIC_TYPE* Remove(ContainerMapList<T>& /*elements*/, SPECIFIC_TYPE* /*obj*/)
-    {
-        return NULL;                                        // a missed
-    }
-
-    template<class SPECIFIC_TYPE, class T, class H>
-    /**
-     * @brief
-     *
-     * @param ContainerMapList<TypeList<H
-     * @param elements
-     * @param obj
-     * @return SPECIFIC_TYPE
-     */
-    SPECIFIC_TYPE* Remove(ContainerMapList<TypeList<H, T> >& elements, SPECIFIC_TYPE* obj)
-    {
-        // The head element is bad
-        SPECIFIC_TYPE* t = Remove(elements._elements, obj);
-        return (t != NULL ? t : Remove(elements._TailElements, obj));
-    }
 }
 
 #endif
@@ -27,7 +27,7 @@
 
 /*
  * @class TypeContainerVisitor is implemented as a visitor pattern.  It is
- * a visitor to the TypeMapContainer or ContainerMapList.  The visitor has
+ * a visitor to the TypeMapContainer.  The visitor has
  * to overload its types as a visit method is called.
  */
 
@@ -37,54 +37,31 @@
 // forward declaration
 template<class T, class Y> class TypeContainerVisitor;
 
-template<class VISITOR, class TYPE_CONTAINER>
+template<class VISITOR, class OBJECT_TYPES>
 /**
- * @brief visitor helper
+ * @brief visitor helper, hands the list of every type of a ContainerMapList to the visitor
  *
- * @param v
- * @param c
- */
-void VisitorHelper(VISITOR& v, TYPE_CONTAINER& c)
-{
-    v.Visit(c);
-}
-
-template<class VISITOR>
-/**
- * @brief terminate condition container map list
+ * One instantiation per visitor and level of the type list, the visitor has to overload
+ * Visit(GridRefManager<T>&) for the types it is interested in.
  *
- * @param
- * @param
  */
-void VisitorHelper(VISITOR& /*v*/, ContainerMapList<TypeNull>& /*c*/)
-{
-}
+struct ContainerMapListVisitor;
 
-template<class VISITOR, class T>
-/**
- * @brief
- *
- * @param v
- * @param c
- */
-void VisitorHelper(VISITOR& v, ContainerMapList<T>& c)
+template<class VISITOR>
+struct ContainerMapListVisitor<VISITOR, TypeNull>
 {
-    v.Visit(c._element);
-}
+    static void Visit(VISITOR& /*v*/, ContainerMapList<TypeNull>& /*c*/) {}
+};
 
 template<class VISITOR, class H, class T>
-/**
- * @brief recursion container map list
- *
- * @param v
- * @param ContainerMapList<TypeList<H
- * @param c
- */
-void VisitorHelper(VISITOR& v, ContainerMapList<TypeList<H, T> >& c)
+struct ContainerMapListVisitor<VISITOR, TypeList<H, T> >
 {
-    VisitorHelper(v, c._elements);
-    VisitorHelper(v, c._TailElements);
-}
+    static void Visit(VISITOR& v, ContainerMapList<TypeList<H, T> >& c)
+    {
+        v.Visit(c._elements._element);
+        ContainerMapListVisitor<VISITOR, T>::Visit(v, c._TailElements);
+    }
+};
 
 template<class VISITOR, class OBJECT_TYPES>
 /**
@@ -95,7 +72,7 @@ template<class VISITOR, class OBJECT_TYPES>
  */
 void VisitorHelper(VISITOR& v, TypeMapContainer<OBJECT_TYPES>& c)
 {
-    VisitorHelper(v, c.GetElements());
+    ContainerMapListVisitor<VISITOR, OBJECT_TYPES>::Visit(v, c.GetElements());
 }
 
 template<class VISITOR, class TYPE_CONTAINER>
@@ -24,15 +24,60 @@
 
 #include "EventProcessor.h"
 
+#include <cstring>
+
+#define EVENT_WHEEL_LEVEL0_BITS 5                           // slots of one millisecond
+#define EVENT_WHEEL_LEVEL_BITS  4                           // slots of the upper levels
+#define EVENT_WHEEL_LEVELS      5                           // times up to 2^21 ms ahead, later ones wait in the overflow list
+
+#define EVENT_WHEEL_LEVEL0_SIZE (1 << EVENT_WHEEL_LEVEL0_BITS)
+#define EVENT_WHEEL_LEVEL_SIZE  (1 << EVENT_WHEEL_LEVEL_BITS)
+#define EVENT_WHEEL_SLOTS       (EVENT_WHEEL_LEVEL0_SIZE + (EVENT_WHEEL_LEVELS - 1) * EVENT_WHEEL_LEVEL_SIZE)
+
+/**
+ * @brief slots of the timer wheel of one processor
+ *
+ * A level 0 slot holds the events of one millisecond within the next EVENT_WHEEL_LEVEL0_SIZE ms,
+ * a slot of an upper level the events of a range of the lower level, moved down when the wheel
+ * time reaches the range.
+ */
+struct EventWheel
+{
+    EventWheel() : level0Mask(0), overflow(NULL)
+    {
+        memset(slots, 0, sizeof(slots));
+    }
+
+    BasicEvent* slots[EVENT_WHEEL_SLOTS];
+    uint32 level0Mask;                                      // level 0 slots with events
+    BasicEvent* overflow;
+};
+
+static inline uint32 GetLevelShift(uint32 level)
+{
+    return EVENT_WHEEL_LEVEL0_BITS + (level - 1) * EVENT_WHEEL_LEVEL_BITS;
+}
+
+static inline uint32 GetLevelSlot(uint32 level, uint64 time)
+{
+    return EVENT_WHEEL_LEVEL0_SIZE + (level - 1) * EVENT_WHEEL_LEVEL_SIZE + uint32(time >> GetLevelShift(level)) % EVENT_WHEEL_LEVEL_SIZE;
+}
+
 EventProcessor::EventProcessor()
 {
     m_time = 0;
+    m_wheelTime = 0;
+    m_wheel = NULL;
+    m_due = NULL;
+    m_wheelEvents = 0;
+    m_sequence = 0;
     m_aborting = false;
 }
 
 EventProcessor::~EventProcessor()
 {
     KillAllEvents(true);
+    delete m_wheel;
 }
 
 void EventProcessor::Update(uint32 p_time)
@@ -41,26 +86,67 @@ void EventProcessor::Update(uint32 p_time)
     m_time += p_time;
 
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    for (;;)
     {
-        // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
-
-        if (!Event->to_Abort)
+        if (m_due)
         {
-            if (Event->Execute(m_time, p_time))
+            // get and remove event from queue
+            BasicEvent* Event = m_due;
+            m_due = Event->m_nextEvent;
+            Event->m_nextEvent = NULL;
+
+            if (!Event->to_Abort)
             {
-                // completely destroy event if it is not re-added
+                if (Event->Execute(m_time, p_time))
+                {
+                    // completely destroy event if it is not re-added
+                    delete Event;
+                }
+            }
+            else
+            {
+                Event->Abort(m_time);
                 delete Event;
             }
+            continue;
         }
-        else
+
+        if (m_wheelTime > m_time)
+            { break; }
+
+        if (!m_wheelEvents)
+        {
+            // nothing to cascade on the way
+            m_wheelTime = m_time + 1;
+            break;
+        }
+
+        // the events of the slot become due, events added meanwhile for this time follow them
+        uint32 index = uint32(m_wheelTime % EVENT_WHEEL_LEVEL0_SIZE);
+        while (BasicEvent* Event = m_wheel->slots[index])
         {
-            Event->Abort(m_time);
-            delete Event;
+            m_wheel->slots[index] = Event->m_nextEvent;
+            --m_wheelEvents;
+            ScheduleDue(Event);
         }
+        m_wheel->level0Mask &= ~(uint32(1) << index);
+
+        // step to the next slot with events or the end of the level 0 round, whichever is first
+        uint32 later = m_wheel->level0Mask & ~((uint32(2) << index) - 1);
+        uint64 roundStart = m_wheelTime - index;
+        uint64 next = roundStart + EVENT_WHEEL_LEVEL0_SIZE;
+        for (uint32 i = index + 1; later && i < EVENT_WHEEL_LEVEL0_SIZE; ++i)
+        {
+            if (later & (uint32(1) << i))
+            {
+                next = roundStart + i;
+                break;
+            }
+        }
+
+        m_wheelTime = next < m_time + 1 ? next : m_time + 1;
+        if (m_wheelTime % EVENT_WHEEL_LEVEL0_SIZE == 0)
+            { Cascade(); }
     }
 }
 
@@ -69,26 +155,20 @@ void EventProcessor::KillAllEvents(bool force)
     // prevent event insertions
     m_aborting = true;
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+    // first, abort all existing events, the kept ones are added again
+    BasicEvent* events = TakeAllEvents();
+    while (BasicEvent* Event = events)
     {
-        EventList::iterator i_old = i;
-        ++i;
-
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if (force || i_old->second->IsDeletable())
-        {
-            delete i_old->second;
+        events = Event->m_nextEvent;
+        Event->m_nextEvent = NULL;
 
-            if (!force)                                     // need per-element cleanup
-                { m_events.erase(i_old); }
-        }
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        if (force || Event->IsDeletable())
+            { delete Event; }
+        else
+            { Schedule(Event); }                            // need per-element cleanup
     }
-
-    // fast clear event list (in force case)
-    if (force)
-        { m_events.clear(); }
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
@@ -97,10 +177,106 @@ void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime
         { Event->m_addTime = m_time; }
 
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    Event->m_sequence = m_sequence++;
+    Schedule(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset)
 {
     return m_time + t_offset;
 }
+
+void EventProcessor::Schedule(BasicEvent* Event)
+{
+    if (Event->m_execTime < m_wheelTime)
+    {
+        ScheduleDue(Event);
+        return;
+    }
+
+    if (!m_wheel)
+        { m_wheel = new EventWheel; }
+
+    uint64 delay = Event->m_execTime - m_wheelTime;
+    BasicEvent** slot;
+
+    if (delay < EVENT_WHEEL_LEVEL0_SIZE)
+    {
+        uint32 index = uint32(Event->m_execTime % EVENT_WHEEL_LEVEL0_SIZE);
+        m_wheel->level0Mask |= uint32(1) << index;
+        slot = &m_wheel->slots[index];
+    }
+    else
+    {
+        slot = &m_wheel->overflow;
+        for (uint32 level = 1; level < EVENT_WHEEL_LEVELS; ++level)
+        {
+            if (delay < (uint64(1) << GetLevelShift(level + 1)))
+            {
+                slot = &m_wheel->slots[GetLevelSlot(level, Event->m_execTime)];
+                break;
+            }
+        }
+    }
+
+    // the order inside a slot is restored when its events become due
+    Event->m_nextEvent = *slot;
+    *slot = Event;
+    ++m_wheelEvents;
+}
+
+void EventProcessor::ScheduleDue(BasicEvent* Event)
+{
+    BasicEvent** pos = &m_due;
+    while (*pos && ((*pos)->m_execTime < Event->m_execTime ||
+                    ((*pos)->m_execTime == Event->m_execTime && int32((*pos)->m_sequence - Event->m_sequence) < 0)))
+        { pos = &(*pos)->m_nextEvent; }
+
+    Event->m_nextEvent = *pos;
+    *pos = Event;
+}
+
+void EventProcessor::Cascade()
+{
+    for (uint32 level = 1; level <= EVENT_WHEEL_LEVELS; ++level)
+    {
+        BasicEvent** slot = level < EVENT_WHEEL_LEVELS ? &m_wheel->slots[GetLevelSlot(level, m_wheelTime)] : &m_wheel->overflow;
+
+        BasicEvent* events = *slot;
+        *slot = NULL;
+        while (BasicEvent* Event = events)
+        {
+            events = Event->m_nextEvent;
+            --m_wheelEvents;
+            Schedule(Event);
+        }
+
+        // the next level moves down only at the end of a round of this one
+        if (level == EVENT_WHEEL_LEVELS || (m_wheelTime >> GetLevelShift(level)) % EVENT_WHEEL_LEVEL_SIZE != 0)
+            { break; }
+    }
+}
+
+BasicEvent* EventProcessor::TakeAllEvents()
+{
+    BasicEvent* events = m_due;
+    m_due = NULL;
+
+    if (!m_wheel)
+        { return events; }
+
+    for (uint32 i = 0; i <= EVENT_WHEEL_SLOTS; ++i)
+    {
+        BasicEvent** slot = i < EVENT_WHEEL_SLOTS ? &m_wheel->slots[i] : &m_wheel->overflow;
+        while (BasicEvent* Event = *slot)
+        {
+            *slot = Event->m_nextEvent;
+            Event->m_nextEvent = events;
+            events = Event;
+        }
+    }
+
+    m_wheel->level0Mask = 0;
+    m_wheelEvents = 0;
+    return events;
+}
@@ -27,14 +27,14 @@
 
 #include "Platform/Define.h"
 
-#include <map>
-
 /**
  * @brief Note. All times are in milliseconds here.
  *
  */
 class BasicEvent
 {
+        friend class EventProcessor;
+
     public:
 
         /**
@@ -42,7 +42,7 @@ class BasicEvent
          *
          */
         BasicEvent()
-            : to_Abort(false)
+            : to_Abort(false), m_nextEvent(NULL), m_sequence(0)
         {
         }
 
@@ -83,17 +83,20 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   /**< time when the event was added to queue, filled by event handler */
         uint64 m_execTime;                                  /**< planned time of next execution, filled by event handler */
+
+    private:
+        BasicEvent* m_nextEvent;                            /**< next event of the same wheel slot */
+        uint32 m_sequence;                                  /**< order of the AddEvent calls, events of the same time execute in it */
 };
 
-/**
- * @brief
- *
- */
-typedef std::multimap<uint64, BasicEvent*> EventList;
+struct EventWheel;
 
 /**
- * @brief
+ * @brief executes the events at their time, kept in a hierarchical timer wheel
  *
+ * The events are linked into the slots of the wheel through their own fields, adding one
+ * allocates nothing and takes constant time, an event is cancelled by setting to_Abort.
+ * Events of the same time execute in the order they were added.
  */
 class EventProcessor
 {
@@ -140,8 +143,36 @@ class EventProcessor
 
     protected:
 
+        /**
+         * @brief
+         *
+         * @param Event
+         */
+        void Schedule(BasicEvent* Event);
+        /**
+         * @brief puts an event into the due list, in the order of time and addition
+         *
+         * @param Event
+         */
+        void ScheduleDue(BasicEvent* Event);
+        /**
+         * @brief moves the events of the upper wheel levels into the lower ones at the wheel time
+         *
+         */
+        void Cascade();
+        /**
+         * @brief
+         *
+         * @return BasicEvent all events of the wheel and the due list, which are emptied
+         */
+        BasicEvent* TakeAllEvents();
+
         uint64 m_time; /**< TODO */
-        EventList m_events; /**< TODO */
+        uint64 m_wheelTime; /**< time of the next wheel slot to move into the due list */
+        EventWheel* m_wheel; /**< allocated at the first event of a later time */
+        BasicEvent* m_due; /**< events of a time passed already, executed at the next Update */
+        uint32 m_wheelEvents; /**< events in the wheel, not counting the due list */
+        uint32 m_sequence; /**< TODO */
         bool m_aborting; /**< TODO */
 };
 
@@ -0,0 +1,238 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_FLATHASHMAP_H
+#define MANGOS_FLATHASHMAP_H
+
+#include "Platform/Define.h"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief default hash of FlatHashMap for integer keys
+ *
+ */
+template<class Key>
+struct FlatHashMapHash
+{
+    uint32 operator()(Key key) const
+    {
+        uint32 hash = uint32(key) * 0x9E3779B1;             // spreads consecutive ids over the table
+        return hash ^ (hash >> 16);
+    }
+};
+
+/**
+ * @brief hash map keeping its entries in one vector, for big maps of static data
+ *
+ * The entries are stored one after another without per entry allocations, a table of
+ * entry indexes with linear probing finds them. Iteration walks the entry vector.
+ *
+ * Unlike UNORDERED_MAP, inserting can move all entries and erasing moves the last entry into
+ * the erased one, so pointers, references and iterators are only valid until the next insert or erase.
+ * The iteration order is the insertion order as long as nothing is erased.
+ */
+template<class Key, class T, class Hash = FlatHashMapHash<Key>, class KeyEqual = std::equal_to<Key> >
+class FlatHashMap
+{
+    public:
+        typedef Key key_type;
+        typedef T mapped_type;
+        typedef std::pair<Key, T> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+        typedef size_t size_type;
+
+        FlatHashMap() {}
+
+        iterator begin() { return m_values.begin(); }
+        iterator end() { return m_values.end(); }
+        const_iterator begin() const { return m_values.begin(); }
+        const_iterator end() const { return m_values.end(); }
+
+        size_type size() const { return m_values.size(); }
+        bool empty() const { return m_values.empty(); }
+
+        void clear()
+        {
+            // release the memory, the maps are cleared for reloading only
+            std::vector<value_type>().swap(m_values);
+            std::vector<uint32>().swap(m_slots);
+        }
+
+        /**
+         * @brief prepares the map for count entries, avoids moving the entries while loading
+         *
+         * @param count
+         */
+        void reserve(size_type count)
+        {
+            m_values.reserve(count);
+            if (SlotCountFor(count) > m_slots.size())
+                { Rehash(SlotCountFor(count)); }
+        }
+
+        iterator find(Key const& key)
+        {
+            uint32 slot = FindSlot(key);
+            return m_slots.empty() || !m_slots[slot] ? m_values.end() : m_values.begin() + (m_slots[slot] - 1);
+        }
+
+        const_iterator find(Key const& key) const
+        {
+            uint32 slot = FindSlot(key);
+            return m_slots.empty() || !m_slots[slot] ? m_values.end() : m_values.begin() + (m_slots[slot] - 1);
+        }
+
+        size_type count(Key const& key) const { return find(key) != end() ? 1 : 0; }
+
+        std::pair<iterator, bool> insert(value_type const& value)
+        {
+            if (SlotCountFor(m_values.size() + 1) > m_slots.size())
+                { Rehash(SlotCountFor(m_values.size() + 1)); }
+
+            uint32 slot = FindSlot(value.first);
+            if (m_slots[slot])
+                { return std::pair<iterator, bool>(m_values.begin() + (m_slots[slot] - 1), false); }
+
+            m_values.push_back(value);
+            m_slots[slot] = uint32(m_values.size());
+            return std::pair<iterator, bool>(m_values.end() - 1, true);
+        }
+
+        T& operator[](Key const& key)
+        {
+            iterator itr = find(key);
+            if (itr != m_values.end())
+                { return itr->second; }
+
+            return insert(value_type(key, T())).first->second;
+        }
+
+        size_type erase(Key const& key)
+        {
+            if (m_slots.empty())
+                { return 0; }
+
+            uint32 slot = FindSlot(key);
+            if (!m_slots[slot])
+                { return 0; }
+
+            EraseSlot(slot);
+            return 1;
+        }
+
+        /**
+         * @brief erases the entry, returns the iterator to continue an iteration with
+         *
+         * The last entry is moved to the place of the erased one, so the returned iterator
+         * is the same position and not the next one.
+         *
+         * @param itr
+         * @return iterator
+         */
+        iterator erase(iterator itr)
+        {
+            size_t index = itr - m_values.begin();
+            EraseSlot(FindSlot(itr->first));
+            return m_values.begin() + index;
+        }
+
+    private:
+        /// slot table size for count entries, at most 3/4 of the slots are used
+        static size_t SlotCountFor(size_t count)
+        {
+            size_t slots = 16;
+            while (slots * 3 < count * 4)
+                { slots *= 2; }
+            return slots;
+        }
+
+        uint32 HomeSlot(Key const& key) const { return Hash()(key) & uint32(m_slots.size() - 1); }
+
+        /// slot holding key or the empty slot where it belongs, m_slots must not be empty
+        uint32 FindSlot(Key const& key) const
+        {
+            if (m_slots.empty())
+                { return 0; }
+
+            uint32 mask = uint32(m_slots.size() - 1);
+            uint32 slot = HomeSlot(key);
+            while (m_slots[slot] && !KeyEqual()(m_values[m_slots[slot] - 1].first, key))
+                { slot = (slot + 1) & mask; }
+            return slot;
+        }
+
+        void Rehash(size_t slotCount)
+        {
+            m_slots.assign(slotCount, 0);
+            uint32 mask = uint32(slotCount - 1);
+
+            for (size_t i = 0; i < m_values.size(); ++i)
+            {
+                uint32 slot = HomeSlot(m_values[i].first);
+                while (m_slots[slot])
+                    { slot = (slot + 1) & mask; }
+                m_slots[slot] = uint32(i + 1);
+            }
+        }
+
+        void EraseSlot(uint32 slot)
+        {
+            uint32 index = m_slots[slot] - 1;
+            uint32 mask = uint32(m_slots.size() - 1);
+
+            // shift the following entries of the probe sequence back, no tombstones needed
+            uint32 hole = slot;
+            for (uint32 next = (hole + 1) & mask; m_slots[next]; next = (next + 1) & mask)
+            {
+                uint32 home = HomeSlot(m_values[m_slots[next] - 1].first);
+                // move the entry unless its home lies cyclically in (hole, next]
+                bool inRange = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+                if (!inRange)
+                {
+                    m_slots[hole] = m_slots[next];
+                    hole = next;
+                }
+            }
+            m_slots[hole] = 0;
+
+            // fill the gap in the entry vector with the last entry
+            uint32 last = uint32(m_values.size() - 1);
+            if (index != last)
+            {
+                m_slots[FindSlot(m_values[last].first)] = index + 1;
+                m_values[index] = m_values[last];
+            }
+            m_values.pop_back();
+        }
+
+        std::vector<value_type> m_values;
+        std::vector<uint32> m_slots;                        // index + 1 into m_values, 0 for an empty slot
+};
+
+#endif
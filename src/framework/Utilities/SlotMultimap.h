@@ -0,0 +1,258 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_SLOTMULTIMAP_H
+#define MANGOS_SLOTMULTIMAP_H
+
+#include "Platform/Define.h"
+#include "Utilities/FlatHashMap.h"
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief multimap of slots in one vector, for small often changed maps iterated while they change
+ *
+ * Inserts append a slot, erases only mark the slot as free, so iterators stay valid across inserts and
+ * erases and an iteration that erases entries just goes on with ++. The free slots are released by
+ * Compact(), which invalidates all iterators and must only be called where no iteration is running.
+ *
+ * Iteration walks the slots in insertion order. Entries of equal keys are chained in insertion order,
+ * equal_range() and find() follow that chain, ++ on an iterator from equal_range() stays on the key.
+ */
+template<class Key, class T, class Hash = FlatHashMapHash<Key> >
+class SlotMultimap
+{
+    private:
+        enum { NO_SLOT = 0xFFFFFFFF };                      // end of the slots and key chains
+
+    public:
+        typedef Key key_type;
+        typedef T mapped_type;
+        typedef std::pair<Key, T> value_type;
+        typedef size_t size_type;
+
+        /**
+         * @brief iterator over the used slots or the slots of one key
+         *
+         */
+        template<class Map, class Value>
+        class Iterator
+        {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef typename SlotMultimap::value_type value_type;
+                typedef ptrdiff_t difference_type;
+                typedef Value* pointer;
+                typedef Value& reference;
+
+                Iterator() : m_map(NULL), m_slot(NO_SLOT), m_sameKey(false) {}
+                Iterator(Map* map, uint32 slot, bool sameKey) : m_map(map), m_slot(slot), m_sameKey(sameKey) {}
+
+                /// iterator to const_iterator
+                template<class OtherMap, class OtherValue>
+                Iterator(Iterator<OtherMap, OtherValue> const& other) :
+                    m_map(other.m_map), m_slot(other.m_slot), m_sameKey(other.m_sameKey) {}
+
+                reference operator*() const { return m_map->m_values[m_slot]; }
+                pointer operator->() const { return &m_map->m_values[m_slot]; }
+
+                Iterator& operator++()
+                {
+                    m_slot = m_sameKey ? m_map->NextOfKey(m_slot) : m_map->NextUsed(m_slot + 1);
+                    return *this;
+                }
+
+                Iterator operator++(int)
+                {
+                    Iterator old = *this;
+                    ++*this;
+                    return old;
+                }
+
+                template<class OtherMap, class OtherValue>
+                bool operator==(Iterator<OtherMap, OtherValue> const& other) const { return m_slot == other.m_slot; }
+                template<class OtherMap, class OtherValue>
+                bool operator!=(Iterator<OtherMap, OtherValue> const& other) const { return m_slot != other.m_slot; }
+
+            private:
+                template<class OtherMap, class OtherValue> friend class Iterator;
+                friend class SlotMultimap;
+
+                Map* m_map;
+                uint32 m_slot;                              // NO_SLOT at the end
+                bool m_sameKey;                             // from equal_range, ++ follows the key
+        };
+
+        typedef Iterator<SlotMultimap, value_type> iterator;
+        typedef Iterator<SlotMultimap const, value_type const> const_iterator;
+
+        SlotMultimap() : m_used(0) {}
+
+        iterator begin() { return iterator(this, NextUsed(0), false); }
+        iterator end() { return iterator(this, NO_SLOT, false); }
+        const_iterator begin() const { return const_iterator(this, NextUsed(0), false); }
+        const_iterator end() const { return const_iterator(this, NO_SLOT, false); }
+
+        size_type size() const { return m_used; }
+        bool empty() const { return m_used == 0; }
+
+        iterator insert(value_type const& value)
+        {
+            uint32 slot = uint32(m_values.size());
+            m_values.push_back(value);
+            m_next.push_back(NO_SLOT);
+            m_isUsed.push_back(true);
+            LinkSlot(slot);
+            ++m_used;
+            return iterator(this, slot, false);
+        }
+
+        /**
+         * @brief frees the slot, iterators to it can still be incremented
+         *
+         * @param itr
+         */
+        void erase(iterator itr)
+        {
+            if (!m_isUsed[itr.m_slot])
+                { return; }
+
+            m_isUsed[itr.m_slot] = false;
+            m_values[itr.m_slot].second = T();
+            --m_used;
+        }
+
+        std::pair<iterator, iterator> equal_range(Key const& key)
+        {
+            return std::pair<iterator, iterator>(iterator(this, FirstOfKey(key), true), end());
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(Key const& key) const
+        {
+            return std::pair<const_iterator, const_iterator>(const_iterator(this, FirstOfKey(key), true), end());
+        }
+
+        /// first entry of key like std::multimap::find
+        iterator find(Key const& key) { return iterator(this, FirstOfKey(key), false); }
+        const_iterator find(Key const& key) const { return const_iterator(this, FirstOfKey(key), false); }
+
+        /**
+         * @brief releases the free slots, invalidates all iterators
+         *
+         */
+        void Compact()
+        {
+            if (m_used == m_values.size())
+                { return; }
+
+            uint32 count = 0;
+            for (uint32 slot = 0; slot < m_values.size(); ++slot)
+            {
+                if (m_isUsed[slot])
+                    { m_values[count++] = m_values[slot]; }
+            }
+
+            m_values.resize(count);
+            m_next.assign(count, NO_SLOT);
+            m_isUsed.assign(count, true);
+
+            for (typename KeyMap::iterator itr = m_keys.begin(); itr != m_keys.end(); ++itr)
+                { itr->second.first = itr->second.last = NO_SLOT; }
+
+            for (uint32 slot = 0; slot < count; ++slot)
+                { LinkSlot(slot); }
+
+            // keys without entries left
+            for (typename KeyMap::iterator itr = m_keys.begin(); itr != m_keys.end();)
+            {
+                if (itr->second.first == NO_SLOT)
+                    { itr = m_keys.erase(itr); }            // moves the last key here
+                else
+                    { ++itr; }
+            }
+        }
+
+    private:
+        /// chain of the slots of a key, free slots stay in it until Compact()
+        struct KeySlots
+        {
+            uint32 first;
+            uint32 last;
+        };
+
+        typedef FlatHashMap<Key, KeySlots, Hash> KeyMap;
+
+        void LinkSlot(uint32 slot)
+        {
+            typename KeyMap::iterator itr = m_keys.find(m_values[slot].first);
+            if (itr == m_keys.end())
+            {
+                KeySlots keySlots;
+                keySlots.first = keySlots.last = slot;
+                m_keys.insert(typename KeyMap::value_type(m_values[slot].first, keySlots));
+                return;
+            }
+
+            if (itr->second.last == NO_SLOT)
+                { itr->second.first = slot; }
+            else
+                { m_next[itr->second.last] = slot; }
+            itr->second.last = slot;
+        }
+
+        uint32 NextUsed(uint32 slot) const
+        {
+            while (slot < m_values.size() && !m_isUsed[slot])
+                { ++slot; }
+            return slot < m_values.size() ? slot : NO_SLOT;
+        }
+
+        uint32 NextOfKey(uint32 slot) const
+        {
+            do
+                { slot = m_next[slot]; }
+            while (slot != NO_SLOT && !m_isUsed[slot]);
+            return slot;
+        }
+
+        uint32 FirstOfKey(Key const& key) const
+        {
+            typename KeyMap::const_iterator itr = m_keys.find(key);
+            if (itr == m_keys.end())
+                { return NO_SLOT; }
+
+            uint32 slot = itr->second.first;
+            return slot == NO_SLOT || m_isUsed[slot] ? slot : NextOfKey(slot);
+        }
+
+        std::vector<value_type> m_values;
+        std::vector<uint32> m_next;                         // next slot of the same key
+        std::vector<bool> m_isUsed;
+        KeyMap m_keys;
+        size_type m_used;
+};
+
+#endif
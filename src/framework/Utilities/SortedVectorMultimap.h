@@ -0,0 +1,135 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SORTEDVECTORMULTIMAP_H
+#define MANGOS_SORTEDVECTORMULTIMAP_H
+
+#include "Platform/Define.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief multimap kept as a sorted vector, for static data loaded once and then only searched
+ *
+ * Entries of equal keys keep their insertion order like in std::multimap. Inserting in key order
+ * appends, other inserts move the following entries, so loading unordered rows costs more than
+ * with std::multimap. Pointers, references and iterators are only valid until the next insert or erase.
+ */
+template<class Key, class T>
+class SortedVectorMultimap
+{
+    public:
+        typedef Key key_type;
+        typedef T mapped_type;
+        typedef std::pair<Key, T> value_type;
+        typedef typename std::vector<value_type>::iterator iterator;
+        typedef typename std::vector<value_type>::const_iterator const_iterator;
+        typedef size_t size_type;
+
+        SortedVectorMultimap() {}
+
+        iterator begin() { return m_values.begin(); }
+        iterator end() { return m_values.end(); }
+        const_iterator begin() const { return m_values.begin(); }
+        const_iterator end() const { return m_values.end(); }
+
+        size_type size() const { return m_values.size(); }
+        bool empty() const { return m_values.empty(); }
+
+        void clear() { std::vector<value_type>().swap(m_values); }
+        void reserve(size_type count) { m_values.reserve(count); }
+
+        iterator insert(value_type const& value)
+        {
+            // rows are mostly loaded in key order
+            if (m_values.empty() || !(value.first < m_values.back().first))
+            {
+                m_values.push_back(value);
+                return m_values.end() - 1;
+            }
+
+            return m_values.insert(upper_bound(value.first), value);
+        }
+
+        iterator erase(iterator itr) { return m_values.erase(itr); }
+        iterator erase(iterator first, iterator last) { return m_values.erase(first, last); }
+
+        size_type erase(Key const& key)
+        {
+            std::pair<iterator, iterator> bounds = equal_range(key);
+            size_type count = bounds.second - bounds.first;
+            m_values.erase(bounds.first, bounds.second);
+            return count;
+        }
+
+        iterator lower_bound(Key const& key) { return std::lower_bound(m_values.begin(), m_values.end(), key, KeyLess()); }
+        const_iterator lower_bound(Key const& key) const { return std::lower_bound(m_values.begin(), m_values.end(), key, KeyLess()); }
+        iterator upper_bound(Key const& key) { return std::upper_bound(m_values.begin(), m_values.end(), key, KeyLess()); }
+        const_iterator upper_bound(Key const& key) const { return std::upper_bound(m_values.begin(), m_values.end(), key, KeyLess()); }
+
+        std::pair<iterator, iterator> equal_range(Key const& key)
+        {
+            return std::equal_range(m_values.begin(), m_values.end(), key, KeyLess());
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(Key const& key) const
+        {
+            return std::equal_range(m_values.begin(), m_values.end(), key, KeyLess());
+        }
+
+        /// first entry of key like std::multimap::find
+        iterator find(Key const& key)
+        {
+            iterator itr = lower_bound(key);
+            return itr != m_values.end() && !(key < itr->first) ? itr : m_values.end();
+        }
+
+        const_iterator find(Key const& key) const
+        {
+            const_iterator itr = lower_bound(key);
+            return itr != m_values.end() && !(key < itr->first) ? itr : m_values.end();
+        }
+
+        size_type count(Key const& key) const
+        {
+            std::pair<const_iterator, const_iterator> bounds = equal_range(key);
+            return bounds.second - bounds.first;
+        }
+
+    private:
+        /// compares entries by key only, also with a plain key for the searches
+        struct KeyLess
+        {
+            bool operator()(value_type const& left, value_type const& right) const { return left.first < right.first; }
+            bool operator()(value_type const& left, Key const& right) const { return left.first < right; }
+            bool operator()(Key const& left, value_type const& right) const { return left < right.first; }
+        };
+
+        std::vector<value_type> m_values;
+};
+
+#endif
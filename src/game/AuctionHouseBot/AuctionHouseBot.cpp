@@ -30,6 +30,10 @@
 #include "SystemConfig.h"
 #include "SQLStorages.h"
 
+#include <ace/Guard_T.h>
+
+#include <algorithm>
+
 /** \addtogroup auctionbot
  * @{
  * \file
@@ -40,7 +44,7 @@
  * Format is YYYYMMDDRR where RR is the change in the conf file
  * for that day.
  */
-#define AUCTIONHOUSEBOT_CONF_VERSION    2010102201
+#define AUCTIONHOUSEBOT_CONF_VERSION    2026101401
 
 #include "Policies/Singleton.h"
 
@@ -192,20 +196,24 @@ class AuctionBotBuyer : public AuctionBotAgent
         ~AuctionBotBuyer();
 
         bool        Initialize() override;
+        bool        IsActive(AuctionHouseType houseType) const override;
         /**
-         * Updates the specified house type. Will buy items if there are any that match certain
+         * Plans for the specified house type. Will buy items if there are any that match certain
          * criteria.
          * @param houseType Type of the house.
-         * @return true if the update was successful, false otherwise
+         * @param auctions The auctions of the house.
+         * @param operations The planned bids and buys are added here.
          */
-        bool        Update(AuctionHouseType houseType) override;
+        void        Plan(AuctionHouseType houseType, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations) override;
 
         void        LoadConfig();
         /**
          * Adds the new auction buyer bot bid.
          * @param config The config.
+         * @param auctions The auctions of the house.
+         * @param operations The planned bids and buys are added here.
          */
-        void        addNewAuctionBuyerBotBid(AHB_Buyer_Config& config);
+        void        addNewAuctionBuyerBotBid(AHB_Buyer_Config& config, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations);
 
     private:
         uint32              m_CheckInterval;
@@ -241,18 +249,22 @@ class AuctionBotBuyer : public AuctionBotAgent
          */
         bool        IsBidableEntry(uint32 bidPrice, double InGame_BuyPrice, double MaxBidablePrice, uint32 MinBidPrice, uint32 MaxChance, uint32 ChanceRatio);
         /**
-         * Places the bid to entry.
+         * Plans the bid to entry.
          *
+         * @param config The config.
          * @param auction The auction.
          * @param bidPrice The bid price.
+         * @param operations The bid is added here.
          */
-        void        PlaceBidToEntry(AuctionEntry* auction, uint32 bidPrice);
+        void        PlaceBidToEntry(AHB_Buyer_Config const& config, AuctionBotAuction const& auction, uint32 bidPrice, AuctionBotOperations& operations);
         /**
-         * Buys the entry.
+         * Plans to buy the entry.
          *
+         * @param config The config.
          * @param auction The auction.
+         * @param operations The buy is added here.
          */
-        void        BuyEntry(AuctionEntry* auction);
+        void        BuyEntry(AHB_Buyer_Config const& config, AuctionBotAuction const& auction, AuctionBotOperations& operations);
         /**
          * Prepares the list of entry.
          *
@@ -263,9 +275,10 @@ class AuctionBotBuyer : public AuctionBotAgent
          * Gets the buyable entry.
          *
          * @param config The config.
+         * @param auctions The auctions of the house.
          * <returns></returns
          */
-        uint32      GetBuyableEntry(AHB_Buyer_Config& config);
+        uint32      GetBuyableEntry(AHB_Buyer_Config& config, AuctionBotSnapshot const& auctions);
 };
 
 /**
@@ -291,18 +304,22 @@ class AuctionBotSeller : public AuctionBotAgent
          * Initializes this instance.
          */
         bool Initialize() override;
+        bool IsActive(AuctionHouseType houseType) const override;
         /**
-         * Updates the specified house type by possibly putting up new items for
+         * Plans for the specified house type by possibly putting up new items for
          * sale if there's a need for it.
          * @param houseType Type of the house.
+         * @param auctions The auctions of the house.
+         * @param operations The planned new auctions are added here.
          */
-        bool Update(AuctionHouseType houseType) override;
+        void Plan(AuctionHouseType houseType, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations) override;
         /**
          * Add new auction to one of the factions.
          * Faction and setting associated is passed with the config
          * @param config The config to use for adding the auctions
+         * @param operations The planned new auctions are added here.
          */
-        void addNewAuctions(AHB_Seller_Config& config);
+        void addNewAuctions(AHB_Seller_Config& config, AuctionBotOperations& operations);
         /**
          * Sets the items ratio. This should be a value betweeen 0 and 10000 which
          * probably represents 0-100%
@@ -352,9 +369,10 @@ class AuctionBotSeller : public AuctionBotAgent
          * Fill ItemInfos object with real content of AH.
          *
          * @param config The config.
+         * @param auctions The auctions of the house.
          * @return
          */
-        uint32      SetStat(AHB_Seller_Config& config);
+        uint32      SetStat(AHB_Seller_Config& config, AuctionBotSnapshot const& auctions);
         /**
          * getRandomArray is used to make available the possibility to
          * add any of missed item in place of first one to last one.
@@ -558,6 +576,9 @@ void AuctionBotConfig::GetConfigFromFile()
     setConfig(CONFIG_UINT32_AHBOT_CLASS_TRADEGOOD_MAX_ITEM_LEVEL   , "AuctionHouseBot.Class.TradeGood.ItemLevel.Max" , 0);
     setConfig(CONFIG_UINT32_AHBOT_CLASS_CONTAINER_MIN_ITEM_LEVEL   , "AuctionHouseBot.Class.Container.ItemLevel.Min" , 0);
     setConfig(CONFIG_UINT32_AHBOT_CLASS_CONTAINER_MAX_ITEM_LEVEL   , "AuctionHouseBot.Class.Container.ItemLevel.Max" , 0);
+
+    setConfig(CONFIG_BOOL_AHBOT_BACKGROUND                   , "AuctionHouseBot.Background"                 , true);
+    setConfigMinMax(CONFIG_UINT32_AHBOT_OPERATIONS_PER_TICK  , "AuctionHouseBot.OperationsPerTick"          , 5, 1, 1000);
 }
 
 bool AuctionBotConfig::Reload()
@@ -683,65 +704,38 @@ void AuctionBotBuyer::LoadConfig()
     }
 }
 
-uint32 AuctionBotBuyer::GetBuyableEntry(AHB_Buyer_Config& config)
+uint32 AuctionBotBuyer::GetBuyableEntry(AHB_Buyer_Config& config, AuctionBotSnapshot const& auctions)
 {
     config.SameItemInfo.clear();
     uint32 count = 0;
     time_t Now = time(NULL);
 
-    AuctionHouseObject::AuctionEntryMapBounds bounds = sAuctionMgr.GetAuctionsMap(config.GetHouseType())->GetAuctionsBounds();
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+    for (AuctionBotSnapshot::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
     {
-        AuctionEntry* Aentry = itr->second;
-        Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
-        if (item)
+        AuctionBotAuction const& Aentry = *itr;
+        BuyerItemInfo& sameItem = config.SameItemInfo[Aentry.itemEntry];    // Structure constructor will make sure Element are correctly initialised if entry is created here.
+
+        ++sameItem.ItemCount;
+        sameItem.BuyPrice = sameItem.BuyPrice + (Aentry.buyout / Aentry.itemCount);
+        sameItem.BidPrice = sameItem.BidPrice + (Aentry.startbid / Aentry.itemCount);
+        if (Aentry.buyout != 0)
         {
-            ItemPrototype const* prototype = item->GetProto();
-            if (prototype)
-            {
-                ++config.SameItemInfo[item->GetEntry()].ItemCount;    // Structure constructor will make sure Element are correctly initialised if entry is created here.
-                config.SameItemInfo[item->GetEntry()].BuyPrice = config.SameItemInfo[item->GetEntry()].BuyPrice + (itr->second->buyout / item->GetCount());
-                config.SameItemInfo[item->GetEntry()].BidPrice = config.SameItemInfo[item->GetEntry()].BidPrice + (itr->second->startbid / item->GetCount());
-                if (itr->second->buyout != 0)
-                {
-                    if (itr->second->buyout / item->GetCount() < config.SameItemInfo[item->GetEntry()].MinBuyPrice)
-                        { config.SameItemInfo[item->GetEntry()].MinBuyPrice = itr->second->buyout / item->GetCount(); }
-                    else if (config.SameItemInfo[item->GetEntry()].MinBuyPrice == 0)
-                        { config.SameItemInfo[item->GetEntry()].MinBuyPrice = itr->second->buyout / item->GetCount(); }
-                }
-                if (itr->second->startbid / item->GetCount() < config.SameItemInfo[item->GetEntry()].MinBidPrice)
-                    { config.SameItemInfo[item->GetEntry()].MinBidPrice = itr->second->startbid / item->GetCount(); }
-                else if (config.SameItemInfo[item->GetEntry()].MinBidPrice == 0)
-                    { config.SameItemInfo[item->GetEntry()].MinBidPrice = itr->second->startbid / item->GetCount(); }
+            if (Aentry.buyout / Aentry.itemCount < sameItem.MinBuyPrice)
+                { sameItem.MinBuyPrice = Aentry.buyout / Aentry.itemCount; }
+            else if (sameItem.MinBuyPrice == 0)
+                { sameItem.MinBuyPrice = Aentry.buyout / Aentry.itemCount; }
+        }
+        if (Aentry.startbid / Aentry.itemCount < sameItem.MinBidPrice)
+            { sameItem.MinBidPrice = Aentry.startbid / Aentry.itemCount; }
+        else if (sameItem.MinBidPrice == 0)
+            { sameItem.MinBidPrice = Aentry.startbid / Aentry.itemCount; }
 
-                if (!Aentry->owner)
-                {
-                    if ((Aentry->bid != 0) && Aentry->bidder) // Add bided by player
-                    {
-                        config.CheckedEntry[Aentry->Id].LastExist = Now;
-                        config.CheckedEntry[Aentry->Id].AuctionId = Aentry->Id;
-                        ++count;
-                    }
-                }
-                else
-                {
-                    if (Aentry->bid != 0)
-                    {
-                        if (Aentry->bidder)
-                        {
-                            config.CheckedEntry[Aentry->Id].LastExist = Now;
-                            config.CheckedEntry[Aentry->Id].AuctionId = Aentry->Id;
-                            ++count;
-                        }
-                    }
-                    else
-                    {
-                        config.CheckedEntry[Aentry->Id].LastExist = Now;
-                        config.CheckedEntry[Aentry->Id].AuctionId = Aentry->Id;
-                        ++count;
-                    }
-                }
-            }
+        // bot auctions only with a bid of a player, player auctions without a bid or with a bid of a player
+        if (Aentry.owner ? (Aentry.bid == 0 || Aentry.bidder) : (Aentry.bid != 0 && Aentry.bidder))
+        {
+            config.CheckedEntry[Aentry.Id].LastExist = Now;
+            config.CheckedEntry[Aentry.Id].AuctionId = Aentry.Id;
+            ++count;
         }
     }
 
@@ -873,22 +867,40 @@ bool AuctionBotBuyer::IsBidableEntry(uint32 bidPrice, double InGame_BuyPrice, do
     }
 }
 
-void AuctionBotBuyer::PlaceBidToEntry(AuctionEntry* auction, uint32 bidPrice)
+void AuctionBotBuyer::PlaceBidToEntry(AHB_Buyer_Config const& config, AuctionBotAuction const& auction, uint32 bidPrice, AuctionBotOperations& operations)
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Bid placed to entry %u, %.2fg", auction->Id, float(bidPrice) / 10000.0f);
-    auction->UpdateBid(bidPrice);
+    DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Bid placed to entry %u, %.2fg", auction.Id, float(bidPrice) / 10000.0f);
+
+    AuctionBotOperation operation;
+    operation.type = AHBOT_OPERATION_BID;
+    operation.houseType = config.GetHouseType();
+    operation.auctionHouseEntry = NULL;
+    operation.itemEntry = auction.itemEntry;
+    operation.stackCount = auction.itemCount;
+    operation.etime = 0;
+    operation.auctionId = auction.Id;
+    operation.expectedBid = auction.bid;
+    operation.bid = bidPrice;
+    operation.buyout = auction.buyout;
+    operations.push_back(operation);
 }
 
-void AuctionBotBuyer::BuyEntry(AuctionEntry* auction)
+void AuctionBotBuyer::BuyEntry(AHB_Buyer_Config const& config, AuctionBotAuction const& auction, AuctionBotOperations& operations)
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Entry %u buyed at %.2fg", auction->Id, float(auction->buyout) / 10000.0f);
-    auction->UpdateBid(auction->buyout);
+    DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Entry %u buyed at %.2fg", auction.Id, float(auction.buyout) / 10000.0f);
+
+    PlaceBidToEntry(config, auction, auction.buyout, operations);
+    operations.back().type = AHBOT_OPERATION_BUY;
 }
 
-void AuctionBotBuyer::addNewAuctionBuyerBotBid(AHB_Buyer_Config& config)
+/// orders snapshot auctions by id, for the lookup of checked entries
+struct AuctionBotAuctionIdLess
 {
-    AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(config.GetHouseType());
+    bool operator()(AuctionBotAuction const& auction, uint32 id) const { return auction.Id < id; }
+};
 
+void AuctionBotBuyer::addNewAuctionBuyerBotBid(AHB_Buyer_Config& config, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations)
+{
     PrepareListOfEntry(config);
 
     time_t Now = time(NULL);
@@ -903,19 +915,22 @@ void AuctionBotBuyer::addNewAuctionBuyerBotBid(AHB_Buyer_Config& config)
 
     for (CheckEntryMap::iterator itr = config.CheckedEntry.begin(); itr != config.CheckedEntry.end();)
     {
-        AuctionEntry* auction = auctionHouse->GetAuction(itr->second.AuctionId);
-        if (!auction)                                       // is auction not active now
+        AuctionBotSnapshot::const_iterator auctionItr = std::lower_bound(auctions.begin(), auctions.end(), itr->second.AuctionId, AuctionBotAuctionIdLess());
+        if (auctionItr == auctions.end() || auctionItr->Id != itr->second.AuctionId)
         {
-            DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Entry %u on ah %u doesn't exists, perhaps bought already?",
-                             itr->second.AuctionId, auction->GetHouseId());
+            // is auction not active now, or its item not accessible, possible auction in payment pending mode
+            DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Entry %u on ah type %u doesn't exists, perhaps bought already?",
+                             itr->second.AuctionId, config.GetHouseType());
 
             config.CheckedEntry.erase(itr++);
             continue;
         }
 
+        AuctionBotAuction const& auction = *auctionItr;
+
         if ((itr->second.LastChecked != 0) && ((Now - itr->second.LastChecked) <= m_CheckInterval))
         {
-            DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: In time interval wait for entry %u!", auction->Id);
+            DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: In time interval wait for entry %u!", auction.Id);
             ++itr;
             continue;
         }
@@ -925,33 +940,26 @@ void AuctionBotBuyer::addNewAuctionBuyerBotBid(AHB_Buyer_Config& config)
 
         uint32 MaxChance = 5000;
 
-        Item* item = sAuctionMgr.GetAItem(auction->itemGuidLow);
-        if (!item)                                          // auction item not accessible, possible auction in payment pending mode
-        {
-            config.CheckedEntry.erase(itr++);
-            continue;
-        }
-
-        ItemPrototype const* prototype = item->GetProto();
+        ItemPrototype const* prototype = auction.proto;
 
         uint32 BasePrice = sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_BUYPRICE_BUYER) ? prototype->BuyPrice : prototype->SellPrice;
-        BasePrice *= item->GetCount();
+        BasePrice *= auction.itemCount;
 
         double MaxBuyablePrice = (BasePrice * config.BuyerPriceRatio) / 100;
-        BuyerItemInfoMap::iterator sameitem_itr = config.SameItemInfo.find(item->GetEntry());
-        uint32 buyoutPrice = auction->buyout / item->GetCount();
+        BuyerItemInfoMap::iterator sameitem_itr = config.SameItemInfo.find(auction.itemEntry);
+        uint32 buyoutPrice = auction.buyout / auction.itemCount;
 
         uint32 bidPrice;
         uint32 bidPriceByItem;
-        if (auction->bid >= auction->startbid)
+        if (auction.bid >= auction.startbid)
         {
-            bidPrice = auction->GetAuctionOutBid();
-            bidPriceByItem = auction->bid / item->GetCount();
+            bidPrice = auction.outBid;
+            bidPriceByItem = auction.bid / auction.itemCount;
         }
         else
         {
-            bidPrice = auction->startbid;
-            bidPriceByItem = auction->startbid / item->GetCount();
+            bidPrice = auction.startbid;
+            bidPriceByItem = auction.startbid / auction.itemCount;
         }
 
         double InGame_BuyPrice;
@@ -977,29 +985,29 @@ void AuctionBotBuyer::addNewAuctionBuyerBotBid(AHB_Buyer_Config& config)
                          sameitem_itr->second.MinBuyPrice / 10000, sameitem_itr->second.MinBidPrice / 10000);
         DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Actual Entry price,  Buy=%ug, Bid=%ug.", buyoutPrice / 10000, bidPrice / 10000);
 
-        if (!auction->owner)                // Original auction owner
+        if (!auction.owner)                 // Original auction owner
         {
             MaxChance = MaxChance / 5;      // if Owner is AHBot this mean player placed bid on this auction. We divide by 5 chance for AhBuyer to place bid on it. (This make more challenge than ignore entry)
         }
-        if (auction->buyout != 0)           // Is the item directly buyable?
+        if (auction.buyout != 0)            // Is the item directly buyable?
         {
             if (IsBuyableEntry(buyoutPrice, InGame_BuyPrice, MaxBuyablePrice, sameitem_itr->second.MinBuyPrice, MaxChance, config.FactionChance))
             {
                 if (IsBidableEntry(bidPriceByItem, InGame_BuyPrice, MaxBidablePrice, sameitem_itr->second.MinBidPrice, MaxChance / 2, config.FactionChance))
-                    if (urand(0, 5) == 0) { PlaceBidToEntry(auction, bidPrice); }
-                    else { BuyEntry(auction); }
+                    if (urand(0, 5) == 0) { PlaceBidToEntry(config, auction, bidPrice, operations); }
+                    else { BuyEntry(config, auction, operations); }
                 else
-                    { BuyEntry(auction); }
+                    { BuyEntry(config, auction, operations); }
             }
             else
             {
                 if (IsBidableEntry(bidPriceByItem, InGame_BuyPrice, MaxBidablePrice, sameitem_itr->second.MinBidPrice, MaxChance / 2, config.FactionChance))
-                    { PlaceBidToEntry(auction, bidPrice); }
+                    { PlaceBidToEntry(config, auction, bidPrice, operations); }
             }
         }
         else // buyout = 0 mean only bid are possible
             if (IsBidableEntry(bidPriceByItem, InGame_BuyPrice, MaxBidablePrice, sameitem_itr->second.MinBidPrice, MaxChance, config.FactionChance))
-                { PlaceBidToEntry(auction, bidPrice); }
+                { PlaceBidToEntry(config, auction, bidPrice, operations); }
 
         itr->second.LastChecked = Now;
         --BuyCycles;
@@ -1008,16 +1016,16 @@ void AuctionBotBuyer::addNewAuctionBuyerBotBid(AHB_Buyer_Config& config)
     }
 }
 
-bool AuctionBotBuyer::Update(AuctionHouseType houseType)
+bool AuctionBotBuyer::IsActive(AuctionHouseType houseType) const
 {
-    if (sAuctionBotConfig.getConfigBuyerEnabled(houseType))
-    {
-        DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: %s buying ...", AuctionBotConfig::GetHouseTypeName(houseType));
-        if (GetBuyableEntry(m_HouseConfig[houseType]) > 0)
-            { addNewAuctionBuyerBotBid(m_HouseConfig[houseType]); }
-        return true;
-    }
-    else { return false; }
+    return sAuctionBotConfig.getConfigBuyerEnabled(houseType);
+}
+
+void AuctionBotBuyer::Plan(AuctionHouseType houseType, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations)
+{
+    DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: %s buying ...", AuctionBotConfig::GetHouseTypeName(houseType));
+    if (GetBuyableEntry(m_HouseConfig[houseType], auctions) > 0)
+        { addNewAuctionBuyerBotBid(m_HouseConfig[houseType], auctions, operations); }
 }
 
 //== AuctionBotSeller functions ============================
@@ -1118,18 +1126,23 @@ bool AuctionBotSeller::Initialize()
 
     uint32 itemsAdded = 0;
 
-    BarGoLink bar(sItemStorage.GetMaxEntry());
-    for (uint32 itemID = 0; itemID < sItemStorage.GetMaxEntry(); ++itemID)
+    // the first filters read columns of the fields only, not the whole prototypes
+    std::vector<uint32> itemIds;
+    std::vector<uint32> qualities;
+    std::vector<uint32> prices;
+    sItemStorage.GetEntries(itemIds);
+    sItemStorage.FillColumn(itemIds, &ItemPrototype::Quality, qualities);
+    sItemStorage.FillColumn(itemIds, sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_BUYPRICE_SELLER) ? &ItemPrototype::BuyPrice : &ItemPrototype::SellPrice, prices);
+
+    BarGoLink bar(itemIds.size());
+    for (size_t idx = 0; idx < itemIds.size(); ++idx)
     {
-        ItemPrototype const* prototype = sObjectMgr.GetItemPrototype(itemID);
+        uint32 itemID = itemIds[idx];
 
         bar.step();
 
-        if (!prototype)
-            { continue; }
-
         // skip items with too high quality (code can't propertly work with its)
-        if (prototype->Quality >= MAX_AUCTION_QUALITY)
+        if (qualities[idx] >= MAX_AUCTION_QUALITY)
             { continue; }
 
         // forced exclude filter
@@ -1140,6 +1153,8 @@ bool AuctionBotSeller::Initialize()
         if (isExcludeItem)
             { continue; }
 
+        ItemPrototype const* prototype = sObjectMgr.GetItemPrototype(itemID);
+
         // forced include filter
         bool isForcedIncludeItem = false;
         for (size_t i = 0; (i < includeItems.size() && (!isForcedIncludeItem)); ++i)
@@ -1181,16 +1196,8 @@ bool AuctionBotSeller::Initialize()
         }
 
         // no price filter
-        if (sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_BUYPRICE_SELLER))
-        {
-            if (prototype->BuyPrice == 0)
-                { continue; }
-        }
-        else
-        {
-            if (prototype->SellPrice == 0)
-                { continue; }
-        }
+        if (prices[idx] == 0)
+            { continue; }
 
         // vendor filter
         if (!sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_ITEMS_VENDOR))
@@ -1515,26 +1522,14 @@ void AuctionBotSeller::LoadSellerValues(AHB_Seller_Config& config)
 
 // Set static of items on one AH faction.
 // Fill ItemInfos object with real content of AH.
-uint32 AuctionBotSeller::SetStat(AHB_Seller_Config& config)
+uint32 AuctionBotSeller::SetStat(AHB_Seller_Config& config, AuctionBotSnapshot const& auctions)
 {
     std::vector<std::vector<uint32> > ItemsInAH(MAX_AUCTION_QUALITY, std::vector< uint32 > (MAX_ITEM_CLASS));
 
-    AuctionHouseObject::AuctionEntryMapBounds bounds = sAuctionMgr.GetAuctionsMap(config.GetHouseType())->GetAuctionsBounds();
-    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+    for (AuctionBotSnapshot::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
     {
-        AuctionEntry* Aentry = itr->second;
-        Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
-        if (item)
-        {
-            ItemPrototype const* prototype = item->GetProto();
-            if (prototype)
-            {
-                if (!Aentry->owner)                         // Add only ahbot items
-                {
-                    ++ItemsInAH[prototype->Quality][prototype->Class];
-                }
-            }
-        }
+        if (!itr->owner)                                    // Add only ahbot items
+            { ++ItemsInAH[itr->proto->Quality][itr->proto->Class]; }
     }
     uint32 count = 0;
     for (uint32 j = 0; j < MAX_AUCTION_QUALITY; ++j)
@@ -1657,7 +1652,7 @@ void AuctionBotSeller::SetItemsAmountForQuality(AuctionQuality quality, uint32 v
 
 // Add new auction to one of the factions.
 // Faction and setting assossiated is defined passed argument ( config )
-void AuctionBotSeller::addNewAuctions(AHB_Seller_Config& config)
+void AuctionBotSeller::addNewAuctions(AHB_Seller_Config& config, AuctionBotOperations& operations)
 {
     uint32 items;
 
@@ -1679,8 +1674,6 @@ void AuctionBotSeller::addNewAuctions(AHB_Seller_Config& config)
 
     AuctionHouseEntry const* ahEntry = sAuctionHouseStore.LookupEntry(houseid);
 
-    AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(config.GetHouseType());
-
     RandomArray randArray;
     std::vector<std::vector<uint32> > ItemsAdded(MAX_AUCTION_QUALITY, std::vector<uint32> (MAX_ITEM_CLASS));
     // Main loop
@@ -1711,54 +1704,64 @@ void AuctionBotSeller::addNewAuctions(AHB_Seller_Config& config)
 
         uint32 stackCount = urand(1, prototype->GetMaxStackSize());
 
-        Item* item = Item::CreateItem(itemID, stackCount);
-        if (!item)
-        {
-            sLog.outError("AHBot: Item::CreateItem() returned NULL for item %u (stack: %u)", itemID, stackCount);
-            return;
-        }
-
         uint32 buyoutPrice;
         uint32 bidPrice = 0;
         // Not sure if i will keep the next test
         if (sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_BUYPRICE_SELLER))
-            { buyoutPrice  = prototype->BuyPrice * item->GetCount(); }
+            { buyoutPrice  = prototype->BuyPrice * stackCount; }
         else
-            { buyoutPrice  = prototype->SellPrice * item->GetCount(); }
+            { buyoutPrice  = prototype->SellPrice * stackCount; }
         // Price of items are set here
         SetPricesOfItem(prototype, config, buyoutPrice, bidPrice, stackCount, ItemQualities(prototype->Quality));
 
-        auctionHouse->AddAuction(ahEntry, item, urand(config.GetMinTime(), config.GetMaxTime()) * HOUR, bidPrice, buyoutPrice);
+        // the item is created when the world thread applies the operation
+        AuctionBotOperation operation;
+        operation.type = AHBOT_OPERATION_ADD;
+        operation.houseType = config.GetHouseType();
+        operation.auctionHouseEntry = ahEntry;
+        operation.itemEntry = itemID;
+        operation.stackCount = stackCount;
+        operation.etime = urand(config.GetMinTime(), config.GetMaxTime()) * HOUR;
+        operation.auctionId = 0;
+        operation.expectedBid = 0;
+        operation.bid = bidPrice;
+        operation.buyout = buyoutPrice;
+        operations.push_back(operation);
     }
 }
 
-bool AuctionBotSeller::Update(AuctionHouseType houseType)
+bool AuctionBotSeller::IsActive(AuctionHouseType houseType) const
 {
-    if (sAuctionBotConfig.getConfigItemAmountRatio(houseType) > 0)
-    {
-        DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_SELLER, "AHBot: %s selling ...", AuctionBotConfig::GetHouseTypeName(houseType));
-        if (SetStat(m_HouseConfig[houseType]))
-            { addNewAuctions(m_HouseConfig[houseType]); }
-        return true;
-    }
-    else
-        { return false; }
+    return sAuctionBotConfig.getConfigItemAmountRatio(houseType) > 0;
+}
+
+void AuctionBotSeller::Plan(AuctionHouseType houseType, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations)
+{
+    DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_SELLER, "AHBot: %s selling ...", AuctionBotConfig::GetHouseTypeName(houseType));
+    if (SetStat(m_HouseConfig[houseType], auctions))
+        { addNewAuctions(m_HouseConfig[houseType], operations); }
 }
 
 //== AuctionHouseBot functions =============================
 
-AuctionHouseBot::AuctionHouseBot() : m_Buyer(NULL), m_Seller(NULL), m_OperationSelector(0)
+AuctionHouseBot::AuctionHouseBot() : m_Buyer(NULL), m_Seller(NULL), m_OperationSelector(0),
+    m_planCondition(m_lock), m_planDoneCondition(m_lock), m_active(false), m_stopping(false),
+    m_planAgent(NULL), m_planHouse(AUCTION_HOUSE_NEUTRAL)
 {
 }
 
 AuctionHouseBot::~AuctionHouseBot()
 {
+    Deactivate();
+
     delete m_Buyer;
     delete m_Seller;
 }
 
 void AuctionHouseBot::InitilizeAgents()
 {
+    WaitPlanDone();
+
     if (sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_SELLER_ENABLED))
     {
         delete m_Seller;
@@ -1779,8 +1782,86 @@ void AuctionHouseBot::InitilizeAgents()
             m_Buyer = NULL;
         }
     }
+
+    if (sAuctionBotConfig.getConfig(CONFIG_BOOL_AHBOT_BACKGROUND) && (m_Buyer || m_Seller))
+        { Activate(); }
+    else
+        { Deactivate(); }
 }
 
+void AuctionHouseBot::Activate()
+{
+    if (m_active)
+        { return; }
+
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1)
+    {
+        sLog.outError("AHBot: can't start the planning thread, the bot plans in the world thread");
+        return;
+    }
+
+    m_active = true;
+}
+
+void AuctionHouseBot::Deactivate()
+{
+    if (!m_active)
+        { return; }
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stopping = true;
+        m_planCondition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+    m_active = false;
+}
+
+void AuctionHouseBot::WaitPlanDone()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    while (m_planAgent)
+        { m_planDoneCondition.wait(); }
+}
+
+int AuctionHouseBot::svc()
+{
+    AuctionBotSnapshot auctions;
+
+    for (;;)
+    {
+        AuctionBotAgent* agent;
+        AuctionHouseType houseType;
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            while (!m_planAgent && !m_stopping)
+                { m_planCondition.wait(); }
+
+            if (!m_planAgent)
+                { break; }                                  // stopping and no plan handed over
+
+            agent = m_planAgent;
+            houseType = m_planHouse;
+            auctions.swap(m_planAuctions);
+        }
+
+        AuctionBotOperations operations;
+        agent->Plan(houseType, auctions, operations);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        m_operations.insert(m_operations.end(), operations.begin(), operations.end());
+        m_planAgent = NULL;
+        m_planDoneCondition.broadcast();
+    }
+
+    return 0;
+}
 void AuctionHouseBot::Initialize()
 {
     if (sAuctionBotConfig.Initialize())
@@ -1789,30 +1870,40 @@ void AuctionHouseBot::Initialize()
 
 void AuctionHouseBot::SetItemsRatio(uint32 al, uint32 ho, uint32 ne)
 {
+    WaitPlanDone();
+
     if (AuctionBotSeller* seller = dynamic_cast<AuctionBotSeller*>(m_Seller))
         { seller->SetItemsRatio(al, ho, ne); }
 }
 
 void AuctionHouseBot::SetItemsRatioForHouse(AuctionHouseType house, uint32 val)
 {
+    WaitPlanDone();
+
     if (AuctionBotSeller* seller = dynamic_cast<AuctionBotSeller*>(m_Seller))
         { seller->SetItemsRatioForHouse(house, val); }
 }
 
 void AuctionHouseBot::SetItemsAmount(uint32(&vals) [MAX_AUCTION_QUALITY])
 {
+    WaitPlanDone();
+
     if (AuctionBotSeller* seller = dynamic_cast<AuctionBotSeller*>(m_Seller))
         { seller->SetItemsAmount(vals); }
 }
 
 void AuctionHouseBot::SetItemsAmountForQuality(AuctionQuality quality, uint32 val)
 {
+    WaitPlanDone();
+
     if (AuctionBotSeller* seller = dynamic_cast<AuctionBotSeller*>(m_Seller))
         { seller->SetItemsAmountForQuality(quality, val); }
 }
 
 bool AuctionHouseBot::ReloadAllConfig()
 {
+    WaitPlanDone();
+
     if (!sAuctionBotConfig.Reload())
     {
         sLog.outError("AHBot: Error while trying to reload config from file!");
@@ -1864,35 +1955,148 @@ void AuctionHouseBot::Rebuild(bool all)
     }
 }
 
+void AuctionHouseBot::TakeSnapshot(AuctionHouseType houseType, AuctionBotSnapshot& auctions) const
+{
+    AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(houseType);
+    auctions.reserve(auctionHouse->GetCount());
+
+    AuctionHouseObject::AuctionEntryMapBounds bounds = auctionHouse->GetAuctionsBounds();
+    for (AuctionHouseObject::AuctionEntryMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+    {
+        AuctionEntry* Aentry = itr->second;
+        Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
+        if (!item || !item->GetProto())
+            { continue; }
+
+        AuctionBotAuction auction;
+        auction.Id = Aentry->Id;
+        auction.itemEntry = item->GetEntry();
+        auction.itemCount = item->GetCount();
+        auction.proto = item->GetProto();
+        auction.owner = Aentry->owner;
+        auction.startbid = Aentry->startbid;
+        auction.bid = Aentry->bid;
+        auction.bidder = Aentry->bidder;
+        auction.buyout = Aentry->buyout;
+        auction.outBid = Aentry->GetAuctionOutBid();
+        auctions.push_back(auction);
+    }
+}
+
 void AuctionHouseBot::Update()
 {
     // nothing do...
     if (!m_Buyer && !m_Seller)
         { return; }
 
-    // scan all possible update cases until first success
-    for (uint32 count = 0; count < 2 * MAX_AUCTION_HOUSE_TYPE; ++count)
+    // the last plan is not done or not applied yet
     {
-        bool successStep = false;
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        if (m_planAgent || !m_operations.empty())
+            { return; }
+    }
 
+    // scan all possible update cases until first active one
+    AuctionBotAgent* agent = NULL;
+    AuctionHouseType houseType = AUCTION_HOUSE_NEUTRAL;
+    for (uint32 count = 0; count < 2 * MAX_AUCTION_HOUSE_TYPE && !agent; ++count)
+    {
         if (m_OperationSelector < MAX_AUCTION_HOUSE_TYPE)
         {
-            if (m_Seller)
-                { successStep = m_Seller->Update(AuctionHouseType(m_OperationSelector)); }
+            houseType = AuctionHouseType(m_OperationSelector);
+            if (m_Seller && m_Seller->IsActive(houseType))
+                { agent = m_Seller; }
         }
         else
         {
-            if (m_Buyer)
-                { successStep = m_Buyer->Update(AuctionHouseType(m_OperationSelector - MAX_AUCTION_HOUSE_TYPE)); }
+            houseType = AuctionHouseType(m_OperationSelector - MAX_AUCTION_HOUSE_TYPE);
+            if (m_Buyer && m_Buyer->IsActive(houseType))
+                { agent = m_Buyer; }
         }
 
         ++m_OperationSelector;
         if (m_OperationSelector >= 2 * MAX_AUCTION_HOUSE_TYPE)
             { m_OperationSelector = 0; }
+    }
 
-        // one success update per call
-        if (successStep)
-            { break; }
+    // one plan per call
+    if (!agent)
+        { return; }
+
+    AuctionBotSnapshot auctions;
+    TakeSnapshot(houseType, auctions);
+
+    if (m_active)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_planAgent = agent;
+        m_planHouse = houseType;
+        m_planAuctions.swap(auctions);
+        m_planCondition.signal();
+        return;
+    }
+
+    AuctionBotOperations operations;
+    agent->Plan(houseType, auctions, operations);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_operations.insert(m_operations.end(), operations.begin(), operations.end());
+}
+
+bool AuctionHouseBot::HasOperations() const
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+    return !m_operations.empty();
+}
+
+void AuctionHouseBot::ApplyOperations()
+{
+    AuctionBotOperations operations;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        uint32 count = std::min(uint32(m_operations.size()), sAuctionBotConfig.getConfig(CONFIG_UINT32_AHBOT_OPERATIONS_PER_TICK));
+        operations.assign(m_operations.begin(), m_operations.begin() + count);
+        m_operations.erase(m_operations.begin(), m_operations.begin() + count);
+    }
+
+    for (AuctionBotOperations::const_iterator itr = operations.begin(); itr != operations.end(); ++itr)
+        { ApplyOperation(*itr); }
+}
+
+void AuctionHouseBot::ApplyOperation(AuctionBotOperation const& operation)
+{
+    AuctionHouseObject* auctionHouse = sAuctionMgr.GetAuctionsMap(operation.houseType);
+
+    switch (operation.type)
+    {
+        case AHBOT_OPERATION_ADD:
+        {
+            Item* item = Item::CreateItem(operation.itemEntry, operation.stackCount);
+            if (!item)
+            {
+                sLog.outError("AHBot: Item::CreateItem() returned NULL for item %u (stack: %u)", operation.itemEntry, operation.stackCount);
+                return;
+            }
+
+            auctionHouse->AddAuction(operation.auctionHouseEntry, item, operation.etime, operation.bid, operation.buyout);
+            break;
+        }
+        case AHBOT_OPERATION_BID:
+        case AHBOT_OPERATION_BUY:
+        {
+            // planned with an outdated view of the auction
+            AuctionEntry* auction = auctionHouse->GetAuction(operation.auctionId);
+            if (!auction || auction->bid != operation.expectedBid || !sAuctionMgr.GetAItem(auction->itemGuidLow))
+            {
+                DEBUG_FILTER_LOG(LOG_FILTER_AHBOT_BUYER, "AHBot: Entry %u changed since the bid was planned, skipped", operation.auctionId);
+                return;
+            }
+
+            auction->UpdateBid(operation.bid);
+            break;
+        }
     }
 }
 /** @} */
@@ -31,6 +31,12 @@
 #include "SharedDefines.h"
 #include "Item.h"
 
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
 /**
  * This is the AuctionHouseBot and it is used to make less populated servers
  * appear more populated than they actually are by having auctions created by
@@ -125,6 +131,7 @@ enum AuctionBotConfigUInt32Values
     CONFIG_UINT32_AHBOT_CLASS_TRADEGOOD_MAX_ITEM_LEVEL,
     CONFIG_UINT32_AHBOT_CLASS_CONTAINER_MIN_ITEM_LEVEL,
     CONFIG_UINT32_AHBOT_CLASS_CONTAINER_MAX_ITEM_LEVEL,
+    CONFIG_UINT32_AHBOT_OPERATIONS_PER_TICK,
     CONFIG_UINT32_AHBOT_UINT32_COUNT
 };
 
@@ -152,6 +159,7 @@ enum AuctionBotConfigBoolValues
     CONFIG_BOOL_AHBOT_SELLER_ENABLED,
     CONFIG_BOOL_AHBOT_BUYER_ENABLED,
     CONFIG_BOOL_AHBOT_LOCKBOX_ENABLED,
+    CONFIG_BOOL_AHBOT_BACKGROUND,
     CONFIG_UINT32_AHBOT_BOOL_COUNT
 };
 
@@ -350,6 +358,64 @@ class AuctionBotConfig
 
 #define sAuctionBotConfig MaNGOS::Singleton<AuctionBotConfig>::Instance()
 
+/**
+ * @brief An auction as the agents see it while planning, copied from the auction house by the
+ * world thread so the planning never touches auctions or items.
+ *
+ */
+struct AuctionBotAuction
+{
+    uint32 Id;
+    uint32 itemEntry;
+    uint32 itemCount;
+    ItemPrototype const* proto;
+    uint32 owner;                                           ///< 0 for auctions of the bot
+    uint32 startbid;
+    uint32 bid;
+    uint32 bidder;
+    uint32 buyout;
+    uint32 outBid;                                          ///< AuctionEntry::GetAuctionOutBid at the copy
+};
+
+/**
+ * @brief The auctions of one house with an item, in auction id order
+ *
+ */
+typedef std::vector<AuctionBotAuction> AuctionBotSnapshot;
+
+/**
+ * @brief What an agent wants to do in the auction house
+ *
+ */
+enum AuctionBotOperationType
+{
+    AHBOT_OPERATION_ADD,                                    ///< create an item and put it up for sale
+    AHBOT_OPERATION_BID,
+    AHBOT_OPERATION_BUY
+};
+
+/**
+ * @brief An operation planned by an agent, applied by the world thread in
+ * \ref AuctionHouseBot::ApplyOperations. A bid or buy is dropped if the auction is gone or got
+ * another bid since the snapshot it was planned with.
+ *
+ */
+struct AuctionBotOperation
+{
+    AuctionBotOperationType type;
+    AuctionHouseType houseType;
+    AuctionHouseEntry const* auctionHouseEntry;             ///< for AHBOT_OPERATION_ADD
+    uint32 itemEntry;                                       ///< for AHBOT_OPERATION_ADD
+    uint32 stackCount;                                      ///< for AHBOT_OPERATION_ADD
+    uint32 etime;                                           ///< auction time in seconds, for AHBOT_OPERATION_ADD
+    uint32 auctionId;                                       ///< for AHBOT_OPERATION_BID and AHBOT_OPERATION_BUY
+    uint32 expectedBid;                                     ///< bid of the auction in the snapshot
+    uint32 bid;                                             ///< start bid, the new bid or the buyout price
+    uint32 buyout;                                          ///< for AHBOT_OPERATION_ADD
+};
+
+typedef std::vector<AuctionBotOperation> AuctionBotOperations;
+
 /**
  * @brief This is the base interface for the \ref AuctionBotSeller and \ref AuctionBotBuyer classes
  * which in itself only provides the possibility to use dynamic_cast in some of the
@@ -382,15 +448,24 @@ class AuctionBotAgent
         virtual bool Initialize() = 0;
 
         /**
-         * @brief This method updates what's going on on the AH for the bots, ie: if this is called for the
-         * \ref AuctionBotBuyer it will place bids on items etc if there's a config file for it. If
-         * the \ref AuctionBotSeller is called instead it would put up some new items if there's a
-         * config file for it.
+         * @brief Checks if the agent does business in the house at all, so a snapshot of it is needed.
+         *
+         * @param houseType the house type to check
+         * @return bool true if \ref AuctionBotAgent::Plan should be called for the house
+         */
+        virtual bool IsActive(AuctionHouseType houseType) const = 0;
+
+        /**
+         * @brief This method plans what's going on on the AH for the bots, ie: if this is called for the
+         * \ref AuctionBotBuyer it will plan bids on items etc. If the \ref AuctionBotSeller is called
+         * instead it would plan to put up some new items. It may run in the planning thread, so it
+         * must only use the snapshot, the item templates and its own data.
          *
-         * @param houseType the house type we should work with while updating
-         * @return bool true if any update was actually done, ie: we put some items up/bought some, false otherwise
+         * @param houseType the house type we should work with
+         * @param auctions snapshot of the auctions of the house
+         * @param operations the planned operations are added here
          */
-        virtual bool Update(AuctionHouseType houseType) = 0;
+        virtual void Plan(AuctionHouseType houseType, AuctionBotSnapshot const& auctions, AuctionBotOperations& operations) = 0;
 };
 
 /**
@@ -417,9 +492,13 @@ typedef AuctionHouseBotStatusInfoPerType AuctionHouseBotStatusInfo[MAX_AUCTION_H
  * (holder of AuctionBotBuyer and AuctionBotSeller objects)
  * (Taken from comments in source)
  *
+ * The agents plan in a background thread on a snapshot of the auction house taken by the world
+ * thread (AuctionHouseBot.Background), the world thread applies the planned operations then with
+ * AuctionHouseBot.OperationsPerTick operations per world tick.
+ *
  * \todo Better description here perhaps
  */
-class AuctionHouseBot
+class AuctionHouseBot : protected ACE_Task_Base
 {
     public:
         /**
@@ -435,11 +514,28 @@ class AuctionHouseBot
 
         /**
          * @brief Updates the \ref AuctionHouseBot by checking if either the \ref AuctionBotSeller or
-         * \ref AuctionBotBuyer wants to sell/buy anything and in that case lets one of them do
-         * that and the other one will have to wait until the next call to \ref AuctionHouseBot::Update
+         * \ref AuctionBotBuyer wants to sell/buy anything and in that case lets one of them plan
+         * that and the other one will have to wait until the next call to \ref AuctionHouseBot::Update.
+         * Nothing is started while the last plan is not done or its operations are not applied.
          *
          */
         void Update();
+        /**
+         * @brief Applies the next planned operations, at most AuctionHouseBot.OperationsPerTick
+         *
+         */
+        void ApplyOperations();
+        /**
+         * @brief Checks if planned operations wait for \ref AuctionHouseBot::ApplyOperations
+         *
+         * @return bool
+         */
+        bool HasOperations() const;
+        /**
+         * @brief Stops the planning thread, the agents plan in the world thread then
+         *
+         */
+        void Deactivate();
         /**
          * @brief Initializes this instance.
          *
@@ -501,17 +597,59 @@ class AuctionHouseBot
          * @param statusInfo the structure to fill with data
          */
         void PrepareStatusInfos(AuctionHouseBotStatusInfo& statusInfo);
+
+    protected:
+        /**
+         * @brief The planning thread
+         *
+         * @return int
+         */
+        int svc() override;
+
     private:
         /**
          * @brief Initializes the agents, ie: the \ref AuctionBotBuyer and \ref AuctionBotSeller
          *
          */
         void InitilizeAgents();
+        /**
+         * @brief Starts the planning thread if AuctionHouseBot.Background is set and there are agents
+         *
+         */
+        void Activate();
+        /**
+         * @brief Blocks until the planning thread is done with its plan, before the agents are changed
+         *
+         */
+        void WaitPlanDone();
+        /**
+         * @brief Copies the auctions of a house for planning
+         *
+         * @param houseType
+         * @param auctions
+         */
+        void TakeSnapshot(AuctionHouseType houseType, AuctionBotSnapshot& auctions) const;
+        /**
+         * @brief Applies an operation when it is still possible
+         *
+         * @param operation
+         */
+        void ApplyOperation(AuctionBotOperation const& operation);
 
         AuctionBotAgent* m_Buyer; /**< The buyer (\ref AuctionBotBuyer) for this \ref AuctionHouseBot */
         AuctionBotAgent* m_Seller; /**< The seller (\ref AuctionBotSeller) for this \ref AuctionHouseBot */
 
         uint32 m_OperationSelector; /**< 0..2*MAX_AUCTION_HOUSE_TYPE-1 */
+
+        mutable ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_planCondition; /**< signaled when a plan is handed over or at stop */
+        ACE_Condition_Thread_Mutex m_planDoneCondition; /**< signaled when the planning thread is done with a plan */
+        bool m_active; /**< the planning thread runs */
+        bool m_stopping;
+        AuctionBotAgent* m_planAgent; /**< agent of the plan handed over, NULL while the thread waits */
+        AuctionHouseType m_planHouse;
+        AuctionBotSnapshot m_planAuctions;
+        std::deque<AuctionBotOperation> m_operations; /**< planned, not yet applied operations */
 };
 
 
@@ -599,7 +599,61 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     recv_data >> auctionSlotID >> auctionMainCategory >> auctionSubCategory >> quality;
     recv_data >> usable;
 
-    AuctionHouseEntry const* auctionHouseEntry = GetCheckedAuctionHouseForAuctioneer(auctioneerGuid);
+    // DEBUG_LOG("Auctionhouse search %s list from: %u, searchedname: %s, levelmin: %u, levelmax: %u, auctionSlotID: %u, auctionMainCategory: %u, auctionSubCategory: %u, quality: %u, usable: %u",
+    //  auctioneerGuid.GetString().c_str(), listfrom, searchedname.c_str(), levelmin, levelmax, auctionSlotID, auctionMainCategory, auctionSubCategory, quality, usable);
+
+    AuctionSearchRequest request;
+    request.auctioneerGuid = auctioneerGuid;
+    request.listfrom = listfrom;
+    request.usable = usable;
+    request.filter.levelMin = levelmin;
+    request.filter.levelMax = levelmax;
+    request.filter.inventoryType = auctionSlotID;
+    request.filter.itemClass = auctionMainCategory;
+    request.filter.itemSubClass = auctionSubCategory;
+    request.filter.quality = quality;
+
+    // converting string that we try to find to lower case
+    if (!Utf8toWStr(searchedname, request.filter.name))
+        { return; }
+
+    wstrToLower(request.filter.name);
+
+    // over the budget the search is answered from WorldSession::Update later,
+    // a newer search replaces it as the client shows only the last result
+    if (!HasAuctionSearchCredit())
+    {
+        if (!m_pendingAuctionSearch)
+            { m_pendingAuctionSearch = new AuctionSearchRequest; }
+
+        *m_pendingAuctionSearch = request;
+        return;
+    }
+
+    delete m_pendingAuctionSearch;
+    m_pendingAuctionSearch = NULL;
+
+    SendAuctionListResult(request);
+}
+
+bool WorldSession::HasAuctionSearchCredit()
+{
+    uint32 budget = sWorld.getConfig(CONFIG_UINT32_AUCTION_SEARCH_BUDGET);
+    if (!budget)
+        { return true; }
+
+    // refill by the budget per second, up to one second of budget
+    uint32 now = WorldTimer::getMSTime();
+    int64 credit = int64(m_auctionSearchCredit) + int64(WorldTimer::getMSTimeDiff(m_auctionSearchCreditTime, now)) * budget / IN_MILLISECONDS;
+    m_auctionSearchCredit = int32(std::min(credit, int64(budget)));
+    m_auctionSearchCreditTime = now;
+
+    return m_auctionSearchCredit > 0;
+}
+
+void WorldSession::SendAuctionListResult(AuctionSearchRequest const& request)
+{
+    AuctionHouseEntry const* auctionHouseEntry = GetCheckedAuctionHouseForAuctioneer(request.auctioneerGuid);
     if (!auctionHouseEntry)
         { return; }
 
@@ -610,25 +664,16 @@ void WorldSession::HandleAuctionListItems(WorldPacket& recv_data)
     if (GetPlayer()->hasUnitState(UNIT_STAT_DIED))
         { GetPlayer()->RemoveSpellsCausingAura(SPELL_AURA_FEIGN_DEATH); }
 
-    // DEBUG_LOG("Auctionhouse search %s list from: %u, searchedname: %s, levelmin: %u, levelmax: %u, auctionSlotID: %u, auctionMainCategory: %u, auctionSubCategory: %u, quality: %u, usable: %u",
-    //  auctioneerGuid.GetString().c_str(), listfrom, searchedname.c_str(), levelmin, levelmax, auctionSlotID, auctionMainCategory, auctionSubCategory, quality, usable);
-
     WorldPacket data(SMSG_AUCTION_LIST_RESULT, (4 + 4));
     uint32 count = 0;
     uint32 totalcount = 0;
     data << uint32(0);
 
-    // converting string that we try to find to lower case
-    std::wstring wsearchedname;
-    if (!Utf8toWStr(searchedname, wsearchedname))
-        { return; }
-
-    wstrToLower(wsearchedname);
+    uint32 cost = sAuctionMgr.BuildListAuctionItems(auctionHouse, data, _player, request, count, totalcount);
 
-    auctionHouse->BuildListAuctionItems(data, _player,
-                                        wsearchedname, listfrom, levelmin, levelmax, usable,
-                                        auctionSlotID, auctionMainCategory, auctionSubCategory, quality,
-                                        count, totalcount);
+    // the credit may go below zero, a large search then delays the following ones longer
+    if (sWorld.getConfig(CONFIG_UINT32_AUCTION_SEARCH_BUDGET))
+        { m_auctionSearchCredit -= int32(cost); }
 
     data.put<uint32>(0, count);
     data << uint32(totalcount);
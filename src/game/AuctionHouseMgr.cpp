@@ -470,6 +470,101 @@ void AuctionHouseMgr::Update()
 {
     for (int i = 0; i < MAX_AUCTION_HOUSE_TYPE; ++i)
         { mAuctions[i].Update(); }
+
+    PurgeSearchCache();
+}
+
+bool AuctionHouseMgr::SearchCacheKey::operator<(SearchCacheKey const& other) const
+{
+    if (auctionHouse != other.auctionHouse)
+        { return auctionHouse < other.auctionHouse; }
+    if (locale != other.locale)
+        { return locale < other.locale; }
+    if (listfrom != other.listfrom)
+        { return listfrom < other.listfrom; }
+    if (filter.levelMin != other.filter.levelMin)
+        { return filter.levelMin < other.filter.levelMin; }
+    if (filter.levelMax != other.filter.levelMax)
+        { return filter.levelMax < other.filter.levelMax; }
+    if (filter.inventoryType != other.filter.inventoryType)
+        { return filter.inventoryType < other.filter.inventoryType; }
+    if (filter.itemClass != other.filter.itemClass)
+        { return filter.itemClass < other.filter.itemClass; }
+    if (filter.itemSubClass != other.filter.itemSubClass)
+        { return filter.itemSubClass < other.filter.itemSubClass; }
+    if (filter.quality != other.filter.quality)
+        { return filter.quality < other.filter.quality; }
+    return filter.name < other.filter.name;
+}
+
+uint32 AuctionHouseMgr::BuildListAuctionItems(AuctionHouseObject* auctionHouse, WorldPacket& data, Player* player,
+        AuctionSearchRequest const& request, uint32& count, uint32& totalcount)
+{
+    uint32 cacheTime = sWorld.getConfig(CONFIG_UINT32_AUCTION_SEARCH_CACHE_TIME);
+    if (!cacheTime || request.usable)
+        { return auctionHouse->BuildListAuctionItems(data, player, request, count, totalcount); }
+
+    SearchCacheKey key;
+    key.auctionHouse = auctionHouse;
+    key.locale = player->GetSession()->GetSessionDbLocaleIndex();
+    key.listfrom = request.listfrom;
+    key.filter = request.filter;
+    if (!key.filter.levelMin)
+        { key.filter.levelMax = 0; }                        // ignored then, same search for any value
+
+    uint32 now = WorldTimer::getMSTime();
+
+    SearchCache::iterator itr = m_searchCache.find(key);
+    if (itr != m_searchCache.end())
+    {
+        SearchCacheEntry const& entry = itr->second;
+        if (entry.generation == auctionHouse->GetGeneration() && WorldTimer::getMSTimeDiff(entry.time, now) < cacheTime)
+        {
+            if (!entry.auctions.empty())
+                { data.append(entry.auctions.contents(), entry.auctions.size()); }
+
+            count = entry.count;
+            totalcount = entry.totalcount;
+            return entry.count;                             // only the copy of the page
+        }
+
+        m_searchCache.erase(itr);
+    }
+
+    size_t start = data.size();
+    uint32 cost = auctionHouse->BuildListAuctionItems(data, player, request, count, totalcount);
+
+    if (m_searchCache.size() >= MAX_AUCTION_SEARCH_CACHE_SIZE)
+    {
+        PurgeSearchCache();
+        if (m_searchCache.size() >= MAX_AUCTION_SEARCH_CACHE_SIZE)
+            { m_searchCache.clear(); }
+    }
+
+    SearchCacheEntry& entry = m_searchCache[key];
+    entry.generation = auctionHouse->GetGeneration();
+    entry.time = now;
+    entry.count = count;
+    entry.totalcount = totalcount;
+    if (data.size() > start)
+        { entry.auctions.append(data.contents() + start, data.size() - start); }
+
+    return cost;
+}
+
+void AuctionHouseMgr::PurgeSearchCache()
+{
+    uint32 cacheTime = sWorld.getConfig(CONFIG_UINT32_AUCTION_SEARCH_CACHE_TIME);
+    uint32 now = WorldTimer::getMSTime();
+
+    for (SearchCache::iterator itr = m_searchCache.begin(); itr != m_searchCache.end();)
+    {
+        if (itr->second.generation != itr->first.auctionHouse->GetGeneration() ||
+            WorldTimer::getMSTimeDiff(itr->second.time, now) >= cacheTime)
+            { m_searchCache.erase(itr++); }
+        else
+            { ++itr; }
+    }
 }
 
 uint32 AuctionHouseMgr::GetAuctionHouseTeam(AuctionHouseEntry const* house)
@@ -566,8 +661,10 @@ void AuctionHouseObject::Update()
 
                 itr->second->DeleteFromDB();
                 sAuctionMgr.RemoveAItem(itr->second->itemGuidLow);
+                m_searchIndex.RemoveAuction(itr->second);
                 delete itr->second;
                 AuctionsMap.erase(itr++);
+                OnAuctionChanged();
                 continue;
             }
         }
@@ -604,68 +701,46 @@ void AuctionHouseObject::BuildListOwnerItems(WorldPacket& data, Player* player,
     }
 }
 
-void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player,
-        std::wstring const& wsearchedname, uint32 listfrom, uint32 levelmin, uint32 levelmax, uint32 usable,
-        uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality,
+uint32 AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player, AuctionSearchRequest const& request,
         uint32& count, uint32& totalcount)
 {
-    int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
+    // only auctions of item templates passing the filters
+    std::vector<AuctionEntry*> auctions;
+    m_searchIndex.FindAuctions(request.filter, player->GetSession()->GetSessionDbLocaleIndex(), auctions);
 
-    for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
+    for (std::vector<AuctionEntry*>::const_iterator itr = auctions.begin(); itr != auctions.end(); ++itr)
     {
-        AuctionEntry* Aentry = itr->second;
+        AuctionEntry* Aentry = *itr;
         Item* item = sAuctionMgr.GetAItem(Aentry->itemGuidLow);
         if (!item)
             { continue; }
 
+        if (request.usable != 0x00)
         {
-            ItemPrototype const* proto = item->GetProto();
-
-            if (itemClass != 0xffffffff && proto->Class != itemClass)
-                { continue; }
-
-            if (itemSubClass != 0xffffffff && proto->SubClass != itemSubClass)
-                { continue; }
-
-            if (inventoryType != 0xffffffff && proto->InventoryType != inventoryType)
-                { continue; }
-
-            if (quality != 0xffffffff && proto->Quality < quality)
+            if (player->CanUseItem(item) != EQUIP_ERR_OK)
                 { continue; }
 
-            if (levelmin != 0x00 && (proto->RequiredLevel < levelmin || (levelmax != 0x00 && proto->RequiredLevel > levelmax)))
-                { continue; }
-
-            if (usable != 0x00)
+            ItemPrototype const* proto = item->GetProto();
+            if (proto->Class == ITEM_CLASS_RECIPE)
             {
-                if (player->CanUseItem(item) != EQUIP_ERR_OK)
-                    continue;
-
-                if (proto->Class == ITEM_CLASS_RECIPE)
+                if (SpellEntry const* spell = sSpellStore.LookupEntry(proto->Spells[0].SpellId))
                 {
-                    if (SpellEntry const* spell = sSpellStore.LookupEntry(proto->Spells[0].SpellId))
-                    {
-                        if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
-                            continue;
-                    }
+                    if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
+                        { continue; }
                 }
             }
+        }
 
-            std::string name = proto->Name1;
-            sObjectMgr.GetItemLocaleStrings(proto->ItemId, loc_idx, &name);
-
-            if (!wsearchedname.empty() && !Utf8FitTo(name, wsearchedname))
-                { continue; }
-
-            if (count < 50 && totalcount >= listfrom)
-            {
-                ++count;
-                Aentry->BuildAuctionInfo(data);
-            }
+        if (count < 50 && totalcount >= request.listfrom)
+        {
+            ++count;
+            Aentry->BuildAuctionInfo(data);
         }
 
         ++totalcount;
     }
+
+    return auctions.size();
 }
 
 AuctionEntry* AuctionHouseObject::AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout, uint32 deposit, Player* pl /*= NULL*/)
@@ -812,6 +887,7 @@ bool AuctionEntry::UpdateBid(uint32 newbid, Player* newbidder /*=NULL*/)
 
     bidder = newbidder ? newbidder->GetGUIDLow() : 0;
     bid = newbid;
+    sAuctionMgr.GetAuctionsMap(auctionHouseEntry)->OnAuctionChanged();
 
     if ((newbid < buyout) || (buyout == 0))                 // bid
     {
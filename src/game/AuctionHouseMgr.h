@@ -42,6 +42,9 @@
 #include "SharedDefines.h"
 #include "Policies/Singleton.h"
 #include "DBCStructure.h"
+#include "ObjectGuid.h"
+#include "ByteBuffer.h"
+#include "AuctionSearchIndex.h"
 
 /** \addtogroup auctionhouse
  * @{
@@ -54,6 +57,7 @@ class Unit;
 class WorldPacket;
 
 #define MIN_AUCTION_TIME (2*HOUR)
+#define MAX_AUCTION_SEARCH_CACHE_SIZE 1024                  // cached search result pages over all houses
 
 /**
  * Documentation for this taken directly from comments in source
@@ -107,11 +111,20 @@ struct AuctionEntry
     bool UpdateBid(uint32 newbid, Player* newbidder = NULL);// true if normal bid, false if buyout, bidder==NULL for generated bid
 };
 
+/// a CMSG_AUCTION_LIST_ITEMS search, kept by the session while it is paced
+struct AuctionSearchRequest
+{
+    ObjectGuid auctioneerGuid;
+    AuctionSearchFilter filter;
+    uint32 listfrom;                                        // first auction of the page, pages have 50 auctions
+    uint32 usable;                                          // only items the player can use, never cached
+};
+
 // this class is used as auctionhouse instance
 class AuctionHouseObject
 {
     public:
-        AuctionHouseObject() {}
+        AuctionHouseObject() : m_generation(0) {}
         ~AuctionHouseObject();
         //{
         //    for (AuctionEntryMap::const_iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end(); ++itr)
@@ -130,6 +143,8 @@ class AuctionHouseObject
         {
             MANGOS_ASSERT(ah);
             AuctionsMap[ah->Id] = ah;
+            m_searchIndex.AddAuction(ah);
+            OnAuctionChanged();
         }
 
         AuctionEntry* GetAuction(uint32 id) const
@@ -140,20 +155,36 @@ class AuctionHouseObject
 
         bool RemoveAuction(uint32 id)
         {
-            return AuctionsMap.erase(id);
+            AuctionEntryMap::iterator itr = AuctionsMap.find(id);
+            if (itr == AuctionsMap.end())
+                { return false; }
+
+            m_searchIndex.RemoveAuction(itr->second);
+            AuctionsMap.erase(itr);
+            OnAuctionChanged();
+            return true;
         }
 
+        /// changes with every added or removed auction and every bid, search results of another generation are outdated
+        uint32 GetGeneration() const { return m_generation; }
+        void OnAuctionChanged() { ++m_generation; }
+
         void Update();
 
         void BuildListBidderItems(WorldPacket& data, Player* player, uint32& count, uint32& totalcount);
         void BuildListOwnerItems(WorldPacket& data, Player* player, uint32& count, uint32& totalcount);
-        void BuildListAuctionItems(WorldPacket& data, Player* player,
-                                   std::wstring const& searchedname, uint32 listfrom, uint32 levelmin, uint32 levelmax, uint32 usable,
-                                   uint32 inventoryType, uint32 itemClass, uint32 itemSubClass, uint32 quality,
-                                   uint32& count, uint32& totalcount);
+        /**
+         * @brief builds the auctions of a search page
+         *
+         * @return uint32 number of auctions the search went through, the cost of the search
+         */
+        uint32 BuildListAuctionItems(WorldPacket& data, Player* player, AuctionSearchRequest const& request,
+                                     uint32& count, uint32& totalcount);
         AuctionEntry* AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout = 0, uint32 deposit = 0, Player* pl = NULL);
     private:
         AuctionEntryMap AuctionsMap;
+        AuctionSearchIndex m_searchIndex;                   // for BuildListAuctionItems
+        uint32 m_generation;
 };
 
 /**
@@ -208,12 +239,53 @@ class AuctionHouseMgr
         void AddAItem(Item* it);
         bool RemoveAItem(uint32 id);
 
+        /**
+         * @brief builds a search page, from the search cache when the same search was done recently
+         *
+         * Searches without the usable filter don't depend on the player, their pages are cached for
+         * Auction.SearchCache.Time ms or until an auction of the house changes.
+         *
+         * @param auctionHouse
+         * @param data packet the auctions are appended to
+         * @param player
+         * @param request
+         * @param count auctions of the page
+         * @param totalcount auctions found by the search
+         * @return uint32 cost of the search, see AuctionHouseObject::BuildListAuctionItems
+         */
+        uint32 BuildListAuctionItems(AuctionHouseObject* auctionHouse, WorldPacket& data, Player* player,
+                                     AuctionSearchRequest const& request, uint32& count, uint32& totalcount);
+
         void Update();
 
     private:
+        struct SearchCacheKey
+        {
+            AuctionHouseObject const* auctionHouse;
+            int locale;
+            uint32 listfrom;
+            AuctionSearchFilter filter;
+
+            bool operator<(SearchCacheKey const& other) const;
+        };
+
+        struct SearchCacheEntry
+        {
+            uint32 generation;
+            uint32 time;                                    // ms time of the search
+            uint32 count;
+            uint32 totalcount;
+            ByteBuffer auctions;                            // the auction infos of the page
+        };
+
+        typedef std::map<SearchCacheKey, SearchCacheEntry> SearchCache;
+
+        void PurgeSearchCache();
+
         AuctionHouseObject  mAuctions[MAX_AUCTION_HOUSE_TYPE];
 
         ItemMap             mAitems;
+        SearchCache         m_searchCache;
 };
 
 /// Convenience define to access the singleton object for the Auction House Manager
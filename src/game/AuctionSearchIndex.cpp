@@ -0,0 +1,286 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "AuctionSearchIndex.h"
+#include "AuctionHouseMgr.h"
+#include "ItemPrototype.h"
+#include "ObjectMgr.h"
+#include "Util.h"
+
+#include <algorithm>
+
+/// Trigram of a lower case name, 21 bits cover each unicode character
+static uint64 MakeTrigram(std::wstring const& name, size_t pos)
+{
+    return (uint64(name[pos] & 0x1FFFFF) << 42) | (uint64(name[pos + 1] & 0x1FFFFF) << 21) | uint64(name[pos + 2] & 0x1FFFFF);
+}
+
+static void AddToIndex(std::map<uint32, std::set<uint32> >& index, uint32 key, uint32 entry)
+{
+    index[key].insert(entry);
+}
+
+static void RemoveFromIndex(std::map<uint32, std::set<uint32> >& index, uint32 key, uint32 entry)
+{
+    std::map<uint32, std::set<uint32> >::iterator itr = index.find(key);
+    if (itr == index.end())
+        { return; }
+
+    itr->second.erase(entry);
+    if (itr->second.empty())
+        { index.erase(itr); }
+}
+
+/// Candidate templates of the keys lo..hi of an index
+struct TemplateRange
+{
+    TemplateRange() : index(NULL), lo(0), hi(0), size(0) {}
+
+    TemplateRange(std::map<uint32, std::set<uint32> > const& templateIndex, uint32 low, uint32 high) :
+        index(&templateIndex), lo(low), hi(high), size(0)
+    {
+        std::map<uint32, std::set<uint32> >::const_iterator end = index->upper_bound(hi);
+        for (std::map<uint32, std::set<uint32> >::const_iterator itr = index->lower_bound(lo); itr != end; ++itr)
+            { size += itr->second.size(); }
+    }
+
+    std::map<uint32, std::set<uint32> > const* index;
+    uint32 lo;
+    uint32 hi;
+    size_t size;
+};
+
+void AuctionSearchIndex::AddAuction(AuctionEntry* auction)
+{
+    TemplateMap::iterator itr = m_templates.find(auction->itemTemplate);
+    if (itr == m_templates.end())
+    {
+        ItemPrototype const* proto = ObjectMgr::GetItemPrototype(auction->itemTemplate);
+        if (!proto)
+            { return; }                                     // can't be found by a search
+
+        itr = m_templates.insert(TemplateMap::value_type(auction->itemTemplate, TemplateEntry())).first;
+        itr->second.proto = proto;
+        AddTemplate(auction->itemTemplate, proto);
+    }
+
+    itr->second.auctions[auction->Id] = auction;
+}
+
+void AuctionSearchIndex::RemoveAuction(AuctionEntry const* auction)
+{
+    TemplateMap::iterator itr = m_templates.find(auction->itemTemplate);
+    if (itr == m_templates.end())
+        { return; }
+
+    itr->second.auctions.erase(auction->Id);
+    if (!itr->second.auctions.empty())
+        { return; }
+
+    RemoveTemplate(itr->first, itr->second.proto);
+    m_templates.erase(itr);
+}
+
+void AuctionSearchIndex::AddTemplate(uint32 entry, ItemPrototype const* proto)
+{
+    AddToIndex(m_byClass, proto->Class << 16 | proto->SubClass, entry);
+    AddToIndex(m_byInventoryType, proto->InventoryType, entry);
+    AddToIndex(m_byQuality, proto->Quality, entry);
+    AddToIndex(m_byLevel, proto->RequiredLevel, entry);
+
+    for (NameIndexMap::iterator itr = m_names.begin(); itr != m_names.end(); ++itr)
+        { AddName(itr->second, entry, itr->first); }
+}
+
+void AuctionSearchIndex::RemoveTemplate(uint32 entry, ItemPrototype const* proto)
+{
+    RemoveFromIndex(m_byClass, proto->Class << 16 | proto->SubClass, entry);
+    RemoveFromIndex(m_byInventoryType, proto->InventoryType, entry);
+    RemoveFromIndex(m_byQuality, proto->Quality, entry);
+    RemoveFromIndex(m_byLevel, proto->RequiredLevel, entry);
+
+    for (NameIndexMap::iterator itr = m_names.begin(); itr != m_names.end(); ++itr)
+        { RemoveName(itr->second, entry); }
+}
+
+void AuctionSearchIndex::AddName(NameIndex& index, uint32 entry, int locale)
+{
+    std::string name = m_templates[entry].proto->Name1;
+    sObjectMgr.GetItemLocaleStrings(entry, locale, &name);
+
+    // a name that isn't valid utf8 is never found, as by Utf8FitTo
+    std::wstring& wname = index.names[entry];
+    if (!Utf8toWStr(name, wname))
+    {
+        wname.clear();
+        return;
+    }
+
+    wstrToLower(wname);
+    for (size_t i = 0; i + 3 <= wname.size(); ++i)
+        { index.trigrams[MakeTrigram(wname, i)].insert(entry); }
+}
+
+void AuctionSearchIndex::RemoveName(NameIndex& index, uint32 entry)
+{
+    UNORDERED_MAP<uint32, std::wstring>::iterator itr = index.names.find(entry);
+    if (itr == index.names.end())
+        { return; }
+
+    std::wstring const& wname = itr->second;
+    for (size_t i = 0; i + 3 <= wname.size(); ++i)
+    {
+        std::map<uint64, TemplateSet>::iterator gram = index.trigrams.find(MakeTrigram(wname, i));
+        if (gram == index.trigrams.end())
+            { continue; }
+
+        gram->second.erase(entry);
+        if (gram->second.empty())
+            { index.trigrams.erase(gram); }
+    }
+
+    index.names.erase(itr);
+}
+
+AuctionSearchIndex::NameIndex& AuctionSearchIndex::GetNameIndex(int locale)
+{
+    NameIndexMap::iterator itr = m_names.find(locale);
+    if (itr != m_names.end())
+        { return itr->second; }
+
+    NameIndex& index = m_names[locale];
+    for (TemplateMap::const_iterator tmpl = m_templates.begin(); tmpl != m_templates.end(); ++tmpl)
+        { AddName(index, tmpl->first, locale); }
+
+    return index;
+}
+
+bool AuctionSearchIndex::MatchesFilter(ItemPrototype const* proto, AuctionSearchFilter const& filter)
+{
+    if (filter.itemClass != 0xffffffff && proto->Class != filter.itemClass)
+        { return false; }
+
+    if (filter.itemSubClass != 0xffffffff && proto->SubClass != filter.itemSubClass)
+        { return false; }
+
+    if (filter.inventoryType != 0xffffffff && proto->InventoryType != filter.inventoryType)
+        { return false; }
+
+    if (filter.quality != 0xffffffff && proto->Quality < filter.quality)
+        { return false; }
+
+    if (filter.levelMin != 0x00 && (proto->RequiredLevel < filter.levelMin || (filter.levelMax != 0x00 && proto->RequiredLevel > filter.levelMax)))
+        { return false; }
+
+    return true;
+}
+
+static bool AuctionIdLess(AuctionEntry const* a, AuctionEntry const* b)
+{
+    return a->Id < b->Id;
+}
+
+void AuctionSearchIndex::FindAuctions(AuctionSearchFilter const& filter, int locale, std::vector<AuctionEntry*>& auctions)
+{
+    auctions.clear();
+
+    // the smallest index range of the filters, all templates without any
+    TemplateRange best;
+    best.size = m_templates.size();
+
+    std::vector<TemplateRange> ranges;
+    if (filter.itemClass != 0xffffffff)
+    {
+        uint32 lo = filter.itemClass << 16 | (filter.itemSubClass != 0xffffffff ? filter.itemSubClass : 0);
+        uint32 hi = filter.itemSubClass != 0xffffffff ? lo : (filter.itemClass << 16 | 0xFFFF);
+        ranges.push_back(TemplateRange(m_byClass, lo, hi));
+    }
+    if (filter.inventoryType != 0xffffffff)
+        { ranges.push_back(TemplateRange(m_byInventoryType, filter.inventoryType, filter.inventoryType)); }
+    if (filter.quality != 0xffffffff)
+        { ranges.push_back(TemplateRange(m_byQuality, filter.quality, 0xffffffff)); }
+    if (filter.levelMin != 0x00)
+        { ranges.push_back(TemplateRange(m_byLevel, filter.levelMin, filter.levelMax != 0x00 ? filter.levelMax : 0xffffffff)); }
+
+    for (std::vector<TemplateRange>::const_iterator itr = ranges.begin(); itr != ranges.end(); ++itr)
+    {
+        if (itr->size < best.size)
+            { best = *itr; }
+    }
+
+    // names contain all trigrams of the searched part, the rarest one gives the candidates
+    NameIndex* names = filter.name.empty() ? NULL : &GetNameIndex(locale);
+    TemplateSet const* nameCandidates = NULL;
+    if (names && filter.name.size() >= 3)
+    {
+        for (size_t i = 0; i + 3 <= filter.name.size(); ++i)
+        {
+            std::map<uint64, TemplateSet>::const_iterator gram = names->trigrams.find(MakeTrigram(filter.name, i));
+            if (gram == names->trigrams.end())
+                { return; }                                 // no name has it
+
+            if (!nameCandidates || gram->second.size() < nameCandidates->size())
+                { nameCandidates = &gram->second; }
+        }
+
+        if (nameCandidates->size() >= best.size)
+            { nameCandidates = NULL; }
+    }
+
+    std::vector<uint32> candidates;
+    if (nameCandidates)
+        { candidates.assign(nameCandidates->begin(), nameCandidates->end()); }
+    else if (best.index)
+    {
+        std::map<uint32, TemplateSet>::const_iterator end = best.index->upper_bound(best.hi);
+        for (std::map<uint32, TemplateSet>::const_iterator itr = best.index->lower_bound(best.lo); itr != end; ++itr)
+            { candidates.insert(candidates.end(), itr->second.begin(), itr->second.end()); }
+    }
+    else
+    {
+        candidates.reserve(m_templates.size());
+        for (TemplateMap::const_iterator itr = m_templates.begin(); itr != m_templates.end(); ++itr)
+            { candidates.push_back(itr->first); }
+    }
+
+    uint32 matchedTemplates = 0;
+    for (std::vector<uint32>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+    {
+        TemplateMap::const_iterator tmpl = m_templates.find(*itr);
+        if (tmpl == m_templates.end() || !MatchesFilter(tmpl->second.proto, filter))
+            { continue; }
+
+        if (names && names->names[*itr].find(filter.name) == std::wstring::npos)
+            { continue; }
+
+        for (AuctionEntryMap::const_iterator auction = tmpl->second.auctions.begin(); auction != tmpl->second.auctions.end(); ++auction)
+            { auctions.push_back(auction->second); }
+        ++matchedTemplates;
+    }
+
+    // the auctions of each template are in id order already
+    if (matchedTemplates > 1)
+        { std::sort(auctions.begin(), auctions.end(), AuctionIdLess); }
+}
@@ -0,0 +1,119 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_AUCTION_SEARCH_INDEX
+#define MANGOS_H_AUCTION_SEARCH_INDEX
+
+#include "Common.h"
+#include "Utilities/UnorderedMapSet.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/** \addtogroup auctionhouse
+ * @{
+ * \file
+ */
+
+struct AuctionEntry;
+struct ItemPrototype;
+
+/**
+ * Filters of CMSG_AUCTION_LIST_ITEMS that depend on the item template only. As in the packet
+ * 0xffffffff is no filter for the class, subclass, inventory type and quality, 0 for levelMin.
+ */
+struct AuctionSearchFilter
+{
+    std::wstring name;                                      ///< lower case part of the name, empty for any
+    uint32 levelMin;
+    uint32 levelMax;                                        ///< 0 for no limit, ignored without levelMin
+    uint32 inventoryType;
+    uint32 itemClass;
+    uint32 itemSubClass;
+    uint32 quality;                                         ///< lowest quality
+};
+
+/**
+ * Secondary indexes of the auctions of an auction house, so a search touches only auctions of
+ * matching item templates. The templates with auctions are indexed by class and subclass,
+ * inventory type, quality and required level, and per locale by the trigrams of their lower
+ * case names. A search takes the smallest index range of its filters and checks the templates
+ * in there against all filters.
+ */
+class AuctionSearchIndex
+{
+    public:
+        void AddAuction(AuctionEntry* auction);
+        void RemoveAuction(AuctionEntry const* auction);
+
+        /**
+         * @brief the auctions of all item templates matching the filter
+         *
+         * @param filter
+         * @param locale db locale index of the searching session, names of other locales are indexed at their first search
+         * @param auctions filled in auction id order
+         */
+        void FindAuctions(AuctionSearchFilter const& filter, int locale, std::vector<AuctionEntry*>& auctions);
+
+    private:
+        typedef std::map<uint32, AuctionEntry*> AuctionEntryMap;
+        typedef std::set<uint32> TemplateSet;
+        typedef std::map<uint32, TemplateSet> TemplateIndex;
+
+        struct TemplateEntry
+        {
+            ItemPrototype const* proto;
+            AuctionEntryMap auctions;
+        };
+
+        typedef std::map<uint32, TemplateEntry> TemplateMap;
+
+        struct NameIndex
+        {
+            UNORDERED_MAP<uint32, std::wstring> names;      ///< lower case name of the templates
+            std::map<uint64, TemplateSet> trigrams;
+        };
+
+        typedef std::map<int, NameIndex> NameIndexMap;
+
+        void AddTemplate(uint32 entry, ItemPrototype const* proto);
+        void RemoveTemplate(uint32 entry, ItemPrototype const* proto);
+        void AddName(NameIndex& index, uint32 entry, int locale);
+        void RemoveName(NameIndex& index, uint32 entry);
+        NameIndex& GetNameIndex(int locale);
+        static bool MatchesFilter(ItemPrototype const* proto, AuctionSearchFilter const& filter);
+
+        TemplateMap m_templates;
+        TemplateIndex m_byClass;                            ///< key class << 16 | subclass
+        TemplateIndex m_byInventoryType;
+        TemplateIndex m_byQuality;
+        TemplateIndex m_byLevel;
+        NameIndexMap m_names;
+};
+
+/** @} */
+#endif
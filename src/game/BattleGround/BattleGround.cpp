@@ -217,6 +217,7 @@ BattleGround::BattleGround()
     m_LevelMin          = 0;
     m_LevelMax          = 0;
     m_InBGFreeSlotQueue = false;
+    m_IsWarm            = false;
 
     m_MaxPlayersPerTeam = 0;
     m_MaxPlayers        = 0;
@@ -305,7 +306,8 @@ void BattleGround::Update(uint32 diff)
         //      should be used instead of current
         // ]]
         // BattleGround Template instance can not be updated, because it would be deleted
-        if (!GetInvitedCount(HORDE) && !GetInvitedCount(ALLIANCE))
+        // a warm instance waits for its first players
+        if (!IsWarm() && !GetInvitedCount(HORDE) && !GetInvitedCount(ALLIANCE))
             { delete this; }
 
         return;
@@ -587,6 +587,19 @@ class BattleGround
          */
         void RemoveFromBGFreeSlotQueue();                   // this method could delete whole BG instance, if another free is available
 
+        /**
+         * @brief marks an instance kept loaded by BattleGroundMgr until a match needs it
+         *
+         * @param warm
+         */
+        void SetWarm(bool warm) { m_IsWarm = warm; }
+        /**
+         * @brief
+         *
+         * @return bool true while the empty instance must not delete itself
+         */
+        bool IsWarm() const { return m_IsWarm; }
+
         /**
          * @brief
          *
@@ -1292,6 +1305,7 @@ class BattleGround
         int32 m_EndTime;                                    /**< it is set to 120000 when bg is ending and it decreases itself */
         BattleGroundBracketId m_BracketId; /**< TODO */
         bool   m_InBGFreeSlotQueue;                         /**< used to make sure that BG is only once inserted into the BattleGroundMgr.BGFreeSlotQueue[bgTypeId] deque */
+        bool   m_IsWarm;                                    /**< pre-created instance waiting for a match */
         Team   m_Winner;                                    /**< 0=alliance, 1=horde, 2=none */
         int32  m_StartDelayTime; /**< TODO */
         bool   m_PrematureCountDown; /**< TODO */
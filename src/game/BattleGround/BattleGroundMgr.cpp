@@ -47,7 +47,7 @@ INSTANTIATE_SINGLETON_1(BattleGroundMgr);
 /***            BATTLEGROUND QUEUE SYSTEM              ***/
 /*********************************************************/
 
-BattleGroundQueue::BattleGroundQueue()
+BattleGroundQueue::BattleGroundQueue() : m_JoinSequence(0)
 {
     for (uint8 i = 0; i < BG_TEAMS_COUNT; ++i)
     {
@@ -63,16 +63,97 @@ BattleGroundQueue::BattleGroundQueue()
 
 BattleGroundQueue::~BattleGroundQueue()
 {
+    // invited groups are in no bucket, but every group has its players in the queue
+    std::set<GroupQueueInfo*> groups;
+    for (QueuedPlayersMap::const_iterator itr = m_QueuedPlayers.begin(); itr != m_QueuedPlayers.end(); ++itr)
+        { groups.insert(itr->second.GroupInfo); }
+
+    for (std::set<GroupQueueInfo*>::const_iterator itr = groups.begin(); itr != groups.end(); ++itr)
+        { delete(*itr); }
+
     m_QueuedPlayers.clear();
-    for (uint8 i = 0; i < MAX_BATTLEGROUND_BRACKETS; ++i)
+}
+
+/*********************************************************/
+/***      BATTLEGROUND QUEUE GROUP BUCKETS             ***/
+/*********************************************************/
+
+void BattleGroundQueue::GroupBuckets::Insert(GroupQueueInfo* ginfo)
+{
+    uint32 size = std::min(uint32(ginfo->Players.size()), uint32(MAX_QUEUED_GROUP_SIZE));
+    if (!size)
+        { return; }
+
+    // new groups go to the end, only groups moved from the premade queue are inserted in front of others
+    GroupsQueueType& bucket = m_Buckets[size - 1];
+    GroupsQueueType::iterator pos = bucket.end();
+    while (pos != bucket.begin())
     {
-        for (uint8 j = 0; j < BG_QUEUE_GROUP_TYPES_COUNT; ++j)
-        {
-            for (GroupsQueueType::iterator itr = m_QueuedGroups[i][j].begin(); itr != m_QueuedGroups[i][j].end(); ++itr)
-                { delete(*itr); }
-            m_QueuedGroups[i][j].clear();
-        }
+        GroupsQueueType::iterator prev = pos;
+        if ((*--prev)->JoinSequence < ginfo->JoinSequence)
+            { break; }
+        pos = prev;
+    }
+
+    ginfo->BucketPos = bucket.insert(pos, ginfo);
+    ginfo->BucketSize = size;
+    ++m_GroupCount;
+    m_PlayerCount += ginfo->Players.size();
+}
+
+void BattleGroundQueue::GroupBuckets::Erase(GroupQueueInfo* ginfo)
+{
+    if (!ginfo->BucketSize)
+        { return; }
+
+    m_Buckets[ginfo->BucketSize - 1].erase(ginfo->BucketPos);
+    ginfo->BucketSize = 0;
+    --m_GroupCount;
+    m_PlayerCount -= ginfo->Players.size();
+}
+
+GroupQueueInfo* BattleGroundQueue::GroupBuckets::GetOldest() const
+{
+    GroupQueueInfo* oldest = NULL;
+    for (uint32 i = 0; i < MAX_QUEUED_GROUP_SIZE; ++i)
+    {
+        if (!m_Buckets[i].empty() && (!oldest || m_Buckets[i].front()->JoinSequence < oldest->JoinSequence))
+            { oldest = m_Buckets[i].front(); }
+    }
+
+    return oldest;
+}
+
+BattleGroundQueue::GroupCursor::GroupCursor(GroupBuckets const& buckets) :
+    m_Buckets(buckets), m_LastSequence(0)
+{
+    for (uint32 i = 0; i < MAX_QUEUED_GROUP_SIZE; ++i)
+        { m_Pos[i] = m_Buckets.GetBucket(i + 1).begin(); }
+}
+
+GroupQueueInfo* BattleGroundQueue::GroupCursor::Next(uint32 maxSize)
+{
+    maxSize = std::min(maxSize, uint32(MAX_QUEUED_GROUP_SIZE));
+
+    uint32 found = MAX_QUEUED_GROUP_SIZE;
+    for (uint32 i = 0; i < maxSize; ++i)
+    {
+        GroupsQueueType const& bucket = m_Buckets.GetBucket(i + 1);
+
+        // skip the groups of this bucket the cursor passed while the bucket was too large
+        while (m_Pos[i] != bucket.end() && (*m_Pos[i])->JoinSequence <= m_LastSequence)
+            { ++m_Pos[i]; }
+
+        if (m_Pos[i] != bucket.end() && (found == MAX_QUEUED_GROUP_SIZE || (*m_Pos[i])->JoinSequence < (*m_Pos[found])->JoinSequence))
+            { found = i; }
     }
+
+    if (found == MAX_QUEUED_GROUP_SIZE)
+        { return NULL; }
+
+    GroupQueueInfo* ginfo = *m_Pos[found]++;
+    m_LastSequence = ginfo->JoinSequence;
+    return ginfo;
 }
 
 /*********************************************************/
@@ -138,6 +219,18 @@ bool BattleGroundQueue::SelectionPool::AddGroup(GroupQueueInfo* ginfo, uint32 de
     return false;
 }
 
+void BattleGroundQueue::SelectionPool::AddGroups(GroupCursor& cursor, uint32 desiredCount, uint32 enoughCount)
+{
+    while (PlayerCount < enoughCount && PlayerCount < desiredCount)
+    {
+        GroupQueueInfo* ginfo = cursor.Next(desiredCount - PlayerCount);
+        if (!ginfo)
+            { break; }
+
+        AddGroup(ginfo, desiredCount);
+    }
+}
+
 /*********************************************************/
 /***               BATTLEGROUND QUEUES                 ***/
 /*********************************************************/
@@ -152,6 +245,9 @@ GroupQueueInfo* BattleGroundQueue::AddGroup(Player* leader, Group* grp, BattleGr
     ginfo->JoinTime                  = WorldTimer::getMSTime();
     ginfo->RemoveInviteTime          = 0;
     ginfo->GroupTeam                 = leader->GetTeam();
+    ginfo->JoinSequence              = ++m_JoinSequence;
+    ginfo->BracketId                 = bracketId;
+    ginfo->BucketSize                = 0;
 
     ginfo->Players.clear();
 
@@ -163,6 +259,8 @@ GroupQueueInfo* BattleGroundQueue::AddGroup(Player* leader, Group* grp, BattleGr
     if (ginfo->GroupTeam == HORDE)
         { ++index; }                                            // BG_QUEUE_*_ALLIANCE -> BG_QUEUE_*_HORDE
 
+    ginfo->QueueType = uint8(index);
+
     DEBUG_LOG("Adding Group to BattleGroundQueue bgTypeId : %u, bracket_id : %u, index : %u", BgTypeId, bracketId, index);
 
     uint32 lastOnlineTime = WorldTimer::getMSTime();
@@ -192,8 +290,8 @@ GroupQueueInfo* BattleGroundQueue::AddGroup(Player* leader, Group* grp, BattleGr
             ginfo->Players[leader->GetObjectGuid()]  = &pl_info;
         }
 
-        // add GroupInfo to m_QueuedGroups
-        m_QueuedGroups[bracketId][index].push_back(ginfo);
+        // add GroupInfo to the bucket of its size
+        m_WaitingGroups[bracketId][index].Insert(ginfo);
 
         // announce to world, this code needs mutex
         if (!isPremade && sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_QUEUE_ANNOUNCER_JOIN))
@@ -202,16 +300,9 @@ GroupQueueInfo* BattleGroundQueue::AddGroup(Player* leader, Group* grp, BattleGr
             {
                 char const* bgName = bg->GetName();
                 uint32 MinPlayers = bg->GetMinPlayersPerTeam();
-                uint32 qHorde = 0;
-                uint32 qAlliance = 0;
+                uint32 qHorde = m_WaitingGroups[bracketId][BG_QUEUE_NORMAL_HORDE].GetPlayerCount();
+                uint32 qAlliance = m_WaitingGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].GetPlayerCount();
                 uint32 q_min_level = leader->GetMinLevelForBattleGroundBracketId(bracketId, BgTypeId);
-                GroupsQueueType::const_iterator itr;
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].end(); ++itr)
-                    if (!(*itr)->IsInvitedToBGInstanceGUID)
-                        { qAlliance += (*itr)->Players.size(); }
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].end(); ++itr)
-                    if (!(*itr)->IsInvitedToBGInstanceGUID)
-                        { qHorde += (*itr)->Players.size(); }
 
                 // Show queue status to player only (when joining queue)
                 if (sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_QUEUE_ANNOUNCER_JOIN) == 1)
@@ -273,7 +364,6 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     // Player *plr = sObjectMgr.GetPlayer(guid);
     // ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
 
-    int32 bracket_id = -1;                                  // signed for proper for-loop finish
     QueuedPlayersMap::iterator itr;
 
     // remove player from map, if he's there
@@ -285,38 +375,13 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
     }
 
     GroupQueueInfo* group = itr->second.GroupInfo;
-    GroupsQueueType::iterator group_itr, group_itr_tmp;
-    // mostly people with the highest levels are in battlegrounds, thats why
-    // we count from MAX_BATTLEGROUND_QUEUES - 1 to 0
-    // variable index removes useless searching in other team's queue
-    uint32 index = BattleGround::GetTeamIndexByTeamId(group->GroupTeam);
+    DEBUG_LOG("BattleGroundQueue: Removing %s, from bracket_id %u", guid.GetString().c_str(), (uint32)group->BracketId);
 
-    for (int8 bracket_id_tmp = MAX_BATTLEGROUND_BRACKETS - 1; bracket_id_tmp >= 0 && bracket_id == -1; --bracket_id_tmp)
-    {
-        // we must check premade and normal team's queue - because when players from premade are joining bg,
-        // they leave groupinfo so we can't use its players size to find out index
-        for (uint8 j = index; j < BG_QUEUE_GROUP_TYPES_COUNT; j += BG_QUEUE_NORMAL_ALLIANCE)
-        {
-            for (group_itr_tmp = m_QueuedGroups[bracket_id_tmp][j].begin(); group_itr_tmp != m_QueuedGroups[bracket_id_tmp][j].end(); ++group_itr_tmp)
-            {
-                if ((*group_itr_tmp) == group)
-                {
-                    bracket_id = bracket_id_tmp;
-                    group_itr = group_itr_tmp;
-                    // we must store index to be able to erase iterator
-                    index = j;
-                    break;
-                }
-            }
-        }
-    }
-    // player can't be in queue without group, but just in case
-    if (bracket_id == -1)
-    {
-        sLog.outError("BattleGroundQueue: ERROR Can not find groupinfo for %s", guid.GetString().c_str());
-        return;
-    }
-    DEBUG_LOG("BattleGroundQueue: Removing %s, from bracket_id %u", guid.GetString().c_str(), (uint32)bracket_id);
+    // a waiting group changes its size bucket, invited groups are in none
+    GroupBuckets& buckets = m_WaitingGroups[group->BracketId][group->QueueType];
+    bool waiting = group->BucketSize != 0;
+    if (waiting)
+        { buckets.Erase(group); }
 
     // ALL variables are correctly set
     // We can ignore leveling up in queue - it should not cause crash
@@ -341,10 +406,9 @@ void BattleGroundQueue::RemovePlayer(ObjectGuid guid, bool decreaseInvitedCount)
 
     // remove group queue info if needed
     if (group->Players.empty())
-    {
-        m_QueuedGroups[bracket_id][index].erase(group_itr);
-        delete group;
-    }
+        { delete group; }
+    else if (waiting)
+        { buckets.Insert(group); }
 }
 
 // returns true when player pl_guid is in queue and is invited to bgInstanceGuid
@@ -376,7 +440,8 @@ bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo* ginfo, BattleGround* bg,
     if (!ginfo->IsInvitedToBGInstanceGUID)
     {
         // not yet invited
-        // set invitation
+        // set invitation, invited groups leave the buckets
+        m_WaitingGroups[ginfo->BracketId][ginfo->QueueType].Erase(ginfo);
         ginfo->IsInvitedToBGInstanceGUID = bg->GetInstanceID();
         BattleGroundTypeId bgTypeId = bg->GetTypeID();
         BattleGroundQueueTypeId bgQueueTypeId = BattleGroundMgr::BGQueueTypeId(bgTypeId);
@@ -436,20 +501,12 @@ void BattleGroundQueue::FillPlayersToBG(BattleGround* bg, BattleGroundBracketId
     int32 hordeFree = bg->GetFreeSlotsForTeam(HORDE);
     int32 aliFree   = bg->GetFreeSlotsForTeam(ALLIANCE);
 
-    // iterator for iterating through bg queue
-    GroupsQueueType::const_iterator Ali_itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].begin();
-    // count of groups in queue - used to stop cycles
-    uint32 aliCount = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].size();
-    // index to queue which group is current
-    uint32 aliIndex = 0;
-    for (; aliIndex < aliCount && m_SelectionPools[BG_TEAM_ALLIANCE].AddGroup((*Ali_itr), aliFree); ++aliIndex)
-        { ++Ali_itr; }
+    // cursors for iterating through bg queue, they only return groups fitting into the free slots
+    GroupCursor aliCursor(m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE]);
+    m_SelectionPools[BG_TEAM_ALLIANCE].AddGroups(aliCursor, aliFree, aliFree);
     // the same thing for horde
-    GroupsQueueType::const_iterator Horde_itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].begin();
-    uint32 hordeCount = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].size();
-    uint32 hordeIndex = 0;
-    for (; hordeIndex < hordeCount && m_SelectionPools[BG_TEAM_HORDE].AddGroup((*Horde_itr), hordeFree); ++hordeIndex)
-        { ++Horde_itr; }
+    GroupCursor hordeCursor(m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE]);
+    m_SelectionPools[BG_TEAM_HORDE].AddGroups(hordeCursor, hordeFree, hordeFree);
 
     // if ofc like BG queue invitation is set in config, then we are happy
     if (sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_INVITATION_TYPE) == 0)
@@ -474,8 +531,8 @@ void BattleGroundQueue::FillPlayersToBG(BattleGround* bg, BattleGroundBracketId
             // kick alliance group, add to pool new group if needed
             if (m_SelectionPools[BG_TEAM_ALLIANCE].KickGroup(diffHorde - diffAli))
             {
-                for (; aliIndex < aliCount && m_SelectionPools[BG_TEAM_ALLIANCE].AddGroup((*Ali_itr), (aliFree >= diffHorde) ? aliFree - diffHorde : 0); ++aliIndex)
-                    { ++Ali_itr; }
+                uint32 desired = (aliFree >= diffHorde) ? aliFree - diffHorde : 0;
+                m_SelectionPools[BG_TEAM_ALLIANCE].AddGroups(aliCursor, desired, desired);
             }
             // if ali selection is already empty, then kick horde group, but if there are less horde than ali in bg - break;
             if (!m_SelectionPools[BG_TEAM_ALLIANCE].GetPlayerCount())
@@ -490,8 +547,8 @@ void BattleGroundQueue::FillPlayersToBG(BattleGround* bg, BattleGroundBracketId
             // kick horde group, add to pool new group if needed
             if (m_SelectionPools[BG_TEAM_HORDE].KickGroup(diffAli - diffHorde))
             {
-                for (; hordeIndex < hordeCount && m_SelectionPools[BG_TEAM_HORDE].AddGroup((*Horde_itr), (hordeFree >= diffAli) ? hordeFree - diffAli : 0); ++hordeIndex)
-                    { ++Horde_itr; }
+                uint32 desired = (hordeFree >= diffAli) ? hordeFree - diffAli : 0;
+                m_SelectionPools[BG_TEAM_HORDE].AddGroups(hordeCursor, desired, desired);
             }
             if (!m_SelectionPools[BG_TEAM_HORDE].GetPlayerCount())
             {
@@ -511,55 +568,35 @@ void BattleGroundQueue::FillPlayersToBG(BattleGround* bg, BattleGroundBracketId
 // it tries to invite as much players as it can - to MaxPlayersPerTeam, because premade groups have more than MinPlayersPerTeam players
 bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint32 MinPlayersPerTeam, uint32 MaxPlayersPerTeam)
 {
-    // check match
-    if (!m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].empty() && !m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].empty())
+    // start premade match with the longest waiting premade groups
+    GroupQueueInfo* aliGroup = m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].GetOldest();
+    GroupQueueInfo* hordeGroup = m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].GetOldest();
+    if (aliGroup && hordeGroup)
     {
-        // start premade match
-        // if groups aren't invited
-        GroupsQueueType::const_iterator ali_group, horde_group;
-        for (ali_group = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].begin(); ali_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].end(); ++ali_group)
-            if (!(*ali_group)->IsInvitedToBGInstanceGUID)
-                { break; }
-        for (horde_group = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].begin(); horde_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].end(); ++horde_group)
-            if (!(*horde_group)->IsInvitedToBGInstanceGUID)
-                { break; }
-
-        if (ali_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].end() && horde_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].end())
+        m_SelectionPools[BG_TEAM_ALLIANCE].AddGroup(aliGroup, MaxPlayersPerTeam);
+        m_SelectionPools[BG_TEAM_HORDE].AddGroup(hordeGroup, MaxPlayersPerTeam);
+        // add groups/players from normal queue to size of bigger group
+        uint32 maxPlayers = std::max(m_SelectionPools[BG_TEAM_ALLIANCE].GetPlayerCount(), m_SelectionPools[BG_TEAM_HORDE].GetPlayerCount());
+        for (uint8 i = 0; i < BG_TEAMS_COUNT; ++i)
         {
-            m_SelectionPools[BG_TEAM_ALLIANCE].AddGroup((*ali_group), MaxPlayersPerTeam);
-            m_SelectionPools[BG_TEAM_HORDE].AddGroup((*horde_group), MaxPlayersPerTeam);
-            // add groups/players from normal queue to size of bigger group
-            uint32 maxPlayers = std::max(m_SelectionPools[BG_TEAM_ALLIANCE].GetPlayerCount(), m_SelectionPools[BG_TEAM_HORDE].GetPlayerCount());
-            GroupsQueueType::const_iterator itr;
-            for (uint8 i = 0; i < BG_TEAMS_COUNT; ++i)
-            {
-                for (itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin(); itr != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++itr)
-                {
-                    // if itr can join BG and player count is less that maxPlayers, then add group to selectionpool
-                    if (!(*itr)->IsInvitedToBGInstanceGUID && !m_SelectionPools[i].AddGroup((*itr), maxPlayers))
-                        { break; }
-                }
-            }
-            // premade selection pools are set
-            return true;
+            GroupCursor cursor(m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i]);
+            m_SelectionPools[i].AddGroups(cursor, maxPlayers, maxPlayers);
         }
+        // premade selection pools are set
+        return true;
     }
     // now check if we can move group from Premade queue to normal queue (timer has expired) or group size lowered!!
-    // this could be 2 cycles but i'm checking only first team in queue - it can cause problem -
-    // if first is invited to BG and seconds timer expired, but we can ignore it, because players have only 80 seconds to click to enter bg
-    // and when they click or after 80 seconds the queue info is removed from queue
+    // this could be 2 cycles but i'm checking only the longest waiting group of each team
     uint32 time_before = WorldTimer::getMSTime() - sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_PREMADE_GROUP_WAIT_FOR_MATCH);
     for (uint8 i = 0; i < BG_TEAMS_COUNT; ++i)
     {
-        if (!m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].empty())
+        GroupQueueInfo* ginfo = m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].GetOldest();
+        if (ginfo && (ginfo->JoinTime < time_before || ginfo->Players.size() < MinPlayersPerTeam))
         {
-            GroupsQueueType::iterator itr = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].begin();
-            if (!(*itr)->IsInvitedToBGInstanceGUID && ((*itr)->JoinTime < time_before || (*itr)->Players.size() < MinPlayersPerTeam))
-            {
-                // we must insert group to normal queue and erase pointer from premade queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].push_front((*itr));
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].erase(itr);
-            }
+            // we must erase the group from premade queue and insert it to normal queue, it keeps its join order there
+            m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].Erase(ginfo);
+            ginfo->QueueType = BG_QUEUE_NORMAL_ALLIANCE + i;
+            m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].Insert(ginfo);
         }
     }
     // selection pools are not set
@@ -569,20 +606,11 @@ bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint
 // this method tries to create battleground with MinPlayersPerTeam against MinPlayersPerTeam
 bool BattleGroundQueue::CheckNormalMatch(BattleGroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers)
 {
-    GroupsQueueType::const_iterator itr_team[BG_TEAMS_COUNT];
+    GroupCursor aliCursor(m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE]);
+    GroupCursor hordeCursor(m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE]);
+    GroupCursor* cursors[BG_TEAMS_COUNT] = { &aliCursor, &hordeCursor };
     for (uint8 i = 0; i < BG_TEAMS_COUNT; ++i)
-    {
-        itr_team[i] = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin();
-        for (; itr_team[i] != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++(itr_team[i]))
-        {
-            if (!(*(itr_team[i]))->IsInvitedToBGInstanceGUID)
-            {
-                m_SelectionPools[i].AddGroup(*(itr_team[i]), maxPlayers);
-                if (m_SelectionPools[i].GetPlayerCount() >= minPlayers)
-                    { break; }
-            }
-        }
-    }
+        { m_SelectionPools[i].AddGroups(*cursors[i], maxPlayers, minPlayers); }
     // try to invite same number of players - this cycle may cause longer wait time even if there are enough players in queue, but we want ballanced bg
     uint32 j = BG_TEAM_ALLIANCE;
     if (m_SelectionPools[BG_TEAM_HORDE].GetPlayerCount() < m_SelectionPools[BG_TEAM_ALLIANCE].GetPlayerCount())
@@ -591,13 +619,8 @@ bool BattleGroundQueue::CheckNormalMatch(BattleGroundBracketId bracket_id, uint3
         && m_SelectionPools[BG_TEAM_HORDE].GetPlayerCount() >= minPlayers && m_SelectionPools[BG_TEAM_ALLIANCE].GetPlayerCount() >= minPlayers)
     {
         // we will try to invite more groups to team with less players indexed by j
-        ++(itr_team[j]);                                    // this will not cause a crash, because for cycle above reached break;
-        for (; itr_team[j] != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + j].end(); ++(itr_team[j]))
-        {
-            if (!(*(itr_team[j]))->IsInvitedToBGInstanceGUID)
-                if (!m_SelectionPools[j].AddGroup(*(itr_team[j]), m_SelectionPools[(j + 1) % BG_TEAMS_COUNT].GetPlayerCount()))
-                    { break; }
-        }
+        uint32 otherCount = m_SelectionPools[(j + 1) % BG_TEAMS_COUNT].GetPlayerCount();
+        m_SelectionPools[j].AddGroups(*cursors[j], otherCount, otherCount);
         // do not allow to start bg with more than 2 players more on 1 faction
         if (abs((int32)(m_SelectionPools[BG_TEAM_HORDE].GetPlayerCount() - m_SelectionPools[BG_TEAM_ALLIANCE].GetPlayerCount())) > 2)
             { return false; }
@@ -617,11 +640,11 @@ should be called from BattleGround::RemovePlayer function in some cases
 void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketId bracket_id)
 {
     // ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
-    // if no players in queue - do nothing
-    if (m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].empty() &&
-        m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].empty() &&
-        m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].empty() &&
-        m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].empty())
+    // if no players wait for an invitation - do nothing
+    if (m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].IsEmpty() &&
+        m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].IsEmpty() &&
+        m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].IsEmpty() &&
+        m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].IsEmpty())
         { return; }
 
     // battleground with free slot for player should be always in the beggining of the queue
@@ -829,6 +852,8 @@ BattleGroundMgr::~BattleGroundMgr()
 
 void BattleGroundMgr::DeleteAllBattleGrounds()
 {
+    DeleteWarmBattleGrounds();
+
     // will also delete template bgs:
     for (uint8 i = BATTLEGROUND_TYPE_NONE; i < MAX_BATTLEGROUND_TYPE_ID; ++i)
     {
@@ -865,6 +890,10 @@ void BattleGroundMgr::Update(uint32 diff)
             m_BattleGroundQueues[bgQueueTypeId].Update(bgTypeId, bracket_id);
         }
     }
+
+    // keep instances loaded in advance, so a match start does not load a map
+    if (uint32 warmCount = sWorld.getConfig(CONFIG_UINT32_BATTLEGROUND_WARM_INSTANCES))
+        { UpdateWarmBattleGrounds(warmCount); }
 }
 
 void BattleGroundMgr::BuildBattleGroundStatusPacket(WorldPacket* data, BattleGround* bg, uint8 QueueSlot, uint8 StatusID, uint32 Time1, uint32 Time2)
@@ -1065,6 +1094,32 @@ uint32 BattleGroundMgr::CreateClientVisibleInstanceId(BattleGroundTypeId bgTypeI
 
 // create a new battleground that will really be used to play
 BattleGround* BattleGroundMgr::CreateNewBattleGround(BattleGroundTypeId bgTypeId, BattleGroundBracketId bracket_id)
+{
+    BattleGround* bg = NULL;
+
+    // a warm instance has its map already loaded, no grid loading when the players enter
+    BGFreeSlotQueueType& warm = m_WarmBattleGrounds[bgTypeId][bracket_id];
+    if (!warm.empty())
+    {
+        bg = warm.front();
+        warm.pop_front();
+        bg->SetWarm(false);
+    }
+    else
+        { bg = CreateBattleGroundInstance(bgTypeId, bracket_id); }
+
+    if (!bg)
+        { return NULL; }
+
+    bg->SetClientInstanceID(CreateClientVisibleInstanceId(bgTypeId, bracket_id));
+
+    // start the joining of the bg
+    bg->SetStatus(STATUS_WAIT_JOIN);
+
+    return bg;
+}
+
+BattleGround* BattleGroundMgr::CreateBattleGroundInstance(BattleGroundTypeId bgTypeId, BattleGroundBracketId bracket_id)
 {
     // get the template BG
     BattleGround* bg_template = GetBattleGroundTemplate(bgTypeId);
@@ -1095,18 +1150,67 @@ BattleGround* BattleGroundMgr::CreateNewBattleGround(BattleGroundTypeId bgTypeId
     // will also set m_bgMap, instanceid
     sMapMgr.CreateBgMap(bg->GetMapId(), bg);
 
-    bg->SetClientInstanceID(CreateClientVisibleInstanceId(bgTypeId, bracket_id));
-
     // reset the new bg (set status to status_wait_queue from status_none)
     bg->Reset();
-
-    // start the joining of the bg
-    bg->SetStatus(STATUS_WAIT_JOIN);
     bg->SetBracketId(bracket_id);
 
     return bg;
 }
 
+void BattleGroundMgr::UpdateWarmBattleGrounds(uint32 warmCount)
+{
+    for (uint32 i = BATTLEGROUND_TYPE_NONE + 1; i < MAX_BATTLEGROUND_TYPE_ID; ++i)
+    {
+        BattleGroundTypeId bgTypeId = BattleGroundTypeId(i);
+        BattleGround* bg_template = GetBattleGroundTemplate(bgTypeId);
+        if (!bg_template)
+            { continue; }
+
+        uint32 lastBracket = std::min((bg_template->GetMaxLevel() - bg_template->GetMinLevel()) / 10, uint32(MAX_BATTLEGROUND_BRACKETS - 1));
+        for (uint32 bracket = 0; bracket <= lastBracket; ++bracket)
+        {
+            BGFreeSlotQueueType& warm = m_WarmBattleGrounds[bgTypeId][bracket];
+            if (warm.size() >= warmCount)
+                { continue; }
+
+            BattleGround* bg = CreateBattleGroundInstance(bgTypeId, BattleGroundBracketId(bracket));
+            if (!bg)
+                { break; }                                  // type without implementation
+
+            // the empty instance must not delete itself at its map update
+            bg->SetWarm(true);
+
+            // load the grids of all static spawns and keep them loaded, this is the work a match start would wait for
+            BattleGroundMap* map = bg->GetBgMap();
+            CellObjectGuidsMap const& cells = sObjectMgr.GetMapObjectGuids(bg->GetMapId());
+            for (CellObjectGuidsMap::const_iterator itr = cells.begin(); itr != cells.end(); ++itr)
+            {
+                CellPair p(itr->first % TOTAL_NUMBER_OF_CELLS_PER_MAP, itr->first / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+                map->LoadGrid(Cell(p), true);
+            }
+
+            DEBUG_LOG("BattleGroundMgr: warm instance %u of bgType %u bracket %u created", bg->GetInstanceID(), bgTypeId, bracket);
+            warm.push_back(bg);
+
+            // one instance per update, a map load is what stalls the world update
+            return;
+        }
+    }
+}
+
+void BattleGroundMgr::DeleteWarmBattleGrounds()
+{
+    for (uint32 i = 0; i < MAX_BATTLEGROUND_TYPE_ID; ++i)
+    {
+        for (uint32 j = 0; j < MAX_BATTLEGROUND_BRACKETS; ++j)
+        {
+            for (BGFreeSlotQueueType::const_iterator itr = m_WarmBattleGrounds[i][j].begin(); itr != m_WarmBattleGrounds[i][j].end(); ++itr)
+                { delete *itr; }
+            m_WarmBattleGrounds[i][j].clear();
+        }
+    }
+}
+
 // used to create the BG templates
 uint32 BattleGroundMgr::CreateBattleGround(BattleGroundTypeId bgTypeId, uint32 MinPlayersPerTeam, uint32 MaxPlayersPerTeam, uint32 LevelMin, uint32 LevelMax, char const* BattleGroundName, uint32 MapID, float Team1StartLocX, float Team1StartLocY, float Team1StartLocZ, float Team1StartLocO, float Team2StartLocX, float Team2StartLocY, float Team2StartLocZ, float Team2StartLocO)
 {
@@ -59,6 +59,7 @@ typedef UNORDERED_MAP<uint32, BattleGroundEventIdx> CreatureBattleEventIndexesMa
 typedef UNORDERED_MAP<uint32, BattleGroundEventIdx> GameObjectBattleEventIndexesMap;
 
 #define COUNT_OF_PLAYERS_TO_AVERAGE_WAIT_TIME 10
+#define MAX_QUEUED_GROUP_SIZE 40                            // raid size, count of the group size buckets of a queue
 
 struct GroupQueueInfo;                                      // type predefinition
 /**
@@ -77,6 +78,12 @@ struct PlayerQueueInfo
  */
 typedef std::map<ObjectGuid, PlayerQueueInfo*> GroupQueueInfoPlayers;
 
+/**
+ * @brief groups in join order
+ *
+ */
+typedef std::list<GroupQueueInfo*> GroupsQueueType;
+
 /**
  * @brief stores information about the group in queue (also used when joined as solo!)
  *
@@ -89,6 +96,11 @@ struct GroupQueueInfo
     uint32  JoinTime;                                       /**< time when group was added */
     uint32  RemoveInviteTime;                               /**< time when we will remove invite for players in group */
     uint32  IsInvitedToBGInstanceGUID;                      /**< was invited to certain BG */
+    uint32  JoinSequence;                                   /**< join order in the queue, groups of a size bucket are sorted by it */
+    BattleGroundBracketId BracketId;                        /**< bracket of the queue the group is in */
+    uint8   QueueType;                                      /**< BattleGroundQueueGroupTypes of the queue the group is in */
+    uint32  BucketSize;                                     /**< size bucket the group waits in, 0 when invited */
+    GroupsQueueType::iterator BucketPos;                    /**< position in its size bucket */
 };
 
 /**
@@ -218,21 +230,85 @@ class BattleGroundQueue
         QueuedPlayersMap m_QueuedPlayers; /**< TODO */
 
         /**
-         * @brief we need constant add to begin and constant remove / add from the end, therefore deque suits our problem well
+         * @brief not yet invited groups of one queue, bucketed by group size
          *
+         * Each bucket keeps its groups in join order, so the oldest group fitting into n free slots
+         * is found at the heads of the buckets 1..n and matching does not walk the whole queue.
          */
-        typedef std::list<GroupQueueInfo*> GroupsQueueType;
+        class GroupBuckets
+        {
+            public:
+                GroupBuckets() : m_GroupCount(0), m_PlayerCount(0) {}
+
+                /**
+                 * @brief puts the group into the bucket of its current size
+                 *
+                 * @param ginfo
+                 */
+                void Insert(GroupQueueInfo* ginfo);
+                /**
+                 * @brief
+                 *
+                 * @param ginfo
+                 */
+                void Erase(GroupQueueInfo* ginfo);
+                /**
+                 * @brief
+                 *
+                 * @return GroupQueueInfo the group waiting longest, NULL if none
+                 */
+                GroupQueueInfo* GetOldest() const;
+                /**
+                 * @brief
+                 *
+                 * @param size 1..MAX_QUEUED_GROUP_SIZE
+                 * @return const GroupsQueueType
+                 */
+                GroupsQueueType const& GetBucket(uint32 size) const { return m_Buckets[size - 1]; }
+                bool IsEmpty() const { return m_GroupCount == 0; }
+                uint32 GetPlayerCount() const { return m_PlayerCount; }
+
+            private:
+                GroupsQueueType m_Buckets[MAX_QUEUED_GROUP_SIZE];
+                uint32 m_GroupCount;
+                uint32 m_PlayerCount;
+        };
+
+        /**
+         * @brief walks the groups of a queue in join order and returns only those fitting into the free slots
+         *
+         * Groups passed once are not returned again, like an iterator over the whole queue would do.
+         */
+        class GroupCursor
+        {
+            public:
+                explicit GroupCursor(GroupBuckets const& buckets);
+
+                /**
+                 * @brief
+                 *
+                 * @param maxSize free slots
+                 * @return GroupQueueInfo next group not larger than maxSize, NULL if none
+                 */
+                GroupQueueInfo* Next(uint32 maxSize);
+
+            private:
+                GroupBuckets const& m_Buckets;
+                GroupsQueueType::const_iterator m_Pos[MAX_QUEUED_GROUP_SIZE];
+                uint32 m_LastSequence;                      /**< JoinSequence of the group returned last, sequences start at 1 */
+        };
 
         /*
-        This two dimensional array is used to store All queued groups
-        First dimension specifies the bgTypeId
+        This two dimensional array is used to store the waiting groups
+        First dimension specifies the bracket
         Second dimension specifies the player's group types -
              BG_QUEUE_PREMADE_ALLIANCE  is used for premade alliance groups and alliance rated arena teams
              BG_QUEUE_PREMADE_HORDE     is used for premade horde groups and horde rated arena teams
              BG_QUEUE_NORMAL_ALLIANCE   is used for normal (or small) alliance groups or non-rated arena matches
              BG_QUEUE_NORMAL_HORDE      is used for normal (or small) horde groups or non-rated arena matches
         */
-        GroupsQueueType m_QueuedGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT]; /**< TODO */
+        GroupBuckets m_WaitingGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
+        uint32 m_JoinSequence;                              /**< JoinSequence of the next group */
 
         /**
          * @brief class to select and invite groups to bg
@@ -254,6 +330,14 @@ class BattleGroundQueue
                  * @return bool
                  */
                 bool AddGroup(GroupQueueInfo* ginfo, uint32 desiredCount);
+                /**
+                 * @brief adds the groups of the cursor fitting into desiredCount until enoughCount players are selected
+                 *
+                 * @param cursor
+                 * @param desiredCount
+                 * @param enoughCount
+                 */
+                void AddGroups(GroupCursor& cursor, uint32 desiredCount, uint32 enoughCount);
                 /**
                  * @brief
                  *
@@ -508,6 +592,11 @@ class BattleGroundMgr
          * @return BattleGround
          */
         BattleGround* CreateNewBattleGround(BattleGroundTypeId bgTypeId, BattleGroundBracketId bracket_id);
+        /**
+         * @brief deletes the warm instances, used at shutdown
+         *
+         */
+        void DeleteWarmBattleGrounds();
 
         /**
          * @brief
@@ -708,6 +797,21 @@ class BattleGroundMgr
          */
         static bool IsBGWeekend(BattleGroundTypeId bgTypeId);
     private:
+        /**
+         * @brief creates a copy of the BG template and its map
+         *
+         * @param bgTypeId
+         * @param bracket_id
+         * @return BattleGround NULL if the type has no implementation
+         */
+        BattleGround* CreateBattleGroundInstance(BattleGroundTypeId bgTypeId, BattleGroundBracketId bracket_id);
+        /**
+         * @brief tops up the warm instances of all types and brackets, creates one instance per call at most
+         *
+         * @param warmCount wanted instances per type and bracket
+         */
+        void UpdateWarmBattleGrounds(uint32 warmCount);
+
         ACE_Thread_Mutex    SchedulerLock; /**< TODO */
         BattleMastersMap    mBattleMastersMap; /**< TODO */
         CreatureBattleEventIndexesMap m_CreatureBattleEventIndexMap; /**< TODO */
@@ -722,6 +826,7 @@ class BattleGroundMgr
          */
         typedef std::set<uint32> ClientBattleGroundIdSet;
         ClientBattleGroundIdSet m_ClientBattleGroundIds[MAX_BATTLEGROUND_TYPE_ID][MAX_BATTLEGROUND_BRACKETS]; /**< the instanceids just visible for the client */
+        BGFreeSlotQueueType m_WarmBattleGrounds[MAX_BATTLEGROUND_TYPE_ID][MAX_BATTLEGROUND_BRACKETS]; /**< instances with all grids loaded, handed out by CreateNewBattleGround */
         bool   m_Testing; /**< TODO */
 };
 
@@ -28,8 +28,11 @@
 #include "Log.h"
 #include "Errors.h"
 #include "Player.h"
+#include "World.h"
 
-Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl)
+Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl),
+    m_visibilityX(0.0f), m_visibilityY(0.0f), m_visibilityDistance(0.0f), m_incrementalVisibilityUpdates(0),
+    m_viewPointLink(this)
 {
     m_source->GetViewPoint().Attach(this);
 }
@@ -41,6 +44,9 @@ Camera::~Camera()
 
     // for symmetry with constructor and way to make viewpoint's list empty
     m_source->GetViewPoint().Detach(this);
+
+    if (m_broadcastSubscription.map)
+        { m_broadcastSubscription.map->UpdateBroadcastSubscription(this, NULL); }
 }
 
 void Camera::ReceivePacket(WorldPacket* data)
@@ -55,9 +61,18 @@ void Camera::UpdateForCurrentViewPoint()
     if (GridType* grid = m_source->GetViewPoint().m_grid)
         { grid->AddWorldObject(this); }
 
+    UpdateBroadcastSubscription();
     UpdateVisibilityForOwner();
 }
 
+void Camera::UpdateBroadcastSubscription()
+{
+    if (m_gridRef.isValid())
+        { m_source->GetMap()->UpdateBroadcastSubscription(this, &m_source->GetViewPoint().m_cell); }
+    else if (m_broadcastSubscription.map)
+        { m_broadcastSubscription.map->UpdateBroadcastSubscription(this, NULL); }
+}
+
 void Camera::SetView(WorldObject* obj, bool update_far_sight_field /*= true*/)
 {
     MANGOS_ASSERT(obj);
@@ -112,6 +127,7 @@ void Camera::Event_AddedToWorld()
     MANGOS_ASSERT(grid);
     grid->AddWorldObject(this);
 
+    UpdateBroadcastSubscription();
     UpdateVisibilityForOwner();
 }
 
@@ -120,6 +136,7 @@ void Camera::Event_RemovedFromWorld()
     if (m_source == &m_owner)
     {
         m_gridRef.unlink();
+        UpdateBroadcastSubscription();
         return;
     }
 
@@ -130,6 +147,7 @@ void Camera::Event_Moved()
 {
     m_gridRef.unlink();
     m_source->GetViewPoint().m_grid->AddWorldObject(this);
+    UpdateBroadcastSubscription();
 }
 
 void Camera::UpdateVisibilityOf(WorldObject* target)
@@ -138,29 +156,63 @@ void Camera::UpdateVisibilityOf(WorldObject* target)
 }
 
 template<class T>
-void Camera::UpdateVisibilityOf(T* target, UpdateData& data, std::set<WorldObject*>& vis)
+void Camera::UpdateVisibilityOf(T* target, UpdateData& data, WorldObjectTickSet& vis)
 {
     m_owner.template UpdateVisibilityOf<T>(m_source, target, data, vis);
 }
 
-template void Camera::UpdateVisibilityOf(Player*        , UpdateData& , std::set<WorldObject*>&);
-template void Camera::UpdateVisibilityOf(Creature*      , UpdateData& , std::set<WorldObject*>&);
-template void Camera::UpdateVisibilityOf(Corpse*        , UpdateData& , std::set<WorldObject*>&);
-template void Camera::UpdateVisibilityOf(GameObject*    , UpdateData& , std::set<WorldObject*>&);
-template void Camera::UpdateVisibilityOf(DynamicObject* , UpdateData& , std::set<WorldObject*>&);
+template void Camera::UpdateVisibilityOf(Player*        , UpdateData& , WorldObjectTickSet&);
+template void Camera::UpdateVisibilityOf(Creature*      , UpdateData& , WorldObjectTickSet&);
+template void Camera::UpdateVisibilityOf(Corpse*        , UpdateData& , WorldObjectTickSet&);
+template void Camera::UpdateVisibilityOf(GameObject*    , UpdateData& , WorldObjectTickSet&);
+template void Camera::UpdateVisibilityOf(DynamicObject* , UpdateData& , WorldObjectTickSet&);
 
 void Camera::UpdateVisibilityForOwner()
 {
-    MaNGOS::VisibleNotifier notifier(*this);
-    Cell::VisitAllObjects(m_source, notifier, m_source->GetMap()->GetVisibilityDistance(), false);
+    UpdateVisibilityForOwner(0.0f);
+    m_incrementalVisibilityUpdates = 0;
+}
+
+void Camera::UpdateVisibilityForOwnerOnMove()
+{
+    // the map visibility distance can grow under Visibility.Dynamic, only the smaller one was checked
+    float visibilityDistance = std::min(m_visibilityDistance, m_source->GetMap()->GetVisibilityDistance());
+    // distance between the positions, GetDistance2d excludes the bounding radius
+    float moved = m_source->GetDistance2d(m_visibilityX, m_visibilityY) + m_source->GetObjectBoundingRadius();
+
+    // the in flight visibility distance differs from the map one, and far moves leave nothing unchanged
+    if (m_incrementalVisibilityUpdates >= World::GetVisibilityIncrementalUpdates() || m_owner.IsTaxiFlying() || moved >= visibilityDistance)
+    {
+        UpdateVisibilityForOwner();
+        return;
+    }
+
+    // objects closer than this were in visibility distance at the last update too
+    UpdateVisibilityForOwner(visibilityDistance - moved);
+    ++m_incrementalVisibilityUpdates;
+}
+
+void Camera::UpdateVisibilityForOwner(float unchangedRadius)
+{
+    MapVisibilityStats& stats = m_source->GetMap()->GetVisibilityStats();
+    MapStatsTimer timer(stats.visibilityUpdateTime);
+    ++stats.visibilityUpdates;
+
+    m_visibilityDistance = m_source->GetMap()->GetVisibilityDistance();
+
+    MaNGOS::VisibleNotifier notifier(*this, unchangedRadius);
+    Cell::VisitAllObjects(m_source, notifier, m_visibilityDistance, false);
     notifier.Notify();
+
+    m_visibilityX = m_source->GetPositionX();
+    m_visibilityY = m_source->GetPositionY();
 }
 
 //////////////////
 
 ViewPoint::~ViewPoint()
 {
-    if (!m_cameras.empty())
+    if (!m_cameras.isEmpty())
     {
         sLog.outError("ViewPoint destructor called, but some cameras referenced to it");
     }
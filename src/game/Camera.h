@@ -27,12 +27,37 @@
 
 #include "Common.h"
 #include "GridDefines.h"
+#include "Utilities/LinkedList.h"
+#include "TickArena.h"
 
 class ViewPoint;
+class Map;
 class WorldObject;
 class UpdateData;
 class WorldPacket;
 class Player;
+class Camera;
+
+// objects collected during one visibility update, allocated from the tick arena inside a map update
+typedef std::set<WorldObject*, std::less<WorldObject*>, ArenaAllocator<WorldObject*> > WorldObjectTickSet;
+
+/// Element of the camera list of a viewpoint, allows attach and detach without allocation or search
+struct ViewPointCameraLink : public LinkedListElement
+{
+    explicit ViewPointCameraLink(Camera* c) : camera(c) {}
+
+    Camera* const camera;
+};
+
+/// Cells of a map a camera gets broadcast packets from, maintained by Map::UpdateBroadcastSubscription
+struct BroadcastSubscription
+{
+    BroadcastSubscription() : map(NULL), range(0) {}
+
+    Map* map;                                               // NULL if not subscribed
+    CellPair cell;                                          // viewpoint cell
+    uint32 range;                                           // subscribed cells around it on each axis
+};
 
 /// Camera - object-receiver. Receives broadcast packets from nearby worldobjects, object visibility changes and sends them to client
 class MANGOS_DLL_SPEC Camera
@@ -55,13 +80,15 @@ class MANGOS_DLL_SPEC Camera
         void ResetView(bool update_far_sight_field = true);
 
         template<class T>
-        void UpdateVisibilityOf(T* obj, UpdateData& d, std::set<WorldObject*>& vis);
+        void UpdateVisibilityOf(T* obj, UpdateData& d, WorldObjectTickSet& vis);
         void UpdateVisibilityOf(WorldObject* obj);
 
         void ReceivePacket(WorldPacket* data);
 
         // updates visibility of worldobjects around viewpoint for camera's owner
         void UpdateVisibilityForOwner();
+        // same after viewpoint relocation, only objects that can be affected by the move are checked
+        void UpdateVisibilityForOwnerOnMove();
 
     private:
         // called when viewpoint changes visibility state
@@ -70,16 +97,28 @@ class MANGOS_DLL_SPEC Camera
         void Event_Moved();
         void Event_ViewPointVisibilityChanged();
 
+        void UpdateBroadcastSubscription();
+
         Player& m_owner;
         WorldObject* m_source;
 
+        // viewpoint position at last visibility update
+        float m_visibilityX;
+        float m_visibilityY;
+        float m_visibilityDistance;                         // map visibility distance used at last update
+        uint32 m_incrementalVisibilityUpdates;              // since last full visibility update
+
         void UpdateForCurrentViewPoint();
+        void UpdateVisibilityForOwner(float unchangedRadius);
 
     public:
         GridReference<Camera>& GetGridRef() { return m_gridRef; }
+        BroadcastSubscription& GetBroadcastSubscription() { return m_broadcastSubscription; }
         bool isActiveObject() const { return false; }
     private:
         GridReference<Camera> m_gridRef;
+        BroadcastSubscription m_broadcastSubscription;
+        ViewPointCameraLink m_viewPointLink;
 };
 
 /// Object-observer, notifies farsight object state to cameras that attached to it
@@ -87,23 +126,21 @@ class MANGOS_DLL_SPEC ViewPoint
 {
         friend class Camera;
 
-        typedef std::list<Camera*> CameraList;
-
-        CameraList m_cameras;
+        LinkedListHead m_cameras;                           // of ViewPointCameraLink
         GridType* m_grid;
+        CellPair m_cell;                                    // cell of m_grid, valid while it is set
 
-        void Attach(Camera* c) { m_cameras.push_back(c); }
-        void Detach(Camera* c) { m_cameras.remove(c); }
+        void Attach(Camera* c) { m_cameras.insertLast(&c->m_viewPointLink); }
+        void Detach(Camera* c) { c->m_viewPointLink.delink(); }
 
         void CameraCall(void (Camera::*handler)())
         {
-            if (!m_cameras.empty())
+            // the handler can detach its camera
+            for (LinkedListElement* link = m_cameras.getFirst(); link;)
             {
-                for (CameraList::iterator itr = m_cameras.begin(); itr != m_cameras.end();)
-                {
-                    Camera* c = *(itr++);
-                    (c->*handler)();
-                }
+                Camera* c = static_cast<ViewPointCameraLink*>(link)->camera;
+                link = link->next();
+                (c->*handler)();
             }
         }
 
@@ -112,12 +149,13 @@ class MANGOS_DLL_SPEC ViewPoint
         ViewPoint() : m_grid(0) {}
         ~ViewPoint();
 
-        bool hasViewers() const { return !m_cameras.empty(); }
+        bool hasViewers() const { return !m_cameras.isEmpty(); }
 
         // these events are called when viewpoint changes visibility state
-        void Event_AddedToWorld(GridType* grid)
+        void Event_AddedToWorld(GridType* grid, CellPair const& cell)
         {
             m_grid = grid;
+            m_cell = cell;
             CameraCall(&Camera::Event_AddedToWorld);
         }
 
@@ -127,9 +165,10 @@ class MANGOS_DLL_SPEC ViewPoint
             CameraCall(&Camera::Event_RemovedFromWorld);
         }
 
-        void Event_GridChanged(GridType* grid)
+        void Event_GridChanged(GridType* grid, CellPair const& cell)
         {
             m_grid = grid;
+            m_cell = cell;
             CameraCall(&Camera::Event_Moved);
         }
 
@@ -142,6 +181,11 @@ class MANGOS_DLL_SPEC ViewPoint
         {
             CameraCall(&Camera::UpdateVisibilityForOwner);
         }
+
+        void Call_UpdateVisibilityForOwnerOnMove()
+        {
+            CameraCall(&Camera::UpdateVisibilityForOwnerOnMove);
+        }
 };
 
 #endif
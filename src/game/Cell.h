@@ -39,6 +39,8 @@ struct MANGOS_DLL_DECL CellArea
     CellArea(CellPair low, CellPair high) : low_bound(low), high_bound(high) {}
 
     bool operator!() const { return low_bound == high_bound; }
+    bool operator==(CellArea const& area) const { return low_bound == area.low_bound && high_bound == area.high_bound; }
+    bool operator!=(CellArea const& area) const { return !operator==(area); }
 
     void ResizeBorders(CellPair& begin_cell, CellPair& end_cell) const
     {
@@ -30,6 +30,25 @@
 #include "Map.h"
 #include <cmath>
 
+namespace MaNGOS
+{
+    // Visit units of a short range search through Map::VisitUnitsInRange if the visitor supports it
+    template<bool UNIT_VISITOR>
+    struct SpatialHashSearch
+    {
+        template<class T> static bool Visit(Map* /*map*/, float /*x*/, float /*y*/, float /*radius*/, T& /*visitor*/) { return false; }
+    };
+
+    template<>
+    struct SpatialHashSearch<true>
+    {
+        template<class T> static bool Visit(Map* map, float x, float y, float radius, T& visitor)
+        {
+            return map->VisitUnitsInRange(x, y, radius, visitor);
+        }
+    };
+}
+
 inline Cell::Cell(CellPair const& p)
 {
     data.Part.grid_x = p.x_coord / MAX_NUMBER_OF_CELLS;
@@ -202,6 +221,10 @@ inline void Cell::VisitWorldObjects(const WorldObject* center_obj, T& visitor, f
 template<class T>
 inline void Cell::VisitAllObjects(const WorldObject* center_obj, T& visitor, float radius, bool dont_load)
 {
+    if (dont_load && MaNGOS::SpatialHashSearch<IsUnitVisitor<T>::value>::Visit(center_obj->GetMap(), center_obj->GetPositionX(), center_obj->GetPositionY(),
+            radius + center_obj->GetObjectBoundingRadius(), visitor))
+        { return; }
+
     CellPair p(MaNGOS::ComputeCellPair(center_obj->GetPositionX(), center_obj->GetPositionY()));
     Cell cell(p);
     if (dont_load)
@@ -237,6 +260,9 @@ inline void Cell::VisitWorldObjects(float x, float y, Map* map, T& visitor, floa
 template<class T>
 inline void Cell::VisitAllObjects(float x, float y, Map* map, T& visitor, float radius, bool dont_load)
 {
+    if (dont_load && MaNGOS::SpatialHashSearch<IsUnitVisitor<T>::value>::Visit(map, x, y, radius, visitor))
+        { return; }
+
     CellPair p(MaNGOS::ComputeCellPair(x, y));
     Cell cell(p);
     if (dont_load)
@@ -27,6 +27,7 @@
 #include "World.h"
 #include "SocialMgr.h"
 #include "Chat.h"
+#include "WorldSocketMgr.h"
 
 Channel::Channel(const std::string& name, uint32 channel_id)
     : m_announce(true), m_moderate(false), m_name(name), m_flags(0), m_channelId(channel_id)
@@ -100,9 +101,7 @@ void Channel::Join(Player* player, const char* password)
 
     data.clear();
 
-    PlayerInfo& pinfo = m_players[guid];
-    pinfo.player = guid;
-    pinfo.flags = MEMBER_FLAG_NONE;
+    AddMember(player);
 
     MakeYouJoined(&data);
     SendToOne(&data, guid);
@@ -112,7 +111,7 @@ void Channel::Join(Player* player, const char* password)
     if (!IsConstant() && !m_ownerGuid)
     {
         SetOwner(guid, (m_players.size() > 1 ? true : false));
-        m_players[guid].SetModerator(true);
+        GetMember(guid).SetModerator(true);
     }
 }
 
@@ -141,9 +140,9 @@ void Channel::Leave(Player* player, bool send)
         data.clear();
     }
 
-    bool changeowner = m_players[guid].IsOwner();
+    bool changeowner = GetMember(guid).IsOwner();
 
-    m_players.erase(guid);
+    RemoveMember(guid);
     if (m_announce && (player->GetSession()->GetSecurity() < SEC_GAMEMASTER || !sWorld.getConfig(CONFIG_BOOL_SILENTLY_GM_JOIN_TO_CHANNEL)))
     {
         WorldPacket data;
@@ -155,7 +154,7 @@ void Channel::Leave(Player* player, bool send)
 
     if (changeowner)
     {
-        ObjectGuid newowner = !m_players.empty() ? m_players.begin()->second.player : ObjectGuid();
+        ObjectGuid newowner = !m_players.empty() ? m_players.front().player : ObjectGuid();
         SetOwner(newowner);
     }
 }
@@ -172,7 +171,7 @@ void Channel::KickOrBan(Player* player, const char* targetName, bool ban)
         return;
     }
 
-    if (!m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (!GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -220,7 +219,7 @@ void Channel::KickOrBan(Player* player, const char* targetName, bool ban)
         MakePlayerKicked(&data, targetGuid, guid);
 
     SendToAll(&data);
-    m_players.erase(targetGuid);
+    RemoveMember(targetGuid);
     target->LeftChannel(this);
 
     if (changeowner)
@@ -242,7 +241,7 @@ void Channel::UnBan(Player* player, const char* targetName)
         return;
     }
 
-    if (!m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (!GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -288,7 +287,7 @@ void Channel::Password(Player* player, const char* password)
         return;
     }
 
-    if (!m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (!GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -316,7 +315,7 @@ void Channel::SetMode(Player* player, const char* targetName, bool moderator, bo
         return;
     }
 
-    if (!m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (!GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -418,7 +417,7 @@ void Channel::SetOwner(Player* player, const char* targetName)
     }
 
     // set channel owner
-    m_players[targetGuid].SetModerator(true);
+    GetMember(targetGuid).SetModerator(true);
     SetOwner(targetGuid);
 }
 
@@ -466,15 +465,15 @@ void Channel::List(Player* player)
     uint32 count  = 0;
     for (PlayerList::const_iterator i = m_players.begin(); i != m_players.end(); ++i)
     {
-        Player* plr = sObjectMgr.GetPlayer(i->first);
+        Player* plr = i->plr;
 
         // PLAYER can't see MODERATOR, GAME MASTER, ADMINISTRATOR characters
         // MODERATOR, GAME MASTER, ADMINISTRATOR can see all
-        if (plr && (player->GetSession()->GetSecurity() > SEC_PLAYER || plr->GetSession()->GetSecurity() <= gmLevelInWhoList) &&
+        if (plr->IsInWorld() && (player->GetSession()->GetSecurity() > SEC_PLAYER || plr->GetSession()->GetSecurity() <= gmLevelInWhoList) &&
                 plr->IsVisibleGloballyFor(player))
         {
-            data << ObjectGuid(i->first);
-            data << uint8(i->second.flags);                 // flags seems to be changed...
+            data << ObjectGuid(i->player);
+            data << uint8(i->flags);                 // flags seems to be changed...
             ++count;
         }
     }
@@ -496,7 +495,7 @@ void Channel::Announce(Player* player)
         return;
     }
 
-    if (!m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (!GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -531,7 +530,7 @@ void Channel::Moderate(Player* player)
         return;
     }
 
-    if (!m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (!GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -590,7 +589,7 @@ void Channel::Say(Player* player, const char* text, uint32 lang)
         return;
     }
 
-    else if (m_players[guid].IsMuted() ||
+    else if (GetMember(guid).IsMuted() ||
              (GetChannelId() == CHANNEL_ID_LOCAL_DEFENSE && !speakInLocalDef) ||
              (GetChannelId() == CHANNEL_ID_WORLD_DEFENSE && !speakInWorldDef))
     {
@@ -600,7 +599,7 @@ void Channel::Say(Player* player, const char* text, uint32 lang)
         return;
     }
 
-    if (m_moderate && !m_players[guid].IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
+    if (m_moderate && !GetMember(guid).IsModerator() && player->GetSession()->GetSecurity() < SEC_GAMEMASTER)
     {
         WorldPacket data;
         MakeNotModerator(&data);
@@ -613,7 +612,7 @@ void Channel::Say(Player* player, const char* text, uint32 lang)
         lang = LANG_UNIVERSAL;
     WorldPacket data;
     ChatHandler::BuildChatPacket(data, CHAT_MSG_CHANNEL, text, Language(lang), player->GetChatTag(), guid, player->GetName(), ObjectGuid(), "", m_name.c_str());
-    SendToAll(&data, !m_players[guid].IsModerator() ? guid : ObjectGuid());
+    SendToAll(&data, !GetMember(guid).IsModerator() ? guid : ObjectGuid());
 }
 
 void Channel::Invite(Player* player, const char* targetName)
@@ -679,10 +678,9 @@ void Channel::SetOwner(ObjectGuid guid, bool exclaim)
 {
     if (m_ownerGuid)
     {
-        // [] will re-add player after it possible removed
-        PlayerList::iterator p_itr = m_players.find(m_ownerGuid);
-        if (p_itr != m_players.end())
-            { p_itr->second.SetOwner(false); }
+        PlayerIndex::const_iterator p_itr = m_playerIndex.find(m_ownerGuid);
+        if (p_itr != m_playerIndex.end())
+            { m_players[p_itr->second].SetOwner(false); }
     }
 
     m_ownerGuid = guid;
@@ -690,7 +688,7 @@ void Channel::SetOwner(ObjectGuid guid, bool exclaim)
     if (m_ownerGuid)
     {
         uint8 oldFlag = GetPlayerFlags(m_ownerGuid);
-        m_players[m_ownerGuid].SetOwner(true);
+        GetMember(m_ownerGuid).SetOwner(true);
 
         WorldPacket data;
         MakeModeChange(&data, m_ownerGuid, oldFlag);
@@ -704,23 +702,67 @@ void Channel::SetOwner(ObjectGuid guid, bool exclaim)
     }
 }
 
+void Channel::AddMember(Player* player)
+{
+    PlayerInfo pinfo;
+    pinfo.player = player->GetObjectGuid();
+    pinfo.plr = player;
+    pinfo.flags = MEMBER_FLAG_NONE;
+
+    m_playerIndex[pinfo.player] = m_players.size();
+    m_players.push_back(pinfo);
+}
+
+void Channel::RemoveMember(ObjectGuid guid)
+{
+    PlayerIndex::iterator p_itr = m_playerIndex.find(guid);
+    if (p_itr == m_playerIndex.end())
+        { return; }
+
+    // the last member takes the place of the removed one
+    uint32 index = p_itr->second;
+    m_playerIndex.erase(p_itr);
+
+    if (index + 1 != m_players.size())
+    {
+        m_players[index] = m_players.back();
+        m_playerIndex[m_players[index].player] = index;
+    }
+
+    m_players.pop_back();
+}
+
 void Channel::SendToAll(WorldPacket* data, ObjectGuid guid)
 {
+    // small channels get the packet directly, it keeps its order to the packets sent to one member
+    bool broadcast = m_players.size() >= CHANNEL_BROADCAST_MIN_MEMBERS;
+    std::vector<WorldSocket*> sockets;
+
     for (PlayerList::const_iterator i = m_players.begin(); i != m_players.end(); ++i)
     {
-        if (Player* plr = sObjectMgr.GetPlayer(i->first))
-        {
-            if (!guid || !plr->GetSocial()->HasIgnore(guid))
-            {
-                plr->GetSession()->SendPacket(data);
-            }
-        }
+        Player* plr = i->plr;
+        if (!plr->IsInWorld())
+            { continue; }
+
+        if (guid && plr->GetSocial()->HasIgnore(guid))
+            { continue; }
+
+        if (broadcast)
+            { plr->GetSession()->AddBroadcastTarget(sockets); }
+        else
+            { plr->GetSession()->SendPacket(data); }
     }
+
+    // one copy of the packet is shared by the network threads
+    if (broadcast)
+        { sWorldSocketMgr->BroadcastPacket(*data, sockets); }
 }
 
 void Channel::SendToOne(WorldPacket* data, ObjectGuid who)
 {
-    if (Player* plr = ObjectMgr::GetPlayer(who))
+    PlayerIndex::const_iterator p_itr = m_playerIndex.find(who);
+    Player* plr = p_itr != m_playerIndex.end() ? m_players[p_itr->second].plr : ObjectMgr::GetPlayer(who);
+    if (plr && plr->IsInWorld())
         { plr->GetSession()->SendPacket(data); }
 }
 
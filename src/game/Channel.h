@@ -34,6 +34,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 enum ChatNotify
 {
@@ -88,6 +89,9 @@ enum ChannelIds
     CHANNEL_ID_GUILD_RECRUITMENT = 25
 };
 
+/// Channels from this size on are sent to through the network threads, see WorldSocketMgr::BroadcastPacket
+#define CHANNEL_BROADCAST_MIN_MEMBERS 64
+
 class Channel
 {
         enum ChannelFlags
@@ -138,6 +142,7 @@ class Channel
         struct PlayerInfo
         {
             ObjectGuid player;
+            Player* plr;                                    // members leave all channels before logout
             uint8 flags;
 
             bool HasFlag(uint8 flag) { return flags & flag; }
@@ -255,24 +260,35 @@ class Channel
         void SendToAll(WorldPacket* data, ObjectGuid guid = ObjectGuid());
         void SendToOne(WorldPacket* data, ObjectGuid who);
 
-        bool IsOn(ObjectGuid who) const { return m_players.find(who) != m_players.end(); }
+        bool IsOn(ObjectGuid who) const { return m_playerIndex.find(who) != m_playerIndex.end(); }
         bool IsBanned(ObjectGuid guid) const { return m_banned.find(guid) != m_banned.end(); }
 
         uint8 GetPlayerFlags(ObjectGuid guid) const
         {
-            PlayerList::const_iterator p_itr = m_players.find(guid);
-            if (p_itr == m_players.end())
+            PlayerIndex::const_iterator p_itr = m_playerIndex.find(guid);
+            if (p_itr == m_playerIndex.end())
                 { return 0; }
 
-            return p_itr->second.flags;
+            return m_players[p_itr->second].flags;
         }
 
+        /// member data of a player known to be on the channel
+        PlayerInfo& GetMember(ObjectGuid guid)
+        {
+            PlayerIndex::const_iterator p_itr = m_playerIndex.find(guid);
+            MANGOS_ASSERT(p_itr != m_playerIndex.end());
+            return m_players[p_itr->second];
+        }
+
+        void AddMember(Player* player);
+        void RemoveMember(ObjectGuid guid);
+
         void SetModerator(ObjectGuid guid, bool set)
         {
-            if (m_players[guid].IsModerator() != set)
+            if (GetMember(guid).IsModerator() != set)
             {
                 uint8 oldFlag = GetPlayerFlags(guid);
-                m_players[guid].SetModerator(set);
+                GetMember(guid).SetModerator(set);
 
                 WorldPacket data;
                 MakeModeChange(&data, guid, oldFlag);
@@ -282,10 +298,10 @@ class Channel
 
         void SetMute(ObjectGuid guid, bool set)
         {
-            if (m_players[guid].IsMuted() != set)
+            if (GetMember(guid).IsMuted() != set)
             {
                 uint8 oldFlag = GetPlayerFlags(guid);
-                m_players[guid].SetMuted(set);
+                GetMember(guid).SetMuted(set);
 
                 WorldPacket data;
                 MakeModeChange(&data, guid, oldFlag);
@@ -302,8 +318,11 @@ class Channel
         uint32      m_channelId;
         ObjectGuid  m_ownerGuid;
 
-        typedef     std::map<ObjectGuid, PlayerInfo> PlayerList;
+        // members in a flat array for the broadcasts, at their index in m_playerIndex
+        typedef     std::vector<PlayerInfo> PlayerList;
+        typedef     UNORDERED_MAP<ObjectGuid, uint32> PlayerIndex;
         PlayerList  m_players;
+        PlayerIndex m_playerIndex;
         GuidSet m_banned;
 };
 #endif
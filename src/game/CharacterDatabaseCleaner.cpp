@@ -26,72 +26,137 @@
 #include "CharacterDatabaseCleaner.h"
 #include "World.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/SqlBatch.h"
 #include "DBCStores.h"
-#include "ProgressBar.h"
+
+#include <set>
+
+#define CLEANING_GUID_RANGE 1000                            // characters checked by one query
+
+namespace CharacterDatabaseCleaner
+{
+    struct CleaningPass
+    {
+        uint32 flag;
+        char const* column;
+        char const* table;
+        bool (*check)(uint32);
+    };
+
+    CleaningPass const cleaningPasses[] =
+    {
+        { CLEANING_FLAG_SKILLS, "skill", "character_skills", &SkillCheck },
+        { CLEANING_FLAG_SPELLS, "spell", "character_spell",  &SpellCheck },
+    };
+
+    uint32 const cleaningPassCount = sizeof(cleaningPasses) / sizeof(cleaningPasses[0]);
+
+    uint32 cleaningFlags = 0;                               // passes left to do
+    uint32 cleaningMaxGuid = 0;
+    std::set<uint32> cleaningInvalidIds;                    // found by the current pass
+    bool cleaning = false;
+
+    void QueryRange(uint32 pass, uint32 rangeStart);
+    void StartPass(uint32 pass);
+    void HandleRangeResult(QueryResult* result, uint32 pass, uint32 rangeStart);
+}
 
 void CharacterDatabaseCleaner::CleanDatabase()
 {
     // config to disable
-    if (!sWorld.getConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB))
+    if (!sWorld.getConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB) || cleaning)
         { return; }
 
-    sLog.outString("Cleaning character database...");
-
     // check flags which clean ups are necessary
     QueryResult* result = CharacterDatabase.PQuery("SELECT cleaning_flags FROM saved_variables");
     if (!result)
         { return; }
-    uint32 flags = (*result)[0].GetUInt32();
+    cleaningFlags = (*result)[0].GetUInt32();
+    delete result;
+
+    if (!cleaningFlags)
+        { return; }
+
+    result = CharacterDatabase.Query("SELECT MAX(guid) FROM characters");
+    cleaningMaxGuid = result ? (*result)[0].GetUInt32() : 0;
     delete result;
 
-    // clean up
-    if (flags & CLEANING_FLAG_SKILLS)
-        { CleanCharacterSkills(); }
-    if (flags & CLEANING_FLAG_SPELLS)
-        { CleanCharacterSpell(); }
-    CharacterDatabase.Execute("UPDATE saved_variables SET cleaning_flags = 0");
+    sLog.outString("Cleaning character database in the background (flags %u, characters up to guid %u)...", cleaningFlags, cleaningMaxGuid);
+
+    cleaning = true;
+    StartPass(0);
 }
 
-void CharacterDatabaseCleaner::CheckUnique(const char* column, const char* table, bool (*check)(uint32))
+bool CharacterDatabaseCleaner::IsCleaning()
 {
-    QueryResult* result = CharacterDatabase.PQuery("SELECT DISTINCT %s FROM %s", column, table);
-    if (!result)
+    return cleaning;
+}
+
+void CharacterDatabaseCleaner::StartPass(uint32 pass)
+{
+    while (pass < cleaningPassCount && !(cleaningFlags & cleaningPasses[pass].flag))
+        { ++pass; }
+
+    if (pass >= cleaningPassCount)
     {
-        sLog.outString("Table %s is empty.", table);
+        CharacterDatabase.Execute("UPDATE saved_variables SET cleaning_flags = 0");
+        sLog.outString("Cleaning character database done");
+        cleaning = false;
         return;
     }
 
-    bool found = false;
-    std::ostringstream ss;
-    BarGoLink bar(result->GetRowCount());
-    do
-    {
-        bar.step();
+    cleaningInvalidIds.clear();
+    QueryRange(pass, 0);
+}
 
-        Field* fields = result->Fetch();
+void CharacterDatabaseCleaner::QueryRange(uint32 pass, uint32 rangeStart)
+{
+    CleaningPass const& cleaningPass = cleaningPasses[pass];
+    CharacterDatabase.AsyncPQuery(&HandleRangeResult, pass, rangeStart, "SELECT DISTINCT %s FROM %s WHERE guid >= %u AND guid < %u",
+                                  cleaningPass.column, cleaningPass.table, rangeStart, rangeStart + CLEANING_GUID_RANGE);
+}
 
-        uint32 id = fields[0].GetUInt32();
+void CharacterDatabaseCleaner::HandleRangeResult(QueryResult* result, uint32 pass, uint32 rangeStart)
+{
+    CleaningPass const& cleaningPass = cleaningPasses[pass];
 
-        if (!check(id))
+    if (result)
+    {
+        std::set<uint32> invalid;
+        do
         {
-            if (!found)
-            {
-                ss << "DELETE FROM " << table << " WHERE " << column << " IN (";
-                found = true;
-            }
-            else
-                { ss << ","; }
-            ss << id;
+            uint32 id = (*result)[0].GetUInt32();
+            if (!cleaningPass.check(id))
+                { invalid.insert(id); }
+        }
+        while (result->NextRow());
+        delete result;
+
+        if (!invalid.empty())
+        {
+            std::ostringstream condition;
+            condition << "guid >= " << rangeStart << " AND guid < " << rangeStart + CLEANING_GUID_RANGE;
+
+            SqlDeleteBatch batch(CharacterDatabase, cleaningPass.table, cleaningPass.column, condition.str());
+            for (std::set<uint32>::const_iterator itr = invalid.begin(); itr != invalid.end(); ++itr)
+                { batch.addKey(*itr); }
+            batch.Execute();
+
+            cleaningInvalidIds.insert(invalid.begin(), invalid.end());
         }
     }
-    while (result->NextRow());
-    delete result;
 
-    if (found)
+    uint32 nextStart = rangeStart + CLEANING_GUID_RANGE;
+    if (nextStart <= cleaningMaxGuid)
     {
-        ss << ")";
-        CharacterDatabase.Execute(ss.str().c_str());
+        DEBUG_LOG("CharacterDatabaseCleaner: %s checked up to guid %u of %u", cleaningPass.table, nextStart, cleaningMaxGuid);
+        QueryRange(pass, nextStart);
+        return;
     }
+
+    sLog.outString("CharacterDatabaseCleaner: %s cleaned, rows of %u invalid %s ids removed", cleaningPass.table, uint32(cleaningInvalidIds.size()), cleaningPass.column);
+    cleaningInvalidIds.clear();
+    StartPass(pass + 1);
 }
 
 bool CharacterDatabaseCleaner::SkillCheck(uint32 skill)
@@ -99,17 +164,7 @@ bool CharacterDatabaseCleaner::SkillCheck(uint32 skill)
     return sSkillLineStore.LookupEntry(skill);
 }
 
-void CharacterDatabaseCleaner::CleanCharacterSkills()
-{
-    CheckUnique("skill", "character_skills", &SkillCheck);
-}
-
 bool CharacterDatabaseCleaner::SpellCheck(uint32 spell_id)
 {
     return sSpellStore.LookupEntry(spell_id);
 }
-
-void CharacterDatabaseCleaner::CleanCharacterSpell()
-{
-    CheckUnique("spell", "character_spell", &SpellCheck);
-}
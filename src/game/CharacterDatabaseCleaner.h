@@ -36,15 +36,18 @@ namespace CharacterDatabaseCleaner
     };
 
 
+    /**
+     * @brief starts the clean ups flagged in saved_variables
+     *
+     * The tables are checked in guid ranges by async queries, the invalid rows
+     * found in a range are deleted before the next range is queried. Nothing
+     * waits for the queries, the clean up runs while the realm is up.
+     */
     void CleanDatabase();
-
-    void CheckUnique(const char* column, const char* table, bool (*check)(uint32));
+    bool IsCleaning();
 
     bool SkillCheck(uint32 skill);
     bool SpellCheck(uint32 spell_id);
-
-    void CleanCharacterSkills();
-    void CleanCharacterSpell();
 }
 
 #endif
@@ -37,6 +37,7 @@
 #include "UpdateMask.h"
 #include "Auth/md5.h"
 #include "ObjectAccessor.h"
+#include "WhoListMgr.h"
 #include "Group.h"
 #include "Database/DatabaseImpl.h"
 #include "PlayerDump.h"
@@ -46,6 +47,7 @@
 #include "Chat.h"
 #include "SpellMgr.h"
 #include "LuaEngine.h"
+#include "PlayerNameCache.h"
 
 // config option SkipCinematics supported values
 enum CinematicsSkipMode
@@ -66,8 +68,21 @@ class LoginQueryHolder : public SqlQueryHolder
         ObjectGuid GetGuid() const { return m_guid; }
         uint32 GetAccountId() const { return m_accountId; }
         bool Initialize();
+
+    private:
+        bool SetGuidQuery(size_t index, const char* sql);
 };
 
+// all login queries select by the character guid only, so they are prepared once per connection
+bool LoginQueryHolder::SetGuidQuery(size_t index, const char* sql)
+{
+    static SqlStatementID loginQueries[MAX_PLAYER_LOGIN_QUERY];
+
+    SqlStatement stmt = CharacterDatabase.CreateStatement(loginQueries[index], sql);
+    stmt.addUInt32(m_guid.GetCounter());
+    return SetStmtQuery(index, stmt);
+}
+
 bool LoginQueryHolder::Initialize()
 {
     SetSize(MAX_PLAYER_LOGIN_QUERY);
@@ -76,30 +91,30 @@ bool LoginQueryHolder::Initialize()
 
     // NOTE: all fields in `characters` must be read to prevent lost character data at next save in case wrong DB structure.
     // !!! NOTE: including unused `zone`,`online`
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADFROM,            "SELECT guid, account, name, race, class, gender, level, xp, money, playerBytes, playerBytes2, playerFlags,"
-                     "position_x, position_y, position_z, map, orientation, taximask, cinematic, totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, resettalents_cost,"
-                     "resettalents_time, trans_x, trans_y, trans_z, trans_o, transguid, extra_flags, stable_slots, at_login, zone, online, death_expire_time, taxi_path,"
-                     "honor_highest_rank, honor_standing, stored_honor_rating, stored_dishonorable_kills, stored_honorable_kills,"
-                     "watchedFaction, drunk,"
-                     "health, power1, power2, power3, power4, power5, exploredZones, equipmentCache, ammoId, actionBars FROM characters WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADGROUP,           "SELECT groupId FROM group_member WHERE memberGuid ='%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADBOUNDINSTANCES,  "SELECT id, permanent, map, resettime FROM character_instance LEFT JOIN instance ON instance = id WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADAURAS,           "SELECT caster_guid,item_guid,spell,stackcount,remaincharges,basepoints0,basepoints1,basepoints2,periodictime0,periodictime1,periodictime2,maxduration,remaintime,effIndexMask FROM character_aura WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADSPELLS,          "SELECT spell,active,disabled FROM character_spell WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADQUESTSTATUS,     "SELECT quest,status,rewarded,explored,timer,mobcount1,mobcount2,mobcount3,mobcount4,itemcount1,itemcount2,itemcount3,itemcount4 FROM character_queststatus WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADHONORCP,         "SELECT victim_type,victim,honor,date,type FROM character_honor_cp WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADREPUTATION,      "SELECT faction,standing,flags FROM character_reputation WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADINVENTORY,       "SELECT data,bag,slot,item,item_template FROM character_inventory JOIN item_instance ON character_inventory.item = item_instance.guid WHERE character_inventory.guid = '%u' ORDER BY bag,slot", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADITEMLOOT,        "SELECT guid,itemid,amount,property FROM item_loot WHERE owner_guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADACTIONS,         "SELECT button,action,type FROM character_action WHERE guid = '%u' ORDER BY button", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADSOCIALLIST,      "SELECT friend,flags FROM character_social WHERE guid = '%u' LIMIT 255", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADHOMEBIND,        "SELECT map,zone,position_x,position_y,position_z FROM character_homebind WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADSPELLCOOLDOWNS,  "SELECT spell,item,time FROM character_spell_cooldown WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADGUILD,           "SELECT guildid,rank FROM guild_member WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADBGDATA,          "SELECT instance_id, team, join_x, join_y, join_z, join_o, join_map FROM character_battleground_data WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADSKILLS,          "SELECT skill, value, max FROM character_skills WHERE guid = '%u'", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADMAILS,           "SELECT id,messageType,sender,receiver,subject,itemTextId,expire_time,deliver_time,money,cod,checked,stationery,mailTemplateId,has_items FROM mail WHERE receiver = '%u' ORDER BY id DESC", m_guid.GetCounter());
-    res &= SetPQuery(PLAYER_LOGIN_QUERY_LOADMAILEDITEMS,     "SELECT data, mail_id, item_guid, item_template FROM mail_items JOIN item_instance ON item_guid = guid WHERE receiver = '%u'", m_guid.GetCounter());
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADFROM,         "SELECT guid, account, name, race, class, gender, level, xp, money, playerBytes, playerBytes2, playerFlags,"
+                        "position_x, position_y, position_z, map, orientation, taximask, cinematic, totaltime, leveltime, rest_bonus, logout_time, is_logout_resting, resettalents_cost,"
+                        "resettalents_time, trans_x, trans_y, trans_z, trans_o, transguid, extra_flags, stable_slots, at_login, zone, online, death_expire_time, taxi_path,"
+                        "honor_highest_rank, honor_standing, stored_honor_rating, stored_dishonorable_kills, stored_honorable_kills,"
+                        "watchedFaction, drunk,"
+                        "health, power1, power2, power3, power4, power5, exploredZones, equipmentCache, ammoId, actionBars FROM characters WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADGROUP,        "SELECT groupId FROM group_member WHERE memberGuid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADBOUNDINSTANCES, "SELECT id, permanent, map, resettime FROM character_instance LEFT JOIN instance ON instance = id WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADAURAS,        "SELECT caster_guid,item_guid,spell,stackcount,remaincharges,basepoints0,basepoints1,basepoints2,periodictime0,periodictime1,periodictime2,maxduration,remaintime,effIndexMask FROM character_aura WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADSPELLS,       "SELECT spell,active,disabled FROM character_spell WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADQUESTSTATUS,  "SELECT quest,status,rewarded,explored,timer,mobcount1,mobcount2,mobcount3,mobcount4,itemcount1,itemcount2,itemcount3,itemcount4 FROM character_queststatus WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADHONORCP,      "SELECT victim_type,victim,honor,date,type FROM character_honor_cp WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADREPUTATION,   "SELECT faction,standing,flags FROM character_reputation WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADINVENTORY,    "SELECT data,bag,slot,item,item_template FROM character_inventory JOIN item_instance ON character_inventory.item = item_instance.guid WHERE character_inventory.guid = ? ORDER BY bag,slot");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADITEMLOOT,     "SELECT guid,itemid,amount,property FROM item_loot WHERE owner_guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADACTIONS,      "SELECT button,action,type FROM character_action WHERE guid = ? ORDER BY button");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADSOCIALLIST,   "SELECT friend,flags FROM character_social WHERE guid = ? LIMIT 255");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADHOMEBIND,     "SELECT map,zone,position_x,position_y,position_z FROM character_homebind WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADSPELLCOOLDOWNS, "SELECT spell,item,time FROM character_spell_cooldown WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADGUILD,        "SELECT guildid,rank FROM guild_member WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADBGDATA,       "SELECT instance_id, team, join_x, join_y, join_z, join_o, join_map FROM character_battleground_data WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADSKILLS,       "SELECT skill, value, max FROM character_skills WHERE guid = ?");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADMAILS,        "SELECT id,messageType,sender,receiver,subject,itemTextId,expire_time,deliver_time,money,cod,checked,stationery,mailTemplateId,has_items FROM mail WHERE receiver = ? ORDER BY id DESC");
+    res &= SetGuidQuery(PLAYER_LOGIN_QUERY_LOADMAILEDITEMS,  "SELECT mail_id, item_guid, item_template FROM mail_items WHERE receiver = ?");
 
     return res;
 }
@@ -563,6 +578,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
             DEBUG_LOG("WORLD: Sent guild-motd (SMSG_GUILD_EVENT)");
 
             /* Let everyone in the guild know you've just signed in */
+            guild->MemberLoggedIn(pCurrChar);
             guild->BroadcastEvent(GE_SIGNED_ON, pCurrChar->GetObjectGuid(), pCurrChar->GetName());
         }
         /* If the player is not in a guild */
@@ -630,6 +646,7 @@ void WorldSession::HandlePlayerLogin(LoginQueryHolder* holder)
     }
 
     sObjectAccessor.AddObject(pCurrChar);
+    sWhoListMgr.AddPlayer(pCurrChar);
     DEBUG_LOG("Player %s added to map %i", pCurrChar->GetName(), pCurrChar->GetMapId());
 
     /* send the player's social lists */
@@ -927,6 +944,8 @@ void WorldSession::HandleChangePlayerNameOpcodeCallBack(QueryResult* result, uin
     CharacterDatabase.PExecute("UPDATE characters set name = '%s', at_login = at_login & ~ %u WHERE guid ='%u'", newname.c_str(), uint32(AT_LOGIN_RENAME), guidLow);
     CharacterDatabase.CommitTransaction();
 
+    sPlayerNameCache.Rename(guidLow, newname);
+
     sLog.outChar("Account: %d (IP: %s) Character:[%s] (guid:%u) Changed name to: %s", session->GetAccountId(), session->GetRemoteAddress().c_str(), oldname.c_str(), guidLow, newname.c_str());
 
     WorldPacket data(SMSG_CHAR_RENAME, 1 + 8 + (newname.size() + 1));
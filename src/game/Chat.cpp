@@ -220,9 +220,14 @@ ChatCommand* ChatHandler::getCommandTable()
         { "lootrecipient",  SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugGetLootRecipientCommand,    "", NULL },
         { "getitemvalue",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugGetItemValueCommand,        "", NULL },
         { "getvalue",       SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugGetValueCommand,            "", NULL },
+        { "memory",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugMemoryCommand,              "", NULL },
         { "moditemvalue",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugModItemValueCommand,        "", NULL },
         { "modvalue",       SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugModValueCommand,            "", NULL },
+        { "netstats",       SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugNetStatsCommand,            "", NULL },
+        { "opcodestats",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugOpcodeStatsCommand,         "", NULL },
         { "play",           SEC_MODERATOR,      false, NULL,                                                "", debugPlayCommandTable },
+        { "profile",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugProfileCommand,             "", NULL },
+        { "scripthooks",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugScriptHooksCommand,         "", NULL },
         { "send",           SEC_ADMINISTRATOR,  false, NULL,                                                "", debugSendCommandTable },
         { "setaurastate",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugSetAuraStateCommand,        "", NULL },
         { "setitemvalue",   SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugSetItemValueCommand,        "", NULL },
@@ -230,6 +235,7 @@ ChatCommand* ChatHandler::getCommandTable()
         { "spellcheck",     SEC_CONSOLE,        true,  &ChatHandler::HandleDebugSpellCheckCommand,          "", NULL },
         { "spellcoefs",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugSpellCoefsCommand,          "", NULL },
         { "spellmods",      SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugSpellModsCommand,           "", NULL },
+        { "spellstats",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugSpellStatsCommand,          "", NULL },
         { "uws",            SEC_ADMINISTRATOR,  false, &ChatHandler::HandleDebugUpdateWorldStateCommand,    "", NULL },
         { NULL,             0,                  false, NULL,                                                "", NULL }
     };
@@ -494,6 +500,7 @@ ChatCommand* ChatHandler::getCommandTable()
         { "creature_involvedrelation",   SEC_ADMINISTRATOR, true,  &ChatHandler::HandleReloadCreatureQuestInvRelationsCommand, "", NULL },
         { "creature_loot_template",      SEC_ADMINISTRATOR, true,  &ChatHandler::HandleReloadLootTemplatesCreatureCommand,   "", NULL },
         { "creature_questrelation",      SEC_ADMINISTRATOR, true,  &ChatHandler::HandleReloadCreatureQuestRelationsCommand,  "", NULL },
+        { "creature_template",           SEC_ADMINISTRATOR, true,  &ChatHandler::HandleReloadCreatureTemplateCommand,        "", NULL },
         { "creature_template_classlevelstats", SEC_ADMINISTRATOR, true, &ChatHandler::HandleReloadCreaturesStatsCommand,     "", NULL },
         { "db_script_string",            SEC_ADMINISTRATOR, true,  &ChatHandler::HandleReloadDbScriptStringCommand,          "", NULL },
         { "dbscripts_on_creature_death", SEC_ADMINISTRATOR, true,  &ChatHandler::HandleReloadDBScriptsOnCreatureDeathCommand, "", NULL },
@@ -630,16 +637,20 @@ ChatCommand* ChatHandler::getCommandTable()
     static ChatCommand serverCommandTable[] =
     {
         { "corpses",        SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerCorpsesCommand,       "", NULL },
+        { "dbstats",        SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerDbStatsCommand,       "", NULL },
         { "exit",           SEC_CONSOLE,        true,  &ChatHandler::HandleServerExitCommand,          "", NULL },
         { "idlerestart",    SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverIdleRestartCommandTable },
         { "idleshutdown",   SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverShutdownCommandTable },
         { "info",           SEC_PLAYER,         true,  &ChatHandler::HandleServerInfoCommand,          "", NULL },
         { "log",            SEC_CONSOLE,        true,  NULL,                                           "", serverLogCommandTable },
+        { "mapstats",       SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerMapStatsCommand,      "", NULL },
         { "motd",           SEC_PLAYER,         true,  &ChatHandler::HandleServerMotdCommand,          "", NULL },
         { "plimit",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleServerPLimitCommand,        "", NULL },
         { "restart",        SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverRestartCommandTable },
         { "shutdown",       SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverShutdownCommandTable },
         { "set",            SEC_ADMINISTRATOR,  true,  NULL,                                           "", serverSetCommandTable },
+        { "terrainstats",   SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerTerrainStatsCommand,  "", NULL },
+        { "tickstats",      SEC_GAMEMASTER,     true,  &ChatHandler::HandleServerTickStatsCommand,     "", NULL },
         { NULL,             0,                  false, NULL,                                           "", NULL }
     };
 
@@ -1276,18 +1287,8 @@ bool ChatHandler::ParseCommands(const char* text)
     MANGOS_ASSERT(*text);
 
     /// chat case (.command or !command format)
-    if (m_session)
-    {
-        if (m_session->GetSecurity() == SEC_PLAYER && !sWorld.getConfig(CONFIG_BOOL_PLAYER_COMMANDS))
-            { return false; }
-
-        if (text[0] != '!' && text[0] != '.')
-            { return false; }
-
-        /// ignore single . and ! in line
-        if (strlen(text) < 2)
-            { return false; }
-    }
+    if (m_session && !IsChatCommand(text, m_session->GetSecurity()))
+        { return false; }
 
     /// ignore messages staring from many dots.
     if ((text[0] == '.' && text[1] == '.') || (text[0] == '!' && text[1] == '!'))
@@ -1302,6 +1303,27 @@ bool ChatHandler::ParseCommands(const char* text)
     return true;
 }
 
+bool ChatHandler::IsChatCommand(char const* text, AccountTypes security)
+{
+    if (security == SEC_PLAYER && !sWorld.getConfig(CONFIG_BOOL_PLAYER_COMMANDS))
+        { return false; }
+
+    return HasCommandPrefix(text);
+}
+
+bool ChatHandler::HasCommandPrefix(char const* text)
+{
+    if (text[0] != '!' && text[0] != '.')
+        { return false; }
+
+    /// ignore single . and ! in line
+    if (strlen(text) < 2)
+        { return false; }
+
+    /// ignore messages staring from many dots.
+    return text[1] != text[0];
+}
+
 bool ChatHandler::ShowHelpForSubCommands(ChatCommand* table, char const* cmd)
 {
     std::string list;
@@ -1811,7 +1833,8 @@ bool ChatHandler::isValidChatMessage(const char* message)
                             bool foundName = false;
                             for (uint8 i = 0; i < ql->Title.size(); ++i)
                             {
-                                if (ql->Title[i] == buffer)
+                                char const* title = ql->Title.Get(i);
+                                if (title && buffer == title)
                                 {
                                     foundName = true;
                                     break;
@@ -1836,11 +1859,12 @@ bool ChatHandler::isValidChatMessage(const char* message)
                             for (uint8 i = LOCALE_koKR; i < MAX_LOCALE; ++i)
                             {
                                 int8 dbIndex = sObjectMgr.GetIndexForLocale(LocaleConstant(i));
-                                if (dbIndex == -1 || il == NULL || (size_t)dbIndex >= il->Name.size())
+                                char const* locName = (dbIndex == -1 || il == NULL) ? NULL : il->Name.Get(dbIndex);
+                                if (!locName)
                                     // using strange database/client combinations can lead to this case
                                     { expectedName = linkedItem->Name1; }
                                 else
-                                    { expectedName = il->Name[dbIndex]; }
+                                    { expectedName = locName; }
 
                                 if (expectedName == buffer)
                                 {
@@ -95,6 +95,10 @@ class MANGOS_DLL_SPEC ChatHandler
         void PSendSysMessage(int32     entry, ...);
 
         bool ParseCommands(const char* text);
+        /// true if ParseCommands executes the chat message of a player with this security as command
+        static bool IsChatCommand(char const* text, AccountTypes security);
+        /// the part of IsChatCommand not depending on the account, the chat message starts like a command
+        static bool HasCommandPrefix(char const* text);
         ChatCommand const* FindCommand(char const* text);
 
         bool isValidChatMessage(const char* msg);
@@ -214,6 +218,12 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleDebugGetValueCommand(char* args);
         bool HandleDebugModItemValueCommand(char* args);
         bool HandleDebugModValueCommand(char* args);
+        bool HandleDebugMemoryCommand(char* args);
+        bool HandleDebugNetStatsCommand(char* args);
+        bool HandleDebugOpcodeStatsCommand(char* args);
+        bool HandleDebugProfileCommand(char* args);
+        bool HandleDebugScriptHooksCommand(char* args);
+        bool HandleDebugSpellStatsCommand(char* args);
         bool HandleDebugSetAuraStateCommand(char* args);
         bool HandleDebugSetItemValueCommand(char* args);
         bool HandleDebugSetValueCommand(char* args);
@@ -403,6 +413,7 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleReloadConditionsCommand(char* args);
         bool HandleReloadCreatureQuestRelationsCommand(char* args);
         bool HandleReloadCreatureQuestInvRelationsCommand(char* args);
+        bool HandleReloadCreatureTemplateCommand(char* args);
         bool HandleReloadCreaturesStatsCommand(char* args);
         bool HandleReloadDbScriptStringCommand(char* args);
         bool HandleReloadDBScriptsOnCreatureDeathCommand(char* args);
@@ -485,6 +496,10 @@ class MANGOS_DLL_SPEC ChatHandler
         bool HandleSendMassMoneyCommand(char* args);
 
         bool HandleServerCorpsesCommand(char* args);
+        bool HandleServerTickStatsCommand(char* args);
+        bool HandleServerTerrainStatsCommand(char* args);
+        bool HandleServerMapStatsCommand(char* args);
+        bool HandleServerDbStatsCommand(char* args);
         bool HandleServerExitCommand(char* args);
         bool HandleServerIdleRestartCommand(char* args);
         bool HandleServerIdleShutDownCommand(char* args);
@@ -43,12 +43,31 @@
 #include "CellImpl.h"
 #include "LuaEngine.h"
 
+/// Chat types whose messages can be commands, see HandleMessagechatOpcode
+static bool IsCommandChatType(uint32 type)
+{
+    switch (type)
+    {
+        case CHAT_MSG_SAY:
+        case CHAT_MSG_EMOTE:
+        case CHAT_MSG_YELL:
+        case CHAT_MSG_PARTY:
+        case CHAT_MSG_GUILD:
+        case CHAT_MSG_OFFICER:
+        case CHAT_MSG_RAID:
+        case CHAT_MSG_RAID_LEADER:
+            return true;
+        default:
+            return false;
+    }
+}
+
 bool WorldSession::processChatmessageFurtherAfterSecurityChecks(std::string& msg, uint32 lang)
 {
     if (lang != LANG_ADDON)
     {
-        // strip invisible characters for non-addon messages
-        if (sWorld.getConfig(CONFIG_BOOL_CHAT_FAKE_MESSAGE_PREVENTING))
+        // only messages starting like a command come here unstripped, see PreprocessChatPacket
+        if (sWorld.getConfig(CONFIG_BOOL_CHAT_FAKE_MESSAGE_PREVENTING) && ChatHandler::HasCommandPrefix(msg.c_str()))
             { stripLineInvisibleChars(msg); }
 
         if (sWorld.getConfig(CONFIG_UINT32_CHAT_STRICT_LINK_CHECKING_SEVERITY) && GetSecurity() < SEC_MODERATOR
@@ -65,6 +84,67 @@ bool WorldSession::processChatmessageFurtherAfterSecurityChecks(std::string& msg
     return true;
 }
 
+ChatPreprocessResult WorldSession::PreprocessChatPacket(WorldPacket& packet)
+{
+    uint32 type;
+    uint32 lang;
+    std::string target, msg;
+
+    packet >> type;
+    packet >> lang;
+
+    if (type >= MAX_CHAT_MSG_TYPE)
+    {
+        sLog.outError("CHAT: Wrong message type received: %u", type);
+        return CHAT_PREPROCESS_DROP;
+    }
+
+    if (type == CHAT_MSG_WHISPER || type == CHAT_MSG_CHANNEL)
+        { packet >> target; }
+    packet >> msg;
+
+    // the client sends valid UTF-8 only, utf8length clears anything else
+    if (!msg.empty() && !utf8length(msg))
+    {
+        DEBUG_LOG("CHAT: account %u sent a message that is no valid UTF-8", GetAccountId());
+        return CHAT_PREPROCESS_DROP;
+    }
+
+    // commands are executed as typed, AFK and DND messages are only stored as reply. If a message starting like a
+    // command is one depends on the security of the account, the world thread strips it if it is none
+    if (lang == LANG_ADDON || type == CHAT_MSG_AFK || type == CHAT_MSG_DND ||
+        (IsCommandChatType(type) && !msg.empty() && ChatHandler::HasCommandPrefix(msg.c_str())))
+    {
+        packet.rpos(0);
+        return CHAT_PREPROCESS_QUEUE;
+    }
+
+    size_t size = msg.size();
+
+    // strip invisible characters for non-addon messages
+    if (sWorld.getConfig(CONFIG_BOOL_CHAT_FAKE_MESSAGE_PREVENTING))
+        { stripLineInvisibleChars(msg); }
+
+    if (msg.empty())
+        { return CHAT_PREPROCESS_DROP; }
+
+    if (msg.size() == size)
+    {
+        packet.rpos(0);
+        return CHAT_PREPROCESS_QUEUE;
+    }
+
+    WorldPacket cleaned(CMSG_MESSAGECHAT, 4 + 4 + target.size() + 1 + msg.size() + 1);
+    cleaned << uint32(type);
+    cleaned << uint32(lang);
+    if (type == CHAT_MSG_WHISPER || type == CHAT_MSG_CHANNEL)
+        { cleaned << target; }
+    cleaned << msg;
+
+    packet.swap(cleaned);
+    return CHAT_PREPROCESS_QUEUE;
+}
+
 void WorldSession::HandleMessagechatOpcode(WorldPacket& recv_data)
 {
     uint32 type;
@@ -332,6 +412,9 @@ void WorldSession::HandleMessagechatOpcode(WorldPacket& recv_data)
             std::string msg;
             recv_data >> msg;
 
+            if (!processChatmessageFurtherAfterSecurityChecks(msg, lang))
+                { return; }
+
             if (msg.empty())
                 { break; }
 
@@ -366,6 +449,9 @@ void WorldSession::HandleMessagechatOpcode(WorldPacket& recv_data)
             std::string msg;
             recv_data >> msg;
 
+            if (!processChatmessageFurtherAfterSecurityChecks(msg, lang))
+                { return; }
+
             if (msg.empty())
                 { break; }
 
@@ -427,9 +513,6 @@ void WorldSession::HandleMessagechatOpcode(WorldPacket& recv_data)
             std::string msg;
             recv_data >> msg;
 
-            if (!processChatmessageFurtherAfterSecurityChecks(msg, lang))
-                { return; }
-
             if (msg.empty())
                 { break; }
 
@@ -452,9 +535,6 @@ void WorldSession::HandleMessagechatOpcode(WorldPacket& recv_data)
             std::string msg;
             recv_data >> msg;
 
-            if (!processChatmessageFurtherAfterSecurityChecks(msg, lang))
-                { return; }
-
             if (msg.empty())
                 { break; }
 
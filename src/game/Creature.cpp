@@ -54,8 +54,10 @@
 #include "GridNotifiersImpl.h"
 #include "CellImpl.h"
 #include "movement/MoveSplineInit.h"
+#include "movement/MoveSpline.h"
 #include "CreatureLinkingMgr.h"
 #include "LuaEngine.h"
+#include "Profiler.h"
 
 // apply implementation of the singletons
 #include "Policies/Singleton.h"
@@ -143,13 +145,15 @@ Creature::Creature(CreatureSubtype subtype) : Unit(),
     lootForPickPocketed(false), lootForBody(false), lootForSkin(false),
     m_groupLootTimer(0), m_groupLootId(0),
     m_lootMoney(0), m_lootGroupRecipientId(0),
-    m_corpseDecayTimer(0), m_respawnTime(0), m_respawnDelay(25), m_corpseDelay(60), m_aggroDelay(0), m_respawnradius(5.0f),
+    m_corpseDecayTimer(0), m_respawnTime(0), m_respawnParkedTime(0), m_respawnDelay(25), m_corpseDelay(60), m_aggroDelay(0),
+    m_idleTierDiff(0), m_idleTierTicks(0), m_respawnradius(5.0f),
     m_subtype(subtype), m_defaultMovementType(IDLE_MOTION_TYPE), m_equipmentId(0),
     m_AlreadyCallAssistance(false), m_AlreadySearchedAssistance(false),
     m_regenHealth(true), m_AI_locked(false), m_IsDeadByDefault(false),
     m_temporaryFactionFlags(TEMPFACTION_NONE),
     m_meleeDamageSchoolMask(SPELL_SCHOOL_MASK_NORMAL), m_originalEntry(0),
-    m_creatureInfo(NULL)
+    m_creatureInfo(NULL),
+    m_createValuesVersion(0)
 {
     /* Loot data */
     hasBeenLootedOnce = false;
@@ -187,7 +191,7 @@ void Creature::AddToWorld()
 
     ///- Register the creature for guid lookup
     if (!IsInWorld() && GetObjectGuid().GetHigh() == HIGHGUID_UNIT)
-        { GetMap()->GetObjectsStore().insert<Creature>(GetObjectGuid(), (Creature*)this); }
+        { GetMap()->InsertObject<Creature>(GetObjectGuid(), (Creature*)this); }
 
     Unit::AddToWorld();
 }
@@ -199,7 +203,7 @@ void Creature::RemoveFromWorld()
 
     ///- Remove the creature from the accessor
     if (IsInWorld() && GetObjectGuid().GetHigh() == HIGHGUID_UNIT)
-        { GetMap()->GetObjectsStore().erase<Creature>(GetObjectGuid(), (Creature*)NULL); }
+        { GetMap()->EraseObject<Creature>(GetObjectGuid(), (Creature*)NULL); }
 
     Unit::RemoveFromWorld();
 }
@@ -446,6 +450,8 @@ uint32 Creature::ChooseDisplayId(const CreatureInfo* cinfo, const CreatureData*
 
 void Creature::Update(uint32 update_diff, uint32 diff)
 {
+    PROFILE_SCOPE_ID("Creature::Update", GetEntry());
+
     switch (m_deathState)
     {
         case JUST_ALIVED:
@@ -458,10 +464,24 @@ void Creature::Update(uint32 update_diff, uint32 diff)
             break;
         case DEAD:
         {
-            if (m_respawnTime <= time(NULL) && (!m_isSpawningLinked || GetMap()->GetCreatureLinkingHolder()->CanSpawn(this)))
+            time_t now = time(NULL);
+            if (m_respawnTime > now)
+            {
+                // nothing to do until the respawn time, wait for it in the respawn queue without updates
+                // (subtypes have timers of their own in their updates)
+                if (m_subtype == CREATURE_SUBTYPE_GENERIC && !IsRespawnParked())
+                {
+                    m_respawnParkedTime = m_respawnTime;
+                    GetMap()->ScheduleRespawn(this, m_respawnTime);
+                }
+                break;
+            }
+
+            if (!m_isSpawningLinked || GetMap()->GetCreatureLinkingHolder()->CanSpawn(this))
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_AI_AND_MOVEGENSS, "Respawning...");
                 m_respawnTime = 0;
+                m_respawnParkedTime = 0;
                 m_aggroDelay = sWorld.getConfig(CONFIG_UINT32_CREATURE_RESPAWN_AGGRO_DELAY);
                 lootForPickPocketed = false;
                 lootForBody         = false;
@@ -597,6 +617,28 @@ void Creature::StopGroupLoot()
     m_groupLootId = 0;
 }
 
+/**
+ * Decide if an idle creature far from players is updated in this tick
+ *
+ * @param idleRate update only every idleRate-th tick, 1 for creatures near players
+ * @param diff tick time, includes the time of the skipped ticks if the creature is updated
+ * @return false if the update is skipped
+ */
+bool Creature::UpdateIdleTier(uint32 idleRate, uint32& diff)
+{
+    // spread the idle updates over the ticks by guid
+    if (idleRate > 1 && !IsInCombat() && movespline->Finalized() &&
+        (++m_idleTierTicks + GetGUIDLow()) % idleRate != 0)
+    {
+        m_idleTierDiff += diff;
+        return false;
+    }
+
+    diff += m_idleTierDiff;
+    m_idleTierDiff = 0;
+    return true;
+}
+
 void Creature::RegenerateAll(uint32 update_diff)
 {
     if (m_regenTimer > 0)
@@ -772,6 +814,47 @@ bool Creature::Create(uint32 guidlow, CreatureCreatePos& cPos, CreatureInfo cons
     return true;
 }
 
+/**
+ * Creatures entering the view of many players (crowded cities, respawns in busy zones) are sent
+ * the same create block again and again. The values part only depends on the field values and the
+ * observer class, so it is built once per class and reused until any field of the creature changes.
+ */
+void Creature::BuildCreateValuesUpdate(ByteBuffer& buf, Player* target) const
+{
+    if (m_createValuesVersion != m_valuesVersion)
+    {
+        m_createValuesCache.clear();
+        m_createValuesVersion = m_valuesVersion;
+    }
+
+    uint32 updateClass = GetValuesUpdateClass(target, true);
+    for (ValuesUpdateBlockCache::const_iterator itr = m_createValuesCache.begin(); itr != m_createValuesCache.end(); ++itr)
+    {
+        if (itr->first == updateClass)
+        {
+            buf.append(itr->second);
+            return;
+        }
+    }
+
+    ByteBuffer block(500);
+    uint32 maskStorage[UPDATE_MASK_MAX_BLOCKS];
+    UpdateMask updateMask(maskStorage);
+    updateMask.SetCount(m_valuesCount);
+    _SetCreateBits(&updateMask, target);
+    BuildValuesUpdate(UPDATETYPE_CREATE_OBJECT, &block, &updateMask, target);
+    buf.append(block);
+
+    // the build may set UNIT_DYNFLAG_LOOTABLE, blocks of the other classes are outdated then
+    if (m_createValuesVersion != m_valuesVersion)
+    {
+        m_createValuesCache.clear();
+        m_createValuesVersion = m_valuesVersion;
+    }
+
+    m_createValuesCache.push_back(ValuesUpdateBlockCache::value_type(updateClass, block));
+}
+
 bool Creature::IsTrainerOf(Player* pPlayer, bool msg) const
 {
     if (!IsTrainer())
@@ -2471,20 +2554,9 @@ struct SpawnCreatureInMapsWorker
 
     void operator()(Map* map)
     {
-        // We use spawn coords to spawn
+        // We use spawn coords to spawn, the map spawns it at its update, unloaded grids spawn it at load
         if (map->IsLoaded(i_data->posX, i_data->posY))
-        {
-            Creature* pCreature = new Creature;
-            // DEBUG_LOG("Spawning creature %u",*itr);
-            if (!pCreature->LoadFromDB(i_guid, map))
-            {
-                delete pCreature;
-            }
-            else
-            {
-                map->Add(pCreature);
-            }
-        }
+            { map->QueueSpawn(TYPEID_UNIT, i_guid); }
     }
 
     uint32 i_guid;
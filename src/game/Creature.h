@@ -34,6 +34,7 @@
 #include "DBCEnums.h"
 #include "Database/DatabaseEnv.h"
 #include "Cell.h"
+#include "MemoryTracker.h"
 
 #include <list>
 
@@ -274,19 +275,19 @@ struct CreatureModelInfo
 
 struct CreatureLocale
 {
-    std::vector<std::string> Name;
-    std::vector<std::string> SubName;
+    LocaleStrings Name;
+    LocaleStrings SubName;
 };
 
 struct GossipMenuItemsLocale
 {
-    std::vector<std::string> OptionText;
-    std::vector<std::string> BoxText;
+    LocaleStrings OptionText;
+    LocaleStrings BoxText;
 };
 
 struct PointOfInterestLocale
 {
-    std::vector<std::string> IconName;
+    LocaleStrings IconName;
 };
 
 enum InhabitTypeValues
@@ -479,7 +480,7 @@ enum TemporaryFactionFlags                                  // Used at real fact
     TEMPFACTION_ALL,
 };
 
-class MANGOS_DLL_SPEC Creature : public Unit
+class MANGOS_DLL_SPEC Creature : public Unit, public MemoryTracked<MEM_TAG_CREATURE>
 {
         CreatureAI* i_AI;
 
@@ -505,6 +506,7 @@ class MANGOS_DLL_SPEC Creature : public Unit
         char const* GetSubName() const { return GetCreatureInfo()->SubName; }
 
         void Update(uint32 update_diff, uint32 time) override;  // overwrite Unit::Update
+        bool UpdateIdleTier(uint32 idleRate, uint32& diff);
 
         virtual void RegenerateAll(uint32 update_diff);
         uint32 GetEquipmentId() const { return m_equipmentId; }
@@ -526,6 +528,9 @@ class MANGOS_DLL_SPEC Creature : public Unit
         virtual bool CanSwim() const { return GetCreatureInfo()->InhabitType & INHABIT_WATER; }
         bool CanFly()  const { return GetCreatureInfo()->InhabitType & INHABIT_AIR; }
 
+        /// Appends the values part of a create block for target, cached per observer class until a field changes
+        void BuildCreateValuesUpdate(ByteBuffer& buf, Player* target) const;
+
         bool IsTrainerOf(Player* player, bool msg) const;
         bool CanInteractWithBattleMaster(Player* player, bool msg) const;
         bool CanTrainAndResetTalentsOf(Player* pPlayer) const;
@@ -686,6 +691,14 @@ class MANGOS_DLL_SPEC Creature : public Unit
         void Respawn();
         void SaveRespawnTime() override;
 
+        /// Dead and waiting in the respawn queue of the map, the creature is not updated until the map wakes it
+        bool IsRespawnParked() const { return m_respawnParkedTime && m_respawnParkedTime == m_respawnTime && m_deathState == DEAD; }
+        void WakeForRespawn(time_t parkedTime)
+        {
+            if (m_respawnParkedTime == parkedTime)
+                { m_respawnParkedTime = 0; }
+        }
+
         uint32 GetRespawnDelay() const { return m_respawnDelay; }
         void SetRespawnDelay(uint32 delay) { m_respawnDelay = delay; }
 
@@ -762,9 +775,12 @@ class MANGOS_DLL_SPEC Creature : public Unit
         /// Timers
         uint32 m_corpseDecayTimer;                          // (msecs)timer for death or corpse disappearance
         time_t m_respawnTime;                               // (secs) time of next respawn
+        time_t m_respawnParkedTime;                         // (secs) respawn time queued in the map, 0 if not queued
         uint32 m_respawnDelay;                              // (secs) delay between corpse disappearance and respawning
         uint32 m_corpseDelay;                               // (secs) delay between death and corpse disappearance
         uint32 m_aggroDelay;                                // (msecs)delay between respawn and aggro due to movement
+        uint32 m_idleTierDiff;                              // (msecs)tick time of skipped idle updates
+        uint32 m_idleTierTicks;
         float m_respawnradius;
 
         CreatureSubtype m_subtype;                          // set in Creatures subclasses for fast it detect without dynamic_cast use
@@ -797,9 +813,12 @@ class MANGOS_DLL_SPEC Creature : public Unit
     private:
         GridReference<Creature> m_gridRef;
         CreatureInfo const* m_creatureInfo;
+
+        mutable ValuesUpdateBlockCache m_createValuesCache; // create values blocks built at m_createValuesVersion
+        mutable uint32 m_createValuesVersion;
 };
 
-class ForcedDespawnDelayEvent : public BasicEvent
+class ForcedDespawnDelayEvent : public BasicEvent, public MemoryTracked<MEM_TAG_EVENT>
 {
     public:
         ForcedDespawnDelayEvent(Creature& owner) : BasicEvent(), m_owner(owner) { }
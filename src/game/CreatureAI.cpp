@@ -168,7 +168,7 @@ void CreatureAI::HandleMovementOnAttackStart(Unit* victim)
 //                                      Event system
 // ////////////////////////////////////////////////////////////////////////////////////////////////
 
-class AiDelayEventAround : public BasicEvent
+class AiDelayEventAround : public BasicEvent, public MemoryTracked<MEM_TAG_EVENT>
 {
     public:
         AiDelayEventAround(AIEventType eventType, ObjectGuid invokerGuid, Creature& owner, std::list<Creature*> const& receivers, uint32 miscValue) :
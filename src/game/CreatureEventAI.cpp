@@ -45,7 +45,7 @@ bool CreatureEventAIHolder::UpdateRepeatTimer(Creature* creature, uint32 repeatM
         { Time = urand(repeatMin, repeatMax); }
     else
     {
-        sLog.outErrorEventAI("Creature %u using Event %u (Type = %u) has RandomMax < RandomMin. Event repeating disabled.", creature->GetEntry(), Event.event_id, Event.event_type);
+        sLog.outErrorEventAI("Creature %u using Event %u (Type = %u) has RandomMax < RandomMin. Event repeating disabled.", creature->GetEntry(), Event->event_id, Event->event_type);
         Enabled = false;
         return false;
     }
@@ -72,53 +72,30 @@ void CreatureEventAI::GetAIInformation(ChatHandler& reader)
     reader.PSendSysMessage("Current events of this creature:");
     for (CreatureEventAIList::const_iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
     {
-        if (itr->Event.action[2].type != ACTION_T_NONE)
-            { reader.PSendSysMessage("%u Type%3u (%s) Timer(%3us) actions[type(param1)]: %2u(%5u)  --  %2u(%u)  --  %2u(%5u)", itr->Event.event_id, itr->Event.event_type, itr->Enabled ? "On" : "Off", itr->Time / 1000, itr->Event.action[0].type, itr->Event.action[0].raw.param1, itr->Event.action[1].type, itr->Event.action[1].raw.param1, itr->Event.action[2].type, itr->Event.action[2].raw.param1); }
-        else if (itr->Event.action[1].type != ACTION_T_NONE)
-            { reader.PSendSysMessage("%u Type%3u (%s) Timer(%3us) actions[type(param1)]: %2u(%5u)  --  %2u(%5u)", itr->Event.event_id, itr->Event.event_type, itr->Enabled ? "On" : "Off", itr->Time / 1000, itr->Event.action[0].type, itr->Event.action[0].raw.param1, itr->Event.action[1].type, itr->Event.action[1].raw.param1); }
+        if (itr->Event->action[2].type != ACTION_T_NONE)
+            { reader.PSendSysMessage("%u Type%3u (%s) Timer(%3us) actions[type(param1)]: %2u(%5u)  --  %2u(%u)  --  %2u(%5u)", itr->Event->event_id, itr->Event->event_type, itr->Enabled ? "On" : "Off", itr->Time / 1000, itr->Event->action[0].type, itr->Event->action[0].raw.param1, itr->Event->action[1].type, itr->Event->action[1].raw.param1, itr->Event->action[2].type, itr->Event->action[2].raw.param1); }
+        else if (itr->Event->action[1].type != ACTION_T_NONE)
+            { reader.PSendSysMessage("%u Type%3u (%s) Timer(%3us) actions[type(param1)]: %2u(%5u)  --  %2u(%5u)", itr->Event->event_id, itr->Event->event_type, itr->Enabled ? "On" : "Off", itr->Time / 1000, itr->Event->action[0].type, itr->Event->action[0].raw.param1, itr->Event->action[1].type, itr->Event->action[1].raw.param1); }
         else
-            { reader.PSendSysMessage("%u Type%3u (%s) Timer(%3us) action[type(param1)]:  %2u(%5u)", itr->Event.event_id, itr->Event.event_type, itr->Enabled ? "On" : "Off", itr->Time / 1000, itr->Event.action[0].type, itr->Event.action[0].raw.param1); }
+            { reader.PSendSysMessage("%u Type%3u (%s) Timer(%3us) action[type(param1)]:  %2u(%5u)", itr->Event->event_id, itr->Event->event_type, itr->Enabled ? "On" : "Off", itr->Time / 1000, itr->Event->action[0].type, itr->Event->action[0].raw.param1); }
     }
 }
 
 CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c),
+    m_EventSleepTime(0),
+    m_program(sEventAIMgr.AcquireProgram(c->GetEntry())),
     m_Phase(0),
     m_MeleeEnabled(true),
     m_InvinceabilityHpLevel(0),
     m_throwAIEventMask(0),
     m_throwAIEventStep(0)
 {
-    // Need make copy for filter unneeded steps and safe in case table reload
-    CreatureEventAI_Event_Map::const_iterator creatureEventsItr = sEventAIMgr.GetCreatureEventAIMap().find(m_creature->GetEntry());
-    if (creatureEventsItr != sEventAIMgr.GetCreatureEventAIMap().end())
+    if (m_program)
     {
-        uint32 events_count = 0;
-        for (CreatureEventAI_Event_Vec::const_iterator i = (*creatureEventsItr).second.begin(); i != (*creatureEventsItr).second.end(); ++i)
-        {
-            // Debug check
-#ifndef MANGOS_DEBUG
-            if ((*i).event_flags & EFLAG_DEBUG_ONLY)
-                { continue; }
-#endif
-
-            ++events_count;
-        }
-        // EventMap had events but they were not added because they must be for instance
-        if (events_count == 0)
-            { sLog.outErrorEventAI("Creature %u has events but no events added to list because of instance flags (spawned in map %u).", m_creature->GetEntry(), m_creature->GetMapId()); }
-        else
-        {
-            m_CreatureEventAIList.reserve(events_count);
-            for (CreatureEventAI_Event_Vec::const_iterator i = (*creatureEventsItr).second.begin(); i != (*creatureEventsItr).second.end(); ++i)
-            {
-                // Debug check
-#ifndef MANGOS_DEBUG
-                if ((*i).event_flags & EFLAG_DEBUG_ONLY)
-                    { continue; }
-#endif
-                m_CreatureEventAIList.push_back(CreatureEventAIHolder(*i));
-            }
-        }
+        // only the timers and states are per creature
+        m_CreatureEventAIList.reserve(m_program->events.size());
+        for (CreatureEventAI_Event_Vec::const_iterator i = m_program->events.begin(); i != m_program->events.end(); ++i)
+            { m_CreatureEventAIList.push_back(CreatureEventAIHolder(&*i)); }
     }
     else
         { sLog.outErrorEventAI("EventMap for Creature %u is empty but creature is using CreatureEventAI.", m_creature->GetEntry()); }
@@ -127,9 +104,21 @@ CreatureEventAI::CreatureEventAI(Creature* c) : CreatureAI(c),
     JustRespawned();
 }
 
+CreatureEventAI::~CreatureEventAI()
+{
+    if (m_program)
+        { m_program->Release(); }
+}
+
+CreatureEventAI_Program::EventIndexes const& CreatureEventAI::GetEventsOfType(EventAI_Type type) const
+{
+    static CreatureEventAI_Program::EventIndexes const noEvents;
+    return m_program ? m_program->eventsByType[type] : noEvents;
+}
+
 #define LOG_PROCESS_EVENT                                                                                                       \
     DEBUG_FILTER_LOG(LOG_FILTER_EVENT_AI_DEV, "CreatureEventAI: Event type %u (script %u) triggered for %s (invoked by %s)",    \
-                     pHolder.Event.event_type, pHolder.Event.event_id, m_creature->GetGuidStr().c_str(), pActionInvoker ? pActionInvoker->GetGuidStr().c_str() : "<no invoker>")
+                     pHolder.Event->event_type, pHolder.Event->event_id, m_creature->GetGuidStr().c_str(), pActionInvoker ? pActionInvoker->GetGuidStr().c_str() : "<no invoker>")
 
 inline bool IsTimerBasedEvent(EventAI_Type type)
 {
@@ -156,21 +145,24 @@ inline bool IsTimerBasedEvent(EventAI_Type type)
 
 bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pActionInvoker, Creature* pAIEventSender /*=NULL*/)
 {
+    // the event may set timers and phase, so the slept time must be off the timers first
+    WakeUpEvents();
+
     if (!pHolder.Enabled || pHolder.Time)
         { return false; }
 
     // Check the inverse phase mask (event doesn't trigger if current phase bit is set in mask)
-    if (pHolder.Event.event_inverse_phase_mask & (1 << m_Phase))
+    if (pHolder.Event->event_inverse_phase_mask & (1 << m_Phase))
     {
-        if (!IsTimerBasedEvent(pHolder.Event.event_type))
-            { DEBUG_FILTER_LOG(LOG_FILTER_EVENT_AI_DEV, "CreatureEventAI: Event %u skipped because of phasemask %u. Current phase %u", pHolder.Event.event_id, pHolder.Event.event_inverse_phase_mask, m_Phase); }
+        if (!IsTimerBasedEvent(pHolder.Event->event_type))
+            { DEBUG_FILTER_LOG(LOG_FILTER_EVENT_AI_DEV, "CreatureEventAI: Event %u skipped because of phasemask %u. Current phase %u", pHolder.Event->event_id, pHolder.Event->event_inverse_phase_mask, m_Phase); }
         return false;
     }
 
-    if (!IsTimerBasedEvent(pHolder.Event.event_type))
+    if (!IsTimerBasedEvent(pHolder.Event->event_type))
         { LOG_PROCESS_EVENT; }
 
-    CreatureEventAI_Event const& event = pHolder.Event;
+    CreatureEventAI_Event const& event = *pHolder.Event;
 
     // Check event conditions based on the event type, also reset events
     switch (event.event_type)
@@ -411,26 +403,26 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
         case EVENT_T_RECEIVE_AI_EVENT:
             break;
         default:
-            sLog.outErrorEventAI("Creature %u using Event %u has invalid Event Type(%u), missing from ProcessEvent() Switch.", m_creature->GetEntry(), pHolder.Event.event_id, pHolder.Event.event_type);
+            sLog.outErrorEventAI("Creature %u using Event %u has invalid Event Type(%u), missing from ProcessEvent() Switch.", m_creature->GetEntry(), pHolder.Event->event_id, pHolder.Event->event_type);
             break;
     }
 
     // Disable non-repeatable events
-    if (!(pHolder.Event.event_flags & EFLAG_REPEATABLE))
+    if (!(pHolder.Event->event_flags & EFLAG_REPEATABLE))
         { pHolder.Enabled = false; }
 
     // Store random here so that all random actions match up
     uint32 rnd = rand();
 
     // Return if chance for event is not met
-    if (pHolder.Event.event_chance <= rnd % 100)
+    if (pHolder.Event->event_chance <= rnd % 100)
         { return false; }
 
     // Process actions, normal case
-    if (!(pHolder.Event.event_flags & EFLAG_RANDOM_ACTION))
+    if (!(pHolder.Event->event_flags & EFLAG_RANDOM_ACTION))
     {
         for (uint32 j = 0; j < MAX_ACTIONS; ++j)
-            { ProcessAction(pHolder.Event.action[j], rnd, pHolder.Event.event_id, pActionInvoker, pAIEventSender); }
+            { ProcessAction(pHolder.Event->action[j], rnd, pHolder.Event->event_id, pActionInvoker, pAIEventSender); }
     }
     // Process actions, random case
     else
@@ -438,7 +430,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
         // amount of real actions
         uint32 count = 0;
         for (uint32 j = 0; j < MAX_ACTIONS; ++j)
-            if (pHolder.Event.action[j].type != ACTION_T_NONE)
+            if (pHolder.Event->action[j].type != ACTION_T_NONE)
                 { ++count; }
 
         if (count)
@@ -450,7 +442,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
             uint32 j = 0;
             for (; ; ++j)
             {
-                if (pHolder.Event.action[j].type != ACTION_T_NONE)
+                if (pHolder.Event->action[j].type != ACTION_T_NONE)
                 {
                     if (!idx)
                         { break; }
@@ -458,7 +450,7 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
                 }
             }
 
-            ProcessAction(pHolder.Event.action[j], rnd, pHolder.Event.event_id, pActionInvoker, pAIEventSender);
+            ProcessAction(pHolder.Event->action[j], rnd, pHolder.Event->event_id, pActionInvoker, pAIEventSender);
         }
     }
     return true;
@@ -731,7 +723,8 @@ void CreatureEventAI::ProcessAction(CreatureEventAI_Action const& action, uint32
             if (new_phase < 0)
             {
                 sLog.outErrorEventAI("Event %d decrease Phase under 0. CreatureEntry = %d", EventId, m_creature->GetEntry());
-                m_Phase = 0;
+                WakeUpEvents();
+    m_Phase = 0;
             }
             else if (new_phase >= MAX_PHASE)
             {
@@ -1010,19 +1003,21 @@ void CreatureEventAI::JustRespawned()                       // NOTE that this is
     for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
     {
         // Reset generic timer
-        if (i->Event.event_type == EVENT_T_TIMER_GENERIC)
+        if (i->Event->event_type == EVENT_T_TIMER_GENERIC)
         {
-            if (i->UpdateRepeatTimer(m_creature, i->Event.timer.initialMin, i->Event.timer.initialMax))
+            if (i->UpdateRepeatTimer(m_creature, i->Event->timer.initialMin, i->Event->timer.initialMax))
                 { i->Enabled = true; }
         }
         // Handle Spawned Events
-        else if (SpawnedEventConditionsCheck((*i).Event))
+        else if (SpawnedEventConditionsCheck(*(*i).Event))
             { ProcessEvent(*i); }
     }
 }
 
 void CreatureEventAI::Reset()
 {
+    WakeUpEvents();
+
     m_EventUpdateTime = EVENT_UPDATE_TIME;
     m_EventDiff = 0;
     m_throwAIEventStep = 0;
@@ -1030,7 +1025,7 @@ void CreatureEventAI::Reset()
     // Reset all events to enabled
     for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
     {
-        CreatureEventAI_Event const& event = (*i).Event;
+        CreatureEventAI_Event const& event = *(*i).Event;
         switch (event.event_type)
         {
                 // Reset all out of combat timers
@@ -1051,11 +1046,9 @@ void CreatureEventAI::Reset()
 
 void CreatureEventAI::JustReachedHome()
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_REACHED_HOME)
-            { ProcessEvent(*i); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_REACHED_HOME);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i]); }
 
     Reset();
 }
@@ -1072,11 +1065,9 @@ void CreatureEventAI::EnterEvadeMode()
     m_creature->SetLootRecipient(NULL);
 
     // Handle Evade events
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_EVADE)
-            { ProcessEvent(*i); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_EVADE);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i]); }
 }
 
 void CreatureEventAI::JustDied(Unit* killer)
@@ -1094,11 +1085,9 @@ void CreatureEventAI::JustDied(Unit* killer)
         { SendAIEventAround(AI_EVENT_JUST_DIED, killer, 0, AIEVENT_DEFAULT_THROW_RADIUS); }
 
     // Handle On Death events
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_DEATH)
-            { ProcessEvent(*i, killer); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_DEATH);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i], killer); }
 
     // reset phase after any death state events
     m_Phase = 0;
@@ -1109,58 +1098,53 @@ void CreatureEventAI::KilledUnit(Unit* victim)
     if (victim->GetTypeId() != TYPEID_PLAYER)
         { return; }
 
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_KILL)
-            { ProcessEvent(*i, victim); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_KILL);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i], victim); }
 }
 
 void CreatureEventAI::JustSummoned(Creature* pUnit)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_UNIT)
-            { ProcessEvent(*i, pUnit); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_SUMMONED_UNIT);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i], pUnit); }
 }
 
 void CreatureEventAI::SummonedCreatureJustDied(Creature* pUnit)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_JUST_DIED)
-            { ProcessEvent(*i, pUnit); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_SUMMONED_JUST_DIED);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i], pUnit); }
 }
 
 void CreatureEventAI::SummonedCreatureDespawn(Creature* pUnit)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_JUST_DESPAWN)
-            { ProcessEvent(*i, pUnit); }
-    }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_SUMMONED_JUST_DESPAWN);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+        { ProcessEvent(m_CreatureEventAIList[*i], pUnit); }
 }
 
 void CreatureEventAI::ReceiveAIEvent(AIEventType eventType, Creature* pSender, Unit* pInvoker, uint32 /*miscValue*/)
 {
     MANGOS_ASSERT(pSender);
 
-    for (CreatureEventAIList::iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_RECEIVE_AI_EVENT);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
     {
-        if (itr->Event.event_type == EVENT_T_RECEIVE_AI_EVENT &&
-            itr->Event.receiveAIEvent.eventType == eventType && (!itr->Event.receiveAIEvent.senderEntry || itr->Event.receiveAIEvent.senderEntry == pSender->GetEntry()))
-            { ProcessEvent(*itr, pInvoker, pSender); }
+        CreatureEventAIHolder& holder = m_CreatureEventAIList[*i];
+        if (holder.Event->receiveAIEvent.eventType == eventType && (!holder.Event->receiveAIEvent.senderEntry || holder.Event->receiveAIEvent.senderEntry == pSender->GetEntry()))
+            { ProcessEvent(holder, pInvoker, pSender); }
     }
 }
 
 void CreatureEventAI::EnterCombat(Unit* enemy)
 {
+    WakeUpEvents();
+
     // Check for on combat start events
     for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
     {
-        CreatureEventAI_Event const& event = (*i).Event;
+        CreatureEventAI_Event const& event = *(*i).Event;
         switch (event.event_type)
         {
             case EVENT_T_AGGRO:
@@ -1207,21 +1191,21 @@ void CreatureEventAI::MoveInLineOfSight(Unit* who)
     // Check for OOC LOS Event
     if (!m_creature->getVictim())
     {
-        for (CreatureEventAIList::iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
+        CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_OOC_LOS);
+        for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
         {
-            if ((*itr).Event.event_type == EVENT_T_OOC_LOS)
-            {
-                // can trigger if closer than fMaxAllowedRange
-                float fMaxAllowedRange = (float)(*itr).Event.ooc_los.maxRange;
+            CreatureEventAIHolder& holder = m_CreatureEventAIList[*i];
 
-                // if range is ok and we are actually in LOS
-                if (m_creature->IsWithinDistInMap(who, fMaxAllowedRange) && m_creature->IsWithinLOSInMap(who))
-                {
-                    // if friendly event&&who is not hostile OR hostile event&&who is hostile
-                    if (((*itr).Event.ooc_los.noHostile && !m_creature->IsHostileTo(who)) ||
-                        ((!(*itr).Event.ooc_los.noHostile) && m_creature->IsHostileTo(who)))
-                        { ProcessEvent(*itr, who); }
-                }
+            // can trigger if closer than fMaxAllowedRange
+            float fMaxAllowedRange = (float)holder.Event->ooc_los.maxRange;
+
+            // if range is ok and we are actually in LOS
+            if (m_creature->IsWithinDistInMap(who, fMaxAllowedRange) && m_creature->IsWithinLOSInMap(who))
+            {
+                // if friendly event&&who is not hostile OR hostile event&&who is hostile
+                if ((holder.Event->ooc_los.noHostile && !m_creature->IsHostileTo(who)) ||
+                    ((!holder.Event->ooc_los.noHostile) && m_creature->IsHostileTo(who)))
+                    { ProcessEvent(holder, who); }
             }
         }
     }
@@ -1254,12 +1238,15 @@ void CreatureEventAI::MoveInLineOfSight(Unit* who)
 
 void CreatureEventAI::SpellHit(Unit* pUnit, const SpellEntry* pSpell)
 {
-    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
-        if ((*i).Event.event_type == EVENT_T_SPELLHIT)
-            // If spell id matches (or no spell id) & if spell school matches (or no spell school)
-            if (!(*i).Event.spell_hit.spellId || pSpell->Id == (*i).Event.spell_hit.spellId)
-                if (GetSchoolMask(pSpell->School) & (*i).Event.spell_hit.schoolMask)
-                    { ProcessEvent(*i, pUnit); }
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_SPELLHIT);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
+    {
+        CreatureEventAIHolder& holder = m_CreatureEventAIList[*i];
+        // If spell id matches (or no spell id) & if spell school matches (or no spell school)
+        if (!holder.Event->spell_hit.spellId || pSpell->Id == holder.Event->spell_hit.spellId)
+            if (GetSchoolMask(pSpell->School) & holder.Event->spell_hit.schoolMask)
+                { ProcessEvent(holder, pUnit); }
+    }
 }
 
 void CreatureEventAI::UpdateAI(const uint32 diff)
@@ -1272,6 +1259,15 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
     {
         m_EventDiff += diff;
 
+        // out of combat only timers make events due, and none is before the sleep time
+        if (!Combat && m_EventDiff < m_EventSleepTime)
+        {
+            m_EventUpdateTime = EVENT_UPDATE_TIME;
+            return;
+        }
+
+        m_EventSleepTime = 0;
+
         // Check for time based events
         for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
         {
@@ -1281,7 +1277,7 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
                 if ((*i).Time > m_EventDiff)
                 {
                     // Do not decrement timers if event can not trigger in this phase
-                    if (!((*i).Event.event_inverse_phase_mask & (1 << m_Phase)))
+                    if (!((*i).Event->event_inverse_phase_mask & (1 << m_Phase)))
                         { (*i).Time -= m_EventDiff; }
 
                     // Skip processing of events that have time remaining
@@ -1291,7 +1287,7 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
             }
 
             // Events that are updated every EVENT_UPDATE_TIME
-            switch ((*i).Event.event_type)
+            switch ((*i).Event->event_type)
             {
                 case EVENT_T_TIMER_OOC:
                 case EVENT_T_TIMER_GENERIC:
@@ -1314,7 +1310,7 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
                     if (Combat)
                     {
                         if (m_creature->getVictim() && m_creature->IsInMap(m_creature->getVictim()))
-                            if (m_creature->IsInRange(m_creature->getVictim(), (float)(*i).Event.range.minDist, (float)(*i).Event.range.maxDist))
+                            if (m_creature->IsInRange(m_creature->getVictim(), (float)(*i).Event->range.minDist, (float)(*i).Event->range.maxDist))
                                 { ProcessEvent(*i); }
                     }
                     break;
@@ -1323,6 +1319,9 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
 
         m_EventDiff = 0;
         m_EventUpdateTime = EVENT_UPDATE_TIME;
+
+        if (!Combat)
+            { m_EventSleepTime = GetEventSleepTime(); }
     }
     else
     {
@@ -1335,6 +1334,58 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
         { DoMeleeAttackIfReady(); }
 }
 
+void CreatureEventAI::WakeUpEvents()
+{
+    if (!m_EventSleepTime)
+        { return; }
+
+    // same as the decrement of UpdateAI, which did not run meanwhile
+    for (CreatureEventAIList::iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    {
+        if (!(*i).Time)
+            { continue; }
+
+        if ((*i).Time > m_EventDiff)
+        {
+            if (!((*i).Event->event_inverse_phase_mask & (1 << m_Phase)))
+                { (*i).Time -= m_EventDiff; }
+        }
+        else
+            { (*i).Time = 0; }
+    }
+
+    m_EventDiff = 0;
+    m_EventSleepTime = 0;
+}
+
+uint32 CreatureEventAI::GetEventSleepTime() const
+{
+    uint32 sleepTime = std::numeric_limits<uint32>::max();
+
+    for (CreatureEventAIList::const_iterator i = m_CreatureEventAIList.begin(); i != m_CreatureEventAIList.end(); ++i)
+    {
+        if (!(*i).Enabled)
+            { continue; }
+
+        if (!(*i).Time)
+        {
+            // out of combat timers did not trigger (e.g. in evade), retry at every update
+            if ((*i).Event->event_type == EVENT_T_TIMER_OOC || (*i).Event->event_type == EVENT_T_TIMER_GENERIC)
+                { return 0; }
+
+            continue;                                       // other events are only processed in combat or when they happen
+        }
+
+        // timers of a masked phase don't run until the phase changes, and a phase change wakes up
+        if ((*i).Event->event_inverse_phase_mask & (1 << m_Phase))
+            { continue; }
+
+        sleepTime = std::min(sleepTime, (*i).Time);
+    }
+
+    return sleepTime;
+}
+
 bool CreatureEventAI::IsVisible(Unit* pl) const
 {
     return m_creature->IsWithinDist(pl, sWorld.getConfig(CONFIG_FLOAT_SIGHT_MONSTER))
@@ -1458,19 +1509,18 @@ void CreatureEventAI::DoFindFriendlyMissingBuff(std::list<Creature*>& _list, flo
 
 void CreatureEventAI::ReceiveEmote(Player* pPlayer, uint32 text_emote)
 {
-    for (CreatureEventAIList::iterator itr = m_CreatureEventAIList.begin(); itr != m_CreatureEventAIList.end(); ++itr)
+    CreatureEventAI_Program::EventIndexes const& events = GetEventsOfType(EVENT_T_RECEIVE_EMOTE);
+    for (CreatureEventAI_Program::EventIndexes::const_iterator i = events.begin(); i != events.end(); ++i)
     {
-        if ((*itr).Event.event_type == EVENT_T_RECEIVE_EMOTE)
-        {
-            if ((*itr).Event.receive_emote.emoteId != text_emote)
-                { return; }
+        CreatureEventAIHolder& holder = m_CreatureEventAIList[*i];
+        if (holder.Event->receive_emote.emoteId != text_emote)
+            { return; }
 
-            PlayerCondition pcon(0, (*itr).Event.receive_emote.condition, (*itr).Event.receive_emote.conditionValue1, (*itr).Event.receive_emote.conditionValue2);
-            if (pcon.Meets(pPlayer, m_creature->GetMap(), m_creature, CONDITION_FROM_EVENTAI))
-            {
-                DEBUG_FILTER_LOG(LOG_FILTER_AI_AND_MOVEGENSS, "CreatureEventAI: ReceiveEmote CreatureEventAI: Condition ok, processing");
-                ProcessEvent(*itr, pPlayer);
-            }
+        PlayerCondition pcon(0, holder.Event->receive_emote.condition, holder.Event->receive_emote.conditionValue1, holder.Event->receive_emote.conditionValue2);
+        if (pcon.Meets(pPlayer, m_creature->GetMap(), m_creature, CONDITION_FROM_EVENTAI))
+        {
+            DEBUG_FILTER_LOG(LOG_FILTER_AI_AND_MOVEGENSS, "CreatureEventAI: ReceiveEmote CreatureEventAI: Condition ok, processing");
+            ProcessEvent(holder, pPlayer);
         }
     }
 }
@@ -30,6 +30,9 @@
 #include "CreatureAI.h"
 #include "Unit.h"
 
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
 class Player;
 class WorldObject;
 
@@ -605,11 +608,42 @@ struct CreatureEventAI_Summon
 // EventSummon_Map
 typedef UNORDERED_MAP<uint32, CreatureEventAI_Summon> CreatureEventAI_Summon_Map;
 
+/**
+ * Events of one creature entry as prepared at load, shared by all its CreatureEventAI.
+ *
+ * A reload of the scripts builds new programs, the running AIs keep their old one
+ * until they are destroyed.
+ */
+class CreatureEventAI_Program
+{
+    public:
+        typedef std::vector<uint16> EventIndexes;
+
+        CreatureEventAI_Program() : m_refs(1) {}
+
+        void AddRef() { ++m_refs; }
+        void Release()
+        {
+            if (--m_refs == 0)
+                { delete this; }
+        }
+
+        // debug only events are left out in release builds
+        CreatureEventAI_Event_Vec events;
+        // indexes into events, the handlers of one event type only visit those
+        EventIndexes eventsByType[EVENT_T_END];
+
+    private:
+        ~CreatureEventAI_Program() {}
+
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;
+};
+
 struct CreatureEventAIHolder
 {
-    CreatureEventAIHolder(CreatureEventAI_Event p) : Event(p), Time(0), Enabled(true) {}
+    CreatureEventAIHolder(CreatureEventAI_Event const* p) : Event(p), Time(0), Enabled(true) {}
 
-    CreatureEventAI_Event Event;
+    CreatureEventAI_Event const* Event;                     // in the program of the AI
     uint32 Time;
     bool Enabled;
 
@@ -621,10 +655,7 @@ class MANGOS_DLL_SPEC CreatureEventAI : public CreatureAI
 {
     public:
         explicit CreatureEventAI(Creature* c);
-        ~CreatureEventAI()
-        {
-            m_CreatureEventAIList.clear();
-        }
+        ~CreatureEventAI();
 
         void GetAIInformation(ChatHandler& reader) override;
 
@@ -666,10 +697,17 @@ class MANGOS_DLL_SPEC CreatureEventAI : public CreatureAI
     protected:
         uint32 m_EventUpdateTime;                           // Time between event updates
         uint32 m_EventDiff;                                 // Time between the last event call
+        uint32 m_EventSleepTime;                            // No event can be due before, updates out of combat are skipped until then
+
+        void WakeUpEvents();
+        uint32 GetEventSleepTime() const;
 
         // Variables used by Events themselves
         typedef std::vector<CreatureEventAIHolder> CreatureEventAIList;
         CreatureEventAIList m_CreatureEventAIList;          // Holder for events (stores enabled, time, and eventid)
+        CreatureEventAI_Program* m_program;                 // the events, NULL if the entry has none
+
+        CreatureEventAI_Program::EventIndexes const& GetEventsOfType(EventAI_Type type) const;
 
         uint8  m_Phase;                                     // Current phase, max 32 phases
         bool   m_MeleeEnabled;                              // If we allow melee auto attack
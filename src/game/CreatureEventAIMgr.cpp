@@ -248,10 +248,63 @@ bool IsValidTargetType(EventAI_Type eventType, EventAI_ActionType actionType, ui
 }
 
 // -------------------
+CreatureEventAIMgr::~CreatureEventAIMgr()
+{
+    ReleasePrograms();
+}
+
+CreatureEventAI_Program* CreatureEventAIMgr::AcquireProgram(uint32 entry) const
+{
+    ProgramMap::const_iterator itr = m_programs.find(entry);
+    if (itr == m_programs.end())
+        { return NULL; }
+
+    itr->second->AddRef();
+    return itr->second;
+}
+
+void CreatureEventAIMgr::ReleasePrograms()
+{
+    // AIs still running keep theirs
+    for (ProgramMap::const_iterator itr = m_programs.begin(); itr != m_programs.end(); ++itr)
+        { itr->second->Release(); }
+
+    m_programs.clear();
+}
+
+void CreatureEventAIMgr::BuildPrograms()
+{
+    for (CreatureEventAI_Event_Map::const_iterator itr = m_CreatureEventAI_Event_Map.begin(); itr != m_CreatureEventAI_Event_Map.end(); ++itr)
+    {
+        CreatureEventAI_Program* program = new CreatureEventAI_Program;
+
+        for (CreatureEventAI_Event_Vec::const_iterator i = itr->second.begin(); i != itr->second.end(); ++i)
+        {
+#ifndef MANGOS_DEBUG
+            if ((*i).event_flags & EFLAG_DEBUG_ONLY)
+                { continue; }
+#endif
+
+            program->eventsByType[(*i).event_type].push_back(uint16(program->events.size()));
+            program->events.push_back(*i);
+        }
+
+        if (program->events.empty())
+        {
+            sLog.outErrorEventAI("Creature %u has events but none is used, all of them are debug only.", itr->first);
+            program->Release();
+            continue;
+        }
+
+        m_programs[itr->first] = program;
+    }
+}
+
 void CreatureEventAIMgr::LoadCreatureEventAI_Scripts()
 {
     // Drop Existing EventAI List
     m_CreatureEventAI_Event_Map.clear();
+    ReleasePrograms();
     std::set<int32> usedTextIds;
 
     // Gather event data
@@ -907,6 +960,7 @@ void CreatureEventAIMgr::LoadCreatureEventAI_Scripts()
 
         CheckUnusedAITexts();
         CheckUnusedAISummons();
+        BuildPrograms();
 
         sLog.outString();
         sLog.outString(">> Loaded %u CreatureEventAI scripts", Count);
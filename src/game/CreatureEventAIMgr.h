@@ -32,7 +32,7 @@ class CreatureEventAIMgr
 {
     public:
         CreatureEventAIMgr() : m_usedTextsAmount(0) {};
-        ~CreatureEventAIMgr() {};
+        ~CreatureEventAIMgr();
 
         void LoadCreatureEventAI_Texts(bool check_entry_use);
         void LoadCreatureEventAI_Summons(bool check_entry_use);
@@ -41,13 +41,21 @@ class CreatureEventAIMgr
         CreatureEventAI_Event_Map  const& GetCreatureEventAIMap()       const { return m_CreatureEventAI_Event_Map; }
         CreatureEventAI_Summon_Map const& GetCreatureEventAISummonMap() const { return m_CreatureEventAI_Summon_Map; }
 
+        /// Program of the entry with a reference for the caller, NULL if it has no events
+        CreatureEventAI_Program* AcquireProgram(uint32 entry) const;
+
     private:
         void CheckUnusedAITexts();
         void CheckUnusedAISummons();
+        void BuildPrograms();
+        void ReleasePrograms();
 
         CreatureEventAI_Event_Map  m_CreatureEventAI_Event_Map;
         CreatureEventAI_Summon_Map m_CreatureEventAI_Summon_Map;
 
+        typedef UNORDERED_MAP<uint32, CreatureEventAI_Program*> ProgramMap;
+        ProgramMap m_programs;
+
         uint32 m_usedTextsAmount;
 };
 
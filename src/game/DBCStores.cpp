@@ -25,12 +25,15 @@
 #include "DBCStores.h"
 #include "Policies/Singleton.h"
 #include "Log.h"
+#include "Config/Config.h"
 #include "ProgressBar.h"
 #include "SharedDefines.h"
 #include "ObjectGuid.h"
 
 #include "DBCfmt.h"
 
+#include <ace/OS_NS_stdlib.h>
+
 #include <map>
 
 typedef std::map<uint32, uint32> AreaIDByAreaFlag;
@@ -166,6 +169,8 @@ std::string AcceptableClientBuildsListStr()
     return data.str();
 }
 
+static std::string dbcCachePath;                            // DBC.CacheDir with trailing slash, empty for no cache files
+
 static bool LoadDBC_assert_print(uint32 fsize, uint32 rsize, const std::string& filename)
 {
     sLog.outError("Size of '%s' setted by format string (%u) not equal size of C++ structure (%u).", filename.c_str(), fsize, rsize);
@@ -181,7 +186,8 @@ inline void LoadDBC(uint32& availableDbcLocales, BarGoLink& bar, StoreProblemLis
     MANGOS_ASSERT(DBCFileLoader::GetFormatRecordSize(storage.GetFormat()) == sizeof(T) || LoadDBC_assert_print(DBCFileLoader::GetFormatRecordSize(storage.GetFormat()), sizeof(T), filename));
 
     std::string dbc_filename = dbc_path + filename;
-    if (storage.Load(dbc_filename.c_str()))
+    std::string cache_filename = dbcCachePath.empty() ? "" : dbcCachePath + filename + ".cache";
+    if (storage.Load(dbc_filename.c_str(), cache_filename.empty() ? NULL : cache_filename.c_str()))
     {
         bar.step();
         for (uint8 i = 0; fullLocaleNameList[i].name; ++i)
@@ -214,6 +220,14 @@ void LoadDBCStores(const std::string& dataPath)
 {
     std::string dbcPath = dataPath + "dbc/";
 
+    dbcCachePath = sConfig.GetStringDefault("DBC.CacheDir", "");
+    if (!dbcCachePath.empty() && dbcCachePath[dbcCachePath.size() - 1] != '/' && dbcCachePath[dbcCachePath.size() - 1] != '\\')
+        { dbcCachePath += '/'; }
+
+    // hexadecimal, the same range in all servers sharing DBC.CacheDir
+    std::string cacheAddress = sConfig.GetStringDefault("DBC.CacheAddress", "");
+    DBCFileLoader::SetCacheAddress(cacheAddress.empty() ? 0 : ACE_OS::strtoull(cacheAddress.c_str(), NULL, 16));
+
     const uint32 DBCFilesCount = 50;
 
     BarGoLink bar(DBCFilesCount);
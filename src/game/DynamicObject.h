@@ -28,6 +28,7 @@
 #include "Object.h"
 #include "DBCEnums.h"
 #include "Unit.h"
+#include "MemoryTracker.h"
 
 enum DynamicObjectType
 {
@@ -38,7 +39,7 @@ enum DynamicObjectType
 
 struct SpellEntry;
 
-class DynamicObject : public WorldObject
+class DynamicObject : public WorldObject, public MemoryTracked<MEM_TAG_DYNOBJECT>
 {
     public:
         explicit DynamicObject();
@@ -0,0 +1,83 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "FollowerRefManager.h"
+#include "Unit.h"
+
+void FollowerRefManager::RecordTrail(Unit const& leader)
+{
+    // a flight leaves no trail to walk
+    if (leader.IsTaxiFlying())
+    {
+        ClearTrail();
+        return;
+    }
+
+    G3D::Vector3 pos(leader.GetPositionX(), leader.GetPositionY(), leader.GetPositionZ());
+
+    if (!m_trail.empty())
+    {
+        float dist = (pos - GetTrailPoint(m_trail.size() - 1)).length();
+        if (dist < FOLLOW_TRAIL_STEP)
+            { return; }
+
+        if (dist > FOLLOW_TRAIL_BREAK)
+            { ClearTrail(); }
+    }
+
+    if (m_trail.size() < FOLLOW_TRAIL_POINTS)
+    {
+        m_trail.reserve(FOLLOW_TRAIL_POINTS);
+        m_trail.push_back(pos);
+    }
+    else
+    {
+        m_trail[m_trailStart] = pos;
+        m_trailStart = (m_trailStart + 1) % FOLLOW_TRAIL_POINTS;
+    }
+}
+
+bool FollowerRefManager::GetTrailPath(G3D::Vector3 const& from, G3D::Vector3 const& dest, Movement::PointsArray& path) const
+{
+    uint32 size = m_trail.size();
+    if (size < 2)
+        { return false; }
+
+    // join the trail at the newest position close to the follower, the trail is walkable from there on
+    int32 join = size - 1;
+    while (join >= 0 && (GetTrailPoint(join) - from).squaredLength() > FOLLOW_TRAIL_STEP * FOLLOW_TRAIL_STEP)
+        { --join; }
+
+    if (join < 0)
+        { return false; }
+
+    path.clear();
+    path.push_back(from);
+    for (uint32 i = join + 1; i < size; ++i)
+        { path.push_back(GetTrailPoint(i)); }
+    path.push_back(dest);
+
+    return true;
+}
@@ -26,11 +26,37 @@
 #define _FOLLOWERREFMANAGER
 
 #include "Utilities/LinkedReference/RefManager.h"
+#include "movement/MoveSplineInitArgs.h"
 
 class Unit;
 class TargetedMovementGeneratorBase;
 
+#define FOLLOW_TRAIL_POINTS     16                          // positions of the leader kept for its followers
+#define FOLLOW_TRAIL_STEP       3.0f                        // distance between them, and to join the trail
+#define FOLLOW_TRAIL_BREAK      20.0f                       // a longer move of the leader (teleport, charge) starts a new trail
+
+/**
+ * Units following and chasing a unit
+ *
+ * Followers keep the positions their leader walked as a trail, which is a valid path for all of them.
+ * A follower close to the trail walks the trail towards its place instead of finding an own path.
+ */
 class FollowerRefManager : public RefManager<Unit, TargetedMovementGeneratorBase>
 {
+    public:
+        FollowerRefManager() : m_trailStart(0) {}
+
+        // add the position of the leader if it moved a trail step since the last one
+        void RecordTrail(Unit const& leader);
+        // path from a follower along the trail to its place, false if the follower is away from the trail
+        bool GetTrailPath(G3D::Vector3 const& from, G3D::Vector3 const& dest, Movement::PointsArray& path) const;
+        void ClearTrail() { m_trail.clear(); m_trailStart = 0; }
+
+    private:
+        // the index-th position, the oldest first
+        G3D::Vector3 const& GetTrailPoint(uint32 index) const { return m_trail[(m_trailStart + index) % m_trail.size()]; }
+
+        Movement::PointsArray m_trail;                      // ring of FOLLOW_TRAIL_POINTS, only filled if the unit has followers
+        uint32 m_trailStart;                                // index of the oldest position
 };
 #endif
@@ -106,7 +106,17 @@ namespace MaNGOS
             return prk;
         }
 
-        inline HonorScores GenerateScores(HonorStandingList standingList, uint32 team)
+        inline HonorStanding const* GetStandingByPosition(HonorStandingList const& standingList, uint32 position)
+        {
+            uint32 pos = 1;
+            for (HonorStandingList::const_iterator itr = standingList.begin(); itr != standingList.end(); ++itr, ++pos)
+                if (pos == position)
+                    { return &*itr; }
+
+            return NULL;
+        }
+
+        inline HonorScores GenerateScores(HonorStandingList const& standingList)
         {
             HonorScores sc;
 
@@ -146,7 +156,7 @@ namespace MaNGOS
 
             // the X values for each breakpoint are found from the CP scores
             // of the players around that point in the WS scores
-            HonorStanding* tempSt;
+            HonorStanding const* tempSt;
             float honor;
 
             // initialize CP array
@@ -155,11 +165,11 @@ namespace MaNGOS
             for (uint8 i = 1; i <= 13; i++)
             {
                 honor = 0.0f;
-                tempSt = sObjectMgr.GetHonorStandingByPosition(sc.BRK[i], team);
+                tempSt = GetStandingByPosition(standingList, sc.BRK[i]);
                 if (tempSt)
                 {
                     honor += tempSt->honorPoints;
-                    tempSt = sObjectMgr.GetHonorStandingByPosition(sc.BRK[i] + 1, team);
+                    tempSt = GetStandingByPosition(standingList, sc.BRK[i] + 1);
                     if (tempSt)
                         { honor += tempSt->honorPoints; }
                 }
@@ -916,6 +916,9 @@ void GameEventMgr::UpdateEventQuests(uint16 event_id, bool Activate)
 
         const_cast<Quest*>(pQuest)->SetQuestActiveState(Activate);
     }
+
+    if (!mGameEventQuests[event_id].empty())
+        { Player::InvalidateAllQuestGiverStatus(); }
 }
 
 void GameEventMgr::SendEventMails(int16 event_id)
@@ -89,7 +89,7 @@ void GameObject::AddToWorld()
 
     ///- Register the gameobject for guid lookup
     if (!IsInWorld())
-        { GetMap()->GetObjectsStore().insert<GameObject>(GetObjectGuid(), (GameObject*)this); }
+        { GetMap()->InsertObject<GameObject>(GetObjectGuid(), (GameObject*)this); }
 
     if (m_model)
         { GetMap()->InsertGameObjectModel(*m_model); }
@@ -126,7 +126,7 @@ void GameObject::RemoveFromWorld()
         if (m_model && GetMap()->ContainsGameObjectModel(*m_model))
             { GetMap()->RemoveGameObjectModel(*m_model); }
 
-        GetMap()->GetObjectsStore().erase<GameObject>(GetObjectGuid(), (GameObject*)NULL);
+        GetMap()->EraseObject<GameObject>(GetObjectGuid(), (GameObject*)NULL);
     }
 
     Object::RemoveFromWorld();
@@ -1658,8 +1658,8 @@ const char* GameObject::GetNameForLocaleIdx(int32 loc_idx) const
         GameObjectLocale const* cl = sObjectMgr.GetGameObjectLocale(GetEntry());
         if (cl)
         {
-            if (cl->Name.size() > (size_t)loc_idx && !cl->Name[loc_idx].empty())
-                { return cl->Name[loc_idx].c_str(); }
+            if (char const* name = cl->Name.Get(loc_idx))
+                { return name; }
         }
     }
 
@@ -1792,6 +1792,7 @@ void GameObject::UpdateCollisionState() const
         { return; }
 
     m_model->enable(IsCollisionEnabled() ? true : false);
+    GetMap()->InvalidateQueryCache();
 }
 
 void GameObject::UpdateModel()
@@ -1927,21 +1928,9 @@ struct SpawnGameObjectInMapsWorker
 
     void operator()(Map* map)
     {
-        // Spawn if necessary (loaded grids only)
+        // Spawn if necessary (loaded grids only), the map spawns it at its update
         if (map->IsLoaded(i_data->posX, i_data->posY))
-        {
-            GameObject* pGameobject = new GameObject;
-            // DEBUG_LOG("Spawning gameobject %u", *itr);
-            if (!pGameobject->LoadFromDB(i_guid, map))
-            {
-                delete pGameobject;
-            }
-            else
-            {
-                if (pGameobject->isSpawnedByDefault())
-                    { map->Add(pGameobject); }
-            }
-        }
+            { map->QueueSpawn(TYPEID_GAMEOBJECT, i_guid); }
     }
 
     uint32 i_guid;
@@ -1986,6 +1975,14 @@ void GameObject::TickCapturePoint()
 {
     // TODO: On retail: Ticks every 5.2 seconds. slider value increase when new player enters on tick
 
+    // no player in the zones of the outdoor pvp script, so none can be in range - skip the search
+    if (m_UniqueUsers.empty())
+    {
+        if (OutdoorPvP* outdoorPvP = sOutdoorPvPMgr.GetScript(GetZoneId()))
+            if (!outdoorPvP->HasPlayers())
+                { return; }
+    }
+
     GameObjectInfo const* info = GetGOInfo();
     float radius = info->capturePoint.radius;
 
@@ -31,6 +31,8 @@
 #include "LootMgr.h"
 #include "Database/DatabaseEnv.h"
 #include "Utilities/EventProcessor.h"
+#include "StringPool.h"
+#include "MemoryTracker.h"
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
@@ -475,7 +477,7 @@ struct GameObjectInfo
 
 struct GameObjectLocale
 {
-    std::vector<std::string> Name;
+    LocaleStrings Name;
 };
 
 // client side GO show states
@@ -545,7 +547,7 @@ struct GameObjectDisplayInfoEntry;
 
 #define GO_ANIMPROGRESS_DEFAULT 100                         // in 3.x 0xFF
 
-class MANGOS_DLL_SPEC GameObject : public WorldObject
+class MANGOS_DLL_SPEC GameObject : public WorldObject, public MemoryTracked<MEM_TAG_GAMEOBJECT>
 {
     public:
         explicit GameObject();
@@ -230,8 +230,8 @@ void PlayerMenu::SendPointOfInterest(uint32 poi_id)
     int loc_idx = GetMenuSession()->GetSessionDbLocaleIndex();
     if (loc_idx >= 0)
         if (PointOfInterestLocale const* pl = sObjectMgr.GetPointOfInterestLocale(poi_id))
-            if (pl->IconName.size() > size_t(loc_idx) && !pl->IconName[loc_idx].empty())
-                { icon_name = pl->IconName[loc_idx]; }
+            if (char const* locText = pl->IconName.Get(loc_idx))
+                { icon_name = locText; }
 
     WorldPacket data(SMSG_GOSSIP_POI, (4 + 4 + 4 + 4 + 4 + 10)); // guess size
     data << uint32(poi->flags);
@@ -430,12 +430,12 @@ void PlayerMenu::SendQuestGiverQuestDetails(Quest const* pQuest, ObjectGuid guid
     {
         if (QuestLocale const* ql = sObjectMgr.GetQuestLocale(pQuest->GetQuestId()))
         {
-            if (ql->Title.size() > (size_t)loc_idx && !ql->Title[loc_idx].empty())
-                { Title = ql->Title[loc_idx]; }
-            if (ql->Details.size() > (size_t)loc_idx && !ql->Details[loc_idx].empty())
-                { Details = ql->Details[loc_idx]; }
-            if (ql->Objectives.size() > (size_t)loc_idx && !ql->Objectives[loc_idx].empty())
-                { Objectives = ql->Objectives[loc_idx]; }
+            if (char const* locText = ql->Title.Get(loc_idx))
+                { Title = locText; }
+            if (char const* locText = ql->Details.Get(loc_idx))
+                { Details = locText; }
+            if (char const* locText = ql->Objectives.Get(loc_idx))
+                { Objectives = locText; }
         }
     }
 
@@ -528,18 +528,18 @@ void PlayerMenu::SendQuestQueryResponse(Quest const* pQuest)
     {
         if (QuestLocale const* ql = sObjectMgr.GetQuestLocale(pQuest->GetQuestId()))
         {
-            if (ql->Title.size() > (size_t)loc_idx && !ql->Title[loc_idx].empty())
-                { Title = ql->Title[loc_idx]; }
-            if (ql->Details.size() > (size_t)loc_idx && !ql->Details[loc_idx].empty())
-                { Details = ql->Details[loc_idx]; }
-            if (ql->Objectives.size() > (size_t)loc_idx && !ql->Objectives[loc_idx].empty())
-                { Objectives = ql->Objectives[loc_idx]; }
-            if (ql->EndText.size() > (size_t)loc_idx && !ql->EndText[loc_idx].empty())
-                { EndText = ql->EndText[loc_idx]; }
+            if (char const* locText = ql->Title.Get(loc_idx))
+                { Title = locText; }
+            if (char const* locText = ql->Details.Get(loc_idx))
+                { Details = locText; }
+            if (char const* locText = ql->Objectives.Get(loc_idx))
+                { Objectives = locText; }
+            if (char const* locText = ql->EndText.Get(loc_idx))
+                { EndText = locText; }
 
             for (int i = 0; i < QUEST_OBJECTIVES_COUNT; ++i)
-                if (ql->ObjectiveText[i].size() > (size_t)loc_idx && !ql->ObjectiveText[i][loc_idx].empty())
-                    { ObjectiveText[i] = ql->ObjectiveText[i][loc_idx]; }
+                if (char const* locText = ql->ObjectiveText[i].Get(loc_idx))
+                    { ObjectiveText[i] = locText; }
         }
     }
 
@@ -640,10 +640,10 @@ void PlayerMenu::SendQuestGiverOfferReward(Quest const* pQuest, ObjectGuid npcGU
     {
         if (QuestLocale const* ql = sObjectMgr.GetQuestLocale(pQuest->GetQuestId()))
         {
-            if (ql->Title.size() > (size_t)loc_idx && !ql->Title[loc_idx].empty())
-                { Title = ql->Title[loc_idx]; }
-            if (ql->OfferRewardText.size() > (size_t)loc_idx && !ql->OfferRewardText[loc_idx].empty())
-                { OfferRewardText = ql->OfferRewardText[loc_idx]; }
+            if (char const* locText = ql->Title.Get(loc_idx))
+                { Title = locText; }
+            if (char const* locText = ql->OfferRewardText.Get(loc_idx))
+                { OfferRewardText = locText; }
         }
     }
 
@@ -722,10 +722,10 @@ void PlayerMenu::SendQuestGiverRequestItems(Quest const* pQuest, ObjectGuid npcG
     {
         if (QuestLocale const* ql = sObjectMgr.GetQuestLocale(pQuest->GetQuestId()))
         {
-            if (ql->Title.size() > (size_t)loc_idx && !ql->Title[loc_idx].empty())
-                { Title = ql->Title[loc_idx]; }
-            if (ql->RequestItemsText.size() > (size_t)loc_idx && !ql->RequestItemsText[loc_idx].empty())
-                { RequestItemsText = ql->RequestItemsText[loc_idx]; }
+            if (char const* locText = ql->Title.Get(loc_idx))
+                { Title = locText; }
+            if (char const* locText = ql->RequestItemsText.Get(loc_idx))
+                { RequestItemsText = locText; }
         }
     }
 
@@ -46,6 +46,7 @@ class Camera;
 #define CENTER_GRID_OFFSET      (SIZE_OF_GRIDS/2)
 
 #define MIN_GRID_DELAY          (MINUTE*IN_MILLISECONDS)
+#define MAX_GRID_EXPIRY_SCALE   8u                      // max. factor of the unload delay for often reloaded grids
 #define MIN_MAP_UPDATE_DELAY    50
 
 #define MAX_NUMBER_OF_CELLS     16
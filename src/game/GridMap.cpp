@@ -31,10 +31,14 @@
 #include "DBCStores.h"
 #include "GridMap.h"
 #include "VMapFactory.h"
+#include "MapTree.h"
 #include "MoveMap.h"
 #include "World.h"
 #include "Policies/Singleton.h"
 #include "Util.h"
+#include "MemoryTracker.h"
+
+#include <algorithm>
 
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "z1.3";
@@ -45,6 +49,7 @@ char const* MAP_LIQUID_MAGIC  = "MLIQ";
 GridMap::GridMap()
 {
     m_flags = 0;
+    m_memoryUsage = 0;
 
     // Area data
     m_gridArea = 0;
@@ -119,6 +124,10 @@ bool GridMap::loadData(char* filename)
             return false;
         }
 
+        // the sections are read into memory as they are stored
+        m_memoryUsage = header.areaMapSize + header.heightMapSize + header.liquidMapSize;
+        MemoryTracker::Allocate(MEM_TAG_GRIDMAP, m_memoryUsage);
+
         fclose(in);
         return true;
     }
@@ -144,6 +153,10 @@ void GridMap::unloadData()
     m_liquidFlags = NULL;
     m_liquid_map  = NULL;
     m_gridGetHeight = &GridMap::getHeightFromFlat;
+
+    if (m_memoryUsage)
+        { MemoryTracker::Free(MEM_TAG_GRIDMAP, m_memoryUsage); }
+    m_memoryUsage = 0;
 }
 
 bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
@@ -284,14 +297,32 @@ float GridMap::getHeightFromFlat(float /*x*/, float /*y*/) const
     return m_gridHeight;
 }
 
-float GridMap::getHeightFromFloat(float x, float y) const
+/**
+ * @brief height of the cell triangle at a point of the grid
+ *
+ * Height stored as: h5 - its v8 grid, h1-h4 - its v9 grid
+ * +--------------> X
+ * | h1-------h2     Coordinates is:
+ * | | \  1  / |     h1 0,0
+ * | |  \   /  |     h2 0,1
+ * | | 2  h5 3 |     h3 1,0
+ * | |  /   \  |     h4 1,1
+ * | | /  4  \ |     h5 1/2,1/2
+ * | h3-------h4
+ * V Y
+ * For find height need
+ * 1 - detect triangle
+ * 2 - solve linear equation from triangle points
+ *
+ * @param V9 heights of the cell corners
+ * @param V8 heights of the cell centers
+ * @param x coordinate in cells, MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS)
+ * @param y coordinate in cells
+ * @return float stored height, integer formats still have to be scaled
+ */
+template<typename Calc, typename Stored>
+static inline float GetCellHeight(Stored const* V9, Stored const* V8, float x, float y)
 {
-    if (!m_V8 || !m_V9)
-        { return m_gridHeight; }
-
-    x = MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS);
-
     int x_int = (int)x;
     int y_int = (int)y;
     x -= x_int;
@@ -299,31 +330,18 @@ float GridMap::getHeightFromFloat(float x, float y) const
     x_int &= (MAP_RESOLUTION - 1);
     y_int &= (MAP_RESOLUTION - 1);
 
-    // Height stored as: h5 - its v8 grid, h1-h4 - its v9 grid
-    // +--------------> X
-    // | h1-------h2     Coordinates is:
-    // | | \  1  / |     h1 0,0
-    // | |  \   /  |     h2 0,1
-    // | | 2  h5 3 |     h3 1,0
-    // | |  /   \  |     h4 1,1
-    // | | /  4  \ |     h5 1/2,1/2
-    // | h3-------h4
-    // V Y
-    // For find height need
-    // 1 - detect triangle
-    // 2 - solve linear equation from triangle points
     // Calculate coefficients for solve h = a*x + b*y + c
-
-    float a, b, c;
+    Stored const* V9_h1_ptr = &V9[x_int * 128 + x_int + y_int];
+    Calc h5 = 2 * Calc(V8[x_int * 128 + y_int]);
+    Calc a, b, c;
     // Select triangle:
     if (x + y < 1)
     {
         if (x > y)
         {
             // 1 triangle (h1, h2, h5 points)
-            float h1 = m_V9[(x_int) * 129 + y_int];
-            float h2 = m_V9[(x_int + 1) * 129 + y_int];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            Calc h1 = V9_h1_ptr[  0];
+            Calc h2 = V9_h1_ptr[129];
             a = h2 - h1;
             b = h5 - h1 - h2;
             c = h1;
@@ -331,9 +349,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 2 triangle (h1, h3, h5 points)
-            float h1 = m_V9[x_int * 129 + y_int  ];
-            float h3 = m_V9[x_int * 129 + y_int + 1];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            Calc h1 = V9_h1_ptr[0];
+            Calc h3 = V9_h1_ptr[1];
             a = h5 - h1 - h3;
             b = h3 - h1;
             c = h1;
@@ -344,9 +361,8 @@ float GridMap::getHeightFromFloat(float x, float y) const
         if (x > y)
         {
             // 3 triangle (h2, h4, h5 points)
-            float h2 = m_V9[(x_int + 1) * 129 + y_int  ];
-            float h4 = m_V9[(x_int + 1) * 129 + y_int + 1];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            Calc h2 = V9_h1_ptr[129];
+            Calc h4 = V9_h1_ptr[130];
             a = h2 + h4 - h5;
             b = h4 - h2;
             c = h5 - h4;
@@ -354,84 +370,33 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 4 triangle (h3, h4, h5 points)
-            float h3 = m_V9[(x_int) * 129 + y_int + 1];
-            float h4 = m_V9[(x_int + 1) * 129 + y_int + 1];
-            float h5 = 2 * m_V8[x_int * 128 + y_int];
+            Calc h3 = V9_h1_ptr[  1];
+            Calc h4 = V9_h1_ptr[130];
             a = h4 - h3;
             b = h3 + h4 - h5;
             c = h5 - h4;
         }
     }
+
     // Calculate height
-    return a * x + b * y + c;
+    return (float)((a * x) + (b * y) + c);
 }
 
-float GridMap::getHeightFromUint8(float x, float y) const
+float GridMap::getHeightFromFloat(float x, float y) const
 {
-    if (!m_uint8_V8 || !m_uint8_V9)
+    if (!m_V8 || !m_V9)
         { return m_gridHeight; }
 
-    x = MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS);
-
-    int x_int = (int)x;
-    int y_int = (int)y;
-    x -= x_int;
-    y -= y_int;
-    x_int &= (MAP_RESOLUTION - 1);
-    y_int &= (MAP_RESOLUTION - 1);
+    return GetCellHeight<float>(m_V9, m_V8, MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS), MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS));
+}
 
-    int32 a, b, c;
-    uint8* V9_h1_ptr = &m_uint8_V9[x_int * 128 + x_int + y_int];
-    if (x + y < 1)
-    {
-        if (x > y)
-        {
-            // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h2 - h1;
-            b = h5 - h1 - h2;
-            c = h1;
-        }
-        else
-        {
-            // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h5 - h1 - h3;
-            b = h3 - h1;
-            c = h1;
-        }
-    }
-    else
-    {
-        if (x > y)
-        {
-            // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h2 + h4 - h5;
-            b = h4 - h2;
-            c = h5 - h4;
-        }
-        else
-        {
-            // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int * 128 + y_int];
-            a = h4 - h3;
-            b = h3 + h4 - h5;
-            c = h5 - h4;
-        }
-    }
+float GridMap::getHeightFromUint8(float x, float y) const
+{
+    if (!m_uint8_V8 || !m_uint8_V9)
+        { return m_gridHeight; }
 
-    // Calculate height
-    return (float)((a * x) + (b * y) + c) * m_gridIntHeightMultiplier + m_gridHeight;
+    return GetCellHeight<int32>(m_uint8_V9, m_uint8_V8, MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS), MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS)) *
+           m_gridIntHeightMultiplier + m_gridHeight;
 }
 
 float GridMap::getHeightFromUint16(float x, float y) const
@@ -439,67 +404,36 @@ float GridMap::getHeightFromUint16(float x, float y) const
     if (!m_uint16_V8 || !m_uint16_V9)
         { return m_gridHeight; }
 
-    x = MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS);
-    y = MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS);
+    return GetCellHeight<int32>(m_uint16_V9, m_uint16_V8, MAP_RESOLUTION * (32 - x / SIZE_OF_GRIDS), MAP_RESOLUTION * (32 - y / SIZE_OF_GRIDS)) *
+           m_gridIntHeightMultiplier + m_gridHeight;
+}
 
-    int x_int = (int)x;
-    int y_int = (int)y;
-    x -= x_int;
-    y -= y_int;
-    x_int &= (MAP_RESOLUTION - 1);
-    y_int &= (MAP_RESOLUTION - 1);
+/**
+ * @brief heights of many points of a grid with integer heights
+ *
+ */
+template<typename Stored>
+static inline void GetCellHeights(Stored const* V9, Stored const* V8, float multiplier, float offset,
+                                  float const* x, float const* y, float* heights, uint32 count)
+{
+    for (uint32 i = 0; i < count; ++i)
+        { heights[i] = GetCellHeight<int32>(V9, V8, MAP_RESOLUTION * (32 - x[i] / SIZE_OF_GRIDS), MAP_RESOLUTION * (32 - y[i] / SIZE_OF_GRIDS)) * multiplier + offset; }
+}
 
-    int32 a, b, c;
-    uint16* V9_h1_ptr = &m_uint16_V9[x_int * 128 + x_int + y_int];
-    if (x + y < 1)
+void GridMap::getHeights(float const* x, float const* y, float* heights, uint32 count) const
+{
+    // the format is selected once, the loops have no call per point
+    if (m_gridGetHeight == &GridMap::getHeightFromFloat && m_V8 && m_V9)
     {
-        if (x > y)
-        {
-            // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h2 - h1;
-            b = h5 - h1 - h2;
-            c = h1;
-        }
-        else
-        {
-            // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h5 - h1 - h3;
-            b = h3 - h1;
-            c = h1;
-        }
+        for (uint32 i = 0; i < count; ++i)
+            { heights[i] = GetCellHeight<float>(m_V9, m_V8, MAP_RESOLUTION * (32 - x[i] / SIZE_OF_GRIDS), MAP_RESOLUTION * (32 - y[i] / SIZE_OF_GRIDS)); }
     }
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint16 && m_uint16_V8 && m_uint16_V9)
+        { GetCellHeights(m_uint16_V9, m_uint16_V8, m_gridIntHeightMultiplier, m_gridHeight, x, y, heights, count); }
+    else if (m_gridGetHeight == &GridMap::getHeightFromUint8 && m_uint8_V8 && m_uint8_V9)
+        { GetCellHeights(m_uint8_V9, m_uint8_V8, m_gridIntHeightMultiplier, m_gridHeight, x, y, heights, count); }
     else
-    {
-        if (x > y)
-        {
-            // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h2 + h4 - h5;
-            b = h4 - h2;
-            c = h5 - h4;
-        }
-        else
-        {
-            // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int * 128 + y_int];
-            a = h4 - h3;
-            b = h3 + h4 - h5;
-            c = h5 - h4;
-        }
-    }
-
-    // Calculate height
-    return (float)((a * x) + (b * y) + c) * m_gridIntHeightMultiplier + m_gridHeight;
+        { std::fill(heights, heights + count, m_gridHeight); }
 }
 
 float GridMap::getLiquidLevel(float x, float y)
@@ -706,6 +640,10 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
         {
             m_GridMaps[i][k] = NULL;
             m_GridRef[i][k] = 0;
+            m_GridMemory[i][k] = 0;
+            m_GridUnusedSince[i][k] = 0;
+            m_PrefetchedGridMaps[i][k] = NULL;
+            m_PrefetchedStale[i][k] = false;
         }
     }
 
@@ -722,7 +660,10 @@ TerrainInfo::~TerrainInfo()
 {
     for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
         for (int i = 0; i < MAX_NUMBER_OF_GRIDS; ++i)
-            { delete m_GridMaps[i][k]; }
+        {
+            delete m_GridMaps[i][k];
+            delete m_PrefetchedGridMaps[i][k];
+        }
 
     VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId);
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId);
@@ -734,7 +675,8 @@ GridMap* TerrainInfo::Load(const uint32 x, const uint32 y)
     MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
 
     // reference grid as a first step
-    RefGrid(x, y);
+    if (RefGrid(x, y) == 1 && m_GridMaps[x][y])
+        { ++m_reusedGrids; }                                // kept loaded while no map used it
 
     // quick check if GridMap already loaded
     GridMap* pMap = m_GridMaps[x][y];
@@ -767,26 +709,39 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     if (!i_timer.Passed())
         { return; }
 
-    for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
     {
-        for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
-        {
-            const int16& iRef = m_GridRef[x][y];
-            GridMap* pMap = m_GridMaps[x][y];
+        // drop prefetched grids nobody entered since the last clean up
+        LOCK_GUARD lock(m_mutex);
 
-            // delete those GridMap objects which have refcount = 0
-            if (pMap && iRef == 0)
+        for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+        {
+            for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
             {
-                m_GridMaps[x][y] = NULL;
-                // delete grid data if reference count == 0
-                pMap->unloadData();
-                delete pMap;
+                if (!m_PrefetchedGridMaps[x][y])
+                    { continue; }
 
-                // unload VMAPS...
-                VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId, x, y);
+                if (m_PrefetchedStale[x][y])
+                {
+                    delete m_PrefetchedGridMaps[x][y];
+                    m_PrefetchedGridMaps[x][y] = NULL;
+                    m_PrefetchedStale[x][y] = false;
+                }
+                else
+                    { m_PrefetchedStale[x][y] = true; }
+            }
+        }
+    }
 
-                // unload mmap...
-                MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId, x, y);
+    // with a memory budget unused grids stay loaded until TerrainManager evicts them
+    if (!sWorld.getConfig(CONFIG_UINT32_TERRAIN_MEMORY_BUDGET))
+    {
+        for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+        {
+            for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+            {
+                // delete those GridMap objects which have refcount = 0
+                if (m_GridMaps[x][y] && m_GridRef[x][y] == 0)
+                    { UnloadGrid(x, y); }
             }
         }
     }
@@ -794,6 +749,70 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
     i_timer.Reset();
 }
 
+void TerrainInfo::UnloadGrid(const uint32 x, const uint32 y)
+{
+    GridMap* pMap = m_GridMaps[x][y];
+    if (!pMap)
+        { return; }
+
+    m_GridMaps[x][y] = NULL;
+    // delete grid data if reference count == 0
+    pMap->unloadData();
+    delete pMap;
+
+    m_memoryUsage -= m_GridMemory[x][y];
+    m_GridMemory[x][y] = 0;
+
+    // unload VMAPS...
+    VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId, x, y);
+
+    // unload mmap...
+    MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId, x, y);
+}
+
+void TerrainInfo::CollectUnusedGrids(std::vector<TerrainUnusedGrid>& grids, uint32 now) const
+{
+    for (uint32 y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+    {
+        for (uint32 x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+        {
+            if (!m_GridMaps[x][y] || m_GridRef[x][y] != 0)
+                { continue; }
+
+            TerrainUnusedGrid grid;
+            grid.age = WorldTimer::getMSTimeDiff(m_GridUnusedSince[x][y], now);
+            grid.terrain = const_cast<TerrainInfo*>(this);
+            grid.x = x;
+            grid.y = y;
+            grid.memory = m_GridMemory[x][y];
+            grids.push_back(grid);
+        }
+    }
+}
+
+void TerrainInfo::AddCacheStats(TerrainCacheStats& stats) const
+{
+    ++stats.terrains;
+    stats.memory += GetMemoryUsage();
+    stats.reusedGrids += uint32(m_reusedGrids.value());
+
+    for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+    {
+        for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+        {
+            if (!m_GridMaps[x][y])
+                { continue; }
+
+            ++stats.loadedGrids;
+            if (m_GridRef[x][y] == 0)
+            {
+                ++stats.unusedGrids;
+                stats.unusedMemory += m_GridMemory[x][y];
+            }
+        }
+    }
+}
+
 int TerrainInfo::RefGrid(const uint32& x, const uint32& y)
 {
     MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
@@ -812,22 +831,32 @@ int TerrainInfo::UnrefGrid(const uint32& x, const uint32& y)
 
     LOCK_GUARD _lock(m_refMutex);
     if (iRef > 0)
-        { return (iRef -= 1); }
+    {
+        if (--iRef == 0)
+            { m_GridUnusedSince[x][y] = WorldTimer::getMSTime(); }
+        return iRef;
+    }
 
     return 0;
 }
 
 float TerrainInfo::GetHeightStatic(float x, float y, float z, bool useVmaps/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
 {
-    float mapHeight = VMAP_INVALID_HEIGHT_VALUE;            // Store Height obtained by maps
+    return CalculateHeight(GetMapHeight(const_cast<TerrainInfo*>(this)->GetGrid(x, y), x, y), x, y, z, useVmaps, maxSearchDist);
+}
+
+float TerrainInfo::GetMapHeight(GridMap* gmap, float x, float y) const
+{
+    // find raw .map surface under Z coordinates (or well-defined above)
+    return gmap ? gmap->getHeight(x, y) : VMAP_INVALID_HEIGHT_VALUE;
+}
+
+float TerrainInfo::CalculateHeight(float mapHeight, float x, float y, float z, bool useVmaps, float maxSearchDist) const
+{
     float vmapHeight = VMAP_INVALID_HEIGHT_VALUE;           // Store Height obtained by vmaps (in "corridor" of z (or slightly above z)
 
     float z2 = z + 2.f;
 
-    // find raw .map surface under Z coordinates (or well-defined above)
-    if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y))
-        { mapHeight = gmap->getHeight(x, y); }
-
     if (useVmaps)
     {
         VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
@@ -891,13 +920,18 @@ bool TerrainInfo::IsOutdoors(float x, float y, float z) const
 }
 
 bool TerrainInfo::GetAreaInfo(float x, float y, float z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
+{
+    return CalculateAreaInfo(const_cast<TerrainInfo*>(this)->GetGrid(x, y), x, y, z, flags, adtId, rootId, groupId);
+}
+
+bool TerrainInfo::CalculateAreaInfo(GridMap* gmap, float x, float y, float z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const
 {
     float vmap_z = z;
     VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
     if (vmgr->getAreaInfo(GetMapId(), x, y, vmap_z, flags, adtId, rootId, groupId))
     {
         // check if there's terrain between player height and object height
-        if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y))
+        if (gmap)
         {
             float _mapheight = gmap->getHeight(x, y);
             // z + 2.0f condition taken from GetHeightStatic(), not sure if it's such a great choice...
@@ -910,6 +944,11 @@ bool TerrainInfo::GetAreaInfo(float x, float y, float z, uint32& flags, int32& a
 }
 
 uint16 TerrainInfo::GetAreaFlag(float x, float y, float z, bool* isOutdoors) const
+{
+    return CalculateAreaFlag(const_cast<TerrainInfo*>(this)->GetGrid(x, y), x, y, z, isOutdoors);
+}
+
+uint16 TerrainInfo::CalculateAreaFlag(GridMap* gmap, float x, float y, float z, bool* isOutdoors) const
 {
     uint32 mogpFlags;
     int32 adtId, rootId, groupId;
@@ -917,7 +956,7 @@ uint16 TerrainInfo::GetAreaFlag(float x, float y, float z, bool* isOutdoors) con
     AreaTableEntry const* atEntry = 0;
     bool haveAreaInfo = false;
 
-    if (GetAreaInfo(x, y, z, mogpFlags, adtId, rootId, groupId))
+    if (CalculateAreaInfo(gmap, x, y, z, mogpFlags, adtId, rootId, groupId))
     {
         haveAreaInfo = true;
         wmoEntry = GetWMOAreaTableEntryByTripple(rootId, adtId, groupId);
@@ -930,7 +969,7 @@ uint16 TerrainInfo::GetAreaFlag(float x, float y, float z, bool* isOutdoors) con
         { areaflag = atEntry->exploreFlag; }
     else
     {
-        if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y))
+        if (gmap)
             { areaflag = gmap->getArea(x, y); }
         // this used while not all *.map files generated (instances)
         else
@@ -971,12 +1010,18 @@ void TerrainInfo::GetZoneAndAreaId(uint32& zoneid, uint32& areaid, float x, floa
 }
 
 GridMapLiquidStatus TerrainInfo::getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData* data) const
+{
+    GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y);
+    float ground_level = CalculateHeight(GetMapHeight(gmap, x, y), x, y, z, true, DEFAULT_WATER_SEARCH);
+    return CalculateLiquidStatus(gmap, ground_level, x, y, z, ReqLiquidType, data);
+}
+
+GridMapLiquidStatus TerrainInfo::CalculateLiquidStatus(GridMap* gmap, float ground_level, float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData* data) const
 {
     GridMapLiquidStatus result = LIQUID_MAP_NO_WATER;
     VMAP::IVMapManager* vmgr = VMAP::VMapFactory::createOrGetVMapManager();
     uint32 liquid_type = 0;
     float liquid_level = INVALID_HEIGHT_VALUE;
-    float ground_level = GetHeightStatic(x, y, z, true, DEFAULT_WATER_SEARCH);
 
     if (vmgr->GetLiquidLevel(GetMapId(), x, y, z, ReqLiquidType, liquid_level, ground_level, liquid_type))
     {
@@ -1011,7 +1056,7 @@ GridMapLiquidStatus TerrainInfo::getLiquidStatus(float x, float y, float z, uint
             result = LIQUID_MAP_ABOVE_WATER;
         }
     }
-    else if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y))
+    else if (gmap)
     {
         GridMapLiquidData map_data;
         GridMapLiquidStatus map_result = gmap->getLiquidStatus(x, y, z, ReqLiquidType, &map_data);
@@ -1027,6 +1072,28 @@ GridMapLiquidStatus TerrainInfo::getLiquidStatus(float x, float y, float z, uint
     return result;
 }
 
+void TerrainInfo::QueryTerrain(float x, float y, float z, TerrainQuery& query) const
+{
+    // the grid and its .map height are resolved once for all parts of the result
+    GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x, y);
+
+    query.mapId = m_mapId;
+    query.x = x;
+    query.y = y;
+    query.z = z;
+
+    query.mapHeight = GetMapHeight(gmap, x, y);
+    query.groundHeight = CalculateHeight(query.mapHeight, x, y, z, true, DEFAULT_WATER_SEARCH);
+
+    memset(&query.liquid, 0, sizeof(query.liquid));
+    query.liquidStatus = CalculateLiquidStatus(gmap, query.groundHeight, x, y, z, MAP_ALL_LIQUIDS, &query.liquid);
+
+    query.areaFlag = CalculateAreaFlag(gmap, x, y, z, &query.outdoors);
+    TerrainManager::GetZoneAndAreaIdByAreaFlag(query.zoneId, query.areaId, query.areaFlag, m_mapId);
+
+    query.valid = true;
+}
+
 bool TerrainInfo::IsInWater(float x, float y, float pZ, GridMapLiquidData* data) const
 {
     // Check surface in x, y point for liquid
@@ -1083,6 +1150,28 @@ float TerrainInfo::GetWaterOrGroundLevel(float x, float y, float z, float* pGrou
     return VMAP_INVALID_HEIGHT_VALUE;
 }
 
+void TerrainInfo::GetMapHeights(float const* x, float const* y, float* heights, uint32 count) const
+{
+    uint32 first = 0;
+    while (first < count)
+    {
+        // consecutive points of one grid are done together
+        int gx = (int)(32 - x[first] / SIZE_OF_GRIDS);
+        int gy = (int)(32 - y[first] / SIZE_OF_GRIDS);
+
+        uint32 end = first + 1;
+        while (end < count && (int)(32 - x[end] / SIZE_OF_GRIDS) == gx && (int)(32 - y[end] / SIZE_OF_GRIDS) == gy)
+            { ++end; }
+
+        if (GridMap* gmap = const_cast<TerrainInfo*>(this)->GetGrid(x[first], y[first]))
+            { gmap->getHeights(x + first, y + first, heights + first, end - first); }
+        else
+            { std::fill(heights + first, heights + end, VMAP_INVALID_HEIGHT_VALUE); }
+
+        first = end;
+    }
+}
+
 GridMap* TerrainInfo::GetGrid(const float x, const float y)
 {
     // half opt method
@@ -1106,21 +1195,16 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
-
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
-
-            if (!map->loadData(tmp))
+            // use the .map data already read by TerrainLoader
+            GridMap* map = m_PrefetchedGridMaps[x][y];
+            if (map)
             {
-                sLog.outError("Error load map file: \n %s\n", tmp);
-                // ASSERT(false);
+                m_PrefetchedGridMaps[x][y] = NULL;
+                m_PrefetchedStale[x][y] = false;
             }
+            else
+                { map = LoadGridMap(x, y); }
 
-            delete[] tmp;
             m_GridMaps[x][y] = map;
 
             // load VMAPs for current map/grid...
@@ -1143,12 +1227,94 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 
             // load navmesh
             MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
+
+            // vmap tiles only reference models VMapManager2 shares between tiles and maps
+            uint32 bytes = map->GetMemoryUsage() + MMAP::MMapFactory::createOrGetMMapManager()->getTileDataSize(m_mapId, x, y);
+            m_GridMemory[x][y] = (bytes + 1023) / 1024;
+            m_GridUnusedSince[x][y] = WorldTimer::getMSTime();
+            m_memoryUsage += m_GridMemory[x][y];
         }
     }
 
     return  m_GridMaps[x][y];
 }
 
+GridMap* TerrainInfo::LoadGridMap(const uint32 x, const uint32 y) const
+{
+    GridMap* map = new GridMap();
+
+    // map file name
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
+    DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+
+    if (!map->loadData(tmp))
+    {
+        sLog.outError("Error load map file: \n %s\n", tmp);
+        // ASSERT(false);
+    }
+
+    delete[] tmp;
+    return map;
+}
+
+// read a file once so loading it later is served from the file system cache
+static void PrefetchFile(std::string const& fileName)
+{
+    FILE* pf = fopen(fileName.c_str(), "rb");
+    if (!pf)
+        { return; }
+
+    char buffer[64 * 1024];
+    while (fread(buffer, 1, sizeof(buffer), pf) == sizeof(buffer)) {}
+
+    fclose(pf);
+}
+
+void TerrainInfo::Prefetch(const uint32 x, const uint32 y)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    {
+        LOCK_GUARD lock(m_mutex);
+        if (m_GridMaps[x][y] || m_PrefetchedGridMaps[x][y])
+            { return; }
+    }
+
+    // the file reads are done without lock, only publishing the GridMap needs it
+    GridMap* map = LoadGridMap(x, y);
+
+    // vmap and mmap tiles are parsed into structures shared with map updates, so only warm up the files here
+    if (VMAP::VMapFactory::createOrGetVMapManager()->isMapLoadingEnabled())
+        { PrefetchFile(sWorld.GetDataPath() + "vmaps/" + VMAP::StaticMapTree::getTileFileName(m_mapId, x, y)); }
+
+    if (MMAP::MMapFactory::IsPathfindingEnabled(m_mapId))
+    {
+        char mmapName[32];
+        snprintf(mmapName, sizeof(mmapName), "mmaps/%03u%02u%02u.mmtile", m_mapId, x, y);
+        PrefetchFile(sWorld.GetDataPath() + mmapName);
+    }
+
+    LOCK_GUARD lock(m_mutex);
+    if (m_GridMaps[x][y] || m_PrefetchedGridMaps[x][y])
+    {
+        // loaded by the map meanwhile
+        delete map;
+        return;
+    }
+
+    m_PrefetchedGridMaps[x][y] = map;
+    m_PrefetchedStale[x][y] = false;
+}
+
+bool TerrainInfo::HasGridData(const uint32 x, const uint32 y)
+{
+    LOCK_GUARD lock(m_mutex);
+    return m_GridMaps[x][y] || m_PrefetchedGridMaps[x][y];
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= NULL*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
@@ -1178,6 +1344,7 @@ INSTANTIATE_CLASS_MUTEX(TerrainManager, ACE_Thread_Mutex);
 
 TerrainManager::TerrainManager()
 {
+    i_evictTimer.SetInterval(1000);
 }
 
 TerrainManager::~TerrainManager()
@@ -1215,7 +1382,8 @@ void TerrainManager::UnloadTerrain(const uint32 mapId)
     {
         TerrainInfo* ptr = (*iter).second;
         // lets check if this object can be actually freed
-        if (ptr->IsReferenced() == false)
+        // with a memory budget its grids are kept for the next instance, RemoveUnusedTerrains frees it
+        if (ptr->IsReferenced() == false && !sWorld.getConfig(CONFIG_UINT32_TERRAIN_MEMORY_BUDGET))
         {
             i_TerrainMap.erase(iter);
             delete ptr;
@@ -1228,6 +1396,73 @@ void TerrainManager::Update(const uint32 diff)
     // global garbage collection for GridMap objects and VMaps
     for (TerrainDataMap::iterator iter = i_TerrainMap.begin(); iter != i_TerrainMap.end(); ++iter)
         { iter->second->CleanUpGrids(diff); }
+
+    uint32 budget = sWorld.getConfig(CONFIG_UINT32_TERRAIN_MEMORY_BUDGET);
+    if (!budget)
+        { return; }
+
+    i_evictTimer.Update(diff);
+    if (!i_evictTimer.Passed())
+        { return; }
+
+    i_evictTimer.Reset();
+    EvictUnusedGrids(uint64(budget) * 1024);
+    RemoveUnusedTerrains();
+}
+
+void TerrainManager::EvictUnusedGrids(uint64 budget)
+{
+    uint64 memory = 0;
+    for (TerrainDataMap::const_iterator iter = i_TerrainMap.begin(); iter != i_TerrainMap.end(); ++iter)
+        { memory += iter->second->GetMemoryUsage(); }
+
+    if (memory <= budget)
+        { return; }
+
+    // the grids of all maps compete for the budget, grids in use are never unloaded
+    std::vector<TerrainUnusedGrid> grids;
+    uint32 now = WorldTimer::getMSTime();
+    for (TerrainDataMap::const_iterator iter = i_TerrainMap.begin(); iter != i_TerrainMap.end(); ++iter)
+        { iter->second->CollectUnusedGrids(grids, now); }
+
+    std::sort(grids.begin(), grids.end());                  // least recently used first
+
+    for (std::vector<TerrainUnusedGrid>::const_iterator itr = grids.begin(); itr != grids.end() && memory > budget; ++itr)
+    {
+        memory -= itr->memory;
+        itr->terrain->UnloadGrid(itr->x, itr->y);
+        ++i_evictedGrids;
+    }
+}
+
+void TerrainManager::RemoveUnusedTerrains()
+{
+    if (sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD) == 0)
+        { return; }
+
+    Guard _guard(*this);
+
+    for (TerrainDataMap::iterator iter = i_TerrainMap.begin(); iter != i_TerrainMap.end();)
+    {
+        TerrainInfo* ptr = iter->second;
+        if (!ptr->IsReferenced() && !ptr->GetMemoryUsage())
+        {
+            i_TerrainMap.erase(iter++);
+            delete ptr;
+        }
+        else
+            { ++iter; }
+    }
+}
+
+void TerrainManager::GetCacheStats(TerrainCacheStats& stats)
+{
+    Guard _guard(*this);
+
+    for (TerrainDataMap::const_iterator iter = i_TerrainMap.begin(); iter != i_TerrainMap.end(); ++iter)
+        { iter->second->AddCacheStats(stats); }
+
+    stats.evictedGrids = uint32(i_evictedGrids.value());
 }
 
 void TerrainManager::UnloadAll()
@@ -34,6 +34,7 @@
 
 #include <bitset>
 #include <list>
+#include <vector>
 
 class Creature;
 class Unit;
@@ -127,6 +128,7 @@ class GridMap
     private:
 
         uint32 m_flags;
+        uint32 m_memoryUsage;                               // bytes of the loaded data
 
         // Area data
         uint16 m_gridArea;
@@ -182,8 +184,19 @@ class GridMap
         static bool ExistMap(uint32 mapid, int gx, int gy);
         static bool ExistVMap(uint32 mapid, int gx, int gy);
 
+        uint32 GetMemoryUsage() const { return m_memoryUsage; }
+
         uint16 getArea(float x, float y);
         float getHeight(float x, float y) { return (this->*m_gridGetHeight)(x, y); }
+        /**
+         * @brief heights of many points of this grid, the same as getHeight for each point
+         *
+         * @param x
+         * @param y
+         * @param heights receives count heights
+         * @param count
+         */
+        void getHeights(float const* x, float const* y, float* heights, uint32 count) const;
         float getLiquidLevel(float x, float y);
         uint8 getTerrainType(float x, float y);
         GridMapLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData* data = 0);
@@ -215,6 +228,60 @@ typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> AtomicLong;
 #define DEFAULT_HEIGHT_SEARCH     10.0f                     // default search distance to find height at nearby locations
 #define DEFAULT_WATER_SEARCH      50.0f                     // default search distance to case detection water level
 
+/**
+ * @brief terrain at one position, see TerrainInfo::QueryTerrain
+ *
+ */
+struct TerrainQuery
+{
+    TerrainQuery() : valid(false), mapId(0), x(0.0f), y(0.0f), z(0.0f) {}
+
+    /// the result is of this position
+    bool IsFor(uint32 _mapId, float _x, float _y, float _z) const { return valid && mapId == _mapId && x == _x && y == _y && z == _z; }
+
+    bool IsInWater() const { return liquidStatus != LIQUID_MAP_NO_WATER; }
+    bool IsUnderWater() const { return (liquidStatus & LIQUID_MAP_UNDER_WATER) && (liquid.type_flags & (MAP_LIQUID_TYPE_WATER | MAP_LIQUID_TYPE_OCEAN)); }
+
+    bool valid;
+    uint32 mapId;
+    float x, y, z;
+    float mapHeight;                                        // .map surface, VMAP_INVALID_HEIGHT_VALUE without .map data
+    float groundHeight;                                     // GetHeightStatic with DEFAULT_WATER_SEARCH, includes vmaps
+    GridMapLiquidStatus liquidStatus;                       // of all liquid types
+    GridMapLiquidData liquid;                               // zero at LIQUID_MAP_NO_WATER
+    uint16 areaFlag;
+    uint32 zoneId;
+    uint32 areaId;
+    bool outdoors;
+};
+
+class TerrainInfo;
+
+/// loaded grid no map uses, see TerrainManager::EvictUnusedGrids
+struct TerrainUnusedGrid
+{
+    uint32 age;                                             // ms since the last map stopped using it
+    TerrainInfo* terrain;
+    uint32 x, y;
+    uint32 memory;                                          // KB
+
+    bool operator<(TerrainUnusedGrid const& other) const { return age > other.age; }
+};
+
+/// loaded terrain of all maps, see .server terrainstats
+struct TerrainCacheStats
+{
+    TerrainCacheStats() : terrains(0), loadedGrids(0), unusedGrids(0), memory(0), unusedMemory(0), reusedGrids(0), evictedGrids(0) {}
+
+    uint32 terrains;
+    uint32 loadedGrids;                                     // .map, vmap and mmap tile of a grid
+    uint32 unusedGrids;                                     // loaded but used by no map
+    uint64 memory;                                          // KB of the loaded grids
+    uint64 unusedMemory;
+    uint32 reusedGrids;                                     // unused grids taken by a map again without loading
+    uint32 evictedGrids;                                    // unused grids unloaded for Terrain.MemoryBudget
+};
+
 // class for sharing and managin GridMap objects
 class MANGOS_DLL_SPEC TerrainInfo : public Referencable<AtomicLong>
 {
@@ -227,6 +294,17 @@ class MANGOS_DLL_SPEC TerrainInfo : public Referencable<AtomicLong>
         // TODO: move all terrain/vmaps data info query functions
         // from 'Map' class into this class
         float GetHeightStatic(float x, float y, float z, bool checkVMap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+        /**
+         * @brief map heights of many points, the same as GetHeightStatic(x, y, z, false) for each point
+         *
+         * Points are best sorted by grid, points of one grid next to each other are done in one go.
+         *
+         * @param x
+         * @param y
+         * @param heights receives count heights, VMAP_INVALID_HEIGHT_VALUE where no map is loaded
+         * @param count
+         */
+        void GetMapHeights(float const* x, float const* y, float* heights, uint32 count) const;
         float GetWaterLevel(float x, float y, float z, float* pGround = NULL) const;
         float GetWaterOrGroundLevel(float x, float y, float z, float* pGround = NULL, bool swim = false) const;
         bool IsInWater(float x, float y, float z, GridMapLiquidData* data = 0) const;
@@ -244,6 +322,19 @@ class MANGOS_DLL_SPEC TerrainInfo : public Referencable<AtomicLong>
         bool GetAreaInfo(float x, float y, float z, uint32& mogpflags, int32& adtId, int32& rootId, int32& groupId) const;
         bool IsOutdoors(float x, float y, float z) const;
 
+        /**
+         * @brief heights, liquid and area of a position in one pass
+         *
+         * The grid, the .map height and the vmap floor are looked up once and shared by all parts,
+         * instead of once by each of GetHeightStatic, getLiquidStatus and GetAreaFlag.
+         *
+         * @param x
+         * @param y
+         * @param z
+         * @param query receives the result
+         */
+        void QueryTerrain(float x, float y, float z, TerrainQuery& query) const;
+
 
         // this method should be used only by TerrainManager
         // to cleanup unreferenced GridMap objects - they are too heavy
@@ -251,18 +342,39 @@ class MANGOS_DLL_SPEC TerrainInfo : public Referencable<AtomicLong>
         // THIS METHOD IS NOT THREAD-SAFE!!!! AND IT SHOULDN'T BE THREAD-SAFE!!!!
         void CleanUpGrids(const uint32 diff);
 
+        // KB of the loaded grids
+        uint32 GetMemoryUsage() const { return uint32(m_memoryUsage.value()); }
+        void AddCacheStats(TerrainCacheStats& stats) const;
+
     protected:
         friend class Map;
+        friend class TerrainLoader;
+        friend class TerrainManager;
         // load/unload terrain data
         GridMap* Load(const uint32 x, const uint32 y);
         void Unload(const uint32 x, const uint32 y);
+        // read terrain data of a grid ahead of Load, called by TerrainLoader threads
+        void Prefetch(const uint32 x, const uint32 y);
+        // a loaded or prefetched GridMap exists, locks against the TerrainLoader threads
+        bool HasGridData(const uint32 x, const uint32 y);
+        // unload the .map, vmap and mmap data of a grid no map uses, not thread safe like CleanUpGrids
+        void UnloadGrid(const uint32 x, const uint32 y);
+        void CollectUnusedGrids(std::vector<TerrainUnusedGrid>& grids, uint32 now) const;
 
     private:
         TerrainInfo(const TerrainInfo&);
         TerrainInfo& operator=(const TerrainInfo&);
 
         GridMap* GetGrid(const float x, const float y);
+
+        // parts of the terrain queries on an already resolved grid, gmap may be NULL
+        float GetMapHeight(GridMap* gmap, float x, float y) const;
+        float CalculateHeight(float mapHeight, float x, float y, float z, bool useVmaps, float maxSearchDist) const;
+        bool CalculateAreaInfo(GridMap* gmap, float x, float y, float z, uint32& flags, int32& adtId, int32& rootId, int32& groupId) const;
+        uint16 CalculateAreaFlag(GridMap* gmap, float x, float y, float z, bool* isOutdoors) const;
+        GridMapLiquidStatus CalculateLiquidStatus(GridMap* gmap, float ground_level, float x, float y, float z, uint8 ReqLiquidType, GridMapLiquidData* data) const;
         GridMap* LoadMapAndVMap(const uint32 x, const uint32 y);
+        GridMap* LoadGridMap(const uint32 x, const uint32 y) const;
 
         int RefGrid(const uint32& x, const uint32& y);
         int UnrefGrid(const uint32& x, const uint32& y);
@@ -271,6 +383,14 @@ class MANGOS_DLL_SPEC TerrainInfo : public Referencable<AtomicLong>
 
         GridMap* m_GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         int16 m_GridRef[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+        uint32 m_GridMemory[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];      // KB of .map data and navmesh tile
+        uint32 m_GridUnusedSince[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS]; // ms time the last reference was dropped
+        AtomicLong m_memoryUsage;                           // KB of all loaded grids
+        AtomicLong m_reusedGrids;
+
+        // GridMap objects read by TerrainLoader, published to m_GridMaps when the grid is loaded
+        GridMap* m_PrefetchedGridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+        bool m_PrefetchedStale[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
         // global garbage collection timer
         ShortIntervalTimer i_timer;
@@ -294,6 +414,8 @@ class MANGOS_DLL_DECL TerrainManager : public MaNGOS::Singleton<TerrainManager,
         void Update(const uint32 diff);
         void UnloadAll();
 
+        void GetCacheStats(TerrainCacheStats& stats);
+
         uint16 GetAreaFlag(uint32 mapid, float x, float y, float z) const
         {
             TerrainInfo* pData = const_cast<TerrainManager*>(this)->LoadTerrain(mapid);
@@ -323,8 +445,16 @@ class MANGOS_DLL_DECL TerrainManager : public MaNGOS::Singleton<TerrainManager,
         TerrainManager(const TerrainManager&);
         TerrainManager& operator=(const TerrainManager&);
 
+        // unload the least recently used unused grids of all maps until the loaded grids fit into budget KB
+        void EvictUnusedGrids(uint64 budget);
+        // delete the maps UnloadTerrain kept for their unused grids when those are evicted
+        void RemoveUnusedTerrains();
+
         typedef MaNGOS::ClassLevelLockable<TerrainManager, ACE_Thread_Mutex>::Lock Guard;
         TerrainDataMap i_TerrainMap;
+
+        ShortIntervalTimer i_evictTimer;
+        AtomicLong i_evictedGrids;
 };
 
 #define sTerrainMgr TerrainManager::Instance()
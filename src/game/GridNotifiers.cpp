@@ -46,25 +46,30 @@ void VisibleChangesNotifier::Visit(CameraMapType& m)
 void VisibleNotifier::Notify()
 {
     Player& player = *i_camera.GetOwner();
-    // at this moment i_clientGUIDs have guids that not iterate at grid level checks
+    // at this moment unmarked client guids are guids that not iterate at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = player.GetTransport())
     {
         for (Transport::PlayerSet::const_iterator itr = transport->GetPassengers().begin(); itr != transport->GetPassengers().end(); ++itr)
         {
-            if (i_clientGUIDs.find((*itr)->GetObjectGuid()) != i_clientGUIDs.end())
+            if (player.m_clientGUIDs.Mark((*itr)->GetObjectGuid()))
             {
                 // ignore far sight case
                 (*itr)->UpdateVisibilityOf(*itr, &player);
                 player.UpdateVisibilityOf(&player, *itr, i_data, i_visibleNow);
-                i_clientGUIDs.erase((*itr)->GetObjectGuid());
             }
         }
     }
 
+    // removals held back since the last object updates go out first in the same packet
+    player.FlushPendingOutOfRange(i_data);
+
     // generate outOfRange for not iterate objects
-    i_data.AddOutOfRangeGUID(i_clientGUIDs);
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
+    GuidSet outOfRangeGUIDs;
+    player.m_clientGUIDs.CollectUnmarked(outOfRangeGUIDs);
+    i_data.AddOutOfRangeGUID(outOfRangeGUIDs);
+    player.GetMap()->GetVisibilityStats().clientObjectsDestroyed += uint32(outOfRangeGUIDs.size());
+    for (GuidSet::iterator itr = outOfRangeGUIDs.begin(); itr != outOfRangeGUIDs.end(); ++itr)
     {
         player.m_clientGUIDs.erase(*itr);
 
@@ -80,8 +85,8 @@ void VisibleNotifier::Notify()
         player.GetSession()->SendPacket(&packet);
 
         // send out of range to other players if need
-        GuidSet const& oor = i_data.GetOutOfRangeGUIDs();
-        for (GuidSet::const_iterator iter = oor.begin(); iter != oor.end(); ++iter)
+        GuidVector const& oor = i_data.GetOutOfRangeGUIDs();
+        for (GuidVector::const_iterator iter = oor.begin(); iter != oor.end(); ++iter)
         {
             if (!iter->IsPlayer())
                 { continue; }
@@ -94,7 +99,7 @@ void VisibleNotifier::Notify()
     // Now do operations that required done at object visibility change to visible
 
     // send data at target visibility change (adding to client)
-    for (std::set<WorldObject*>::const_iterator vItr = i_visibleNow.begin(); vItr != i_visibleNow.end(); ++vItr)
+    for (WorldObjectTickSet::const_iterator vItr = i_visibleNow.begin(); vItr != i_visibleNow.end(); ++vItr)
     {
         // target aura duration for caster show only if target exist at caster client
         if ((*vItr) != &player && (*vItr)->isType(TYPEMASK_UNIT))
@@ -105,14 +110,17 @@ void VisibleNotifier::Notify()
 void MessageDeliverer::Visit(CameraMapType& m)
 {
     for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Player* owner = iter->getSource()->GetOwner();
+        { VisitCamera(iter->getSource()); }
+}
 
-        if (i_toSelf || owner != &i_player)
-        {
-            if (WorldSession* session = owner->GetSession())
-                { session->SendPacket(i_message); }
-        }
+void MessageDeliverer::VisitCamera(Camera* camera)
+{
+    Player* owner = camera->GetOwner();
+
+    if (i_toSelf || owner != &i_player)
+    {
+        if (WorldSession* session = owner->GetSession())
+            { session->SendPacket(i_message); }
     }
 }
 
@@ -133,37 +141,46 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
 void ObjectMessageDeliverer::Visit(CameraMapType& m)
 {
     for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        if (WorldSession* session = iter->getSource()->GetOwner()->GetSession())
-            { session->SendPacket(i_message); }
-    }
+        { VisitCamera(iter->getSource()); }
+}
+
+void ObjectMessageDeliverer::VisitCamera(Camera* camera)
+{
+    if (WorldSession* session = camera->GetOwner()->GetSession())
+        { session->SendPacket(i_message); }
 }
 
 void MessageDistDeliverer::Visit(CameraMapType& m)
 {
     for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-    {
-        Player* owner = iter->getSource()->GetOwner();
+        { VisitCamera(iter->getSource()); }
+}
 
-        if ((i_toSelf || owner != &i_player) &&
-            (!i_ownTeamOnly || owner->GetTeam() == i_player.GetTeam()) &&
-            (!i_dist || iter->getSource()->GetBody()->IsWithinDist(&i_player, i_dist)))
-        {
-            if (WorldSession* session = owner->GetSession())
-                { session->SendPacket(i_message); }
-        }
+void MessageDistDeliverer::VisitCamera(Camera* camera)
+{
+    Player* owner = camera->GetOwner();
+
+    if ((i_toSelf || owner != &i_player) &&
+        (!i_ownTeamOnly || owner->GetTeam() == i_player.GetTeam()) &&
+        (!i_dist || camera->GetBody()->IsWithinDist(&i_player, i_dist)))
+    {
+        if (WorldSession* session = owner->GetSession())
+            { session->SendPacket(i_message); }
     }
 }
 
 void ObjectMessageDistDeliverer::Visit(CameraMapType& m)
 {
     for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+        { VisitCamera(iter->getSource()); }
+}
+
+void ObjectMessageDistDeliverer::VisitCamera(Camera* camera)
+{
+    if (!i_dist || camera->GetBody()->IsWithinDist(&i_object, i_dist))
     {
-        if (!i_dist || iter->getSource()->GetBody()->IsWithinDist(&i_object, i_dist))
-        {
-            if (WorldSession* session = iter->getSource()->GetOwner()->GetSession())
-                { session->SendPacket(i_message); }
-        }
+        if (WorldSession* session = camera->GetOwner()->GetSession())
+            { session->SendPacket(i_message); }
     }
 }
 
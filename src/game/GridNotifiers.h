@@ -42,11 +42,19 @@ namespace MaNGOS
     {
         Camera& i_camera;
         UpdateData i_data;
-        GuidSet i_clientGUIDs;
-        std::set<WorldObject*> i_visibleNow;
-
-        explicit VisibleNotifier(Camera& c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_clientGUIDs) {}
+        WorldObjectTickSet i_visibleNow;
+        float i_x;
+        float i_y;
+        float i_unchangedRadiusSq;                          // objects in this distance keep their visibility, unless stealthed
+
+        // client guids not marked in the sweep are out of range at Notify
+        explicit VisibleNotifier(Camera& c, float unchangedRadius = 0.0f) : i_camera(c),
+            i_x(c.GetBody()->GetPositionX()), i_y(c.GetBody()->GetPositionY()), i_unchangedRadiusSq(unchangedRadius * unchangedRadius)
+        {
+            c.GetOwner()->m_clientGUIDs.BeginSweep();
+        }
         template<class T> void Visit(GridRefManager<T>& m);
+        template<class T> bool IsVisibilityUnchanged(T* target) const;
         void Visit(CameraMapType& /*m*/) {}
         void Notify(void);
     };
@@ -67,6 +75,7 @@ namespace MaNGOS
         bool i_toSelf;
         MessageDeliverer(Player const& pl, WorldPacket* msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
         void Visit(CameraMapType& m);
+        void VisitCamera(Camera* camera);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
 
@@ -87,6 +96,7 @@ namespace MaNGOS
         WorldPacket* i_message;
         explicit ObjectMessageDeliverer(WorldPacket* msg) : i_message(msg) {}
         void Visit(CameraMapType& m);
+        void VisitCamera(Camera* camera);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
 
@@ -101,6 +111,7 @@ namespace MaNGOS
         MessageDistDeliverer(Player const& pl, WorldPacket* msg, float dist, bool to_self, bool ownTeamOnly)
             : i_player(pl), i_message(msg), i_toSelf(to_self), i_ownTeamOnly(ownTeamOnly), i_dist(dist) {}
         void Visit(CameraMapType& m);
+        void VisitCamera(Camera* camera);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
 
@@ -111,13 +122,15 @@ namespace MaNGOS
         float i_dist;
         ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket* msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
         void Visit(CameraMapType& m);
+        void VisitCamera(Camera* camera);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
 
     struct MANGOS_DLL_DECL ObjectUpdater
     {
         uint32 i_timeDiff;
-        explicit ObjectUpdater(const uint32& diff) : i_timeDiff(diff) {}
+        uint32 i_idleRate;                                  // update rate of idle creatures, see Creature::UpdateIdleTier
+        explicit ObjectUpdater(const uint32& diff, uint32 idleRate = 1) : i_timeDiff(diff), i_idleRate(idleRate) {}
         template<class T> void Visit(GridRefManager<T>& m);
         void Visit(PlayerMapType&) {}
         void Visit(CorpseMapType&) {}
@@ -143,6 +156,29 @@ namespace MaNGOS
 #endif
     };
 
+    // AI notifies of all units whose relocation notify is due this tick, see Map::ProcessRelocationNotifies
+    struct MANGOS_DLL_DECL RelocationBatchNotifier
+    {
+        std::vector<Unit*> const& i_movers;                 // movers whose notify area contains the visited cell
+        // mover positions packed by coordinate, so the pairs out of reach are skipped without touching the movers
+        std::vector<float> i_moverX;
+        std::vector<float> i_moverY;
+        std::vector<float> i_moverReach;                    // notify radius + mover bounding radius
+
+        RelocationBatchNotifier(std::vector<Unit*> const& movers, float radius);
+        template<class T> void Visit(GridRefManager<T>&) {}
+        void Visit(PlayerMapType&);
+        void Visit(CreatureMapType&);
+
+        bool IsInReach(size_t moverIdx, float x, float y, float boundingRadius) const
+        {
+            float dx = i_moverX[moverIdx] - x;
+            float dy = i_moverY[moverIdx] - y;
+            float reach = i_moverReach[moverIdx] + boundingRadius;
+            return dx * dx + dy * dy <= reach * reach;
+        }
+    };
+
     struct MANGOS_DLL_DECL DynamicObjectUpdater
     {
         DynamicObject& i_dynobject;
@@ -344,6 +380,7 @@ namespace MaNGOS
 
         void Visit(CreatureMapType& m);
         void Visit(PlayerMapType& m);
+        void VisitUnit(Unit* unit);
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
     };
@@ -359,21 +396,23 @@ namespace MaNGOS
 
         void Visit(CreatureMapType& m);
         void Visit(PlayerMapType& m);
+        void VisitUnit(Unit* unit);
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
     };
 
-    // All accepted by Check units if any
-    template<class Check>
+    // All accepted by Check units if any, appended to a std::list or std::vector
+    template<class Check, class Container = std::list<Unit*> >
     struct MANGOS_DLL_DECL UnitListSearcher
     {
-        std::list<Unit*>& i_objects;
+        Container& i_objects;
         Check& i_check;
 
-        UnitListSearcher(std::list<Unit*>& objects, Check& check) : i_objects(objects), i_check(check) {}
+        UnitListSearcher(Container& objects, Check& check) : i_objects(objects), i_check(check) {}
 
         void Visit(PlayerMapType& m);
         void Visit(CreatureMapType& m);
+        void VisitUnit(Unit* unit);
 
         template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
     };
@@ -1178,4 +1217,8 @@ namespace MaNGOS
     template<> inline void DynamicObjectUpdater::Visit<Player>(PlayerMapType&);
 #endif
 }
+
+template<class Check> struct IsUnitVisitor<MaNGOS::UnitSearcher<Check> > { static const bool value = true; };
+template<class Check> struct IsUnitVisitor<MaNGOS::UnitLastSearcher<Check> > { static const bool value = true; };
+template<class Check, class Container> struct IsUnitVisitor<MaNGOS::UnitListSearcher<Check, Container> > { static const bool value = true; };
 #endif
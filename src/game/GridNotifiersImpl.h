@@ -41,17 +41,41 @@ inline void MaNGOS::VisibleNotifier::Visit(GridRefManager<T>& m)
 {
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
-        i_camera.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow);
-        i_clientGUIDs.erase(iter->getSource()->GetObjectGuid());
+        if (!IsVisibilityUnchanged(iter->getSource()))
+            { i_camera.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow); }
+        i_camera.GetOwner()->m_clientGUIDs.Mark(iter->getSource()->GetObjectGuid());
     }
 }
 
+inline bool IsVisibilityDistanceDependent(WorldObject* /*target*/) { return false; }
+// stealth detection depends on distance
+inline bool IsVisibilityDistanceDependent(Unit* target) { return target->GetVisibility() == VISIBILITY_GROUP_STEALTH; }
+
+template<class T>
+inline bool MaNGOS::VisibleNotifier::IsVisibilityUnchanged(T* target) const
+{
+    if (i_unchangedRadiusSq <= 0.0f || IsVisibilityDistanceDependent(target))
+        { return false; }
+
+    float dx = target->GetPositionX() - i_x;
+    float dy = target->GetPositionY() - i_y;
+    return dx * dx + dy * dy < i_unchangedRadiusSq;
+}
+
 inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
 {
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
+        // dead creatures are woken by the respawn queue of the map
+        if (iter->getSource()->IsRespawnParked())
+            { continue; }
+
+        uint32 diff = i_timeDiff;
+        if (!iter->getSource()->UpdateIdleTier(i_idleRate, diff))
+            { continue; }
+
         WorldObject::UpdateHelper helper(iter->getSource());
-        helper.Update(i_timeDiff);
+        helper.Update(diff);
     }
 }
 
@@ -121,6 +145,77 @@ inline void MaNGOS::CreatureRelocationNotifier::Visit(CreatureMapType& m)
     }
 }
 
+inline MaNGOS::RelocationBatchNotifier::RelocationBatchNotifier(std::vector<Unit*> const& movers, float radius) : i_movers(movers)
+{
+    i_moverX.reserve(movers.size());
+    i_moverY.reserve(movers.size());
+    i_moverReach.reserve(movers.size());
+
+    for (std::vector<Unit*>::const_iterator itr = movers.begin(); itr != movers.end(); ++itr)
+    {
+        i_moverX.push_back((*itr)->GetPositionX());
+        i_moverY.push_back((*itr)->GetPositionY());
+        i_moverReach.push_back(radius + (*itr)->GetObjectBoundingRadius());
+    }
+}
+
+// same pairs as PlayerRelocationNotifier and CreatureRelocationNotifier for each mover in reach
+inline void MaNGOS::RelocationBatchNotifier::Visit(PlayerMapType& m)
+{
+    for (PlayerMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    {
+        Player* player = iter->getSource();
+        if (!player->IsAlive() || player->IsTaxiFlying())
+            { continue; }
+
+        float x = player->GetPositionX();
+        float y = player->GetPositionY();
+        float boundingRadius = player->GetObjectBoundingRadius();
+
+        for (size_t i = 0; i < i_movers.size(); ++i)
+        {
+            if (!IsInReach(i, x, y, boundingRadius))
+                { continue; }
+
+            Unit* mover = i_movers[i];
+            if (mover->GetTypeId() == TYPEID_UNIT && mover->IsAlive())
+                { PlayerCreatureRelocationWorker(player, (Creature*)mover); }
+        }
+    }
+}
+
+inline void MaNGOS::RelocationBatchNotifier::Visit(CreatureMapType& m)
+{
+    for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    {
+        Creature* c = iter->getSource();
+        if (!c->IsAlive())
+            { continue; }
+
+        float x = c->GetPositionX();
+        float y = c->GetPositionY();
+        float boundingRadius = c->GetObjectBoundingRadius();
+
+        for (size_t i = 0; i < i_movers.size(); ++i)
+        {
+            if (!IsInReach(i, x, y, boundingRadius))
+                { continue; }
+
+            Unit* mover = i_movers[i];
+            if (mover == c || !mover->IsAlive())
+                { continue; }
+
+            if (mover->GetTypeId() == TYPEID_PLAYER)
+            {
+                if (!mover->IsTaxiFlying())
+                    { PlayerCreatureRelocationWorker((Player*)mover, c); }
+            }
+            else
+                { CreatureCreatureRelocationWorker(c, (Creature*)mover); }
+        }
+    }
+}
+
 inline void MaNGOS::DynamicObjectUpdater::VisitHelper(Unit* target)
 {
     if (!target->IsAlive() || target->IsTaxiFlying())
@@ -479,6 +574,13 @@ void MaNGOS::UnitSearcher<Check>::Visit(PlayerMapType& m)
     }
 }
 
+template<class Check>
+void MaNGOS::UnitSearcher<Check>::VisitUnit(Unit* unit)
+{
+    if (!i_object && i_check(unit))
+        { i_object = unit; }
+}
+
 template<class Check>
 void MaNGOS::UnitLastSearcher<Check>::Visit(CreatureMapType& m)
 {
@@ -500,21 +602,35 @@ void MaNGOS::UnitLastSearcher<Check>::Visit(PlayerMapType& m)
 }
 
 template<class Check>
-void MaNGOS::UnitListSearcher<Check>::Visit(PlayerMapType& m)
+void MaNGOS::UnitLastSearcher<Check>::VisitUnit(Unit* unit)
+{
+    if (i_check(unit))
+        { i_object = unit; }
+}
+
+template<class Check, class Container>
+void MaNGOS::UnitListSearcher<Check, Container>::Visit(PlayerMapType& m)
 {
     for (PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
         if (i_check(itr->getSource()))
             { i_objects.push_back(itr->getSource()); }
 }
 
-template<class Check>
-void MaNGOS::UnitListSearcher<Check>::Visit(CreatureMapType& m)
+template<class Check, class Container>
+void MaNGOS::UnitListSearcher<Check, Container>::Visit(CreatureMapType& m)
 {
     for (CreatureMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
         if (i_check(itr->getSource()))
             { i_objects.push_back(itr->getSource()); }
 }
 
+template<class Check, class Container>
+void MaNGOS::UnitListSearcher<Check, Container>::VisitUnit(Unit* unit)
+{
+    if (i_check(unit))
+        { i_objects.push_back(unit); }
+}
+
 // Creature searchers
 
 template<class Check>
@@ -55,7 +55,7 @@ ActiveState::Update(Map& m, NGridType& grid, GridInfo& info, const uint32& x, co
 void
 IdleState::Update(Map& m, NGridType& grid, GridInfo&, const uint32& x, const uint32& y, const uint32&) const
 {
-    m.ResetGridExpiry(grid);
+    m.ResetGridUnloadExpiry(grid);
     grid.SetGridState(GRID_STATE_REMOVAL);
     DEBUG_LOG("Grid[%u,%u] on map %u moved to IDLE state", x, y, m.GetId());
 }
@@ -71,7 +71,7 @@ RemovalState::Update(Map& m, NGridType& grid, GridInfo& info, const uint32& x, c
             if (!m.UnloadGrid(x, y, false))
             {
                 DEBUG_LOG("Grid[%u,%u] for map %u differed unloading due to players or active objects nearby", x, y, m.GetId());
-                m.ResetGridExpiry(grid);
+                m.ResetGridUnloadExpiry(grid);
             }
         }
     }
@@ -999,6 +999,60 @@ void Group::UpdatePlayerOutOfRange(Player* pPlayer)
                 { player->GetSession()->SendPacket(&data); }
 }
 
+void Group::AddStatsChangedMember(Player* pPlayer)
+{
+    bool first;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_statsLock);
+        first = m_statsChangedMembers.empty();
+        m_statsChangedMembers.insert(pPlayer->GetObjectGuid());
+    }
+
+    if (first)
+        { sObjectMgr.AddGroupStatsUpdate(this); }
+}
+
+void Group::SendChangedMemberStats()
+{
+    GuidSet changedGuids;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_statsLock);
+        changedGuids.swap(m_statsChangedMembers);
+    }
+
+    std::vector<Player*> changed;
+    std::vector<WorldPacket> packets(changedGuids.size());
+    for (GuidSet::const_iterator itr = changedGuids.begin(); itr != changedGuids.end(); ++itr)
+    {
+        Player* pPlayer = sObjectMgr.GetPlayer(*itr);
+        if (!pPlayer)
+            { continue; }
+
+        // left the group meanwhile, the changes are not needed anymore
+        if (pPlayer->IsInWorld() && pPlayer->GetGroup() == this && pPlayer->GetGroupUpdateFlag() != GROUP_UPDATE_FLAG_NONE)
+        {
+            pPlayer->GetSession()->BuildPartyMemberStatsChangedPacket(pPlayer, &packets[changed.size()]);
+            changed.push_back(pPlayer);
+        }
+
+        pPlayer->ResetGroupUpdateFlags();
+    }
+
+    if (changed.empty())
+        { return; }
+
+    for (GroupReference* itr = GetFirstMember(); itr != NULL; itr = itr->next())
+    {
+        Player* player = itr->getSource();
+        if (!player || !player->GetSession())
+            { continue; }
+
+        for (size_t i = 0; i < changed.size(); ++i)
+            if (changed[i] != player && !player->HaveAtClient(changed[i]))
+                { player->GetSession()->SendPacket(&packets[i]); }
+    }
+}
+
 void Group::BroadcastPacket(WorldPacket* packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignore)
 {
     for (GroupReference* itr = GetFirstMember(); itr != NULL; itr = itr->next())
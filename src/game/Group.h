@@ -37,6 +37,8 @@
 #include <map>
 #include <vector>
 
+#include <ace/Thread_Mutex.h>
+
 class WorldSession;
 class Map;
 class BattleGround;
@@ -294,6 +296,10 @@ class MANGOS_DLL_SPEC Group
         void SendTargetIconList(WorldSession* session);
         void SendUpdate();
         void UpdatePlayerOutOfRange(Player* pPlayer);
+        // queues the stats changes of the member to be sent with the ones of the other members, thread safe, see UpdateCoalesce.RaidStats
+        void AddStatsChangedMember(Player* pPlayer);
+        // sends the queued stats changes, each member gets the ones of all changed members it does not see at once
+        void SendChangedMemberStats();
         // ignore: GUID of player that will be ignored
         void BroadcastPacket(WorldPacket* packet, bool ignorePlayersInBGRaid, int group = -1, ObjectGuid ignore = ObjectGuid());
         void BroadcastReadyCheck(WorldPacket* packet);
@@ -401,5 +407,7 @@ class MANGOS_DLL_SPEC Group
         Rolls               RollId;
         BoundInstancesMap   m_boundInstances;
         uint8*              m_subGroupsCounts;
+        GuidSet             m_statsChangedMembers;          // members with queued stats changes
+        ACE_Thread_Mutex    m_statsLock;                    // members on different maps are updated by different threads
 };
 #endif
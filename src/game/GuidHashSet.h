@@ -0,0 +1,227 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_GUIDHASHSET_H
+#define MANGOS_GUIDHASHSET_H
+
+#include "Common.h"
+#include "ObjectGuid.h"
+
+#include <vector>
+
+/**
+ * Open addressing set of object guids for hot lookups like Player::HaveAtClient.
+ *
+ * Guids are stored in one power of two sized array with linear probing and backward shift deletion,
+ * so lookups touch a few adjacent slots instead of a chain of tree nodes. Empty guids mark free slots
+ * and can't be stored.
+ *
+ * Sweeps support diffing the set against the objects seen in one pass: after BeginSweep() every
+ * guid passed to Mark() is remembered, CollectUnmarked() then returns the guids of the set not seen.
+ * Inserts and erases during a sweep are allowed, iterators are invalidated by both.
+ */
+class MANGOS_DLL_SPEC GuidHashSet
+{
+    public:
+        class const_iterator
+        {
+                friend class GuidHashSet;
+
+            public:
+                ObjectGuid const& operator*() const { return m_set->m_slots[m_index].guid; }
+                ObjectGuid const* operator->() const { return &m_set->m_slots[m_index].guid; }
+
+                const_iterator& operator++()
+                {
+                    ++m_index;
+                    SkipFree();
+                    return *this;
+                }
+
+                bool operator==(const_iterator const& other) const { return m_index == other.m_index; }
+                bool operator!=(const_iterator const& other) const { return m_index != other.m_index; }
+
+            private:
+                const_iterator(GuidHashSet const* set, size_t index) : m_set(set), m_index(index) { SkipFree(); }
+
+                void SkipFree()
+                {
+                    while (m_index < m_set->m_slots.size() && m_set->m_slots[m_index].guid.IsEmpty())
+                        { ++m_index; }
+                }
+
+                GuidHashSet const* m_set;
+                size_t m_index;
+        };
+
+        GuidHashSet() : m_size(0), m_sweep(0) {}
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_slots.size()); }
+
+        bool empty() const { return m_size == 0; }
+        size_t size() const { return m_size; }
+
+        void clear()
+        {
+            m_slots.clear();
+            m_size = 0;
+        }
+
+        bool contains(ObjectGuid const& guid) const { return FindSlot(guid) != NOT_FOUND; }
+
+        /// Returns false if the guid was already stored
+        bool insert(ObjectGuid const& guid)
+        {
+            MANGOS_ASSERT(!guid.IsEmpty());
+
+            if ((m_size + 1) * 4 > m_slots.size() * 3)
+                { Rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2); }
+
+            size_t mask = m_slots.size() - 1;
+            for (size_t i = Hash(guid) & mask;; i = (i + 1) & mask)
+            {
+                if (m_slots[i].guid == guid)
+                    { return false; }
+
+                if (m_slots[i].guid.IsEmpty())
+                {
+                    m_slots[i].guid = guid;
+                    m_slots[i].sweep = m_sweep;             // inserted during a sweep counts as seen
+                    ++m_size;
+                    return true;
+                }
+            }
+        }
+
+        /// Returns false if the guid wasn't stored
+        bool erase(ObjectGuid const& guid)
+        {
+            size_t i = FindSlot(guid);
+            if (i == NOT_FOUND)
+                { return false; }
+
+            // shift following entries of the probe sequence back, so lookups never need tombstones
+            size_t mask = m_slots.size() - 1;
+            for (size_t j = (i + 1) & mask; !m_slots[j].guid.IsEmpty(); j = (j + 1) & mask)
+            {
+                size_t home = Hash(m_slots[j].guid) & mask;
+                // move j into the hole at i if its home slot isn't cyclically within (i, j]
+                if (i <= j ? (home <= i || home > j) : (home <= i && home > j))
+                {
+                    m_slots[i] = m_slots[j];
+                    i = j;
+                }
+            }
+
+            m_slots[i].guid.Clear();
+            --m_size;
+            return true;
+        }
+
+        /// Start a new diff pass, all stored guids count as not seen
+        void BeginSweep() { ++m_sweep; }
+
+        /// Remember the guid as seen in the current pass, returns false if it isn't stored or was already seen
+        bool Mark(ObjectGuid const& guid)
+        {
+            size_t i = FindSlot(guid);
+            if (i == NOT_FOUND || m_slots[i].sweep == m_sweep)
+                { return false; }
+
+            m_slots[i].sweep = m_sweep;
+            return true;
+        }
+
+        /// Add the stored guids not seen in the current pass to the container
+        void CollectUnmarked(GuidSet& unmarked) const
+        {
+            for (size_t i = 0; i < m_slots.size(); ++i)
+            {
+                if (!m_slots[i].guid.IsEmpty() && m_slots[i].sweep != m_sweep)
+                    { unmarked.insert(m_slots[i].guid); }
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            Slot() : sweep(0) {}
+
+            ObjectGuid guid;
+            uint32 sweep;                                   // last pass the guid was marked in
+        };
+
+        static const size_t MIN_CAPACITY = 64;
+        static const size_t NOT_FOUND = size_t(-1);
+
+        static size_t Hash(ObjectGuid const& guid)
+        {
+            // 64 bit finalizer of MurmurHash3, low and high parts of guids both vary
+            uint64 h = guid.GetRawValue();
+            h ^= h >> 33;
+            h *= UI64LIT(0xff51afd7ed558ccd);
+            h ^= h >> 33;
+            h *= UI64LIT(0xc4ceb9fe1a85ec53);
+            h ^= h >> 33;
+            return size_t(h);
+        }
+
+        size_t FindSlot(ObjectGuid const& guid) const
+        {
+            if (m_slots.empty() || guid.IsEmpty())
+                { return NOT_FOUND; }
+
+            size_t mask = m_slots.size() - 1;
+            for (size_t i = Hash(guid) & mask; !m_slots[i].guid.IsEmpty(); i = (i + 1) & mask)
+            {
+                if (m_slots[i].guid == guid)
+                    { return i; }
+            }
+
+            return NOT_FOUND;
+        }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<Slot> slots(capacity);
+            slots.swap(m_slots);
+            m_size = 0;
+
+            for (std::vector<Slot>::const_iterator itr = slots.begin(); itr != slots.end(); ++itr)
+            {
+                if (itr->guid.IsEmpty())
+                    { continue; }
+
+                insert(itr->guid);
+                m_slots[FindSlot(itr->guid)].sweep = itr->sweep;
+            }
+        }
+
+        std::vector<Slot> m_slots;
+        size_t m_size;
+        uint32 m_sweep;
+};
+
+#endif
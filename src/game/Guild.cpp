@@ -44,16 +44,19 @@ void MemberSlot::SetMemberStats(Player* player)
     Level  = player->getLevel();
     Class  = player->getClass();
     ZoneId = player->IsInWorld() ? player->GetZoneId() : player->GetCachedZoneId();
+    guild->InvalidateRoster();
 }
 
 void MemberSlot::UpdateLogoutTime()
 {
     LogoutTime = time(NULL);
+    guild->InvalidateRoster();
 }
 
 void MemberSlot::SetPNOTE(std::string pnote)
 {
     Pnote = pnote;
+    guild->InvalidateRoster();
 
     // pnote now can be used for encoding to DB
     CharacterDatabase.escape_string(pnote);
@@ -63,6 +66,7 @@ void MemberSlot::SetPNOTE(std::string pnote)
 void MemberSlot::SetOFFNOTE(std::string offnote)
 {
     OFFnote = offnote;
+    guild->InvalidateRoster();
 
     // offnote now can be used for encoding to DB
     CharacterDatabase.escape_string(offnote);
@@ -72,6 +76,7 @@ void MemberSlot::SetOFFNOTE(std::string offnote)
 void MemberSlot::ChangeRank(uint32 newRank)
 {
     RankId = newRank;
+    guild->InvalidateRoster();
 
     Player* player = sObjectMgr.GetPlayer(guid);
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
@@ -100,6 +105,8 @@ Guild::Guild()
     m_CreatedDay = 0;
 
     m_GuildEventLogNextGuid = 0;
+
+    m_rosterTime = 0;
 }
 
 Guild::~Guild()
@@ -189,6 +196,7 @@ bool Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
     // fill player data
     MemberSlot newmember;
 
+    newmember.guild = this;
     newmember.guid = plGuid;
 
     if (pl)
@@ -242,9 +250,11 @@ bool Guild::AddMember(ObjectGuid plGuid, uint32 plRank)
         pl->SetInGuild(m_Id);
         pl->SetRank(newmember.RankId);
         pl->SetGuildIdInvited(0);
+        m_onlineMembers[lowguid] = pl;
     }
 
     UpdateAccountsNumber();
+    InvalidateRoster();
 
     // Used by Eluna
     sEluna->OnAddMember(this, pl, newmember.RankId);
@@ -259,6 +269,7 @@ void Guild::SetMOTD(std::string motd)
     // motd now can be used for encoding to DB
     CharacterDatabase.escape_string(motd);
     CharacterDatabase.PExecute("UPDATE guild SET motd='%s' WHERE guildid='%u'", motd.c_str(), m_Id);
+    InvalidateRoster();
 
     // Used by Eluna
     sEluna->OnMOTDChanged(this, motd);
@@ -271,6 +282,7 @@ void Guild::SetGINFO(std::string ginfo)
     // ginfo now can be used for encoding to DB
     CharacterDatabase.escape_string(ginfo);
     CharacterDatabase.PExecute("UPDATE guild SET info='%s' WHERE guildid='%u'", ginfo.c_str(), m_Id);
+    InvalidateRoster();
 
     // Used by Eluna
     sEluna->OnInfoChanged(this, ginfo);
@@ -431,6 +443,7 @@ bool Guild::LoadMembersFromDB(QueryResult* guildMembersResult)
 
         MemberSlot newmember;
         uint32 lowguid = fields[1].GetUInt32();
+        newmember.guild = this;
         newmember.guid = ObjectGuid(HIGHGUID_PLAYER, lowguid);
         newmember.RankId = fields[2].GetUInt32();
         // don't allow member to have not existing rank!
@@ -544,6 +557,8 @@ bool Guild::DelMember(ObjectGuid guid, bool isDisbanding)
     }
 
     members.erase(lowguid);
+    m_onlineMembers.erase(lowguid);
+    InvalidateRoster();
 
     Player* player = sObjectMgr.GetPlayer(guid);
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
@@ -575,6 +590,21 @@ bool Guild::ChangeMemberRank(ObjectGuid guid, uint8 newRank)
     return false;
 }
 
+void Guild::MemberLoggedIn(Player* player)
+{
+    if (!GetMemberSlot(player->GetObjectGuid()))
+        { return; }
+
+    m_onlineMembers[player->GetGUIDLow()] = player;
+    InvalidateRoster();
+}
+
+void Guild::MemberLoggedOut(Player* player)
+{
+    if (m_onlineMembers.erase(player->GetGUIDLow()))
+        { InvalidateRoster(); }
+}
+
 void Guild::BroadcastToGuild(WorldSession* session, const std::string& msg, uint32 language)
 {
     if (session && session->GetPlayer() && HasRankRight(session->GetPlayer()->GetRank(), GR_RIGHT_GCHATSPEAK))
@@ -582,11 +612,11 @@ void Guild::BroadcastToGuild(WorldSession* session, const std::string& msg, uint
         WorldPacket data;
         ChatHandler::BuildChatPacket(data, CHAT_MSG_GUILD, msg.c_str(), Language(language), session->GetPlayer()->GetChatTag(), session->GetPlayer()->GetObjectGuid(), session->GetPlayer()->GetName());
 
-        for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+        for (OnlineMemberList::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
         {
-            Player* pl = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
+            Player* pl = itr->second;
 
-            if (pl && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_GCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetObjectGuid()))
+            if (pl->IsInWorld() && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_GCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetObjectGuid()))
                 { pl->GetSession()->SendPacket(&data); }
         }
     }
@@ -596,14 +626,14 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 {
     if (session && session->GetPlayer() && HasRankRight(session->GetPlayer()->GetRank(), GR_RIGHT_OFFCHATSPEAK))
     {
-        for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
-        {
-            WorldPacket data;
-            ChatHandler::BuildChatPacket(data, CHAT_MSG_OFFICER, msg.c_str(), Language(language), session->GetPlayer()->GetChatTag(), session->GetPlayer()->GetObjectGuid(), session->GetPlayer()->GetName());
+        WorldPacket data;
+        ChatHandler::BuildChatPacket(data, CHAT_MSG_OFFICER, msg.c_str(), Language(language), session->GetPlayer()->GetChatTag(), session->GetPlayer()->GetObjectGuid(), session->GetPlayer()->GetName());
 
-            Player* pl = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
+        for (OnlineMemberList::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
+        {
+            Player* pl = itr->second;
 
-            if (pl && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_OFFCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetObjectGuid()))
+            if (pl->IsInWorld() && pl->GetSession() && HasRankRight(pl->GetRank(), GR_RIGHT_OFFCHATLISTEN) && !pl->GetSocial()->HasIgnore(session->GetPlayer()->GetObjectGuid()))
                 { pl->GetSession()->SendPacket(&data); }
         }
     }
@@ -611,24 +641,20 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 
 void Guild::BroadcastPacket(WorldPacket* packet)
 {
-    for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (OnlineMemberList::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
     {
-        Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
-        if (player)
-            { player->GetSession()->SendPacket(packet); }
+        if (itr->second->IsInWorld())
+            { itr->second->GetSession()->SendPacket(packet); }
     }
 }
 
 void Guild::BroadcastPacketToRank(WorldPacket* packet, uint32 rankId)
 {
-    for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
+    for (OnlineMemberList::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
     {
-        if (itr->second.RankId == rankId)
-        {
-            Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
-            if (player)
-                { player->GetSession()->SendPacket(packet); }
-        }
+        Player* player = itr->second;
+        if (player->IsInWorld() && player->GetRank() == rankId)
+            { player->GetSession()->SendPacket(packet); }
     }
 }
 
@@ -650,6 +676,7 @@ void Guild::CreateRank(std::string name_, uint32 rights)
 void Guild::AddRank(const std::string& name_, uint32 rights)
 {
     m_Ranks.push_back(RankInfo(name_, rights));
+    InvalidateRoster();
 }
 
 void Guild::DelRank()
@@ -663,6 +690,7 @@ void Guild::DelRank()
     CharacterDatabase.PExecute("DELETE FROM guild_rank WHERE rid>='%u' AND guildid='%u'", rank, m_Id);
 
     m_Ranks.pop_back();
+    InvalidateRoster();
 }
 
 std::string Guild::GetRankName(uint32 rankId)
@@ -699,6 +727,7 @@ void Guild::SetRankRights(uint32 rankId, uint32 rights)
         { return; }
 
     m_Ranks[rankId].Rights = rights;
+    InvalidateRoster();
 
     CharacterDatabase.PExecute("UPDATE guild_rank SET rights='%u' WHERE rid='%u' AND guildid='%u'", rights, rankId, m_Id);
 }
@@ -731,9 +760,26 @@ void Guild::Disband()
 }
 
 void Guild::Roster(WorldSession* session /*= NULL*/)
+{
+    // addons of large guilds ask for the roster often, it is only rebuilt after a change
+    time_t now = time(NULL);
+    if (!m_rosterTime || now - m_rosterTime >= GUILD_ROSTER_CACHE_TIME)
+    {
+        BuildRoster(m_roster);
+        m_rosterTime = now;
+    }
+
+    if (session)
+        { session->SendPacket(&m_roster); }
+    else
+        { BroadcastPacket(&m_roster); }
+    DEBUG_LOG("WORLD: Sent (SMSG_GUILD_ROSTER)");
+}
+
+void Guild::BuildRoster(WorldPacket& data)
 {
     // we can only guess size
-    WorldPacket data(SMSG_GUILD_ROSTER, (4 + MOTD.length() + 1 + GINFO.length() + 1 + 4 + m_Ranks.size() * 4 + members.size() * 50));
+    data.Initialize(SMSG_GUILD_ROSTER, (4 + MOTD.length() + 1 + GINFO.length() + 1 + 4 + m_Ranks.size() * 4 + members.size() * 50));
     data << uint32(members.size());
     data << MOTD;
     data << GINFO;
@@ -744,7 +790,9 @@ void Guild::Roster(WorldSession* session /*= NULL*/)
 
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
-        if (Player* pl = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first)))
+        OnlineMemberList::const_iterator online = m_onlineMembers.find(itr->first);
+        Player* pl = online != m_onlineMembers.end() && online->second->IsInWorld() ? online->second : NULL;
+        if (pl)
         {
             data << pl->GetObjectGuid();
             data << uint8(1);
@@ -770,11 +818,6 @@ void Guild::Roster(WorldSession* session /*= NULL*/)
             data << itr->second.OFFnote;
         }
     }
-    if (session)
-        { session->SendPacket(&data); }
-    else
-        { BroadcastPacket(&data); }
-    DEBUG_LOG("WORLD: Sent (SMSG_GUILD_ROSTER)");
 }
 
 void Guild::Query(WorldSession* session)
@@ -29,12 +29,15 @@
 #include "Item.h"
 #include "ObjectAccessor.h"
 #include "SharedDefines.h"
+#include "WorldPacket.h"
 
 class Item;
+class Guild;
 
 #define GUILD_RANK_NONE         0xFF
 #define GUILD_RANKS_MIN_COUNT   5
 #define GUILD_RANKS_MAX_COUNT   10
+#define GUILD_ROSTER_CACHE_TIME 10                          // seconds, levels and zones of online members change without notice
 
 enum GuildDefaultRanks
 {
@@ -175,6 +178,7 @@ struct MemberSlot
     void SetOFFNOTE(std::string offnote);
     void ChangeRank(uint32 newRank);
 
+    Guild* guild;
     ObjectGuid guid;
     uint32 accountId;
     std::string Name;
@@ -208,6 +212,7 @@ class Guild
         void Disband();
 
         typedef UNORDERED_MAP<uint32, MemberSlot> MemberList;
+        typedef UNORDERED_MAP<uint32, Player*> OnlineMemberList;
         typedef std::vector<RankInfo> RankList;
 
         uint32 GetId() { return m_Id; }
@@ -230,6 +235,8 @@ class Guild
         bool AddMember(ObjectGuid plGuid, uint32 plRank);
         bool DelMember(ObjectGuid guid, bool isDisbanding = false);
         bool ChangeMemberRank(ObjectGuid guid, uint8 newRank);
+        void MemberLoggedIn(Player* player);
+        void MemberLoggedOut(Player* player);
         // lowest rank is the count of ranks - 1 (the highest rank_id in table)
         uint32 GetLowestRank() const { return m_Ranks.size() - 1; }
 
@@ -259,10 +266,9 @@ class Guild
         template<class Do>
         void BroadcastWorker(Do& _do, Player* except = NULL)
         {
-            for (MemberList::iterator itr = members.begin(); itr != members.end(); ++itr)
-                if (Player* player = ObjectAccessor::FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first)))
-                    if (player != except)
-                        { _do(player); }
+            for (OnlineMemberList::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
+                if (itr->second->IsInWorld() && itr->second != except)
+                    { _do(itr->second); }
         }
 
         void CreateRank(std::string name, uint32 rights);
@@ -300,6 +306,7 @@ class Guild
         }
 
         void Roster(WorldSession* session = NULL);          // NULL = broadcast
+        void InvalidateRoster() { m_rosterTime = 0; }
         void Query(WorldSession* session);
 
         // Guild EventLog
@@ -309,6 +316,7 @@ class Guild
 
     protected:
         void AddRank(const std::string& name, uint32 rights);
+        void BuildRoster(WorldPacket& data);
 
         uint32 m_Id;
         std::string m_Name;
@@ -329,6 +337,10 @@ class Guild
         RankList m_Ranks;
 
         MemberList members;
+        OnlineMemberList m_onlineMembers;                   // logged in members, see MemberLoggedIn
+
+        WorldPacket m_roster;                               // last SMSG_GUILD_ROSTER
+        time_t m_rosterTime;                                // 0 when m_roster is outdated
 
         /** These are actually ordered lists. The first element is the oldest entry.*/
         typedef std::list<GuildEventLogEntry> GuildEventLog;
@@ -27,6 +27,10 @@
 #include "Unit.h"
 #include "DBCStructure.h"
 #include "SpellMgr.h"
+#include "Map.h"
+
+// the hating units can be in any region of a split continent, changes reaching out of the region updated by the thread are
+// done after the region pass, see Map::IsNearUpdatedRegion
 
 HostileRefManager::HostileRefManager(Unit* pOwner) : iOwner(pOwner)
 {
@@ -37,6 +41,24 @@ HostileRefManager::~HostileRefManager()
     deleteReferences();
 }
 
+//=================================================
+
+Map* HostileRefManager::getDeferringMap(Unit* pOther)
+{
+    if (!iOwner->IsInWorld() || !iOwner->GetMap()->IsRegionUpdateRunning())
+        { return NULL; }
+
+    if (Map* map = ThreatManager::getDeferringMap(iOwner, pOther))
+        { return map; }
+
+    for (HostileReference* ref = getFirst(); ref; ref = ref->next())
+    {
+        if (Map* map = ThreatManager::getDeferringMap(ref->getSource()->getOwner()))
+            { return map; }
+    }
+    return NULL;
+}
+
 //=================================================
 // send threat to all my hateres for the pVictim
 // The pVictim is hated than by them as well
@@ -44,12 +66,24 @@ HostileRefManager::~HostileRefManager()
 
 void HostileRefManager::threatAssist(Unit* pVictim, float pThreat, SpellEntry const* pThreatSpell, bool pSingleTarget)
 {
-    uint32 size = pSingleTarget ? 1 : getSize();            // if pSingleTarget do not devide threat
-    float threat = pThreat / size;
     HostileReference* ref = getFirst();
+    if (!ref || !pVictim)
+        { return; }
+
+    if (Map* map = getDeferringMap(pVictim))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_ASSIST, iOwner->GetObjectGuid(), pVictim->GetObjectGuid(), pThreat, pSingleTarget ? 1 : 0, pThreatSpell));
+        return;
+    }
+
+    uint32 size = pSingleTarget ? 1 : getSize();            // if pSingleTarget do not devide threat
+    SpellSchoolMask schoolMask = pThreatSpell ? GetSpellSchoolMask(pThreatSpell) : SPELL_SCHOOL_MASK_NORMAL;
+
+    // the threat modifiers depend on the victim and the spell only, so calculate the threat once for all hating units
+    float threat = ThreatCalcHelper::CalcThreat(pVictim, NULL, pThreat / size, false, schoolMask, pThreatSpell);
     while (ref)
     {
-        ref->getSource()->addThreat(pVictim, threat, false, (pThreatSpell ? GetSpellSchoolMask(pThreatSpell) : SPELL_SCHOOL_MASK_NORMAL), pThreatSpell);
+        ref->getSource()->addCalculatedThreat(pVictim, threat);
 
         ref = ref->next();
     }
@@ -59,6 +93,12 @@ void HostileRefManager::threatAssist(Unit* pVictim, float pThreat, SpellEntry co
 
 void HostileRefManager::addThreatPercent(int32 pValue)
 {
+    if (Map* map = getDeferringMap())
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_ADD_PERCENT, iOwner->GetObjectGuid(), ObjectGuid(), 0.0f, pValue));
+        return;
+    }
+
     HostileReference* ref;
 
     ref = getFirst();
@@ -74,6 +114,12 @@ void HostileRefManager::addThreatPercent(int32 pValue)
 
 void HostileRefManager::setOnlineOfflineState(bool pIsOnline)
 {
+    if (Map* map = getDeferringMap())
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_SET_ONLINE, iOwner->GetObjectGuid(), ObjectGuid(), 0.0f, pIsOnline ? 1 : 0));
+        return;
+    }
+
     HostileReference* ref;
 
     ref = getFirst();
@@ -89,6 +135,12 @@ void HostileRefManager::setOnlineOfflineState(bool pIsOnline)
 
 void HostileRefManager::updateThreatTables()
 {
+    if (Map* map = getDeferringMap())
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_UPDATE_TABLES, iOwner->GetObjectGuid()));
+        return;
+    }
+
     HostileReference* ref = getFirst();
     while (ref)
     {
@@ -103,6 +155,12 @@ void HostileRefManager::updateThreatTables()
 
 void HostileRefManager::deleteReferences()
 {
+    if (Map* map = getDeferringMap())
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_DELETE, iOwner->GetObjectGuid()));
+        return;
+    }
+
     HostileReference* ref = getFirst();
     while (ref)
     {
@@ -118,6 +176,12 @@ void HostileRefManager::deleteReferences()
 
 void HostileRefManager::deleteReferencesForFaction(uint32 faction)
 {
+    if (Map* map = getDeferringMap())
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_DELETE_FACTION, iOwner->GetObjectGuid(), ObjectGuid(), 0.0f, int32(faction)));
+        return;
+    }
+
     HostileReference* ref = getFirst();
     while (ref)
     {
@@ -136,6 +200,12 @@ void HostileRefManager::deleteReferencesForFaction(uint32 faction)
 
 void HostileRefManager::deleteReference(Unit* pCreature)
 {
+    if (Map* map = getDeferringMap(pCreature))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_DELETE_ONE, iOwner->GetObjectGuid(), pCreature->GetObjectGuid()));
+        return;
+    }
+
     HostileReference* ref = getFirst();
     while (ref)
     {
@@ -155,6 +225,12 @@ void HostileRefManager::deleteReference(Unit* pCreature)
 
 void HostileRefManager::setOnlineOfflineState(Unit* pCreature, bool pIsOnline)
 {
+    if (Map* map = getDeferringMap(pCreature))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_HOSTILE_SET_ONLINE, iOwner->GetObjectGuid(), pCreature->GetObjectGuid(), 0.0f, pIsOnline ? 1 : 0));
+        return;
+    }
+
     HostileReference* ref = getFirst();
     while (ref)
     {
@@ -29,6 +29,7 @@
 #include "Utilities/LinkedReference/RefManager.h"
 
 class Unit;
+class Map;
 class ThreatManager;
 class HostileReference;
 struct SpellEntry;
@@ -70,6 +71,9 @@ class HostileRefManager : public RefManager<Unit, ThreatManager>
         void deleteReference(Unit* pCreature);
 
     private:
+        // Map to queue a change at if a hating unit or pOther can't be changed now, see ThreatManager::getDeferringMap
+        Map* getDeferringMap(Unit* pOther = NULL);
+
         Unit* iOwner;                                       // owner of manager variable, back ref. to it, always exist
 };
 //=================================================
@@ -26,6 +26,7 @@
 #define MANGOS_H_ITEMPROTOTYPE
 
 #include "Common.h"
+#include "StringPool.h"
 
 enum ItemModType
 {
@@ -505,8 +506,8 @@ struct ItemPrototype
 
 struct ItemLocale
 {
-    std::vector<std::string> Name;
-    std::vector<std::string> Description;
+    LocaleStrings Name;
+    LocaleStrings Description;
 };
 
 #endif
@@ -174,14 +174,14 @@ bool ChatHandler::HandleGMListIngameCommand(char* /*args*/)
     std::list< std::pair<std::string, bool> > names;
 
     {
-        HashMapHolder<Player>::ReadGuard g(HashMapHolder<Player>::GetLock());
-        HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-        for (HashMapHolder<Player>::MapType::const_iterator itr = m.begin(); itr != m.end(); ++itr)
+        HashMapHolder<Player>::SnapshotType players;
+        sObjectAccessor.GetPlayers(players);
+        for (HashMapHolder<Player>::SnapshotType::const_iterator itr = players.begin(); itr != players.end(); ++itr)
         {
-            AccountTypes itr_sec = itr->second->GetSession()->GetSecurity();
-            if ((itr->second->isGameMaster() || (itr_sec > SEC_PLAYER && itr_sec <= (AccountTypes)sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_GM_LIST))) &&
-                (!m_session || itr->second->IsVisibleGloballyFor(m_session->GetPlayer())))
-                { names.push_back(std::make_pair<std::string, bool>(GetNameLink(itr->second), itr->second->isAcceptWhispers())); }
+            AccountTypes itr_sec = (*itr)->GetSession()->GetSecurity();
+            if (((*itr)->isGameMaster() || (itr_sec > SEC_PLAYER && itr_sec <= (AccountTypes)sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_GM_LIST))) &&
+                (!m_session || (*itr)->IsVisibleGloballyFor(m_session->GetPlayer())))
+                { names.push_back(std::make_pair<std::string, bool>(GetNameLink(*itr), (*itr)->isAcceptWhispers())); }
         }
     }
 
@@ -4951,6 +4951,123 @@ bool ChatHandler::HandleServerCorpsesCommand(char* /*args*/)
     return true;
 }
 
+/// Display time spent in the world update stages
+bool ChatHandler::HandleServerTickStatsCommand(char* /*args*/)
+{
+    PSendSysMessage("Last tick: %u ms, budget: %u ms, ticks over budget: %u",
+                    sWorld.GetLastTickTime(), sWorld.getConfig(CONFIG_UINT32_TICK_BUDGET), sWorld.GetTickOverruns());
+    PSendSysMessage("Deferred map transfers of last map update: %u in %u ms",
+                    sMapMgr.GetLastDeferredActionCount(), sMapMgr.GetLastDeferredActionTime());
+
+    for (int i = 0; i < WUPDATE_STAGE_COUNT; ++i)
+    {
+        WorldUpdateStage stage = WorldUpdateStage(i);
+        WorldUpdateStageStats const& stats = sWorld.GetUpdateStageStats(stage);
+
+        PSendSysMessage("%s: last %u ms, avg %u ms, max %u ms, calls %u, overruns %u, deferred %u",
+                        World::GetUpdateStageName(stage), stats.lastTime, stats.calls ? uint32(stats.totalTime / stats.calls) : 0,
+                        stats.maxTime, stats.calls, stats.overruns, stats.deferrals);
+    }
+
+    return true;
+}
+
+/// Display the loaded grids of all terrains and their memory
+bool ChatHandler::HandleServerTerrainStatsCommand(char* /*args*/)
+{
+    TerrainCacheStats stats;
+    sTerrainMgr.GetCacheStats(stats);
+
+    PSendSysMessage("Terrains: %u, loaded grids: %u, memory: " UI64FMTD " KB, budget: %u MB",
+                    stats.terrains, stats.loadedGrids, stats.memory, sWorld.getConfig(CONFIG_UINT32_TERRAIN_MEMORY_BUDGET));
+    PSendSysMessage("Unused grids: %u with " UI64FMTD " KB, used again: %u, evicted: %u",
+                    stats.unusedGrids, stats.unusedMemory, stats.reusedGrids, stats.evictedGrids);
+
+    return true;
+}
+
+/// Display request timing of the database connections, `reset` clears the counters
+bool ChatHandler::HandleServerDbStatsCommand(char* args)
+{
+    bool reset = false;
+    if (*args)
+    {
+        if (!ExtractLiteralArg(&args, "reset"))
+            { return false; }
+
+        reset = true;
+    }
+
+    Database* databases[] = { &LoginDatabase, &WorldDatabase, &CharacterDatabase };
+    char const* names[] = { "Login", "World", "Character" };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (reset)
+        {
+            databases[i]->ResetStats();
+            continue;
+        }
+
+        std::vector<std::string> lines;
+        databases[i]->GetStatsLines(lines);
+
+        PSendSysMessage("%s database:", names[i]);
+        for (std::vector<std::string>::const_iterator itr = lines.begin(); itr != lines.end(); ++itr)
+            { PSendSysMessage("  %s", itr->c_str()); }
+    }
+
+    if (reset)
+        { SendSysMessage("Database request counters reset."); }
+
+    return true;
+}
+
+/// Display visibility and relocation work of the loaded maps, as comma separated values with `csv`
+bool ChatHandler::HandleServerMapStatsCommand(char* args)
+{
+    bool csv = false;
+    if (*args)
+    {
+        if (!ExtractLiteralArg(&args, "csv"))
+            { return false; }
+
+        csv = true;
+        SendSysMessage("map,instance,players,notifies_scheduled,notifies_executed,visibility_updates,visibility_us,"
+                       "client_creates,client_destroys,player_relocations,player_relocation_us,creature_relocations,creature_relocation_us");
+    }
+
+    MapManager::MapMapType const& maps = sMapMgr.Maps();
+    for (MapManager::MapMapType::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+    {
+        Map* map = itr->second;
+        MapVisibilityStats const& stats = map->GetVisibilityStats();
+
+        if (csv)
+        {
+            PSendSysMessage("%u,%u,%u,%u,%u,%u," UI64FMTD ",%u,%u,%u," UI64FMTD ",%u," UI64FMTD,
+                            map->GetId(), map->GetInstanceId(), map->GetPlayersCountExceptGMs(),
+                            stats.relocationNotifiesScheduled, stats.relocationNotifiesExecuted,
+                            stats.visibilityUpdates, stats.visibilityUpdateTime,
+                            stats.clientObjectsCreated, stats.clientObjectsDestroyed,
+                            stats.playerRelocations, stats.playerRelocationTime,
+                            stats.creatureRelocations, stats.creatureRelocationTime);
+            continue;
+        }
+
+        PSendSysMessage("Map %u instance %u, players %u:", map->GetId(), map->GetInstanceId(), map->GetPlayersCountExceptGMs());
+        PSendSysMessage("  relocation notifies: scheduled %u, executed %u", stats.relocationNotifiesScheduled, stats.relocationNotifiesExecuted);
+        PSendSysMessage("  visibility updates: %u, avg %u us, client creates %u, destroys %u",
+                        stats.visibilityUpdates, stats.visibilityUpdates ? uint32(stats.visibilityUpdateTime / stats.visibilityUpdates) : 0,
+                        stats.clientObjectsCreated, stats.clientObjectsDestroyed);
+        PSendSysMessage("  player relocations: %u, avg %u us, creature relocations: %u, avg %u us",
+                        stats.playerRelocations, stats.playerRelocations ? uint32(stats.playerRelocationTime / stats.playerRelocations) : 0,
+                        stats.creatureRelocations, stats.creatureRelocations ? uint32(stats.creatureRelocationTime / stats.creatureRelocations) : 0);
+    }
+
+    return true;
+}
+
 bool ChatHandler::HandleRepairitemsCommand(char* args)
 {
     Player* target;
@@ -5076,8 +5193,11 @@ bool ChatHandler::HandleMmapLocCommand(char* /*args*/)
     PSendSysMessage("gridloc [%i,%i]", gx, gy);
 
     // calculate navmesh tile location
-    const dtNavMesh* navmesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(player->GetMapId());
-    const dtNavMeshQuery* navmeshquery = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshQuery(player->GetMapId(), player->GetInstanceId());
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, mmap->GetLock(), true);
+
+    const dtNavMesh* navmesh = NULL;
+    const dtNavMeshQuery* navmeshquery = mmap->GetThreadNavMeshQuery(player->GetMapId(), navmesh);
     if (!navmesh || !navmeshquery)
     {
         PSendSysMessage("NavMesh not loaded for current map.");
@@ -5122,8 +5242,7 @@ bool ChatHandler::HandleMmapLoadedTilesCommand(char* /*args*/)
     uint32 mapid = m_session->GetPlayer()->GetMapId();
 
     const dtNavMesh* navmesh = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMesh(mapid);
-    const dtNavMeshQuery* navmeshquery = MMAP::MMapFactory::createOrGetMMapManager()->GetNavMeshQuery(mapid, m_session->GetPlayer()->GetInstanceId());
-    if (!navmesh || !navmeshquery)
+    if (!navmesh)
     {
         PSendSysMessage("NavMesh not loaded for current map.");
         return true;
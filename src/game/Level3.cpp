@@ -61,6 +61,7 @@
 #include "CreatureEventAIMgr.h"
 #include "AuctionHouseBot/AuctionHouseBot.h"
 #include "SQLStorages.h"
+#include "QueryResponseCache.h"
 
 static uint32 ahbotQualityIds[MAX_AUCTION_QUALITY] =
 {
@@ -424,6 +425,24 @@ bool ChatHandler::HandleReloadConditionsCommand(char* /*args*/)
     return true;
 }
 
+bool ChatHandler::HandleReloadCreatureTemplateCommand(char* /*args*/)
+{
+    sLog.outString("Re-Loading changed rows of `creature_template`...");
+
+    uint32 changedCount = 0;
+    if (!sObjectMgr.ReloadCreatureTemplates(changedCount))
+    {
+        SendSysMessage("DB table `creature_template` can't be read, nothing reloaded.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    sLog.outString(">> %u creature templates changed", changedCount);
+    sQueryResponseCache.Clear(QUERY_RESPONSE_CREATURE);
+    SendGlobalSysMessage("DB table `creature_template` reloaded.");
+    return true;
+}
+
 bool ChatHandler::HandleReloadCreaturesStatsCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading stats data...");
@@ -576,6 +595,7 @@ bool ChatHandler::HandleReloadNpcTextCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading `npc_text` Table!");
     sObjectMgr.LoadGossipText();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_NPC_TEXT);
     SendGlobalSysMessage("DB table `npc_text` reloaded.");
     return true;
 }
@@ -753,6 +773,7 @@ bool ChatHandler::HandleReloadPageTextsCommand(char* /*args*/)
 {
     sLog.outString("Re-Loading Page Texts...");
     sObjectMgr.LoadPageTexts();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_PAGE_TEXT);
     SendGlobalSysMessage("DB table `page_texts` reloaded.");
     return true;
 }
@@ -979,22 +1000,45 @@ bool ChatHandler::HandleReloadGameTeleCommand(char* /*args*/)
 
 bool ChatHandler::HandleReloadLocalesCreatureCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Creature ...");
     sObjectMgr.LoadCreatureLocales();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_CREATURE);
     SendGlobalSysMessage("DB table `locales_creature` reloaded.");
     return true;
 }
 
 bool ChatHandler::HandleReloadLocalesGameobjectCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Gameobject ... ");
     sObjectMgr.LoadGameObjectLocales();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_GAMEOBJECT);
     SendGlobalSysMessage("DB table `locales_gameobject` reloaded.");
     return true;
 }
 
 bool ChatHandler::HandleReloadLocalesGossipMenuOptionCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Gossip Menu Option ... ");
     sObjectMgr.LoadGossipMenuItemsLocales();
     SendGlobalSysMessage("DB table `locales_gossip_menu_option` reloaded.");
@@ -1003,30 +1047,61 @@ bool ChatHandler::HandleReloadLocalesGossipMenuOptionCommand(char* /*args*/)
 
 bool ChatHandler::HandleReloadLocalesItemCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Item ... ");
     sObjectMgr.LoadItemLocales();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_ITEM);
     SendGlobalSysMessage("DB table `locales_item` reloaded.");
     return true;
 }
 
 bool ChatHandler::HandleReloadLocalesNpcTextCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales NPC Text ... ");
     sObjectMgr.LoadGossipTextLocales();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_NPC_TEXT);
     SendGlobalSysMessage("DB table `locales_npc_text` reloaded.");
     return true;
 }
 
 bool ChatHandler::HandleReloadLocalesPageTextCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Page Text ... ");
     sObjectMgr.LoadPageTextLocales();
+    sQueryResponseCache.Clear(QUERY_RESPONSE_PAGE_TEXT);
     SendGlobalSysMessage("DB table `locales_page_text` reloaded.");
     return true;
 }
 
 bool ChatHandler::HandleReloadLocalesPointsOfInterestCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Points Of Interest ... ");
     sObjectMgr.LoadPointOfInterestLocales();
     SendGlobalSysMessage("DB table `locales_points_of_interest` reloaded.");
@@ -1035,6 +1110,13 @@ bool ChatHandler::HandleReloadLocalesPointsOfInterestCommand(char* /*args*/)
 
 bool ChatHandler::HandleReloadLocalesQuestCommand(char* /*args*/)
 {
+    if (!sObjectMgr.AreLocalesLoaded())
+    {
+        SendSysMessage("Locales are loaded at the first login of a localized client, please attempt reload later.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
     sLog.outString("Re-Loading Locales Quest ... ");
     sObjectMgr.LoadQuestLocales();
     SendGlobalSysMessage("DB table `locales_quest` reloaded.");
@@ -3082,9 +3164,9 @@ bool ChatHandler::HandleLookupObjectCommand(char* args)
             GameObjectLocale const* gl = sObjectMgr.GetGameObjectLocale(itr->id);
             if (gl)
             {
-                if ((int32)gl->Name.size() > loc_idx && !gl->Name[loc_idx].empty())
+                if (char const* locName = gl->Name.Get(loc_idx))
                 {
-                    std::string name = gl->Name[loc_idx];
+                    std::string name = locName;
 
                     if (Utf8FitTo(name, wnamepart))
                     {
@@ -4600,9 +4682,10 @@ bool ChatHandler::HandleResetAllCommand(char* args)
     }
 
     CharacterDatabase.PExecute("UPDATE characters SET at_login = at_login | '%u' WHERE (at_login & '%u') = '0'", atLogin, atLogin);
-    HashMapHolder<Player>::MapType const& plist = sObjectAccessor.GetPlayers();
-    for (HashMapHolder<Player>::MapType::const_iterator itr = plist.begin(); itr != plist.end(); ++itr)
-        { itr->second->SetAtLoginFlag(atLogin); }
+    HashMapHolder<Player>::SnapshotType players;
+    sObjectAccessor.GetPlayers(players);
+    for (HashMapHolder<Player>::SnapshotType::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+        { (*itr)->SetAtLoginFlag(atLogin); }
 
     return true;
 }
@@ -5604,10 +5687,15 @@ bool ChatHandler::HandlePDumpWriteCommand(char* args)
         return false;
     }
 
-    switch (PlayerDumpWriter().WriteDump(file, lowguid))
+    bool binary = ExtractLiteralArg(&args, "binary") != NULL;
+
+    switch (PlayerDumpWriter().WriteDump(file, lowguid, binary))
     {
         case DUMP_SUCCESS:
             PSendSysMessage(LANG_COMMAND_EXPORT_SUCCESS);
+            // the dump is made from the database rows, see PlayerDumpWriter::GetDump
+            if (sObjectMgr.GetPlayer(guid))
+                { SendSysMessage("The character is online, its changes since the last save are not in the dump."); }
             break;
         case DUMP_FILE_OPEN_ERROR:
             PSendSysMessage(LANG_FILE_OPEN_FAIL, file);
@@ -32,6 +32,9 @@
 #include "DBCStores.h"
 #include "SQLStorages.h"
 
+#include <algorithm>
+#include <cfloat>
+
 static eConfigFloatValues const qualityToRate[MAX_ITEM_QUALITY] =
 {
     CONFIG_FLOAT_RATE_DROP_ITEM_POOR,                       // ITEM_QUALITY_POOR
@@ -70,6 +73,7 @@ class LootTemplate::LootGroup                               // A set of loot def
     private:
         LootStoreItemList ExplicitlyChanced;                // Entries with chances defined in DB
         LootStoreItemList EqualChanced;                     // Zero chances - every entry takes the same chance
+        std::vector<float> ChanceLimits;                    // Summed up chances of ExplicitlyChanced up to each entry, FLT_MAX from an entry with 100% on
 
         LootStoreItem const* Roll() const;                  // Rolls an item from the group, returns NULL if all miss their chances
 };
@@ -102,8 +106,9 @@ void LootStore::LoadLootTable()
 
     sLog.outString("%s :", GetName());
 
-    //                                                 0      1     2                    3        4              5         6
-    QueryResult* result = WorldDatabase.PQuery("SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, condition_id FROM %s", GetName());
+    //                                      0      1     2                    3        4              5         6
+    std::string query = std::string("SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, condition_id FROM ") + GetName();
+    QueryResult* result = WorldDatabase.QueryWithSnapshot(GetName(), GetName(), query.c_str(), WorldDatabase.GetTableRowCount(GetName()));
 
     if (result)
     {
@@ -838,7 +843,15 @@ ByteBuffer& operator<<(ByteBuffer& b, LootView const& lv)
 void LootTemplate::LootGroup::AddEntry(LootStoreItem& item)
 {
     if (item.chance != 0)
-        { ExplicitlyChanced.push_back(item); }
+    {
+        ExplicitlyChanced.push_back(item);
+
+        // the roll takes the first entry with a summed up chance above it, an entry with 100% ends the roll
+        float limit = ChanceLimits.empty() ? 0.0f : ChanceLimits.back();
+        if (limit != FLT_MAX)
+            { limit = item.chance >= 100.0f ? FLT_MAX : limit + item.chance; }
+        ChanceLimits.push_back(limit);
+    }
     else
         { EqualChanced.push_back(item); }
 }
@@ -850,14 +863,11 @@ LootStoreItem const* LootTemplate::LootGroup::Roll() const
     {
         float Roll = rand_chance_f();
 
-        for (uint32 i = 0; i < ExplicitlyChanced.size(); ++i) // check each explicitly chanced entry in the template and modify its chance based on quality.
+        // same as subtracting the chances entry by entry until the roll drops below 0
+        if (Roll < ChanceLimits.back())
         {
-            if (ExplicitlyChanced[i].chance >= 100.0f)
-                { return &ExplicitlyChanced[i]; }
-
-            Roll -= ExplicitlyChanced[i].chance;
-            if (Roll < 0)
-                { return &ExplicitlyChanced[i]; }
+            std::vector<float>::const_iterator limit = std::upper_bound(ChanceLimits.begin(), ChanceLimits.end(), Roll);
+            return &ExplicitlyChanced[limit - ChanceLimits.begin()];
         }
     }
     if (!EqualChanced.empty())                              // If nothing selected yet - an item is taken from equal-chanced part
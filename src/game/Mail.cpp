@@ -274,6 +274,19 @@ void MailDraft::SendReturnToSender(uint32 sender_acc, ObjectGuid sender_guid, Ob
     // will delete item or place to receiver mail list
     SendMailTo(MailReceiver(receiver, receiver_guid), MailSender(MAIL_NORMAL, sender_guid.GetCounter()), MAIL_CHECK_MASK_RETURNED, deliver_delay);
 }
+
+MailInsertBatch::MailInsertBatch() :
+    mails(CharacterDatabase, "mail", "id,messageType,stationery,mailTemplateId,sender,receiver,subject,itemTextId,has_items,expire_time,deliver_time,money,cod,checked"),
+    mailItems(CharacterDatabase, "mail_items", "mail_id,item_guid,item_template,receiver")
+{
+}
+
+void MailInsertBatch::Execute()
+{
+    mails.Execute();
+    mailItems.Execute();
+}
+
 /**
  * Sends a mail.
  *
@@ -281,8 +294,9 @@ void MailDraft::SendReturnToSender(uint32 sender_acc, ObjectGuid sender_guid, Ob
  * @param sender               The MailSender from which this mail is originated.
  * @param checked              The mask used to specify the mail.
  * @param deliver_delay        The delay after which the mail is delivered in seconds
+ * @param batch                The batch the mail is added to instead of inserting it at once, can be NULL
  */
-void MailDraft::SendMailTo(MailReceiver const& receiver, MailSender const& sender, MailCheckMask checked, uint32 deliver_delay)
+void MailDraft::SendMailTo(MailReceiver const& receiver, MailSender const& sender, MailCheckMask checked, uint32 deliver_delay, MailInsertBatch* batch)
 {
     Player* pReceiver = receiver.GetPlayer();               // can be NULL
 
@@ -338,23 +352,54 @@ void MailDraft::SendMailTo(MailReceiver const& receiver, MailSender const& sende
     }
 
     time_t expire_time = deliver_time + expire_delay;
+    sObjectMgr.ScheduleMailExpiry(mailId, expire_time);
 
     // Add to DB
-    std::string safe_subject = GetSubject();
-
-    CharacterDatabase.BeginTransaction();
-    CharacterDatabase.escape_string(safe_subject);
-    CharacterDatabase.PExecute("INSERT INTO mail (id,messageType,stationery,mailTemplateId,sender,receiver,subject,itemTextId,has_items,expire_time,deliver_time,money,cod,checked) "
-                               "VALUES ('%u', '%u', '%u', '%u', '%u', '%u', '%s', '%u', '%u', '" UI64FMTD "','" UI64FMTD "', '%u', '%u', '%u')",
-                               mailId, sender.GetMailMessageType(), sender.GetStationery(), GetMailTemplateId(), sender.GetSenderId(), receiver.GetPlayerGuid().GetCounter(), safe_subject.c_str(), GetBodyId(), (has_items ? 1 : 0), (uint64)expire_time, (uint64)deliver_time, m_money, m_COD, checked);
+    if (batch)
+    {
+        batch->mails.NewRow();
+        batch->mails.addUInt32(mailId);
+        batch->mails.addUInt32(sender.GetMailMessageType());
+        batch->mails.addUInt32(sender.GetStationery());
+        batch->mails.addUInt32(GetMailTemplateId());
+        batch->mails.addUInt32(sender.GetSenderId());
+        batch->mails.addUInt32(receiver.GetPlayerGuid().GetCounter());
+        batch->mails.addString(GetSubject());
+        batch->mails.addUInt32(GetBodyId());
+        batch->mails.addUInt32(has_items ? 1 : 0);
+        batch->mails.addUInt64(uint64(expire_time));
+        batch->mails.addUInt64(uint64(deliver_time));
+        batch->mails.addUInt32(m_money);
+        batch->mails.addUInt32(m_COD);
+        batch->mails.addUInt32(checked);
 
-    for (MailItemMap::const_iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
+        for (MailItemMap::const_iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
+        {
+            batch->mailItems.NewRow();
+            batch->mailItems.addUInt32(mailId);
+            batch->mailItems.addUInt32(mailItemIter->second->GetGUIDLow());
+            batch->mailItems.addUInt32(mailItemIter->second->GetEntry());
+            batch->mailItems.addUInt32(receiver.GetPlayerGuid().GetCounter());
+        }
+    }
+    else
     {
-        Item* item = mailItemIter->second;
-        CharacterDatabase.PExecute("INSERT INTO mail_items (mail_id,item_guid,item_template,receiver) VALUES ('%u', '%u', '%u','%u')",
-                                   mailId, item->GetGUIDLow(), item->GetEntry(), receiver.GetPlayerGuid().GetCounter());
+        std::string safe_subject = GetSubject();
+
+        CharacterDatabase.BeginTransaction();
+        CharacterDatabase.escape_string(safe_subject);
+        CharacterDatabase.PExecute("INSERT INTO mail (id,messageType,stationery,mailTemplateId,sender,receiver,subject,itemTextId,has_items,expire_time,deliver_time,money,cod,checked) "
+                                   "VALUES ('%u', '%u', '%u', '%u', '%u', '%u', '%s', '%u', '%u', '" UI64FMTD "','" UI64FMTD "', '%u', '%u', '%u')",
+                                   mailId, sender.GetMailMessageType(), sender.GetStationery(), GetMailTemplateId(), sender.GetSenderId(), receiver.GetPlayerGuid().GetCounter(), safe_subject.c_str(), GetBodyId(), (has_items ? 1 : 0), (uint64)expire_time, (uint64)deliver_time, m_money, m_COD, checked);
+
+        for (MailItemMap::const_iterator mailItemIter = m_items.begin(); mailItemIter != m_items.end(); ++mailItemIter)
+        {
+            Item* item = mailItemIter->second;
+            CharacterDatabase.PExecute("INSERT INTO mail_items (mail_id,item_guid,item_template,receiver) VALUES ('%u', '%u', '%u','%u')",
+                                       mailId, item->GetGUIDLow(), item->GetEntry(), receiver.GetPlayerGuid().GetCounter());
+        }
+        CharacterDatabase.CommitTransaction();
     }
-    CharacterDatabase.CommitTransaction();
 
     // For online receiver update in game mail status and data
     if (pReceiver)
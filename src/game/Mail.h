@@ -42,6 +42,7 @@
 
 #include "Common.h"
 #include "ObjectGuid.h"
+#include "Database/SqlBatch.h"
 #include <map>
 
 struct AuctionEntry;
@@ -179,6 +180,20 @@ class MailReceiver
         Player* m_receiver;
         ObjectGuid m_receiver_guid;
 };
+/**
+ * The rows of many mails sent at once, written as multi-row inserts.
+ */
+struct MailInsertBatch
+{
+    MailInsertBatch();
+    /**
+     * Issues the inserts, they join the transaction of the caller.
+     */
+    void Execute();
+
+    SqlInsertBatch mails;
+    SqlInsertBatch mailItems;
+};
 /**
  * The class to represent the draft of a mail.
  */
@@ -256,7 +271,7 @@ class MailDraft
         void CloneFrom(MailDraft const& draft);
     public:                                                 // finishers
         void SendReturnToSender(uint32 sender_acc, ObjectGuid sender_guid, ObjectGuid receiver_guid);
-        void SendMailTo(MailReceiver const& receiver, MailSender const& sender, MailCheckMask checked = MAIL_CHECK_MASK_NONE, uint32 deliver_delay = 0);
+        void SendMailTo(MailReceiver const& receiver, MailSender const& sender, MailCheckMask checked = MAIL_CHECK_MASK_NONE, uint32 deliver_delay = 0, MailInsertBatch* batch = NULL);
     private:
         MailDraft(MailDraft const&);                        // trap decl, no body, mail draft must cloned only explicitly...
         MailDraft& operator=(MailDraft const&);             // trap decl, no body, ...because items clone is high price operation
@@ -43,6 +43,7 @@
 #include "WorldSession.h"
 #include "Opcodes.h"
 #include "Chat.h"
+#include "Database/DatabaseImpl.h"
 
 bool WorldSession::CheckMailBox(ObjectGuid guid)
 {
@@ -353,7 +354,7 @@ void WorldSession::HandleMailReturnToSender(WorldPacket& recv_data)
 
     Player* pl = _player;
     Mail* m = pl->GetMail(mailId);
-    if (!m || m->state == MAIL_STATE_DELETED || m->deliver_time > time(NULL))
+    if (!m || m->state == MAIL_STATE_DELETED || m->deliver_time > time(NULL) || (m->HasItems() && !pl->IsMailedItemsLoaded()))
     {
         pl->SendMailResult(mailId, MAIL_RETURNED_TO_SENDER, MAIL_ERR_INTERNAL_ERROR);
         return;
@@ -541,6 +542,45 @@ void WorldSession::HandleGetMailList(WorldPacket& recv_data)
     if (!CheckMailBox(mailboxGuid))
         { return; }
 
+    // the items in the mails are loaded at the first look into the mailbox
+    if (!_player->IsMailedItemsLoaded())
+    {
+        if (_player->StartMailedItemsLoading())
+        {
+            CharacterDatabase.AsyncPQuery(&WorldSession::HandleMailedItemsCallBack, GetAccountId(), _player->GetGUIDLow(),
+                                          "SELECT data, mail_id, item_guid, item_template FROM mail_items JOIN item_instance ON item_guid = guid WHERE receiver = '%u'",
+                                          _player->GetGUIDLow());
+        }
+        return;
+    }
+
+    SendMailList();
+}
+
+/**
+ * Loads the mailed items queried by HandleGetMailList and sends the mail list then.
+ */
+void WorldSession::HandleMailedItemsCallBack(QueryResult* result, uint32 accountId, uint32 playerLowGuid)
+{
+    WorldSession* session = sWorld.FindSession(accountId);
+    Player* player = session ? session->GetPlayer() : NULL;
+
+    // the player may have logged out, or logged in again and asked once more
+    if (!player || player->GetGUIDLow() != playerLowGuid || !player->IsMailedItemsLoading())
+    {
+        delete result;
+        return;
+    }
+
+    player->LoadMailedItems(result);
+    session->SendMailList();
+}
+
+/**
+ * Sends the mails in the mailbox to the client, the mailed items must be loaded.
+ */
+void WorldSession::SendMailList()
+{
     // client can't work with packets > max int16 value
     const uint32 maxPacketSize = 32767;
 
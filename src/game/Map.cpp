@@ -24,6 +24,7 @@
 
 #include "Map.h"
 #include "MapManager.h"
+#include "MapQueryCache.h"
 #include "Player.h"
 #include "GridNotifiers.h"
 #include "Log.h"
@@ -33,6 +34,7 @@
 #include "GridNotifiersImpl.h"
 #include "Transports.h"
 #include "ObjectAccessor.h"
+#include "WhoListMgr.h"
 #include "ObjectMgr.h"
 #include "World.h"
 #include "Group.h"
@@ -41,9 +43,27 @@
 #include "MapPersistentStateMgr.h"
 #include "VMapFactory.h"
 #include "MoveMap.h"
+#include "movement/MoveSpline.h"
 #include "BattleGround/BattleGroundMgr.h"
 #include "Chat.h"
 #include "LuaEngine.h"
+#include "Metrics.h"
+#include "Profiler.h"
+#include "TickArena.h"
+
+#include <ace/TSS_T.h>
+
+/// Region of a split map updated by the thread, see Map::IsNearUpdatedRegion
+struct UpdatedRegion
+{
+    UpdatedRegion() : map(NULL), regionId(0) {}
+
+    Map const* map;
+    uint32 regionId;
+};
+
+typedef ACE_TSS<UpdatedRegion> UpdatedRegionTSS;
+static UpdatedRegionTSS s_updatedRegion;
 
 Map::~Map()
 {
@@ -53,7 +73,7 @@ Map::~Map()
     UnloadAll(true);
 
     if (!m_scriptSchedule.empty())
-        { sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size()); }
+        { sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.GetStepCount()); }
 
     if (m_persistentState)
         { m_persistentState->SetUsedByMapState(NULL); }         // field pointer can be deleted after this
@@ -61,8 +81,8 @@ Map::~Map()
     delete i_data;
     i_data = NULL;
 
-    // unload instance specific navigation data
-    MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(m_TerrainData->GetMapId(), GetInstanceId());
+    delete m_spatialHash;
+    delete m_queryCache;
 
     // release reference count
     if (m_TerrainData->Release())
@@ -82,13 +102,36 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
     : i_mapEntry(sMapStore.LookupEntry(id)),
       i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0),
       m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE), m_persistentState(NULL),
-      m_activeNonPlayersIter(m_activeNonPlayers.end()),
-      i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-      i_data(NULL), i_script_id(0)
+      m_activeNonPlayersIter(m_activeNonPlayers.end()), m_hibernating(false),
+      i_gridExpiry(expiry), m_gridCount(0), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
+      m_activeCellsTick(0), m_regionSize(0), m_regionUpdateRunning(false),
+      m_spatialHash(NULL), m_queryCache(NULL), m_queryCacheTimer(0),
+      m_periodicBatchWindow(0), m_periodicBatchTimer(0), m_periodicTickUpdate(true),
+      m_objectUpdateSendParts(0), m_visibilityScale(1.0f), m_visibilityScaleTimer(0), m_visibilityScaleUpdateTime(0), m_visibilityScaleUpdates(0),
+      m_scriptSchedule(this), m_updateTimeMetric(NULL), i_data(NULL), i_script_id(0)
 {
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
 
+    // shared by all instances of the map id
+    static uint32 const updateTimeBounds[] = { 5, 10, 25, 50, 100, 200, 500, 1000 };
+    char mapIdStr[12];
+    snprintf(mapIdStr, sizeof(mapIdStr), "%u", id);
+    m_updateTimeMetric = sMetrics.GetHistogram("map_update_ms", "Duration of the map updates in ms", updateTimeBounds, countof(updateTimeBounds), "map", mapIdStr);
+
+    // only continents are split, regions of one instance would share its instance data, threat lists and group state
+    if (!Instanceable())
+        { m_regionSize = sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_CONTINENT_REGION_SIZE); }
+
+    m_regionCells.resize(GetRegionsPerAxis() * GetRegionsPerAxis());
+    m_regionUpdateTime.resize(m_regionCells.size(), 0);
+
+    if (float searchRadius = sWorld.getConfig(CONFIG_FLOAT_SPATIAL_HASH_SEARCH_RADIUS))
+        { m_spatialHash = new SpatialHash(searchRadius); }
+
+    if (sWorld.getConfig(CONFIG_UINT32_MAP_QUERY_CACHE_TIME))
+        { m_queryCache = new MapQueryCache(); }
+
     for (unsigned int j = 0; j < MAX_NUMBER_OF_GRIDS; ++j)
     {
         for (unsigned int idx = 0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
@@ -206,6 +249,7 @@ void Map::RemoveFromGrid(Creature* obj, NGridType* grid, Cell const& cell)
 
 void Map::DeleteFromWorld(Player* pl)
 {
+    sWhoListMgr.RemovePlayer(pl);
     sObjectAccessor.RemoveObject(pl);
     delete pl;
 }
@@ -213,14 +257,31 @@ void Map::DeleteFromWorld(Player* pl)
 void
 Map::EnsureGridCreated(const GridPair& p)
 {
+    RegionGuard guard(*this);
+
     if (!getNGrid(p.x_coord, p.y_coord))
     {
         setNGrid(new NGridType(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
                  p.x_coord, p.y_coord);
+        ++m_gridCount;
 
         // build a linkage between this map and NGridType
         buildNGridLinkage(getNGrid(p.x_coord, p.y_coord));
 
+        // grid comes back within its unload delay (players moving along the grid border), keep it loaded longer next time
+        GridUnloadInfoMap::iterator unloadInfo = m_gridUnloadInfo.find(getNGrid(p.x_coord, p.y_coord)->GetGridId());
+        if (unloadInfo != m_gridUnloadInfo.end())
+        {
+            GridUnloadInfo& info = unloadInfo->second;
+            if (sWorld.GetGameTime() - info.unloadTime < time_t(i_gridExpiry / IN_MILLISECONDS * info.expiryScale))
+            {
+                info.unloadTime = 0;
+                info.expiryScale = std::min(info.expiryScale * 2, MAX_GRID_EXPIRY_SCALE);
+            }
+            else
+                { m_gridUnloadInfo.erase(unloadInfo); }
+        }
+
         getNGrid(p.x_coord, p.y_coord)->SetGridState(GRID_STATE_IDLE);
 
         // z coord
@@ -262,6 +323,8 @@ Map::EnsureGridLoadedAtEnter(const Cell& cell, Player* player)
 
 bool Map::EnsureGridLoaded(const Cell& cell)
 {
+    RegionGuard guard(*this);
+
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -308,7 +371,7 @@ bool Map::Add(Player* player)
     SendInitTransports(player);
 
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
-    player->GetViewPoint().Event_AddedToWorld(&(*grid)(cell.CellX(), cell.CellY()));
+    player->GetViewPoint().Event_AddedToWorld(&(*grid)(cell.CellX(), cell.CellY()), cell.cellPair());
     UpdateObjectVisibility(player, cell, p);
 
     sEluna->OnMapChanged(player);
@@ -352,7 +415,7 @@ Map::Add(T* obj)
 
     DEBUG_LOG("%s enters grid[%u,%u]", obj->GetGuidStr().c_str(), cell.GridX(), cell.GridY());
 
-    obj->GetViewPoint().Event_AddedToWorld(&(*grid)(cell.CellX(), cell.CellY()));
+    obj->GetViewPoint().Event_AddedToWorld(&(*grid)(cell.CellX(), cell.CellY()), cell.cellPair());
     UpdateObjectVisibility(obj, cell, p);
 }
 
@@ -373,6 +436,15 @@ void Map::MessageBroadcast(Player const* player, WorldPacket* msg, bool to_self)
         { return; }
 
     MaNGOS::MessageDeliverer post_man(*player, msg, to_self);
+
+    CameraList cameras;
+    if (GetBroadcastSubscribers(player->GetPositionX(), player->GetPositionY(), GetVisibilityDistance() + player->GetObjectBoundingRadius(), cameras))
+    {
+        for (CameraList::const_iterator itr = cameras.begin(); itr != cameras.end(); ++itr)
+            { post_man.VisitCamera(*itr); }
+        return;
+    }
+
     TypeContainerVisitor<MaNGOS::MessageDeliverer, WorldTypeMapContainer > message(post_man);
     cell.Visit(p, message, *this, *player, GetVisibilityDistance());
 }
@@ -396,6 +468,15 @@ void Map::MessageBroadcast(WorldObject const* obj, WorldPacket* msg)
     // TODO: currently on continents when Visibility.Distance.InFlight > Visibility.Distance.Continents
     // we have alot of blinking mobs because monster move packet send is broken...
     MaNGOS::ObjectMessageDeliverer post_man(msg);
+
+    CameraList cameras;
+    if (GetBroadcastSubscribers(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance() + obj->GetObjectBoundingRadius(), cameras))
+    {
+        for (CameraList::const_iterator itr = cameras.begin(); itr != cameras.end(); ++itr)
+            { post_man.VisitCamera(*itr); }
+        return;
+    }
+
     TypeContainerVisitor<MaNGOS::ObjectMessageDeliverer, WorldTypeMapContainer > message(post_man);
     cell.Visit(p, message, *this, *obj, GetVisibilityDistance());
 }
@@ -413,173 +494,949 @@ void Map::MessageDistBroadcast(Player const* player, WorldPacket* msg, float dis
     Cell cell(p);
     cell.SetNoCreate();
 
-    if (!loaded(GridPair(cell.data.Part.grid_x, cell.data.Part.grid_y)))
-        { return; }
+    if (!loaded(GridPair(cell.data.Part.grid_x, cell.data.Part.grid_y)))
+        { return; }
+
+    MaNGOS::MessageDistDeliverer post_man(*player, msg, dist, to_self, own_team_only);
+
+    CameraList cameras;
+    if (GetBroadcastSubscribers(player->GetPositionX(), player->GetPositionY(), dist + player->GetObjectBoundingRadius(), cameras))
+    {
+        for (CameraList::const_iterator itr = cameras.begin(); itr != cameras.end(); ++itr)
+            { post_man.VisitCamera(*itr); }
+        return;
+    }
+
+    TypeContainerVisitor<MaNGOS::MessageDistDeliverer , WorldTypeMapContainer > message(post_man);
+    cell.Visit(p, message, *this, *player, dist);
+}
+
+void Map::MessageDistBroadcast(WorldObject const* obj, WorldPacket* msg, float dist)
+{
+    CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
+
+    if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+    {
+        sLog.outError("Map::MessageBroadcast: Object (GUID: %u TypeId: %u) have invalid coordinates X:%f Y:%f grid cell [%u:%u]", obj->GetGUIDLow(), obj->GetTypeId(), obj->GetPositionX(), obj->GetPositionY(), p.x_coord, p.y_coord);
+        return;
+    }
+
+    Cell cell(p);
+    cell.SetNoCreate();
+
+    if (!loaded(GridPair(cell.data.Part.grid_x, cell.data.Part.grid_y)))
+        { return; }
+
+    MaNGOS::ObjectMessageDistDeliverer post_man(*obj, msg, dist);
+
+    CameraList cameras;
+    if (GetBroadcastSubscribers(obj->GetPositionX(), obj->GetPositionY(), dist + obj->GetObjectBoundingRadius(), cameras))
+    {
+        for (CameraList::const_iterator itr = cameras.begin(); itr != cameras.end(); ++itr)
+            { post_man.VisitCamera(*itr); }
+        return;
+    }
+
+    TypeContainerVisitor<MaNGOS::ObjectMessageDistDeliverer, WorldTypeMapContainer > message(post_man);
+    cell.Visit(p, message, *this, *obj, dist);
+}
+
+/**
+ * Subscription range in cells on each axis around the viewpoint cell of a camera.
+ * Broadcasts reach up to the visibility distance plus the bounding radius of the sender,
+ * the extra cell covers the latter and short distance broadcasts in maps with small visibility.
+ */
+uint32 Map::GetBroadcastRange() const
+{
+    return uint32(ceil(m_VisibleDistance / SIZE_OF_GRID_CELL)) + 1;
+}
+
+void Map::UpdateBroadcastSubscription(Camera* camera, CellPair const* cell)
+{
+    BroadcastSubscription& subscription = camera->GetBroadcastSubscription();
+
+    if (subscription.map && subscription.map != this)
+        { subscription.map->UpdateBroadcastSubscription(camera, NULL); }
+
+    uint32 range = GetBroadcastRange();
+    if (cell && subscription.map == this && subscription.cell == *cell && subscription.range == range)
+        { return; }
+
+    RegionGuard guard(*this);
+
+    // old and new subscribed areas, empty bounds for none (low > high)
+    int32 oldLowX = 0, oldLowY = 0, oldHighX = -1, oldHighY = -1;
+    if (subscription.map == this)
+    {
+        oldLowX = int32(subscription.cell.x_coord) - int32(subscription.range);
+        oldLowY = int32(subscription.cell.y_coord) - int32(subscription.range);
+        oldHighX = int32(subscription.cell.x_coord) + int32(subscription.range);
+        oldHighY = int32(subscription.cell.y_coord) + int32(subscription.range);
+    }
+
+    int32 newLowX = 0, newLowY = 0, newHighX = -1, newHighY = -1;
+    if (cell)
+    {
+        newLowX = int32(cell->x_coord) - int32(range);
+        newLowY = int32(cell->y_coord) - int32(range);
+        newHighX = int32(cell->x_coord) + int32(range);
+        newHighY = int32(cell->y_coord) + int32(range);
+    }
+
+    int32 const maxCell = int32(TOTAL_NUMBER_OF_CELLS_PER_MAP) - 1;
+
+    for (int32 x = std::max(oldLowX, 0); x <= std::min(oldHighX, maxCell); ++x)
+    {
+        for (int32 y = std::max(oldLowY, 0); y <= std::min(oldHighY, maxCell); ++y)
+        {
+            if (x >= newLowX && x <= newHighX && y >= newLowY && y <= newHighY)
+                { continue; }
+
+            BroadcastSubscribersMap::iterator itr = m_broadcastSubscribers.find(y * TOTAL_NUMBER_OF_CELLS_PER_MAP + x);
+            if (itr == m_broadcastSubscribers.end())
+                { continue; }
+
+            CameraList& cameras = itr->second;
+            CameraList::iterator camItr = std::find(cameras.begin(), cameras.end(), camera);
+            if (camItr != cameras.end())
+            {
+                *camItr = cameras.back();
+                cameras.pop_back();
+            }
+
+            if (cameras.empty())
+                { m_broadcastSubscribers.erase(itr); }
+        }
+    }
+
+    for (int32 x = std::max(newLowX, 0); x <= std::min(newHighX, maxCell); ++x)
+    {
+        for (int32 y = std::max(newLowY, 0); y <= std::min(newHighY, maxCell); ++y)
+        {
+            if (x >= oldLowX && x <= oldHighX && y >= oldLowY && y <= oldHighY)
+                { continue; }
+
+            m_broadcastSubscribers[y * TOTAL_NUMBER_OF_CELLS_PER_MAP + x].push_back(camera);
+        }
+    }
+
+    if (cell)
+    {
+        subscription.map = this;
+        subscription.cell = *cell;
+        subscription.range = range;
+    }
+    else
+        { subscription = BroadcastSubscription(); }
+}
+
+void Map::UpdateBroadcastSubscriptions()
+{
+    std::set<Camera*> cameras;
+    for (BroadcastSubscribersMap::const_iterator itr = m_broadcastSubscribers.begin(); itr != m_broadcastSubscribers.end(); ++itr)
+        { cameras.insert(itr->second.begin(), itr->second.end()); }
+
+    for (std::set<Camera*>::const_iterator itr = cameras.begin(); itr != cameras.end(); ++itr)
+    {
+        CellPair cell = (*itr)->GetBroadcastSubscription().cell;
+        UpdateBroadcastSubscription(*itr, &cell);
+    }
+}
+
+/**
+ * Collects the cameras whose viewpoint cell is in the cell area of the radius, the same cameras
+ * Cell::Visit would find in the grid. Returns false if the radius is longer than the subscription
+ * range, the caller has to visit the grid cells then.
+ */
+bool Map::GetBroadcastSubscribers(float x, float y, float radius, CameraList& cameras) const
+{
+    if (radius > GetBroadcastRange() * SIZE_OF_GRID_CELL)
+        { return false; }
+
+    CellPair p = MaNGOS::ComputeCellPair(x, y);
+    CellArea area = Cell::CalculateCellArea(x, y, std::max(radius, 0.0f));
+
+    RegionGuard guard(*this);
+
+    BroadcastSubscribersMap::const_iterator itr = m_broadcastSubscribers.find(p.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP + p.x_coord);
+    if (itr == m_broadcastSubscribers.end())
+        { return true; }
+
+    for (CameraList::const_iterator camItr = itr->second.begin(); camItr != itr->second.end(); ++camItr)
+    {
+        CellPair const& cell = (*camItr)->GetBroadcastSubscription().cell;
+        if (cell.x_coord >= area.low_bound.x_coord && cell.x_coord <= area.high_bound.x_coord &&
+            cell.y_coord >= area.low_bound.y_coord && cell.y_coord <= area.high_bound.y_coord)
+            { cameras.push_back(*camItr); }
+    }
+
+    return true;
+}
+
+bool Map::loaded(const GridPair& p) const
+{
+    return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
+}
+
+void Map::Update(const uint32& t_diff)
+{
+    PROFILE_SCOPE_ID("Map::Update", GetId());
+    ThreadActivityScope activity("Map::Update", GetId());
+    TickArena::Scope arenaScope;                            // transient containers of the update, freed at once at its end
+    uint32 updateStart = WorldTimer::getMSTime();
+
+    m_dyn_tree.update(t_diff);
+
+    // cached query results are only reused for a short time, units and models move meanwhile
+    if (m_queryCache)
+    {
+        m_queryCacheTimer += t_diff;
+        if (m_queryCacheTimer >= sWorld.getConfig(CONFIG_UINT32_MAP_QUERY_CACHE_TIME))
+        {
+            m_queryCacheTimer = 0;
+            m_queryCache->Invalidate();
+        }
+    }
+
+    // step of the periodic aura tick batches
+    m_periodicBatchWindow = sWorld.getConfig(CONFIG_UINT32_PERIODIC_AURA_BATCH_WINDOW);
+    m_periodicBatchTimer += t_diff;
+    m_periodicTickUpdate = m_periodicBatchTimer >= m_periodicBatchWindow;
+    if (m_periodicTickUpdate)
+        { m_periodicBatchTimer = m_periodicBatchWindow ? m_periodicBatchTimer % m_periodicBatchWindow : 0; }
+
+    /// update worldsessions for existing players
+    {
+        PROFILE_SCOPE_ID("Map::UpdateSessions", GetId());
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        {
+            Player* plr = m_mapRefIter->getSource();
+            if (plr && plr->IsInWorld())
+            {
+                WorldSession* pSession = plr->GetSession();
+                MapSessionFilter updater(pSession);
+
+                pSession->Update(updater);
+            }
+        }
+    }
+
+    /// update players at tick
+    {
+        PROFILE_SCOPE_ID("Map::UpdatePlayers", GetId());
+        for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+        {
+            Player* plr = m_mapRefIter->getSource();
+            if (plr && plr->IsInWorld())
+            {
+                WorldObject::UpdateHelper helper(plr);
+                helper.Update(t_diff);
+                PrefetchGridsAhead(plr);
+            }
+        }
+    }
+
+    /// wake the dead creatures due to respawn, their next update respawns them
+    ProcessRespawns();
+
+    /// spawn objects of started game events and pools
+    ProcessPendingSpawns();
+
+    /// move the transports, a move to another map is applied by ProcessDeferredActions
+    if (!m_transports.empty())
+    {
+        PROFILE_SCOPE_ID("Map::UpdateTransports", GetId());
+        for (TransportSet::const_iterator itr = m_transports.begin(); itr != m_transports.end(); ++itr)
+        {
+            WorldObject::UpdateHelper helper(*itr);
+            helper.Update(t_diff);
+        }
+    }
+
+    /// update active cells around players and active objects
+    {
+        PROFILE_SCOPE_ID("Map::UpdateCells", GetId());
+        UpdateActiveCells();
+        UpdateRegions(t_diff);
+    }
+
+    {
+        PROFILE_SCOPE_ID("Map::ProcessRelocations", GetId());
+        ProcessSplineRelocations();
+        ProcessRelocationNotifies();
+    }
+
+    // Send world objects and item update field changes
+    {
+        PROFILE_SCOPE_ID("Map::SendObjectUpdates", GetId());
+        SendObjectUpdates();
+    }
+
+    // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
+    // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
+    if (!IsBattleGround())
+    {
+        PROFILE_SCOPE_ID("Map::UpdateGridStates", GetId());
+        for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
+        {
+            NGridType* grid = i->getSource();
+            GridInfo* info = i->getSource()->getGridInfoRef();
+            ++i;                                            // The update might delete the map and we need the next map before the iterator gets invalid
+            MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
+            sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
+        }
+    }
+
+    ///- Process necessary scripts
+    if (!m_scriptSchedule.empty())
+    {
+        PROFILE_SCOPE_ID("Map::ScriptsProcess", GetId());
+        ScriptsProcess();
+    }
+
+    sEluna->OnUpdate(this, t_diff);
+
+    if (i_data)
+        { i_data->Update(t_diff); }
+
+    uint32 updateTime = WorldTimer::getMSTimeDiff(updateStart, WorldTimer::getMSTime());
+    if (m_updateTimeMetric)
+        { m_updateTimeMetric->Add(updateTime); }
+
+    UpdateVisibilityScale(updateTime, t_diff);
+}
+
+/**
+ * Shrink the visibility distance while the map is overloaded and restore it afterwards
+ *
+ * The map counts as overloaded when its average update time or the largest number of players and
+ * active objects seeing one cell exceed the Visibility.Dynamic thresholds. The scale is changed in
+ * steps at most every VISIBILITY_SCALE_INTERVAL, and only grows back below 3/4 of the thresholds.
+ */
+void Map::UpdateVisibilityScale(uint32 updateTime, uint32 diff)
+{
+    static const uint32 VISIBILITY_SCALE_INTERVAL = 5 * IN_MILLISECONDS;
+    static const float VISIBILITY_SCALE_STEP = 0.1f;
+
+    m_visibilityScaleUpdateTime += updateTime;
+    ++m_visibilityScaleUpdates;
+
+    m_visibilityScaleTimer += diff;
+    if (m_visibilityScaleTimer < VISIBILITY_SCALE_INTERVAL)
+        { return; }
+
+    uint32 avgUpdateTime = m_visibilityScaleUpdateTime / m_visibilityScaleUpdates;
+    m_visibilityScaleTimer = 0;
+    m_visibilityScaleUpdateTime = 0;
+    m_visibilityScaleUpdates = 0;
+
+    uint32 maxUpdateTime = sWorld.getConfig(CONFIG_UINT32_VISIBILITY_DYNAMIC_UPDATE_TIME);
+    uint32 maxCrowd = sWorld.getConfig(CONFIG_UINT32_VISIBILITY_DYNAMIC_CROWD_SIZE);
+    float minScale = sWorld.getConfig(CONFIG_FLOAT_VISIBILITY_DYNAMIC_MIN_SCALE);
+
+    uint32 crowd = 0;
+    if (maxCrowd)
+    {
+        for (ActiveCellsMap::const_iterator itr = m_activeCells.begin(); itr != m_activeCells.end(); ++itr)
+            { crowd = std::max(crowd, itr->second); }
+    }
+
+    bool overloaded = (maxUpdateTime && avgUpdateTime > maxUpdateTime) || (maxCrowd && crowd > maxCrowd);
+    bool relieved = (!maxUpdateTime || avgUpdateTime * 4 < maxUpdateTime * 3) && (!maxCrowd || crowd * 4 < maxCrowd * 3);
+
+    float scale = m_visibilityScale;
+    if (overloaded)
+        { scale = std::max(minScale, scale - VISIBILITY_SCALE_STEP); }
+    else if (relieved)
+        { scale = std::min(1.0f, scale + VISIBILITY_SCALE_STEP); }
+
+    if (scale == m_visibilityScale)
+        { return; }
+
+    DEBUG_LOG("Map %u instance %u: visibility distance %.1f -> %.1f (update time %u ms, crowd %u)",
+              GetId(), GetInstanceId(), GetVisibilityDistance(), m_VisibleDistance * scale, avgUpdateTime, crowd);
+    m_visibilityScale = scale;
+}
+
+void Map::AddToSpatialHash(Unit* unit)
+{
+    if (!m_spatialHash)
+        { return; }
+
+    RegionGuard guard(*this);
+    m_spatialHash->Insert(unit);
+}
+
+void Map::RemoveFromSpatialHash(Unit* unit)
+{
+    if (!m_spatialHash)
+        { return; }
+
+    RegionGuard guard(*this);
+    m_spatialHash->Remove(unit);
+}
+
+void Map::RelocateInSpatialHash(Unit* unit)
+{
+    if (!m_spatialHash)
+        { return; }
+
+    RegionGuard guard(*this);
+    m_spatialHash->Relocate(unit);
+}
+
+/// Queue terrain loading of the not yet loaded grids a moving player reaches within Terrain.PrefetchTime
+void Map::PrefetchGridsAhead(Player const* player)
+{
+    TerrainLoader& loader = sMapMgr.GetTerrainLoader();
+    uint32 prefetchTime = sWorld.getConfig(CONFIG_UINT32_TERRAIN_PREFETCH_TIME);
+    if (!loader.IsActive() || !prefetchTime)
+        { return; }
+
+    float x, y;
+    if (player->IsTaxiFlying() && !player->movespline->Finalized())
+    {
+        // follow the flight path
+        G3D::Vector3 ahead = player->movespline->ComputePositionAhead(int32(prefetchTime));
+        x = ahead.x;
+        y = ahead.y;
+    }
+    else if (player->isMoving())
+    {
+        float dist = player->GetSpeed(MOVE_RUN) * prefetchTime / IN_MILLISECONDS;
+        x = player->GetPositionX() + dist * cos(player->GetOrientation());
+        y = player->GetPositionY() + dist * sin(player->GetOrientation());
+    }
+    else
+        { return; }
+
+    // check the grids along the way in half grid steps
+    float dx = x - player->GetPositionX();
+    float dy = y - player->GetPositionY();
+    uint32 steps = uint32(sqrt(dx * dx + dy * dy) / (SIZE_OF_GRIDS / 2)) + 1;
+
+    for (uint32 i = 1; i <= steps; ++i)
+    {
+        float px = player->GetPositionX() + dx * i / steps;
+        float py = player->GetPositionY() + dy * i / steps;
+        if (!MaNGOS::IsValidMapCoord(px, py))
+            { break; }
+
+        GridPair p = MaNGOS::ComputeGridPair(px, py);
+        uint32 gx = (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord;
+        uint32 gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
+        if (!m_bLoadedGrids[gx][gy] && !m_TerrainData->HasGridData(gx, gy))
+            { loader.Prefetch(m_TerrainData, gx, gy); }
+    }
+}
+
+void Map::UpdateActiveCells()
+{
+    ++m_activeCellsTick;
+
+    // the player iterator is stored in the map object
+    // to make sure calls to Map::Remove don't invalidate it
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* plr = m_mapRefIter->getSource();
+
+        if (!plr->IsInWorld() || !plr->IsPositionValid())
+            { continue; }
+
+        UpdateActiveCellAnchor(plr);
+    }
+
+    // non-player active objects
+    for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end(); ++m_activeNonPlayersIter)
+    {
+        WorldObject* obj = *m_activeNonPlayersIter;
+
+        // skip not in world
+        if (!obj->IsInWorld() || !obj->IsPositionValid())
+            { continue; }
+
+        UpdateActiveCellAnchor(obj);
+    }
+
+    // drop anchors that left the map or world since last tick, the pointers aren't valid anymore
+    for (ActiveCellAnchorsMap::iterator itr = m_activeCellAnchors.begin(); itr != m_activeCellAnchors.end();)
+    {
+        if (itr->second.tick != m_activeCellsTick)
+        {
+            DereferenceCellArea(itr->second.area);
+            if (itr->second.hasNearArea)
+                { DereferenceNearCellArea(itr->second.nearArea); }
+            m_activeCellAnchors.erase(itr++);
+        }
+        else
+            { ++itr; }
+    }
+}
+
+void Map::UpdateActiveCellAnchor(WorldObject const* obj)
+{
+    // lets update mobs/objects in ALL visible cells around player!
+    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+
+    // only players keep the creatures around them at full update rate
+    float nearDistance = obj->GetTypeId() == TYPEID_PLAYER ? sWorld.getConfig(CONFIG_FLOAT_CREATURE_IDLE_UPDATE_DISTANCE) : 0.0f;
+    bool hasNearArea = nearDistance > 0.0f;
+    CellArea nearArea;
+    if (hasNearArea)
+        { nearArea = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), nearDistance); }
+
+    ActiveCellAnchorsMap::iterator itr = m_activeCellAnchors.find(obj);
+    if (itr == m_activeCellAnchors.end())
+    {
+        ReferenceCellArea(area);
+        if (hasNearArea)
+            { ReferenceNearCellArea(nearArea); }
+
+        ActiveCellAnchor& anchor = m_activeCellAnchors[obj];
+        anchor.area = area;
+        anchor.tick = m_activeCellsTick;
+        anchor.nearArea = nearArea;
+        anchor.hasNearArea = hasNearArea;
+        return;
+    }
+
+    ActiveCellAnchor& anchor = itr->second;
+    anchor.tick = m_activeCellsTick;
+
+    // reference the new areas first, so cells shared by both areas stay active
+    if (anchor.area != area)
+    {
+        ReferenceCellArea(area);
+        DereferenceCellArea(anchor.area);
+        anchor.area = area;
+    }
+
+    if (anchor.hasNearArea != hasNearArea || (hasNearArea && anchor.nearArea != nearArea))
+    {
+        if (hasNearArea)
+            { ReferenceNearCellArea(nearArea); }
+        if (anchor.hasNearArea)
+            { DereferenceNearCellArea(anchor.nearArea); }
+        anchor.nearArea = nearArea;
+        anchor.hasNearArea = hasNearArea;
+    }
+}
+
+void Map::ReferenceCellArea(CellArea const& area)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+            if (++m_activeCells[cell_id] == 1)
+                { m_regionCells[GetRegionIdOfCell(x, y)].push_back(cell_id); }
+        }
+    }
+}
+
+void Map::DereferenceCellArea(CellArea const& area)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+
+            ActiveCellsMap::iterator itr = m_activeCells.find(cell_id);
+            MANGOS_ASSERT(itr != m_activeCells.end());
+            if (--itr->second > 0)
+                { continue; }
+
+            m_activeCells.erase(itr);
+
+            std::vector<uint32>& cells = m_regionCells[GetRegionIdOfCell(x, y)];
+            std::vector<uint32>::iterator cellItr = std::find(cells.begin(), cells.end(), cell_id);
+            MANGOS_ASSERT(cellItr != cells.end());
+            *cellItr = cells.back();
+            cells.pop_back();
+        }
+    }
+}
+
+void Map::ReferenceNearCellArea(CellArea const& area)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+            { ++m_nearCells[(y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x]; }
+    }
+}
+
+void Map::DereferenceNearCellArea(CellArea const& area)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            ActiveCellsMap::iterator itr = m_nearCells.find((y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x);
+            MANGOS_ASSERT(itr != m_nearCells.end());
+            if (--itr->second == 0)
+                { m_nearCells.erase(itr); }
+        }
+    }
+}
+
+uint32 Map::GetRegionIdOfCell(uint32 x, uint32 y) const
+{
+    if (!m_regionSize)
+        { return 0; }
+
+    uint32 regionX = x / MAX_NUMBER_OF_CELLS / m_regionSize;
+    uint32 regionY = y / MAX_NUMBER_OF_CELLS / m_regionSize;
+    return regionY * GetRegionsPerAxis() + regionX;
+}
+
+/**
+ * Update all active cells of the tick
+ *
+ * Split continents are updated in four passes by checkerboard color of the regions. Regions of the same
+ * color never share a border, so objects moving out of their region or notifying their surrounding only
+ * reach regions that are not updated at the same time. Map wide containers are guarded by m_regionLock
+ * while the passes run. Threat and hostile list changes reaching out of a region are applied after its pass.
+ */
+void Map::UpdateRegions(uint32 diff)
+{
+    MapUpdater& mapUpdater = sMapMgr.GetMapUpdater();
+
+    if (!m_regionSize || !mapUpdater.IsActive())
+    {
+        for (uint32 regionId = 0; regionId < m_regionCells.size(); ++regionId)
+        {
+            if (!m_regionCells[regionId].empty())
+                { UpdateRegion(regionId, diff); }
+        }
+        return;
+    }
+
+    uint32 regionsPerAxis = GetRegionsPerAxis();
+
+    for (uint32 color = 0; color < 4; ++color)
+    {
+        MapUpdater::Batch batch;
+
+        m_regionUpdateRunning = true;
+
+        for (uint32 regionY = color >> 1; regionY < regionsPerAxis; regionY += 2)
+        {
+            for (uint32 regionX = color & 1; regionX < regionsPerAxis; regionX += 2)
+            {
+                uint32 regionId = regionY * regionsPerAxis + regionX;
+                if (!m_regionCells[regionId].empty())
+                    { mapUpdater.ScheduleRegionUpdate(*this, regionId, diff, batch); }
+            }
+        }
+
+        mapUpdater.Wait(batch);
+
+        m_regionUpdateRunning = false;
+
+        ProcessThreatActions();
+    }
+}
+
+void Map::UpdateRegion(uint32 regionId, uint32 diff)
+{
+    PROFILE_SCOPE_ID("Map::UpdateRegion", GetId());
+    ThreadActivityScope activity("Map::UpdateRegion", GetId());
+    TickArena::Scope arenaScope;                            // nested in the Map::Update scope if run by the waiting thread
+    MANGOS_ASSERT(regionId < m_regionCells.size());
+
+    uint32 startTime = WorldTimer::getMSTime();
+
+    s_updatedRegion->map = this;
+    s_updatedRegion->regionId = regionId;
+
+    MaNGOS::ObjectUpdater updater(diff);
+    // for creature
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    // for pets
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+    // creatures in cells without a player nearby are updated at the idle rate
+    uint32 idleRate = sWorld.getConfig(CONFIG_UINT32_CREATURE_IDLE_UPDATE_RATE);
+    bool idleTiers = idleRate > 1 && sWorld.getConfig(CONFIG_FLOAT_CREATURE_IDLE_UPDATE_DISTANCE) > 0.0f;
+    MaNGOS::ObjectUpdater idleUpdater(diff, idleRate);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > idle_grid_object_update(idleUpdater);
+
+    std::vector<uint32> const& cells = m_regionCells[regionId];
+    for (std::vector<uint32>::const_iterator itr = cells.begin(); itr != cells.end(); ++itr)
+    {
+        CellPair pair(*itr % TOTAL_NUMBER_OF_CELLS_PER_MAP, *itr / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        Cell cell(pair);
+        cell.SetNoCreate();
+        if (idleTiers && m_nearCells.find(*itr) == m_nearCells.end())
+            { Visit(cell, idle_grid_object_update); }
+        else
+            { Visit(cell, grid_object_update); }
+        Visit(cell, world_object_update);
+    }
+
+    s_updatedRegion->map = NULL;
+
+    m_regionUpdateTime[regionId] = WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime());
+}
+
+/**
+ * Check if the threat and hostile lists of the object can be changed by the calling thread
+ *
+ * While a region pass runs, this is true only for objects less than half a region away from the region
+ * updated by the thread. These areas of the regions of one pass don't overlap, so the lists of a unit are
+ * changed by a single thread. Changes involving units out of the area are queued by DeferThreatAction.
+ */
+bool Map::IsNearUpdatedRegion(WorldObject const& obj) const
+{
+    if (!m_regionUpdateRunning)
+        { return true; }
+
+    UpdatedRegion const* updated = s_updatedRegion.ts_object();
+    if (!updated || updated->map != this)
+        { return false; }
+
+    CellPair cell = MaNGOS::ComputeCellPair(obj.GetPositionX(), obj.GetPositionY());
+    int32 gridX = int32(cell.x_coord / MAX_NUMBER_OF_CELLS);
+    int32 gridY = int32(cell.y_coord / MAX_NUMBER_OF_CELLS);
 
-    MaNGOS::MessageDistDeliverer post_man(*player, msg, dist, to_self, own_team_only);
-    TypeContainerVisitor<MaNGOS::MessageDistDeliverer , WorldTypeMapContainer > message(post_man);
-    cell.Visit(p, message, *this, *player, dist);
+    uint32 regionsPerAxis = GetRegionsPerAxis();
+    int32 size = int32(m_regionSize);
+    int32 margin = (size - 1) / 2;                          // regions of a pass are one region apart
+    int32 lowX = int32(updated->regionId % regionsPerAxis) * size - margin;
+    int32 lowY = int32(updated->regionId / regionsPerAxis) * size - margin;
+    return gridX >= lowX && gridX < lowX + size + 2 * margin &&
+           gridY >= lowY && gridY < lowY + size + 2 * margin;
 }
 
-void Map::MessageDistBroadcast(WorldObject const* obj, WorldPacket* msg, float dist)
+void Map::DeferThreatAction(MapThreatAction const& action)
 {
-    CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
+    RegionGuard guard(*this);
+    m_threatActions.push_back(action);
+}
 
-    if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+void Map::ProcessThreatActions()
+{
+    if (m_threatActions.empty())
+        { return; }
+
+    ThreatActionList actions;
+    actions.swap(m_threatActions);
+
+    for (ThreatActionList::const_iterator itr = actions.begin(); itr != actions.end(); ++itr)
     {
-        sLog.outError("Map::MessageBroadcast: Object (GUID: %u TypeId: %u) have invalid coordinates X:%f Y:%f grid cell [%u:%u]", obj->GetGUIDLow(), obj->GetTypeId(), obj->GetPositionX(), obj->GetPositionY(), p.x_coord, p.y_coord);
-        return;
+        // the units are still in world, objects are removed after the map update
+        Unit* owner = GetUnit(itr->owner);
+        Unit* other = !itr->other.IsEmpty() ? GetUnit(itr->other) : NULL;
+        if (!owner || (!itr->other.IsEmpty() && !other))
+            { continue; }
+
+        switch (itr->type)
+        {
+            case MAP_THREAT_ADD:
+                owner->GetThreatManager().addCalculatedThreat(other, itr->threat);
+                break;
+            case MAP_THREAT_MODIFY_PERCENT:
+                owner->GetThreatManager().modifyThreatPercent(other, itr->param);
+                break;
+            case MAP_THREAT_CLEAR:
+                owner->GetThreatManager().clearReferences();
+                break;
+            case MAP_THREAT_TAUNT_APPLY:
+                owner->GetThreatManager().tauntApply(other);
+                break;
+            case MAP_THREAT_TAUNT_FADE_OUT:
+                owner->GetThreatManager().tauntFadeOut(other);
+                break;
+            case MAP_HOSTILE_ASSIST:
+                owner->GetHostileRefManager().threatAssist(other, itr->threat, itr->spell, itr->param != 0);
+                break;
+            case MAP_HOSTILE_ADD_PERCENT:
+                owner->GetHostileRefManager().addThreatPercent(itr->param);
+                break;
+            case MAP_HOSTILE_SET_ONLINE:
+                if (other)
+                    { owner->GetHostileRefManager().setOnlineOfflineState(other, itr->param != 0); }
+                else
+                    { owner->GetHostileRefManager().setOnlineOfflineState(itr->param != 0); }
+                break;
+            case MAP_HOSTILE_UPDATE_TABLES:
+                owner->GetHostileRefManager().updateThreatTables();
+                break;
+            case MAP_HOSTILE_DELETE:
+                owner->GetHostileRefManager().deleteReferences();
+                break;
+            case MAP_HOSTILE_DELETE_FACTION:
+                owner->GetHostileRefManager().deleteReferencesForFaction(uint32(itr->param));
+                break;
+            case MAP_HOSTILE_DELETE_ONE:
+                owner->GetHostileRefManager().deleteReference(other);
+                break;
+        }
     }
+}
 
-    Cell cell(p);
-    cell.SetNoCreate();
+void Map::DeferTeleport(Player* player, WorldLocation const& dest, uint32 options, AreaTrigger const* at)
+{
+    RegionGuard guard(*this);
+    m_deferredActions.push_back(MapDeferredAction(MAP_DEFERRED_TELEPORT, player->GetObjectGuid(), dest, options, at));
+}
 
-    if (!loaded(GridPair(cell.data.Part.grid_x, cell.data.Part.grid_y)))
-        { return; }
+void Map::DeferTransportMove(Transport* transport, WorldLocation const& dest)
+{
+    RegionGuard guard(*this);
+    m_deferredActions.push_back(MapDeferredAction(MAP_DEFERRED_TRANSPORT_MOVE, transport->GetObjectGuid(), dest, 0, NULL));
+}
 
-    MaNGOS::ObjectMessageDistDeliverer post_man(*obj, msg, dist);
-    TypeContainerVisitor<MaNGOS::ObjectMessageDistDeliverer, WorldTypeMapContainer > message(post_man);
-    cell.Visit(p, message, *this, *obj, dist);
+void Map::AddRelocationNotify(Unit* unit)
+{
+    RegionGuard guard(*this);
+    m_relocationNotifies.push_back(unit->GetObjectGuid());
+    ++m_visibilityStats.relocationNotifiesScheduled;
 }
 
-bool Map::loaded(const GridPair& p) const
+WanderArea const* Map::GetWanderArea(uint32 spawnGuid) const
 {
-    return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
+    RegionGuard guard(*this);
+    WanderAreaMap::const_iterator itr = m_wanderAreas.find(spawnGuid);
+    return itr != m_wanderAreas.end() ? &itr->second : NULL;
 }
 
-void Map::Update(const uint32& t_diff)
+WanderArea const& Map::AddWanderArea(uint32 spawnGuid, WanderArea const& area)
 {
-    m_dyn_tree.update(t_diff);
+    // areas are never erased, so the references stay valid while the map grows
+    RegionGuard guard(*this);
+    return m_wanderAreas.insert(WanderAreaMap::value_type(spawnGuid, area)).first->second;
+}
 
-    /// update worldsessions for existing players
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
-    {
-        Player* plr = m_mapRefIter->getSource();
-        if (plr && plr->IsInWorld())
-        {
-            WorldSession* pSession = plr->GetSession();
-            MapSessionFilter updater(pSession);
+void Map::AddSplineRelocation(Creature* creature)
+{
+    RegionGuard guard(*this);
+    m_splineRelocations.push_back(creature->GetObjectGuid());
+}
 
-            pSession->Update(updater);
-        }
-    }
+/**
+ * Relocate the creatures whose spline position update was due in this tick
+ *
+ * The positions are computed here from the state the splines have at the end of the region
+ * updates, so the region threads neither evaluate splines nor contend for the cell relocation.
+ * A spline finalized in between was already stopped at its current position and is skipped.
+ */
+void Map::ProcessSplineRelocations()
+{
+    if (m_splineRelocations.empty())
+        { return; }
 
-    /// update players at tick
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    GuidVector relocations;
+    relocations.swap(m_splineRelocations);
+
+    for (GuidVector::const_iterator itr = relocations.begin(); itr != relocations.end(); ++itr)
     {
-        Player* plr = m_mapRefIter->getSource();
-        if (plr && plr->IsInWorld())
-        {
-            WorldObject::UpdateHelper helper(plr);
-            helper.Update(t_diff);
-        }
+        Creature* creature = GetAnyTypeCreature(*itr);
+        if (!creature || !creature->IsInWorld() || creature->movespline->Finalized())
+            { continue; }
+
+        Movement::Location loc = creature->movespline->ComputePosition();
+        CreatureRelocation(creature, loc.x, loc.y, loc.z, loc.orientation);
     }
+}
 
-    /// update active cells around players and active objects
-    resetMarkedCells();
+/**
+ * Run the AI relocation notifies collected in this tick
+ *
+ * Instead of every mover visiting its own cell area, every cell in the area of any mover is visited
+ * once and its objects are tested against all movers whose area contains the cell.
+ */
+void Map::ProcessRelocationNotifies()
+{
+    if (m_relocationNotifies.empty())
+        { return; }
 
-    MaNGOS::ObjectUpdater updater(t_diff);
-    // for creature
-    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
-    // for pets
-    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+    GuidVector notifies;
+    notifies.swap(m_relocationNotifies);
 
-    // the player iterator is stored in the map object
-    // to make sure calls to Map::Remove don't invalidate it
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
-    {
-        Player* plr = m_mapRefIter->getSource();
+    float radius = MAX_CREATURE_ATTACK_RADIUS * sWorld.getConfig(CONFIG_FLOAT_RATE_CREATURE_AGGRO);
 
-        if (!plr->IsInWorld() || !plr->IsPositionValid())
+    typedef UNORDERED_MAP<uint32 /*cell id*/, std::vector<Unit*> > CellMoversMap;
+    CellMoversMap cellMovers;
+
+    for (GuidVector::const_iterator itr = notifies.begin(); itr != notifies.end(); ++itr)
+    {
+        // can be already removed from map
+        Unit* mover = GetUnit(*itr);
+        if (!mover || !mover->IsInWorld())
             { continue; }
 
-        // lets update mobs/objects in ALL visible cells around player!
-        CellArea area = Cell::CalculateCellArea(plr->GetPositionX(), plr->GetPositionY(), GetVisibilityDistance());
+        mover->_SetAINotifyScheduled(false);
+        ++m_visibilityStats.relocationNotifiesExecuted;
 
+        CellArea area = Cell::CalculateCellArea(mover->GetPositionX(), mover->GetPositionY(), radius + mover->GetObjectBoundingRadius());
         for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
         {
             for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
-            {
-                // marked cells are those that have been visited
-                // don't visit the same cell twice
-                uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                if (!isCellMarked(cell_id))
-                {
-                    markCell(cell_id);
-                    CellPair pair(x, y);
-                    Cell cell(pair);
-                    cell.SetNoCreate();
-                    Visit(cell, grid_object_update);
-                    Visit(cell, world_object_update);
-                }
-            }
+                { cellMovers[(y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x].push_back(mover); }
         }
     }
 
-    // non-player active objects
-    if (!m_activeNonPlayers.empty())
+    for (CellMoversMap::const_iterator itr = cellMovers.begin(); itr != cellMovers.end(); ++itr)
     {
-        for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
-        {
-            // skip not in world
-            WorldObject* obj = *m_activeNonPlayersIter;
+        MaNGOS::RelocationBatchNotifier notifier(itr->second, radius);
+        TypeContainerVisitor<MaNGOS::RelocationBatchNotifier, GridTypeMapContainer > grid_notifier(notifier);
+        TypeContainerVisitor<MaNGOS::RelocationBatchNotifier, WorldTypeMapContainer > world_notifier(notifier);
+
+        CellPair pair(itr->first % TOTAL_NUMBER_OF_CELLS_PER_MAP, itr->first / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+        Cell cell(pair);
+        cell.SetNoCreate();
+        Visit(cell, grid_notifier);
+        Visit(cell, world_notifier);
+    }
+}
 
-            // step before processing, in this case if Map::Remove remove next object we correctly
-            // step to next-next, and if we step to end() then newly added objects can wait next update.
-            ++m_activeNonPlayersIter;
+/// Apply the actions requested during the last update, returns the number of actions
+uint32 Map::ProcessDeferredActions()
+{
+    if (m_deferredActions.empty())
+        { return 0; }
 
-            if (!obj->IsInWorld() || !obj->IsPositionValid())
-                { continue; }
+    DeferredActionList actions;
+    actions.swap(m_deferredActions);
 
-            // lets update mobs/objects in ALL visible cells around player!
-            CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+    for (DeferredActionList::const_iterator itr = actions.begin(); itr != actions.end(); ++itr)
+    {
+        switch (itr->type)
+        {
+            case MAP_DEFERRED_TELEPORT:
+            {
+                // player can be already gone by an earlier teleport or logout
+                Player* player = GetPlayer(itr->guid);
+                if (!player)
+                {
+                    DEBUG_LOG("Map::ProcessDeferredActions: %s left map %u before deferred teleport to map %u", itr->guid.GetString().c_str(), GetId(), itr->dest.mapid);
+                    break;
+                }
 
-            for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+                player->TeleportTo(itr->dest.mapid, itr->dest.coord_x, itr->dest.coord_y, itr->dest.coord_z, itr->dest.orientation, itr->options, itr->at);
+                break;
+            }
+            case MAP_DEFERRED_TRANSPORT_MOVE:
             {
-                for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+                for (TransportSet::const_iterator tItr = m_transports.begin(); tItr != m_transports.end(); ++tItr)
                 {
-                    // marked cells are those that have been visited
-                    // don't visit the same cell twice
-                    uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                    if (!isCellMarked(cell_id))
+                    if ((*tItr)->GetObjectGuid() == itr->guid)
                     {
-                        markCell(cell_id);
-                        CellPair pair(x, y);
-                        Cell cell(pair);
-                        cell.SetNoCreate();
-                        Visit(cell, grid_object_update);
-                        Visit(cell, world_object_update);
+                        // changes m_transports, the loop ends here
+                        (*tItr)->TeleportTransport(itr->dest.mapid, itr->dest.coord_x, itr->dest.coord_y, itr->dest.coord_z);
+                        break;
                     }
                 }
+                break;
             }
         }
     }
 
-    // Send world objects and item update field changes
-    SendObjectUpdates();
-
-    // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
-    // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
-    if (!IsBattleGround())
-    {
-        for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
-        {
-            NGridType* grid = i->getSource();
-            GridInfo* info = i->getSource()->getGridInfoRef();
-            ++i;                                            // The update might delete the map and we need the next map before the iterator gets invalid
-            MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
-            sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
-        }
-    }
-
-    ///- Process necessary scripts
-    if (!m_scriptSchedule.empty())
-        { ScriptsProcess(); }
-
-    sEluna->OnUpdate(this, t_diff);
-
-    if (i_data)
-        { i_data->Update(t_diff); }
+    return actions.size();
 }
 
 void Map::Remove(Player* player, bool remove)
@@ -683,6 +1540,9 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
 {
     MANGOS_ASSERT(player);
 
+    MapStatsTimer timer(m_visibilityStats.playerRelocationTime);
+    ++m_visibilityStats.playerRelocations;
+
     CellPair old_val = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
     CellPair new_val = MaNGOS::ComputeCellPair(x, y);
 
@@ -704,7 +1564,7 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
             { EnsureGridLoadedAtEnter(new_cell, player); }
 
         NGridType* newGrid = getNGrid(new_cell.GridX(), new_cell.GridY());
-        player->GetViewPoint().Event_GridChanged(&(*newGrid)(new_cell.CellX(), new_cell.CellY()));
+        player->GetViewPoint().Event_GridChanged(&(*newGrid)(new_cell.CellX(), new_cell.CellY()), new_cell.cellPair());
     }
 
     player->OnRelocated();
@@ -721,6 +1581,9 @@ void Map::CreatureRelocation(Creature* creature, float x, float y, float z, floa
 {
     MANGOS_ASSERT(CheckGridIntegrity(creature, false));
 
+    MapStatsTimer timer(m_visibilityStats.creatureRelocationTime);
+    ++m_visibilityStats.creatureRelocations;
+
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
 
     // do move or do move to respawn or remove creature if previous all fail
@@ -761,7 +1624,7 @@ bool Map::CreatureCellRelocation(Creature* c, Cell new_cell)
         NGridType* newGrid = getNGrid(new_cell.GridX(), new_cell.GridY());
         RemoveFromGrid(c, oldGrid, old_cell);
         AddToGrid(c, newGrid, new_cell);
-        c->GetViewPoint().Event_GridChanged(&(*newGrid)(new_cell.CellX(), new_cell.CellY()));
+        c->GetViewPoint().Event_GridChanged(&(*newGrid)(new_cell.CellX(), new_cell.CellY()), new_cell.cellPair());
     }
     return true;
 }
@@ -814,8 +1677,13 @@ bool Map::UnloadGrid(const uint32& x, const uint32& y, bool pForce)
         RemoveAllObjectsInRemoveList();
 
         unloader.UnloadN();
+
+        if (!pForce)
+            { m_gridUnloadInfo[grid->GetGridId()].unloadTime = sWorld.GetGameTime(); }
+
         delete getNGrid(x, y);
         setNGrid(NULL, x, y);
+        --m_gridCount;
     }
 
     int gx = (MAX_NUMBER_OF_GRIDS - 1) - x;
@@ -833,6 +1701,12 @@ bool Map::UnloadGrid(const uint32& x, const uint32& y, bool pForce)
     return true;
 }
 
+void Map::ResetGridUnloadExpiry(NGridType& grid) const
+{
+    GridUnloadInfoMap::const_iterator unloadInfo = m_gridUnloadInfo.find(grid.GetGridId());
+    ResetGridExpiry(grid, unloadInfo != m_gridUnloadInfo.end() ? float(unloadInfo->second.expiryScale) : 1.0f);
+}
+
 void Map::UnloadAll(bool pForce)
 {
     for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
@@ -985,6 +1859,7 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
 
+    RegionGuard guard(*this);
     i_objectsToRemove.insert(obj);
     // DEBUG_LOG("Object (GUID: %u TypeId: %u ) added to removing list.",obj->GetGUIDLow(),obj->GetTypeId());
 }
@@ -1086,6 +1961,8 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    RegionGuard guard(*this);
+
     m_activeNonPlayers.insert(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
@@ -1114,6 +1991,8 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive(WorldObject* obj)
 {
+    RegionGuard guard(*this);
+
     // Map::Update for active object in proccess
     if (m_activeNonPlayersIter != m_activeNonPlayers.end())
     {
@@ -1226,7 +2105,7 @@ WorldPersistentState* WorldMap::GetPersistanceState() const
 
 DungeonMap::DungeonMap(uint32 id, time_t expiry, uint32 InstanceId)
     : Map(id, expiry, InstanceId),
-      m_resetAfterUnload(false), m_unloadWhenEmpty(false)
+      m_resetAfterUnload(false), m_unloadWhenEmpty(false), m_emptyTime(0)
 {
     MANGOS_ASSERT(i_mapEntry->IsDungeon());
 
@@ -1359,6 +2238,8 @@ bool DungeonMap::Add(Player* player)
     m_resetAfterUnload = false;
     m_unloadWhenEmpty = false;
 
+    WakeUp();
+
     // this will acquire the same mutex so it can not be in the previous block
     Map::Add(player);
 
@@ -1368,6 +2249,43 @@ bool DungeonMap::Add(Player* player)
 void DungeonMap::Update(const uint32& t_diff)
 {
     Map::Update(t_diff);
+
+    uint32 hibernateDelay = sWorld.getConfig(CONFIG_UINT32_INSTANCE_HIBERNATE_DELAY);
+    if (!hibernateDelay || HavePlayers())
+    {
+        m_emptyTime = 0;
+        return;
+    }
+
+    m_emptyTime += t_diff;
+
+    // active objects and queued scripts keep the instance running until they are done
+    if (m_emptyTime >= hibernateDelay && m_activeNonPlayers.empty() && !HasScheduledScripts())
+        { Hibernate(); }
+}
+
+/*
+    Stop updating the empty instance, grids and objects stay loaded as they are.
+    The unload timer keeps running in MapManager, so the instance is still unloaded after Instance.UnloadDelay.
+*/
+void DungeonMap::Hibernate()
+{
+    if (m_hibernating)
+        { return; }
+
+    DETAIL_LOG("MAP: Instance '%u' of map '%s' is empty, hibernating", GetInstanceId(), GetMapName());
+    m_hibernating = true;
+}
+
+void DungeonMap::WakeUp()
+{
+    m_emptyTime = 0;
+
+    if (!m_hibernating)
+        { return; }
+
+    DETAIL_LOG("MAP: Instance '%u' of map '%s' wakes up", GetInstanceId(), GetMapName());
+    m_hibernating = false;
 }
 
 void DungeonMap::Remove(Player* player, bool remove)
@@ -1605,30 +2523,21 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
     ObjectGuid targetGuid = target ? target->GetObjectGuid() : ObjectGuid();
     ObjectGuid ownerGuid  = source->isType(TYPEMASK_ITEM) ? ((Item*)source)->GetOwnerGuid() : ObjectGuid();
 
+    RegionGuard guard(*this);
+
     if (execParams)                                         // Check if the execution should be uniquely
     {
-        for (ScriptScheduleMap::const_iterator searchItr = m_scriptSchedule.begin(); searchItr != m_scriptSchedule.end(); ++searchItr)
+        if (m_scriptSchedule.IsScheduled(scripts.first, id,
+                                         execParams & SCRIPT_EXEC_PARAM_UNIQUE_BY_SOURCE ? sourceGuid : ObjectGuid(),
+                                         execParams & SCRIPT_EXEC_PARAM_UNIQUE_BY_TARGET ? targetGuid : ObjectGuid(), ownerGuid))
         {
-            if (searchItr->second.IsSameScript(scripts.first, id,
-                                               execParams & SCRIPT_EXEC_PARAM_UNIQUE_BY_SOURCE ? sourceGuid : ObjectGuid(),
-                                               execParams & SCRIPT_EXEC_PARAM_UNIQUE_BY_TARGET ? targetGuid : ObjectGuid(), ownerGuid))
-            {
-                DEBUG_LOG("DB-SCRIPTS: Process table `%s` id %u. Skip script as script already started for source %s, target %s - ScriptsStartParams %u", scripts.first, id, sourceGuid.GetString().c_str(), targetGuid.GetString().c_str(), execParams);
-                return true;
-            }
+            DEBUG_LOG("DB-SCRIPTS: Process table `%s` id %u. Skip script as script already started for source %s, target %s - ScriptsStartParams %u", scripts.first, id, sourceGuid.GetString().c_str(), targetGuid.GetString().c_str(), execParams);
+            return true;
         }
     }
 
-    ///- Schedule script execution for all scripts in the script map
-    ScriptMap const* s2 = &(s->second);
-    for (ScriptMap::const_iterator iter = s2->begin(); iter != s2->end(); ++iter)
-    {
-        ScriptAction sa(scripts.first, this, sourceGuid, targetGuid, ownerGuid, &iter->second);
-
-        m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + iter->first), sa));
-
-        sScriptMgr.IncreaseScheduledScriptsCount();
-    }
+    ///- Schedule script execution for all scripts in the script map, the steps are referenced, not copied
+    m_scriptSchedule.Schedule(scripts.first, s->second, sourceGuid, targetGuid, ownerGuid, sWorld.GetGameTime());
 
     return true;
 }
@@ -1642,54 +2551,125 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
     ObjectGuid targetGuid = target ? target->GetObjectGuid() : ObjectGuid();
     ObjectGuid ownerGuid  = source->isType(TYPEMASK_ITEM) ? ((Item*)source)->GetOwnerGuid() : ObjectGuid();
 
-    ScriptAction sa("Internal Activate Command used for spell", this, sourceGuid, targetGuid, ownerGuid, &script);
-
-    m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + delay), sa));
+    RegionGuard guard(*this);
+    m_scriptSchedule.Schedule("Internal Activate Command used for spell", script, delay, sourceGuid, targetGuid, ownerGuid, sWorld.GetGameTime());
+}
 
-    sScriptMgr.IncreaseScheduledScriptsCount();
+void Map::ScheduleRespawn(Creature* creature, time_t respawnTime)
+{
+    // dead creatures park themselves at their update, also from the region update threads
+    RegionGuard guard(*this);
+    m_respawnQueue.push(RespawnQueueEntry(respawnTime, creature->GetObjectGuid()));
 }
 
-/// Process queued scripts
-void Map::ScriptsProcess()
+void Map::ProcessRespawns()
 {
-    if (m_scriptSchedule.empty())
+    if (m_respawnQueue.empty())
         { return; }
 
-    ///- Process overdue queued scripts
-    ScriptScheduleMap::iterator iter = m_scriptSchedule.begin();
-    // ok as multimap is a *sorted* associative container
-    while (!m_scriptSchedule.empty() && (iter->first <= sWorld.GetGameTime()))
+    time_t now = time(NULL);
+
+    RegionGuard guard(*this);
+    while (!m_respawnQueue.empty() && m_respawnQueue.top().time <= now)
+    {
+        RespawnQueueEntry entry = m_respawnQueue.top();
+        m_respawnQueue.pop();
+
+        // the creature can be unloaded with its grid or be queued again with another respawn time meanwhile
+        if (Creature* creature = GetCreature(entry.guid))
+            { creature->WakeForRespawn(entry.time); }
+    }
+}
+
+void Map::QueueSpawn(TypeID typeId, uint32 dbGuid)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_pendingSpawnLock);
+    m_pendingSpawns.push_back(PendingSpawn(typeId, dbGuid));
+}
+
+void Map::ProcessPendingSpawns()
+{
+    std::vector<PendingSpawn> spawns;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_pendingSpawnLock);
+        if (m_pendingSpawns.empty())
+            { return; }
+
+        size_t limit = sWorld.getConfig(CONFIG_UINT32_MAP_SPAWNS_PER_UPDATE);
+        if (!limit || limit > m_pendingSpawns.size())
+            { limit = m_pendingSpawns.size(); }
+
+        spawns.assign(m_pendingSpawns.begin(), m_pendingSpawns.begin() + limit);
+        m_pendingSpawns.erase(m_pendingSpawns.begin(), m_pendingSpawns.begin() + limit);
+    }
+
+    for (std::vector<PendingSpawn>::const_iterator itr = spawns.begin(); itr != spawns.end(); ++itr)
+        { SpawnPending(itr->typeId, itr->dbGuid); }
+}
+
+/// game events add their objects to the grid data of ObjectMgr, pools to the one of the persistent state
+static bool IsInCellGuids(CellGuidSet const& eventGuids, CellGuidSet const& poolGuids, uint32 dbGuid)
+{
+    return eventGuids.find(dbGuid) != eventGuids.end() || poolGuids.find(dbGuid) != poolGuids.end();
+}
+
+void Map::SpawnPending(TypeID typeId, uint32 dbGuid)
+{
+    switch (typeId)
     {
-        if (iter->second.HandleScriptStep())
+        case TYPEID_UNIT:
         {
-            // Terminate following script steps of this script
-            const char* tableName = iter->second.GetTableName();
-            uint32 id = iter->second.GetId();
-            ObjectGuid sourceGuid = iter->second.GetSourceGuid();
-            ObjectGuid targetGuid = iter->second.GetTargetGuid();
-            ObjectGuid ownerGuid = iter->second.GetOwnerGuid();
-
-            for (ScriptScheduleMap::iterator rmItr = m_scriptSchedule.begin(); rmItr != m_scriptSchedule.end();)
-            {
-                if (rmItr->second.IsSameScript(tableName, id, sourceGuid, targetGuid, ownerGuid))
-                {
-                    m_scriptSchedule.erase(rmItr++);
-                    sScriptMgr.DecreaseScheduledScriptCount();
-                }
-                else
-                    { ++rmItr; }
-            }
+            CreatureData const* data = sObjectMgr.GetCreatureData(dbGuid);
+            if (!data || !IsLoaded(data->posX, data->posY))
+                { return; }                                 // the grid load spawns it, if still in the grid data then
+
+            CellPair cellPair = MaNGOS::ComputeCellPair(data->posX, data->posY);
+            uint32 cellId = (cellPair.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP) + cellPair.x_coord;
+            if (!IsInCellGuids(sObjectMgr.GetCellObjectGuids(GetId(), cellId).creatures, GetPersistentState()->GetCellObjectGuids(cellId).creatures, dbGuid) ||
+                GetCreature(data->GetObjectGuid(dbGuid)))
+                { return; }
+
+            Creature* pCreature = new Creature;
+            if (!pCreature->LoadFromDB(dbGuid, this))
+                { delete pCreature; }
+            else
+                { Add(pCreature); }
+            break;
         }
-        else
+        case TYPEID_GAMEOBJECT:
         {
-            m_scriptSchedule.erase(iter);
-
-            sScriptMgr.DecreaseScheduledScriptCount();
+            GameObjectData const* data = sObjectMgr.GetGOData(dbGuid);
+            if (!data || !IsLoaded(data->posX, data->posY))
+                { return; }
+
+            CellPair cellPair = MaNGOS::ComputeCellPair(data->posX, data->posY);
+            uint32 cellId = (cellPair.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP) + cellPair.x_coord;
+            if (!IsInCellGuids(sObjectMgr.GetCellObjectGuids(GetId(), cellId).gameobjects, GetPersistentState()->GetCellObjectGuids(cellId).gameobjects, dbGuid) ||
+                GetGameObject(ObjectGuid(HIGHGUID_GAMEOBJECT, data->id, dbGuid)))
+                { return; }
+
+            GameObject* pGameobject = new GameObject;
+            if (!pGameobject->LoadFromDB(dbGuid, this))
+                { delete pGameobject; }
+            else if (pGameobject->isSpawnedByDefault())
+                { Add(pGameobject); }
+            else
+                { delete pGameobject; }
+            break;
         }
-        iter = m_scriptSchedule.begin();
+        default:
+            break;
     }
 }
 
+/// Process queued scripts
+void Map::ScriptsProcess()
+{
+    ///- Process overdue queued scripts
+    m_scriptSchedule.Process(sWorld.GetGameTime());
+}
+
 /**
  * Function return player that in world at CURRENT map
  *
@@ -1711,6 +2691,7 @@ Player* Map::GetPlayer(ObjectGuid guid)
  */
 Creature* Map::GetCreature(ObjectGuid guid)
 {
+    RegionGuard guard(*this);
     return m_objectsStore.find<Creature>(guid, (Creature*)NULL);
 }
 
@@ -1721,6 +2702,7 @@ Creature* Map::GetCreature(ObjectGuid guid)
  */
 Pet* Map::GetPet(ObjectGuid guid)
 {
+    RegionGuard guard(*this);
     return m_objectsStore.find<Pet>(guid, (Pet*)NULL);
 }
 
@@ -1761,6 +2743,7 @@ Creature* Map::GetAnyTypeCreature(ObjectGuid guid)
  */
 GameObject* Map::GetGameObject(ObjectGuid guid)
 {
+    RegionGuard guard(*this);
     return m_objectsStore.find<GameObject>(guid, (GameObject*)NULL);
 }
 
@@ -1771,6 +2754,7 @@ GameObject* Map::GetGameObject(ObjectGuid guid)
  */
 DynamicObject* Map::GetDynamicObject(ObjectGuid guid)
 {
+    RegionGuard guard(*this);
     return m_objectsStore.find<DynamicObject>(guid, (DynamicObject*)NULL);
 }
 
@@ -1827,6 +2811,42 @@ void Map::SendObjectUpdates()
         obj->BuildUpdateData(update_players);
     }
 
+    if (!i_objectsToClientUpdateDelayed.empty())
+    {
+        i_objectsToClientUpdate.swap(i_objectsToClientUpdateDelayed);
+        i_objectsToClientUpdateDelayed.clear();
+    }
+
+    // objects gone out of view one by one this tick, one out of range block per player
+    for (MapRefManager::iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+    {
+        Player* player = itr->getSource();
+        if (player->HasPendingOutOfRange())
+            { player->FlushPendingOutOfRange(update_players[player]); }
+    }
+
+    MapUpdater& mapUpdater = sMapMgr.GetMapUpdater();
+    uint32 minPlayers = sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_PARALLEL_SEND_PLAYERS);
+
+    // building and compressing the packets of different players is independent
+    if (mapUpdater.IsActive() && minPlayers && update_players.size() >= minPlayers)
+    {
+        m_objectUpdateSends.reserve(update_players.size());
+        for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
+            { m_objectUpdateSends.push_back(&*iter); }
+
+        // the waiting thread executes a part too
+        m_objectUpdateSendParts = std::min(mapUpdater.GetThreadCount() + 1, uint32(m_objectUpdateSends.size()));
+
+        MapUpdater::Batch batch;
+        for (uint32 part = 0; part < m_objectUpdateSendParts; ++part)
+            { mapUpdater.ScheduleObjectUpdatesSend(*this, part, batch); }
+        mapUpdater.Wait(batch);
+
+        m_objectUpdateSends.clear();
+        return;
+    }
+
     WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
     for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
     {
@@ -1836,9 +2856,30 @@ void Map::SendObjectUpdates()
     }
 }
 
+/// Build and send the packets of one part of the players collected by SendObjectUpdates
+void Map::SendObjectUpdatesPart(uint32 part)
+{
+    PROFILE_SCOPE_ID("Map::SendObjectUpdatesPart", GetId());
+    ThreadActivityScope activity("Map::SendObjectUpdatesPart", GetId());
+    MANGOS_ASSERT(part < m_objectUpdateSendParts);
+
+    size_t begin = m_objectUpdateSends.size() * part / m_objectUpdateSendParts;
+    size_t end = m_objectUpdateSends.size() * (part + 1) / m_objectUpdateSendParts;
+
+    WorldPacket packet;                                     // one buffer per part, reused for its players
+    for (size_t i = begin; i < end; ++i)
+    {
+        UpdateDataMapType::value_type& update = *m_objectUpdateSends[i];
+        update.second.BuildPacket(&packet);
+        update.first->GetSession()->SendPacket(&packet);
+        packet.clear();
+    }
+}
+
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
 {
     // TODO: for map local guid counters possible force reload map instead shutdown server at guid counter overflow
+    RegionGuard guard(*this);
     switch (guidhigh)
     {
         case HIGHGUID_UNIT:
@@ -1960,8 +3001,24 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
  */
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
-           && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
+    bool result;
+    if (m_queryCache)
+    {
+        RegionGuard guard(*this);
+        if (m_queryCache->GetLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, result))
+            { return result; }
+    }
+
+    result = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
+             && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
+
+    if (m_queryCache)
+    {
+        RegionGuard guard(*this);
+        m_queryCache->SetLineOfSight(srcX, srcY, srcZ, destX, destY, destZ, result);
+    }
+
+    return result;
 }
 
 /**
@@ -1994,21 +3051,48 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
 
 float Map::GetHeight(float x, float y, float z) const
 {
+    float height;
+    if (m_queryCache)
+    {
+        RegionGuard guard(*this);
+        if (m_queryCache->GetHeight(x, y, z, height))
+            { return height; }
+    }
+
     float staticHeight = m_TerrainData->GetHeightStatic(x, y, z);
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
-    return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight));
+    height = std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight));
+
+    if (m_queryCache)
+    {
+        RegionGuard guard(*this);
+        m_queryCache->SetHeight(x, y, z, height);
+    }
+
+    return height;
 }
 
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
     m_dyn_tree.insert(mdl);
+    InvalidateQueryCache();
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
     m_dyn_tree.remove(mdl);
+    InvalidateQueryCache();
+}
+
+void Map::InvalidateQueryCache()
+{
+    if (!m_queryCache)
+        { return; }
+
+    RegionGuard guard(*this);
+    m_queryCache->Invalidate();
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
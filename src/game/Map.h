@@ -30,10 +30,12 @@
 #include "Policies/ThreadingModel.h"
 #include <ace/RW_Thread_Mutex.h>
 #include <ace/Thread_Mutex.h>
+#include <ace/Recursive_Thread_Mutex.h>
 
 #include "DBCStructure.h"
 #include "GridDefines.h"
 #include "Cell.h"
+#include "SpatialHash.h"
 #include "Object.h"
 #include "Timer.h"
 #include "SharedDefines.h"
@@ -46,11 +48,16 @@
 #include "vmap/DynamicTree.h"
 
 #include <bitset>
+#include <deque>
 #include <list>
+#include <queue>
+#include <set>
+#include <vector>
 
 struct CreatureInfo;
 class Creature;
 class Unit;
+class Camera;
 class WorldPacket;
 class InstanceData;
 class Group;
@@ -62,6 +69,48 @@ struct ScriptInfo;
 class BattleGround;
 class GridMap;
 class GameObjectModel;
+class MapQueryCache;
+class MetricHistogram;
+struct AreaTrigger;
+struct SpellEntry;
+class Transport;
+
+/// Visibility and relocation work of a map since its creation, see .server mapstats
+/// Not synchronized, so only approximate while regions of the map are updated in parallel
+struct MapVisibilityStats
+{
+    MapVisibilityStats() : relocationNotifiesScheduled(0), relocationNotifiesExecuted(0), visibilityUpdates(0),
+        clientObjectsCreated(0), clientObjectsDestroyed(0), playerRelocations(0), creatureRelocations(0),
+        visibilityUpdateTime(0), playerRelocationTime(0), creatureRelocationTime(0) {}
+
+    uint32 relocationNotifiesScheduled;
+    uint32 relocationNotifiesExecuted;
+    uint32 visibilityUpdates;                               // Camera::UpdateVisibilityForOwner passes
+    uint32 clientObjectsCreated;                            // by visibility changes
+    uint32 clientObjectsDestroyed;
+    uint32 playerRelocations;
+    uint32 creatureRelocations;
+    uint64 visibilityUpdateTime;                            // in microseconds, including nested calls
+    uint64 playerRelocationTime;
+    uint64 creatureRelocationTime;
+};
+
+/// Adds its lifetime in microseconds to a MapVisibilityStats time
+class MapStatsTimer
+{
+    public:
+        explicit MapStatsTimer(uint64& total) : m_total(total), m_start(ACE_OS::gettimeofday()) {}
+        ~MapStatsTimer()
+        {
+            ACE_UINT64 elapsed;
+            (ACE_OS::gettimeofday() - m_start).to_usec(elapsed);
+            m_total += elapsed;
+        }
+
+    private:
+        uint64& m_total;
+        ACE_Time_Value m_start;
+};
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
@@ -97,6 +146,64 @@ struct WorldTemplate
 #pragma pack(pop)
 #endif
 
+enum MapDeferredActionType
+{
+    MAP_DEFERRED_TELEPORT       = 0,                        // far teleport of a player of this map
+    MAP_DEFERRED_TRANSPORT_MOVE = 1,                        // transport of this map reached a node on another map
+};
+
+/// Action touching other maps, requested during Map::Update and applied by MapManager after all maps are updated
+struct MapDeferredAction
+{
+    MapDeferredAction(MapDeferredActionType _type, ObjectGuid _guid, WorldLocation const& _dest, uint32 _options, AreaTrigger const* _at)
+        : type(_type), guid(_guid), dest(_dest), options(_options), at(_at) {}
+
+    MapDeferredActionType type;
+    ObjectGuid guid;
+    WorldLocation dest;
+    uint32 options;                                         // TeleportToOptions
+    AreaTrigger const* at;
+};
+
+enum MapThreatActionType
+{
+    MAP_THREAT_ADD                  = 0,                    // ThreatManager::addCalculatedThreat
+    MAP_THREAT_MODIFY_PERCENT       = 1,                    // ThreatManager::modifyThreatPercent
+    MAP_THREAT_CLEAR                = 2,                    // ThreatManager::clearReferences
+    MAP_THREAT_TAUNT_APPLY          = 3,                    // ThreatManager::tauntApply
+    MAP_THREAT_TAUNT_FADE_OUT       = 4,                    // ThreatManager::tauntFadeOut
+    MAP_HOSTILE_ASSIST              = 5,                    // HostileRefManager::threatAssist
+    MAP_HOSTILE_ADD_PERCENT         = 6,                    // HostileRefManager::addThreatPercent
+    MAP_HOSTILE_SET_ONLINE          = 7,                    // HostileRefManager::setOnlineOfflineState, of one unit if other is set
+    MAP_HOSTILE_UPDATE_TABLES       = 8,                    // HostileRefManager::updateThreatTables
+    MAP_HOSTILE_DELETE              = 9,                    // HostileRefManager::deleteReferences
+    MAP_HOSTILE_DELETE_FACTION      = 10,                   // HostileRefManager::deleteReferencesForFaction
+    MAP_HOSTILE_DELETE_ONE          = 11,                   // HostileRefManager::deleteReference
+};
+
+/// Change of threat or hostile lists reaching out of the region updated by the thread, applied after the region pass
+struct MapThreatAction
+{
+    MapThreatAction(MapThreatActionType _type, ObjectGuid _owner, ObjectGuid _other = ObjectGuid(), float _threat = 0.0f, int32 _param = 0, SpellEntry const* _spell = NULL)
+        : type(_type), owner(_owner), other(_other), threat(_threat), param(_param), spell(_spell) {}
+
+    MapThreatActionType type;
+    ObjectGuid owner;                                       // unit of the threat or hostile list
+    ObjectGuid other;                                       // victim, taunter or hating unit
+    float threat;
+    int32 param;                                            // percent, faction, online state or single target flag
+    SpellEntry const* spell;
+};
+
+/// Wander destinations of a random moving spawn, found on the nav mesh once, see RandomMovementGenerator
+struct WanderArea
+{
+    WanderArea() : open(false) {}
+
+    std::vector<Position> points;                           // empty if the spawn has no nav mesh around
+    bool open;                                              // the spawn point and all points see each other on the nav mesh
+};
+
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
 
 class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
@@ -134,10 +241,17 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void MessageDistBroadcast(Player const*, WorldPacket*, float dist, bool to_self, bool own_team_only = false);
         void MessageDistBroadcast(WorldObject const*, WorldPacket*, float dist);
 
-        float GetVisibilityDistance() const { return m_VisibleDistance; }
+        float GetVisibilityDistance() const { return m_VisibleDistance * m_visibilityScale; }
+        // factor of the map visibility distance applied under load, see UpdateVisibilityScale()
+        float GetVisibilityScale() const { return m_visibilityScale; }
         // function for setting up visibility distance for maps on per-type/per-Id basis
         virtual void InitVisibilityDistance();
 
+        // Cameras receiving broadcasts sent from the cells around their viewpoint, cell NULL unsubscribes
+        void UpdateBroadcastSubscription(Camera* camera, CellPair const* cell);
+        // resubscribes all cameras, needed after the map visibility distance changed
+        void UpdateBroadcastSubscriptions();
+
         void PlayerRelocation(Player*, float x, float y, float z, float angl);
         void CreatureRelocation(Creature* creature, float x, float y, float z, float orientation);
 
@@ -165,6 +279,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         {
             grid.ResetTimeTracker((time_t)((float)i_gridExpiry * factor));
         }
+        // start the unload delay of an idle grid, longer for grids reloaded soon after their last unload
+        void ResetGridUnloadExpiry(NGridType& grid) const;
 
         time_t GetGridExpiry(void) const { return i_gridExpiry; }
         uint32 GetId(void) const { return i_id; }
@@ -195,9 +311,35 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, CellPair cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
-        bool isCellMarked(uint32 pCellId) { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        // empty instances are not updated until a player enters again, see DungeonMap::Update
+        bool IsHibernating() const { return m_hibernating; }
+        uint32 GetLoadedGridCount() const { return m_gridCount; }
+
+        void DeferTeleport(Player* player, WorldLocation const& dest, uint32 options, AreaTrigger const* at);
+        void DeferTransportMove(Transport* transport, WorldLocation const& dest);
+        uint32 ProcessDeferredActions();
+
+        // threat and hostile lists of units away from the region updated by the thread are changed after the pass
+        bool IsRegionUpdateRunning() const { return m_regionUpdateRunning; }
+        bool IsNearUpdatedRegion(WorldObject const& obj) const;
+        void DeferThreatAction(MapThreatAction const& action);
+
+        // transports are updated by the update of the map they are currently on
+        void AddTransport(Transport* transport) { m_transports.insert(transport); }
+        void RemoveTransport(Transport* transport) { m_transports.erase(transport); }
+
+        // AI relocation notifies are collected during the update and visited per cell at its end
+        void AddRelocationNotify(Unit* unit);
+
+        // intermediate spline positions of moving creatures are computed and relocated together after the region updates
+        void AddSplineRelocation(Creature* creature);
+
+        // continent region updates, see UpdateRegions()
+        uint32 GetRegionSize() const { return m_regionSize; }
+        uint32 GetRegionCount() const { return m_regionCells.size(); }
+        uint32 GetRegionUpdateTime(uint32 regionId) const { return regionId < m_regionUpdateTime.size() ? m_regionUpdateTime[regionId] : 0; }
+        void UpdateRegion(uint32 regionId, uint32 diff);
+        void SendObjectUpdatesPart(uint32 part);
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
@@ -224,6 +366,25 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         // must called with RemoveFromWorld
         void RemoveFromActive(WorldObject* obj);
 
+        /**
+         * @brief queues a dead creature until its respawn time, it is not updated meanwhile
+         *
+         * @param creature
+         * @param respawnTime
+         */
+        void ScheduleRespawn(Creature* creature, time_t respawnTime);
+
+        /**
+         * @brief queues the spawn of a creature or game object of a started game event or pool
+         *
+         * The spawns are done by the map update, at most Map.SpawnsPerUpdate of them per update.
+         * Objects removed from the grid data meanwhile (event stopped, other pool member chosen) are skipped.
+         *
+         * @param typeId TYPEID_UNIT or TYPEID_GAMEOBJECT
+         * @param dbGuid
+         */
+        void QueueSpawn(TypeID typeId, uint32 dbGuid);
+
         Player* GetPlayer(ObjectGuid guid);
         Creature* GetCreature(ObjectGuid guid);
         Pet* GetPet(ObjectGuid guid);
@@ -237,14 +398,36 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         typedef TypeUnorderedMapContainer<AllMapStoredObjectTypes, ObjectGuid> MapStoredObjectTypesContainer;
         MapStoredObjectTypesContainer& GetObjectsStore() { return m_objectsStore; }
 
+        template<class T> void InsertObject(ObjectGuid guid, T* obj)
+        {
+            RegionGuard guard(*this);
+            m_objectsStore.insert<T>(guid, obj);
+        }
+
+        template<class T> void EraseObject(ObjectGuid guid, T* obj)
+        {
+            RegionGuard guard(*this);
+            m_objectsStore.erase<T>(guid, obj);
+        }
+
         void AddUpdateObject(Object* obj)
         {
+            RegionGuard guard(*this);
             i_objectsToClientUpdate.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            RegionGuard guard(*this);
             i_objectsToClientUpdate.erase(obj);
+            i_objectsToClientUpdateDelayed.erase(obj);
+        }
+
+        // object is added to the client update list again after the current SendObjectUpdates
+        void AddDelayedUpdateObject(Object* obj)
+        {
+            RegionGuard guard(*this);
+            i_objectsToClientUpdateDelayed.insert(obj);
         }
 
         // DynObjects currently
@@ -270,11 +453,48 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         void InsertGameObjectModel(const GameObjectModel& mdl);
         void RemoveGameObjectModel(const GameObjectModel& mdl);
         bool ContainsGameObjectModel(const GameObjectModel& mdl) const;
+        // results of line of sight and height queries are outdated after a collision state change of a model
+        void InvalidateQueryCache();
+
+        // Units in world of the map in short range search buckets, no-op if SpatialHash.SearchRadius is 0
+        void AddToSpatialHash(Unit* unit);
+        void RemoveFromSpatialHash(Unit* unit);
+        void RelocateInSpatialHash(Unit* unit);
+        template<class T> bool VisitUnitsInRange(float x, float y, float radius, T& visitor);
+
+        MapVisibilityStats& GetVisibilityStats() { return m_visibilityStats; }
+
+        // Periodic aura ticks wait for the updates stepping over PeriodicAura.BatchWindow, see Aura::Update
+        bool IsPeriodicTickUpdate() const { return m_periodicTickUpdate; }
+        uint32 GetPeriodicBatchWindow() const { return m_periodicBatchWindow; }
+
+        // Wander area of a spawn by its db guid, kept for the life time of the map
+        WanderArea const* GetWanderArea(uint32 spawnGuid) const;
+        WanderArea const& AddWanderArea(uint32 spawnGuid, WanderArea const& area);
 
         // Get Holder for Creature Linking
         CreatureLinkingHolder* GetCreatureLinkingHolder() { return &m_creatureLinkingHolder; }
 
     private:
+        // Serializes map wide containers while regions of this map are updated by several threads, no-op otherwise
+        class RegionGuard
+        {
+            public:
+                explicit RegionGuard(Map const& map) : m_lock(map.m_regionUpdateRunning ? &map.m_regionLock : NULL)
+                {
+                    if (m_lock)
+                        { m_lock->acquire(); }
+                }
+                ~RegionGuard()
+                {
+                    if (m_lock)
+                        { m_lock->release(); }
+                }
+
+            private:
+                ACE_Recursive_Thread_Mutex* m_lock;
+        };
+
         void LoadMapAndVMap(int gx, int gy);
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
@@ -308,9 +528,28 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
 
         void setNGrid(NGridType* grid, uint32 x, uint32 y);
         void ScriptsProcess();
+        void ProcessRespawns();
+        void ProcessPendingSpawns();
+        void SpawnPending(TypeID typeId, uint32 dbGuid);
+
+        void PrefetchGridsAhead(Player const* player);
+        void ProcessRelocationNotifies();
+        void ProcessSplineRelocations();
+        void UpdateVisibilityScale(uint32 updateTime, uint32 diff);
+        void UpdateActiveCells();
+        void UpdateActiveCellAnchor(WorldObject const* obj);
+        void ReferenceCellArea(CellArea const& area);
+        void DereferenceCellArea(CellArea const& area);
+        void ReferenceNearCellArea(CellArea const& area);
+        void DereferenceNearCellArea(CellArea const& area);
+        uint32 GetRegionIdOfCell(uint32 x, uint32 y) const;
+        void UpdateRegions(uint32 diff);
+        void ProcessThreatActions();
+        uint32 GetRegionsPerAxis() const { return m_regionSize ? (MAX_NUMBER_OF_GRIDS + m_regionSize - 1) / m_regionSize : 1; }
 
         void SendObjectUpdates();
         std::set<Object*> i_objectsToClientUpdate;
+        std::set<Object*> i_objectsToClientUpdateDelayed;   // with updates held back, see UPDATE_COALESCE_*
 
     protected:
         MapEntry const* i_mapEntry;
@@ -327,22 +566,128 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>
         ActiveNonPlayers m_activeNonPlayers;
         ActiveNonPlayers::iterator m_activeNonPlayersIter;
         MapStoredObjectTypesContainer m_objectsStore;
+        bool m_hibernating;
+
+        bool HasScheduledScripts() const { return !m_scriptSchedule.empty(); }
 
     private:
         time_t i_gridExpiry;
 
+        // grids unloaded before, to keep grids longer that are reloaded soon after their unload
+        struct GridUnloadInfo
+        {
+            GridUnloadInfo() : unloadTime(0), expiryScale(1) {}
+
+            time_t unloadTime;                              // 0 while loaded
+            uint32 expiryScale;                             // factor of i_gridExpiry at next unload
+        };
+        typedef UNORDERED_MAP<uint32 /*grid id*/, GridUnloadInfo> GridUnloadInfoMap;
+        GridUnloadInfoMap m_gridUnloadInfo;
+
         NGridType* i_grids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+        uint32 m_gridCount;                                 // created grids in i_grids
 
         // Shared geodata object with map coord info...
         TerrainInfo* const m_TerrainData;
         bool m_bLoadedGrids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP* TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        // Cells updated each tick: every player or active object in world references the cells of its visibility area.
+        // The references only change when an anchor's area crosses a cell border, anchors not seen in a tick are dropped.
+        struct ActiveCellAnchor
+        {
+            ActiveCellAnchor() : tick(0), hasNearArea(false) {}
+
+            CellArea area;
+            uint32 tick;                                    // last m_activeCellsTick the anchor was seen in world
+            CellArea nearArea;                              // cells within CreatureIdleUpdate.Distance of a player
+            bool hasNearArea;
+        };
+        typedef UNORDERED_MAP<uint32 /*cell id*/, uint32 /*references*/> ActiveCellsMap;
+        typedef UNORDERED_MAP<WorldObject const*, ActiveCellAnchor> ActiveCellAnchorsMap;
+        ActiveCellsMap m_activeCells;
+        ActiveCellsMap m_nearCells;                         // active cells with creatures updated at full rate
+        ActiveCellAnchorsMap m_activeCellAnchors;
+        uint32 m_activeCellsTick;
+
+        // active cells bucketed per region (single bucket if map isn't split)
+        uint32 m_regionSize;                                // region side in grids, 0 for not split maps
+        std::vector<std::vector<uint32> > m_regionCells;
+        std::vector<uint32> m_regionUpdateTime;             // last update time of each region in ms
+        bool m_regionUpdateRunning;
+        mutable ACE_Recursive_Thread_Mutex m_regionLock;
 
         std::set<WorldObject*> i_objectsToRemove;
 
-        typedef std::multimap<time_t, ScriptAction> ScriptScheduleMap;
-        ScriptScheduleMap m_scriptSchedule;
+        GuidVector m_relocationNotifies;                    // units whose AI relocation notify is due this tick
+        GuidVector m_splineRelocations;                     // creatures whose spline position update is due this tick
+
+        typedef UNORDERED_MAP<uint32 /*spawn guid*/, WanderArea> WanderAreaMap;
+        WanderAreaMap m_wanderAreas;
+
+        SpatialHash* m_spatialHash;                         // NULL if disabled
+
+        MapQueryCache* m_queryCache;                        // NULL if disabled
+        uint32 m_queryCacheTimer;                           // time since the cache was cleared
+
+        MapVisibilityStats m_visibilityStats;
+
+        uint32 m_periodicBatchWindow;                       // 0 if periodic ticks aren't batched
+        uint32 m_periodicBatchTimer;                        // time since the last batch step
+        bool m_periodicTickUpdate;                          // this update steps over a batch window
+
+        // update data of SendObjectUpdates split into parts sent on the map update threads
+        std::vector<UpdateDataMapType::value_type*> m_objectUpdateSends;
+        uint32 m_objectUpdateSendParts;
+
+        typedef std::vector<Camera*> CameraList;
+        typedef UNORDERED_MAP<uint32 /*cell id*/, CameraList> BroadcastSubscribersMap;
+        BroadcastSubscribersMap m_broadcastSubscribers;
+
+        uint32 GetBroadcastRange() const;
+        bool GetBroadcastSubscribers(float x, float y, float radius, CameraList& cameras) const;
+
+        float m_visibilityScale;
+        uint32 m_visibilityScaleTimer;
+        uint32 m_visibilityScaleUpdateTime;                 // sum of update times since last scale check
+        uint32 m_visibilityScaleUpdates;
+
+        typedef std::vector<MapDeferredAction> DeferredActionList;
+        DeferredActionList m_deferredActions;
+
+        typedef std::vector<MapThreatAction> ThreatActionList;
+        ThreatActionList m_threatActions;                   // queued by the regions of the running pass
+
+        typedef std::set<Transport*> TransportSet;
+        TransportSet m_transports;
+
+        ScriptSchedule m_scriptSchedule;
+
+        struct RespawnQueueEntry
+        {
+            RespawnQueueEntry(time_t _time, ObjectGuid _guid) : time(_time), guid(_guid) {}
+
+            bool operator<(RespawnQueueEntry const& other) const { return time > other.time; }  // earliest on top
+
+            time_t time;
+            ObjectGuid guid;
+        };
+
+        typedef std::priority_queue<RespawnQueueEntry> RespawnQueue;
+        RespawnQueue m_respawnQueue;                        // creatures not updated until their respawn time, entries of removed creatures are skipped
+
+        struct PendingSpawn
+        {
+            PendingSpawn(TypeID _typeId, uint32 _dbGuid) : typeId(_typeId), dbGuid(_dbGuid) {}
+
+            TypeID typeId;
+            uint32 dbGuid;
+        };
+
+        typedef std::deque<PendingSpawn> PendingSpawnQueue;
+        PendingSpawnQueue m_pendingSpawns;
+        ACE_Thread_Mutex m_pendingSpawnLock;                // pools also spawn in other instances of the map from map update threads
+
+        MetricHistogram* m_updateTimeMetric;                // map_update_ms of the map id
 
         InstanceData* i_data;
         uint32 i_script_id;
@@ -401,8 +746,12 @@ class MANGOS_DLL_SPEC DungeonMap : public Map
 
         virtual void InitVisibilityDistance() override;
     private:
+        void Hibernate();
+        void WakeUp();
+
         bool m_resetAfterUnload;
         bool m_unloadWhenEmpty;
+        uint32 m_emptyTime;                                 // time without players in ms
 };
 
 class MANGOS_DLL_SPEC BattleGroundMap : public Map
@@ -446,4 +795,29 @@ Map::Visit(const Cell& cell, TypeContainerVisitor<T, CONTAINER>& visitor)
         getNGrid(x, y)->Visit(cell_x, cell_y, visitor);
     }
 }
+
+/**
+ * Visit the units within x, y +- radius through the spatial hash
+ *
+ * Returns false without visiting anything if the hash is disabled or radius is too long for it,
+ * the caller has to visit the grid cells then. The units are collected before visiting,
+ * so the visitor runs without the region lock.
+ */
+template<class T>
+inline bool Map::VisitUnitsInRange(float x, float y, float radius, T& visitor)
+{
+    if (!m_spatialHash || radius > m_spatialHash->GetMaxSearchRadius())
+        { return false; }
+
+    ReusedUnitVector units;
+    {
+        RegionGuard guard(*this);
+        m_spatialHash->Query(x, y, radius, units);
+    }
+
+    for (std::vector<Unit*>::const_iterator itr = units.begin(); itr != units.end(); ++itr)
+        { visitor.VisitUnit(*itr); }
+
+    return true;
+}
 #endif
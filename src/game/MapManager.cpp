@@ -39,13 +39,16 @@ INSTANTIATE_SINGLETON_2(MapManager, CLASS_LOCK);
 INSTANTIATE_CLASS_MUTEX(MapManager, ACE_Recursive_Thread_Mutex);
 
 MapManager::MapManager()
-    : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN))
+    : i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)),
+      m_updatingMaps(false), m_deferredActionCount(0), m_deferredActionTime(0)
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
 }
 
 MapManager::~MapManager()
 {
+    m_updater.Deactivate();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
         { delete iter->second; }
 
@@ -60,6 +63,24 @@ MapManager::Initialize()
 {
     InitStateMachine();
     InitMaxInstanceId();
+
+    if (uint32 numThreads = sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_THREADS))
+    {
+        if (m_updater.Activate(numThreads) == 0)
+            { sLog.outString("Using %u threads for map updates", numThreads); }
+    }
+
+    if (uint32 numThreads = sWorld.getConfig(CONFIG_UINT32_TERRAIN_PREFETCH_THREADS))
+    {
+        if (m_terrainLoader.Activate(numThreads) == 0)
+            { sLog.outString("Using %u threads for terrain prefetching", numThreads); }
+    }
+
+    if (uint32 numThreads = sWorld.getConfig(CONFIG_UINT32_MMAP_PATHFIND_THREADS))
+    {
+        if (m_pathFinderQueue.Activate(numThreads) == 0)
+            { sLog.outString("Using %u threads for pathfinding", numThreads); }
+    }
 }
 
 void MapManager::InitStateMachine()
@@ -90,7 +111,10 @@ void MapManager::UpdateGridState(grid_state_t state, Map& map, NGridType& ngrid,
 void MapManager::InitializeVisibilityDistanceInfo()
 {
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
-        { (*iter).second->InitVisibilityDistance(); }
+    {
+        (*iter).second->InitVisibilityDistance();
+        (*iter).second->UpdateBroadcastSubscriptions();
+    }
 }
 
 Map* MapManager::CreateMap(uint32 id, const WorldObject* obj)
@@ -180,22 +204,46 @@ void MapManager::Update(uint32 diff)
     if (!i_timer.Passed())
         { return; }
 
-    for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
-        { iter->second->Update((uint32)i_timer.GetCurrent()); }
+    if (m_updater.IsActive())
+    {
+        m_updatingMaps = true;
 
-    for (TransportSet::iterator iter = m_Transports.begin(); iter != m_Transports.end(); ++iter)
+        for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+        {
+            if (!iter->second->IsHibernating())
+                { m_updater.ScheduleUpdate(*iter->second, (uint32)i_timer.GetCurrent()); }
+        }
+
+        // join point: everything below can touch several maps at once
+        m_updater.Wait();
+        m_updatingMaps = false;
+    }
+    else
     {
-        WorldObject::UpdateHelper helper((*iter));
-        helper.Update((uint32)i_timer.GetCurrent());
+        for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+        {
+            if (!iter->second->IsHibernating())
+                { iter->second->Update((uint32)i_timer.GetCurrent()); }
+        }
     }
 
-    // remove all maps which can be unloaded
+    // apply transfers requested by the map updates, in map order so the result doesn't depend on the update threads
+    uint32 deferredStart = WorldTimer::getMSTime();
+    m_deferredActionCount = 0;
+    for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+        { m_deferredActionCount += iter->second->ProcessDeferredActions(); }
+    m_deferredActionTime = WorldTimer::getMSTimeDiff(deferredStart, WorldTimer::getMSTime());
+
+    // remove all maps which can be unloaded, limited per update so many instances reset at once do not unload in one tick
+    // CanUnload keeps returning true for the maps left, they are unloaded at the next updates
+    uint32 unloadLimit = sWorld.getConfig(CONFIG_UINT32_INSTANCE_UNLOADS_PER_UPDATE);
+    uint32 unloaded = 0;
     MapMapType::iterator iter = i_maps.begin();
     while (iter != i_maps.end())
     {
         Map* pMap = iter->second;
         // check if map can be unloaded
-        if (pMap->CanUnload((uint32)i_timer.GetCurrent()))
+        if (pMap->CanUnload((uint32)i_timer.GetCurrent()) && (!unloadLimit || unloaded++ < unloadLimit))
         {
             pMap->UnloadAll(true);
             delete pMap;
@@ -234,6 +282,10 @@ bool MapManager::IsValidMAP(uint32 mapid)
 
 void MapManager::UnloadAll()
 {
+    m_updater.Deactivate();
+    m_terrainLoader.Deactivate();
+    m_pathFinderQueue.Deactivate();
+
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
         { iter->second->UnloadAll(true); }
 
@@ -256,6 +308,31 @@ void MapManager::InitMaxInstanceId()
         i_MaxInstanceId = result->Fetch()[0].GetUInt32();
         delete result;
     }
+
+    // the first instance reserves a block, instances created before the table was used are skipped
+    i_InstanceIdReserveEnd = i_MaxInstanceId;
+    if (sWorld.getConfig(CONFIG_UINT32_INSTANCE_ID_RESERVE_SIZE))
+        { CharacterDatabase.DirectPExecute("UPDATE instance_reserve SET next_id = %u WHERE next_id <= %u", i_MaxInstanceId + 1, i_MaxInstanceId); }
+}
+
+uint32 MapManager::GenerateInstanceId()
+{
+    if (uint32 reserveSize = sWorld.getConfig(CONFIG_UINT32_INSTANCE_ID_RESERVE_SIZE))
+    {
+        if (i_MaxInstanceId >= i_InstanceIdReserveEnd)
+        {
+            uint32 first;
+            if (CharacterDatabase.ReserveRange("instance_reserve", "next_id", reserveSize, first))
+            {
+                i_MaxInstanceId = first - 1;
+                i_InstanceIdReserveEnd = first - 1 + reserveSize;
+            }
+            else
+                { sLog.outError("MapManager: can't reserve instance ids from table `instance_reserve`, the id %u may be used by another server", i_MaxInstanceId + 1); }
+        }
+    }
+
+    return ++i_MaxInstanceId;
 }
 
 uint32 MapManager::GetNumInstances()
@@ -282,6 +359,14 @@ uint32 MapManager::GetNumPlayersInInstances()
     return ret;
 }
 
+uint32 MapManager::GetLoadedGridCount() const
+{
+    uint32 ret = 0;
+    for (MapMapType::const_iterator itr = i_maps.begin(); itr != i_maps.end(); ++itr)
+        { ret += itr->second->GetLoadedGridCount(); }
+    return ret;
+}
+
 ///// returns a new or existing Instance
 ///// in case of battlegrounds it will only return an existing map, those maps are created by bg-system
 Map* MapManager::CreateInstance(uint32 id, Player* player)
@@ -30,6 +30,9 @@
 #include "Policies/Singleton.h"
 #include <ace/Recursive_Thread_Mutex.h>
 #include "Map.h"
+#include "MapUpdater.h"
+#include "TerrainLoader.h"
+#include "PathFinderQueue.h"
 #include "GridStates.h"
 
 class Transport;
@@ -77,6 +80,15 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         void Initialize(void);
         void Update(uint32);
 
+        // thread pool for map updates, inactive if maps are updated by the world thread
+        MapUpdater& GetMapUpdater() { return m_updater; }
+        TerrainLoader& GetTerrainLoader() { return m_terrainLoader; }
+        PathFinderQueue& GetPathFinderQueue() { return m_pathFinderQueue; }
+        // true while maps are updated by the thread pool, actions touching other maps must be deferred, see Map::DeferTeleport
+        bool IsUpdatingMaps() const { return m_updatingMaps; }
+        uint32 GetLastDeferredActionCount() const { return m_deferredActionCount; }
+        uint32 GetLastDeferredActionTime() const { return m_deferredActionTime; }
+
         void SetGridCleanUpDelay(uint32 t)
         {
             if (t < MIN_GRID_DELAY)
@@ -145,13 +157,14 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         typedef std::map<uint32, TransportSet> TransportMap;
         TransportMap m_TransportsByMap;
 
-        uint32 GenerateInstanceId() { return ++i_MaxInstanceId; }
+        uint32 GenerateInstanceId();
         void InitMaxInstanceId();
         void InitializeVisibilityDistanceInfo();
 
         /* statistics */
         uint32 GetNumInstances();
         uint32 GetNumPlayersInInstances();
+        uint32 GetLoadedGridCount() const;
 
 
         // get list of all maps
@@ -184,8 +197,15 @@ class MANGOS_DLL_DECL MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::
         uint32 i_gridCleanUpDelay;
         MapMapType i_maps;
         IntervalTimer i_timer;
+        MapUpdater m_updater;
+        TerrainLoader m_terrainLoader;
+        PathFinderQueue m_pathFinderQueue;
+        bool m_updatingMaps;
+        uint32 m_deferredActionCount;                       // applied after the last map update
+        uint32 m_deferredActionTime;                        // in ms
 
         uint32 i_MaxInstanceId;
+        uint32 i_InstanceIdReserveEnd;                      // last id of the block reserved with Instance.IdReserveSize
 };
 
 template<typename Do>
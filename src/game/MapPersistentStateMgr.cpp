@@ -825,6 +825,7 @@ void MapPersistentStateManager::_ResetOrWarnAll(uint32 mapid, bool warn, uint32
         { return; }
 
     time_t now = time(NULL);
+    std::set<uint32> instances;
 
     if (!warn)
     {
@@ -836,19 +837,12 @@ void MapPersistentStateManager::_ResetOrWarnAll(uint32 mapid, bool warn, uint32
             return;
         }
 
-        // remove all binds to instances of the given map
-        for (PersistentStateMap::iterator itr = m_instanceSaveByInstanceId.begin(); itr != m_instanceSaveByInstanceId.end();)
-        {
-            if (itr->second->GetMapId() == mapid)
-                { _ResetSave(m_instanceSaveByInstanceId, itr); }
-            else
-                { ++itr; }
-        }
-
-        // delete them from the DB, even if not loaded
+        // delete them from the DB, even if not loaded, in set based statements for the whole map
         CharacterDatabase.BeginTransaction();
         CharacterDatabase.PExecute("DELETE FROM character_instance USING character_instance LEFT JOIN instance ON character_instance.instance = id WHERE map = '%u'", mapid);
         CharacterDatabase.PExecute("DELETE FROM group_instance USING group_instance LEFT JOIN instance ON group_instance.instance = id WHERE map = '%u'", mapid);
+        CharacterDatabase.PExecute("DELETE FROM creature_respawn USING creature_respawn JOIN instance ON creature_respawn.instance = id WHERE map = '%u'", mapid);
+        CharacterDatabase.PExecute("DELETE FROM gameobject_respawn USING gameobject_respawn JOIN instance ON gameobject_respawn.instance = id WHERE map = '%u'", mapid);
         CharacterDatabase.PExecute("DELETE FROM instance WHERE map = '%u'", mapid);
         CharacterDatabase.CommitTransaction();
 
@@ -856,6 +850,13 @@ void MapPersistentStateManager::_ResetOrWarnAll(uint32 mapid, bool warn, uint32
         time_t next_reset = DungeonResetScheduler::CalculateNextResetTime(temp, now + timeLeft);
         // update it in the DB
         CharacterDatabase.PExecute("UPDATE instance_reset SET resettime = '" UI64FMTD "' WHERE mapid = '%u'", (uint64)next_reset, mapid);
+
+        // the binds and maps are reset over the next updates, a weekly raid reset would stall a single one
+        for (PersistentStateMap::const_iterator itr = m_instanceSaveByInstanceId.begin(); itr != m_instanceSaveByInstanceId.end(); ++itr)
+        {
+            if (itr->second->GetMapId() == mapid)
+                { instances.insert(itr->first); }
+        }
     }
 
     // note: this isn't fast but it's meant to be executed very rarely
@@ -871,7 +872,39 @@ void MapPersistentStateManager::_ResetOrWarnAll(uint32 mapid, bool warn, uint32
         if (warn)
             { ((DungeonMap*)map2)->SendResetWarnings(timeLeft); }
         else
-            { ((DungeonMap*)map2)->Reset(INSTANCE_RESET_GLOBAL); }
+            { instances.insert(map2->GetInstanceId()); }
+    }
+
+    for (std::set<uint32>::const_iterator itr = instances.begin(); itr != instances.end(); ++itr)
+        { m_pendingGlobalResets.push_back(std::make_pair(mapid, *itr)); }
+}
+
+void MapPersistentStateManager::_ResetPendingInstances(uint32 count)
+{
+    while (!m_pendingGlobalResets.empty() && count--)
+    {
+        uint32 mapId = m_pendingGlobalResets.front().first;
+        uint32 instanceId = m_pendingGlobalResets.front().second;
+        m_pendingGlobalResets.pop_front();
+
+        // remove all binds to the instance
+        PersistentStateMap::iterator itr = m_instanceSaveByInstanceId.find(instanceId);
+        if (itr != m_instanceSaveByInstanceId.end())
+            { _ResetSave(m_instanceSaveByInstanceId, itr); }
+
+        if (Map* map = sMapMgr.FindMap(mapId, instanceId))
+            { ((DungeonMap*)map)->Reset(INSTANCE_RESET_GLOBAL); }
+    }
+}
+
+void MapPersistentStateManager::Update()
+{
+    m_Scheduler.Update();
+
+    if (!m_pendingGlobalResets.empty())
+    {
+        uint32 count = sWorld.getConfig(CONFIG_UINT32_INSTANCE_RESETS_PER_UPDATE);
+        _ResetPendingInstances(count ? count : uint32(m_pendingGlobalResets.size()));
     }
 }
 
@@ -350,12 +350,17 @@ class MANGOS_DLL_DECL MapPersistentStateManager : public MaNGOS::Singleton<MapPe
 
         void GetStatistics(uint32& numStates, uint32& numBoundPlayers, uint32& numBoundGroups);
 
-        void Update() { m_Scheduler.Update(); }
+        void Update();
     private:
         typedef UNORDERED_MAP < uint32 /*InstanceId or MapId*/, MapPersistentState* > PersistentStateMap;
 
+        // instances of a global reset still to be unbound and reset, their DB rows are deleted already
+        typedef std::deque < std::pair < uint32 /*mapId*/, uint32 /*instanceId*/ > > PendingResetQueue;
+        PendingResetQueue m_pendingGlobalResets;
+
         //  called by scheduler for DungeonPersistentStates
         void _ResetOrWarnAll(uint32 mapid, bool warn, uint32 timeleft);
+        void _ResetPendingInstances(uint32 count);
         void _ResetInstance(uint32 mapid, uint32 instanceId);
         void _CleanupExpiredInstancesAtTime(time_t t);
 
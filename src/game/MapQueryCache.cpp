@@ -0,0 +1,100 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "MapQueryCache.h"
+
+#include <algorithm>
+
+MapQueryCache::MapQueryCache() :
+    m_lineOfSight(MAP_QUERY_CACHE_SIZE), m_height(MAP_QUERY_CACHE_SIZE), m_generation(1)
+{
+}
+
+void MapQueryCache::MakeKey(float x1, float y1, float z1, float x2, float y2, float z2, int32* key)
+{
+    int32 src[3] = { Round(x1), Round(y1), Round(z1) };
+    int32 dest[3] = { Round(x2), Round(y2), Round(z2) };
+
+    if (std::lexicographical_compare(dest, dest + 3, src, src + 3))
+        { std::swap_ranges(src, src + 3, dest); }
+
+    std::copy(src, src + 3, key);
+    std::copy(dest, dest + 3, key + 3);
+}
+
+uint32 MapQueryCache::Hash(int32 const* key, size_t count)
+{
+    uint32 hash = 2166136261u;
+    for (size_t i = 0; i < count; ++i)
+        { hash = (hash ^ uint32(key[i])) * 16777619u; }
+
+    return hash ^ (hash >> 15);
+}
+
+bool MapQueryCache::GetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, bool& inLineOfSight) const
+{
+    int32 key[6];
+    MakeKey(x1, y1, z1, x2, y2, z2, key);
+
+    LineOfSightEntry const& entry = m_lineOfSight[Hash(key, 6) & (MAP_QUERY_CACHE_SIZE - 1)];
+    if (entry.generation != m_generation || !std::equal(key, key + 6, entry.key))
+        { return false; }
+
+    inLineOfSight = entry.inLineOfSight;
+    return true;
+}
+
+void MapQueryCache::SetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, bool inLineOfSight)
+{
+    int32 key[6];
+    MakeKey(x1, y1, z1, x2, y2, z2, key);
+
+    LineOfSightEntry& entry = m_lineOfSight[Hash(key, 6) & (MAP_QUERY_CACHE_SIZE - 1)];
+    std::copy(key, key + 6, entry.key);
+    entry.generation = m_generation;
+    entry.inLineOfSight = inLineOfSight;
+}
+
+bool MapQueryCache::GetHeight(float x, float y, float z, float& height) const
+{
+    int32 key[3] = { Round(x), Round(y), Round(z) };
+
+    HeightEntry const& entry = m_height[Hash(key, 3) & (MAP_QUERY_CACHE_SIZE - 1)];
+    if (entry.generation != m_generation || !std::equal(key, key + 3, entry.key))
+        { return false; }
+
+    height = entry.height;
+    return true;
+}
+
+void MapQueryCache::SetHeight(float x, float y, float z, float height)
+{
+    int32 key[3] = { Round(x), Round(y), Round(z) };
+
+    HeightEntry& entry = m_height[Hash(key, 3) & (MAP_QUERY_CACHE_SIZE - 1)];
+    std::copy(key, key + 3, entry.key);
+    entry.generation = m_generation;
+    entry.height = height;
+}
@@ -0,0 +1,92 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_MAPQUERYCACHE_H
+#define MANGOS_MAPQUERYCACHE_H
+
+#include "Common.h"
+
+#include <vector>
+
+// edge of the cubes the query coordinates are rounded to
+#define MAP_QUERY_CACHE_STEP 0.25f
+// entries of each query kind, power of two
+#define MAP_QUERY_CACHE_SIZE 1024
+
+/**
+ * Short lived results of the line of sight and height queries of a map.
+ *
+ * AI and spell code asks the same or almost the same questions many times per tick, like casters checking
+ * their target every update or position selection probing the same points. The cache keeps the results by
+ * the coordinates rounded to MAP_QUERY_CACHE_STEP, so points in the same small cube share one result.
+ * Each kind is a direct mapped table, a colliding query just replaces the older result.
+ *
+ * All entries are dropped by Invalidate, which the map calls when its dynamic tree changes (doors, models
+ * of game objects) and when the configured life time of the results passed. Map wraps the calls with its
+ * region lock, see Map::IsInLineOfSight.
+ */
+class MANGOS_DLL_SPEC MapQueryCache
+{
+    public:
+        MapQueryCache();
+
+        bool GetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, bool& inLineOfSight) const;
+        void SetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, bool inLineOfSight);
+
+        bool GetHeight(float x, float y, float z, float& height) const;
+        void SetHeight(float x, float y, float z, float height);
+
+        void Invalidate() { ++m_generation; }
+
+    private:
+        struct LineOfSightEntry
+        {
+            LineOfSightEntry() : generation(0), inLineOfSight(false) { memset(key, 0, sizeof(key)); }
+
+            int32 key[6];
+            uint32 generation;                              // entry is valid while it matches m_generation
+            bool inLineOfSight;
+        };
+
+        struct HeightEntry
+        {
+            HeightEntry() : generation(0), height(0.0f) { memset(key, 0, sizeof(key)); }
+
+            int32 key[3];
+            uint32 generation;
+            float height;
+        };
+
+        static int32 Round(float c) { return int32(floor(c / MAP_QUERY_CACHE_STEP)); }
+        // both directions of a ray share one entry
+        static void MakeKey(float x1, float y1, float z1, float x2, float y2, float z2, int32* key);
+        static uint32 Hash(int32 const* key, size_t count);
+
+        std::vector<LineOfSightEntry> m_lineOfSight;
+        std::vector<HeightEntry> m_height;
+        uint32 m_generation;
+};
+
+#endif
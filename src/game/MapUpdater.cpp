@@ -0,0 +1,204 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "MapUpdater.h"
+#include "Map.h"
+#include "Log.h"
+#include "Database/DatabaseEnv.h"
+#include "Config/Config.h"
+#include "Threading.h"
+#include "Profiler.h"
+
+#include <ace/Guard_T.h>
+
+MapUpdater::MapUpdater() :
+    m_queueCondition(m_lock),
+    m_doneCondition(m_lock),
+    m_threadCount(0),
+    m_startedThreads(0),
+    m_stopping(false)
+{
+}
+
+MapUpdater::~MapUpdater()
+{
+    Deactivate();
+}
+
+int MapUpdater::Activate(uint32 numThreads)
+{
+    if (IsActive() || numThreads == 0)
+        { return 0; }
+
+    m_stopping = false;
+    m_startedThreads = 0;
+    m_affinity = sConfig.GetStringDefault("Affinity.MapUpdate", "");
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, int(numThreads)) == -1)
+    {
+        sLog.outError("MapUpdater: can't start %u map update threads, maps will be updated by the world thread", numThreads);
+        return -1;
+    }
+
+    m_threadCount = numThreads;
+    return 0;
+}
+
+void MapUpdater::Deactivate()
+{
+    if (!IsActive())
+        { return; }
+
+    Wait();
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stopping = true;
+        m_queueCondition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+    m_threadCount = 0;
+}
+
+void MapUpdater::UpdateRequest::Execute() const
+{
+    SyncQueryAudit::Context auditContext("MapUpdater");
+
+    switch (m_type)
+    {
+        case REQUEST_UPDATE_MAP:
+            m_map->Update(m_diff);
+            break;
+        case REQUEST_UPDATE_REGION:
+            m_map->UpdateRegion(m_param, m_diff);
+            break;
+        case REQUEST_SEND_OBJECT_UPDATES:
+            m_map->SendObjectUpdatesPart(m_param);
+            break;
+    }
+}
+
+void MapUpdater::Schedule(UpdateRequest const& request)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    m_queue.push_back(request);
+    ++request.m_batch->m_pendingRequests;
+    m_queueCondition.signal();
+}
+
+void MapUpdater::ScheduleUpdate(Map& map, uint32 diff)
+{
+    Schedule(UpdateRequest(REQUEST_UPDATE_MAP, &map, 0, diff, &m_mapBatch));
+}
+
+void MapUpdater::ScheduleRegionUpdate(Map& map, uint32 regionId, uint32 diff, Batch& batch)
+{
+    Schedule(UpdateRequest(REQUEST_UPDATE_REGION, &map, regionId, diff, &batch));
+}
+
+void MapUpdater::ScheduleObjectUpdatesSend(Map& map, uint32 part, Batch& batch)
+{
+    Schedule(UpdateRequest(REQUEST_SEND_OBJECT_UPDATES, &map, part, 0, &batch));
+}
+
+void MapUpdater::Wait(Batch& batch)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    while (batch.m_pendingRequests > 0)
+    {
+        RequestQueue::iterator itr = m_queue.begin();
+        while (itr != m_queue.end() && itr->m_batch != &batch)
+            { ++itr; }
+
+        if (itr == m_queue.end())
+        {
+            // everything left is already executed by other threads
+            m_doneCondition.wait();
+            continue;
+        }
+
+        UpdateRequest request = *itr;
+        m_queue.erase(itr);
+
+        guard.release();
+        request.Execute();
+        guard.acquire();
+
+        if (--batch.m_pendingRequests == 0)
+            { m_doneCondition.broadcast(); }
+    }
+}
+
+void MapUpdater::RequestDone(Batch& batch)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    MANGOS_ASSERT(batch.m_pendingRequests > 0);
+    if (--batch.m_pendingRequests == 0)
+        { m_doneCondition.broadcast(); }
+}
+
+int MapUpdater::svc()
+{
+    WorldDatabase.ThreadStart();                            // let thread do safe mySQL requests
+    SyncQueryAudit::MarkThread();
+    sTickProfiler.SetThreadName("map update");
+
+    uint32 index;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        index = m_startedThreads++;
+    }
+
+    if (!ACE_Based::Thread::setCurrentAffinity(m_affinity, index))
+        { sLog.outError("Affinity.MapUpdate '%s' is invalid or not supported, map update thread not bound", m_affinity.c_str()); }
+
+    for (;;)
+    {
+        UpdateRequest request(REQUEST_UPDATE_MAP, NULL, 0, 0, NULL);
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            while (m_queue.empty() && !m_stopping)
+                { m_queueCondition.wait(); }
+
+            if (m_queue.empty())
+                { break; }                                  // stopping and nothing left to do
+
+            request = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        request.Execute();
+        RequestDone(*request.m_batch);
+    }
+
+    WorldDatabase.ThreadEnd();                              // free mySQL thread resources
+
+    return 0;
+}
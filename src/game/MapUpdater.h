@@ -0,0 +1,125 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_MAPUPDATER_H
+#define MANGOS_MAPUPDATER_H
+
+#include "Common.h"
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+class Map;
+
+/**
+ * Thread pool running independent Map::Update calls of one world tick at the same time.
+ *
+ * MapManager schedules every map of the tick with ScheduleUpdate() and then joins with Wait(),
+ * so all cross-map work done after the join point (transports, remove lists, map unloading)
+ * still runs on the world thread only.
+ *
+ * Continents split into regions (see Map::UpdateRegions) schedule their region passes, and maps with
+ * many players their packet building (see Map::SendObjectUpdates), into the same pool as a separate
+ * batch. A thread waiting for a batch executes the queued requests of that batch itself, so nested
+ * waits from inside a worker can't starve the pool.
+ */
+class MapUpdater : protected ACE_Task_Base
+{
+    public:
+        /// Group of requests that can be waited for together
+        class Batch
+        {
+                friend class MapUpdater;
+
+            public:
+                Batch() : m_pendingRequests(0) {}
+
+            private:
+                uint32 m_pendingRequests;                   // queued + currently executed requests
+        };
+
+        MapUpdater();
+        virtual ~MapUpdater();
+
+        /// Start numThreads worker threads, no-op for 0 (maps are updated by the world thread then)
+        int Activate(uint32 numThreads);
+        /// Stop and join all worker threads, pending requests are still executed
+        void Deactivate();
+        bool IsActive() const { return m_threadCount > 0; }
+        uint32 GetThreadCount() const { return m_threadCount; }
+
+        void ScheduleUpdate(Map& map, uint32 diff);
+        /// Block until all scheduled map updates are finished
+        void Wait() { Wait(m_mapBatch); }
+
+        void ScheduleRegionUpdate(Map& map, uint32 regionId, uint32 diff, Batch& batch);
+        void ScheduleObjectUpdatesSend(Map& map, uint32 part, Batch& batch);
+        /// Block until all requests of the batch are finished, executing its queued requests meanwhile
+        void Wait(Batch& batch);
+
+    protected:
+        int svc() override;
+
+    private:
+        enum RequestType
+        {
+            REQUEST_UPDATE_MAP,
+            REQUEST_UPDATE_REGION,
+            REQUEST_SEND_OBJECT_UPDATES
+        };
+
+        struct UpdateRequest
+        {
+            UpdateRequest(RequestType type, Map* map, uint32 param, uint32 diff, Batch* batch) :
+                m_type(type), m_map(map), m_param(param), m_diff(diff), m_batch(batch) {}
+
+            void Execute() const;
+
+            RequestType m_type;
+            Map* m_map;
+            uint32 m_param;                                 // region or part passed to the map
+            uint32 m_diff;
+            Batch* m_batch;
+        };
+
+        typedef std::deque<UpdateRequest> RequestQueue;
+
+        void Schedule(UpdateRequest const& request);
+        void RequestDone(Batch& batch);
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_queueCondition;        // signaled when requests are queued or at stop
+        ACE_Condition_Thread_Mutex m_doneCondition;         // signaled when the last request of a batch is finished
+
+        RequestQueue m_queue;
+        Batch m_mapBatch;
+        uint32 m_threadCount;
+        uint32 m_startedThreads;                            // index of the next thread for Affinity.MapUpdate
+        std::string m_affinity;
+        bool m_stopping;
+};
+
+#endif
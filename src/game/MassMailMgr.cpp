@@ -84,6 +84,9 @@ void MassMailMgr::Update(bool sendall /*= false*/)
 
     uint32 maxcount = sWorld.getConfig(CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK);
 
+    // the rows of all mails of this tick are written by a few multi-row inserts
+    MailInsertBatch batch;
+
     do
     {
         MassMail& task = m_massMails.front();
@@ -100,7 +103,7 @@ void MassMailMgr::Update(bool sendall /*= false*/)
             if (task.m_receivers.empty())
             {
                 // prevent mail return
-                task.m_protoMail->SendMailTo(MailReceiver(receiver, receiver_guid), task.m_sender, MAIL_CHECK_MASK_RETURNED);
+                task.m_protoMail->SendMailTo(MailReceiver(receiver, receiver_guid), task.m_sender, MAIL_CHECK_MASK_RETURNED, 0, &batch);
 
                 if (!sendall)
                     { --maxcount; }
@@ -112,7 +115,7 @@ void MassMailMgr::Update(bool sendall /*= false*/)
             draft.CloneFrom(*task.m_protoMail);
 
             // prevent mail return
-            draft.SendMailTo(MailReceiver(receiver, receiver_guid), task.m_sender, MAIL_CHECK_MASK_RETURNED);
+            draft.SendMailTo(MailReceiver(receiver, receiver_guid), task.m_sender, MAIL_CHECK_MASK_RETURNED, 0, &batch);
 
             if (!sendall)
                 { --maxcount; }
@@ -122,6 +125,10 @@ void MassMailMgr::Update(bool sendall /*= false*/)
             { m_massMails.pop_front(); }
     }
     while (!m_massMails.empty() && (sendall || maxcount > 0));
+
+    CharacterDatabase.BeginTransaction();
+    batch.Execute();
+    CharacterDatabase.CommitTransaction();
 }
 
 void MassMailMgr::GetStatistic(uint32& tasks, uint32& mails, uint32& needTime) const
@@ -94,17 +94,17 @@ void MotionMaster::UpdateMotion(uint32 diff)
     else
         { m_cleanFlag &= ~MMCF_UPDATE; }
 
-    if (m_expList)
+    if (m_cleanFlag & MMCF_EXPIRED)
     {
-        for (size_t i = 0; i < m_expList->size(); ++i)
+        for (size_t i = 0; i < m_expList.size(); ++i)
         {
-            MovementGenerator* mg = (*m_expList)[i];
+            MovementGenerator* mg = m_expList[i];
             if (!isStatic(mg))
                 { delete mg; }
         }
 
-        delete m_expList;
-        m_expList = NULL;
+        m_expList.clear();
+        m_cleanFlag &= ~MMCF_EXPIRED;
 
         if (empty())
             { Initialize(); }
@@ -146,8 +146,11 @@ void MotionMaster::DelayedClean(bool reset, bool all)
     if (empty() || (!all && size() == 1))
         { return; }
 
-    if (!m_expList)
-        { m_expList = new ExpireList(); }
+    if (!(m_cleanFlag & MMCF_EXPIRED))
+    {
+        m_expList.reserve(MOTION_MASTER_STACK_RESERVE);
+        m_cleanFlag |= MMCF_EXPIRED;
+    }
 
     while (all ? !empty() : size() > 1)
     {
@@ -156,7 +159,7 @@ void MotionMaster::DelayedClean(bool reset, bool all)
         curr->Finalize(*m_owner);
 
         if (!isStatic(curr))
-            { m_expList->push_back(curr); }
+            { m_expList.push_back(curr); }
     }
 }
 
@@ -206,8 +209,11 @@ void MotionMaster::DelayedExpire(bool reset)
     MovementGenerator* curr = top();
     pop();
 
-    if (!m_expList)
-        { m_expList = new ExpireList(); }
+    if (!(m_cleanFlag & MMCF_EXPIRED))
+    {
+        m_expList.reserve(MOTION_MASTER_STACK_RESERVE);
+        m_cleanFlag |= MMCF_EXPIRED;
+    }
 
     // also drop stored under top() targeted motions
     while (!empty() && (top()->GetMovementGeneratorType() == CHASE_MOTION_TYPE || top()->GetMovementGeneratorType() == FOLLOW_MOTION_TYPE))
@@ -215,13 +221,13 @@ void MotionMaster::DelayedExpire(bool reset)
         MovementGenerator* temp = top();
         pop();
         temp ->Finalize(*m_owner);
-        m_expList->push_back(temp);
+        m_expList.push_back(temp);
     }
 
     curr->Finalize(*m_owner);
 
     if (!isStatic(curr))
-        { m_expList->push_back(curr); }
+        { m_expList.push_back(curr); }
 }
 
 void MotionMaster::MoveIdle()
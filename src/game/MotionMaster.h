@@ -61,17 +61,24 @@ enum MMCleanFlag
 {
     MMCF_NONE   = 0,
     MMCF_UPDATE = 1,                                        // Clear or Expire called from update
-    MMCF_RESET  = 2                                         // Flag if need top()->Reset()
+    MMCF_RESET  = 2,                                        // Flag if need top()->Reset()
+    MMCF_EXPIRED = 4                                        // Generators removed during update wait in m_expList
 };
 
-class MANGOS_DLL_SPEC MotionMaster : private std::stack<MovementGenerator*>
+// generators usually stacked at once, both containers keep their capacity
+#define MOTION_MASTER_STACK_RESERVE 4
+
+class MANGOS_DLL_SPEC MotionMaster : private std::stack<MovementGenerator*, std::vector<MovementGenerator*> >
 {
     private:
-        typedef std::stack<MovementGenerator*> Impl;
+        typedef std::stack<MovementGenerator*, std::vector<MovementGenerator*> > Impl;
         typedef std::vector<MovementGenerator*> ExpireList;
 
     public:
-        explicit MotionMaster(Unit* unit) : m_owner(unit), m_expList(NULL), m_cleanFlag(MMCF_NONE) {}
+        explicit MotionMaster(Unit* unit) : m_owner(unit), m_cleanFlag(MMCF_NONE)
+        {
+            Impl::c.reserve(MOTION_MASTER_STACK_RESERVE);
+        }
         ~MotionMaster();
 
         void Initialize();
@@ -134,7 +141,7 @@ class MANGOS_DLL_SPEC MotionMaster : private std::stack<MovementGenerator*>
         void DelayedExpire(bool reset);
 
         Unit*       m_owner;
-        ExpireList* m_expList;
+        ExpireList  m_expList;
         uint8       m_cleanFlag;
 };
 #endif
@@ -28,6 +28,30 @@
 
 #include "MoveMap.h"
 #include "MoveMapSharedDefines.h"
+#include "MemoryTracker.h"
+
+#include <zlib/zlib.h>
+
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+
+#include <algorithm>
+
+/// Index of a thread into the per map query lists, the threads calculating paths never share a query
+struct NavMeshQuerySlot
+{
+    NavMeshQuerySlot() : index(uint32(++s_usedSlots - 1)) {}
+
+    uint32 index;
+
+    static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_usedSlots;
+};
+
+ACE_Atomic_Op<ACE_Thread_Mutex, long> NavMeshQuerySlot::s_usedSlots(0);
+
+typedef ACE_TSS<NavMeshQuerySlot> NavMeshQuerySlotTSS;
+static NavMeshQuerySlotTSS navMeshQuerySlot;
 
 namespace MMAP
 {
@@ -138,6 +162,7 @@ namespace MMAP
         // store inside our map list
         MMapData* mmap_data = new MMapData(mesh);
         mmap_data->mmapLoadedTiles.clear();
+        openArchive(mapId, mmap_data);
 
         loadedMMaps.insert(std::pair<uint32, MMapData*>(mapId, mmap_data));
         return true;
@@ -150,6 +175,8 @@ namespace MMAP
 
     bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
     {
+        ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, false);
+
         // make sure the mmap is loaded and ready to load tiles
         if (!loadMapData(mapId))
             { return false; }
@@ -166,7 +193,36 @@ namespace MMAP
             return false;
         }
 
-        // load this tile :: mmaps/MMMXXYY.mmtile
+        // load this tile :: from mmaps/MMM.mmtiles or mmaps/MMMXXYY.mmtile
+        uint32 dataSize = 0;
+        unsigned char* data = readArchiveTile(mmap, mapId, x, y, dataSize);
+        if (!data)
+            { data = readTileFile(mapId, x, y, dataSize); }
+
+        if (!data)
+            { return false; }
+
+        dtMeshHeader* header = (dtMeshHeader*)data;
+        dtTileRef tileRef = 0;
+
+        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
+        if (dtStatusFailed(mmap->navMesh->addTile(data, int(dataSize), DT_TILE_FREE_DATA, 0, &tileRef)))
+        {
+            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
+            dtFree(data);
+            return false;
+        }
+
+        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+        MemoryTracker::Allocate(MEM_TAG_MMAP, dataSize);
+        mmap->pathCache.Clear();                            // shorter corridors through the new tile
+        ++loadedTiles;
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
+        return true;
+    }
+
+    unsigned char* MMapManager::readTileFile(uint32 mapId, int32 x, int32 y, uint32& size)
+    {
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i%02i%02i.mmtile") + 1;
         char* fileName = new char[pathLen];
         snprintf(fileName, pathLen, (sWorld.GetDataPath() + "mmaps/%03i%02i%02i.mmtile").c_str(), mapId, x, y);
@@ -176,7 +232,7 @@ namespace MMAP
         {
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "ERROR: MMAP:loadMap: Could not open mmtile file '%s'", fileName);
             delete[] fileName;
-            return false;
+            return NULL;
         }
         delete[] fileName;
 
@@ -188,14 +244,14 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: Could not load mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         if (fileHeader.mmapMagic != MMAP_MAGIC)
         {
             sLog.outError("MMAP:loadMap: Bad header in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         if (fileHeader.mmapVersion != MMAP_VERSION)
@@ -203,7 +259,7 @@ namespace MMAP
             sLog.outError("MMAP:loadMap: %03u%02i%02i.mmtile was built with generator v%i, expected v%i",
                           mapId, x, y, fileHeader.mmapVersion, MMAP_VERSION);
             fclose(file);
-            return false;
+            return NULL;
         }
 
         unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
@@ -214,30 +270,119 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
-            return false;
+            dtFree(data);
+            return NULL;
         }
 
         fclose(file);
 
-        dtMeshHeader* header = (dtMeshHeader*)data;
-        dtTileRef tileRef = 0;
+        size = fileHeader.size;
+        return data;
+    }
 
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        if (dtStatusFailed(mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef)))
+    void MMapManager::openArchive(uint32 mapId, MMapData* mmap)
+    {
+        uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i.mmtiles") + 1;
+        char* fileName = new char[pathLen];
+        snprintf(fileName, pathLen, (sWorld.GetDataPath() + "mmaps/%03i.mmtiles").c_str(), mapId);
+
+        // without an archive the tiles are read from their own files
+        FILE* file = fopen(fileName, "rb");
+        delete[] fileName;
+        if (!file)
+            { return; }
+
+        MmapArchiveHeader header;
+        if (fread(&header, sizeof(MmapArchiveHeader), 1, file) != 1 || header.archiveMagic != MMAP_ARCHIVE_MAGIC ||
+            header.archiveVersion != MMAP_ARCHIVE_VERSION || header.tileCount > 64 * 64)
         {
-            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
+            sLog.outError("MMAP:openArchive: Bad header in %03u.mmtiles, reading the mmtile files", mapId);
+            fclose(file);
+            return;
+        }
+
+        if (header.mmapVersion != MMAP_VERSION || header.dtVersion != DT_NAVMESH_VERSION)
+        {
+            sLog.outError("MMAP:openArchive: %03u.mmtiles was built with generator v%i, expected v%i, reading the mmtile files",
+                          mapId, header.mmapVersion, MMAP_VERSION);
+            fclose(file);
+            return;
+        }
+
+        std::vector<MmapArchiveTile> tiles(header.tileCount);
+        if (header.tileCount && fread(&tiles[0], sizeof(MmapArchiveTile), header.tileCount, file) != header.tileCount)
+        {
+            sLog.outError("MMAP:openArchive: Bad index in %03u.mmtiles, reading the mmtile files", mapId);
+            fclose(file);
+            return;
+        }
+
+        for (std::vector<MmapArchiveTile>::const_iterator itr = tiles.begin(); itr != tiles.end(); ++itr)
+            { mmap->archiveTiles[itr->tileId] = *itr; }
+
+        mmap->archive = file;
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:openArchive: Opened %03i.mmtiles with %u tiles", mapId, header.tileCount);
+    }
+
+    unsigned char* MMapManager::readArchiveTile(MMapData* mmap, uint32 mapId, int32 x, int32 y, uint32& size)
+    {
+        if (!mmap->archive)
+            { return NULL; }
+
+        MMapArchiveIndex::const_iterator itr = mmap->archiveTiles.find(packTileID(x, y));
+        if (itr == mmap->archiveTiles.end())
+            { return NULL; }
+
+        MmapArchiveTile const& tile = itr->second;
+        if (!tile.size || !tile.storedSize)
+            { return NULL; }
+
+        unsigned char* data = (unsigned char*)dtAlloc(tile.size, DT_ALLOC_PERM);
+        MANGOS_ASSERT(data);
+
+        bool read = fseek(mmap->archive, long(tile.offset), SEEK_SET) == 0;
+        if (read && (tile.flags & MMAP_ARCHIVE_TILE_COMPRESSED))
+        {
+            std::vector<unsigned char> stored(tile.storedSize);
+            uLongf unpackedSize = tile.size;
+            read = fread(&stored[0], tile.storedSize, 1, mmap->archive) == 1 &&
+                   uncompress(data, &unpackedSize, &stored[0], tile.storedSize) == Z_OK && unpackedSize == tile.size;
+        }
+        else if (read)
+            { read = fread(data, tile.size, 1, mmap->archive) == 1; }
+
+        if (!read)
+        {
+            sLog.outError("MMAP:loadMap: Bad data of tile %02i,%02i in %03u.mmtiles, reading the mmtile file", x, y, mapId);
             dtFree(data);
-            return false;
+            return NULL;
         }
 
-        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
-        ++loadedTiles;
-        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
-        return true;
+        size = tile.size;
+        return data;
+    }
+
+    uint32 MMapManager::getTileDataSize(uint32 mapId, int32 x, int32 y)
+    {
+        ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, 0);
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            { return 0; }
+
+        MMapData* mmap = itr->second;
+        MMapTileSet::const_iterator tile = mmap->mmapLoadedTiles.find(packTileID(x, y));
+        if (tile == mmap->mmapLoadedTiles.end())
+            { return 0; }
+
+        dtMeshTile const* meshTile = mmap->navMesh->getTileByRef(tile->second);
+        return meshTile ? uint32(meshTile->dataSize) : 0;
     }
 
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
+        ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, false);
+
         // check if we have this map loaded
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
         {
@@ -258,6 +403,8 @@ namespace MMAP
         }
 
         dtTileRef tileRef = mmap->mmapLoadedTiles[packedGridPos];
+        dtMeshTile const* meshTile = mmap->navMesh->getTileByRef(tileRef);
+        int dataSize = meshTile ? meshTile->dataSize : 0;
 
         // unload, and mark as non loaded
         if (dtStatusFailed(mmap->navMesh->removeTile(tileRef, NULL, NULL)))
@@ -271,7 +418,9 @@ namespace MMAP
         else
         {
             mmap->mmapLoadedTiles.erase(packedGridPos);
+            mmap->pathCache.Clear();                        // corridors through the tile are invalid
             --loadedTiles;
+            MemoryTracker::Free(MEM_TAG_MMAP, size_t(dataSize));
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded mmtile %03i[%02i,%02i] from %03i", mapId, x, y, mapId);
             return true;
         }
@@ -281,6 +430,8 @@ namespace MMAP
 
     bool MMapManager::unloadMap(uint32 mapId)
     {
+        ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, false);
+
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
         {
             // file may not exist, therefore not loaded
@@ -294,11 +445,14 @@ namespace MMAP
         {
             uint32 x = (i->first >> 16);
             uint32 y = (i->first & 0x0000FFFF);
+            dtMeshTile const* meshTile = mmap->navMesh->getTileByRef(i->second);
+            int dataSize = meshTile ? meshTile->dataSize : 0;
             if (dtStatusFailed(mmap->navMesh->removeTile(i->second, NULL, NULL)))
                 { sLog.outError("MMAP:unloadMap: Could not unload %03u%02i%02i.mmtile from navmesh", mapId, x, y); }
             else
             {
                 --loadedTiles;
+                MemoryTracker::Free(MEM_TAG_MMAP, size_t(dataSize));
                 DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMap: Unloaded mmtile %03i[%02i,%02i] from %03i", mapId, x, y, mapId);
             }
         }
@@ -310,62 +464,108 @@ namespace MMAP
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
-    {
-        // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-        {
-            // file may not exist, therefore not loaded
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
-        }
-
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
-        {
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
-            return false;
-        }
-
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
-
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
-
-        return true;
-    }
-
     dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
+        ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, NULL);
+
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
             { return NULL; }
 
         return loadedMMaps[mapId]->navMesh;
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    dtNavMeshQuery const* MMapManager::GetThreadNavMeshQuery(uint32 mapId, dtNavMesh const*& navMesh)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        navMesh = NULL;
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
             { return NULL; }
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        NavMeshQuerySlot* slot = navMeshQuerySlot;          // taken at the first query of the thread
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_threadQueryLock, NULL);
+
+        MMapData* mmap = itr->second;
+        if (mmap->threadQueries.size() <= slot->index)
+            { mmap->threadQueries.resize(slot->index + 1, NULL); }
+
+        if (!mmap->threadQueries[slot->index])
         {
-            // allocate mesh query
             dtNavMeshQuery* query = dtAllocNavMeshQuery();
             MANGOS_ASSERT(query);
-            if (dtStatusFailed(query->init(mmap->navMesh, 1024)))
+            if (dtStatusFailed(query->init(mmap->navMesh, m_queryNodes)))
             {
                 dtFreeNavMeshQuery(query);
-                sLog.outError("MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
+                sLog.outError("MMAP:GetThreadNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u query slot %u", mapId, slot->index);
                 return NULL;
             }
 
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
+            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:GetThreadNavMeshQuery: created dtNavMeshQuery for mapId %03u query slot %u", mapId, slot->index);
+            mmap->threadQueries[slot->index] = query;
         }
 
-        return mmap->navMeshQueries[instanceId];
+        navMesh = mmap->navMesh;
+        return mmap->threadQueries[slot->index];
+    }
+
+    PathCache* MMapManager::GetPathCache(uint32 mapId)
+    {
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        return itr != loadedMMaps.end() ? &itr->second->pathCache : NULL;
+    }
+
+    // ######################## PathCache ########################
+    bool PathCache::Find(dtPolyRef start, dtPolyRef end, uint32 filterFlags, dtPolyRef* path, uint32& length, uint32 maxLength)
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
+        EntryIndex::iterator itr = m_index.find(Key(start, end, filterFlags));
+        if (itr == m_index.end())
+            { return false; }
+
+        std::vector<dtPolyRef> const& corridor = itr->second->second;
+        if (corridor.size() > maxLength)
+            { return false; }
+
+        m_entries.splice(m_entries.begin(), m_entries, itr->second);
+
+        length = corridor.size();
+        std::copy(corridor.begin(), corridor.end(), path);
+        return true;
+    }
+
+    void PathCache::Store(dtPolyRef start, dtPolyRef end, uint32 filterFlags, dtPolyRef const* path, uint32 length)
+    {
+        if (!m_maxEntries)
+            { return; }
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        Key key(start, end, filterFlags);
+        EntryIndex::iterator itr = m_index.find(key);
+        if (itr != m_index.end())
+        {
+            itr->second->second.assign(path, path + length);
+            m_entries.splice(m_entries.begin(), m_entries, itr->second);
+            return;
+        }
+
+        if (m_index.size() >= m_maxEntries)
+        {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+
+        m_entries.push_front(Entry(key, std::vector<dtPolyRef>(path, path + length)));
+        m_index.insert(EntryIndex::value_type(key, m_entries.begin()));
+    }
+
+    void PathCache::Clear()
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        m_entries.clear();
+        m_index.clear();
     }
 }
@@ -29,8 +29,17 @@
 #include "../../dep/recastnavigation/Detour/Include/DetourNavMesh.h"
 #include "../../dep/recastnavigation/Detour/Include/DetourNavMeshQuery.h"
 
+#include "MoveMapSharedDefines.h"
 #include "Utilities/UnorderedMapSet.h"
 
+#include <ace/RW_Thread_Mutex.h>
+#include <ace/Thread_Mutex.h>
+
+#include <cstdio>
+#include <list>
+#include <map>
+#include <vector>
+
 //  memory management
 inline void* dtCustomAlloc(int size, dtAllocHint /*hint*/)
 {
@@ -46,26 +55,76 @@ inline void dtCustomFree(void* ptr)
 namespace MMAP
 {
     typedef UNORDERED_MAP<uint32, dtTileRef> MMapTileSet;
-    typedef UNORDERED_MAP<uint32, dtNavMeshQuery*> NavMeshQuerySet;
+    typedef UNORDERED_MAP<uint32, MmapArchiveTile> MMapArchiveIndex;
+
+#define MMAP_PATH_CACHE_SIZE 256                            // corridors per map
+#define MMAP_DEFAULT_QUERY_NODES 2048                       // search nodes of a query, see mmap.queryNodes
+
+    // polygon corridors found by pathfinding, the least recently used ones are dropped when full
+    // shared by all threads calculating paths on the map, cleared when its tiles change
+    class PathCache
+    {
+        public:
+            explicit PathCache(uint32 maxEntries) : m_maxEntries(maxEntries) {}
+
+            // copies the corridor from start to end poly into path, false if there is none or it is longer than maxLength
+            bool Find(dtPolyRef start, dtPolyRef end, uint32 filterFlags, dtPolyRef* path, uint32& length, uint32 maxLength);
+            void Store(dtPolyRef start, dtPolyRef end, uint32 filterFlags, dtPolyRef const* path, uint32 length);
+            void Clear();
+
+        private:
+            struct Key
+            {
+                Key(dtPolyRef s, dtPolyRef e, uint32 f) : start(s), end(e), filterFlags(f) {}
+
+                bool operator<(Key const& other) const
+                {
+                    if (start != other.start)
+                        { return start < other.start; }
+                    if (end != other.end)
+                        { return end < other.end; }
+                    return filterFlags < other.filterFlags;
+                }
+
+                dtPolyRef start;
+                dtPolyRef end;
+                uint32 filterFlags;
+            };
+
+            typedef std::pair<Key, std::vector<dtPolyRef> > Entry;
+            typedef std::list<Entry> EntryList;             // most recently used first
+            typedef std::map<Key, EntryList::iterator> EntryIndex;
+
+            ACE_Thread_Mutex m_lock;
+            EntryList m_entries;
+            EntryIndex m_index;
+            uint32 m_maxEntries;
+    };
 
     // dummy struct to hold map's mmap data
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh) : navMesh(mesh), archive(NULL), pathCache(MMAP_PATH_CACHE_SIZE) {}
         ~MMapData()
         {
-            for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
-                { dtFreeNavMeshQuery(i->second); }
+            for (std::vector<dtNavMeshQuery*>::iterator i = threadQueries.begin(); i != threadQueries.end(); ++i)
+                { dtFreeNavMeshQuery(*i); }
 
             if (navMesh)
                 { dtFreeNavMesh(navMesh); }
+
+            if (archive)
+                { fclose(archive); }
         }
 
         dtNavMesh* navMesh;
 
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
+        // dtNavMeshQuery is not thread safe, every thread calculating paths on the map has its own for all instances
+        std::vector<dtNavMeshQuery*> threadQueries; // by query slot of the thread, NULL until it calculates a path
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
+        FILE* archive;                      // mmaps/MMM.mmtiles if there is one, open while the map is loaded
+        MMapArchiveIndex archiveTiles;      // tiles of the archive by [map grid coords]
+        PathCache pathCache;
     };
 
 
@@ -76,26 +135,46 @@ namespace MMAP
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), m_queryNodes(MMAP_DEFAULT_QUERY_NODES) {}
             ~MMapManager();
 
             bool loadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
 
+            // query of the calling thread and the nav mesh of the map, the caller holds GetLock() for reading
+            dtNavMeshQuery const* GetThreadNavMeshQuery(uint32 mapId, dtNavMesh const*& navMesh);
+
+            // search nodes of the queries created from now on
+            void SetQueryNodes(uint32 nodes) { m_queryNodes = nodes; }
+
+            // path cache of the map, the caller holds GetLock() for reading
+            PathCache* GetPathCache(uint32 mapId);
+
+            // held for reading while paths are calculated, tiles are only loaded and unloaded by writers
+            ACE_RW_Thread_Mutex& GetLock() { return m_lock; }
+
+            // bytes of the loaded tile, 0 if it is not loaded
+            uint32 getTileDataSize(uint32 mapId, int32 x, int32 y);
+
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
         private:
             bool loadMapData(uint32 mapId);
+            void openArchive(uint32 mapId, MMapData* mmap);
+            unsigned char* readArchiveTile(MMapData* mmap, uint32 mapId, int32 x, int32 y, uint32& size);
+            unsigned char* readTileFile(uint32 mapId, int32 x, int32 y, uint32& size);
             uint32 packTileID(int32 x, int32 y);
 
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+
+            uint32 m_queryNodes;
+
+            ACE_RW_Thread_Mutex m_lock;
+            ACE_Thread_Mutex m_threadQueryLock;         // threadQueries are created by readers
     };
 
     // static class
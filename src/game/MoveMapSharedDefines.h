@@ -43,6 +43,37 @@ struct MmapTileHeader
         mmapVersion(MMAP_VERSION), size(0), usesLiquids(true) {}
 };
 
+#define MMAP_ARCHIVE_MAGIC 0x4d4d4152   // 'MMAR'
+#define MMAP_ARCHIVE_VERSION 1
+
+// mmaps/MMM.mmtiles holds all tiles of a map: this header, tileCount MmapArchiveTile and the tile data
+struct MmapArchiveHeader
+{
+    uint32 archiveMagic;
+    uint32 archiveVersion;
+    uint32 dtVersion;
+    uint32 mmapVersion;
+    uint32 tileCount;
+
+    MmapArchiveHeader() : archiveMagic(MMAP_ARCHIVE_MAGIC), archiveVersion(MMAP_ARCHIVE_VERSION),
+        dtVersion(DT_NAVMESH_VERSION), mmapVersion(MMAP_VERSION), tileCount(0) {}
+};
+
+enum MmapArchiveTileFlags
+{
+    MMAP_ARCHIVE_TILE_COMPRESSED    = 0x01,                 // zlib stream, else the navmesh data as is
+    MMAP_ARCHIVE_TILE_LIQUIDS       = 0x02                  // MmapTileHeader::usesLiquids
+};
+
+struct MmapArchiveTile
+{
+    uint32 tileId;                                          // x << 16 | y of the MMMXXYY.mmtile name
+    uint32 offset;                                          // of the data from the file start
+    uint32 storedSize;                                      // bytes in the file
+    uint32 size;                                            // bytes of the navmesh data
+    uint32 flags;                                           // MmapArchiveTileFlags
+};
+
 enum NavTerrain
 {
     NAV_EMPTY   = 0x00,
@@ -25,6 +25,75 @@
 #include "MovementGenerator.h"
 #include "Unit.h"
 
+#include <ace/TSS_T.h>
+
+#define MOVEGEN_POOL_GRANULARITY    16                      // generator sizes are rounded up to this
+#define MOVEGEN_POOL_SIZE_CLASSES   16                      // larger generators are not pooled
+#define MOVEGEN_POOL_MAX_FREE       64                      // free blocks kept per size class and thread
+
+/// Free generator memory of one thread by size class
+struct MovementGeneratorPool
+{
+    ~MovementGeneratorPool()
+    {
+        for (uint32 i = 0; i < MOVEGEN_POOL_SIZE_CLASSES; ++i)
+        {
+            for (std::vector<void*>::iterator itr = blocks[i].begin(); itr != blocks[i].end(); ++itr)
+                { ::operator delete(*itr); }
+        }
+    }
+
+    std::vector<void*> blocks[MOVEGEN_POOL_SIZE_CLASSES];
+};
+
+typedef ACE_TSS<MovementGeneratorPool> MovementGeneratorPoolTSS;
+static MovementGeneratorPoolTSS movementGeneratorPool;
+
+static inline uint32 GetPoolSizeClass(size_t size)
+{
+    return uint32((size + MOVEGEN_POOL_GRANULARITY - 1) / MOVEGEN_POOL_GRANULARITY) - 1;
+}
+
+void* MovementGenerator::operator new(size_t size)
+{
+    uint32 sizeClass = GetPoolSizeClass(size);
+    if (sizeClass >= MOVEGEN_POOL_SIZE_CLASSES)
+        { return ::operator new(size); }
+
+    MovementGeneratorPool* pool = movementGeneratorPool;    // created at the first use of the thread
+    std::vector<void*>& blocks = pool->blocks[sizeClass];
+    if (blocks.empty())
+        { return ::operator new((sizeClass + 1) * MOVEGEN_POOL_GRANULARITY); }
+
+    void* ptr = blocks.back();
+    blocks.pop_back();
+    return ptr;
+}
+
+void MovementGenerator::operator delete(void* ptr, size_t size)
+{
+    if (!ptr)
+        { return; }
+
+    // a generator may be deleted by another thread than it was created by, that pool takes it then
+    uint32 sizeClass = GetPoolSizeClass(size);
+    if (sizeClass < MOVEGEN_POOL_SIZE_CLASSES)
+    {
+        MovementGeneratorPool* pool = movementGeneratorPool;
+        std::vector<void*>& blocks = pool->blocks[sizeClass];
+        if (blocks.size() < MOVEGEN_POOL_MAX_FREE)
+        {
+            if (blocks.empty())
+                { blocks.reserve(MOVEGEN_POOL_MAX_FREE); }
+
+            blocks.push_back(ptr);
+            return;
+        }
+    }
+
+    ::operator delete(ptr);
+}
+
 MovementGenerator::~MovementGenerator()
 {
 }
@@ -42,6 +42,10 @@ class MANGOS_DLL_SPEC MovementGenerator
     public:
         virtual ~MovementGenerator();
 
+        // generators are pushed and dropped at every fear, root or charm, their memory is reused per thread
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         // called before adding movement generator to motion stack
         virtual void Initialize(Unit&) = 0;
         // called aftre remove movement generator from motion stack
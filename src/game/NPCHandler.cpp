@@ -40,6 +40,7 @@
 #include "Guild.h"
 #include "Spell.h"
 #include "GuildMgr.h"
+#include "World.h"
 #include "Chat.h"
 #include "Item.h"
 #include "LuaEngine.h"
@@ -556,15 +557,30 @@ void WorldSession::SendStablePet(ObjectGuid guid)
 {
     DEBUG_LOG("WORLD: Recv MSG_LIST_STABLED_PETS Send.");
 
+    //                                                                                                   0      1     2   3      4      5        6
+    CharacterDatabase.AsyncPQuery(&WorldSession::SendStablePetCallBack, GetAccountId(), guid.GetRawValue(), "SELECT owner, slot, id, entry, level, loyalty, name FROM character_pet WHERE owner = '%u' AND slot >= '%u' AND slot <= '%u' ORDER BY slot",
+                                  _player->GetGUIDLow(), PET_SAVE_FIRST_STABLE_SLOT, PET_SAVE_LAST_STABLE_SLOT);
+}
+
+void WorldSession::SendStablePetCallBack(QueryResult* result, uint32 accountId, uint64 guid)
+{
+    WorldSession* session = sWorld.FindSession(accountId);
+    Player* player = session ? session->GetPlayer() : NULL;
+    if (!player || !player->IsInWorld())
+    {
+        delete result;
+        return;
+    }
+
     WorldPacket data(MSG_LIST_STABLED_PETS, 200);           // guess size
-    data << guid;
+    data << ObjectGuid(guid);
 
-    Pet* pet = _player->GetPet();
+    Pet* pet = player->GetPet();
 
     size_t wpos = data.wpos();
     data << uint8(0);                                       // place holder for slot show number
 
-    data << uint8(GetPlayer()->m_stableSlots);
+    data << uint8(player->m_stableSlots);
 
     uint8 num = 0;                                          // counter for place holder
 
@@ -580,16 +596,16 @@ void WorldSession::SendStablePet(ObjectGuid guid)
         ++num;
     }
 
-    //                                                     0      1     2   3      4      5        6
-    QueryResult* result = CharacterDatabase.PQuery("SELECT owner, slot, id, entry, level, loyalty, name FROM character_pet WHERE owner = '%u' AND slot >= '%u' AND slot <= '%u' ORDER BY slot",
-                          _player->GetGUIDLow(), PET_SAVE_FIRST_STABLE_SLOT, PET_SAVE_LAST_STABLE_SLOT);
-
     if (result)
     {
         do
         {
             Field* fields = result->Fetch();
 
+            // the character may have been changed while the query was queued
+            if (fields[0].GetUInt32() != player->GetGUIDLow())
+                { continue; }
+
             data << uint32(fields[2].GetUInt32());          // petnumber
             data << uint32(fields[3].GetUInt32());          // creature entry
             data << uint32(fields[4].GetUInt32());          // level
@@ -605,7 +621,7 @@ void WorldSession::SendStablePet(ObjectGuid guid)
     }
 
     data.put<uint8>(wpos, num);                             // set real data to placeholder
-    SendPacket(&data);
+    session->SendPacket(&data);
 }
 
 void WorldSession::SendStableResult(uint8 res)
@@ -25,6 +25,8 @@
 #ifndef MANGOS_H_NPCHANDLER
 #define MANGOS_H_NPCHANDLER
 
+#include "StringPool.h"
+
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
 #if defined( __GNUC__ )
 #pragma pack(1)
@@ -49,15 +51,15 @@ struct PageText
 
 struct PageTextLocale
 {
-    std::vector<std::string> Text;
+    LocaleStrings Text;
 };
 
 struct NpcTextLocale
 {
     NpcTextLocale() { Text_0.resize(8); Text_1.resize(8); }
 
-    std::vector<std::vector<std::string> > Text_0;
-    std::vector<std::vector<std::string> > Text_1;
+    std::vector<LocaleStrings> Text_0;
+    std::vector<LocaleStrings> Text_1;
 };
 
 struct QEmote
@@ -0,0 +1,216 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "NetworkStats.h"
+#include "UpdateMask.h"
+#include "World.h"
+#include "Log.h"
+#include "Policies/Singleton.h"
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(NetworkStats);
+
+static char const* const typeIdNames[MAX_TYPE_ID] =
+{
+    "object", "item", "container", "unit", "player", "gameobject", "dynamicobject", "corpse"
+};
+
+NetworkStats::NetworkStats()
+{
+    m_queuedPackets = 0;
+    m_queuedBytes = 0;
+
+    Reset();
+}
+
+bool NetworkStats::IsEnabled() const
+{
+    return sWorld.getConfig(CONFIG_BOOL_NETSTATS_ENABLE);
+}
+
+void NetworkStats::CountPacket(uint16 opcode, size_t bytes)
+{
+    if (!IsEnabled() || opcode >= NUM_MSG_TYPES)
+        { return; }
+
+    ++m_opcodePackets[opcode];
+    m_opcodeBytes[opcode] += long(bytes);
+}
+
+void NetworkStats::CountUpdatePacket(bool compressed, size_t rawBytes, size_t bytes)
+{
+    if (!IsEnabled())
+        { return; }
+
+    ++m_updatePackets[compressed];
+    m_updateBytes[compressed] += long(bytes);
+    m_updateRawBytes[compressed] += long(rawBytes);
+}
+
+bool NetworkStats::SampleFieldChanges()
+{
+    if (!IsEnabled())
+        { return false; }
+
+    return ++m_fieldSampleTick % long(sWorld.getConfig(CONFIG_UINT32_NETSTATS_FIELD_SAMPLE_RATE)) == 0;
+}
+
+void NetworkStats::CountFieldChanges(uint8 typeId, UpdateMask const& updateMask)
+{
+    if (typeId >= MAX_TYPE_ID)
+        { return; }
+
+    uint32 count = std::min(updateMask.GetCount(), uint32(PLAYER_END));
+    for (uint32 index = updateMask.FindNextBit(0); index < count; index = updateMask.FindNextBit(index + 1))
+        { ++m_fieldChanges[typeId][index]; }
+}
+
+void NetworkStats::CountCongestedPacket(bool collapsed)
+{
+    if (!IsEnabled())
+        { return; }
+
+    ++m_congestedPackets[collapsed];
+}
+
+void NetworkStats::AddQueuedPackets(long packets, long bytes)
+{
+    m_queuedPackets += packets;
+    m_queuedBytes += bytes;
+}
+
+static bool RowLess(NetworkStatsRow const& a, NetworkStatsRow const& b)
+{
+    if (a.bytes != b.bytes)
+        { return a.bytes > b.bytes; }
+
+    return a.count > b.count;
+}
+
+static void SortRows(NetworkStatsRows& rows, size_t begin, uint32 maxPerCategory)
+{
+    std::sort(rows.begin() + begin, rows.end(), RowLess);
+
+    if (maxPerCategory && rows.size() - begin > maxPerCategory)
+        { rows.resize(begin + maxPerCategory, rows.front()); }
+}
+
+void NetworkStats::CollectRows(NetworkStatsRows& rows, uint32 maxPerCategory) const
+{
+    size_t begin = rows.size();
+    for (uint32 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        if (long packets = m_opcodePackets[opcode].value())
+        {
+            long bytes = m_opcodeBytes[opcode].value();
+            rows.push_back(NetworkStatsRow("opcode", LookupOpcodeName(opcode), packets, bytes, bytes));
+        }
+    }
+    SortRows(rows, begin, maxPerCategory);
+
+    for (int compressed = 0; compressed < 2; ++compressed)
+    {
+        if (long packets = m_updatePackets[compressed].value())
+        {
+            rows.push_back(NetworkStatsRow("update", compressed ? "compressed" : "uncompressed", packets,
+                                           m_updateBytes[compressed].value(), m_updateRawBytes[compressed].value()));
+        }
+    }
+
+    rows.push_back(NetworkStatsRow("queue", "backlog", m_queuedPackets.value(), m_queuedBytes.value(), m_queuedBytes.value()));
+    for (int collapsed = 0; collapsed < 2; ++collapsed)
+    {
+        if (long packets = m_congestedPackets[collapsed].value())
+            { rows.push_back(NetworkStatsRow("queue", collapsed ? "collapsed" : "dropped", packets, 0, 0)); }
+    }
+
+    begin = rows.size();
+    for (uint32 typeId = 0; typeId < MAX_TYPE_ID; ++typeId)
+    {
+        for (uint32 index = 0; index < PLAYER_END; ++index)
+        {
+            if (long changes = m_fieldChanges[typeId][index].value())
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "%s:0x%04X", typeIdNames[typeId], index);
+                rows.push_back(NetworkStatsRow("field", name, changes, 0, 0));
+            }
+        }
+    }
+    SortRows(rows, begin, maxPerCategory);
+}
+
+void NetworkStats::Reset()
+{
+    for (uint32 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        m_opcodePackets[opcode] = 0;
+        m_opcodeBytes[opcode] = 0;
+    }
+
+    for (int compressed = 0; compressed < 2; ++compressed)
+    {
+        m_updatePackets[compressed] = 0;
+        m_updateBytes[compressed] = 0;
+        m_updateRawBytes[compressed] = 0;
+    }
+
+    for (uint32 typeId = 0; typeId < MAX_TYPE_ID; ++typeId)
+        for (uint32 index = 0; index < PLAYER_END; ++index)
+            { m_fieldChanges[typeId][index] = 0; }
+
+    m_fieldSampleTick = 0;
+
+    m_congestedPackets[0] = 0;
+    m_congestedPackets[1] = 0;
+}
+
+void NetworkStats::DumpCSV()
+{
+    NetworkStatsRows rows;
+    CollectRows(rows);
+    Reset();
+
+    std::string fileName = sLog.GetLogsDir() + "netstats.csv";
+    FILE* file = fopen(fileName.c_str(), "a");
+    if (!file)
+    {
+        sLog.outError("NetworkStats: can't open %s for writing", fileName.c_str());
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0)
+        { fprintf(file, "time,category,name,count,bytes,raw_bytes\n"); }
+
+    uint64 now = uint64(sWorld.GetGameTime());
+    for (NetworkStatsRows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        fprintf(file, UI64FMTD ",%s,%s," UI64FMTD "," UI64FMTD "," UI64FMTD "\n",
+                now, itr->category, itr->name.c_str(), itr->count, itr->bytes, itr->rawBytes);
+    }
+
+    fclose(file);
+}
@@ -0,0 +1,112 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_NETWORKSTATS_H
+#define MANGOS_NETWORKSTATS_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "ObjectGuid.h"
+#include "UpdateFields.h"
+#include "Opcodes.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
+#include <vector>
+
+class UpdateMask;
+
+/// One line of the statistics, see NetworkStats::CollectRows
+struct NetworkStatsRow
+{
+    NetworkStatsRow(char const* category_, std::string const& name_, uint64 count_, uint64 bytes_, uint64 rawBytes_) :
+        category(category_), name(name_), count(count_), bytes(bytes_), rawBytes(rawBytes_) {}
+
+    char const* category;                                   // "opcode", "update", "field" or "queue"
+    std::string name;
+    uint64 count;                                           // packets, or sampled changes of a field
+    uint64 bytes;                                           // sent bytes including the packet header
+    uint64 rawBytes;                                        // bytes before compression
+};
+
+typedef std::vector<NetworkStatsRow> NetworkStatsRows;
+
+/**
+ * Outbound traffic counters, enabled by NetStats.Enable.
+ *
+ * WorldSocket counts every sent packet by opcode, UpdateData::BuildPacket the update packets before
+ * and after compression, and Object::BuildValuesUpdate the changed fields of every NetStats.FieldSampleRate-th
+ * values block by object type and field index, WorldSocket and WorldSession the output queue backlog and
+ * the packets dropped or collapsed for congested sockets. The counters are updated by the network and map threads,
+ * shown by .debug netstats and appended to netstats.csv in the logs directory every NetStats.DumpInterval
+ * seconds, after which they start again from zero.
+ */
+class NetworkStats
+{
+    public:
+        NetworkStats();
+
+        bool IsEnabled() const;
+
+        void CountPacket(uint16 opcode, size_t bytes);
+        void CountUpdatePacket(bool compressed, size_t rawBytes, size_t bytes);
+        /// true for the values blocks which changed fields are to be counted
+        bool SampleFieldChanges();
+        void CountFieldChanges(uint8 typeId, UpdateMask const& updateMask);
+        /// Packet not sent to a congested socket, dropped or replaced by a newer one
+        void CountCongestedPacket(bool collapsed);
+        /// Change of the packets waiting in the output queues of all sockets, kept also while disabled
+        void AddQueuedPackets(long packets, long bytes);
+        long GetQueuedPackets() const { return m_queuedPackets.value(); }
+        long GetQueuedBytes() const { return m_queuedBytes.value(); }
+
+        /// Nonzero counters sorted by bytes (fields by changes), at most maxPerCategory per category if set
+        void CollectRows(NetworkStatsRows& rows, uint32 maxPerCategory = 0) const;
+        void Reset();
+
+        /// Append the counters to the csv file and reset them
+        void DumpCSV();
+
+    private:
+        typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> Counter;
+
+        Counter m_opcodePackets[NUM_MSG_TYPES];
+        Counter m_opcodeBytes[NUM_MSG_TYPES];
+
+        Counter m_updatePackets[2];                         // [compressed]
+        Counter m_updateBytes[2];
+        Counter m_updateRawBytes[2];
+
+        Counter m_fieldChanges[MAX_TYPE_ID][PLAYER_END];
+        Counter m_fieldSampleTick;
+
+        Counter m_congestedPackets[2];                      // [collapsed]
+        Counter m_queuedPackets;                            // current backlog, not reset
+        Counter m_queuedBytes;
+};
+
+#define sNetworkStats MaNGOS::Singleton<NetworkStats>::Instance()
+
+#endif
@@ -49,6 +49,7 @@
 #include "movement/packet_builder.h"
 #include "CreatureLinkingMgr.h"
 #include "Chat.h"
+#include "NetworkStats.h"
 #include "LuaEngine.h"
 
 Object::Object()
@@ -58,6 +59,7 @@ Object::Object()
 
     m_uint32Values      = NULL;
     m_valuesCount       = 0;
+    m_valuesVersion     = 0;
 
     m_inWorld           = false;
     m_objectUpdated     = false;
@@ -88,7 +90,7 @@ void Object::_InitValues()
     m_uint32Values = new uint32[ m_valuesCount ];
     memset(m_uint32Values, 0, m_valuesCount * sizeof(uint32));
 
-    m_changedValues.resize(m_valuesCount, false);
+    m_changedValues.SetCount(m_valuesCount);
 
     m_objectUpdated = false;
 }
@@ -191,10 +193,16 @@ void Object::BuildCreateUpdateBlockForPlayer(UpdateData* data, Player* target) c
 
     BuildMovementUpdate(&buf, updateFlags);
 
-    UpdateMask updateMask;
-    updateMask.SetCount(m_valuesCount);
-    _SetCreateBits(&updateMask, target);
-    BuildValuesUpdate(updatetype, &buf, &updateMask, target);
+    if (GetTypeId() == TYPEID_UNIT)
+        { ((Creature*)this)->BuildCreateValuesUpdate(buf, target); }
+    else
+    {
+        uint32 maskStorage[UPDATE_MASK_MAX_BLOCKS];
+        UpdateMask updateMask(maskStorage);
+        updateMask.SetCount(m_valuesCount);
+        _SetCreateBits(&updateMask, target);
+        BuildValuesUpdate(updatetype, &buf, &updateMask, target);
+    }
     data->AddUpdateBlock(buf);
 }
 
@@ -212,17 +220,85 @@ void Object::SendCreateUpdateToPlayer(Player* player)
 void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
 {
     ByteBuffer buf(500);
+    BuildValuesUpdateBlock(buf, target);
+    data->AddUpdateBlock(buf);
+}
 
+void Object::BuildValuesUpdateBlock(ByteBuffer& buf, Player* target) const
+{
     buf << uint8(UPDATETYPE_VALUES);
     buf << GetPackGUID();
 
-    UpdateMask updateMask;
+    uint32 maskStorage[UPDATE_MASK_MAX_BLOCKS];
+    UpdateMask updateMask(maskStorage);
     updateMask.SetCount(m_valuesCount);
 
     _SetUpdateBits(&updateMask, target);
     BuildValuesUpdate(UPDATETYPE_VALUES, &buf, &updateMask, target);
+}
 
-    data->AddUpdateBlock(buf);
+/// Target dependent parts of a values update block, see Object::GetValuesUpdateClass
+enum ValuesUpdateClassFlags
+{
+    VALUES_UPDATE_CLASS_SELF            = 0x01,             // players send all own fields to themselves
+    VALUES_UPDATE_CLASS_GM              = 0x02,
+    VALUES_UPDATE_CLASS_TRAINER         = 0x04,
+    VALUES_UPDATE_CLASS_HUNTER          = 0x08,
+    VALUES_UPDATE_CLASS_LOOTER          = 0x10,
+    VALUES_UPDATE_CLASS_TAPPER          = 0x20,
+    VALUES_UPDATE_CLASS_QUEST_ACTIVE    = 0x40,
+    VALUES_UPDATE_CLASS_UNLOOTED        = 0x80              // loot not taken yet, the build sets UNIT_DYNFLAG_LOOTABLE
+};
+
+/**
+ * Observers with the same class get the same bytes from BuildValuesUpdateBlock(), so the block
+ * can be built once per class. Has to test every target dependent case of _SetUpdateBits() and
+ * BuildValuesUpdate() for the changed fields, or for all nonzero fields of a create block.
+ */
+uint32 Object::GetValuesUpdateClass(Player* target, bool create) const
+{
+    uint32 updateClass = 0;
+
+    if (target == this)
+        { updateClass |= VALUES_UPDATE_CLASS_SELF; }
+
+    if (target->isGameMaster())
+        { updateClass |= VALUES_UPDATE_CLASS_GM; }
+
+    if (GetTypeId() == TYPEID_UNIT)
+    {
+        Creature* creature = (Creature*)this;
+
+        if (create ? m_uint32Values[UNIT_NPC_FLAGS] != 0 : m_changedValues.GetBit(UNIT_NPC_FLAGS))
+        {
+            uint32 npcFlags = m_uint32Values[UNIT_NPC_FLAGS];
+
+            if ((npcFlags & UNIT_NPC_FLAG_TRAINER) && creature->IsTrainerOf(target, false))
+                { updateClass |= VALUES_UPDATE_CLASS_TRAINER; }
+
+            if ((npcFlags & UNIT_NPC_FLAG_STABLEMASTER) && target->getClass() == CLASS_HUNTER)
+                { updateClass |= VALUES_UPDATE_CLASS_HUNTER; }
+        }
+
+        if (create ? m_uint32Values[UNIT_DYNAMIC_FLAGS] != 0 : m_changedValues.GetBit(UNIT_DYNAMIC_FLAGS))
+        {
+            if (!creature->loot.isLooted())
+                { updateClass |= VALUES_UPDATE_CLASS_UNLOOTED; }
+
+            if (target->isAllowedToLoot(creature))
+                { updateClass |= VALUES_UPDATE_CLASS_LOOTER; }
+
+            if (target->IsTappedByMeOrMyGroup(creature))
+                { updateClass |= VALUES_UPDATE_CLASS_TAPPER; }
+        }
+    }
+    else if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
+    {
+        if (((GameObject*)this)->ActivateToQuest(target))
+            { updateClass |= VALUES_UPDATE_CLASS_QUEST_ACTIVE; }
+    }
+
+    return updateClass;
 }
 
 void Object::BuildOutOfRangeUpdateBlock(UpdateData* data) const
@@ -367,155 +443,145 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
 
     MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
 
+    if (updatetype == UPDATETYPE_VALUES && sNetworkStats.SampleFieldChanges())
+        { sNetworkStats.CountFieldChanges(m_objectTypeId, *updateMask); }
+
     *data << (uint8)updateMask->GetBlockCount();
     data->append(updateMask->GetMask(), updateMask->GetLength());
 
     // 2 specialized loops for speed optimization in non-unit case
     if (isType(TYPEMASK_UNIT))                              // unit (creature/player) case
     {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
+        for (uint32 index = updateMask->FindNextBit(0); index < m_valuesCount; index = updateMask->FindNextBit(index + 1))
         {
-            if (updateMask->GetBit(index))
+            if (index == UNIT_NPC_FLAGS)
             {
-                if (index == UNIT_NPC_FLAGS)
+                uint32 appendValue = m_uint32Values[index];
+
+                if (GetTypeId() == TYPEID_UNIT)
                 {
-                    uint32 appendValue = m_uint32Values[index];
+                    if (appendValue & UNIT_NPC_FLAG_TRAINER)
+                    {
+                        if (!((Creature*)this)->IsTrainerOf(target, false))
+                            { appendValue &= ~UNIT_NPC_FLAG_TRAINER; }
+                    }
 
-                    if (GetTypeId() == TYPEID_UNIT)
+                    if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
                     {
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->IsTrainerOf(target, false))
-                                { appendValue &= ~UNIT_NPC_FLAG_TRAINER; }
-                        }
+                        if (target->getClass() != CLASS_HUNTER)
+                            { appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER; }
+                    }
+                }
+
+                *data << uint32(appendValue);
+            }
+            // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
+            else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
+            {
+                // convert from float to uint32 and send
+                *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
+            }
 
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
+            // there are some float values which may be negative or can't get negative due to other checks
+            else if ((index >= PLAYER_FIELD_NEGSTAT0    && index <= PLAYER_FIELD_NEGSTAT4) ||
+                     (index >= PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
+                     (index >= PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
+                     (index >= PLAYER_FIELD_POSSTAT0    && index <= PLAYER_FIELD_POSSTAT4))
+            {
+                *data << uint32(m_floatValues[index]);
+            }
+
+            // Gamemasters should be always able to select units - remove not selectable flag
+            else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
+            {
+                *data << (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE);
+            }
+            /* Hide loot animation for players that aren't permitted to loot the corpse */
+            else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
+            {
+                uint32 send_value = m_uint32Values[index];
+
+                /* Initiate pointer to creature so we can check loot */
+                if (Creature* my_creature = (Creature*)this)
+                    /* If the creature is NOT fully looted */
+                    if (!my_creature->loot.isLooted())
+                        /* If the lootable flag is NOT set */
+                        if (!(send_value & UNIT_DYNFLAG_LOOTABLE))
                         {
-                            if (target->getClass() != CLASS_HUNTER)
-                                { appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER; }
+                            /* Update it on the creature */
+                            my_creature->SetFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE);
+                            /* Update it in the packet */
+                            send_value = send_value | UNIT_DYNFLAG_LOOTABLE;
                         }
-                    }
 
-                    *data << uint32(appendValue);
-                }
-                // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
-                else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
-                {
-                    // convert from float to uint32 and send
-                    *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
-                }
+                /* If we're not allowed to loot the target, destroy the lootable flag */
+                if (!target->isAllowedToLoot((Creature*)this))
+                    if (send_value & UNIT_DYNFLAG_LOOTABLE)
+                        { send_value = send_value & ~UNIT_DYNFLAG_LOOTABLE; }
 
-                // there are some float values which may be negative or can't get negative due to other checks
-                else if ((index >= PLAYER_FIELD_NEGSTAT0    && index <= PLAYER_FIELD_NEGSTAT4) ||
-                         (index >= PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
-                         (index >= PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
-                         (index >= PLAYER_FIELD_POSSTAT0    && index <= PLAYER_FIELD_POSSTAT4))
-                {
-                    *data << uint32(m_floatValues[index]);
-                }
+                /* If we are allowed to loot it and mob is tapped by us, destroy the tapped flag */
+                bool is_tapped = target->IsTappedByMeOrMyGroup((Creature*)this);
 
-                // Gamemasters should be always able to select units - remove not selectable flag
-                else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
-                {
-                    *data << (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE);
-                }
-                /* Hide loot animation for players that aren't permitted to loot the corpse */
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
-                {
-                    uint32 send_value = m_uint32Values[index];
-
-                    /* Initiate pointer to creature so we can check loot */
-                    if (Creature* my_creature = (Creature*)this)
-                        /* If the creature is NOT fully looted */
-                        if (!my_creature->loot.isLooted())
-                            /* If the lootable flag is NOT set */
-                            if (!(send_value & UNIT_DYNFLAG_LOOTABLE))
-                            {
-                                /* Update it on the creature */
-                                my_creature->SetFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_LOOTABLE);
-                                /* Update it in the packet */
-                                send_value = send_value | UNIT_DYNFLAG_LOOTABLE;
-                            }
-
-                    /* If we're not allowed to loot the target, destroy the lootable flag */
-                    if (!target->isAllowedToLoot((Creature*)this))
-                        if (send_value & UNIT_DYNFLAG_LOOTABLE)
-                            { send_value = send_value & ~UNIT_DYNFLAG_LOOTABLE; }
-
-                    /* If we are allowed to loot it and mob is tapped by us, destroy the tapped flag */
-                    bool is_tapped = target->IsTappedByMeOrMyGroup((Creature*)this);
-
-                    /* If the creature has tapped flag but is tapped by us, remove the flag */
-                    if (send_value & UNIT_DYNFLAG_TAPPED && is_tapped)
-                        { send_value = send_value & ~UNIT_DYNFLAG_TAPPED; }
-                    /* If creature does not have tapped flag but is not tapped by us, set the flag */
-                    else if (!(send_value & UNIT_DYNFLAG_TAPPED) && !is_tapped)
-                        { send_value = send_value | UNIT_DYNFLAG_TAPPED; }
-
-                    *data << send_value;
-                }
-                else
-                {
-                    // send in current format (float as float, uint32 as uint32)
-                    *data << m_uint32Values[index];
-                }
+                /* If the creature has tapped flag but is tapped by us, remove the flag */
+                if (send_value & UNIT_DYNFLAG_TAPPED && is_tapped)
+                    { send_value = send_value & ~UNIT_DYNFLAG_TAPPED; }
+                /* If creature does not have tapped flag but is not tapped by us, set the flag */
+                else if (!(send_value & UNIT_DYNFLAG_TAPPED) && !is_tapped)
+                    { send_value = send_value | UNIT_DYNFLAG_TAPPED; }
+
+                *data << send_value;
+            }
+            else
+            {
+                // send in current format (float as float, uint32 as uint32)
+                *data << m_uint32Values[index];
             }
         }
     }
     else if (isType(TYPEMASK_GAMEOBJECT))                   // gameobject case
     {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
+        for (uint32 index = updateMask->FindNextBit(0); index < m_valuesCount; index = updateMask->FindNextBit(index + 1))
         {
-            if (updateMask->GetBit(index))
+            // send in current format (float as float, uint32 as uint32)
+            if (index == GAMEOBJECT_DYN_FLAGS)
             {
-                // send in current format (float as float, uint32 as uint32)
-                if (index == GAMEOBJECT_DYN_FLAGS)
+                if (IsActivateToQuest)
                 {
-                    if (IsActivateToQuest)
+                    switch (((GameObject*)this)->GetGoType())
                     {
-                        switch (((GameObject*)this)->GetGoType())
-                        {
-                            case GAMEOBJECT_TYPE_QUESTGIVER:
-                            case GAMEOBJECT_TYPE_CHEST:
-                            case GAMEOBJECT_TYPE_GENERIC:
-                            case GAMEOBJECT_TYPE_SPELL_FOCUS:
-                            case GAMEOBJECT_TYPE_GOOBER:
-                                *data << uint16(GO_DYNFLAG_LO_ACTIVATE);
-                                *data << uint16(0);
-                                break;
-                            default:
-                                *data << uint32(0);         // unknown, not happen.
-                                break;
-                        }
+                        case GAMEOBJECT_TYPE_QUESTGIVER:
+                        case GAMEOBJECT_TYPE_CHEST:
+                        case GAMEOBJECT_TYPE_GENERIC:
+                        case GAMEOBJECT_TYPE_SPELL_FOCUS:
+                        case GAMEOBJECT_TYPE_GOOBER:
+                            *data << uint16(GO_DYNFLAG_LO_ACTIVATE);
+                            *data << uint16(0);
+                            break;
+                        default:
+                            *data << uint32(0);         // unknown, not happen.
+                            break;
                     }
-                    else
-                        { *data << uint32(0); }                 // disable quest object
                 }
                 else
-                    { *data << m_uint32Values[index]; }         // other cases
+                    { *data << uint32(0); }                 // disable quest object
             }
+            else
+                { *data << m_uint32Values[index]; }         // other cases
         }
     }
     else                                                    // other objects case (no special index checks)
     {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
+        for (uint32 index = updateMask->FindNextBit(0); index < m_valuesCount; index = updateMask->FindNextBit(index + 1))
         {
-            if (updateMask->GetBit(index))
-            {
-                // send in current format (float as float, uint32 as uint32)
-                *data << m_uint32Values[index];
-            }
+            // send in current format (float as float, uint32 as uint32)
+            *data << m_uint32Values[index];
         }
     }
 }
 
 void Object::ClearUpdateMask(bool remove)
 {
-    if (m_uint32Values)
-    {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
-            { m_changedValues[index] = false; }
-    }
+    m_changedValues.Clear();
 
     if (m_objectUpdated)
     {
@@ -546,9 +612,7 @@ bool Object::LoadValues(const char* data)
 
 void Object::_SetUpdateBits(UpdateMask* updateMask, Player* /*target*/) const
 {
-    for (uint16 index = 0; index < m_valuesCount; ++index)
-        if (m_changedValues[index])
-            { updateMask->SetBit(index); }
+    *updateMask |= m_changedValues;
 }
 
 void Object::_SetCreateBits(UpdateMask* updateMask, Player* /*target*/) const
@@ -565,7 +629,7 @@ void Object::SetInt32Value(uint16 index, int32 value)
     if (m_int32Values[index] != value)
     {
         m_int32Values[index] = value;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -577,7 +641,7 @@ void Object::SetUInt32Value(uint16 index, uint32 value)
     if (m_uint32Values[index] != value)
     {
         m_uint32Values[index] = value;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -587,7 +651,8 @@ void Object::UpdateUInt32Value(uint16 index, uint32 value)
     MANGOS_ASSERT(index < m_valuesCount || PrintIndexError(index, true));
 
     m_uint32Values[index] = value;
-    m_changedValues[index] = true;
+    m_changedValues.SetBit(index);
+    ++m_valuesVersion;
 }
 
 void Object::SetUInt64Value(uint16 index, const uint64& value)
@@ -597,8 +662,8 @@ void Object::SetUInt64Value(uint16 index, const uint64& value)
     {
         m_uint32Values[index] = *((uint32*)&value);
         m_uint32Values[index + 1] = *(((uint32*)&value) + 1);
-        m_changedValues[index] = true;
-        m_changedValues[index + 1] = true;
+        m_changedValues.SetBit(index);
+        m_changedValues.SetBit(index + 1);
         MarkForClientUpdate();
     }
 }
@@ -610,7 +675,7 @@ void Object::SetFloatValue(uint16 index, float value)
     if (m_floatValues[index] != value)
     {
         m_floatValues[index] = value;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -629,7 +694,7 @@ void Object::SetByteValue(uint16 index, uint8 offset, uint8 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFF) << (offset * 8));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 8));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -648,7 +713,7 @@ void Object::SetUInt16Value(uint16 index, uint8 offset, uint16 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFFFF) << (offset * 16));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 16));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -710,7 +775,7 @@ void Object::SetFlag(uint16 index, uint32 newFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -724,7 +789,7 @@ void Object::RemoveFlag(uint16 index, uint32 oldFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -798,7 +863,7 @@ void Object::SetByteFlag(uint16 index, uint8 offset, uint8 newFlag)
     if (!(uint8(m_uint32Values[index] >> (offset * 8)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (offset * 8));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -816,7 +881,7 @@ void Object::RemoveByteFlag(uint16 index, uint8 offset, uint8 oldFlag)
     if (uint8(m_uint32Values[index] >> (offset * 8)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (offset * 8));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -828,7 +893,7 @@ void Object::SetShortFlag(uint16 index, bool highpart, uint16 newFlag)
     if (!(uint16(m_uint32Values[index] >> (highpart ? 16 : 0)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (highpart ? 16 : 0));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -840,7 +905,7 @@ void Object::RemoveShortFlag(uint16 index, bool highpart, uint16 oldFlag)
     if (uint16(m_uint32Values[index] >> (highpart ? 16 : 0)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (highpart ? 16 : 0));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -876,6 +941,33 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
     BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
 }
 
+/// Same using the block already built for an observer of the same values update class if any
+void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateBlockCache& cache)
+{
+    UpdateDataMapType::iterator iter = update_players.find(pl);
+
+    if (iter == update_players.end())
+    {
+        std::pair<UpdateDataMapType::iterator, bool> p = update_players.insert(UpdateDataMapType::value_type(pl, UpdateData()));
+        MANGOS_ASSERT(p.second);
+        iter = p.first;
+    }
+
+    uint32 updateClass = GetValuesUpdateClass(pl);
+    for (ValuesUpdateBlockCache::const_iterator itr = cache.begin(); itr != cache.end(); ++itr)
+    {
+        if (itr->first == updateClass)
+        {
+            iter->second.AddUpdateBlock(itr->second);
+            return;
+        }
+    }
+
+    cache.push_back(ValuesUpdateBlockCache::value_type(updateClass, ByteBuffer(500)));
+    BuildValuesUpdateBlock(cache.back().second, pl);
+    iter->second.AddUpdateBlock(cache.back().second);
+}
+
 void Object::AddToClientUpdateList()
 {
     sLog.outError("Unexpected call of Object::AddToClientUpdateList for object (TypeId: %u Update fields: %u)", GetTypeId(), m_valuesCount);
@@ -896,6 +988,8 @@ void Object::BuildUpdateData(UpdateDataMapType& /*update_players */)
 
 void Object::MarkForClientUpdate()
 {
+    ++m_valuesVersion;                                      // every setter ends here after changing a field
+
     if (m_inWorld)
     {
         if (!m_objectUpdated)
@@ -909,13 +1003,17 @@ void Object::MarkForClientUpdate()
 WorldObject::WorldObject() :
     m_currMap(NULL),
     m_mapId(0), m_InstanceId(0),
+    m_terrainQuery(NULL),
     m_isActiveObject(false)
 {
+    for (int i = 0; i < MAX_UPDATE_COALESCE_CLASS; ++i)
+        { m_coalescedSendTime[i] = 0; }
 }
 
 WorldObject::~WorldObject()
 {
     Eluna::RemoveRef(this);
+    delete m_terrainQuery;
 }
 
 void WorldObject::CleanupsBeforeDelete()
@@ -936,7 +1034,11 @@ void WorldObject::Relocate(float x, float y, float z, float orientation)
     m_position.o = orientation;
 
     if (isType(TYPEMASK_UNIT))
-        { ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, orientation); }
+    {
+        ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, orientation);
+        if (((Unit*)this)->IsInSpatialHash())
+            { GetMap()->RelocateInSpatialHash((Unit*)this); }
+    }
 }
 
 void WorldObject::Relocate(float x, float y, float z)
@@ -946,7 +1048,11 @@ void WorldObject::Relocate(float x, float y, float z)
     m_position.z = z;
 
     if (isType(TYPEMASK_UNIT))
-        { ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, GetOrientation()); }
+    {
+        ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, GetOrientation());
+        if (((Unit*)this)->IsInSpatialHash())
+            { GetMap()->RelocateInSpatialHash((Unit*)this); }
+    }
 }
 
 void WorldObject::SetOrientation(float orientation)
@@ -959,17 +1065,19 @@ void WorldObject::SetOrientation(float orientation)
 
 uint32 WorldObject::GetZoneId() const
 {
-    return GetTerrain()->GetZoneId(m_position.x, m_position.y, m_position.z);
+    return GetTerrainQuery().zoneId;
 }
 
 uint32 WorldObject::GetAreaId() const
 {
-    return GetTerrain()->GetAreaId(m_position.x, m_position.y, m_position.z);
+    return GetTerrainQuery().areaId;
 }
 
 void WorldObject::GetZoneAndAreaId(uint32& zoneid, uint32& areaid) const
 {
-    GetTerrain()->GetZoneAndAreaId(zoneid, areaid, m_position.x, m_position.y, m_position.z);
+    TerrainQuery const& query = GetTerrainQuery();
+    zoneid = query.zoneId;
+    areaid = query.areaId;
 }
 
 InstanceData* WorldObject::GetInstanceData() const
@@ -1375,11 +1483,11 @@ namespace MaNGOS
                 : i_object(obj), i_msgtype(msgtype), i_textData(textData), i_language(language), i_target(target) {}
             void operator()(WorldPacket& data, int32 loc_idx)
             {
-                char const* text = NULL;
-                if ((int32)i_textData->Content.size() > loc_idx + 1 && !i_textData->Content[loc_idx + 1].empty())
-                    { text = i_textData->Content[loc_idx + 1].c_str(); }
-                else
-                    { text = i_textData->Content[0].c_str(); }
+                char const* text = i_textData->Content.Get(loc_idx + 1);
+                if (!text)
+                    { text = i_textData->Content.Get(0); }
+                if (!text)
+                    { text = ""; }
 
                 ChatHandler::BuildChatPacket(data, i_msgtype, text, i_language, CHAT_TAG_NONE, i_object.GetObjectGuid(), i_object.GetNameForLocaleIdx(loc_idx),
                     i_target ? i_target->GetObjectGuid() : ObjectGuid(), i_target ? i_target->GetNameForLocaleIdx(loc_idx) : "");
@@ -1508,6 +1616,18 @@ TerrainInfo const* WorldObject::GetTerrain() const
     return m_currMap->GetTerrain();
 }
 
+TerrainQuery const& WorldObject::GetTerrainQuery() const
+{
+    if (!m_terrainQuery)
+        { m_terrainQuery = new TerrainQuery; }
+
+    // zone, area and water checks of one update share the result of the same position
+    if (!m_terrainQuery->IsFor(GetMapId(), m_position.x, m_position.y, m_position.z))
+        { GetTerrain()->QueryTerrain(m_position.x, m_position.y, m_position.z, *m_terrainQuery); }
+
+    return *m_terrainQuery;
+}
+
 void WorldObject::AddObjectToRemoveList()
 {
     GetMap()->AddObjectToRemoveList(this);
@@ -1827,6 +1947,7 @@ void WorldObject::AddToClientUpdateList()
 
 void WorldObject::RemoveFromClientUpdateList()
 {
+    m_coalescedValues.Clear();
     GetMap()->RemoveUpdateObject(this);
 }
 
@@ -1834,12 +1955,17 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
-    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj)
+    ValuesUpdateBlockCache i_blocks;
+    bool i_coalescing;
+    bool i_hasChanges;                                      // false if only coalesced changes are pending
+    std::vector<Player*> i_coalescedObservers;
+    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj),
+        i_coalescing(obj.IsCoalescingUpdates()), i_hasChanges(!obj.m_changedValues.IsEmpty())
     {
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
-        if (i_object.isType(TYPEMASK_PLAYER))
-            { i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas); }
+        if (i_hasChanges && i_object.isType(TYPEMASK_PLAYER))
+            { i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas, i_blocks); }
     }
 
     void Visit(CameraMapType& m)
@@ -1848,7 +1974,12 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter->getSource()->GetOwner();
             if (owner != &i_object && owner->HaveAtClient(&i_object))
-                { i_object.BuildUpdateDataForPlayer(owner, i_updateDatas); }
+            {
+                if (i_coalescing && !i_object.IsImmediateUpdateObserver(owner))
+                    { i_coalescedObservers.push_back(owner); }
+                else if (i_hasChanges)
+                    { i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, i_blocks); }
+            }
         }
     }
 
@@ -1860,7 +1991,97 @@ void WorldObject::BuildUpdateData(UpdateDataMapType& update_players)
     WorldObjectChangeAccumulator notifier(*this, update_players);
     Cell::VisitWorldObjects(this, notifier, GetMap()->GetVisibilityDistance());
 
+    if (!notifier.i_coalescedObservers.empty())
+    {
+        CoalesceValuesUpdate();
+
+        if (!m_changedValues.IsEmpty())
+        {
+            // the changes left for the far observers differ from the ones sent above
+            ValuesUpdateBlockCache blocks;
+            for (std::vector<Player*>::const_iterator itr = notifier.i_coalescedObservers.begin(); itr != notifier.i_coalescedObservers.end(); ++itr)
+                { BuildUpdateDataForPlayer(*itr, update_players, blocks); }
+        }
+    }
+    else
+        { m_coalescedValues.Clear(); }                      // nobody to send them to
+
     ClearUpdateMask(false);
+
+    // check the held back changes again in the next update
+    if (!m_coalescedValues.IsEmpty())
+    {
+        m_objectUpdated = true;
+        GetMap()->AddDelayedUpdateObject(this);
+    }
+}
+
+static uint32 const coalescedFieldsBegin[MAX_UPDATE_COALESCE_CLASS] = { UNIT_FIELD_HEALTH, UNIT_FIELD_POWER1 };
+static uint32 const coalescedFieldsEnd[MAX_UPDATE_COALESCE_CLASS]   = { UNIT_FIELD_HEALTH + 1, UNIT_FIELD_POWER5 + 1 };
+static eConfigUInt32Values const coalesceIntervalConfig[MAX_UPDATE_COALESCE_CLASS] = { CONFIG_UINT32_UPDATE_COALESCE_HEALTH, CONFIG_UINT32_UPDATE_COALESCE_POWER };
+
+bool WorldObject::IsCoalescingUpdates() const
+{
+    if (!isType(TYPEMASK_UNIT))
+        { return false; }
+
+    for (int i = 0; i < MAX_UPDATE_COALESCE_CLASS; ++i)
+    {
+        if (sWorld.getConfig(coalesceIntervalConfig[i]))
+            { return true; }
+    }
+
+    return false;
+}
+
+/// The player controlling the unit and its party get all changes at once
+bool WorldObject::IsImmediateUpdateObserver(Player const* observer) const
+{
+    Player const* controller = ((Unit const*)this)->GetCharmerOrOwnerPlayerOrPlayerItself();
+    return controller && (controller == observer || controller->IsInSameGroupWith(observer));
+}
+
+/**
+ * Turns m_changedValues into the changes for observers that aren't immediate observers.
+ * Changes of a coalesce class are held back if the class was sent less than its interval ago,
+ * and sent together with the held back ones once the interval passed.
+ */
+void WorldObject::CoalesceValuesUpdate()
+{
+    if (!m_coalescedValues.GetCount())
+        { m_coalescedValues.SetCount(m_valuesCount); }
+
+    uint32 now = WorldTimer::getMSTime();
+
+    for (int i = 0; i < MAX_UPDATE_COALESCE_CLASS; ++i)
+    {
+        uint32 interval = sWorld.getConfig(coalesceIntervalConfig[i]);
+        bool due = WorldTimer::getMSTimeDiff(m_coalescedSendTime[i], now) >= interval;
+        bool sent = false;
+
+        for (uint32 index = coalescedFieldsBegin[i]; index < coalescedFieldsEnd[i]; ++index)
+        {
+            if (due)
+            {
+                if (m_coalescedValues.GetBit(index))
+                {
+                    m_coalescedValues.UnsetBit(index);
+                    m_changedValues.SetBit(index);
+                }
+
+                sent = sent || m_changedValues.GetBit(index);
+            }
+            // zero health or power is sent at once, the client shows deaths and empty bars from it
+            else if (m_changedValues.GetBit(index) && m_uint32Values[index] != 0)
+            {
+                m_changedValues.UnsetBit(index);
+                m_coalescedValues.SetBit(index);
+            }
+        }
+
+        if (sent)
+            { m_coalescedSendTime[i] = now; }
+    }
 }
 
 bool WorldObject::IsControlledByPlayer() const
@@ -29,6 +29,7 @@
 #include "ByteBuffer.h"
 #include "UpdateFields.h"
 #include "UpdateData.h"
+#include "UpdateMask.h"
 #include "ObjectGuid.h"
 #include "Camera.h"
 
@@ -77,10 +78,21 @@ class Map;
 class UpdateMask;
 class InstanceData;
 class TerrainInfo;
+struct TerrainQuery;
 struct MangosStringLocale;
 
 typedef UNORDERED_MAP<Player*, UpdateData> UpdateDataMapType;
 
+/// Unit fields whose changes are sent to observers outside the owner's party at most every UpdateCoalesce.* ms
+enum UpdateCoalesceClass
+{
+    UPDATE_COALESCE_HEALTH  = 0,
+    UPDATE_COALESCE_POWER   = 1,
+    MAX_UPDATE_COALESCE_CLASS
+};
+// values update blocks of one object already built for observers of a values update class
+typedef std::vector<std::pair<uint32 /*class*/, ByteBuffer> > ValuesUpdateBlockCache;
+
 struct Position
 {
     Position() : x(0.0f), y(0.0f), z(0.0f), o(0.0f) {}
@@ -406,7 +418,10 @@ class MANGOS_DLL_SPEC Object
 
         void BuildMovementUpdate(ByteBuffer* data, uint8 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
+        void BuildValuesUpdateBlock(ByteBuffer& buf, Player* target) const;
+        uint32 GetValuesUpdateClass(Player* target, bool create = false) const;
         void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players);
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateBlockCache& cache);
 
         uint16 m_objectType;
 
@@ -420,10 +435,11 @@ class MANGOS_DLL_SPEC Object
             float*  m_floatValues;
         };
 
-        std::vector<bool> m_changedValues;
+        UpdateMask m_changedValues;
         std::map<uint32, uint32> m_plrSpecificFlags;
 
         uint16 m_valuesCount;
+        uint32 m_valuesVersion;                             // changed at every field change, see Creature::BuildCreateValuesUpdate
 
         bool m_objectUpdated;
 
@@ -619,6 +635,8 @@ class MANGOS_DLL_SPEC WorldObject : public Object
 
         // obtain terrain data for map where this object belong...
         TerrainInfo const* GetTerrain() const;
+        // terrain at the current position, queried again after the object moved
+        TerrainQuery const& GetTerrainQuery() const;
 
         void AddToClientUpdateList() override;
         void RemoveFromClientUpdateList() override;
@@ -657,9 +675,18 @@ class MANGOS_DLL_SPEC WorldObject : public Object
         uint32 m_InstanceId;                                // in map copy with instance id
 
         Position m_position;
+        mutable TerrainQuery* m_terrainQuery;               // last result of GetTerrainQuery, created at first use
         ViewPoint m_viewPoint;
         WorldUpdateCounter m_updateTracker;
         bool m_isActiveObject;
+
+        // changes held back from far observers, see UpdateCoalesceClass
+        UpdateMask m_coalescedValues;
+        uint32 m_coalescedSendTime[MAX_UPDATE_COALESCE_CLASS];
+
+        bool IsCoalescingUpdates() const;
+        bool IsImmediateUpdateObserver(Player const* observer) const;
+        void CoalesceValuesUpdate();
 };
 
 #endif
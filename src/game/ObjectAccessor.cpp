@@ -93,22 +93,57 @@ Player* ObjectAccessor::FindPlayer(ObjectGuid guid, bool inWorld /*= true*/)
 
 Player* ObjectAccessor::FindPlayerByName(const char* name)
 {
-    HashMapHolder<Player>::ReadGuard g(HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (HashMapHolder<Player>::MapType::iterator iter = m.begin(); iter != m.end(); ++iter)
-        if (iter->second->IsInWorld() && (::strcmp(name, iter->second->GetName()) == 0))
-            { return iter->second; }
+    HashMapHolder<Player>::ReadGuard g(sObjectAccessor.i_playerNameLock);
+    PlayerNameMapType const& names = sObjectAccessor.i_playerNames;
+    PlayerNameMapType::const_iterator itr = names.find(name);
+    if (itr == names.end() || !itr->second->IsInWorld())
+        { return NULL; }
+
+    return itr->second;
+}
+
+void ObjectAccessor::AddObject(Player* object)
+{
+    HashMapHolder<Player>::Insert(object);
+
+    HashMapHolder<Player>::WriteGuard g(i_playerNameLock);
+    i_playerNames[object->GetName()] = object;
+}
+
+void ObjectAccessor::RemoveObject(Player* object)
+{
+    HashMapHolder<Player>::Remove(object);
+
+    HashMapHolder<Player>::WriteGuard g(i_playerNameLock);
+
+    // a player of the same name may have replaced it meanwhile
+    PlayerNameMapType::iterator itr = i_playerNames.find(object->GetName());
+    if (itr != i_playerNames.end() && itr->second == object)
+        { i_playerNames.erase(itr); }
+}
+
+void ObjectAccessor::RenamePlayer(Player* player, std::string const& newName)
+{
+    HashMapHolder<Player>::WriteGuard g(i_playerNameLock);
+
+    PlayerNameMapType::iterator itr = i_playerNames.find(player->GetName());
+    bool indexed = itr != i_playerNames.end() && itr->second == player;
+    if (indexed)
+        { i_playerNames.erase(itr); }
+
+    player->SetName(newName);
 
-    return NULL;
+    if (indexed)
+        { i_playerNames[newName] = player; }
 }
 
 void
 ObjectAccessor::SaveAllPlayers()
 {
-    HashMapHolder<Player>::ReadGuard g(HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (HashMapHolder<Player>::MapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-        { itr->second->SaveToDB(); }
+    HashMapHolder<Player>::SnapshotType players;
+    HashMapHolder<Player>::GetSnapshot(players);
+    for (HashMapHolder<Player>::SnapshotType::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+        { (*itr)->SaveToDB(); }
 }
 
 void ObjectAccessor::KickPlayer(ObjectGuid guid)
@@ -276,8 +311,7 @@ void ObjectAccessor::RemoveOldCorpses()
 
 /// Define the static member of HashMapHolder
 
-template <class T> typename HashMapHolder<T>::MapType HashMapHolder<T>::m_objectMap;
-template <class T> ACE_RW_Thread_Mutex HashMapHolder<T>::i_lock;
+template <class T> typename HashMapHolder<T>::Shard HashMapHolder<T>::m_shards[HASH_MAP_HOLDER_SHARDS];
 
 /// Global definitions for the hashmap storage
 
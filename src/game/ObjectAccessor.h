@@ -47,46 +47,87 @@ class Unit;
 class WorldObject;
 class Map;
 
+#define HASH_MAP_HOLDER_SHARDS 16                           // lock stripes of the global object maps
+
+/**
+ * The global objects of a type by guid, split into shards with a lock each by the guid counter,
+ * so lookups of the map update threads rarely wait for each other.
+ */
 template <class T>
 class HashMapHolder
 {
     public:
 
         typedef UNORDERED_MAP<ObjectGuid, T*>   MapType;
+        typedef std::vector<T*> SnapshotType;
         typedef ACE_RW_Thread_Mutex LockType;
         typedef ACE_Read_Guard<LockType> ReadGuard;
         typedef ACE_Write_Guard<LockType> WriteGuard;
 
         static void Insert(T* o)
         {
-            WriteGuard guard(i_lock);
-            m_objectMap[o->GetObjectGuid()] = o;
+            Shard& shard = GetShard(o->GetObjectGuid());
+            WriteGuard guard(shard.lock);
+            shard.objects[o->GetObjectGuid()] = o;
         }
 
         static void Remove(T* o)
         {
-            WriteGuard guard(i_lock);
-            m_objectMap.erase(o->GetObjectGuid());
+            Shard& shard = GetShard(o->GetObjectGuid());
+            WriteGuard guard(shard.lock);
+            shard.objects.erase(o->GetObjectGuid());
         }
 
         static T* Find(ObjectGuid guid)
         {
-            ReadGuard guard(i_lock);
-            typename MapType::iterator itr = m_objectMap.find(guid);
-            return (itr != m_objectMap.end()) ? itr->second : NULL;
+            Shard& shard = GetShard(guid);
+            ReadGuard guard(shard.lock);
+            typename MapType::const_iterator itr = shard.objects.find(guid);
+            return (itr != shard.objects.end()) ? itr->second : NULL;
         }
 
-        static MapType& GetContainer() { return m_objectMap; }
+        /**
+         * Copies the objects for iteration without holding the locks. The objects are only removed from the
+         * world thread outside the map updates, or by the map thread of their map, a world thread iteration
+         * outside the map updates is safe.
+         */
+        static void GetSnapshot(SnapshotType& objects)
+        {
+            objects.clear();
+            for (uint32 i = 0; i < HASH_MAP_HOLDER_SHARDS; ++i)
+            {
+                ReadGuard guard(m_shards[i].lock);
+                objects.reserve(objects.size() + m_shards[i].objects.size());
+                for (typename MapType::const_iterator itr = m_shards[i].objects.begin(); itr != m_shards[i].objects.end(); ++itr)
+                    { objects.push_back(itr->second); }
+            }
+        }
 
-        static LockType& GetLock() { return i_lock; }
+        static size_t GetCount()
+        {
+            size_t count = 0;
+            for (uint32 i = 0; i < HASH_MAP_HOLDER_SHARDS; ++i)
+            {
+                ReadGuard guard(m_shards[i].lock);
+                count += m_shards[i].objects.size();
+            }
+            return count;
+        }
 
     private:
 
+        struct Shard
+        {
+            LockType lock;
+            MapType objects;
+        };
+
         // Non instanceable only static
         HashMapHolder() {}
 
-        static LockType i_lock;
-        static MapType  m_objectMap;
+        static Shard& GetShard(ObjectGuid guid) { return m_shards[guid.GetCounter() % HASH_MAP_HOLDER_SHARDS]; }
+
+        static Shard m_shards[HASH_MAP_HOLDER_SHARDS];
 };
 
 class MANGOS_DLL_DECL ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor, MaNGOS::ClassLevelLockable<ObjectAccessor, ACE_Thread_Mutex> >
@@ -100,6 +141,7 @@ class MANGOS_DLL_DECL ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor,
 
     public:
         typedef UNORDERED_MAP<ObjectGuid, Corpse*> Player2CorpsesMapType;
+        typedef UNORDERED_MAP<std::string, Player*> PlayerNameMapType;
 
         // Search player at any map in world and other objects at same map with `obj`
         // Note: recommended use Map::GetUnit version if player also expected at same map only
@@ -107,12 +149,13 @@ class MANGOS_DLL_DECL ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor,
 
         // Player access
         static Player* FindPlayer(ObjectGuid guid, bool inWorld = true);// if need player at specific map better use Map::GetPlayer
-        static Player* FindPlayerByName(const char* name);
+        static Player* FindPlayerByName(const char* name);  // name as stored, see normalizePlayerName
         static void KickPlayer(ObjectGuid guid);
 
-        HashMapHolder<Player>::MapType& GetPlayers()
+        // Online players for iteration, see HashMapHolder::GetSnapshot
+        void GetPlayers(HashMapHolder<Player>::SnapshotType& players) const
         {
-            return HashMapHolder<Player>::GetContainer();
+            HashMapHolder<Player>::GetSnapshot(players);
         }
 
         void SaveAllPlayers();
@@ -128,19 +171,23 @@ class MANGOS_DLL_DECL ObjectAccessor : public MaNGOS::Singleton<ObjectAccessor,
 
         // For call from Player/Corpse AddToWorld/RemoveFromWorld only
         void AddObject(Corpse* object) { HashMapHolder<Corpse>::Insert(object); }
-        void AddObject(Player* object) { HashMapHolder<Player>::Insert(object); }
+        void AddObject(Player* object);
         void RemoveObject(Corpse* object) { HashMapHolder<Corpse>::Remove(object); }
-        void RemoveObject(Player* object) { HashMapHolder<Player>::Remove(object); }
+        void RemoveObject(Player* object);
+
+        // Renames a player added already, keeping the name index right
+        void RenamePlayer(Player* player, std::string const& newName);
 
     private:
 
         Player2CorpsesMapType   i_player2corpse;
+        PlayerNameMapType       i_playerNames;              // of the players in HashMapHolder<Player>
 
         typedef ACE_Thread_Mutex LockType;
         typedef MaNGOS::GeneralLock<LockType > Guard;
 
-        LockType i_playerGuard;
         LockType i_corpseGuard;
+        ACE_RW_Thread_Mutex i_playerNameLock;               // of i_playerNames
 };
 
 #define sObjectAccessor ObjectAccessor::Instance()
@@ -137,7 +137,7 @@ void LoadHelper(CellGuidSet const& guid_set, CellPair& cell, GridRefManager<T>&
         if (obj->isActiveObject())
             { map->AddToActive(obj); }
 
-        obj->GetViewPoint().Event_AddedToWorld(&grid);
+        obj->GetViewPoint().Event_AddedToWorld(&grid, cell);
 
         if (bg)
             { bg->OnObjectDBLoad(obj); }
@@ -24,6 +24,7 @@
 
 #include "ObjectMgr.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/SqlBatch.h"
 #include "Policies/Singleton.h"
 
 #include "SQLStorages.h"
@@ -51,6 +52,7 @@
 #include "Mail.h"
 #include "Formulas.h"
 #include "InstanceData.h"
+#include "PlayerNameCache.h"
 
 #include <limits>
 
@@ -136,12 +138,25 @@ ObjectMgr::ObjectMgr() :
     m_GroupIds("Group ids"),
     m_FirstTemporaryCreatureGuid(1),
     m_FirstTemporaryGameObjectGuid(1),
-    DBCLocaleIndex(LOCALE_enUS)
+    DBCLocaleIndex(LOCALE_enUS),
+    m_localesLoaded(1),
+    m_localesDeferred(false),
+    m_localesThread(NULL),
+    m_honorMaintenanceThread(NULL),
+    m_honorMaintenanceDone(0)
 {
 }
 
 ObjectMgr::~ObjectMgr()
 {
+    if (m_localesThread)
+    {
+        m_localesThread->wait();
+        delete m_localesThread;
+    }
+
+    WaitHonorMaintenance();
+
     for (QuestMap::iterator i = mQuestTemplates.begin(); i != mQuestTemplates.end(); ++i)
         { delete i->second; }
 
@@ -170,6 +185,58 @@ ObjectMgr::~ObjectMgr()
         { itr->second.Clear(); }
 }
 
+/// Loads the deferred *_locale tables, see ObjectMgr::RequestLocales
+class LocalesLoader : public ACE_Based::Runnable
+{
+    public:
+        void run() override
+        {
+            WorldDatabase.ThreadStart();                    // let thread do safe mySQL requests
+            sObjectMgr.LoadLocales();
+            WorldDatabase.ThreadEnd();                      // free mySQL thread resources
+        }
+};
+
+void ObjectMgr::LoadLocales()
+{
+    uint32 startTime = WorldTimer::getMSTime();
+
+    LoadCreatureLocales();                                  // must be after CreatureInfo loading
+    LoadGameObjectLocales();                                // must be after GameobjectInfo loading
+    LoadItemLocales();                                      // must be after ItemPrototypes loading
+    LoadQuestLocales();                                     // must be after QuestTemplates loading
+    LoadGossipTextLocales();                                // must be after LoadGossipText
+    LoadPageTextLocales();                                  // must be after PageText loading
+    LoadGossipMenuItemsLocales();                           // must be after gossip menu items loading
+    LoadPointOfInterestLocales();                           // must be after POI loading
+
+    // the maps are complete before the Get*Locale functions see them
+    m_localesLoaded = 1;
+
+    sLog.outString(">>> Localization strings loaded in %u ms", WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()));
+}
+
+void ObjectMgr::DeferLocales()
+{
+    // the loading thread must not add locale indexes while sessions look them up
+    for (int i = 0; i < MAX_LOCALE; ++i)
+        if (LocaleConstant(i) != LOCALE_enUS)
+            { GetOrNewIndexForLocale(LocaleConstant(i)); }
+
+    m_localesLoaded = 0;
+    m_localesDeferred = true;
+}
+
+void ObjectMgr::RequestLocales()
+{
+    if (!m_localesDeferred)
+        { return; }
+
+    m_localesDeferred = false;
+    sLog.outString("Loading Localization strings for the first localized client...");
+    m_localesThread = new ACE_Based::Thread(new LocalesLoader);
+}
+
 Group* ObjectMgr::GetGroupById(uint32 id) const
 {
     GroupMap::const_iterator itr = mGroupMap.find(id);
@@ -179,15 +246,10 @@ Group* ObjectMgr::GetGroupById(uint32 id) const
     return NULL;
 }
 
-void ObjectMgr::AddLocaleString(std::string const& s, LocaleConstant locale, StringVector& data)
+void ObjectMgr::AddLocaleString(std::string const& s, LocaleConstant locale, LocaleStrings& data)
 {
     if (!s.empty())
-    {
-        if (data.size() <= size_t(locale))
-            data.resize(locale + 1);
-
-        data[locale] = s;
-    }
+        { data.Set(locale, s); }
 }
 
 void ObjectMgr::LoadCreatureLocales()
@@ -232,10 +294,7 @@ void ObjectMgr::LoadCreatureLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Name.size() <= idx)
-                        { data.Name.resize(idx + 1); }
-
-                    data.Name[idx] = str;
+                    data.Name.Set(idx, str);
                 }
             }
             str = fields[1 + 2 * (i - 1) + 1].GetCppString();
@@ -244,10 +303,7 @@ void ObjectMgr::LoadCreatureLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.SubName.size() <= idx)
-                        { data.SubName.resize(idx + 1); }
-
-                    data.SubName[idx] = str;
+                    data.SubName.Set(idx, str);
                 }
             }
         }
@@ -323,10 +379,7 @@ void ObjectMgr::LoadGossipMenuItemsLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.OptionText.size() <= idx)
-                        { data.OptionText.resize(idx + 1); }
-
-                    data.OptionText[idx] = str;
+                    data.OptionText.Set(idx, str);
                 }
             }
             str = fields[2 + 2 * (i - 1) + 1].GetCppString();
@@ -335,10 +388,7 @@ void ObjectMgr::LoadGossipMenuItemsLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.BoxText.size() <= idx)
-                        { data.BoxText.resize(idx + 1); }
-
-                    data.BoxText[idx] = str;
+                    data.BoxText.Set(idx, str);
                 }
             }
         }
@@ -394,10 +444,7 @@ void ObjectMgr::LoadPointOfInterestLocales()
             int idx = GetOrNewIndexForLocale(LocaleConstant(i));
             if (idx >= 0)
             {
-                if (data.IconName.size() <= size_t(idx))
-                    { data.IconName.resize(idx + 1); }
-
-                data.IconName[idx] = str;
+                data.IconName.Set(idx, str);
             }
         }
     }
@@ -429,165 +476,183 @@ void ObjectMgr::LoadCreatureTemplates()
     // check data correctness
     for (uint32 i = 1; i < sCreatureStorage.GetMaxEntry(); ++i)
     {
-        CreatureInfo const* cInfo = sCreatureStorage.LookupEntry<CreatureInfo>(i);
-        if (!cInfo)
-            { continue; }
+        if (CreatureInfo const* cInfo = sCreatureStorage.LookupEntry<CreatureInfo>(i))
+            { CheckCreatureTemplate(cInfo); }
+    }
+}
+
+bool ObjectMgr::ReloadCreatureTemplates(uint32& changedCount)
+{
+    std::vector<uint32> changedIds;
+
+    SQLCreatureLoader loader;
+    if (!loader.Reload(sCreatureStorage, changedIds))
+        { return false; }
+
+    // only the published records need the checks, the others were checked before
+    for (std::vector<uint32>::const_iterator itr = changedIds.begin(); itr != changedIds.end(); ++itr)
+        { CheckCreatureTemplate(sCreatureStorage.LookupEntry<CreatureInfo>(*itr)); }
+
+    changedCount = uint32(changedIds.size());
+    return true;
+}
 
-        FactionTemplateEntry const* factionTemplate = sFactionTemplateStore.LookupEntry(cInfo->FactionAlliance);
-        if (!factionTemplate)
-            { sLog.outErrorDb("Creature (Entry: %u) has nonexistent faction_A template (%u)", cInfo->Entry, cInfo->FactionAlliance); }
+void ObjectMgr::CheckCreatureTemplate(CreatureInfo const* cInfo)
+{
+    FactionTemplateEntry const* factionTemplate = sFactionTemplateStore.LookupEntry(cInfo->FactionAlliance);
+    if (!factionTemplate)
+        { sLog.outErrorDb("Creature (Entry: %u) has nonexistent faction_A template (%u)", cInfo->Entry, cInfo->FactionAlliance); }
 
-        factionTemplate = sFactionTemplateStore.LookupEntry(cInfo->FactionHorde);
-        if (!factionTemplate)
-            { sLog.outErrorDb("Creature (Entry: %u) has nonexistent faction_H template (%u)", cInfo->Entry, cInfo->FactionHorde); }
+    factionTemplate = sFactionTemplateStore.LookupEntry(cInfo->FactionHorde);
+    if (!factionTemplate)
+        { sLog.outErrorDb("Creature (Entry: %u) has nonexistent faction_H template (%u)", cInfo->Entry, cInfo->FactionHorde); }
 
-        for (int k = 0; k < MAX_KILL_CREDIT; ++k)
+    for (int k = 0; k < MAX_KILL_CREDIT; ++k)
+    {
+        if (cInfo->KillCredit[k])
         {
-            if (cInfo->KillCredit[k])
+            if (!GetCreatureTemplate(cInfo->KillCredit[k]))
             {
-                if (!GetCreatureTemplate(cInfo->KillCredit[k]))
-                {
-                    sLog.outErrorDb("Creature (Entry: %u) has nonexistent creature entry in `KillCredit%d` (%u)", cInfo->Entry, k + 1, cInfo->KillCredit[k]);
-                    const_cast<CreatureInfo*>(cInfo)->KillCredit[k] = 0;
-                }
+                sLog.outErrorDb("Creature (Entry: %u) has nonexistent creature entry in `KillCredit%d` (%u)", cInfo->Entry, k + 1, cInfo->KillCredit[k]);
+                const_cast<CreatureInfo*>(cInfo)->KillCredit[k] = 0;
             }
         }
+    }
 
-        // used later for scale
-        CreatureDisplayInfoEntry const* displayScaleEntry = NULL;
+    // used later for scale
+    CreatureDisplayInfoEntry const* displayScaleEntry = NULL;
 
-        for (int i = 0; i < MAX_CREATURE_MODEL; ++i)
+    for (int i = 0; i < MAX_CREATURE_MODEL; ++i)
+    {
+        if (cInfo->ModelId[i])
         {
-            if (cInfo->ModelId[i])
+            CreatureDisplayInfoEntry const* displayEntry = sCreatureDisplayInfoStore.LookupEntry(cInfo->ModelId[i]);
+            if (!displayEntry)
             {
-                CreatureDisplayInfoEntry const* displayEntry = sCreatureDisplayInfoStore.LookupEntry(cInfo->ModelId[i]);
-                if (!displayEntry)
-                {
-                    sLog.outErrorDb("Creature (Entry: %u) has nonexistent modelid_%d (%u), can crash client", cInfo->Entry, i + 1, cInfo->ModelId[i]);
-                    const_cast<CreatureInfo*>(cInfo)->ModelId[i] = 0;
-                }
-                else if (!displayScaleEntry)
-                    { displayScaleEntry = displayEntry; }
-
-                CreatureModelInfo const* minfo = sCreatureModelStorage.LookupEntry<CreatureModelInfo>(cInfo->ModelId[i]);
-                if (!minfo)
-                    { sLog.outErrorDb("Creature (Entry: %u) are using modelid_%d (%u), but creature_model_info are missing for this model.", cInfo->Entry, i + 1, cInfo->ModelId[i]); }
+                sLog.outErrorDb("Creature (Entry: %u) has nonexistent modelid_%d (%u), can crash client", cInfo->Entry, i + 1, cInfo->ModelId[i]);
+                const_cast<CreatureInfo*>(cInfo)->ModelId[i] = 0;
             }
+            else if (!displayScaleEntry)
+                { displayScaleEntry = displayEntry; }
+
+            CreatureModelInfo const* minfo = sCreatureModelStorage.LookupEntry<CreatureModelInfo>(cInfo->ModelId[i]);
+            if (!minfo)
+                { sLog.outErrorDb("Creature (Entry: %u) are using modelid_%d (%u), but creature_model_info are missing for this model.", cInfo->Entry, i + 1, cInfo->ModelId[i]); }
         }
+    }
 
-        if (!displayScaleEntry)
-            { sLog.outErrorDb("Creature (Entry: %u) has nonexistent modelid in modelid_1/modelid_2", cInfo->Entry); }
+    if (!displayScaleEntry)
+        { sLog.outErrorDb("Creature (Entry: %u) has nonexistent modelid in modelid_1/modelid_2", cInfo->Entry); }
 
-        if (!cInfo->MinLevel)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has invalid minlevel, set to 1", cInfo->Entry);
-            const_cast<CreatureInfo*>(cInfo)->MinLevel = 1;
-        }
+    if (!cInfo->MinLevel)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has invalid minlevel, set to 1", cInfo->Entry);
+        const_cast<CreatureInfo*>(cInfo)->MinLevel = 1;
+    }
 
-        if (cInfo->MinLevel > cInfo->MaxLevel)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has invalid maxlevel, set to minlevel", cInfo->Entry);
-            const_cast<CreatureInfo*>(cInfo)->MaxLevel = cInfo->MinLevel;
-        }
+    if (cInfo->MinLevel > cInfo->MaxLevel)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has invalid maxlevel, set to minlevel", cInfo->Entry);
+        const_cast<CreatureInfo*>(cInfo)->MaxLevel = cInfo->MinLevel;
+    }
 
-        if (cInfo->MinLevel > DEFAULT_MAX_CREATURE_LEVEL)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) `MinLevel` exceeds maximum allowed value of '%u'", cInfo->Entry, uint32(DEFAULT_MAX_CREATURE_LEVEL));
-            const_cast<CreatureInfo*>(cInfo)->MinLevel = uint32(DEFAULT_MAX_CREATURE_LEVEL);
-        }
+    if (cInfo->MinLevel > DEFAULT_MAX_CREATURE_LEVEL)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) `MinLevel` exceeds maximum allowed value of '%u'", cInfo->Entry, uint32(DEFAULT_MAX_CREATURE_LEVEL));
+        const_cast<CreatureInfo*>(cInfo)->MinLevel = uint32(DEFAULT_MAX_CREATURE_LEVEL);
+    }
 
-        if (cInfo->MaxLevel > DEFAULT_MAX_CREATURE_LEVEL)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) `MaxLevel` exceeds maximum allowed value of '%u'", cInfo->Entry, uint32(DEFAULT_MAX_CREATURE_LEVEL));
-            const_cast<CreatureInfo*>(cInfo)->MaxLevel = uint32(DEFAULT_MAX_CREATURE_LEVEL);
-        }
+    if (cInfo->MaxLevel > DEFAULT_MAX_CREATURE_LEVEL)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) `MaxLevel` exceeds maximum allowed value of '%u'", cInfo->Entry, uint32(DEFAULT_MAX_CREATURE_LEVEL));
+        const_cast<CreatureInfo*>(cInfo)->MaxLevel = uint32(DEFAULT_MAX_CREATURE_LEVEL);
+    }
 
-        // use below code for 0-checks for unit_class
-        if (!cInfo->UnitClass || (((1 << (cInfo->UnitClass - 1)) & CLASSMASK_ALL_CREATURES) == 0))
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has invalid `UnitClass(%u)` in creature_template", cInfo->Entry, cInfo->UnitClass);
-            const_cast<CreatureInfo*>(cInfo)->UnitClass = uint32(CLASS_WARRIOR);
-        }
+    // use below code for 0-checks for unit_class
+    if (!cInfo->UnitClass || (((1 << (cInfo->UnitClass - 1)) & CLASSMASK_ALL_CREATURES) == 0))
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has invalid `UnitClass(%u)` in creature_template", cInfo->Entry, cInfo->UnitClass);
+        const_cast<CreatureInfo*>(cInfo)->UnitClass = uint32(CLASS_WARRIOR);
+    }
 
-        for (uint32 level = cInfo->MinLevel; level <= cInfo->MaxLevel; ++level)
+    for (uint32 level = cInfo->MinLevel; level <= cInfo->MaxLevel; ++level)
+    {
+        if (!GetCreatureClassLvlStats(level, cInfo->UnitClass))
         {
-            if (!GetCreatureClassLvlStats(level, cInfo->UnitClass))
-            {
-                sLog.outErrorDb("#Creature (Entry: %u), Class(%u), level(%u) has no data in `creature_template_classlevelstats`", cInfo->Entry, cInfo->UnitClass, level);
-                break;
-            }
+            sLog.outErrorDb("#Creature (Entry: %u), Class(%u), level(%u) has no data in `creature_template_classlevelstats`", cInfo->Entry, cInfo->UnitClass, level);
+            break;
         }
+    }
 
-        if (cInfo->DamageSchool >= MAX_SPELL_SCHOOL)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has invalid spell school value (%u) in `dmgschool`", cInfo->Entry, cInfo->DamageSchool);
-            const_cast<CreatureInfo*>(cInfo)->DamageSchool = SPELL_SCHOOL_NORMAL;
-        }
+    if (cInfo->DamageSchool >= MAX_SPELL_SCHOOL)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has invalid spell school value (%u) in `dmgschool`", cInfo->Entry, cInfo->DamageSchool);
+        const_cast<CreatureInfo*>(cInfo)->DamageSchool = SPELL_SCHOOL_NORMAL;
+    }
 
-        if (cInfo->MeleeBaseAttackTime == 0)
-            { const_cast<CreatureInfo*>(cInfo)->MeleeBaseAttackTime  = BASE_ATTACK_TIME; }
+    if (cInfo->MeleeBaseAttackTime == 0)
+        { const_cast<CreatureInfo*>(cInfo)->MeleeBaseAttackTime  = BASE_ATTACK_TIME; }
 
-        if (cInfo->RangedBaseAttackTime == 0)
-            { const_cast<CreatureInfo*>(cInfo)->RangedBaseAttackTime = BASE_ATTACK_TIME; }
+    if (cInfo->RangedBaseAttackTime == 0)
+        { const_cast<CreatureInfo*>(cInfo)->RangedBaseAttackTime = BASE_ATTACK_TIME; }
 
-        if ((cInfo->NpcFlags & UNIT_NPC_FLAG_TRAINER) && cInfo->TrainerType >= MAX_TRAINER_TYPE)
-            { sLog.outErrorDb("Creature (Entry: %u) has wrong trainer type %u", cInfo->Entry, cInfo->TrainerType); }
+    if ((cInfo->NpcFlags & UNIT_NPC_FLAG_TRAINER) && cInfo->TrainerType >= MAX_TRAINER_TYPE)
+        { sLog.outErrorDb("Creature (Entry: %u) has wrong trainer type %u", cInfo->Entry, cInfo->TrainerType); }
 
-        if (cInfo->CreatureType && !sCreatureTypeStore.LookupEntry(cInfo->CreatureType))
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has invalid creature type (%u) in `type`", cInfo->Entry, cInfo->CreatureType);
-            const_cast<CreatureInfo*>(cInfo)->CreatureType = CREATURE_TYPE_HUMANOID;
-        }
+    if (cInfo->CreatureType && !sCreatureTypeStore.LookupEntry(cInfo->CreatureType))
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has invalid creature type (%u) in `type`", cInfo->Entry, cInfo->CreatureType);
+        const_cast<CreatureInfo*>(cInfo)->CreatureType = CREATURE_TYPE_HUMANOID;
+    }
 
-        // must exist or used hidden but used in data horse case
-        if (cInfo->Family && !sCreatureFamilyStore.LookupEntry(cInfo->Family) && cInfo->Family != CREATURE_FAMILY_HORSE_CUSTOM)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has invalid creature family (%u) in `family`", cInfo->Entry, cInfo->Family);
-            const_cast<CreatureInfo*>(cInfo)->Family = 0;
-        }
+    // must exist or used hidden but used in data horse case
+    if (cInfo->Family && !sCreatureFamilyStore.LookupEntry(cInfo->Family) && cInfo->Family != CREATURE_FAMILY_HORSE_CUSTOM)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has invalid creature family (%u) in `family`", cInfo->Entry, cInfo->Family);
+        const_cast<CreatureInfo*>(cInfo)->Family = 0;
+    }
 
-        if (cInfo->InhabitType <= 0 || cInfo->InhabitType > INHABIT_ANYWHERE)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has wrong value (%u) in `InhabitType`, creature will not correctly walk/swim", cInfo->Entry, cInfo->InhabitType);
-            const_cast<CreatureInfo*>(cInfo)->InhabitType = INHABIT_ANYWHERE;
-        }
+    if (cInfo->InhabitType <= 0 || cInfo->InhabitType > INHABIT_ANYWHERE)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has wrong value (%u) in `InhabitType`, creature will not correctly walk/swim", cInfo->Entry, cInfo->InhabitType);
+        const_cast<CreatureInfo*>(cInfo)->InhabitType = INHABIT_ANYWHERE;
+    }
 
-        if (cInfo->PetSpellDataId)
-        {
-            CreatureSpellDataEntry const* spellDataId = sCreatureSpellDataStore.LookupEntry(cInfo->PetSpellDataId);
-            if (!spellDataId)
-                { sLog.outErrorDb("Creature (Entry: %u) has non-existing PetSpellDataId (%u)", cInfo->Entry, cInfo->PetSpellDataId); }
-        }
+    if (cInfo->PetSpellDataId)
+    {
+        CreatureSpellDataEntry const* spellDataId = sCreatureSpellDataStore.LookupEntry(cInfo->PetSpellDataId);
+        if (!spellDataId)
+            { sLog.outErrorDb("Creature (Entry: %u) has non-existing PetSpellDataId (%u)", cInfo->Entry, cInfo->PetSpellDataId); }
+    }
 
-        if (cInfo->MovementType >= MAX_DB_MOTION_TYPE)
-        {
-            sLog.outErrorDb("Creature (Entry: %u) has wrong movement generator type (%u), ignore and set to IDLE.", cInfo->Entry, cInfo->MovementType);
-            const_cast<CreatureInfo*>(cInfo)->MovementType = IDLE_MOTION_TYPE;
-        }
+    if (cInfo->MovementType >= MAX_DB_MOTION_TYPE)
+    {
+        sLog.outErrorDb("Creature (Entry: %u) has wrong movement generator type (%u), ignore and set to IDLE.", cInfo->Entry, cInfo->MovementType);
+        const_cast<CreatureInfo*>(cInfo)->MovementType = IDLE_MOTION_TYPE;
+    }
 
-        if (cInfo->EquipmentTemplateId > 0)                         // 0 no equipment
+    if (cInfo->EquipmentTemplateId > 0)                         // 0 no equipment
+    {
+        if (!GetEquipmentInfo(cInfo->EquipmentTemplateId) && !GetEquipmentInfoRaw(cInfo->EquipmentTemplateId))
         {
-            if (!GetEquipmentInfo(cInfo->EquipmentTemplateId) && !GetEquipmentInfoRaw(cInfo->EquipmentTemplateId))
-            {
-                sLog.outErrorDb("Table `creature_template` have creature (Entry: %u) with equipment_id %u not found in table `creature_equip_template` or `creature_equip_template_raw`, set to no equipment.", cInfo->Entry, cInfo->EquipmentTemplateId);
-                const_cast<CreatureInfo*>(cInfo)->EquipmentTemplateId = 0;
-            }
+            sLog.outErrorDb("Table `creature_template` have creature (Entry: %u) with equipment_id %u not found in table `creature_equip_template` or `creature_equip_template_raw`, set to no equipment.", cInfo->Entry, cInfo->EquipmentTemplateId);
+            const_cast<CreatureInfo*>(cInfo)->EquipmentTemplateId = 0;
         }
+    }
 
-        if (cInfo->VendorTemplateId > 0)
-        {
-            if (!(cInfo->NpcFlags & UNIT_NPC_FLAG_VENDOR))
-                { sLog.outErrorDb("Table `creature_template` have creature (Entry: %u) with vendor_id %u but not have flag UNIT_NPC_FLAG_VENDOR (%u), vendor items will ignored.", cInfo->Entry, cInfo->VendorTemplateId, UNIT_NPC_FLAG_VENDOR); }
-        }
+    if (cInfo->VendorTemplateId > 0)
+    {
+        if (!(cInfo->NpcFlags & UNIT_NPC_FLAG_VENDOR))
+            { sLog.outErrorDb("Table `creature_template` have creature (Entry: %u) with vendor_id %u but not have flag UNIT_NPC_FLAG_VENDOR (%u), vendor items will ignored.", cInfo->Entry, cInfo->VendorTemplateId, UNIT_NPC_FLAG_VENDOR); }
+    }
 
-        /// if not set custom creature scale then load scale from CreatureDisplayInfo.dbc
-        if (cInfo->Scale <= 0.0f)
-        {
-            if (displayScaleEntry)
-                { const_cast<CreatureInfo*>(cInfo)->Scale = displayScaleEntry->scale; }
-            else
-                { const_cast<CreatureInfo*>(cInfo)->Scale = DEFAULT_OBJECT_SCALE; }
-        }
+    /// if not set custom creature scale then load scale from CreatureDisplayInfo.dbc
+    if (cInfo->Scale <= 0.0f)
+    {
+        if (displayScaleEntry)
+            { const_cast<CreatureInfo*>(cInfo)->Scale = displayScaleEntry->scale; }
+        else
+            { const_cast<CreatureInfo*>(cInfo)->Scale = DEFAULT_OBJECT_SCALE; }
     }
 }
 
@@ -1023,8 +1088,9 @@ void ObjectMgr::LoadCreatureModelInfo()
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    //                                                0                       1   2    3
-    QueryResult* result = WorldDatabase.Query("SELECT creature.guid, creature.id, map, modelid,"
+    QueryResult* result = WorldDatabase.QueryWithSnapshot("creature", "creature,game_event_creature,pool_creature,pool_creature_template",
+                          //      0              1            2    3
+                          "SELECT creature.guid, creature.id, map, modelid,"
                           //   4             5           6           7           8            9              10         11
                           "equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, spawndist, currentwaypoint,"
                           //   12         13       14          15            16
@@ -1034,7 +1100,7 @@ void ObjectMgr::LoadCreatures()
                           "FROM creature "
                           "LEFT OUTER JOIN game_event_creature ON creature.guid = game_event_creature.guid "
                           "LEFT OUTER JOIN pool_creature ON creature.guid = pool_creature.guid "
-                          "LEFT OUTER JOIN pool_creature_template ON creature.id = pool_creature_template.id");
+                          "LEFT OUTER JOIN pool_creature_template ON creature.id = pool_creature_template.id", WorldDatabase.GetTableRowCount("creature"));
 
     if (!result)
     {
@@ -1049,6 +1115,8 @@ void ObjectMgr::LoadCreatures()
 
     // build single time for check creature data
 
+    mCreatureDataMap.reserve(mCreatureDataMap.size() + size_t(result->GetRowCount()));
+
     BarGoLink bar(result->GetRowCount());
 
     do
@@ -1192,8 +1260,9 @@ void ObjectMgr::LoadGameObjects()
 {
     uint32 count = 0;
 
-    //                                                0                           1   2    3           4           5           6
-    QueryResult* result = WorldDatabase.Query("SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
+    QueryResult* result = WorldDatabase.QueryWithSnapshot("gameobject", "gameobject,game_event_gameobject,pool_gameobject,pool_gameobject_template",
+                          //      0                1              2    3           4           5           6
+                          "SELECT gameobject.guid, gameobject.id, map, position_x, position_y, position_z, orientation,"
                           //   7          8          9          10         11             12            13     14
                           "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, event,"
                           //   15                          16
@@ -1201,7 +1270,7 @@ void ObjectMgr::LoadGameObjects()
                           "FROM gameobject "
                           "LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
                           "LEFT OUTER JOIN pool_gameobject ON gameobject.guid = pool_gameobject.guid "
-                          "LEFT OUTER JOIN pool_gameobject_template ON gameobject.id = pool_gameobject_template.id");
+                          "LEFT OUTER JOIN pool_gameobject_template ON gameobject.id = pool_gameobject_template.id", WorldDatabase.GetTableRowCount("gameobject"));
 
     if (!result)
     {
@@ -1214,6 +1283,8 @@ void ObjectMgr::LoadGameObjects()
         return;
     }
 
+    mGameObjectDataMap.reserve(mGameObjectDataMap.size() + size_t(result->GetRowCount()));
+
     BarGoLink bar(result->GetRowCount());
 
     do
@@ -1370,6 +1441,13 @@ bool ObjectMgr::GetPlayerNameByGUID(ObjectGuid guid, std::string& name) const
 
     uint32 lowguid = guid.GetCounter();
 
+    PlayerNameCache::Entry entry;
+    if (sPlayerNameCache.Get(lowguid, entry))
+    {
+        name = entry.name;
+        return true;
+    }
+
     QueryResult* result = CharacterDatabase.PQuery("SELECT name FROM characters WHERE guid = '%u'", lowguid);
 
     if (result)
@@ -1479,10 +1557,7 @@ void ObjectMgr::LoadItemLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Name.size() <= idx)
-                        { data.Name.resize(idx + 1); }
-
-                    data.Name[idx] = str;
+                    data.Name.Set(idx, str);
                 }
             }
 
@@ -1492,10 +1567,7 @@ void ObjectMgr::LoadItemLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Description.size() <= idx)
-                        { data.Description.resize(idx + 1); }
-
-                    data.Description[idx] = str;
+                    data.Description.Set(idx, str);
                 }
             }
         }
@@ -2604,186 +2676,241 @@ void ObjectMgr::LoadPlayerInfo()
         }
     }
 }
-void ObjectMgr::LoadStandingList(uint32 dateBegin)
-{
-    HonorStanding Standing;
 
+void ObjectMgr::LoadStandingList(uint32 dateBegin, HonorStandingList& allyList, HonorStandingList& hordeList)
+{
     // needed for reload case
-    AllyHonorStandingList.clear();
-    HordeHonorStandingList.clear();
+    allyList.clear();
+    hordeList.clear();
+
+    // this query create an ordered standing list, with the kills (victim setted) and the stored values of every character
+    QueryResult* result = CharacterDatabase.PQuery("SELECT cp.guid, SUM(cp.honor) AS honor_sum, SUM(CASE WHEN cp.victim > 0 THEN 1 ELSE 0 END), "
+                          "c.race, c.stored_honor_rating, c.stored_honorable_kills FROM character_honor_cp cp JOIN characters c ON c.guid = cp.guid "
+                          "WHERE cp.TYPE = %u AND cp.date BETWEEN %u AND %u GROUP BY cp.guid, c.race, c.stored_honor_rating, c.stored_honorable_kills "
+                          "ORDER BY honor_sum DESC", HONORABLE, dateBegin, dateBegin + 7);
+    if (!result)
+        { return; }
 
-    uint32 guid, kills, side;
+    uint32 minKills = sWorld.getConfig(CONFIG_UINT32_MIN_HONOR_KILLS);
 
-    Field* fields = NULL;
-    QueryResult* result2 = NULL;
-    // this query create an ordered standing list
-    QueryResult* result = CharacterDatabase.PQuery("SELECT guid,SUM(honor) as honor_sum FROM character_honor_cp WHERE TYPE = %u AND date BETWEEN %u AND %u GROUP BY guid ORDER BY honor_sum DESC", HONORABLE, dateBegin, dateBegin + 7);
-    if (result)
+    do
     {
-        BarGoLink bar(result->GetRowCount());
+        Field* fields = result->Fetch();
 
-        do
+        // you need to reach CONFIG_UINT32_MIN_HONOR_KILLS to be added in standing list
+        uint32 kills = fields[2].GetUInt32();
+        if (kills < minKills)
+            { continue; }
+
+        HonorStanding standing;
+        standing.guid = fields[0].GetUInt32();
+        standing.honorPoints = fields[1].GetUInt32();
+        standing.honorKills = kills;
+        standing.storedRating = fields[4].GetFloat();
+        standing.storedKills = fields[5].GetUInt32();
+
+        switch (Player::TeamForRace(fields[3].GetUInt8()))
         {
-            fields = result->Fetch();
-            guid  = fields[0].GetUInt32();
-            side = GetPlayerTeamByGUID(ObjectGuid(HIGHGUID_PLAYER, guid));
+            case ALLIANCE: allyList.push_back(standing);  break;
+            case HORDE:    hordeList.push_back(standing); break;
+            default:                                        break;
+        }
+    }
+    while (result->NextRow());
 
-            kills = 0;
-            // kills count with victim setted ( not zero value )
-            result2 = CharacterDatabase.PQuery("SELECT COUNT(*) FROM character_honor_cp WHERE guid = %u AND victim>0 AND TYPE = %u AND date BETWEEN %u AND %u", guid, HONORABLE, dateBegin, dateBegin + 7);
-            if (result2)
-                { kills = result2->Fetch()->GetUInt32(); }
+    delete result;
 
-            // you need to reach CONFIG_UINT32_MIN_HONOR_KILLS to be added in standing list
-            if (kills < sWorld.getConfig(CONFIG_UINT32_MIN_HONOR_KILLS))
-                { continue; }
+    // make sure all things are sorted
+    allyList.sort();
+    hordeList.sort();
+}
 
-            Standing.guid = guid;
-            Standing.honorPoints = fields[1].GetUInt32();
-            Standing.honorKills = kills;
+void ObjectMgr::LoadStandingList()
+{
+    uint32 LastWeekBegin = sWorld.GetDateLastMaintenanceDay() - 7;
+    LoadStandingList(LastWeekBegin, AllyHonorStandingList, HordeHonorStandingList);
 
-            if (side == ALLIANCE)
-                { AllyHonorStandingList.push_back(Standing); }
-            else if (side == HORDE)
-                { HordeHonorStandingList.push_back(Standing); }
+    // distribution of RP earning without flushing table
+    DistributeRankPoints(AllyHonorStandingList, LastWeekBegin);
+    DistributeRankPoints(HordeHonorStandingList, LastWeekBegin);
 
-            bar.step();
+    sLog.outString();
+    sLog.outString(">> Loaded %lu Horde and %lu Ally honor standing definitions", HordeHonorStandingList.size(), AllyHonorStandingList.size());
+}
+
+/// Runs the weekly honor maintenance, see ObjectMgr::StartHonorMaintenance
+class HonorMaintenanceJob : public ACE_Based::Runnable
+{
+    public:
+        explicit HonorMaintenanceJob(uint32 dateTop) : m_dateTop(dateTop) {}
+
+        void run() override
+        {
+            CharacterDatabase.ThreadStart();                // let thread do safe mySQL requests
+            sObjectMgr.FlushRankPoints(m_dateTop);
+            CharacterDatabase.ThreadEnd();                  // free mySQL thread resources
         }
-        while (result->NextRow());
 
-        delete result;
-        delete result2;
+    private:
+        uint32 m_dateTop;
+};
 
-        // make sure all things are sorted
-        AllyHonorStandingList.sort();
-        HordeHonorStandingList.sort();
-    }
+void ObjectMgr::StartHonorMaintenance(uint32 dateTop)
+{
+    // a maintenance still running did the work of the older weeks already
+    if (IsHonorMaintenanceRunning())
+        { return; }
+
+    sLog.outString("Honor maintenance started");
+    m_honorMaintenanceDone = 0;
+    m_honorMaintenanceThread = new ACE_Based::Thread(new HonorMaintenanceJob(dateTop));
 }
 
-void ObjectMgr::LoadStandingList()
+bool ObjectMgr::FinishHonorMaintenance()
 {
+    if (!m_honorMaintenanceThread || m_honorMaintenanceDone.value() == 0)
+        { return false; }
 
-    uint32 LastWeekBegin = sWorld.GetDateLastMaintenanceDay() - 7;
-    LoadStandingList(LastWeekBegin);
+    WaitHonorMaintenance();
 
-    // distribution of RP earning without flushing table
-    DistributeRankPoints(ALLIANCE, LastWeekBegin);
-    DistributeRankPoints(HORDE, LastWeekBegin);
+    AllyHonorStandingList.swap(m_maintenanceAllyList);
+    HordeHonorStandingList.swap(m_maintenanceHordeList);
+    m_maintenanceAllyList.clear();
+    m_maintenanceHordeList.clear();
 
-    sLog.outString();
     sLog.outString(">> Loaded %lu Horde and %lu Ally honor standing definitions", HordeHonorStandingList.size(), AllyHonorStandingList.size());
+    return true;
 }
 
+void ObjectMgr::WaitHonorMaintenance()
+{
+    if (!m_honorMaintenanceThread)
+        { return; }
+
+    m_honorMaintenanceThread->wait();
+    delete m_honorMaintenanceThread;
+    m_honorMaintenanceThread = NULL;
+}
 
 void ObjectMgr::FlushRankPoints(uint32 dateTop)
 {
     // FLUSH CP
-    QueryResult* result = CharacterDatabase.PQuery("SELECT date FROM character_honor_cp WHERE TYPE = %u AND date <= %u GROUP BY date ORDER BY date DESC", HONORABLE, dateTop);
-    if (result)
+    QueryResult* result = CharacterDatabase.PQuery("SELECT MIN(date) FROM character_honor_cp WHERE TYPE = %u AND date <= %u", HONORABLE, dateTop);
+    if (result && !result->Fetch()[0].IsNULL())
     {
-        uint32 date;
-        bool flush;
+        uint32 date = result->Fetch()[0].GetUInt32();
         uint32 WeekBegin = dateTop - 7;
         // search latest non-processed date if the server has been offline for different weeks
-        do
+        while (WeekBegin && date < WeekBegin)
         {
-            date = result->Fetch()->GetUInt32();
-            while (WeekBegin && date < WeekBegin)
-            {
-                WeekBegin -= 7;
-            }
+            WeekBegin -= 7;
         }
-        while (result->NextRow());
+
+        // the writes of a flushed week are not read back, its stored values are taken for the next weeks
+        UNORDERED_MAP<uint32, HonorStanding> flushed;
+        HonorStandingList allyList;
+        HonorStandingList hordeList;
 
         // start to flush from latest non-processed date to up
         while (WeekBegin <= dateTop)
         {
-            LoadStandingList(WeekBegin);
+            bool flush = WeekBegin < dateTop - 7;           // flush only with date < lastweek
+            if (flush)
+            {
+                LoadStandingList(WeekBegin, allyList, hordeList);
+
+                HonorStandingList* lists[] = { &allyList, &hordeList };
+                for (uint32 i = 0; i < countof(lists); ++i)
+                {
+                    for (HonorStandingList::iterator itr = lists[i]->begin(); itr != lists[i]->end(); ++itr)
+                    {
+                        UNORDERED_MAP<uint32, HonorStanding>::const_iterator prev = flushed.find(itr->guid);
+                        if (prev != flushed.end())
+                        {
+                            itr->storedRating = prev->second.storedRating;
+                            itr->storedKills = prev->second.storedKills;
+                        }
+                    }
 
-            flush = WeekBegin < dateTop - 7; // flush only with date < lastweek
+                    DistributeRankPoints(*lists[i], WeekBegin, true);
 
-            DistributeRankPoints(ALLIANCE, WeekBegin, flush);
-            DistributeRankPoints(HORDE, WeekBegin, flush);
+                    for (HonorStandingList::const_iterator itr = lists[i]->begin(); itr != lists[i]->end(); ++itr)
+                        { flushed[itr->guid] = *itr; }
+                }
+            }
 
             WeekBegin += 7;
         }
     }
 
+    delete result;
+
     // FLUSH KILLS
+    // process only HK ( victim_type > 0 ), all characters at once
     CharacterDatabase.BeginTransaction();
-    // process only HK ( victim_type > 0 )
-    result = CharacterDatabase.PQuery("SELECT guid,TYPE,COUNT(*) AS kills FROM character_honor_cp WHERE date <= %u AND victim_type>0 GROUP BY guid,type", dateTop - 7);
-    if (result)
-    {
-        uint32 guid, kills;
-        uint8 type;
-        Field* fields = NULL;
-        do
-        {
-            fields = result->Fetch();
-            guid   = fields[0].GetUInt32();
-            type   = fields[1].GetUInt8();
-            kills  = fields[2].GetUInt32();
-
-            if (type == HONORABLE)
-                { CharacterDatabase.PExecute("UPDATE characters SET stored_honorable_kills = stored_honorable_kills + %u WHERE guid = %u", kills, guid); }
-            else if (type == DISHONORABLE)
-                { CharacterDatabase.PExecute("UPDATE characters SET stored_dishonorable_kills = stored_dishonorable_kills + %u WHERE guid = %u", kills, guid); }
-        }
-        while (result->NextRow());
-    }
+    CharacterDatabase.PExecute("UPDATE characters SET stored_honorable_kills = stored_honorable_kills + "
+                               "(SELECT COUNT(*) FROM character_honor_cp cp WHERE cp.guid = characters.guid AND cp.date <= %u AND cp.victim_type > 0 AND cp.TYPE = %u) "
+                               "WHERE guid IN (SELECT guid FROM character_honor_cp WHERE date <= %u AND victim_type > 0 AND TYPE = %u)",
+                               dateTop - 7, HONORABLE, dateTop - 7, HONORABLE);
+    CharacterDatabase.PExecute("UPDATE characters SET stored_dishonorable_kills = stored_dishonorable_kills + "
+                               "(SELECT COUNT(*) FROM character_honor_cp cp WHERE cp.guid = characters.guid AND cp.date <= %u AND cp.victim_type > 0 AND cp.TYPE = %u) "
+                               "WHERE guid IN (SELECT guid FROM character_honor_cp WHERE date <= %u AND victim_type > 0 AND TYPE = %u)",
+                               dateTop - 7, DISHONORABLE, dateTop - 7, DISHONORABLE);
 
     // cleanin ALL cp before dateTop
     CharacterDatabase.PExecute("DELETE FROM character_honor_cp WHERE date <= %u", dateTop - 7);
     CharacterDatabase.CommitTransaction();
 
-    sLog.outString();
     sLog.outString(">> Flushed all ranking points");
 
-    delete result;
+    // the standings of the last week, taken by the world thread in FinishHonorMaintenance
+    uint32 LastWeekBegin = dateTop - 7;
+    LoadStandingList(LastWeekBegin, m_maintenanceAllyList, m_maintenanceHordeList);
+    DistributeRankPoints(m_maintenanceAllyList, LastWeekBegin);
+    DistributeRankPoints(m_maintenanceHordeList, LastWeekBegin);
+
+    m_honorMaintenanceDone = 1;
 }
 
-void ObjectMgr::DistributeRankPoints(uint32 team, uint32 dateBegin , bool flush /*false*/)
+void ObjectMgr::DistributeRankPoints(HonorStandingList& list, uint32 dateBegin, bool flush /*false*/)
 {
-    float RP;
-    uint32 HK;
-
-    HonorStandingList list = GetStandingListBySide(team);
-
     if (list.empty())
         { return; }
 
-    HonorScores scores = MaNGOS::Honor::GenerateScores(list, team);
+    HonorScores scores = MaNGOS::Honor::GenerateScores(list);
 
-    Field* fields = NULL;
-    QueryResult* result = NULL;
     for (HonorStandingList::iterator itr = list.begin(); itr != list.end() ; ++itr)
     {
-        RP = 0;
-        result = CharacterDatabase.PQuery("SELECT stored_honor_rating,stored_honorable_kills FROM characters WHERE guid = %u ", itr->guid);
-        if (!result)
-            { continue; } // not cleaned table?
-
-        fields = result->Fetch();
-        RP = fields[0].GetFloat();
-        HK = fields[1].GetUInt32();
-
-        itr->rpEarning = MaNGOS::Honor::CalculateRpEarning(itr->GetInfo()->honorPoints, scores);
-        RP             = MaNGOS::Honor::CalculateRpDecay(itr->rpEarning, RP);
+        itr->rpEarning = MaNGOS::Honor::CalculateRpEarning(itr->honorPoints, scores);
 
         if (flush)
         {
-            CharacterDatabase.BeginTransaction();
-            CharacterDatabase.PExecute("DELETE FROM character_honor_cp WHERE guid = %u AND TYPE = %u AND date BETWEEN %u AND %u", itr->guid, HONORABLE, dateBegin, dateBegin + 7);
-            CharacterDatabase.PExecute("UPDATE characters SET stored_honor_rating = %f , stored_honorable_kills = %u WHERE guid = %u", finiteAlways(RP + itr->rpEarning), HK + itr->honorKills, itr->guid);
-            CharacterDatabase.CommitTransaction();
+            itr->storedRating = finiteAlways(MaNGOS::Honor::CalculateRpDecay(itr->rpEarning, itr->storedRating) + itr->rpEarning);
+            itr->storedKills += itr->honorKills;
         }
     }
 
-    delete result;
+    if (!flush)
+        { return; }
+
+    // the contribution points of the week are replaced by the new stored values
+    char condition[64];
+    snprintf(condition, sizeof(condition), "TYPE = %u AND date BETWEEN %u AND %u", HONORABLE, dateBegin, dateBegin + 7);
+
+    CharacterDatabase.BeginTransaction();
+
+    SqlDeleteBatch deleteCP(CharacterDatabase, "character_honor_cp", "guid", std::string(condition));
+    for (HonorStandingList::const_iterator itr = list.begin(); itr != list.end() ; ++itr)
+    {
+        deleteCP.addKey(itr->guid);
+        CharacterDatabase.PExecute("UPDATE characters SET stored_honor_rating = %f , stored_honorable_kills = %u WHERE guid = %u", itr->storedRating, itr->storedKills, itr->guid);
+    }
+    deleteCP.Execute();
+
+    CharacterDatabase.CommitTransaction();
 }
 
-HonorStandingList ObjectMgr::GetStandingListBySide(uint32 side)
+HonorStandingList& ObjectMgr::GetStandingListBySide(uint32 side)
 {
     switch (side)
     {
@@ -2795,7 +2922,7 @@ HonorStandingList ObjectMgr::GetStandingListBySide(uint32 side)
 
 HonorStanding* ObjectMgr::GetHonorStandingByGUID(uint32 guid, uint32 side)
 {
-    HonorStandingList standingList = sObjectMgr.GetStandingListBySide(side);
+    HonorStandingList& standingList = sObjectMgr.GetStandingListBySide(side);
 
     for (HonorStandingList::iterator itr = standingList.begin(); itr != standingList.end() ; ++itr)
         if (itr->guid == guid)
@@ -2807,7 +2934,7 @@ HonorStanding* ObjectMgr::GetHonorStandingByGUID(uint32 guid, uint32 side)
 
 HonorStanding* ObjectMgr::GetHonorStandingByPosition(uint32 position, uint32 side)
 {
-    HonorStandingList standingList = sObjectMgr.GetStandingListBySide(side);
+    HonorStandingList& standingList = sObjectMgr.GetStandingListBySide(side);
     uint32 pos = 1;
 
     for (HonorStandingList::iterator itr = standingList.begin(); itr != standingList.end() ; ++itr)
@@ -2822,7 +2949,7 @@ HonorStanding* ObjectMgr::GetHonorStandingByPosition(uint32 position, uint32 sid
 
 uint32 ObjectMgr::GetHonorStandingPositionByGUID(uint32 guid, uint32 side)
 {
-    HonorStandingList standingList = sObjectMgr.GetStandingListBySide(side);
+    HonorStandingList& standingList = sObjectMgr.GetStandingListBySide(side);
     uint32 pos = 1;
 
     for (HonorStandingList::iterator itr = standingList.begin(); itr != standingList.end() ; ++itr)
@@ -3128,6 +3255,7 @@ void ObjectMgr::LoadGroups()
 void ObjectMgr::LoadQuests()
 {
     // For reload case
+    Player::InvalidateAllQuestGiverStatus();
     for (QuestMap::const_iterator itr = mQuestTemplates.begin(); itr != mQuestTemplates.end(); ++itr)
         { delete itr->second; }
 
@@ -3824,10 +3952,7 @@ void ObjectMgr::LoadQuestLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Title.size() <= idx)
-                        { data.Title.resize(idx + 1); }
-
-                    data.Title[idx] = str;
+                    data.Title.Set(idx, str);
                 }
             }
             str = fields[1 + 10 * (i - 1) + 1].GetCppString();
@@ -3836,10 +3961,7 @@ void ObjectMgr::LoadQuestLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Details.size() <= idx)
-                        { data.Details.resize(idx + 1); }
-
-                    data.Details[idx] = str;
+                    data.Details.Set(idx, str);
                 }
             }
             str = fields[1 + 10 * (i - 1) + 2].GetCppString();
@@ -3848,10 +3970,7 @@ void ObjectMgr::LoadQuestLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Objectives.size() <= idx)
-                        { data.Objectives.resize(idx + 1); }
-
-                    data.Objectives[idx] = str;
+                    data.Objectives.Set(idx, str);
                 }
             }
             str = fields[1 + 10 * (i - 1) + 3].GetCppString();
@@ -3860,10 +3979,7 @@ void ObjectMgr::LoadQuestLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.OfferRewardText.size() <= idx)
-                        { data.OfferRewardText.resize(idx + 1); }
-
-                    data.OfferRewardText[idx] = str;
+                    data.OfferRewardText.Set(idx, str);
                 }
             }
             str = fields[1 + 10 * (i - 1) + 4].GetCppString();
@@ -3872,10 +3988,7 @@ void ObjectMgr::LoadQuestLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.RequestItemsText.size() <= idx)
-                        { data.RequestItemsText.resize(idx + 1); }
-
-                    data.RequestItemsText[idx] = str;
+                    data.RequestItemsText.Set(idx, str);
                 }
             }
             str = fields[1 + 10 * (i - 1) + 5].GetCppString();
@@ -3884,10 +3997,7 @@ void ObjectMgr::LoadQuestLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.EndText.size() <= idx)
-                        { data.EndText.resize(idx + 1); }
-
-                    data.EndText[idx] = str;
+                    data.EndText.Set(idx, str);
                 }
             }
             for (int k = 0; k < 4; ++k)
@@ -3898,10 +4008,7 @@ void ObjectMgr::LoadQuestLocales()
                     int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                     if (idx >= 0)
                     {
-                        if ((int32)data.ObjectiveText[k].size() <= idx)
-                            { data.ObjectiveText[k].resize(idx + 1); }
-
-                        data.ObjectiveText[k][idx] = str;
+                        data.ObjectiveText[k].Set(idx, str);
                     }
                 }
             }
@@ -4175,10 +4282,7 @@ void ObjectMgr::LoadPageTextLocales()
             int idx = GetOrNewIndexForLocale(LocaleConstant(i));
             if (idx >= 0)
             {
-                if ((int32)data.Text.size() <= idx)
-                    { data.Text.resize(idx + 1); }
-
-                data.Text[idx] = str;
+                data.Text.Set(idx, str);
             }
         }
     }
@@ -4464,10 +4568,7 @@ void ObjectMgr::LoadGossipTextLocales()
                     int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                     if (idx >= 0)
                     {
-                        if ((int32)data.Text_0[j].size() <= idx)
-                            { data.Text_0[j].resize(idx + 1); }
-
-                        data.Text_0[j][idx] = str0;
+                        data.Text_0[j].Set(idx, str0);
                     }
                 }
                 std::string str1 = fields[1 + 8 * 2 * (i - 1) + 2 * j + 1].GetCppString();
@@ -4476,10 +4577,7 @@ void ObjectMgr::LoadGossipTextLocales()
                     int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                     if (idx >= 0)
                     {
-                        if ((int32)data.Text_1[j].size() <= idx)
-                            { data.Text_1[j].resize(idx + 1); }
-
-                        data.Text_1[j][idx] = str1;
+                        data.Text_1[j].Set(idx, str1);
                     }
                 }
             }
@@ -4493,16 +4591,73 @@ void ObjectMgr::LoadGossipTextLocales()
     sLog.outString(">> Loaded " SIZEFMTD " NpcText locale strings", mNpcTextLocaleMap.size());
 }
 
-// not very fast function but it is called only once a day, or on starting-up
+/// due mails read by one query of ReturnOrDeleteOldMails
+#define MAX_MAIL_EXPIRY_QUERY_MAILS 1000
+
+// at starting-up all expired mails are read, later only the due ones of the expiry queue
 void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
 {
     time_t basetime = time(NULL);
+
+    if (serverUp)
+    {
+        std::vector<uint32> dueMails;
+
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_mailExpiryLock);
+
+            // a bucket is due when all of its hour passed
+            MailExpiryQueue::iterator end = m_mailExpiryQueue.lower_bound(uint32(basetime / HOUR));
+            for (MailExpiryQueue::iterator itr = m_mailExpiryQueue.begin(); itr != end; ++itr)
+                { dueMails.insert(dueMails.end(), itr->second.begin(), itr->second.end()); }
+            m_mailExpiryQueue.erase(m_mailExpiryQueue.begin(), end);
+        }
+
+        uint32 count = 0;
+        for (size_t i = 0; i < dueMails.size(); i += MAX_MAIL_EXPIRY_QUERY_MAILS)
+        {
+            std::ostringstream ids;
+            for (size_t j = i; j < dueMails.size() && j < i + MAX_MAIL_EXPIRY_QUERY_MAILS; ++j)
+                { ids << (j > i ? "," : "") << dueMails[j]; }
+
+            // mails deleted or taken meanwhile are not found anymore
+            //                                                     0  1           2      3        4          5         6           7   8       9
+            QueryResult* result = CharacterDatabase.PQuery("SELECT id,messageType,sender,receiver,itemTextId,has_items,expire_time,cod,checked,mailTemplateId FROM mail WHERE id IN (%s) AND expire_time < '" UI64FMTD "'",
+                                  ids.str().c_str(), (uint64)basetime);
+            if (result)
+                { count += ReturnOrDeleteMails(result, true, basetime, NULL); }
+        }
+
+        if (!dueMails.empty())
+            { DEBUG_LOG("Returned or deleted %u of " SIZEFMTD " due mails", count, dueMails.size()); }
+        return;
+    }
+
     DEBUG_LOG("Returning mails current time: hour: %d, minute: %d, second: %d ", localtime(&basetime)->tm_hour, localtime(&basetime)->tm_min, localtime(&basetime)->tm_sec);
     // delete all old mails without item and without body immediately, if starting server
-    if (!serverUp)
-        { CharacterDatabase.PExecute("DELETE FROM mail WHERE expire_time < '" UI64FMTD "' AND has_items = '0' AND itemTextId = 0", (uint64)basetime); }
+    CharacterDatabase.PExecute("DELETE FROM mail WHERE expire_time < '" UI64FMTD "' AND has_items = '0' AND itemTextId = 0", (uint64)basetime);
     //                                                     0  1           2      3        4          5         6           7   8       9
     QueryResult* result = CharacterDatabase.PQuery("SELECT id,messageType,sender,receiver,itemTextId,has_items,expire_time,cod,checked,mailTemplateId FROM mail WHERE expire_time < '" UI64FMTD "'", (uint64)basetime);
+
+    uint32 count = 0;
+    if (result)
+    {
+        BarGoLink bar(result->GetRowCount());
+        count = ReturnOrDeleteMails(result, false, basetime, &bar);
+    }
+
+    // the later expiring mails wait in the queue
+    if (QueryResult* queueResult = CharacterDatabase.PQuery("SELECT id,expire_time FROM mail WHERE expire_time >= '" UI64FMTD "'", (uint64)basetime))
+    {
+        do
+        {
+            Field* fields = queueResult->Fetch();
+            ScheduleMailExpiry(fields[0].GetUInt32(), time_t(fields[1].GetUInt64()));
+        }
+        while (queueResult->NextRow());
+        delete queueResult;
+    }
+
     if (!result)
     {
         BarGoLink bar(1);
@@ -4512,18 +4667,30 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
         return;                                             // any mails need to be returned or deleted
     }
 
+    sLog.outString();
+    sLog.outString(">> Loaded %u mails", count);
+}
+
+void ObjectMgr::ScheduleMailExpiry(uint32 mailId, time_t expireTime)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mailExpiryLock);
+    m_mailExpiryQueue[uint32(expireTime / HOUR)].push_back(mailId);
+}
+
+uint32 ObjectMgr::ReturnOrDeleteMails(QueryResult* result, bool serverUp, time_t basetime, BarGoLink* bar)
+{
     // std::ostringstream delitems, delmails; // will be here for optimization
     // bool deletemail = false, deleteitem = false;
     // delitems << "DELETE FROM item_instance WHERE guid IN ( ";
     // delmails << "DELETE FROM mail WHERE id IN ( "
 
-    BarGoLink bar(result->GetRowCount());
     uint32 count = 0;
     Field* fields;
 
     do
     {
-        bar.step();
+        if (bar)
+            { bar->step(); }
 
         fields = result->Fetch();
         Mail* m = new Mail;
@@ -4543,8 +4710,8 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
             { pl = GetPlayer(m->receiverGuid); }
         if (pl)
         {
-            // this code will run very improbably (the time is between 4 and 5 am, in game is online a player, who has old mail
-            // his in mailbox and he has already listed his mails )
+            // the mail may be in the list the online player has already seen, try again later
+            ScheduleMailExpiry(m->messageID, basetime + HOUR);
             delete m;
             continue;
         }
@@ -4579,6 +4746,7 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
                 // mail will be returned:
                 CharacterDatabase.PExecute("UPDATE mail SET sender = '%u', receiver = '%u', expire_time = '" UI64FMTD "', deliver_time = '" UI64FMTD "',cod = '0', checked = '%u' WHERE id = '%u'",
                                            m->receiverGuid.GetCounter(), m->sender, (uint64)(basetime + 30 * DAY), (uint64)basetime, MAIL_CHECK_MASK_RETURNED, m->messageID);
+                ScheduleMailExpiry(m->messageID, basetime + 30 * DAY);
                 for (MailItemInfoVec::iterator itr2 = m->items.begin(); itr2 != m->items.end(); ++itr2)
                 {
                     // update receiver in mail items for its proper delivery, and in instance_item for avoid lost item at sender delete
@@ -4602,8 +4770,7 @@ void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
     while (result->NextRow());
     delete result;
 
-    sLog.outString();
-    sLog.outString(">> Loaded %u mails", count);
+    return count;
 }
 
 void ObjectMgr::LoadQuestAreaTriggers()
@@ -5435,10 +5602,7 @@ void ObjectMgr::LoadGameObjectLocales()
                 int idx = GetOrNewIndexForLocale(LocaleConstant(i));
                 if (idx >= 0)
                 {
-                    if ((int32)data.Name.size() <= idx)
-                        { data.Name.resize(idx + 1); }
-
-                    data.Name[idx] = str;
+                    data.Name.Set(idx, str);
                 }
             }
         }
@@ -6304,6 +6468,7 @@ void ObjectMgr::DeleteCorpseCellData(uint32 mapid, uint32 cellid, uint32 player_
 void ObjectMgr::LoadQuestRelationsHelper(QuestRelationsMap& map, char const* table)
 {
     map.clear();                                            // need for reload case
+    Player::InvalidateAllQuestGiverStatus();
 
     uint32 count = 0;
 
@@ -6759,7 +6924,7 @@ bool ObjectMgr::LoadMangosStrings(DatabaseType& db, char const* table, int32 min
     for (MangosStringLocaleMap::iterator itr = mMangosStringLocaleMap.begin(); itr != mMangosStringLocaleMap.end();)
     {
         if (itr->first >= start_value && itr->first < end_value)
-            { mMangosStringLocaleMap.erase(itr++); }
+            { itr = mMangosStringLocaleMap.erase(itr); }    // moves the last entry to itr
         else
             { ++itr; }
     }
@@ -6817,7 +6982,7 @@ bool ObjectMgr::LoadMangosStrings(DatabaseType& db, char const* table, int32 min
         ++count;
 
         // 0 -> default, idx in to idx+1
-        data.Content[0] = fields[1].GetCppString();
+        data.Content.Set(0, fields[1].GetCppString());
 
         for (int i = 1; i < MAX_LOCALE; ++i)
         {
@@ -6828,10 +6993,7 @@ bool ObjectMgr::LoadMangosStrings(DatabaseType& db, char const* table, int32 min
                 if (idx >= 0)
                 {
                     // 0 -> default, idx in to idx+1
-                    if ((int32)data.Content.size() <= idx + 1)
-                        { data.Content.resize(idx + 2); }
-
-                    data.Content[idx + 1] = str;
+                    data.Content.Set(idx + 1, str);
                 }
             }
         }
@@ -6890,10 +7052,11 @@ const char* ObjectMgr::GetMangosString(int32 entry, int locale_idx) const
     // Content[0] always exist if exist MangosStringLocale
     if (MangosStringLocale const* msl = GetMangosStringLocale(entry))
     {
-        if ((int32)msl->Content.size() > locale_idx + 1 && !msl->Content[locale_idx + 1].empty())
-            { return msl->Content[locale_idx + 1].c_str(); }
-        else
-            { return msl->Content[0].c_str(); }
+        if (char const* str = msl->Content.Get(locale_idx + 1))
+            { return str; }
+
+        char const* str = msl->Content.Get(0);
+        return str ? str : "";
     }
 
     _DoStringError(entry, "Entry %i not found but requested", entry);
@@ -8554,6 +8717,27 @@ void ObjectMgr::AddGroup(Group* group)
 void ObjectMgr::RemoveGroup(Group* group)
 {
     mGroupMap.erase(group->GetId());
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_groupStatsUpdateLock);
+    m_groupStatsUpdates.erase(group);
+}
+
+void ObjectMgr::AddGroupStatsUpdate(Group* group)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_groupStatsUpdateLock);
+    m_groupStatsUpdates.insert(group);
+}
+
+void ObjectMgr::SendGroupStatsUpdates()
+{
+    GroupSet groups;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_groupStatsUpdateLock);
+        groups.swap(m_groupStatsUpdates);
+    }
+
+    for (GroupSet::const_iterator itr = groups.begin(); itr != groups.end(); ++itr)
+        { (*itr)->SendChangedMemberStats(); }
 }
 
 void ObjectMgr::GetCreatureLocaleStrings(uint32 entry, int32 loc_idx, char const** namePtr, char const** subnamePtr) const
@@ -8562,11 +8746,11 @@ void ObjectMgr::GetCreatureLocaleStrings(uint32 entry, int32 loc_idx, char const
     {
         if (CreatureLocale const *il = GetCreatureLocale(entry))
         {
-            if (namePtr && il->Name.size() > size_t(loc_idx) && !il->Name[loc_idx].empty())
-                { *namePtr = il->Name[loc_idx].c_str(); }
+            if (char const* name = namePtr ? il->Name.Get(loc_idx) : NULL)
+                { *namePtr = name; }
 
-            if (subnamePtr && il->SubName.size() > size_t(loc_idx) && !il->SubName[loc_idx].empty())
-                { *subnamePtr = il->SubName[loc_idx].c_str(); }
+            if (char const* subname = subnamePtr ? il->SubName.Get(loc_idx) : NULL)
+                { *subnamePtr = subname; }
         }
     }
 }
@@ -8577,11 +8761,11 @@ void ObjectMgr::GetItemLocaleStrings(uint32 entry, int32 loc_idx, std::string* n
     {
         if (ItemLocale const *il = GetItemLocale(entry))
         {
-            if (namePtr && il->Name.size() > size_t(loc_idx) && !il->Name[loc_idx].empty())
-                { *namePtr = il->Name[loc_idx]; }
+            if (char const* name = namePtr ? il->Name.Get(loc_idx) : NULL)
+                { *namePtr = name; }
 
-            if (descriptionPtr && il->Description.size() > size_t(loc_idx) && !il->Description[loc_idx].empty())
-                { *descriptionPtr = il->Description[loc_idx]; }
+            if (char const* description = descriptionPtr ? il->Description.Get(loc_idx) : NULL)
+                { *descriptionPtr = description; }
         }
     }
 }
@@ -8592,8 +8776,8 @@ void ObjectMgr::GetQuestLocaleStrings(uint32 entry, int32 loc_idx, std::string*
     {
         if (QuestLocale const *il = GetQuestLocale(entry))
         {
-            if (titlePtr && il->Title.size() > size_t(loc_idx) && !il->Title[loc_idx].empty())
-                { *titlePtr = il->Title[loc_idx]; }
+            if (char const* title = titlePtr ? il->Title.Get(loc_idx) : NULL)
+                { *titlePtr = title; }
         }
     }
 }
@@ -8606,13 +8790,13 @@ void ObjectMgr::GetNpcTextLocaleStringsAll(uint32 entry, int32 loc_idx, ObjectMg
         {
             if (text0_Ptr)
                 for (int i = 0; i < MAX_GOSSIP_TEXT_OPTIONS; ++i)
-                    if (nl->Text_0[i].size() > (size_t)loc_idx && !nl->Text_0[i][loc_idx].empty())
-                        { (*text0_Ptr)[i] = nl->Text_0[i][loc_idx]; }
+                    if (char const* text = nl->Text_0[i].Get(loc_idx))
+                        { (*text0_Ptr)[i] = text; }
 
             if (text1_Ptr)
                 for (int i = 0; i < MAX_GOSSIP_TEXT_OPTIONS; ++i)
-                    if (nl->Text_1[i].size() > (size_t)loc_idx && !nl->Text_1[i][loc_idx].empty())
-                        { (*text1_Ptr)[i] = nl->Text_1[i][loc_idx]; }
+                    if (char const* text = nl->Text_1[i].Get(loc_idx))
+                        { (*text1_Ptr)[i] = text; }
         }
     }
 }
@@ -8623,13 +8807,11 @@ void ObjectMgr::GetNpcTextLocaleStrings0(uint32 entry, int32 loc_idx, std::strin
     {
         if (NpcTextLocale const *nl = GetNpcTextLocale(entry))
         {
-            if (text0_0_Ptr)
-                if (nl->Text_0[0].size() > (size_t)loc_idx && !nl->Text_0[0][loc_idx].empty())
-                    { *text0_0_Ptr = nl->Text_0[0][loc_idx]; }
+            if (char const* text = text0_0_Ptr ? nl->Text_0[0].Get(loc_idx) : NULL)
+                { *text0_0_Ptr = text; }
 
-            if (text1_0_Ptr)
-                if (nl->Text_1[0].size() > (size_t)loc_idx && !nl->Text_1[0][loc_idx].empty())
-                    { *text1_0_Ptr = nl->Text_1[0][loc_idx]; }
+            if (char const* text = text1_0_Ptr ? nl->Text_1[0].Get(loc_idx) : NULL)
+                { *text1_0_Ptr = text; }
         }
     }
 }
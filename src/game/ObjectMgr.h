@@ -42,6 +42,9 @@
 #include "ObjectAccessor.h"
 #include "ObjectGuid.h"
 #include "Policies/Singleton.h"
+#include "Utilities/FlatHashMap.h"
+#include "Utilities/SortedVectorMultimap.h"
+#include "Threading.h"
 
 #include <string>
 #include <map>
@@ -50,6 +53,7 @@
 class Group;
 class Item;
 class SQLStorage;
+class BarGoLink;
 
 struct GameTele
 {
@@ -115,14 +119,14 @@ struct MangosStringLocale
 {
     MangosStringLocale() : SoundId(0), Type(0), LanguageId(LANG_UNIVERSAL), Emote(0) { }
 
-    std::vector<std::string> Content;                       // 0 -> default, i -> i-1 locale index
+    LocaleStrings Content;                                  // 0 -> default, i -> i-1 locale index
     uint32 SoundId;
     uint8  Type;
     Language LanguageId;
     uint32 Emote;
 };
 
-typedef UNORDERED_MAP<uint32, CreatureData> CreatureDataMap;
+typedef FlatHashMap<uint32, CreatureData> CreatureDataMap;
 typedef CreatureDataMap::value_type CreatureDataPair;
 
 class FindCreatureData
@@ -145,7 +149,7 @@ class FindCreatureData
         float i_spawnedDist;
 };
 
-typedef UNORDERED_MAP<uint32, GameObjectData> GameObjectDataMap;
+typedef FlatHashMap<uint32, GameObjectData> GameObjectDataMap;
 typedef GameObjectDataMap::value_type GameObjectDataPair;
 
 class FindGOData
@@ -168,19 +172,19 @@ class FindGOData
         float i_spawnedDist;
 };
 
-typedef UNORDERED_MAP<uint32, CreatureLocale> CreatureLocaleMap;
-typedef UNORDERED_MAP<uint32, GameObjectLocale> GameObjectLocaleMap;
-typedef UNORDERED_MAP<uint32, ItemLocale> ItemLocaleMap;
-typedef UNORDERED_MAP<uint32, QuestLocale> QuestLocaleMap;
-typedef UNORDERED_MAP<uint32, NpcTextLocale> NpcTextLocaleMap;
-typedef UNORDERED_MAP<uint32, PageTextLocale> PageTextLocaleMap;
-typedef UNORDERED_MAP<int32, MangosStringLocale> MangosStringLocaleMap;
-typedef UNORDERED_MAP<uint32, GossipMenuItemsLocale> GossipMenuItemsLocaleMap;
-typedef UNORDERED_MAP<uint32, PointOfInterestLocale> PointOfInterestLocaleMap;
-
-typedef std::multimap<int32, uint32> ExclusiveQuestGroupsMap;
-typedef std::multimap<uint32, ItemRequiredTarget> ItemRequiredTargetMap;
-typedef std::multimap<uint32, uint32> QuestRelationsMap;
+typedef FlatHashMap<uint32, CreatureLocale> CreatureLocaleMap;
+typedef FlatHashMap<uint32, GameObjectLocale> GameObjectLocaleMap;
+typedef FlatHashMap<uint32, ItemLocale> ItemLocaleMap;
+typedef FlatHashMap<uint32, QuestLocale> QuestLocaleMap;
+typedef FlatHashMap<uint32, NpcTextLocale> NpcTextLocaleMap;
+typedef FlatHashMap<uint32, PageTextLocale> PageTextLocaleMap;
+typedef FlatHashMap<int32, MangosStringLocale> MangosStringLocaleMap;
+typedef FlatHashMap<uint32, GossipMenuItemsLocale> GossipMenuItemsLocaleMap;
+typedef FlatHashMap<uint32, PointOfInterestLocale> PointOfInterestLocaleMap;
+
+typedef SortedVectorMultimap<int32, uint32> ExclusiveQuestGroupsMap;
+typedef SortedVectorMultimap<uint32, ItemRequiredTarget> ItemRequiredTargetMap;
+typedef SortedVectorMultimap<uint32, uint32> QuestRelationsMap;
 typedef std::pair<ExclusiveQuestGroupsMap::const_iterator, ExclusiveQuestGroupsMap::const_iterator> ExclusiveQuestGroupsMapBounds;
 typedef std::pair<ItemRequiredTargetMap::const_iterator, ItemRequiredTargetMap::const_iterator> ItemRequiredTargetMapBounds;
 typedef std::pair<QuestRelationsMap::const_iterator, QuestRelationsMap::const_iterator> QuestRelationsMapBounds;
@@ -258,9 +262,9 @@ struct GossipMenus
     uint16          conditionId;
 };
 
-typedef std::multimap<uint32, GossipMenus> GossipMenusMap;
+typedef SortedVectorMultimap<uint32, GossipMenus> GossipMenusMap;
 typedef std::pair<GossipMenusMap::const_iterator, GossipMenusMap::const_iterator> GossipMenusMapBounds;
-typedef std::multimap<uint32, GossipMenuItems> GossipMenuItemsMap;
+typedef SortedVectorMultimap<uint32, GossipMenuItems> GossipMenuItemsMap;
 typedef std::pair<GossipMenuItemsMap::const_iterator, GossipMenuItemsMap::const_iterator> GossipMenuItemsMapBounds;
 
 struct PetCreateSpellEntry
@@ -286,7 +290,7 @@ struct GraveYardData
     uint32 safeLocId;
     Team team;
 };
-typedef std::multimap < uint32 /*zoneId*/, GraveYardData > GraveYardMap;
+typedef SortedVectorMultimap < uint32 /*zoneId*/, GraveYardData > GraveYardMap;
 typedef std::pair<GraveYardMap::const_iterator, GraveYardMap::const_iterator> GraveYardMapBounds;
 
 enum ConditionType
@@ -425,12 +429,16 @@ class HonorStanding
             honorKills  = 0;
             guid        = 0;
             rpEarning   = 0;
+            storedRating = 0;
+            storedKills = 0;
         }
 
         float honorPoints;
         uint32 honorKills;
         uint32 guid;
         float rpEarning;
+        float storedRating;                                 // stored_honor_rating of the character, for the flush
+        uint32 storedKills;                                 // stored_honorable_kills of the character, for the flush
 
         HonorStanding* GetInfo() { return this; };
 };
@@ -490,6 +498,10 @@ class ObjectMgr
         Group* GetGroupById(uint32 id) const;
         void AddGroup(Group* group);
         void RemoveGroup(Group* group);
+        /// Queues the group to send the stats changes of its raid members, thread safe, see Group::AddStatsChangedMember
+        void AddGroupStatsUpdate(Group* group);
+        /// Sends the queued stats changes of all groups, by the world thread while no map is updated
+        void SendGroupStatsUpdates();
 
         CreatureModelInfo const* GetCreatureModelRandomGender(uint32 display_id) const;
         uint32 GetCreatureModelOtherTeamModel(uint32 modelId) const;
@@ -642,6 +654,14 @@ class ObjectMgr
         void LoadPetCreateSpells();
         void LoadCreatureLocales();
         void LoadCreatureTemplates();
+        /**
+         * @brief publishes the changed rows of creature_template, see SQLStorageLoaderBase::Reload
+         *
+         * Spawned creatures keep the template they were created with until they are created again.
+         * @param changedCount receives the number of changed and added templates
+         * @return bool false if the table can't be read
+         */
+        bool ReloadCreatureTemplates(uint32& changedCount);
         void LoadCreatures();
         void LoadCreatureAddons();
         void LoadCreatureClassLvlStats();
@@ -658,6 +678,24 @@ class ObjectMgr
         void LoadPageTextLocales();
         void LoadGossipMenuItemsLocales();
         void LoadPointOfInterestLocales();
+        /**
+         * @brief loads all *_locale tables
+         *
+         */
+        void LoadLocales();
+        /**
+         * @brief leaves the *_locale tables to the first session of a localized client, see RequestLocales
+         *
+         */
+        void DeferLocales();
+        /**
+         * @brief starts loading the deferred *_locale tables in a thread of their own
+         *
+         * Until they are loaded no locale data is found and the default texts are used.
+         * Once loaded they stay loaded.
+         */
+        void RequestLocales();
+        bool AreLocalesLoaded() const { return m_localesLoaded.value() != 0; }
         void LoadInstanceTemplate();
         void LoadWorldTemplate();
         void LoadConditions();
@@ -713,15 +751,41 @@ class ObjectMgr
 
         static HonorStanding* GetHonorStandingByGUID(uint32 guid, uint32 side);
         static HonorStanding* GetHonorStandingByPosition(uint32 position, uint32 side);
-        HonorStandingList GetStandingListBySide(uint32 side);
+        HonorStandingList& GetStandingListBySide(uint32 side);
         uint32 GetHonorStandingPositionByGUID(uint32 guid, uint32 side);
         void UpdateHonorStandingByGuid(uint32 guid, HonorStanding standing, uint32 side) ;
         void FlushRankPoints(uint32 dateTop);
-        void DistributeRankPoints(uint32 team, uint32 dateBegin , bool flush = false);
-        void LoadStandingList(uint32 dateBegin);
+        static void DistributeRankPoints(HonorStandingList& list, uint32 dateBegin, bool flush = false);
+        static void LoadStandingList(uint32 dateBegin, HonorStandingList& allyList, HonorStandingList& hordeList);
         void LoadStandingList();
 
+        /**
+         * @brief starts the weekly honor maintenance on its own thread
+         *
+         * The thread flushes the rank points of the weeks before dateTop - 7 and computes the standings
+         * of the last week, the standing lists in use are not touched meanwhile.
+         *
+         * @param dateTop day of the last maintenance
+         */
+        void StartHonorMaintenance(uint32 dateTop);
+        /**
+         * @brief takes the standings of a finished honor maintenance
+         *
+         * @return bool true if the maintenance finished since the last call
+         */
+        bool FinishHonorMaintenance();
+        void WaitHonorMaintenance();
+        bool IsHonorMaintenanceRunning() const { return m_honorMaintenanceThread != NULL; }
+
+        /**
+         * @brief returns or deletes expired mails
+         *
+         * @param serverUp false at starting-up, when all expired mails are read and the expiry queue is filled,
+         *                 true for the due mails of the queue
+         */
         void ReturnOrDeleteOldMails(bool serverUp);
+        /// Adds a mail to the expiry queue, can be called from map threads too
+        void ScheduleMailExpiry(uint32 mailId, time_t expireTime);
 
         void SetHighestGuids();
 
@@ -790,6 +854,7 @@ class ObjectMgr
 
         CreatureLocale const* GetCreatureLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             CreatureLocaleMap::const_iterator itr = mCreatureLocaleMap.find(entry);
             if (itr == mCreatureLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -799,6 +864,7 @@ class ObjectMgr
 
         GameObjectLocale const* GetGameObjectLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             GameObjectLocaleMap::const_iterator itr = mGameObjectLocaleMap.find(entry);
             if (itr == mGameObjectLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -806,6 +872,7 @@ class ObjectMgr
 
         ItemLocale const* GetItemLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             ItemLocaleMap::const_iterator itr = mItemLocaleMap.find(entry);
             if (itr == mItemLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -815,6 +882,7 @@ class ObjectMgr
 
         QuestLocale const* GetQuestLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             QuestLocaleMap::const_iterator itr = mQuestLocaleMap.find(entry);
             if (itr == mQuestLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -824,6 +892,7 @@ class ObjectMgr
 
         NpcTextLocale const* GetNpcTextLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             NpcTextLocaleMap::const_iterator itr = mNpcTextLocaleMap.find(entry);
             if (itr == mNpcTextLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -835,6 +904,7 @@ class ObjectMgr
 
         PageTextLocale const* GetPageTextLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             PageTextLocaleMap::const_iterator itr = mPageTextLocaleMap.find(entry);
             if (itr == mPageTextLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -842,6 +912,7 @@ class ObjectMgr
 
         GossipMenuItemsLocale const* GetGossipMenuItemsLocale(uint32 entry) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             GossipMenuItemsLocaleMap::const_iterator itr = mGossipMenuItemsLocaleMap.find(entry);
             if (itr == mGossipMenuItemsLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -849,6 +920,7 @@ class ObjectMgr
 
         PointOfInterestLocale const* GetPointOfInterestLocale(uint32 poi_id) const
         {
+            if (!AreLocalesLoaded()) { return NULL; }
             PointOfInterestLocaleMap::const_iterator itr = mPointOfInterestLocaleMap.find(poi_id);
             if (itr == mPointOfInterestLocaleMap.end()) { return NULL; }
             return &itr->second;
@@ -903,6 +975,11 @@ class ObjectMgr
             return mMapObjectGuids[mapid][cell_id];
         }
 
+        CellObjectGuidsMap const& GetMapObjectGuids(uint16 mapid)
+        {
+            return mMapObjectGuids[mapid];
+        }
+
         // modifiers for global grid objects state (static DB spawns, global spawn mods from gameevent system)
         // Don't must be used for modify instance specific spawn state modifications
         void AddCreatureToGrid(uint32 guid, CreatureData const* data);
@@ -988,11 +1065,11 @@ class ObjectMgr
         bool RemoveVendorItem(uint32 entry, uint32 item);
         bool IsVendorItemValid(bool isTemplate, char const* tableName, uint32 vendor_entry, uint32 item, uint32 maxcount, uint32 ptime, uint16 conditionId, Player* pl = NULL, std::set<uint32>* skip_vendors = NULL) const;
 
-        static void AddLocaleString(std::string const& s, LocaleConstant locale, StringVector& data);
-        static inline void GetLocaleString(const StringVector& data, int loc_idx, std::string& value)
+        static void AddLocaleString(std::string const& s, LocaleConstant locale, LocaleStrings& data);
+        static inline void GetLocaleString(LocaleStrings const& data, int loc_idx, std::string& value)
         {
-            if (data.size() > size_t(loc_idx) && !data[loc_idx].empty())
-                value = data[loc_idx];
+            if (char const* str = data.Get(loc_idx))
+                { value = str; }
         }
 
         int GetOrNewIndexForLocale(LocaleConstant loc);
@@ -1058,6 +1135,11 @@ class ObjectMgr
         IdGenerator<uint32> m_GuildIds;
         IdGenerator<uint32> m_ItemTextIds;
         IdGenerator<uint32> m_MailIds;
+
+        /// mail ids by the hour of their expire time, a mail is returned or deleted after its hour passed
+        typedef std::map<uint32, std::vector<uint32> > MailExpiryQueue;
+        MailExpiryQueue m_mailExpiryQueue;
+        ACE_Thread_Mutex m_mailExpiryLock;
         IdGenerator<uint32> m_PetNumbers;
         IdGenerator<uint32> m_GroupIds;
 
@@ -1084,6 +1166,10 @@ class ObjectMgr
 
         GroupMap            mGroupMap;
 
+        typedef std::set<Group*> GroupSet;
+        GroupSet            m_groupStatsUpdates;
+        ACE_Thread_Mutex    m_groupStatsUpdateLock;
+
         ItemTextMap         mItemTexts;
 
         QuestAreaTriggerMap mQuestAreaTriggerMap;
@@ -1126,9 +1212,19 @@ class ObjectMgr
 
         int DBCLocaleIndex;
 
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_localesLoaded;  // set after the deferred *_locale tables are loaded
+        bool m_localesDeferred;                             // not loaded and not requested yet
+        ACE_Based::Thread* m_localesThread;
+
+        ACE_Based::Thread* m_honorMaintenanceThread;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_honorMaintenanceDone;  // set when the thread computed the lists below
+        HonorStandingList m_maintenanceAllyList;            // standings of the last week computed by the maintenance
+        HonorStandingList m_maintenanceHordeList;
+
     private:
         void LoadCreatureAddons(SQLStorage& creatureaddons, char const* entryName, char const* comment);
         void ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const* table, char const* guidEntryStr);
+        void CheckCreatureTemplate(CreatureInfo const* cInfo);
         void LoadQuestRelationsHelper(QuestRelationsMap& map, char const* table);
         void LoadVendors(char const* tableName, bool isTemplates);
         void LoadTrainers(char const* tableName, bool isTemplates);
@@ -1136,6 +1232,9 @@ class ObjectMgr
         void LoadGossipMenu(std::set<uint32>& gossipScriptSet);
         void LoadGossipMenuItems(std::set<uint32>& gossipScriptSet);
 
+        /// returns or deletes the mails of the result, returns the count of deleted mails
+        uint32 ReturnOrDeleteMails(QueryResult* result, bool serverUp, time_t basetime, BarGoLink* bar);
+
         typedef std::map<uint32, PetLevelInfo*> PetLevelInfoMap;
         // PetLevelInfoMap[creature_id][level]
         PetLevelInfoMap petInfo;                            // [creature_id][level]
@@ -0,0 +1,240 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "OpcodeStats.h"
+#include "World.h"
+#include "Opcodes.h"
+#include "Metrics.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Guard_T.h>
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(OpcodeStats);
+
+/// bounds of the exported opcode_handler_us buckets
+static uint32 const handlerTimeBounds[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000 };
+
+void OpcodeStatsCounters::Add(OpcodeStatsCounters const& other)
+{
+    for (int i = 0; i < MAX_OPCODE_STATS_PATH; ++i)
+    {
+        calls[i] += other.calls[i];
+        time[i] += other.time[i];
+    }
+
+    for (int i = 0; i < OPCODE_STATS_BUCKETS; ++i)
+        { buckets[i] += other.buckets[i]; }
+
+    bytes += other.bytes;
+    maxTime = std::max(maxTime, other.maxTime);
+}
+
+uint32 OpcodeStatsCounters::GetPercentile(uint32 percent) const
+{
+    uint64 total = GetCalls();
+    if (!total)
+        { return 0; }
+
+    uint64 needed = (total * percent + 99) / 100;
+    uint64 count = 0;
+    for (int i = 0; i < OPCODE_STATS_BUCKETS; ++i)
+    {
+        count += buckets[i];
+        if (count >= needed)
+            { return std::min(uint32(2) << i, maxTime); }
+    }
+
+    return maxTime;
+}
+
+OpcodeStats::OpcodeStats() : m_metrics(NUM_MSG_TYPES), m_resetTime(time(NULL))
+{
+}
+
+OpcodeStats::~OpcodeStats()
+{
+    for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        { delete *itr; }
+}
+
+bool OpcodeStats::IsEnabled() const
+{
+    return sWorld.getConfig(CONFIG_BOOL_OPCODESTATS_ENABLE);
+}
+
+OpcodeStats::Table& OpcodeStats::GetThreadTable()
+{
+    ThreadTable* current = m_threadTable;
+    if (!current->table)
+    {
+        Table* table = new Table;
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_tablesLock, *table);
+        m_tables.push_back(table);
+        current->table = table;
+    }
+
+    return *current->table;
+}
+
+OpcodeStats::OpcodeMetrics& OpcodeStats::GetMetrics(uint16 opcode)
+{
+    OpcodeMetrics& metrics = m_metrics[opcode];
+    if (metrics.time)
+        { return metrics; }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_metricsLock, metrics);
+    if (!metrics.time)
+    {
+        char const* name = LookupOpcodeName(opcode);
+        metrics.bytes = sMetrics.GetCounter("opcode_received_bytes", "Received packet bytes by opcode", "opcode", name);
+        metrics.time = sMetrics.GetHistogram("opcode_handler_us", "Packet handler time in microseconds by opcode",
+                                             handlerTimeBounds, countof(handlerTimeBounds), "opcode", name);
+    }
+
+    return metrics;
+}
+
+void OpcodeStats::AddCall(uint16 opcode, OpcodeStatsPath path, uint32 time, uint32 bytes)
+{
+    if (opcode >= NUM_MSG_TYPES)
+        { return; }
+
+    {
+        Table& table = GetThreadTable();
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, table.lock);
+        OpcodeStatsCounters& counters = table.opcodes[opcode];
+        ++counters.calls[path];
+        counters.time[path] += time;
+        counters.bytes += bytes;
+        counters.maxTime = std::max(counters.maxTime, time);
+
+        int bucket = 0;
+        while (bucket < OPCODE_STATS_BUCKETS - 1 && (uint32(2) << bucket) <= time)
+            { ++bucket; }
+        ++counters.buckets[bucket];
+    }
+
+    OpcodeMetrics& metrics = GetMetrics(opcode);
+    metrics.time->Add(time);
+    metrics.bytes->Add(long(bytes));
+}
+
+static bool OutlierLess(OpcodeStatsOutlier const& a, OpcodeStatsOutlier const& b)
+{
+    return a.handlerTime > b.handlerTime;
+}
+
+void OpcodeStats::AddOutlier(OpcodeStatsOutlier const& outlier)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_outliersLock);
+
+    // a session is listed once, with its most expensive second
+    for (OpcodeStatsOutliers::iterator itr = m_outliers.begin(); itr != m_outliers.end(); ++itr)
+    {
+        if (itr->accountId != outlier.accountId)
+            { continue; }
+
+        if (outlier.handlerTime > itr->handlerTime)
+            { *itr = outlier; }
+        return;
+    }
+
+    if (m_outliers.size() < OPCODE_STATS_MAX_OUTLIERS)
+        { m_outliers.push_back(outlier); }
+    else
+    {
+        // last in the order of OutlierLess, the least handler time
+        OpcodeStatsOutliers::iterator least = std::max_element(m_outliers.begin(), m_outliers.end(), OutlierLess);
+        if (least->handlerTime < outlier.handlerTime)
+            { *least = outlier; }
+    }
+}
+
+static bool RowLess(OpcodeStatsRow const& a, OpcodeStatsRow const& b)
+{
+    uint64 timeA = a.counters.GetTime();
+    uint64 timeB = b.counters.GetTime();
+    if (timeA != timeB)
+        { return timeA > timeB; }
+
+    return a.opcode < b.opcode;
+}
+
+void OpcodeStats::CollectRows(OpcodeStatsRows& rows, uint32 maxRows) const
+{
+    CountersMap merged;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, const_cast<ACE_Thread_Mutex&>(m_tablesLock));
+        for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, tableGuard, (*itr)->lock);
+            for (CountersMap::const_iterator opcode = (*itr)->opcodes.begin(); opcode != (*itr)->opcodes.end(); ++opcode)
+                { merged[opcode->first].Add(opcode->second); }
+        }
+    }
+
+    size_t begin = rows.size();
+    for (CountersMap::const_iterator itr = merged.begin(); itr != merged.end(); ++itr)
+        { rows.push_back(OpcodeStatsRow(itr->first, itr->second)); }
+
+    std::sort(rows.begin() + begin, rows.end(), RowLess);
+
+    if (maxRows && rows.size() - begin > maxRows)
+        { rows.resize(begin + maxRows, rows.front()); }
+}
+
+void OpcodeStats::CollectOutliers(OpcodeStatsOutliers& outliers) const
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_outliersLock);
+        outliers = m_outliers;
+    }
+
+    std::sort(outliers.begin(), outliers.end(), OutlierLess);
+}
+
+void OpcodeStats::Reset()
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_tablesLock);
+        for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, tableGuard, (*itr)->lock);
+            (*itr)->opcodes.clear();
+        }
+    }
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_outliersLock);
+        m_outliers.clear();
+    }
+
+    m_resetTime = time(NULL);
+}
@@ -0,0 +1,176 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_OPCODESTATS_H
+#define MANGOS_OPCODESTATS_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Utilities/UnorderedMapSet.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+
+#include <vector>
+
+class MetricHistogram;
+class MetricCounter;
+
+/// Where a packet handler ran, see WorldSession::Update
+enum OpcodeStatsPath
+{
+    OPCODE_STATS_WORLD      = 0,                            // WorldSessionFilter, World::UpdateSessions
+    OPCODE_STATS_MAP        = 1,                            // MapSessionFilter, Map::Update
+    MAX_OPCODE_STATS_PATH   = 2
+};
+
+#define OPCODE_STATS_BUCKETS        24                      // handler times in powers of two microseconds
+#define OPCODE_STATS_MAX_OUTLIERS   20
+
+/// Counters of one opcode
+struct OpcodeStatsCounters
+{
+    OpcodeStatsCounters() : bytes(0), maxTime(0)
+    {
+        memset(calls, 0, sizeof(calls));
+        memset(time, 0, sizeof(time));
+        memset(buckets, 0, sizeof(buckets));
+    }
+
+    void Add(OpcodeStatsCounters const& other);
+
+    uint64 GetCalls() const { return calls[OPCODE_STATS_WORLD] + calls[OPCODE_STATS_MAP]; }
+    uint64 GetTime() const { return time[OPCODE_STATS_WORLD] + time[OPCODE_STATS_MAP]; }
+    /// upper limit of the handler time of the percent of calls, in microseconds
+    uint32 GetPercentile(uint32 percent) const;
+
+    uint64 calls[MAX_OPCODE_STATS_PATH];
+    uint64 time[MAX_OPCODE_STATS_PATH];                     // in microseconds
+    uint64 bytes;                                           // received packet bodies
+    uint32 maxTime;
+    uint32 buckets[OPCODE_STATS_BUCKETS];                   // calls below 2, 4, 8, ... microseconds
+};
+
+/// One line of the statistics, see OpcodeStats::CollectRows
+struct OpcodeStatsRow
+{
+    OpcodeStatsRow(uint16 opcode_, OpcodeStatsCounters const& counters_) : opcode(opcode_), counters(counters_) {}
+
+    uint16 opcode;
+    OpcodeStatsCounters counters;
+};
+
+typedef std::vector<OpcodeStatsRow> OpcodeStatsRows;
+
+/// A second in which one session took more handler time than OpcodeStats.OutlierTime
+struct OpcodeStatsOutlier
+{
+    uint32 accountId;
+    std::string playerName;
+    std::string address;
+    time_t time;
+    uint32 handlerTime;                                     // in microseconds
+    uint32 calls;
+    uint16 costliestOpcode;                                 // of the longest call in the second
+    bool throttled;                                         // reached OpcodeStats.SessionBudget
+};
+
+typedef std::vector<OpcodeStatsOutlier> OpcodeStatsOutliers;
+
+/**
+ * Handler time, calls and received bytes per opcode, enabled by OpcodeStats.Enable.
+ *
+ * Every thread counts into an own table like SpellStats, the tables are merged for .debug opcodestats.
+ * The handler times also go to the metrics exporter, as opcode_handler_us histogram per opcode.
+ * The sessions account their handler time per second, see WorldSession::AccountHandlerTime, and the
+ * most expensive seconds are kept as outliers.
+ */
+class OpcodeStats
+{
+    public:
+        OpcodeStats();
+        ~OpcodeStats();
+
+        bool IsEnabled() const;
+
+        void AddCall(uint16 opcode, OpcodeStatsPath path, uint32 time, uint32 bytes);
+        void AddOutlier(OpcodeStatsOutlier const& outlier);
+
+        /// Opcodes sorted by time, at most maxRows if set
+        void CollectRows(OpcodeStatsRows& rows, uint32 maxRows = 0) const;
+        /// Outliers sorted by handler time
+        void CollectOutliers(OpcodeStatsOutliers& outliers) const;
+        void Reset();
+
+        /// Time of the last reset, for the call rates
+        time_t GetResetTime() const { return m_resetTime; }
+
+    private:
+        typedef UNORDERED_MAP<uint16, OpcodeStatsCounters> CountersMap;
+
+        struct Table
+        {
+            ACE_Thread_Mutex lock;                          // contended only while collecting or resetting
+            CountersMap opcodes;
+        };
+
+        typedef std::vector<Table*> Tables;
+
+        /// Table of the current thread, owned by m_tables
+        struct ThreadTable
+        {
+            ThreadTable() : table(NULL) {}
+
+            Table* table;
+        };
+
+        /// Exported metrics of an opcode, created at its first call
+        struct OpcodeMetrics
+        {
+            OpcodeMetrics() : time(NULL), bytes(NULL) {}
+
+            MetricHistogram* time;
+            MetricCounter* bytes;
+        };
+
+        Table& GetThreadTable();
+        OpcodeMetrics& GetMetrics(uint16 opcode);
+
+        ACE_TSS<ThreadTable> m_threadTable;
+        ACE_Thread_Mutex m_tablesLock;
+        Tables m_tables;                                    // of all threads which ever counted, kept after thread end
+
+        ACE_Thread_Mutex m_metricsLock;
+        std::vector<OpcodeMetrics> m_metrics;               // by opcode
+
+        mutable ACE_Thread_Mutex m_outliersLock;
+        OpcodeStatsOutliers m_outliers;                     // the OPCODE_STATS_MAX_OUTLIERS longest
+
+        time_t m_resetTime;
+};
+
+#define sOpcodeStats MaNGOS::Singleton<OpcodeStats>::Instance()
+
+#endif
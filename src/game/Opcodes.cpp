@@ -39,11 +39,15 @@ OpcodeHandler const Opcodes::emptyHandler =
     &WorldSession::Handle_NULL
 };
 
+ACE_Atomic_Op<ACE_Thread_Mutex, long> Opcodes::mReserveSize[NUM_MSG_TYPES];
+
 
 Opcodes::Opcodes()
 {
     /// Build Opcodes map
     BuildOpcodeList();
+    BuildSendPolicyList();
+    BuildRateLimitList();
 }
 
 Opcodes::~Opcodes()
@@ -966,3 +970,87 @@ void Opcodes::BuildOpcodeList()
 
     return;
 }
+
+/**
+ * Sets the send priority and congestion policy of outgoing opcodes, all others are \ref SEND_PRIORITY_NORMAL
+ * and \ref CONGESTION_KEEP. Only matters for clients that can't keep up and have packets queued in their
+ * \ref WorldSocket: urgent packets overtake the queue, bulk packets stay in order with the normal ones but only
+ * fill half of the send buffer at a time. Superseded movement is collapsed and cosmetic packets are dropped.
+ */
+void Opcodes::BuildSendPolicyList()
+{
+    for (uint16 i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        mSendPriority[i] = uint8(SEND_PRIORITY_NORMAL);
+        mCongestionPolicy[i] = uint8(CONGESTION_KEEP);
+    }
+
+    StoreSendPriority(SMSG_SPELL_START,                 SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_SPELL_GO,                    SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_SPELL_FAILURE,               SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_ATTACKSTART,                 SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_ATTACKSTOP,                  SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_ATTACKERSTATEUPDATE,         SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_SPELLNONMELEEDAMAGELOG,      SEND_PRIORITY_URGENT);
+    StoreSendPriority(SMSG_MONSTER_MOVE,                SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_HEARTBEAT,               SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_START_FORWARD,           SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_START_BACKWARD,          SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_STOP,                    SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_START_STRAFE_LEFT,       SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_START_STRAFE_RIGHT,      SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_STOP_STRAFE,             SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_JUMP,                    SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_START_TURN_LEFT,         SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_START_TURN_RIGHT,        SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_STOP_TURN,               SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_SET_FACING,              SEND_PRIORITY_URGENT);
+    StoreSendPriority(MSG_MOVE_FALL_LAND,               SEND_PRIORITY_URGENT);
+
+    StoreSendPriority(SMSG_UPDATE_OBJECT,               SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_COMPRESSED_UPDATE_OBJECT,    SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_AUCTION_LIST_RESULT,         SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_AUCTION_OWNER_LIST_RESULT,   SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_AUCTION_BIDDER_LIST_RESULT,  SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_MAIL_LIST_RESULT,            SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_WHO,                         SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_GUILD_ROSTER,                SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_ITEM_QUERY_SINGLE_RESPONSE,  SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_CREATURE_QUERY_RESPONSE,     SEND_PRIORITY_BULK);
+    StoreSendPriority(SMSG_GAMEOBJECT_QUERY_RESPONSE,   SEND_PRIORITY_BULK);
+
+    StoreCongestionPolicy(MSG_MOVE_HEARTBEAT,           CONGESTION_COLLAPSE);
+    StoreCongestionPolicy(SMSG_MONSTER_MOVE,            CONGESTION_COLLAPSE);
+
+    StoreCongestionPolicy(SMSG_EMOTE,                   CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_TEXT_EMOTE,              CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_PLAY_SPELL_VISUAL,       CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_ATTACKERSTATEUPDATE,     CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_SPELLNONMELEEDAMAGELOG,  CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_SPELLHEALLOG,            CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_SPELLENERGIZELOG,        CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_SPELLDAMAGESHIELD,       CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_SPELLLOGEXECUTE,         CONGESTION_DROP);
+    StoreCongestionPolicy(SMSG_PERIODICAURALOG,         CONGESTION_DROP);
+}
+
+/**
+ * Sets the token buckets and costs of the incoming opcodes clients can spam and that are expensive to
+ * answer, all others are not limited. The buckets are sized for what a client does on its own, like
+ * the name queries of a full raid at login, so mostly addons and abuse run into the limits.
+ */
+void Opcodes::BuildRateLimitList()
+{
+    for (uint16 i = 0; i < NUM_MSG_TYPES; ++i)
+        { mRateLimitIndex[i] = NO_RATE_LIMIT; }
+
+    //             opcode                           per minute  burst  cost  policy
+    StoreRateLimit(CMSG_WHO,                        20,         5,     20,   RATE_LIMIT_DELAY);
+    StoreRateLimit(CMSG_AUCTION_LIST_ITEMS,         120,        20,    10,   RATE_LIMIT_DELAY);
+    StoreRateLimit(CMSG_GUILD_ROSTER,               12,         3,     10,   RATE_LIMIT_DROP);
+    StoreRateLimit(CMSG_NAME_QUERY,                 600,        120,   1,    RATE_LIMIT_DELAY);
+    StoreRateLimit(CMSG_ITEM_QUERY_SINGLE,          600,        200,   1,    RATE_LIMIT_DELAY);
+    StoreRateLimit(CMSG_CREATURE_QUERY,             600,        200,   1,    RATE_LIMIT_DELAY);
+    StoreRateLimit(CMSG_GAMEOBJECT_QUERY,           600,        200,   1,    RATE_LIMIT_DELAY);
+    StoreRateLimit(CMSG_PAGE_TEXT_QUERY,            120,        20,    1,    RATE_LIMIT_DELAY);
+}
@@ -37,6 +37,9 @@
 //       table opcodeTable in source when Opcode.h included but WorldSession.h not included
 #include "WorldSession.h"
 
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
 /**
  * This is a list of Opcodes that are known for the client/server communication, it is used
  * to tell the server to do something or the client to do something. Every opcode is handled
@@ -987,6 +990,55 @@ enum PacketProcessing
     PROCESS_THREADSAFE     ///< packet is thread-safe - process it in \ref Map::Update
 };
 
+/**
+ * Order in which the queued outgoing packets of a socket are sent, see \ref WorldSocket::BufferPacket
+ * and \ref Opcodes::BuildSendPolicyList
+ */
+enum PacketSendPriority
+{
+    SEND_PRIORITY_URGENT = 0, ///< combat and movement, may overtake queued packets of the other priorities
+    SEND_PRIORITY_NORMAL,     ///< everything else, sent in order
+    SEND_PRIORITY_BULK,       ///< large lists and object updates, kept in order with normal packets but paced
+    MAX_SEND_PRIORITY
+};
+
+/**
+ * What happens to an outgoing packet for a client that can't keep up with its output,
+ * see \ref Opcodes::BuildSendPolicyList
+ */
+enum PacketCongestionPolicy
+{
+    CONGESTION_KEEP = 0,      ///< always sent
+    CONGESTION_DROP,          ///< only shows what others do, not sent while the socket is congested
+    CONGESTION_COLLAPSE       ///< a queued packet of the same opcode for the same leading guid is replaced by it
+};
+
+/**
+ * What happens to an incoming packet of a session over the rate limit or cost budget of its opcode,
+ * see \ref Opcodes::BuildRateLimitList
+ */
+enum PacketRateLimitPolicy
+{
+    RATE_LIMIT_DELAY = 0,     ///< stays queued with the packets after it until the session has tokens again
+    RATE_LIMIT_DROP,          ///< discarded, for requests the client repeats anyway
+    RATE_LIMIT_DISCONNECT,    ///< the session is kicked
+    MAX_RATE_LIMIT_POLICY
+};
+
+/// Token bucket and cost of an incoming opcode, kept per session by \ref WorldSession
+struct OpcodeRateLimit
+{
+    uint16 opcode;
+    uint16 perMinute;         ///< tokens refilled per minute
+    uint16 burst;             ///< tokens in a full bucket
+    uint16 cost;              ///< taken from the cost budget of the session, see RateLimit.CostBudget
+    PacketRateLimitPolicy policy;
+};
+
+#define NO_RATE_LIMIT 0xFF
+
+#define PACKET_RESERVE_MAX 0x4000                           // learned reserve sizes are not larger
+
 class WorldPacket;
 
 /**
@@ -1017,6 +1069,8 @@ class Opcodes
         ~Opcodes();
     public:
         void BuildOpcodeList();
+        void BuildSendPolicyList();
+        void BuildRateLimitList();
         void StoreOpcode(uint16 Opcode, char const* name, SessionStatus status, PacketProcessing process, void (WorldSession::*handler)(WorldPacket& recvPacket))
         {
             OpcodeHandler& ref = mOpcodeMap[Opcode];
@@ -1026,6 +1080,67 @@ class Opcodes
             ref.handler = handler;
         }
 
+        void StoreSendPriority(uint16 Opcode, PacketSendPriority priority)
+        {
+            mSendPriority[Opcode] = uint8(priority);
+        }
+
+        void StoreCongestionPolicy(uint16 Opcode, PacketCongestionPolicy policy)
+        {
+            mCongestionPolicy[Opcode] = uint8(policy);
+        }
+
+        void StoreRateLimit(uint16 Opcode, uint16 perMinute, uint16 burst, uint16 cost, PacketRateLimitPolicy policy)
+        {
+            OpcodeRateLimit limit = { Opcode, perMinute, burst, cost, policy };
+            mRateLimitIndex[Opcode] = uint8(mRateLimits.size());
+            mRateLimits.push_back(limit);
+        }
+
+        /// Send priority of an outgoing opcode, SEND_PRIORITY_NORMAL if not set
+        inline PacketSendPriority GetSendPriority(uint16 id) const
+        {
+            return id < NUM_MSG_TYPES ? PacketSendPriority(mSendPriority[id]) : SEND_PRIORITY_NORMAL;
+        }
+
+        /// Handling of an outgoing opcode for congested sockets, CONGESTION_KEEP if not set
+        inline PacketCongestionPolicy GetCongestionPolicy(uint16 id) const
+        {
+            return id < NUM_MSG_TYPES ? PacketCongestionPolicy(mCongestionPolicy[id]) : CONGESTION_KEEP;
+        }
+
+        /// Index of the rate limit of an incoming opcode in GetRateLimits, NO_RATE_LIMIT if it has none
+        inline uint8 GetRateLimitIndex(uint16 id) const
+        {
+            return id < NUM_MSG_TYPES ? mRateLimitIndex[id] : NO_RATE_LIMIT;
+        }
+
+        std::vector<OpcodeRateLimit> const& GetRateLimits() const { return mRateLimits; }
+
+        /// Size to reserve for a new packet of the opcode, the size its packets reached lately if the guess of the caller is smaller
+        static size_t GetReserveSize(uint16 id, size_t guess)
+        {
+            size_t learned = id < NUM_MSG_TYPES ? size_t(mReserveSize[id].value()) : 0;
+            return std::max(learned, guess);
+        }
+
+        /**
+         * Follows the size of a finished packet of the opcode: at once to a larger one, slowly to smaller ones.
+         * Packets are finished by all threads, a lost update between the read and the write only keeps the previous guess.
+         */
+        static void LearnPacketSize(uint16 id, size_t size)
+        {
+            if (id >= NUM_MSG_TYPES || !size)
+                { return; }
+
+            long reached = long(std::min(size, size_t(PACKET_RESERVE_MAX)));
+            long learned = mReserveSize[id].value();
+            if (reached > learned)
+                { mReserveSize[id] = reached; }
+            else if (learned - reached >= 16)
+                { mReserveSize[id] = learned - (learned - reached) / 16; }
+        }
+
         /// Lookup opcode
         inline OpcodeHandler const* LookupOpcode(uint16 id) const
         {
@@ -1048,6 +1163,12 @@ class Opcodes
         static OpcodeHandler const emptyHandler;
 
         OpcodeMap mOpcodeMap;
+        uint8 mSendPriority[NUM_MSG_TYPES];                 // PacketSendPriority, looked up for every sent packet
+        uint8 mCongestionPolicy[NUM_MSG_TYPES];             // PacketCongestionPolicy
+        uint8 mRateLimitIndex[NUM_MSG_TYPES];               // in mRateLimits, looked up for every received packet
+        std::vector<OpcodeRateLimit> mRateLimits;
+        // learned by LearnPacketSize, 0 before the first packet
+        static ACE_Atomic_Op<ACE_Thread_Mutex, long> mReserveSize[NUM_MSG_TYPES];
 };
 
 #define opcodeTable MaNGOS::Singleton<Opcodes>::Instance()
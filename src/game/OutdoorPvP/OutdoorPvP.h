@@ -167,12 +167,19 @@ class OutdoorPvP
         virtual bool HandleDropFlag(Player* /*player*/, uint32 /*spellId*/) { return false; }
 
         /**
-         * @brief update - called by the OutdoorPvPMgr
+         * @brief update - called by the OutdoorPvPMgr while players are in the zones of the script
          *
          * @param uint32
          */
         virtual void Update(uint32 /*diff*/) {}
 
+        /**
+         * @brief
+         *
+         * @return bool true if any player is in the main or affected zones
+         */
+        bool HasPlayers() const { return !m_zonePlayers.empty(); }
+
         /**
          * @brief Handle player kill
          *
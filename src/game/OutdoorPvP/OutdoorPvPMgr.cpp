@@ -128,8 +128,9 @@ void OutdoorPvPMgr::Update(uint32 diff)
     if (!m_updateTimer.Passed())
         { return; }
 
+    // zones without players have nothing to update, capture points stay idle as well
     for (uint8 i = 0; i < MAX_OPVP_ID; ++i)
-        if (m_scripts[i])
+        if (m_scripts[i] && m_scripts[i]->HasPlayers())
             { m_scripts[i]->Update(m_updateTimer.GetCurrent()); }
 
     m_updateTimer.Reset();
@@ -0,0 +1,245 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "PacketLog.h"
+#include "WorldPacket.h"
+#include "SharedDefines.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Util.h"
+#include "Config/Config.h"
+
+#include <ace/OS_NS_stdio.h>
+#include <ace/OS_NS_unistd.h>
+
+INSTANTIATE_SINGLETON_1(PacketLog);
+
+#define PKT_VERSION             0x0301                      // PKT 3.1
+#define PKT_SNIFFER_ID          'M'
+#define PKT_HEADER_SIZE         66
+
+PacketLog::PacketLog() :
+    m_enabled(false), m_file(NULL), m_fileSize(0), m_maxSize(0), m_maxFiles(0), m_startTicks(0)
+{
+}
+
+PacketLog::~PacketLog()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_fileLock);
+
+    m_enabled = false;
+    if (m_file)
+        { CloseFile(); }
+}
+
+template<class Set>
+static void ParseIdList(std::string const& list, Set& result)
+{
+    Tokens tokens = StrSplit(list, " ,");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+        { result.insert(uint32(strtoul(itr->c_str(), NULL, 0))); }
+}
+
+void PacketLog::LoadConfig()
+{
+    IdSet accounts;
+    IdSet opcodes;
+    AddressSet addresses;
+
+    ParseIdList(sConfig.GetStringDefault("WorldLogAccounts", ""), accounts);
+    ParseIdList(sConfig.GetStringDefault("WorldLogOpcodes", ""), opcodes);
+
+    Tokens tokens = StrSplit(sConfig.GetStringDefault("WorldLogAddresses", ""), " ,");
+    addresses.insert(tokens.begin(), tokens.end());
+
+    {
+        ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_filterLock);
+
+        m_accounts.swap(accounts);
+        m_opcodes.swap(opcodes);
+        m_addresses.swap(addresses);
+    }
+
+    std::string configName = sConfig.GetStringDefault("WorldLogFile", "");
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_fileLock);
+
+    int maxSize = sConfig.GetIntDefault("WorldLogMaxSize", 0);
+    int maxFiles = sConfig.GetIntDefault("WorldLogMaxFiles", 4);
+    m_maxSize = maxSize > 0 ? uint64(maxSize) * 1024 * 1024 : 0;
+    m_maxFiles = maxFiles > 0 ? uint32(maxFiles) : 0;
+
+    // a reload keeps capturing into the same file
+    if (m_file && configName == m_configName)
+        { return; }
+
+    m_enabled = false;
+    if (m_file)
+        { CloseFile(); }
+
+    m_configName = configName;
+    if (configName.empty())
+        { return; }
+
+    if (sConfig.GetBoolDefault("WorldLogTimestamp", false))
+    {
+        size_t dot_pos = configName.find_last_of(".");
+        if (dot_pos != configName.npos)
+            { configName.insert(dot_pos, "_" + Log::GetTimestampStr()); }
+        else
+            { configName += "_" + Log::GetTimestampStr(); }
+    }
+
+    m_fileName = sLog.GetLogsDir() + configName;
+    OpenFile();
+
+    m_enabled = m_file != NULL;
+}
+
+bool PacketLog::IsFiltered(uint32 account, std::string const& address, uint32 opcode) const
+{
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_filterLock, true);
+
+    if (!m_accounts.empty() && m_accounts.find(account) == m_accounts.end())
+        { return true; }
+
+    if (!m_opcodes.empty() && m_opcodes.find(opcode) == m_opcodes.end())
+        { return true; }
+
+    if (!m_addresses.empty() && m_addresses.find(address) == m_addresses.end())
+        { return true; }
+
+    return false;
+}
+
+void PacketLog::LogPacket(uint32 socket, uint32 account, std::string const& address, WorldPacket const& packet, bool incoming)
+{
+    if (!m_enabled)
+        { return; }
+
+    uint32 opcode = packet.GetOpcode();
+    if (IsFiltered(account, address, opcode))
+        { return; }
+
+    // built outside of the lock, only queueing it to the log writer is serialized
+    ByteBuffer record(24 + packet.size());
+    record.append(incoming ? "CMSG" : "SMSG", 4);
+    record << uint32(socket);                               // connection id
+    record << uint32(WorldTimer::getMSTime());              // tick count
+    record << uint32(0);                                    // optional data length
+    record << uint32(packet.size() + 4);                    // data length with the opcode
+    record << uint32(opcode);
+    if (packet.size())
+        { record.append(packet.contents(), packet.size()); }
+
+    std::string data(reinterpret_cast<char const*>(record.contents()), record.size());
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_fileLock);
+
+    if (!m_file)
+        { return; }
+
+    if (m_maxSize && m_fileSize > PKT_HEADER_SIZE && m_fileSize + data.size() > m_maxSize)
+    {
+        Rotate();
+        if (!m_file)
+            { return; }
+    }
+
+    sLog.GetWriter().Write(m_file, data);
+    m_fileSize += data.size();
+}
+
+std::string PacketLog::GetRotatedName(uint32 index) const
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), ".%u", index);
+    return m_fileName + buf;
+}
+
+void PacketLog::OpenFile()
+{
+    // a capture of an earlier run can't be continued, it is rotated like a full one
+    if (ACE_OS::access(m_fileName.c_str(), F_OK) == 0)
+    {
+        for (uint32 i = m_maxFiles; i > 0; --i)
+        {
+            if (i == m_maxFiles)
+                { ACE_OS::unlink(GetRotatedName(i).c_str()); }
+            else
+                { ACE_OS::rename(GetRotatedName(i).c_str(), GetRotatedName(i + 1).c_str()); }
+        }
+
+        if (m_maxFiles)
+            { ACE_OS::rename(m_fileName.c_str(), GetRotatedName(1).c_str()); }
+        else
+            { ACE_OS::unlink(m_fileName.c_str()); }
+    }
+
+    m_file = ACE_OS::fopen(m_fileName.c_str(), "wb");
+    if (!m_file)
+    {
+        sLog.outError("WorldLogFile %s can't be created, packets are not captured", m_fileName.c_str());
+        return;
+    }
+
+    static uint32 const builds[] = EXPECTED_MANGOSD_CLIENT_BUILD;
+    m_startTicks = WorldTimer::getMSTime();
+
+    ByteBuffer header(PKT_HEADER_SIZE);
+    header.append("PKT", 3);
+    header << uint16(PKT_VERSION);
+    header << uint8(PKT_SNIFFER_ID);
+    header << uint32(builds[0]);                            // client build
+    header.append("enUS", 4);                               // client locale
+    for (int i = 0; i < 40; ++i)
+        { header << uint8(0); }                             // session key, the capture is not encrypted
+    header << uint32(time(NULL));                           // start time
+    header << uint32(m_startTicks);                         // tick count at the start time
+    header << uint32(0);                                    // optional data length
+
+    // nothing is queued for the new file yet
+    fwrite(header.contents(), 1, header.size(), m_file);
+    fflush(m_file);
+    m_fileSize = header.size();
+}
+
+void PacketLog::CloseFile()
+{
+    sLog.GetWriter().Flush();
+
+    fclose(m_file);
+    m_file = NULL;
+    m_fileSize = 0;
+}
+
+void PacketLog::Rotate()
+{
+    CloseFile();
+    OpenFile();
+
+    if (!m_file)
+        { m_enabled = false; }
+}
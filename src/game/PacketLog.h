@@ -0,0 +1,105 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_PACKETLOG_H
+#define MANGOS_PACKETLOG_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/RW_Thread_Mutex.h>
+
+#include <cstdio>
+#include <set>
+
+class WorldPacket;
+
+/**
+ * Binary capture of the world packets in the PKT 3.1 format read by the common packet parsers.
+ *
+ * WorldSocket hands every received and sent packet to LogPacket, which skips it unless WorldLogFile is set
+ * and the account, opcode and remote address pass the WorldLogAccounts, WorldLogOpcodes and WorldLogAddresses
+ * filters. The records are written through the log writer (see LogAsync), a file reaching WorldLogMaxSize is
+ * renamed to <name>.1 (older ones to .2 and so on, up to WorldLogMaxFiles) and a new one is started.
+ * The filters are updated by .reload config, so the capture of a suspect account can be set up live.
+ */
+class PacketLog
+{
+    public:
+        PacketLog();
+        ~PacketLog();
+
+        bool IsEnabled() const { return m_enabled; }
+
+        /// Read the file and filter settings, at startup and config reload
+        void LoadConfig();
+
+        /**
+         * @brief captures a packet if it passes the filters
+         *
+         * @param socket connection id of the record
+         * @param account 0 before the authentication
+         * @param address remote address of the socket
+         * @param packet
+         * @param incoming sent by the client
+         */
+        void LogPacket(uint32 socket, uint32 account, std::string const& address, WorldPacket const& packet, bool incoming);
+
+    private:
+        typedef std::set<uint32> IdSet;
+        typedef std::set<std::string> AddressSet;
+
+        bool IsFiltered(uint32 account, std::string const& address, uint32 opcode) const;
+
+        /// Open m_fileName, write the file header, m_fileLock held
+        void OpenFile();
+        /// Write the queued records and close the file, m_fileLock held
+        void CloseFile();
+        /// Name of the index-th older file
+        std::string GetRotatedName(uint32 index) const;
+        /// Shift the closed files and start a new one, m_fileLock held
+        void Rotate();
+
+        volatile bool m_enabled;
+
+        mutable ACE_RW_Thread_Mutex m_filterLock;
+        IdSet m_accounts;                                   // empty for all
+        IdSet m_opcodes;
+        AddressSet m_addresses;
+
+        ACE_Thread_Mutex m_fileLock;
+        FILE* m_file;
+        std::string m_configName;                           // WorldLogFile of the open file
+        std::string m_fileName;                             // with logs dir and timestamp
+        uint64 m_fileSize;
+        uint64 m_maxSize;                                   // bytes, 0 for no limit
+        uint32 m_maxFiles;
+        uint32 m_startTicks;                                // ms time of the file header
+};
+
+#define sPacketLog MaNGOS::Singleton<PacketLog>::Instance()
+
+#endif
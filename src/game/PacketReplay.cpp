@@ -0,0 +1,388 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "PacketReplay.h"
+#include "World.h"
+#include "WorldSession.h"
+#include "WorldPacket.h"
+#include "WorldPacketPool.h"
+#include "Opcodes.h"
+#include "ObjectGuid.h"
+#include "Player.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Util.h"
+#include "Config/Config.h"
+#include "Database/DatabaseEnv.h"
+
+#include <ace/OS_NS_stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+INSTANTIATE_SINGLETON_1(PacketReplay);
+
+#define PKT_VERSION             0x0301                      // PKT 3.1, as written by PacketLog
+#define PKT_HEADER_SIZE         66
+#define REPLAY_LOGIN_TIMEOUT    (MINUTE * IN_MILLISECONDS)  // a bot whose character is not in the world then is finished
+
+PacketReplay::PacketReplay() :
+    m_active(false), m_startInterval(0), m_shutdown(false), m_startTime(0), m_startedBots(0), m_finishedBots(0),
+    m_queuedPackets(0), m_sentPackets(0), m_sentBytes(0)
+{
+}
+
+void PacketReplay::Initialize()
+{
+    m_fileName = sConfig.GetStringDefault("Replay.File", "");
+    if (m_fileName.empty())
+        { return; }
+
+    if (!LoadCapture(m_fileName))
+        { return; }
+
+    if (m_scripts.empty())
+    {
+        sLog.outError("Replay.File %s has no connection logging in a character, nothing is replayed", m_fileName.c_str());
+        return;
+    }
+
+    std::vector<uint32> characters;
+    Tokens tokens = StrSplit(sConfig.GetStringDefault("Replay.Characters", ""), " ,");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        if (uint32 guid = uint32(atoi(itr->c_str())))
+            { characters.push_back(guid); }
+    }
+
+    // without a list every script logs in its captured character
+    if (characters.empty())
+    {
+        for (std::vector<ReplayScript>::const_iterator itr = m_scripts.begin(); itr != m_scripts.end(); ++itr)
+            { characters.push_back(itr->characterGuid); }
+    }
+
+    std::set<uint32> accounts;
+    for (std::vector<uint32>::const_iterator itr = characters.begin(); itr != characters.end(); ++itr)
+    {
+        QueryResult* result = CharacterDatabase.PQuery("SELECT account FROM characters WHERE guid = '%u'", *itr);
+        if (!result)
+        {
+            sLog.outError("Replay.Characters: character %u does not exist, skipped", *itr);
+            continue;
+        }
+
+        uint32 accountId = result->Fetch()[0].GetUInt32();
+        delete result;
+
+        // one session per account, a second bot would replace the first one
+        if (!accounts.insert(accountId).second)
+        {
+            sLog.outError("Replay.Characters: character %u is of account %u of another bot, skipped", *itr, accountId);
+            continue;
+        }
+
+        ReplayBot bot;
+        bot.script = uint32(m_bots.size() % m_scripts.size());
+        bot.accountId = accountId;
+        bot.characterGuid = *itr;
+        m_bots.push_back(bot);
+    }
+
+    if (m_bots.empty())
+    {
+        sLog.outError("Replay.File %s has no bot to play it, nothing is replayed", m_fileName.c_str());
+        return;
+    }
+
+    m_startInterval = sConfig.GetIntDefault("Replay.Interval", 100);
+    m_shutdown = sConfig.GetBoolDefault("Replay.Shutdown", true);
+    m_active = true;
+
+    sLog.outString("Replaying %u connections of %s with %u bots", uint32(m_scripts.size()), m_fileName.c_str(), uint32(m_bots.size()));
+}
+
+bool PacketReplay::LoadCapture(std::string const& fileName)
+{
+    FILE* file = ACE_OS::fopen(fileName.c_str(), "rb");
+    if (!file)
+    {
+        sLog.outError("Replay.File %s can't be opened, nothing is replayed", fileName.c_str());
+        return false;
+    }
+
+    ByteBuffer data;
+    uint8 buf[64 * 1024];
+    while (size_t count = fread(buf, 1, sizeof(buf), file))
+        { data.append(buf, count); }
+    fclose(file);
+
+    std::vector<ReplayScript> scripts;
+    std::map<uint32, size_t> connections;                   // connection id to its current script
+    std::vector<uint32> firstTicks;
+
+    try
+    {
+        char magic[3];
+        data.read(reinterpret_cast<uint8*>(magic), sizeof(magic));
+        if (data.size() < PKT_HEADER_SIZE || memcmp(magic, "PKT", 3) != 0 || data.read<uint16>() != PKT_VERSION)
+        {
+            sLog.outError("Replay.File %s is no PKT 3.1 capture, nothing is replayed", fileName.c_str());
+            return false;
+        }
+
+        data.rpos(PKT_HEADER_SIZE - 4);
+        data.read_skip(data.read<uint32>());                // optional header data
+
+        while (data.rpos() < data.size())
+        {
+            char direction[4];
+            data.read(reinterpret_cast<uint8*>(direction), sizeof(direction));
+            uint32 connection = data.read<uint32>();
+            uint32 ticks = data.read<uint32>();
+            data.read_skip(data.read<uint32>());            // optional record data
+            uint32 length = data.read<uint32>();
+            if (length < 4)
+                { throw ByteBufferException(false, data.rpos(), length, data.size()); }
+
+            uint32 opcode = data.read<uint32>();
+            length -= 4;
+
+            if (memcmp(direction, "CMSG", 4) != 0)
+            {
+                data.read_skip(length);
+                continue;
+            }
+
+            // socket handles are reused, every authentication starts a new connection
+            std::map<uint32, size_t>::iterator itr = connections.find(connection);
+            if (opcode == CMSG_AUTH_SESSION || itr == connections.end())
+            {
+                connections[connection] = scripts.size();
+                scripts.push_back(ReplayScript());
+                scripts.back().connection = connection;
+                firstTicks.push_back(ticks);
+                itr = connections.find(connection);
+            }
+
+            // handled by the socket, never reaching a session
+            if (opcode == CMSG_AUTH_SESSION || opcode == CMSG_PING || opcode == CMSG_KEEP_ALIVE || opcode >= NUM_MSG_TYPES)
+            {
+                data.read_skip(length);
+                continue;
+            }
+
+            ReplayScript& script = scripts[itr->second];
+            script.packets.push_back(ReplayPacket());
+            ReplayPacket& packet = script.packets.back();
+            packet.time = WorldTimer::getMSTimeDiff(firstTicks[itr->second], ticks);
+            packet.opcode = uint16(opcode);
+            if (length)
+            {
+                packet.data.assign(reinterpret_cast<char const*>(data.contents() + data.rpos()), length);
+                data.read_skip(length);
+            }
+
+            if (opcode == CMSG_PLAYER_LOGIN && !script.characterGuid && length >= 8)
+            {
+                uint64 guid;
+                memcpy(&guid, packet.data.data(), sizeof(guid));
+                EndianConvert(guid);
+                script.characterGuid = ObjectGuid(guid).GetCounter();
+            }
+        }
+    }
+    catch (ByteBufferException&)
+    {
+        sLog.outError("Replay.File %s is truncated, the last record is skipped", fileName.c_str());
+    }
+
+    for (std::vector<ReplayScript>::const_iterator itr = scripts.begin(); itr != scripts.end(); ++itr)
+    {
+        if (itr->characterGuid)
+            { m_scripts.push_back(*itr); }
+    }
+
+    return true;
+}
+
+void PacketReplay::Update()
+{
+    if (!m_active)
+        { return; }
+
+    uint32 now = WorldTimer::getMSTime();
+
+    if (!m_startedBots)
+    {
+        m_startTime = now;
+        m_stageTimes.resize(WUPDATE_STAGE_COUNT);
+        for (int i = 0; i < WUPDATE_STAGE_COUNT; ++i)
+            { m_stageTimes[i] = sWorld.GetUpdateStageStats(WorldUpdateStage(i)).totalTime; }
+    }
+    else
+        { m_tickTimes.push_back(sWorld.GetLastTickTime()); }
+
+    // fed before starting, a session added now is in the world only after this update
+    for (std::vector<ReplayBot>::iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+    {
+        if (itr->started && !itr->finished && !FeedBot(*itr, now))
+        {
+            itr->finished = true;
+            ++m_finishedBots;
+        }
+    }
+
+    while (m_startedBots < m_bots.size() && WorldTimer::getMSTimeDiff(m_startTime, now) >= m_startedBots * m_startInterval)
+    {
+        ReplayBot& bot = m_bots[m_startedBots++];
+        bot.startTime = now;
+        StartBot(bot);
+    }
+
+    if (m_finishedBots < m_bots.size())
+        { return; }
+
+    WriteReport();
+    m_active = false;
+
+    if (m_shutdown)
+        { World::StopNow(SHUTDOWN_EXIT_CODE); }
+}
+
+void PacketReplay::StartBot(ReplayBot& bot)
+{
+    WorldSession* session = new WorldSession(bot.accountId, NULL, SEC_PLAYER, 0, LOCALE_enUS);
+    session->SetReplayed();
+
+    sWorld.AddSession(session);
+    bot.started = true;
+}
+
+bool PacketReplay::FeedBot(ReplayBot& bot, uint32 now)
+{
+    // not added, kicked or replaced by a login of the account
+    WorldSession* session = sWorld.FindSession(bot.accountId);
+    if (!session || !session->IsReplayed())
+        { return false; }
+
+    ReplayScript const& script = m_scripts[bot.script];
+
+    // the last packets were handled in the update after queueing them
+    if (bot.next >= script.packets.size())
+    {
+        session->KickPlayer();
+        return false;
+    }
+
+    if (bot.waitLogin)
+    {
+        Player* player = session->GetPlayer();
+        if (!player || !player->IsInWorld())
+        {
+            if (WorldTimer::getMSTimeDiff(bot.waitStart, now) < REPLAY_LOGIN_TIMEOUT)
+                { return true; }
+
+            sLog.outError("Replay: character %u of bot account %u is not in the world in time, bot finished", bot.characterGuid, bot.accountId);
+            session->KickPlayer();
+            return false;
+        }
+
+        // the script continues as if the login took as long as in the capture
+        bot.startTime += WorldTimer::getMSTimeDiff(bot.waitStart, now);
+        bot.waitLogin = false;
+    }
+
+    uint32 elapsed = WorldTimer::getMSTimeDiff(bot.startTime, now);
+    while (bot.next < script.packets.size() && script.packets[bot.next].time <= elapsed)
+    {
+        ReplayPacket const& replayed = script.packets[bot.next++];
+
+        WorldPacket* packet = sWorldPacketPool.Acquire(replayed.opcode, replayed.data.size());
+        if (!replayed.data.empty())
+            { packet->append(replayed.data.data(), replayed.data.size()); }
+
+        if (replayed.opcode == CMSG_PLAYER_LOGIN && packet->size() >= 8)
+        {
+            packet->put<uint64>(0, ObjectGuid(HIGHGUID_PLAYER, bot.characterGuid).GetRawValue());
+            bot.waitLogin = true;
+            bot.waitStart = now;
+        }
+
+        session->QueuePacket(packet);
+        ++m_queuedPackets;
+
+        if (bot.waitLogin)
+            { break; }
+    }
+
+    return true;
+}
+
+void PacketReplay::CountSentPacket(WorldPacket const& packet)
+{
+    ++m_sentPackets;
+    m_sentBytes += long(packet.size() + 4);                 // with the server header
+}
+
+/// Value at the percent of the sorted times
+static uint32 GetPercentile(std::vector<uint32> const& times, uint32 percent)
+{
+    return times[std::min(times.size() - 1, times.size() * percent / 100)];
+}
+
+void PacketReplay::WriteReport()
+{
+    uint32 duration = WorldTimer::getMSTimeDiff(m_startTime, WorldTimer::getMSTime());
+    uint32 ticks = uint32(m_tickTimes.size());
+
+    sLog.outString("Replay of %s with %u bots finished after %u s and %u world updates", m_fileName.c_str(),
+                   uint32(m_bots.size()), duration / IN_MILLISECONDS, ticks);
+
+    if (ticks)
+    {
+        std::vector<uint32> times = m_tickTimes;
+        std::sort(times.begin(), times.end());
+
+        uint64 total = 0;
+        for (std::vector<uint32>::const_iterator itr = times.begin(); itr != times.end(); ++itr)
+            { total += *itr; }
+
+        sLog.outString("  world update: avg %.1f ms, median %u ms, 95%% %u ms, 99%% %u ms, max %u ms", double(total) / ticks,
+                       GetPercentile(times, 50), GetPercentile(times, 95), GetPercentile(times, 99), times.back());
+
+        for (int i = 0; i < WUPDATE_STAGE_COUNT; ++i)
+        {
+            WorldUpdateStageStats const& stats = sWorld.GetUpdateStageStats(WorldUpdateStage(i));
+            sLog.outString("  %-20s avg %.2f ms", World::GetUpdateStageName(WorldUpdateStage(i)),
+                           double(stats.totalTime - m_stageTimes[i]) / ticks);
+        }
+    }
+
+    long sentPackets = m_sentPackets.value();
+    long sentBytes = m_sentBytes.value();
+    sLog.outString("  " UI64FMTD " packets received, %ld packets and %ld bytes sent, %.0f bytes/s per bot", m_queuedPackets,
+                   sentPackets, sentBytes, duration ? double(sentBytes) * IN_MILLISECONDS / duration / m_bots.size() : 0.0);
+}
@@ -0,0 +1,126 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_PACKETREPLAY_H
+#define MANGOS_PACKETREPLAY_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
+#include <vector>
+
+class WorldPacket;
+
+/// Received packet of a captured connection
+struct ReplayPacket
+{
+    uint32 time;                                            // ms after the first packet of the connection
+    uint16 opcode;
+    std::string data;
+};
+
+/// Received packets of one captured connection that logged in a character
+struct ReplayScript
+{
+    ReplayScript() : connection(0), characterGuid(0) {}
+
+    uint32 connection;
+    uint32 characterGuid;                                   // logged in by the capture
+    std::vector<ReplayPacket> packets;
+};
+
+/// Session playing a script, identified by the account so a session deleted by the world is not used
+struct ReplayBot
+{
+    ReplayBot() : script(0), accountId(0), characterGuid(0), startTime(0), waitStart(0), next(0), started(false), finished(false), waitLogin(false) {}
+
+    uint32 script;
+    uint32 accountId;
+    uint32 characterGuid;
+    uint32 startTime;                                       // ms time the script time is counted from
+    uint32 waitStart;                                       // ms time the login started
+    size_t next;                                            // next packet of the script
+    bool started;                                           // session created
+    bool finished;
+    bool waitLogin;                                         // holds the script until the character is in the world
+};
+
+/**
+ * Headless load replay: sessions without a socket play the received packets of a PKT capture (see WorldLogFile)
+ * against the loaded world, as a benchmark of the server without clients.
+ *
+ * Every captured connection that logged in a character becomes a script. Replay.Characters lists the characters
+ * the bots log in, bot i plays script i modulo the script count with its own character, the packets are queued
+ * into the session as the network thread would at the captured times. The socket handled packets like the
+ * authentication and pings are skipped, packets of a bot whose login is still loading wait for it.
+ * When the last bot finished, the tick times, the world update stage costs and the sent packets and bytes
+ * are written to the server log, with Replay.Shutdown the server stops then.
+ */
+class PacketReplay
+{
+    public:
+        PacketReplay();
+
+        bool IsActive() const { return m_active; }
+
+        /// Read Replay.File and the bots at the end of the world initialization
+        void Initialize();
+
+        /// Start and feed the bots, at the start of every world update
+        void Update();
+
+        /// Count a packet sent to a replayed session, from any thread
+        void CountSentPacket(WorldPacket const& packet);
+
+    private:
+        bool LoadCapture(std::string const& fileName);
+        void StartBot(ReplayBot& bot);
+        /// Queue the due packets, false if the script has ended
+        bool FeedBot(ReplayBot& bot, uint32 now);
+        void WriteReport();
+
+        bool m_active;
+        std::string m_fileName;
+        std::vector<ReplayScript> m_scripts;
+        std::vector<ReplayBot> m_bots;
+        uint32 m_startInterval;                             // ms between the bot starts
+        bool m_shutdown;
+
+        uint32 m_startTime;
+        uint32 m_startedBots;
+        uint32 m_finishedBots;
+        uint64 m_queuedPackets;
+        std::vector<uint32> m_tickTimes;
+        std::vector<uint64> m_stageTimes;                   // total times of the world update stages at the start
+
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_sentPackets;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_sentBytes;
+};
+
+#define sPacketReplay MaNGOS::Singleton<PacketReplay>::Instance()
+
+#endif
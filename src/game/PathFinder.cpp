@@ -28,33 +28,177 @@
 #include "GridMap.h"
 #include "Creature.h"
 #include "PathFinder.h"
+#include "PathFinderQueue.h"
+#include "MapManager.h"
+#include "Map.h"
 #include "Log.h"
+#include "Util.h"
+
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+
+#include <algorithm>
+
+#define POOLED_PATH_POLY_BUFFERS 32
+
+/// Free corridor buffers of one thread
+struct PathPolyBufferPool
+{
+    ~PathPolyBufferPool()
+    {
+        for (std::vector<dtPolyRef*>::iterator itr = buffers.begin(); itr != buffers.end(); ++itr)
+            { delete[] *itr; }
+    }
+
+    std::vector<dtPolyRef*> buffers;
+};
+
+typedef ACE_TSS<PathPolyBufferPool> PathPolyBufferPoolTSS;
+static PathPolyBufferPoolTSS pathPolyBufferPool;
+
+static dtPolyRef* AcquirePathPolyBuffer()
+{
+    PathPolyBufferPool* pool = pathPolyBufferPool;          // created at the first use of the thread
+    if (pool->buffers.empty())
+        { return new dtPolyRef[MAX_PATH_LENGTH]; }
+
+    dtPolyRef* refs = pool->buffers.back();
+    pool->buffers.pop_back();
+    return refs;
+}
+
+////////////////// PathPolyBuffer //////////////////
+PathPolyBuffer::PathPolyBuffer() : m_refs(AcquirePathPolyBuffer())
+{
+}
+
+PathPolyBuffer::PathPolyBuffer(PathPolyBuffer const& other) : m_refs(AcquirePathPolyBuffer())
+{
+    memcpy(m_refs, other.m_refs, MAX_PATH_LENGTH * sizeof(dtPolyRef));
+}
+
+PathPolyBuffer::~PathPolyBuffer()
+{
+    // requests are released by the pathfinding threads, their pools only keep a few
+    PathPolyBufferPool* pool = pathPolyBufferPool;
+    if (pool->buffers.size() < POOLED_PATH_POLY_BUFFERS)
+        { pool->buffers.push_back(m_refs); }
+    else
+        { delete[] m_refs; }
+}
 
 ////////////////// PathFinder //////////////////
 PathFinder::PathFinder(const Unit* owner) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH),
-    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshQuery(NULL)
+    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshQuery(NULL),
+    m_mapId(owner->GetMapId()), m_sourceLowGuid(owner->GetGUIDLow()),
+    m_sourceIsCreature(false), m_sourceCanSwim(false), m_sourceCanFly(false),
+    m_request(NULL), m_requestState(REQUEST_NONE)
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceLowGuid);
 
-    uint32 mapId = m_sourceUnit->GetMapId();
-    if (MMAP::MMapFactory::IsPathfindingEnabled(mapId))
-    {
-        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        m_navMesh = mmap->GetNavMesh(mapId);
-        m_navMeshQuery = mmap->GetNavMeshQuery(mapId, m_sourceUnit->GetInstanceId());
-    }
+    m_underWater[0] = m_underWater[1] = -1;
 
     createFilter();
 }
 
 PathFinder::~PathFinder()
 {
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceUnit->GetGUIDLow());
+    // a request is a copy without own request, its owner may be gone already
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::~PathInfo() for %u \n", m_sourceLowGuid);
+
+    cancelRequest();
 }
 
 bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest)
+{
+    // the pending result would overwrite this one
+    cancelRequest();
+
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, mmap->GetLock(), false);
+
+    attachNavMeshQuery();
+    if (prepareCalculation(destX, destY, destZ, forceDest))
+        { BuildPolyPath(m_startPosition, m_endPosition); }
+
+    return true;
+}
+
+bool PathFinder::calculateAsync(float destX, float destY, float destZ, bool forceDest)
+{
+    PathFinderQueue& queue = sMapMgr.GetPathFinderQueue();
+    if (!queue.IsActive())
+        { return calculate(destX, destY, destZ, forceDest); }
+
+    // a newer destination replaces the pending one
+    cancelRequest();
+
+    {
+        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+        ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, mmap->GetLock(), false);
+
+        attachNavMeshQuery();
+        if (!prepareCalculation(destX, destY, destZ, forceDest))
+            { return true; }                                // shortcut, nothing to queue
+    }
+
+    // the pathfinding threads don't access the terrain
+    if (m_sourceIsCreature)
+    {
+        isUnderWater(0);
+        isUnderWater(1);
+    }
+
+    m_request = new PathFinder(*this);
+    m_request->m_request = NULL;
+    queue.Schedule(m_request);
+    return false;
+}
+
+bool PathFinder::updateRequest()
+{
+    if (!m_request || !sMapMgr.GetPathFinderQueue().Take(m_request))
+        { return false; }
+
+    takeResult(*m_request);
+
+    delete m_request;
+    m_request = NULL;
+    return true;
+}
+
+void PathFinder::cancelRequest()
+{
+    if (!m_request)
+        { return; }
+
+    sMapMgr.GetPathFinderQueue().Cancel(m_request);
+    m_request = NULL;
+}
+
+void PathFinder::takeResult(PathFinder const& request)
+{
+    m_polyLength = request.m_polyLength;
+    memcpy(m_pathPolyRefs, request.m_pathPolyRefs, m_polyLength * sizeof(dtPolyRef));
+
+    m_pathPoints = request.m_pathPoints;
+    m_type = request.m_type;
+    m_actualEndPosition = request.m_actualEndPosition;
+}
+
+void PathFinder::attachNavMeshQuery()
+{
+    // the unit may be updated by another thread each time, so the query of the thread is taken anew
+    m_navMesh = NULL;
+    m_navMeshQuery = NULL;
+
+    if (MMAP::MMapFactory::IsPathfindingEnabled(m_mapId))
+        { m_navMeshQuery = MMAP::MMapFactory::createOrGetMMapManager()->GetThreadNavMeshQuery(m_mapId, m_navMesh); }
+}
+
+bool PathFinder::prepareCalculation(float destX, float destY, float destZ, bool forceDest)
 {
     // Vector3 oldDest = getEndPosition();
     Vector3 dest(destX, destY, destZ);
@@ -67,7 +211,7 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
     m_forceDestination = forceDest;
 
-    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
+    DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceLowGuid);
 
     // make sure navMesh works - we can run on map w/o mmap
     // check if the start and end point have a .mmtile loaded (can we pass via not loaded tile on the way?)
@@ -76,15 +220,130 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
     {
         BuildShortcut();
         m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
-        return true;
+        return false;
     }
 
     updateFilter();
 
-    BuildPolyPath(start, dest);
+    m_sourceIsCreature = m_sourceUnit->GetTypeId() == TYPEID_UNIT;
+    m_sourceCanSwim = m_sourceIsCreature && ((Creature*)m_sourceUnit)->CanSwim();
+    m_sourceCanFly = m_sourceIsCreature && ((Creature*)m_sourceUnit)->CanFly();
+    m_underWater[0] = m_underWater[1] = -1;
     return true;
 }
 
+void PathFinder::findWanderPoints(float x, float y, float z, float radius, WanderArea& area)
+{
+    area.points.clear();
+    area.open = false;
+
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, guard, mmap->GetLock());
+
+    attachNavMeshQuery();
+    if (!m_navMesh || !m_navMeshQuery)
+        { return; }
+
+    float centerPoint[VERTEX_SIZE] = {y, z, x};
+    float distToPoly;
+    dtPolyRef centerPoly = getPolyByLocation(centerPoint, &distToPoly);
+    if (centerPoly == INVALID_POLYREF)
+        { return; }
+
+    // only polygons reachable from the center are wander destinations, not those of other floors or caves
+    dtPolyRef areaPolys[MAX_WANDER_AREA_POLYS];
+    int areaPolyCount = 0;
+    dtStatus status = m_navMeshQuery->findPolysAroundCircle(centerPoly, centerPoint, radius, &m_filter,
+                      areaPolys, NULL, NULL, &areaPolyCount, MAX_WANDER_AREA_POLYS);
+    if (dtStatusFailed(status) || !areaPolyCount)
+        { return; }
+
+    float points[MAX_WANDER_POINTS + 1][VERTEX_SIZE];
+    dtPolyRef pointPolys[MAX_WANDER_POINTS + 1];
+    dtVcopy(points[0], centerPoint);
+    pointPolys[0] = centerPoly;
+    uint32 pointCount = 1;
+
+    for (uint32 tries = 0; pointCount <= MAX_WANDER_POINTS && tries < 4 * MAX_WANDER_POINTS; ++tries)
+    {
+        float angle = rand_norm_f() * (M_PI_F * 2.0f);
+        float range = rand_norm_f() * radius;
+        float target[VERTEX_SIZE] = {y + range * sin(angle), z, x + range * cos(angle)};
+
+        dtPolyRef polyRef = getPolyByLocation(target, &distToPoly);
+        if (std::find(areaPolys, areaPolys + areaPolyCount, polyRef) == areaPolys + areaPolyCount)
+            { continue; }
+
+        float* point = points[pointCount];
+        if (dtStatusFailed(m_navMeshQuery->closestPointOnPoly(polyRef, target, point)))
+            { continue; }
+
+        float dy = point[0] - y;
+        float dx = point[2] - x;
+        if (dx * dx + dy * dy > radius * radius)
+            { continue; }
+
+        pointPolys[pointCount++] = polyRef;
+    }
+
+    // an area whose points all see each other is walked on straight lines
+    area.open = true;
+    dtPolyRef visited[MAX_WANDER_AREA_POLYS];
+    int visitedCount;
+    for (uint32 i = 0; i < pointCount && area.open; ++i)
+    {
+        for (uint32 j = i + 1; j < pointCount && area.open; ++j)
+        {
+            float hit;
+            float hitNormal[VERTEX_SIZE];
+            status = m_navMeshQuery->raycast(pointPolys[i], points[i], points[j], &m_filter, &hit, hitNormal, visited, &visitedCount, MAX_WANDER_AREA_POLYS);
+            if (dtStatusFailed(status) || hit <= 1.0f)
+                { area.open = false; }
+        }
+    }
+
+    for (uint32 i = 1; i < pointCount; ++i)
+    {
+        Position pos;
+        pos.x = points[i][2];
+        pos.y = points[i][0];
+        pos.z = points[i][1];
+        area.points.push_back(pos);
+    }
+
+    if (area.points.empty())
+        { area.open = false; }
+}
+
+void PathFinder::calculateRequest()
+{
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+    ACE_READ_GUARD(ACE_RW_Thread_Mutex, guard, mmap->GetLock());
+
+    // the nav mesh of the map thread may be unloaded since, use the current one
+    attachNavMeshQuery();
+
+    if (!m_navMeshQuery || !HaveTile(m_startPosition) || !HaveTile(m_endPosition))
+    {
+        BuildShortcut();
+        m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+        return;
+    }
+
+    BuildPolyPath(m_startPosition, m_endPosition);
+}
+
+bool PathFinder::isUnderWater(uint32 point)
+{
+    if (m_underWater[point] < 0)
+    {
+        Vector3 const& p = point ? m_endPosition : m_startPosition;
+        m_underWater[point] = m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z) ? 1 : 0;
+    }
+
+    return m_underWater[point] > 0;
+}
+
 dtPolyRef PathFinder::getPathPolyByPosition(const dtPolyRef* polyPath, uint32 polyPathSize, const float* point, float* distance) const
 {
     if (!polyPath || !polyPathSize)
@@ -171,14 +430,14 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPoly == 0 || endPoly == 0)\n");
         BuildShortcut();
 
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
             // Check for swimming or flying shortcut
-            if ((startPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(startPos.x, startPos.y, startPos.z)) ||
-                (endPoly == INVALID_POLYREF && m_sourceUnit->GetTerrain()->IsUnderWater(endPos.x, endPos.y, endPos.z)))
-                { m_type = ((Creature*)m_sourceUnit)->CanSwim() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH; }
+            if ((startPoly == INVALID_POLYREF && isUnderWater(0)) ||
+                (endPoly == INVALID_POLYREF && isUnderWater(1)))
+                { m_type = m_sourceCanSwim ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH; }
             else
-                { m_type = ((Creature*)m_sourceUnit)->CanFly() ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH; }
+                { m_type = m_sourceCanFly ? PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH) : PATHFIND_NOPATH; }
         }
         else
             { m_type = PATHFIND_NOPATH; }
@@ -193,21 +452,18 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: farFromPoly distToStartPoly=%.3f distToEndPoly=%.3f\n", distToStartPoly, distToEndPoly);
 
         bool buildShotrcut = false;
-        if (m_sourceUnit->GetTypeId() == TYPEID_UNIT)
+        if (m_sourceIsCreature)
         {
-            Creature* owner = (Creature*)m_sourceUnit;
-
-            Vector3 p = (distToStartPoly > 7.0f) ? startPos : endPos;
-            if (m_sourceUnit->GetTerrain()->IsUnderWater(p.x, p.y, p.z))
+            if (isUnderWater(distToStartPoly > 7.0f ? 0 : 1))
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: underWater case\n");
-                if (owner->CanSwim())
+                if (m_sourceCanSwim)
                     { buildShotrcut = true; }
             }
             else
             {
                 DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: flying case\n");
-                if (owner->CanFly())
+                if (m_sourceCanFly)
                     { buildShotrcut = true; }
             }
         }
@@ -261,7 +517,9 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         for (pathStartIndex = 0; pathStartIndex < m_polyLength; ++pathStartIndex)
         {
             // here to catch few bugs
-            MANGOS_ASSERT(m_pathPolyRefs[pathStartIndex] != INVALID_POLYREF || m_sourceUnit->PrintEntryError("PathFinder::BuildPolyPath"));
+            if (m_pathPolyRefs[pathStartIndex] == INVALID_POLYREF)
+                { sLog.outError("PathFinder::BuildPolyPath: invalid poly in the path of %u", m_sourceLowGuid); }
+            MANGOS_ASSERT(m_pathPolyRefs[pathStartIndex] != INVALID_POLYREF);
 
             if (m_pathPolyRefs[pathStartIndex] == startPoly)
             {
@@ -278,6 +536,11 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
             }
     }
 
+    // corridors of other units between the same polys, e.g. a group chasing the same target
+    MMAP::PathCache* pathCache = MMAP::MMapFactory::createOrGetMMapManager()->GetPathCache(m_mapId);
+    uint32 filterFlags = uint32(m_filter.getIncludeFlags()) << 16 | m_filter.getExcludeFlags();
+    bool searched = false;
+
     if (startPolyFound && endPolyFound)
     {
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPolyFound && endPolyFound)\n");
@@ -289,6 +552,10 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         m_polyLength = pathEndIndex - pathStartIndex + 1;
         memmove(m_pathPolyRefs, m_pathPolyRefs + pathStartIndex, m_polyLength * sizeof(dtPolyRef));
     }
+    else if (pathCache && pathCache->Find(startPoly, endPoly, filterFlags, m_pathPolyRefs, m_polyLength, MAX_PATH_LENGTH))
+    {
+        DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: corridor taken from the path cache\n");
+    }
     else if (startPolyFound && !endPolyFound)
     {
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ BuildPolyPath :: (startPolyFound && !endPolyFound)\n");
@@ -329,14 +596,13 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
 
         // generate suffix
         uint32 suffixPolyLength = 0;
-        dtStatus dtResult = m_navMeshQuery->findPath(
+        dtStatus dtResult = findPolyPath(
                                 suffixStartPoly,    // start polygon
                                 endPoly,            // end polygon
                                 suffixEndPoint,     // start position
                                 endPoint,           // end position
-                                &m_filter,            // polygon search filter
                                 m_pathPolyRefs + prefixPolyLength - 1,    // [out] path
-                                (int*)&suffixPolyLength,
+                                &suffixPolyLength,
                                 MAX_PATH_LENGTH - prefixPolyLength); // max number of polygons in output path
 
         if (!suffixPolyLength || dtStatusFailed(dtResult))
@@ -344,13 +610,14 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
             // this is probably an error state, but we'll leave it
             // and hopefully recover on the next Update
             // we still need to copy our preffix
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_sourceLowGuid);
         }
 
         DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++  m_polyLength=%u prefixPolyLength=%u suffixPolyLength=%u \n", m_polyLength, prefixPolyLength, suffixPolyLength);
 
         // new path = prefix + suffix - overlap
         m_polyLength = prefixPolyLength + suffixPolyLength - 1;
+        searched = true;
     }
     else
     {
@@ -363,26 +630,31 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
         // free and invalidate old path data
         clear();
 
-        dtStatus dtResult = m_navMeshQuery->findPath(
+        dtStatus dtResult = findPolyPath(
                                 startPoly,          // start polygon
                                 endPoly,            // end polygon
                                 startPoint,         // start position
                                 endPoint,           // end position
-                                &m_filter,           // polygon search filter
                                 m_pathPolyRefs,     // [out] path
-                                (int*)&m_polyLength,
+                                &m_polyLength,
                                 MAX_PATH_LENGTH);   // max number of polygons in output path
 
         if (!m_polyLength || dtStatusFailed(dtResult))
         {
             // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outError("%u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+            sLog.outError("%u's Path Build failed: 0 length path", m_sourceLowGuid);
             BuildShortcut();
             m_type = PATHFIND_NOPATH;
             return;
         }
+
+        searched = true;
     }
 
+    // only complete corridors, an incomplete one is searched again when the unit moved on
+    if (searched && pathCache && m_polyLength && m_pathPolyRefs[m_polyLength - 1] == endPoly)
+        { pathCache->Store(startPoly, endPoly, filterFlags, m_pathPolyRefs, m_polyLength); }
+
     // by now we know what type of path we can get
     if (m_pathPolyRefs[m_polyLength - 1] == endPoly && !(m_type & PATHFIND_INCOMPLETE))
         { m_type = PATHFIND_NORMAL; }
@@ -393,6 +665,22 @@ void PathFinder::BuildPolyPath(const Vector3& startPos, const Vector3& endPos)
     BuildPointPath(startPoint, endPoint);
 }
 
+dtStatus PathFinder::findPolyPath(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint,
+                                  dtPolyRef* path, uint32* pathSize, uint32 maxPathSize)
+{
+    // a sliced search stops after the iteration budget with the corridor to the node closest to the end,
+    // the unit walks it as incomplete path and the suffix search of the next calculation extends it
+    // the query state is started and finished here, so the query stays usable by other path finders
+    dtNavMeshQuery* query = const_cast<dtNavMeshQuery*>(m_navMeshQuery);
+
+    dtStatus status = query->initSlicedFindPath(startPoly, endPoly, startPoint, endPoint, &m_filter);
+    if (dtStatusInProgress(status))
+        { query->updateSlicedFindPath(MAX_PATH_SEARCH_ITERATIONS); }
+
+    // fails with an empty path if the search failed
+    return query->finalizeSlicedFindPath(path, (int*)pathSize, maxPathSize);
+}
+
 void PathFinder::BuildPointPath(const float* startPoint, const float* endPoint)
 {
     float pathPoints[MAX_POINT_PATH_LENGTH * VERTEX_SIZE];
@@ -35,13 +35,23 @@ using Movement::Vector3;
 using Movement::PointsArray;
 
 class Unit;
+class PathFinderQueue;
+struct WanderArea;
 
 // 74*4.0f=296y  number_of_points*interval = max_path_len
 // this is way more than actual evade range
 // I think we can safely cut those down even more
-#define MAX_PATH_LENGTH         74
 #define MAX_POINT_PATH_LENGTH   74
 
+// polygons of a corridor, long ones used to end as incomplete paths searched again and again
+#define MAX_PATH_LENGTH         256
+// nodes the A* may expand in one calculation, a longer search ends with the best partial corridor
+#define MAX_PATH_SEARCH_ITERATIONS  512
+
+// wander destinations of a spawn and the polygons searched around it for them
+#define MAX_WANDER_POINTS       8
+#define MAX_WANDER_AREA_POLYS   128
+
 #define SMOOTH_PATH_STEP_SIZE   4.0f
 #define SMOOTH_PATH_SLOP        0.3f
 
@@ -58,8 +68,27 @@ enum PathType
     PATHFIND_NOT_USING_PATH = 0x0010    // used when we are either flying/swiming or on map w/o mmaps
 };
 
+// corridor storage of a PathFinder, taken from a pool of the thread so paths don't allocate
+class PathPolyBuffer
+{
+    public:
+        PathPolyBuffer();
+        PathPolyBuffer(PathPolyBuffer const& other);
+        ~PathPolyBuffer();
+
+        operator dtPolyRef*() { return m_refs; }
+        operator dtPolyRef const*() const { return m_refs; }
+
+    private:
+        PathPolyBuffer& operator=(PathPolyBuffer const&);
+
+        dtPolyRef* m_refs;                                  // MAX_PATH_LENGTH polys
+};
+
 class PathFinder
 {
+    friend class PathFinderQueue;
+
     public:
         PathFinder(Unit const* owner);
         ~PathFinder();
@@ -68,6 +97,16 @@ class PathFinder
         // return: true if new path was calculated, false otherwise (no change needed)
         bool calculate(float destX, float destY, float destZ, bool forceDest = false);
 
+        // Same as calculate, but on the pathfinding threads when they are running
+        // return: true if the path is calculated already, else updateRequest returns true when it is
+        bool calculateAsync(float destX, float destY, float destZ, bool forceDest = false);
+        // Take the result of calculateAsync, true if the path was updated
+        bool updateRequest();
+        bool isPending() const { return m_request != NULL; }
+
+        // Find random points on the nav mesh connected to the center within radius, none without nav mesh
+        void findWanderPoints(float x, float y, float z, float radius, WanderArea& area);
+
         // option setters - use optional
         void setUseStrightPath(bool useStraightPath) { m_useStraightPath = useStraightPath; };
         void setPathLengthLimit(float distance) { m_pointPathLimit = std::min<uint32>(uint32(distance / SMOOTH_PATH_STEP_SIZE), MAX_POINT_PATH_LENGTH); };
@@ -82,7 +121,16 @@ class PathFinder
 
     private:
 
-        dtPolyRef      m_pathPolyRefs[MAX_PATH_LENGTH];   // array of detour polygon references
+        enum RequestState
+        {
+            REQUEST_NONE,
+            REQUEST_QUEUED,
+            REQUEST_RUNNING,
+            REQUEST_DONE,
+            REQUEST_CANCELLED
+        };
+
+        PathPolyBuffer m_pathPolyRefs;                    // array of detour polygon references
         uint32         m_polyLength;                      // number of polygons in the path
 
         PointsArray    m_pathPoints;       // our actual (x,y,z) path to the target
@@ -102,6 +150,17 @@ class PathFinder
 
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
+        // owner data read by BuildPolyPath, cached for the pathfinding threads
+        uint32          m_mapId;
+        uint32          m_sourceLowGuid;
+        bool            m_sourceIsCreature;
+        bool            m_sourceCanSwim;
+        bool            m_sourceCanFly;
+        int8            m_underWater[2];    // start and end point, -1 if not checked yet
+
+        PathFinder*     m_request;          // copy calculated by the PathFinderQueue
+        RequestState    m_requestState;     // state of this as a request, guarded by the queue
+
         void setStartPosition(Vector3 point) { m_startPosition = point; }
         void setEndPosition(Vector3 point) { m_actualEndPosition = point; m_endPosition = point; }
         void setActualEndPosition(Vector3 point) { m_actualEndPosition = point; }
@@ -123,6 +182,16 @@ class PathFinder
         void BuildPolyPath(const Vector3& startPos, const Vector3& endPos);
         void BuildPointPath(const float* startPoint, const float* endPoint);
         void BuildShortcut();
+        dtStatus findPolyPath(dtPolyRef startPoly, dtPolyRef endPoly, const float* startPoint, const float* endPoint,
+                              dtPolyRef* path, uint32* pathSize, uint32 maxPathSize);
+
+        bool prepareCalculation(float destX, float destY, float destZ, bool forceDest);
+        void calculateRequest();
+        // take the nav mesh query of the calling thread, the caller holds the read lock of the MMapManager
+        void attachNavMeshQuery();
+        void takeResult(PathFinder const& request);
+        void cancelRequest();
+        bool isUnderWater(uint32 point);
 
         NavTerrain getNavTerrain(float x, float y, float z);
         void createFilter();
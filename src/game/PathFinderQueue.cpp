@@ -0,0 +1,171 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "PathFinderQueue.h"
+#include "PathFinder.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+
+#include <algorithm>
+
+PathFinderQueue::PathFinderQueue() :
+    m_queueCondition(m_lock),
+    m_threadCount(0),
+    m_stopping(false)
+{
+}
+
+PathFinderQueue::~PathFinderQueue()
+{
+    Deactivate();
+}
+
+int PathFinderQueue::Activate(uint32 numThreads)
+{
+    if (IsActive() || numThreads == 0)
+        { return 0; }
+
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, int(numThreads)) == -1)
+    {
+        sLog.outError("PathFinderQueue: can't start %u pathfinding threads, paths will be calculated by the map threads", numThreads);
+        return -1;
+    }
+
+    m_threadCount = numThreads;
+    return 0;
+}
+
+void PathFinderQueue::Deactivate()
+{
+    if (!IsActive())
+        { return; }
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stopping = true;
+        m_queueCondition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+    m_threadCount = 0;
+
+    // the owners still wait for these, let them go straight
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (RequestQueue::const_iterator itr = m_queue.begin(); itr != m_queue.end(); ++itr)
+    {
+        if ((*itr)->m_requestState == PathFinder::REQUEST_CANCELLED)
+            { delete *itr; }
+        else
+        {
+            (*itr)->BuildShortcut();
+            (*itr)->m_type = PathType(PATHFIND_NORMAL | PATHFIND_NOT_USING_PATH);
+            (*itr)->m_requestState = PathFinder::REQUEST_DONE;
+        }
+    }
+
+    m_queue.clear();
+}
+
+void PathFinderQueue::Schedule(PathFinder* request)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    request->m_requestState = PathFinder::REQUEST_QUEUED;
+    m_queue.push_back(request);
+    m_queueCondition.signal();
+}
+
+bool PathFinderQueue::Take(PathFinder* request)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+    return request->m_requestState == PathFinder::REQUEST_DONE;
+}
+
+void PathFinderQueue::Cancel(PathFinder* request)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    switch (request->m_requestState)
+    {
+        case PathFinder::REQUEST_QUEUED:
+        {
+            RequestQueue::iterator itr = std::find(m_queue.begin(), m_queue.end(), request);
+            if (itr != m_queue.end())
+                { m_queue.erase(itr); }
+            delete request;
+            break;
+        }
+        case PathFinder::REQUEST_RUNNING:
+            request->m_requestState = PathFinder::REQUEST_CANCELLED; // deleted by its thread
+            break;
+        default:
+            delete request;
+            break;
+    }
+}
+
+uint32 PathFinderQueue::GetQueueSize() const
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+    return m_queue.size();
+}
+
+int PathFinderQueue::svc()
+{
+    for (;;)
+    {
+        PathFinder* request;
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            while (m_queue.empty() && !m_stopping)
+                { m_queueCondition.wait(); }
+
+            if (m_stopping)
+                { break; }
+
+            request = m_queue.front();
+            m_queue.pop_front();
+            request->m_requestState = PathFinder::REQUEST_RUNNING;
+        }
+
+        request->calculateRequest();
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            if (request->m_requestState == PathFinder::REQUEST_CANCELLED)
+                { delete request; }
+            else
+                { request->m_requestState = PathFinder::REQUEST_DONE; }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_PATHFINDERQUEUE_H
+#define MANGOS_PATHFINDERQUEUE_H
+
+#include "Common.h"
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+class PathFinder;
+
+/**
+ * Threads calculating the paths of PathFinder::calculateAsync.
+ *
+ * A request is a copy of the PathFinder taken on the map thread with everything needed from its
+ * owner, so the threads never touch units or terrain. Each thread uses an own dtNavMeshQuery and
+ * holds the mmap lock for reading meanwhile, so tiles are not changed below it. The PathFinder
+ * takes the result in its next update, or cancels the request when it is replaced or destroyed.
+ */
+class PathFinderQueue : protected ACE_Task_Base
+{
+    public:
+        PathFinderQueue();
+        virtual ~PathFinderQueue();
+
+        /// Start numThreads pathfinding threads, no-op for 0 (paths are calculated by the map threads then)
+        int Activate(uint32 numThreads);
+        /// Stop and join all threads, queued requests are finished with a shortcut path
+        void Deactivate();
+        bool IsActive() const { return m_threadCount > 0; }
+
+        /// Queue the calculation, the queue owns the request until Take or Cancel
+        void Schedule(PathFinder* request);
+        /// true if the request is calculated, it is owned by the caller again then
+        bool Take(PathFinder* request);
+        /// The result is not needed anymore, the request is deleted now or when its calculation ends
+        void Cancel(PathFinder* request);
+
+        uint32 GetQueueSize() const;
+
+    protected:
+        int svc() override;
+
+    private:
+        typedef std::deque<PathFinder*> RequestQueue;
+
+        mutable ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_queueCondition;        // signaled when requests are queued or at stop
+
+        RequestQueue m_queue;
+        uint32 m_threadCount;
+        bool m_stopping;
+};
+
+#endif
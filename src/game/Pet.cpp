@@ -82,7 +82,7 @@ void Pet::AddToWorld()
 {
     ///- Register the pet for guid lookup
     if (!IsInWorld())
-        { GetMap()->GetObjectsStore().insert<Pet>(GetObjectGuid(), (Pet*)this); }
+        { GetMap()->InsertObject<Pet>(GetObjectGuid(), (Pet*)this); }
 
     Unit::AddToWorld();
 }
@@ -91,7 +91,7 @@ void Pet::RemoveFromWorld()
 {
     ///- Remove the pet from the accessor
     if (IsInWorld())
-        { GetMap()->GetObjectsStore().erase<Pet>(GetObjectGuid(), (Pet*)NULL); }
+        { GetMap()->EraseObject<Pet>(GetObjectGuid(), (Pet*)NULL); }
 
     ///- Don't call the function for Creature, normal mobs + totems go in a different storage
     Unit::RemoveFromWorld();
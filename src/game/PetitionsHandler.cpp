@@ -175,7 +175,6 @@ void WorldSession::HandlePetitionShowSignOpcode(WorldPacket& recv_data)
     DEBUG_LOG("Received opcode CMSG_PETITION_SHOW_SIGNATURES");
     // recv_data.hexlike();
 
-    uint8 signs = 0;
     ObjectGuid petitionguid;
     recv_data >> petitionguid;                              // petition guid
 
@@ -186,18 +185,32 @@ void WorldSession::HandlePetitionShowSignOpcode(WorldPacket& recv_data)
     if (_player->GetGuildId())
         { return; }
 
-    QueryResult* result = CharacterDatabase.PQuery("SELECT playerguid FROM petition_sign WHERE petitionguid = '%u'", petitionguid_low);
+    DEBUG_LOG("CMSG_PETITION_SHOW_SIGNATURES petition: %s", petitionguid.GetString().c_str());
+
+    CharacterDatabase.AsyncPQuery(&WorldSession::HandlePetitionShowSignOpcodeCallBack, GetAccountId(), petitionguid.GetRawValue(),
+                                  "SELECT playerguid FROM petition_sign WHERE petitionguid = '%u'", petitionguid_low);
+}
+
+void WorldSession::HandlePetitionShowSignOpcodeCallBack(QueryResult* result, uint32 accountId, uint64 petitionguid)
+{
+    WorldSession* session = sWorld.FindSession(accountId);
+    Player* player = session ? session->GetPlayer() : NULL;
+    if (!player)
+    {
+        delete result;
+        return;
+    }
+
+    uint8 signs = 0;
 
     // result==NULL also correct in case no sign yet
     if (result)
         { signs = (uint8)result->GetRowCount(); }
 
-    DEBUG_LOG("CMSG_PETITION_SHOW_SIGNATURES petition: %s", petitionguid.GetString().c_str());
-
     WorldPacket data(SMSG_PETITION_SHOW_SIGNATURES, (8 + 8 + 4 + 1 + signs * 12));
     data << ObjectGuid(petitionguid);                       // petition guid
-    data << _player->GetObjectGuid();                       // owner guid
-    data << uint32(petitionguid_low);                       // guild guid (in mangos always same as GUID_LOPART(petitionguid)
+    data << player->GetObjectGuid();                        // owner guid
+    data << uint32(ObjectGuid(petitionguid).GetCounter());  // guild guid (in mangos always same as GUID_LOPART(petitionguid)
     data << uint8(signs);                                   // sign's count
 
     for (uint8 i = 1; i <= signs; ++i)
@@ -211,7 +224,7 @@ void WorldSession::HandlePetitionShowSignOpcode(WorldPacket& recv_data)
         result->NextRow();
     }
     delete result;
-    SendPacket(&data);
+    session->SendPacket(&data);
 }
 
 void WorldSession::HandlePetitionQueryOpcode(WorldPacket& recv_data)
@@ -232,29 +245,30 @@ void WorldSession::SendPetitionQueryOpcode(ObjectGuid petitionguid)
 {
     uint32 petitionLowGuid = petitionguid.GetCounter();
 
-    ObjectGuid ownerGuid;
-    std::string name = "NO_NAME_FOR_GUID";
-    uint8 signs = 0;
-
-    QueryResult* result = CharacterDatabase.PQuery(
-                              "SELECT ownerguid, name, "
-                              "  (SELECT COUNT(playerguid) FROM petition_sign WHERE petition_sign.petitionguid = '%u') AS signs "
-                              "FROM petition WHERE petitionguid = '%u'", petitionLowGuid, petitionLowGuid);
+    CharacterDatabase.AsyncPQuery(&WorldSession::SendPetitionQueryOpcodeCallBack, GetAccountId(), petitionLowGuid,
+                                  "SELECT ownerguid, name FROM petition WHERE petitionguid = '%u'", petitionLowGuid);
+}
 
-    if (result)
+void WorldSession::SendPetitionQueryOpcodeCallBack(QueryResult* result, uint32 accountId, uint32 petitionLowGuid)
+{
+    if (!result)
     {
-        Field* fields = result->Fetch();
-        ownerGuid = ObjectGuid(HIGHGUID_PLAYER, fields[0].GetUInt32());
-        name      = fields[1].GetCppString();
-        signs     = fields[2].GetUInt8();
-        delete result;
+        DEBUG_LOG("CMSG_PETITION_QUERY failed for petition (GUID: %u)", petitionLowGuid);
+        return;
     }
-    else
+
+    WorldSession* session = sWorld.FindSession(accountId);
+    if (!session)
     {
-        DEBUG_LOG("CMSG_PETITION_QUERY failed for petition (GUID: %u)", petitionLowGuid);
+        delete result;
         return;
     }
 
+    Field* fields = result->Fetch();
+    ObjectGuid ownerGuid = ObjectGuid(HIGHGUID_PLAYER, fields[0].GetUInt32());
+    std::string name = fields[1].GetCppString();
+    delete result;
+
     WorldPacket data(SMSG_PETITION_QUERY_RESPONSE, (4 + 8 + name.size() + 1 + 2 + 4 * 11));
     data << uint32(petitionLowGuid);                        // guild/team guid (in mangos always same as GUID_LOPART(petition guid)
     data << ObjectGuid(ownerGuid);                          // charter owner guid
@@ -272,7 +286,7 @@ void WorldSession::SendPetitionQueryOpcode(ObjectGuid petitionguid)
     data << uint32(0);                                      // 11
     data << uint32(0);                                      // 13 count of next strings?
     data << uint32(0);                                      // 14
-    SendPacket(&data);
+    session->SendPacket(&data);
 }
 
 void WorldSession::HandlePetitionRenameOpcode(WorldPacket& recv_data)
@@ -45,6 +45,7 @@
 #include "CellImpl.h"
 #include "ObjectMgr.h"
 #include "ObjectAccessor.h"
+#include "WhoListMgr.h"
 #include "CreatureAI.h"
 #include "Formulas.h"
 #include "Group.h"
@@ -60,6 +61,7 @@
 #include "OutdoorPvP/OutdoorPvP.h"
 #include "Chat.h"
 #include "Database/DatabaseImpl.h"
+#include "Database/SqlBatch.h"
 #include "Spell.h"
 #include "ScriptMgr.h"
 #include "SocialMgr.h"
@@ -67,6 +69,8 @@
 #include "DBCStores.h"
 #include "SQLStorages.h"
 #include "LuaEngine.h"
+#include "Profiler.h"
+#include "PlayerNameCache.h"
 
 #include <cmath>
 
@@ -128,6 +132,10 @@ enum CharacterFlags
 
 static const uint32 corpseReclaimDelay[MAX_DEATH_COUNT] = {30, 60, 120};
 
+#define QUEST_GIVER_STATUS_GO_FLAG 0x80000000               // game object entries in the quest giver status cache
+
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_questGiverStatusGeneration;
+
 //== PlayerTaxi ================================================
 
 PlayerTaxi::PlayerTaxi()
@@ -388,6 +396,8 @@ Player::Player(WorldSession* session): Unit(), m_mover(this), m_camera(this), m_
 
     m_comboPoints = 0;
 
+    m_questGiverStatusGeneration = 0;
+
     m_usedTalentCount = 0;
 
     m_modManaRegen = 0;
@@ -398,16 +408,15 @@ Player::Player(WorldSession* session): Unit(), m_mover(this), m_camera(this), m_
     m_weaponChangeTimer = 0;
 
     m_zoneUpdateId = 0;
-    m_zoneUpdateTimer = 0;
     m_positionStatusUpdateTimer = 0;
 
     m_areaUpdateId = 0;
 
-    m_nextSave = sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE);
+    uint32 saveInterval = sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE);
 
     // randomize first save time in range [CONFIG_UINT32_INTERVAL_SAVE] around [CONFIG_UINT32_INTERVAL_SAVE]
     // this must help in case next save after mass player load after server startup
-    m_nextSave = urand(m_nextSave / 2, m_nextSave * 3 / 2);
+    m_updateTimers.Schedule(PLAYER_TIMER_SAVE, urand(saveInterval / 2, saveInterval * 3 / 2));
 
     clearResurrectRequestData();
 
@@ -462,8 +471,9 @@ Player::Player(WorldSession* session): Unit(), m_mover(this), m_camera(this), m_
     m_deathExpireTime = 0;
 
     m_swingErrorMsg = 0;
+    m_pendingDerivedStats = 0;
 
-    m_DetectInvTimer = 1 * IN_MILLISECONDS;
+    m_updateTimers.Schedule(PLAYER_TIMER_DETECT_STEALTH, 1 * IN_MILLISECONDS);
 
     for (int j = 0; j < PLAYER_MAX_BATTLEGROUND_QUEUES; ++j)
     {
@@ -490,8 +500,11 @@ Player::Player(WorldSession* session): Unit(), m_mover(this), m_camera(this), m_
     //////////////////// Rest System/////////////////////
 
     m_mailsUpdated = false;
+    m_spellCooldownsChanged = true;                         // first save writes the cooldowns set at loading
     unReadMails = 0;
     m_nextMailDelivereTime = 0;
+    m_mailedItemsLoaded = false;
+    m_mailedItemsLoading = false;
 
     m_resetTalentsCost = 0;
     m_resetTalentsTime = 0;
@@ -1089,9 +1102,13 @@ void Player::SetDrunkValue(uint16 newDrunkenValue, uint32 itemId)
 
 void Player::Update(uint32 update_diff, uint32 p_time)
 {
+    PROFILE_SCOPE_ID("Player::Update", GetGUIDLow());
+
     if (!IsInWorld())
         { return; }
 
+    m_updateTimers.Advance(update_diff);
+
     // Undelivered mail
     if (m_nextMailDelivereTime && m_nextMailDelivereTime <= time(NULL))
     {
@@ -1102,6 +1119,9 @@ void Player::Update(uint32 update_diff, uint32 p_time)
         m_nextMailDelivereTime = 0;
     }
 
+    // stats changed since the last update, by auras applied from other units as well
+    UpdatePendingDerivedStats();
+
     // Used to implement delayed far teleports
     SetCanDelayTeleport(true);
     Unit::Update(update_diff, p_time);
@@ -1201,28 +1221,6 @@ void Player::Update(uint32 update_diff, uint32 p_time)
             { m_weaponChangeTimer -= update_diff; }
     }
 
-    if (m_zoneUpdateTimer > 0)
-    {
-        if (update_diff >= m_zoneUpdateTimer)
-        {
-            uint32 newzone, newarea;
-            GetZoneAndAreaId(newzone, newarea);
-
-            if (m_zoneUpdateId != newzone)
-                { UpdateZone(newzone, newarea); }               // Also update area
-            else
-            {
-                // Use area updates as well
-                if (m_areaUpdateId != newarea)
-                    { UpdateArea(newarea); }
-
-                m_zoneUpdateTimer = ZONE_UPDATE_INTERVAL;
-            }
-        }
-        else
-            { m_zoneUpdateTimer -= update_diff; }
-    }
-
     if (IsAlive())
     {
         RegenerateAll();
@@ -1231,35 +1229,13 @@ void Player::Update(uint32 update_diff, uint32 p_time)
     if (m_deathState == JUST_DIED)
         { KillPlayer(); }
 
-    if (m_nextSave > 0)
-    {
-        if (update_diff >= m_nextSave)
-        {
-            // m_nextSave reseted in SaveToDB call
-            // Used by Eluna
-            sEluna->OnSave(this);
-            SaveToDB();
-            DETAIL_LOG("Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
-        }
-        else
-            { m_nextSave -= update_diff; }
-    }
+    // zone check, auto save and stealth detection
+    if (m_updateTimers.HasDue())
+        { UpdateDueTimers(); }
 
     // Handle Water/drowning
     HandleDrowning(update_diff);
 
-    // Handle detect stealth players
-    if (m_DetectInvTimer > 0)
-    {
-        if (update_diff >= m_DetectInvTimer)
-        {
-            HandleStealthedUnitsDetection();
-            m_DetectInvTimer = 3000;
-        }
-        else
-            { m_DetectInvTimer -= update_diff; }
-    }
-
     // Played time
     if (now > m_Last_tick)
     {
@@ -1290,7 +1266,7 @@ void Player::Update(uint32 update_diff, uint32 p_time)
             { m_deathTimer -= p_time; }
     }
 
-    UpdateEnchantTime(update_diff);
+    UpdateEnchantTime();
     UpdateHomebindTime(update_diff);
 
     // Group update
@@ -1304,6 +1280,42 @@ void Player::Update(uint32 update_diff, uint32 p_time)
         { TeleportTo(m_teleport_dest, m_teleport_options); }
 }
 
+void Player::UpdateDueTimers()
+{
+    if (m_updateTimers.TakeDue(PLAYER_TIMER_ZONE_UPDATE))
+    {
+        uint32 newzone, newarea;
+        GetZoneAndAreaId(newzone, newarea);
+
+        if (m_zoneUpdateId != newzone)
+            { UpdateZone(newzone, newarea); }               // Also update area
+        else
+        {
+            // Use area updates as well
+            if (m_areaUpdateId != newarea)
+                { UpdateArea(newarea); }
+
+            m_updateTimers.Schedule(PLAYER_TIMER_ZONE_UPDATE, ZONE_UPDATE_INTERVAL);
+        }
+    }
+
+    if (m_updateTimers.TakeDue(PLAYER_TIMER_SAVE))
+    {
+        // rescheduled in SaveToDB call
+        // Used by Eluna
+        sEluna->OnSave(this);
+        SaveToDB();
+        DETAIL_LOG("Player '%s' (GUID: %u) saved", GetName(), GetGUIDLow());
+    }
+
+    // Handle detect stealth players
+    if (m_updateTimers.TakeDue(PLAYER_TIMER_DETECT_STEALTH))
+    {
+        HandleStealthedUnitsDetection();
+        m_updateTimers.Schedule(PLAYER_TIMER_DETECT_STEALTH, 3000);
+    }
+}
+
 void Player::SetDeathState(DeathState s)
 {
     uint32 ressSpellId = 0;
@@ -1533,6 +1545,19 @@ bool Player::TeleportTo(uint32 mapid, float x, float y, float z, float orientati
         }
     }
 
+    // map updates running in parallel must not change other maps, far teleports requested by them are applied by
+    // MapManager after all maps are updated. The checks refusing the teleport are made before, so callers still get false
+    if (GetMapId() != mapid && IsInWorld() && sMapMgr.IsUpdatingMaps())
+    {
+        DungeonPersistentState* state = GetBoundInstanceSaveForSelfOrGroup(mapid);
+        Map* map = sMapMgr.FindMap(mapid, state ? state->GetInstanceId() : 0);
+        if (map && !map->CanEnter(this))
+            { return false; }
+
+        GetMap()->DeferTeleport(this, WorldLocation(mapid, x, y, z, orientation), options, assignedAreaTrigger ? NULL : at);
+        return true;
+    }
+
     // if we were on a transport, leave
     if (!(options & TELE_TO_NOT_LEAVE_TRANSPORT) && m_transport)
     {
@@ -1784,6 +1809,8 @@ void Player::RemoveFromWorld()
     // cleanup
     if (IsInWorld())
     {
+        m_pendingOutOfRangeGUIDs.clear();                   // the client drops the objects of the left map itself
+
         ///- Release charmed creatures, unsummon totems and remove pets/guardians
         UnsummonAllTotems();
         RemoveMiniPet();
@@ -2152,6 +2179,8 @@ void Player::SetGMVisible(bool on)
 
         SetVisibility(VISIBILITY_OFF);
     }
+
+    sWhoListMgr.UpdateVisibility(this);
 }
 
 bool Player::IsGroupVisibleFor(Player* p) const
@@ -2270,6 +2299,8 @@ void Player::GiveLevel(uint32 level)
     if (level == getLevel())
         { return; }
 
+    InvalidateQuestGiverStatus();
+
     PlayerLevelInfo info;
     sObjectMgr.GetPlayerLevelInfo(getRace(), getClass(), level, &info);
 
@@ -3263,7 +3294,8 @@ void Player::removeSpell(uint32 spell_id, bool disabled, bool learn_low_rank)
 
 void Player::RemoveSpellCooldown(uint32 spell_id, bool update /* = false */)
 {
-    m_spellCooldowns.erase(spell_id);
+    if (m_spellCooldowns.erase(spell_id))
+        { m_spellCooldownsChanged = true; }
 
     if (update)
         { SendClearCooldown(spell_id, this); }
@@ -3293,6 +3325,7 @@ void Player::RemoveAllSpellCooldown()
             { SendClearCooldown(itr->first, this); }
 
         m_spellCooldowns.clear();
+        m_spellCooldownsChanged = true;
     }
 }
 
@@ -3336,6 +3369,10 @@ void Player::_LoadSpellCooldowns(QueryResult* result)
 
 void Player::_SaveSpellCooldowns()
 {
+    // outdated cooldowns left in the table are skipped at loading
+    if (!m_spellCooldownsChanged)
+        { return; }
+
     static SqlStatementID deleteSpellCooldown ;
     static SqlStatementID insertSpellCooldown ;
 
@@ -3359,6 +3396,8 @@ void Player::_SaveSpellCooldowns()
         else
             { ++itr; }
     }
+
+    m_spellCooldownsChanged = false;
 }
 
 uint32 Player::resetTalentsCost() const
@@ -3742,6 +3781,9 @@ TrainerSpellState Player::GetTrainerSpellState(TrainerSpell const* trainer_spell
  */
 void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRealmChars, bool deleteFinally)
 {
+    // same async DB connection as the saves of the account
+    Database::AsyncOrderScope orderScope(CharacterDatabase, accountId);
+
     //Make sure to delete unresolved tickets so they don't take up place in the open tickets list
     CharacterDatabase.PExecute("DELETE FROM character_ticket "
                                "WHERE resolved = 0 AND guid = %u",
@@ -3760,6 +3802,8 @@ void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRe
 
     uint32 lowguid = playerguid.GetCounter();
 
+    sPlayerNameCache.Remove(lowguid);
+
     // convert corpse to bones if exist (to prevent exiting Corpse in World without DB entry)
     // bones will be deleted by corpse/bones deleting thread shortly
     sObjectAccessor.ConvertCorpseForPlayer(playerguid);
@@ -3969,30 +4013,66 @@ void Player::DeleteOldCharacters()
     Player::DeleteOldCharacters(keepDays);
 }
 
+#define DELETE_OLD_CHARACTERS_BATCH 10                      // characters deleted per query result
+
+static bool deletingOldCharacters = false;
+
+/**
+ * Deletes the characters of one query result and queries the next ones, until no character is left.
+ *
+ * @param resultChars
+ * @param deleteBefore characters deleted before this time are deleted finally
+ * @param lastGuid the highest guid deleted so far, the deletes may be still pending
+ * @param deleted number of characters deleted so far
+ */
+static void DeleteOldCharactersCallback(QueryResult* resultChars, uint64 deleteBefore, uint32 lastGuid, uint32 deleted)
+{
+    if (!resultChars)
+    {
+        sLog.outString("Player::DeleteOldChars: %u character(s) deleted", deleted);
+        deletingOldCharacters = false;
+        return;
+    }
+
+    do
+    {
+        Field* charFields = resultChars->Fetch();
+        lastGuid = charFields[0].GetUInt32();
+        Player::DeleteFromDB(ObjectGuid(HIGHGUID_PLAYER, lastGuid), charFields[1].GetUInt32(), true, true);
+        ++deleted;
+    }
+    while (resultChars->NextRow());
+    delete resultChars;
+
+    DETAIL_LOG("Player::DeleteOldChars: %u character(s) deleted so far", deleted);
+
+    CharacterDatabase.AsyncPQuery(&DeleteOldCharactersCallback, deleteBefore, lastGuid, deleted,
+                                  "SELECT guid, deleteInfos_Account FROM characters WHERE deleteDate IS NOT NULL AND deleteDate < '" UI64FMTD "' AND guid > %u ORDER BY guid LIMIT %u",
+                                  deleteBefore, lastGuid, DELETE_OLD_CHARACTERS_BATCH);
+}
+
 /**
  * Characters which were kept back in the database after being deleted and are older than the specified amount of days, will be completely deleted.
  *
+ * The characters are queried and deleted in small batches by async queries, nothing waits for them.
+ *
  * @see Player::DeleteFromDB
  *
  * @param keepDays overrite the config option by another amount of days
  */
 void Player::DeleteOldCharacters(uint32 keepDays)
 {
+    // the last deletion is still running
+    if (deletingOldCharacters)
+        { return; }
+
     sLog.outString("Player::DeleteOldChars: Deleting all characters which have been deleted %u days before...", keepDays);
 
-    QueryResult* resultChars = CharacterDatabase.PQuery("SELECT guid, deleteInfos_Account FROM characters WHERE deleteDate IS NOT NULL AND deleteDate < '" UI64FMTD "'", uint64(time(NULL) - time_t(keepDays * DAY)));
-    if (resultChars)
-    {
-        sLog.outString("Player::DeleteOldChars: Found %u character(s) to delete", uint32(resultChars->GetRowCount()));
-        do
-        {
-            Field* charFields = resultChars->Fetch();
-            ObjectGuid guid = ObjectGuid(HIGHGUID_PLAYER, charFields[0].GetUInt32());
-            Player::DeleteFromDB(guid, charFields[1].GetUInt32(), true, true);
-        }
-        while (resultChars->NextRow());
-        delete resultChars;
-    }
+    deletingOldCharacters = true;
+    uint64 deleteBefore = uint64(time(NULL) - time_t(keepDays * DAY));
+    CharacterDatabase.AsyncPQuery(&DeleteOldCharactersCallback, deleteBefore, uint32(0), uint32(0),
+                                  "SELECT guid, deleteInfos_Account FROM characters WHERE deleteDate IS NOT NULL AND deleteDate < '" UI64FMTD "' ORDER BY guid LIMIT %u",
+                                  deleteBefore, DELETE_OLD_CHARACTERS_BATCH);
 }
 
 void Player::SetRoot(bool enable)
@@ -5109,6 +5189,8 @@ void Player::SetSkill(uint16 id, uint16 currVal, uint16 maxVal, uint16 step /*=0
     if (!id)
         { return; }
 
+    InvalidateQuestGiverStatus();                           // quests may require the skill
+
     SkillStatusMap::iterator itr = mSkillStatus.find(id);
 
     // has skill
@@ -5535,8 +5617,9 @@ void Player::CheckAreaExploreAndOutdoor()
     if (IsTaxiFlying())
         { return; }
 
-    bool isOutdoor;
-    uint16 areaFlag = GetTerrain()->GetAreaFlag(GetPositionX(), GetPositionY(), GetPositionZ(), &isOutdoor);
+    TerrainQuery const& terrain = GetTerrainQuery();
+    bool isOutdoor = terrain.outdoors;
+    uint16 areaFlag = terrain.areaFlag;
 
     if (isOutdoor)
     {
@@ -6072,6 +6155,12 @@ bool Player::AddHonorCP(float honor, uint8 type, uint32 victim, uint8 victimType
     return true;
 }
 
+void Player::SetInGuild(uint32 GuildId)
+{
+    SetUInt32Value(PLAYER_GUILDID, GuildId);
+    sWhoListMgr.UpdateGuild(this);
+}
+
 uint32 Player::GetGuildIdFromDB(ObjectGuid guid)
 {
     uint32 lowguid = guid.GetCounter();
@@ -6192,6 +6281,8 @@ void Player::UpdateZone(uint32 newZone, uint32 newArea)
     /* If we're moving into a different zone */
     if (m_zoneUpdateId != newZone)
     {
+        sWhoListMgr.UpdateZone(this, newZone);
+
         // handle outdoor pvp zones
         sOutdoorPvPMgr.HandlePlayerLeaveZone(this, m_zoneUpdateId);
         sOutdoorPvPMgr.HandlePlayerEnterZone(this, newZone);
@@ -6214,7 +6305,7 @@ void Player::UpdateZone(uint32 newZone, uint32 newArea)
     sEluna->OnUpdateZone(this, newZone, newArea);
 
     m_zoneUpdateId    = newZone;
-    m_zoneUpdateTimer = ZONE_UPDATE_INTERVAL;
+    m_updateTimers.Schedule(PLAYER_TIMER_ZONE_UPDATE, ZONE_UPDATE_INTERVAL);
 
     // zone changed, so area changed as well, update it
     UpdateArea(newArea);
@@ -10776,30 +10867,30 @@ void Player::UpdateItemDuration(uint32 time, bool realtimeonly)
     }
 }
 
-void Player::UpdateEnchantTime(uint32 time)
+void Player::UpdateEnchantTime()
 {
-    for (EnchantDurationList::iterator itr = m_enchantDuration.begin(), next; itr != m_enchantDuration.end(); itr = next)
+    // sorted by end time, only the expired ones at the front are visited
+    uint64 clock = m_updateTimers.GetClock();
+    while (!m_enchantDuration.empty() && m_enchantDuration.front().endTime <= clock)
     {
-        MANGOS_ASSERT(itr->item);
-        next = itr;
-        if (!itr->item->GetEnchantmentId(itr->slot))
-        {
-            next = m_enchantDuration.erase(itr);
-        }
-        else if (itr->leftduration <= time)
-        {
-            ApplyEnchantment(itr->item, itr->slot, false, false);
-            itr->item->ClearEnchantment(itr->slot);
-            next = m_enchantDuration.erase(itr);
-        }
-        else if (itr->leftduration > time)
+        EnchantDuration expired = m_enchantDuration.front();
+        m_enchantDuration.erase(m_enchantDuration.begin());
+
+        MANGOS_ASSERT(expired.item);
+        if (expired.item->GetEnchantmentId(expired.slot))
         {
-            itr->leftduration -= time;
-            ++next;
+            ApplyEnchantment(expired.item, expired.slot, false, false);
+            expired.item->ClearEnchantment(expired.slot);
         }
     }
 }
 
+uint32 Player::GetEnchantmentTimeLeft(EnchantDuration const& enchant) const
+{
+    uint64 clock = m_updateTimers.GetClock();
+    return enchant.endTime > clock ? uint32(enchant.endTime - clock) : 0;
+}
+
 void Player::AddEnchantmentDurations(Item* item)
 {
     for (int x = 0; x < MAX_ENCHANTMENT_SLOT; ++x)
@@ -10820,7 +10911,7 @@ void Player::RemoveEnchantmentDurations(Item* item)
         if (itr->item == item)
         {
             // save duration in item
-            item->SetEnchantmentDuration(EnchantmentSlot(itr->slot), itr->leftduration);
+            item->SetEnchantmentDuration(EnchantmentSlot(itr->slot), GetEnchantmentTimeLeft(*itr));
             itr = m_enchantDuration.erase(itr);
         }
         else
@@ -10880,7 +10971,7 @@ void Player::AddEnchantmentDuration(Item* item, EnchantmentSlot slot, uint32 dur
     {
         if (itr->item == item && itr->slot == slot)
         {
-            itr->item->SetEnchantmentDuration(itr->slot, itr->leftduration);
+            itr->item->SetEnchantmentDuration(itr->slot, GetEnchantmentTimeLeft(*itr));
             m_enchantDuration.erase(itr);
             break;
         }
@@ -10888,7 +10979,14 @@ void Player::AddEnchantmentDuration(Item* item, EnchantmentSlot slot, uint32 dur
     if (item && duration > 0)
     {
         GetSession()->SendItemEnchantTimeUpdate(GetObjectGuid(), item->GetObjectGuid(), slot, uint32(duration / 1000));
-        m_enchantDuration.push_back(EnchantDuration(item, slot, duration));
+
+        // keep the list sorted by end time, mostly the new one ends last
+        uint64 endTime = m_updateTimers.GetClock() + duration;
+        EnchantDurationList::iterator pos = m_enchantDuration.end();
+        while (pos != m_enchantDuration.begin() && (pos - 1)->endTime > endTime)
+            { --pos; }
+
+        m_enchantDuration.insert(pos, EnchantDuration(item, slot, endTime));
     }
 }
 
@@ -11050,7 +11148,9 @@ void Player::SendEnchantmentDurations()
 {
     for (EnchantDurationList::const_iterator itr = m_enchantDuration.begin(); itr != m_enchantDuration.end(); ++itr)
     {
-        GetSession()->SendItemEnchantTimeUpdate(GetObjectGuid(), itr->item->GetObjectGuid(), itr->slot, uint32(itr->leftduration) / 1000);
+        // cleared enchantments are dropped when they would have ended
+        if (itr->item->GetEnchantmentId(itr->slot))
+            { GetSession()->SendItemEnchantTimeUpdate(GetObjectGuid(), itr->item->GetObjectGuid(), itr->slot, GetEnchantmentTimeLeft(*itr) / 1000); }
     }
 }
 
@@ -11228,11 +11328,11 @@ void Player::PrepareGossipMenu(WorldObject* pSource, uint32 menuId)
 
                 if (GossipMenuItemsLocale const* no = sObjectMgr.GetGossipMenuItemsLocale(idxEntry))
                 {
-                    if (no->OptionText.size() > (size_t)loc_idx && !no->OptionText[loc_idx].empty())
-                        { strOptionText = no->OptionText[loc_idx]; }
+                    if (char const* locText = no->OptionText.Get(loc_idx))
+                        { strOptionText = locText; }
 
-                    if (no->BoxText.size() > (size_t)loc_idx && !no->BoxText[loc_idx].empty())
-                        { strBoxText = no->BoxText[loc_idx]; }
+                    if (char const* locText = no->BoxText.Get(loc_idx))
+                        { strBoxText = locText; }
                 }
             }
 
@@ -11896,6 +11996,7 @@ void Player::AddQuest(Quest const* pQuest, Object* questGiver)
     MANGOS_ASSERT(log_slot < MAX_QUEST_LOG_SIZE);
 
     uint32 quest_id = pQuest->GetQuestId();
+    InvalidateQuestGiverStatus();
 
     // if not exist then created with set uState==NEW and rewarded=false
     QuestStatusData& questStatusData = mQuestStatus[quest_id];
@@ -12040,6 +12141,7 @@ void Player::IncompleteQuest(uint32 quest_id)
 void Player::RewardQuest(Quest const* pQuest, uint32 reward, Object* questGiver, bool announce)
 {
     uint32 quest_id = pQuest->GetQuestId();
+    InvalidateQuestGiverStatus();
 
     for (int i = 0; i < QUEST_ITEM_OBJECTIVES_COUNT; ++i)
     {
@@ -12607,8 +12709,38 @@ bool Player::CanShareQuest(uint32 quest_id) const
     return false;
 }
 
+bool Player::GetCachedQuestGiverStatus(uint8 typeId, uint32 entry, uint32& status)
+{
+    long generation = s_questGiverStatusGeneration.value();
+    if (m_questGiverStatusGeneration != generation)
+    {
+        m_questGiverStatus.clear();
+        m_questGiverStatusGeneration = generation;
+        return false;
+    }
+
+    QuestGiverStatusCache::const_iterator itr = m_questGiverStatus.find(typeId == TYPEID_GAMEOBJECT ? entry | QUEST_GIVER_STATUS_GO_FLAG : entry);
+    if (itr == m_questGiverStatus.end())
+        { return false; }
+
+    status = itr->second;
+    return true;
+}
+
+void Player::CacheQuestGiverStatus(uint8 typeId, uint32 entry, uint32 status)
+{
+    m_questGiverStatus[typeId == TYPEID_GAMEOBJECT ? entry | QUEST_GIVER_STATUS_GO_FLAG : entry] = uint8(status);
+}
+
+void Player::InvalidateAllQuestGiverStatus()
+{
+    ++s_questGiverStatusGeneration;
+}
+
 void Player::SetQuestStatus(uint32 quest_id, QuestStatus status)
 {
+    InvalidateQuestGiverStatus();
+
     if (sObjectMgr.GetQuestTemplate(quest_id))
     {
         QuestStatusData& q_status = mQuestStatus[quest_id];
@@ -13685,7 +13817,7 @@ bool Player::LoadFromDB(ObjectGuid guid, SqlQueryHolder* holder)
 
     // Mail
     _LoadMails(holder->GetResult(PLAYER_LOGIN_QUERY_LOADMAILS));
-    _LoadMailedItems(holder->GetResult(PLAYER_LOGIN_QUERY_LOADMAILEDITEMS));
+    _LoadMailItemInfos(holder->GetResult(PLAYER_LOGIN_QUERY_LOADMAILEDITEMS));
     UpdateNextMailTimeAndUnreads();
 
     _LoadAuras(holder->GetResult(PLAYER_LOGIN_QUERY_LOADAURAS), time_diff);
@@ -14361,9 +14493,53 @@ void Player::_LoadItemLoot(QueryResult* result)
     }
 }
 
+// load the item lists of the mails, the items themselves are loaded at the first mailbox open
+void Player::_LoadMailItemInfos(QueryResult* result)
+{
+    //         0        1          2
+    // "SELECT mail_id, item_guid, item_template FROM mail_items WHERE receiver = '%u'", GUID_LOPART(m_guid)
+    if (!result)
+        { return; }
+
+    do
+    {
+        Field* fields = result->Fetch();
+        uint32 mail_id       = fields[0].GetUInt32();
+        uint32 item_guid_low = fields[1].GetUInt32();
+        uint32 item_template = fields[2].GetUInt32();
+
+        Mail* mail = GetMail(mail_id);
+        if (!mail)
+            { continue; }
+        mail->AddItem(item_guid_low, item_template);
+
+        if (!ObjectMgr::GetItemPrototype(item_template))
+        {
+            sLog.outError("Player %u has unknown item_template (ProtoType) in mailed items(GUID: %u template: %u) in mail (%u), deleted.", GetGUIDLow(), item_guid_low, item_template, mail->messageID);
+            CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", item_guid_low);
+            CharacterDatabase.PExecute("DELETE FROM item_instance WHERE guid = '%u'", item_guid_low);
+        }
+    }
+    while (result->NextRow());
+
+    delete result;
+}
+
+bool Player::StartMailedItemsLoading()
+{
+    if (m_mailedItemsLoaded || m_mailedItemsLoading)
+        { return false; }
+
+    m_mailedItemsLoading = true;
+    return true;
+}
+
 // load mailed item which should receive current player
-void Player::_LoadMailedItems(QueryResult* result)
+void Player::LoadMailedItems(QueryResult* result)
 {
+    m_mailedItemsLoading = false;
+    m_mailedItemsLoaded = true;
+
     // data needs to be at first place for Item::LoadFromDB
     //         0     1        2          3
     // "SELECT data, mail_id, item_guid, item_template FROM mail_items JOIN item_instance ON item_guid = guid WHERE receiver = '%u'", GUID_LOPART(m_guid)
@@ -14377,26 +14553,20 @@ void Player::_LoadMailedItems(QueryResult* result)
         uint32 item_guid_low = fields[2].GetUInt32();
         uint32 item_template = fields[3].GetUInt32();
 
+        // mails deleted meanwhile and items mailed after the login are skipped
         Mail* mail = GetMail(mail_id);
-        if (!mail)
+        if (!mail || GetMItem(item_guid_low))
             { continue; }
-        mail->AddItem(item_guid_low, item_template);
 
         ItemPrototype const* proto = ObjectMgr::GetItemPrototype(item_template);
-
         if (!proto)
-        {
-            sLog.outError("Player %u has unknown item_template (ProtoType) in mailed items(GUID: %u template: %u) in mail (%u), deleted.", GetGUIDLow(), item_guid_low, item_template, mail->messageID);
-            CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", item_guid_low);
-            CharacterDatabase.PExecute("DELETE FROM item_instance WHERE guid = '%u'", item_guid_low);
-            continue;
-        }
+            { continue; }                                   // deleted at login
 
         Item* item = NewItemOrBag(proto);
 
         if (!item->LoadFromDB(item_guid_low, fields, GetObjectGuid()))
         {
-            sLog.outError("Player::_LoadMailedItems - Item in mail (%u) doesn't exist !!!! - item guid: %u, deleted from mail", mail->messageID, item_guid_low);
+            sLog.outError("Player::LoadMailedItems - Item in mail (%u) doesn't exist !!!! - item guid: %u, deleted from mail", mail->messageID, item_guid_low);
             CharacterDatabase.PExecute("DELETE FROM mail_items WHERE item_guid = '%u'", item_guid_low);
             item->FSetState(ITEM_REMOVED);
             item->SaveToDB();                               // it also deletes item object !
@@ -14915,9 +15085,11 @@ bool Player::_LoadHomeBind(QueryResult* result)
 
 void Player::SaveToDB()
 {
-    // we should assure this: ASSERT((m_nextSave != sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE)));
+    // order the save with the other async character DB work of the account, see Database::AsyncOrderScope
+    Database::AsyncOrderScope orderScope(CharacterDatabase, GetSession()->GetAccountId());
+
     // delay auto save at any saves (manual, in code, or autosave)
-    m_nextSave = sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE);
+    m_updateTimers.Schedule(PLAYER_TIMER_SAVE, sWorld.getConfig(CONFIG_UINT32_INTERVAL_SAVE));
 
     // lets allow only players in world to be saved
     if (IsBeingTeleportedFar())
@@ -15111,44 +15283,28 @@ void Player::SaveGoldToDB()
 
 void Player::_SaveActions()
 {
-    static SqlStatementID insertAction ;
-    static SqlStatementID updateAction ;
-    static SqlStatementID deleteAction ;
+    SqlInsertBatch insertActions(CharacterDatabase, "character_action", "guid,button,action,type", "guid,button");
+    SqlDeleteBatch deleteActions(CharacterDatabase, "character_action", "button", "guid", GetGUIDLow());
 
     for (ActionButtonList::iterator itr = m_actionButtons.begin(); itr != m_actionButtons.end();)
     {
         switch (itr->second.uState)
         {
             case ACTIONBUTTON_NEW:
-            {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(insertAction, "INSERT INTO character_action (guid,button,action,type) VALUES (?, ?, ?, ?)");
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(uint32(itr->first));
-                stmt.addUInt32(itr->second.GetAction());
-                stmt.addUInt32(uint32(itr->second.GetType()));
-                stmt.Execute();
-                itr->second.uState = ACTIONBUTTON_UNCHANGED;
-                ++itr;
-            }
-            break;
             case ACTIONBUTTON_CHANGED:
             {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(updateAction, "UPDATE character_action  SET action = ?, type = ? WHERE guid = ? AND button = ?");
-                stmt.addUInt32(itr->second.GetAction());
-                stmt.addUInt32(uint32(itr->second.GetType()));
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(uint32(itr->first));
-                stmt.Execute();
+                insertActions.NewRow();
+                insertActions.addUInt32(GetGUIDLow());
+                insertActions.addUInt32(uint32(itr->first));
+                insertActions.addUInt32(itr->second.GetAction());
+                insertActions.addUInt32(uint32(itr->second.GetType()));
                 itr->second.uState = ACTIONBUTTON_UNCHANGED;
                 ++itr;
             }
             break;
             case ACTIONBUTTON_DELETED:
             {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAction, "DELETE FROM character_action WHERE guid = ? AND button = ?");
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(uint32(itr->first));
-                stmt.Execute();
+                deleteActions.addKey(uint32(itr->first));
                 m_actionButtons.erase(itr++);
             }
             break;
@@ -15157,12 +15313,14 @@ void Player::_SaveActions()
                 break;
         }
     }
+
+    deleteActions.Execute();
+    insertActions.Execute();
 }
 
 void Player::_SaveAuras()
 {
     static SqlStatementID deleteAuras ;
-    static SqlStatementID insertAuras ;
 
     SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM character_aura WHERE guid = ?");
     stmt.PExecute(GetGUIDLow());
@@ -15172,9 +15330,10 @@ void Player::_SaveAuras()
     if (auraHolders.empty())
         { return; }
 
-    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO character_aura (guid, caster_guid, item_guid, spell, stackcount, remaincharges, "
-            "basepoints0, basepoints1, basepoints2, periodictime0, periodictime1, periodictime2, maxduration, remaintime, effIndexMask) "
-            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    // upsert in case two holders share the key, a plain multi-row insert would drop all auras then
+    SqlInsertBatch insertAuras(CharacterDatabase, "character_aura", "guid, caster_guid, item_guid, spell, stackcount, remaincharges, "
+                               "basepoints0, basepoints1, basepoints2, periodictime0, periodictime1, periodictime2, maxduration, remaintime, effIndexMask",
+                               "guid, caster_guid, item_guid, spell");
 
     for (SpellAuraHolderMap::const_iterator itr = auraHolders.begin(); itr != auraHolders.end(); ++itr)
     {
@@ -15210,25 +15369,27 @@ void Player::_SaveAuras()
             if (!effIndexMask)
                 { continue; }
 
-            stmt.addUInt32(GetGUIDLow());
-            stmt.addUInt64(holder->GetCasterGuid().GetRawValue());
-            stmt.addUInt32(holder->GetCastItemGuid().GetCounter());
-            stmt.addUInt32(holder->GetId());
-            stmt.addUInt32(holder->GetStackAmount());
-            stmt.addUInt8(holder->GetAuraCharges());
+            insertAuras.NewRow();
+            insertAuras.addUInt32(GetGUIDLow());
+            insertAuras.addUInt64(holder->GetCasterGuid().GetRawValue());
+            insertAuras.addUInt32(holder->GetCastItemGuid().GetCounter());
+            insertAuras.addUInt32(holder->GetId());
+            insertAuras.addUInt32(holder->GetStackAmount());
+            insertAuras.addUInt8(holder->GetAuraCharges());
 
             for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-                { stmt.addInt32(damage[i]); }
+                { insertAuras.addInt32(damage[i]); }
 
             for (uint32 i = 0; i < MAX_EFFECT_INDEX; ++i)
-                { stmt.addUInt32(periodicTime[i]); }
+                { insertAuras.addUInt32(periodicTime[i]); }
 
-            stmt.addInt32(holder->GetAuraMaxDuration());
-            stmt.addInt32(holder->GetAuraDuration());
-            stmt.addUInt32(effIndexMask);
-            stmt.Execute();
+            insertAuras.addInt32(holder->GetAuraMaxDuration());
+            insertAuras.addInt32(holder->GetAuraDuration());
+            insertAuras.addUInt32(effIndexMask);
         }
     }
+
+    insertAuras.Execute();
 }
 
 void Player::_SaveInventory()
@@ -15255,7 +15416,7 @@ void Player::_SaveInventory()
     // update enchantment durations
     for (EnchantDurationList::const_iterator itr = m_enchantDuration.begin(); itr != m_enchantDuration.end(); ++itr)
     {
-        itr->item->SetEnchantmentDuration(itr->slot, itr->leftduration);
+        itr->item->SetEnchantmentDuration(itr->slot, GetEnchantmentTimeLeft(*itr));
     }
 
     // if no changes
@@ -15288,9 +15449,8 @@ void Player::_SaveInventory()
         return;
     }
 
-    static SqlStatementID insertInventory ;
-    static SqlStatementID updateInventory ;
-    static SqlStatementID deleteInventory ;
+    SqlInsertBatch insertInventory(CharacterDatabase, "character_inventory", "guid,bag,slot,item,item_template", "item");
+    SqlDeleteBatch deleteInventory(CharacterDatabase, "character_inventory", "item");
 
     for (size_t i = 0; i < m_itemUpdateQueue.size(); ++i)
     {
@@ -15303,33 +15463,19 @@ void Player::_SaveInventory()
         switch (item->GetState())
         {
             case ITEM_NEW:
-            {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(insertInventory, "INSERT INTO character_inventory (guid,bag,slot,item,item_template) VALUES (?, ?, ?, ?, ?)");
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(bag_guid);
-                stmt.addUInt8(item->GetSlot());
-                stmt.addUInt32(item->GetGUIDLow());
-                stmt.addUInt32(item->GetEntry());
-                stmt.Execute();
-            }
-            break;
             case ITEM_CHANGED:
             {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(updateInventory, "UPDATE character_inventory SET guid = ?, bag = ?, slot = ?, item_template = ? WHERE item = ?");
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(bag_guid);
-                stmt.addUInt8(item->GetSlot());
-                stmt.addUInt32(item->GetEntry());
-                stmt.addUInt32(item->GetGUIDLow());
-                stmt.Execute();
+                insertInventory.NewRow();
+                insertInventory.addUInt32(GetGUIDLow());
+                insertInventory.addUInt32(bag_guid);
+                insertInventory.addUInt8(item->GetSlot());
+                insertInventory.addUInt32(item->GetGUIDLow());
+                insertInventory.addUInt32(item->GetEntry());
             }
             break;
             case ITEM_REMOVED:
-            {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(deleteInventory, "DELETE FROM character_inventory WHERE item = ?");
-                stmt.PExecute(item->GetGUIDLow());
-            }
-            break;
+                deleteInventory.addKey(item->GetGUIDLow());
+                break;
             case ITEM_UNCHANGED:
                 break;
         }
@@ -15337,6 +15483,9 @@ void Player::_SaveInventory()
         item->SaveToDB();                                   // item have unchanged inventory record and can be save standalone
     }
     m_itemUpdateQueue.clear();
+
+    deleteInventory.Execute();
+    insertInventory.Execute();
 }
 
 void Player::_SaveHonorCP()
@@ -15449,9 +15598,9 @@ void Player::_SaveMail()
 
 void Player::_SaveQuestStatus()
 {
-    static SqlStatementID insertQuestStatus ;
-
-    static SqlStatementID updateQuestStatus ;
+    SqlInsertBatch insertQuestStatus(CharacterDatabase, "character_queststatus",
+                                     "guid,quest,status,rewarded,explored,timer,mobcount1,mobcount2,mobcount3,mobcount4,itemcount1,itemcount2,itemcount3,itemcount4",
+                                     "guid,quest");
 
     // we don't need transactions here.
     for (QuestStatusMap::iterator i = mQuestStatus.begin(); i != mQuestStatus.end(); ++i)
@@ -15459,39 +15608,19 @@ void Player::_SaveQuestStatus()
         switch (i->second.uState)
         {
             case QUEST_NEW :
-            {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(insertQuestStatus, "INSERT INTO character_queststatus (guid,quest,status,rewarded,explored,timer,mobcount1,mobcount2,mobcount3,mobcount4,itemcount1,itemcount2,itemcount3,itemcount4) "
-                                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(i->first);
-                stmt.addUInt8(i->second.m_status);
-                stmt.addUInt8(i->second.m_rewarded);
-                stmt.addUInt8(i->second.m_explored);
-                stmt.addUInt64(uint64(i->second.m_timer / IN_MILLISECONDS + sWorld.GetGameTime()));
-                for (int k = 0; k < QUEST_OBJECTIVES_COUNT; ++k)
-                    { stmt.addUInt32(i->second.m_creatureOrGOcount[k]); }
-                for (int k = 0; k < QUEST_OBJECTIVES_COUNT; ++k)
-                    { stmt.addUInt32(i->second.m_itemcount[k]); }
-                stmt.Execute();
-            }
-            break;
             case QUEST_CHANGED :
             {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(updateQuestStatus, "UPDATE character_queststatus SET status = ?,rewarded = ?,explored = ?,timer = ?,"
-                                    "mobcount1 = ?,mobcount2 = ?,mobcount3 = ?,mobcount4 = ?,itemcount1 = ?,itemcount2 = ?,itemcount3 = ?,itemcount4 = ?  WHERE guid = ? AND quest = ?");
-
-                stmt.addUInt8(i->second.m_status);
-                stmt.addUInt8(i->second.m_rewarded);
-                stmt.addUInt8(i->second.m_explored);
-                stmt.addUInt64(uint64(i->second.m_timer / IN_MILLISECONDS + sWorld.GetGameTime()));
+                insertQuestStatus.NewRow();
+                insertQuestStatus.addUInt32(GetGUIDLow());
+                insertQuestStatus.addUInt32(i->first);
+                insertQuestStatus.addUInt8(i->second.m_status);
+                insertQuestStatus.addUInt8(i->second.m_rewarded);
+                insertQuestStatus.addUInt8(i->second.m_explored);
+                insertQuestStatus.addUInt64(uint64(i->second.m_timer / IN_MILLISECONDS + sWorld.GetGameTime()));
                 for (int k = 0; k < QUEST_OBJECTIVES_COUNT; ++k)
-                    { stmt.addUInt32(i->second.m_creatureOrGOcount[k]); }
+                    { insertQuestStatus.addUInt32(i->second.m_creatureOrGOcount[k]); }
                 for (int k = 0; k < QUEST_OBJECTIVES_COUNT; ++k)
-                    { stmt.addUInt32(i->second.m_itemcount[k]); }
-                stmt.addUInt32(GetGUIDLow());
-                stmt.addUInt32(i->first);
-                stmt.Execute();
+                    { insertQuestStatus.addUInt32(i->second.m_itemcount[k]); }
             }
             break;
             case QUEST_UNCHANGED:
@@ -15499,13 +15628,14 @@ void Player::_SaveQuestStatus()
         };
         i->second.uState = QUEST_UNCHANGED;
     }
+
+    insertQuestStatus.Execute();
 }
 
 void Player::_SaveSkills()
 {
-    static SqlStatementID delSkills ;
-    static SqlStatementID insSkills ;
-    static SqlStatementID updSkills ;
+    SqlInsertBatch insertSkills(CharacterDatabase, "character_skills", "guid, skill, value, max", "guid, skill");
+    SqlDeleteBatch deleteSkills(CharacterDatabase, "character_skills", "skill", "guid", GetGUIDLow());
 
     // we don't need transactions here.
     for (SkillStatusMap::iterator itr = mSkillStatus.begin(); itr != mSkillStatus.end();)
@@ -15518,57 +15648,46 @@ void Player::_SaveSkills()
 
         if (itr->second.uState == SKILL_DELETED)
         {
-            SqlStatement stmt = CharacterDatabase.CreateStatement(delSkills, "DELETE FROM character_skills WHERE guid = ? AND skill = ?");
-            stmt.PExecute(GetGUIDLow(), itr->first);
+            deleteSkills.addKey(itr->first);
             mSkillStatus.erase(itr++);
             continue;
         }
 
         uint32 valueData = GetUInt32Value(PLAYER_SKILL_VALUE_INDEX(itr->second.pos));
-        uint16 value = SKILL_VALUE(valueData);
-        uint16 max = SKILL_MAX(valueData);
 
-        switch (itr->second.uState)
-        {
-            case SKILL_NEW:
-            {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(insSkills, "INSERT INTO character_skills (guid, skill, value, max) VALUES (?, ?, ?, ?)");
-                stmt.PExecute(GetGUIDLow(), itr->first, value, max);
-            }
-            break;
-            case SKILL_CHANGED:
-            {
-                SqlStatement stmt = CharacterDatabase.CreateStatement(updSkills, "UPDATE character_skills SET value = ?, max = ? WHERE guid = ? AND skill = ?");
-                stmt.PExecute(value, max, GetGUIDLow(), itr->first);
-            }
-            break;
-            case SKILL_UNCHANGED:
-            case SKILL_DELETED:
-                MANGOS_ASSERT(false);
-                break;
-        };
+        // SKILL_NEW and SKILL_CHANGED
+        insertSkills.NewRow();
+        insertSkills.addUInt32(GetGUIDLow());
+        insertSkills.addUInt32(itr->first);
+        insertSkills.addUInt32(SKILL_VALUE(valueData));
+        insertSkills.addUInt32(SKILL_MAX(valueData));
         itr->second.uState = SKILL_UNCHANGED;
 
         ++itr;
     }
+
+    deleteSkills.Execute();
+    insertSkills.Execute();
 }
 
 void Player::_SaveSpells()
 {
-    static SqlStatementID delSpells ;
-    static SqlStatementID insSpells ;
+    SqlInsertBatch insertSpells(CharacterDatabase, "character_spell", "guid,spell,active,disabled", "guid,spell");
+    SqlDeleteBatch deleteSpells(CharacterDatabase, "character_spell", "spell", "guid", GetGUIDLow());
 
-    SqlStatement stmtDel = CharacterDatabase.CreateStatement(delSpells, "DELETE FROM character_spell WHERE guid = ? and spell = ?");
-    SqlStatement stmtIns = CharacterDatabase.CreateStatement(insSpells, "INSERT INTO character_spell (guid,spell,active,disabled) VALUES (?, ?, ?, ?)");
-
-    for (PlayerSpellMap::iterator itr = m_spells.begin(), next = m_spells.begin(); itr != m_spells.end();)
+    for (PlayerSpellMap::iterator itr = m_spells.begin(); itr != m_spells.end();)
     {
-        if (itr->second.state == PLAYERSPELL_REMOVED || itr->second.state == PLAYERSPELL_CHANGED)
-            { stmtDel.PExecute(GetGUIDLow(), itr->first); }
-
-        // add only changed/new not dependent spells
+        // add only changed/new not dependent spells, changed dependent ones lose their record
         if (!itr->second.dependent && (itr->second.state == PLAYERSPELL_NEW || itr->second.state == PLAYERSPELL_CHANGED))
-            { stmtIns.PExecute(GetGUIDLow(), itr->first, uint8(itr->second.active ? 1 : 0), uint8(itr->second.disabled ? 1 : 0)); }
+        {
+            insertSpells.NewRow();
+            insertSpells.addUInt32(GetGUIDLow());
+            insertSpells.addUInt32(itr->first);
+            insertSpells.addUInt8(uint8(itr->second.active ? 1 : 0));
+            insertSpells.addUInt8(uint8(itr->second.disabled ? 1 : 0));
+        }
+        else if (itr->second.state == PLAYERSPELL_REMOVED || itr->second.state == PLAYERSPELL_CHANGED)
+            { deleteSpells.addKey(itr->first); }
 
         if (itr->second.state == PLAYERSPELL_REMOVED)
             { m_spells.erase(itr++); }
@@ -15578,6 +15697,9 @@ void Player::_SaveSpells()
             ++itr;
         }
     }
+
+    deleteSpells.Execute();
+    insertSpells.Execute();
 }
 
 // save player stats -- only for external usage
@@ -16195,6 +16317,17 @@ void Player::AddSpellMod(SpellModifier* mod, bool apply)
         }
     }
 
+    // mods keep having charges or not, the used up charges of a mod are -1
+    if (mod->charges)
+    {
+        if (apply)
+            { m_chargedSpellMods[mod->op].push_back(mod); }
+        else
+            { m_chargedSpellMods[mod->op].remove(mod); }
+    }
+    else
+        { m_spellModTotals[mod->op].clear(); }
+
     if (apply)
         { m_spellMods[mod->op].push_back(mod); }
     else
@@ -16206,6 +16339,38 @@ void Player::AddSpellMod(SpellModifier* mod, bool apply)
     }
 }
 
+SpellModTotals Player::GetSpellModTotals(SpellEntry const* spellInfo, SpellModOp op)
+{
+    SpellModTotalsMap& totalsMap = m_spellModTotals[op];
+    SpellModTotalsMap::const_iterator found = totalsMap.find(spellInfo->Id);
+    if (found != totalsMap.end())
+        { return found->second; }
+
+    SpellModTotals totals;
+    totals.flat = 0;
+    totals.pct = 0;
+    totals.instantCastPct = 0;
+
+    for (SpellModList::const_iterator itr = m_spellMods[op].begin(); itr != m_spellMods[op].end(); ++itr)
+    {
+        SpellModifier* mod = *itr;
+        if (mod->charges || !mod->isAffectedOnSpell(spellInfo))
+            { continue; }
+
+        if (mod->type == SPELLMOD_FLAT)
+            { totals.flat += mod->value; }
+        else if (mod->type == SPELLMOD_PCT)
+        {
+            totals.pct += mod->value;
+            if (op == SPELLMOD_CASTING_TIME && mod->value <= -100)
+                { totals.instantCastPct += mod->value; }
+        }
+    }
+
+    totalsMap.insert(SpellModTotalsMap::value_type(spellInfo->Id, totals));
+    return totals;
+}
+
 SpellModifier* Player::GetSpellMod(SpellModOp op, uint32 spellId) const
 {
     for (SpellModList::const_iterator itr = m_spellMods[op].begin(); itr != m_spellMods[op].end(); ++itr)
@@ -16353,6 +16518,7 @@ void Player::HandleStealthedUnitsDetection()
             if (!hasAtClient)
             {
                 ObjectGuid i_guid = (*i)->GetObjectGuid();
+                SendPendingOutOfRangeBeforeCreate(i_guid);
                 (*i)->SendCreateUpdateToPlayer(this);
                 m_clientGUIDs.insert(i_guid);
 
@@ -16368,7 +16534,7 @@ void Player::HandleStealthedUnitsDetection()
         {
             if (hasAtClient)
             {
-                (*i)->DestroyForPlayer(this);
+                AddPendingOutOfRange((*i)->GetObjectGuid());
                 m_clientGUIDs.erase((*i)->GetObjectGuid());
             }
         }
@@ -17043,6 +17209,7 @@ void Player::AddSpellCooldown(uint32 spellid, uint32 itemid, time_t end_time)
     sc.end = end_time;
     sc.itemid = itemid;
     m_spellCooldowns[spellid] = sc;
+    m_spellCooldownsChanged = true;
 }
 
 void Player::SendCooldownEvent(SpellEntry const* spellInfo, uint32 itemId, Spell* spell)
@@ -17205,8 +17372,9 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
             if (target->GetTypeId() == TYPEID_UNIT)
                 { BeforeVisibilityDestroy<Creature>((Creature*)target, this); }
 
-            target->DestroyForPlayer(this);
+            AddPendingOutOfRange(t_guid);
             m_clientGUIDs.erase(t_guid);
+            ++GetMap()->GetVisibilityStats().clientObjectsDestroyed;
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "UpdateVisibilityOf: %s out of range for player %u. Distance = %f", t_guid.GetString().c_str(), GetGUIDLow(), GetDistance(target));
         }
@@ -17215,9 +17383,11 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
     {
         if (target->IsVisibleForInState(this, viewPoint, false))
         {
+            SendPendingOutOfRangeBeforeCreate(target->GetObjectGuid());
             target->SendCreateUpdateToPlayer(this);
             if (target->GetTypeId() != TYPEID_GAMEOBJECT || !((GameObject*)target)->IsTransport())
                 { m_clientGUIDs.insert(target->GetObjectGuid()); }
+            ++GetMap()->GetVisibilityStats().clientObjectsCreated;
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "UpdateVisibilityOf: %s is visible now for player %u. Distance = %f", target->GetGuidStr().c_str(), GetGUIDLow(), GetDistance(target));
 
@@ -17230,20 +17400,39 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
 }
 
 template<class T>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, T* target)
+inline void UpdateVisibilityOf_helper(GuidHashSet& s64, T* target)
 {
     s64.insert(target->GetObjectGuid());
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, GameObject* target)
+inline void UpdateVisibilityOf_helper(GuidHashSet& s64, GameObject* target)
 {
     if (!target->IsTransport())
         { s64.insert(target->GetObjectGuid()); }
 }
 
+void Player::FlushPendingOutOfRange(UpdateData& data)
+{
+    data.AddOutOfRangeGUID(m_pendingOutOfRangeGUIDs);
+    m_pendingOutOfRangeGUIDs.clear();
+}
+
+/// A held back out of range of the object has to reach the client before its new create
+void Player::SendPendingOutOfRangeBeforeCreate(ObjectGuid const& guid)
+{
+    if (std::find(m_pendingOutOfRangeGUIDs.begin(), m_pendingOutOfRangeGUIDs.end(), guid) == m_pendingOutOfRangeGUIDs.end())
+        { return; }
+
+    UpdateData data;
+    FlushPendingOutOfRange(data);
+    WorldPacket packet;
+    data.BuildPacket(&packet);
+    GetSession()->SendPacket(&packet);
+}
+
 template<class T>
-void Player::UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateData& data, std::set<WorldObject*>& visibleNow)
+void Player::UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateData& data, WorldObjectTickSet& visibleNow)
 {
     if (HaveAtClient(target))
     {
@@ -17255,6 +17444,7 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateD
 
             target->BuildOutOfRangeUpdateBlock(&data);
             m_clientGUIDs.erase(t_guid);
+            ++GetMap()->GetVisibilityStats().clientObjectsDestroyed;
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "UpdateVisibilityOf(TemplateV): %s is out of range for %s. Distance = %f", t_guid.GetString().c_str(), GetGuidStr().c_str(), GetDistance(target));
         }
@@ -17266,17 +17456,18 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateD
             visibleNow.insert(target);
             target->BuildCreateUpdateBlockForPlayer(&data, this);
             UpdateVisibilityOf_helper(m_clientGUIDs, target);
+            ++GetMap()->GetVisibilityStats().clientObjectsCreated;
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "UpdateVisibilityOf(TemplateV): %s is visible now for %s. Distance = %f", target->GetGuidStr().c_str(), GetGuidStr().c_str(), GetDistance(target));
         }
     }
 }
 
-template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, Player*        target, UpdateData& data, std::set<WorldObject*>& visibleNow);
-template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, Creature*      target, UpdateData& data, std::set<WorldObject*>& visibleNow);
-template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, Corpse*        target, UpdateData& data, std::set<WorldObject*>& visibleNow);
-template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, GameObject*    target, UpdateData& data, std::set<WorldObject*>& visibleNow);
-template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, DynamicObject* target, UpdateData& data, std::set<WorldObject*>& visibleNow);
+template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, Player*        target, UpdateData& data, WorldObjectTickSet& visibleNow);
+template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, Creature*      target, UpdateData& data, WorldObjectTickSet& visibleNow);
+template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, Corpse*        target, UpdateData& data, WorldObjectTickSet& visibleNow);
+template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, GameObject*    target, UpdateData& data, WorldObjectTickSet& visibleNow);
+template void Player::UpdateVisibilityOf(WorldObject const* viewPoint, DynamicObject* target, UpdateData& data, WorldObjectTickSet& visibleNow);
 
 void Player::InitPrimaryProfessions()
 {
@@ -17454,8 +17645,22 @@ void Player::SendUpdateToOutOfRangeGroupMembers()
     if (m_groupUpdateMask == GROUP_UPDATE_FLAG_NONE)
         { return; }
     if (Group* group = GetGroup())
-        { group->UpdatePlayerOutOfRange(this); }
+    {
+        // the group sends the changes of raid members together, the flags are kept until then
+        if (group->isRaidGroup() && sWorld.getConfig(CONFIG_UINT32_UPDATE_COALESCE_RAID_STATS))
+        {
+            group->AddStatsChangedMember(this);
+            return;
+        }
+
+        group->UpdatePlayerOutOfRange(this);
+    }
 
+    ResetGroupUpdateFlags();
+}
+
+void Player::ResetGroupUpdateFlags()
+{
     m_groupUpdateMask = GROUP_UPDATE_FLAG_NONE;
     m_auraUpdateMask = 0;
     if (Pet* pet = GetPet())
@@ -17902,7 +18107,7 @@ void Player::UpdateForQuestWorldObjects()
 
     // UpdateData udata;
     // WorldPacket packet;
-    for (GuidSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
+    for (GuidHashSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
     {
         if (itr->IsGameObject())
         {
@@ -18474,7 +18679,17 @@ void Player::SetOriginalGroup(Group* group, int8 subgroup)
 void Player::UpdateUnderwaterState(Map* m, float x, float y, float z)
 {
     GridMapLiquidData liquid_status;
-    GridMapLiquidStatus res = m->GetTerrain()->getLiquidStatus(x, y, z, MAP_ALL_LIQUIDS, &liquid_status);
+    GridMapLiquidStatus res;
+    // at the current position the result is shared with the area and outdoor check
+    if (m == GetMap() && x == GetPositionX() && y == GetPositionY() && z == GetPositionZ())
+    {
+        TerrainQuery const& terrain = GetTerrainQuery();
+        res = terrain.liquidStatus;
+        liquid_status = terrain.liquid;
+    }
+    else
+        { res = m->GetTerrain()->getLiquidStatus(x, y, z, MAP_ALL_LIQUIDS, &liquid_status); }
+
     if (!res)
     {
         m_MirrorTimerFlags &= ~(UNDERWATER_INWATER | UNDERWATER_INLAVA | UNDERWATER_INSLIME | UNDERWATER_INDARKWATER);
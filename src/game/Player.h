@@ -36,6 +36,7 @@
 #include "Group.h"
 #include "Bag.h"
 #include "WorldSession.h"
+#include "MemoryTracker.h"
 #include "Pet.h"
 #include "MapReference.h"
 #include "Util.h"                                           // for Tokens typedef
@@ -45,6 +46,7 @@
 #include "SharedDefines.h"
 #include "Chat.h"
 #include "GMTicketMgr.h"
+#include "GuidHashSet.h"
 
 #include<string>
 #include<vector>
@@ -144,6 +146,16 @@ struct SpellModifier
 
 typedef std::list<SpellModifier*> SpellModList;
 
+/// Sums of the spell mods without charges of one op that affect a spell, see Player::GetSpellModTotals
+struct SpellModTotals
+{
+    int32 flat;
+    int32 pct;
+    int32 instantCastPct;                                   // part of pct by SPELLMOD_CASTING_TIME mods of -100 or less
+};
+
+typedef FlatHashMap<uint32, SpellModTotals> SpellModTotalsMap;
+
 struct SpellCooldown
 {
     time_t end;
@@ -305,15 +317,79 @@ struct Areas
 
 struct EnchantDuration
 {
-    EnchantDuration() : item(NULL), slot(MAX_ENCHANTMENT_SLOT), leftduration(0) {};
-    EnchantDuration(Item* _item, EnchantmentSlot _slot, uint32 _leftduration) : item(_item), slot(_slot), leftduration(_leftduration) { MANGOS_ASSERT(item); };
+    EnchantDuration() : item(NULL), slot(MAX_ENCHANTMENT_SLOT), endTime(0) {};
+    EnchantDuration(Item* _item, EnchantmentSlot _slot, uint64 _endTime) : item(_item), slot(_slot), endTime(_endTime) { MANGOS_ASSERT(item); };
 
     Item* item;
     EnchantmentSlot slot;
-    uint32 leftduration;
+    uint64 endTime;                                         // on the clock of PlayerUpdateTimers
+};
+
+typedef std::vector<EnchantDuration> EnchantDurationList;   // sorted by endTime
+
+/// Periodic checks of Player::Update
+enum PlayerUpdateTimer
+{
+    PLAYER_TIMER_ZONE_UPDATE    = 0,                        // zone and area of the position
+    PLAYER_TIMER_SAVE           = 1,                        // auto save, CONFIG_UINT32_INTERVAL_SAVE
+    PLAYER_TIMER_DETECT_STEALTH = 2,                        // stealthed units around
+    MAX_PLAYER_UPDATE_TIMERS
 };
 
-typedef std::list<EnchantDuration> EnchantDurationList;
+/**
+ * @brief Timers of a player on one clock advanced by Player::Update
+ *
+ * A timer is stored as the clock time it is due at, nothing is counted down
+ * per update. The earliest due time is kept, so an update without a due timer
+ * is a single compare.
+ */
+class PlayerUpdateTimers
+{
+    public:
+        PlayerUpdateTimers() : m_clock(0), m_nextDue(0)
+        {
+            for (int i = 0; i < MAX_PLAYER_UPDATE_TIMERS; ++i)
+                { m_due[i] = 0; }
+        }
+
+        uint64 GetClock() const { return m_clock; }
+        void Advance(uint32 diff) { m_clock += diff; }
+
+        // a delay of 0 stops the timer
+        void Schedule(PlayerUpdateTimer timer, uint32 delay)
+        {
+            m_due[timer] = delay ? m_clock + delay : 0;
+            UpdateNextDue();
+        }
+
+        // time until the timer is due, 0 if it is stopped or due
+        uint32 GetTimeLeft(PlayerUpdateTimer timer) const { return m_due[timer] > m_clock ? uint32(m_due[timer] - m_clock) : 0; }
+
+        bool HasDue() const { return m_nextDue && m_clock >= m_nextDue; }
+
+        // stops the timer if it is due
+        bool TakeDue(PlayerUpdateTimer timer)
+        {
+            if (!m_due[timer] || m_clock < m_due[timer])
+                { return false; }
+
+            Schedule(timer, 0);
+            return true;
+        }
+
+    private:
+        void UpdateNextDue()
+        {
+            m_nextDue = 0;
+            for (int i = 0; i < MAX_PLAYER_UPDATE_TIMERS; ++i)
+                if (m_due[i] && (!m_nextDue || m_due[i] < m_nextDue))
+                    { m_nextDue = m_due[i]; }
+        }
+
+        uint64 m_clock;                                     // sum of the update diffs
+        uint64 m_due[MAX_PLAYER_UPDATE_TIMERS];             // 0 for a stopped timer
+        uint64 m_nextDue;
+};
 typedef std::list<Item*> ItemDurationList;
 
 enum RaidGroupError
@@ -433,6 +509,18 @@ enum MirrorTimerType
 #define MAX_TIMERS              3
 #define DISABLED_MIRROR_TIMER   -1
 
+// 2^n values, stats calculated from the primary stats, see Player::UpdateStats
+enum PlayerDerivedStats
+{
+    PLAYER_DERIVED_ARMOR            = 0x0001,
+    PLAYER_DERIVED_MELEE_CRIT       = 0x0002,
+    PLAYER_DERIVED_DODGE            = 0x0004,
+    PLAYER_DERIVED_SPELL_CRIT       = 0x0008,
+    PLAYER_DERIVED_ATTACK_POWER     = 0x0010,               // melee and ranged, with the weapon damage
+    PLAYER_DERIVED_SPELL_BONUS      = 0x0020,               // spell damage and healing bonus and mana regen
+    PLAYER_DERIVED_ALL              = 0x003F
+};
+
 // 2^n values
 enum PlayerExtraFlags
 {
@@ -463,6 +551,7 @@ enum AtLoginFlags
 };
 
 typedef std::map<uint32, QuestStatusData> QuestStatusMap;
+typedef UNORDERED_MAP<uint32, uint8> QuestGiverStatusCache;// dialog status by quest giver entry, game object entries with the high bit set
 
 enum QuestSlotOffsets
 {
@@ -840,7 +929,7 @@ class TradeData
         ObjectGuid m_items[TRADE_SLOT_COUNT];               // traded itmes from m_player side including non-traded slot
 };
 
-class MANGOS_DLL_SPEC Player : public Unit
+class MANGOS_DLL_SPEC Player : public Unit, public MemoryTracked<MEM_TAG_PLAYER>
 {
         friend class WorldSession;
         friend void Item::AddToUpdateQueueOf(Player* player);
@@ -1120,7 +1209,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         TradeData* GetTradeData() const { return m_trade; }
         void TradeCancel(bool sendback);
 
-        void UpdateEnchantTime(uint32 time);
+        void UpdateEnchantTime();
+        uint32 GetEnchantmentTimeLeft(EnchantDuration const& enchant) const;
         void UpdateItemDuration(uint32 time, bool realtimeonly = false);
         void AddEnchantmentDurations(Item* item);
         void RemoveEnchantmentDurations(Item* item);
@@ -1315,6 +1405,14 @@ class MANGOS_DLL_SPEC Player : public Unit
 
         QuestStatusMap& getQuestStatusMap() { return mQuestStatus; };
 
+        // Dialog status from the quest relations of a quest giver entry, see WorldSession::getDialogStatus
+        bool GetCachedQuestGiverStatus(uint8 typeId, uint32 entry, uint32& status);
+        void CacheQuestGiverStatus(uint8 typeId, uint32 entry, uint32 status);
+        // at changes of the quests, level, skills or reputation of the player
+        void InvalidateQuestGiverStatus() { m_questGiverStatus.clear(); }
+        // at changes of the quests of all players, like game events and reloads
+        static void InvalidateAllQuestGiverStatus();
+
         ObjectGuid const& GetSelectionGuid() const { return m_curSelectionGuid; }
         void SetSelectionGuid(ObjectGuid guid) { m_curSelectionGuid = guid; SetTargetGuid(guid); }
 
@@ -1339,12 +1437,21 @@ class MANGOS_DLL_SPEC Player : public Unit
         PlayerMails::iterator GetMailBegin() { return m_mail.begin();}
         PlayerMails::iterator GetMailEnd() { return m_mail.end();}
 
+        /// the items in the mails are loaded at the first mailbox open, see WorldSession::HandleGetMailList
+        bool IsMailedItemsLoaded() const { return m_mailedItemsLoaded; }
+        /// false if the items are already loaded or being loaded
+        bool StartMailedItemsLoading();
+        bool IsMailedItemsLoading() const { return m_mailedItemsLoading; }
+        void LoadMailedItems(QueryResult* result);
+
         /*********************************************************/
         /*** MAILED ITEMS SYSTEM ***/
         /*********************************************************/
 
         uint8 unReadMails;
         time_t m_nextMailDelivereTime;
+        bool m_mailedItemsLoaded;
+        bool m_mailedItemsLoading;
 
         typedef UNORDERED_MAP<uint32, Item*> ItemMap;
 
@@ -1414,6 +1521,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         void AddSpellMod(SpellModifier* mod, bool apply);
         bool IsAffectedBySpellmod(SpellEntry const* spellInfo, SpellModifier* mod, Spell const* spell = NULL);
         template <class T> T ApplySpellMod(uint32 spellId, SpellModOp op, T& basevalue, Spell const* spell = NULL);
+        SpellModTotals GetSpellModTotals(SpellEntry const* spellInfo, SpellModOp op);
         SpellModifier* GetSpellMod(SpellModOp op, uint32 spellId) const;
         void RemoveSpellMods(Spell const* spell);
         void ResetSpellModsDueToCanceledSpell(Spell const* spell);
@@ -1505,8 +1613,9 @@ class MANGOS_DLL_SPEC Player : public Unit
         static void RemoveFromGroup(Group* group, ObjectGuid guid);
         void RemoveFromGroup() { RemoveFromGroup(GetGroup(), GetObjectGuid()); }
         void SendUpdateToOutOfRangeGroupMembers();
+        void ResetGroupUpdateFlags();
 
-        void SetInGuild(uint32 GuildId) { SetUInt32Value(PLAYER_GUILDID, GuildId); }
+        void SetInGuild(uint32 GuildId);
         void SetRank(uint32 rankId) { SetUInt32Value(PLAYER_GUILDRANK, rankId); }
         void SetGuildIdInvited(uint32 GuildId) { m_GuildIdInvited = GuildId; }
         uint32 GetGuildId() { return GetUInt32Value(PLAYER_GUILDID);  }
@@ -1560,6 +1669,9 @@ class MANGOS_DLL_SPEC Player : public Unit
         void UpdateSpellCritChance(uint32 school);
         void UpdateManaRegen();
 
+        /// Recalculate the derived stats of the primary stats changed since the last call
+        void UpdatePendingDerivedStats();
+
         ObjectGuid const& GetLootGuid() const { return m_lootGuid; }
         void SetLootGuid(ObjectGuid const& guid) { m_lootGuid = guid; }
 
@@ -1965,8 +2077,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         float GetTransOffsetO() const { return m_movementInfo.GetTransportPos()->o; }
         uint32 GetTransTime() const { return m_movementInfo.GetTransportTime(); }
 
-        uint32 GetSaveTimer() const { return m_nextSave; }
-        void   SetSaveTimer(uint32 timer) { m_nextSave = timer; }
+        uint32 GetSaveTimer() const { return m_updateTimers.GetTimeLeft(PLAYER_TIMER_SAVE); }
+        void   SetSaveTimer(uint32 timer) { m_updateTimers.Schedule(PLAYER_TIMER_SAVE, timer); }
 
         // Recall position
         uint32 m_recallMap;
@@ -1983,9 +2095,14 @@ class MANGOS_DLL_SPEC Player : public Unit
         Object* GetObjectByTypeMask(ObjectGuid guid, TypeMask typemask);
 
         // currently visible objects at player client
-        GuidSet m_clientGUIDs;
+        GuidHashSet m_clientGUIDs;
+
+        bool HaveAtClient(WorldObject const* u) { return u == this || m_clientGUIDs.contains(u->GetObjectGuid()); }
 
-        bool HaveAtClient(WorldObject const* u) { return u == this || m_clientGUIDs.find(u->GetObjectGuid()) != m_clientGUIDs.end(); }
+        // objects gone out of view this tick, sent as one out of range block by Map::SendObjectUpdates
+        bool HasPendingOutOfRange() const { return !m_pendingOutOfRangeGUIDs.empty(); }
+        void AddPendingOutOfRange(ObjectGuid const& guid) { m_pendingOutOfRangeGUIDs.push_back(guid); }
+        void FlushPendingOutOfRange(UpdateData& data);
 
         bool IsVisibleInGridForPlayer(Player* pl) const override;
         bool IsVisibleGloballyFor(Player* pl) const;
@@ -1993,7 +2110,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         void UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* target);
 
         template<class T>
-        void UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateData& data, std::set<WorldObject*>& visibleNow);
+        void UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateData& data, WorldObjectTickSet& visibleNow);
 
         // Stealth detection system
         void HandleStealthedUnitsDetection();
@@ -2113,7 +2230,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         void _LoadInventory(QueryResult* result, uint32 timediff);
         void _LoadItemLoot(QueryResult* result);
         void _LoadMails(QueryResult* result);
-        void _LoadMailedItems(QueryResult* result);
+        void _LoadMailItemInfos(QueryResult* result);
         void _LoadQuestStatus(QueryResult* result);
         void _LoadGroup(QueryResult* result);
         void _LoadSkills(QueryResult* result);
@@ -2148,6 +2265,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         void SendMirrorTimer(MirrorTimerType Type, uint32 MaxValue, uint32 CurrentValue, int32 Regen);
         void StopMirrorTimer(MirrorTimerType Type);
         void HandleDrowning(uint32 time_diff);
+        void UpdateDueTimers();
         int32 getMaxTimer(MirrorTimerType timer);
 
         /*********************************************************/
@@ -2166,7 +2284,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         ObjectGuid m_lootGuid;
 
         Team m_team;
-        uint32 m_nextSave;
+        PlayerUpdateTimers m_updateTimers;
         time_t m_speakTime;
         uint32 m_speakCount;
         uint32 m_atLoginFlags;
@@ -2184,6 +2302,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         int8 m_comboPoints;
 
         QuestStatusMap mQuestStatus;
+        QuestGiverStatusCache m_questGiverStatus;
+        long m_questGiverStatusGeneration;                  // of InvalidateAllQuestGiverStatus when the cache was filled
 
         SkillStatusMap mSkillStatus;
 
@@ -2192,6 +2312,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         PlayerMails m_mail;
         PlayerSpellMap m_spells;
         SpellCooldowns m_spellCooldowns;
+        bool m_spellCooldownsChanged;                       // m_spellCooldowns differ from the last saved state
 
         GlobalCooldownMgr m_GlobalCooldownMgr;
 
@@ -2200,6 +2321,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         float m_auraBaseMod[BASEMOD_END][MOD_END];
 
         SpellModList m_spellMods[MAX_SPELLMOD];
+        SpellModList m_chargedSpellMods[MAX_SPELLMOD];      // the mods of m_spellMods with charges
+        SpellModTotalsMap m_spellModTotals[MAX_SPELLMOD];   // by spell id, of the mods without charges
         int32 m_SpellModRemoveCount;
         EnchantDurationList m_enchantDuration;
         ItemDurationList m_itemDuration;
@@ -2223,7 +2346,6 @@ class MANGOS_DLL_SPEC Player : public Unit
         uint32 m_weaponChangeTimer;
 
         uint32 m_zoneUpdateId;
-        uint32 m_zoneUpdateTimer;
         uint32 m_areaUpdateId;
         uint32 m_positionStatusUpdateTimer;
 
@@ -2238,6 +2360,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         bool m_canBlock;
         bool m_canDualWield;
         uint8 m_swingErrorMsg;
+        uint32 m_pendingDerivedStats;                       // PlayerDerivedStats, see UpdateStats
         float m_ammoDPS;
 
         //////////////////// Rest System/////////////////////
@@ -2314,6 +2437,9 @@ class MANGOS_DLL_SPEC Player : public Unit
         GridReference<Player> m_gridRef;
         MapReference m_mapRef;
 
+        GuidVector m_pendingOutOfRangeGUIDs;
+        void SendPendingOutOfRangeBeforeCreate(ObjectGuid const& guid);
+
         // Homebind coordinates
         uint32 m_homebindMapId;
         uint16 m_homebindAreaId;
@@ -2342,8 +2468,6 @@ class MANGOS_DLL_SPEC Player : public Unit
         bool m_bHasDelayedTeleport;
         bool m_bHasBeenAliveAtDelayedTeleport;
 
-        uint32 m_DetectInvTimer;
-
         // Temporary removed pet cache
         uint32 m_temporaryUnsummonedPetNumber;
 
@@ -2358,9 +2482,23 @@ template <class T> T Player::ApplySpellMod(uint32 spellId, SpellModOp op, T& bas
 {
     SpellEntry const* spellInfo = sSpellStore.LookupEntry(spellId);
     if (!spellInfo) { return 0; }
+
+    SpellModTotals totals = GetSpellModTotals(spellInfo, op);
     int32 totalpct = 0;
-    int32 totalflat = 0;
-    for (SpellModList::iterator itr = m_spellMods[op].begin(); itr != m_spellMods[op].end(); ++itr)
+    int32 totalflat = totals.flat;
+
+    // skip percent mods for null basevalue
+    if (basevalue != T(0))
+    {
+        totalpct = totals.pct;
+
+        // special case (skip >10sec spell casts for instant cast setting)
+        if (op == SPELLMOD_CASTING_TIME && basevalue >= T(10 * IN_MILLISECONDS))
+            { totalpct -= totals.instantCastPct; }
+    }
+
+    // the few mods with charges are checked one by one, their charges are used up
+    for (SpellModList::iterator itr = m_chargedSpellMods[op].begin(); itr != m_chargedSpellMods[op].end(); ++itr)
     {
         SpellModifier* mod = *itr;
 
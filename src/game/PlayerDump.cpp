@@ -29,6 +29,7 @@
 #include "UpdateFields.h"
 #include "ObjectMgr.h"
 #include "AccountMgr.h"
+#include "Database/SqlBatch.h"
 
 // Character Dump tables
 struct DumpTable
@@ -261,41 +262,151 @@ std::string PlayerDumpWriter::GenerateWhereStr(char const* field, GUIDs const& g
     return wherestr.str();
 }
 
-void StoreGUID(QueryResult* result, uint32 field, std::set<uint32>& guids)
+void StoreGUID(Field* fields, uint32 field, std::set<uint32>& guids)
 {
-    Field* fields = result->Fetch();
     uint32 guid = fields[field].GetUInt32();
     if (guid)
         { guids.insert(guid); }
 }
 
-void StoreGUID(QueryResult* result, uint32 data, uint32 field, std::set<uint32>& guids)
+void StoreGUID(Field* fields, uint32 data, uint32 field, std::set<uint32>& guids)
 {
-    Field* fields = result->Fetch();
     std::string dataStr = fields[data].GetCppString();
     uint32 guid = atoi(gettoknth(dataStr, field).c_str());
     if (guid)
         { guids.insert(guid); }
 }
 
+/**
+ * @brief the required_ column of character_db_version
+ *
+ * @param reqName empty if the table has none
+ * @return bool false if the table is missing
+ */
+static bool GetRevisionGuardField(std::string& reqName)
+{
+    QueryNamedResult* result = CharacterDatabase.QueryNamed("SELECT * FROM character_db_version LIMIT 1");
+    if (!result)
+        { return false; }
+
+    QueryFieldNames const& namesMap = result->GetFieldNames();
+    for (QueryFieldNames::const_iterator itr = namesMap.begin(); itr != namesMap.end(); ++itr)
+    {
+        if (itr->substr(0, 9) == "required_")
+        {
+            reqName = *itr;
+            break;
+        }
+    }
+
+    delete result;
+    return true;
+}
+
+// Binary dump format: header, then per query result of a table its index in dumpTables, column names and rows
+#define BINARY_DUMP_MAGIC       0x424D4450                  // "PDMB" in little endian order of ByteBuffer
+#define BINARY_DUMP_VERSION     1
+#define BINARY_DUMP_END         0xFF                        // instead of a table index after the last rows
+
+/// Tag in front of every value of a binary dump row
+enum BinaryDumpValueTag
+{
+    BINARY_DUMP_NULL    = 0,
+    BINARY_DUMP_INT     = 1,                                // int64
+    BINARY_DUMP_UINT    = 2,                                // uint64
+    BINARY_DUMP_DOUBLE  = 3,                                // double
+    BINARY_DUMP_STRING  = 4                                 // uint32 length and the bytes
+};
+
+static void AppendDumpString(ByteBuffer& dump, std::string const& value)
+{
+    dump << uint32(value.size());
+    dump.append(value);
+}
+
+static void ReadDumpString(ByteBuffer& dump, std::string& value)
+{
+    uint32 length;
+    dump >> length;
+
+    size_t pos = dump.rpos();
+    dump.read_skip(length);                                 // throws before reading past the end
+    value.assign(reinterpret_cast<char const*>(dump.contents()) + pos, length);
+}
+
+static void AppendDumpValue(ByteBuffer& dump, Field const& field)
+{
+    if (field.IsNULL())
+    {
+        dump << uint8(BINARY_DUMP_NULL);
+        return;
+    }
+
+    switch (field.GetType())
+    {
+        case Field::DB_TYPE_INTEGER:
+        case Field::DB_TYPE_BOOL:
+        {
+            char const* text = field.GetString();
+            if (text && *text == '-')
+                { dump << uint8(BINARY_DUMP_INT) << int64(field.GetInt64()); }
+            else
+                { dump << uint8(BINARY_DUMP_UINT) << uint64(field.GetUInt64()); }
+            break;
+        }
+        case Field::DB_TYPE_FLOAT:
+            dump << uint8(BINARY_DUMP_DOUBLE) << double(field.GetDouble());
+            break;
+        default:
+            dump << uint8(BINARY_DUMP_STRING);
+            AppendDumpString(dump, field.GetCppString());
+            break;
+    }
+}
+
 // Writing - High-level functions
-void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char const* tableFrom, char const* tableTo, DumpTableType type)
+char const* PlayerDumpWriter::GetKeyField(DumpTableType type, GUIDs const*& guids) const
 {
-    GUIDs const* guids = NULL;
-    char const* fieldname = NULL;
+    guids = NULL;
 
     switch (type)
     {
-        case DTT_ITEM:      fieldname = "guid";      guids = &items; break;
-        case DTT_ITEM_GIFT: fieldname = "item_guid"; guids = &items; break;
-        case DTT_ITEM_LOOT: fieldname = "guid";      guids = &items; break;
-        case DTT_PET:       fieldname = "owner";                     break;
-        case DTT_PET_TABLE: fieldname = "guid";      guids = &pets;  break;
-        case DTT_MAIL:      fieldname = "receiver";                  break;
-        case DTT_MAIL_ITEM: fieldname = "mail_id";   guids = &mails; break;
-        case DTT_ITEM_TEXT: fieldname = "id";        guids = &texts; break;
-        default:            fieldname = "guid";                      break;
+        case DTT_ITEM:      guids = &items; return "guid";
+        case DTT_ITEM_GIFT: guids = &items; return "item_guid";
+        case DTT_ITEM_LOOT: guids = &items; return "guid";
+        case DTT_PET:                       return "owner";
+        case DTT_PET_TABLE: guids = &pets;  return "guid";
+        case DTT_MAIL:                      return "receiver";
+        case DTT_MAIL_ITEM: guids = &mails; return "mail_id";
+        case DTT_ITEM_TEXT: guids = &texts; return "id";
+        default:                            return "guid";
     }
+}
+
+void PlayerDumpWriter::CollectGUIDs(Field* fields, DumpTableType type)
+{
+    switch (type)
+    {
+        case DTT_INVENTORY:
+            StoreGUID(fields, 3, items); break;             // item guid collection
+        case DTT_ITEM:
+            StoreGUID(fields, 0, ITEM_FIELD_ITEM_TEXT_ID, texts); break;
+            // item text id collection
+        case DTT_PET:
+            StoreGUID(fields, 0, pets);  break;             // pet petnumber collection (character_pet.id)
+        case DTT_MAIL:
+            StoreGUID(fields, 0, mails);                    // mail id collection (mail.id)
+            StoreGUID(fields, 7, texts); break;             // item text id collection
+        case DTT_MAIL_ITEM:
+            StoreGUID(fields, 1, items); break;             // item guid collection (mail_items.item_guid)
+        default:                       break;
+    }
+}
+
+void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char const* tableFrom, char const* tableTo, DumpTableType type)
+{
+    GUIDs const* guids;
+    char const* fieldname = GetKeyField(type, guids);
 
     // for guid set stop if set is empty
     if (guids && guids->empty())
@@ -321,23 +432,7 @@ void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char con
 
         do
         {
-            // collect guids
-            switch (type)
-            {
-                case DTT_INVENTORY:
-                    StoreGUID(result, 3, items); break;     // item guid collection
-                case DTT_ITEM:
-                    StoreGUID(result, 0, ITEM_FIELD_ITEM_TEXT_ID, texts); break;
-                    // item text id collection
-                case DTT_PET:
-                    StoreGUID(result, 0, pets);  break;     // pet petnumber collection (character_pet.id)
-                case DTT_MAIL:
-                    StoreGUID(result, 0, mails);            // mail id collection (mail.id)
-                    StoreGUID(result, 7, texts); break;     // item text id collection
-                case DTT_MAIL_ITEM:
-                    StoreGUID(result, 1, items); break;     // item guid collection (mail_items.item_guid)
-                default:                       break;
-            }
+            CollectGUIDs(result->Fetch(), type);
 
             dump += CreateDumpString(tableTo, result);
             dump += "\n";
@@ -349,6 +444,51 @@ void PlayerDumpWriter::DumpTableContent(std::string& dump, uint32 guid, char con
     while (guids && guids_itr != guids->end());             // not set case iterate single time, set case iterate for all guids
 }
 
+void PlayerDumpWriter::DumpTableContent(ByteBuffer& dump, uint32 guid, uint8 tableIndex)
+{
+    DumpTable const& table = dumpTables[tableIndex];
+
+    GUIDs const* guids;
+    char const* fieldname = GetKeyField(table.type, guids);
+
+    if (guids && guids->empty())
+        { return; }
+
+    GUIDs::const_iterator guids_itr;
+    if (guids)
+        { guids_itr = guids->begin(); }
+
+    do
+    {
+        std::string wherestr = guids ? GenerateWhereStr(fieldname, *guids, guids_itr) : GenerateWhereStr(fieldname, guid);
+
+        QueryNamedResult* result = CharacterDatabase.PQueryNamed("SELECT * FROM %s WHERE %s", table.name, wherestr.c_str());
+        if (!result)
+            { return; }
+
+        QueryFieldNames const& names = result->GetFieldNames();
+
+        dump << uint8(tableIndex);
+        dump << uint16(names.size());
+        for (QueryFieldNames::const_iterator itr = names.begin(); itr != names.end(); ++itr)
+            { AppendDumpString(dump, *itr); }
+        dump << uint32(result->GetRowCount());
+
+        do
+        {
+            Field* fields = result->Fetch();
+            CollectGUIDs(fields, table.type);
+
+            for (uint32 i = 0; i < result->GetFieldCount(); ++i)
+                { AppendDumpValue(dump, fields[i]); }
+        }
+        while (result->NextRow());
+
+        delete result;
+    }
+    while (guids && guids_itr != guids->end());
+}
+
 std::string PlayerDumpWriter::GetDump(uint32 guid)
 {
     std::string dump;
@@ -357,20 +497,9 @@ std::string PlayerDumpWriter::GetDump(uint32 guid)
     dump += "IMPORTANT NOTE: NOT APPLY ITS DIRECTLY to character DB or you will DAMAGE and CORRUPT character DB\n\n";
 
     // revision check guard
-    QueryNamedResult* result = CharacterDatabase.QueryNamed("SELECT * FROM character_db_version LIMIT 1");
-    if (result)
+    std::string reqName;
+    if (GetRevisionGuardField(reqName))
     {
-        QueryFieldNames const& namesMap = result->GetFieldNames();
-        std::string reqName;
-        for (QueryFieldNames::const_iterator itr = namesMap.begin(); itr != namesMap.end(); ++itr)
-        {
-            if (itr->substr(0, 9) == "required_")
-            {
-                reqName = *itr;
-                break;
-            }
-        }
-
         if (!reqName.empty())
         {
             // this will fail at wrong character DB version
@@ -378,8 +507,6 @@ std::string PlayerDumpWriter::GetDump(uint32 guid)
         }
         else
             { sLog.outError("Table 'character_db_version' not have revision guard field, revision guard query not added to pdump."); }
-
-        delete result;
     }
     else
         { sLog.outError("Character DB not have 'character_db_version' table, revision guard query not added to pdump."); }
@@ -393,8 +520,39 @@ std::string PlayerDumpWriter::GetDump(uint32 guid)
     return dump;
 }
 
-DumpReturn PlayerDumpWriter::WriteDump(const std::string& file, uint32 guid)
+void PlayerDumpWriter::GetBinaryDump(uint32 guid, ByteBuffer& dump)
+{
+    dump << uint32(BINARY_DUMP_MAGIC);
+    dump << uint32(BINARY_DUMP_VERSION);
+
+    // the reader checks the character DB has this column, empty for no check
+    std::string reqName;
+    if (!GetRevisionGuardField(reqName) || reqName.empty())
+        { sLog.outError("Character DB not have 'character_db_version' table or revision guard field, revision guard not added to pdump."); }
+    AppendDumpString(dump, reqName);
+
+    for (uint8 i = 0; dumpTables[i].isValid(); ++i)
+        { DumpTableContent(dump, guid, i); }
+
+    dump << uint8(BINARY_DUMP_END);
+}
+
+DumpReturn PlayerDumpWriter::WriteDump(const std::string& file, uint32 guid, bool binary /*= false*/)
 {
+    if (binary)
+    {
+        FILE* fout = fopen(file.c_str(), "wb");
+        if (!fout)
+            { return DUMP_FILE_OPEN_ERROR; }
+
+        ByteBuffer dump;
+        GetBinaryDump(guid, dump);
+
+        bool written = fwrite(dump.contents(), dump.size(), 1, fout) == 1;
+        fclose(fout);
+        return written ? DUMP_SUCCESS : DUMP_FILE_OPEN_ERROR;
+    }
+
     FILE* fout = fopen(file.c_str(), "w");
     if (!fout)
         { return DUMP_FILE_OPEN_ERROR; }
@@ -409,19 +567,9 @@ DumpReturn PlayerDumpWriter::WriteDump(const std::string& file, uint32 guid)
 // Reading - High-level functions
 #define ROLLBACK(DR) {CharacterDatabase.RollbackTransaction(); fclose(fin); return (DR);}
 
-DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid)
+bool PlayerDumpReader::PrepareCharacter(std::string& name, uint32& guid)
 {
-    // check character count
-    uint32 charcount = sAccountMgr.GetCharactersCount(account);
-    if (charcount >= 10)
-        { return DUMP_TOO_MANY_CHARS; }
-
-    FILE* fin = fopen(file.c_str(), "r");
-    if (!fin)
-        { return DUMP_FILE_OPEN_ERROR; }
-
     QueryResult* result = NULL;
-    char newguid[20], chraccount[20], newpetid[20], currpetid[20], lastpetid[20];
 
     // make sure the same guid doesn't already exist and is safe to use
     bool incHighest = true;
@@ -455,6 +603,59 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
     else
         { name = ""; }
 
+    return incHighest;
+}
+
+void PlayerDumpReader::SetNextGuids(GuidMap const& items, GuidMap const& mails, GuidMap const& itemTexts, bool incHighest)
+{
+    // FIXME: current code with post-updating guids not safe for future per-map threads
+    sObjectMgr.m_ItemGuids.Set(sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed() + items.size());
+    sObjectMgr.m_MailIds.Set(sObjectMgr.m_MailIds.GetNextAfterMaxUsed() +  mails.size());
+    sObjectMgr.m_ItemTextIds.Set(sObjectMgr.m_ItemTextIds.GetNextAfterMaxUsed() + itemTexts.size());
+
+    if (incHighest)
+        { sObjectMgr.m_CharGuids.Set(sObjectMgr.m_CharGuids.GetNextAfterMaxUsed() + 1); }
+}
+
+DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid)
+{
+    // check character count
+    uint32 charcount = sAccountMgr.GetCharactersCount(account);
+    if (charcount >= 10)
+        { return DUMP_TOO_MANY_CHARS; }
+
+    FILE* fin = fopen(file.c_str(), "rb");
+    if (!fin)
+        { return DUMP_FILE_OPEN_ERROR; }
+
+    char magic[4];
+    if (fread(magic, sizeof(magic), 1, fin) == 1 && memcmp(magic, "PDMB", sizeof(magic)) == 0)
+    {
+        ByteBuffer dump;
+        char chunk[16384];
+        while (size_t count = fread(chunk, 1, sizeof(chunk), fin))
+            { dump.append(chunk, count); }
+
+        bool readError = ferror(fin) != 0;
+        fclose(fin);
+        if (readError)
+            { return DUMP_FILE_BROKEN; }
+
+        dump.read_skip<uint32>();                           // magic
+        return LoadBinaryDump(dump, account, name, guid);
+    }
+
+    // text dump, read line by line from the start
+    fclose(fin);
+    fin = fopen(file.c_str(), "r");
+    if (!fin)
+        { return DUMP_FILE_OPEN_ERROR; }
+
+    QueryResult* result = NULL;
+    char newguid[20], chraccount[20], newpetid[20], currpetid[20], lastpetid[20];
+
+    bool incHighest = PrepareCharacter(name, guid);
+
     // name encoded or empty
 
     snprintf(newguid, 20, "%u", guid);
@@ -696,15 +897,344 @@ DumpReturn PlayerDumpReader::LoadDump(const std::string& file, uint32 account, s
 
     CharacterDatabase.CommitTransaction();
 
-    // FIXME: current code with post-updating guids not safe for future per-map threads
-    sObjectMgr.m_ItemGuids.Set(sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed() + items.size());
-    sObjectMgr.m_MailIds.Set(sObjectMgr.m_MailIds.GetNextAfterMaxUsed() +  mails.size());
-    sObjectMgr.m_ItemTextIds.Set(sObjectMgr.m_ItemTextIds.GetNextAfterMaxUsed() + itemTexts.size());
-
-    if (incHighest)
-        { sObjectMgr.m_CharGuids.Set(sObjectMgr.m_CharGuids.GetNextAfterMaxUsed() + 1); }
+    SetNextGuids(items, mails, itemTexts, incHighest);
 
     fclose(fin);
 
     return DUMP_SUCCESS;
 }
+
+/// Value of a binary dump row
+struct BinaryDumpValue
+{
+    BinaryDumpValue() : tag(BINARY_DUMP_NULL) { number.ui64 = 0; }
+
+    uint32 GetUInt32() const
+    {
+        switch (tag)
+        {
+            case BINARY_DUMP_INT:    return uint32(number.i64);
+            case BINARY_DUMP_UINT:   return uint32(number.ui64);
+            case BINARY_DUMP_DOUBLE: return uint32(number.d);
+            case BINARY_DUMP_STRING: return uint32(atol(text.c_str()));
+            default:                 return 0;
+        }
+    }
+
+    void SetUInt32(uint32 value)
+    {
+        tag = BINARY_DUMP_UINT;
+        number.ui64 = value;
+        text.clear();
+    }
+
+    void SetString(std::string const& value)
+    {
+        tag = BINARY_DUMP_STRING;
+        text = value;
+    }
+
+    uint8 tag;
+    Field::NumericValue number;
+    std::string text;
+};
+
+typedef std::vector<BinaryDumpValue> BinaryDumpRow;
+
+static void ReadDumpValue(ByteBuffer& dump, BinaryDumpValue& value)
+{
+    dump >> value.tag;
+
+    switch (value.tag)
+    {
+        case BINARY_DUMP_NULL:                              break;
+        case BINARY_DUMP_INT:    dump >> value.number.i64;  break;
+        case BINARY_DUMP_UINT:   dump >> value.number.ui64; break;
+        case BINARY_DUMP_DOUBLE: dump >> value.number.d;    break;
+        case BINARY_DUMP_STRING: ReadDumpString(dump, value.text); break;
+        default:
+            throw ByteBufferException(false, dump.rpos(), 0, dump.size());
+    }
+}
+
+static void AddDumpValue(SqlInsertBatch& batch, BinaryDumpValue const& value)
+{
+    switch (value.tag)
+    {
+        case BINARY_DUMP_INT:    batch.addInt64(value.number.i64);   break;
+        case BINARY_DUMP_UINT:   batch.addUInt64(value.number.ui64); break;
+        case BINARY_DUMP_DOUBLE: batch.addDouble(value.number.d);    break;
+        case BINARY_DUMP_STRING: batch.addString(value.text);        break;
+        default:                 batch.addNull();                    break;
+    }
+}
+
+/**
+ * @brief index of a column of the dumped table
+ *
+ * @param names
+ * @param name
+ * @return int -1 if the dump has no such column
+ */
+static int FindDumpColumn(QueryFieldNames const& names, char const* name)
+{
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        if (names[i] == name)
+            { return int(i); }
+    }
+
+    return -1;
+}
+
+/// replaces an old guid of the dump by the new one of the same old guid
+static void ChangeDumpGuid(BinaryDumpValue& value, std::map<uint32, uint32>& guidMap, uint32 hiGuid, bool nonzero = false)
+{
+    uint32 oldGuid = value.GetUInt32();
+    if (nonzero && oldGuid == 0)
+        { return; }
+
+    value.SetUInt32(registerNewGuid(oldGuid, guidMap, hiGuid));
+}
+
+#define BINARY_ROLLBACK(DR) { CharacterDatabase.RollbackTransaction(); return (DR); }
+
+DumpReturn PlayerDumpReader::LoadBinaryDump(ByteBuffer& dump, uint32 account, std::string name, uint32 guid)
+{
+    bool incHighest = true;
+
+    GuidMap items;
+    GuidMap mails;
+    GuidMap itemTexts;
+    GuidMap petIds;
+
+    bool inTransaction = false;
+
+    size_t tableCount = 0;
+    while (dumpTables[tableCount].isValid())
+        { ++tableCount; }
+
+    try
+    {
+        uint32 version;
+        dump >> version;
+        if (version != BINARY_DUMP_VERSION)
+        {
+            sLog.outError("LoadPlayerDump: binary dump version %u is not supported!", version);
+            return DUMP_FILE_BROKEN;
+        }
+
+        // fails at a character DB without the required_ column of the dump
+        std::string reqName;
+        ReadDumpString(dump, reqName);
+        if (!reqName.empty())
+        {
+            if (reqName.find_first_not_of("abcdefghijklmnopqrstuvwxyz0123456789_") != std::string::npos)
+                { return DUMP_FILE_BROKEN; }
+
+            QueryResult* result = CharacterDatabase.PQuery("SELECT %s FROM character_db_version LIMIT 1", reqName.c_str());
+            if (!result)
+                { return DUMP_FILE_BROKEN; }
+            delete result;
+        }
+
+        incHighest = PrepareCharacter(name, guid);
+
+        CharacterDatabase.BeginTransaction();
+        inTransaction = true;
+
+        for (;;)
+        {
+            uint8 tableIndex;
+            dump >> tableIndex;
+            if (tableIndex == BINARY_DUMP_END)
+                { break; }
+
+            if (tableIndex >= tableCount)
+            {
+                sLog.outError("LoadPlayerDump: Unknown table index %u!", tableIndex);
+                BINARY_ROLLBACK(DUMP_FILE_BROKEN);
+            }
+
+            DumpTable const& table = dumpTables[tableIndex];
+
+            uint16 fieldCount;
+            dump >> fieldCount;
+
+            QueryFieldNames names(fieldCount);
+            std::string columns;
+            for (uint16 i = 0; i < fieldCount; ++i)
+            {
+                ReadDumpString(dump, names[i]);
+                if (names[i].empty() || names[i].find_first_of("`\"") != std::string::npos)
+                    { BINARY_ROLLBACK(DUMP_FILE_BROKEN); }
+
+                if (i)
+                    { columns += ','; }
+                columns += std::string(_TABLE_SIM_) + names[i] + _TABLE_SIM_;
+            }
+
+            // the columns changed to server values
+            int guidCol = FindDumpColumn(names, table.type == DTT_PET || table.type == DTT_MAIL ? "id" : (table.type == DTT_MAIL_ITEM ? "mail_id" : "guid"));
+            int ownerCol = -1;
+            int itemCol = -1;
+            int textCol = -1;
+            switch (table.type)
+            {
+                case DTT_CHARACTER:  ownerCol = FindDumpColumn(names, "account"); textCol = FindDumpColumn(names, "name"); itemCol = FindDumpColumn(names, "at_login"); break;
+                case DTT_INVENTORY:  ownerCol = FindDumpColumn(names, "bag"); itemCol = FindDumpColumn(names, "item"); break;
+                case DTT_ITEM:       ownerCol = FindDumpColumn(names, "owner_guid"); textCol = FindDumpColumn(names, "data"); break;
+                case DTT_ITEM_GIFT:  itemCol = FindDumpColumn(names, "item_guid"); break;
+                case DTT_ITEM_LOOT:  ownerCol = FindDumpColumn(names, "owner_guid"); break;
+                case DTT_PET:        ownerCol = FindDumpColumn(names, "owner"); break;
+                case DTT_MAIL:       ownerCol = FindDumpColumn(names, "receiver"); textCol = FindDumpColumn(names, "itemTextId"); break;
+                case DTT_MAIL_ITEM:  ownerCol = FindDumpColumn(names, "receiver"); itemCol = FindDumpColumn(names, "item_guid"); break;
+                case DTT_ITEM_TEXT:  textCol = FindDumpColumn(names, "text"); break;
+                default:                                     break;
+            }
+
+            bool missingColumn = guidCol < 0;
+            switch (table.type)
+            {
+                case DTT_CHARACTER:  missingColumn = missingColumn || ownerCol < 0 || textCol < 0 || itemCol < 0; break;
+                case DTT_INVENTORY:
+                case DTT_MAIL_ITEM:  missingColumn = missingColumn || ownerCol < 0 || itemCol < 0; break;
+                case DTT_ITEM:
+                case DTT_MAIL:       missingColumn = missingColumn || ownerCol < 0 || textCol < 0; break;
+                case DTT_ITEM_GIFT:  missingColumn = missingColumn || itemCol < 0; break;
+                case DTT_ITEM_LOOT:
+                case DTT_PET:        missingColumn = missingColumn || ownerCol < 0; break;
+                case DTT_ITEM_TEXT:  missingColumn = missingColumn || textCol < 0; break;
+                default:                                     break;
+            }
+
+            if (missingColumn)
+            {
+                sLog.outError("LoadPlayerDump: Table '%s' of the dump misses a guid column!", table.name);
+                BINARY_ROLLBACK(DUMP_FILE_BROKEN);
+            }
+
+            uint32 rowCount;
+            dump >> rowCount;
+
+            SqlInsertBatch batch(CharacterDatabase, table.name, columns.c_str());
+            BinaryDumpRow row(fieldCount);
+
+            for (uint32 r = 0; r < rowCount; ++r)
+            {
+                for (uint16 i = 0; i < fieldCount; ++i)
+                    { ReadDumpValue(dump, row[i]); }
+
+                // change the data to server values
+                switch (table.type)
+                {
+                    case DTT_CHAR_TABLE:
+                        row[guidCol].SetUInt32(guid);               // character_*.guid
+                        break;
+                    case DTT_CHARACTER:
+                    {
+                        row[guidCol].SetUInt32(guid);
+                        row[ownerCol].SetUInt32(account);
+
+                        if (name.empty())
+                        {
+                            // check if the original name already exists
+                            std::string dumpName = row[textCol].text;
+                            CharacterDatabase.escape_string(dumpName);
+
+                            if (QueryResult* result = CharacterDatabase.PQuery("SELECT * FROM characters WHERE name = '%s'", dumpName.c_str()))
+                            {
+                                delete result;
+                                row[itemCol].SetUInt32(row[itemCol].GetUInt32() | AT_LOGIN_RENAME);
+                            }
+                        }
+                        else
+                            { row[textCol].SetString(name); }
+                        break;
+                    }
+                    case DTT_INVENTORY:
+                        row[guidCol].SetUInt32(guid);
+                        ChangeDumpGuid(row[ownerCol], items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed(), true);   // bag
+                        ChangeDumpGuid(row[itemCol], items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed());
+                        break;
+                    case DTT_ITEM:
+                    {
+                        ChangeDumpGuid(row[guidCol], items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed());
+                        row[ownerCol].SetUInt32(guid);
+
+                        // the update fields of the item also hold its guid, the owner and the item text
+                        char newguid[20];
+                        snprintf(newguid, 20, "%u", guid);
+                        std::string vals = row[textCol].text;
+                        if (!changetokGuid(vals, OBJECT_FIELD_GUID + 1, items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed()) ||
+                            !changetoknth(vals, ITEM_FIELD_OWNER + 1, newguid) ||
+                            !changetokGuid(vals, ITEM_FIELD_ITEM_TEXT_ID + 1, itemTexts, sObjectMgr.m_ItemTextIds.GetNextAfterMaxUsed(), true))
+                            { BINARY_ROLLBACK(DUMP_FILE_BROKEN); }
+                        row[textCol].SetString(vals);
+                        break;
+                    }
+                    case DTT_ITEM_GIFT:
+                        row[guidCol].SetUInt32(guid);
+                        ChangeDumpGuid(row[itemCol], items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed());
+                        break;
+                    case DTT_ITEM_LOOT:
+                        ChangeDumpGuid(row[guidCol], items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed());
+                        row[ownerCol].SetUInt32(guid);
+                        break;
+                    case DTT_PET:
+                    {
+                        uint32 oldPetId = row[guidCol].GetUInt32();
+                        GuidMap::const_iterator itr = petIds.find(oldPetId);
+                        uint32 newPetId = itr != petIds.end() ? itr->second : sObjectMgr.GeneratePetNumber();
+                        petIds[oldPetId] = newPetId;
+
+                        row[guidCol].SetUInt32(newPetId);
+                        row[ownerCol].SetUInt32(guid);
+                        break;
+                    }
+                    case DTT_PET_TABLE:                             // pet_*.guid -> petid in fact
+                    {
+                        GuidMap::const_iterator itr = petIds.find(row[guidCol].GetUInt32());
+                        if (itr == petIds.end())
+                            { BINARY_ROLLBACK(DUMP_FILE_BROKEN); }
+                        row[guidCol].SetUInt32(itr->second);
+                        break;
+                    }
+                    case DTT_MAIL:
+                        ChangeDumpGuid(row[guidCol], mails, sObjectMgr.m_MailIds.GetNextAfterMaxUsed());
+                        row[ownerCol].SetUInt32(guid);
+                        ChangeDumpGuid(row[textCol], itemTexts, sObjectMgr.m_ItemTextIds.GetNextAfterMaxUsed(), true);
+                        break;
+                    case DTT_MAIL_ITEM:
+                        ChangeDumpGuid(row[guidCol], mails, sObjectMgr.m_MailIds.GetNextAfterMaxUsed());
+                        ChangeDumpGuid(row[itemCol], items, sObjectMgr.m_ItemGuids.GetNextAfterMaxUsed());
+                        row[ownerCol].SetUInt32(guid);
+                        break;
+                    case DTT_ITEM_TEXT:
+                        ChangeDumpGuid(row[guidCol], itemTexts, sObjectMgr.m_ItemTextIds.GetNextAfterMaxUsed());
+                        sObjectMgr.AddItemText(row[guidCol].GetUInt32(), row[textCol].text);
+                        break;
+                }
+
+                batch.NewRow();
+                for (uint16 i = 0; i < fieldCount; ++i)
+                    { AddDumpValue(batch, row[i]); }
+            }
+
+            batch.Execute();
+        }
+    }
+    catch (ByteBufferException&)
+    {
+        // the transaction is started after the header
+        if (inTransaction)
+            { CharacterDatabase.RollbackTransaction(); }
+        return DUMP_UNEXPECTED_END;
+    }
+
+    CharacterDatabase.CommitTransaction();
+
+    SetNextGuids(items, mails, itemTexts, incHighest);
+
+    return DUMP_SUCCESS;
+}
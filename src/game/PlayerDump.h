@@ -28,6 +28,10 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
+
+class ByteBuffer;
+class Field;
 
 enum DumpTableType
 {
@@ -78,12 +82,31 @@ class PlayerDumpWriter : public PlayerDump
     public:
         PlayerDumpWriter() {}
 
+        /**
+         * @brief the dump holds the rows of the character in the database, not the Player in memory
+         *
+         * The dump of an online character misses its changes since the last save. Player::SaveToDB
+         * commits asynchronously, so saving right before the dump doesn't help either.
+         *
+         * @param guid
+         * @return std::string
+         */
         std::string GetDump(uint32 guid);
-        DumpReturn WriteDump(const std::string& file, uint32 guid);
+        /**
+         * @brief the rows of GetDump with their column names and binary values, loaded without parsing SQL
+         *
+         * @param guid
+         * @param dump
+         */
+        void GetBinaryDump(uint32 guid, ByteBuffer& dump);
+        DumpReturn WriteDump(const std::string& file, uint32 guid, bool binary = false);
     private:
         typedef std::set<uint32> GUIDs;
 
+        char const* GetKeyField(DumpTableType type, GUIDs const*& guids) const;
+        void CollectGUIDs(Field* fields, DumpTableType type);
         void DumpTableContent(std::string& dump, uint32 guid, char const* tableFrom, char const* tableTo, DumpTableType type);
+        void DumpTableContent(ByteBuffer& dump, uint32 guid, uint8 tableIndex);
         std::string GenerateWhereStr(char const* field, GUIDs const& guids, GUIDs::const_iterator& itr);
         std::string GenerateWhereStr(char const* field, uint32 guid);
 
@@ -98,7 +121,23 @@ class PlayerDumpReader : public PlayerDump
     public:
         PlayerDumpReader() {}
 
+        /**
+         * @brief loads a text or binary dump, the format is told by the start of the file
+         *
+         * @param file
+         * @param account
+         * @param name new name, empty for the name of the dump
+         * @param guid new guid, 0 for the next free one
+         * @return DumpReturn
+         */
         DumpReturn LoadDump(const std::string& file, uint32 account, std::string name, uint32 guid);
+
+    private:
+        typedef std::map<uint32, uint32> GuidMap;           // old->new guid relation
+
+        bool PrepareCharacter(std::string& name, uint32& guid);
+        DumpReturn LoadBinaryDump(ByteBuffer& dump, uint32 account, std::string name, uint32 guid);
+        void SetNextGuids(GuidMap const& items, GuidMap const& mails, GuidMap const& itemTexts, bool incHighest);
 };
 
 #endif
@@ -0,0 +1,97 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "PlayerNameCache.h"
+#include "World.h"
+
+#include <ace/Guard_T.h>
+
+INSTANTIATE_SINGLETON_1(PlayerNameCache);
+
+bool PlayerNameCache::Get(uint32 lowguid, Entry& entry)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
+    EntryMap::iterator itr = m_entries.find(lowguid);
+    if (itr == m_entries.end())
+        { return false; }
+
+    m_usage.splice(m_usage.begin(), m_usage, itr->second.usage);
+    entry = itr->second.entry;
+    return true;
+}
+
+void PlayerNameCache::Add(uint32 lowguid, std::string const& name, uint8 race, uint8 gender, uint8 playerClass)
+{
+    size_t maxSize = sWorld.getConfig(CONFIG_UINT32_PLAYER_NAME_CACHE_SIZE);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_entries.find(lowguid);
+    if (itr != m_entries.end())
+        { m_usage.splice(m_usage.begin(), m_usage, itr->second.usage); }
+    else
+    {
+        if (!maxSize)
+            { return; }
+
+        // the size can be lowered by a config reload, drop more than one then
+        while (m_entries.size() >= maxSize)
+        {
+            m_entries.erase(m_usage.back());
+            m_usage.pop_back();
+        }
+
+        m_usage.push_front(lowguid);
+        itr = m_entries.insert(EntryMap::value_type(lowguid, CachedEntry())).first;
+        itr->second.usage = m_usage.begin();
+    }
+
+    Entry& entry = itr->second.entry;
+    entry.name = name;
+    entry.race = race;
+    entry.gender = gender;
+    entry.playerClass = playerClass;
+}
+
+void PlayerNameCache::Rename(uint32 lowguid, std::string const& name)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_entries.find(lowguid);
+    if (itr != m_entries.end())
+        { itr->second.entry.name = name; }
+}
+
+void PlayerNameCache::Remove(uint32 lowguid)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_entries.find(lowguid);
+    if (itr == m_entries.end())
+        { return; }
+
+    m_usage.erase(itr->second.usage);
+    m_entries.erase(itr);
+}
@@ -0,0 +1,85 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_PLAYERNAMECACHE_H
+#define MANGOS_PLAYERNAMECACHE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Thread_Mutex.h>
+
+#include <list>
+
+/**
+ * Name, race, gender and class of offline characters for the name queries.
+ *
+ * Characters are added at logout and when their name was read from the database, at most
+ * PlayerNameCache.Size of them, the ones not asked for the longest time are dropped first.
+ * Renames update and deletions remove the cached character.
+ */
+class PlayerNameCache
+{
+    public:
+        struct Entry
+        {
+            std::string name;
+            uint8 race;
+            uint8 gender;
+            uint8 playerClass;
+        };
+
+        /**
+         * @brief
+         *
+         * @param lowguid
+         * @param entry filled if cached
+         * @return bool false if the character isn't cached
+         */
+        bool Get(uint32 lowguid, Entry& entry);
+
+        void Add(uint32 lowguid, std::string const& name, uint8 race, uint8 gender, uint8 playerClass);
+        /// sets the new name if the character is cached
+        void Rename(uint32 lowguid, std::string const& name);
+        void Remove(uint32 lowguid);
+
+    private:
+        typedef std::list<uint32> UsageList;                // most recently used first
+
+        struct CachedEntry
+        {
+            Entry entry;
+            UsageList::iterator usage;
+        };
+
+        typedef UNORDERED_MAP<uint32, CachedEntry> EntryMap;
+
+        ACE_Thread_Mutex m_lock;
+        EntryMap m_entries;
+        UsageList m_usage;
+};
+
+#define sPlayerNameCache MaNGOS::Singleton<PlayerNameCache>::Instance()
+
+#endif
@@ -391,8 +391,13 @@ void PoolGroup<Creature>::Spawn1Object(MapPersistentState& mapState, PoolObject*
 
             Map* dataMap = dataMapState->GetMap();
 
+            // instant spawns of a pool or event start are spread over the map updates
+            if (instantly && dataMap && dataMap->IsLoaded(data->posX, data->posY))
+            {
+                dataMap->QueueSpawn(TYPEID_UNIT, obj->guid);
+            }
             // We use spawn coords to spawn
-            if (dataMap && dataMap->IsLoaded(data->posX, data->posY))
+            else if (dataMap && dataMap->IsLoaded(data->posX, data->posY))
             {
                 Creature* pCreature = new Creature;
                 // DEBUG_LOG("Spawning creature %u",obj->guid);
@@ -435,8 +440,13 @@ void PoolGroup<GameObject>::Spawn1Object(MapPersistentState& mapState, PoolObjec
 
             Map* dataMap = dataMapState->GetMap();
 
+            // instant spawns of a pool or event start are spread over the map updates
+            if (instantly && dataMap && dataMap->IsLoaded(data->posX, data->posY))
+            {
+                dataMap->QueueSpawn(TYPEID_GAMEOBJECT, obj->guid);
+            }
             // We use spawn coords to spawn
-            if (dataMap && dataMap->IsLoaded(data->posX, data->posY))
+            else if (dataMap && dataMap->IsLoaded(data->posX, data->posY))
             {
                 GameObject* pGameobject = new GameObject;
                 // DEBUG_LOG("Spawning gameobject %u", obj->guid);
@@ -39,26 +39,40 @@
 #include "Pet.h"
 #include "MapManager.h"
 #include "SQLStorages.h"
+#include "QueryResponseCache.h"
+#include "PlayerNameCache.h"
 
-void WorldSession::SendNameQueryOpcode(Player* p)
+void WorldSession::SendNameQueryResponse(ObjectGuid guid, std::string const& name, uint8 race, uint8 gender, uint8 playerClass)
 {
-    if (!p)
-        { return; }
-
     // guess size
     WorldPacket data(SMSG_NAME_QUERY_RESPONSE, (8 + 1 + 4 + 4 + 4 + 10));
-    data << p->GetObjectGuid();                             // player guid
-    data << p->GetName();                                   // played name
+    data << guid;                                           // player guid
+    data << name;                                           // played name
     data << uint8(0);                                       // realm name for cross realm BG usage
-    data << uint32(p->getRace());
-    data << uint32(p->getGender());
-    data << uint32(p->getClass());
+    data << uint32(race);
+    data << uint32(gender);
+    data << uint32(playerClass);
 
     SendPacket(&data);
 }
 
+void WorldSession::SendNameQueryOpcode(Player* p)
+{
+    if (!p)
+        { return; }
+
+    SendNameQueryResponse(p->GetObjectGuid(), p->GetName(), p->getRace(), p->getGender(), p->getClass());
+}
+
 void WorldSession::SendNameQueryOpcodeFromDB(ObjectGuid guid)
 {
+    PlayerNameCache::Entry entry;
+    if (sPlayerNameCache.Get(guid.GetCounter(), entry))
+    {
+        SendNameQueryResponse(guid, entry.name, entry.race, entry.gender, entry.playerClass);
+        return;
+    }
+
     CharacterDatabase.AsyncPQuery(&WorldSession::SendNameQueryOpcodeFromDBCallBack, GetAccountId(),
                                   //          0     1     2     3       4
                                   "SELECT guid, name, race, gender, class "
@@ -89,18 +103,12 @@ void WorldSession::SendNameQueryOpcodeFromDBCallBack(QueryResult* result, uint32
         pRace        = fields[2].GetUInt8();
         pGender      = fields[3].GetUInt8();
         pClass       = fields[4].GetUInt8();
-    }
 
-    // guess size
-    WorldPacket data(SMSG_NAME_QUERY_RESPONSE, (8 + 1 + 4 + 4 + 4 + 10));
-    data << ObjectGuid(HIGHGUID_PLAYER, lowguid);
-    data << name;
-    data << uint8(0);                                       // realm name for cross realm BG usage
-    data << uint32(pRace);                                  // race
-    data << uint32(pGender);                                // gender
-    data << uint32(pClass);                                 // class
+        // the character can be online meanwhile, its logout adds it again then
+        sPlayerNameCache.Add(lowguid, name, pRace, pGender, pClass);
+    }
 
-    session->SendPacket(&data);
+    session->SendNameQueryResponse(ObjectGuid(HIGHGUID_PLAYER, lowguid), name, pRace, pGender, pClass);
     delete result;
 }
 
@@ -142,33 +150,47 @@ void WorldSession::HandleCreatureQueryOpcode(WorldPacket& recv_data)
     {
         int loc_idx = GetSessionDbLocaleIndex();
 
-        char const* name = ci->Name;
-        char const* subName = ci->SubName;
-        sObjectMgr.GetCreatureLocaleStrings(entry, loc_idx, &name, &subName);
-
         DETAIL_LOG("WORLD: CMSG_CREATURE_QUERY '%s' - Entry: %u.", ci->Name, entry);
-        // guess size
-        WorldPacket data(SMSG_CREATURE_QUERY_RESPONSE, 100);
-        data << uint32(entry);                              // creature entry
-        data << name;
-        data << uint8(0) << uint8(0) << uint8(0);           // name2, name3, name4, always empty
-        data << subName;
-        data << uint32(ci->CreatureTypeFlags);              // flags
-        if (unit)
-            { data << uint32(((unit->IsPet()) ? 0 : ci->CreatureType)); } // CreatureType.dbc   wdbFeild8
-        else
-            { data << uint32(ci->CreatureType); }
 
-        data << uint32(ci->Family);                         // CreatureFamily.dbc
-        data << uint32(ci->Rank);                           // Creature Rank (elite, boss, etc)
-        data << uint32(0);                                  // unknown        wdbFeild11
-        data << uint32(ci->PetSpellDataId);                 // Id from CreatureSpellData.dbc    wdbField12
+        // the cached response has the template values, creature type and display id depend on the queried unit
+        WorldPacket data;
+        if (!sQueryResponseCache.Get(QUERY_RESPONSE_CREATURE, entry, loc_idx, data))
+        {
+            char const* name = ci->Name;
+            char const* subName = ci->SubName;
+            sObjectMgr.GetCreatureLocaleStrings(entry, loc_idx, &name, &subName);
+
+            // guess size
+            data.Initialize(SMSG_CREATURE_QUERY_RESPONSE, 100);
+            data << uint32(entry);                          // creature entry
+            data << name;
+            data << uint8(0) << uint8(0) << uint8(0);       // name2, name3, name4, always empty
+            data << subName;
+            data << uint32(ci->CreatureTypeFlags);          // flags
+            data << uint32(ci->CreatureType);               // CreatureType.dbc   wdbFeild8
+            data << uint32(ci->Family);                     // CreatureFamily.dbc
+            data << uint32(ci->Rank);                       // Creature Rank (elite, boss, etc)
+            data << uint32(0);                              // unknown        wdbFeild11
+            data << uint32(ci->PetSpellDataId);             // Id from CreatureSpellData.dbc    wdbField12
+            data << uint32(0);                              // DisplayID      wdbFeild13, set below
+            data << uint16(ci->civilian);                   // wdbFeild14
+
+            sQueryResponseCache.Store(QUERY_RESPONSE_CREATURE, entry, loc_idx, data);
+        }
+
+        // fields after the strings, counted from the end
+        size_t const creatureTypePos = data.size() - 26;
+        size_t const displayIdPos = data.size() - 6;
+
         if (unit)
-            { data << unit->GetUInt32Value(UNIT_FIELD_DISPLAYID); } // DisplayID      wdbFeild13
+        {
+            if (unit->IsPet())
+                { data.put<uint32>(creatureTypePos, 0); }
+            data.put<uint32>(displayIdPos, unit->GetUInt32Value(UNIT_FIELD_DISPLAYID));
+        }
         else
-            { data << uint32(Creature::ChooseDisplayId(ci)); }  // workaround, way to manage models must be fixed
+            { data.put<uint32>(displayIdPos, Creature::ChooseDisplayId(ci)); }  // workaround, way to manage models must be fixed
 
-        data << uint16(ci->civilian);                       // wdbFeild14
         SendPacket(&data);
         DEBUG_LOG("WORLD: Sent SMSG_CREATURE_QUERY_RESPONSE");
     }
@@ -194,16 +216,19 @@ void WorldSession::HandleGameObjectQueryOpcode(WorldPacket& recv_data)
     const GameObjectInfo* info = ObjectMgr::GetGameObjectInfo(entryID);
     if (info)
     {
+        int loc_idx = GetSessionDbLocaleIndex();
+        if (sQueryResponseCache.Send(this, QUERY_RESPONSE_GAMEOBJECT, entryID, loc_idx))
+            { return; }
+
         std::string Name = info->name;
 
-        int loc_idx = GetSessionDbLocaleIndex();
         if (loc_idx >= 0)
         {
             GameObjectLocale const* gl = sObjectMgr.GetGameObjectLocale(entryID);
             if (gl)
             {
-                if (gl->Name.size() > size_t(loc_idx) && !gl->Name[loc_idx].empty())
-                    { Name = gl->Name[loc_idx]; }
+                if (char const* locText = gl->Name.Get(loc_idx))
+                    { Name = locText; }
             }
         }
         DETAIL_LOG("WORLD: CMSG_GAMEOBJECT_QUERY '%s' - Entry: %u. ", info->name, entryID);
@@ -215,6 +240,7 @@ void WorldSession::HandleGameObjectQueryOpcode(WorldPacket& recv_data)
         data << uint16(0) << uint8(0) << uint8(0);          // name2, name3, name4
         data.append(info->raw.data, 24);
         // data << float(info->size);                       // go size , to check
+        sQueryResponseCache.Store(QUERY_RESPONSE_GAMEOBJECT, entryID, loc_idx, data);
         SendPacket(&data);
         DEBUG_LOG("WORLD: Sent SMSG_GAMEOBJECT_QUERY_RESPONSE");
     }
@@ -293,6 +319,10 @@ void WorldSession::HandleNpcTextQueryOpcode(WorldPacket& recv_data)
 
     GossipText const* pGossip = sObjectMgr.GetGossipText(textID);
 
+    int loc_idx = GetSessionDbLocaleIndex();
+    if (pGossip && sQueryResponseCache.Send(this, QUERY_RESPONSE_NPC_TEXT, textID, loc_idx))
+        { return; }
+
     WorldPacket data(SMSG_NPC_TEXT_UPDATE, 100);            // guess size
     data << textID;
 
@@ -321,8 +351,6 @@ void WorldSession::HandleNpcTextQueryOpcode(WorldPacket& recv_data)
             Text_1[i] = pGossip->Options[i].Text_1;
         }
 
-        int loc_idx = GetSessionDbLocaleIndex();
-
         sObjectMgr.GetNpcTextLocaleStringsAll(textID, loc_idx, &Text_0, &Text_1);
 
         for (int i = 0; i < MAX_GOSSIP_TEXT_OPTIONS; ++i)
@@ -347,6 +375,8 @@ void WorldSession::HandleNpcTextQueryOpcode(WorldPacket& recv_data)
                 data << pGossip->Options[i].Emotes[j]._Emote;
             }
         }
+
+        sQueryResponseCache.Store(QUERY_RESPONSE_NPC_TEXT, textID, loc_idx, data);
     }
 
     SendPacket(&data);
@@ -362,9 +392,17 @@ void WorldSession::HandlePageTextQueryOpcode(WorldPacket& recv_data)
     recv_data >> pageID;
     recv_data.read_skip<uint64>();                          // guid
 
+    int loc_idx = GetSessionDbLocaleIndex();
+
     while (pageID)
     {
         PageText const* pPage = sPageTextStore.LookupEntry<PageText>(pageID);
+        if (pPage && sQueryResponseCache.Send(this, QUERY_RESPONSE_PAGE_TEXT, pageID, loc_idx))
+        {
+            pageID = pPage->Next_Page;
+            continue;
+        }
+
         // guess size
         WorldPacket data(SMSG_PAGE_TEXT_QUERY_RESPONSE, 50);
         data << pageID;
@@ -379,19 +417,19 @@ void WorldSession::HandlePageTextQueryOpcode(WorldPacket& recv_data)
         {
             std::string Text = pPage->Text;
 
-            int loc_idx = GetSessionDbLocaleIndex();
             if (loc_idx >= 0)
             {
                 PageTextLocale const* pl = sObjectMgr.GetPageTextLocale(pageID);
                 if (pl)
                 {
-                    if (pl->Text.size() > size_t(loc_idx) && !pl->Text[loc_idx].empty())
-                        { Text = pl->Text[loc_idx]; }
+                    if (char const* locText = pl->Text.Get(loc_idx))
+                        { Text = locText; }
                 }
             }
 
             data << Text;
             data << uint32(pPage->Next_Page);
+            sQueryResponseCache.Store(QUERY_RESPONSE_PAGE_TEXT, pageID, loc_idx, data);
             pageID = pPage->Next_Page;
         }
         SendPacket(&data);
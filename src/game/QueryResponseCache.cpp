@@ -0,0 +1,71 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "QueryResponseCache.h"
+#include "WorldSession.h"
+#include "ObjectMgr.h"
+
+#include <ace/Guard_T.h>
+
+INSTANTIATE_SINGLETON_1(QueryResponseCache);
+
+bool QueryResponseCache::Send(WorldSession* session, QueryResponseType type, uint32 entry, int locale)
+{
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, false);
+
+    ResponseMap::const_iterator itr = m_responses[type].find(MakeKey(entry, locale));
+    if (itr == m_responses[type].end())
+        { return false; }
+
+    session->SendPacket(&itr->second);
+    return true;
+}
+
+bool QueryResponseCache::Get(QueryResponseType type, uint32 entry, int locale, WorldPacket& packet)
+{
+    ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex, guard, m_lock, false);
+
+    ResponseMap::const_iterator itr = m_responses[type].find(MakeKey(entry, locale));
+    if (itr == m_responses[type].end())
+        { return false; }
+
+    packet = itr->second;
+    return true;
+}
+
+void QueryResponseCache::Store(QueryResponseType type, uint32 entry, int locale, WorldPacket const& packet)
+{
+    // the locale strings are still loading, the response would keep the default texts
+    if (locale >= 0 && !sObjectMgr.AreLocalesLoaded())
+        { return; }
+
+    ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_lock);
+    m_responses[type][MakeKey(entry, locale)] = packet;
+}
+
+void QueryResponseCache::Clear(QueryResponseType type)
+{
+    ACE_WRITE_GUARD(ACE_RW_Thread_Mutex, guard, m_lock);
+    m_responses[type].clear();
+}
@@ -0,0 +1,103 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_QUERYRESPONSECACHE_H
+#define MANGOS_QUERYRESPONSECACHE_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "WorldPacket.h"
+
+#include <ace/RW_Thread_Mutex.h>
+
+class WorldSession;
+
+enum QueryResponseType
+{
+    QUERY_RESPONSE_ITEM         = 0,                        // SMSG_ITEM_QUERY_SINGLE_RESPONSE
+    QUERY_RESPONSE_CREATURE     = 1,                        // SMSG_CREATURE_QUERY_RESPONSE
+    QUERY_RESPONSE_GAMEOBJECT   = 2,                        // SMSG_GAMEOBJECT_QUERY_RESPONSE
+    QUERY_RESPONSE_NPC_TEXT     = 3,                        // SMSG_NPC_TEXT_UPDATE
+    QUERY_RESPONSE_PAGE_TEXT    = 4                         // SMSG_PAGE_TEXT_QUERY_RESPONSE
+};
+
+#define MAX_QUERY_RESPONSE_TYPE 5
+
+/**
+ * Built responses of the static data queries, one per entry and locale.
+ *
+ * The query handlers build a response at the first query of the entry in a locale and send the cached packet
+ * for later queries. Only existing entries are cached, the reload commands of the tables drop the responses
+ * of their type. Handlers can run in map update threads, so the cache is locked.
+ */
+class QueryResponseCache
+{
+    public:
+        /**
+         * @brief sends the cached response to the session
+         *
+         * @param session
+         * @param type
+         * @param entry
+         * @param locale locale index of the session, -1 for the default locale
+         * @return bool false if the response isn't cached
+         */
+        bool Send(WorldSession* session, QueryResponseType type, uint32 entry, int locale);
+
+        /**
+         * @brief copies the cached response, for responses changed per query before sending
+         *
+         * @param type
+         * @param entry
+         * @param locale
+         * @param packet
+         * @return bool false if the response isn't cached
+         */
+        bool Get(QueryResponseType type, uint32 entry, int locale, WorldPacket& packet);
+
+        /**
+         * @brief caches a built response, responses of localized sessions only once the locales are loaded
+         *
+         * @param type
+         * @param entry
+         * @param locale
+         * @param packet
+         */
+        void Store(QueryResponseType type, uint32 entry, int locale, WorldPacket const& packet);
+
+        /// drops the responses of a type, after its tables were reloaded
+        void Clear(QueryResponseType type);
+
+    private:
+        typedef UNORDERED_MAP<uint64, WorldPacket> ResponseMap;
+
+        static uint64 MakeKey(uint32 entry, int locale) { return (uint64(entry) << 8) | uint8(locale + 1); }
+
+        ResponseMap m_responses[MAX_QUERY_RESPONSE_TYPE];
+        ACE_RW_Thread_Mutex m_lock;
+};
+
+#define sQueryResponseCache MaNGOS::Singleton<QueryResponseCache>::Instance()
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "Platform/Define.h"
 #include "Database/DatabaseEnv.h"
+#include "StringPool.h"
 
 #include <string>
 #include <vector>
@@ -168,13 +169,13 @@ struct QuestLocale
 {
     QuestLocale() { ObjectiveText.resize(QUEST_OBJECTIVES_COUNT); }
 
-    std::vector<std::string> Title;
-    std::vector<std::string> Details;
-    std::vector<std::string> Objectives;
-    std::vector<std::string> OfferRewardText;
-    std::vector<std::string> RequestItemsText;
-    std::vector<std::string> EndText;
-    std::vector< std::vector<std::string> > ObjectiveText;
+    LocaleStrings Title;
+    LocaleStrings Details;
+    LocaleStrings Objectives;
+    LocaleStrings OfferRewardText;
+    LocaleStrings RequestItemsText;
+    LocaleStrings EndText;
+    std::vector<LocaleStrings> ObjectiveText;
 };
 
 // This Quest class provides a convenient way to access a few pretotaled (cached) quest details,
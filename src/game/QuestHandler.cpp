@@ -506,6 +506,12 @@ uint32 WorldSession::getDialogStatus(Player* pPlayer, Object* questgiver, uint32
 
     uint32 dialogStatus = defstatus;
 
+    // the status depends only on the entry and the quest state of the player, see Player::InvalidateQuestGiverStatus
+    bool useCache = defstatus == DIALOG_STATUS_NONE;
+    uint32 cachedStatus;
+    if (useCache && pPlayer->GetCachedQuestGiverStatus(questgiver->GetTypeId(), questgiver->GetEntry(), cachedStatus))
+        { return cachedStatus; }
+
     QuestRelationsMapBounds rbounds;                        // QuestRelations (quest-giver)
     QuestRelationsMapBounds irbounds;                       // InvolvedRelations (quest-finisher)
 
@@ -594,6 +600,9 @@ uint32 WorldSession::getDialogStatus(Player* pPlayer, Object* questgiver, uint32
             { dialogStatus = dialogStatusNew; }
     }
 
+    if (useCache)
+        { pPlayer->CacheQuestGiverStatus(questgiver->GetTypeId(), questgiver->GetEntry(), dialogStatus); }
+
     return dialogStatus;
 }
 
@@ -606,7 +615,7 @@ void WorldSession::HandleQuestgiverStatusMultipleQuery(WorldPacket& /*recvPacket
     WorldPacket data(SMSG_QUESTGIVER_STATUS_MULTIPLE, 4);
     data << uint32(count);                                  // placeholder
 
-    for (GuidSet::const_iterator itr = _player->m_clientGUIDs.begin(); itr != _player->m_clientGUIDs.end(); ++itr)
+    for (GuidHashSet::const_iterator itr = _player->m_clientGUIDs.begin(); itr != _player->m_clientGUIDs.end(); ++itr)
     {
         uint8 dialogStatus = DIALOG_STATUS_NONE;
 
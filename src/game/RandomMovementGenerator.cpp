@@ -27,6 +27,7 @@
 #include "RandomMovementGenerator.h"
 #include "Map.h"
 #include "Util.h"
+#include "PathFinder.h"
 #include "movement/MoveSplineInit.h"
 #include "movement/MoveSpline.h"
 
@@ -42,25 +43,67 @@ RandomMovementGenerator<Creature>::RandomMovementGenerator(const Creature& creat
     i_radius = wander_distance;
     // TODO - add support for flying mobs using some distance
     i_verticalZ = 0.0f;
+    // the wander points of db spawns are found on the nav mesh once and shared by all their respawns
+    i_spawnGuid = creature.HasStaticDBSpawnData() && !creature.CanFly() && wander_distance > 0.0f ? creature.GetGUIDLow() : 0;
+    i_wanderArea = NULL;
+    i_atWanderPoint = false;
+}
+
+template<>
+WanderArea const* RandomMovementGenerator<Creature>::_getWanderArea(Creature& creature)
+{
+    if (!i_spawnGuid)
+        { return NULL; }
+
+    if (!i_wanderArea)
+    {
+        Map* map = creature.GetMap();
+        i_wanderArea = map->GetWanderArea(i_spawnGuid);
+        if (!i_wanderArea)
+        {
+            WanderArea area;
+            PathFinder path(&creature);
+            path.findWanderPoints(i_x, i_y, i_z, i_radius, area);
+            i_wanderArea = &map->AddWanderArea(i_spawnGuid, area);
+        }
+    }
+
+    return i_wanderArea->points.empty() ? NULL : i_wanderArea;
 }
 
 template<>
 void RandomMovementGenerator<Creature>::_setRandomLocation(Creature& creature)
 {
-    const float angle = rand_norm_f() * (M_PI_F * 2.0f);
-    const float range = rand_norm_f() * i_radius;
+    float destX, destY, destZ;
+    bool generatePath = true;
 
-    const float maxPathRange = range * 1.5f;
+    if (WanderArea const* area = _getWanderArea(creature))
+    {
+        // known good points need neither height nor path checks, nor a path at all in open areas
+        Position const& point = area->points[urand(0, area->points.size() - 1)];
+        destX = point.x;
+        destY = point.y;
+        destZ = point.z;
+        generatePath = !area->open || !i_atWanderPoint;
+        i_atWanderPoint = true;
+    }
+    else
+    {
+        const float angle = rand_norm_f() * (M_PI_F * 2.0f);
+        const float range = rand_norm_f() * i_radius;
 
-    float destX = i_x + range * cos(angle);
-    float destY = i_y + range * sin(angle);
-    float destZ = i_z + frand(-1, 1) * i_verticalZ;
-    creature.UpdateAllowedPositionZ(destX, destY, destZ);
+        destX = i_x + range * cos(angle);
+        destY = i_y + range * sin(angle);
+        destZ = i_z + frand(-1, 1) * i_verticalZ;
+        creature.UpdateAllowedPositionZ(destX, destY, destZ);
+    }
+
+    const float maxPathRange = sqrt((destX - i_x) * (destX - i_x) + (destY - i_y) * (destY - i_y)) * 1.5f;
 
     creature.addUnitState(UNIT_STAT_ROAMING_MOVE);
 
     Movement::MoveSplineInit init(creature);
-    init.MoveTo(destX, destY, destZ, true, false, maxPathRange);
+    init.MoveTo(destX, destY, destZ, generatePath, false, maxPathRange);
     init.SetWalk(true);
     init.Launch();
 
@@ -83,6 +126,11 @@ void RandomMovementGenerator<Creature>::Initialize(Creature& creature)
     if (!creature.IsAlive() || creature.hasUnitState(UNIT_STAT_NOT_MOVE))
         { return; }
 
+    // the spawn point is checked against the wander points as well
+    float dx = creature.GetPositionX() - i_x;
+    float dy = creature.GetPositionY() - i_y;
+    i_atWanderPoint = dx * dx + dy * dy < 1.0f;
+
     _setRandomLocation(creature);
 }
 
@@ -95,6 +143,7 @@ void RandomMovementGenerator<Creature>::Reset(Creature& creature)
 template<>
 void RandomMovementGenerator<Creature>::Interrupt(Creature& creature)
 {
+    i_atWanderPoint = false;
     creature.InterruptMoving();
     creature.clearUnitState(UNIT_STAT_ROAMING | UNIT_STAT_ROAMING_MOVE);
     creature.SetWalk(!creature.hasUnitState(UNIT_STAT_RUNNING_STATE), false);
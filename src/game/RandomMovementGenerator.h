@@ -27,6 +27,8 @@
 
 #include "MovementGenerator.h"
 
+struct WanderArea;
+
 // define chance for creature to not stop after reaching a waypoint
 #define MOVEMENT_RANDOM_MMGEN_CHANCE_NO_BREAK 30
 
@@ -37,7 +39,8 @@ class MANGOS_DLL_SPEC RandomMovementGenerator
     public:
         explicit RandomMovementGenerator(const Creature&);
         explicit RandomMovementGenerator(float x, float y, float z, float radius, float verticalZ = 0.0f) :
-            i_nextMoveTime(0), i_x(x), i_y(y), i_z(z), i_radius(radius), i_verticalZ(verticalZ) {}
+            i_nextMoveTime(0), i_x(x), i_y(y), i_z(z), i_radius(radius), i_verticalZ(verticalZ),
+            i_spawnGuid(0), i_wanderArea(NULL), i_atWanderPoint(false) {}
 
         void _setRandomLocation(T&);
         void Initialize(T&);
@@ -47,10 +50,16 @@ class MANGOS_DLL_SPEC RandomMovementGenerator
         bool Update(T&, const uint32&);
         MovementGeneratorType GetMovementGeneratorType() const override { return RANDOM_MOTION_TYPE; }
     private:
+        // wander points of the spawn, NULL if it has none
+        WanderArea const* _getWanderArea(T&);
+
         ShortTimeTracker i_nextMoveTime;
         float i_x, i_y, i_z;
         float i_radius;
         float i_verticalZ;
+        uint32 i_spawnGuid;                                 // db guid of a spawn wandering around its spawn point
+        WanderArea const* i_wanderArea;
+        bool i_atWanderPoint;                               // at the spawn point or a wander point, seeing all of an open area
 };
 
 #endif
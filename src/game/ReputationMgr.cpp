@@ -283,6 +283,7 @@ bool ReputationMgr::SetOneFactionReputation(FactionEntry const* factionEntry, in
 
         itr->second.Standing = standing - BaseRep;
         itr->second.needSend = true;
+        m_player->InvalidateQuestGiverStatus();             // quests may require a reputation value
         itr->second.needSave = true;
 
         SetVisible(&itr->second);
@@ -0,0 +1,167 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "ScriptHookStats.h"
+#include "World.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(ScriptHookStats);
+
+static char const* const hookNames[MAX_SCRIPT_HOOK] =
+{
+    "gossip_hello", "go_gossip_hello", "gossip_select", "go_gossip_select", "gossip_select_code", "go_gossip_select_code",
+    "dialog_status", "go_dialog_status", "quest_accept", "go_quest_accept", "item_quest_accept", "quest_rewarded",
+    "go_quest_rewarded", "go_use", "item_use", "area_trigger", "process_event", "effect_dummy", "go_effect_dummy",
+    "item_effect_dummy", "effect_script_effect", "aura_dummy", "creature_ai", "instance_data"
+};
+
+void ScriptHookCounters::Add(ScriptHookCounters const& other)
+{
+    for (int i = 0; i < MAX_SCRIPT_HOOK; ++i)
+    {
+        calls[i] += other.calls[i];
+        time[i] += other.time[i];
+    }
+}
+
+uint64 ScriptHookStatsRow::GetTime() const
+{
+    uint64 total = 0;
+    for (int i = 0; i < MAX_SCRIPT_HOOK; ++i)
+        { total += counters.time[i]; }
+
+    return total;
+}
+
+ScriptHookStats::ScriptHookStats()
+{
+}
+
+ScriptHookStats::~ScriptHookStats()
+{
+    for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        { delete *itr; }
+}
+
+bool ScriptHookStats::IsEnabled() const
+{
+    return sWorld.getConfig(CONFIG_BOOL_SCRIPTHOOKSTATS_ENABLE);
+}
+
+ScriptHookStats::Table& ScriptHookStats::GetThreadTable()
+{
+    ThreadTable* current = m_threadTable;
+    if (!current->table)
+    {
+        Table* table = new Table;
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_tablesLock, *table);
+        m_tables.push_back(table);
+        current->table = table;
+    }
+
+    return *current->table;
+}
+
+void ScriptHookStats::AddTime(uint32 scriptId, ScriptHook hook, uint64 time)
+{
+    Table& table = GetThreadTable();
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, table.lock);
+    ScriptHookCounters& counters = table.scripts[scriptId];
+    ++counters.calls[hook];
+    counters.time[hook] += time;
+}
+
+static bool RowLess(ScriptHookStatsRow const& a, ScriptHookStatsRow const& b)
+{
+    uint64 timeA = a.GetTime();
+    uint64 timeB = b.GetTime();
+    if (timeA != timeB)
+        { return timeA > timeB; }
+
+    return a.scriptId < b.scriptId;
+}
+
+void ScriptHookStats::CollectRows(ScriptHookStatsRows& rows, uint32 maxRows) const
+{
+    CountersMap merged;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, const_cast<ACE_Thread_Mutex&>(m_tablesLock));
+        for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, tableGuard, (*itr)->lock);
+            for (CountersMap::const_iterator script = (*itr)->scripts.begin(); script != (*itr)->scripts.end(); ++script)
+                { merged[script->first].Add(script->second); }
+        }
+    }
+
+    size_t begin = rows.size();
+    for (CountersMap::const_iterator itr = merged.begin(); itr != merged.end(); ++itr)
+        { rows.push_back(ScriptHookStatsRow(itr->first, itr->second)); }
+
+    std::sort(rows.begin() + begin, rows.end(), RowLess);
+
+    if (maxRows && rows.size() - begin > maxRows)
+        { rows.resize(begin + maxRows, rows.front()); }
+}
+
+void ScriptHookStats::Reset()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_tablesLock);
+    for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, tableGuard, (*itr)->lock);
+        (*itr)->scripts.clear();
+    }
+}
+
+char const* ScriptHookStats::GetHookName(ScriptHook hook)
+{
+    return hookNames[hook];
+}
+
+ScriptHookTimer::ScriptHookTimer(uint32 scriptId, ScriptHook hook) :
+    m_scriptId(sScriptHookStats.IsEnabled() ? scriptId : 0), m_hook(hook)
+{
+    if (m_scriptId)
+        { m_start = ACE_OS::gettimeofday(); }
+}
+
+ScriptHookTimer::~ScriptHookTimer()
+{
+    if (!m_scriptId)
+        { return; }
+
+    ACE_UINT64 elapsed;
+    (ACE_OS::gettimeofday() - m_start).to_usec(elapsed);
+    sScriptHookStats.AddTime(m_scriptId, m_hook, elapsed);
+}
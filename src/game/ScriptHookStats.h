@@ -0,0 +1,132 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SCRIPTHOOKSTATS_H
+#define MANGOS_SCRIPTHOOKSTATS_H
+
+#include "Common.h"
+#include "ScriptMgr.h"
+#include "Policies/Singleton.h"
+#include "Utilities/UnorderedMapSet.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Time_Value.h>
+#include <ace/TSS_T.h>
+
+#include <vector>
+
+/// Counters of one script name
+struct ScriptHookCounters
+{
+    ScriptHookCounters()
+    {
+        memset(calls, 0, sizeof(calls));
+        memset(time, 0, sizeof(time));
+    }
+
+    void Add(ScriptHookCounters const& other);
+
+    uint64 calls[MAX_SCRIPT_HOOK];
+    uint64 time[MAX_SCRIPT_HOOK];                           // in microseconds
+};
+
+/// One line of the statistics, see ScriptHookStats::CollectRows
+struct ScriptHookStatsRow
+{
+    ScriptHookStatsRow(uint32 scriptId_, ScriptHookCounters const& counters_) : scriptId(scriptId_), counters(counters_) {}
+
+    /// Time of all hooks, the hooks of a script don't call each other
+    uint64 GetTime() const;
+
+    uint32 scriptId;
+    ScriptHookCounters counters;
+};
+
+typedef std::vector<ScriptHookStatsRow> ScriptHookStatsRows;
+
+/**
+ * Per script name cost accounting of the calls into the script library, enabled by ScriptHookStats.Enable.
+ *
+ * Like SpellStats every thread counts into an own table, the tables are only merged for .debug scripthooks.
+ * Only calls of implemented hooks are counted, see ScriptMgr::HasScriptHook.
+ */
+class ScriptHookStats
+{
+    public:
+        ScriptHookStats();
+        ~ScriptHookStats();
+
+        bool IsEnabled() const;
+
+        void AddTime(uint32 scriptId, ScriptHook hook, uint64 time);
+
+        /// Scripts sorted by time, at most maxRows if set
+        void CollectRows(ScriptHookStatsRows& rows, uint32 maxRows = 0) const;
+        void Reset();
+
+        static char const* GetHookName(ScriptHook hook);
+
+    private:
+        typedef UNORDERED_MAP<uint32, ScriptHookCounters> CountersMap;
+
+        struct Table
+        {
+            ACE_Thread_Mutex lock;                          // contended only while collecting or resetting
+            CountersMap scripts;
+        };
+
+        typedef std::vector<Table*> Tables;
+
+        /// Table of the current thread, owned by m_tables
+        struct ThreadTable
+        {
+            ThreadTable() : table(NULL) {}
+
+            Table* table;
+        };
+
+        Table& GetThreadTable();
+
+        ACE_TSS<ThreadTable> m_threadTable;
+        ACE_Thread_Mutex m_tablesLock;
+        Tables m_tables;                                    // of all threads which ever counted, kept after thread end
+};
+
+#define sScriptHookStats MaNGOS::Singleton<ScriptHookStats>::Instance()
+
+/// Adds its lifetime to the script hook statistics, if enabled at construction
+class ScriptHookTimer
+{
+    public:
+        ScriptHookTimer(uint32 scriptId, ScriptHook hook);
+        ~ScriptHookTimer();
+
+    private:
+        uint32 m_scriptId;                                  // 0 if disabled
+        ScriptHook m_hook;
+        ACE_Time_Value m_start;
+};
+
+#endif
@@ -38,6 +38,7 @@
 #include "OutdoorPvP/OutdoorPvP.h"
 #include "WaypointMovementGenerator.h"
 #include "LuaEngine.h"
+#include "ScriptHookStats.h"
 
 #include "revision_nr.h"
 
@@ -60,6 +61,7 @@ ScriptMgr::ScriptMgr() :
     m_pOnInitScriptLibrary(NULL),
     m_pOnFreeScriptLibrary(NULL),
     m_pGetScriptLibraryVersion(NULL),
+    m_pGetScriptHooks(NULL),
 
     m_pGetCreatureAI(NULL),
     m_pCreateInstanceData(NULL),
@@ -1805,6 +1807,217 @@ bool ScriptAction::HandleScriptStep()
     return false;
 }
 
+// /////////////////////////////////////////////////////////
+//              DB SCRIPT SCHEDULE
+// /////////////////////////////////////////////////////////
+
+ScriptSchedule::ScriptSchedule(Map* map) :
+    m_map(map), m_executing(NULL), m_time(0), m_order(0), m_stepCount(0)
+{
+    memset(m_slots, 0, sizeof(m_slots));
+}
+
+ScriptSchedule::~ScriptSchedule()
+{
+    for (uint32 i = 0; i < SCRIPT_SCHEDULE_SLOTS; ++i)
+    {
+        while (ScheduledScript* entry = m_slots[i])
+        {
+            m_slots[i] = entry->next;
+            delete entry;
+        }
+    }
+
+    for (std::vector<ScheduledScript*>::const_iterator itr = m_freeEntries.begin(); itr != m_freeEntries.end(); ++itr)
+        { delete *itr; }
+}
+
+ScriptSchedule::ScheduledScript* ScriptSchedule::Acquire(const char* table, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, time_t now)
+{
+    // nothing waits, the wheel does not need to catch up from an old time
+    if (!m_stepCount && !m_executing)
+        { m_time = now; }
+
+    ScheduledScript* entry;
+    if (m_freeEntries.empty())
+        { entry = new ScheduledScript; }
+    else
+    {
+        entry = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    }
+
+    entry->table = table;
+    entry->sourceGuid = sourceGuid;
+    entry->targetGuid = targetGuid;
+    entry->ownerGuid = ownerGuid;
+    entry->startTime = now;
+    entry->order = m_order++;
+    entry->next = NULL;
+    return entry;
+}
+
+void ScriptSchedule::Release(ScheduledScript* entry)
+{
+    m_freeEntries.push_back(entry);
+}
+
+void ScriptSchedule::Schedule(const char* table, ScriptMap const& steps, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, time_t now)
+{
+    if (steps.empty())
+        { return; }
+
+    ScheduledScript* entry = Acquire(table, sourceGuid, targetGuid, ownerGuid, now);
+    entry->steps = &steps;
+    entry->nextStep = steps.begin();
+    entry->script = &entry->nextStep->second;
+    entry->dueTime = now + entry->nextStep->first;
+    entry->stepsLeft = uint32(steps.size());
+
+    m_stepCount += entry->stepsLeft;
+    sScriptMgr.IncreaseScheduledScriptsCount(entry->stepsLeft);
+
+    Insert(entry);
+}
+
+void ScriptSchedule::Schedule(const char* table, ScriptInfo const& step, uint32 delay, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, time_t now)
+{
+    ScheduledScript* entry = Acquire(table, sourceGuid, targetGuid, ownerGuid, now);
+    entry->steps = NULL;
+    entry->script = &step;
+    entry->dueTime = now + delay;
+    entry->stepsLeft = 1;
+
+    ++m_stepCount;
+    sScriptMgr.IncreaseScheduledScriptsCount();
+
+    Insert(entry);
+}
+
+void ScriptSchedule::Insert(ScheduledScript* entry)
+{
+    // the wheel executes nothing before its time, a step of the past is due at once
+    if (entry->dueTime < m_time)
+        { entry->dueTime = m_time; }
+
+    ScheduledScript** itr = &m_slots[entry->dueTime % SCRIPT_SCHEDULE_SLOTS];
+    while (*itr && ((*itr)->dueTime < entry->dueTime || ((*itr)->dueTime == entry->dueTime && (*itr)->order < entry->order)))
+        { itr = &(*itr)->next; }
+
+    entry->next = *itr;
+    *itr = entry;
+}
+
+bool ScriptSchedule::IsScheduled(const char* table, uint32 id, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid) const
+{
+    // the step being executed counts as waiting until it is done
+    if (m_executing && m_executing->GetAction(m_map).IsSameScript(table, id, sourceGuid, targetGuid, ownerGuid))
+        { return true; }
+
+    for (uint32 i = 0; i < SCRIPT_SCHEDULE_SLOTS; ++i)
+        for (ScheduledScript const* entry = m_slots[i]; entry; entry = entry->next)
+            if (entry->GetAction(m_map).IsSameScript(table, id, sourceGuid, targetGuid, ownerGuid))
+                { return true; }
+
+    return false;
+}
+
+void ScriptSchedule::Process(time_t now)
+{
+    if (!m_stepCount)
+    {
+        m_time = now;
+        return;
+    }
+
+    // the slot of the last processed second is visited again for steps scheduled after it was processed
+    for (; m_time <= now; ++m_time)
+    {
+        ScheduledScript*& slot = m_slots[m_time % SCRIPT_SCHEDULE_SLOTS];
+        while (slot && slot->dueTime <= m_time)
+        {
+            ScheduledScript* entry = slot;
+            slot = entry->next;
+
+            if (Execute(entry))
+            {
+                // Terminate following script steps of this script
+                Terminate(entry);
+                Release(entry);
+            }
+            else if (entry->stepsLeft)
+                { Insert(entry); }
+            else
+                { Release(entry); }
+        }
+
+        if (m_time == now)
+            { break; }
+    }
+}
+
+bool ScriptSchedule::Execute(ScheduledScript* entry)
+{
+    m_executing = entry;
+
+    // all steps of the same time are executed at once, as steps started later can't come between them
+    bool terminate = false;
+    time_t dueTime = entry->dueTime;
+    while (entry->stepsLeft && entry->dueTime == dueTime)
+    {
+        // the step is taken before it is executed, the step may start other scripts
+        ScriptAction action = entry->GetAction(m_map);
+        if (--entry->stepsLeft)
+        {
+            ++entry->nextStep;
+            entry->script = &entry->nextStep->second;
+            entry->dueTime = entry->startTime + entry->nextStep->first;
+        }
+
+        --m_stepCount;
+        sScriptMgr.DecreaseScheduledScriptCount();
+
+        if (action.HandleScriptStep())
+        {
+            terminate = true;
+            break;
+        }
+    }
+
+    m_executing = NULL;
+    return terminate;
+}
+
+void ScriptSchedule::Terminate(ScheduledScript const* entry)
+{
+    ScriptAction action = entry->GetAction(m_map);
+    const char* table = action.GetTableName();
+    uint32 id = action.GetId();
+    ObjectGuid sourceGuid = action.GetSourceGuid();
+    ObjectGuid targetGuid = action.GetTargetGuid();
+    ObjectGuid ownerGuid = action.GetOwnerGuid();
+
+    m_stepCount -= entry->stepsLeft;
+    sScriptMgr.DecreaseScheduledScriptCount(entry->stepsLeft);
+
+    for (uint32 i = 0; i < SCRIPT_SCHEDULE_SLOTS; ++i)
+    {
+        for (ScheduledScript** itr = &m_slots[i]; *itr;)
+        {
+            ScheduledScript* other = *itr;
+            if (other->GetAction(m_map).IsSameScript(table, id, sourceGuid, targetGuid, ownerGuid))
+            {
+                *itr = other->next;
+                m_stepCount -= other->stepsLeft;
+                sScriptMgr.DecreaseScheduledScriptCount(other->stepsLeft);
+                Release(other);
+            }
+            else
+                { itr = &other->next; }
+        }
+    }
+}
+
 // /////////////////////////////////////////////////////////
 //              Scripting Library Hooks
 // /////////////////////////////////////////////////////////
@@ -1993,17 +2206,21 @@ CreatureAI* ScriptMgr::GetCreatureAI(Creature* pCreature)
     if (CreatureAI* luaAI = sEluna->GetAI(pCreature))
         return luaAI;
 
-    if (!m_pGetCreatureAI)
+    uint32 scriptId = pCreature->GetScriptId();
+    if (!m_pGetCreatureAI || !HasScriptHook(scriptId, SCRIPT_HOOK_CREATURE_AI))
         { return NULL; }
 
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_CREATURE_AI);
     return m_pGetCreatureAI(pCreature);
 }
 
 InstanceData* ScriptMgr::CreateInstanceData(Map* pMap)
 {
-    if (!m_pCreateInstanceData)
+    uint32 scriptId = pMap->GetScriptId();
+    if (!m_pCreateInstanceData || !HasScriptHook(scriptId, SCRIPT_HOOK_INSTANCE_DATA))
         { return NULL; }
 
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_INSTANCE_DATA);
     return m_pCreateInstanceData(pMap);
 }
 
@@ -2013,7 +2230,12 @@ bool ScriptMgr::OnGossipHello(Player* pPlayer, Creature* pCreature)
     if (sEluna->OnGossipHello(pPlayer, pCreature))
         return true;
 
-    return m_pOnGossipHello != NULL && m_pOnGossipHello(pPlayer, pCreature);
+    uint32 scriptId = pCreature->GetScriptId();
+    if (!m_pOnGossipHello || !HasScriptHook(scriptId, SCRIPT_HOOK_GOSSIP_HELLO))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GOSSIP_HELLO);
+    return m_pOnGossipHello(pPlayer, pCreature);
 }
 
 bool ScriptMgr::OnGossipHello(Player* pPlayer, GameObject* pGameObject)
@@ -2022,7 +2244,12 @@ bool ScriptMgr::OnGossipHello(Player* pPlayer, GameObject* pGameObject)
     if (sEluna->OnGossipHello(pPlayer, pGameObject))
         return true;
 
-    return m_pOnGOGossipHello != NULL && m_pOnGOGossipHello(pPlayer, pGameObject);
+    uint32 scriptId = pGameObject->GetGOInfo()->ScriptId;
+    if (!m_pOnGOGossipHello || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_GOSSIP_HELLO))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_GOSSIP_HELLO);
+    return m_pOnGOGossipHello(pPlayer, pGameObject);
 }
 
 bool ScriptMgr::OnGossipSelect(Player* pPlayer, Creature* pCreature, uint32 sender, uint32 action, const char* code)
@@ -2040,10 +2267,21 @@ bool ScriptMgr::OnGossipSelect(Player* pPlayer, Creature* pCreature, uint32 send
             return true;
     }
 
+    uint32 scriptId = pCreature->GetScriptId();
     if (code)
-        { return m_pOnGossipSelectWithCode != NULL && m_pOnGossipSelectWithCode(pPlayer, pCreature, sender, action, code); }
-    else
-        { return m_pOnGossipSelect != NULL && m_pOnGossipSelect(pPlayer, pCreature, sender, action); }
+    {
+        if (!m_pOnGossipSelectWithCode || !HasScriptHook(scriptId, SCRIPT_HOOK_GOSSIP_SELECT_CODE))
+            { return false; }
+
+        ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GOSSIP_SELECT_CODE);
+        return m_pOnGossipSelectWithCode(pPlayer, pCreature, sender, action, code);
+    }
+
+    if (!m_pOnGossipSelect || !HasScriptHook(scriptId, SCRIPT_HOOK_GOSSIP_SELECT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GOSSIP_SELECT);
+    return m_pOnGossipSelect(pPlayer, pCreature, sender, action);
 }
 
 bool ScriptMgr::OnGossipSelect(Player* pPlayer, GameObject* pGameObject, uint32 sender, uint32 action, const char* code)
@@ -2059,10 +2297,21 @@ bool ScriptMgr::OnGossipSelect(Player* pPlayer, GameObject* pGameObject, uint32
         if (sEluna->OnGossipSelect(pPlayer, pGameObject, sender, action))
             return true;
 
+    uint32 scriptId = pGameObject->GetGOInfo()->ScriptId;
     if (code)
-        { return m_pOnGOGossipSelectWithCode != NULL && m_pOnGOGossipSelectWithCode(pPlayer, pGameObject, sender, action, code); }
-    else
-        { return m_pOnGOGossipSelect != NULL && m_pOnGOGossipSelect(pPlayer, pGameObject, sender, action); }
+    {
+        if (!m_pOnGOGossipSelectWithCode || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_GOSSIP_SELECT_CODE))
+            { return false; }
+
+        ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_GOSSIP_SELECT_CODE);
+        return m_pOnGOGossipSelectWithCode(pPlayer, pGameObject, sender, action, code);
+    }
+
+    if (!m_pOnGOGossipSelect || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_GOSSIP_SELECT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_GOSSIP_SELECT);
+    return m_pOnGOGossipSelect(pPlayer, pGameObject, sender, action);
 }
 
 bool ScriptMgr::OnQuestAccept(Player* pPlayer, Creature* pCreature, Quest const* pQuest)
@@ -2071,7 +2320,12 @@ bool ScriptMgr::OnQuestAccept(Player* pPlayer, Creature* pCreature, Quest const*
     if (sEluna->OnQuestAccept(pPlayer, pCreature, pQuest))
         return true;
 
-    return m_pOnQuestAccept != NULL && m_pOnQuestAccept(pPlayer, pCreature, pQuest);
+    uint32 scriptId = pCreature->GetScriptId();
+    if (!m_pOnQuestAccept || !HasScriptHook(scriptId, SCRIPT_HOOK_QUEST_ACCEPT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_QUEST_ACCEPT);
+    return m_pOnQuestAccept(pPlayer, pCreature, pQuest);
 }
 
 bool ScriptMgr::OnQuestAccept(Player* pPlayer, GameObject* pGameObject, Quest const* pQuest)
@@ -2080,7 +2334,12 @@ bool ScriptMgr::OnQuestAccept(Player* pPlayer, GameObject* pGameObject, Quest co
     if (sEluna->OnQuestAccept(pPlayer, pGameObject, pQuest))
         return true;
 
-    return m_pOnGOQuestAccept != NULL && m_pOnGOQuestAccept(pPlayer, pGameObject, pQuest);
+    uint32 scriptId = pGameObject->GetGOInfo()->ScriptId;
+    if (!m_pOnGOQuestAccept || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_QUEST_ACCEPT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_QUEST_ACCEPT);
+    return m_pOnGOQuestAccept(pPlayer, pGameObject, pQuest);
 }
 
 bool ScriptMgr::OnQuestAccept(Player* pPlayer, Item* pItem, Quest const* pQuest)
@@ -2089,7 +2348,12 @@ bool ScriptMgr::OnQuestAccept(Player* pPlayer, Item* pItem, Quest const* pQuest)
     if (sEluna->OnQuestAccept(pPlayer, pItem, pQuest))
         return true;
 
-    return m_pOnItemQuestAccept != NULL && m_pOnItemQuestAccept(pPlayer, pItem, pQuest);
+    uint32 scriptId = pItem->GetProto()->ScriptId;
+    if (!m_pOnItemQuestAccept || !HasScriptHook(scriptId, SCRIPT_HOOK_ITEM_QUEST_ACCEPT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_ITEM_QUEST_ACCEPT);
+    return m_pOnItemQuestAccept(pPlayer, pItem, pQuest);
 }
 
 bool ScriptMgr::OnQuestRewarded(Player* pPlayer, Creature* pCreature, Quest const* pQuest)
@@ -2098,7 +2362,12 @@ bool ScriptMgr::OnQuestRewarded(Player* pPlayer, Creature* pCreature, Quest cons
     if (sEluna->OnQuestReward(pPlayer, pCreature, pQuest))
         return true;
 
-    return m_pOnQuestRewarded != NULL && m_pOnQuestRewarded(pPlayer, pCreature, pQuest);
+    uint32 scriptId = pCreature->GetScriptId();
+    if (!m_pOnQuestRewarded || !HasScriptHook(scriptId, SCRIPT_HOOK_QUEST_REWARDED))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_QUEST_REWARDED);
+    return m_pOnQuestRewarded(pPlayer, pCreature, pQuest);
 }
 
 bool ScriptMgr::OnQuestRewarded(Player* pPlayer, GameObject* pGameObject, Quest const* pQuest)
@@ -2107,7 +2376,12 @@ bool ScriptMgr::OnQuestRewarded(Player* pPlayer, GameObject* pGameObject, Quest
     if (sEluna->OnQuestReward(pPlayer, pGameObject, pQuest))
         return true;
 
-    return m_pOnGOQuestRewarded != NULL && m_pOnGOQuestRewarded(pPlayer, pGameObject, pQuest);
+    uint32 scriptId = pGameObject->GetGOInfo()->ScriptId;
+    if (!m_pOnGOQuestRewarded || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_QUEST_REWARDED))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_QUEST_REWARDED);
+    return m_pOnGOQuestRewarded(pPlayer, pGameObject, pQuest);
 }
 
 uint32 ScriptMgr::GetDialogStatus(Player* pPlayer, Creature* pCreature)
@@ -2116,9 +2390,11 @@ uint32 ScriptMgr::GetDialogStatus(Player* pPlayer, Creature* pCreature)
     if (uint32 dialogId = sEluna->GetDialogStatus(pPlayer, pCreature))
         return dialogId;
 
-    if (!m_pGetNPCDialogStatus)
+    uint32 scriptId = pCreature->GetScriptId();
+    if (!m_pGetNPCDialogStatus || !HasScriptHook(scriptId, SCRIPT_HOOK_DIALOG_STATUS))
         { return DIALOG_STATUS_UNDEFINED; }
 
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_DIALOG_STATUS);
     return m_pGetNPCDialogStatus(pPlayer, pCreature);
 }
 
@@ -2128,15 +2404,22 @@ uint32 ScriptMgr::GetDialogStatus(Player* pPlayer, GameObject* pGameObject)
     if (uint32 dialogId = sEluna->GetDialogStatus(pPlayer, pGameObject))
         return dialogId;
 
-    if (!m_pGetGODialogStatus)
+    uint32 scriptId = pGameObject->GetGOInfo()->ScriptId;
+    if (!m_pGetGODialogStatus || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_DIALOG_STATUS))
         { return DIALOG_STATUS_UNDEFINED; }
 
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_DIALOG_STATUS);
     return m_pGetGODialogStatus(pPlayer, pGameObject);
 }
 
 bool ScriptMgr::OnGameObjectUse(Player* pPlayer, GameObject* pGameObject)
 {
-    return m_pOnGOUse != NULL && m_pOnGOUse(pPlayer, pGameObject);
+    uint32 scriptId = pGameObject->GetGOInfo()->ScriptId;
+    if (!m_pOnGOUse || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_USE))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_USE);
+    return m_pOnGOUse(pPlayer, pGameObject);
 }
 
 bool ScriptMgr::OnItemUse(Player* pPlayer, Item* pItem, SpellCastTargets const& targets)
@@ -2145,7 +2428,12 @@ bool ScriptMgr::OnItemUse(Player* pPlayer, Item* pItem, SpellCastTargets const&
     if (!sEluna->OnUse(pPlayer, pItem, targets))
         return true;
 
-    return m_pOnItemUse != NULL && m_pOnItemUse(pPlayer, pItem, targets);
+    uint32 scriptId = pItem->GetProto()->ScriptId;
+    if (!m_pOnItemUse || !HasScriptHook(scriptId, SCRIPT_HOOK_ITEM_USE))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_ITEM_USE);
+    return m_pOnItemUse(pPlayer, pItem, targets);
 }
 
 bool ScriptMgr::OnAreaTrigger(Player* pPlayer, AreaTriggerEntry const* atEntry)
@@ -2154,12 +2442,22 @@ bool ScriptMgr::OnAreaTrigger(Player* pPlayer, AreaTriggerEntry const* atEntry)
     if (sEluna->OnAreaTrigger(pPlayer, atEntry))
         return true;
 
-    return m_pOnAreaTrigger != NULL && m_pOnAreaTrigger(pPlayer, atEntry);
+    uint32 scriptId = GetAreaTriggerScriptId(atEntry->id);
+    if (!m_pOnAreaTrigger || !HasScriptHook(scriptId, SCRIPT_HOOK_AREA_TRIGGER))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_AREA_TRIGGER);
+    return m_pOnAreaTrigger(pPlayer, atEntry);
 }
 
 bool ScriptMgr::OnProcessEvent(uint32 eventId, Object* pSource, Object* pTarget, bool isStart)
 {
-    return m_pOnProcessEvent != NULL && m_pOnProcessEvent(eventId, pSource, pTarget, isStart);
+    uint32 scriptId = GetEventIdScriptId(eventId);
+    if (!m_pOnProcessEvent || !HasScriptHook(scriptId, SCRIPT_HOOK_PROCESS_EVENT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_PROCESS_EVENT);
+    return m_pOnProcessEvent(eventId, pSource, pTarget, isStart);
 }
 
 bool ScriptMgr::OnEffectDummy(Unit* pCaster, uint32 spellId, SpellEffectIndex effIndex, Creature* pTarget, ObjectGuid originalCasterGuid)
@@ -2168,7 +2466,12 @@ bool ScriptMgr::OnEffectDummy(Unit* pCaster, uint32 spellId, SpellEffectIndex ef
     if (sEluna->OnDummyEffect(pCaster, spellId, effIndex, pTarget))
         return true;
 
-    return m_pOnEffectDummyCreature != NULL && m_pOnEffectDummyCreature(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
+    uint32 scriptId = pTarget->GetScriptId();
+    if (!m_pOnEffectDummyCreature || !HasScriptHook(scriptId, SCRIPT_HOOK_EFFECT_DUMMY))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_EFFECT_DUMMY);
+    return m_pOnEffectDummyCreature(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
 }
   
 bool ScriptMgr::OnEffectDummy(Unit* pCaster, uint32 spellId, SpellEffectIndex effIndex, GameObject* pTarget, ObjectGuid originalCasterGuid)
@@ -2177,7 +2480,12 @@ bool ScriptMgr::OnEffectDummy(Unit* pCaster, uint32 spellId, SpellEffectIndex ef
     if (sEluna->OnDummyEffect(pCaster, spellId, effIndex, pTarget))
         return true;
 
-    return m_pOnEffectDummyGO != NULL && m_pOnEffectDummyGO(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
+    uint32 scriptId = pTarget->GetGOInfo()->ScriptId;
+    if (!m_pOnEffectDummyGO || !HasScriptHook(scriptId, SCRIPT_HOOK_GO_EFFECT_DUMMY))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_GO_EFFECT_DUMMY);
+    return m_pOnEffectDummyGO(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
 }
   
 bool ScriptMgr::OnEffectDummy(Unit* pCaster, uint32 spellId, SpellEffectIndex effIndex, Item* pTarget, ObjectGuid originalCasterGuid)
@@ -2186,17 +2494,33 @@ bool ScriptMgr::OnEffectDummy(Unit* pCaster, uint32 spellId, SpellEffectIndex ef
     if (sEluna->OnDummyEffect(pCaster, spellId, effIndex, pTarget))
         return true;
 
-    return m_pOnEffectDummyItem != NULL && m_pOnEffectDummyItem(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
+    uint32 scriptId = pTarget->GetProto()->ScriptId;
+    if (!m_pOnEffectDummyItem || !HasScriptHook(scriptId, SCRIPT_HOOK_ITEM_EFFECT_DUMMY))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_ITEM_EFFECT_DUMMY);
+    return m_pOnEffectDummyItem(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
 }
 
 bool ScriptMgr::OnEffectScriptEffect(Unit* pCaster, uint32 spellId, SpellEffectIndex effIndex, Creature* pTarget, ObjectGuid originalCasterGuid)
 {
-    return m_pOnEffectScriptEffectCreature != NULL && m_pOnEffectScriptEffectCreature(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
+    uint32 scriptId = pTarget->GetScriptId();
+    if (!m_pOnEffectScriptEffectCreature || !HasScriptHook(scriptId, SCRIPT_HOOK_EFFECT_SCRIPT_EFFECT))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_EFFECT_SCRIPT_EFFECT);
+    return m_pOnEffectScriptEffectCreature(pCaster, spellId, effIndex, pTarget, originalCasterGuid);
 }
 
 bool ScriptMgr::OnAuraDummy(Aura const* pAura, bool apply)
 {
-    return m_pOnAuraDummy != NULL && m_pOnAuraDummy(pAura, apply);
+    // only called for creature targets
+    uint32 scriptId = ((Creature*)pAura->GetTarget())->GetScriptId();
+    if (!m_pOnAuraDummy || !HasScriptHook(scriptId, SCRIPT_HOOK_AURA_DUMMY))
+        { return false; }
+
+    ScriptHookTimer timer(scriptId, SCRIPT_HOOK_AURA_DUMMY);
+    return m_pOnAuraDummy(pAura, apply);
 }
 
 ScriptLoadResult ScriptMgr::LoadScriptLibrary(const char* libName)
@@ -2258,6 +2582,9 @@ ScriptLoadResult ScriptMgr::LoadScriptLibrary(const char* libName)
 
 #   undef GET_SCRIPT_HOOK_PTR
 
+    // optional, without it every hook of every script is called
+    GetScriptHookPtr(m_pGetScriptHooks,                "GetScriptHooks");
+
     if (strcmp(pGetMangosRevStr(), REVISION_NR) != 0)
     {
         m_pOnFreeScriptLibrary = NULL;                      // prevent call before init
@@ -2266,6 +2593,7 @@ ScriptLoadResult ScriptMgr::LoadScriptLibrary(const char* libName)
     }
 
     m_pOnInitScriptLibrary();
+    LoadScriptHooks();
     return SCRIPT_LOAD_OK;
 }
 
@@ -2279,10 +2607,12 @@ void ScriptMgr::UnloadScriptLibrary()
 
     MANGOS_CLOSE_LIBRARY(m_hScriptLib);
     m_hScriptLib = NULL;
+    m_scriptHooks.clear();
 
     m_pOnInitScriptLibrary      = NULL;
     m_pOnFreeScriptLibrary      = NULL;
     m_pGetScriptLibraryVersion  = NULL;
+    m_pGetScriptHooks           = NULL;
 
     m_pGetCreatureAI            = NULL;
     m_pCreateInstanceData       = NULL;
@@ -2311,6 +2641,28 @@ void ScriptMgr::UnloadScriptLibrary()
     m_pOnAuraDummy              = NULL;
 }
 
+void ScriptMgr::LoadScriptHooks()
+{
+    m_scriptHooks.assign(GetScriptIdsCount(), m_pGetScriptHooks ? 0 : SCRIPT_HOOK_MASK_ALL);
+    if (!m_pGetScriptHooks)
+        { return; }
+
+    uint32 scripts = 0;
+    uint32 hooks = 0;
+    for (uint32 i = 1; i < m_scriptHooks.size(); ++i)
+    {
+        m_scriptHooks[i] = m_pGetScriptHooks(i) & SCRIPT_HOOK_MASK_ALL;
+        if (!m_scriptHooks[i])
+            { continue; }
+
+        ++scripts;
+        for (uint32 mask = m_scriptHooks[i]; mask; mask &= mask - 1)
+            { ++hooks; }
+    }
+
+    sLog.outString(">> Loaded %u hooks of %u script names from the script library", hooks, scripts);
+}
+
 void ScriptMgr::CollectPossibleEventIds(std::set<uint32>& eventIds)
 {
     // Load all possible script entries from gameobjects
@@ -442,6 +442,96 @@ typedef std::multimap < uint32 /*delay*/, ScriptInfo > ScriptMap;
 typedef std::map < uint32 /*id*/, ScriptMap > ScriptMapMap;
 typedef std::pair<const char*, ScriptMapMap> ScriptMapMapName;
 
+#define SCRIPT_SCHEDULE_SLOTS 64                            // seconds covered by one turn of the script schedule wheel
+
+/**
+ * @brief DB script steps waiting for their execution on a map
+ *
+ * A started script is kept as one entry pointing at the static steps of its ScriptMap, the steps are
+ * not copied. The entries are hashed into a wheel of one second slots by the time of their next step,
+ * a slot keeps its entries sorted by that time and the start order, so the steps run in the same order
+ * as from a time sorted list. Entries of finished scripts are kept for reuse.
+ */
+class ScriptSchedule
+{
+    public:
+        ScriptSchedule(Map* map);
+        ~ScriptSchedule();
+
+        /**
+         * @brief schedules all steps of a script
+         *
+         * @param table name of the table the script is from
+         * @param steps the steps, must exist until they are executed
+         * @param sourceGuid
+         * @param targetGuid
+         * @param ownerGuid owner of the source if the source is an item
+         * @param now current game time
+         */
+        void Schedule(const char* table, ScriptMap const& steps, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, time_t now);
+        /**
+         * @brief schedules a single script step
+         *
+         * @param table
+         * @param step the step, must exist until it is executed
+         * @param delay seconds from now
+         * @param sourceGuid
+         * @param targetGuid
+         * @param ownerGuid
+         * @param now
+         */
+        void Schedule(const char* table, ScriptInfo const& step, uint32 delay, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, time_t now);
+
+        /**
+         * @brief true if a step of a matching script waits for its execution, see ScriptAction::IsSameScript
+         *
+         */
+        bool IsScheduled(const char* table, uint32 id, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid) const;
+
+        /**
+         * @brief executes all steps due up to now
+         *
+         * @param now current game time
+         */
+        void Process(time_t now);
+
+        bool empty() const { return m_stepCount == 0; }
+        size_t GetStepCount() const { return m_stepCount; }
+
+    private:
+        struct ScheduledScript
+        {
+            const char* table;
+            ObjectGuid sourceGuid;
+            ObjectGuid targetGuid;
+            ObjectGuid ownerGuid;
+            ScriptMap const* steps;                         // NULL for a single step
+            ScriptMap::const_iterator nextStep;
+            ScriptInfo const* script;                       // next step to execute
+            time_t startTime;
+            time_t dueTime;                                 // execution time of the next step
+            uint64 order;                                   // start order, keeps steps of the same time in order
+            uint32 stepsLeft;
+            ScheduledScript* next;                          // in the slot
+
+            ScriptAction GetAction(Map* map) const { return ScriptAction(table, map, sourceGuid, targetGuid, ownerGuid, script); }
+        };
+
+        ScheduledScript* Acquire(const char* table, ObjectGuid sourceGuid, ObjectGuid targetGuid, ObjectGuid ownerGuid, time_t now);
+        void Insert(ScheduledScript* entry);
+        bool Execute(ScheduledScript* entry);
+        void Terminate(ScheduledScript const* entry);
+        void Release(ScheduledScript* entry);
+
+        Map* m_map;
+        ScheduledScript* m_slots[SCRIPT_SCHEDULE_SLOTS];
+        std::vector<ScheduledScript*> m_freeEntries;
+        ScheduledScript* m_executing;                       // entry of the step being executed, out of its slot meanwhile
+        time_t m_time;                                      // game time up to which the steps were executed
+        uint64 m_order;
+        size_t m_stepCount;
+};
+
 extern ScriptMapMapName sQuestEndScripts;
 extern ScriptMapMapName sQuestStartScripts;
 extern ScriptMapMapName sSpellScripts;
@@ -460,6 +550,39 @@ enum ScriptLoadResult
     SCRIPT_LOAD_ERR_OUTDATED,
 };
 
+/// Hooks a script library may implement per script name, see ScriptMgr::HasScriptHook
+enum ScriptHook
+{
+    SCRIPT_HOOK_GOSSIP_HELLO            = 0,
+    SCRIPT_HOOK_GO_GOSSIP_HELLO         = 1,
+    SCRIPT_HOOK_GOSSIP_SELECT           = 2,
+    SCRIPT_HOOK_GO_GOSSIP_SELECT        = 3,
+    SCRIPT_HOOK_GOSSIP_SELECT_CODE      = 4,
+    SCRIPT_HOOK_GO_GOSSIP_SELECT_CODE   = 5,
+    SCRIPT_HOOK_DIALOG_STATUS           = 6,
+    SCRIPT_HOOK_GO_DIALOG_STATUS        = 7,
+    SCRIPT_HOOK_QUEST_ACCEPT            = 8,
+    SCRIPT_HOOK_GO_QUEST_ACCEPT         = 9,
+    SCRIPT_HOOK_ITEM_QUEST_ACCEPT       = 10,
+    SCRIPT_HOOK_QUEST_REWARDED          = 11,
+    SCRIPT_HOOK_GO_QUEST_REWARDED       = 12,
+    SCRIPT_HOOK_GO_USE                  = 13,
+    SCRIPT_HOOK_ITEM_USE                = 14,
+    SCRIPT_HOOK_AREA_TRIGGER            = 15,
+    SCRIPT_HOOK_PROCESS_EVENT           = 16,
+    SCRIPT_HOOK_EFFECT_DUMMY            = 17,
+    SCRIPT_HOOK_GO_EFFECT_DUMMY         = 18,
+    SCRIPT_HOOK_ITEM_EFFECT_DUMMY       = 19,
+    SCRIPT_HOOK_EFFECT_SCRIPT_EFFECT    = 20,
+    SCRIPT_HOOK_AURA_DUMMY              = 21,
+    SCRIPT_HOOK_CREATURE_AI             = 22,
+    SCRIPT_HOOK_INSTANCE_DATA           = 23,
+    MAX_SCRIPT_HOOK                     = 24
+};
+
+#define SCRIPT_HOOK_MASK(hook)      (uint32(1) << (hook))
+#define SCRIPT_HOOK_MASK_ALL        (SCRIPT_HOOK_MASK(MAX_SCRIPT_HOOK) - 1)
+
 class ScriptMgr
 {
     public:
@@ -493,7 +616,23 @@ class ScriptMgr
         void UnloadScriptLibrary();
         bool IsScriptLibraryLoaded() const { return m_hScriptLib != NULL; }
 
+        /**
+         * @brief whether the script library implements the hook for the script name
+         *
+         * Filled from GetScriptHooks of the library after its init, so calls are only made
+         * into the library for scripts which have something to do.
+         *
+         * @param scriptId
+         * @param hook
+         * @return bool
+         */
+        bool HasScriptHook(uint32 scriptId, ScriptHook hook) const
+        {
+            return scriptId < m_scriptHooks.size() && (m_scriptHooks[scriptId] & SCRIPT_HOOK_MASK(hook));
+        }
+
         uint32 IncreaseScheduledScriptsCount() { return (uint32)++m_scheduledScripts; }
+        uint32 IncreaseScheduledScriptsCount(size_t count) { return (uint32)(m_scheduledScripts += count); }
         uint32 DecreaseScheduledScriptCount() { return (uint32)--m_scheduledScripts; }
         uint32 DecreaseScheduledScriptCount(size_t count) { return (uint32)(m_scheduledScripts -= count); }
         bool IsScriptScheduled() const { return m_scheduledScripts > 0; }
@@ -539,10 +678,13 @@ class ScriptMgr
         typedef UNORDERED_MAP<uint32, uint32> AreaTriggerScriptMap;
         typedef UNORDERED_MAP<uint32, uint32> EventIdScriptMap;
 
+        void LoadScriptHooks();
+
         AreaTriggerScriptMap    m_AreaTriggerScripts;
         EventIdScriptMap        m_EventIdScripts;
 
         ScriptNameMap           m_scriptNames;
+        std::vector<uint32>     m_scriptHooks;              // SCRIPT_HOOK_MASK per script id
         MANGOS_LIBRARY_HANDLE   m_hScriptLib;
 
         // atomic op counter for active scripts amount
@@ -551,6 +693,7 @@ class ScriptMgr
         void (MANGOS_IMPORT* m_pOnInitScriptLibrary)();
         void (MANGOS_IMPORT* m_pOnFreeScriptLibrary)();
         const char* (MANGOS_IMPORT* m_pGetScriptLibraryVersion)();
+        uint32 (MANGOS_IMPORT* m_pGetScriptHooks)(uint32);
 
         CreatureAI* (MANGOS_IMPORT* m_pGetCreatureAI)(Creature*);
         InstanceData* (MANGOS_IMPORT* m_pCreateInstanceData)(Map*);
@@ -0,0 +1,172 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "SessionKeyCache.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+#include <ace/INET_Addr.h>
+
+SessionKeyCache::SessionKeyCache() :
+    m_ttl(0), m_nextPurgeTime(0), m_active(false), m_stopping(false)
+{
+}
+
+SessionKeyCache& SessionKeyCache::Instance()
+{
+    static SessionKeyCache cache;
+    return cache;
+}
+
+int SessionKeyCache::Activate(uint16 port, std::string const& bindIp, std::string const& secret, uint32 ttl)
+{
+    if (m_active || !port)
+        { return 0; }
+
+    if (secret.empty())
+    {
+        sLog.outError("SessionKey.Secret is not set, session keys of realmd are not received");
+        return -1;
+    }
+
+    ACE_INET_Addr addr(port, bindIp.c_str());
+    if (m_socket.open(addr) == -1)
+    {
+        sLog.outError("SessionKeyCache: can't open UDP port %u, session keys of realmd are not received", uint32(port));
+        return -1;
+    }
+
+    m_secret = secret;
+    m_ttl = ttl;
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1)
+    {
+        sLog.outError("SessionKeyCache: can't start the thread, session keys of realmd are not received");
+        m_socket.close();
+        return -1;
+    }
+
+    m_active = true;
+    return 0;
+}
+
+void SessionKeyCache::Deactivate()
+{
+    if (!m_active)
+        { return; }
+
+    m_stopping = true;
+    ACE_Task_Base::wait();
+    m_socket.close();
+    m_active = false;
+}
+
+bool SessionKeyCache::Take(std::string const& account, SessionKeyMessage& message)
+{
+    if (!m_active)
+        { return false; }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
+    KeyMap::iterator itr = m_keys.find(account);
+    if (itr == m_keys.end() || itr->second.taken)
+        { return false; }
+
+    if (itr->second.expireTime <= time(NULL))
+    {
+        m_keys.erase(itr);
+        return false;
+    }
+
+    message = itr->second.message;
+    itr->second.taken = true;
+    return true;
+}
+
+void SessionKeyCache::Add(SessionKeyMessage const& message)
+{
+    time_t now = time(NULL);
+
+    // a replayed or long delayed datagram must not provide a key again
+    time_t expireTime = time_t(message.sendTime) + time_t(m_ttl);
+    if (expireTime <= now)
+        { return; }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    // a replay within the ttl finds its own key, taken or not, or the key of a later logon
+    KeyMap::iterator itr = m_keys.find(message.account);
+    if (itr != m_keys.end() && itr->second.expireTime > now && itr->second.message.sendTime >= message.sendTime)
+        { return; }
+
+    Entry& entry = m_keys[message.account];
+    entry.message = message;
+    entry.expireTime = expireTime;
+    entry.taken = false;
+
+    if (now < m_nextPurgeTime)
+        { return; }
+
+    for (KeyMap::iterator itr = m_keys.begin(); itr != m_keys.end();)
+    {
+        if (itr->second.expireTime <= now)
+            { m_keys.erase(itr++); }
+        else
+            { ++itr; }
+    }
+
+    m_nextPurgeTime = now + m_ttl;
+}
+
+int SessionKeyCache::svc()
+{
+    uint8 buf[SessionKeyMessage::MAX_SIZE];
+
+    while (!m_stopping)
+    {
+        // woken up every second to see the stop
+        ACE_Time_Value timeout(1);
+        ACE_INET_Addr from;
+
+        ssize_t size = m_socket.recv(buf, sizeof(buf), from, 0, &timeout);
+        if (size <= 0)
+            { continue; }
+
+        ByteBuffer packet;
+        packet.append(buf, size_t(size));
+
+        SessionKeyMessage message;
+        if (!message.Read(packet, m_secret))
+        {
+            sLog.outError("SessionKeyCache: invalid session key datagram from %s, check SessionKey.Secret", from.get_host_addr());
+            continue;
+        }
+
+        Add(message);
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_SESSIONKEYCACHE
+#define MANGOS_H_SESSIONKEYCACHE
+
+#include "Common.h"
+#include "Auth/SessionKeyMessage.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/SOCK_Dgram.h>
+
+#include <map>
+
+/**
+ * @brief session keys of fresh logons received from realmd, see SessionKeyMessage
+ *
+ * A thread receives the datagrams of realmd. WorldSocket::HandleAuthSession takes the key of
+ * the account from here and only reads the account from LoginDatabase if none arrived in time.
+ */
+class SessionKeyCache : protected ACE_Task_Base
+{
+    public:
+        static SessionKeyCache& Instance();
+
+        /**
+         * @brief starts the thread receiving the session keys
+         *
+         * @param port UDP port, 0 to receive none
+         * @param bindIp
+         * @param secret shared with realmd
+         * @param ttl seconds a key is kept waiting for the client
+         * @return int -1 if the port can't be opened
+         */
+        int Activate(uint16 port, std::string const& bindIp, std::string const& secret, uint32 ttl);
+        /// Stops and joins the thread
+        void Deactivate();
+        bool IsActive() const { return m_active; }
+
+        /**
+         * @brief takes the session key published for the account, each key and each datagram is used once
+         *
+         * @param account
+         * @param message
+         * @return bool false if there is none or it is expired
+         */
+        bool Take(std::string const& account, SessionKeyMessage& message);
+
+    protected:
+        int svc() override;
+
+    private:
+        SessionKeyCache();
+
+        struct Entry
+        {
+            SessionKeyMessage message;
+            time_t expireTime;                              // sendTime + ttl, a datagram can't extend it
+            bool taken;                                     // kept until expired, a replay of the datagram is refused
+        };
+
+        typedef std::map<std::string, Entry> KeyMap;
+
+        void Add(SessionKeyMessage const& message);
+
+        ACE_SOCK_Dgram m_socket;
+        std::string m_secret;
+        uint32 m_ttl;
+
+        ACE_Thread_Mutex m_lock;
+        KeyMap m_keys;
+        time_t m_nextPurgeTime;                             // expired keys of clients that never came are erased now and then
+
+        bool m_active;
+        volatile bool m_stopping;
+};
+
+#define sSessionKeyCache SessionKeyCache::Instance()
+
+#endif
@@ -0,0 +1,251 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "SlowTickWatchdog.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "World.h"
+#include "MapManager.h"
+#include "Map.h"
+#include "Database/DatabaseEnv.h"
+
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#define SLOW_TICK_MAX_EVENTS        100                     // longest profiler scopes in a report
+#define SLOW_TICK_MIN_EVENT_TIME    1000                    // in microseconds
+
+/// longer events first
+static bool CompareEventDuration(std::pair<uint32, ProfilerEvent> const& a, std::pair<uint32, ProfilerEvent> const& b)
+{
+    return a.second.duration > b.second.duration;
+}
+
+static bool CompareEventStart(std::pair<uint32, ProfilerEvent> const& a, std::pair<uint32, ProfilerEvent> const& b)
+{
+    return a.second.start < b.second.start;
+}
+
+/// async queue lengths of the three databases
+static std::string GetDatabaseQueues()
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "world %ld, characters %ld, login %ld",
+             WorldDatabase.GetAsyncQueueSize(), CharacterDatabase.GetAsyncQueueSize(), LoginDatabase.GetAsyncQueueSize());
+    return buf;
+}
+
+SlowTickWatchdog::SlowTickWatchdog() :
+    m_threshold(0), m_minInterval(0), m_profile(false), m_tickStart(0), m_tick(0), m_capturedTick(0),
+    m_nextReportTime(0), m_skippedReports(0), m_active(false), m_stopping(false)
+{
+}
+
+SlowTickWatchdog& SlowTickWatchdog::Instance()
+{
+    static SlowTickWatchdog watchdog;
+    return watchdog;
+}
+
+int SlowTickWatchdog::Activate(uint32 threshold, uint32 minInterval, bool profile)
+{
+    if (m_active || !threshold)
+        { return 0; }
+
+    m_threshold = threshold;
+    m_minInterval = minInterval;
+    m_profile = profile;
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1)
+    {
+        sLog.outError("SlowTickWatchdog: can't start the thread, slow world updates are not reported");
+        return -1;
+    }
+
+    if (m_profile)
+        { sTickProfiler.SetContinuous(true); }
+
+    m_active = true;
+    return 0;
+}
+
+void SlowTickWatchdog::Deactivate()
+{
+    if (!m_active)
+        { return; }
+
+    m_stopping = true;
+    ACE_Task_Base::wait();
+
+    if (m_profile)
+        { sTickProfiler.SetContinuous(false); }
+
+    m_active = false;
+}
+
+void SlowTickWatchdog::TickStarted()
+{
+    if (!m_active)
+        { return; }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_tickStart = TickProfiler::GetTime();
+    ++m_tick;
+}
+
+void SlowTickWatchdog::TickEnded()
+{
+    if (!m_active)
+        { return; }
+
+    uint64 tickStart;
+    std::string stall;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        tickStart = m_tickStart;
+        m_tickStart = 0;
+        stall.swap(m_stall);
+    }
+
+    uint64 tickTime = TickProfiler::GetTime() - tickStart;
+    if (tickTime < uint64(m_threshold) * 1000)
+        { return; }
+
+    time_t now = time(NULL);
+    if (now < m_nextReportTime)
+    {
+        ++m_skippedReports;
+        return;
+    }
+
+    m_nextReportTime = now + m_minInterval;
+    WriteReport(tickStart, tickTime, stall);
+    m_skippedReports = 0;
+}
+
+int SlowTickWatchdog::svc()
+{
+    // a few checks within the threshold, to note the stall soon after it is reached
+    ACE_Time_Value interval(0, std::max(m_threshold / 4, uint32(10)) * 1000);
+
+    while (!m_stopping)
+    {
+        ACE_OS::sleep(interval);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        if (!m_tickStart || m_capturedTick == m_tick)
+            { continue; }
+
+        uint64 elapsed = TickProfiler::GetTime() - m_tickStart;
+        if (elapsed < uint64(m_threshold) * 1000)
+            { continue; }
+
+        m_capturedTick = m_tick;
+        CaptureStall(elapsed);
+    }
+
+    return 0;
+}
+
+void SlowTickWatchdog::CaptureStall(uint64 elapsed)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "  At " UI64FMTD " ms:\n", elapsed / 1000);
+    m_stall = buf;
+
+    std::vector<ThreadActivity> activities;
+    sTickProfiler.CollectActivities(activities);
+
+    for (std::vector<ThreadActivity>::const_iterator itr = activities.begin(); itr != activities.end(); ++itr)
+    {
+        if (!itr->activity)
+            { continue; }
+
+        snprintf(buf, sizeof(buf), "    thread %u (%s): %s %u\n", itr->threadId, itr->threadName ? itr->threadName : "unnamed",
+                 itr->activity, itr->id);
+        m_stall += buf;
+    }
+
+    m_stall += "    DB async queues: " + GetDatabaseQueues() + "\n";
+}
+
+void SlowTickWatchdog::WriteReport(uint64 tickStart, uint64 tickTime, std::string const& stall)
+{
+    std::string fileName = sLog.GetLogsDir() + "slowtick.log";
+    FILE* file = fopen(fileName.c_str(), "a");
+    if (!file)
+    {
+        sLog.outError("SlowTickWatchdog: can't open %s", fileName.c_str());
+        return;
+    }
+
+    time_t now = time(NULL);
+    tm* aTm = localtime(&now);
+    fprintf(file, "%04d-%02d-%02d %02d:%02d:%02d World update took " UI64FMTD " ms, threshold %u ms, %u slow updates not reported before\n",
+            aTm->tm_year + 1900, aTm->tm_mon + 1, aTm->tm_mday, aTm->tm_hour, aTm->tm_min, aTm->tm_sec,
+            tickTime / 1000, m_threshold, m_skippedReports);
+
+    fputs(stall.c_str(), file);
+
+    fprintf(file, "  At the end:\n");
+    fprintf(file, "    sessions: %u active, %u queued\n", sWorld.GetActiveSessionCount(), sWorld.GetQueuedSessionCount());
+    fprintf(file, "    DB async queues: %s\n", GetDatabaseQueues().c_str());
+
+    MapManager::MapMapType const& maps = sMapMgr.Maps();
+    for (MapManager::MapMapType::const_iterator itr = maps.begin(); itr != maps.end(); ++itr)
+    {
+        if (uint32 players = itr->second->GetPlayers().getSize())
+            { fprintf(file, "    map %u instance %u: %u players, %u grids\n", itr->first.nMapId, itr->first.nInstanceId, players, itr->second->GetLoadedGridCount()); }
+    }
+
+    if (m_profile)
+    {
+        ProfilerThreadEvents events;
+        sTickProfiler.CollectEvents(tickStart, SLOW_TICK_MIN_EVENT_TIME, events);
+
+        if (events.size() > SLOW_TICK_MAX_EVENTS)
+        {
+            std::partial_sort(events.begin(), events.begin() + SLOW_TICK_MAX_EVENTS, events.end(), CompareEventDuration);
+            events.resize(SLOW_TICK_MAX_EVENTS);
+        }
+        std::sort(events.begin(), events.end(), CompareEventStart);
+
+        fprintf(file, "  Scopes of at least %u ms, start in the update and duration in ms:\n", SLOW_TICK_MIN_EVENT_TIME / 1000);
+        for (ProfilerThreadEvents::const_iterator itr = events.begin(); itr != events.end(); ++itr)
+        {
+            fprintf(file, "    %8.1f %8.1f  thread %u: %s %u\n", (itr->second.start - tickStart) / 1000.0, itr->second.duration / 1000.0,
+                    itr->first, itr->second.name, itr->second.id);
+        }
+    }
+
+    fputs("\n", file);
+    fclose(file);
+
+    sLog.outError("World update took " UI64FMTD " ms, diagnostics are written to %s", tickTime / 1000, fileName.c_str());
+}
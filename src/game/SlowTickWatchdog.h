@@ -0,0 +1,92 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_SLOWTICKWATCHDOG
+#define MANGOS_H_SLOWTICKWATCHDOG
+
+#include "Common.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+
+/**
+ * @brief writes diagnostics of world updates longer than SlowTick.Threshold to slowtick.log
+ *
+ * A thread watches the running update and notes what every thread is doing and the DB queues once
+ * the update is over the threshold, while it is still stuck. When the update ends the world thread
+ * adds the players of the maps and, with SlowTick.Profile, the longest profiler scopes of the update.
+ */
+class SlowTickWatchdog : protected ACE_Task_Base
+{
+    public:
+        static SlowTickWatchdog& Instance();
+
+        /**
+         * @brief starts the watching thread, called by the world thread
+         *
+         * @param threshold update time in ms, 0 to watch nothing
+         * @param minInterval seconds between two reports, the slow updates between are only counted
+         * @param profile keep the tick profiler recording for the reports
+         * @return int -1 if the thread can't be started
+         */
+        int Activate(uint32 threshold, uint32 minInterval, bool profile);
+        /// Stops and joins the thread
+        void Deactivate();
+        bool IsActive() const { return m_active; }
+
+        /// called by the world thread before and after each World::Update
+        void TickStarted();
+        void TickEnded();
+
+    protected:
+        int svc() override;
+
+    private:
+        SlowTickWatchdog();
+
+        /// notes the threads and DB queues of the stuck update, called by the watching thread
+        void CaptureStall(uint64 elapsed);
+        void WriteReport(uint64 tickStart, uint64 tickTime, std::string const& stall);
+
+        uint32 m_threshold;                                 // in ms
+        uint32 m_minInterval;
+        bool m_profile;
+
+        ACE_Thread_Mutex m_lock;
+        uint64 m_tickStart;                                 // in microseconds, 0 between updates
+        uint32 m_tick;
+        uint32 m_capturedTick;                              // update the stall was noted for
+        std::string m_stall;
+
+        time_t m_nextReportTime;
+        uint32 m_skippedReports;
+
+        bool m_active;
+        volatile bool m_stopping;
+};
+
+#define sSlowTickWatchdog SlowTickWatchdog::Instance()
+
+#endif
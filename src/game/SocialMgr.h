@@ -77,6 +77,8 @@ struct FriendInfo
 
 typedef std::map<uint32, FriendInfo> PlayerSocialMap;
 typedef std::map<uint32, PlayerSocial> SocialMap;
+/// @brief online players having the player of the key on their friend list
+typedef std::map<uint32, std::set<uint32> > FriendListersMap;
 
 /// Results of friend related commands
 enum FriendsResult
@@ -142,7 +144,7 @@ class SocialMgr
         SocialMgr();
         ~SocialMgr();
         // Misc
-        void RemovePlayerSocial(uint32 guid) { m_socialMap.erase(guid); }
+        void RemovePlayerSocial(uint32 guid);
 
         void GetFriendInfo(Player* player, uint32 friendGUID, FriendInfo& friendInfo);
         // Packet management
@@ -152,7 +154,13 @@ class SocialMgr
         // Loading
         PlayerSocial* LoadFromDB(QueryResult* result, ObjectGuid guid);
     private:
+        friend class PlayerSocial;
+
+        void AddFriendLister(uint32 friendGuid, uint32 listerGuid) { m_friendListers[friendGuid].insert(listerGuid); }
+        void RemoveFriendLister(uint32 friendGuid, uint32 listerGuid);
+
         SocialMap m_socialMap;
+        FriendListersMap m_friendListers;                   // reverse index of the friend lists in m_socialMap
 };
 
 #define sSocialMgr MaNGOS::Singleton<SocialMgr>::Instance()
@@ -0,0 +1,217 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "SpatialHash.h"
+#include "Unit.h"
+#include "GridDefines.h"
+
+#include <ace/TSS_T.h>
+
+#define REUSED_UNIT_VECTORS 8
+#define NO_STORAGE uint32(-1)
+
+/// Storages of the ReusedUnitVector of one thread
+struct ReusedUnitVectorPool
+{
+    ReusedUnitVectorPool() { memset(inUse, 0, sizeof(inUse)); }
+
+    std::vector<Unit*> storages[REUSED_UNIT_VECTORS];
+    bool inUse[REUSED_UNIT_VECTORS];
+};
+
+typedef ACE_TSS<ReusedUnitVectorPool> ReusedUnitVectorPoolTSS;
+static ReusedUnitVectorPoolTSS reusedUnitVectorPool;
+
+ReusedUnitVector::ReusedUnitVector() : m_storage(NO_STORAGE)
+{
+    ReusedUnitVectorPool* pool = reusedUnitVectorPool;      // created at the first use of the thread
+    for (uint32 i = 0; i < REUSED_UNIT_VECTORS; ++i)
+    {
+        if (!pool->inUse[i])
+        {
+            pool->inUse[i] = true;
+            swap(pool->storages[i]);
+            m_storage = i;
+            return;
+        }
+    }
+}
+
+ReusedUnitVector::~ReusedUnitVector()
+{
+    if (m_storage == NO_STORAGE)
+        { return; }
+
+    // a few huge searches shouldn't keep their memory for the rest of the thread
+    if (capacity() > 4096)
+        { std::vector<Unit*>().swap(*this); }
+
+    clear();
+
+    ReusedUnitVectorPool* pool = reusedUnitVectorPool;
+    swap(pool->storages[m_storage]);
+    pool->inUse[m_storage] = false;
+}
+
+uint32 SpatialHash::ComputeBucketCoord(float c)
+{
+    MaNGOS::NormalizeMapCoord(c);
+    return uint32((c + MAP_HALFSIZE) / SPATIAL_HASH_BUCKET_SIZE);
+}
+
+uint32 SpatialHash::ComputeBucketId(float x, float y, float boundingRadius)
+{
+    if (boundingRadius > SPATIAL_HASH_MAX_BUCKETED_RADIUS)
+        { return LARGE_UNITS_BUCKET; }
+
+    return ComputeBucketId(x, y);
+}
+
+void SpatialHash::Bucket::push_back(float posX, float posY, float radius, Unit* unit)
+{
+    x.push_back(posX);
+    y.push_back(posY);
+    boundingRadius.push_back(radius);
+    units.push_back(unit);
+}
+
+void SpatialHash::Bucket::move(size_t from, size_t to)
+{
+    x[to] = x[from];
+    y[to] = y[from];
+    boundingRadius[to] = boundingRadius[from];
+    units[to] = units[from];
+}
+
+void SpatialHash::Bucket::pop_back()
+{
+    x.pop_back();
+    y.pop_back();
+    boundingRadius.pop_back();
+    units.pop_back();
+}
+
+void SpatialHash::Insert(Unit* unit)
+{
+    SpatialHashSlot& slot = unit->GetSpatialHashSlot();
+    if (slot.IsValid())
+        { return; }
+
+    float x = unit->GetPositionX();
+    float y = unit->GetPositionY();
+    float boundingRadius = unit->GetObjectBoundingRadius();
+
+    slot.bucket = ComputeBucketId(x, y, boundingRadius);
+    Bucket& bucket = GetBucket(slot.bucket);
+    slot.index = bucket.size();
+    bucket.push_back(x, y, boundingRadius, unit);
+}
+
+void SpatialHash::Remove(Unit* unit)
+{
+    SpatialHashSlot& slot = unit->GetSpatialHashSlot();
+    if (!slot.IsValid())
+        { return; }
+
+    Bucket& bucket = GetBucket(slot.bucket);
+    MANGOS_ASSERT(slot.index < bucket.size() && bucket.units[slot.index] == unit);
+
+    // move the last unit into the freed place
+    uint32 last = bucket.size() - 1;
+    if (slot.index != last)
+    {
+        bucket.move(last, slot.index);
+        bucket.units[slot.index]->GetSpatialHashSlot().index = slot.index;
+    }
+    bucket.pop_back();
+
+    if (bucket.empty() && slot.bucket != LARGE_UNITS_BUCKET)
+        { m_buckets.erase(slot.bucket); }
+
+    slot = SpatialHashSlot();
+}
+
+void SpatialHash::Relocate(Unit* unit)
+{
+    SpatialHashSlot& slot = unit->GetSpatialHashSlot();
+    if (!slot.IsValid())
+        { return; }
+
+    float x = unit->GetPositionX();
+    float y = unit->GetPositionY();
+    float boundingRadius = unit->GetObjectBoundingRadius();
+
+    if (ComputeBucketId(x, y, boundingRadius) != slot.bucket)
+    {
+        Remove(unit);
+        Insert(unit);
+        return;
+    }
+
+    Bucket& bucket = GetBucket(slot.bucket);
+    bucket.x[slot.index] = x;
+    bucket.y[slot.index] = y;
+    bucket.boundingRadius[slot.index] = boundingRadius;
+}
+
+void SpatialHash::QueryBucket(Bucket const& bucket, float x, float y, float radius, std::vector<Unit*>& units)
+{
+    for (size_t i = 0; i < bucket.size(); ++i)
+    {
+        float reach = radius + bucket.boundingRadius[i];
+        if (std::fabs(bucket.x[i] - x) <= reach && std::fabs(bucket.y[i] - y) <= reach)
+            { units.push_back(bucket.units[i]); }
+    }
+}
+
+void SpatialHash::Query(float x, float y, float radius, std::vector<Unit*>& units) const
+{
+    uint32 standing = ComputeBucketId(x, y);
+    BucketMap::const_iterator itr = m_buckets.find(standing);
+    if (itr != m_buckets.end())
+        { QueryBucket(itr->second, x, y, radius, units); }
+
+    // bucketed units reach at most SPATIAL_HASH_MAX_BUCKETED_RADIUS out of their bucket
+    float reach = radius + SPATIAL_HASH_MAX_BUCKETED_RADIUS;
+    uint32 lowX = ComputeBucketCoord(x - reach);
+    uint32 highX = ComputeBucketCoord(x + reach);
+    uint32 lowY = ComputeBucketCoord(y - reach);
+    uint32 highY = ComputeBucketCoord(y + reach);
+
+    for (uint32 bucketX = lowX; bucketX <= highX; ++bucketX)
+    {
+        for (uint32 bucketY = lowY; bucketY <= highY; ++bucketY)
+        {
+            uint32 bucketId = (bucketX << 16) | bucketY;
+            if (bucketId == standing)
+                { continue; }
+
+            itr = m_buckets.find(bucketId);
+            if (itr != m_buckets.end())
+                { QueryBucket(itr->second, x, y, radius, units); }
+        }
+    }
+
+    QueryBucket(m_largeUnits, x, y, radius, units);
+}
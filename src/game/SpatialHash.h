@@ -0,0 +1,138 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_SPATIALHASH_H
+#define MANGOS_SPATIALHASH_H
+
+#include "Common.h"
+#include "Utilities/UnorderedMapSet.h"
+
+#include <vector>
+
+class Unit;
+
+#define SPATIAL_HASH_BUCKET_SIZE 8.0f
+// units with larger bounding radius are checked by every search
+#define SPATIAL_HASH_MAX_BUCKETED_RADIUS (SPATIAL_HASH_BUCKET_SIZE / 2)
+
+/// Position of a unit inside the SpatialHash of its map
+struct SpatialHashSlot
+{
+    static const uint32 INVALID_BUCKET = uint32(-1);
+
+    SpatialHashSlot() : bucket(INVALID_BUCKET), index(0) {}
+
+    bool IsValid() const { return bucket != INVALID_BUCKET; }
+
+    uint32 bucket;
+    uint32 index;
+};
+
+/**
+ * Fine grained buckets of the creatures and players in world of a map, kept next to the grid cells.
+ *
+ * Short range searches (melee cleaves, small AoE, proximity checks) visit whole 33 yard cells and their
+ * object lists. The hash buckets units in SPATIAL_HASH_BUCKET_SIZE squares storing their positions in
+ * one array per coordinate, so such searches only touch the units stored near the searched square. Like the grid
+ * search a unit is found if its bounding circle reaches into the square around the search center.
+ *
+ * Units are inserted at Unit::AddToWorld, moved at WorldObject::Relocate and Unit::UpdateModelData, and
+ * removed at Unit::RemoveFromWorld. Map wraps the calls with its region lock, see Map::VisitUnitsInRange.
+ */
+class MANGOS_DLL_SPEC SpatialHash
+{
+    public:
+        explicit SpatialHash(float maxSearchRadius) : m_maxSearchRadius(maxSearchRadius) {}
+
+        /// Largest search radius served by the hash, longer searches visit the grid cells
+        float GetMaxSearchRadius() const { return m_maxSearchRadius; }
+
+        void Insert(Unit* unit);
+        void Remove(Unit* unit);
+        void Relocate(Unit* unit);
+
+        /// Append the units reaching into x, y +- radius, units of the bucket containing x, y first
+        void Query(float x, float y, float radius, std::vector<Unit*>& units) const;
+
+    private:
+        // units of a bucket, all vectors indexed by SpatialHashSlot::index
+        struct Bucket
+        {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> boundingRadius;
+            std::vector<Unit*> units;
+
+            size_t size() const { return units.size(); }
+            bool empty() const { return units.empty(); }
+            void push_back(float posX, float posY, float radius, Unit* unit);
+            void move(size_t from, size_t to);
+            void pop_back();
+        };
+        typedef UNORDERED_MAP<uint32, Bucket> BucketMap;
+
+        static const uint32 LARGE_UNITS_BUCKET = uint32(-2);
+
+        static uint32 ComputeBucketCoord(float c);
+        static uint32 ComputeBucketId(float x, float y) { return (ComputeBucketCoord(x) << 16) | ComputeBucketCoord(y); }
+        static uint32 ComputeBucketId(float x, float y, float boundingRadius);
+
+        Bucket& GetBucket(uint32 bucketId) { return bucketId == LARGE_UNITS_BUCKET ? m_largeUnits : m_buckets[bucketId]; }
+
+        static void QueryBucket(Bucket const& bucket, float x, float y, float radius, std::vector<Unit*>& units);
+
+        float m_maxSearchRadius;
+        BucketMap m_buckets;
+        Bucket m_largeUnits;
+};
+
+/**
+ * Unit vector taking the storage of a vector used before by the same thread and handing it back when it
+ * goes out of scope, so unit searches and spell target selections don't allocate for each call. Only
+ * meant for local variables, a thread lends out a few storages at once, further ones are plain vectors.
+ */
+class MANGOS_DLL_SPEC ReusedUnitVector : public std::vector<Unit*>
+{
+    public:
+        ReusedUnitVector();
+        ~ReusedUnitVector();
+
+    private:
+        ReusedUnitVector(ReusedUnitVector const&);
+        ReusedUnitVector& operator=(ReusedUnitVector const&);
+
+        uint32 m_storage;                                   // index in the pool of the thread, or none
+};
+
+/**
+ * Visitors that only look at creatures and players can be served by the SpatialHash of the map.
+ * They accept each unit by VisitUnit(Unit*) and specialize this to true, see Cell::VisitAllObjects.
+ */
+template<class VISITOR>
+struct IsUnitVisitor
+{
+    static const bool value = false;
+};
+
+#endif
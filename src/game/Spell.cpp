@@ -52,6 +52,7 @@
 #include "Chat.h"
 #include "SQLStorages.h"
 #include "LuaEngine.h"
+#include "SpellStats.h"
 
 extern pEffect SpellEffects[TOTAL_SPELL_EFFECTS];
 
@@ -380,7 +381,7 @@ void Spell::FillTargetMap()
 {
     // TODO: ADD the correct target FILLS!!!!!!
 
-    UnitList tmpUnitLists[MAX_EFFECT_INDEX];                // Stores the temporary Target Lists for each effect
+    ReusedUnitVector tmpUnitLists[MAX_EFFECT_INDEX];        // Stores the temporary Target Lists for each effect
     uint8 effToIndex[MAX_EFFECT_INDEX] = {0, 1, 2};         // Helper array, to link to another tmpUnitList, if the targets for both effects match
     for (int i = 0; i < MAX_EFFECT_INDEX; ++i)
     {
@@ -891,6 +892,8 @@ void Spell::DoAllEffectOnTarget(TargetInfo* target)
         { return; }
     target->processed = true;                               // Target checked in apply effects procedure
 
+    SpellStatsTimer statsTimer(m_spellInfo->Id, SPELL_STATS_EFFECT_ON_TARGET);
+
     // Get mask of effects for target
     uint32 mask = target->effectMask;
 
@@ -1465,6 +1468,8 @@ struct TargetDistanceOrderNear : public std::binary_function<const Unit, const U
 
 void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList& targetUnitMap)
 {
+    SpellStatsTimer statsTimer(m_spellInfo->Id, SPELL_STATS_TARGET_MAP);
+
     float radius;
     uint32 EffectChainTarget = m_spellInfo->EffectChainTarget[effIndex];
     uint32 unMaxTargets = m_spellInfo->MaxAffectedTargets;  // Get spell max affected targets
@@ -1510,18 +1515,18 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             unMaxTargets = EffectChainTarget;
             float max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
 
-            UnitList tempTargetUnitMap;
+            ReusedUnitVector tempTargetUnitMap;
 
             {
                 MaNGOS::AnyAoETargetUnitInObjectRangeCheck u_check(m_caster, max_range);
-                MaNGOS::UnitListSearcher<MaNGOS::AnyAoETargetUnitInObjectRangeCheck> searcher(tempTargetUnitMap, u_check);
+                MaNGOS::UnitListSearcher<MaNGOS::AnyAoETargetUnitInObjectRangeCheck, UnitList> searcher(tempTargetUnitMap, u_check);
                 Cell::VisitAllObjects(m_caster, searcher, max_range);
             }
 
             if (tempTargetUnitMap.empty())
                 { break; }
 
-            tempTargetUnitMap.sort(TargetDistanceOrderNear(m_caster));
+            std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(m_caster));
 
             // Now to get us a random target that's in the initial range of the spell
             uint32 t = 0;
@@ -1539,7 +1544,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
 
             tempTargetUnitMap.erase(itr);
 
-            tempTargetUnitMap.sort(TargetDistanceOrderNear(pUnitTarget));
+            std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(pUnitTarget));
 
             t = unMaxTargets - 1;
             Unit* prev = pUnitTarget;
@@ -1559,7 +1564,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 prev = *next;
                 targetUnitMap.push_back(prev);
                 tempTargetUnitMap.erase(next);
-                tempTargetUnitMap.sort(TargetDistanceOrderNear(prev));
+                std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(prev));
                 next = tempTargetUnitMap.begin();
 
                 --t;
@@ -1571,17 +1576,17 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             m_targets.m_targetMask = 0;
             unMaxTargets = EffectChainTarget;
             float max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
-            UnitList tempTargetUnitMap;
+            ReusedUnitVector tempTargetUnitMap;
             {
                 MaNGOS::AnyFriendlyUnitInObjectRangeCheck u_check(m_caster, max_range);
-                MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck> searcher(tempTargetUnitMap, u_check);
+                MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck, UnitList> searcher(tempTargetUnitMap, u_check);
                 Cell::VisitAllObjects(m_caster, searcher, max_range);
             }
 
             if (tempTargetUnitMap.empty())
                 { break; }
 
-            tempTargetUnitMap.sort(TargetDistanceOrderNear(m_caster));
+            std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(m_caster));
 
             // Now to get us a random target that's in the initial range of the spell
             uint32 t = 0;
@@ -1599,7 +1604,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
 
             tempTargetUnitMap.erase(itr);
 
-            tempTargetUnitMap.sort(TargetDistanceOrderNear(pUnitTarget));
+            std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(pUnitTarget));
 
             t = unMaxTargets - 1;
             Unit* prev = pUnitTarget;
@@ -1618,7 +1623,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 prev = *next;
                 targetUnitMap.push_back(prev);
                 tempTargetUnitMap.erase(next);
-                tempTargetUnitMap.sort(TargetDistanceOrderNear(prev));
+                std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(prev));
                 next = tempTargetUnitMap.begin();
                 --t;
             }
@@ -1657,17 +1662,17 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                     // FIXME: This very like horrible hack and wrong for most spells
                     { max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS; }
 
-                UnitList tempTargetUnitMap;
+                ReusedUnitVector tempTargetUnitMap;
                 {
                     MaNGOS::AnyAoEVisibleTargetUnitInObjectRangeCheck u_check(pUnitTarget, originalCaster, max_range);
-                    MaNGOS::UnitListSearcher<MaNGOS::AnyAoEVisibleTargetUnitInObjectRangeCheck> searcher(tempTargetUnitMap, u_check);
+                    MaNGOS::UnitListSearcher<MaNGOS::AnyAoEVisibleTargetUnitInObjectRangeCheck, UnitList> searcher(tempTargetUnitMap, u_check);
                     Cell::VisitAllObjects(m_caster, searcher, max_range);
                 }
 
                 if (tempTargetUnitMap.empty())
                     { break; }
 
-                tempTargetUnitMap.sort(TargetDistanceOrderNear(pUnitTarget));
+                std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(pUnitTarget));
 
                 if (*tempTargetUnitMap.begin() == pUnitTarget)
                     { tempTargetUnitMap.erase(tempTargetUnitMap.begin()); }
@@ -1691,7 +1696,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                     prev = *next;
                     targetUnitMap.push_back(prev);
                     tempTargetUnitMap.erase(next);
-                    tempTargetUnitMap.sort(TargetDistanceOrderNear(prev));
+                    std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(prev));
                     next = tempTargetUnitMap.begin();
 
                     --t;
@@ -1715,7 +1720,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                         { targetB = SPELL_TARGETS_FRIENDLY; }
             }
 
-            UnitList tempTargetUnitMap;
+            ReusedUnitVector tempTargetUnitMap;
             SQLMultiStorage::SQLMSIteratorBounds<SpellTargetEntry> bounds = sSpellScriptTargetStorage.getBounds<SpellTargetEntry>(m_spellInfo->Id);
 
             // fill real target list if no spell script target defined
@@ -1756,7 +1761,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
             }
 
             // exclude caster
-            targetUnitMap.remove(m_caster);
+            targetUnitMap.erase(std::remove(targetUnitMap.begin(), targetUnitMap.end(), m_caster), targetUnitMap.end());
             break;
         }
         case TARGET_AREAEFFECT_CUSTOM:
@@ -1769,7 +1774,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 break;
             }
 
-            UnitList tempTargetUnitMap;
+            ReusedUnitVector tempTargetUnitMap;
             SQLMultiStorage::SQLMSIteratorBounds<SpellTargetEntry> bounds = sSpellScriptTargetStorage.getBounds<SpellTargetEntry>(m_spellInfo->Id);
             // fill real target list if no spell script target defined
             FillAreaTargets(bounds.first != bounds.second ? tempTargetUnitMap : targetUnitMap, radius, PUSH_DEST_CENTER, SPELL_TARGETS_ALL);
@@ -1812,7 +1817,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 for (UnitList::iterator itr = targetUnitMap.begin(); itr != targetUnitMap.end();)
                 {
                     if (!(*itr)->IsTargetableForAttack(m_spellInfo->HasAttribute(SPELL_ATTR_EX3_CAST_ON_DEAD)))
-                        { targetUnitMap.erase(itr++); }
+                        { itr = targetUnitMap.erase(itr); }
                     else
                         { ++itr; }
                 }
@@ -2119,14 +2124,14 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                 unMaxTargets = EffectChainTarget;
                 float max_range = radius + unMaxTargets * CHAIN_SPELL_JUMP_RADIUS;
 
-                UnitList tempTargetUnitMap;
+                ReusedUnitVector tempTargetUnitMap;
 
                 FillAreaTargets(tempTargetUnitMap, max_range, PUSH_SELF_CENTER, SPELL_TARGETS_FRIENDLY);
 
                 if (m_caster != pUnitTarget && std::find(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), m_caster) == tempTargetUnitMap.end())
-                    { tempTargetUnitMap.push_front(m_caster); }
+                    { tempTargetUnitMap.insert(tempTargetUnitMap.begin(), m_caster); }
 
-                tempTargetUnitMap.sort(TargetDistanceOrderNear(pUnitTarget));
+                std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(pUnitTarget));
 
                 if (tempTargetUnitMap.empty())
                     { break; }
@@ -2159,7 +2164,7 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
                     prev = *next;
                     targetUnitMap.push_back(prev);
                     tempTargetUnitMap.erase(next);
-                    tempTargetUnitMap.sort(TargetDistanceOrderNear(prev));
+                    std::stable_sort(tempTargetUnitMap.begin(), tempTargetUnitMap.end(), TargetDistanceOrderNear(prev));
                     next = tempTargetUnitMap.begin();
 
                     --t;
@@ -2415,17 +2420,16 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
     {
         // make sure one unit is always removed per iteration
         uint32 removed_utarget = 0;
-        for (UnitList::iterator itr = targetUnitMap.begin(), next; itr != targetUnitMap.end(); itr = next)
+        for (UnitList::iterator itr = targetUnitMap.begin(); itr != targetUnitMap.end();)
         {
-            next = itr;
-            ++next;
-            if (!*itr) { continue; }
-            if ((*itr) == m_targets.getUnitTarget())
+            if (*itr && (*itr) == m_targets.getUnitTarget())
             {
-                targetUnitMap.erase(itr);
+                itr = targetUnitMap.erase(itr);
                 removed_utarget = 1;
                 //        break;
             }
+            else
+                { ++itr; }
         }
         // remove random units from the map
         while (targetUnitMap.size() > unMaxTargets - removed_utarget)
@@ -2488,6 +2492,8 @@ void Spell::SetTargetMap(SpellEffectIndex effIndex, uint32 targetMode, UnitList&
 
 void Spell::prepare(SpellCastTargets const* targets, Aura* triggeredByAura)
 {
+    SpellStatsTimer statsTimer(m_spellInfo->Id, SPELL_STATS_PREPARE);
+
     m_targets = *targets;
 
     m_spellState = SPELL_STATE_PREPARING;
@@ -2619,6 +2625,8 @@ void Spell::cancel()
 
 void Spell::cast(bool skipCheck)
 {
+    SpellStatsTimer statsTimer(m_spellInfo->Id, SPELL_STATS_CAST);
+
     SetExecutedCurrently(true);
 
     if (!m_caster->CheckAndIncreaseCastCounter())
@@ -2751,6 +2759,8 @@ void Spell::cast(bool skipCheck)
 
     FillTargetMap();
 
+    sSpellStats.CountTargets(m_spellInfo->Id, uint32(m_UniqueTargetInfo.size() + m_UniqueGOTargetInfo.size() + m_UniqueItemInfo.size()));
+
     if (m_spellState == SPELL_STATE_FINISHED)               // stop cast if spell marked as finish somewhere in FillTargetMap
     {
         m_caster->DecreaseCastCounter();
@@ -3846,6 +3856,7 @@ void Spell::HandleEffects(Unit* pUnitTarget, Item* pItemTarget, GameObject* pGOT
 
     if (eff < TOTAL_SPELL_EFFECTS)
     {
+        SpellStatsTimer statsTimer(m_spellInfo->Id, SPELL_STATS_EFFECT_HANDLER);
         (*this.*SpellEffects[eff])(i);
     }
     else
@@ -4535,7 +4546,7 @@ SpellCastResult Spell::CheckCast(bool strict)
             {
                 if (m_targets.m_targetMask & (TARGET_FLAG_DEST_LOCATION | TARGET_FLAG_SOURCE_LOCATION))
                 {
-                    UnitList targetsCombat;
+                    ReusedUnitVector targetsCombat;
                     float radius = GetSpellRadius(sSpellRadiusStore.LookupEntry(m_spellInfo->EffectRadiusIndex[i]));
 
                     FillAreaTargets(targetsCombat, radius, PUSH_DEST_CENTER, SPELL_TARGETS_AOE_DAMAGE);
@@ -33,6 +33,7 @@
 #include "LootMgr.h"
 #include "Unit.h"
 #include "Player.h"
+#include "MemoryTracker.h"
 
 class WorldSession;
 class WorldPacket;
@@ -212,7 +213,7 @@ enum SpellTargets
 
 typedef std::multimap<uint64, uint64> SpellTargetTimeMap;
 
-class Spell
+class Spell : public MemoryTracked<MEM_TAG_SPELL>
 {
         friend struct MaNGOS::SpellNotifierPlayer;
         friend struct MaNGOS::SpellNotifierCreatureAndPlayer;
@@ -436,7 +437,7 @@ class Spell
         void CleanupTargetList();
         void ClearCastItem();
 
-        typedef std::list<Unit*> UnitList;
+        typedef std::vector<Unit*> UnitList;                // ReusedUnitVector for temporary lists
 
     protected:
         bool HasGlobalCooldown();
@@ -551,9 +552,10 @@ class Spell
             uint8 effectMask;
         };
 
-        typedef std::list<TargetInfo>     TargetList;
-        typedef std::list<GOTargetInfo>   GOTargetList;
-        typedef std::list<ItemTargetInfo> ItemTargetList;
+        // targets are only added at Spell::FillTargetMap and Spell::CheckCast, never while iterating them
+        typedef std::vector<TargetInfo>     TargetList;
+        typedef std::vector<GOTargetInfo>   GOTargetList;
+        typedef std::vector<ItemTargetInfo> ItemTargetList;
 
         TargetList     m_UniqueTargetInfo;
         GOTargetList   m_UniqueGOTargetInfo;
@@ -698,93 +700,96 @@ namespace MaNGOS
         }
 
         template<class T> inline void Visit(GridRefManager<T>&  m)
+        {
+            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+                { VisitUnit(itr->getSource()); }
+        }
+
+        void VisitUnit(Unit* unit)
         {
             MANGOS_ASSERT(i_data);
 
             if (!i_originalCaster || !i_castingObject)
                 { return; }
 
-            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
-            {
-                // there are still more spells which can be casted on dead, but
-                // they are no AOE and don't have such a nice SPELL_ATTR flag
-                if ((i_TargetType != SPELL_TARGETS_ALL && !itr->getSource()->IsTargetableForAttack(i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX3_CAST_ON_DEAD)))
-                    // mostly phase check
-                    || !itr->getSource()->IsInMap(i_originalCaster))
-                    { continue; }
+            // there are still more spells which can be casted on dead, but
+            // they are no AOE and don't have such a nice SPELL_ATTR flag
+            if ((i_TargetType != SPELL_TARGETS_ALL && !unit->IsTargetableForAttack(i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX3_CAST_ON_DEAD)))
+                // mostly phase check
+                || !unit->IsInMap(i_originalCaster))
+                { return; }
 
-                switch (i_TargetType)
+            switch (i_TargetType)
+            {
+                case SPELL_TARGETS_HOSTILE:
+                    if (!i_originalCaster->IsHostileTo(unit))
+                        { return; }
+                    break;
+                case SPELL_TARGETS_NOT_FRIENDLY:
+                    if (i_originalCaster->IsFriendlyTo(unit))
+                        { return; }
+                    break;
+                case SPELL_TARGETS_NOT_HOSTILE:
+                    if (i_originalCaster->IsHostileTo(unit))
+                        { return; }
+                    break;
+                case SPELL_TARGETS_FRIENDLY:
+                    if (!i_originalCaster->IsFriendlyTo(unit))
+                        { return; }
+                    break;
+                case SPELL_TARGETS_AOE_DAMAGE:
                 {
-                    case SPELL_TARGETS_HOSTILE:
-                        if (!i_originalCaster->IsHostileTo(itr->getSource()))
-                            { continue; }
-                        break;
-                    case SPELL_TARGETS_NOT_FRIENDLY:
-                        if (i_originalCaster->IsFriendlyTo(itr->getSource()))
-                            { continue; }
-                        break;
-                    case SPELL_TARGETS_NOT_HOSTILE:
-                        if (i_originalCaster->IsHostileTo(itr->getSource()))
-                            { continue; }
-                        break;
-                    case SPELL_TARGETS_FRIENDLY:
-                        if (!i_originalCaster->IsFriendlyTo(itr->getSource()))
-                            { continue; }
-                        break;
-                    case SPELL_TARGETS_AOE_DAMAGE:
+                    if (unit->GetTypeId() == TYPEID_UNIT && ((Creature*)unit)->IsTotem())
+                        { return; }
+
+                    if (i_playerControlled)
                     {
-                        if (itr->getSource()->GetTypeId() == TYPEID_UNIT && ((Creature*)itr->getSource())->IsTotem())
-                            { continue; }
-
-                        if (i_playerControlled)
-                        {
-                            if (i_originalCaster->IsFriendlyTo(itr->getSource()))
-                                { continue; }
-                        }
-                        else
-                        {
-                            if (!i_originalCaster->IsHostileTo(itr->getSource()))
-                                { continue; }
-                        }
+                        if (i_originalCaster->IsFriendlyTo(unit))
+                            { return; }
+                    }
+                    else
+                    {
+                        if (!i_originalCaster->IsHostileTo(unit))
+                            { return; }
                     }
-                    break;
-                    case SPELL_TARGETS_ALL:
-                        break;
-                    default: continue;
                 }
+                break;
+                case SPELL_TARGETS_ALL:
+                    break;
+                default: return;
+            }
 
-                // we don't need to check InMap here, it's already done some lines above
-                switch (i_push_type)
-                {
-                    case PUSH_IN_FRONT:
-                        if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, 2 * M_PI_F / 3))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                    case PUSH_IN_FRONT_90:
-                        if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F / 2))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                    case PUSH_IN_FRONT_15:
-                        if (i_castingObject->isInFront((Unit*)(itr->getSource()), i_radius, M_PI_F / 12))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                    case PUSH_IN_BACK:
-                        if (i_castingObject->isInBack((Unit*)(itr->getSource()), i_radius, 2 * M_PI_F / 3))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                    case PUSH_SELF_CENTER:
-                        if (i_castingObject->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                    case PUSH_DEST_CENTER:
-                        if (itr->getSource()->IsWithinDist3d(i_centerX, i_centerY, i_centerZ, i_radius))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                    case PUSH_TARGET_CENTER:
-                        if (i_spell.m_targets.getUnitTarget() && i_spell.m_targets.getUnitTarget()->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                            { i_data->push_back(itr->getSource()); }
-                        break;
-                }
+            // we don't need to check InMap here, it's already done some lines above
+            switch (i_push_type)
+            {
+                case PUSH_IN_FRONT:
+                    if (i_castingObject->isInFront(unit, i_radius, 2 * M_PI_F / 3))
+                        { i_data->push_back(unit); }
+                    break;
+                case PUSH_IN_FRONT_90:
+                    if (i_castingObject->isInFront(unit, i_radius, M_PI_F / 2))
+                        { i_data->push_back(unit); }
+                    break;
+                case PUSH_IN_FRONT_15:
+                    if (i_castingObject->isInFront(unit, i_radius, M_PI_F / 12))
+                        { i_data->push_back(unit); }
+                    break;
+                case PUSH_IN_BACK:
+                    if (i_castingObject->isInBack(unit, i_radius, 2 * M_PI_F / 3))
+                        { i_data->push_back(unit); }
+                    break;
+                case PUSH_SELF_CENTER:
+                    if (i_castingObject->IsWithinDist(unit, i_radius))
+                        { i_data->push_back(unit); }
+                    break;
+                case PUSH_DEST_CENTER:
+                    if (unit->IsWithinDist3d(i_centerX, i_centerY, i_centerZ, i_radius))
+                        { i_data->push_back(unit); }
+                    break;
+                case PUSH_TARGET_CENTER:
+                    if (i_spell.m_targets.getUnitTarget() && i_spell.m_targets.getUnitTarget()->IsWithinDist(unit, i_radius))
+                        { i_data->push_back(unit); }
+                    break;
             }
         }
 
@@ -804,9 +809,11 @@ namespace MaNGOS
 #endif
 }
 
+template<> struct IsUnitVisitor<MaNGOS::SpellNotifierCreatureAndPlayer> { static const bool value = true; };
+
 typedef void(Spell::*pEffect)(SpellEffectIndex eff_idx);
 
-class SpellEvent : public BasicEvent
+class SpellEvent : public BasicEvent, public MemoryTracked<MEM_TAG_EVENT>
 {
     public:
         SpellEvent(Spell* spell);
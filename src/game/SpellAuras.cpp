@@ -53,6 +53,7 @@
 #include "CellImpl.h"
 #include "MapManager.h"
 #include "LuaEngine.h"
+#include "SpellStats.h"
 
 #define NULL_AURA_SLOT 0xFF
 
@@ -385,7 +386,7 @@ void Aura::Update(uint32 diff)
     if (m_isPeriodic)
     {
         m_periodicTimer -= diff;
-        if (m_periodicTimer <= 0) // tick also at m_periodicTimer==0 to prevent lost last tick in case max m_duration == (max m_periodicTimer)*N
+        if (m_periodicTimer <= 0 && IsPeriodicTickAllowed()) // tick also at m_periodicTimer==0 to prevent lost last tick in case max m_duration == (max m_periodicTimer)*N
         {
             // update before applying (aura can be removed in TriggerSpell or PeriodicTick calls)
             m_periodicTimer += m_modifier.periodictime;
@@ -395,6 +396,21 @@ void Aura::Update(uint32 diff)
     }
 }
 
+bool Aura::IsPeriodicTickAllowed() const
+{
+    Unit* target = GetTarget();
+    if (!target->IsInWorld())
+        { return true; }
+
+    Map const* map = target->GetMap();
+    if (map->IsPeriodicTickUpdate())
+        { return true; }
+
+    // the last tick of an aura expiring before the next batch step can't wait
+    int32 duration = GetAuraDuration();
+    return duration >= 0 && uint32(duration) <= map->GetPeriodicBatchWindow();
+}
+
 void AreaAura::Update(uint32 diff)
 {
     // update for the caster of the aura
@@ -407,7 +423,7 @@ void AreaAura::Update(uint32 diff)
             Unit* owner = caster->GetCharmerOrOwner();
             if (!owner)
                 { owner = caster; }
-            Spell::UnitList targets;
+            ReusedUnitVector targets;
 
             switch (m_areaAuraType)
             {
@@ -600,7 +616,13 @@ void Aura::ApplyModifier(bool apply, bool Real)
     GetHolder()->SetInUse(true);
     SetInUse(true);
     if (aura < TOTAL_AURAS)
-        { (*this.*AuraHandler [aura])(apply, Real); }
+    {
+        SpellStatsTimer statsTimer(GetId(), apply ? SPELL_STATS_AURA_APPLY : SPELL_STATS_AURA_REMOVE);
+        (*this.*AuraHandler [aura])(apply, Real);
+
+        // handlers may change the amount of the aura
+        GetTarget()->InvalidateAuraModifierTotals(aura);
+    }
 
     SetInUse(false);
     GetHolder()->SetInUse(false);
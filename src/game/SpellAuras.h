@@ -28,6 +28,7 @@
 #include "SpellAuraDefines.h"
 #include "DBCEnums.h"
 #include "ObjectGuid.h"
+#include "MemoryTracker.h"
 
 /**
  * Used to modify what an \ref Aura does to a player/npc.
@@ -90,7 +91,7 @@ struct ReapplyAffectedPassiveAurasHelper;
  * It also takes care of the stacks left of the spell, has a \ref DiminishingGroup to get diminishing
  * returns to work correctly, applies the \ref Modifier of the different \ref Aura s and such.
  */
-class MANGOS_DLL_SPEC SpellAuraHolder
+class MANGOS_DLL_SPEC SpellAuraHolder : public MemoryTracked<MEM_TAG_AURAHOLDER>
 {
     public:
         SpellAuraHolder(SpellEntry const* spellproto, Unit* target, WorldObject* caster, Item* castItem);
@@ -256,7 +257,7 @@ typedef void(Aura::*pAuraHandler)(bool Apply, bool Real);
 //      each setting object update field code line moved under if(Real) check is significant mangos speedup, and less server->client data sends
 //      each packet sending code moved under if(Real) check is _large_ mangos speedup, and lot less server->client data sends
 
-class MANGOS_DLL_SPEC Aura
+class MANGOS_DLL_SPEC Aura : public MemoryTracked<MEM_TAG_AURA>
 {
         friend struct ReapplyAffectedPassiveAurasHelper;
         friend Aura* CreateAura(SpellEntry const* spellproto, SpellEffectIndex eff, int32* currentBasePoints, SpellAuraHolder* holder, Unit* target, Unit* caster, Item* castItem);
@@ -479,6 +480,8 @@ class MANGOS_DLL_SPEC Aura
 
         // must be called only from Aura*::Update
         void PeriodicTick();
+        // false while the tick waits for the next periodic tick batch of the map
+        bool IsPeriodicTickAllowed() const;
         void PeriodicDummyTick();
 
         void ReapplyAffectedPassiveAuras();
@@ -0,0 +1,214 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "SpellStats.h"
+#include "World.h"
+#include "Log.h"
+#include "DBCStores.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(SpellStats);
+
+static char const* const stageNames[MAX_SPELL_STATS_STAGE] =
+{
+    "prepare", "cast", "target_map", "effect_on_target", "effect_handler", "aura_apply", "aura_remove"
+};
+
+void SpellStatsCounters::Add(SpellStatsCounters const& other)
+{
+    for (int i = 0; i < MAX_SPELL_STATS_STAGE; ++i)
+    {
+        calls[i] += other.calls[i];
+        time[i] += other.time[i];
+    }
+
+    targets += other.targets;
+}
+
+uint64 SpellStatsRow::GetTime() const
+{
+    return *std::max_element(counters.time, counters.time + MAX_SPELL_STATS_STAGE);
+}
+
+SpellStats::SpellStats()
+{
+}
+
+SpellStats::~SpellStats()
+{
+    for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        { delete *itr; }
+}
+
+bool SpellStats::IsEnabled() const
+{
+    return sWorld.getConfig(CONFIG_BOOL_SPELLSTATS_ENABLE);
+}
+
+SpellStats::Table& SpellStats::GetThreadTable()
+{
+    ThreadTable* current = m_threadTable;
+    if (!current->table)
+    {
+        Table* table = new Table;
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_tablesLock, *table);
+        m_tables.push_back(table);
+        current->table = table;
+    }
+
+    return *current->table;
+}
+
+void SpellStats::AddTime(uint32 spellId, SpellStatsStage stage, uint64 time)
+{
+    Table& table = GetThreadTable();
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, table.lock);
+    SpellStatsCounters& counters = table.spells[spellId];
+    ++counters.calls[stage];
+    counters.time[stage] += time;
+}
+
+void SpellStats::CountTargets(uint32 spellId, uint32 targets)
+{
+    if (!IsEnabled())
+        { return; }
+
+    Table& table = GetThreadTable();
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, table.lock);
+    table.spells[spellId].targets += targets;
+}
+
+static bool RowLess(SpellStatsRow const& a, SpellStatsRow const& b)
+{
+    uint64 timeA = a.GetTime();
+    uint64 timeB = b.GetTime();
+    if (timeA != timeB)
+        { return timeA > timeB; }
+
+    return a.spellId < b.spellId;
+}
+
+void SpellStats::CollectRows(SpellStatsRows& rows, uint32 maxRows) const
+{
+    CountersMap merged;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, const_cast<ACE_Thread_Mutex&>(m_tablesLock));
+        for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, tableGuard, (*itr)->lock);
+            for (CountersMap::const_iterator spell = (*itr)->spells.begin(); spell != (*itr)->spells.end(); ++spell)
+                { merged[spell->first].Add(spell->second); }
+        }
+    }
+
+    size_t begin = rows.size();
+    for (CountersMap::const_iterator itr = merged.begin(); itr != merged.end(); ++itr)
+        { rows.push_back(SpellStatsRow(itr->first, itr->second)); }
+
+    std::sort(rows.begin() + begin, rows.end(), RowLess);
+
+    if (maxRows && rows.size() - begin > maxRows)
+        { rows.resize(begin + maxRows, rows.front()); }
+}
+
+void SpellStats::Reset()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_tablesLock);
+    for (Tables::const_iterator itr = m_tables.begin(); itr != m_tables.end(); ++itr)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, tableGuard, (*itr)->lock);
+        (*itr)->spells.clear();
+    }
+}
+
+void SpellStats::DumpCSV()
+{
+    SpellStatsRows rows;
+    CollectRows(rows);
+    Reset();
+
+    std::string fileName = sLog.GetLogsDir() + "spellstats.csv";
+    FILE* file = fopen(fileName.c_str(), "a");
+    if (!file)
+    {
+        sLog.outError("SpellStats: can't open %s for writing", fileName.c_str());
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0)
+    {
+        fprintf(file, "time,spell,name,targets");
+        for (int i = 0; i < MAX_SPELL_STATS_STAGE; ++i)
+            { fprintf(file, ",%s_calls,%s_usec", stageNames[i], stageNames[i]); }
+        fprintf(file, "\n");
+    }
+
+    uint64 now = uint64(sWorld.GetGameTime());
+    for (SpellStatsRows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        SpellEntry const* spellInfo = sSpellStore.LookupEntry(itr->spellId);
+
+        // names may contain commas, but never quotes
+        fprintf(file, UI64FMTD ",%u,\"%s\"," UI64FMTD, now, itr->spellId, spellInfo ? spellInfo->SpellName[0] : "",
+                itr->counters.targets);
+        for (int i = 0; i < MAX_SPELL_STATS_STAGE; ++i)
+            { fprintf(file, "," UI64FMTD "," UI64FMTD, itr->counters.calls[i], itr->counters.time[i]); }
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+}
+
+char const* SpellStats::GetStageName(SpellStatsStage stage)
+{
+    return stageNames[stage];
+}
+
+SpellStatsTimer::SpellStatsTimer(uint32 spellId, SpellStatsStage stage) :
+    m_spellId(sSpellStats.IsEnabled() ? spellId : 0), m_stage(stage)
+{
+    if (m_spellId)
+        { m_start = ACE_OS::gettimeofday(); }
+}
+
+SpellStatsTimer::~SpellStatsTimer()
+{
+    if (!m_spellId)
+        { return; }
+
+    ACE_UINT64 elapsed;
+    (ACE_OS::gettimeofday() - m_start).to_usec(elapsed);
+    sSpellStats.AddTime(m_spellId, m_stage, elapsed);
+}
@@ -0,0 +1,150 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_SPELLSTATS_H
+#define MANGOS_SPELLSTATS_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Utilities/UnorderedMapSet.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Time_Value.h>
+#include <ace/TSS_T.h>
+
+#include <vector>
+
+/// Measured parts of the spell cast pipeline, the times of nested stages are included in the outer ones
+enum SpellStatsStage
+{
+    SPELL_STATS_PREPARE          = 0,                       // Spell::prepare
+    SPELL_STATS_CAST             = 1,                       // Spell::cast
+    SPELL_STATS_TARGET_MAP       = 2,                       // Spell::SetTargetMap, per effect
+    SPELL_STATS_EFFECT_ON_TARGET = 3,                       // Spell::DoAllEffectOnTarget for units
+    SPELL_STATS_EFFECT_HANDLER   = 4,                       // Spell::HandleEffects, per effect and target
+    SPELL_STATS_AURA_APPLY       = 5,                       // Aura::ApplyModifier
+    SPELL_STATS_AURA_REMOVE      = 6,
+    MAX_SPELL_STATS_STAGE        = 7
+};
+
+/// Counters of one spell id
+struct SpellStatsCounters
+{
+    SpellStatsCounters() : targets(0)
+    {
+        memset(calls, 0, sizeof(calls));
+        memset(time, 0, sizeof(time));
+    }
+
+    void Add(SpellStatsCounters const& other);
+
+    uint64 calls[MAX_SPELL_STATS_STAGE];
+    uint64 time[MAX_SPELL_STATS_STAGE];                     // in microseconds
+    uint64 targets;                                         // units, gameobjects and items selected by Spell::cast
+};
+
+/// One line of the statistics, see SpellStats::CollectRows
+struct SpellStatsRow
+{
+    SpellStatsRow(uint32 spellId_, SpellStatsCounters const& counters_) : spellId(spellId_), counters(counters_) {}
+
+    /// Time of the outermost stage, nested stages are part of it
+    uint64 GetTime() const;
+
+    uint32 spellId;
+    SpellStatsCounters counters;
+};
+
+typedef std::vector<SpellStatsRow> SpellStatsRows;
+
+/**
+ * Per spell cost accounting of the spell cast pipeline, enabled by SpellStats.Enable.
+ *
+ * Every thread counts into an own table, so the map update threads don't share counters while casting,
+ * the tables are only merged for .debug spellstats and spellstats.csv in the logs directory which is
+ * appended every SpellStats.DumpInterval seconds, after which the counters start again from zero.
+ */
+class SpellStats
+{
+    public:
+        SpellStats();
+        ~SpellStats();
+
+        bool IsEnabled() const;
+
+        void AddTime(uint32 spellId, SpellStatsStage stage, uint64 time);
+        void CountTargets(uint32 spellId, uint32 targets);
+
+        /// Spells sorted by time, at most maxRows if set
+        void CollectRows(SpellStatsRows& rows, uint32 maxRows = 0) const;
+        void Reset();
+
+        /// Append the counters to the csv file and reset them
+        void DumpCSV();
+
+        static char const* GetStageName(SpellStatsStage stage);
+
+    private:
+        typedef UNORDERED_MAP<uint32, SpellStatsCounters> CountersMap;
+
+        struct Table
+        {
+            ACE_Thread_Mutex lock;                          // contended only while collecting or resetting
+            CountersMap spells;
+        };
+
+        typedef std::vector<Table*> Tables;
+
+        /// Table of the current thread, owned by m_tables
+        struct ThreadTable
+        {
+            ThreadTable() : table(NULL) {}
+
+            Table* table;
+        };
+
+        Table& GetThreadTable();
+
+        ACE_TSS<ThreadTable> m_threadTable;
+        ACE_Thread_Mutex m_tablesLock;
+        Tables m_tables;                                    // of all threads which ever counted, kept after thread end
+};
+
+#define sSpellStats MaNGOS::Singleton<SpellStats>::Instance()
+
+/// Adds its lifetime to the spell statistics, if enabled at construction
+class SpellStatsTimer
+{
+    public:
+        SpellStatsTimer(uint32 spellId, SpellStatsStage stage);
+        ~SpellStatsTimer();
+
+    private:
+        uint32 m_spellId;                                   // 0 if disabled
+        SpellStatsStage m_stage;
+        ACE_Time_Value m_start;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "StartupLoader.h"
+#include "Log.h"
+#include "Timer.h"
+#include "ProgressBar.h"
+#include "Util.h"
+#include "Database/DatabaseEnv.h"
+
+#include <ace/Guard_T.h>
+
+StartupLoader::StartupLoader(char const* name) :
+    m_name(name),
+    m_readyCondition(m_lock),
+    m_unfinished(0)
+{
+}
+
+StartupLoader::~StartupLoader()
+{
+    for (StepList::iterator itr = m_steps.begin(); itr != m_steps.end(); ++itr)
+        { delete itr->m_callback; }
+}
+
+void StartupLoader::AddStep(char const* name, MaNGOS::ICallback* callback, char const* dependsOn)
+{
+    uint32 index = m_steps.size();
+    m_steps.push_back(Step(name, callback));
+
+    if (!dependsOn)
+        { return; }
+
+    Tokens names = StrSplit(dependsOn, ",");
+    for (Tokens::const_iterator itr = names.begin(); itr != names.end(); ++itr)
+    {
+        std::string dependency = *itr;
+        dependency.erase(0, dependency.find_first_not_of(' '));
+        dependency.erase(dependency.find_last_not_of(' ') + 1);
+
+        // only steps added before, so the adding order is a valid serial order
+        uint32 i = 0;
+        while (i < index && m_steps[i].m_name != dependency)
+            { ++i; }
+
+        MANGOS_ASSERT(i < index);
+
+        m_steps[i].m_dependents.push_back(index);
+        ++m_steps[index].m_waitingFor;
+    }
+}
+
+void StartupLoader::Execute(Step& step)
+{
+    sLog.outString("Loading %s...", step.m_name.c_str());
+
+    uint32 startTime = WorldTimer::getMSTime();
+    step.m_callback->Execute();
+    sLog.outString(">> %s: '%s' done in %u ms", m_name.c_str(), step.m_name.c_str(), WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()));
+}
+
+void StartupLoader::Run(uint32 numThreads)
+{
+    uint32 startTime = WorldTimer::getMSTime();
+
+    if (numThreads > m_steps.size())
+        { numThreads = m_steps.size(); }
+
+    if (numThreads <= 1)
+    {
+        for (StepList::iterator itr = m_steps.begin(); itr != m_steps.end(); ++itr)
+            { Execute(*itr); }
+    }
+    else
+    {
+        m_unfinished = m_steps.size();
+        for (uint32 i = 0; i < m_steps.size(); ++i)
+            if (!m_steps[i].m_waitingFor)
+                { m_ready.push_back(i); }
+
+        // bars of steps running at the same time would overwrite each other
+        bool showBars = BarGoLink::GetOutputState();
+        BarGoLink::SetOutputState(false);
+
+        if (activate(THR_NEW_LWP | THR_JOINABLE, int(numThreads)) == -1)
+        {
+            sLog.outError("%s: can't start %u loading threads, loading one step after another", m_name.c_str(), numThreads);
+            numThreads = 1;
+            svc();
+        }
+        else
+            { wait(); }
+
+        BarGoLink::SetOutputState(showBars);
+    }
+
+    sLog.outString(">> %s: %u steps loaded in %u ms (%u threads)", m_name.c_str(), uint32(m_steps.size()),
+                   WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()), numThreads > 1 ? numThreads : 1);
+    sLog.outString();
+}
+
+int StartupLoader::svc()
+{
+    WorldDatabase.ThreadStart();                            // let thread do safe mySQL requests
+
+    for (;;)
+    {
+        uint32 index;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            while (m_ready.empty() && m_unfinished)
+                { m_readyCondition.wait(); }
+
+            if (!m_unfinished)
+                { break; }
+
+            index = m_ready.front();
+            m_ready.pop_front();
+        }
+
+        Execute(m_steps[index]);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+        Step const& step = m_steps[index];
+        for (std::vector<uint32>::const_iterator itr = step.m_dependents.begin(); itr != step.m_dependents.end(); ++itr)
+            if (--m_steps[*itr].m_waitingFor == 0)
+                { m_ready.push_back(*itr); }
+
+        --m_unfinished;
+        m_readyCondition.broadcast();
+    }
+
+    WorldDatabase.ThreadEnd();                              // free mySQL thread resources
+
+    return 0;
+}
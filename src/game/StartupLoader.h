@@ -0,0 +1,101 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_STARTUPLOADER_H
+#define MANGOS_STARTUPLOADER_H
+
+#include "Common.h"
+#include "Utilities/Callback.h"
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+#include <vector>
+
+/**
+ * Runs a group of startup loading steps declared with their dependencies on a thread pool.
+ *
+ * A step starts when all steps it depends on are finished, steps without a dependency between them
+ * run at the same time on their own pooled database connections. Every step must only write the data
+ * it loads itself and only read the data of the steps it depends on or of earlier loading.
+ * With one thread the steps run one after another in the order they were added, as the plain
+ * serial loading code did.
+ */
+class StartupLoader : protected ACE_Task_Base
+{
+    public:
+        typedef void (*LoadFunction)();
+
+        explicit StartupLoader(char const* name);
+        virtual ~StartupLoader();
+
+        /**
+         * Add a step, dependsOn is a comma separated list of the names of steps added before
+         * that must be finished before this one starts, NULL for none
+         */
+        void AddStep(char const* name, LoadFunction function, char const* dependsOn = NULL)
+        {
+            AddStep(name, new MaNGOS::_ICallback<MaNGOS::_SCallback<> >(MaNGOS::_SCallback<>(function)), dependsOn);
+        }
+
+        template<class Class>
+        void AddStep(char const* name, Class* object, void (Class::*method)(), char const* dependsOn = NULL)
+        {
+            AddStep(name, new MaNGOS::Callback<Class>(object, method), dependsOn);
+        }
+
+        /// Run all steps and return when they are finished, on the calling thread for numThreads <= 1
+        void Run(uint32 numThreads);
+
+    protected:
+        int svc() override;
+
+    private:
+        struct Step
+        {
+            Step(char const* name, MaNGOS::ICallback* callback) :
+                m_name(name), m_callback(callback), m_waitingFor(0) {}
+
+            std::string m_name;
+            MaNGOS::ICallback* m_callback;
+            std::vector<uint32> m_dependents;               // steps waiting for this one
+            uint32 m_waitingFor;                            // unfinished steps this one depends on
+        };
+
+        typedef std::vector<Step> StepList;
+
+        void AddStep(char const* name, MaNGOS::ICallback* callback, char const* dependsOn);
+        void Execute(Step& step);
+
+        std::string m_name;
+        StepList m_steps;
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_readyCondition;        // signaled when steps got ready or all are finished
+        std::deque<uint32> m_ready;                         // steps without unfinished dependencies
+        uint32 m_unfinished;
+};
+
+#endif
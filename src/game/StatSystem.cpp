@@ -45,20 +45,21 @@ bool Player::UpdateStats(Stats stat)
 
     SetStat(stat, int32(value));
 
+    // health and mana follow at once, they are read right after buffs like Power Word: Fortitude
+    // the other stats and the values depending on them are updated once for all stat changes
+    // in the next player update, a raid buff modifies all stats of many players in one map update
+    uint32 derived = PLAYER_DERIVED_ATTACK_POWER | PLAYER_DERIVED_SPELL_BONUS; // exist AP from stat auras
     switch (stat)
     {
         case STAT_STRENGTH:
             break;
         case STAT_AGILITY:
-            UpdateArmor();
-            UpdateAllCritPercentages();
-            UpdateDodgePercentage();
+            derived |= PLAYER_DERIVED_ARMOR | PLAYER_DERIVED_MELEE_CRIT | PLAYER_DERIVED_DODGE;
             break;
         case STAT_STAMINA:   UpdateMaxHealth(); break;
         case STAT_INTELLECT:
             UpdateMaxPower(POWER_MANA);
-            UpdateAllSpellCritChances();
-            UpdateArmor();                                  // SPELL_AURA_MOD_RESISTANCE_OF_INTELLECT_PERCENT, only armor currently
+            derived |= PLAYER_DERIVED_SPELL_CRIT | PLAYER_DERIVED_ARMOR; // SPELL_AURA_MOD_RESISTANCE_OF_INTELLECT_PERCENT, only armor currently
             break;
 
         case STAT_SPIRIT:
@@ -67,16 +68,46 @@ bool Player::UpdateStats(Stats stat)
         default:
             break;
     }
-    // Need update (exist AP from stat auras)
-    UpdateAttackPowerAndDamage();
-    UpdateAttackPowerAndDamage(true);
 
-    UpdateSpellDamageAndHealingBonus();
-    UpdateManaRegen();
+    m_pendingDerivedStats |= derived;
+
+    // not updated while out of world
+    if (!IsInWorld())
+        { UpdatePendingDerivedStats(); }
 
     return true;
 }
 
+void Player::UpdatePendingDerivedStats()
+{
+    uint32 derived = m_pendingDerivedStats;
+    if (!derived)
+        { return; }
+
+    m_pendingDerivedStats = 0;
+
+    if (derived & PLAYER_DERIVED_ARMOR)
+        { UpdateArmor(); }
+    if (derived & PLAYER_DERIVED_MELEE_CRIT)
+        { UpdateAllCritPercentages(); }
+    if (derived & PLAYER_DERIVED_DODGE)
+        { UpdateDodgePercentage(); }
+    if (derived & PLAYER_DERIVED_SPELL_CRIT)
+        { UpdateAllSpellCritChances(); }
+
+    if (derived & PLAYER_DERIVED_ATTACK_POWER)
+    {
+        UpdateAttackPowerAndDamage();
+        UpdateAttackPowerAndDamage(true);
+    }
+
+    if (derived & PLAYER_DERIVED_SPELL_BONUS)
+    {
+        UpdateSpellDamageAndHealingBonus();
+        UpdateManaRegen();
+    }
+}
+
 void Player::UpdateSpellDamageAndHealingBonus()
 {
     // Magic damage modifiers implemented in Unit::SpellDamageBonusDone
@@ -89,6 +120,8 @@ void Player::UpdateSpellDamageAndHealingBonus()
 
 bool Player::UpdateAllStats()
 {
+    m_pendingDerivedStats = 0;                              // all done below
+
     for (int i = STAT_STRENGTH; i < MAX_STATS; ++i)
     {
         float value = GetTotalStatValue(Stats(i));
@@ -33,6 +33,9 @@
 #include "movement/MoveSplineInit.h"
 #include "movement/MoveSpline.h"
 
+// every so many paths along the trail of the target a follower finds an own path, in case the trail misleads
+#define FOLLOW_TRAIL_VALIDATE_INTERVAL  8
+
 //-----------------------------------------------//
 template<class T, typename D>
 void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool updateDestination)
@@ -71,28 +74,61 @@ void TargetedMovementGeneratorMedium<T, D>::_setTargetLocation(T& owner, bool up
     else
     {
         // the destination has not changed, we just need to refresh the path (usually speed change)
-        G3D::Vector3 end = i_path->getEndPosition();
+        G3D::Vector3 end = i_pathByTrail ? owner.movespline->FinalDestination() : i_path->getEndPosition();
         x = end.x;
         y = end.y;
         z = end.z;
     }
 
+    // followers walk the trail of their target and only now and then validate it by an own path
+    if (this->GetMovementGeneratorType() == FOLLOW_MOTION_TYPE && (!i_path || !i_path->isPending()) &&
+        ++i_trailPaths % FOLLOW_TRAIL_VALIDATE_INTERVAL != 0 && _launchTrailPath(owner, x, y, z))
+        { return; }
+
+    i_pathByTrail = false;
+
     if (!i_path)
         { i_path = new PathFinder(&owner); }
 
     // allow pets following their master to cheat while generating paths
     bool forceDest = (owner.GetTypeId() == TYPEID_UNIT && ((Creature*)&owner)->IsPet()
                       && owner.hasUnitState(UNIT_STAT_FOLLOW));
-    i_path->calculate(x, y, z, forceDest);
+    // a queued path is launched by Update when it is ready, until then the old movement goes on
+    if (i_path->calculateAsync(x, y, z, forceDest))
+        { _launchPath(owner); }
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_launchPath(T& owner)
+{
     if (i_path->getPathType() & PATHFIND_NOPATH)
         { return; }
 
+    _moveByPath(owner, i_path->getPath());
+}
+
+template<class T, typename D>
+bool TargetedMovementGeneratorMedium<T, D>::_launchTrailPath(T& owner, float x, float y, float z)
+{
+    Movement::PointsArray path;
+    G3D::Vector3 from(owner.GetPositionX(), owner.GetPositionY(), owner.GetPositionZ());
+    if (!i_target->GetFollowerRefManager().GetTrailPath(from, G3D::Vector3(x, y, z), path))
+        { return false; }
+
+    i_pathByTrail = true;
+    _moveByPath(owner, path);
+    return true;
+}
+
+template<class T, typename D>
+void TargetedMovementGeneratorMedium<T, D>::_moveByPath(T& owner, Movement::PointsArray const& path)
+{
     D::_addUnitStateMove(owner);
     i_targetReached = false;
     m_speedChanged = false;
 
     Movement::MoveSplineInit init(owner);
-    init.MovebyPath(i_path->getPath());
+    init.MovebyPath(path);
     init.SetWalk(((D*)this)->EnableWalking());
     init.Launch();
 }
@@ -133,6 +169,17 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
         return true;
     }
 
+    if (i_path && i_path->isPending())
+    {
+        if (!i_path->updateRequest())
+            { return true; }                                // a recheck would only replace the request
+
+        _launchPath(owner);
+    }
+
+    if (this->GetMovementGeneratorType() == FOLLOW_MOTION_TYPE)
+        { i_target->GetFollowerRefManager().RecordTrail(*i_target.getTarget()); }
+
     bool targetMoved = false;
     i_recheckDistance.Update(time_diff);
     if (i_recheckDistance.Passed())
@@ -162,7 +209,7 @@ bool TargetedMovementGeneratorMedium<T, D>::Update(T& owner, const uint32& time_
 template<class T, typename D>
 bool TargetedMovementGeneratorMedium<T, D>::IsReachable() const
 {
-    return (i_path) ? (i_path->getPathType() & PATHFIND_NORMAL) : true;
+    return (i_path && !i_pathByTrail) ? (i_path->getPathType() & PATHFIND_NORMAL) : true;
 }
 
 template<class T, typename D>
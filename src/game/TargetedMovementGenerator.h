@@ -27,6 +27,7 @@
 
 #include "MovementGenerator.h"
 #include "FollowerReference.h"
+#include "movement/MoveSplineInitArgs.h"
 
 class PathFinder;
 
@@ -48,8 +49,8 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
             TargetedMovementGeneratorBase(target),
             i_recheckDistance(0),
             i_offset(offset), i_angle(angle),
-            m_speedChanged(false), i_targetReached(false),
-            i_path(NULL)
+            m_speedChanged(false), i_targetReached(false), i_pathByTrail(false),
+            i_trailPaths(0), i_path(NULL)
         {
         }
         ~TargetedMovementGeneratorMedium() { delete i_path; }
@@ -65,6 +66,9 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
 
     protected:
         void _setTargetLocation(T&, bool updateDestination);
+        void _launchPath(T&);
+        bool _launchTrailPath(T&, float x, float y, float z);
+        void _moveByPath(T&, Movement::PointsArray const& path);
         bool RequiresNewPosition(T& owner, float x, float y, float z) const;
         virtual float GetDynamicTargetDistance(T& /*owner*/, bool /*forRangeCheck*/) const { return i_offset; }
 
@@ -73,6 +77,8 @@ class MANGOS_DLL_SPEC TargetedMovementGeneratorMedium
         float i_angle;
         bool m_speedChanged : 1;
         bool i_targetReached : 1;
+        bool i_pathByTrail : 1;                             // the movement follows the trail of the target
+        uint32 i_trailPaths;
 
         PathFinder* i_path;
 };
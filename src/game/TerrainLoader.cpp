@@ -0,0 +1,131 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "TerrainLoader.h"
+#include "GridMap.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+
+TerrainLoader::TerrainLoader() :
+    m_queueCondition(m_lock),
+    m_threadCount(0),
+    m_stopping(false)
+{
+}
+
+TerrainLoader::~TerrainLoader()
+{
+    Deactivate();
+}
+
+int TerrainLoader::Activate(uint32 numThreads)
+{
+    if (IsActive() || numThreads == 0)
+        { return 0; }
+
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, int(numThreads)) == -1)
+    {
+        sLog.outError("TerrainLoader: can't start %u terrain loader threads, grids will be loaded when created", numThreads);
+        return -1;
+    }
+
+    m_threadCount = numThreads;
+    return 0;
+}
+
+void TerrainLoader::Deactivate()
+{
+    if (!IsActive())
+        { return; }
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stopping = true;
+        m_queueCondition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+    m_threadCount = 0;
+
+    // release the terrains of the dropped requests
+    for (RequestQueue::const_iterator itr = m_queue.begin(); itr != m_queue.end(); ++itr)
+        { itr->m_terrain->Release(); }
+
+    m_queue.clear();
+    m_queued.clear();
+}
+
+void TerrainLoader::Prefetch(TerrainInfo* terrain, uint32 x, uint32 y)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    if (m_stopping || !m_queued.insert(PrefetchRequest(terrain, x, y)).second)
+        { return; }
+
+    // keep the terrain alive until the request is done
+    terrain->AddRef();
+    m_queue.push_back(PrefetchRequest(terrain, x, y));
+    m_queueCondition.signal();
+}
+
+uint32 TerrainLoader::GetQueueSize() const
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+    return m_queue.size();
+}
+
+int TerrainLoader::svc()
+{
+    for (;;)
+    {
+        PrefetchRequest request(NULL, 0, 0);
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            while (m_queue.empty() && !m_stopping)
+                { m_queueCondition.wait(); }
+
+            if (m_stopping)
+                { break; }
+
+            request = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        request.m_terrain->Prefetch(request.m_x, request.m_y);
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            m_queued.erase(request);
+        }
+
+        request.m_terrain->Release();
+    }
+
+    return 0;
+}
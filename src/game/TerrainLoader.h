@@ -0,0 +1,95 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_TERRAINLOADER_H
+#define MANGOS_TERRAINLOADER_H
+
+#include "Common.h"
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+#include <set>
+
+class TerrainInfo;
+
+/**
+ * I/O threads loading the terrain of grids that players are about to enter.
+ *
+ * Maps predict the grids ahead of moving and flying players and queue them with Prefetch().
+ * A loader thread reads the .map file into a GridMap that TerrainInfo publishes when the grid
+ * is created, and reads the vmap and mmap tiles of the grid once, so the synchronous loading of
+ * the collision and navigation data later on only hits the file system cache.
+ */
+class TerrainLoader : protected ACE_Task_Base
+{
+    public:
+        TerrainLoader();
+        virtual ~TerrainLoader();
+
+        /// Start numThreads loader threads, no-op for 0 (grids are loaded when created then)
+        int Activate(uint32 numThreads);
+        /// Stop and join all loader threads, queued requests are dropped
+        void Deactivate();
+        bool IsActive() const { return m_threadCount > 0; }
+
+        /// Queue loading grid x, y (terrain coordinates) of the terrain, ignored if already queued
+        void Prefetch(TerrainInfo* terrain, uint32 x, uint32 y);
+
+        uint32 GetQueueSize() const;
+
+    protected:
+        int svc() override;
+
+    private:
+        struct PrefetchRequest
+        {
+            PrefetchRequest(TerrainInfo* terrain, uint32 x, uint32 y) : m_terrain(terrain), m_x(x), m_y(y) {}
+
+            bool operator<(PrefetchRequest const& other) const
+            {
+                if (m_terrain != other.m_terrain)
+                    { return m_terrain < other.m_terrain; }
+                return m_x != other.m_x ? m_x < other.m_x : m_y < other.m_y;
+            }
+
+            TerrainInfo* m_terrain;
+            uint32 m_x;
+            uint32 m_y;
+        };
+
+        typedef std::deque<PrefetchRequest> RequestQueue;
+        typedef std::set<PrefetchRequest> RequestSet;
+
+        mutable ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_queueCondition;        // signaled when requests are queued or at stop
+
+        RequestQueue m_queue;
+        RequestSet m_queued;                                // queued or currently loaded requests
+        uint32 m_threadCount;
+        bool m_stopping;
+};
+
+#endif
@@ -221,24 +221,50 @@ void ThreatContainer::clearReferences()
         delete(*i);
     }
     iThreatList.clear();
+    iThreatRefIndex.clear();
 }
 
 //============================================================
-// Return the HostileReference of NULL, if not found
-HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
+
+Map* ThreatContainer::getDeferringMap() const
 {
-    HostileReference* result = NULL;
-    ObjectGuid guid = pVictim->GetObjectGuid();
     for (ThreatList::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
     {
-        if ((*i)->getUnitGuid() == guid)
+        if ((*i)->isValid())
         {
-            result = (*i);
-            break;
+            if (Map* map = ThreatManager::getDeferringMap((*i)->getTarget()))
+                { return map; }
         }
     }
+    return NULL;
+}
+
+//============================================================
 
-    return result;
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    ThreatRefIndex::iterator itr = iThreatRefIndex.find(pRef->getUnitGuid());
+    if (itr == iThreatRefIndex.end() || *itr->second != pRef)
+        { return; }
+
+    iThreatList.erase(itr->second);
+    iThreatRefIndex.erase(itr);
+}
+
+//============================================================
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
+{
+    iThreatList.push_back(pHostileReference);
+    iThreatRefIndex[pHostileReference->getUnitGuid()] = --iThreatList.end();
+}
+
+//============================================================
+// Return the HostileReference of NULL, if not found
+HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim) const
+{
+    ThreatRefIndex::const_iterator itr = iThreatRefIndex.find(pVictim->GetObjectGuid());
+    return itr != iThreatRefIndex.end() ? *itr->second : NULL;
 }
 
 //============================================================
@@ -283,7 +309,34 @@ void ThreatContainer::update()
 {
     if (iDirty && iThreatList.size() > 1)
     {
-        iThreatList.sort(HostileReferenceSortPredicate);
+        // usually only a few references changed since the last sort, so move these back to their place
+        // like an insertion sort does, and sort all only if they are too many
+        size_t stepsLeft = 4 * iThreatList.size();
+
+        ThreatList::iterator next = iThreatList.begin();
+        for (++next; next != iThreatList.end();)
+        {
+            ThreatList::iterator itr = next++;
+            ThreatList::iterator pos = itr;
+            while (pos != iThreatList.begin() && stepsLeft)
+            {
+                ThreatList::iterator prev = pos;
+                if (!HostileReferenceSortPredicate(*itr, *--prev))
+                    { break; }
+
+                pos = prev;
+                --stepsLeft;
+            }
+
+            if (!stepsLeft)
+            {
+                iThreatList.sort(HostileReferenceSortPredicate);
+                break;
+            }
+
+            if (pos != itr)
+                { iThreatList.splice(pos, iThreatList, itr); }
+        }
     }
     iDirty = false;
 }
@@ -391,6 +444,9 @@ HostileReference* ThreatContainer::selectNextVictim(Creature* pAttacker, Hostile
 //=================== ThreatManager ==========================
 //============================================================
 
+// Threat is added by units of any region of a split continent, changes involving units away from the region
+// updated by the thread are queued on the map and done after the region pass, see Map::IsNearUpdatedRegion
+
 ThreatManager::ThreatManager(Unit* owner)
     : iCurrentVictim(NULL), iOwner(owner)
 {
@@ -398,8 +454,40 @@ ThreatManager::ThreatManager(Unit* owner)
 
 //============================================================
 
+Map* ThreatManager::getDeferringMap(Unit* pUnit, Unit* pOther)
+{
+    // the lists of units out of world are changed right away, they are not updated
+    if (!pUnit->IsInWorld())
+        { return NULL; }
+
+    if (!pUnit->GetMap()->IsNearUpdatedRegion(*pUnit))
+        { return pUnit->GetMap(); }
+
+    if (pOther && pOther->IsInWorld() && !pOther->GetMap()->IsNearUpdatedRegion(*pOther))
+        { return pOther->GetMap(); }
+
+    return NULL;
+}
+
+//============================================================
+
 void ThreatManager::clearReferences()
 {
+    if (iOwner->IsInWorld() && iOwner->GetMap()->IsRegionUpdateRunning())
+    {
+        Map* map = getDeferringMap(iOwner);
+        if (!map)
+            { map = iThreatContainer.getDeferringMap(); }
+        if (!map)
+            { map = iThreatOfflineContainer.getDeferringMap(); }
+
+        if (map)
+        {
+            map->DeferThreatAction(MapThreatAction(MAP_THREAT_CLEAR, iOwner->GetObjectGuid()));
+            return;
+        }
+    }
+
     iThreatContainer.clearReferences();
     iThreatOfflineContainer.clearReferences();
     iCurrentVictim = NULL;
@@ -407,34 +495,57 @@ void ThreatManager::clearReferences()
 
 //============================================================
 
-void ThreatManager::addThreat(Unit* pVictim, float pThreat, bool crit, SpellSchoolMask schoolMask, SpellEntry const* pThreatSpell)
+bool ThreatManager::isThreatAllowed(Unit* pVictim) const
 {
-    // function deals with adding threat and adding players and pets into ThreatList
-    // mobs, NPCs, guards have ThreatList and HateOfflineList
-    // players and pets have only InHateListOf
-    // HateOfflineList is used co contain unattackable victims (in-flight, in-water, GM etc.)
-
     // not to self
     if (pVictim == getOwner())
-        { return; }
+        { return false; }
 
     // not to GM
     if (!pVictim || (pVictim->GetTypeId() == TYPEID_PLAYER && ((Player*)pVictim)->isGameMaster()))
-        { return; }
+        { return false; }
 
     // not to dead and not for dead
     if (!pVictim->IsAlive() || !getOwner()->IsAlive())
-        { return; }
+        { return false; }
 
     MANGOS_ASSERT(getOwner()->GetTypeId() == TYPEID_UNIT);
+    return true;
+}
+
+//============================================================
+
+void ThreatManager::addThreat(Unit* pVictim, float pThreat, bool crit, SpellSchoolMask schoolMask, SpellEntry const* pThreatSpell)
+{
+    // function deals with adding threat and adding players and pets into ThreatList
+    // mobs, NPCs, guards have ThreatList and HateOfflineList
+    // players and pets have only InHateListOf
+    // HateOfflineList is used co contain unattackable victims (in-flight, in-water, GM etc.)
+
+    if (!isThreatAllowed(pVictim))
+        { return; }
 
     float threat = ThreatCalcHelper::CalcThreat(pVictim, iOwner, pThreat, crit, schoolMask, pThreatSpell);
 
     addThreatDirectly(pVictim, threat);
 }
 
+void ThreatManager::addCalculatedThreat(Unit* pVictim, float threat)
+{
+    if (!isThreatAllowed(pVictim))
+        { return; }
+
+    addThreatDirectly(pVictim, threat);
+}
+
 void ThreatManager::addThreatDirectly(Unit* pVictim, float threat)
 {
+    if (Map* map = getDeferringMap(iOwner, pVictim))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_THREAT_ADD, iOwner->GetObjectGuid(), pVictim->GetObjectGuid(), threat));
+        return;
+    }
+
     HostileReference* ref = iThreatContainer.addThreat(pVictim, threat);
     // Ref is not in the online refs, search the offline refs next
     if (!ref)
@@ -455,6 +566,12 @@ void ThreatManager::addThreatDirectly(Unit* pVictim, float threat)
 
 void ThreatManager::modifyThreatPercent(Unit* pVictim, int32 pPercent)
 {
+    if (Map* map = getDeferringMap(iOwner, pVictim))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_THREAT_MODIFY_PERCENT, iOwner->GetObjectGuid(), pVictim->GetObjectGuid(), 0.0f, pPercent));
+        return;
+    }
+
     iThreatContainer.modifyThreatPercent(pVictim, pPercent);
 }
 
@@ -485,6 +602,12 @@ float ThreatManager::getThreat(Unit* pVictim, bool pAlsoSearchOfflineList)
 
 void ThreatManager::tauntApply(Unit* pTaunter)
 {
+    if (Map* map = getDeferringMap(iOwner, pTaunter))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_THREAT_TAUNT_APPLY, iOwner->GetObjectGuid(), pTaunter->GetObjectGuid()));
+        return;
+    }
+
     if (HostileReference* ref = iThreatContainer.getReferenceByTarget(pTaunter))
     {
         if (getCurrentVictim() && (ref->getThreat() < getCurrentVictim()->getThreat()))
@@ -502,6 +625,12 @@ void ThreatManager::tauntApply(Unit* pTaunter)
 
 void ThreatManager::tauntFadeOut(Unit* pTaunter)
 {
+    if (Map* map = getDeferringMap(iOwner, pTaunter))
+    {
+        map->DeferThreatAction(MapThreatAction(MAP_THREAT_TAUNT_FADE_OUT, iOwner->GetObjectGuid(), pTaunter->GetObjectGuid()));
+        return;
+    }
+
     if (HostileReference* ref = iThreatContainer.getReferenceByTarget(pTaunter))
     {
         ref->resetTempThreat();
@@ -30,12 +30,14 @@
 #include "Utilities/LinkedReference/Reference.h"
 #include "UnitEvents.h"
 #include "ObjectGuid.h"
+#include "Utilities/UnorderedMapSet.h"
 #include <list>
 
 //==============================================================
 
 class Unit;
 class Creature;
+class Map;
 class ThreatManager;
 struct SpellEntry;
 
@@ -142,14 +144,20 @@ typedef std::list<HostileReference*> ThreatList;
 class MANGOS_DLL_SPEC ThreatContainer
 {
     private:
+        // position of the reference of every target in iThreatList, list iterators stay valid while sorting
+        typedef UNORDERED_MAP<ObjectGuid, ThreatList::iterator> ThreatRefIndex;
+
         ThreatList iThreatList;
+        ThreatRefIndex iThreatRefIndex;
         bool iDirty;
     protected:
         friend class ThreatManager;
 
-        void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-        void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+        void remove(HostileReference* pRef);
+        void addReference(HostileReference* pHostileReference);
         void clearReferences();
+        // Map to queue the clearing at if a target can't be changed now, see ThreatManager::getDeferringMap
+        Map* getDeferringMap() const;
         // Sort the list if necessary
         void update();
     public:
@@ -170,7 +178,7 @@ class MANGOS_DLL_SPEC ThreatContainer
 
         HostileReference* getMostHated() { return iThreatList.empty() ? NULL : iThreatList.front(); }
 
-        HostileReference* getReferenceByTarget(Unit* pVictim);
+        HostileReference* getReferenceByTarget(Unit* pVictim) const;
 
         ThreatList const& getThreatList() const { return iThreatList; }
 };
@@ -194,6 +202,9 @@ class MANGOS_DLL_SPEC ThreatManager
         // add threat as raw value (ignore redirections and expection all mods applied already to it
         void addThreatDirectly(Unit* pVictim, float threat);
 
+        // add threat calculated by ThreatCalcHelper already, see HostileRefManager::threatAssist
+        void addCalculatedThreat(Unit* pVictim, float threat);
+
         void modifyThreatPercent(Unit* pVictim, int32 pPercent);
 
         float getThreat(Unit* pVictim, bool pAlsoSearchOfflineList = false);
@@ -216,8 +227,15 @@ class MANGOS_DLL_SPEC ThreatManager
         void setDirty(bool pDirty) { iThreatContainer.setDirty(pDirty); }
 
         // Don't must be used for explicit modify threat values in iterator return pointers
+        // While regions of a continent are updated, only the update of units near the owner changes the list, see Map::IsNearUpdatedRegion
         ThreatList const& getThreatList() const { return iThreatContainer.getThreatList(); }
+
+        // Map to queue a change of the lists of the units at, NULL if the change can be done now
+        static Map* getDeferringMap(Unit* pUnit, Unit* pOther = NULL);
     private:
+        // the victim can be added to the threat list
+        bool isThreatAllowed(Unit* pVictim) const;
+
         HostileReference* iCurrentVictim;
         Unit* iOwner;
         ThreatContainer iThreatContainer;
@@ -118,6 +118,7 @@ void MapManager::LoadTransports()
 
         // If we someday decide to use the grid to track transports, here:
         t->SetMap(sMapMgr.CreateMap(mapid, t));
+        t->GetMap()->AddTransport(t);
 
         // t->GetMap()->Add<GameObject>((GameObject *)t);
         ++count;
@@ -440,7 +441,10 @@ void Transport::MoveToNextWayPoint()
 
 void Transport::TeleportTransport(uint32 newMapid, float x, float y, float z)
 {
-    Map const* oldMap = GetMap();
+    // the maps may be updated by other threads, see Map::DeferTransportMove
+    MANGOS_ASSERT(newMapid == GetMapId() || !sMapMgr.IsUpdatingMaps());
+
+    Map* oldMap = GetMap();
     Relocate(x, y, z);
 
     for (PlayerSet::iterator itr = m_passengers.begin(); itr != m_passengers.end();)
@@ -474,6 +478,9 @@ void Transport::TeleportTransport(uint32 newMapid, float x, float y, float z)
 
     if (oldMap != newMap)
     {
+        oldMap->RemoveTransport(this);
+        newMap->AddTransport(this);
+
         UpdateForMap(oldMap);
         UpdateForMap(newMap);
     }
@@ -506,6 +513,15 @@ void Transport::Update(uint32 /*update_diff*/, uint32 /*p_time*/)
     {
         MoveToNextWayPoint();
 
+        // the map update iterates its transports and other maps can be updated at the same time,
+        // the path continues on the new map after the move
+        if (m_curr->second.mapid != GetMapId())
+        {
+            GetMap()->DeferTransportMove(this, WorldLocation(m_curr->second.mapid, m_curr->second.x, m_curr->second.y, m_curr->second.z, GetOrientation()));
+            m_nextNodeTime = m_curr->first;
+            break;
+        }
+
         // first check help in case client-server transport coordinates de-synchronization
         if (m_curr->second.mapid != GetMapId() || m_curr->second.teleport)
         {
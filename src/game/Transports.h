@@ -45,6 +45,9 @@ class Transport : public GameObject
         typedef std::set<Player*> PlayerSet;
         PlayerSet const& GetPassengers() const { return m_passengers; }
 
+        // moves the transport and its passengers, to another map only while maps are not updated
+        void TeleportTransport(uint32 newMapid, float x, float y, float z);
+
     private:
         struct WayPoint
         {
@@ -73,7 +76,6 @@ class Transport : public GameObject
         uint32 m_period;
 
     private:
-        void TeleportTransport(uint32 newMapid, float x, float y, float z);
         void UpdateForMap(Map const* map);
         void MoveToNextWayPoint();                          // move m_next/m_cur to next points
 };
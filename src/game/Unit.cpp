@@ -39,6 +39,7 @@
 #include "SpellAuras.h"
 #include "MapManager.h"
 #include "ObjectAccessor.h"
+#include "WhoListMgr.h"
 #include "CreatureAI.h"
 #include "TemporarySummon.h"
 #include "Formulas.h"
@@ -62,6 +63,9 @@
 #include <math.h>
 #include <stdarg.h>
 
+// candidates of a random target search, from the tick arena inside a map update
+typedef std::list<Unit*, ArenaAllocator<Unit*> > UnitTickList;
+
 #ifdef WIN32
 inline uint32 getMSTime() { return GetTickCount(); }
 #else
@@ -220,7 +224,6 @@ Unit::Unit() :
     // m_Aura = NULL;
     // m_AurasCheck = 2000;
     // m_removeAuraTimer = 4;
-    m_spellAuraHoldersUpdateIterator = m_spellAuraHolders.end();
     m_AuraFlags = 0;
 
     m_Visibility = VISIBILITY_ON;
@@ -1772,7 +1775,7 @@ void Unit::DealMeleeDamage(CalcDamageInfo* damageInfo, bool durabilityLoss)
             { ((Player*)this)->CastItemCombatSpell(pVictim, damageInfo->attackType); }
 
         // victim's damage shield
-        std::set<Aura*> alreadyDone;
+        std::set<Aura*, std::less<Aura*>, ArenaAllocator<Aura*> > alreadyDone;
         AuraList const& vDamageShields = pVictim->GetAurasByType(SPELL_AURA_DAMAGE_SHIELD);
         for (AuraList::const_iterator i = vDamageShields.begin(); i != vDamageShields.end();)
         {
@@ -1948,6 +1951,7 @@ void Unit::CalculateDamageAbsorbAndResist(Unit* pCaster, SpellSchoolMask schoolM
         mod->m_amount -= currentAbsorb;
         if ((*i)->GetHolder()->DropAuraCharge())
             { mod->m_amount = 0; }
+        InvalidateAuraModifierTotals(SPELL_AURA_SCHOOL_ABSORB);
         // Need remove it later
         if (mod->m_amount <= 0)
             { existExpired = true; }
@@ -1998,6 +2002,7 @@ void Unit::CalculateDamageAbsorbAndResist(Unit* pCaster, SpellSchoolMask schoolM
         }
 
         (*i)->GetModifier()->m_amount -= currentAbsorb;
+        InvalidateAuraModifierTotals(SPELL_AURA_MANA_SHIELD);
         if ((*i)->GetModifier()->m_amount <= 0)
         {
             RemoveAurasDueToSpell((*i)->GetId());
@@ -2947,29 +2952,22 @@ void Unit::_UpdateSpells(uint32 time)
         }
     }
 
-    // update auras
-    // m_AurasUpdateIterator can be updated in inderect called code at aura remove to skip next planned to update but removed auras
-    for (m_spellAuraHoldersUpdateIterator = m_spellAuraHolders.begin(); m_spellAuraHoldersUpdateIterator != m_spellAuraHolders.end();)
-    {
-        SpellAuraHolder* i_holder = m_spellAuraHoldersUpdateIterator->second;
-        ++m_spellAuraHoldersUpdateIterator;                 // need shift to next for allow update if need into aura update
-        i_holder->UpdateHolder(time);
-    }
+    // update auras, holders removed meanwhile are skipped by the iteration
+    for (SpellAuraHolderMap::iterator iter = m_spellAuraHolders.begin(); iter != m_spellAuraHolders.end(); ++iter)
+        { iter->second->UpdateHolder(time); }
 
     // remove expired auras
-    for (SpellAuraHolderMap::iterator iter = m_spellAuraHolders.begin(); iter != m_spellAuraHolders.end();)
+    for (SpellAuraHolderMap::iterator iter = m_spellAuraHolders.begin(); iter != m_spellAuraHolders.end(); ++iter)
     {
         SpellAuraHolder* holder = iter->second;
 
         if (!(holder->IsPermanent() || holder->IsPassive()) && holder->GetAuraDuration() == 0)
-        {
-            RemoveSpellAuraHolder(holder, AURA_REMOVE_BY_EXPIRE);
-            iter = m_spellAuraHolders.begin();
-        }
-        else
-            { ++iter; }
+            { RemoveSpellAuraHolder(holder, AURA_REMOVE_BY_EXPIRE); }
     }
 
+    // no iteration over the holders is running here, release the slots of removed ones
+    m_spellAuraHolders.Compact();
+
     if (!m_gameObj.empty())
     {
         GameObjectList::iterator ite1, dnext1;
@@ -3212,12 +3210,12 @@ bool Unit::isInAccessablePlaceFor(Creature const* c) const
 
 bool Unit::IsInWater() const
 {
-    return GetTerrain()->IsInWater(GetPositionX(), GetPositionY(), GetPositionZ());
+    return GetTerrainQuery().IsInWater();
 }
 
 bool Unit::IsUnderWater() const
 {
-    return GetTerrain()->IsUnderWater(GetPositionX(), GetPositionY(), GetPositionZ());
+    return GetTerrainQuery().IsUnderWater();
 }
 
 void Unit::DeMorph()
@@ -3225,50 +3223,81 @@ void Unit::DeMorph()
     SetDisplayId(GetNativeDisplayId());
 }
 
-int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+AuraModifierTotals Unit::GetAuraModifierTotals(AuraType auratype, AuraModifierFilter filter, uint32 value) const
 {
-    int32 modifier = 0;
+    AuraModifierTotals totals;
+    totals.total = 0;
+    totals.multiplier = 1.0f;
+    totals.maxPositive = 0;
+    totals.maxNegative = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
+    if (mTotalAuraList.empty())
+        { return totals; }
+
+    uint64 key = uint64(auratype) | (uint64(filter) << 16) | (uint64(value) << 32);
+    AuraModifierTotalsMap::const_iterator itr = m_auraModifierTotals.find(key);
+    if (itr != m_auraModifierTotals.end())
+        { return itr->second; }
+
     for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        { modifier += (*i)->GetModifier()->m_amount; }
+    {
+        Modifier* mod = (*i)->GetModifier();
+        switch (filter)
+        {
+            case AURA_MODIFIER_FILTER_MISC_MASK:
+                if (!(uint32(mod->m_miscvalue) & value))
+                    { continue; }
+                break;
+            case AURA_MODIFIER_FILTER_MISC_VALUE:
+                if (mod->m_miscvalue != int32(value))
+                    { continue; }
+                break;
+            default:
+                break;
+        }
+
+        totals.total += mod->m_amount;
+        totals.multiplier *= (100.0f + mod->m_amount) / 100.0f;
+        if (mod->m_amount > totals.maxPositive)
+            { totals.maxPositive = mod->m_amount; }
+        if (mod->m_amount < totals.maxNegative)
+            { totals.maxNegative = mod->m_amount; }
+    }
 
-    return modifier;
+    m_auraModifierTotals.insert(AuraModifierTotalsMap::value_type(key, totals));
+    return totals;
 }
 
-float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+void Unit::InvalidateAuraModifierTotals(AuraType auratype)
 {
-    float multiplier = 1.0f;
+    for (AuraModifierTotalsMap::iterator itr = m_auraModifierTotals.begin(); itr != m_auraModifierTotals.end();)
+    {
+        if (AuraType(itr->first & 0xFFFF) == auratype)
+            { itr = m_auraModifierTotals.erase(itr); }      // moves the last entry to itr
+        else
+            { ++itr; }
+    }
+}
 
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        { multiplier *= (100.0f + (*i)->GetModifier()->m_amount) / 100.0f; }
+int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+{
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_NONE, 0).total;
+}
 
-    return multiplier;
+float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+{
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_NONE, 0).multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount > modifier)
-            { modifier = (*i)->GetModifier()->m_amount; }
-
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_NONE, 0).maxPositive;
 }
 
 int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount < modifier)
-            { modifier = (*i)->GetModifier()->m_amount; }
-
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_NONE, 0).maxNegative;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
@@ -3276,16 +3305,7 @@ int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask)
     if (!misc_mask)
         { return 0; }
 
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask)
-            { modifier += mod->m_amount; }
-    }
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_MASK, misc_mask).total;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask) const
@@ -3293,16 +3313,7 @@ float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask
     if (!misc_mask)
         { return 1.0f; }
 
-    float multiplier = 1.0f;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask)
-            { multiplier *= (100.0f + mod->m_amount) / 100.0f; }
-    }
-    return multiplier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_MASK, misc_mask).multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
@@ -3310,17 +3321,7 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_
     if (!misc_mask)
         { return 0; }
 
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask && mod->m_amount > modifier)
-            { modifier = mod->m_amount; }
-    }
-
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_MASK, misc_mask).maxPositive;
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
@@ -3328,75 +3329,27 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_
     if (!misc_mask)
         { return 0; }
 
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue & misc_mask && mod->m_amount < modifier)
-            { modifier = mod->m_amount; }
-    }
-
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_MASK, misc_mask).maxNegative;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value)
-            { modifier += mod->m_amount; }
-    }
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_VALUE, uint32(misc_value)).total;
 }
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    float multiplier = 1.0f;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value)
-            { multiplier *= (100.0f + mod->m_amount) / 100.0f; }
-    }
-    return multiplier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_VALUE, uint32(misc_value)).multiplier;
 }
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value && mod->m_amount > modifier)
-            { modifier = mod->m_amount; }
-    }
-
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_VALUE, uint32(misc_value)).maxPositive;
 }
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
-    int32 modifier = 0;
-
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for (AuraList::const_iterator i = mTotalAuraList.begin(); i != mTotalAuraList.end(); ++i)
-    {
-        Modifier* mod = (*i)->GetModifier();
-        if (mod->m_miscvalue == misc_value && mod->m_amount < modifier)
-            { modifier = mod->m_amount; }
-    }
-
-    return modifier;
+    return GetAuraModifierTotals(auratype, AURA_MODIFIER_FILTER_MISC_VALUE, uint32(misc_value)).maxNegative;
 }
 
 bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
@@ -3556,6 +3509,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     // add aura, register in lists and arrays
     holder->_AddSpellAuraHolder();
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddProcHolder(holder);
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -3577,7 +3531,10 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
 void Unit::AddAuraToModList(Aura* aura)
 {
     if (aura->GetModifier()->m_auraname < TOTAL_AURAS)
-        { m_modAuras[aura->GetModifier()->m_auraname].push_back(aura); }
+    {
+        m_modAuras[aura->GetModifier()->m_auraname].push_back(aura);
+        InvalidateAuraModifierTotals(aura->GetModifier()->m_auraname);
+    }
 }
 
 void Unit::RemoveRankAurasDueToSpell(uint32 spellId)
@@ -4013,9 +3970,6 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
         if (caster->GetTypeId() == TYPEID_UNIT && ((Creature*)caster)->IsTotem() && ((Totem*)caster)->GetTotemType() == TOTEM_STATUE)
             { statue = ((Totem*)caster); }
 
-    if (m_spellAuraHoldersUpdateIterator != m_spellAuraHolders.end() && m_spellAuraHoldersUpdateIterator->second == holder)
-        { ++m_spellAuraHoldersUpdateIterator; }
-
     SpellAuraHolderBounds bounds = GetSpellAuraHolderBounds(holder->GetId());
     for (SpellAuraHolderMap::iterator itr = bounds.first; itr != bounds.second; ++itr)
     {
@@ -4025,6 +3979,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
             break;
         }
     }
+    RemoveProcHolder(holder);
 
     holder->SetRemoveMode(mode);
     holder->UnregisterAndCleanupTrackedAuras();
@@ -4078,6 +4033,7 @@ void Unit::RemoveAura(Aura* Aur, AuraRemoveMode mode)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
         m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur);
+        InvalidateAuraModifierTotals(Aur->GetModifier()->m_auraname);
     }
 
     // Set remove mode
@@ -4118,6 +4074,34 @@ void Unit::RemoveAura(Aura* Aur, AuraRemoveMode mode)
         { delete Aur; }
 }
 
+void Unit::AddProcHolder(SpellAuraHolder* holder)
+{
+    // same flags as checked first at Unit::IsTriggeredAtSpellProcEvent
+    SpellEntry const* spellProto = holder->GetSpellProto();
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(spellProto->Id);
+
+    ProcHolderEntry entry;
+    entry.procFlags = spellProcEvent && spellProcEvent->procFlags ? spellProcEvent->procFlags : spellProto->procFlags;
+    entry.holder = holder;
+
+    if (!entry.procFlags)
+        { return; }                                         // never procs
+
+    m_procHolders.push_back(entry);
+}
+
+void Unit::RemoveProcHolder(SpellAuraHolder* holder)
+{
+    for (ProcHolderList::iterator itr = m_procHolders.begin(); itr != m_procHolders.end(); ++itr)
+    {
+        if (itr->holder == holder)
+        {
+            m_procHolders.erase(itr);
+            break;
+        }
+    }
+}
+
 void Unit::RemoveAllAuras(AuraRemoveMode mode /*= AURA_REMOVE_BY_DEFAULT*/)
 {
     while (!m_spellAuraHolders.empty())
@@ -7661,9 +7645,14 @@ void Unit::SetLevel(uint32 lvl)
 {
     SetUInt32Value(UNIT_FIELD_LEVEL, lvl);
 
-    // group update
-    if ((GetTypeId() == TYPEID_PLAYER) && ((Player*)this)->GetGroup())
-        { ((Player*)this)->SetGroupUpdateFlag(GROUP_UPDATE_FLAG_LEVEL); }
+    if (GetTypeId() == TYPEID_PLAYER)
+    {
+        sWhoListMgr.UpdateLevel((Player*)this);
+
+        // group update
+        if (((Player*)this)->GetGroup())
+            { ((Player*)this)->SetGroupUpdateFlag(GROUP_UPDATE_FLAG_LEVEL); }
+    }
 }
 
 void Unit::SetHealth(uint32 val)
@@ -7856,6 +7845,7 @@ uint32 Unit::GetCreatePowers(Powers power) const
 void Unit::AddToWorld()
 {
     Object::AddToWorld();
+    GetMap()->AddToSpatialHash(this);
     ScheduleAINotify(0);
 }
 
@@ -7871,6 +7861,7 @@ void Unit::RemoveFromWorld()
         RemoveAllDynObjects();
         CleanupDeletedAuras();
         GetViewPoint().Event_RemovedFromWorld();
+        GetMap()->RemoveFromSpatialHash(this);
     }
 
     Object::RemoveFromWorld();
@@ -8233,19 +8224,22 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag,
 
     RemoveSpellList removedSpells;
     ProcTriggeredList procTriggered;
-    // Fill procTriggered list
-    for (SpellAuraHolderMap::const_iterator itr = GetSpellAuraHolderMap().begin(); itr != GetSpellAuraHolderMap().end(); ++itr)
+    // Fill procTriggered list, only holders reacting to one of the proc flags can trigger
+    for (ProcHolderList::const_iterator itr = m_procHolders.begin(); itr != m_procHolders.end(); ++itr)
     {
+        if (!(itr->procFlags & procFlag))
+            { continue; }
+
         // skip deleted auras (possible at recursive triggered call
-        if (itr->second->IsDeleted())
+        if (itr->holder->IsDeleted())
             { continue; }
 
         SpellProcEventEntry const* spellProcEvent = NULL;
-        if (!IsTriggeredAtSpellProcEvent(pTarget, itr->second, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent))
+        if (!IsTriggeredAtSpellProcEvent(pTarget, itr->holder, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent))
             { continue; }
 
-        itr->second->SetInUse(true);                        // prevent holder deletion
-        procTriggered.push_back(ProcTriggeredData(spellProcEvent, itr->second));
+        itr->holder->SetInUse(true);                        // prevent holder deletion
+        procTriggered.push_back(ProcTriggeredData(spellProcEvent, itr->holder));
     }
 
     // Nothing found
@@ -8636,6 +8630,10 @@ void Unit::UpdateModelData()
             { SetFloatValue(UNIT_FIELD_COMBATREACH, 1.5f); }
         else
             { SetFloatValue(UNIT_FIELD_COMBATREACH, GetObjectScale() * modelInfo->combat_reach); }
+
+        // the bounding radius decides how far out of its position the unit is found
+        if (IsInSpatialHash())
+            { GetMap()->RelocateInSpatialHash(this); }
     }
 }
 
@@ -8707,10 +8705,10 @@ void Unit::UpdateReactives(uint32 p_time)
 
 Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /*= ATTACK_DISTANCE*/) const
 {
-    std::list<Unit*> targets;
+    UnitTickList targets;
 
     MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck u_check(this, radius);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyUnfriendlyUnitInObjectRangeCheck, UnitTickList> searcher(targets, u_check);
     Cell::VisitAllObjects(this, searcher, radius);
 
     // remove current target
@@ -8718,11 +8716,11 @@ Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /
         { targets.remove(except); }
 
     // remove not LoS targets
-    for (std::list<Unit*>::iterator tIter = targets.begin(); tIter != targets.end();)
+    for (UnitTickList::iterator tIter = targets.begin(); tIter != targets.end();)
     {
         if (!IsWithinLOSInMap(*tIter))
         {
-            std::list<Unit*>::iterator tIter2 = tIter;
+            UnitTickList::iterator tIter2 = tIter;
             ++tIter;
             targets.erase(tIter2);
         }
@@ -8736,7 +8734,7 @@ Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /
 
     // select random
     uint32 rIdx = urand(0, targets.size() - 1);
-    std::list<Unit*>::const_iterator tcIter = targets.begin();
+    UnitTickList::const_iterator tcIter = targets.begin();
     for (uint32 i = 0; i < rIdx; ++i)
         { ++tcIter; }
 
@@ -8745,10 +8743,10 @@ Unit* Unit::SelectRandomUnfriendlyTarget(Unit* except /*= NULL*/, float radius /
 
 Unit* Unit::SelectRandomFriendlyTarget(Unit* except /*= NULL*/, float radius /*= ATTACK_DISTANCE*/) const
 {
-    std::list<Unit*> targets;
+    UnitTickList targets;
 
     MaNGOS::AnyFriendlyUnitInObjectRangeCheck u_check(this, radius);
-    MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck> searcher(targets, u_check);
+    MaNGOS::UnitListSearcher<MaNGOS::AnyFriendlyUnitInObjectRangeCheck, UnitTickList> searcher(targets, u_check);
 
     Cell::VisitAllObjects(this, searcher, radius);
 
@@ -8757,11 +8755,11 @@ Unit* Unit::SelectRandomFriendlyTarget(Unit* except /*= NULL*/, float radius /*=
         { targets.remove(except); }
 
     // remove not LoS targets
-    for (std::list<Unit*>::iterator tIter = targets.begin(); tIter != targets.end();)
+    for (UnitTickList::iterator tIter = targets.begin(); tIter != targets.end();)
     {
         if (!IsWithinLOSInMap(*tIter))
         {
-            std::list<Unit*>::iterator tIter2 = tIter;
+            UnitTickList::iterator tIter2 = tIter;
             ++tIter;
             targets.erase(tIter2);
         }
@@ -8775,7 +8773,7 @@ Unit* Unit::SelectRandomFriendlyTarget(Unit* except /*= NULL*/, float radius /*=
 
     // select random
     uint32 rIdx = urand(0, targets.size() - 1);
-    std::list<Unit*>::const_iterator tcIter = targets.begin();
+    UnitTickList::const_iterator tcIter = targets.begin();
     for (uint32 i = 0; i < rIdx; ++i)
         { ++tcIter; }
 
@@ -9070,7 +9068,7 @@ SpellAuraHolder* Unit::GetSpellAuraHolder(uint32 spellid, ObjectGuid casterGuid)
     return NULL;
 }
 
-class RelocationNotifyEvent : public BasicEvent
+class RelocationNotifyEvent : public BasicEvent, public MemoryTracked<MEM_TAG_EVENT>
 {
     public:
         RelocationNotifyEvent(Unit& owner) : BasicEvent(), m_owner(owner)
@@ -9080,18 +9078,11 @@ class RelocationNotifyEvent : public BasicEvent
 
         bool Execute(uint64 /*e_time*/, uint32 /*p_time*/)
         {
-            float radius = MAX_CREATURE_ATTACK_RADIUS * sWorld.getConfig(CONFIG_FLOAT_RATE_CREATURE_AGGRO);
-            if (m_owner.GetTypeId() == TYPEID_PLAYER)
-            {
-                MaNGOS::PlayerRelocationNotifier notify((Player&)m_owner);
-                Cell::VisitAllObjects(&m_owner, notify, radius);
-            }
-            else // if(m_owner.GetTypeId() == TYPEID_UNIT)
-            {
-                MaNGOS::CreatureRelocationNotifier notify((Creature&)m_owner);
-                Cell::VisitAllObjects(&m_owner, notify, radius);
-            }
-            m_owner._SetAINotifyScheduled(false);
+            // the map visits the cells of all units due in this tick at once, see Map::ProcessRelocationNotifies
+            if (m_owner.IsInWorld())
+                { m_owner.GetMap()->AddRelocationNotify(&m_owner); }
+            else
+                { m_owner._SetAINotifyScheduled(false); }
             return true;
         }
 
@@ -9123,7 +9114,7 @@ void Unit::OnRelocated()
         m_last_notified_position.y = GetPositionY();
         m_last_notified_position.z = GetPositionZ();
 
-        GetViewPoint().Call_UpdateVisibilityForOwner();
+        GetViewPoint().Call_UpdateVisibilityForOwnerOnMove();
         UpdateObjectVisibility();
     }
     ScheduleAINotify(World::GetRelocationAINotifyDelay());
@@ -9149,6 +9140,15 @@ void Unit::UpdateSplineMovement(uint32 t_diff)
     if (m_movesplineTimer.Passed() || arrived)
     {
         m_movesplineTimer.Reset(POSITION_UPDATE_DELAY);
+
+        // intermediate creature positions are relocated in one batch after the map regions are updated,
+        // the arrival is relocated at once as the next movement starts from there
+        if (GetTypeId() != TYPEID_PLAYER && !arrived)
+        {
+            GetMap()->AddSplineRelocation((Creature*)this);
+            return;
+        }
+
         Movement::Location loc = movespline->ComputePosition();
 
         if (GetTypeId() == TYPEID_PLAYER)
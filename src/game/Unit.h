@@ -44,9 +44,12 @@
 #include "MotionMaster.h"
 #include "DBCStructure.h"
 #include "Path.h"
+#include "SpatialHash.h"
 #include "WorldPacket.h"
 #include "Timer.h"
 #include "Log.h"
+#include "Utilities/FlatHashMap.h"
+#include "Utilities/SlotMultimap.h"
 #include <list>
 
 enum SpellInterruptFlags
@@ -1110,18 +1113,46 @@ enum ReactiveType
 
 struct SpellProcEventEntry;                                 // used only privately
 
+/// Which modifiers of an aura type are aggregated, see Unit::GetAuraModifierTotals
+enum AuraModifierFilter
+{
+    AURA_MODIFIER_FILTER_NONE       = 0,
+    AURA_MODIFIER_FILTER_MISC_MASK  = 1,                    // m_miscvalue has a bit of the mask
+    AURA_MODIFIER_FILTER_MISC_VALUE = 2                     // m_miscvalue equals the value
+};
+
+/// Aggregates of the modifiers of the auras of one type
+struct AuraModifierTotals
+{
+    int32 total;
+    float multiplier;                                       // product of (100 + amount) / 100
+    int32 maxPositive;                                      // 0 if there is no positive amount
+    int32 maxNegative;                                      // 0 if there is no negative amount
+};
+
+/// Hash of the aura type, filter and filter value keys of Unit::m_auraModifierTotals
+struct AuraModifierTotalsHash
+{
+    uint32 operator()(uint64 key) const
+    {
+        uint32 hash = (uint32(key) ^ uint32(key >> 32)) * 0x9E3779B1;
+        return hash ^ (hash >> 16);
+    }
+};
+
 class MANGOS_DLL_SPEC Unit : public WorldObject
 {
     public:
         typedef std::set<Unit*> AttackerSet;
         /**
          * A multimap from spell ids to \ref SpellAuraHolder, multiple \ref SpellAuraHolder can have
-         * the same id (ie: the same key)
+         * the same id (ie: the same key). Removed holders only free their slot, iterations over the
+         * map may remove holders and go on, the slots are released after the aura update.
          */
-        typedef std::multimap < uint32 /*spellId*/, SpellAuraHolder* > SpellAuraHolderMap;
+        typedef SlotMultimap < uint32 /*spellId*/, SpellAuraHolder* > SpellAuraHolderMap;
         /**
          * A pair of two iterators to a \ref SpellAuraHolderMap which is used in conjunction
-         * with the std::multimap::equal_range which gives all \ref SpellAuraHolder that have the same
+         * with the SlotMultimap::equal_range which gives all \ref SpellAuraHolder that have the same
          * spellid in this case, the first member is the iterator to the beginning, and the
          * second member is the iterator to the end.
          */
@@ -1129,6 +1160,16 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         /// Same thing as \ref SpellAuraHolderBounds but with const_iterator instead of iterator
         typedef std::pair<SpellAuraHolderMap::const_iterator, SpellAuraHolderMap::const_iterator> SpellAuraHolderConstBounds;
         typedef std::list<SpellAuraHolder*> SpellAuraHolderList;
+        /**
+         * A \ref SpellAuraHolder that can proc together with the proc flags it reacts to,
+         * entries of \ref Unit::m_procHolders
+         */
+        struct ProcHolderEntry
+        {
+            uint32 procFlags;                               // spell_proc_event flags or the ones of the spell
+            SpellAuraHolder* holder;
+        };
+        typedef std::vector<ProcHolderEntry> ProcHolderList;
         /**
          * List of \ref Aura used in \ref Unit::GetAurasByType and more and also in the members
          * \ref Unit::m_modAuras and \ref Unit::m_deletedAuras
@@ -3511,6 +3552,14 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         int32 GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const;
         int32 GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const;
 
+        /**
+         * Drops the cached aggregates of the given \ref AuraType, must be called whenever an
+         * \ref Aura of the type is added, removed or changes its \ref Modifier
+         * @param auratype the type whose auras changed
+         * \see Unit::GetAuraModifierTotals
+         */
+        void InvalidateAuraModifierTotals(AuraType auratype);
+
         Aura* GetDummyAura(uint32 spell_id) const;
 
         uint32 m_AuraFlags;
@@ -3620,6 +3669,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
 
         void AddFollower(FollowerReference* pRef) { m_FollowingRefManager.insertFirst(pRef); }
         void RemoveFollower(FollowerReference* /*pRef*/) { /* nothing to do yet */ }
+        FollowerRefManager& GetFollowerRefManager() { return m_FollowingRefManager; }
 
         MotionMaster* GetMotionMaster() { return &i_motionMaster; }
 
@@ -3667,6 +3717,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         void _SetAINotifyScheduled(bool on) { m_AINotifyScheduled = on;}       // only for call from RelocationNotifyEvent code
         void OnRelocated();
 
+        SpatialHashSlot& GetSpatialHashSlot() { return m_spatialHashSlot; }
+        bool IsInSpatialHash() const { return m_spatialHashSlot.IsValid(); }
+
         bool IsLinkingEventTrigger() { return m_isCreatureLinkingTrigger; }
 
     protected:
@@ -3686,7 +3739,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         DeathState m_deathState; ///< The current state of life/death for this \ref Unit
 
         SpellAuraHolderMap m_spellAuraHolders;
-        SpellAuraHolderMap::iterator m_spellAuraHoldersUpdateIterator; // != end() in Unit::m_spellAuraHolders update and point to next element
+        ProcHolderList m_procHolders;                       // holders of m_spellAuraHolders with proc flags, in the same order
         AuraList m_deletedAuras;                            // auras removed while in ApplyModifier and waiting deleted
         SpellAuraHolderList m_deletedHolders;
 
@@ -3702,7 +3755,18 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         bool m_isSorted;
         uint32 m_transform;
 
+        /**
+         * Aggregates the modifiers of the auras of a type, computed at the first use after a change
+         * @param auratype the aura type
+         * @param filter which modifiers are included
+         * @param value the misc mask or misc value of the filter
+         * @return the aggregates of the matching modifiers
+         */
+        AuraModifierTotals GetAuraModifierTotals(AuraType auratype, AuraModifierFilter filter, uint32 value) const;
+
         AuraList m_modAuras[TOTAL_AURAS];
+        typedef FlatHashMap<uint64, AuraModifierTotals, AuraModifierTotalsHash> AuraModifierTotalsMap;
+        mutable AuraModifierTotalsMap m_auraModifierTotals;  // by aura type, filter and filter value
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
         float m_weaponDamage[MAX_ATTACK][2];
         bool m_canModifyStats;
@@ -3728,6 +3792,10 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         void CleanupDeletedAuras();
         void UpdateSplineMovement(uint32 t_diff);
 
+        // keep m_procHolders in step with m_spellAuraHolders
+        void AddProcHolder(SpellAuraHolder* holder);
+        void RemoveProcHolder(SpellAuraHolder* holder);
+
         Unit* _GetTotem(TotemSlot slot) const;              // for templated function without include need
         Pet* _GetPet(ObjectGuid guid) const;                // for templated function without include need
 
@@ -3745,6 +3813,7 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         Position m_last_notified_position;
         bool m_AINotifyScheduled;
         ShortTimeTracker m_movesplineTimer;
+        SpatialHashSlot m_spatialHashSlot;
 
         Diminishing m_Diminishing;
         // Manage all Units threatening us
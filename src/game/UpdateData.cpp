@@ -31,19 +31,27 @@
 #include "Opcodes.h"
 #include "World.h"
 #include "ObjectGuid.h"
+#include "NetworkStats.h"
 
-UpdateData::UpdateData() : m_blockCount(0)
+#include <ace/TSS_T.h>
+
+UpdateData::UpdateData() : m_blockCount(0), m_data(ByteBuffer::DEFAULT_SIZE, MEM_TAG_UPDATEDATA)
 {
 }
 
 void UpdateData::AddOutOfRangeGUID(GuidSet& guids)
 {
-    m_outOfRangeGUIDs.insert(guids.begin(), guids.end());
+    m_outOfRangeGUIDs.insert(m_outOfRangeGUIDs.end(), guids.begin(), guids.end());
+}
+
+void UpdateData::AddOutOfRangeGUID(GuidVector const& guids)
+{
+    m_outOfRangeGUIDs.insert(m_outOfRangeGUIDs.end(), guids.begin(), guids.end());
 }
 
 void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
 {
-    m_outOfRangeGUIDs.insert(guid);
+    m_outOfRangeGUIDs.push_back(guid);
 }
 
 void UpdateData::AddUpdateBlock(const ByteBuffer& block)
@@ -52,44 +60,98 @@ void UpdateData::AddUpdateBlock(const ByteBuffer& block)
     ++m_blockCount;
 }
 
-void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+/// Deflate stream of a thread, initialized once and reset between packets
+class UpdateDataDeflateStream
+{
+    public:
+        UpdateDataDeflateStream() : m_initialized(false), m_level(0)
+        {
+            m_stream.zalloc = (alloc_func)0;
+            m_stream.zfree = (free_func)0;
+            m_stream.opaque = (voidpf)0;
+        }
+
+        ~UpdateDataDeflateStream()
+        {
+            if (m_initialized)
+                { deflateEnd(&m_stream); }
+        }
+
+        // returns NULL if the stream can't be initialized
+        z_stream* Acquire(int level)
+        {
+            // the compression level can be changed by config reload
+            if (m_initialized && (m_level != level || deflateReset(&m_stream) != Z_OK))
+            {
+                deflateEnd(&m_stream);
+                m_initialized = false;
+            }
+
+            if (!m_initialized)
+            {
+                int z_res = deflateInit(&m_stream, level);
+                if (z_res != Z_OK)
+                {
+                    sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return NULL;
+                }
+
+                m_initialized = true;
+                m_level = level;
+            }
+
+            return &m_stream;
+        }
+
+    private:
+        z_stream m_stream;
+        bool m_initialized;
+        int m_level;
+};
+
+typedef ACE_TSS<UpdateDataDeflateStream> UpdateDataDeflateStreamTSS;
+static UpdateDataDeflateStreamTSS deflateStream;
+
+/// Compresses header and data as one stream, so they don't have to be joined in a temporary buffer first
+void UpdateData::Compress(void* dst, uint32* dst_size, ByteBuffer const& header, ByteBuffer const& data)
 {
-    z_stream c_stream;
-
-    c_stream.zalloc = (alloc_func)0;
-    c_stream.zfree = (free_func)0;
-    c_stream.opaque = (voidpf)0;
-
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    z_stream* c_stream = deflateStream->Acquire(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (!c_stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
-
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
 
-    if (c_stream.avail_in != 0)
+    ByteBuffer const* parts[2] = { &header, &data };
+    for (int i = 0; i < 2; ++i)
     {
-        sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
-        *dst_size = 0;
-        return;
+        if (!parts[i]->wpos())
+            { continue; }
+
+        c_stream->next_in = (Bytef*)parts[i]->contents();
+        c_stream->avail_in = (uInt)parts[i]->wpos();
+
+        int z_res = deflate(c_stream, Z_NO_FLUSH);
+        if (z_res != Z_OK)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
+            *dst_size = 0;
+            return;
+        }
+
+        if (c_stream->avail_in != 0)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
+            *dst_size = 0;
+            return;
+        }
     }
 
-    z_res = deflate(&c_stream, Z_FINISH);
+    int z_res = deflate(c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
         sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
@@ -97,38 +159,28 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
-    *dst_size = c_stream.total_out;
+    *dst_size = c_stream->total_out;
 }
 
 bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport)
 {
     MANGOS_ASSERT(packet->empty());                         // shouldn't happen
 
-    ByteBuffer buf(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()) + m_data.wpos());
+    ByteBuffer header(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()));
 
-    buf << (uint32)(!m_outOfRangeGUIDs.empty() ? m_blockCount + 1 : m_blockCount);
-    buf << (uint8)(hasTransport ? 1 : 0);
+    header << (uint32)(!m_outOfRangeGUIDs.empty() ? m_blockCount + 1 : m_blockCount);
+    header << (uint8)(hasTransport ? 1 : 0);
 
     if (!m_outOfRangeGUIDs.empty())
     {
-        buf << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
-        buf << (uint32) m_outOfRangeGUIDs.size();
+        header << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
+        header << (uint32) m_outOfRangeGUIDs.size();
 
-        for (GuidSet::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
-            { buf << i->WriteAsPacked(); }
+        for (GuidVector::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
+            { header << i->WriteAsPacked(); }
     }
 
-    buf.append(m_data);
-
-    size_t pSize = buf.wpos();                              // use real used data size
+    size_t pSize = header.wpos() + m_data.wpos();           // use real used data size
 
     if (pSize > 100)                                        // compress large packets
     {
@@ -136,17 +188,21 @@ bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport)
         packet->resize(destsize + sizeof(uint32));
 
         packet->put<uint32>(0, pSize);
-        Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+        Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, header, m_data);
         if (destsize == 0)
             { return false; }
 
         packet->resize(destsize + sizeof(uint32));
         packet->SetOpcode(SMSG_COMPRESSED_UPDATE_OBJECT);
+        sNetworkStats.CountUpdatePacket(true, pSize, packet->size());
     }
     else                                                    // send small packets without compression
     {
-        packet->append(buf);
+        packet->reserve(pSize);
+        packet->append(header);
+        packet->append(m_data);
         packet->SetOpcode(SMSG_UPDATE_OBJECT);
+        sNetworkStats.CountUpdatePacket(false, pSize, pSize);
     }
 
     return true;
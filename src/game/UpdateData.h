@@ -59,19 +59,20 @@ class UpdateData
         UpdateData();
 
         void AddOutOfRangeGUID(GuidSet& guids);
+        void AddOutOfRangeGUID(GuidVector const& guids);
         void AddOutOfRangeGUID(ObjectGuid const& guid);
         void AddUpdateBlock(const ByteBuffer& block);
         bool BuildPacket(WorldPacket* packet, bool hasTransport = false);
         bool HasData() { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
-        GuidSet const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
+        GuidVector const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
 
     protected:
         uint32 m_blockCount;
-        GuidSet m_outOfRangeGUIDs;
+        GuidVector m_outOfRangeGUIDs;                       // callers add every object once
         ByteBuffer m_data;
 
-        void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+        void Compress(void* dst, uint32* dst_size, ByteBuffer const& header, ByteBuffer const& data);
 };
 #endif
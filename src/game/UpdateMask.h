@@ -27,16 +27,26 @@
 
 #include "UpdateFields.h"
 #include "Errors.h"
+#include "Utilities/ByteConverter.h"
+
+#if COMPILER == COMPILER_MICROSOFT
+#  include <intrin.h>
+#endif
+
+/// Blocks for the values of any object type, size of the storage passed to UpdateMask(uint32*)
+#define UPDATE_MASK_MAX_BLOCKS ((PLAYER_END + 31) / 32)
 
 class UpdateMask
 {
     public:
-        UpdateMask() : mCount(0), mBlocks(0), mUpdateMask(0) { }
-        UpdateMask(const UpdateMask& mask) : mUpdateMask(0) { *this = mask; }
+        UpdateMask() : mCount(0), mBlocks(0), mUpdateMask(0), mStorage(0) { }
+        // uses storage of UPDATE_MASK_MAX_BLOCKS blocks instead of heap memory, like a stack array outliving the mask
+        explicit UpdateMask(uint32* storage) : mCount(0), mBlocks(0), mUpdateMask(0), mStorage(storage) { }
+        UpdateMask(const UpdateMask& mask) : mUpdateMask(0), mStorage(0) { *this = mask; }
 
         ~UpdateMask()
         {
-            delete[] mUpdateMask;
+            FreeMask();
         }
 
         void SetBit(uint32 index)
@@ -59,14 +69,53 @@ class UpdateMask
         uint32 GetCount() const { return mCount; }
         uint8* GetMask() { return (uint8*)mUpdateMask; }
 
+        // index of the first set bit at or after index, GetCount() if there is none
+        uint32 FindNextBit(uint32 index) const
+        {
+            uint32 block = index >> 5;
+            if (block >= mBlocks)
+                { return mCount; }
+
+            // the mask is sent as bytes, bit 0 of the first byte is index 0 on any byte order
+            uint32 bits = mUpdateMask[block];
+            EndianConvert(bits);
+            bits &= ~uint32(0) << (index & 31);
+
+            while (!bits)
+            {
+                if (++block >= mBlocks)
+                    { return mCount; }
+
+                bits = mUpdateMask[block];
+                EndianConvert(bits);
+            }
+
+            return (block << 5) + CountTrailingZeros(bits);
+        }
+
+        bool IsEmpty() const
+        {
+            for (uint32 i = 0; i < mBlocks; ++i)
+            {
+                if (mUpdateMask[i])
+                    { return false; }
+            }
+
+            return true;
+        }
+
         void SetCount(uint32 valuesCount)
         {
-            delete[] mUpdateMask;
+            FreeMask();
 
             mCount = valuesCount;
             mBlocks = (valuesCount + 31) / 32;
 
-            mUpdateMask = new uint32[mBlocks];
+            if (mStorage && mBlocks <= UPDATE_MASK_MAX_BLOCKS)
+                { mUpdateMask = mStorage; }
+            else
+                { mUpdateMask = new uint32[mBlocks]; }
+
             memset(mUpdateMask, 0, mBlocks << 2);
         }
 
@@ -121,8 +170,36 @@ class UpdateMask
         }
 
     private:
+        void FreeMask()
+        {
+            if (mUpdateMask != mStorage)
+                { delete[] mUpdateMask; }
+            mUpdateMask = 0;
+        }
+
+        // value must not be 0
+        static uint32 CountTrailingZeros(uint32 value)
+        {
+#if COMPILER == COMPILER_GNU
+            return __builtin_ctz(value);
+#elif COMPILER == COMPILER_MICROSOFT
+            unsigned long index;
+            _BitScanForward(&index, value);
+            return uint32(index);
+#else
+            uint32 count = 0;
+            while (!(value & 1))
+            {
+                value >>= 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+
         uint32 mCount;
         uint32 mBlocks;
         uint32* mUpdateMask;
+        uint32* mStorage;                                   // not owned, NULL for heap memory
 };
 #endif
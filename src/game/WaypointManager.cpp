@@ -31,6 +31,8 @@
 #include "ObjectMgr.h"
 #include "ScriptMgr.h"
 
+#include <algorithm>
+
 INSTANTIATE_SINGLETON_1(WaypointManager);
 
 bool WaypointBehavior::isEmpty()
@@ -45,6 +47,12 @@ bool WaypointBehavior::isEmpty()
     return true;
 }
 
+WaypointBehavior::WaypointBehavior() : emote(0), spell(0), model1(0), model2(0)
+{
+    for (int i = 0; i < MAX_WAYPOINT_TEXT; ++i)
+        { textid[i] = 0; }
+}
+
 WaypointBehavior::WaypointBehavior(const WaypointBehavior& b)
 {
     emote = b.emote;
@@ -55,6 +63,57 @@ WaypointBehavior::WaypointBehavior(const WaypointBehavior& b)
         { textid[i] = b.textid[i]; }
 }
 
+/// Order of nodes in a path
+struct WaypointNodePointLess
+{
+    bool operator()(WaypointNode const& node, uint32 point) const { return node.point < point; }
+};
+
+size_t WaypointPath::FindIndex(uint32 point) const
+{
+    NodeList::const_iterator itr = std::lower_bound(m_nodes.begin(), m_nodes.end(), point, WaypointNodePointLess());
+    return itr != m_nodes.end() && itr->point == point ? size_t(itr - m_nodes.begin()) : m_nodes.size();
+}
+
+WaypointNode* WaypointPath::FindNode(uint32 point)
+{
+    size_t index = FindIndex(point);
+    return index < m_nodes.size() ? &m_nodes[index] : NULL;
+}
+
+WaypointNode const* WaypointPath::FindNode(uint32 point) const
+{
+    size_t index = FindIndex(point);
+    return index < m_nodes.size() ? &m_nodes[index] : NULL;
+}
+
+WaypointNode& WaypointPath::InsertNode(uint32 point)
+{
+    // nodes are loaded ordered by point, so they are usually appended
+    if (m_nodes.empty() || m_nodes.back().point < point)
+    {
+        m_nodes.push_back(WaypointNode());
+        m_nodes.back().point = point;
+        return m_nodes.back();
+    }
+
+    NodeList::iterator itr = std::lower_bound(m_nodes.begin(), m_nodes.end(), point, WaypointNodePointLess());
+    if (itr == m_nodes.end() || itr->point != point)
+    {
+        itr = m_nodes.insert(itr, WaypointNode());
+        itr->point = point;
+    }
+
+    return *itr;
+}
+
+void WaypointPath::EraseNode(uint32 point)
+{
+    size_t index = FindIndex(point);
+    if (index < m_nodes.size())
+        { m_nodes.erase(m_nodes.begin() + index); }
+}
+
 void WaypointManager::Load()
 {
     uint32 total_paths = 0;
@@ -98,7 +157,7 @@ void WaypointManager::Load()
         //                                   0   1      2           3           4           5         6
         result = WorldDatabase.Query("SELECT id, point, position_x, position_y, position_z, waittime, script_id,"
                                      //   7        8        9        10       11       12     13     14           15      16
-                                     "textid1, textid2, textid3, textid4, textid5, emote, spell, orientation, model1, model2 FROM creature_movement");
+                                     "textid1, textid2, textid3, textid4, textid5, emote, spell, orientation, model1, model2 FROM creature_movement ORDER BY id, point");
 
         BarGoLink bar(result->GetRowCount());
 
@@ -125,7 +184,7 @@ void WaypointManager::Load()
                 { creatureNoMoveType.insert(id); }
 
             WaypointPath& path  = m_pathMap[id];
-            WaypointNode& node  = path[point];
+            WaypointNode& node  = path.InsertNode(point);
 
             node.x              = fields[2].GetFloat();
             node.y              = fields[3].GetFloat();
@@ -205,7 +264,7 @@ void WaypointManager::Load()
             // save memory by not storing empty behaviors
             if (!be.isEmpty())
             {
-                node.behavior = new WaypointBehavior(be);
+                node.behavior = _newBehavior(be);
                 ++total_behaviors;
             }
             else
@@ -269,7 +328,7 @@ void WaypointManager::Load()
         //                                   0      1      2           3           4           5         6
         result = WorldDatabase.Query("SELECT entry, point, position_x, position_y, position_z, waittime, script_id,"
                                      //   7        8        9        10       11       12     13     14           15      16
-                                     "textid1, textid2, textid3, textid4, textid5, emote, spell, orientation, model1, model2 FROM creature_movement_template");
+                                     "textid1, textid2, textid3, textid4, textid5, emote, spell, orientation, model1, model2 FROM creature_movement_template ORDER BY entry, point");
 
         BarGoLink bar(result->GetRowCount());
 
@@ -290,7 +349,7 @@ void WaypointManager::Load()
             }
 
             WaypointPath& path  = m_pathTemplateMap[entry];
-            WaypointNode& node  = path[point];
+            WaypointNode& node  = path.InsertNode(point);
 
             node.x              = fields[2].GetFloat();
             node.y              = fields[3].GetFloat();
@@ -360,7 +419,7 @@ void WaypointManager::Load()
             // save memory by not storing empty behaviors
             if (!be.isEmpty())
             {
-                node.behavior   = new WaypointBehavior(be);
+                node.behavior   = _newBehavior(be);
                 ++total_behaviors;
             }
             else
@@ -376,6 +435,17 @@ void WaypointManager::Load()
         sLog.outString(">>> Loaded %u path templates with %u nodes and %u behaviors", total_paths, total_nodes, total_behaviors);
     }
 
+    for (WaypointPathMap::iterator itr = m_pathMap.begin(); itr != m_pathMap.end(); ++itr)
+        { itr->second.Compact(); }
+
+    for (WaypointPathMap::iterator itr = m_pathTemplateMap.begin(); itr != m_pathTemplateMap.end(); ++itr)
+        { itr->second.Compact(); }
+
+    sLog.outString(">>> Waypoint storage uses %u KB for paths, %u KB for path templates and %u KB for %u behaviors",
+                   uint32(_getMemoryUsage(m_pathMap) / 1024), uint32(_getMemoryUsage(m_pathTemplateMap) / 1024),
+                   uint32(m_behaviors.size() * sizeof(WaypointBehavior) / 1024), uint32(m_behaviors.size()));
+    sLog.outString();
+
     if (!movementScriptSet.empty())
     {
         for (std::set<uint32>::const_iterator itr = movementScriptSet.begin(); itr != movementScriptSet.end(); ++itr)
@@ -385,20 +455,24 @@ void WaypointManager::Load()
 
 void WaypointManager::Unload()
 {
-    for (WaypointPathMap::iterator itr = m_pathMap.begin(); itr != m_pathMap.end(); ++itr)
-        { _clearPath(itr->second); }
     m_pathMap.clear();
-
-    for (WaypointPathMap::iterator itr = m_pathTemplateMap.begin(); itr != m_pathTemplateMap.end(); ++itr)
-        { _clearPath(itr->second); }
     m_pathTemplateMap.clear();
+    m_behaviors.clear();
 }
 
-void WaypointManager::_clearPath(WaypointPath& path)
+WaypointBehavior* WaypointManager::_newBehavior(WaypointBehavior const& behavior)
 {
-    for (WaypointPath::const_iterator itr = path.begin(); itr != path.end(); ++itr)
-        { delete itr->second.behavior; }
-    path.clear();
+    m_behaviors.push_back(behavior);
+    return &m_behaviors.back();
+}
+
+size_t WaypointManager::_getMemoryUsage(WaypointPathMap const& pathMap) const
+{
+    size_t usage = 0;
+    for (WaypointPathMap::const_iterator itr = pathMap.begin(); itr != pathMap.end(); ++itr)
+        { usage += sizeof(itr->first) + itr->second.GetMemoryUsage(); }
+
+    return usage;
 }
 
 /// - Insert after the last point
@@ -423,14 +497,16 @@ void WaypointManager::_addNode(uint32 id, uint32 point, float x, float y, float
                               "VALUES (%u,%u, %f,%f,%f,%f, %u,%u)",
                               id, point, x, y, z, o, wpGuid, delay);
 
-    m_pathMap[id][point] = WaypointNode(x, y, z, o, delay, 0, NULL);
+    WaypointNode& node = m_pathMap[id].InsertNode(point);
+    node = WaypointNode(x, y, z, o, delay, 0, NULL);
+    node.point = point;
 }
 
 uint32 WaypointManager::GetLastPoint(uint32 id, uint32 default_notfound)
 {
     WaypointPathMap::const_iterator itr = m_pathMap.find(id);
-    if (itr != m_pathMap.end() && itr->second.rbegin() != itr->second.rend())
-        { default_notfound = itr->second.rbegin()->first; }
+    if (itr != m_pathMap.end() && !itr->second.empty())
+        { default_notfound = itr->second[itr->second.size() - 1].point; }
 
     return default_notfound;
 }
@@ -443,7 +519,7 @@ void WaypointManager::DeleteNode(uint32 id, uint32 point)
     if (itr == m_pathMap.end())
         { return; }
 
-    itr->second.erase(point);
+    itr->second.EraseNode(point);
 }
 
 void WaypointManager::DeletePath(uint32 id)
@@ -451,7 +527,7 @@ void WaypointManager::DeletePath(uint32 id)
     WorldDatabase.PExecuteLog("DELETE FROM creature_movement WHERE id=%u", id);
     WaypointPathMap::iterator itr = m_pathMap.find(id);
     if (itr != m_pathMap.end())
-        { _clearPath(itr->second); }
+        { itr->second.clear(); }
     // the path is not removed from the map, just cleared
     // WMGs have pointers to the path, so deleting them would crash
     // this wastes some memory, but these functions are
@@ -465,12 +541,11 @@ void WaypointManager::SetNodePosition(uint32 id, uint32 point, float x, float y,
     if (itr == m_pathMap.end())
         { return; }
 
-    WaypointPath::iterator find = itr->second.find(point);
-    if (find != itr->second.end())
+    if (WaypointNode* node = itr->second.FindNode(point))
     {
-        find->second.x = x;
-        find->second.y = y;
-        find->second.z = z;
+        node->x = x;
+        node->y = y;
+        node->z = z;
     }
 }
 
@@ -495,11 +570,10 @@ void WaypointManager::SetNodeText(uint32 id, uint32 point, const char* text_fiel
     if (itr == m_pathMap.end())
         { return; }
 
-    WaypointPath::iterator find = itr->second.find(point);
-    if (find != itr->second.end())
+    if (WaypointNode* find = itr->second.FindNode(point))
     {
-        WaypointNode& node = find->second;
-        if (!node.behavior) { node.behavior = new WaypointBehavior(); }
+        WaypointNode& node = *find;
+        if (!node.behavior) { node.behavior = _newBehavior(WaypointBehavior()); }
 
 //        if(field == "text1") node.behavior->text[0] = text ? text : "";
 //        if(field == "text2") node.behavior->text[1] = text ? text : "";
@@ -547,15 +621,15 @@ void WaypointManager::CheckTextsExistance(std::set<int32>& ids)
 {
     for (WaypointPathMap::const_iterator pmItr = m_pathMap.begin(); pmItr != m_pathMap.end(); ++pmItr)
     {
-        for (WaypointPath::const_iterator pItr = pmItr->second.begin(); pItr != pmItr->second.end(); ++pItr)
-            if (pItr->second.behavior)
-                { CheckWPText(false, pmItr->first, pItr->first, pItr->second.behavior, ids); }
+        for (size_t i = 0; i < pmItr->second.size(); ++i)
+            if (WaypointBehavior* behavior = pmItr->second[i].behavior)
+                { CheckWPText(false, pmItr->first, pmItr->second[i].point, behavior, ids); }
     }
 
     for (WaypointPathMap::const_iterator pmItr = m_pathTemplateMap.begin(); pmItr != m_pathTemplateMap.end(); ++pmItr)
     {
-        for (WaypointPath::const_iterator pItr = pmItr->second.begin(); pItr != pmItr->second.end(); ++pItr)
-            if (pItr->second.behavior)
-                { CheckWPText(false, pmItr->first, pItr->first, pItr->second.behavior, ids); }
+        for (size_t i = 0; i < pmItr->second.size(); ++i)
+            if (WaypointBehavior* behavior = pmItr->second[i].behavior)
+                { CheckWPText(false, pmItr->first, pmItr->second[i].point, behavior, ids); }
     }
 }
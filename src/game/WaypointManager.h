@@ -27,6 +27,7 @@
 
 #include "Common.h"
 #include <vector>
+#include <deque>
 #include <string>
 #include "Utilities/UnorderedMapSet.h"
 #include "Policies/Singleton.h"
@@ -41,7 +42,7 @@ struct WaypointBehavior
     uint32 model2;
 
     bool isEmpty();
-    WaypointBehavior() {}
+    WaypointBehavior();
     WaypointBehavior(const WaypointBehavior& b);
 };
 
@@ -53,13 +54,45 @@ struct WaypointNode
     float orientation;
     uint32 delay;
     uint32 script_id;                                       // Added may 2010. WaypointBehavior w/DB data should in time be removed.
-    WaypointBehavior* behavior;
-    WaypointNode() : x(0.0f), y(0.0f), z(0.0f), orientation(0.0f), delay(0), script_id(0), behavior(NULL) {}
+    WaypointBehavior* behavior;                             // pooled by the WaypointManager
+    uint32 point;
+    WaypointNode() : x(0.0f), y(0.0f), z(0.0f), orientation(0.0f), delay(0), script_id(0), behavior(NULL), point(0) {}
     WaypointNode(float _x, float _y, float _z, float _o, uint32 _delay, uint32 _script_id, WaypointBehavior* _behavior)
-        : x(_x), y(_y), z(_z), orientation(_o), delay(_delay), script_id(_script_id), behavior(_behavior) {}
+        : x(_x), y(_y), z(_z), orientation(_o), delay(_delay), script_id(_script_id), behavior(_behavior), point(0) {}
 };
 
-typedef std::map < uint32 /*pointId*/, WaypointNode > WaypointPath;
+/**
+ * Nodes of a waypoint path in one array ordered by point id
+ *
+ * Walking the path goes by the index of a node, point ids are only looked up by binary search
+ * when the index a movement generator remembered does not hold its point anymore.
+ */
+class WaypointPath
+{
+    public:
+        typedef std::vector<WaypointNode> NodeList;
+
+        bool empty() const { return m_nodes.empty(); }
+        size_t size() const { return m_nodes.size(); }
+        WaypointNode const& operator[](size_t index) const { return m_nodes[index]; }
+
+        // index of the node with the point id, size() if there is none
+        size_t FindIndex(uint32 point) const;
+        WaypointNode* FindNode(uint32 point);
+        WaypointNode const* FindNode(uint32 point) const;
+
+        // get the node with the point id, created at its place if new
+        WaypointNode& InsertNode(uint32 point);
+        void EraseNode(uint32 point);
+        void clear() { m_nodes.clear(); }
+
+        // drop the spare capacity left by loading
+        void Compact() { NodeList(m_nodes).swap(m_nodes); }
+        size_t GetMemoryUsage() const { return sizeof(*this) + m_nodes.capacity() * sizeof(WaypointNode); }
+
+    private:
+        NodeList m_nodes;
+};
 
 class WaypointManager
 {
@@ -92,12 +125,15 @@ class WaypointManager
         void CheckTextsExistance(std::set<int32>& ids);
 
     private:
+        typedef UNORDERED_MAP < uint32 /*guidOrEntry*/, WaypointPath > WaypointPathMap;
+
         void _addNode(uint32 id, uint32 point, float x, float y, float z, float o, uint32 delay, uint32 wpGuid);
-        void _clearPath(WaypointPath& path);
+        WaypointBehavior* _newBehavior(WaypointBehavior const& behavior);
+        size_t _getMemoryUsage(WaypointPathMap const& pathMap) const;
 
-        typedef UNORDERED_MAP < uint32 /*guidOrEntry*/, WaypointPath > WaypointPathMap;
         WaypointPathMap m_pathMap;
         WaypointPathMap m_pathTemplateMap;
+        std::deque<WaypointBehavior> m_behaviors;           // behaviors of all nodes, a deque keeps them in place when it grows
 };
 
 #define sWaypointMgr MaNGOS::Singleton<WaypointManager>::Instance()
@@ -72,7 +72,8 @@ void WaypointMovementGenerator<Creature>::LoadPath(Creature& creature)
     // Initialize the i_currentNode to point to the first node
     if (i_path->empty())
         { return; }
-    i_currentNode = i_path->begin()->first;
+    m_currentIndex = 0;
+    i_currentNode = (*i_path)[0].point;
     m_lastReachedWaypoint = 0;
 }
 
@@ -118,9 +119,7 @@ void WaypointMovementGenerator<Creature>::OnArrived(Creature& creature)
     creature.clearUnitState(UNIT_STAT_ROAMING_MOVE);
     m_isArrivalDone = true;
 
-    WaypointPath::const_iterator currPoint = i_path->find(i_currentNode);
-    MANGOS_ASSERT(currPoint != i_path->end());
-    WaypointNode const& node = currPoint->second;
+    WaypointNode const& node = (*i_path)[GetCurrentIndex()];
 
     if (node.script_id)
     {
@@ -186,10 +185,9 @@ void WaypointMovementGenerator<Creature>::StartMove(Creature& creature)
     if (!creature.IsAlive() || creature.hasUnitState(UNIT_STAT_NOT_MOVE))
         { return; }
 
-    WaypointPath::const_iterator currPoint = i_path->find(i_currentNode);
-    MANGOS_ASSERT(currPoint != i_path->end());
+    size_t currIndex = GetCurrentIndex();
 
-    if (WaypointBehavior* behavior = currPoint->second.behavior)
+    if (WaypointBehavior* behavior = (*i_path)[currIndex].behavior)
     {
         if (behavior->model2 != 0)
             { creature.SetDisplayId(behavior->model2); }
@@ -198,18 +196,19 @@ void WaypointMovementGenerator<Creature>::StartMove(Creature& creature)
 
     if (m_isArrivalDone)
     {
-        ++currPoint;
-        if (currPoint == i_path->end())
-            { currPoint = i_path->begin(); }
+        ++currIndex;
+        if (currIndex == i_path->size())
+            { currIndex = 0; }
 
-        i_currentNode = currPoint->first;
+        m_currentIndex = currIndex;
+        i_currentNode = (*i_path)[currIndex].point;
     }
 
     m_isArrivalDone = false;
 
     creature.addUnitState(UNIT_STAT_ROAMING_MOVE);
 
-    WaypointNode const& nextNode = currPoint->second;;
+    WaypointNode const& nextNode = (*i_path)[currIndex];
     Movement::MoveSplineInit init(creature);
     init.MoveTo(nextNode.x, nextNode.y, nextNode.z, true);
 
@@ -266,17 +265,29 @@ bool WaypointMovementGenerator<Creature>::GetResetPosition(Creature&, float& x,
     if (!i_path || i_path->empty())
         { return false; }
 
-    WaypointPath::const_iterator lastPoint = i_path->find(m_lastReachedWaypoint);
+    WaypointNode const* lastPoint = i_path->FindNode(m_lastReachedWaypoint);
     // Special case: Before the first waypoint is reached, m_lastReachedWaypoint is set to 0 (which may not be contained in i_path)
-    if (!m_lastReachedWaypoint && lastPoint == i_path->end())
+    if (!m_lastReachedWaypoint && !lastPoint)
         { return false; }
 
-    MANGOS_ASSERT(lastPoint != i_path->end());
+    MANGOS_ASSERT(lastPoint);
 
-    x = lastPoint->second.x; y = lastPoint->second.y; z = lastPoint->second.z;
+    x = lastPoint->x; y = lastPoint->y; z = lastPoint->z;
     return true;
 }
 
+size_t WaypointMovementGenerator<Creature>::GetCurrentIndex()
+{
+    // the remembered index only misses after the path was edited by commands
+    if (m_currentIndex >= i_path->size() || (*i_path)[m_currentIndex].point != i_currentNode)
+    {
+        m_currentIndex = i_path->FindIndex(i_currentNode);
+        MANGOS_ASSERT(m_currentIndex < i_path->size());
+    }
+
+    return m_currentIndex;
+}
+
 bool WaypointMovementGenerator<Creature>::Stopped(Creature& u)
 {
     return !i_nextMoveTime.Passed() || u.hasUnitState(UNIT_STAT_WAYPOINT_PAUSED);
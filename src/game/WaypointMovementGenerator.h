@@ -71,7 +71,7 @@ class MANGOS_DLL_SPEC WaypointMovementGenerator<Creature>
   public PathMovementBase<Creature, WaypointPath const*>
 {
     public:
-        WaypointMovementGenerator(Creature&) : i_nextMoveTime(0), m_isArrivalDone(false), m_lastReachedWaypoint(0) {}
+        WaypointMovementGenerator(Creature&) : i_nextMoveTime(0), m_isArrivalDone(false), m_lastReachedWaypoint(0), m_currentIndex(0) {}
         ~WaypointMovementGenerator() { i_path = NULL; }
         void Initialize(Creature& u);
         void Interrupt(Creature&);
@@ -102,9 +102,13 @@ class MANGOS_DLL_SPEC WaypointMovementGenerator<Creature>
 
         void StartMoveNow(Creature& creature);
 
+        // index of i_currentNode in the path
+        size_t GetCurrentIndex();
+
         ShortTimeTracker i_nextMoveTime;
         bool m_isArrivalDone;
         uint32 m_lastReachedWaypoint;
+        size_t m_currentIndex;
 };
 
 /** FlightPathMovementGenerator generates movement of the player for the paths
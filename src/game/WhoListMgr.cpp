@@ -0,0 +1,295 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "WhoListMgr.h"
+#include "Player.h"
+#include "GuildMgr.h"
+#include "World.h"
+#include "WorldSession.h"
+#include "WorldPacket.h"
+#include "DBCStores.h"
+#include "Policies/Singleton.h"
+#include "Util.h"
+
+#include <ace/Guard_T.h>
+
+#include <algorithm>
+
+INSTANTIATE_SINGLETON_1(WhoListMgr);
+
+/// 50 is maximum player count sent to client
+#define MAX_WHO_LIST_PLAYERS 49
+
+struct WhoListLevelLess
+{
+    template<class T>
+    bool operator()(T const& entry, uint32 level) const { return entry.level < level; }
+    template<class T>
+    bool operator()(T const& left, T const& right) const { return left.level < right.level; }
+};
+
+WhoListMgr::WhoListMgr() : m_changed(true), m_snapshot(NULL), m_snapshotTime(0)
+{
+}
+
+WhoListMgr::~WhoListMgr()
+{
+    delete m_snapshot;
+}
+
+void WhoListMgr::FillEntry(Entry& entry, Player* player)
+{
+    entry.guidLow = player->GetGUIDLow();
+    entry.name = player->GetName();
+    if (!Utf8toWStr(entry.name, entry.lowerName))
+        { entry.lowerName.clear(); }
+    wstrToLower(entry.lowerName);
+    entry.guildId = player->GetGuildId();
+    entry.level = player->getLevel();
+    entry.zoneId = player->GetZoneId();
+    entry.race = player->getRace();
+    entry.classId = player->getClass();
+    entry.team = player->GetTeam();
+    entry.security = player->GetSession()->GetSecurity();
+    entry.hidden = player->GetVisibility() == VISIBILITY_OFF;
+}
+
+void WhoListMgr::AddPlayer(Player* player)
+{
+    Entry entry;
+    FillEntry(entry, player);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_players[entry.guidLow] = entry;
+    m_changed = true;
+}
+
+void WhoListMgr::RemovePlayer(Player* player)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    if (m_players.erase(player->GetGUIDLow()))
+        { m_changed = true; }
+}
+
+void WhoListMgr::UpdateLevel(Player* player)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_players.find(player->GetGUIDLow());
+    if (itr == m_players.end() || itr->second.level == player->getLevel())
+        { return; }
+
+    itr->second.level = player->getLevel();
+    m_changed = true;
+}
+
+void WhoListMgr::UpdateZone(Player* player, uint32 zoneId)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_players.find(player->GetGUIDLow());
+    if (itr == m_players.end() || itr->second.zoneId == zoneId)
+        { return; }
+
+    itr->second.zoneId = zoneId;
+    m_changed = true;
+}
+
+void WhoListMgr::UpdateGuild(Player* player)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_players.find(player->GetGUIDLow());
+    if (itr == m_players.end() || itr->second.guildId == player->GetGuildId())
+        { return; }
+
+    itr->second.guildId = player->GetGuildId();
+    m_changed = true;
+}
+
+void WhoListMgr::UpdateVisibility(Player* player)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    EntryMap::iterator itr = m_players.find(player->GetGUIDLow());
+    bool hidden = player->GetVisibility() == VISIBILITY_OFF;
+    if (itr == m_players.end() || itr->second.hidden == hidden)
+        { return; }
+
+    itr->second.hidden = hidden;
+    m_changed = true;
+}
+
+void WhoListMgr::RefreshSnapshot()
+{
+    uint32 now = WorldTimer::getMSTime();
+    if (m_snapshot && WorldTimer::getMSTimeDiff(m_snapshotTime, now) < sWorld.getConfig(CONFIG_UINT32_WHO_LIST_REFRESH_TIME))
+        { return; }
+
+    Snapshot* snapshot = new Snapshot;
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+        if (m_snapshot && !m_changed)
+        {
+            delete snapshot;
+            m_snapshotTime = now;
+            return;
+        }
+
+        for (EntryMap::const_iterator itr = m_players.begin(); itr != m_players.end(); ++itr)
+        {
+            SnapshotEntry entry;
+            static_cast<Entry&>(entry) = itr->second;
+            snapshot->players[GetTeamBucket(entry.team)].push_back(entry);
+        }
+
+        snapshot->online = uint32(m_players.size());
+        m_changed = false;
+    }
+
+    for (uint32 team = 0; team < 2; ++team)
+    {
+        std::vector<SnapshotEntry>& players = snapshot->players[team];
+        std::stable_sort(players.begin(), players.end(), WhoListLevelLess());
+
+        for (uint32 i = 0; i < players.size(); ++i)
+        {
+            SnapshotEntry& entry = players[i];
+            if (entry.guildId)
+            {
+                entry.guildName = sGuildMgr.GetGuildNameById(entry.guildId);
+                if (!Utf8toWStr(entry.guildName, entry.lowerGuildName))
+                    { entry.lowerGuildName.clear(); }
+                wstrToLower(entry.lowerGuildName);
+            }
+
+            snapshot->zones[team][entry.zoneId].push_back(i);
+        }
+    }
+
+    delete m_snapshot;
+    m_snapshot = snapshot;
+    m_snapshotTime = now;
+}
+
+bool WhoListMgr::Matches(SnapshotEntry const& entry, Player* viewer, WhoListQuery const& query, LocaleConstant locale) const
+{
+    if (entry.level < query.levelMin || entry.level > query.levelMax)
+        { return false; }
+
+    if (!(query.classMask & (1 << entry.classId)) || !(query.raceMask & (1 << entry.race)))
+        { return false; }
+
+    AccountTypes security = viewer->GetSession()->GetSecurity();
+    if (security == SEC_PLAYER)
+    {
+        // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
+        if (entry.security > AccountTypes(sWorld.getConfig(CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST)))
+            { return false; }
+    }
+
+    // invisible GMs are visible for self and for GMs of the same or higher security
+    if (entry.hidden && entry.guidLow != viewer->GetGUIDLow() && (security == SEC_PLAYER || entry.security > security))
+        { return false; }
+
+    if (!query.playerName.empty() && entry.lowerName.find(query.playerName) == std::wstring::npos)
+        { return false; }
+
+    if (!query.guildName.empty() && entry.lowerGuildName.find(query.guildName) == std::wstring::npos)
+        { return false; }
+
+    if (query.strings.empty())
+        { return true; }
+
+    std::string areaName;
+    if (AreaTableEntry const* areaEntry = GetAreaEntryByAreaID(entry.zoneId))
+        { areaName = areaEntry->area_name[locale]; }
+
+    for (std::vector<std::wstring>::const_iterator itr = query.strings.begin(); itr != query.strings.end(); ++itr)
+    {
+        if (entry.lowerGuildName.find(*itr) != std::wstring::npos ||
+            entry.lowerName.find(*itr) != std::wstring::npos ||
+            Utf8FitTo(areaName, *itr))
+            { return true; }
+    }
+
+    return false;
+}
+
+void WhoListMgr::BuildWhoList(Player* viewer, WhoListQuery const& query, WorldPacket& data, uint32& listed, uint32& online)
+{
+    RefreshSnapshot();
+
+    listed = 0;
+    online = m_snapshot->online;
+
+    LocaleConstant locale = viewer->GetSession()->GetSessionDbcLocale();
+
+    // player can see member of other team only if CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST
+    bool bothTeams = viewer->GetSession()->GetSecurity() > SEC_PLAYER || sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_WHO_LIST);
+    uint32 firstTeam = bothTeams ? 0 : GetTeamBucket(viewer->GetTeam());
+    uint32 lastTeam = bothTeams ? 1 : firstTeam;
+
+    for (uint32 team = firstTeam; team <= lastTeam && listed < MAX_WHO_LIST_PLAYERS; ++team)
+    {
+        std::vector<SnapshotEntry> const& players = m_snapshot->players[team];
+
+        // the zone lists index the players by level too, so the level range has to be checked only
+        std::vector<uint32> candidates;
+        if (!query.zones.empty())
+        {
+            for (std::vector<uint32>::const_iterator zoneItr = query.zones.begin(); zoneItr != query.zones.end(); ++zoneItr)
+            {
+                ZoneIndex::const_iterator itr = m_snapshot->zones[team].find(*zoneItr);
+                if (itr != m_snapshot->zones[team].end())
+                    { candidates.insert(candidates.end(), itr->second.begin(), itr->second.end()); }
+            }
+        }
+
+        std::vector<SnapshotEntry>::const_iterator first = std::lower_bound(players.begin(), players.end(), query.levelMin, WhoListLevelLess());
+        uint32 count = query.zones.empty() ? uint32(players.end() - first) : uint32(candidates.size());
+
+        for (uint32 i = 0; i < count && listed < MAX_WHO_LIST_PLAYERS; ++i)
+        {
+            SnapshotEntry const& entry = query.zones.empty() ? *(first + i) : players[candidates[i]];
+
+            if (query.zones.empty() && entry.level > query.levelMax)
+                { break; }
+
+            if (!Matches(entry, viewer, query, locale))
+                { continue; }
+
+            data << entry.name;                             // player name
+            data << entry.guildName;                        // guild name
+            data << uint32(entry.level);                    // player level
+            data << uint32(entry.classId);                  // player class
+            data << uint32(entry.race);                     // player race
+            data << uint32(entry.zoneId);                   // player zone id
+            ++listed;
+        }
+    }
+}
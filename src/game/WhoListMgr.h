@@ -0,0 +1,135 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_WHOLISTMGR
+#define MANGOS_H_WHOLISTMGR
+
+#include "Common.h"
+#include "SharedDefines.h"
+#include "Policies/Singleton.h"
+#include "Utilities/UnorderedMapSet.h"
+
+#include <ace/Thread_Mutex.h>
+
+#include <string>
+#include <vector>
+
+class Player;
+class WorldPacket;
+
+/// The filters of CMSG_WHO, names and strings in lower case
+struct WhoListQuery
+{
+    uint32 levelMin;
+    uint32 levelMax;
+    uint32 raceMask;
+    uint32 classMask;
+    std::vector<uint32> zones;                              // empty for any zone
+    std::wstring playerName;
+    std::wstring guildName;
+    std::vector<std::wstring> strings;                      // any of them in the player, guild or zone name
+};
+
+/**
+ * The online players for the who list. The index is kept up to date at login, logout and at level,
+ * zone, guild and GM visibility changes, which may happen in the map threads. CMSG_WHO is answered
+ * from a snapshot of it with the guild names resolved and all names in lower case, bucketed by team
+ * and level and indexed by zone. The snapshot is rebuilt by the world thread on a request when the
+ * index changed and it is older than WhoList.RefreshTime, so a burst of requests costs one rebuild.
+ */
+class WhoListMgr
+{
+    public:
+        WhoListMgr();
+        ~WhoListMgr();
+
+        void AddPlayer(Player* player);
+        void RemovePlayer(Player* player);
+        void UpdateLevel(Player* player);
+        void UpdateZone(Player* player, uint32 zoneId);
+        void UpdateGuild(Player* player);
+        void UpdateVisibility(Player* player);
+
+        /**
+         * @brief adds the players matching the query to a SMSG_WHO packet, world thread only
+         *
+         * @param viewer
+         * @param query
+         * @param data
+         * @param listed players added to the packet, at most 49
+         * @param online all online players
+         */
+        void BuildWhoList(Player* viewer, WhoListQuery const& query, WorldPacket& data, uint32& listed, uint32& online);
+
+    private:
+        struct Entry
+        {
+            uint32 guidLow;
+            std::string name;
+            std::wstring lowerName;
+            uint32 guildId;
+            uint32 level;
+            uint32 zoneId;
+            uint8 race;
+            uint8 classId;
+            Team team;
+            AccountTypes security;
+            bool hidden;                                    // GM invisible
+        };
+
+        struct SnapshotEntry : public Entry
+        {
+            std::string guildName;
+            std::wstring lowerGuildName;
+        };
+
+        typedef UNORDERED_MAP<uint32, Entry> EntryMap;
+        typedef UNORDERED_MAP<uint32, std::vector<uint32> > ZoneIndex;
+
+        /// immutable once built, replaced as a whole
+        struct Snapshot
+        {
+            std::vector<SnapshotEntry> players[2];          // per team, by level
+            ZoneIndex zones[2];                             // per team, indexes into players by level
+            uint32 online;
+        };
+
+        static uint32 GetTeamBucket(Team team) { return team == ALLIANCE ? 0 : 1; }
+        static void FillEntry(Entry& entry, Player* player);
+
+        void RefreshSnapshot();
+        bool Matches(SnapshotEntry const& entry, Player* viewer, WhoListQuery const& query, LocaleConstant locale) const;
+
+        ACE_Thread_Mutex m_lock;
+        EntryMap m_players;                                 // guarded by m_lock
+        bool m_changed;                                     // guarded by m_lock
+
+        Snapshot* m_snapshot;
+        uint32 m_snapshotTime;
+};
+
+#define sWhoListMgr MaNGOS::Singleton<WhoListMgr>::Instance()
+
+#endif
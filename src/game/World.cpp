@@ -69,7 +69,16 @@
 #include "AuctionHouseBot/AuctionHouseBot.h"
 #include "CharacterDatabaseCleaner.h"
 #include "CreatureLinkingMgr.h"
+#include "NetworkStats.h"
+#include "Metrics.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "PacketLog.h"
+#include "PacketReplay.h"
+#include "SpellStats.h"
+#include "WorldSocketMgr.h"
 #include "LuaEngine.h"
+#include "StartupLoader.h"
 
 INSTANTIATE_SINGLETON_1(World);
 
@@ -89,6 +98,7 @@ float World::m_VisibleObjectGreyDistance      = 0;
 
 float  World::m_relocation_lower_limit_sq     = 10.f * 10.f;
 uint32 World::m_relocation_ai_notify_delay    = 1000u;
+uint32 World::m_visibility_incremental_updates = 8;
 
 /// World constructor
 World::World()
@@ -102,6 +112,10 @@ World::World()
     m_maxActiveSessionCount = 0;
     m_maxQueuedSessionCount = 0;
 
+    m_tickStartTime = 0;
+    m_lastTickTime = 0;
+    m_tickOverruns = 0;
+
     m_defaultDbcLocale = LOCALE_enUS;
     m_availableDbcLocaleMask = 0;
 
@@ -151,6 +165,7 @@ void World::CleanupsBeforeStop()
     KickAll();                                       // save and kick all players
     UpdateSessions(1);                               // real players unload required UpdateSessions call
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
+    sObjectMgr.WaitHonorMaintenance();               // the maintenance thread uses the character database
     Eluna::Uninitialize();
 }
 
@@ -214,6 +229,9 @@ World::AddSession_(WorldSession* s)
 
     // NOTE - Still there is race condition in WorldSession* being used in the Sockets
 
+    if (s->GetSessionDbLocaleIndex() >= 0)
+        { sObjectMgr.RequestLocales(); }
+
     ///- kick already loaded player with same account (if any) and remove session
     ///- if player is in loading and want to load again, return
     if (!RemoveSession(s->GetAccountId()))
@@ -403,6 +421,64 @@ Weather* World::AddWeather(uint32 zone_id)
     return w;
 }
 
+/// Metrics fed by the world thread
+struct WorldMetrics
+{
+    WorldMetrics()
+    {
+        static uint32 const tickTimeBounds[] = { 10, 25, 50, 100, 200, 500, 1000, 2000 };
+
+        tickTime = sMetrics.GetHistogram("world_tick_ms", "Duration of the world updates in ms", tickTimeBounds, countof(tickTimeBounds));
+        tickDiff = sMetrics.GetHistogram("world_diff_ms", "Time between the starts of the world updates in ms", tickTimeBounds, countof(tickTimeBounds));
+        sessions = sMetrics.GetGauge("world_sessions", "Active sessions");
+        queuedSessions = sMetrics.GetGauge("world_queued_sessions", "Sessions waiting in the login queue");
+        maps = sMetrics.GetGauge("world_maps", "Loaded maps and instances");
+        grids = sMetrics.GetGauge("world_grids", "Loaded grids of all maps");
+        mmapTiles = sMetrics.GetGauge("mmap_loaded_tiles", "Loaded navigation mesh tiles");
+        netQueuedPackets = sMetrics.GetGauge("net_queued_packets", "Packets waiting in the output queues of the sockets");
+        netQueuedBytes = sMetrics.GetGauge("net_queued_bytes", "Bytes waiting in the output queues of the sockets");
+        worldDbQueue = sMetrics.GetGauge("db_async_queue", "Requests queued for the database delay threads", "db", WorldDatabase.GetDatabaseName());
+        characterDbQueue = sMetrics.GetGauge("db_async_queue", "Requests queued for the database delay threads", "db", CharacterDatabase.GetDatabaseName());
+        loginDbQueue = sMetrics.GetGauge("db_async_queue", "Requests queued for the database delay threads", "db", LoginDatabase.GetDatabaseName());
+        processMemory = sMetrics.GetGauge("process_resident_bytes", "Resident memory of the process");
+
+        for (uint32 i = 0; i < MAX_MEMORY_TAG; ++i)
+        {
+            char const* tag = MemoryTracker::GetTagName(MemoryTag(i));
+            memoryLive[i] = sMetrics.GetGauge("memory_live_bytes", "Counted live memory by subsystem", "tag", tag);
+            memoryAllocated[i] = sMetrics.GetCounter("memory_allocated_bytes", "Counted allocated bytes by subsystem", "tag", tag);
+            memoryAllocations[i] = sMetrics.GetCounter("memory_allocations", "Counted allocations by subsystem", "tag", tag);
+            memoryPoolSlabs[i] = sMetrics.GetGauge("memory_pool_slab_bytes", "Slab memory of the object pools by subsystem", "tag", tag);
+            memoryPushed[i] = MemoryTagStats();
+        }
+    }
+
+    MetricHistogram* tickTime;
+    MetricHistogram* tickDiff;
+    MetricGauge* sessions;
+    MetricGauge* queuedSessions;
+    MetricGauge* maps;
+    MetricGauge* grids;
+    MetricGauge* mmapTiles;
+    MetricGauge* netQueuedPackets;
+    MetricGauge* netQueuedBytes;
+    MetricGauge* worldDbQueue;
+    MetricGauge* characterDbQueue;
+    MetricGauge* loginDbQueue;
+    MetricGauge* processMemory;
+    MetricGauge* memoryLive[MAX_MEMORY_TAG];
+    MetricCounter* memoryAllocated[MAX_MEMORY_TAG];
+    MetricCounter* memoryAllocations[MAX_MEMORY_TAG];
+    MetricGauge* memoryPoolSlabs[MAX_MEMORY_TAG];
+    MemoryTagStats memoryPushed[MAX_MEMORY_TAG];            // at the last sample, the counters get the growth since
+};
+
+static WorldMetrics& GetWorldMetrics()
+{
+    static WorldMetrics metrics;
+    return metrics;
+}
+
 /// Initialize config values
 void World::LoadConfigSettings(bool reload)
 {
@@ -491,6 +567,8 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_FLOAT_RATE_AUCTION_DEPOSIT, "Rate.Auction.Deposit", 1.0f);
     setConfig(CONFIG_FLOAT_RATE_AUCTION_CUT,     "Rate.Auction.Cut", 1.0f);
     setConfig(CONFIG_UINT32_AUCTION_DEPOSIT_MIN, "Auction.Deposit.Min", 0);
+    setConfig(CONFIG_UINT32_AUCTION_SEARCH_CACHE_TIME, "Auction.SearchCache.Time", 3000);
+    setConfig(CONFIG_UINT32_AUCTION_SEARCH_BUDGET, "Auction.SearchBudget", 100000);
     setConfig(CONFIG_FLOAT_RATE_HONOR, "Rate.Honor", 1.0f);
     setConfigPos(CONFIG_FLOAT_RATE_MINING_AMOUNT, "Rate.Mining.Amount", 1.0f);
     setConfigPos(CONFIG_FLOAT_RATE_MINING_NEXT,   "Rate.Mining.Next", 1.0f);
@@ -515,6 +593,7 @@ void World::LoadConfigSettings(bool reload)
 
     setConfigPos(CONFIG_FLOAT_CREATURE_FAMILY_ASSISTANCE_RADIUS,      "CreatureFamilyAssistanceRadius",     10.0f);
     setConfigPos(CONFIG_FLOAT_CREATURE_FAMILY_FLEE_ASSISTANCE_RADIUS, "CreatureFamilyFleeAssistanceRadius", 30.0f);
+    setConfigPos(CONFIG_FLOAT_CREATURE_IDLE_UPDATE_DISTANCE,          "CreatureIdleUpdate.Distance",        0.0f);
 
     ///- Read other configuration items from the config file
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
@@ -524,6 +603,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_INTERVAL_SAVE, "PlayerSave.Interval", 15 * MINUTE * IN_MILLISECONDS);
     setConfigMinMax(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE, "PlayerSave.Stats.MinLevel", 0, 0, MAX_LEVEL);
     setConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT, "PlayerSave.Stats.SaveOnlyOnLogout", true);
+    setConfig(CONFIG_UINT32_PLAYER_NAME_CACHE_SIZE, "PlayerNameCache.Size", 50000);
 
     setConfigMin(CONFIG_UINT32_INTERVAL_GRIDCLEAN, "GridCleanUpDelay", 5 * MINUTE * IN_MILLISECONDS, MIN_GRID_DELAY);
     if (reload)
@@ -533,6 +613,51 @@ void World::LoadConfigSettings(bool reload)
     if (reload)
         { sMapMgr.SetMapUpdateInterval(getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE)); }
 
+    if (configNoReload(reload, CONFIG_UINT32_MAPUPDATE_THREADS, "MapUpdate.Threads", 0))
+        { setConfigMinMax(CONFIG_UINT32_MAPUPDATE_THREADS, "MapUpdate.Threads", 0, 0, 64); }
+    if (configNoReload(reload, CONFIG_UINT32_MAPUPDATE_CONTINENT_REGION_SIZE, "MapUpdate.ContinentRegionSize", 0))
+        { setConfigMinMax(CONFIG_UINT32_MAPUPDATE_CONTINENT_REGION_SIZE, "MapUpdate.ContinentRegionSize", 0, 0, MAX_NUMBER_OF_GRIDS / 2); }
+    setConfig(CONFIG_UINT32_MAPUPDATE_PARALLEL_SEND_PLAYERS, "MapUpdate.ParallelSendPlayers", 100);
+    if (configNoReload(reload, CONFIG_UINT32_TERRAIN_PREFETCH_THREADS, "Terrain.PrefetchThreads", 1))
+        { setConfigMinMax(CONFIG_UINT32_TERRAIN_PREFETCH_THREADS, "Terrain.PrefetchThreads", 1, 0, 16); }
+    setConfig(CONFIG_UINT32_TERRAIN_PREFETCH_TIME, "Terrain.PrefetchTime", 10000);
+    setConfig(CONFIG_UINT32_TERRAIN_MEMORY_BUDGET, "Terrain.MemoryBudget", 0);
+    if (configNoReload(reload, CONFIG_UINT32_STARTUP_LOADER_THREADS, "StartupLoaderThreads", 1))
+        { setConfigMinMax(CONFIG_UINT32_STARTUP_LOADER_THREADS, "StartupLoaderThreads", 1, 1, 64); }
+    if (configNoReload(reload, CONFIG_BOOL_LAZY_LOAD_LOCALES, "LazyLoad.Locales", false))
+        { setConfig(CONFIG_BOOL_LAZY_LOAD_LOCALES, "LazyLoad.Locales", false); }
+    if (configNoReload(reload, CONFIG_FLOAT_SPATIAL_HASH_SEARCH_RADIUS, "SpatialHash.SearchRadius", 0.0f))
+        { setConfigMinMax(CONFIG_FLOAT_SPATIAL_HASH_SEARCH_RADIUS, "SpatialHash.SearchRadius", 0.0f, 0.0f, SIZE_OF_GRID_CELL); }
+    if (configNoReload(reload, CONFIG_UINT32_MAP_QUERY_CACHE_TIME, "Map.QueryCacheTime", 500))
+        { setConfigMinMax(CONFIG_UINT32_MAP_QUERY_CACHE_TIME, "Map.QueryCacheTime", 500, 0, 5000); }
+    setConfig(CONFIG_UINT32_MAP_SPAWNS_PER_UPDATE, "Map.SpawnsPerUpdate", 50);
+
+    setConfig(CONFIG_UINT32_TICK_BUDGET, "TickBudget", 50);
+    setConfig(CONFIG_UINT32_TICK_BUDGET_STAGE, "TickBudget.Stage", 20);
+    setConfig(CONFIG_UINT32_TICK_BUDGET_MAX_DEFERRALS, "TickBudget.MaxDeferrals", 20);
+    setConfig(CONFIG_UINT32_TICK_BUDGET_CLI_COMMANDS, "TickBudget.CliCommands", 10);
+
+    setConfig(CONFIG_BOOL_NETSTATS_ENABLE, "NetStats.Enable", false);
+    setConfigMin(CONFIG_UINT32_NETSTATS_FIELD_SAMPLE_RATE, "NetStats.FieldSampleRate", 16, 1);
+    setConfig(CONFIG_UINT32_NETSTATS_DUMP_INTERVAL, "NetStats.DumpInterval", 0);
+    if (reload)
+        { m_timers[WUPDATE_NETSTATS].SetInterval(getConfig(CONFIG_UINT32_NETSTATS_DUMP_INTERVAL) * IN_MILLISECONDS); }
+
+    sPacketLog.LoadConfig();
+
+    setConfig(CONFIG_BOOL_SPELLSTATS_ENABLE, "SpellStats.Enable", false);
+    setConfig(CONFIG_UINT32_SPELLSTATS_DUMP_INTERVAL, "SpellStats.DumpInterval", 0);
+    setConfig(CONFIG_BOOL_SCRIPTHOOKSTATS_ENABLE, "ScriptHookStats.Enable", false);
+    setConfig(CONFIG_BOOL_OPCODESTATS_ENABLE, "OpcodeStats.Enable", false);
+    setConfig(CONFIG_UINT32_OPCODESTATS_SESSION_BUDGET, "OpcodeStats.SessionBudget", 0);
+    setConfig(CONFIG_UINT32_OPCODESTATS_OUTLIER_TIME, "OpcodeStats.OutlierTime", 50000);
+
+    setConfig(CONFIG_BOOL_RATE_LIMIT_ENABLE, "RateLimit.Enable", true);
+    setConfig(CONFIG_UINT32_RATE_LIMIT_COST_BUDGET, "RateLimit.CostBudget", 60);
+    setConfig(CONFIG_INT32_RATE_LIMIT_POLICY, "RateLimit.Policy", -1);
+    if (reload)
+        { m_timers[WUPDATE_SPELLSTATS].SetInterval(getConfig(CONFIG_UINT32_SPELLSTATS_DUMP_INTERVAL) * IN_MILLISECONDS); }
+
     setConfig(CONFIG_UINT32_INTERVAL_CHANGEWEATHER, "ChangeWeatherInterval", 10 * MINUTE * IN_MILLISECONDS);
 
     if (configNoReload(reload, CONFIG_UINT32_PORT_WORLD, "WorldServerPort", DEFAULT_WORLDSERVER_PORT))
@@ -594,10 +719,16 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_BOOL_CAST_UNSTUCK, "CastUnstuck", true);
     setConfig(CONFIG_UINT32_MAX_SPELL_CASTS_IN_CHAIN, "MaxSpellCastsInChain", 20);
+    setConfigMinMax(CONFIG_UINT32_PERIODIC_AURA_BATCH_WINDOW, "PeriodicAura.BatchWindow", 0, 0, 1000);
     setConfig(CONFIG_UINT32_RABBIT_DAY, "RabbitDay", 0);
 
     setConfig(CONFIG_UINT32_INSTANCE_RESET_TIME_HOUR, "Instance.ResetTimeHour", 4);
     setConfig(CONFIG_UINT32_INSTANCE_UNLOAD_DELAY,    "Instance.UnloadDelay", 30 * MINUTE * IN_MILLISECONDS);
+    setConfig(CONFIG_UINT32_INSTANCE_HIBERNATE_DELAY, "Instance.HibernateDelay", 0);
+    setConfig(CONFIG_UINT32_INSTANCE_RESETS_PER_UPDATE, "Instance.ResetsPerUpdate", 20);
+    setConfig(CONFIG_UINT32_INSTANCE_UNLOADS_PER_UPDATE, "Instance.UnloadsPerUpdate", 4);
+    if (configNoReload(reload, CONFIG_UINT32_INSTANCE_ID_RESERVE_SIZE, "Instance.IdReserveSize", 0))
+        { setConfig(CONFIG_UINT32_INSTANCE_ID_RESERVE_SIZE, "Instance.IdReserveSize", 0); }
 
     setConfigMinMax(CONFIG_UINT32_MAX_PRIMARY_TRADE_SKILL, "MaxPrimaryTradeSkill", 2, 0, 10);
 
@@ -615,6 +746,7 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_UINT32_GM_LEVEL_IN_GM_LIST,  "GM.InGMList.Level",  SEC_ADMINISTRATOR);
     setConfig(CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST, "GM.InWhoList.Level", SEC_ADMINISTRATOR);
+    setConfig(CONFIG_UINT32_WHO_LIST_REFRESH_TIME, "WhoList.RefreshTime", 1000);
     setConfig(CONFIG_BOOL_GM_LOG_TRADE,           "GM.LogTrade", false);
 
     setConfigMinMax(CONFIG_UINT32_START_GM_LEVEL, "GM.StartLevel", 1, getConfig(CONFIG_UINT32_START_PLAYER_LEVEL), MAX_LEVEL);
@@ -671,10 +803,12 @@ void World::LoadConfigSettings(bool reload)
 
     setConfig(CONFIG_UINT32_CREATURE_FAMILY_ASSISTANCE_DELAY, "CreatureFamilyAssistanceDelay", 1500);
     setConfig(CONFIG_UINT32_CREATURE_FAMILY_FLEE_DELAY,       "CreatureFamilyFleeDelay",       7000);
+    setConfigMinMax(CONFIG_UINT32_CREATURE_IDLE_UPDATE_RATE,  "CreatureIdleUpdate.Rate", 4, 1, 20);
 
     setConfig(CONFIG_UINT32_WORLD_BOSS_LEVEL_DIFF, "WorldBossLevelDiff", 3);
 
     setConfigMinMax(CONFIG_INT32_QUEST_LOW_LEVEL_HIDE_DIFF, "Quests.LowLevelHideDiff", 4, -1, MAX_LEVEL);
+    Player::InvalidateAllQuestGiverStatus();                // the marks depend on the setting
     setConfigMinMax(CONFIG_INT32_QUEST_HIGH_LEVEL_HIDE_DIFF, "Quests.HighLevelHideDiff", 7, -1, MAX_LEVEL);
 
     setConfig(CONFIG_BOOL_QUEST_IGNORE_RAID, "Quests.IgnoreRaid", false);
@@ -714,6 +848,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_BATTLEGROUND_INVITATION_TYPE,              "Battleground.InvitationType", 0);
     setConfig(CONFIG_UINT32_BATTLEGROUND_PREMATURE_FINISH_TIMER,       "BattleGround.PrematureFinishTimer", 5 * MINUTE * IN_MILLISECONDS);
     setConfig(CONFIG_UINT32_BATTLEGROUND_PREMADE_GROUP_WAIT_FOR_MATCH, "BattleGround.PremadeGroupWaitForMatch", 0);
+    setConfigMinMax(CONFIG_UINT32_BATTLEGROUND_WARM_INSTANCES,         "BattleGround.WarmInstances", 0, 0, 4);
     setConfig(CONFIG_BOOL_OUTDOORPVP_SI_ENABLED,                       "OutdoorPvp.SIEnabled", true);
     setConfig(CONFIG_BOOL_OUTDOORPVP_EP_ENABLED,                       "OutdoorPvp.EPEnabled", true);
 
@@ -738,6 +873,17 @@ void World::LoadConfigSettings(bool reload)
 
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq  = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10), 2);
+    m_visibility_incremental_updates = sConfig.GetIntDefault("Visibility.IncrementalUpdates", 8);
+
+    setConfig(CONFIG_UINT32_VISIBILITY_DYNAMIC_UPDATE_TIME, "Visibility.Dynamic.UpdateTime", 0);
+    setConfig(CONFIG_UINT32_VISIBILITY_DYNAMIC_CROWD_SIZE,  "Visibility.Dynamic.CrowdSize", 0);
+    setConfigMinMax(CONFIG_FLOAT_VISIBILITY_DYNAMIC_MIN_SCALE, "Visibility.Dynamic.MinScale", 0.5f, 0.1f, 1.0f);
+
+    setConfig(CONFIG_UINT32_UPDATE_COALESCE_HEALTH, "UpdateCoalesce.Health", 0);
+    setConfig(CONFIG_UINT32_UPDATE_COALESCE_POWER,  "UpdateCoalesce.Power", 0);
+    setConfig(CONFIG_UINT32_UPDATE_COALESCE_RAID_STATS, "UpdateCoalesce.RaidStats", 0);
+    if (reload)
+        { m_timers[WUPDATE_GROUPSTATS].SetInterval(getConfig(CONFIG_UINT32_UPDATE_COALESCE_RAID_STATS)); }
 
     m_VisibleUnitGreyDistance = sConfig.GetFloatDefault("Visibility.Distance.Grey.Unit", 1);
     if (m_VisibleUnitGreyDistance >  MAX_VISIBILITY_DISTANCE)
@@ -798,6 +944,18 @@ void World::LoadConfigSettings(bool reload)
         m_MaxVisibleDistanceInFlight = MAX_VISIBILITY_DISTANCE - m_VisibleObjectGreyDistance;
     }
 
+    // regions of the same pass are one region apart, so that gap must be wider than the reach of two objects
+    if (uint32 regionSize = getConfig(CONFIG_UINT32_MAPUPDATE_CONTINENT_REGION_SIZE))
+    {
+        float reach = std::max(m_MaxVisibleDistanceOnContinents + m_VisibleUnitGreyDistance, m_MaxVisibleDistanceInFlight + m_VisibleObjectGreyDistance);
+        uint32 minRegionSize = std::max(uint32(2), uint32(2 * reach / SIZE_OF_GRIDS) + 1);
+        if (regionSize < minRegionSize)
+        {
+            sLog.outError("MapUpdate.ContinentRegionSize (%u) must be at least %u grids for the visibility distances, set to %u.", regionSize, minRegionSize, minRegionSize);
+            setConfig(CONFIG_UINT32_MAPUPDATE_CONTINENT_REGION_SIZE, minRegionSize);
+        }
+    }
+
     ///- Load the CharDelete related config options
     setConfigMinMax(CONFIG_UINT32_CHARDELETE_METHOD, "CharDelete.Method", 0, 0, 1);
     setConfigMinMax(CONFIG_UINT32_CHARDELETE_MIN_LEVEL, "CharDelete.MinLevel", 0, 0, getConfig(CONFIG_UINT32_MAX_PLAYER_LEVEL));
@@ -848,6 +1006,11 @@ void World::LoadConfigSettings(bool reload)
     std::string ignoreMapIds = sConfig.GetStringDefault("mmap.ignoreMapIds", "");
     MMAP::MMapFactory::preventPathfindingOnMaps(ignoreMapIds.c_str());
     sLog.outString("WORLD: mmap pathfinding %sabled", getConfig(CONFIG_BOOL_MMAP_ENABLED) ? "en" : "dis");
+    if (configNoReload(reload, CONFIG_UINT32_MMAP_PATHFIND_THREADS, "mmap.pathfindThreads", 0))
+        { setConfigMinMax(CONFIG_UINT32_MMAP_PATHFIND_THREADS, "mmap.pathfindThreads", 0, 0, 16); }
+    if (configNoReload(reload, CONFIG_UINT32_MMAP_QUERY_NODES, "mmap.queryNodes", MMAP_DEFAULT_QUERY_NODES))
+        { setConfigMinMax(CONFIG_UINT32_MMAP_QUERY_NODES, "mmap.queryNodes", MMAP_DEFAULT_QUERY_NODES, 512, 65535); }
+    MMAP::MMapFactory::createOrGetMMapManager()->SetQueryNodes(getConfig(CONFIG_UINT32_MMAP_QUERY_NODES));
 
     setConfig(CONFIG_BOOL_ELUNA_ENABLED, "Eluna.Enabled", true);
 }
@@ -867,6 +1030,9 @@ void World::SetInitialWorldSettings()
     ///- Initialize config settings
     LoadConfigSettings();
 
+    ///- The static world data loaded below doesn't depend on writes of this server, read it from the replicas if any
+    Database::ReplicaReadScope worldReplicaReads(WorldDatabase);
+
     ///- Check the existence of the map files for all races start areas.
     if (!MapManager::ExistMapAndVMap(0, -6240.32f, 331.033f) ||                     // Dwarf/ Gnome
         !MapManager::ExistMapAndVMap(0, -8949.95f, -132.493f) ||                // Human
@@ -944,35 +1110,20 @@ void World::SetInitialWorldSettings()
     sLog.outString("Loading GameObject models...");
     LoadGameObjectModelList();
 
-    sLog.outString("Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
-
-    sLog.outString("Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
-
-    sLog.outString("Loading Spell Facing Flags...");
-    sSpellMgr.LoadFacingCasterFlags();
-
-    sLog.outString("Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
-
-    sLog.outString("Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
-
-    sLog.outString("Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
-
-    sLog.outString("Loading Spell Bonus Data...");
-    sSpellMgr.LoadSpellBonuses();
-
-    sLog.outString("Loading Spell Proc Item Enchant...");
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
-
-    sLog.outString("Loading Spell Linked definitions...");
-    sSpellMgr.LoadSpellLinked();                            // must be after LoadSpellChains
-
-    sLog.outString("Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
+    {
+        StartupLoader loader("Spell data");
+        loader.AddStep("Spell Chain Data", &sSpellMgr, &SpellMgr::LoadSpellChains);
+        loader.AddStep("Spell Elixir types", &sSpellMgr, &SpellMgr::LoadSpellElixirs);
+        loader.AddStep("Spell Facing Flags", &sSpellMgr, &SpellMgr::LoadFacingCasterFlags);
+        loader.AddStep("Spell Learn Skills", &sSpellMgr, &SpellMgr::LoadSpellLearnSkills, "Spell Chain Data");
+        loader.AddStep("Spell Learn Spells", &sSpellMgr, &SpellMgr::LoadSpellLearnSpells, "Spell Chain Data");
+        loader.AddStep("Spell Proc Event conditions", &sSpellMgr, &SpellMgr::LoadSpellProcEvents, "Spell Chain Data");
+        loader.AddStep("Spell Bonus Data", &sSpellMgr, &SpellMgr::LoadSpellBonuses, "Spell Chain Data");
+        loader.AddStep("Spell Proc Item Enchant", &sSpellMgr, &SpellMgr::LoadSpellProcItemEnchant, "Spell Chain Data");
+        loader.AddStep("Spell Linked definitions", &sSpellMgr, &SpellMgr::LoadSpellLinked, "Spell Chain Data");
+        loader.AddStep("Aggro Spells Definitions", &sSpellMgr, &SpellMgr::LoadSpellThreats, "Spell Chain Data");
+        loader.Run(getConfig(CONFIG_UINT32_STARTUP_LOADER_THREADS));
+    }
 
     sLog.outString("Loading NPC Texts...");
     sObjectMgr.LoadGossipText();
@@ -1127,11 +1278,21 @@ void World::SetInitialWorldSettings()
     sLog.outString("Loading Player Corpses...");
     sObjectMgr.LoadCorpses();
 
-    sLog.outString("Loading Loot Tables...");
-    sLog.outString();
-    LoadLootTables();
-    sLog.outString(">>> Loot Tables loaded");
-    sLog.outString();
+    {
+        StartupLoader loader("Loot Tables");
+        loader.AddStep("creature loot", &LoadLootTemplates_Creature);
+        loader.AddStep("fishing loot", &LoadLootTemplates_Fishing);
+        loader.AddStep("gameobject loot", &LoadLootTemplates_Gameobject);
+        loader.AddStep("item loot", &LoadLootTemplates_Item);
+        loader.AddStep("mail loot", &LoadLootTemplates_Mail);
+        loader.AddStep("pickpocketing loot", &LoadLootTemplates_Pickpocketing);
+        loader.AddStep("skinning loot", &LoadLootTemplates_Skinning);
+        loader.AddStep("disenchant loot", &LoadLootTemplates_Disenchant);
+        // checks the references of all other loot tables
+        loader.AddStep("reference loot", &LoadLootTemplates_Reference,
+                       "creature loot, fishing loot, gameobject loot, item loot, mail loot, pickpocketing loot, skinning loot, disenchant loot");
+        loader.Run(getConfig(CONFIG_UINT32_STARTUP_LOADER_THREADS));
+    }
 
     sLog.outString("Loading Skill Fishing base level requirements...");
     sObjectMgr.LoadFishingBaseSkillLevel();
@@ -1160,16 +1321,16 @@ void World::SetInitialWorldSettings()
     sWaypointMgr.Load();
 
     ///- Loading localization data
-    sLog.outString("Loading Localization strings...");
-    sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
-    sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
-    sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
-    sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
-    sObjectMgr.LoadGossipTextLocales();                     // must be after LoadGossipText
-    sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
-    sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
-    sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
-    sLog.outString(">>> Localization strings loaded");
+    if (getConfig(CONFIG_BOOL_LAZY_LOAD_LOCALES))
+    {
+        sLog.outString("Localization strings are loaded at the first login of a localized client");
+        sObjectMgr.DeferLocales();
+    }
+    else
+    {
+        sLog.outString("Loading Localization strings...");
+        sObjectMgr.LoadLocales();
+    }
     sLog.outString();
 
     ///- Load dynamic data tables from the database
@@ -1280,13 +1441,10 @@ void World::SetInitialWorldSettings()
     // for AhBot
     m_timers[WUPDATE_AHBOT].SetInterval(20 * IN_MILLISECONDS); // every 20 sec
 
-    // to set mailtimer to return mails every day between 4 and 5 am
-    // mailtimer is increased when updating auctions
-    // one second is 1000 -(tested on win system)
-    mail_timer = uint32((((localtime(&m_gameTime)->tm_hour + 20) % 24) * HOUR * IN_MILLISECONDS) / m_timers[WUPDATE_AUCTIONS].GetInterval());
-    // 1440
-    mail_timer_expires = uint32((DAY * IN_MILLISECONDS) / (m_timers[WUPDATE_AUCTIONS].GetInterval()));
-    DEBUG_LOG("Mail timer set to: %u, mail return is called every %u minutes", mail_timer, mail_timer_expires);
+    m_timers[WUPDATE_NETSTATS].SetInterval(getConfig(CONFIG_UINT32_NETSTATS_DUMP_INTERVAL) * IN_MILLISECONDS);
+    m_timers[WUPDATE_SPELLSTATS].SetInterval(getConfig(CONFIG_UINT32_SPELLSTATS_DUMP_INTERVAL) * IN_MILLISECONDS);
+    m_timers[WUPDATE_GROUPSTATS].SetInterval(getConfig(CONFIG_UINT32_UPDATE_COALESCE_RAID_STATS));
+    m_timers[WUPDATE_METRICS].SetInterval(IN_MILLISECONDS);
 
     ///- Initialize static helper structures
     AIRegistry::Initialize();
@@ -1331,6 +1489,9 @@ void World::SetInitialWorldSettings()
 
     uint32 uStartInterval = WorldTimer::getMSTimeDiff(uStartTime, WorldTimer::getMSTime());
     sLog.outString("SERVER STARTUP TIME: %i minutes %i seconds", uStartInterval / 60000, (uStartInterval % 60000) / 1000);
+
+    ///- Load a capture to replay, see Replay.File
+    sPacketReplay.Initialize();
 }
 
 void World::DetectDBCLang()
@@ -1394,39 +1555,46 @@ void World::Update(uint32 diff)
     ///- Update the game time and check for shutdown time
     _UpdateGameTime();
 
-    ///-Update mass mailer tasks if any
-    sMassMailMgr.Update();
+    ///- End a tick profiler recording whose time is over
+    sTickProfiler.Update();
+    PROFILE_SCOPE("World::Update");
+
+    m_tickStartTime = WorldTimer::getMSTime();
+    uint32 stageStart;
 
     /// <ul><li> Handle auctions when the timer has passed
     if (m_timers[WUPDATE_AUCTIONS].Passed())
     {
+        PROFILE_SCOPE("World::UpdateAuctions");
+        stageStart = WorldTimer::getMSTime();
         m_timers[WUPDATE_AUCTIONS].Reset();
 
-        ///- Update mails (return old mails with item, or delete them)
-        //(tested... works on win)
-        if (++mail_timer > mail_timer_expires)
-        {
-            mail_timer = 0;
-            sObjectMgr.ReturnOrDeleteOldMails(true);
-        }
+        ///- Update mails (return old mails with item, or delete them), only the due mails of the expiry queue are read
+        sObjectMgr.ReturnOrDeleteOldMails(true);
 
         ///- Handle expired auctions
         sAuctionMgr.Update();
+        RecordUpdateStage(WUPDATE_STAGE_AUCTIONS, stageStart);
     }
 
-    /// <li> Handle AHBot operations
-    if (m_timers[WUPDATE_AHBOT].Passed())
-    {
-        sAuctionBot.Update();
-        m_timers[WUPDATE_AHBOT].Reset();
-    }
+    /// <li> Queue the packets of replayed sessions before their update
+    sPacketReplay.Update();
 
     /// <li> Handle session updates
-    UpdateSessions(diff);
+    {
+        PROFILE_SCOPE("World::UpdateSessions");
+        ThreadActivityScope activity("World::UpdateSessions", 0);
+        stageStart = WorldTimer::getMSTime();
+        UpdateSessions(diff);
+        RecordUpdateStage(WUPDATE_STAGE_SESSIONS, stageStart);
+    }
 
     /// <li> Handle weather updates when the timer has passed
     if (m_timers[WUPDATE_WEATHERS].Passed())
     {
+        PROFILE_SCOPE("World::UpdateWeathers");
+        stageStart = WorldTimer::getMSTime();
+
         ///- Send an update signal to Weather objects
         for (WeatherMap::iterator itr = m_weathers.begin(); itr != m_weathers.end();)
         {
@@ -1442,6 +1610,7 @@ void World::Update(uint32 diff)
         }
 
         m_timers[WUPDATE_WEATHERS].SetCurrent(0);
+        RecordUpdateStage(WUPDATE_STAGE_WEATHERS, stageStart);
     }
     /// <li> Update uptime table
     if (m_timers[WUPDATE_UPTIME].Passed())
@@ -1453,45 +1622,132 @@ void World::Update(uint32 diff)
         LoginDatabase.PExecute("UPDATE uptime SET uptime = %u, maxplayers = %u WHERE realmid = %u AND starttime = " UI64FMTD, tmpDiff, maxClientsNum, realmID, uint64(m_startTime));
     }
 
+    /// <li> Sample the gauges of the metrics exporter
+    if (m_timers[WUPDATE_METRICS].Passed())
+    {
+        m_timers[WUPDATE_METRICS].Reset();
+        UpdateMetrics();
+    }
+
+    /// <li> Append the traffic counters to netstats.csv
+    if (getConfig(CONFIG_UINT32_NETSTATS_DUMP_INTERVAL) && m_timers[WUPDATE_NETSTATS].Passed())
+    {
+        m_timers[WUPDATE_NETSTATS].Reset();
+        if (getConfig(CONFIG_BOOL_NETSTATS_ENABLE))
+            { sNetworkStats.DumpCSV(); }
+    }
+
+    /// <li> Append the spell cast costs to spellstats.csv
+    if (getConfig(CONFIG_UINT32_SPELLSTATS_DUMP_INTERVAL) && m_timers[WUPDATE_SPELLSTATS].Passed())
+    {
+        m_timers[WUPDATE_SPELLSTATS].Reset();
+        if (getConfig(CONFIG_BOOL_SPELLSTATS_ENABLE))
+            { sSpellStats.DumpCSV(); }
+    }
+
     /// <li> Handle all other objects
     ///- Update objects (maps, transport, creatures,...)
-    sMapMgr.Update(diff);
-    sBattleGroundMgr.Update(diff);
-    sOutdoorPvPMgr.Update(diff);
+    {
+        PROFILE_SCOPE("MapManager::Update");
+        ThreadActivityScope activity("MapManager::Update", 0);
+        stageStart = WorldTimer::getMSTime();
+        sMapMgr.Update(diff);
+        RecordUpdateStage(WUPDATE_STAGE_MAPS, stageStart);
+    }
+
+    {
+        PROFILE_SCOPE("BattleGroundMgr::Update");
+        stageStart = WorldTimer::getMSTime();
+        sBattleGroundMgr.Update(diff);
+        RecordUpdateStage(WUPDATE_STAGE_BATTLEGROUNDS, stageStart);
+    }
+
+    {
+        PROFILE_SCOPE("OutdoorPvPMgr::Update");
+        stageStart = WorldTimer::getMSTime();
+        sOutdoorPvPMgr.Update(diff);
+        RecordUpdateStage(WUPDATE_STAGE_OUTDOORPVP, stageStart);
+    }
+
+    ///- Send the stats changes of raid members queued by the map updates
+    if (m_timers[WUPDATE_GROUPSTATS].Passed())
+    {
+        m_timers[WUPDATE_GROUPSTATS].Reset();
+        sObjectMgr.SendGroupStatsUpdates();
+    }
 
     ///- Used by Eluna
     sEluna->OnWorldUpdate(diff);
 
+    ///- Deferrable work, kept behind the player facing updates so it can see what is left of the tick budget
+    ///- Update mass mailer tasks if any
+    if (CanRunDeferrableStage(WUPDATE_STAGE_MASSMAIL))
+    {
+        PROFILE_SCOPE("World::UpdateMassMail");
+        stageStart = WorldTimer::getMSTime();
+        sMassMailMgr.Update();
+        RecordUpdateStage(WUPDATE_STAGE_MASSMAIL, stageStart);
+    }
+
+    /// <li> Handle AHBot operations, planned every 20 sec and applied a few per tick
+    if ((m_timers[WUPDATE_AHBOT].Passed() || sAuctionBot.HasOperations()) && CanRunDeferrableStage(WUPDATE_STAGE_AHBOT))
+    {
+        PROFILE_SCOPE("World::UpdateAuctionBot");
+        stageStart = WorldTimer::getMSTime();
+        if (m_timers[WUPDATE_AHBOT].Passed())
+        {
+            sAuctionBot.Update();
+            m_timers[WUPDATE_AHBOT].Reset();
+        }
+        sAuctionBot.ApplyOperations();
+        RecordUpdateStage(WUPDATE_STAGE_AHBOT, stageStart);
+    }
+
     ///- Delete all characters which have been deleted X days before
-    if (m_timers[WUPDATE_DELETECHARS].Passed())
+    if (m_timers[WUPDATE_DELETECHARS].Passed() && CanRunDeferrableStage(WUPDATE_STAGE_DELETECHARS))
     {
+        PROFILE_SCOPE("World::DeleteOldCharacters");
+        stageStart = WorldTimer::getMSTime();
         m_timers[WUPDATE_DELETECHARS].Reset();
         Player::DeleteOldCharacters();
+        RecordUpdateStage(WUPDATE_STAGE_DELETECHARS, stageStart);
     }
 
     // execute callbacks from sql queries that were queued recently
-    UpdateResultQueue();
+    {
+        PROFILE_SCOPE("World::UpdateResultQueue");
+        UpdateResultQueue();
+    }
 
     ///- Erase corpses once every 20 minutes
-    if (m_timers[WUPDATE_CORPSES].Passed())
+    if (m_timers[WUPDATE_CORPSES].Passed() && CanRunDeferrableStage(WUPDATE_STAGE_CORPSES))
     {
+        PROFILE_SCOPE("World::RemoveOldCorpses");
+        stageStart = WorldTimer::getMSTime();
         m_timers[WUPDATE_CORPSES].Reset();
 
         sObjectAccessor.RemoveOldCorpses();
+        RecordUpdateStage(WUPDATE_STAGE_CORPSES, stageStart);
     }
 
     ///- Process Game events when necessary
     if (m_timers[WUPDATE_EVENTS].Passed())
     {
+        PROFILE_SCOPE("World::UpdateGameEvents");
+        stageStart = WorldTimer::getMSTime();
         m_timers[WUPDATE_EVENTS].Reset();                   // to give time for Update() to be processed
         uint32 nextGameEvent = sGameEventMgr.Update();
         m_timers[WUPDATE_EVENTS].SetInterval(nextGameEvent);
         m_timers[WUPDATE_EVENTS].Reset();
+        RecordUpdateStage(WUPDATE_STAGE_EVENTS, stageStart);
     }
 
     /// </ul>
     ///- Move all creatures with "delayed move" and remove and delete all objects with "delayed remove"
-    sMapMgr.RemoveAllObjectsInRemoveList();
+    {
+        PROFILE_SCOPE("MapManager::RemoveAllObjectsInRemoveList");
+        sMapMgr.RemoveAllObjectsInRemoveList();
+    }
 
     // update the instance reset times
     sMapPersistentStateMgr.Update();
@@ -1499,20 +1755,121 @@ void World::Update(uint32 diff)
     if (m_MaintenanceTimeChecker < diff)
     {
         if (GetDateToday() >= m_NextMaintenanceDate)
-        {
-            ServerMaintenanceStart();
-            sObjectMgr.LoadStandingList();
-        }
+            { ServerMaintenanceStart(); }
         m_MaintenanceTimeChecker = 600000; // check 10 minutes
     }
     else
         { m_MaintenanceTimeChecker -= diff; }
 
+    // new standings of the honor maintenance thread
+    if (sObjectMgr.FinishHonorMaintenance())
+        { ServerMaintenanceFinish(); }
+
     // And last, but not least handle the issued cli commands
     ProcessCliCommands();
 
     // cleanup unused GridMap objects as well as VMaps
     sTerrainMgr.Update(diff);
+
+    m_lastTickTime = WorldTimer::getMSTimeDiff(m_tickStartTime, WorldTimer::getMSTime());
+    if (getConfig(CONFIG_UINT32_TICK_BUDGET) && m_lastTickTime > getConfig(CONFIG_UINT32_TICK_BUDGET))
+        { ++m_tickOverruns; }
+
+    WorldMetrics& metrics = GetWorldMetrics();
+    metrics.tickTime->Add(m_lastTickTime);
+    metrics.tickDiff->Add(diff);
+}
+
+void World::UpdateMetrics()
+{
+    WorldMetrics& metrics = GetWorldMetrics();
+
+    metrics.sessions->Set(GetActiveSessionCount());
+    metrics.queuedSessions->Set(GetQueuedSessionCount());
+    metrics.maps->Set(long(sMapMgr.Maps().size()));
+    metrics.grids->Set(sMapMgr.GetLoadedGridCount());
+    metrics.mmapTiles->Set(MMAP::MMapFactory::createOrGetMMapManager()->getLoadedTilesCount());
+    metrics.netQueuedPackets->Set(sNetworkStats.GetQueuedPackets());
+    metrics.netQueuedBytes->Set(sNetworkStats.GetQueuedBytes());
+    metrics.worldDbQueue->Set(WorldDatabase.GetAsyncQueueSize());
+    metrics.characterDbQueue->Set(CharacterDatabase.GetAsyncQueueSize());
+    metrics.loginDbQueue->Set(LoginDatabase.GetAsyncQueueSize());
+    metrics.processMemory->Set(long(MemoryTracker::GetProcessMemory()));
+
+    for (uint32 i = 0; i < MAX_MEMORY_TAG; ++i)
+    {
+        MemoryTagStats stats;
+        MemoryTracker::GetStats(MemoryTag(i), stats);
+
+        metrics.memoryLive[i]->Set(long(stats.liveBytes));
+        metrics.memoryAllocated[i]->Add(long(stats.allocatedBytes - metrics.memoryPushed[i].allocatedBytes));
+        metrics.memoryAllocations[i]->Add(long(stats.allocations - metrics.memoryPushed[i].allocations));
+        metrics.memoryPushed[i] = stats;
+        metrics.memoryPoolSlabs[i]->Set(long(MemoryPool::GetSlabBytes(MemoryTag(i))));
+    }
+}
+
+char const* World::GetUpdateStageName(WorldUpdateStage stage)
+{
+    switch (stage)
+    {
+        case WUPDATE_STAGE_AUCTIONS:      return "auctions";
+        case WUPDATE_STAGE_SESSIONS:      return "sessions";
+        case WUPDATE_STAGE_WEATHERS:      return "weathers";
+        case WUPDATE_STAGE_MAPS:          return "maps";
+        case WUPDATE_STAGE_BATTLEGROUNDS: return "battlegrounds";
+        case WUPDATE_STAGE_OUTDOORPVP:    return "outdoorpvp";
+        case WUPDATE_STAGE_EVENTS:        return "game events";
+        case WUPDATE_STAGE_MASSMAIL:      return "mass mail";
+        case WUPDATE_STAGE_AHBOT:         return "ahbot";
+        case WUPDATE_STAGE_DELETECHARS:   return "delete old chars";
+        case WUPDATE_STAGE_CORPSES:       return "old corpses";
+        default:                          return "unknown";
+    }
+}
+
+/// Postpone deferrable work while the current tick is over budget, at most TickBudget.MaxDeferrals ticks in a row
+bool World::CanRunDeferrableStage(WorldUpdateStage stage)
+{
+    WorldUpdateStageStats& stats = m_updateStageStats[stage];
+
+    uint32 tickBudget = getConfig(CONFIG_UINT32_TICK_BUDGET);
+    if (!tickBudget || stats.deferredTicks >= getConfig(CONFIG_UINT32_TICK_BUDGET_MAX_DEFERRALS))
+    {
+        stats.deferredTicks = 0;
+        return true;
+    }
+
+    // expect the stage to take as long as last time
+    uint32 tickTime = WorldTimer::getMSTimeDiff(m_tickStartTime, WorldTimer::getMSTime());
+    if (tickTime + stats.lastTime <= tickBudget)
+    {
+        stats.deferredTicks = 0;
+        return true;
+    }
+
+    ++stats.deferredTicks;
+    ++stats.deferrals;
+    return false;
+}
+
+void World::RecordUpdateStage(WorldUpdateStage stage, uint32 startTime)
+{
+    WorldUpdateStageStats& stats = m_updateStageStats[stage];
+
+    uint32 time = WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime());
+    stats.lastTime = time;
+    if (time > stats.maxTime)
+        { stats.maxTime = time; }
+    stats.totalTime += time;
+    ++stats.calls;
+
+    uint32 stageBudget = getConfig(CONFIG_UINT32_TICK_BUDGET_STAGE);
+    if (stageBudget && time > stageBudget)
+    {
+        ++stats.overruns;
+        DEBUG_LOG("World::Update: %s took %u ms, budget is %u ms", GetUpdateStageName(stage), time, stageBudget);
+    }
 }
 
 namespace MaNGOS
@@ -1566,14 +1923,28 @@ void World::SendWorldText(int32 string_id, ...)
     va_list ap;
     va_start(ap, string_id);
 
-    MaNGOS::WorldWorldTextBuilder wt_builder(string_id, &ap);
-    MaNGOS::LocalizedPacketListDo<MaNGOS::WorldWorldTextBuilder> wt_do(wt_builder);
+    // the text is built once per locale and every packet broadcast by the network threads
+    typedef std::map<int32, std::vector<WorldSocket*> > LocaleSockets;
+    LocaleSockets localeSockets;
     for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
     {
         if (!itr->second || !itr->second->GetPlayer() || !itr->second->GetPlayer()->IsInWorld())
             { continue; }
 
-        wt_do(itr->second->GetPlayer());
+        itr->second->AddBroadcastTarget(localeSockets[itr->second->GetSessionDbLocaleIndex()]);
+    }
+
+    MaNGOS::WorldWorldTextBuilder wt_builder(string_id, &ap);
+    for (LocaleSockets::const_iterator itr = localeSockets.begin(); itr != localeSockets.end(); ++itr)
+    {
+        MaNGOS::WorldWorldTextBuilder::WorldPacketList data_list;
+        wt_builder(data_list, itr->first);
+
+        std::vector<WorldPacket const*> packets(data_list.begin(), data_list.end());
+        sWorldSocketMgr->BroadcastPackets(packets, itr->second);
+
+        for (size_t i = 0; i < data_list.size(); ++i)
+            { delete data_list[i]; }
     }
 
     va_end(ap);
@@ -1582,15 +1953,19 @@ void World::SendWorldText(int32 string_id, ...)
 /// Sends a packet to all players with optional team and instance restrictions
 void World::SendGlobalMessage(WorldPacket* packet)
 {
+    std::vector<WorldSocket*> sockets;
     for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
     {
         if (itr->second &&
             itr->second->GetPlayer() &&
             itr->second->GetPlayer()->IsInWorld())
         {
-            itr->second->SendPacket(packet);
+            itr->second->AddBroadcastTarget(sockets);
         }
     }
+
+    // a single copy of the packet is shared by the network threads instead of one per session
+    sWorldSocketMgr->BroadcastPacket(*packet, sockets);
 }
 
 /// Sends a server message to the specified or all players
@@ -1612,6 +1987,8 @@ void World::SendZoneUnderAttackMessage(uint32 zoneId, Team team)
     WorldPacket data(SMSG_ZONE_UNDER_ATTACK, 4);
     data << uint32(zoneId);
 
+    std::vector<WorldSocket*> sockets;
+
     for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
     {
         if (itr->second &&
@@ -1620,9 +1997,11 @@ void World::SendZoneUnderAttackMessage(uint32 zoneId, Team team)
             itr->second->GetPlayer()->GetTeam() == team &&
             !itr->second->GetPlayer()->GetMap()->Instanceable())
         {
-            itr->second->SendPacket(&data);
+            itr->second->AddBroadcastTarget(sockets);
         }
     }
+
+    sWorldSocketMgr->BroadcastPacket(data, sockets);
 }
 
 /// Sends a world defense message to all players not in an instance
@@ -1881,17 +2260,23 @@ void World::ServerMaintenanceStart()
     if (m_NextMaintenanceDate <= GetDateToday())            // avoid loop in manually case, maybe useless
         { m_NextMaintenanceDate += 7; }
 
-    // flushing rank points list ( standing must be reloaded after server maintenance )
-    sObjectMgr.FlushRankPoints(LastWeekEnd);
-
-    // save and update all online players
-    for (SessionMap::iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
-        if (itr->second->GetPlayer() && itr->second->GetPlayer()->IsInWorld())
-            { itr->second->GetPlayer()->SaveToDB(); }
+    // flushing rank points list on the maintenance thread ( standing is reloaded by ServerMaintenanceFinish )
+    sObjectMgr.StartHonorMaintenance(LastWeekEnd);
 
     CharacterDatabase.PExecute("UPDATE saved_variables SET NextMaintenanceDate = '"UI64FMTD"'", uint64(m_NextMaintenanceDate));
 }
 
+void World::ServerMaintenanceFinish()
+{
+    // update the honor fields of all online players from the new standings, the flush wrote the database already
+    for (SessionMap::iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+    {
+        Player* player = itr->second->GetPlayer();
+        if (player && player->IsInWorld())
+            { player->UpdateHonor(); }
+    }
+}
+
 void World::InitServerMaintenanceCheck()
 {
     QueryResult* result = CharacterDatabase.Query("SELECT NextMaintenanceDate FROM saved_variables");
@@ -1917,12 +2302,17 @@ void World::InitServerMaintenanceCheck()
 // This handles the issued and queued CLI/RA commands
 void World::ProcessCliCommands()
 {
+    // commands over the budget stay queued for the next tick, so a flood of RA/SOAP commands can't stall the tick
+    uint32 budget = getConfig(CONFIG_UINT32_TICK_BUDGET_CLI_COMMANDS);
+    uint32 startTime = WorldTimer::getMSTime();
+
     CliCommandHolder::Print* zprint = NULL;
     void* callbackArg = NULL;
     CliCommandHolder* command;
     while (cliCmdQueue.next(command))
     {
         DEBUG_LOG("CLI command under processing...");
+        uint32 commandStart = WorldTimer::getMSTime();
         zprint = command->m_print;
         callbackArg = command->m_callbackArg;
         CliHandler handler(command->m_cliAccountId, command->m_cliAccessLevel, callbackArg, zprint);
@@ -1931,7 +2321,15 @@ void World::ProcessCliCommands()
         if (command->m_commandFinished)
             { command->m_commandFinished(callbackArg, !handler.HasSentErrorMessage()); }
 
+        uint32 commandTime = WorldTimer::getMSTimeDiff(commandStart, WorldTimer::getMSTime());
+        if (budget && commandTime > budget)
+            { sLog.outString("CLI command '%s' of account %u took %u ms", command->m_command, command->m_cliAccountId, commandTime); }
+
         delete command;
+
+        // at least one command per tick
+        if (budget && WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()) >= budget)
+            { break; }
     }
 }
 
@@ -31,6 +31,7 @@
 
 #include "Common.h"
 #include "Timer.h"
+#include "MPSCQueue.h"
 #include "Policies/Singleton.h"
 #include "SharedDefines.h"
 
@@ -80,7 +81,43 @@ enum WorldTimers
     WUPDATE_EVENTS      = 4,
     WUPDATE_DELETECHARS = 5,
     WUPDATE_AHBOT       = 6,
-    WUPDATE_COUNT       = 7
+    WUPDATE_NETSTATS    = 7,
+    WUPDATE_SPELLSTATS  = 8,
+    WUPDATE_GROUPSTATS  = 9,
+    WUPDATE_METRICS     = 10,
+    WUPDATE_COUNT       = 11
+};
+
+/// Measured parts of World::Update
+enum WorldUpdateStage
+{
+    WUPDATE_STAGE_AUCTIONS      = 0,
+    WUPDATE_STAGE_SESSIONS      = 1,
+    WUPDATE_STAGE_WEATHERS      = 2,
+    WUPDATE_STAGE_MAPS          = 3,
+    WUPDATE_STAGE_BATTLEGROUNDS = 4,
+    WUPDATE_STAGE_OUTDOORPVP    = 5,
+    WUPDATE_STAGE_EVENTS        = 6,
+    // deferrable stages, postponed to a later tick while the tick budget is exceeded
+    WUPDATE_STAGE_MASSMAIL      = 7,
+    WUPDATE_STAGE_AHBOT         = 8,
+    WUPDATE_STAGE_DELETECHARS   = 9,
+    WUPDATE_STAGE_CORPSES       = 10,
+    WUPDATE_STAGE_COUNT         = 11
+};
+
+/// Timing of one WorldUpdateStage
+struct WorldUpdateStageStats
+{
+    WorldUpdateStageStats() : lastTime(0), maxTime(0), totalTime(0), calls(0), overruns(0), deferrals(0), deferredTicks(0) {}
+
+    uint32 lastTime;                                        // in ms
+    uint32 maxTime;
+    uint64 totalTime;
+    uint32 calls;
+    uint32 overruns;                                        // calls taking longer than the stage budget
+    uint32 deferrals;                                       // ticks the stage was postponed in
+    uint32 deferredTicks;                                   // postponed ticks in a row, reset when the stage runs
 };
 
 /// Configuration elements
@@ -90,6 +127,27 @@ enum eConfigUInt32Values
     CONFIG_UINT32_INTERVAL_SAVE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
+    CONFIG_UINT32_MAPUPDATE_THREADS,
+    CONFIG_UINT32_MAPUPDATE_CONTINENT_REGION_SIZE,
+    CONFIG_UINT32_MAPUPDATE_PARALLEL_SEND_PLAYERS,
+    CONFIG_UINT32_TERRAIN_PREFETCH_THREADS,
+    CONFIG_UINT32_TERRAIN_PREFETCH_TIME,
+    CONFIG_UINT32_TERRAIN_MEMORY_BUDGET,
+    CONFIG_UINT32_MAP_QUERY_CACHE_TIME,
+    CONFIG_UINT32_MAP_SPAWNS_PER_UPDATE,
+    CONFIG_UINT32_MMAP_PATHFIND_THREADS,
+    CONFIG_UINT32_MMAP_QUERY_NODES,
+    CONFIG_UINT32_STARTUP_LOADER_THREADS,
+    CONFIG_UINT32_TICK_BUDGET,
+    CONFIG_UINT32_TICK_BUDGET_STAGE,
+    CONFIG_UINT32_TICK_BUDGET_MAX_DEFERRALS,
+    CONFIG_UINT32_TICK_BUDGET_CLI_COMMANDS,
+    CONFIG_UINT32_NETSTATS_FIELD_SAMPLE_RATE,
+    CONFIG_UINT32_NETSTATS_DUMP_INTERVAL,
+    CONFIG_UINT32_SPELLSTATS_DUMP_INTERVAL,
+    CONFIG_UINT32_OPCODESTATS_SESSION_BUDGET,
+    CONFIG_UINT32_OPCODESTATS_OUTLIER_TIME,
+    CONFIG_UINT32_RATE_LIMIT_COST_BUDGET,
     CONFIG_UINT32_INTERVAL_CHANGEWEATHER,
     CONFIG_UINT32_PORT_WORLD,
     CONFIG_UINT32_GAME_TYPE,
@@ -112,7 +170,12 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MIN_HONOR_KILLS,
     CONFIG_UINT32_INSTANCE_RESET_TIME_HOUR,
     CONFIG_UINT32_INSTANCE_UNLOAD_DELAY,
+    CONFIG_UINT32_INSTANCE_HIBERNATE_DELAY,
+    CONFIG_UINT32_INSTANCE_RESETS_PER_UPDATE,
+    CONFIG_UINT32_INSTANCE_UNLOADS_PER_UPDATE,
+    CONFIG_UINT32_INSTANCE_ID_RESERVE_SIZE,
     CONFIG_UINT32_MAX_SPELL_CASTS_IN_CHAIN,
+    CONFIG_UINT32_PERIODIC_AURA_BATCH_WINDOW,
     CONFIG_UINT32_RABBIT_DAY,
     CONFIG_UINT32_MAX_PRIMARY_TRADE_SKILL,
     CONFIG_UINT32_TRADE_SKILL_GMIGNORE_MAX_PRIMARY_COUNT,
@@ -126,6 +189,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_GM_WISPERING_TO,
     CONFIG_UINT32_GM_LEVEL_IN_GM_LIST,
     CONFIG_UINT32_GM_LEVEL_IN_WHO_LIST,
+    CONFIG_UINT32_WHO_LIST_REFRESH_TIME,
     CONFIG_UINT32_START_GM_LEVEL,
     CONFIG_UINT32_GM_INVISIBLE_AURA,
     CONFIG_UINT32_GROUP_VISIBILITY,
@@ -133,6 +197,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK,
     CONFIG_UINT32_UPTIME_UPDATE,
     CONFIG_UINT32_AUCTION_DEPOSIT_MIN,
+    CONFIG_UINT32_AUCTION_SEARCH_CACHE_TIME,
+    CONFIG_UINT32_AUCTION_SEARCH_BUDGET,
     CONFIG_UINT32_SKILL_CHANCE_ORANGE,
     CONFIG_UINT32_SKILL_CHANCE_YELLOW,
     CONFIG_UINT32_SKILL_CHANCE_GREEN,
@@ -149,6 +215,12 @@ enum eConfigUInt32Values
     CONFIG_UINT32_CHATFLOOD_MUTE_TIME,
     CONFIG_UINT32_CREATURE_FAMILY_ASSISTANCE_DELAY,
     CONFIG_UINT32_CREATURE_FAMILY_FLEE_DELAY,
+    CONFIG_UINT32_CREATURE_IDLE_UPDATE_RATE,
+    CONFIG_UINT32_VISIBILITY_DYNAMIC_UPDATE_TIME,
+    CONFIG_UINT32_VISIBILITY_DYNAMIC_CROWD_SIZE,
+    CONFIG_UINT32_UPDATE_COALESCE_HEALTH,
+    CONFIG_UINT32_UPDATE_COALESCE_POWER,
+    CONFIG_UINT32_UPDATE_COALESCE_RAID_STATS,
     CONFIG_UINT32_WORLD_BOSS_LEVEL_DIFF,
     CONFIG_UINT32_CHAT_STRICT_LINK_CHECKING_SEVERITY,
     CONFIG_UINT32_CHAT_STRICT_LINK_CHECKING_KICK,
@@ -162,6 +234,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_BATTLEGROUND_PREMATURE_FINISH_TIMER,
     CONFIG_UINT32_BATTLEGROUND_PREMADE_GROUP_WAIT_FOR_MATCH,
     CONFIG_UINT32_BATTLEGROUND_QUEUE_ANNOUNCER_JOIN,
+    CONFIG_UINT32_BATTLEGROUND_WARM_INSTANCES,
     CONFIG_UINT32_GUILD_EVENT_LOG_COUNT,
     CONFIG_UINT32_TIMERBAR_FATIGUE_GMLEVEL,
     CONFIG_UINT32_TIMERBAR_FATIGUE_MAX,
@@ -170,6 +243,7 @@ enum eConfigUInt32Values
     CONFIG_UINT32_TIMERBAR_FIRE_GMLEVEL,
     CONFIG_UINT32_TIMERBAR_FIRE_MAX,
     CONFIG_UINT32_MIN_LEVEL_STAT_SAVE,
+    CONFIG_UINT32_PLAYER_NAME_CACHE_SIZE,
     CONFIG_UINT32_MAINTENANCE_DAY,
     CONFIG_UINT32_CHARDELETE_KEEP_DAYS,
     CONFIG_UINT32_CHARDELETE_METHOD,
@@ -187,6 +261,7 @@ enum eConfigInt32Values
     CONFIG_INT32_DEATH_SICKNESS_LEVEL = 0,
     CONFIG_INT32_QUEST_LOW_LEVEL_HIDE_DIFF,
     CONFIG_INT32_QUEST_HIGH_LEVEL_HIDE_DIFF,
+    CONFIG_INT32_RATE_LIMIT_POLICY,
     CONFIG_INT32_VALUE_COUNT
 };
 
@@ -258,6 +333,9 @@ enum eConfigFloatValues
     CONFIG_FLOAT_LISTEN_RANGE_TEXTEMOTE,
     CONFIG_FLOAT_CREATURE_FAMILY_FLEE_ASSISTANCE_RADIUS,
     CONFIG_FLOAT_CREATURE_FAMILY_ASSISTANCE_RADIUS,
+    CONFIG_FLOAT_CREATURE_IDLE_UPDATE_DISTANCE,
+    CONFIG_FLOAT_VISIBILITY_DYNAMIC_MIN_SCALE,
+    CONFIG_FLOAT_SPATIAL_HASH_SEARCH_RADIUS,
     CONFIG_FLOAT_GROUP_XP_DISTANCE,
     CONFIG_FLOAT_THREAT_RADIUS,
     CONFIG_FLOAT_GHOST_RUN_SPEED_WORLD,
@@ -311,12 +389,18 @@ enum eConfigBoolValues
     CONFIG_BOOL_OUTDOORPVP_EP_ENABLED,
     CONFIG_BOOL_KICK_PLAYER_ON_BAD_PACKET,
     CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT,
+    CONFIG_BOOL_NETSTATS_ENABLE,
+    CONFIG_BOOL_SPELLSTATS_ENABLE,
+    CONFIG_BOOL_SCRIPTHOOKSTATS_ENABLE,
+    CONFIG_BOOL_OPCODESTATS_ENABLE,
+    CONFIG_BOOL_RATE_LIMIT_ENABLE,
     CONFIG_BOOL_CLEAN_CHARACTER_DB,
     CONFIG_BOOL_VMAP_INDOOR_CHECK,
     CONFIG_BOOL_PET_UNSUMMON_AT_MOUNT,
     CONFIG_BOOL_MMAP_ENABLED,
     CONFIG_BOOL_ELUNA_ENABLED,
     CONFIG_BOOL_PLAYER_COMMANDS,
+    CONFIG_BOOL_LAZY_LOAD_LOCALES,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -541,9 +625,11 @@ class World
 
         static float GetRelocationLowerLimitSq()            { return m_relocation_lower_limit_sq; }
         static uint32 GetRelocationAINotifyDelay()          { return m_relocation_ai_notify_delay; }
+        static uint32 GetVisibilityIncrementalUpdates()     { return m_visibility_incremental_updates; }
 
         void InitServerMaintenanceCheck();
         void ServerMaintenanceStart();
+        void ServerMaintenanceFinish();
 
         void ProcessCliCommands();
         void QueueCliCommand(CliCommandHolder* commandHolder) { cliCmdQueue.add(commandHolder); }
@@ -551,6 +637,12 @@ class World
         void UpdateResultQueue();
         void InitResultQueue();
 
+        // world update timing
+        static char const* GetUpdateStageName(WorldUpdateStage stage);
+        WorldUpdateStageStats const& GetUpdateStageStats(WorldUpdateStage stage) const { return m_updateStageStats[stage]; }
+        uint32 GetLastTickTime() const { return m_lastTickTime; }
+        uint32 GetTickOverruns() const { return m_tickOverruns; }
+
         void UpdateRealmCharCount(uint32 accid);
 
         LocaleConstant GetAvailableDbcLocale(LocaleConstant locale) const { if (m_availableDbcLocaleMask & (1 << locale)) { return locale; } else { return m_defaultDbcLocale; } }
@@ -562,6 +654,10 @@ class World
 
     protected:
         void _UpdateGameTime();
+        bool CanRunDeferrableStage(WorldUpdateStage stage);
+        void RecordUpdateStage(WorldUpdateStage stage, uint32 startTime);
+        /// Sample the session, map, network and database queue gauges
+        void UpdateMetrics();
         // callback for UpdateRealmCharacters
         void _UpdateRealmCharCount(QueryResult* resultCharCount, uint32 accountId);
 
@@ -593,8 +689,10 @@ class World
         time_t m_startTime;
         time_t m_gameTime;
         IntervalTimer m_timers[WUPDATE_COUNT];
-        uint32 mail_timer;
-        uint32 mail_timer_expires;
+        WorldUpdateStageStats m_updateStageStats[WUPDATE_STAGE_COUNT];
+        uint32 m_tickStartTime;
+        uint32 m_lastTickTime;
+        uint32 m_tickOverruns;                              // ticks taking longer than the tick budget
 
         typedef UNORDERED_MAP<uint32, Weather*> WeatherMap;
         WeatherMap m_weathers;
@@ -626,6 +724,7 @@ class World
 
         static float  m_relocation_lower_limit_sq;
         static uint32 m_relocation_ai_notify_delay;
+        static uint32 m_visibility_incremental_updates;
 
         // CLI command holder to be thread safe
         ACE_Based::LockedQueue<CliCommandHolder*, ACE_Thread_Mutex> cliCmdQueue;
@@ -635,7 +734,7 @@ class World
 
         // sessions that are added async
         void AddSession_(WorldSession* s);
-        ACE_Based::LockedQueue<WorldSession*, ACE_Thread_Mutex> addSessQueue;
+        ACE_Based::MPSCQueue<WorldSession*> addSessQueue;
 
         // used versions
         std::string m_DBVersion;
@@ -0,0 +1,161 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "WorldPacketPool.h"
+#include "MPSCQueue.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Guard_T.h>
+
+INSTANTIATE_SINGLETON_1(WorldPacketPool);
+
+/// Capacity of the size classes, the last one is the largest packet a client may send
+static size_t const packetSizeClasses[] = { 64, 256, 1024, 4096, 10240 };
+
+#define MAX_PACKET_SIZE_CLASS (sizeof(packetSizeClasses) / sizeof(packetSizeClasses[0]))
+#define MAX_FREE_PACKETS_PER_CLASS 512                      // more given back packets are deleted
+
+static uint8 GetPacketSizeClass(size_t size)
+{
+    uint8 sizeClass = 0;
+    while (sizeClass < MAX_PACKET_SIZE_CLASS && packetSizeClasses[sizeClass] < size)
+        { ++sizeClass; }
+
+    return sizeClass;
+}
+
+struct WorldPacketPool::PooledPacket : public WorldPacket
+{
+    PooledPacket(uint16 opcode, size_t size, uint8 sizeClass_, ThreadCache* owner_) :
+        WorldPacket(opcode, size), sizeClass(sizeClass_), owner(owner_), nextReturned(NULL) {}
+
+    uint8 sizeClass;
+    ThreadCache* owner;                                     // NULL for packets larger than all size classes
+    PooledPacket* volatile nextReturned;
+};
+
+struct WorldPacketPool::ThreadCache
+{
+    ThreadCache() : returned(NULL) {}
+
+    /// Called by any thread
+    void Return(PooledPacket* packet)
+    {
+        PooledPacket* head;
+        do
+        {
+            head = ACE_Based::MPSCQueueAtomic::LoadAcquire(&returned);
+            packet->nextReturned = head;
+        }
+        while (ACE_Based::MPSCQueueAtomic::CompareExchange(&returned, head, packet) != head);
+    }
+
+    /// Called by the owning thread only, takes the whole list so the pushes above can't see ABA
+    void TakeReturned()
+    {
+        PooledPacket* packet = ACE_Based::MPSCQueueAtomic::Exchange(&returned, (PooledPacket*)NULL);
+        while (packet)
+        {
+            PooledPacket* next = packet->nextReturned;
+
+            std::vector<PooledPacket*>& freeList = freeLists[packet->sizeClass];
+            if (freeList.size() < MAX_FREE_PACKETS_PER_CLASS)
+                { freeList.push_back(packet); }
+            else
+                { delete packet; }
+
+            packet = next;
+        }
+    }
+
+    std::vector<PooledPacket*> freeLists[MAX_PACKET_SIZE_CLASS];
+    PooledPacket* volatile returned;
+};
+
+WorldPacketPool::WorldPacketPool()
+{
+}
+
+WorldPacketPool::ThreadCache* WorldPacketPool::GetThreadCache()
+{
+    ThreadCacheRef* ref = m_threadCache;
+    if (!ref)
+        { return NULL; }
+
+    if (!ref->cache)
+    {
+        ref->cache = new ThreadCache();
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_cacheLock, ref->cache);
+        m_caches.push_back(ref->cache);
+    }
+
+    return ref->cache;
+}
+
+WorldPacket* WorldPacketPool::Acquire(uint16 opcode, size_t size)
+{
+    uint8 sizeClass = GetPacketSizeClass(size);
+    ThreadCache* cache = sizeClass < MAX_PACKET_SIZE_CLASS ? GetThreadCache() : NULL;
+    if (!cache)
+        { return new PooledPacket(opcode, size, 0, NULL); }
+
+    std::vector<PooledPacket*>& freeList = cache->freeLists[sizeClass];
+    if (freeList.empty())
+        { cache->TakeReturned(); }
+
+    if (freeList.empty())
+        { return new PooledPacket(opcode, packetSizeClasses[sizeClass], sizeClass, cache); }
+
+    PooledPacket* packet = freeList.back();
+    freeList.pop_back();
+
+    packet->Initialize(opcode, packetSizeClasses[sizeClass]);
+    return packet;
+}
+
+void WorldPacketPool::Release(WorldPacket* packet)
+{
+    if (!packet)
+        { return; }
+
+    PooledPacket* pooled = static_cast<PooledPacket*>(packet);
+    if (pooled->owner)
+        { pooled->owner->Return(pooled); }
+    else
+        { delete pooled; }
+}
+
+PooledWorldPacketPtr::~PooledWorldPacketPtr()
+{
+    sWorldPacketPool.Release(m_packet);
+}
+
+WorldPacket* PooledWorldPacketPtr::release()
+{
+    WorldPacket* packet = m_packet;
+    m_packet = NULL;
+    return packet;
+}
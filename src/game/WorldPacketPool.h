@@ -0,0 +1,92 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_WORLDPACKETPOOL_H
+#define MANGOS_WORLDPACKETPOOL_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "WorldPacket.h"
+
+#include <ace/TSS_T.h>
+#include <ace/Thread_Mutex.h>
+
+#include <vector>
+
+/**
+ * Freelists of received packets, one per network thread and size class.
+ *
+ * WorldSocket takes the packet for every received header from the freelist of its thread and WorldSession
+ * gives it back after the handler ran. Packets given back by other threads are pushed lock-free onto a return
+ * list of the thread that acquired them, which takes the whole list when its freelist of the size class is empty,
+ * so neither side allocates or locks once the pool is warm.
+ */
+class WorldPacketPool
+{
+    public:
+        WorldPacketPool();
+
+        /// Packet with capacity for at least size bytes, from the freelist of the calling thread if possible
+        WorldPacket* Acquire(uint16 opcode, size_t size);
+        /// Give back a packet of Acquire, safe to call from any thread
+        void Release(WorldPacket* packet);
+
+    private:
+        struct PooledPacket;
+        struct ThreadCache;
+
+        struct ThreadCacheRef
+        {
+            ThreadCacheRef() : cache(NULL) {}
+
+            ThreadCache* cache;
+        };
+
+        ThreadCache* GetThreadCache();
+
+        ACE_TSS<ThreadCacheRef> m_threadCache;
+        ACE_Thread_Mutex m_cacheLock;
+        std::vector<ThreadCache*> m_caches;                 // never freed, packets still in use point to them
+};
+
+/// Gives a pooled packet back when going out of scope unless release() was called, like ACE_Auto_Ptr
+class PooledWorldPacketPtr
+{
+    public:
+        explicit PooledWorldPacketPtr(WorldPacket* packet) : m_packet(packet) {}
+        ~PooledWorldPacketPtr();
+
+        WorldPacket* release();
+
+    private:
+        PooledWorldPacketPtr(PooledWorldPacketPtr const&);
+        PooledWorldPacketPtr& operator=(PooledWorldPacketPtr const&);
+
+        WorldPacket* m_packet;
+};
+
+#define sWorldPacketPool MaNGOS::Singleton<WorldPacketPool>::Instance()
+
+#endif
@@ -32,6 +32,7 @@
 #include "Log.h"
 #include "Opcodes.h"
 #include "WorldPacket.h"
+#include "WorldPacketPool.h"
 #include "WorldSession.h"
 #include "Player.h"
 #include "ObjectMgr.h"
@@ -42,8 +43,16 @@
 #include "ObjectAccessor.h"
 #include "BattleGround/BattleGroundMgr.h"
 #include "MapManager.h"
+#include "AuctionHouseMgr.h"
 #include "SocialMgr.h"
+#include "NetworkStats.h"
 #include "LuaEngine.h"
+#include "Profiler.h"
+#include "OpcodeStats.h"
+#include "PacketReplay.h"
+#include "PlayerNameCache.h"
+
+#include <ace/OS_NS_sys_time.h>
 
 // select opcodes appropriate for processing in Map::Update context for current session state
 static bool MapSessionFilterHelper(WorldSession* session, OpcodeHandler const& opHandle)
@@ -85,13 +94,43 @@ bool WorldSessionFilter::Process(WorldPacket* packet)
     return !MapSessionFilterHelper(m_pSession, opHandle);
 }
 
+// holds back or singles out the packets of a session over the rate limit of their opcode
+class RateLimitFilter
+{
+    public:
+        RateLimitFilter(PacketFilter& filter, WorldSession& session) :
+            m_filter(filter), m_session(session), m_limited(false), m_policy(RATE_LIMIT_DELAY) {}
+
+        bool Process(WorldPacket* packet)
+        {
+            if (!m_filter.Process(packet))
+                { return false; }
+
+            // a delayed packet stays at the front of the queue, so the packets after it keep their order
+            m_limited = m_session.IsRateLimited(packet->GetOpcode(), m_policy);
+            return !m_limited || m_policy != RATE_LIMIT_DELAY;
+        }
+
+        bool IsLimited() const { return m_limited; }
+        uint8 GetPolicy() const { return m_policy; }
+
+    private:
+        PacketFilter& m_filter;
+        WorldSession& m_session;
+        bool m_limited;
+        uint8 m_policy;
+};
+
 /// WorldSession constructor
 WorldSession::WorldSession(uint32 id, WorldSocket* sock, AccountTypes sec, time_t mute_time, LocaleConstant locale) :
     m_muteTime(mute_time),
     _player(NULL), m_Socket(sock), _security(sec), _accountId(id), _logoutTime(0),
     m_inQueue(false), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_playerSave(false),
     m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(sObjectMgr.GetIndexForLocale(locale)),
-    m_latency(0), m_tutorialState(TUTORIALDATA_UNCHANGED)
+    m_latency(0), m_tutorialState(TUTORIALDATA_UNCHANGED), m_pendingAuctionSearch(NULL),
+    m_auctionSearchCredit(int32(sWorld.getConfig(CONFIG_UINT32_AUCTION_SEARCH_BUDGET))), m_auctionSearchCreditTime(WorldTimer::getMSTime()),
+    m_handlerTimeWindow(WorldTimer::getMSTime()), m_handlerTime(0), m_handlerCalls(0), m_costliestOpcode(0), m_costliestOpcodeTime(0),
+    m_handlerThrottled(false), m_rateLimitTime(0), m_rateLimitCredit(0), m_replay(false)
 {
     if (sock)
     {
@@ -118,7 +157,9 @@ WorldSession::~WorldSession()
     ///- empty incoming packet queue
     WorldPacket* packet = NULL;
     while (_recvQueue.next(packet))
-        { delete packet; }
+        { sWorldPacketPool.Release(packet); }
+
+    delete m_pendingAuctionSearch;
 }
 
 void WorldSession::SizeError(WorldPacket const& packet, uint32 size) const
@@ -137,7 +178,17 @@ char const* WorldSession::GetPlayerName() const
 void WorldSession::SendPacket(WorldPacket const* packet)
 {
     if (!m_Socket)
-        { return; }
+    {
+        if (m_replay)
+            { sPacketReplay.CountSentPacket(*packet); }
+        return;
+    }
+
+    if (m_Socket->IsOutputCongested() && opcodeTable.GetCongestionPolicy(packet->GetOpcode()) == CONGESTION_DROP)
+    {
+        sNetworkStats.CountCongestedPacket(false);
+        return;
+    }
 
 #ifdef MANGOS_DEBUG
 
@@ -179,6 +230,15 @@ void WorldSession::SendPacket(WorldPacket const* packet)
         { m_Socket->CloseSocket(); }
 }
 
+void WorldSession::AddBroadcastTarget(std::vector<WorldSocket*>& sockets)
+{
+    if (!m_Socket || m_Socket->IsClosed())
+        { return; }
+
+    m_Socket->AddReference();
+    sockets.push_back(m_Socket);
+}
+
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(WorldPacket* new_packet)
 {
@@ -209,8 +269,28 @@ bool WorldSession::Update(PacketFilter& updater)
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if socket already closed
     WorldPacket* packet = NULL;
-    while (m_Socket && !m_Socket->IsClosed() && _recvQueue.next(packet, updater))
+    bool mapThread = !updater.ProcessLogout();
+    RateLimitFilter filter(updater, *this);
+
+    // a session over its handler time budget keeps the rest of its packets queued for the next second
+    while ((m_replay || (m_Socket && !m_Socket->IsClosed())) && !IsHandlerTimeExhausted() && _recvQueue.next(packet, filter))
     {
+        if (filter.IsLimited())
+        {
+            if (filter.GetPolicy() == RATE_LIMIT_DISCONNECT)
+            {
+                DETAIL_LOG("Disconnecting session [account id %u / address %s] over the rate limit of opcode %s (0x%.4X).",
+                           GetAccountId(), GetRemoteAddress().c_str(), packet->GetOpcodeName(), packet->GetOpcode());
+
+                KickPlayer();
+            }
+            else
+                { DEBUG_LOG("SESSION: dropped opcode %s (0x%.4X) over the rate limit", packet->GetOpcodeName(), packet->GetOpcode()); }
+
+            sWorldPacketPool.Release(packet);
+            continue;
+        }
+
         /*#if 1
         sLog.outError( "MOEP: %s (0x%.4X)",
                         packet->GetOpcodeName(),
@@ -230,7 +310,7 @@ bool WorldSession::Update(PacketFilter& updater)
                             { LogUnexpectedOpcode(packet, "the player has not logged in yet"); }
                     }
                     else if (_player->IsInWorld())
-                        { ExecuteOpcode(opHandle, packet); }
+                        { ExecuteOpcode(opHandle, packet, mapThread); }
 
                     // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
                     break;
@@ -241,7 +321,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     }
                     else
                         // not expected _player or must checked in packet hanlder
-                        { ExecuteOpcode(opHandle, packet); }
+                        { ExecuteOpcode(opHandle, packet, mapThread); }
                     break;
                 case STATUS_TRANSFER:
                     if (!_player)
@@ -249,7 +329,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     else if (_player->IsInWorld())
                         { LogUnexpectedOpcode(packet, "the player is still in world"); }
                     else
-                        { ExecuteOpcode(opHandle, packet); }
+                        { ExecuteOpcode(opHandle, packet, mapThread); }
                     break;
                 case STATUS_AUTHED:
                     // prevent cheating with skip queue wait
@@ -263,7 +343,7 @@ bool WorldSession::Update(PacketFilter& updater)
                     // and before other STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT opcodes.
                     m_playerRecentlyLogout = false;
 
-                    ExecuteOpcode(opHandle, packet);
+                    ExecuteOpcode(opHandle, packet, mapThread);
                     break;
                 case STATUS_NEVER:
                     sLog.outError("SESSION: received not allowed opcode %s (0x%.4X)",
@@ -301,7 +381,7 @@ bool WorldSession::Update(PacketFilter& updater)
             }
         }
 
-        delete packet;
+        sWorldPacketPool.Release(packet);
     }
 
     ///- Cleanup socket pointer if need
@@ -315,12 +395,25 @@ bool WorldSession::Update(PacketFilter& updater)
     // logout procedure should happen only in World::UpdateSessions() method!!!
     if (updater.ProcessLogout())
     {
+        ///- Answer a paced auction search when the budget refilled, in the world thread like the opcode
+        if (m_pendingAuctionSearch && HasAuctionSearchCredit())
+        {
+            AuctionSearchRequest* request = m_pendingAuctionSearch;
+            m_pendingAuctionSearch = NULL;
+
+            if (_player && _player->IsInWorld())
+                { SendAuctionListResult(*request); }
+
+            delete request;
+        }
+
         ///- If necessary, log the player out
         time_t currTime = time(NULL);
-        if (!m_Socket || (ShouldLogOut(currTime) && !m_playerLoading))
+        bool connected = m_Socket || m_replay;              // a replayed session has no socket until kicked
+        if (!connected || (ShouldLogOut(currTime) && !m_playerLoading))
             { LogoutPlayer(true); }
 
-        if (!m_Socket)
+        if (!connected)
             { return false; }                                   // Will remove this session from the world session map
     }
 
@@ -330,6 +423,8 @@ bool WorldSession::Update(PacketFilter& updater)
 /// %Log the player out
 void WorldSession::LogoutPlayer(bool Save)
 {
+    Database::AsyncOrderScope orderScope(CharacterDatabase, GetAccountId());
+
     // finish pending transfers before starting the logout
     while (_player && _player->IsBeingTeleportedFar())
         { HandleMoveWorldportAckOpcode(); }
@@ -440,6 +535,7 @@ void WorldSession::LogoutPlayer(bool Save)
             }
 
             guild->BroadcastEvent(GE_SIGNED_OFF, _player->GetObjectGuid(), _player->GetName());
+            guild->MemberLoggedOut(_player);
         }
 
         ///- Remove pet
@@ -450,6 +546,9 @@ void WorldSession::LogoutPlayer(bool Save)
         if (Save)
             { _player->SaveToDB(); }
 
+        // guild rosters, mails and friend lists keep asking for the name of the offline character
+        sPlayerNameCache.Add(_player->GetGUIDLow(), _player->GetName(), _player->getRace(), _player->getGender(), _player->getClass());
+
         ///- Leave all channels before player delete...
         _player->CleanupChannels();
 
@@ -513,6 +612,8 @@ void WorldSession::LogoutPlayer(bool Save)
 /// Kick a player out of the World
 void WorldSession::KickPlayer()
 {
+    m_replay = false;
+
     if (m_Socket)
         { m_Socket->CloseSocket(); }
 }
@@ -622,13 +723,11 @@ void WorldSession::SendAuthWaitQue(uint32 position)
     }
 }
 
-void WorldSession::LoadTutorialsData()
+void WorldSession::LoadTutorialsData(QueryResult* result)
 {
     for (int aX = 0 ; aX < 8 ; ++aX)
         { m_Tutorials[ aX ] = 0; }
 
-    QueryResult* result = CharacterDatabase.PQuery("SELECT tut0,tut1,tut2,tut3,tut4,tut5,tut6,tut7 FROM character_tutorial WHERE account = '%u'", GetAccountId());
-
     if (!result)
     {
         m_tutorialState = TUTORIALDATA_NEW;
@@ -703,8 +802,14 @@ void WorldSession::SendTransferAborted(uint32 mapid, uint8 reason, uint8 arg)
     SendPacket(&data);
 }
 
-void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet)
+void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet, bool mapThread)
 {
+    // keep the async character DB work of this account in order, see Database::AsyncOrderScope
+    Database::AsyncOrderScope orderScope(CharacterDatabase, GetAccountId());
+    SyncQueryAudit::Context auditContext(opHandle.name);
+    PROFILE_SCOPE_ID(opHandle.name, packet->GetOpcode());
+    ThreadActivityScope activity(opHandle.name, packet->GetOpcode());
+
     if (!sEluna->OnPacketReceive(this, *packet))
         return;
 
@@ -713,7 +818,19 @@ void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* pac
     if (_player)
         { _player->SetCanDelayTeleport(true); }
 
-    (this->*opHandle.handler)(*packet);
+    if (sOpcodeStats.IsEnabled())
+    {
+        ACE_Time_Value start = ACE_OS::gettimeofday();
+        (this->*opHandle.handler)(*packet);
+
+        ACE_UINT64 elapsed;
+        (ACE_OS::gettimeofday() - start).to_usec(elapsed);
+        uint32 handlerTime = uint32(std::min(elapsed, ACE_UINT64(0xFFFFFFFF)));
+        sOpcodeStats.AddCall(packet->GetOpcode(), mapThread ? OPCODE_STATS_MAP : OPCODE_STATS_WORLD, handlerTime, uint32(packet->size()));
+        AccountHandlerTime(packet->GetOpcode(), handlerTime);
+    }
+    else
+        { (this->*opHandle.handler)(*packet); }
 
     if (_player)
     {
@@ -730,6 +847,111 @@ void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* pac
         { LogUnprocessedTail(packet); }
 }
 
+/// Adds the time of a handler to the current second of the session
+void WorldSession::AccountHandlerTime(uint16 opcode, uint32 time)
+{
+    m_handlerTime += time;
+    ++m_handlerCalls;
+
+    if (time > m_costliestOpcodeTime)
+    {
+        m_costliestOpcode = opcode;
+        m_costliestOpcodeTime = time;
+    }
+}
+
+/// Starts the next second of the handler time, when the last one was expensive the session is noted as outlier
+bool WorldSession::IsHandlerTimeExhausted()
+{
+    if (WorldTimer::getMSTimeDiff(m_handlerTimeWindow, WorldTimer::getMSTime()) >= IN_MILLISECONDS)
+        { StartHandlerTimeWindow(); }
+
+    uint32 budget = sWorld.getConfig(CONFIG_UINT32_OPCODESTATS_SESSION_BUDGET);
+    if (!budget || m_handlerTime < budget)
+        { return false; }
+
+    m_handlerThrottled = true;
+    return true;
+}
+
+void WorldSession::StartHandlerTimeWindow()
+{
+    uint32 outlierTime = sWorld.getConfig(CONFIG_UINT32_OPCODESTATS_OUTLIER_TIME);
+    if (outlierTime && m_handlerTime >= outlierTime)
+    {
+        OpcodeStatsOutlier outlier;
+        outlier.accountId = GetAccountId();
+        outlier.playerName = GetPlayerName();
+        outlier.address = GetRemoteAddress();
+        outlier.time = time(NULL);
+        outlier.handlerTime = m_handlerTime;
+        outlier.calls = m_handlerCalls;
+        outlier.costliestOpcode = m_costliestOpcode;
+        outlier.throttled = m_handlerThrottled;
+        sOpcodeStats.AddOutlier(outlier);
+    }
+
+    m_handlerTimeWindow = WorldTimer::getMSTime();
+    m_handlerTime = 0;
+    m_handlerCalls = 0;
+    m_costliestOpcode = 0;
+    m_costliestOpcodeTime = 0;
+    m_handlerThrottled = false;
+}
+
+// tokens are counted in the share refilled per ms at a rate of one token per minute, so no refill is lost to rounding
+static uint32 const RATE_LIMIT_TOKEN = MINUTE * IN_MILLISECONDS;
+
+bool WorldSession::IsRateLimited(uint16 opcode, uint8& policy)
+{
+    uint8 index = opcodeTable.GetRateLimitIndex(opcode);
+    if (index == NO_RATE_LIMIT || !sWorld.getConfig(CONFIG_BOOL_RATE_LIMIT_ENABLE) || GetSecurity() > SEC_PLAYER)
+        { return false; }
+
+    std::vector<OpcodeRateLimit> const& limits = opcodeTable.GetRateLimits();
+    uint32 budget = sWorld.getConfig(CONFIG_UINT32_RATE_LIMIT_COST_BUDGET);
+    uint32 now = WorldTimer::getMSTime();
+
+    if (m_rateLimitTokens.empty())
+    {
+        // full buckets at login
+        m_rateLimitTokens.resize(limits.size());
+        for (size_t i = 0; i < limits.size(); ++i)
+            { m_rateLimitTokens[i] = uint32(limits[i].burst) * RATE_LIMIT_TOKEN; }
+
+        m_rateLimitCredit = budget * IN_MILLISECONDS;
+    }
+    else if (uint64 elapsed = WorldTimer::getMSTimeDiff(m_rateLimitTime, now))
+    {
+        for (size_t i = 0; i < limits.size(); ++i)
+        {
+            uint64 tokens = m_rateLimitTokens[i] + elapsed * limits[i].perMinute;
+            m_rateLimitTokens[i] = uint32(std::min(tokens, uint64(limits[i].burst) * RATE_LIMIT_TOKEN));
+        }
+
+        // the budget is per second, up to one second of it is saved up
+        uint64 credit = m_rateLimitCredit + elapsed * budget;
+        m_rateLimitCredit = uint32(std::min(credit, uint64(budget) * IN_MILLISECONDS));
+    }
+
+    m_rateLimitTime = now;
+
+    OpcodeRateLimit const& limit = limits[index];
+    // an opcode costing more than the whole budget needs a full budget only
+    uint32 cost = std::min(uint32(limit.cost), budget) * IN_MILLISECONDS;
+
+    if (m_rateLimitTokens[index] < RATE_LIMIT_TOKEN || (budget && m_rateLimitCredit < cost))
+    {
+        int32 forcedPolicy = sWorld.getConfig(CONFIG_INT32_RATE_LIMIT_POLICY);
+        policy = forcedPolicy >= 0 && forcedPolicy < MAX_RATE_LIMIT_POLICY ? uint8(forcedPolicy) : uint8(limit.policy);
+        return true;
+    }
+
+    m_rateLimitTokens[index] -= RATE_LIMIT_TOKEN;
+    m_rateLimitCredit -= cost;
+    return false;
+}
+
 void WorldSession::SendPlaySpellVisual(ObjectGuid guid, uint32 spellArtKit)
 {
     WorldPacket data(SMSG_PLAY_SPELL_VISUAL, 8 + 4);        // visual effect on guid
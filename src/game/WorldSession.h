@@ -30,6 +30,7 @@
 #define MANGOS_H_WORLDSESSION
 
 #include "Common.h"
+#include "MPSCQueue.h"
 #include "SharedDefines.h"
 #include "ObjectGuid.h"
 #include "AuctionHouseMgr.h"
@@ -38,6 +39,7 @@
 struct ItemPrototype;
 struct AuctionEntry;
 struct AuctionHouseEntry;
+struct AuctionSearchRequest;
 
 class ObjectGuid;
 class Creature;
@@ -84,6 +86,13 @@ enum TutorialDataState
     TUTORIALDATA_NEW       = 2
 };
 
+/// What the network thread does with a received CMSG_MESSAGECHAT, see WorldSession::PreprocessChatPacket
+enum ChatPreprocessResult
+{
+    CHAT_PREPROCESS_QUEUE  = 0,                             // cleaned, the world thread link checks and delivers it
+    CHAT_PREPROCESS_DROP   = 1                              // nothing to deliver
+};
+
 // class to deal with packet processing
 // allows to determine if next packet is safe to be processed
 class PacketFilter
@@ -138,6 +147,8 @@ class MANGOS_DLL_SPEC WorldSession
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
         void SendPacket(WorldPacket const* packet);
+        /// Add the referenced socket to the targets of a WorldSocketMgr::BroadcastPacket, if connected
+        void AddBroadcastTarget(std::vector<WorldSocket*>& sockets);
         void SendNotification(const char* format, ...) ATTR_PRINTF(2, 3);
         void SendNotification(int32 string_id, ...);
         void SendPetNameInvalid(uint32 error, const std::string& name);
@@ -153,6 +164,9 @@ class MANGOS_DLL_SPEC WorldSession
         char const* GetPlayerName() const;
         void SetSecurity(AccountTypes security) { _security = security; }
         std::string const& GetRemoteAddress() { return m_Address; }
+        /// Session of a PacketReplay bot, connected without a socket until kicked
+        void SetReplayed() { m_replay = true; m_Address = "replay"; }
+        bool IsReplayed() const { return m_replay; }
         void SetPlayer(Player* plr) { _player = plr; }
 
         /// Session in auth.queue currently
@@ -180,11 +194,22 @@ class MANGOS_DLL_SPEC WorldSession
 
         bool Update(PacketFilter& updater);
 
+        /**
+         * @brief takes a token of the opcode and its cost from the budget of the session
+         *
+         * @param opcode incoming opcode
+         * @param policy set to the PacketRateLimitPolicy of the opcode when limited
+         * @return bool true if the session is over the rate limit of the opcode or its cost budget,
+         *              nothing is taken then
+         */
+        bool IsRateLimited(uint16 opcode, uint8& policy);
+
         /// Handle the authentication waiting queue (to be completed)
         void SendAuthWaitQue(uint32 position);
 
         void SendNameQueryOpcode(Player* p);
         void SendNameQueryOpcodeFromDB(ObjectGuid guid);
+        void SendNameQueryResponse(ObjectGuid guid, std::string const& name, uint8 race, uint8 gender, uint8 playerClass);
         static void SendNameQueryOpcodeFromDBCallBack(QueryResult* result, uint32 accountId);
 
         void SendTrainerList(ObjectGuid guid);
@@ -208,14 +233,17 @@ class MANGOS_DLL_SPEC WorldSession
         void SendCancelTrade();
 
         void SendPetitionQueryOpcode(ObjectGuid petitionguid);
+        static void SendPetitionQueryOpcodeCallBack(QueryResult* result, uint32 accountId, uint32 petitionLowGuid);
 
         // pet
         void SendPetNameQuery(ObjectGuid guid, uint32 petnumber);
         void SendStablePet(ObjectGuid guid);
+        static void SendStablePetCallBack(QueryResult* result, uint32 accountId, uint64 guid);
         void SendStableResult(uint8 res);
         bool CheckStableMaster(ObjectGuid guid);
 
-        void LoadTutorialsData();
+        /// result of "SELECT tut0,...,tut7 FROM character_tutorial" for the account, deleted here
+        void LoadTutorialsData(QueryResult* result);
         void SendTutorialsData();
         void SaveTutorialsData();
         uint32 GetTutorialInt(uint32 intId)
@@ -244,6 +272,7 @@ class MANGOS_DLL_SPEC WorldSession
         static void SendAuctionOutbiddedMail(AuctionEntry* auction);
         void SendAuctionCancelledToBidderMail(AuctionEntry* auction);
         AuctionHouseEntry const* GetCheckedAuctionHouseForAuctioneer(ObjectGuid guid);
+        void SendAuctionListResult(AuctionSearchRequest const& request);
 
         // Item Enchantment
         void SendEnchantmentLog(ObjectGuid targetGuid, ObjectGuid casterGuid, uint32 itemId, uint32 spellId);
@@ -430,6 +459,7 @@ class MANGOS_DLL_SPEC WorldSession
 
         void HandlePetitionBuyOpcode(WorldPacket& recv_data);
         void HandlePetitionShowSignOpcode(WorldPacket& recv_data);
+        static void HandlePetitionShowSignOpcodeCallBack(QueryResult* result, uint32 accountId, uint64 petitionguid);
         void HandlePetitionQueryOpcode(WorldPacket& recv_data);
         void HandlePetitionRenameOpcode(WorldPacket& recv_data);
         void HandlePetitionSignOpcode(WorldPacket& recv_data);
@@ -511,6 +541,8 @@ class MANGOS_DLL_SPEC WorldSession
         void AuctionBind(uint32 price, AuctionEntry * auction, Player * pl, Player* auction_owner);
 
         void HandleGetMailList(WorldPacket& recv_data);
+        static void HandleMailedItemsCallBack(QueryResult* result, uint32 accountId, uint32 playerLowGuid);
+        void SendMailList();
         void HandleSendMail(WorldPacket& recv_data);
         void HandleMailTakeMoney(WorldPacket& recv_data);
         void HandleMailTakeItem(WorldPacket& recv_data);
@@ -575,6 +607,9 @@ class MANGOS_DLL_SPEC WorldSession
         void HandlePushQuestToParty(WorldPacket& recvPacket);
         void HandleQuestPushResult(WorldPacket& recvPacket);
 
+        /// Validates and cleans a chat message on the network thread, neither the player nor the account is accessed
+        ChatPreprocessResult PreprocessChatPacket(WorldPacket& packet);
+        /// Link checks a chat message on the world thread, the templates and locales it reads can be reloaded there
         bool processChatmessageFurtherAfterSecurityChecks(std::string&, uint32);
         void SendPlayerNotFoundNotice(std::string name);
         void SendWrongFactionNotice();
@@ -672,12 +707,20 @@ class MANGOS_DLL_SPEC WorldSession
         bool VerifyMovementInfo(MovementInfo const& movementInfo) const;
         void HandleMoverRelocation(MovementInfo& movementInfo);
 
-        void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet);
+        void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet, bool mapThread);
+
+        // handler time of the session per second, see OpcodeStats.SessionBudget
+        void AccountHandlerTime(uint16 opcode, uint32 time);
+        bool IsHandlerTimeExhausted();
+        void StartHandlerTimeWindow();
 
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* reason);
         void LogUnprocessedTail(WorldPacket* packet);
 
+        // auction search pacing, see Auction.SearchBudget
+        bool HasAuctionSearchCredit();
+
         Player* _player;
         WorldSocket* m_Socket;
         std::string m_Address;
@@ -697,7 +740,21 @@ class MANGOS_DLL_SPEC WorldSession
         uint32 m_Tutorials[8];
         TutorialDataState m_tutorialState;
         int32 m_clientTimeDelay;
-        ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
+        AuctionSearchRequest* m_pendingAuctionSearch;       // last search while over the search budget
+        int32 m_auctionSearchCredit;                        // auctions the session may still search through
+        uint32 m_auctionSearchCreditTime;                   // ms time of the last credit refill
+        uint32 m_handlerTimeWindow;                         // ms time the handler time second started
+        uint32 m_handlerTime;                               // microseconds in the second
+        uint32 m_handlerCalls;
+        uint16 m_costliestOpcode;
+        uint32 m_costliestOpcodeTime;
+        bool m_handlerThrottled;
+        std::vector<uint32> m_rateLimitTokens;              // per rate limit, see Opcodes::GetRateLimits
+        uint32 m_rateLimitTime;                             // ms time of the last token refill
+        uint32 m_rateLimitCredit;                           // milli cost units left, see RateLimit.CostBudget
+
+        bool m_replay;                                      // PacketReplay bot
+        ACE_Based::MPSCQueue<WorldPacket*> _recvQueue;      // filled by the network thread, drained by world or map update
 };
 #endif
 /// @}
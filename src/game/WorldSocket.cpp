@@ -31,7 +31,7 @@
 #include <ace/os_include/sys/os_socket.h>
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
-#include <ace/Auto_Ptr.h>
+#include <ace/TSS_T.h>
 
 #include "WorldSocket.h"
 #include "Common.h"
@@ -39,17 +39,22 @@
 #include "Util.h"
 #include "World.h"
 #include "WorldPacket.h"
+#include "WorldPacketPool.h"
 #include "SharedDefines.h"
 #include "ByteBuffer.h"
 #include "AddonHandler.h"
 #include "Opcodes.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 #include "Auth/BigNumber.h"
 #include "Auth/Sha1.h"
+#include "SessionKeyCache.h"
 #include "WorldSession.h"
 #include "WorldSocketMgr.h"
 #include "Log.h"
 #include "DBCStores.h"
+#include "NetworkStats.h"
+#include "PacketLog.h"
 #include "LuaEngine.h"
 
 #if defined( __GNUC__ )
@@ -81,12 +86,18 @@ WorldSocket::WorldSocket(void) :
     m_LastPingTime(ACE_Time_Value::zero),
     m_OverSpeedPings(0),
     m_Session(0),
+    m_AccountId(0),
     m_RecvWPct(0),
     m_RecvPct(),
     m_Header(sizeof(ClientPktHeader)),
     m_OutBuffer(0),
     m_OutBufferSize(65536),
+    m_PacketQueueBytes(0),
+    m_OutQueueHighWater(0),
+    m_OutQueueMax(0),
     m_OutActive(false),
+    m_FlushRequested(false),
+    m_AuthPending(false),
     m_Seed(static_cast<uint32>(rand32()))
 {
     reference_counting_policy().value(ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
@@ -94,7 +105,7 @@ WorldSocket::WorldSocket(void) :
 
 WorldSocket::~WorldSocket(void)
 {
-    delete m_RecvWPct;
+    sWorldPacketPool.Release(m_RecvWPct);
 
     if (m_OutBuffer)
         { m_OutBuffer->release(); }
@@ -105,7 +116,16 @@ WorldSocket::~WorldSocket(void)
 
     WorldPacket* pct;
     while (m_PacketQueue.dequeue_head(pct) == 0)
-        { delete pct; }
+    {
+        ForgetQueuedPacket(pct);
+        delete pct;
+    }
+
+    while (m_UrgentPacketQueue.dequeue_head(pct) == 0)
+    {
+        ForgetQueuedPacket(pct);
+        delete pct;
+    }
 }
 
 bool WorldSocket::IsClosed(void) const
@@ -137,35 +157,138 @@ const std::string& WorldSocket::GetRemoteAddress(void) const
     return m_Address;
 }
 
-int WorldSocket::SendPacket(const WorldPacket& pkt)
+/// Packets of CONGESTION_COLLAPSE opcodes start with the packed guid of the object they are about
+static bool GetCollapseKey(WorldPacket& pct, std::pair<uint16, uint64>& key)
 {
-    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
+    size_t rpos = pct.rpos();
+    bool valid = true;
 
+    try
+    {
+        pct.rpos(0);
+        key = std::make_pair(pct.GetOpcode(), pct.readPackGUID());
+    }
+    catch (ByteBufferException&)
+    {
+        valid = false;
+    }
+
+    pct.rpos(rpos);
+    return valid;
+}
+
+/// Copy of the packet being sent that Eluna may change, its storage is reused for the packets of a thread
+struct ThreadSendPacket
+{
+    ThreadSendPacket() : inUse(false) {}
+
+    WorldPacket packet;
+    bool inUse;                                             // packets sent from an Eluna hook get an own copy
+};
+
+typedef ACE_TSS<ThreadSendPacket> ThreadSendPacketTSS;
+static ThreadSendPacketTSS threadSendPacket;
+
+int WorldSocket::SendPacket(const WorldPacket& pkt)
+{
     if (closing_)
         { return -1; }
 
-    WorldPacket pct = pkt;
+    // Eluna may change the packet and the caller's packet is often broadcast to many sockets,
+    // so it is copied, into storage of the calling thread to need neither allocation nor m_OutBufferLock
+    ThreadSendPacket* copy = threadSendPacket;
+    if (!copy || copy->inUse)
+    {
+        WorldPacket pct(pkt);
+        return SendPacketCopy(pct);
+    }
+
+    copy->inUse = true;
+    copy->packet = pkt;
+
+    int result = SendPacketCopy(copy->packet);
 
-    // Dump outgoing packet.
-    sLog.outWorldPacketDump(uint32(get_handle()), pct.GetOpcode(), pct.GetOpcodeName(), &pct, false);
+    // keep only the storage of small packets like movement for the next copy
+    if (copy->packet.size() > 4096)
+    {
+        WorldPacket empty;
+        copy->packet.swap(empty);
+    }
+
+    copy->inUse = false;
+    return result;
+}
+
+int WorldSocket::SendPacketCopy(WorldPacket& pct)
+{
+    // Capture outgoing packet.
+    if (sPacketLog.IsEnabled())
+        { sPacketLog.LogPacket(uint32(get_handle()), m_AccountId, GetRemoteAddress(), pct, false); }
 
     if (!sEluna->OnPacketSend(m_Session, pct))
         return 0;
 
-    if (iSendPacket(pct) == -1)
+    sNetworkStats.CountPacket(pct.GetOpcode(), pct.size() + sizeof(ServerPktHeader));
+
+    return BufferPacket(pct);
+}
+
+int WorldSocket::BufferPacket(WorldPacket& pct)
+{
+    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+        { return -1; }
+
+    // urgent packets may overtake the queued packets of the other priorities, but packets of the same
+    // queue are never reordered
+    bool urgent = opcodeTable.GetSendPriority(pct.GetOpcode()) == SEND_PRIORITY_URGENT;
+    PacketQueueT& queue = urgent ? m_UrgentPacketQueue : m_PacketQueue;
+    bool mayBuffer = m_UrgentPacketQueue.is_empty() && (urgent || m_PacketQueue.is_empty());
+
+    if (!mayBuffer || iSendPacket(pct) == -1)
     {
         WorldPacket* npct;
 
-        ACE_NEW_RETURN(npct, WorldPacket(pct), -1);
+        // a client that can't keep up is dropped instead of growing the queue without limit
+        if (m_OutQueueMax && m_PacketQueueBytes + pct.size() > m_OutQueueMax)
+        {
+            sLog.outError("WorldSocket::SendPacket: output queue of %s is over Network.OutQueueMax, closing", GetRemoteAddress().c_str());
+            return -1;
+        }
+
+        // under backlog a newer packet replaces the queued one it supersedes
+        bool collapsible = opcodeTable.GetCongestionPolicy(pct.GetOpcode()) == CONGESTION_COLLAPSE;
+        if (collapsible && CollapseQueuedPacket(pct))
+            { return 0; }
+
+        ACE_NEW_RETURN(npct, WorldPacket(), -1);
+        npct->swap(pct);                                    // move the copy to the queue
 
         // NOTE maybe check of the size of the queue can be good ?
         // to make it bounded instead of unbounded
-        if (m_PacketQueue.enqueue_tail(npct) == -1)
+        if (queue.enqueue_tail(npct) == -1)
         {
             delete npct;
             sLog.outError("WorldSocket::SendPacket: m_PacketQueue.enqueue_tail failed");
             return -1;
         }
+
+        m_PacketQueueBytes += npct->size();
+        sNetworkStats.AddQueuedPackets(1, long(npct->size()));
+
+        if (collapsible)
+        {
+            std::pair<uint16, uint64> key;
+            if (GetCollapseKey(*npct, key))
+                { m_CollapsiblePackets[key] = npct; }
+        }
+    }
+    // without pending output the network thread would only send it at its next poll timeout
+    else if (!m_OutActive && !m_FlushRequested)
+    {
+        m_FlushRequested = true;
+        sWorldSocketMgr->RequestFlush(this);
     }
 
     return 0;
@@ -282,6 +405,8 @@ int WorldSocket::handle_output(ACE_HANDLE)
 {
     ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
 
+    m_FlushRequested = false;
+
     if (closing_)
         { return -1; }
 
@@ -290,6 +415,8 @@ int WorldSocket::handle_output(ACE_HANDLE)
     if (send_len == 0)
         { return cancel_wakeup_output(Guard); }
 
+    EncryptPendingHeaders();
+
 #ifdef MSG_NOSIGNAL
     ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
 #else
@@ -385,7 +512,7 @@ int WorldSocket::handle_input_header(void)
 
     header.size -= 4;
 
-    ACE_NEW_RETURN(m_RecvWPct, WorldPacket((uint16)header.cmd, header.size), -1);
+    m_RecvWPct = sWorldPacketPool.Acquire((uint16)header.cmd, header.size);
 
     if (header.size > 0)
     {
@@ -556,7 +683,7 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     MANGOS_ASSERT(new_pct);
 
     // manage memory ;)
-    ACE_Auto_Ptr<WorldPacket> aptr(new_pct);
+    PooledWorldPacketPtr aptr(new_pct);
 
     const ACE_UINT16 opcode = new_pct->GetOpcode();
 
@@ -569,8 +696,9 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     if (closing_)
         { return -1; }
 
-    // Dump received packet.
-    sLog.outWorldPacketDump(uint32(get_handle()), new_pct->GetOpcode(), new_pct->GetOpcodeName(), new_pct, true);
+    // Capture received packet.
+    if (sPacketLog.IsEnabled())
+        { sPacketLog.LogPacket(uint32(get_handle()), m_AccountId, GetRemoteAddress(), *new_pct, true); }
 
     try
     {
@@ -579,7 +707,7 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
             case CMSG_PING:
                 return HandlePing(*new_pct);
             case CMSG_AUTH_SESSION:
-                if (m_Session)
+                if (m_Session || m_AuthPending)
                 {
                     sLog.outError("WorldSocket::ProcessIncoming: Player send CMSG_AUTH_SESSION again");
                     return -1;
@@ -599,6 +727,10 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
 
                 if (m_Session != NULL)
                 {
+                    // chat is validated and cleaned here, the world thread link checks and delivers it
+                    if (opcode == CMSG_MESSAGECHAT && m_Session->PreprocessChatPacket(*new_pct) == CHAT_PREPROCESS_DROP)
+                        { return 0; }
+
                     // OK ,give the packet to WorldSession
                     aptr.release();
                     // WARNING here we call it with locks held.
@@ -638,18 +770,30 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     ACE_NOTREACHED(return 0);
 }
 
+/// CMSG_AUTH_SESSION of a socket while its account is looked up, see WorldSocket::HandleAuthSession
+struct AuthSessionRequest
+{
+    std::string account;
+    uint32 clientSeed;
+    uint8 digest[20];
+    WorldPacket addonInfo;                                  // rest of CMSG_AUTH_SESSION for the addon packet
+
+    // filled from the account
+    uint32 id;
+    uint32 security;
+    time_t mutetime;
+    LocaleConstant locale;
+    BigNumber K;
+};
+
 int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
 {
-    // NOTE: ATM the socket is singlethread, have this in mind ...
     uint8 digest[20];
-    uint32 clientSeed, id, security;
+    uint32 clientSeed;
     uint32 unk2;
     uint32 BuiltNumberClient;
-    LocaleConstant locale;
     std::string account;
-    Sha1Hash sha1;
-    BigNumber v, s, g, N, K;
-    WorldPacket packet, SendAddonPacked;
+    WorldPacket packet;
 
     // Read the content of the packet
     recvPacket >> BuiltNumberClient;
@@ -676,25 +820,111 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
         return -1;
     }
 
+    // Limit the login burst after a restart, the client retries on its own
+    if (!sWorldSocketMgr->AdmitAuthSession())
+    {
+        packet.Initialize(SMSG_AUTH_RESPONSE, 1);
+        packet << uint8(AUTH_DB_BUSY);
+
+        SendPacket(packet);
+
+        DETAIL_LOG("WorldSocket::HandleAuthSession: Sent Auth Response (too many logins, see Network.AuthRate).");
+        return -1;
+    }
+
+    AuthSessionRequest* request = new AuthSessionRequest;
+    request->account = account;
+    request->clientSeed = clientSeed;
+    memcpy(request->digest, digest, sizeof(digest));
+    request->addonInfo = recvPacket;
+    request->addonInfo.rpos(recvPacket.rpos());
+
+    m_AuthPending = true;
+    AddReference();
+
+    std::string safe_address = GetRemoteAddress();
+    LoginDatabase.escape_string(safe_address);
+
+    // realmd sent the account with the session key, only bans issued since the logon and the ip lock are looked up
+    SessionKeyMessage published;
+    if (sSessionKeyCache.Take(request->account, published))
+    {
+        request->id = published.accountId;
+        request->security = published.security <= SEC_ADMINISTRATOR ? published.security : uint32(SEC_ADMINISTRATOR);
+        request->mutetime = time_t(published.muteTime);
+        request->locale = published.locale < MAX_LOCALE ? LocaleConstant(published.locale) : LOCALE_enUS;
+        request->K.SetBinary(published.K, sizeof(published.K));
+
+        bool queued = LoginDatabase.AsyncPQuery(this, &WorldSocket::HandleAuthSessionAccessCallback, request,
+                                  "SELECT "
+                                  "last_ip, "                 // 0
+                                  "locked, "                  // 1
+                                  "EXISTS (SELECT 1 FROM account_banned WHERE account_banned.id = account.id AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)) "
+                                  "OR EXISTS (SELECT 1 FROM ip_banned WHERE (unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s') " // 2
+                                  "FROM account "
+                                  "WHERE id = '%u'",
+                                  safe_address.c_str(), request->id);
+        if (!queued)
+        {
+            delete request;
+            FinishAuthSession(false);
+            return -1;
+        }
+
+        return 0;
+    }
+
     // Get the account information from the realmd database
-    std::string safe_account = account; // Duplicate, else will screw the SHA hash verification below
+    std::string safe_account = request->account; // Duplicate, else will screw the SHA hash verification below
     LoginDatabase.escape_string(safe_account);
     // No SQL injection, username escaped.
 
-    QueryResult* result =
-        LoginDatabase.PQuery("SELECT "
-                             "id, "                      // 0
-                             "gmlevel, "                 // 1
-                             "sessionkey, "              // 2
-                             "last_ip, "                 // 3
-                             "locked, "                  // 4
-                             "v, "                       // 5
-                             "s, "                       // 6
-                             "mutetime, "                // 7
-                             "locale "                   // 8
-                             "FROM account "
-                             "WHERE username = '%s'",
-                             safe_account.c_str());
+    // the lookup runs on the LoginDatabase thread, the network thread is not blocked by it
+    bool queued = LoginDatabase.AsyncPQuery(this, &WorldSocket::HandleAuthSessionAccountCallback, request,
+                              "SELECT "
+                              "id, "                      // 0
+                              "gmlevel, "                 // 1
+                              "sessionkey, "              // 2
+                              "last_ip, "                 // 3
+                              "locked, "                  // 4
+                              "v, "                       // 5
+                              "s, "                       // 6
+                              "mutetime, "                // 7
+                              "locale, "                  // 8
+                              "EXISTS (SELECT 1 FROM account_banned WHERE account_banned.id = account.id AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)) "
+                              "OR EXISTS (SELECT 1 FROM ip_banned WHERE (unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s') " // 9
+                              "FROM account "
+                              "WHERE username = '%s'",
+                              safe_address.c_str(), safe_account.c_str());
+    if (!queued)
+    {
+        delete request;
+        FinishAuthSession(false);
+        return -1;
+    }
+
+    return 0;
+}
+
+void WorldSocket::HandleAuthSessionAccountCallback(QueryResult* result, AuthSessionRequest* request)
+{
+    if (HandleAuthSessionAccount(result, request) == -1)
+    {
+        delete request;
+        FinishAuthSession(false);
+    }
+}
+
+int WorldSocket::HandleAuthSessionAccount(QueryResult* result, AuthSessionRequest* request)
+{
+    BigNumber v, s, g, N;
+    WorldPacket packet;
+
+    if (IsClosed())
+    {
+        delete result;
+        return -1;
+    }
 
     // Stop if the account is not found
     if (!result)
@@ -726,62 +956,108 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     OPENSSL_free((void*) sStr);
     OPENSSL_free((void*) vStr);
 
-    ///- Re-check ip locking (same check as in realmd).
-    if (fields[4].GetUInt8() == 1)  // if ip is locked
+    if (CheckAccountAccess(fields[4].GetUInt8() == 1, fields[3].GetString(), fields[9].GetBool()) == -1)
     {
-        if (strcmp(fields[3].GetString(), GetRemoteAddress().c_str()))
-        {
-            packet.Initialize(SMSG_AUTH_RESPONSE, 1);
-            packet << uint8(AUTH_FAILED);
-            SendPacket(packet);
-
-            delete result;
-            BASIC_LOG("WorldSocket::HandleAuthSession: Sent Auth Response (Account IP differs).");
-            return -1;
-        }
+        delete result;
+        return -1;
     }
 
-    id = fields[0].GetUInt32();
-    security = fields[1].GetUInt16();
-    if (security > SEC_ADMINISTRATOR)                       // prevent invalid security settings in DB
-        { security = SEC_ADMINISTRATOR; }
+    request->id = fields[0].GetUInt32();
+    request->security = fields[1].GetUInt16();
+    if (request->security > SEC_ADMINISTRATOR)              // prevent invalid security settings in DB
+        { request->security = SEC_ADMINISTRATOR; }
 
-    K.SetHexStr(fields[2].GetString());
+    request->K.SetHexStr(fields[2].GetString());
 
-    time_t mutetime = time_t (fields[7].GetUInt64());
+    request->mutetime = time_t (fields[7].GetUInt64());
 
-    locale = LocaleConstant(fields[8].GetUInt8());
-    if (locale >= MAX_LOCALE)
-        { locale = LOCALE_enUS; }
+    request->locale = LocaleConstant(fields[8].GetUInt8());
+    if (request->locale >= MAX_LOCALE)
+        { request->locale = LOCALE_enUS; }
 
     delete result;
 
-    // Re-check account ban (same check as in realmd)
-    QueryResult* banresult =
-        LoginDatabase.PQuery("SELECT 1 FROM account_banned WHERE id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)"
-                             "UNION "
-                             "SELECT 1 FROM ip_banned WHERE (unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'",
-                             id, GetRemoteAddress().c_str());
+    return AuthenticateSession(request);
+}
+
+void WorldSocket::HandleAuthSessionAccessCallback(QueryResult* result, AuthSessionRequest* request)
+{
+    if (HandleAuthSessionAccess(result, request) == -1)
+    {
+        delete request;
+        FinishAuthSession(false);
+    }
+}
+
+int WorldSocket::HandleAuthSessionAccess(QueryResult* result, AuthSessionRequest* request)
+{
+    if (IsClosed())
+    {
+        delete result;
+        return -1;
+    }
+
+    // the account was deleted since the logon
+    if (!result)
+    {
+        WorldPacket packet(SMSG_AUTH_RESPONSE, 1);
+        packet << uint8(AUTH_UNKNOWN_ACCOUNT);
+        SendPacket(packet);
 
-    if (banresult) // if account banned
+        sLog.outError("WorldSocket::HandleAuthSession: Sent Auth Response (unknown account).");
+        return -1;
+    }
+
+    Field* fields = result->Fetch();
+    int access = CheckAccountAccess(fields[1].GetUInt8() == 1, fields[0].GetString(), fields[2].GetBool());
+    delete result;
+
+    if (access == -1)
+        { return -1; }
+
+    return AuthenticateSession(request);
+}
+
+int WorldSocket::CheckAccountAccess(bool ipLocked, char const* lastIp, bool banned)
+{
+    WorldPacket packet;
+
+    ///- Re-check ip locking (same check as in realmd).
+    if (ipLocked && strcmp(lastIp, GetRemoteAddress().c_str()))
     {
         packet.Initialize(SMSG_AUTH_RESPONSE, 1);
-        packet << uint8(AUTH_BANNED);
+        packet << uint8(AUTH_FAILED);
         SendPacket(packet);
 
-        delete banresult;
+        BASIC_LOG("WorldSocket::HandleAuthSession: Sent Auth Response (Account IP differs).");
+        return -1;
+    }
+
+    // Re-check account ban (same check as in realmd)
+    if (banned)
+    {
+        packet.Initialize(SMSG_AUTH_RESPONSE, 1);
+        packet << uint8(AUTH_BANNED);
+        SendPacket(packet);
 
         sLog.outError("WorldSocket::HandleAuthSession: Sent Auth Response (Account banned).");
         return -1;
     }
 
+    return 0;
+}
+
+int WorldSocket::AuthenticateSession(AuthSessionRequest* request)
+{
+    WorldPacket packet;
+
     // Check locked state for server
     AccountTypes allowedAccountType = sWorld.GetPlayerSecurityLimit();
 
-    if (allowedAccountType > SEC_PLAYER && AccountTypes(security) < allowedAccountType)
+    if (allowedAccountType > SEC_PLAYER && AccountTypes(request->security) < allowedAccountType)
     {
-        WorldPacket Packet(SMSG_AUTH_RESPONSE, 1);
-        Packet << uint8(AUTH_UNAVAILABLE);
+        packet.Initialize(SMSG_AUTH_RESPONSE, 1);
+        packet << uint8(AUTH_UNAVAILABLE);
 
         SendPacket(packet);
 
@@ -795,14 +1071,14 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     uint32 t = 0;
     uint32 seed = m_Seed;
 
-    sha.UpdateData(account);
+    sha.UpdateData(request->account);
     sha.UpdateData((uint8*) & t, 4);
-    sha.UpdateData((uint8*) & clientSeed, 4);
+    sha.UpdateData((uint8*) & request->clientSeed, 4);
     sha.UpdateData((uint8*) & seed, 4);
-    sha.UpdateBigNumbers(&K, NULL);
+    sha.UpdateBigNumbers(&request->K, NULL);
     sha.Finalize();
 
-    if (memcmp(sha.GetDigest(), digest, 20))
+    if (memcmp(sha.GetDigest(), request->digest, 20))
     {
         packet.Initialize(SMSG_AUTH_RESPONSE, 1);
         packet << uint8(AUTH_FAILED);
@@ -816,7 +1092,7 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     std::string address = GetRemoteAddress();
 
     DEBUG_LOG("WorldSocket::HandleAuthSession: Client '%s' authenticated successfully from %s.",
-              account.c_str(),
+              request->account.c_str(),
               address.c_str());
 
     // Update the last_ip in the database
@@ -824,26 +1100,65 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     static SqlStatementID updAccount;
 
     SqlStatement stmt = LoginDatabase.CreateStatement(updAccount, "UPDATE account SET last_ip = ? WHERE username = ?");
-    stmt.PExecute(address.c_str(), account.c_str());
+    stmt.PExecute(address.c_str(), request->account.c_str());
 
-    // NOTE ATM the socket is single-threaded, have this in mind ...
-    ACE_NEW_RETURN(m_Session, WorldSession(id, this, AccountTypes(security), mutetime, locale), -1);
+    // must see the tutorials saved by a previous session of the account
+    Database::AsyncOrderScope orderScope(CharacterDatabase, request->id);
+    if (!CharacterDatabase.AsyncPQuery(this, &WorldSocket::HandleAuthSessionTutorialsCallback, request,
+                                       "SELECT tut0,tut1,tut2,tut3,tut4,tut5,tut6,tut7 FROM character_tutorial WHERE account = '%u'", request->id))
+        { return -1; }
 
-    m_Crypt.SetKey(K.AsByteArray(), 40);
-    m_Crypt.Init();
+    return 0;
+}
 
-    m_Session->LoadTutorialsData();
+void WorldSocket::HandleAuthSessionTutorialsCallback(QueryResult* result, AuthSessionRequest* request)
+{
+    if (IsClosed())
+    {
+        delete result;
+        delete request;
+        FinishAuthSession(false);
+        return;
+    }
 
-    // In case needed sometime the second arg is in microseconds 1 000 000 = 1 sec
-    ACE_OS::sleep(ACE_Time_Value(0, 10000));
+    WorldSession* session = new WorldSession(request->id, this, AccountTypes(request->security), request->mutetime, request->locale);
+    session->LoadTutorialsData(result);
 
-    sWorld.AddSession(m_Session);
+    {
+        // headers buffered from now on are encrypted when sent
+        ACE_GUARD(LockType, Guard, m_OutBufferLock);
+
+        m_Crypt.SetKey(request->K.AsByteArray(), 40);
+        m_Crypt.Init();
+    }
+
+    {
+        ACE_GUARD(LockType, Guard, m_SessionLock);
+
+        m_Session = session;
+        m_AccountId = request->id;
+    }
+
+    sWorld.AddSession(session);
 
     // Create and send the Addon packet
-    if (sAddOnHandler.BuildAddonPacket(&recvPacket, &SendAddonPacked))
+    WorldPacket SendAddonPacked;
+    if (sAddOnHandler.BuildAddonPacket(&request->addonInfo, &SendAddonPacked))
         { SendPacket(SendAddonPacked); }
 
-    return 0;
+    delete request;
+    FinishAuthSession(true);
+}
+
+void WorldSocket::FinishAuthSession(bool authed)
+{
+    sWorldSocketMgr->FinishAuthSession();
+    m_AuthPending = false;
+
+    if (!authed)
+        { CloseSocket(); }
+
+    RemoveReference();
 }
 
 int WorldSocket::HandlePing(WorldPacket& recvPacket)
@@ -929,7 +1244,9 @@ int WorldSocket::iSendPacket(const WorldPacket& pct)
     EndianConvertReverse(header.size);
     EndianConvert(header.cmd);
 
-    m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
+    // headers are encrypted by the network thread right before sending, see EncryptPendingHeaders
+    if (m_Crypt.IsInitialized())
+        { m_UnencryptedHeaders.push_back(size_t(m_OutBuffer->wr_ptr() - m_OutBuffer->base())); }
 
     if (m_OutBuffer->copy((char*) & header, sizeof(header)) == -1)
         { ACE_ASSERT(false); }
@@ -941,17 +1258,41 @@ int WorldSocket::iSendPacket(const WorldPacket& pct)
     return 0;
 }
 
+void WorldSocket::EncryptPendingHeaders()
+{
+    if (m_UnencryptedHeaders.empty())
+        { return; }
+
+    m_Crypt.EncryptSendHeaders((uint8*) m_OutBuffer->base(), &m_UnencryptedHeaders[0], m_UnencryptedHeaders.size());
+    m_UnencryptedHeaders.clear();
+}
+
 bool WorldSocket::iFlushPacketQueue()
+{
+    bool haveone = iFlushPacketQueue(m_UrgentPacketQueue);
+
+    if (m_UrgentPacketQueue.is_empty() && iFlushPacketQueue(m_PacketQueue))
+        { haveone = true; }
+
+    return haveone;
+}
+
+bool WorldSocket::iFlushPacketQueue(PacketQueueT& queue)
 {
     WorldPacket* pct;
     bool haveone = false;
 
-    while (m_PacketQueue.dequeue_head(pct) == 0)
+    while (queue.dequeue_head(pct) == 0)
     {
-        if (iSendPacket(*pct) == -1)
+        // bulk packets leave half of the buffer to urgent packets sent until the next write
+        bool paced = m_OutBuffer->length() > m_OutBufferSize / 2 &&
+                     opcodeTable.GetSendPriority(pct->GetOpcode()) == SEND_PRIORITY_BULK;
+
+        if (paced || iSendPacket(*pct) == -1)
         {
-            if (m_PacketQueue.enqueue_head(pct) == -1)
+            if (queue.enqueue_head(pct) == -1)
             {
+                ForgetQueuedPacket(pct);
                 delete pct;
                 sLog.outError("WorldSocket::iFlushPacketQueue m_PacketQueue->enqueue_head");
                 return false;
@@ -962,9 +1303,47 @@ bool WorldSocket::iFlushPacketQueue()
         else
         {
             haveone = true;
+            ForgetQueuedPacket(pct);
             delete pct;
         }
     }
 
     return haveone;
 }
+
+bool WorldSocket::CollapseQueuedPacket(WorldPacket& pct)
+{
+    std::pair<uint16, uint64> key;
+    if (!GetCollapseKey(pct, key))
+        { return false; }
+
+    CollapsiblePacketMap::const_iterator itr = m_CollapsiblePackets.find(key);
+    if (itr == m_CollapsiblePackets.end())
+        { return false; }
+
+    WorldPacket* queued = itr->second;
+    m_PacketQueueBytes -= queued->size();
+    m_PacketQueueBytes += pct.size();
+    sNetworkStats.AddQueuedPackets(0, long(pct.size()) - long(queued->size()));
+    sNetworkStats.CountCongestedPacket(true);
+
+    queued->swap(pct);                                      // keeps the place in the queue
+    return true;
+}
+
+void WorldSocket::ForgetQueuedPacket(WorldPacket* pct)
+{
+    m_PacketQueueBytes -= pct->size();
+    sNetworkStats.AddQueuedPackets(-1, -long(pct->size()));
+
+    if (m_CollapsiblePackets.empty() || opcodeTable.GetCongestionPolicy(pct->GetOpcode()) != CONGESTION_COLLAPSE)
+        { return; }
+
+    std::pair<uint16, uint64> key;
+    if (!GetCollapseKey(*pct, key))
+        { return; }
+
+    CollapsiblePacketMap::iterator itr = m_CollapsiblePackets.find(key);
+    if (itr != m_CollapsiblePackets.end() && itr->second == pct)
+        { m_CollapsiblePackets.erase(itr); }
+}
@@ -52,6 +52,8 @@
 class ACE_Message_Block;
 class WorldPacket;
 class WorldSession;
+class QueryResult;
+struct AuthSessionRequest;
 
 /// Handler that can communicate over stream sockets.
 typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
@@ -110,6 +112,9 @@ class WorldSocket : protected WorldHandler
         /// Queue for storing packets for which there is no space.
         typedef ACE_Unbounded_Queue< WorldPacket* > PacketQueueT;
 
+        /// Queued packets of CONGESTION_COLLAPSE opcodes by opcode and leading guid.
+        typedef std::map<std::pair<uint16, uint64>, WorldPacket*> CollapsiblePacketMap;
+
         /// Check if socket is closed.
         bool IsClosed(void) const;
 
@@ -124,6 +129,10 @@ class WorldSocket : protected WorldHandler
         /// @return -1 of failure
         int SendPacket(const WorldPacket& pct);
 
+        /// True while more than Network.OutQueueHighWater bytes wait behind the full output buffer.
+        /// Read without lock, so it is only a hint for dropping or throttling packets.
+        bool IsOutputCongested(void) const { return m_OutQueueHighWater && m_PacketQueueBytes > m_OutQueueHighWater; }
+
         /// Add reference to this object.
         long AddReference(void);
 
@@ -169,21 +178,58 @@ class WorldSocket : protected WorldHandler
         /// @param new_pct received packet ,note that you need to delete it.
         int ProcessIncoming(WorldPacket* new_pct);
 
-        /// Called by ProcessIncoming() on CMSG_AUTH_SESSION.
+        /// Called by ProcessIncoming() on CMSG_AUTH_SESSION, looks up the account asynchronously.
         int HandleAuthSession(WorldPacket& recvPacket);
 
+        /// LoginDatabase callback of HandleAuthSession, runs in the world thread.
+        void HandleAuthSessionAccountCallback(QueryResult* result, AuthSessionRequest* request);
+        int HandleAuthSessionAccount(QueryResult* result, AuthSessionRequest* request);
+        /// LoginDatabase callback of HandleAuthSession for an account of SessionKeyCache, only checks the bans and the ip lock.
+        void HandleAuthSessionAccessCallback(QueryResult* result, AuthSessionRequest* request);
+        int HandleAuthSessionAccess(QueryResult* result, AuthSessionRequest* request);
+        /// Re-checks the ip lock and the bans (same checks as in realmd), sends the refusal
+        int CheckAccountAccess(bool ipLocked, char const* lastIp, bool banned);
+        /// Checks the client digest with the session key of the account and loads the tutorials
+        int AuthenticateSession(AuthSessionRequest* request);
+
+        /// CharacterDatabase callback of HandleAuthSessionAccount, creates the session.
+        void HandleAuthSessionTutorialsCallback(QueryResult* result, AuthSessionRequest* request);
+
+        /// End of an admitted auth session request, closes the socket if not authed.
+        void FinishAuthSession(bool authed);
+
         /// Called by ProcessIncoming() on CMSG_PING.
         int HandlePing(WorldPacket& recvPacket);
 
+        /// Dump pct, run the Eluna hook on it and buffer it, pct is a copy of the packet passed to SendPacket
+        int SendPacketCopy(WorldPacket& pct);
+
+        /// Write pct to m_OutBuffer or move it to a packet queue if there is no space or packets have to be sent first,
+        /// takes m_OutBufferLock
+        int BufferPacket(WorldPacket& pct);
+
         /// Try to write WorldPacket to m_OutBuffer ,return -1 if no space
         /// Need to be called with m_OutBufferLock lock held
         int iSendPacket(const WorldPacket& pct);
 
-        /// Flush m_PacketQueue if there are packets in it
+        /// Encrypt the headers written to m_OutBuffer since the last send, called before sending it
+        /// Need to be called with m_OutBufferLock lock held
+        void EncryptPendingHeaders();
+
+        /// Flush m_UrgentPacketQueue and m_PacketQueue if there are packets in them
         /// Need to be called with m_OutBufferLock lock held
         /// @return true if it wrote to the buffer ( AKA you need
         /// to mark the socket for output ).
         bool iFlushPacketQueue();
+        bool iFlushPacketQueue(PacketQueueT& queue);
+
+        /// Replace the queued packet superseded by pct with it, false if there is none
+        /// Need to be called with m_OutBufferLock lock held
+        bool CollapseQueuedPacket(WorldPacket& pct);
+
+        /// Bookkeeping for a packet leaving the queues, it is deleted by the caller
+        /// Need to be called with m_OutBufferLock lock held
+        void ForgetQueuedPacket(WorldPacket* pct);
 
     private:
         /// Time in which the last ping was received
@@ -204,6 +250,9 @@ class WorldSocket : protected WorldHandler
         /// Session to which received packets are routed
         WorldSession* m_Session;
 
+        /// Account of m_Session, set once at authentication and read without m_SessionLock by the packet capture
+        uint32 m_AccountId;
+
         /// here are stored the fragments of the received data
         WorldPacket* m_RecvWPct;
 
@@ -224,13 +273,35 @@ class WorldSocket : protected WorldHandler
         /// Size of the m_OutBuffer.
         size_t m_OutBufferSize;
 
+        /// Offsets from the base of m_OutBuffer of the headers not encrypted yet, see EncryptPendingHeaders
+        std::vector<size_t> m_UnencryptedHeaders;
+
         /// Here are stored packets for which there was no space on m_OutBuffer,
         /// this allows not-to kick player if its buffer is overflowed.
         PacketQueueT m_PacketQueue;
 
+        /// Queued packets of SEND_PRIORITY_URGENT, sent before m_PacketQueue.
+        PacketQueueT m_UrgentPacketQueue;
+
+        /// Packets in the queues that newer ones of the same opcode and guid replace, see CollapseQueuedPacket.
+        CollapsiblePacketMap m_CollapsiblePackets;
+
+        /// Size of the packets in m_PacketQueue and m_UrgentPacketQueue.
+        size_t m_PacketQueueBytes;
+
+        /// Limits of m_PacketQueueBytes from Network.OutQueueHighWater and Network.OutQueueMax, 0 for none.
+        size_t m_OutQueueHighWater;
+        size_t m_OutQueueMax;
+
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        /// True if the socket waits in the flush list of its network thread, see WorldSocketMgr::RequestFlush
+        bool m_FlushRequested;
+
+        /// True while the account of the CMSG_AUTH_SESSION is looked up, the socket is referenced meanwhile
+        bool m_AuthPending;
+
         uint32 m_Seed;
 };
 
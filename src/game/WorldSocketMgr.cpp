@@ -43,12 +43,29 @@
 #include <ace/os_include/sys/os_socket.h>
 
 #include <set>
+#include <vector>
 
 #include "Log.h"
 #include "Common.h"
 #include "Config/Config.h"
 #include "Database/DatabaseEnv.h"
 #include "WorldSocket.h"
+#include "WorldPacket.h"
+
+/// Packets of WorldSocketMgr::BroadcastPackets, deleted by the last network thread that sent them
+struct SharedBroadcastPackets
+{
+    explicit SharedBroadcastPackets(long threads) : refs(threads) {}
+
+    void Release()
+    {
+        if (--refs == 0)
+            { delete this; }
+    }
+
+    std::vector<WorldPacket> packets;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> refs;
+};
 
 /**
 * This is a helper class to WorldSocketMgr ,that manages
@@ -61,7 +78,9 @@ class ReactorRunnable : protected ACE_Task_Base
         ReactorRunnable() :
             m_Reactor(0),
             m_Connections(0),
-            m_ThreadId(-1)
+            m_ThreadId(-1),
+            m_AffinityIndex(0),
+            m_LastUpdate(ACE_Time_Value::zero)
         {
             ACE_Reactor_Impl* imp = 0;
 
@@ -95,11 +114,15 @@ class ReactorRunnable : protected ACE_Task_Base
             m_Reactor->end_reactor_event_loop();
         }
 
-        int Start()
+        /// CPU sets of Affinity.Network and the index of this thread among the network threads
+        int Start(std::string const& affinity, uint32 affinityIndex)
         {
             if (m_ThreadId != -1)
                 { return -1; }
 
+            m_Affinity = affinity;
+            m_AffinityIndex = affinityIndex;
+
             return (m_ThreadId = activate());
         }
 
@@ -127,6 +150,40 @@ class ReactorRunnable : protected ACE_Task_Base
             return m_Reactor;
         }
 
+        void RequestFlush(WorldSocket* sock)
+        {
+            bool wakeup;
+
+            {
+                ACE_GUARD(ACE_Thread_Mutex, Guard, m_FlushSockets_Lock);
+
+                // one wakeup for all sockets getting output until the thread flushes them
+                wakeup = m_FlushSockets.empty() && m_Broadcasts.empty();
+                sock->AddReference();
+                m_FlushSockets.push_back(sock);
+            }
+
+            if (wakeup)
+                { m_Reactor->notify(); }
+        }
+
+        /// Let the thread send the packets to its sockets, takes over the socket references
+        void RequestBroadcast(SharedBroadcastPackets* packets, std::vector<WorldSocket*>& sockets)
+        {
+            bool wakeup;
+
+            {
+                ACE_GUARD(ACE_Thread_Mutex, Guard, m_FlushSockets_Lock);
+
+                wakeup = m_FlushSockets.empty() && m_Broadcasts.empty();
+                m_Broadcasts.push_back(Broadcast(packets, SocketVector()));
+                m_Broadcasts.back().second.swap(sockets);
+            }
+
+            if (wakeup)
+                { m_Reactor->notify(); }
+        }
+
     protected:
         void AddNewSockets()
         {
@@ -151,10 +208,50 @@ class ReactorRunnable : protected ACE_Task_Base
             m_NewSockets.clear();
         }
 
+        void FlushSockets()
+        {
+            SocketVector sockets;
+            BroadcastVector broadcasts;
+
+            {
+                ACE_GUARD(ACE_Thread_Mutex, Guard, m_FlushSockets_Lock);
+                sockets.swap(m_FlushSockets);
+                broadcasts.swap(m_Broadcasts);
+            }
+
+            // the sockets request their flush by this, so it happens at the next loop
+            for (BroadcastVector::const_iterator b = broadcasts.begin(); b != broadcasts.end(); ++b)
+            {
+                std::vector<WorldPacket> const& packets = b->first->packets;
+                for (SocketVector::const_iterator i = b->second.begin(); i != b->second.end(); ++i)
+                {
+                    for (size_t p = 0; p < packets.size() && !(*i)->IsClosed(); ++p)
+                    {
+                        if ((*i)->SendPacket(packets[p]) == -1)
+                            { (*i)->CloseSocket(); }
+                    }
+
+                    (*i)->RemoveReference();
+                }
+
+                b->first->Release();
+            }
+
+            // failing sockets are closed by the next full update
+            for (SocketVector::const_iterator i = sockets.begin(); i != sockets.end(); ++i)
+            {
+                (*i)->Update();
+                (*i)->RemoveReference();
+            }
+        }
+
         virtual int svc()
         {
             DEBUG_LOG("Network Thread Starting");
 
+            if (!ACE_Based::Thread::setCurrentAffinity(m_Affinity, m_AffinityIndex))
+                { sLog.outError("Affinity.Network '%s' is invalid or not supported, network thread not bound", m_Affinity.c_str()); }
+
             WorldDatabase.ThreadStart();
 
             MANGOS_ASSERT(m_Reactor);
@@ -164,12 +261,21 @@ class ReactorRunnable : protected ACE_Task_Base
             while (!m_Reactor->reactor_event_loop_done())
             {
                 // dont be too smart to move this outside the loop
-                // the run_reactor_event_loop will modify interval
+                // the handle_events will modify interval
                 ACE_Time_Value interval(0, 10000);
 
-                if (m_Reactor->run_reactor_event_loop(interval) == -1)
+                if (m_Reactor->handle_events(interval) == -1)
                     { break; }
 
+                // output of sockets that requested it is sent right away, all sockets every 10 ms
+                FlushSockets();
+
+                ACE_Time_Value now = ACE_OS::gettimeofday();
+                if (now - m_LastUpdate < ACE_Time_Value(0, 10000))
+                    { continue; }
+
+                m_LastUpdate = now;
+
                 AddNewSockets();
 
                 for (i = m_Sockets.begin(); i != m_Sockets.end();)
@@ -188,6 +294,8 @@ class ReactorRunnable : protected ACE_Task_Base
                 }
             }
 
+            FlushSockets();                                 // release the references
+
             WorldDatabase.ThreadEnd();
 
             DEBUG_LOG("Network Thread Exitting");
@@ -198,15 +306,27 @@ class ReactorRunnable : protected ACE_Task_Base
     private:
         typedef ACE_Atomic_Op<ACE_SYNCH_MUTEX, long> AtomicInt;
         typedef std::set<WorldSocket*> SocketSet;
+        typedef std::vector<WorldSocket*> SocketVector;
+        typedef std::pair<SharedBroadcastPackets*, SocketVector> Broadcast;
+        typedef std::vector<Broadcast> BroadcastVector;
 
         ACE_Reactor* m_Reactor;
         AtomicInt m_Connections;
         int m_ThreadId;
 
+        std::string m_Affinity;
+        uint32 m_AffinityIndex;
+
         SocketSet m_Sockets;
 
         SocketSet m_NewSockets;
         ACE_Thread_Mutex m_NewSockets_Lock;
+
+        SocketVector m_FlushSockets;
+        BroadcastVector m_Broadcasts;                       // also guarded by m_FlushSockets_Lock
+        ACE_Thread_Mutex m_FlushSockets_Lock;
+
+        ACE_Time_Value m_LastUpdate;                        // of the full m_Sockets update
 };
 
 WorldSocketMgr::WorldSocketMgr():
@@ -214,7 +334,14 @@ WorldSocketMgr::WorldSocketMgr():
     m_NetThreadsCount(0),
     m_SockOutKBuff(-1),
     m_SockOutUBuff(65536),
+    m_OutQueueHighWater(0),
+    m_OutQueueMax(0),
     m_UseNoDelay(true),
+    m_AuthRate(0),
+    m_AuthQueueMax(0),
+    m_AuthRateTime(0),
+    m_AuthRateCount(0),
+    m_PendingAuths(0),
     m_Acceptor(0)
 {
 }
@@ -254,6 +381,12 @@ int WorldSocketMgr::StartReactiveIO(ACE_UINT16 port, const char* address)
         return -1;
     }
 
+    m_OutQueueHighWater = static_cast<size_t>(std::max(sConfig.GetIntDefault("Network.OutQueueHighWater", 0), 0));
+    m_OutQueueMax = static_cast<size_t>(std::max(sConfig.GetIntDefault("Network.OutQueueMax", 0), 0));
+
+    m_AuthRate = static_cast<uint32>(std::max(sConfig.GetIntDefault("Network.AuthRate", 0), 0));
+    m_AuthQueueMax = static_cast<uint32>(std::max(sConfig.GetIntDefault("Network.AuthQueueMax", 0), 0));
+
     WorldSocket::Acceptor* acc = new WorldSocket::Acceptor;
     m_Acceptor = acc;
 
@@ -265,8 +398,9 @@ int WorldSocketMgr::StartReactiveIO(ACE_UINT16 port, const char* address)
         return -1;
     }
 
+    std::string affinity = sConfig.GetStringDefault("Affinity.Network", "");
     for (size_t i = 0; i < m_NetThreadsCount; ++i)
-        { m_NetThreads[i].Start(); }
+        { m_NetThreads[i].Start(affinity, uint32(i)); }
 
     return 0;
 }
@@ -310,6 +444,65 @@ void WorldSocketMgr::Wait()
     }
 }
 
+void WorldSocketMgr::RequestFlush(WorldSocket* sock)
+{
+    for (size_t i = 0; i < m_NetThreadsCount; ++i)
+    {
+        if (m_NetThreads[i].GetReactor() == sock->reactor())
+        {
+            m_NetThreads[i].RequestFlush(sock);
+            return;
+        }
+    }
+}
+
+void WorldSocketMgr::BroadcastPacket(WorldPacket const& packet, std::vector<WorldSocket*> const& sockets)
+{
+    std::vector<WorldPacket const*> packets(1, &packet);
+    BroadcastPackets(packets, sockets);
+}
+
+void WorldSocketMgr::BroadcastPackets(std::vector<WorldPacket const*> const& packets, std::vector<WorldSocket*> const& sockets)
+{
+    if (sockets.empty())
+        { return; }
+
+    std::vector<std::vector<WorldSocket*> > threadSockets(m_NetThreadsCount);
+    long threads = 0;
+
+    for (std::vector<WorldSocket*>::const_iterator itr = sockets.begin(); itr != sockets.end(); ++itr)
+    {
+        size_t i = 0;
+        while (i < m_NetThreadsCount && m_NetThreads[i].GetReactor() != (*itr)->reactor())
+            { ++i; }
+
+        if (i == m_NetThreadsCount)
+        {
+            (*itr)->RemoveReference();                      // not added to a network thread yet
+            continue;
+        }
+
+        if (threadSockets[i].empty())
+            { ++threads; }
+
+        threadSockets[i].push_back(*itr);
+    }
+
+    if (!threads)
+        { return; }
+
+    SharedBroadcastPackets* shared = new SharedBroadcastPackets(threads);
+    shared->packets.reserve(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i)
+        { shared->packets.push_back(*packets[i]); }
+
+    for (size_t i = 0; i < m_NetThreadsCount; ++i)
+    {
+        if (!threadSockets[i].empty())
+            { m_NetThreads[i].RequestBroadcast(shared, threadSockets[i]); }
+    }
+}
+
 int WorldSocketMgr::OnSocketOpen(WorldSocket* sock)
 {
     // set some options here
@@ -335,6 +528,8 @@ int WorldSocketMgr::OnSocketOpen(WorldSocket* sock)
     }
 
     sock->m_OutBufferSize = static_cast<size_t>(m_SockOutUBuff);
+    sock->m_OutQueueHighWater = m_OutQueueHighWater;
+    sock->m_OutQueueMax = m_OutQueueMax;
 
     // we skip the Acceptor Thread
     size_t min = 1;
@@ -348,6 +543,40 @@ int WorldSocketMgr::OnSocketOpen(WorldSocket* sock)
     return m_NetThreads[min].AddSocket(sock);
 }
 
+bool WorldSocketMgr::AdmitAuthSession()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_AuthLock, false);
+
+    if (m_AuthQueueMax && m_PendingAuths >= m_AuthQueueMax)
+        { return false; }
+
+    if (m_AuthRate)
+    {
+        time_t now = time(NULL);
+        if (now != m_AuthRateTime)
+        {
+            m_AuthRateTime = now;
+            m_AuthRateCount = 0;
+        }
+
+        if (m_AuthRateCount >= m_AuthRate)
+            { return false; }
+
+        ++m_AuthRateCount;
+    }
+
+    ++m_PendingAuths;
+    return true;
+}
+
+void WorldSocketMgr::FinishAuthSession()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_AuthLock);
+
+    MANGOS_ASSERT(m_PendingAuths > 0);
+    --m_PendingAuths;
+}
+
 WorldSocketMgr* WorldSocketMgr::Instance()
 {
     return ACE_Singleton<WorldSocketMgr, ACE_Thread_Mutex>::instance();
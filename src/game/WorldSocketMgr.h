@@ -36,7 +36,9 @@
 #include <ace/Thread_Mutex.h>
 
 #include <string>
+#include <vector>
 
+class WorldPacket;
 class WorldSocket;
 class ReactorRunnable;
 class ACE_Event_Handler;
@@ -57,11 +59,23 @@ class WorldSocketMgr
         /// Wait untill all network threads have "joined" .
         void Wait();
 
+        /// Send packet to the sockets from their network threads, one copy of it is shared by the threads.
+        /// Takes over a reference of every socket, see WorldSession::AddBroadcastTarget
+        void BroadcastPacket(WorldPacket const& packet, std::vector<WorldSocket*> const& sockets);
+        /// Same for several packets sent in order
+        void BroadcastPackets(std::vector<WorldPacket const*> const& packets, std::vector<WorldSocket*> const& sockets);
+
         /// Make this class singleton .
         static WorldSocketMgr* Instance();
 
     private:
         int OnSocketOpen(WorldSocket* sock);
+        /// Wake the network thread of the socket to send its new output now instead of at its next poll timeout
+        void RequestFlush(WorldSocket* sock);
+        /// Admission of a CMSG_AUTH_SESSION, false over Network.AuthRate or Network.AuthQueueMax
+        bool AdmitAuthSession();
+        /// The account lookup of an admitted CMSG_AUTH_SESSION is finished
+        void FinishAuthSession();
         int StartReactiveIO(ACE_UINT16 port, const char* address);
 
         WorldSocketMgr();
@@ -72,8 +86,18 @@ class WorldSocketMgr
 
         int m_SockOutKBuff;
         int m_SockOutUBuff;
+        size_t m_OutQueueHighWater;
+        size_t m_OutQueueMax;
         bool m_UseNoDelay;
 
+        ACE_UINT32 m_AuthRate;                              // admitted auth sessions per second, 0 for no limit
+        ACE_UINT32 m_AuthQueueMax;                          // auth sessions waiting for the database, 0 for no limit
+
+        ACE_Thread_Mutex m_AuthLock;
+        time_t m_AuthRateTime;                              // second counted by m_AuthRateCount
+        ACE_UINT32 m_AuthRateCount;
+        ACE_UINT32 m_PendingAuths;
+
         std::string m_addr;
         ACE_UINT16 m_port;
 
@@ -38,6 +38,13 @@
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "SpellMgr.h"
+#include "NetworkStats.h"
+#include "SpellStats.h"
+#include "ScriptHookStats.h"
+#include "OpcodeStats.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "World.h"
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(char* args)
 {
@@ -1111,3 +1118,310 @@ bool ChatHandler::HandleDebugSpellModsCommand(char* args)
 
     return true;
 }
+
+/// Display the counted memory by subsystem with the allocation rates since the last call, as comma separated values with `csv`
+bool ChatHandler::HandleDebugMemoryCommand(char* args)
+{
+    bool csv = false;
+    if (*args)
+    {
+        if (!ExtractLiteralArg(&args, "csv"))
+            { return false; }
+
+        csv = true;
+    }
+
+    // commands run in the world thread only
+    static MemoryTagStats lastStats[MAX_MEMORY_TAG];
+    static uint32 lastTime = 0;
+
+    uint32 now = WorldTimer::getMSTime();
+    double seconds = lastTime ? std::max(WorldTimer::getMSTimeDiff(lastTime, now), uint32(1)) / double(IN_MILLISECONDS) : 0.0;
+    lastTime = now;
+
+    if (csv)
+        { SendSysMessage("tag,live_bytes,live_count,allocated_bytes,allocations,bytes_per_sec,allocations_per_sec,pool_slab_bytes,pool_free_bytes"); }
+    else if (seconds > 0.0)
+        { PSendSysMessage("Counted memory, rates of the last %.1f seconds:", seconds); }
+    else
+        { SendSysMessage("Counted memory, rates since start:"); }
+
+    int64 totalLive = 0;
+    for (uint32 i = 0; i < MAX_MEMORY_TAG; ++i)
+    {
+        MemoryTagStats stats;
+        MemoryTracker::GetStats(MemoryTag(i), stats);
+
+        double interval = seconds > 0.0 ? seconds : std::max(double(sWorld.GetUptime()), 1.0);
+        double bytesRate = (stats.allocatedBytes - lastStats[i].allocatedBytes) / interval;
+        double allocationRate = (stats.allocations - lastStats[i].allocations) / interval;
+        lastStats[i] = stats;
+        totalLive += stats.liveBytes;
+
+        uint64 slabBytes = MemoryPool::GetSlabBytes(MemoryTag(i));
+        uint64 freeBytes = MemoryPool::GetFreeBytes(MemoryTag(i));
+
+        if (csv)
+        {
+            PSendSysMessage("%s," SI64FMTD "," SI64FMTD "," UI64FMTD "," UI64FMTD ",%.0f,%.0f," UI64FMTD "," UI64FMTD, MemoryTracker::GetTagName(MemoryTag(i)), stats.liveBytes,
+                            stats.liveCount, stats.allocatedBytes, stats.allocations, bytesRate, allocationRate, slabBytes, freeBytes);
+            continue;
+        }
+
+        PSendSysMessage("  %-12s " SI64FMTD " KB in " SI64FMTD " allocations, %.0f KB/s in %.0f allocations/s", MemoryTracker::GetTagName(MemoryTag(i)),
+                        stats.liveBytes / 1024, stats.liveCount, bytesRate / 1024, allocationRate);
+
+        if (slabBytes)
+            { PSendSysMessage("  %-12s pooled in " UI64FMTD " KB of slabs, " UI64FMTD " KB of them free", "", slabBytes / 1024, freeBytes / 1024); }
+    }
+
+    if (csv)
+        { return true; }
+
+    if (uint64 resident = MemoryTracker::GetProcessMemory())
+        { PSendSysMessage(SI64FMTD " KB counted of " UI64FMTD " KB resident memory.", totalLive / 1024, resident / 1024); }
+    else
+        { PSendSysMessage(SI64FMTD " KB counted.", totalLive / 1024); }
+
+    return true;
+}
+
+/// Display outbound traffic by opcode, update packet compression and sampled field changes, as comma separated values with `csv`
+bool ChatHandler::HandleDebugNetStatsCommand(char* args)
+{
+    bool csv = false;
+    if (*args)
+    {
+        if (ExtractLiteralArg(&args, "reset"))
+        {
+            sNetworkStats.Reset();
+            SendSysMessage("Network statistics reset.");
+            return true;
+        }
+
+        if (!ExtractLiteralArg(&args, "csv"))
+            { return false; }
+
+        csv = true;
+    }
+
+    if (!sNetworkStats.IsEnabled())
+        { SendSysMessage("Network statistics are disabled, see NetStats.Enable."); }
+
+    NetworkStatsRows rows;
+    sNetworkStats.CollectRows(rows, csv ? 0 : 10);
+
+    if (csv)
+        { SendSysMessage("category,name,count,bytes,raw_bytes"); }
+    else
+        { PSendSysMessage("Top opcodes, output queues and fields, fields sampled in 1 of %u values blocks:", sWorld.getConfig(CONFIG_UINT32_NETSTATS_FIELD_SAMPLE_RATE)); }
+
+    for (NetworkStatsRows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        if (csv)
+        {
+            PSendSysMessage("%s,%s," UI64FMTD "," UI64FMTD "," UI64FMTD, itr->category, itr->name.c_str(), itr->count, itr->bytes, itr->rawBytes);
+            continue;
+        }
+
+        if (strcmp(itr->category, "field") != 0)
+            { PSendSysMessage("  %s %s: " UI64FMTD " packets, " UI64FMTD " bytes (" UI64FMTD " raw)", itr->category, itr->name.c_str(), itr->count, itr->bytes, itr->rawBytes); }
+        else
+            { PSendSysMessage("  %s %s: " UI64FMTD " changes", itr->category, itr->name.c_str(), itr->count); }
+    }
+
+    return true;
+}
+
+/// Display handler time, calls and received bytes by opcode, as comma separated values with `csv`, or the most expensive sessions
+bool ChatHandler::HandleDebugOpcodeStatsCommand(char* args)
+{
+    bool csv = false;
+    bool sessions = false;
+    if (*args)
+    {
+        if (ExtractLiteralArg(&args, "reset"))
+        {
+            sOpcodeStats.Reset();
+            SendSysMessage("Opcode statistics reset.");
+            return true;
+        }
+
+        if (ExtractLiteralArg(&args, "csv"))
+            { csv = true; }
+        else if (ExtractLiteralArg(&args, "sessions"))
+            { sessions = true; }
+        else
+            { return false; }
+    }
+
+    if (!sOpcodeStats.IsEnabled())
+        { SendSysMessage("Opcode statistics are disabled, see OpcodeStats.Enable."); }
+
+    if (sessions)
+    {
+        OpcodeStatsOutliers outliers;
+        sOpcodeStats.CollectOutliers(outliers);
+
+        PSendSysMessage("Sessions of more than %u microseconds handler time in one second:", sWorld.getConfig(CONFIG_UINT32_OPCODESTATS_OUTLIER_TIME));
+        for (OpcodeStatsOutliers::const_iterator itr = outliers.begin(); itr != outliers.end(); ++itr)
+        {
+            PSendSysMessage("  account %u %s (%s): %u us in %u calls, longest %s%s, " UI64FMTD " seconds ago", itr->accountId, itr->playerName.c_str(),
+                            itr->address.c_str(), itr->handlerTime, itr->calls, LookupOpcodeName(itr->costliestOpcode),
+                            itr->throttled ? ", throttled" : "", uint64(time(NULL) - itr->time));
+        }
+        return true;
+    }
+
+    OpcodeStatsRows rows;
+    sOpcodeStats.CollectRows(rows, csv ? 0 : 10);
+
+    uint64 seconds = std::max(uint64(time(NULL) - sOpcodeStats.GetResetTime()), uint64(1));
+    if (csv)
+        { SendSysMessage("opcode,name,world_calls,world_usec,map_calls,map_usec,max_usec,p99_usec,bytes"); }
+    else
+        { PSendSysMessage("Most expensive opcodes of the last " UI64FMTD " seconds:", seconds); }
+
+    for (OpcodeStatsRows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        OpcodeStatsCounters const& counters = itr->counters;
+        if (csv)
+        {
+            PSendSysMessage("%u,%s," UI64FMTD "," UI64FMTD "," UI64FMTD "," UI64FMTD ",%u,%u," UI64FMTD, uint32(itr->opcode), LookupOpcodeName(itr->opcode),
+                            counters.calls[OPCODE_STATS_WORLD], counters.time[OPCODE_STATS_WORLD], counters.calls[OPCODE_STATS_MAP],
+                            counters.time[OPCODE_STATS_MAP], counters.maxTime, counters.GetPercentile(99), counters.bytes);
+            continue;
+        }
+
+        PSendSysMessage("  %s: " UI64FMTD " calls (%.1f/s, " UI64FMTD " in map updates), " UI64FMTD " us, max %u us, p99 %u us, " UI64FMTD " bytes",
+                        LookupOpcodeName(itr->opcode), counters.GetCalls(), double(counters.GetCalls()) / seconds, counters.calls[OPCODE_STATS_MAP],
+                        counters.GetTime(), counters.maxTime, counters.GetPercentile(99), counters.bytes);
+    }
+
+    return true;
+}
+
+/// Record the tick profiler scopes for some seconds, the trace is written to LogsDir afterwards
+bool ChatHandler::HandleDebugProfileCommand(char* args)
+{
+    uint32 seconds;
+    if (!ExtractUInt32(&args, seconds) || !seconds)
+        { return false; }
+
+    if (!sTickProfiler.Start(seconds))
+    {
+        PSendSysMessage("The profiler still records to %s.", sTickProfiler.GetFileName().c_str());
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    PSendSysMessage("Recording %u seconds to %s.", std::min(seconds, uint32(PROFILER_MAX_SECONDS)), sTickProfiler.GetFileName().c_str());
+    return true;
+}
+
+bool ChatHandler::HandleDebugScriptHooksCommand(char* args)
+{
+    if (*args)
+    {
+        if (!ExtractLiteralArg(&args, "reset"))
+            { return false; }
+
+        sScriptHookStats.Reset();
+        SendSysMessage("Script hook statistics reset.");
+        return true;
+    }
+
+    if (!sScriptHookStats.IsEnabled())
+        { SendSysMessage("Script hook statistics are disabled, see ScriptHookStats.Enable."); }
+
+    ScriptHookStatsRows rows;
+    sScriptHookStats.CollectRows(rows, 10);
+
+    SendSysMessage("Most expensive scripts, calls and microseconds per hook:");
+    for (ScriptHookStatsRows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        std::ostringstream line;
+        line << "  " << sScriptMgr.GetScriptName(itr->scriptId) << ":";
+
+        bool first = true;
+        for (int i = 0; i < MAX_SCRIPT_HOOK; ++i)
+        {
+            if (!itr->counters.calls[i])
+                { continue; }
+
+            line << (first ? " " : ", ") << ScriptHookStats::GetHookName(ScriptHook(i)) << " " << itr->counters.calls[i]
+                 << "/" << itr->counters.time[i];
+            first = false;
+        }
+
+        SendSysMessage(line.str().c_str());
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleDebugSpellStatsCommand(char* args)
+{
+    bool csv = false;
+    if (*args)
+    {
+        if (ExtractLiteralArg(&args, "reset"))
+        {
+            sSpellStats.Reset();
+            SendSysMessage("Spell statistics reset.");
+            return true;
+        }
+
+        if (!ExtractLiteralArg(&args, "csv"))
+            { return false; }
+
+        csv = true;
+    }
+
+    if (!sSpellStats.IsEnabled())
+        { SendSysMessage("Spell statistics are disabled, see SpellStats.Enable."); }
+
+    SpellStatsRows rows;
+    sSpellStats.CollectRows(rows, csv ? 0 : 10);
+
+    if (csv)
+    {
+        std::string header = "spell,targets";
+        for (int i = 0; i < MAX_SPELL_STATS_STAGE; ++i)
+        {
+            char const* stageName = SpellStats::GetStageName(SpellStatsStage(i));
+            header += std::string(",") + stageName + "_calls," + stageName + "_usec";
+        }
+        SendSysMessage(header.c_str());
+    }
+    else
+        { SendSysMessage("Most expensive spells, calls and microseconds per stage:"); }
+
+    for (SpellStatsRows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+    {
+        std::ostringstream line;
+        if (csv)
+            { line << itr->spellId << "," << itr->counters.targets; }
+        else
+        {
+            SpellEntry const* spellInfo = sSpellStore.LookupEntry(itr->spellId);
+            line << "  " << itr->spellId << " " << (spellInfo ? spellInfo->SpellName[GetSessionDbcLocale()] : "") << ": "
+                 << itr->counters.targets << " targets";
+        }
+
+        for (int i = 0; i < MAX_SPELL_STATS_STAGE; ++i)
+        {
+            if (csv)
+                { line << "," << itr->counters.calls[i] << "," << itr->counters.time[i]; }
+            else if (itr->counters.calls[i])
+            {
+                line << ", " << SpellStats::GetStageName(SpellStatsStage(i)) << " " << itr->counters.calls[i]
+                     << "/" << itr->counters.time[i];
+            }
+        }
+
+        SendSysMessage(line.str().c_str());
+    }
+
+    return true;
+}
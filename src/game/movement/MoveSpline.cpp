@@ -64,6 +64,24 @@ namespace Movement
         return c;
     }
 
+    Vector3 MoveSpline::ComputePositionAhead(int32 msecs) const
+    {
+        MANGOS_ASSERT(Initialized());
+
+        int32 time_ahead = std::min(time_passed + msecs, Duration());
+        int32 seg_Idx = point_Idx;
+        while (seg_Idx + 1 < spline.last() && spline.length(seg_Idx + 1) <= time_ahead)
+            { ++seg_Idx; }
+
+        float u = 1.f;
+        int32 seg_time = spline.length(seg_Idx, seg_Idx + 1);
+        if (seg_time > 0)
+            { u = std::min(1.f, (time_ahead - spline.length(seg_Idx)) / (float)seg_time); }
+        Vector3 c;
+        spline.evaluate_percent(seg_Idx, u, c);
+        return c;
+    }
+
     void MoveSpline::computeFallElevation(float& el) const
     {
         float z_now = spline.getPoint(spline.first()).z - Movement::computeFallElevation(MSToSec(time_passed));
@@ -239,6 +239,14 @@ namespace Movement
              */
             Location ComputePosition() const;
 
+            /**
+             * @brief position the spline reaches msecs after the current one, the end point if msecs is beyond the end
+             *
+             * @param msecs
+             * @return Vector3
+             */
+            Vector3 ComputePositionAhead(int32 msecs) const;
+
             /**
              * @brief
              *
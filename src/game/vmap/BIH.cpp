@@ -24,6 +24,8 @@
 
 #include "BIH.h"
 
+#include <cstring>
+
 void BIH::buildHierarchy(std::vector<uint32>& tempTree, buildData& dat, BuildStats& stats)
 {
     // create space for the first node
@@ -276,6 +278,9 @@ bool BIH::readFromFile(FILE* rf)
     check += fread(&lo, sizeof(float), 3, rf);
     check += fread(&hi, sizeof(float), 3, rf);
     bounds = AABox(lo, hi);
+    mappedTree = NULL;
+    mappedObjects = NULL;
+    mappedObjectCount = 0;
     check += fread(&treeSize, sizeof(uint32), 1, rf);
     tree.resize(treeSize);
     check += fread(&tree[0], sizeof(uint32), treeSize, rf);
@@ -285,6 +290,34 @@ bool BIH::readFromFile(FILE* rf)
     return check == (3 + 3 + 2 + treeSize + count);
 }
 
+uint32 BIH::readFromMemory(const char* data, uint32 size)
+{
+    uint32 treeSize, count;
+    uint32 used = 6 * sizeof(float) + sizeof(uint32);
+    if (size < used)
+        { return 0; }
+
+    const float* box = reinterpret_cast<const float*>(data);
+    memcpy(&treeSize, data + 6 * sizeof(float), sizeof(uint32));
+    if (!treeSize || (size - used) / sizeof(uint32) <= treeSize)
+        { return 0; }
+
+    const uint32* nodes = reinterpret_cast<const uint32*>(data + used);
+    used += treeSize * sizeof(uint32);
+    memcpy(&count, data + used, sizeof(uint32));
+    used += sizeof(uint32);
+    if ((size - used) / sizeof(uint32) < count)
+        { return 0; }
+
+    tree.clear();
+    objects.clear();
+    bounds = AABox(Vector3(box[0], box[1], box[2]), Vector3(box[3], box[4], box[5]));
+    mappedTree = nodes;
+    mappedObjects = reinterpret_cast<const uint32*>(data + used);
+    mappedObjectCount = count;
+    return used + count * sizeof(uint32);
+}
+
 void BIH::BuildStats::updateLeaf(int depth, int n)
 {
     ++numLeaves;
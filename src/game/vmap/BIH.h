@@ -49,6 +49,32 @@ using G3D::Vector3;
 using G3D::AABox;
 using G3D::Ray;
 
+/**
+ * @brief tests the objects of a BIH leaf against a ray one by one
+ *
+ * Specialize it for ray callbacks that test several objects of a leaf at once.
+ * The objects of the leaf are objects[first] to objects[first + count - 1] of the tree order.
+ */
+template<class RayCallback>
+struct BIHLeafTrait
+{
+    /**
+     * @brief
+     *
+     * @return bool true if the traversal is to stop
+     */
+    static bool intersectRay(RayCallback& intersectCallback, const Ray& r, const uint32* objects, uint32 first, uint32 count, float& maxDist, bool stopAtFirst)
+    {
+        for (uint32 i = first; i < first + count; ++i)
+        {
+            bool hit = intersectCallback(r, objects[i], maxDist, stopAtFirst);
+            if (stopAtFirst && hit)
+                { return true; }
+        }
+        return false;
+    }
+};
+
 /**
  * @brief
  *
@@ -109,6 +135,9 @@ class BIH
          */
         void init_empty()
         {
+            mappedTree = NULL;
+            mappedObjects = NULL;
+            mappedObjectCount = 0;
             tree.clear();
             objects.clear();
             // create space for the first node
@@ -121,7 +150,7 @@ class BIH
          * @brief
          *
          */
-        BIH() {init_empty();}
+        BIH() : mappedTree(NULL), mappedObjects(NULL), mappedObjectCount(0) {init_empty();}
         template< class BoundsFunc, class PrimArray >
         /**
          * @brief
@@ -138,6 +167,9 @@ class BIH
                 init_empty();
                 return;
             }
+            mappedTree = NULL;
+            mappedObjects = NULL;
+            mappedObjectCount = 0;
             buildData dat;
             dat.maxPrims = leafSize;
             dat.numPrims = primitives.size();
@@ -170,7 +202,15 @@ class BIH
          *
          * @return uint32
          */
-        uint32 primCount() { return objects.size(); }
+        uint32 primCount() { return mappedTree ? mappedObjectCount : objects.size(); }
+        /**
+         * @brief objects in tree order, the objects of a leaf are next to each other
+         *
+         * Empty for a tree used in place by readFromMemory.
+         *
+         * @return const std::vector<uint32>
+         */
+        const std::vector<uint32>& getObjects() const { return objects; }
 
         template<typename RayCallback>
         /**
@@ -183,6 +223,8 @@ class BIH
          */
         void intersectRay(const Ray& r, RayCallback& intersectCallback, float& maxDist, bool stopAtFirst = false) const
         {
+            const uint32* treeNodes = getTreeNodes();
+            const uint32* treeObjects = getTreeObjects();
             float intervalMin = -1.f;
             float intervalMax = -1.f;
             Vector3 org = r.origin();
@@ -239,7 +281,7 @@ class BIH
             {
                 while (true)
                 {
-                    uint32 tn = tree[node];
+                    uint32 tn = treeNodes[node];
                     uint32 axis = (tn & (3 << 30)) >> 30;
                     bool BVH2 = tn & (1 << 29);
                     int offset = tn & ~(7 << 29);
@@ -248,8 +290,8 @@ class BIH
                         if (axis < 3)
                         {
                             // "normal" interior node
-                            float tf = (intBitsToFloat(tree[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
-                            float tb = (intBitsToFloat(tree[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
+                            float tf = (intBitsToFloat(treeNodes[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
+                            float tb = (intBitsToFloat(treeNodes[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
                             // ray passes between clip zones
                             if (tf < intervalMin && tb > intervalMax)
                                 { break; }
@@ -281,14 +323,9 @@ class BIH
                         else
                         {
                             // leaf - test some objects
-                            int n = tree[node + 1];
-                            while (n > 0)
-                            {
-                                bool hit = intersectCallback(r, objects[offset], maxDist, stopAtFirst);
-                                if (stopAtFirst && hit) { return; }
-                                --n;
-                                ++offset;
-                            }
+                            uint32 n = treeNodes[node + 1];
+                            if (n > 0 && BIHLeafTrait<RayCallback>::intersectRay(intersectCallback, r, treeObjects, offset, n, maxDist, stopAtFirst))
+                                { return; }
                             break;
                         }
                     }
@@ -296,8 +333,8 @@ class BIH
                     {
                         if (axis > 2)
                             { return; } // should not happen
-                        float tf = (intBitsToFloat(tree[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
-                        float tb = (intBitsToFloat(tree[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
+                        float tf = (intBitsToFloat(treeNodes[node + offsetFront[axis]]) - org[axis]) * invDir[axis];
+                        float tb = (intBitsToFloat(treeNodes[node + offsetBack[axis]]) - org[axis]) * invDir[axis];
                         node = offset;
                         intervalMin = (tf >= intervalMin) ? tf : intervalMin;
                         intervalMax = (tb <= intervalMax) ? tb : intervalMax;
@@ -333,6 +370,8 @@ class BIH
          */
         void intersectPoint(const Vector3& p, IsectCallback& intersectCallback) const
         {
+            const uint32* treeNodes = getTreeNodes();
+            const uint32* treeObjects = getTreeObjects();
             if (!bounds.contains(p))
                 { return; }
 
@@ -344,7 +383,7 @@ class BIH
             {
                 while (true)
                 {
-                    uint32 tn = tree[node];
+                    uint32 tn = treeNodes[node];
                     uint32 axis = (tn & (3 << 30)) >> 30;
                     bool BVH2 = tn & (1 << 29);
                     int offset = tn & ~(7 << 29);
@@ -353,8 +392,8 @@ class BIH
                         if (axis < 3)
                         {
                             // "normal" interior node
-                            float tl = intBitsToFloat(tree[node + 1]);
-                            float tr = intBitsToFloat(tree[node + 2]);
+                            float tl = intBitsToFloat(treeNodes[node + 1]);
+                            float tr = intBitsToFloat(treeNodes[node + 2]);
                             // point is between clip zones
                             if (tl < p[axis] && tr > p[axis])
                                 { break; }
@@ -380,10 +419,10 @@ class BIH
                         else
                         {
                             // leaf - test some objects
-                            int n = tree[node + 1];
+                            int n = treeNodes[node + 1];
                             while (n > 0)
                             {
-                                intersectCallback(p, objects[offset]); // !!!
+                                intersectCallback(p, treeObjects[offset]); // !!!
                                 --n;
                                 ++offset;
                             }
@@ -394,8 +433,8 @@ class BIH
                     {
                         if (axis > 2)
                             { return; } // should not happen
-                        float tl = intBitsToFloat(tree[node + 1]);
-                        float tr = intBitsToFloat(tree[node + 2]);
+                        float tl = intBitsToFloat(treeNodes[node + 1]);
+                        float tr = intBitsToFloat(treeNodes[node + 2]);
                         node = offset;
                         if (tl > p[axis] || tr < p[axis])
                             { break; }
@@ -426,11 +465,25 @@ class BIH
          * @return bool
          */
         bool readFromFile(FILE* rf);
+        /**
+         * @brief uses a tree stored like by writeToFile in place, the memory has to outlive the tree
+         *
+         * @param data start of the tree, 4 byte aligned
+         * @param size bytes available from data on
+         * @return uint32 bytes used by the tree, 0 if the data is too short
+         */
+        uint32 readFromMemory(const char* data, uint32 size);
 
     protected:
         std::vector<uint32> tree; /**< TODO */
         std::vector<uint32> objects; /**< TODO */
         AABox bounds; /**< TODO */
+        const uint32* mappedTree;                           // tree and objects used in place, NULL if owned
+        const uint32* mappedObjects;
+        uint32 mappedObjectCount;
+
+        const uint32* getTreeNodes() const { return mappedTree ? mappedTree : (tree.empty() ? NULL : &tree[0]); }
+        const uint32* getTreeObjects() const { return mappedTree ? mappedObjects : (objects.empty() ? NULL : &objects[0]); }
 
         /**
          * @brief
@@ -26,7 +26,6 @@
 
 #include <G3D/Table.h>
 #include <G3D/Array.h>
-#include <G3D/Set.h>
 #include "BIH.h"
 
 template<class T, class BoundsFunc = BoundsTrait<T> >
@@ -89,11 +88,21 @@ class BIHWrap
          */
         typedef G3D::Array<const T*> ObjArray;
 
+        /**
+         * @brief changes kept out of the tree until it is rebuilt
+         *
+         */
+        enum
+        {
+            MAX_PENDING_OBJECTS = 8,                        // tested one by one besides the tree
+            MIN_REMOVED_OBJECTS = 8                         // and half of the tree, skipped in the tree
+        };
+
         BIH m_tree; /**< TODO */
-        ObjArray m_objects; /**< TODO */
-        G3D::Table<const T*, uint32> m_obj2Idx; /**< TODO */
-        G3D::Set<const T*> m_objects_to_push; /**< TODO */
-        int unbalanced_times; /**< TODO */
+        ObjArray m_objects; /**< objects of the tree by index, NULL for removed ones */
+        G3D::Table<const T*, uint32> m_obj2Idx; /**< index in m_objects of the objects in the tree */
+        ObjArray m_pending; /**< objects inserted since the tree was built */
+        int m_removed; /**< NULL entries in m_objects */
 
     public:
 
@@ -101,17 +110,16 @@ class BIHWrap
          * @brief
          *
          */
-        BIHWrap() : unbalanced_times(0) {}
+        BIHWrap() : m_removed(0) {}
 
         /**
-         * @brief
+         * @brief the object is found by the queries at once, the tree is not rebuilt
          *
          * @param obj
          */
         void insert(const T& obj)
         {
-            ++unbalanced_times;
-            m_objects_to_push.insert(&obj);
+            m_pending.append(&obj);
         }
 
         /**
@@ -121,28 +129,61 @@ class BIHWrap
          */
         void remove(const T& obj)
         {
-            ++unbalanced_times;
             uint32 Idx = 0;
             const T* temp;
             if (m_obj2Idx.getRemove(&obj, temp, Idx))
-                { m_objects[Idx] = NULL; }
+            {
+                // the tree keeps the leaf, the queries skip it
+                m_objects[Idx] = NULL;
+                ++m_removed;
+            }
             else
-                { m_objects_to_push.remove(&obj); }
+            {
+                int pendingIdx = m_pending.findIndex(&obj);
+                if (pendingIdx >= 0)
+                    { m_pending.fastRemove(pendingIdx); }
+            }
         }
 
         /**
-         * @brief
+         * @brief changes since the last build
+         *
+         * @return bool
+         */
+        bool isUnbalanced() const { return m_pending.size() || m_removed; }
+
+        /**
+         * @brief so many changes that the queries become slower than with a new tree
+         *
+         * @return bool
+         */
+        bool needsBalance() const
+        {
+            return m_pending.size() > MAX_PENDING_OBJECTS || (m_removed >= MIN_REMOVED_OBJECTS && m_removed * 2 >= m_objects.size());
+        }
+
+        /**
+         * @brief builds the tree of the current objects
          *
          */
         void balance()
         {
-            if (unbalanced_times == 0)
+            if (!isUnbalanced())
                 { return; }
 
-            unbalanced_times = 0;
-            m_objects.fastClear();
-            m_obj2Idx.getKeys(m_objects);
-            m_objects_to_push.getMembers(m_objects);
+            ObjArray objects;
+            for (int i = 0; i < m_objects.size(); ++i)
+                if (m_objects[i])
+                    { objects.append(m_objects[i]); }
+            objects.append(m_pending);
+
+            m_objects.swap(objects);
+            m_pending.fastClear();
+            m_removed = 0;
+
+            m_obj2Idx.clear();
+            for (int i = 0; i < m_objects.size(); ++i)
+                { m_obj2Idx.set(m_objects[i], uint32(i)); }
 
             m_tree.build(m_objects, BoundsFunc::getBounds2);
         }
@@ -159,6 +200,9 @@ class BIHWrap
         {
             MDLCallback<RayCallback> temp_cb(intersectCallback, m_objects.getCArray());
             m_tree.intersectRay(r, temp_cb, maxDist, true);
+
+            for (int i = 0; i < m_pending.size(); ++i)
+                { intersectCallback(r, *m_pending[i], maxDist); }
         }
 
         template<typename IsectCallback>
@@ -172,5 +216,8 @@ class BIHWrap
         {
             MDLCallback<IsectCallback> temp_cb(intersectCallback, m_objects.getCArray());
             m_tree.intersectPoint(p, temp_cb);
+
+            for (int i = 0; i < m_pending.size(); ++i)
+                { intersectCallback(p, *m_pending[i]); }
         }
 };
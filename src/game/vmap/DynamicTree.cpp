@@ -62,10 +62,12 @@ struct DynTreeImpl : public ParentTree/*, public Intersectable*/
 {
     typedef GameObjectModel Model;
     typedef ParentTree base;
+    typedef BIHWrap<GameObjectModel> Node;
 
     DynTreeImpl() :
         rebalance_timer(CHECK_TREE_PERIOD),
-        unbalanced_times(0)
+        unbalanced_times(0),
+        next_cell(0)
     {
     }
 
@@ -97,12 +99,45 @@ struct DynTreeImpl : public ParentTree/*, public Intersectable*/
         {
             rebalance_timer.Reset(CHECK_TREE_PERIOD);
             if (unbalanced_times > 0)
-                { balance(); }
+                { balanceCells(); }
         }
     }
 
+    /**
+     * The cells find changed objects without a new tree, so only cells with many changes are
+     * rebuilt at once. Of the others one is rebuilt per check, mass spawns at battleground start
+     * are spread over the following updates instead of rebuilding every cell in one tick.
+     */
+    void balanceCells()
+    {
+        const int cellCount = CELL_NUMBER * CELL_NUMBER;
+        bool rebuiltOne = false;
+        int unbalanced = 0;
+
+        for (int i = 0; i < cellCount; ++i)
+        {
+            int cell = (next_cell + i) % cellCount;
+            Node* node = nodes[cell / CELL_NUMBER][cell % CELL_NUMBER];
+            if (!node || !node->isUnbalanced())
+                { continue; }
+
+            if (!rebuiltOne || node->needsBalance())
+            {
+                if (!rebuiltOne)
+                    { next_cell = (cell + 1) % cellCount; }
+                node->balance();
+                rebuiltOne = true;
+            }
+            else
+                { ++unbalanced; }
+        }
+
+        unbalanced_times = unbalanced;
+    }
+
     ShortTimeTracker rebalance_timer;
-    int unbalanced_times;
+    int unbalanced_times;                                   // changes or cells with changes to put into the trees
+    int next_cell;                                          // round robin start of balanceCells
 };
 
 DynamicMapTree::DynamicMapTree() : impl(*new DynTreeImpl())
@@ -147,11 +182,14 @@ void DynamicMapTree::update(uint32 t_diff)
 struct DynamicTreeIntersectionCallback
 {
     bool did_hit;
-    DynamicTreeIntersectionCallback() : did_hit(false) {}
+    bool stopAtFirstHit;                                    // line of sight, the models may use their simplified meshes
+    explicit DynamicTreeIntersectionCallback(bool stopAtFirst) : did_hit(false), stopAtFirstHit(stopAtFirst) {}
     bool operator()(const G3D::Ray& r, const GameObjectModel& obj, float& distance)
     {
-        did_hit = obj.intersectRay(r, distance, true);
-        return did_hit;
+        // a miss of a later object must not forget an earlier hit
+        bool hit = obj.intersectRay(r, distance, stopAtFirstHit);
+        did_hit = did_hit || hit;
+        return hit;
     }
     bool didHit() const { return did_hit;}
 };
@@ -186,7 +224,7 @@ Else, pMaxDist is not modified and returns false;
 bool DynamicMapTree::getIntersectionTime(const G3D::Ray& ray, const Vector3& endPos, float& pMaxDist) const
 {
     float distance = pMaxDist;
-    DynamicTreeIntersectionCallback callback;
+    DynamicTreeIntersectionCallback callback(false);
     impl.intersectRay(ray, callback, distance, endPos);
     if (callback.didHit())
         { pMaxDist = distance; }
@@ -264,7 +302,7 @@ bool DynamicMapTree::isInLineOfSight(float x1, float y1, float z1, float x2, flo
         { return true; }
 
     G3D::Ray r(v1, (v2 - v1) / maxDist);
-    DynamicTreeIntersectionCallback callback;
+    DynamicTreeIntersectionCallback callback(true);
     impl.intersectRay(r, callback, maxDist, v2);
 
     return !callback.did_hit;
@@ -274,7 +312,7 @@ float DynamicMapTree::getHeight(float x, float y, float z, float maxSearchDist)
 {
     Vector3 v(x, y, z);
     G3D::Ray r(v, Vector3(0, 0, -1));
-    DynamicTreeIntersectionCallback callback;
+    DynamicTreeIntersectionCallback callback(false);
     impl.intersectZAllignedRay(r, callback, maxSearchDist);
 
     if (callback.didHit())
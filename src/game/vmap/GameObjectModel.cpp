@@ -101,9 +101,9 @@ GameObjectModel::~GameObjectModel()
         { ((VMAP::VMapManager2*)VMAP::VMapFactory::createOrGetVMapManager())->releaseModelInstance(name); }
 }
 
-bool GameObjectModel::initialize(const GameObject* const pGo, const GameObjectDisplayInfoEntry* const pDisplayInfo)
+bool GameObjectModel::initialize(uint32 displayId, const Vector3& pos, float orientation, float scale)
 {
-    ModelList::const_iterator it = model_list.find(pDisplayInfo->Displayid);
+    ModelList::const_iterator it = model_list.find(displayId);
     if (it == model_list.end())
         { return false; }
 
@@ -121,12 +121,12 @@ bool GameObjectModel::initialize(const GameObject* const pGo, const GameObjectDi
         { return false; }
 
     name = it->second.name;
-    iPos = Vector3(pGo->GetPositionX(), pGo->GetPositionY(), pGo->GetPositionZ());
+    iPos = pos;
     collision_enabled = true;
-    iScale = pGo->GetObjectScale();
+    iScale = scale;
     iInvScale = 1.f / iScale;
 
-    G3D::Matrix3 iRotation = G3D::Matrix3::fromEulerAnglesZYX(pGo->GetOrientation(), 0, 0);
+    G3D::Matrix3 iRotation = G3D::Matrix3::fromEulerAnglesZYX(orientation, 0, 0);
     iInvRot = iRotation.inverse();
     // transform bounding box:
     mdl_box = AABox(mdl_box.low() * iScale, mdl_box.high() * iScale);
@@ -136,11 +136,23 @@ bool GameObjectModel::initialize(const GameObject* const pGo, const GameObjectDi
 
     this->iBound = rotated_bounds + iPos;
 
+    return true;
+}
+
+GameObjectModel* GameObjectModel::construct(const GameObject* const pGo)
+{
+    const GameObjectDisplayInfoEntry* info = sGameObjectDisplayInfoStore.LookupEntry(pGo->GetDisplayId());
+    if (!info)
+        { return NULL; }
+
+    GameObjectModel* mdl = construct(info->Displayid, Vector3(pGo->GetPositionX(), pGo->GetPositionY(), pGo->GetPositionZ()),
+                                     pGo->GetOrientation(), pGo->GetObjectScale());
+
 #ifdef SPAWN_CORNERS
     // test:
-    for (int i = 0; i < 8; ++i)
+    for (int i = 0; mdl && i < 8; ++i)
     {
-        Vector3 pos(iBound.corner(i));
+        Vector3 pos(mdl->iBound.corner(i));
         if (Creature* c = const_cast<GameObject*>(pGo)->SummonCreature(24440, pos.x, pos.y, pos.z, 0, TEMPSUMMON_MANUAL_DESPAWN, 0))
         {
             c->setFaction(35);
@@ -149,17 +161,13 @@ bool GameObjectModel::initialize(const GameObject* const pGo, const GameObjectDi
     }
 #endif
 
-    return true;
+    return mdl;
 }
 
-GameObjectModel* GameObjectModel::construct(const GameObject* const pGo)
+GameObjectModel* GameObjectModel::construct(uint32 displayId, const Vector3& pos, float orientation, float scale)
 {
-    const GameObjectDisplayInfoEntry* info = sGameObjectDisplayInfoStore.LookupEntry(pGo->GetDisplayId());
-    if (!info)
-        { return NULL; }
-
     GameObjectModel* mdl = new GameObjectModel();
-    if (!mdl->initialize(pGo, info))
+    if (!mdl->initialize(displayId, pos, orientation, scale))
     {
         delete mdl;
         return NULL;
@@ -62,11 +62,13 @@ class GameObjectModel
         /**
          * @brief
          *
-         * @param pGo
-         * @param info
+         * @param displayId
+         * @param pos
+         * @param orientation
+         * @param scale
          * @return bool
          */
-        bool initialize(const GameObject* const pGo, const GameObjectDisplayInfoEntry* info);
+        bool initialize(uint32 displayId, const G3D::Vector3& pos, float orientation, float scale);
 
     public:
         std::string name; /**< TODO */
@@ -121,5 +123,15 @@ class GameObjectModel
          * @return GameObjectModel
          */
         static GameObjectModel* construct(const GameObject* const pGo);
+        /**
+         * @brief model of a display without a gameobject, for tools like the collision benchmark
+         *
+         * @param displayId GameObjectDisplayInfoEntry::Displayid
+         * @param pos
+         * @param orientation
+         * @param scale
+         * @return GameObjectModel NULL if the display has no model
+         */
+        static GameObjectModel* construct(uint32 displayId, const G3D::Vector3& pos, float orientation, float scale);
 };
 #endif
@@ -28,9 +28,13 @@
 #include "VMapDefinitions.h"
 
 #include <set>
+#include <deque>
 #include <iomanip>
 #include <sstream>
-#include <iomanip>
+
+#include <ace/Task.h>
+#include <ace/Guard_T.h>
+#include <ace/Condition_Thread_Mutex.h>
 
 using G3D::Vector3;
 using G3D::AABox;
@@ -63,6 +67,8 @@ namespace VMAP
     {
         iCurrentUniqueNameId = 0;
         iFilterMethod = NULL;
+        iLosError = 0.0f;
+        iThreads = 1;
         iSrcDir = pSrcDirName;
         iDestDir = pDestDirName;
         // mkdir(iDestDir);
@@ -74,134 +80,231 @@ namespace VMAP
         // delete iCoordModelMapping;
     }
 
-    bool TileAssembler::convertWorld2()
+    /**
+     * @brief the maps, then the models they spawn, converted by a pool of threads
+     *
+     * A model is queued once, when the first map spawning it is written. The threads
+     * only write files nobody else writes, so the output is the same for any count.
+     */
+    class AssemblyQueue : public ACE_Task_Base
     {
-        bool success = readMapSpawns();
-        if (!success)
-            { return false; }
+        public:
+            AssemblyQueue(TileAssembler& assembler, MapData& maps) :
+                m_assembler(assembler), m_maps(maps), m_nextMap(maps.begin()), m_condition(m_lock), m_busy(0), m_failed(false) {}
 
-        // export Map data
-        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end() && success; ++map_iter)
-        {
-            // build global map tree
-            std::vector<ModelSpawn*> mapSpawns;
-            UniqueEntryMap::iterator entry;
-            printf("Calculating model bounds for map %u...\n", map_iter->first);
-            for (entry = map_iter->second->UniqueEntries.begin(); entry != map_iter->second->UniqueEntries.end(); ++entry)
+            bool AddModel(std::string const& name)
             {
-                // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
-                if (entry->second.flags & MOD_M2)
-                {
-                    if (!calculateTransformedBound(entry->second))
-                        { break; }
-                }
-                else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
-                {
-                    // TODO: remove extractor hack and uncomment below line:
-                    // entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
-                    entry->second.iBound = entry->second.iBound + Vector3(533.33333f * 32, 533.33333f * 32, 0.f);
-                }
-                mapSpawns.push_back(&(entry->second));
-                spawnedModelFiles.insert(entry->second.name);
-            }
+                ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+                if (!m_knownModels.insert(name).second)
+                    { return false; }
 
-            printf("Creating map tree...\n");
-            BIH pTree;
-            pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
-
-            // ===> possibly move this code to StaticMapTree class
-            std::map<uint32, uint32> modelNodeIdx;
-            for (uint32 i = 0; i < mapSpawns.size(); ++i)
-                { modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i)); }
-
-            // write map tree file
-            std::stringstream mapfilename;
-            mapfilename << iDestDir << "/" << std::setfill('0') << std::setw(3) << map_iter->first << ".vmtree";
-            FILE* mapfile = fopen(mapfilename.str().c_str(), "wb");
-            if (!mapfile)
-            {
-                success = false;
-                printf("Can not open %s\n", mapfilename.str().c_str());
-                break;
+                m_models.push_back(name);
+                m_condition.signal();
+                return true;
             }
 
-            // general info
-            if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) { success = false; }
-            uint32 globalTileID = StaticMapTree::packTileID(65, 65);
-            pair<TileMap::iterator, TileMap::iterator> globalRange = map_iter->second->TileEntries.equal_range(globalTileID);
-            char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
-            if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) { success = false; }
-            // Nodes
-            if (success && fwrite("NODE", 4, 1, mapfile) != 1) { success = false; }
-            if (success) { success = pTree.writeToFile(mapfile); }
-            // global map spawns (WDT), if any (most instances)
-            if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) { success = false; }
-
-            for (TileMap::iterator glob = globalRange.first; glob != globalRange.second && success; ++glob)
+            bool Run(uint32 threads)
             {
-                success = ModelSpawn::writeToFile(mapfile, map_iter->second->UniqueEntries[glob->second]);
-            }
-
-            fclose(mapfile);
+                if (threads < 2 || activate(THR_NEW_LWP | THR_JOINABLE, int(threads)) == -1)
+                    { svc(); }
+                else
+                    { wait(); }
 
-            // <====
+                return !m_failed;
+            }
 
-            // write map tile files, similar to ADT files, only with extra BSP tree node info
-            TileMap& tileEntries = map_iter->second->TileEntries;
-            TileMap::iterator tile;
-            for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
+            int svc() override
             {
-                const ModelSpawn& spawn = map_iter->second->UniqueEntries[tile->second];
-                if (spawn.flags & MOD_WORLDSPAWN)           // WDT spawn, saved as tile 65/65 currently...
-                    { continue; }
-                uint32 nSpawns = tileEntries.count(tile->first);
-                std::stringstream tilefilename;
-                tilefilename.fill('0');
-                tilefilename << iDestDir << "/" << std::setw(3) << map_iter->first << "_";
-                uint32 x, y;
-                StaticMapTree::unpackTileID(tile->first, x, y);
-                tilefilename << std::setw(2) << x << "_" << std::setw(2) << y << ".vmtile";
-                FILE* tilefile = fopen(tilefilename.str().c_str(), "wb");
-                // file header
-                if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) { success = false; }
-                // write number of tile spawns
-                if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) { success = false; }
-                // write tile spawns
-                for (uint32 s = 0; s < nSpawns; ++s)
+                for (;;)
                 {
-                    if (s && tile != tileEntries.end())
-                        { ++tile; }
-                    const ModelSpawn& spawn2 = map_iter->second->UniqueEntries[tile->second];
-                    success = success && ModelSpawn::writeToFile(tilefile, spawn2);
-                    // MapTree nodes to update when loading tile:
-                    std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
-                    if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) { success = false; }
+                    MapData::iterator map;
+                    std::string model;
+
+                    {
+                        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+                        // a map still being written may queue more models
+                        while (!m_failed && m_nextMap == m_maps.end() && m_models.empty() && m_busy)
+                            { m_condition.wait(); }
+
+                        if (m_failed || (m_nextMap == m_maps.end() && m_models.empty()))
+                        {
+                            m_condition.broadcast();
+                            break;
+                        }
+
+                        map = m_nextMap;
+                        if (map != m_maps.end())
+                            { ++m_nextMap; }
+                        else
+                        {
+                            model = m_models.front();
+                            m_models.pop_front();
+                        }
+
+                        ++m_busy;
+                    }
+
+                    bool success;
+                    std::set<std::string> modelFiles;
+                    if (map != m_maps.end())
+                        { success = m_assembler.exportMap(map->first, *map->second, modelFiles); }
+                    else
+                    {
+                        printf("Converting %s\n", model.c_str());
+                        success = m_assembler.convertRawFile(model);
+                        if (!success)
+                            { printf("error converting %s\n", model.c_str()); }
+                    }
+
+                    for (std::set<std::string>::const_iterator itr = modelFiles.begin(); itr != modelFiles.end(); ++itr)
+                        { AddModel(*itr); }
+
+                    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+                    --m_busy;
+                    if (!success)
+                        { m_failed = true; }
+                    m_condition.broadcast();
                 }
-                fclose(tilefile);
+
+                return 0;
             }
-            // break; // test, extract only first map; TODO: remvoe this line
-        }
+
+        private:
+            TileAssembler& m_assembler;
+            MapData& m_maps;
+            MapData::iterator m_nextMap;                    // maps are written before the models
+            std::deque<std::string> m_models;
+            std::set<std::string> m_knownModels;            // queued or converted already
+            ACE_Thread_Mutex m_lock;
+            ACE_Condition_Thread_Mutex m_condition;
+            uint32 m_busy;                                  // jobs being run
+            bool m_failed;
+    };
+
+    bool TileAssembler::convertWorld2()
+    {
+        bool success = readMapSpawns();
+        if (!success)
+            { return false; }
 
         // add an object models, listed in temp_gameobject_models file
         exportGameobjectModels();
 
-        // export objects
-        std::cout << "\nConverting Model Files" << std::endl;
-        for (std::set<std::string>::iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
+        AssemblyQueue queue(*this, mapData);
+        for (std::set<std::string>::const_iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
+            { queue.AddModel(*mfile); }
+
+        // export map data and objects
+        printf("\nConverting %u maps and their models on %u threads\n", uint32(mapData.size()), iThreads);
+        success = queue.Run(iThreads);
+
+        // cleanup:
+        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+        {
+            delete map_iter->second;
+        }
+        return success;
+    }
+
+    bool TileAssembler::exportMap(uint32 pMapId, MapSpawns& pSpawns, std::set<std::string>& pModelFiles)
+    {
+        bool success = true;
+
+        // build global map tree
+        std::vector<ModelSpawn*> mapSpawns;
+        UniqueEntryMap::iterator entry;
+        printf("Calculating model bounds for map %u...\n", pMapId);
+        for (entry = pSpawns.UniqueEntries.begin(); entry != pSpawns.UniqueEntries.end(); ++entry)
         {
-            std::cout << "Converting " << *mfile << std::endl;
-            if (!convertRawFile(*mfile))
+            // M2 models don't have a bound set in WDT/ADT placement data, i still think they're not used for LoS at all on retail
+            if (entry->second.flags & MOD_M2)
             {
-                std::cout << "error converting " << *mfile << std::endl;
-                success = false;
-                break;
+                if (!calculateTransformedBound(entry->second))
+                    { break; }
+            }
+            else if (entry->second.flags & MOD_WORLDSPAWN) // WMO maps and terrain maps use different origin, so we need to adapt :/
+            {
+                // TODO: remove extractor hack and uncomment below line:
+                // entry->second.iPos += Vector3(533.33333f*32, 533.33333f*32, 0.f);
+                entry->second.iBound = entry->second.iBound + Vector3(533.33333f * 32, 533.33333f * 32, 0.f);
             }
+            mapSpawns.push_back(&(entry->second));
+            pModelFiles.insert(entry->second.name);
         }
 
-        // cleanup:
-        for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
+        printf("Creating map tree...\n");
+        BIH pTree;
+        pTree.build(mapSpawns, BoundsTrait<ModelSpawn*>::getBounds);
+
+        // ===> possibly move this code to StaticMapTree class
+        std::map<uint32, uint32> modelNodeIdx;
+        for (uint32 i = 0; i < mapSpawns.size(); ++i)
+            { modelNodeIdx.insert(pair<uint32, uint32>(mapSpawns[i]->ID, i)); }
+
+        // write map tree file
+        std::stringstream mapfilename;
+        mapfilename << iDestDir << "/" << std::setfill('0') << std::setw(3) << pMapId << ".vmtree";
+        FILE* mapfile = fopen(mapfilename.str().c_str(), "wb");
+        if (!mapfile)
         {
-            delete map_iter->second;
+            printf("Can not open %s\n", mapfilename.str().c_str());
+            return false;
+        }
+
+        // general info
+        if (success && fwrite(VMAP_MAGIC, 1, 8, mapfile) != 8) { success = false; }
+        uint32 globalTileID = StaticMapTree::packTileID(65, 65);
+        pair<TileMap::iterator, TileMap::iterator> globalRange = pSpawns.TileEntries.equal_range(globalTileID);
+        char isTiled = globalRange.first == globalRange.second; // only maps without terrain (tiles) have global WMO
+        if (success && fwrite(&isTiled, sizeof(char), 1, mapfile) != 1) { success = false; }
+        // Nodes
+        if (success && fwrite("NODE", 4, 1, mapfile) != 1) { success = false; }
+        if (success) { success = pTree.writeToFile(mapfile); }
+        // global map spawns (WDT), if any (most instances)
+        if (success && fwrite("GOBJ", 4, 1, mapfile) != 1) { success = false; }
+
+        for (TileMap::iterator glob = globalRange.first; glob != globalRange.second && success; ++glob)
+        {
+            success = ModelSpawn::writeToFile(mapfile, pSpawns.UniqueEntries[glob->second]);
+        }
+
+        fclose(mapfile);
+
+        // <====
+
+        // write map tile files, similar to ADT files, only with extra BSP tree node info
+        TileMap& tileEntries = pSpawns.TileEntries;
+        TileMap::iterator tile;
+        for (tile = tileEntries.begin(); tile != tileEntries.end(); ++tile)
+        {
+            const ModelSpawn& spawn = pSpawns.UniqueEntries[tile->second];
+            if (spawn.flags & MOD_WORLDSPAWN)               // WDT spawn, saved as tile 65/65 currently...
+                { continue; }
+            uint32 nSpawns = tileEntries.count(tile->first);
+            std::stringstream tilefilename;
+            tilefilename.fill('0');
+            tilefilename << iDestDir << "/" << std::setw(3) << pMapId << "_";
+            uint32 x, y;
+            StaticMapTree::unpackTileID(tile->first, x, y);
+            tilefilename << std::setw(2) << x << "_" << std::setw(2) << y << ".vmtile";
+            FILE* tilefile = fopen(tilefilename.str().c_str(), "wb");
+            // file header
+            if (success && fwrite(VMAP_MAGIC, 1, 8, tilefile) != 8) { success = false; }
+            // write number of tile spawns
+            if (success && fwrite(&nSpawns, sizeof(uint32), 1, tilefile) != 1) { success = false; }
+            // write tile spawns
+            for (uint32 s = 0; s < nSpawns; ++s)
+            {
+                if (s && tile != tileEntries.end())
+                    { ++tile; }
+                const ModelSpawn& spawn2 = pSpawns.UniqueEntries[tile->second];
+                success = success && ModelSpawn::writeToFile(tilefile, spawn2);
+                // MapTree nodes to update when loading tile:
+                std::map<uint32, uint32>::iterator nIdx = modelNodeIdx.find(spawn2.ID);
+                if (success && fwrite(&nIdx->second, sizeof(uint32), 1, tilefile) != 1) { success = false; }
+            }
+            fclose(tilefile);
         }
         return success;
     }
@@ -330,7 +433,7 @@ namespace VMAP
             model.setGroupModels(groupsArray);
         }
 
-        success = model.writeFile(iDestDir + "/" + pModelFilename + ".vmo");
+        success = model.writeMappedFile(iDestDir + "/" + pModelFilename + ".vmo", iLosError);
 
         //std::cout << "readRawFile2: '" << pModelFilename << "' tris: " << nElements << " nodes: " << nNodes << std::endl;
         return success;
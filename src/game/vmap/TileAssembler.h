@@ -171,6 +171,8 @@ namespace VMAP
             unsigned int iCurrentUniqueNameId; /**< TODO */
             MapData mapData; /**< TODO */
             std::set<std::string> spawnedModelFiles; /**< TODO */
+            float iLosError;                                /**< see setLosError */
+            uint32 iThreads;                                /**< see setThreads */
 
         public:
             /**
@@ -192,6 +194,17 @@ namespace VMAP
              * @return bool
              */
             bool convertWorld2();
+            /**
+             * @brief writes the map tree and the tile files of one map
+             *
+             * Called by several threads at once for different maps.
+             *
+             * @param pMapId
+             * @param pSpawns spawns of the map, the M2 bounds are calculated here
+             * @param pModelFiles receives the names of the models the map spawns
+             * @return bool
+             */
+            bool exportMap(uint32 pMapId, MapSpawns& pSpawns, std::set<std::string>& pModelFiles);
             /**
              * @brief
              *
@@ -224,6 +237,18 @@ namespace VMAP
              * @param )
              */
             void setModelNameFilterMethod(bool (*pFilterMethod)(char* pName)) { iFilterMethod = pFilterMethod; }
+            /**
+             * @brief writes simplified group meshes for line of sight checks to the model files
+             *
+             * @param pLosError largest vertex offset of the simplified meshes in yards, 0 writes none
+             */
+            void setLosError(float pLosError) { iLosError = pLosError; }
+            /**
+             * @brief converts maps and models on several threads, the output does not depend on the count
+             *
+             * @param pThreads
+             */
+            void setThreads(uint32 pThreads) { iThreads = pThreads ? pThreads : 1; }
             /**
              * @brief
              *
@@ -32,6 +32,7 @@
 namespace VMAP
 {
     const char VMAP_MAGIC[] = "VMAP_4.0";                       /**< used in final vmap files */
+    const char VMAP_MAPPED_MAGIC[] = "VMAP_5.1";                /**< model files used in place, see WorldModel::writeMappedFile */
     const char RAW_VMAP_MAGIC[] = "VMAPz05";                    /**< used in extracted vmap files with raw data */
     const char GAMEOBJECT_MODELS[] = "temp_gameobject_models";  /**< TODO */
 
@@ -31,6 +31,11 @@
 #include "ModelInstance.h"
 #include "WorldModel.h"
 #include "VMapDefinitions.h"
+#ifndef NO_CORE_FUNCS
+#include "MemoryTracker.h"
+#endif
+
+#include <ace/OS_NS_sys_stat.h>
 
 using G3D::Vector3;
 
@@ -266,6 +271,14 @@ namespace VMAP
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "VMapManager2: loading file '%s%s'.", basepath.c_str(), filename.c_str());
             model = iLoadedModelFiles.insert(std::pair<std::string, ManagedModel>(filename, ManagedModel())).first;
             model->second.setModel(worldmodel);
+
+            // mapped model files are used in place and the read ones take about their size
+            ACE_stat fileStat;
+            if (ACE_OS::stat((basepath + filename + ".vmo").c_str(), &fileStat) == 0)
+                { model->second.setFileSize(uint32(fileStat.st_size)); }
+#ifndef NO_CORE_FUNCS
+            MemoryTracker::Allocate(MEM_TAG_VMAP, model->second.getFileSize());
+#endif
         }
         model->second.incRefCount();
         return model->second.getModel();
@@ -283,6 +296,9 @@ namespace VMAP
         {
             DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "VMapManager2: unloading file '%s'", filename.c_str());
             delete model->second.getModel();
+#ifndef NO_CORE_FUNCS
+            MemoryTracker::Free(MEM_TAG_VMAP, model->second.getFileSize());
+#endif
             iLoadedModelFiles.erase(model);
         }
     }
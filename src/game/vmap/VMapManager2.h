@@ -62,7 +62,7 @@ namespace VMAP
              * @brief
              *
              */
-            ManagedModel(): iModel(0), iRefCount(0) {}
+            ManagedModel(): iModel(0), iRefCount(0), iFileSize(0) {}
             /**
              * @brief
              *
@@ -86,9 +86,17 @@ namespace VMAP
              * @return int
              */
             int decRefCount() { return --iRefCount; }
+            /**
+             * @brief size of the model file, counted as memory of the model
+             *
+             * @param size
+             */
+            void setFileSize(uint32 size) { iFileSize = size; }
+            uint32 getFileSize() const { return iFileSize; }
         protected:
             WorldModel* iModel; /**< TODO */
             int iRefCount; /**< TODO */
+            uint32 iFileSize;
     };
 
     /**
@@ -26,6 +26,19 @@
 #include "VMapDefinitions.h"
 #include "MapTree.h"
 
+#ifndef NO_CORE_FUNCS
+#include <ace/Mem_Map.h>
+#endif
+
+#include <map>
+#include <set>
+
+// SSE2 is part of every x86-64 target, other targets use the scalar loop on the same data
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VMAP_SSE_RAY_KERNEL
+#include <emmintrin.h>
+#endif
+
 using G3D::Vector3;
 using G3D::Ray;
 
@@ -252,11 +265,241 @@ namespace VMAP
         return result;
     }
 
+    bool WmoLiquid::readFromMemory(const char* data, uint32 size, WmoLiquid*& out)
+    {
+        uint32 tilesX, tilesY, type;
+        float coords[3];
+        uint32 headerSize = 3 * sizeof(uint32) + sizeof(coords);
+        if (size < headerSize)
+            { return false; }
+
+        memcpy(&tilesX, data, sizeof(uint32));
+        memcpy(&tilesY, data + sizeof(uint32), sizeof(uint32));
+        memcpy(coords, data + 2 * sizeof(uint32), sizeof(coords));
+        memcpy(&type, data + 2 * sizeof(uint32) + sizeof(coords), sizeof(uint32));
+        Vector3 corner(coords[0], coords[1], coords[2]);
+
+        // a valid tile count is below the data size, this keeps the products below 2^64
+        if (tilesX >= size || tilesY >= size)
+            { return false; }
+
+        uint64 heights = (uint64(tilesX) + 1) * (uint64(tilesY) + 1);
+        uint64 flags = uint64(tilesX) * tilesY;
+        if (heights > (size - headerSize) / sizeof(float) || flags > size - headerSize - heights * sizeof(float))
+            { return false; }
+
+        WmoLiquid* liquid = new WmoLiquid(tilesX, tilesY, corner, type);
+        memcpy(liquid->iHeight, data + headerSize, size_t(heights * sizeof(float)));
+        memcpy(liquid->iFlags, data + headerSize + heights * sizeof(float), size_t(flags));
+        out = liquid;
+        return true;
+    }
+
+    // ===================== mapped model files ==================================
+
+    /// Start of a VMAP_MAPPED_MAGIC model file, followed by the group headers and the data they point to
+    struct MappedModelHeader
+    {
+        char magic[8];
+        uint32 rootWmoId;
+        uint32 groupCount;
+        uint32 groupTreeOffset;                             // BIH of the group bounds, 0 if no groups
+        uint32 fileSize;
+    };
+
+    /// Group of a mapped model file, offsets are from the file start and 4 byte aligned
+    struct MappedGroupHeader
+    {
+        float bound[6];
+        uint32 mogpFlags;
+        uint32 groupWmoId;
+        uint32 triangleCount;
+        float quantOrigin[3];
+        float quantScale[3];
+        uint32 trianglesOffset;                             // uint16 blocks, see GroupModel::iMappedTriangles
+        uint32 meshTreeOffset;                              // BIH as written by BIH::writeToFile
+        uint32 liquidOffset;                                // 0 if the group has no liquid
+        uint32 losTriangleCount;                            // simplified mesh for line of sight, 0 if none
+        uint32 losTrianglesOffset;                          // same quantization as the full mesh
+        uint32 losTreeOffset;
+    };
+
+    /// Memory of a mapped model file. The core maps the file, the tools don't link ACE and read it.
+    class ModelFileData
+    {
+        public:
+            bool open(const std::string& filename)
+            {
+#ifndef NO_CORE_FUNCS
+                return iMap.map(filename.c_str(), static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) != -1;
+#else
+                FILE* rf = fopen(filename.c_str(), "rb");
+                if (!rf)
+                    { return false; }
+                bool result = fseek(rf, 0, SEEK_END) == 0;
+                long size = result ? ftell(rf) : -1;
+                result = size >= 0 && fseek(rf, 0, SEEK_SET) == 0;
+                if (result)
+                {
+                    iSize = uint32(size);
+                    iBuffer.resize(iSize / sizeof(uint32) + 1);  // uint32 storage keeps the data aligned
+                    result = fread(&iBuffer[0], 1, iSize, rf) == iSize;
+                }
+                fclose(rf);
+                return result;
+#endif
+            }
+
+#ifndef NO_CORE_FUNCS
+            const char* data() const { return static_cast<const char*>(iMap.addr()); }
+            uint32 size() const { return uint32(iMap.size()); }
+        private:
+            ACE_Mem_Map iMap;
+#else
+            ModelFileData() : iSize(0) {}
+            const char* data() const { return reinterpret_cast<const char*>(&iBuffer[0]); }
+            uint32 size() const { return iSize; }
+        private:
+            std::vector<uint32> iBuffer;
+            uint32 iSize;
+#endif
+    };
+
+    /// Pads the file to the next 4 byte boundary
+    static bool AlignFile(FILE* wf, uint32& offset)
+    {
+        long pos = ftell(wf);
+        if (pos < 0)
+            { return false; }
+
+        static const char padding[4] = { 0, 0, 0, 0 };
+        uint32 pad = (4 - uint32(pos) % 4) % 4;
+        if (pad && fwrite(padding, 1, pad, wf) != pad)
+            { return false; }
+
+        offset = uint32(pos) + pad;
+        return true;
+    }
+
+    /// Writes the triangles quantized to the grid of lo and scale in mesh tree order, then the tree
+    static bool WriteQuantizedMesh(FILE* wf, const std::vector<Vector3>& vertices, const std::vector<MeshTriangle>& triangles,
+                                   const Vector3& lo, const Vector3& scale, uint32& trianglesOffset, uint32& treeOffset)
+    {
+        std::vector<uint16> quantized(vertices.size() * 3);
+        std::vector<Vector3> dequantized(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                float q = scale[c] > 0.0f ? floor((vertices[i][c] - lo[c]) / scale[c] + 0.5f) : 0.0f;
+                quantized[i * 3 + c] = uint16(std::min(std::max(q, 0.0f), 65535.0f));
+                dequantized[i][c] = lo[c] + quantized[i * 3 + c] * scale[c];
+            }
+        }
+
+        // the tree is built on the quantized triangles, so its bounds contain them exactly
+        BIH tree;
+        TriBoundFunc bFunc(dequantized);
+        tree.build(triangles, bFunc);
+
+        const std::vector<uint32>& order = tree.getObjects();
+        size_t count = triangles.size();
+        std::vector<uint16> data(count * 9);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const MeshTriangle& tri = triangles[order[i]];
+            const uint32 corners[3] = { tri.idx0, tri.idx1, tri.idx2 };
+            for (int k = 0; k < 3; ++k)
+                for (int c = 0; c < 3; ++c)
+                    { data[(k * 3 + c) * count + i] = quantized[corners[k] * 3 + c]; }
+        }
+
+        if (!AlignFile(wf, trianglesOffset))
+            { return false; }
+        if (fwrite(&data[0], sizeof(uint16), data.size(), wf) != data.size())
+            { return false; }
+        if (!AlignFile(wf, treeOffset))
+            { return false; }
+        return tree.writeToFile(wf);
+    }
+
+    /**
+     * Vertex clustering: the vertices within a cube of maxError / sqrt(3) edge length are merged to
+     * their average, so no vertex moves further than maxError. Triangles collapsed by the merge and
+     * duplicates are dropped.
+     */
+    static void SimplifyMesh(const std::vector<Vector3>& vertices, const std::vector<MeshTriangle>& triangles, float maxError,
+                             std::vector<Vector3>& outVertices, std::vector<MeshTriangle>& outTriangles)
+    {
+        outVertices.clear();
+        outTriangles.clear();
+        if (vertices.empty())
+            { return; }
+
+        Vector3 lo = vertices[0];
+        for (size_t i = 1; i < vertices.size(); ++i)
+            { lo = lo.min(vertices[i]); }
+        float cell = maxError / sqrt(3.0f);
+
+        std::map<uint64, uint32> clusters;
+        std::vector<uint32> remap(vertices.size());
+        std::vector<uint32> clusterSize;
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            uint64 key = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+                float pos = floor((vertices[i][c] - lo[c]) / cell);
+                key = (key << 21) | uint64(std::min(std::max(pos, 0.0f), float(0x1FFFFF)));
+            }
+
+            std::map<uint64, uint32>::iterator itr = clusters.find(key);
+            if (itr == clusters.end())
+            {
+                itr = clusters.insert(std::make_pair(key, uint32(outVertices.size()))).first;
+                outVertices.push_back(Vector3::zero());
+                clusterSize.push_back(0);
+            }
+
+            remap[i] = itr->second;
+            outVertices[itr->second] += vertices[i];
+            ++clusterSize[itr->second];
+        }
+
+        for (size_t i = 0; i < outVertices.size(); ++i)
+            { outVertices[i] /= float(clusterSize[i]); }
+
+        std::set<std::pair<uint32, std::pair<uint32, uint32> > > written;
+        for (size_t i = 0; i < triangles.size(); ++i)
+        {
+            uint32 a = remap[triangles[i].idx0];
+            uint32 b = remap[triangles[i].idx1];
+            uint32 c = remap[triangles[i].idx2];
+            if (a == b || b == c || a == c)
+                { continue; }
+
+            // rotate the smallest index first, the winding stays
+            while (a > b || a > c)
+            {
+                uint32 t = a;
+                a = b;
+                b = c;
+                c = t;
+            }
+
+            if (written.insert(std::make_pair(a, std::make_pair(b, c))).second)
+                { outTriangles.push_back(MeshTriangle(a, b, c)); }
+        }
+    }
+
     // ===================== GroupModel ==================================
 
     GroupModel::GroupModel(const GroupModel& other):
         iBound(other.iBound), iMogpFlags(other.iMogpFlags), iGroupWMOID(other.iGroupWMOID),
-        vertices(other.vertices), triangles(other.triangles), meshTree(other.meshTree), iLiquid(0)
+        vertices(other.vertices), triangles(other.triangles), meshTree(other.meshTree), iLiquid(0),
+        triangleData(other.triangleData), iMappedTriangles(other.iMappedTriangles), iMappedTriangleCount(other.iMappedTriangleCount),
+        iQuantOrigin(other.iQuantOrigin), iQuantScale(other.iQuantScale), losTree(other.losTree),
+        iMappedLosTriangles(other.iMappedLosTriangles), iMappedLosTriangleCount(other.iMappedLosTriangleCount)
     {
         if (other.iLiquid)
             { iLiquid = new WmoLiquid(*other.iLiquid); }
@@ -268,6 +511,42 @@ namespace VMAP
         triangles.swap(tri);
         TriBoundFunc bFunc(vertices);
         meshTree.build(triangles, bFunc);
+        buildTriangleData();
+    }
+
+    void GroupModel::buildTriangleData()
+    {
+        triangleData.clear();
+
+        const std::vector<uint32>& order = meshTree.getObjects();
+        size_t count = triangles.size();
+        if (order.size() != count)
+            { return; }                                     // damaged file, IntersectTriangles isn't used
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (order[i] >= count)
+                { return; }
+            const MeshTriangle& tri = triangles[order[i]];
+            if (tri.idx0 >= vertices.size() || tri.idx1 >= vertices.size() || tri.idx2 >= vertices.size())
+                { return; }
+        }
+
+        triangleData.resize(count * 9);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const MeshTriangle& tri = triangles[order[i]];
+            const Vector3& v0 = vertices[tri.idx0];
+            const Vector3 e1 = vertices[tri.idx1] - v0;
+            const Vector3 e2 = vertices[tri.idx2] - v0;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                triangleData[c * count + i] = v0[c];
+                triangleData[(3 + c) * count + i] = e1[c];
+                triangleData[(6 + c) * count + i] = e2[c];
+            }
+        }
     }
 
     bool GroupModel::writeToFile(FILE* wf)
@@ -322,6 +601,8 @@ namespace VMAP
         vertices.clear();
         delete iLiquid;
         iLiquid = 0;
+        iMappedTriangles = NULL;
+        iMappedTriangleCount = 0;
 
         if (result && fread(&iBound, sizeof(G3D::AABox), 1, rf) != 1) { result = false; }
         if (result && fread(&iMogpFlags, sizeof(uint32), 1, rf) != 1) { result = false; }
@@ -349,6 +630,7 @@ namespace VMAP
         // read mesh BIH
         if (result && !readChunk(rf, chunk, "MBIH", 4)) { result = false; }
         if (result) { result = meshTree.readFromFile(rf); }
+        if (result) { buildTriangleData(); }
 
         // read liquid data
         if (result && !readChunk(rf, chunk, "LIQU", 4)) { result = false; }
@@ -358,35 +640,376 @@ namespace VMAP
         return result;
     }
 
+    bool GroupModel::writeMappedData(FILE* wf, MappedGroupHeader& header, float losError) const
+    {
+        memset(&header, 0, sizeof(header));
+        for (int c = 0; c < 3; ++c)
+        {
+            header.bound[c] = iBound.low()[c];
+            header.bound[3 + c] = iBound.high()[c];
+        }
+        header.mogpFlags = iMogpFlags;
+        header.groupWmoId = iGroupWMOID;
+
+        bool result = true;
+        if (!triangles.empty())
+        {
+            // quantize the vertices to the 16 bit grid over their bounds
+            Vector3 lo = vertices[0];
+            Vector3 hi = vertices[0];
+            for (size_t i = 1; i < vertices.size(); ++i)
+            {
+                lo = lo.min(vertices[i]);
+                hi = hi.max(vertices[i]);
+            }
+            Vector3 scale = (hi - lo) / 65535.0f;
+
+            header.triangleCount = uint32(triangles.size());
+            for (int c = 0; c < 3; ++c)
+            {
+                header.quantOrigin[c] = lo[c];
+                header.quantScale[c] = scale[c];
+            }
+
+            result = WriteQuantizedMesh(wf, vertices, triangles, lo, scale, header.trianglesOffset, header.meshTreeOffset);
+
+            if (result && losError > 0.0f)
+            {
+                // the merged vertices are averages, so they stay within the bounds of the quantization
+                std::vector<Vector3> losVertices;
+                std::vector<MeshTriangle> losTriangles;
+                SimplifyMesh(vertices, triangles, losError, losVertices, losTriangles);
+
+                // a mesh that isn't notably smaller isn't worth a second tree
+                if (!losTriangles.empty() && losTriangles.size() * 4 <= triangles.size() * 3)
+                {
+                    header.losTriangleCount = uint32(losTriangles.size());
+                    result = WriteQuantizedMesh(wf, losVertices, losTriangles, lo, scale, header.losTrianglesOffset, header.losTreeOffset);
+                }
+            }
+        }
+
+        if (result && iLiquid)
+        {
+            result = AlignFile(wf, header.liquidOffset);
+            if (result) { result = iLiquid->writeToFile(wf); }
+        }
+
+        return result;
+    }
+
+    bool GroupModel::readMappedData(const char* file, uint32 fileSize, const MappedGroupHeader& header)
+    {
+        triangles.clear();
+        vertices.clear();
+        triangleData.clear();
+        delete iLiquid;
+        iLiquid = 0;
+        iMappedTriangles = NULL;
+        iMappedTriangleCount = 0;
+        iMappedLosTriangles = NULL;
+        iMappedLosTriangleCount = 0;
+
+        iBound = G3D::AABox(Vector3(header.bound[0], header.bound[1], header.bound[2]), Vector3(header.bound[3], header.bound[4], header.bound[5]));
+        iMogpFlags = header.mogpFlags;
+        iGroupWMOID = header.groupWmoId;
+
+        if (header.triangleCount)
+        {
+            uint64 trianglesEnd = uint64(header.trianglesOffset) + uint64(header.triangleCount) * 9 * sizeof(uint16);
+            if (header.trianglesOffset % 4 || trianglesEnd > fileSize || header.meshTreeOffset % 4 || header.meshTreeOffset >= fileSize)
+                { return false; }
+
+            if (!meshTree.readFromMemory(file + header.meshTreeOffset, fileSize - header.meshTreeOffset) ||
+                meshTree.primCount() != header.triangleCount)
+                { return false; }
+
+            iMappedTriangles = reinterpret_cast<const uint16*>(file + header.trianglesOffset);
+            iMappedTriangleCount = header.triangleCount;
+            iQuantOrigin = Vector3(header.quantOrigin[0], header.quantOrigin[1], header.quantOrigin[2]);
+            iQuantScale = Vector3(header.quantScale[0], header.quantScale[1], header.quantScale[2]);
+        }
+
+        if (header.triangleCount && header.losTriangleCount)
+        {
+            uint64 trianglesEnd = uint64(header.losTrianglesOffset) + uint64(header.losTriangleCount) * 9 * sizeof(uint16);
+            if (header.losTrianglesOffset % 4 || trianglesEnd > fileSize || header.losTreeOffset % 4 || header.losTreeOffset >= fileSize)
+                { return false; }
+
+            if (!losTree.readFromMemory(file + header.losTreeOffset, fileSize - header.losTreeOffset) ||
+                losTree.primCount() != header.losTriangleCount)
+                { return false; }
+
+            iMappedLosTriangles = reinterpret_cast<const uint16*>(file + header.losTrianglesOffset);
+            iMappedLosTriangleCount = header.losTriangleCount;
+        }
+
+        if (header.liquidOffset)
+        {
+            if (header.liquidOffset >= fileSize)
+                { return false; }
+            return WmoLiquid::readFromMemory(file + header.liquidOffset, fileSize - header.liquidOffset, iLiquid);
+        }
+
+        return true;
+    }
+
+    /// Triangles of GroupModel::triangleData
+    struct FloatTriangles
+    {
+        FloatTriangles(const float* triangleData, size_t count) : data(triangleData), stride(count) {}
+
+        void get(uint32 i, float* v0, float* e1, float* e2) const
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                v0[c] = data[c * stride + i];
+                e1[c] = data[(3 + c) * stride + i];
+                e2[c] = data[(6 + c) * stride + i];
+            }
+        }
+
+#ifdef VMAP_SSE_RAY_KERNEL
+        void get4(uint32 i, __m128* v0, __m128* e1, __m128* e2) const
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                v0[c] = _mm_loadu_ps(data + c * stride + i);
+                e1[c] = _mm_loadu_ps(data + (3 + c) * stride + i);
+                e2[c] = _mm_loadu_ps(data + (6 + c) * stride + i);
+            }
+        }
+#endif
+
+        const float* data;
+        size_t stride;
+    };
+
+    /// Quantized triangles of a mapped model file, see GroupModel::iMappedTriangles
+    struct QuantizedTriangles
+    {
+        QuantizedTriangles(const uint16* quantized, size_t count, const Vector3& quantOrigin, const Vector3& quantScale) :
+            data(quantized), stride(count), origin(quantOrigin), scale(quantScale) {}
+
+        void get(uint32 i, float* v0, float* e1, float* e2) const
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                float q0 = data[c * stride + i];
+                v0[c] = origin[c] + q0 * scale[c];
+                e1[c] = (float(data[(3 + c) * stride + i]) - q0) * scale[c];
+                e2[c] = (float(data[(6 + c) * stride + i]) - q0) * scale[c];
+            }
+        }
+
+#ifdef VMAP_SSE_RAY_KERNEL
+        static __m128 load4(const uint16* values)
+        {
+            __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(packed, _mm_setzero_si128()));
+        }
+
+        void get4(uint32 i, __m128* v0, __m128* e1, __m128* e2) const
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                const __m128 s = _mm_set1_ps(scale[c]);
+                const __m128 q0 = load4(data + c * stride + i);
+                v0[c] = _mm_add_ps(_mm_set1_ps(origin[c]), _mm_mul_ps(q0, s));
+                e1[c] = _mm_mul_ps(_mm_sub_ps(load4(data + (3 + c) * stride + i), q0), s);
+                e2[c] = _mm_mul_ps(_mm_sub_ps(load4(data + (6 + c) * stride + i), q0), s);
+            }
+        }
+#endif
+
+        const uint16* data;
+        size_t stride;
+        Vector3 origin;
+        Vector3 scale;
+    };
+
+    /**
+     * @brief same algorithm as IntersectTriangle for the triangles first to first + count - 1 of the tree order
+     *
+     * Four triangles are tested per SSE step, the rest one by one.
+     */
+    template<class Triangles>
+    static bool IntersectTriangleRange(const Triangles& tris, const G3D::Ray& ray, uint32 first, uint32 count, float& distance)
+    {
+        static const float EPS = 1e-5f;
+
+        const float ox = ray.origin().x, oy = ray.origin().y, oz = ray.origin().z;
+        const float dx = ray.direction().x, dy = ray.direction().y, dz = ray.direction().z;
+
+        bool hit = false;
+        uint32 i = first;
+        const uint32 end = first + count;
+
+#ifdef VMAP_SSE_RAY_KERNEL
+        const __m128 rox = _mm_set1_ps(ox), roy = _mm_set1_ps(oy), roz = _mm_set1_ps(oz);
+        const __m128 rdx = _mm_set1_ps(dx), rdy = _mm_set1_ps(dy), rdz = _mm_set1_ps(dz);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 eps = _mm_set1_ps(EPS);
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 v0[3], e1[3], e2[3];
+            tris.get4(i, v0, e1, e2);
+
+            // p = direction x e2, a = e1 . p
+            const __m128 px = _mm_sub_ps(_mm_mul_ps(rdy, e2[2]), _mm_mul_ps(rdz, e2[1]));
+            const __m128 py = _mm_sub_ps(_mm_mul_ps(rdz, e2[0]), _mm_mul_ps(rdx, e2[2]));
+            const __m128 pz = _mm_sub_ps(_mm_mul_ps(rdx, e2[1]), _mm_mul_ps(rdy, e2[0]));
+            const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1[0], px), _mm_mul_ps(e1[1], py)), _mm_mul_ps(e1[2], pz));
+            __m128 mask = _mm_cmpge_ps(_mm_andnot_ps(signBit, a), eps);
+            if (!_mm_movemask_ps(mask))
+                { continue; }
+
+            const __m128 f = _mm_div_ps(one, a);
+            const __m128 sx = _mm_sub_ps(rox, v0[0]);
+            const __m128 sy = _mm_sub_ps(roy, v0[1]);
+            const __m128 sz = _mm_sub_ps(roz, v0[2]);
+            const __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)));
+            mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+
+            // q = s x e1
+            const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1[2]), _mm_mul_ps(sz, e1[1]));
+            const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1[0]), _mm_mul_ps(sx, e1[2]));
+            const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1[1]), _mm_mul_ps(sy, e1[0]));
+            const __m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(rdx, qx), _mm_mul_ps(rdy, qy)), _mm_mul_ps(rdz, qz)));
+            mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+
+            const __m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2[0], qx), _mm_mul_ps(e2[1], qy)), _mm_mul_ps(e2[2], qz)));
+            mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpgt_ps(t, zero), _mm_cmplt_ps(t, _mm_set1_ps(distance))));
+
+            int lanes = _mm_movemask_ps(mask);
+            if (!lanes)
+                { continue; }
+
+            float times[4];
+            _mm_storeu_ps(times, t);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if ((lanes & (1 << lane)) && times[lane] < distance)
+                {
+                    distance = times[lane];
+                    hit = true;
+                }
+            }
+        }
+#endif
+
+        for (; i < end; ++i)
+        {
+            float v0[3], e1[3], e2[3];
+            tris.get(i, v0, e1, e2);
+
+            const float px = dy * e2[2] - dz * e2[1];
+            const float py = dz * e2[0] - dx * e2[2];
+            const float pz = dx * e2[1] - dy * e2[0];
+            const float a = e1[0] * px + e1[1] * py + e1[2] * pz;
+            if (fabs(a) < EPS)
+                { continue; }
+
+            const float f = 1.0f / a;
+            const float sx = ox - v0[0], sy = oy - v0[1], sz = oz - v0[2];
+            const float u = f * (sx * px + sy * py + sz * pz);
+            if ((u < 0.0f) || (u > 1.0f))
+                { continue; }
+
+            const float qx = sy * e1[2] - sz * e1[1];
+            const float qy = sz * e1[0] - sx * e1[2];
+            const float qz = sx * e1[1] - sy * e1[0];
+            const float v = f * (dx * qx + dy * qy + dz * qz);
+            if ((v < 0.0f) || ((u + v) > 1.0f))
+                { continue; }
+
+            const float t = f * (e2[0] * qx + e2[1] * qy + e2[2] * qz);
+            if ((t > 0.0f) && (t < distance))
+            {
+                distance = t;
+                hit = true;
+            }
+        }
+
+        return hit;
+    }
+
+    bool GroupModel::IntersectTriangles(const G3D::Ray& ray, uint32 first, uint32 count, float& distance, bool losMesh) const
+    {
+        if (losMesh)
+            { return IntersectTriangleRange(QuantizedTriangles(iMappedLosTriangles, iMappedLosTriangleCount, iQuantOrigin, iQuantScale), ray, first, count, distance); }
+        if (iMappedTriangles)
+            { return IntersectTriangleRange(QuantizedTriangles(iMappedTriangles, iMappedTriangleCount, iQuantOrigin, iQuantScale), ray, first, count, distance); }
+
+        return IntersectTriangleRange(FloatTriangles(&triangleData[0], triangles.size()), ray, first, count, distance);
+    }
+
     struct GModelRayCallback
     {
-        GModelRayCallback(const std::vector<MeshTriangle>& tris, const std::vector<Vector3>& vert):
-            vertices(vert.begin()), triangles(tris.begin()), hit(false) {}
+        GModelRayCallback(const GroupModel& group, const std::vector<MeshTriangle>& tris, const std::vector<Vector3>& vert, bool hasTriangleData, bool useLosMesh = false):
+            model(group), vertices(vert.begin()), triangles(tris.begin()), batched(hasTriangleData), losMesh(useLosMesh), hit(false) {}
         bool operator()(const G3D::Ray& ray, uint32 entry, float& distance, bool /*pStopAtFirstHit*/)
         {
             bool result = IntersectTriangle(triangles[entry], vertices, ray, distance);
             if (result)  { hit = true; }
             return hit;
         }
+        const GroupModel& model;
         std::vector<Vector3>::const_iterator vertices;
         std::vector<MeshTriangle>::const_iterator triangles;
+        bool batched;                                       // the model has its triangle data
+        bool losMesh;                                       // the leaves are of the line of sight mesh
         bool hit;
     };
+}
+
+template<> struct BIHLeafTrait<VMAP::GModelRayCallback>
+{
+    static bool intersectRay(VMAP::GModelRayCallback& intersectCallback, const Ray& r, const uint32* objects, uint32 first, uint32 count, float& maxDist, bool stopAtFirst)
+    {
+        if (!intersectCallback.batched)
+        {
+            for (uint32 i = first; i < first + count; ++i)
+            {
+                if (intersectCallback(r, objects[i], maxDist, stopAtFirst) && stopAtFirst)
+                    { return true; }
+            }
+            return false;
+        }
+
+        if (intersectCallback.model.IntersectTriangles(r, first, count, maxDist, intersectCallback.losMesh))
+            { intersectCallback.hit = true; }
+        return stopAtFirst && intersectCallback.hit;
+    }
+};
 
+namespace VMAP
+{
     bool GroupModel::IntersectRay(const G3D::Ray& ray, float& distance, bool stopAtFirstHit) const
     {
-        if (triangles.empty())
+        if (triangles.empty() && !iMappedTriangles)
             { return false; }
-        GModelRayCallback callback(triangles, vertices);
+
+        // any hit blocks the sight, the simplified mesh finds one sooner
+        if (stopAtFirstHit && iMappedLosTriangles)
+        {
+            GModelRayCallback callback(*this, triangles, vertices, true, true);
+            losTree.intersectRay(ray, callback, distance, true);
+            return callback.hit;
+        }
+
+        GModelRayCallback callback(*this, triangles, vertices, !triangleData.empty() || iMappedTriangles);
         meshTree.intersectRay(ray, callback, distance, stopAtFirstHit);
         return callback.hit;
     }
 
     bool GroupModel::IsInsideObject(const Vector3& pos, const Vector3& down, float& z_dist) const
     {
-        if (triangles.empty() || !iBound.contains(pos))
+        if ((triangles.empty() && !iMappedTriangles) || !iBound.contains(pos))
             { return false; }
-        GModelRayCallback callback(triangles, vertices);
         Vector3 rPos = pos - 0.1f * down;
         float dist = G3D::inf();
         G3D::Ray ray(rPos, down);
@@ -412,6 +1035,11 @@ namespace VMAP
 
     // ===================== WorldModel ==================================
 
+    WorldModel::~WorldModel()
+    {
+        delete iFileData;
+    }
+
     void WorldModel::setGroupModels(std::vector<GroupModel>& models)
     {
         groupModels.swap(models);
@@ -547,6 +1175,87 @@ namespace VMAP
         return result;
     }
 
+    bool WorldModel::writeMappedFile(const std::string& filename, float losError)
+    {
+        FILE* wf = fopen(filename.c_str(), "wb");
+        if (!wf)
+            { return false; }
+
+        MappedModelHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, VMAP_MAPPED_MAGIC, 8);
+        header.rootWmoId = RootWMOID;
+        header.groupCount = groupModels.size();
+
+        // headers are written again with the offsets at the end
+        std::vector<MappedGroupHeader> groups(groupModels.size());
+        bool result = fwrite(&header, sizeof(header), 1, wf) == 1;
+        if (result && !groups.empty() && fwrite(&groups[0], sizeof(MappedGroupHeader), groups.size(), wf) != groups.size()) { result = false; }
+
+        for (uint32 i = 0; i < groupModels.size() && result; ++i)
+            { result = groupModels[i].writeMappedData(wf, groups[i], losError); }
+
+        if (result && !groups.empty())
+        {
+            result = AlignFile(wf, header.groupTreeOffset);
+            if (result) { result = groupTree.writeToFile(wf); }
+        }
+
+        long size = ftell(wf);
+        header.fileSize = uint32(size);
+        if (result && (size < 0 || fseek(wf, 0, SEEK_SET) != 0)) { result = false; }
+        if (result && fwrite(&header, sizeof(header), 1, wf) != 1) { result = false; }
+        if (result && !groups.empty() && fwrite(&groups[0], sizeof(MappedGroupHeader), groups.size(), wf) != groups.size()) { result = false; }
+
+        fclose(wf);
+        return result;
+    }
+
+    bool WorldModel::readMappedFile(const std::string& filename)
+    {
+        iFileData = new ModelFileData();
+        bool result = iFileData->open(filename);
+
+        const char* data = result ? iFileData->data() : NULL;
+        uint32 size = result ? iFileData->size() : 0;
+
+        MappedModelHeader header;
+        if (result && size < sizeof(header)) { result = false; }
+        if (result)
+        {
+            memcpy(&header, data, sizeof(header));
+            result = memcmp(header.magic, VMAP_MAPPED_MAGIC, 8) == 0 && header.fileSize == size &&
+                     uint64(sizeof(header)) + uint64(header.groupCount) * sizeof(MappedGroupHeader) <= size;
+        }
+
+        if (result)
+        {
+            RootWMOID = header.rootWmoId;
+            groupModels.resize(header.groupCount);
+            for (uint32 i = 0; i < header.groupCount && result; ++i)
+            {
+                MappedGroupHeader group;
+                memcpy(&group, data + sizeof(header) + i * sizeof(MappedGroupHeader), sizeof(group));
+                result = groupModels[i].readMappedData(data, size, group);
+            }
+        }
+
+        if (result && header.groupCount)
+        {
+            result = header.groupTreeOffset % 4 == 0 && header.groupTreeOffset < size &&
+                     groupTree.readFromMemory(data + header.groupTreeOffset, size - header.groupTreeOffset) != 0;
+        }
+
+        if (!result)
+        {
+            groupModels.clear();
+            delete iFileData;
+            iFileData = NULL;
+        }
+
+        return result;
+    }
+
     bool WorldModel::readFile(const std::string& filename)
     {
         FILE* rf = fopen(filename.c_str(), "rb");
@@ -557,7 +1266,15 @@ namespace VMAP
         uint32 chunkSize = 0;
         uint32 count = 0;
         char chunk[8];                          // Ignore the added magic header
-        if (!readChunk(rf, chunk, VMAP_MAGIC, 8)) { result = false; }
+        if (fread(chunk, sizeof(char), 8, rf) != 8) { result = false; }
+
+        // files of the assembler are used in place, older ones are read
+        if (result && memcmp(chunk, VMAP_MAPPED_MAGIC, 8) == 0)
+        {
+            fclose(rf);
+            return readMappedFile(filename);
+        }
+        if (result && memcmp(chunk, VMAP_MAGIC, 8) != 0) { result = false; }
 
         if (result && !readChunk(rf, chunk, "WMOD", 4)) { result = false; }
         if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) { result = false; }
@@ -38,6 +38,8 @@ namespace VMAP
     class TreeNode;
     struct AreaInfo;
     struct LocationInfo;
+    struct MappedGroupHeader;
+    class ModelFileData;
 
     /**
      * @brief
@@ -146,6 +148,15 @@ namespace VMAP
              * @return bool
              */
             static bool readFromFile(FILE* rf, WmoLiquid*& liquid);
+            /**
+             * @brief reads a liquid stored like by writeToFile from memory
+             *
+             * @param data
+             * @param size bytes available from data on
+             * @param liquid
+             * @return bool
+             */
+            static bool readFromMemory(const char* data, uint32 size, WmoLiquid*& liquid);
         private:
             /**
              * @brief
@@ -175,7 +186,8 @@ namespace VMAP
              * @brief
              *
              */
-            GroupModel(): iLiquid(0) {}
+            GroupModel(): iLiquid(0), iMappedTriangles(NULL), iMappedTriangleCount(0),
+                iMappedLosTriangles(NULL), iMappedLosTriangleCount(0) {}
             /**
              * @brief
              *
@@ -190,7 +202,8 @@ namespace VMAP
              * @param bound
              */
             GroupModel(uint32 mogpFlags, uint32 groupWMOID, const AABox& bound):
-                iBound(bound), iMogpFlags(mogpFlags), iGroupWMOID(groupWMOID), iLiquid(0) {}
+                iBound(bound), iMogpFlags(mogpFlags), iGroupWMOID(groupWMOID), iLiquid(0), iMappedTriangles(NULL), iMappedTriangleCount(0),
+                iMappedLosTriangles(NULL), iMappedLosTriangleCount(0) {}
             /**
              * @brief
              *
@@ -256,6 +269,24 @@ namespace VMAP
              * @return bool
              */
             bool readFromFile(FILE* rf);
+            /**
+             * @brief writes the group to a mapped model file, the triangles are quantized
+             *
+             * @param wf
+             * @param header filled with the offsets of the written data
+             * @param losError largest vertex offset of the simplified line of sight mesh, 0 writes none
+             * @return bool
+             */
+            bool writeMappedData(FILE* wf, MappedGroupHeader& header, float losError) const;
+            /**
+             * @brief uses the group data of a mapped model file in place
+             *
+             * @param file start of the file memory, it has to outlive the group
+             * @param fileSize
+             * @param header
+             * @return bool
+             */
+            bool readMappedData(const char* file, uint32 fileSize, const MappedGroupHeader& header);
             /**
              * @brief
              *
@@ -274,7 +305,24 @@ namespace VMAP
              * @return uint32
              */
             uint32 GetWmoID() const { return iGroupWMOID; }
+            /**
+             * @brief tests the triangles of a mesh tree leaf, see BIHLeafTrait
+             *
+             * @param ray
+             * @param first position of the first triangle in tree order
+             * @param count
+             * @param distance
+             * @param losMesh the leaf is of losTree
+             * @return bool
+             */
+            bool IntersectTriangles(const G3D::Ray& ray, uint32 first, uint32 count, float& distance, bool losMesh) const;
         protected:
+            /**
+             * @brief fills triangleData from the mesh, after the mesh tree is built or read
+             *
+             */
+            void buildTriangleData();
+
             G3D::AABox iBound;  /**< TODO */
             uint32 iMogpFlags;  /**< 0x8 outdor; 0x2000 indoor */
             uint32 iGroupWMOID; /**< TODO */
@@ -282,6 +330,19 @@ namespace VMAP
             std::vector<MeshTriangle> triangles; /**< TODO */
             BIH meshTree; /**< TODO */
             WmoLiquid* iLiquid; /**< TODO */
+            // first vertex and both edges of the triangles in mesh tree order, one block of
+            // triangles.size() floats per component: v0 x,y,z, e1 x,y,z, e2 x,y,z
+            std::vector<float> triangleData;
+            // triangles of a mapped model file instead of vertices and triangles: the quantized corners in
+            // mesh tree order, one block of iMappedTriangleCount values per component: q0 x,y,z, q1 x,y,z, q2 x,y,z
+            const uint16* iMappedTriangles;
+            uint32 iMappedTriangleCount;
+            G3D::Vector3 iQuantOrigin;                      // corner = iQuantOrigin + q * iQuantScale
+            G3D::Vector3 iQuantScale;
+            // simplified mesh of a mapped model file for line of sight, in the layout of iMappedTriangles
+            BIH losTree;
+            const uint16* iMappedLosTriangles;
+            uint32 iMappedLosTriangleCount;
 
 #ifdef MMAP_GENERATOR
         public:
@@ -299,7 +360,12 @@ namespace VMAP
              * @brief
              *
              */
-            WorldModel(): RootWMOID(0) {}
+            WorldModel(): RootWMOID(0), iFileData(NULL) {}
+            /**
+             * @brief
+             *
+             */
+            ~WorldModel();
 
             /**
              * @brief pass group models to WorldModel and create BIH. Passed vector is swapped with old geometry!
@@ -350,16 +416,34 @@ namespace VMAP
              */
             bool writeFile(const std::string& filename);
             /**
-             * @brief
+             * @brief writes the model in the VMAP_MAPPED_MAGIC format
+             *
+             * The file is used in place by readFile: the group headers, quantized triangles and trees are
+             * read from the memory mapped file, only the group list and the liquids are copied.
+             *
+             * @param filename
+             * @param losError largest vertex offset of the simplified group meshes for line of sight, 0 writes none
+             * @return bool
+             */
+            bool writeMappedFile(const std::string& filename, float losError = 0.0f);
+            /**
+             * @brief reads a model file of either format
              *
              * @param filename
              * @return bool
              */
             bool readFile(const std::string& filename);
         protected:
+            bool readMappedFile(const std::string& filename);
+
             uint32 RootWMOID; /**< TODO */
             std::vector<GroupModel> groupModels; /**< TODO */
             BIH groupTree; /**< TODO */
+            ModelFileData* iFileData;                       // memory of a mapped model file, NULL for the old format
+
+        private:
+            WorldModel(const WorldModel&);
+            WorldModel& operator=(const WorldModel&);
 
 #ifdef MMAP_GENERATOR
         public:
@@ -34,6 +34,8 @@
 #include "Common.h"
 #include "Master.h"
 #include "WorldSocket.h"
+#include "SessionKeyCache.h"
+#include "Metrics.h"
 #include "WorldRunnable.h"
 #include "World.h"
 #include "Log.h"
@@ -329,6 +331,12 @@ int Master::Run()
     uint16 wsport = sWorld.getConfig(CONFIG_UINT32_PORT_WORLD);
     std::string bind_ip = sConfig.GetStringDefault("BindIP", "0.0.0.0");
 
+    sSessionKeyCache.Activate(sConfig.GetIntDefault("SessionKey.ListenPort", 0), bind_ip,
+                              sConfig.GetStringDefault("SessionKey.Secret", ""), sConfig.GetIntDefault("SessionKey.TTL", 60));
+
+    sMetricsExporter.Activate(sConfig.GetIntDefault("Metrics.PrometheusPort", 0), bind_ip, sConfig.GetStringDefault("Metrics.StatsDAddress", ""),
+                              sConfig.GetIntDefault("Metrics.StatsDInterval", 10), sConfig.GetStringDefault("Metrics.Prefix", "mangos"));
+
     if (sWorldSocketMgr->StartNetwork(wsport, bind_ip) == -1)
     {
         sLog.outError("Failed to start network");
@@ -339,6 +347,9 @@ int Master::Run()
 
     sWorldSocketMgr->Wait();
 
+    sSessionKeyCache.Deactivate();
+    sMetricsExporter.Deactivate();
+
     ///- Stop freeze protection before shutdown tasks
     if (freeze_thread)
     {
@@ -438,6 +449,8 @@ int Master::Run()
     // as it's allocated with static storage.
     sScriptMgr.UnloadScriptLibrary();
 
+    sLog.StopAsyncWriter();
+
     ///- Exit the process with specified return value
     return World::GetExitCode();
 }
@@ -448,6 +461,7 @@ bool Master::_StartDB()
     ///- Get world database info from configuration file
     std::string dbstring = sConfig.GetStringDefault("WorldDatabaseInfo", "");
     int nConnections = sConfig.GetIntDefault("WorldDatabaseConnections", 1);
+    std::string replicas = sConfig.GetStringDefault("WorldDatabaseReplicas", "");
     if (dbstring.empty())
     {
         sLog.outError("Database not specified in configuration file");
@@ -456,7 +470,7 @@ bool Master::_StartDB()
     sLog.outString("World Database total connections: %i", nConnections + 1);
 
     ///- Initialise the world database
-    if (!WorldDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!WorldDatabase.Initialize(dbstring.c_str(), nConnections, 1, replicas.c_str()))
     {
         sLog.outError("Can not connect to world database %s", dbstring.c_str());
         return false;
@@ -471,6 +485,7 @@ bool Master::_StartDB()
 
     dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo", "");
     nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    int nAsyncConnections = sConfig.GetIntDefault("CharacterDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Character Database not specified in configuration file");
@@ -479,10 +494,10 @@ bool Master::_StartDB()
         WorldDatabase.HaltDelayThread();
         return false;
     }
-    sLog.outString("Character Database total connections: %i", nConnections + 1);
+    sLog.outString("Character Database total connections: %i", nConnections + nAsyncConnections);
 
     ///- Initialise the Character database
-    if (!CharacterDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!CharacterDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Can not connect to Character database %s", dbstring.c_str());
 
@@ -502,6 +517,7 @@ bool Master::_StartDB()
     ///- Get login database info from configuration file
     dbstring = sConfig.GetStringDefault("LoginDatabaseInfo", "");
     nConnections = sConfig.GetIntDefault("LoginDatabaseConnections", 1);
+    replicas = sConfig.GetStringDefault("LoginDatabaseReplicas", "");
     if (dbstring.empty())
     {
         sLog.outError("Login database not specified in configuration file");
@@ -514,7 +530,7 @@ bool Master::_StartDB()
 
     ///- Initialise the login database
     sLog.outString("Login Database total connections: %i", nConnections + 1);
-    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections, 1, replicas.c_str()))
     {
         sLog.outError("Can not connect to login database %s", dbstring.c_str());
 
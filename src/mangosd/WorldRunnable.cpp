@@ -33,8 +33,12 @@
 #include "Timer.h"
 #include "ObjectAccessor.h"
 #include "MapManager.h"
+#include "AuctionHouseBot/AuctionHouseBot.h"
 
 #include "Database/DatabaseEnv.h"
+#include "Config/Config.h"
+#include "Profiler.h"
+#include "SlowTickWatchdog.h"
 
 #define WORLD_SLEEP_CONST 50
 
@@ -46,6 +50,16 @@ extern int m_ServiceStatus;
 /// Heartbeat for the World
 void WorldRunnable::run()
 {
+    std::string cpuSets = sConfig.GetStringDefault("Affinity.World", "");
+    if (!ACE_Based::Thread::setCurrentAffinity(cpuSets, 0))
+        { sLog.outError("Affinity.World '%s' is invalid or not supported, world thread not bound", cpuSets.c_str()); }
+
+    SyncQueryAudit::MarkThread();                           // report the requests the world update waits for
+    sTickProfiler.SetThreadName("world");
+
+    sSlowTickWatchdog.Activate(sConfig.GetIntDefault("SlowTick.Threshold", 0), sConfig.GetIntDefault("SlowTick.MinInterval", 60),
+                               sConfig.GetBoolDefault("SlowTick.Profile", false));
+
     uint32 realCurrTime = 0;
     uint32 realPrevTime = WorldTimer::tick();
 
@@ -59,7 +73,12 @@ void WorldRunnable::run()
 
         uint32 diff = WorldTimer::tick();
 
-        sWorld.Update(diff);
+        {
+            SyncQueryAudit::Context auditContext("World::Update");
+            sSlowTickWatchdog.TickStarted();
+            sWorld.Update(diff);
+            sSlowTickWatchdog.TickEnded();
+        }
         realPrevTime = realCurrTime;
 
         // diff (D0) include time of previous sleep (d0) + tick time (t0)
@@ -92,5 +111,8 @@ void WorldRunnable::run()
 
     sWorldSocketMgr->StopNetwork();
 
+    sAuctionBot.Deactivate();                               // stop the AHBot planning thread
+    sSlowTickWatchdog.Deactivate();
+
     sMapMgr.UnloadAll();                                    // unload all grids (including locked in memory)
 }
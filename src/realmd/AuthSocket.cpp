@@ -28,12 +28,15 @@
 
 #include "Common.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 #include "Config/Config.h"
 #include "Log.h"
 #include "RealmList.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
 #include "PatchHandler.h"
+#include "SessionKeyPublisher.h"
+#include "LoginGuard.h"
 
 #include <openssl/md5.h>
 //#include "Util.h" -- for commented utf8ToUpperOnlyLatin
@@ -184,26 +187,98 @@ const AuthHandler table[] =
 
 #define AUTH_TOTAL_COMMANDS sizeof(table)/sizeof(AuthHandler)
 
+/// Open sockets by id, all used by the reactor thread only, which also runs the async query callbacks
+typedef std::map<uint32, AuthSocket*> AuthSocketMap;
+static AuthSocketMap authSockets;
+static uint32 nextAuthSocketId = 0;
+
 /// Constructor - set the N and g values for SRP6
 AuthSocket::AuthSocket()
 {
-    N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
-    g.SetDword(7);
+    N = sSRP6Worker.GetN();
+    g = sSRP6Worker.GetG();
     _authed = false;
 
     _accountSecurityLevel = SEC_PLAYER;
+    _accountId = 0;
+    _muteTime = 0;
+    _storedFailedLogins = 0;
 
     _build = 0;
     patch_ = ACE_INVALID_HANDLE;
+
+    _socketId = ++nextAuthSocketId;
+    _waitingForResult = false;
+    authSockets[_socketId] = this;
 }
 
 /// Close patch file descriptor before leaving
 AuthSocket::~AuthSocket()
 {
+    authSockets.erase(_socketId);
+
     if (patch_ != ACE_INVALID_HANDLE)
         { ACE_OS::close(patch_); }
 }
 
+template<void (AuthSocket::*Method)(QueryResult*)>
+void AuthSocket::QueryCallback(QueryResult* result, uint32 socketId)
+{
+    AuthSocketMap::const_iterator itr = authSockets.find(socketId);
+    if (itr == authSockets.end())
+    {
+        delete result;                                      // connection closed meanwhile
+        return;
+    }
+
+    AuthSocket* socket = itr->second;
+    socket->_waitingForResult = false;
+    (socket->*Method)(result);
+}
+
+template<void (AuthSocket::*Method)(QueryResult*)>
+bool AuthSocket::StartQuery(const char* format, ...)
+{
+    char szQuery[MAX_QUERY_LEN];
+
+    va_list ap;
+    va_start(ap, format);
+    int res = vsnprintf(szQuery, MAX_QUERY_LEN, format, ap);
+    va_end(ap);
+
+    if (res == -1)
+    {
+        sLog.outError("SQL Query truncated (and not execute) for format: %s", format);
+        return false;
+    }
+
+    _waitingForResult = LoginDatabase.AsyncQuery(&AuthSocket::QueryCallback<Method>, _socketId, szQuery);
+    return _waitingForResult;
+}
+
+void AuthSocket::ProcessComputedProofs()
+{
+    while (SRP6Worker::ProofRequest* request = sSRP6Worker.TakeDoneProof())
+    {
+        AuthSocketMap::const_iterator itr = authSockets.find(request->socketId);
+        if (itr != authSockets.end())
+        {
+            AuthSocket* socket = itr->second;
+            socket->_waitingForResult = false;
+            socket->_LogonProofComputed(*request);
+            socket->ResumeRead();
+        }
+
+        delete request;
+    }
+}
+
+void AuthSocket::ResumeRead()
+{
+    if (!_waitingForResult)
+        { OnRead(); }
+}
+
 /// Accept the connection and set the s random value for SRP6
 void AuthSocket::OnAccept()
 {
@@ -216,6 +291,10 @@ void AuthSocket::OnRead()
     uint8 _cmd;
     while (1)
     {
+        // the command before is still waiting for the database
+        if (_waitingForResult)
+            { return; }
+
         if (!recv_soft((char*)&_cmd, 1))
             { return; }
         size_t i;
@@ -364,11 +443,13 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
-
     _login = (const char*)ch->I;
     _build = ch->build;
 
+    _localizationName.resize(4);
+    for (int i = 0; i < 4; ++i)
+        { _localizationName[i] = ch->country[4 - i - 1]; }
+
     ///- Normalize account name
     // utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
 
@@ -377,154 +458,169 @@ bool AuthSocket::_HandleLogonChallenge()
     _safelogin = _login;
     LoginDatabase.escape_string(_safelogin);
 
+    ///- Limit the attempts of the IP and check its bans before any database work
+    if (!sLoginGuard.AdmitAttempt(get_remote_address()) || sLoginGuard.IsIpBanned(get_remote_address()))
+    {
+        ByteBuffer pkt;
+        pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+        pkt << (uint8) 0x00;
+
+        if (sLoginGuard.IsIpBanned(get_remote_address()))
+        {
+            pkt << (uint8) WOW_FAIL_BANNED;
+            BASIC_LOG("[AuthChallenge] Banned ip %s tries to login!", get_remote_address().c_str());
+        }
+        else
+        {
+            pkt << (uint8) WOW_FAIL_DB_BUSY;
+            DETAIL_LOG("[AuthChallenge] ip %s tries to login too often, see LoginRate.PerMinute", get_remote_address().c_str());
+        }
+
+        send((char const*)pkt.contents(), pkt.size());
+        return true;
+    }
+
+    // the account and ban lookups can live with the replication lag, the session key is read from the primary at reconnect
+    Database::ReplicaReadScope replicaReads(LoginDatabase);
+
+    ///- Get the account details from the account table, with the active ban of the account if any
+    //                   0                1     2         3          4          5    6    7          8            9           10
+    return StartQuery<&AuthSocket::_LogonChallengeAccountLoaded>("SELECT a.sha_pass_hash, a.id, a.locked, a.last_ip, a.gmlevel, a.v, a.s, b.bandate, b.unbandate, a.mutetime, a.failed_logins "
+            "FROM account a LEFT JOIN account_banned b ON b.id = a.id AND b.active = 1 AND (b.unbandate > UNIX_TIMESTAMP() OR b.unbandate = b.bandate) "
+            "WHERE a.username = '%s'", _safelogin.c_str());
+}
+
+void AuthSocket::_LogonChallengeAccountLoaded(QueryResult* result)
+{
+    ByteBuffer pkt;
     pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
     pkt << (uint8) 0x00;
 
-    ///- Verify that this IP is not in the ip_banned table
-    // No SQL injection possible (paste the IP address as passed by the socket)
-    std::string address = get_remote_address();
-    LoginDatabase.escape_string(address);
-    QueryResult* result = LoginDatabase.PQuery("SELECT unbandate FROM ip_banned WHERE "
-                          //    permanent                    still banned
-                          "(unbandate = bandate OR unbandate > UNIX_TIMESTAMP()) AND ip = '%s'", address.c_str());
     if (result)
     {
-        pkt << (uint8)WOW_FAIL_BANNED;
-        BASIC_LOG("[AuthChallenge] Banned ip %s tries to login!", get_remote_address().c_str());
-        delete result;
-    }
-    else
-    {
-        ///- Get the account details from the account table
-        // No SQL injection (escaped user name)
+        ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
+        bool locked = false;
+        if ((*result)[2].GetUInt8() == 1)                   // if ip is locked
+        {
+            DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*result)[3].GetString());
+            DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
+            if (strcmp((*result)[3].GetString(), get_remote_address().c_str()))
+            {
+                DEBUG_LOG("[AuthChallenge] Account IP differs");
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
+                locked = true;
+            }
+            else
+            {
+                DEBUG_LOG("[AuthChallenge] Account IP matches");
+            }
+        }
+        else
+        {
+            DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+        }
 
-        result = LoginDatabase.PQuery("SELECT sha_pass_hash,id,locked,last_ip,gmlevel,v,s FROM account WHERE username = '%s'", _safelogin.c_str());
-        if (result)
+        if (!locked)
         {
-            ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            if ((*result)[2].GetUInt8() == 1)               // if ip is locked
+            ///- If the account is banned, reject the logon attempt
+            if (!(*result)[7].IsNULL())
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*result)[3].GetString());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
-                if (strcmp((*result)[3].GetString(), get_remote_address().c_str()))
+                if ((*result)[7].GetUInt64() == (*result)[8].GetUInt64())
                 {
-                    DEBUG_LOG("[AuthChallenge] Account IP differs");
-                    pkt << (uint8) WOW_FAIL_SUSPENDED;
-                    locked = true;
+                    pkt << (uint8) WOW_FAIL_BANNED;
+                    BASIC_LOG("[AuthChallenge] Banned account %s tries to login!", _login.c_str());
                 }
                 else
                 {
-                    DEBUG_LOG("[AuthChallenge] Account IP matches");
+                    pkt << (uint8) WOW_FAIL_SUSPENDED;
+                    BASIC_LOG("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str());
                 }
             }
             else
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
-            }
+                ///- Get the password from the account table, upper it, and make the SRP6 calculation
+                std::string rI = (*result)[0].GetCppString();
 
-            if (!locked)
-            {
-                ///- If the account is banned, reject the logon attempt
-                QueryResult* banresult = LoginDatabase.PQuery("SELECT bandate,unbandate FROM account_banned WHERE "
-                                         "id = %u AND active = 1 AND (unbandate > UNIX_TIMESTAMP() OR unbandate = bandate)", (*result)[1].GetUInt32());
-                if (banresult)
-                {
-                    if ((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        pkt << (uint8) WOW_FAIL_BANNED;
-                        BASIC_LOG("[AuthChallenge] Banned account %s tries to login!", _login.c_str());
-                    }
-                    else
-                    {
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
-                        BASIC_LOG("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str());
-                    }
-
-                    delete banresult;
-                }
+                ///- Don't calculate (v, s) if there are already some in the database
+                std::string databaseV = (*result)[5].GetCppString();
+                std::string databaseS = (*result)[6].GetCppString();
+
+                DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+
+                // multiply with 2, bytes are stored as hexstring
+                if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
+                    { _SetVSFields(rI); }
                 else
                 {
-                    ///- Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = (*result)[0].GetCppString();
+                    s.SetHexStr(databaseS.c_str());
+                    v.SetHexStr(databaseV.c_str());
+                }
 
-                    ///- Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = (*result)[5].GetCppString();
-                    std::string databaseS = (*result)[6].GetCppString();
+                BigNumber gmod;
+                if (!sSRP6Worker.TakeEphemeral(b, gmod))
+                {
+                    b.SetRand(19 * 8);
+                    gmod = g.ModExp(b, N);
+                }
+                B = ((v * 3) + gmod) % N;
 
-                    DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+                MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
 
-                    // multiply with 2, bytes are stored as hexstring
-                    if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
-                        { _SetVSFields(rI); }
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
+                BigNumber unk3;
+                unk3.SetRand(16 * 8);
 
-                    b.SetRand(19 * 8);
-                    BigNumber gmod = g.ModExp(b, N);
-                    B = ((v * 3) + gmod) % N;
+                ///- Fill the response packet with the result
+                pkt << uint8(WOW_SUCCESS);
 
-                    MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+                // B may be calculated < 32B so we force minimal length to 32B
+                pkt.append(B.AsByteArray(32), 32);          // 32 bytes
+                pkt << uint8(1);
+                pkt.append(g.AsByteArray(), 1);
+                pkt << uint8(32);
+                pkt.append(N.AsByteArray(32), 32);
+                pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
+                pkt.append(unk3.AsByteArray(16), 16);
+                uint8 securityFlags = 0;
+                pkt << uint8(securityFlags);                // security flags (0x0...0x04)
 
-                    BigNumber unk3;
-                    unk3.SetRand(16 * 8);
+                if (securityFlags & 0x01)                   // PIN input
+                {
+                    pkt << uint32(0);
+                    pkt << uint64(0) << uint64(0);          // 16 bytes hash?
+                }
 
-                    ///- Fill the response packet with the result
-                    pkt << uint8(WOW_SUCCESS);
+                if (securityFlags & 0x02)                   // Matrix input
+                {
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint8(0);
+                    pkt << uint64(0);
+                }
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(B.AsByteArray(32), 32);      // 32 bytes
+                if (securityFlags & 0x04)                   // Security token input
+                {
                     pkt << uint8(1);
-                    pkt.append(g.AsByteArray(), 1);
-                    pkt << uint8(32);
-                    pkt.append(N.AsByteArray(32), 32);
-                    pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
-                    pkt.append(unk3.AsByteArray(16), 16);
-                    uint8 securityFlags = 0;
-                    pkt << uint8(securityFlags);            // security flags (0x0...0x04)
-
-                    if (securityFlags & 0x01)               // PIN input
-                    {
-                        pkt << uint32(0);
-                        pkt << uint64(0) << uint64(0);      // 16 bytes hash?
-                    }
-
-                    if (securityFlags & 0x02)               // Matrix input
-                    {
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint64(0);
-                    }
-
-                    if (securityFlags & 0x04)               // Security token input
-                    {
-                        pkt << uint8(1);
-                    }
-
-                    uint8 secLevel = (*result)[4].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
-
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        { _localizationName[i] = ch->country[4 - i - 1]; }
-
-                    BASIC_LOG("[AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", _login.c_str(), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
                 }
+
+                uint8 secLevel = (*result)[4].GetUInt8();
+                _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
+                _accountId = (*result)[1].GetUInt32();
+                _muteTime = (*result)[9].GetUInt64();
+                _storedFailedLogins = (*result)[10].GetUInt32();
+
+                BASIC_LOG("[AuthChallenge] account %s is using '%s' locale (%u)", _login.c_str(), _localizationName.c_str(), GetLocaleByName(_localizationName));
             }
-            delete result;
-        }
-        else                                                // no account
-        {
-            pkt << (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
         }
+        delete result;
     }
+    else                                                    // no account
+    {
+        pkt << (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
+    }
+
     send((char const*)pkt.contents(), pkt.size());
-    return true;
+    ResumeRead();
 }
 
 /// Logon Proof command handler
@@ -613,8 +709,35 @@ bool AuthSocket::_HandleLogonProof()
     sha.Finalize();
     BigNumber u;
     u.SetBinary(sha.GetDigest(), 20);
-    BigNumber S = (A * (v.ModExp(u, N))).ModExp(b, N);
 
+    SRP6Worker::ProofRequest* request = new SRP6Worker::ProofRequest;
+    request->socketId = _socketId;
+    request->A = A;
+    request->u = u;
+    request->v = v;
+    request->b = b;
+    memcpy(request->M1, lp.M1, sizeof(request->M1));
+
+    if (sSRP6Worker.IsActive())
+    {
+        // continued by ProcessComputedProofs
+        _waitingForResult = true;
+        sSRP6Worker.QueueProof(request);
+        return true;
+    }
+
+    request->S = (A * (v.ModExp(u, N))).ModExp(b, N);
+    _LogonProofComputed(*request);
+    delete request;
+    return true;
+}
+
+void AuthSocket::_LogonProofComputed(SRP6Worker::ProofRequest const& request)
+{
+    BigNumber A = request.A;
+    BigNumber S = request.S;
+
+    Sha1Hash sha;
     uint8 t[32];
     uint8 t1[16];
     uint8 vK[40];
@@ -674,7 +797,7 @@ bool AuthSocket::_HandleLogonProof()
     M.SetBinary(sha.GetDigest(), 20);
 
     ///- Check if SRP6 results match (password is correct), else send an error
-    if (!memcmp(M.AsByteArray(), lp.M1, 20))
+    if (!memcmp(M.AsByteArray(), request.M1, 20))
     {
         BASIC_LOG("User '%s' successfully authenticated", _login.c_str());
 
@@ -683,6 +806,21 @@ bool AuthSocket::_HandleLogonProof()
         const char* K_hex = K.AsHexStr();
         LoginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', failed_logins = 0 WHERE username = '%s'", K_hex, get_remote_address().c_str(), GetLocaleByName(_localizationName), _safelogin.c_str());
         OPENSSL_free((void*)K_hex);
+        sLoginGuard.ResetFailedLogins(_accountId);
+
+        // the world server needs no account lookup if the datagram arrives before the client
+        if (sSessionKeyPublisher.IsEnabled())
+        {
+            SessionKeyMessage message;
+            message.account = _login;
+            message.accountId = _accountId;
+            message.security = uint8(_accountSecurityLevel);
+            message.locale = uint8(GetLocaleByName(_localizationName));
+            message.muteTime = _muteTime;
+            message.sendTime = uint64(time(NULL));
+            memcpy(message.K, K.AsByteArray(40), sizeof(message.K));
+            sSessionKeyPublisher.Publish(message);
+        }
 
         ///- Finish SRP6 and send the final result to the client
         sha.Initialize();
@@ -713,41 +851,35 @@ bool AuthSocket::_HandleLogonProof()
         if (MaxWrongPassCount > 0)
         {
             // Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            LoginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'", _safelogin.c_str());
+            // the counter is written to failed_logins by LoginGuard in an interval
+            uint32 failed_logins = sLoginGuard.AddFailedLogin(_accountId, _storedFailedLogins);
 
-            if (QueryResult* loginfail = LoginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()))
+            if (failed_logins >= MaxWrongPassCount)
             {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
+                uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+                bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
 
-                if (failed_logins >= MaxWrongPassCount)
+                if (WrongPassBanType)
+                {
+                    LoginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
+                                           _accountId, WrongPassBanTime);
+                    BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
+                              _login.c_str(), WrongPassBanTime, failed_logins);
+                }
+                else
                 {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
-
-                    if (WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
-                                               acc_id, WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                                  _login.c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = get_remote_address();
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                                               current_ip.c_str(), WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                                  current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
-                    }
+                    std::string current_ip = get_remote_address();
+                    sLoginGuard.AddIpBan(current_ip, WrongPassBanTime);
+
+                    LoginDatabase.escape_string(current_ip);
+                    LoginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+                                           current_ip.c_str(), WrongPassBanTime);
+                    BASIC_LOG("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
+                              current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
                 }
-                delete loginfail;
             }
         }
     }
-    return true;
 }
 
 /// Reconnect Challenge command handler
@@ -787,21 +919,25 @@ bool AuthSocket::_HandleReconnectChallenge()
     
     EndianConvert(ch->build);
     _build = ch->build;
-    
-    QueryResult* result = LoginDatabase.PQuery("SELECT sessionkey FROM account WHERE username = '%s'", _safelogin.c_str());
-    
+
+    // the session key was just written by the world server, so it is read from the primary
+    return StartQuery<&AuthSocket::_ReconnectChallengeSessionKeyLoaded>("SELECT sessionkey FROM account WHERE username = '%s'", _safelogin.c_str());
+}
+
+void AuthSocket::_ReconnectChallengeSessionKeyLoaded(QueryResult* result)
+{
     // Stop if the account is not found
     if (!result)
     {
         sLog.outError("[ERROR] user %s tried to login and we can not find his session key in the database.", _login.c_str());
         close_connection();
-        return false;
+        return;
     }
-    
+
     Field* fields = result->Fetch();
     K.SetHexStr(fields[0].GetString());
     delete result;
-    
+
     ///- Sending response
     ByteBuffer pkt;
     pkt << (uint8)  CMD_AUTH_RECONNECT_CHALLENGE;
@@ -810,7 +946,7 @@ bool AuthSocket::_HandleReconnectChallenge()
     pkt.append(_reconnectProof.AsByteArray(16), 16);        // 16 bytes random
     pkt << (uint64) 0x00 << (uint64) 0x00;                  // 16 bytes zeros
     send((char const*)pkt.contents(), pkt.size());
-    return true;
+    ResumeRead();
 }
 
 /// Reconnect Proof command handler
@@ -866,40 +1002,72 @@ bool AuthSocket::_HandleRealmList()
     if (recv_len() < 5)
         { return false; }
     recv_skip(5);
-    
-    ///- Get the user id (else close the connection)
-    // No SQL injection (escaped user name)
-    
-    QueryResult* result = LoginDatabase.PQuery("SELECT id,sha_pass_hash FROM account WHERE username = '%s'", _safelogin.c_str());
+
+    ///- Update realm list if need
+    sRealmList.UpdateIfNeed();
+
+    ///- Get the user id with the characters on each realm in one go (else close the connection)
+    return StartQuery<&AuthSocket::_RealmListAccountLoaded>("SELECT a.id, rc.realmid, rc.numchars FROM account a "
+            "LEFT JOIN realmcharacters rc ON rc.acctid = a.id WHERE a.username = '%s'", _safelogin.c_str());
+}
+
+void AuthSocket::_RealmListAccountLoaded(QueryResult* result)
+{
     if (!result)
     {
         sLog.outError("[ERROR] user %s tried to login and we can not find him in the database.", _login.c_str());
         close_connection();
-        return false;
+        return;
     }
-    
-    uint32 id = (*result)[0].GetUInt32();
-    std::string rI = (*result)[1].GetCppString();
+
+    std::map<uint32, uint8> charCounts;
+    do
+    {
+        Field* fields = result->Fetch();
+        if (!fields[1].IsNULL())                            // no realmcharacters rows at all
+            { charCounts[fields[1].GetUInt32()] = fields[2].GetUInt8(); }
+    }
+    while (result->NextRow());
     delete result;
-    
-    ///- Update realm list if need
-    sRealmList.UpdateIfNeed();
-    
+
     ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
     ByteBuffer pkt;
-    LoadRealmlist(pkt, id);
-    
+    LoadRealmlist(pkt, charCounts);
+
     ByteBuffer hdr;
     hdr << (uint8) CMD_REALM_LIST;
     hdr << (uint16)pkt.size();
     hdr.append(pkt);
-    
+
     send((char const*)hdr.contents(), hdr.size());
-    return true;
+    ResumeRead();
 }
 
-void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
+void AuthSocket::LoadRealmlist(ByteBuffer& pkt, std::map<uint32, uint8> const& charCounts)
 {
+    RealmList::RealmListPacket const* cached = sRealmList.FindCachedPacket(_build, _accountSecurityLevel);
+    if (!cached)
+    {
+        RealmList::RealmListPacket& packet = sRealmList.CachePacket(_build, _accountSecurityLevel);
+        BuildRealmlist(packet);
+        cached = &packet;
+    }
+
+    size_t start = pkt.wpos();
+    pkt.append(cached->body);
+
+    for (std::vector<std::pair<size_t, uint32> >::const_iterator itr = cached->charCountPositions.begin(); itr != cached->charCountPositions.end(); ++itr)
+    {
+        std::map<uint32, uint8>::const_iterator count = charCounts.find(itr->second);
+        if (count != charCounts.end())
+            { pkt.put<uint8>(start + itr->first, count->second); }
+    }
+}
+
+void AuthSocket::BuildRealmlist(RealmList::RealmListPacket& packet)
+{
+    ByteBuffer& pkt = packet.body;
+
     RealmList::RealmListIterators iters;
     iters = sRealmList.GetIteratorsForBuild(_build);
     uint32 numRealms = sRealmList.NumRealmsForBuild(_build);
@@ -917,19 +1085,6 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
                  itr != iters.second;
                  ++itr)
             {
-                uint8 AmountOfCharacters;
-                
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult* result = LoginDatabase.PQuery("SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", (*itr)->m_ID, acctid);
-                if (result)
-                {
-                    Field* fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
-                
                 bool ok_build = std::find((*itr)->realmbuilds.begin(), (*itr)->realmbuilds.end(), _build) != (*itr)->realmbuilds.end();
                 
                 RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(_build) : NULL;
@@ -956,7 +1111,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
                 pkt << name;                                // name
                 pkt << (*itr)->address;                   // address
                 pkt << float((*itr)->populationLevel);
-                pkt << uint8(AmountOfCharacters);
+                packet.charCountPositions.push_back(std::make_pair(pkt.wpos(), (*itr)->m_ID));
+                pkt << uint8(0);                            // characters of the account, patched in by LoadRealmlist
                 pkt << uint8((*itr)->timezone);           // realm category
                 pkt << uint8(0x00);                         // unk, may be realm number/id?
             }
@@ -980,19 +1136,6 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
                  itr != iters.second;
                  ++itr)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult* result = LoginDatabase.PQuery("SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", (*itr)->m_ID, acctid);
-                if (result)
-                {
-                    Field* fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    { AmountOfCharacters = 0; }
-
                 bool ok_build = std::find((*itr)->realmbuilds.begin(), (*itr)->realmbuilds.end(), _build) != (*itr)->realmbuilds.end();
 
                 RealmBuildInfo const* buildInfo = ok_build ? FindBuildInfo(_build) : NULL;
@@ -1016,7 +1159,8 @@ void AuthSocket::LoadRealmlist(ByteBuffer& pkt, uint32 acctid)
                 pkt << (*itr)->name;                            // name
                 pkt << (*itr)->address;                   // address
                 pkt << float((*itr)->populationLevel);
-                pkt << uint8(AmountOfCharacters);
+                packet.charCountPositions.push_back(std::make_pair(pkt.wpos(), (*itr)->m_ID));
+                pkt << uint8(0);                            // characters of the account, patched in by LoadRealmlist
                 pkt << uint8((*itr)->timezone);           // realm category (Cfg_Categories.dbc)
                 pkt << uint8(0x2C);                         // unk, may be realm number/id?
 
@@ -35,6 +35,12 @@
 #include "ByteBuffer.h"
 
 #include "BufferedSocket.h"
+#include "SRP6Worker.h"
+#include "RealmList.h"
+
+#include <map>
+
+class QueryResult;
 
 /**
  * @brief Handle login commands
@@ -73,12 +79,18 @@ class AuthSocket: public BufferedSocket
          */
         void SendProof(Sha1Hash sha);
         /**
-         * @brief
+         * @brief appends the realm list cached for the build and security level with the character counts of the account
          *
          * @param pkt
-         * @param acctid
+         * @param charCounts number of characters of the account by realm id
+         */
+        void LoadRealmlist(ByteBuffer& pkt, std::map<uint32, uint8> const& charCounts);
+
+        /**
+         * @brief continues the logons whose proof was computed by SRP6Worker, called by the reactor thread
+         *
          */
-        void LoadRealmlist(ByteBuffer& pkt, uint32 acctid);
+        static void ProcessComputedProofs();
 
         /**
          * @brief
@@ -138,6 +150,44 @@ class AuthSocket: public BufferedSocket
         void _SetVSFields(const std::string& rI);
 
     private:
+        /**
+         * @brief async LoginDatabase query callback, calls the method of the socket if it was not closed meanwhile
+         *
+         * The handlers issue async queries instead of waiting for the database on the reactor thread.
+         * The socket reads no further commands until the result arrived and the method was called.
+         *
+         * @param result
+         * @param socketId
+         */
+        template<void (AuthSocket::*Method)(QueryResult*)>
+        static void QueryCallback(QueryResult* result, uint32 socketId);
+        /**
+         * @brief issues an async query whose result is passed to the method of this socket
+         *
+         * @param format...
+         * @return bool
+         */
+        template<void (AuthSocket::*Method)(QueryResult*)>
+        bool StartQuery(const char* format, ...) ATTR_PRINTF(2, 3);
+        /**
+         * @brief reads the commands received while an async query was running
+         *
+         */
+        void ResumeRead();
+        /**
+         * @brief serializes the realms for the build and security level of this socket
+         *
+         * @param packet
+         */
+        void BuildRealmlist(RealmList::RealmListPacket& packet);
+
+        void _LogonChallengeAccountLoaded(QueryResult* result);
+        void _ReconnectChallengeSessionKeyLoaded(QueryResult* result);
+        void _RealmListAccountLoaded(QueryResult* result);
+        void _LogonProofComputed(SRP6Worker::ProofRequest const& request);
+
+        uint32 _socketId;                                   // id of the socket in QueryCallback
+        bool _waitingForResult;                             // input is not read until the async query or SRP6Worker result arrived
 
         BigNumber N, s, g, v; /**< TODO */
         BigNumber b, B; /**< TODO */
@@ -152,6 +202,9 @@ class AuthSocket: public BufferedSocket
         std::string _localizationName; /**< Since GetLocaleByName() is _NOT_ bijective, we have to store the locale as a string. Otherwise we can't differ between enUS and enGB, which is important for the patch system */
         uint16 _build; /**< TODO */
         AccountTypes _accountSecurityLevel; /**< TODO */
+        uint32 _accountId;                                  // sent to the world servers with the session key
+        uint64 _muteTime;
+        uint32 _storedFailedLogins;                         // failed_logins of the account at the logon challenge
 
         ACE_HANDLE patch_; /**< TODO */
 
@@ -0,0 +1,197 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/** \file
+  \ingroup realmd
+  */
+
+#include "LoginGuard.h"
+#include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
+#include "Log.h"
+
+#include <ace/OS_NS_sys_time.h>
+
+/// ms since the epoch, for the attempt buckets
+static uint64 GetNowMs()
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * 1000 + now.usec() / 1000;
+}
+
+LoginGuard::LoginGuard() :
+    m_attemptsPerMs(0.0), m_attemptsBurst(0.0), m_syncInterval(60), m_nextSyncTime(0)
+{
+}
+
+LoginGuard& LoginGuard::Instance()
+{
+    static LoginGuard guard;
+    return guard;
+}
+
+void LoginGuard::Initialize(uint32 attemptsPerMinute, uint32 attemptsBurst, uint32 syncInterval)
+{
+    m_attemptsPerMs = attemptsPerMinute / 60000.0;
+    m_attemptsBurst = attemptsBurst ? double(attemptsBurst) : 1.0;
+    m_syncInterval = syncInterval ? syncInterval : 1;
+    m_nextSyncTime = time(NULL) + m_syncInterval;
+
+    LoadIpBans(LoginDatabase.Query("SELECT ip, bandate, unbandate FROM ip_banned WHERE unbandate = bandate OR unbandate > UNIX_TIMESTAMP()"));
+}
+
+void LoginGuard::Update()
+{
+    time_t now = time(NULL);
+    if (now < m_nextSyncTime)
+        { return; }
+
+    m_nextSyncTime = now + m_syncInterval;
+
+    SaveFailedLogins();
+
+    // accounts not failing for a while are read from failed_logins again
+    for (FailedLoginsMap::iterator itr = m_failedLogins.begin(); itr != m_failedLogins.end();)
+    {
+        if (!itr->second.dirty && itr->second.lastTime + time_t(m_syncInterval) * 5 < now)
+            { m_failedLogins.erase(itr++); }
+        else
+            { ++itr; }
+    }
+
+    // full buckets are the same as none
+    uint64 nowMs = GetNowMs();
+    for (AttemptBucketMap::iterator itr = m_attemptBuckets.begin(); itr != m_attemptBuckets.end();)
+    {
+        if (itr->second.tokens + (nowMs - itr->second.lastTime) * m_attemptsPerMs >= m_attemptsBurst)
+            { m_attemptBuckets.erase(itr++); }
+        else
+            { ++itr; }
+    }
+
+    // the bans of the GMs are applied with the next reload
+    LoginDatabase.AsyncQuery(this, &LoginGuard::LoadIpBans, "SELECT ip, bandate, unbandate FROM ip_banned WHERE unbandate = bandate OR unbandate > UNIX_TIMESTAMP()");
+}
+
+void LoginGuard::LoadIpBans(QueryResult* result)
+{
+    m_ipBans.clear();
+
+    if (!result)
+        { return; }
+
+    do
+    {
+        Field* fields = result->Fetch();
+        uint64 bandate = fields[1].GetUInt64();
+        uint64 unbandate = fields[2].GetUInt64();
+        m_ipBans[fields[0].GetCppString()] = unbandate == bandate ? 0 : time_t(unbandate);
+    }
+    while (result->NextRow());
+
+    delete result;
+}
+
+void LoginGuard::SaveFailedLogins()
+{
+    bool started = false;
+
+    for (FailedLoginsMap::iterator itr = m_failedLogins.begin(); itr != m_failedLogins.end(); ++itr)
+    {
+        if (!itr->second.dirty)
+            { continue; }
+
+        if (!started)
+        {
+            LoginDatabase.BeginTransaction();
+            started = true;
+        }
+
+        LoginDatabase.PExecute("UPDATE account SET failed_logins = %u WHERE id = %u", itr->second.count, itr->first);
+        itr->second.dirty = false;
+    }
+
+    if (started)
+        { LoginDatabase.CommitTransaction(); }
+}
+
+bool LoginGuard::AdmitAttempt(std::string const& ip)
+{
+    if (m_attemptsPerMs <= 0.0)
+        { return true; }
+
+    uint64 now = GetNowMs();
+
+    AttemptBucketMap::iterator itr = m_attemptBuckets.find(ip);
+    if (itr == m_attemptBuckets.end())
+    {
+        AttemptBucket bucket;
+        bucket.tokens = m_attemptsBurst;
+        bucket.lastTime = now;
+        itr = m_attemptBuckets.insert(AttemptBucketMap::value_type(ip, bucket)).first;
+    }
+
+    AttemptBucket& bucket = itr->second;
+    bucket.tokens = std::min(m_attemptsBurst, bucket.tokens + (now - bucket.lastTime) * m_attemptsPerMs);
+    bucket.lastTime = now;
+
+    if (bucket.tokens < 1.0)
+        { return false; }
+
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+bool LoginGuard::IsIpBanned(std::string const& ip) const
+{
+    IpBanMap::const_iterator itr = m_ipBans.find(ip);
+    return itr != m_ipBans.end() && (!itr->second || itr->second > time(NULL));
+}
+
+void LoginGuard::AddIpBan(std::string const& ip, uint32 duration)
+{
+    m_ipBans[ip] = duration ? time(NULL) + duration : 0;
+}
+
+uint32 LoginGuard::AddFailedLogin(uint32 accountId, uint32 storedFailedLogins)
+{
+    FailedLoginsMap::iterator itr = m_failedLogins.find(accountId);
+    if (itr == m_failedLogins.end())
+    {
+        FailedLogins failed;
+        failed.count = storedFailedLogins;
+        itr = m_failedLogins.insert(FailedLoginsMap::value_type(accountId, failed)).first;
+    }
+
+    ++itr->second.count;
+    itr->second.lastTime = time(NULL);
+    itr->second.dirty = true;
+    return itr->second.count;
+}
+
+void LoginGuard::ResetFailedLogins(uint32 accountId)
+{
+    m_failedLogins.erase(accountId);
+}
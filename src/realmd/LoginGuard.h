@@ -0,0 +1,124 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef MANGOS_H_LOGINGUARD
+#define MANGOS_H_LOGINGUARD
+
+#include "Common.h"
+
+#include <map>
+
+class QueryResult;
+
+/**
+ * @brief keeps the logon attempts of brute force and scanning traffic away from the login database
+ *
+ * The logon challenges of an IP are limited by a token bucket before anything is looked up. The IP
+ * bans are checked against a copy of the ip_banned table reloaded in an interval, and the wrong
+ * passwords are counted here and written to failed_logins in the same interval.
+ * Used by the reactor thread only.
+ */
+class LoginGuard
+{
+    public:
+        static LoginGuard& Instance();
+
+        /**
+         * @brief loads the IP bans
+         *
+         * @param attemptsPerMinute logon challenges an IP may start per minute, 0 for no limit
+         * @param attemptsBurst logon challenges an IP may start at once
+         * @param syncInterval seconds between reloading the IP bans and writing the failed logins
+         */
+        void Initialize(uint32 attemptsPerMinute, uint32 attemptsBurst, uint32 syncInterval);
+
+        /// Reloads the IP bans and writes the failed logins when the interval passed
+        void Update();
+        /// Writes the counted failed logins, also at shutdown
+        void SaveFailedLogins();
+
+        /// Takes a logon attempt of the IP from its bucket, false if none is left
+        bool AdmitAttempt(std::string const& ip);
+
+        bool IsIpBanned(std::string const& ip) const;
+        /**
+         * @brief bans the IP without waiting for the next reload
+         *
+         * @param ip
+         * @param duration seconds, 0 for a permanent ban
+         */
+        void AddIpBan(std::string const& ip, uint32 duration);
+
+        /**
+         * @brief counts a wrong password of the account
+         *
+         * @param accountId
+         * @param storedFailedLogins failed_logins read at the logon challenge, used when the account is not counted yet
+         * @return uint32 failed logins since the last successful one
+         */
+        uint32 AddFailedLogin(uint32 accountId, uint32 storedFailedLogins);
+        /// The account logged on, its failed_logins is reset by the caller
+        void ResetFailedLogins(uint32 accountId);
+
+    private:
+        LoginGuard();
+
+        void LoadIpBans(QueryResult* result);
+
+        struct AttemptBucket
+        {
+            double tokens;
+            uint64 lastTime;                                // ms
+        };
+
+        struct FailedLogins
+        {
+            uint32 count;
+            time_t lastTime;
+            bool dirty;                                     // not written to failed_logins yet
+        };
+
+        typedef std::map<std::string, AttemptBucket> AttemptBucketMap;
+        typedef std::map<std::string, time_t> IpBanMap;     // unban time, 0 for permanent bans
+        typedef std::map<uint32, FailedLogins> FailedLoginsMap;
+
+        AttemptBucketMap m_attemptBuckets;
+        IpBanMap m_ipBans;
+        FailedLoginsMap m_failedLogins;
+
+        double m_attemptsPerMs;
+        double m_attemptsBurst;
+        uint32 m_syncInterval;
+        time_t m_nextSyncTime;
+};
+
+#define sLoginGuard LoginGuard::Instance()
+
+#endif
+/// @}
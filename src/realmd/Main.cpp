@@ -33,6 +33,9 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "SRP6Worker.h"
+#include "SessionKeyPublisher.h"
+#include "LoginGuard.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "revision_nr.h"
@@ -326,8 +329,15 @@ extern int main(int argc, char** argv)
     // server has started up successfully => enable async DB requests
     LoginDatabase.AllowAsyncTransactions();
 
+    sLoginGuard.Initialize(sConfig.GetIntDefault("LoginRate.PerMinute", 30), sConfig.GetIntDefault("LoginRate.Burst", 10),
+                           sConfig.GetIntDefault("LoginGuard.SyncInterval", 60));
+
+    sSessionKeyPublisher.Initialize(sConfig.GetStringDefault("SessionKey.PublishAddresses", ""), sConfig.GetStringDefault("SessionKey.Secret", ""));
+
+    sSRP6Worker.Activate(sConfig.GetIntDefault("SRP6.Threads", 1), sConfig.GetIntDefault("SRP6.PrecomputedKeys", 256));
+
     // maximum counter for next ping
-    uint32 numLoops = (sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000000 / 100000));
+    uint32 numLoops = (sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000000 / 10000));
     uint32 loopCounter = 0;
 
 #ifndef WIN32
@@ -337,11 +347,16 @@ extern int main(int argc, char** argv)
     while (!stopEvent)
     {
         // dont move this outside the loop, the reactor will modify it
-        ACE_Time_Value interval(0, 100000);
+        // kept short, the results of the account lookups are only handed to the sockets between the loops
+        ACE_Time_Value interval(0, 10000);
 
         if (ACE_Reactor::instance()->run_reactor_event_loop(interval) == -1)
             { break; }
 
+        LoginDatabase.ProcessResultQueue();
+        AuthSocket::ProcessComputedProofs();
+        sLoginGuard.Update();
+
         if ((++loopCounter) == numLoops)
         {
             loopCounter = 0;
@@ -354,6 +369,9 @@ extern int main(int argc, char** argv)
 #endif
     }
 
+    sSRP6Worker.Deactivate();
+    sLoginGuard.SaveFailedLogins();
+
     ///- Wait for the delay thread to exit
     LoginDatabase.HaltDelayThread();
 
@@ -361,6 +379,7 @@ extern int main(int argc, char** argv)
     UnhookSignals();
 
     sLog.outString("Halting process...");
+    sLog.StopAsyncWriter();
     return 0;
 }
 
@@ -396,7 +415,8 @@ bool StartDB()
 
     sLog.outString("Login Database total connections: %i", 1 + 1);
 
-    if (!LoginDatabase.Initialize(dbstring.c_str()))
+    std::string replicas = sConfig.GetStringDefault("LoginDatabaseReplicas", "");
+    if (!LoginDatabase.Initialize(dbstring.c_str(), 1, 1, replicas.c_str()))
     {
         sLog.outError("Can not connect to database");
         return false;
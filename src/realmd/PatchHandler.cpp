@@ -30,14 +30,23 @@
 #include "PatchHandler.h"
 #include "AuthCodes.h"
 #include "Log.h"
+#include "Config/Config.h"
 
 #include <ace/OS_NS_sys_socket.h>
+#include <ace/OS_NS_sys_stat.h>
+#include <ace/OS_NS_sys_time.h>
 #include <ace/OS_NS_dirent.h>
 #include <ace/OS_NS_errno.h>
 #include <ace/OS_NS_unistd.h>
+#include <ace/OS_NS_signal.h>
+#include <ace/OS_NS_Thread.h>
 
 #include <ace/os_include/netinet/os_tcp.h>
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
 #ifndef MSG_NOSIGNAL
 #define MSG_NOSIGNAL 0
 #endif
@@ -115,6 +124,49 @@ int PatchHandler::svc(void)
     Chunk data;
     data.cmd = CMD_XFER_DATA;
 
+    // bytes per second, 0 for no limit
+    uint64 rate = uint64(sConfig.GetIntDefault("PatchTransferRate", 0)) * 1024;
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    uint64 sent = 0;
+
+#if defined(__linux__)
+    // sendfile is not stopped by MSG_NOSIGNAL, a closed connection has to return EPIPE instead of killing realmd
+    sigset_t sigpipe;
+    ACE_OS::sigemptyset(&sigpipe);
+    ACE_OS::sigaddset(&sigpipe, SIGPIPE);
+    ACE_OS::thr_sigsetmask(SIG_BLOCK, &sigpipe, NULL);
+
+    // the chunks are sent from the page cache by the kernel, only their headers pass through here
+    // a resumed transfer starts later in the file
+    ACE_OFF_T size = ACE_OS::filesize(patch_fd_);
+    ACE_OFF_T offset = ACE_OS::lseek(patch_fd_, 0, SEEK_CUR);
+    if (size == -1 || offset == -1)
+        { return -1; }
+
+    while (offset < size)
+    {
+        size_t chunk = size_t(std::min<ACE_OFF_T>(sizeof(data.data), size - offset));
+        data.data_size = (ACE_UINT16)chunk;
+
+        if (peer().send((const char*)&data, sizeof(data) - sizeof(data.data), flags) == -1)
+            { return -1; }
+
+        off_t pos = offset;
+        while (pos < offset + ACE_OFF_T(chunk))
+        {
+            ssize_t r = sendfile(get_handle(), patch_fd_, &pos, size_t(offset + ACE_OFF_T(chunk) - pos));
+            if (r == -1 && errno == EINTR)
+                { continue; }
+
+            if (r <= 0)
+                { return -1; }
+        }
+
+        offset += chunk;
+        sent += chunk;
+        Throttle(rate, start, sent);
+    }
+#else
     ssize_t r;
 
     while ((r = ACE_OS::read(patch_fd_, data.data, sizeof(data.data))) > 0)
@@ -127,16 +179,34 @@ int PatchHandler::svc(void)
         {
             return -1;
         }
+
+        sent += r;
+        Throttle(rate, start, sent);
     }
 
     if (r == -1)
     {
         return -1;
     }
+#endif
 
     return 0;
 }
 
+void PatchHandler::Throttle(ACE_UINT64 rate, ACE_Time_Value const& start, ACE_UINT64 sent)
+{
+    if (!rate)
+        { return; }
+
+    // sleep until the time the sent bytes are allowed to take at the rate
+    ACE_Time_Value due = start;
+    due += ACE_Time_Value(time_t(sent / rate), suseconds_t((sent % rate) * 1000000 / rate));
+
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    if (due > now)
+        { ACE_OS::sleep(due - now); }
+}
+
 PatchCache::~PatchCache()
 {
     for (Patches::iterator i = patches_.begin(); i != patches_.end(); ++i)
@@ -158,6 +228,41 @@ void PatchCache::LoadPatchMD5(const char* szFileName)
     // Try to open the patch file
     std::string path = "./patches/";
     path += szFileName;
+
+    ACE_stat st;
+    if (ACE_OS::stat(path.c_str(), &st) != 0)
+        { return; }
+
+    uint64 fileSize = uint64(st.st_size);
+    uint64 fileTime = uint64(st.st_mtime);
+
+    // The hash of an unchanged patch is read from its .md5 file
+    std::string md5Path = path + ".md5";
+    if (FILE* pCache = fopen(md5Path.c_str(), "r"))
+    {
+        unsigned long long cachedSize, cachedTime;
+        char hex[MD5_DIGEST_LENGTH * 2 + 1];
+        bool valid = fscanf(pCache, "%llu %llu %32s", &cachedSize, &cachedTime, hex) == 3 &&
+                     cachedSize == fileSize && cachedTime == fileTime && strlen(hex) == MD5_DIGEST_LENGTH * 2;
+        fclose(pCache);
+
+        if (valid)
+        {
+            PATCH_INFO* info = new PATCH_INFO;
+            for (int i = 0; i < MD5_DIGEST_LENGTH; ++i)
+            {
+                unsigned int byte;
+                sscanf(&hex[i * 2], "%2x", &byte);
+                info->md5[i] = ACE_UINT8(byte);
+            }
+
+            delete patches_[path];
+            patches_[path] = info;
+            sLog.outDebug("Loaded patch info of %s from %s", path.c_str(), md5Path.c_str());
+            return;
+        }
+    }
+
     FILE* pPatch = fopen(path.c_str(), "rb");
     sLog.outDebug("Loading patch info from %s", path.c_str());
 
@@ -181,8 +286,19 @@ void PatchCache::LoadPatchMD5(const char* szFileName)
     fclose(pPatch);
 
     // Store the result in the internal patch hash map
+    delete patches_[path];
     patches_[path] = new PATCH_INFO;
     MD5_Final((ACE_UINT8*) & patches_[path]->md5, &ctx);
+
+    // and next to the patch for the next start
+    if (FILE* pCache = fopen(md5Path.c_str(), "w"))
+    {
+        fprintf(pCache, UI64FMTD " " UI64FMTD " ", fileSize, fileTime);
+        for (int i = 0; i < MD5_DIGEST_LENGTH; ++i)
+            { fprintf(pCache, "%02x", patches_[path]->md5[i]); }
+        fprintf(pCache, "\n");
+        fclose(pCache);
+    }
 }
 
 bool PatchCache::GetHash(const char* pat, ACE_UINT8 mymd5[MD5_DIGEST_LENGTH])
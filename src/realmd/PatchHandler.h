@@ -157,6 +157,15 @@ class PatchHandler: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
         virtual int svc(void) override;
 
     private:
+        /**
+         * @brief sleeps while the transfer is ahead of PatchTransferRate
+         *
+         * @param rate bytes per second, 0 for no limit
+         * @param start time the transfer started
+         * @param sent bytes sent since start
+         */
+        static void Throttle(ACE_UINT64 rate, ACE_Time_Value const& start, ACE_UINT64 sent);
+
         ACE_HANDLE patch_fd_; /**< TODO */
 };
 
@@ -32,6 +32,7 @@
 #include "Util.h"                                           // for Tokens typedef
 #include "Policies/Singleton.h"
 #include "Database/DatabaseEnv.h"
+#include "Database/DatabaseImpl.h"
 
 INSTANTIATE_SINGLETON_1(RealmList);
 
@@ -120,6 +121,20 @@ uint32 RealmList::NumRealmsForBuild(uint32 build) const
     return m_realmsByVersion[BelongsToVersion(build)].size();
 }
 
+RealmList::RealmListPacket const* RealmList::FindCachedPacket(uint32 build, AccountTypes security) const
+{
+    RealmListPacketMap::const_iterator itr = m_packetCache.find(std::make_pair(build, security));
+    return itr != m_packetCache.end() ? &itr->second : NULL;
+}
+
+RealmList::RealmListPacket& RealmList::CachePacket(uint32 build, AccountTypes security)
+{
+    RealmListPacket& packet = m_packetCache[std::make_pair(build, security)];
+    packet.body.clear();
+    packet.charCountPositions.clear();
+    return packet;
+}
+
 void RealmList::AddRealmToBuildList(const Realm& realm)
 {
     RealmBuilds builds = realm.realmbuilds;
@@ -208,11 +223,6 @@ void RealmList::UpdateIfNeed()
 
     m_NextUpdateTime = time(NULL) + m_UpdateInterval;
 
-    // Clears Realm list
-    m_realms.clear();
-    for (int i = 0; i < REALM_VERSION_COUNT; ++i)
-        m_realmsByVersion[i].clear();
-    
     // Get the content of the realmlist table in the database
     UpdateRealms(false);
 }
@@ -221,8 +231,23 @@ void RealmList::UpdateRealms(bool init)
 {
     DETAIL_LOG("Updating Realm List...");
 
-    ////                                               0   1     2        3     4     5           6         7                     8           9
-    QueryResult* result = LoginDatabase.Query("SELECT id, name, address, port, icon, realmflags, timezone, allowedSecurityLevel, population, realmbuilds FROM realmlist WHERE (realmflags & 1) = 0 ORDER BY name");
+    ////                       0   1     2        3     4     5           6         7                     8           9
+    char const* query = "SELECT id, name, address, port, icon, realmflags, timezone, allowedSecurityLevel, population, realmbuilds FROM realmlist WHERE (realmflags & 1) = 0 ORDER BY name";
+
+    // the realm list sent meanwhile is the one of the last update
+    if (init)
+        { LoadRealms(LoginDatabase.Query(query), true); }
+    else
+        { LoginDatabase.AsyncQuery(this, &RealmList::LoadRealms, false, query); }
+}
+
+void RealmList::LoadRealms(QueryResult* result, bool init)
+{
+    // Clears Realm list
+    m_packetCache.clear();
+    m_realms.clear();
+    for (int i = 0; i < REALM_VERSION_COUNT; ++i)
+        { m_realmsByVersion[i].clear(); }
 
     ///- Circle through results and add them to the realm map
     if (result)
@@ -30,6 +30,9 @@
 #define MANGOS_H_REALMLIST
 
 #include "Common.h"
+#include "ByteBuffer.h"
+
+class QueryResult;
 
 /**
  * @brief
@@ -102,6 +105,18 @@ class RealmList
         typedef std::list<const Realm*> RealmStlList;
         typedef std::pair<RealmStlList::const_iterator, RealmStlList::const_iterator> RealmListIterators;
         typedef std::map<uint32, RealmVersion> RealmBuildVersionMap;
+
+        /**
+         * @brief realm list packet body of one client build and account security level
+         *
+         * The character counts differ by account, they are written as 0 and patched in at the
+         * positions listed for each realm.
+         */
+        struct RealmListPacket
+        {
+            ByteBuffer body;
+            std::vector<std::pair<size_t, uint32> > charCountPositions; ///< byte position in body and realm id
+        };
         
         /**
          * @brief
@@ -158,7 +173,26 @@ class RealmList
          * \see RealmList::NumRealmsForBuild
          */
         uint32 size() const { return m_realms.size(); };
+
+        /**
+         * @brief packet cached for the build and security level since the last realm list update
+         *
+         * @param build
+         * @param security
+         * @return RealmListPacket NULL if not built yet
+         */
+        RealmListPacket const* FindCachedPacket(uint32 build, AccountTypes security) const;
+        /**
+         * @brief empty packet to be filled and kept until the next realm list update
+         *
+         * @param build
+         * @param security
+         * @return RealmListPacket
+         */
+        RealmListPacket& CachePacket(uint32 build, AccountTypes security);
     private:
+        typedef std::map<std::pair<uint32, AccountTypes>, RealmListPacket> RealmListPacketMap;
+
         /** 
          * Checks what version (ie, vanilla, tbc) a certain build number belongs to
          * @param build the build you want to check the version for
@@ -186,7 +220,19 @@ class RealmList
          */
         void AddRealmToBuildList(const Realm& realm);
     
+        /**
+         * @brief loads the realmlist table, synchronous at init, else the list is replaced when the result arrives
+         *
+         * @param init
+         */
         void UpdateRealms(bool init);
+        /**
+         * @brief replaces the realms by the rows of the realmlist table
+         *
+         * @param result
+         * @param init
+         */
+        void LoadRealms(QueryResult* result, bool init);
         /**
          * @brief
          *
@@ -206,6 +252,7 @@ class RealmList
         RealmMap m_realms;                                    ///< Internal map of realms
         RealmStlList m_realmsByVersion[REALM_VERSION_COUNT]; ///< This sorts the realms by their supported build
         RealmBuildVersionMap m_buildToVersion;
+        RealmListPacketMap m_packetCache;                   ///< Realm list packets by build and security level
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
 };
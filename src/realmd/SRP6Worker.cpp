@@ -0,0 +1,165 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/** \file
+  \ingroup realmd
+  */
+
+#include "SRP6Worker.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+
+SRP6Worker::SRP6Worker() :
+    m_condition(m_lock), m_poolSize(0), m_threadCount(0), m_stopping(false)
+{
+    m_N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
+    m_g.SetDword(7);
+}
+
+SRP6Worker& SRP6Worker::Instance()
+{
+    static SRP6Worker worker;
+    return worker;
+}
+
+int SRP6Worker::Activate(uint32 numThreads, uint32 poolSize)
+{
+    if (IsActive() || numThreads == 0)
+        { return 0; }
+
+    m_stopping = false;
+    m_poolSize = poolSize;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, int(numThreads)) == -1)
+    {
+        sLog.outError("SRP6Worker: can't start %u threads, logons are computed by the network thread", numThreads);
+        return -1;
+    }
+
+    m_threadCount = numThreads;
+    return 0;
+}
+
+void SRP6Worker::Deactivate()
+{
+    if (!IsActive())
+        { return; }
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        m_stopping = true;
+        m_condition.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+    m_threadCount = 0;
+
+    for (ProofQueue::const_iterator itr = m_doneProofs.begin(); itr != m_doneProofs.end(); ++itr)
+        { delete *itr; }
+    m_doneProofs.clear();
+}
+
+bool SRP6Worker::TakeEphemeral(BigNumber& b, BigNumber& gmod)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
+    if (m_ephemerals.empty())
+        { return false; }
+
+    b = m_ephemerals.front().b;
+    gmod = m_ephemerals.front().gmod;
+    m_ephemerals.pop_front();
+
+    m_condition.signal();                                   // refill
+    return true;
+}
+
+void SRP6Worker::QueueProof(ProofRequest* request)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    m_proofs.push_back(request);
+    m_condition.signal();
+}
+
+SRP6Worker::ProofRequest* SRP6Worker::TakeDoneProof()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+
+    if (m_doneProofs.empty())
+        { return NULL; }
+
+    ProofRequest* request = m_doneProofs.front();
+    m_doneProofs.pop_front();
+    return request;
+}
+
+int SRP6Worker::svc()
+{
+    // BigNumber operations change the number, so every thread has its own copies
+    BigNumber N = m_N;
+    BigNumber g = m_g;
+
+    for (;;)
+    {
+        ProofRequest* request = NULL;
+
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+            while (m_proofs.empty() && m_ephemerals.size() >= m_poolSize && !m_stopping)
+                { m_condition.wait(); }
+
+            if (!m_proofs.empty())
+            {
+                request = m_proofs.front();
+                m_proofs.pop_front();
+            }
+            else if (m_stopping)
+                { break; }                                  // stopping and no proof left
+        }
+
+        if (request)
+        {
+            request->S = (request->A * (request->v.ModExp(request->u, N))).ModExp(request->b, N);
+
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+            m_doneProofs.push_back(request);
+            continue;
+        }
+
+        // precomputing only when no logon is waiting
+        Ephemeral ephemeral;
+        ephemeral.b.SetRand(19 * 8);
+        ephemeral.gmod = g.ModExp(ephemeral.b, N);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+        if (m_ephemerals.size() < m_poolSize)
+            { m_ephemerals.push_back(ephemeral); }
+    }
+
+    return 0;
+}
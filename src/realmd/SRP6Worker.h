@@ -0,0 +1,117 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef MANGOS_H_SRP6WORKER
+#define MANGOS_H_SRP6WORKER
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+/**
+ * @brief thread pool doing the expensive SRP6 modular exponentiations of the logons
+ *
+ * Between the proofs the threads fill a pool of random b with g^b mod N, the challenges
+ * take them from there instead of computing g^b on the reactor thread. The proofs of the
+ * clients are queued and handed back with the computed S to the reactor thread by TakeDoneProof.
+ */
+class SRP6Worker : protected ACE_Task_Base
+{
+    public:
+        /// (A * v^u)^b mod N of one logon proof
+        struct ProofRequest
+        {
+            uint32 socketId;                                // AuthSocket the result is for
+            BigNumber A, u, v, b;
+            uint8 M1[20];                                   // proof sent by the client
+            BigNumber S;                                    // result
+        };
+
+        static SRP6Worker& Instance();
+
+        /// Start numThreads threads keeping up to poolSize precomputed ephemerals, no-op for 0 threads
+        int Activate(uint32 numThreads, uint32 poolSize);
+        /// Stop and join all threads, queued proofs are still computed
+        void Deactivate();
+        bool IsActive() const { return m_threadCount > 0; }
+
+        BigNumber const& GetN() const { return m_N; }
+        BigNumber const& GetG() const { return m_g; }
+
+        /**
+         * @brief takes a precomputed server ephemeral
+         *
+         * @param b random private value
+         * @param gmod g^b mod N
+         * @return bool false if the pool is empty
+         */
+        bool TakeEphemeral(BigNumber& b, BigNumber& gmod);
+
+        /// Computes S in a thread, the request is owned by the worker until TakeDoneProof returned it
+        void QueueProof(ProofRequest* request);
+        /// Returns a computed proof owned by the caller, NULL if there is none
+        ProofRequest* TakeDoneProof();
+
+    protected:
+        int svc() override;
+
+    private:
+        SRP6Worker();
+
+        struct Ephemeral
+        {
+            BigNumber b;
+            BigNumber gmod;
+        };
+
+        typedef std::deque<ProofRequest*> ProofQueue;
+        typedef std::deque<Ephemeral> EphemeralPool;
+
+        BigNumber m_N, m_g;
+
+        ACE_Thread_Mutex m_lock;
+        ACE_Condition_Thread_Mutex m_condition;             // signaled at queued proofs, taken ephemerals and stop
+
+        ProofQueue m_proofs;
+        ProofQueue m_doneProofs;
+        EphemeralPool m_ephemerals;
+        uint32 m_poolSize;
+        uint32 m_threadCount;
+        bool m_stopping;
+};
+
+#define sSRP6Worker SRP6Worker::Instance()
+
+#endif
+/// @}
@@ -0,0 +1,92 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/** \file
+  \ingroup realmd
+  */
+
+#include "SessionKeyPublisher.h"
+#include "Log.h"
+#include "Util.h"
+
+SessionKeyPublisher& SessionKeyPublisher::Instance()
+{
+    static SessionKeyPublisher publisher;
+    return publisher;
+}
+
+bool SessionKeyPublisher::Initialize(std::string const& addresses, std::string const& secret)
+{
+    m_targets.clear();
+    m_secret = secret;
+
+    Tokens tokens = StrSplit(addresses, "|");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        ACE_INET_Addr addr;
+        if (addr.set(itr->c_str()) == -1)
+        {
+            sLog.outError("SessionKey.PublishAddresses: '%s' is not a valid host:port", itr->c_str());
+            m_targets.clear();
+            return false;
+        }
+
+        m_targets.push_back(addr);
+    }
+
+    if (m_targets.empty())
+        { return true; }
+
+    if (m_secret.empty())
+    {
+        sLog.outError("SessionKey.Secret is not set, session keys are not sent to the world servers");
+        m_targets.clear();
+        return false;
+    }
+
+    if (m_socket.open(ACE_Addr::sap_any) == -1)
+    {
+        sLog.outError("Can't open the socket sending the session keys to the world servers");
+        m_targets.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void SessionKeyPublisher::Publish(SessionKeyMessage const& message)
+{
+    if (m_targets.empty())
+        { return; }
+
+    ByteBuffer buf;
+    message.Write(buf, m_secret);
+
+    for (std::vector<ACE_INET_Addr>::const_iterator itr = m_targets.begin(); itr != m_targets.end(); ++itr)
+    {
+        if (m_socket.send(buf.contents(), buf.size(), *itr) == -1)
+            { DEBUG_LOG("Session key of %s not sent to %s", message.account.c_str(), itr->get_host_addr()); }
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef MANGOS_H_SESSIONKEYPUBLISHER
+#define MANGOS_H_SESSIONKEYPUBLISHER
+
+#include "Common.h"
+#include "Auth/SessionKeyMessage.h"
+
+#include <ace/SOCK_Dgram.h>
+#include <ace/INET_Addr.h>
+
+#include <vector>
+
+/**
+ * @brief sends the session keys of the logons to the world servers, see SessionKeyMessage
+ *
+ */
+class SessionKeyPublisher
+{
+    public:
+        static SessionKeyPublisher& Instance();
+
+        /**
+         * @brief opens the socket
+         *
+         * @param addresses '|' separated host:port of the world servers, empty to disable
+         * @param secret shared with the world servers
+         * @return bool false on invalid addresses
+         */
+        bool Initialize(std::string const& addresses, std::string const& secret);
+        bool IsEnabled() const { return !m_targets.empty(); }
+
+        /// Sends the message to all world servers, lost datagrams only cost the world server a database lookup
+        void Publish(SessionKeyMessage const& message);
+
+    private:
+        SessionKeyPublisher() {}
+
+        ACE_SOCK_Dgram m_socket;
+        std::vector<ACE_INET_Addr> m_targets;
+        std::string m_secret;
+};
+
+#define sSessionKeyPublisher SessionKeyPublisher::Instance()
+
+#endif
+/// @}
@@ -30,6 +30,7 @@
 #include "DBCStores.h"
 #include "ObjectMgr.h"
 #include "ProgressBar.h"
+#include "ScriptMgr.h"
 #include "system/ScriptLoader.h"
 #include "system/system.h"
 #include "ScriptDevMgr.h"
@@ -297,6 +298,52 @@ char const* GetScriptLibraryVersion()
     return strSD2Version.c_str();
 }
 
+/**
+ * Function that tells the core which hooks a script implements
+ *
+ * @param uiScriptId Id of the ScriptName, assigned by the core
+ * @return Mask of SCRIPT_HOOK_MASK(ScriptHook) values, the core doesn't call the other hooks for this script
+ */
+MANGOS_DLL_EXPORT
+uint32 GetScriptHooks(uint32 uiScriptId)
+{
+    Script* pTempScript = uiScriptId < m_scripts.size() ? m_scripts[uiScriptId] : NULL;
+
+    if (!pTempScript)
+    {
+        return 0;
+    }
+
+    uint32 uiHooks = 0;
+
+    if (pTempScript->pGossipHello)            { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GOSSIP_HELLO); }
+    if (pTempScript->pGossipHelloGO)          { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_GOSSIP_HELLO); }
+    if (pTempScript->pGossipSelect)           { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GOSSIP_SELECT); }
+    if (pTempScript->pGossipSelectGO)         { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_GOSSIP_SELECT); }
+    if (pTempScript->pGossipSelectWithCode)   { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GOSSIP_SELECT_CODE); }
+    if (pTempScript->pGossipSelectGOWithCode) { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_GOSSIP_SELECT_CODE); }
+    if (pTempScript->pDialogStatusNPC)        { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_DIALOG_STATUS); }
+    if (pTempScript->pDialogStatusGO)         { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_DIALOG_STATUS); }
+    if (pTempScript->pQuestAcceptNPC)         { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_QUEST_ACCEPT); }
+    if (pTempScript->pQuestAcceptGO)          { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_QUEST_ACCEPT); }
+    if (pTempScript->pQuestAcceptItem)        { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_ITEM_QUEST_ACCEPT); }
+    if (pTempScript->pQuestRewardedNPC)       { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_QUEST_REWARDED); }
+    if (pTempScript->pQuestRewardedGO)        { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_QUEST_REWARDED); }
+    if (pTempScript->pGOUse)                  { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_USE); }
+    if (pTempScript->pItemUse)                { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_ITEM_USE); }
+    if (pTempScript->pAreaTrigger)            { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_AREA_TRIGGER); }
+    if (pTempScript->pProcessEventId)         { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_PROCESS_EVENT); }
+    if (pTempScript->pEffectDummyNPC)         { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_EFFECT_DUMMY); }
+    if (pTempScript->pEffectDummyGO)          { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_GO_EFFECT_DUMMY); }
+    if (pTempScript->pEffectDummyItem)        { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_ITEM_EFFECT_DUMMY); }
+    if (pTempScript->pEffectScriptEffectNPC)  { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_EFFECT_SCRIPT_EFFECT); }
+    if (pTempScript->pEffectAuraDummy)        { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_AURA_DUMMY); }
+    if (pTempScript->GetAI)                   { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_CREATURE_AI); }
+    if (pTempScript->GetInstanceData)         { uiHooks |= SCRIPT_HOOK_MASK(SCRIPT_HOOK_INSTANCE_DATA); }
+
+    return uiHooks;
+}
+
 MANGOS_DLL_EXPORT
 bool GossipHello(Player* pPlayer, Creature* pCreature)
 {
@@ -65,6 +65,58 @@ void AuthCrypt::EncryptSend(uint8* data, size_t len)
     }
 }
 
+void AuthCrypt::EncryptSendHeaders(uint8* data, size_t const* offsets, size_t count)
+{
+    if (!_initialized || _key.empty()) { return; }
+
+    uint8 const* key = &_key[0];
+    size_t const keySize = _key.size();
+    size_t i = _send_i % keySize;
+    uint8 j = _send_j;
+
+    for (size_t n = 0; n < count; ++n)
+    {
+        uint8* header = data + offsets[n];
+        for (size_t t = 0; t < CRYPTED_SEND_LEN; ++t)
+        {
+            j = (header[t] ^ key[i]) + j;
+            header[t] = j;
+            if (++i == keySize)
+                { i = 0; }
+        }
+    }
+
+    _send_i = uint8(i);
+    _send_j = j;
+}
+
+void AuthCrypt::EncryptClientHeader(uint8* data)
+{
+    if (!_initialized) { return; }
+
+    for (size_t t = 0; t < CRYPTED_RECV_LEN; t++)
+    {
+        _send_i %= _key.size();
+        uint8 x = (data[t] ^ _key[_send_i]) + _send_j;
+        ++_send_i;
+        data[t] = _send_j = x;
+    }
+}
+
+void AuthCrypt::DecryptServerHeader(uint8* data)
+{
+    if (!_initialized) { return; }
+
+    for (size_t t = 0; t < CRYPTED_SEND_LEN; t++)
+    {
+        _recv_i %= _key.size();
+        uint8 x = (data[t] - _recv_j) ^ _key[_recv_i];
+        ++_recv_i;
+        _recv_j = data[t];
+        data[t] = x;
+    }
+}
+
 void AuthCrypt::SetKey(uint8* key, size_t len)
 {
     _key.resize(len);
@@ -79,6 +79,33 @@ class AuthCrypt
          * @param size_t
          */
         void EncryptSend(uint8*, size_t);
+        /**
+         * @brief encrypts the headers at the offsets of data in one pass, in send order
+         *
+         * Same as EncryptSend for every header, with the key state kept in locals for the whole batch.
+         *
+         * @param data
+         * @param offsets start of every CRYPTED_SEND_LEN bytes header in data
+         * @param count
+         */
+        void EncryptSendHeaders(uint8* data, size_t const* offsets, size_t count);
+
+        /**
+         * @brief client side of the stream: encrypts a CRYPTED_RECV_LEN bytes header for DecryptRecv of the server
+         *
+         * Uses the send state, a client object never calls EncryptSend.
+         *
+         * @param data
+         */
+        void EncryptClientHeader(uint8* data);
+        /**
+         * @brief client side of the stream: decrypts a CRYPTED_SEND_LEN bytes header of EncryptSend of the server
+         *
+         * Uses the receive state, a client object never calls DecryptRecv.
+         *
+         * @param data
+         */
+        void DecryptServerHeader(uint8* data);
 
         /**
          * @brief
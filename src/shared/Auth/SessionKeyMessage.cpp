@@ -0,0 +1,79 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "Auth/SessionKeyMessage.h"
+
+#include <openssl/sha.h>
+#include <openssl/hmac.h>
+#include <openssl/crypto.h>
+
+static void Sign(uint8 const* data, size_t size, std::string const& secret, uint8 digest[SHA_DIGEST_LENGTH])
+{
+    unsigned int length = SHA_DIGEST_LENGTH;
+    HMAC(EVP_sha1(), secret.data(), int(secret.size()), data, size, digest, &length);
+}
+
+void SessionKeyMessage::Write(ByteBuffer& buf, std::string const& secret) const
+{
+    buf << account;
+    buf << uint32(accountId);
+    buf << uint8(security);
+    buf << uint8(locale);
+    buf << uint64(muteTime);
+    buf << uint64(sendTime);
+    buf.append(K, sizeof(K));
+
+    uint8 digest[SHA_DIGEST_LENGTH];
+    Sign(buf.contents(), buf.size(), secret, digest);
+    buf.append(digest, sizeof(digest));
+}
+
+bool SessionKeyMessage::Read(ByteBuffer& buf, std::string const& secret)
+{
+    if (buf.size() <= SHA_DIGEST_LENGTH)
+        { return false; }
+
+    uint8 digest[SHA_DIGEST_LENGTH];
+    Sign(buf.contents(), buf.size() - SHA_DIGEST_LENGTH, secret, digest);
+    if (CRYPTO_memcmp(digest, buf.contents() + buf.size() - SHA_DIGEST_LENGTH, SHA_DIGEST_LENGTH) != 0)
+        { return false; }
+
+    try
+    {
+        buf >> account;
+        buf >> accountId;
+        buf >> security;
+        buf >> locale;
+        buf >> muteTime;
+        buf >> sendTime;
+        buf.read(K, sizeof(K));
+    }
+    catch (ByteBufferException&)
+    {
+        return false;
+    }
+
+    return buf.rpos() == buf.size() - SHA_DIGEST_LENGTH;
+}
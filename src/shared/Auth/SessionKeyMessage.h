@@ -0,0 +1,69 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_AUTH_SESSIONKEYMESSAGE
+#define MANGOS_H_AUTH_SESSIONKEYMESSAGE
+
+#include "Common.h"
+#include "ByteBuffer.h"
+
+/**
+ * @brief account data of a fresh logon, sent by realmd to the world servers in an UDP datagram
+ *
+ * The world server authenticates the session with it instead of reading the account. The datagram
+ * is signed by a HMAC-SHA1 with the secret shared by realmd and the world servers, so only realmd
+ * can create them, but the session key is not encrypted: realmd and the world servers are meant to
+ * exchange them on a private network.
+ */
+struct SessionKeyMessage
+{
+    static size_t const MAX_SIZE = 512;                     // datagram size, far above the real one
+
+    std::string account;
+    uint32 accountId;
+    uint8 security;
+    uint8 locale;
+    uint64 muteTime;
+    uint64 sendTime;                                        // unix time at realmd, old datagrams are rejected
+    uint8 K[40];
+
+    /**
+     * @brief serializes and signs the message
+     *
+     * @param buf
+     * @param secret
+     */
+    void Write(ByteBuffer& buf, std::string const& secret) const;
+    /**
+     * @brief
+     *
+     * @param buf
+     * @param secret
+     * @return bool false if the datagram is damaged or not signed with the secret
+     */
+    bool Read(ByteBuffer& buf, std::string const& secret);
+};
+
+#endif
@@ -115,3 +115,65 @@ void ByteBuffer::hexlike() const
 
     sLog.outDebug("%s", ss.str().c_str());
 }
+
+void ByteBufferStorage::assign(ByteBufferStorage const& other)
+{
+    if (other.m_size > m_capacity)
+    {
+        m_size = 0;                                         // nothing to keep
+        Reallocate(other.m_size);
+    }
+
+    if (other.m_size)
+        { memcpy(m_data, other.m_data, other.m_size); }
+    m_size = other.m_size;
+}
+
+void ByteBufferStorage::Reallocate(size_t newCapacity)
+{
+    uint8* data = new uint8[newCapacity];
+    if (m_size)
+        { memcpy(data, m_data, m_size); }
+
+    if (!IsInline())
+        { delete[] m_data; }
+
+    m_data = data;
+    m_capacity = newCapacity;
+}
+
+void ByteBufferStorage::MoveFrom(ByteBufferStorage& other)
+{
+    if (!IsInline())
+        { delete[] m_data; }
+
+    if (other.IsInline())
+    {
+        m_data = m_inline;
+        m_capacity = BYTEBUFFER_INLINE_SIZE;
+        if (other.m_size)
+            { memcpy(m_inline, other.m_inline, other.m_size); }
+    }
+    else
+    {
+        // the heap block changes hands, no copy
+        m_data = other.m_data;
+        m_capacity = other.m_capacity;
+        other.m_data = other.m_inline;
+        other.m_capacity = BYTEBUFFER_INLINE_SIZE;
+    }
+
+    m_size = other.m_size;
+    other.m_size = 0;
+}
+
+void ByteBufferStorage::swap(ByteBufferStorage& other)
+{
+    if (this == &other)
+        { return; }
+
+    ByteBufferStorage temp;
+    temp.MoveFrom(*this);
+    MoveFrom(other);
+    other.MoveFrom(temp);
+}
@@ -26,6 +26,7 @@
 #define MANGOS_H_BYTEBUFFER
 
 #include "Common.h"
+#include "MemoryTracker.h"
 #include "Utilities/ByteConverter.h"
 
 /**
@@ -75,6 +76,81 @@ struct Unused
     Unused() {}
 };
 
+#ifndef BYTEBUFFER_INLINE_SIZE
+#define BYTEBUFFER_INLINE_SIZE 128                          // contents up to this size are kept inside the buffer
+#endif
+
+/**
+ * @brief byte storage of a ByteBuffer, small contents are kept inline without a heap allocation
+ *
+ * Only the heap part is counted as capacity by MemoryTracker. Larger contents grow to at least
+ * twice the capacity at a time.
+ */
+class ByteBufferStorage
+{
+    public:
+        ByteBufferStorage() : m_data(m_inline), m_size(0), m_capacity(BYTEBUFFER_INLINE_SIZE) {}
+        ByteBufferStorage(ByteBufferStorage const& other) : m_data(m_inline), m_size(0), m_capacity(BYTEBUFFER_INLINE_SIZE) { assign(other); }
+        ~ByteBufferStorage() { if (!IsInline()) { delete[] m_data; } }
+
+        ByteBufferStorage& operator=(ByteBufferStorage const& other)
+        {
+            if (this != &other)
+                { assign(other); }
+            return *this;
+        }
+
+        uint8& operator[](size_t pos) { return m_data[pos]; }
+        uint8 const& operator[](size_t pos) const { return m_data[pos]; }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        size_t capacity() const { return m_capacity; }
+
+        /**
+         * @brief
+         *
+         * @return size_t bytes allocated on the heap, 0 while the contents are inline
+         */
+        size_t heapCapacity() const { return IsInline() ? 0 : m_capacity; }
+
+        void clear() { m_size = 0; }
+
+        void reserve(size_t newCapacity)
+        {
+            if (newCapacity > m_capacity)
+                { Reallocate(newCapacity); }
+        }
+
+        /**
+         * @brief new bytes are 0 as in std::vector
+         *
+         * @param newSize
+         */
+        void resize(size_t newSize)
+        {
+            if (newSize > m_capacity)
+                { Reallocate(std::max(newSize, m_capacity * 2)); }
+            if (newSize > m_size)
+                { memset(m_data + m_size, 0, newSize - m_size); }
+            m_size = newSize;
+        }
+
+        void swap(ByteBufferStorage& other);
+
+    private:
+        bool IsInline() const { return m_data == m_inline; }
+
+        void assign(ByteBufferStorage const& other);
+        void Reallocate(size_t newCapacity);
+        void MoveFrom(ByteBufferStorage& other);
+
+        uint8* m_data;                                      // m_inline or a heap block of m_capacity
+        size_t m_size;
+        size_t m_capacity;
+        uint8 m_inline[BYTEBUFFER_INLINE_SIZE];
+};
+
 /**
  * @brief
  *
@@ -88,27 +164,58 @@ class ByteBuffer
          * @brief constructor
          *
          */
-        ByteBuffer(): _rpos(0), _wpos(0)
+        ByteBuffer(): _rpos(0), _wpos(0), _trackedSize(0), _memoryTag(MEM_TAG_BYTEBUFFER)
         {
             _storage.reserve(DEFAULT_SIZE);
+            TrackStorage();
         }
 
         /**
          * @brief constructor
          *
          * @param res
+         * @param tag subsystem the storage is counted for
          */
-        ByteBuffer(size_t res): _rpos(0), _wpos(0)
+        ByteBuffer(size_t res, MemoryTag tag = MEM_TAG_BYTEBUFFER): _rpos(0), _wpos(0), _trackedSize(0), _memoryTag(uint8(tag))
         {
             _storage.reserve(res);
+            TrackStorage();
         }
 
         /**
-         * @brief copy constructor
+         * @brief copy constructor, the copy is counted for the same subsystem
          *
          * @param buf
          */
-        ByteBuffer(const ByteBuffer& buf): _rpos(buf._rpos), _wpos(buf._wpos), _storage(buf._storage) { }
+        ByteBuffer(const ByteBuffer& buf): _rpos(buf._rpos), _wpos(buf._wpos), _storage(buf._storage), _trackedSize(0), _memoryTag(buf._memoryTag)
+        {
+            TrackStorage();
+        }
+
+        ~ByteBuffer()
+        {
+            if (_trackedSize)
+                { MemoryTracker::Free(MemoryTag(_memoryTag), _trackedSize); }
+        }
+
+        /**
+         * @brief copies the contents, the buffer stays counted for its subsystem
+         *
+         * @param buf
+         * @return ByteBuffer
+         */
+        ByteBuffer& operator=(const ByteBuffer& buf)
+        {
+            if (this != &buf)
+            {
+                _rpos = buf._rpos;
+                _wpos = buf._wpos;
+                _storage = buf._storage;
+                TrackStorage();
+            }
+
+            return *this;
+        }
 
         /**
          * @brief
@@ -604,6 +711,7 @@ class ByteBuffer
         void resize(size_t newsize)
         {
             _storage.resize(newsize);
+            TrackStorage();
             _rpos = 0;
             _wpos = size();
         }
@@ -616,7 +724,30 @@ class ByteBuffer
         void reserve(size_t ressize)
         {
             if (ressize > size())
-                { _storage.reserve(ressize); }
+            {
+                _storage.reserve(ressize);
+                TrackStorage();
+            }
+        }
+
+        /**
+         * @brief exchanges the contents with buf without copying them
+         *
+         * @param buf
+         */
+        void swap(ByteBuffer& buf)
+        {
+            std::swap(_rpos, buf._rpos);
+            std::swap(_wpos, buf._wpos);
+            _storage.swap(buf._storage);
+
+            if (_memoryTag == buf._memoryTag)
+                { std::swap(_trackedSize, buf._trackedSize); }
+            else
+            {
+                TrackStorage();
+                buf.TrackStorage();
+            }
         }
 
         /**
@@ -665,7 +796,10 @@ class ByteBuffer
             MANGOS_ASSERT(size() < 10000000);
 
             if (_storage.size() < _wpos + cnt)
-                { _storage.resize(_wpos + cnt); }
+            {
+                _storage.resize(_wpos + cnt);
+                TrackStorage();
+            }
             memcpy(&_storage[_wpos], src, cnt);
             _wpos += cnt;
         }
@@ -765,8 +899,27 @@ class ByteBuffer
         }
 
     protected:
+        /**
+         * @brief counts a changed capacity of the storage for the subsystem of the buffer
+         *
+         */
+        void TrackStorage()
+        {
+            size_t capacity = _storage.heapCapacity();
+            if (capacity == _trackedSize)
+                { return; }
+
+            if (_trackedSize)
+                { MemoryTracker::Free(MemoryTag(_memoryTag), _trackedSize); }
+            if (capacity)
+                { MemoryTracker::Allocate(MemoryTag(_memoryTag), capacity); }
+            _trackedSize = capacity;
+        }
+
         size_t _rpos, _wpos; /**< TODO */
-        std::vector<uint8> _storage; /**< TODO */
+        ByteBufferStorage _storage; /**< TODO */
+        size_t _trackedSize;                                // capacity counted by MemoryTracker
+        uint8 _memoryTag;                                   // MemoryTag
 };
 
 template <typename T>
@@ -28,65 +28,94 @@
 
 #include "DBCFileLoader.h"
 
-DBCFileLoader::DBCFileLoader()
+#include <ace/OS_NS_sys_stat.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/// Header of a converted cache file, see DBCFileLoader::WriteCache
+struct DBCCacheHeader
 {
-    data = NULL;
-    fieldsOffset = NULL;
+    static uint32 const MAGIC = 0x43434244;                 // "DBCC"
+    static uint32 const VERSION = 2;
+
+    uint32 magic;
+    uint32 version;
+    uint32 pointerSize;                                     // size of the string fields
+    uint32 formatLength;                                    // the format string follows the header
+    uint64 sourceSize;                                      // size and modification time of the .dbc file
+    uint64 sourceTime;
+    uint32 fieldCount;
+    uint32 recordCount;
+    uint32 recordSize;                                      // size of the C++ structure of a record
+    uint32 stringSize;
+    uint64 baseAddress;                                     // string fields hold baseAddress plus their position in the file
+};
+
+/// Parts of a cache file are 8 byte aligned
+static uint32 AlignCacheSize(uint32 size)
+{
+    return (size + 7) & ~uint32(7);
 }
 
-bool DBCFileLoader::Load(const char* filename, const char* fmt)
+/// Cache files are mapped at multiples of the allocation granularity of all platforms
+static uint64 AlignCacheAddress(uint64 address)
 {
-    uint32 header;
-    delete[] data;
+    return (address + 0xFFFF) & ~uint64(0xFFFF);
+}
 
-    FILE* f = fopen(filename, "rb");
-    if (!f) { return false; }
+uint64 DBCFileLoader::m_cacheAddress = 0;
 
-    if (fread(&header, 4, 1, f) != 1)                       // Number of records
-    {
-        fclose(f);
-        return false;
-    }
+void DBCFileLoader::SetCacheAddress(uint64 address)
+{
+    m_cacheAddress = AlignCacheAddress(address);
+}
 
-    EndianConvert(header);
-    if (header != 0x43424457)                               //'WDBC'
-    {
-        fclose(f);
-        return false;
-    }
+static uint32 ReadHeaderField(unsigned char const* pos)
+{
+    uint32 value;
+    memcpy(&value, pos, sizeof(value));
+    EndianConvert(value);
+    return value;
+}
 
-    if (fread(&recordCount, 4, 1, f) != 1)                  // Number of records
-    {
-        fclose(f);
-        return false;
-    }
+DBCFileLoader::DBCFileLoader()
+{
+    data = NULL;
+    fieldsOffset = NULL;
+    m_map = NULL;
+}
 
-    EndianConvert(recordCount);
+bool DBCFileLoader::Load(const char* filename, const char* fmt)
+{
+    delete m_map;
+    data = NULL;
 
-    if (fread(&fieldCount, 4, 1, f) != 1)                   // Number of fields
+    // private writable mapping, records used in place can be changed after loading without touching the file
+    m_map = new ACE_Mem_Map;
+    if (m_map->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_RDWR, ACE_MAP_PRIVATE) == -1 || m_map->size() < 20)
     {
-        fclose(f);
+        delete m_map;
+        m_map = NULL;
         return false;
     }
 
-    EndianConvert(fieldCount);
+    unsigned char* file = static_cast<unsigned char*>(m_map->addr());
 
-    if (fread(&recordSize, 4, 1, f) != 1)                   // Size of a record
-    {
-        fclose(f);
-        return false;
-    }
+    if (ReadHeaderField(file) != 0x43424457)                // 'WDBC'
+        { return false; }
 
-    EndianConvert(recordSize);
+    recordCount = ReadHeaderField(file + 4);                // Number of records
+    fieldCount = ReadHeaderField(file + 8);                 // Number of fields
+    recordSize = ReadHeaderField(file + 12);                // Size of a record
+    stringSize = ReadHeaderField(file + 16);                // String size
 
-    if (fread(&stringSize, 4, 1, f) != 1)                   // String size
-    {
-        fclose(f);
-        return false;
-    }
-
-    EndianConvert(stringSize);
+    if (m_map->size() < 20 + size_t(recordSize) * recordCount + stringSize)
+        { return false; }
 
+    delete[] fieldsOffset;
     fieldsOffset = new uint32[fieldCount];
     fieldsOffset[0] = 0;
     for (uint32 i = 1; i < fieldCount; ++i)
@@ -98,22 +127,14 @@ bool DBCFileLoader::Load(const char* filename, const char* fmt)
             { fieldsOffset[i] += 4; }
     }
 
-    data = new unsigned char[recordSize * recordCount + stringSize];
+    data = file + 20;
     stringTable = data + recordSize * recordCount;
-
-    if (fread(data, recordSize * recordCount + stringSize, 1, f) != 1)
-    {
-        fclose(f);
-        return false;
-    }
-
-    fclose(f);
     return true;
 }
 
 DBCFileLoader::~DBCFileLoader()
 {
-    delete[] data;
+    delete m_map;
     delete[] fieldsOffset;
 }
 
@@ -181,7 +202,6 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
     this func will generate  entry[rows] data;
     */
 
-    typedef char* ptr;
     if (strlen(format) != fieldCount)
         { return NULL; }
 
@@ -189,40 +209,13 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
     int32 i;
     uint32 recordsize = GetFormatRecordSize(format, &i);
 
-    if (i >= 0)
-    {
-        uint32 maxi = 0;
-        // find max index
-        for (uint32 y = 0; y < recordCount; ++y)
-        {
-            uint32 ind = getRecord(y).getUInt(i);
-            if (ind > maxi) { maxi = ind; }
-        }
-
-        ++maxi;
-        records = maxi;
-        indexTable = new ptr[maxi];
-        memset(indexTable, 0, maxi * sizeof(ptr));
-    }
-    else
-    {
-        records = recordCount;
-        indexTable = new ptr[recordCount];
-    }
-
     char* dataTable = new char[recordCount * recordsize];
+    indexTable = ProduceIndex(i, records, dataTable, recordsize);
 
     uint32 offset = 0;
 
     for (uint32 y = 0; y < recordCount; ++y)
     {
-        if (i >= 0)
-        {
-            indexTable[getRecord(y).getUInt(i)] = &dataTable[offset];
-        }
-        else
-            { indexTable[y] = &dataTable[offset]; }
-
         for (uint32 x = 0; x < fieldCount; ++x)
         {
             switch (format[x])
@@ -315,3 +308,292 @@ char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
 
     return stringPool;
 }
+
+char** DBCFileLoader::ProduceIndex(int32 indexPos, uint32& records, char* dataTable, uint32 dataRecordSize)
+{
+    typedef char* ptr;
+    ptr* indexTable;
+
+    if (indexPos >= 0)
+    {
+        uint32 maxi = 0;
+        // find max index
+        for (uint32 y = 0; y < recordCount; ++y)
+        {
+            uint32 ind = getRecord(y).getUInt(indexPos);
+            if (ind > maxi) { maxi = ind; }
+        }
+
+        ++maxi;
+        records = maxi;
+        indexTable = new ptr[maxi];
+        memset(indexTable, 0, maxi * sizeof(ptr));
+
+        for (uint32 y = 0; y < recordCount; ++y)
+            { indexTable[getRecord(y).getUInt(indexPos)] = &dataTable[y * dataRecordSize]; }
+    }
+    else
+    {
+        records = recordCount;
+        indexTable = new ptr[recordCount];
+
+        for (uint32 y = 0; y < recordCount; ++y)
+            { indexTable[y] = &dataTable[y * dataRecordSize]; }
+    }
+
+    return indexTable;
+}
+
+bool DBCFileLoader::IsInPlaceFormat(const char* format) const
+{
+#if MANGOS_ENDIAN == MANGOS_BIGENDIAN
+    return false;                                           // the file values need byte swapping
+#else
+    if (strlen(format) != fieldCount || GetFormatRecordSize(format) != recordSize)
+        { return false; }
+
+    for (uint32 x = 0; x < fieldCount; ++x)
+    {
+        switch (format[x])
+        {
+            case DBC_FF_FLOAT:
+            case DBC_FF_INT:
+            case DBC_FF_IND:
+            case DBC_FF_BYTE:
+                break;
+            default:
+                return false;                               // skipped, string or sort fields change the layout
+        }
+    }
+
+    return true;
+#endif
+}
+
+char* DBCFileLoader::ProduceDataInPlace(const char* format, uint32& records, char**& indexTable)
+{
+    if (!IsInPlaceFormat(format))
+        { return NULL; }
+
+    int32 i;
+    GetFormatRecordSize(format, &i);
+
+    char* dataTable = reinterpret_cast<char*>(data);
+    indexTable = ProduceIndex(i, records, dataTable, recordSize);
+    return dataTable;
+}
+
+/// Offsets of the string fields in the C++ structure of format
+static void GetStringFieldOffsets(const char* format, std::vector<uint32>& offsets)
+{
+    uint32 offset = 0;
+    for (uint32 x = 0; format[x]; ++x)
+    {
+        switch (format[x])
+        {
+            case DBC_FF_FLOAT:
+                offset += sizeof(float);
+                break;
+            case DBC_FF_IND:
+            case DBC_FF_INT:
+                offset += sizeof(uint32);
+                break;
+            case DBC_FF_BYTE:
+                offset += sizeof(uint8);
+                break;
+            case DBC_FF_STRING:
+                offsets.push_back(offset);
+                offset += sizeof(char*);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+char* DBCFileLoader::LoadCache(const char* cacheFile, const char* sourceFile, const char* format, uint32& records, char**& indexTable)
+{
+    ACE_stat source;
+    if (ACE_OS::stat(sourceFile, &source) != 0 || ACE_OS::access(cacheFile, R_OK) != 0)
+        { return NULL; }
+
+    delete m_map;
+    m_map = NULL;
+    data = NULL;
+
+    // the header tells where the cache wants to be mapped
+    DBCCacheHeader header;
+    FILE* f = fopen(cacheFile, "rb");
+    if (!f)
+        { return NULL; }
+
+    bool headerRead = fread(&header, sizeof(header), 1, f) == 1;
+    fclose(f);
+
+    if (!headerRead)
+        { return NULL; }
+
+    uint32 formatLength = strlen(format);
+    if (header.magic != DBCCacheHeader::MAGIC || header.version != DBCCacheHeader::VERSION ||
+        header.pointerSize != sizeof(char*) || header.formatLength != formatLength ||
+        header.sourceSize != uint64(source.st_size) || header.sourceTime != uint64(source.st_mtime) ||
+        header.recordSize != GetFormatRecordSize(format))
+        { return NULL; }                                    // other format or the .dbc file changed
+
+    uint32 formatPos = sizeof(header);
+    uint32 idsPos = AlignCacheSize(formatPos + formatLength);
+    uint32 dataPos = AlignCacheSize(idsPos + header.recordCount * sizeof(uint32));
+    uint32 stringPos = AlignCacheSize(dataPos + header.recordCount * header.recordSize);
+
+    // keep later written caches out of the range of this one
+    if (header.baseAddress)
+        { m_cacheAddress = std::max(m_cacheAddress, AlignCacheAddress(header.baseAddress + stringPos + header.stringSize)); }
+
+    // the address is a hint only, a cache mapped elsewhere gets its string fields relocated
+    void* baseAddress = reinterpret_cast<void*>(size_t(header.baseAddress));
+    m_map = new ACE_Mem_Map;
+    if (m_map->map(cacheFile, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_RDWR, ACE_MAP_PRIVATE, baseAddress) == -1)
+    {
+        delete m_map;
+        m_map = NULL;
+        return NULL;
+    }
+
+    char* file = static_cast<char*>(m_map->addr());
+    bool relocate = !header.baseAddress || file != baseAddress;
+
+    if (m_map->size() != size_t(stringPos) + header.stringSize || memcmp(file + formatPos, format, formatLength) != 0)
+        { return NULL; }
+
+    fieldCount = header.fieldCount;
+    recordCount = header.recordCount;
+    recordSize = header.recordSize;
+    stringSize = header.stringSize;
+
+    uint32 const* ids = reinterpret_cast<uint32 const*>(file + idsPos);
+    char* dataTable = file + dataPos;
+
+    uint32 maxi = 0;
+    for (uint32 y = 0; y < recordCount; ++y)
+        if (ids[y] > maxi)
+            { maxi = ids[y]; }
+
+    records = recordCount ? maxi + 1 : 0;
+    indexTable = new char*[records];
+    memset(indexTable, 0, records * sizeof(char*));
+
+    std::vector<uint32> stringFields;
+    GetStringFieldOffsets(format, stringFields);
+
+    for (uint32 y = 0; y < recordCount; ++y)
+    {
+        char* record = &dataTable[y * recordSize];
+        indexTable[ids[y]] = record;
+
+        for (std::vector<uint32>::const_iterator itr = stringFields.begin(); itr != stringFields.end(); ++itr)
+        {
+            size_t stringPointer;
+            memcpy(&stringPointer, record + *itr, sizeof(stringPointer));
+            size_t filePos = stringPointer - size_t(header.baseAddress);
+            if (filePos < stringPos || filePos >= size_t(stringPos) + stringSize)
+            {
+                delete[] indexTable;
+                indexTable = NULL;
+                return NULL;
+            }
+
+            // the only write to the mapping, at the wanted address the pages stay shared between processes
+            if (relocate)
+                { *((char**)(record + *itr)) = file + filePos; }
+        }
+    }
+
+    return dataTable;
+}
+
+bool DBCFileLoader::WriteCache(const char* cacheFile, const char* sourceFile, const char* format, char const* dataTable, char const* stringPool)
+{
+    ACE_stat source;
+    if (!data || ACE_OS::stat(sourceFile, &source) != 0)
+        { return false; }
+
+    int32 indexPos;
+    DBCCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DBCCacheHeader::MAGIC;
+    header.version = DBCCacheHeader::VERSION;
+    header.pointerSize = sizeof(char*);
+    header.formatLength = strlen(format);
+    header.sourceSize = uint64(source.st_size);
+    header.sourceTime = uint64(source.st_mtime);
+    header.fieldCount = fieldCount;
+    header.recordCount = recordCount;
+    header.recordSize = GetFormatRecordSize(format, &indexPos);
+    header.stringSize = stringSize;
+    header.baseAddress = m_cacheAddress;
+
+    uint32 idsPos = AlignCacheSize(sizeof(header) + header.formatLength);
+    uint32 dataPos = AlignCacheSize(idsPos + recordCount * sizeof(uint32));
+    uint32 stringPos = AlignCacheSize(dataPos + recordCount * header.recordSize);
+
+    std::vector<uint32> stringFields;
+    GetStringFieldOffsets(format, stringFields);
+
+    std::string buffer(reinterpret_cast<char const*>(&header), sizeof(header));
+    buffer.append(format, header.formatLength);
+    buffer.resize(AlignCacheSize(buffer.size()), 0);
+
+    for (uint32 y = 0; y < recordCount; ++y)
+    {
+        uint32 id = indexPos >= 0 ? getRecord(y).getUInt(indexPos) : y;
+        buffer.append(reinterpret_cast<char const*>(&id), sizeof(id));
+    }
+    buffer.resize(AlignCacheSize(buffer.size()), 0);
+
+    // string pointers become pointers into a mapping at the base address
+    for (uint32 y = 0; y < recordCount; ++y)
+    {
+        size_t recordPos = buffer.size();
+        buffer.append(&dataTable[y * header.recordSize], header.recordSize);
+
+        for (std::vector<uint32>::const_iterator itr = stringFields.begin(); itr != stringFields.end(); ++itr)
+        {
+            char const* str;
+            memcpy(&str, &buffer[recordPos + *itr], sizeof(str));
+            size_t stringPointer = size_t(header.baseAddress) + stringPos + (str - stringPool);
+            memcpy(&buffer[recordPos + *itr], &stringPointer, sizeof(stringPointer));
+        }
+    }
+    buffer.resize(AlignCacheSize(buffer.size()), 0);
+
+    buffer.append(reinterpret_cast<char const*>(stringTable), stringSize);
+
+    // a cache is replaced by a complete one only
+    std::string tempFile = std::string(cacheFile) + ".tmp";
+    FILE* f = fopen(tempFile.c_str(), "wb");
+    if (!f)
+        { return false; }
+
+    bool ok = fwrite(buffer.data(), buffer.size(), 1, f) == 1;
+    ok = fclose(f) == 0 && ok;
+
+    ACE_OS::unlink(cacheFile);
+    if (!ok || ACE_OS::rename(tempFile.c_str(), cacheFile) != 0)
+    {
+        ACE_OS::unlink(tempFile.c_str());
+        return false;
+    }
+
+    if (header.baseAddress)
+        { m_cacheAddress = AlignCacheAddress(header.baseAddress + buffer.size()); }
+
+    return true;
+}
+
+ACE_Mem_Map* DBCFileLoader::ReleaseMapping()
+{
+    ACE_Mem_Map* map = m_map;
+    m_map = NULL;
+    data = NULL;
+    return map;
+}
@@ -27,6 +27,7 @@
 
 #include "Platform/Define.h"
 #include "Utilities/ByteConverter.h"
+#include <ace/Mem_Map.h>
 #include <cassert>
 
 /**
@@ -198,6 +199,67 @@ class DBCFileLoader
          * @return char
          */
         char* AutoProduceStrings(const char* fmt, char* dataTable);
+        /**
+         * @brief true if the file records have the layout of the C++ structure of fmt already
+         *
+         * Only numeric fields without skipped ones, on little endian hosts.
+         *
+         * @param fmt
+         * @return bool
+         */
+        bool IsInPlaceFormat(const char* fmt) const;
+        /**
+         * @brief indexes the records of the mapped file in place instead of copying them
+         *
+         * The data stays valid as long as the mapping, see ReleaseMapping.
+         *
+         * @param fmt
+         * @param count
+         * @param indexTable
+         * @return char NULL if the format is not an in place format
+         */
+        char* ProduceDataInPlace(const char* fmt, uint32& count, char**& indexTable);
+        /**
+         * @brief maps a cache file written by WriteCache, the records are used in place
+         *
+         * Only the string fields are set at loading. The data stays valid as long as the mapping,
+         * see ReleaseMapping.
+         *
+         * @param cacheFile
+         * @param sourceFile the .dbc file, the cache is used only if it wasn't changed since
+         * @param fmt
+         * @param count
+         * @param indexTable
+         * @return char NULL if the cache is missing, damaged or outdated
+         */
+        char* LoadCache(const char* cacheFile, const char* sourceFile, const char* fmt, uint32& count, char**& indexTable);
+        /**
+         * @brief writes the records produced from the loaded file to a cache file
+         *
+         * @param cacheFile
+         * @param sourceFile
+         * @param fmt
+         * @param dataTable result of AutoProduceData with the strings of AutoProduceStrings
+         * @param stringPool result of AutoProduceStrings
+         * @return bool
+         */
+        bool WriteCache(const char* cacheFile, const char* sourceFile, const char* fmt, char const* dataTable, char const* stringPool);
+        /**
+         * @brief hands the file mapping over to the caller, for data produced in place
+         *
+         * @return ACE_Mem_Map
+         */
+        ACE_Mem_Map* ReleaseMapping();
+        /**
+         * @brief sets the address cache files written from now on are mapped at
+         *
+         * The string fields of a cache hold pointers for a mapping at its address. Processes mapping
+         * the cache there use the records without any write, so all their pages stay shared.
+         * Later caches are placed after the ones written or loaded before.
+         *
+         * @param address 0 for caches without an address, their string fields are set at every loading
+         */
+        static void SetCacheAddress(uint64 address);
         /**
          * @brief
          *
@@ -207,6 +269,7 @@ class DBCFileLoader
          */
         static uint32 GetFormatRecordSize(const char* format, int32* index_pos = NULL);
     private:
+        char** ProduceIndex(int32 indexPos, uint32& records, char* dataTable, uint32 dataRecordSize);
 
         uint32 recordSize; /**< TODO */
         uint32 recordCount; /**< TODO */
@@ -215,5 +278,8 @@ class DBCFileLoader
         uint32* fieldsOffset; /**< TODO */
         unsigned char* data; /**< TODO */
         unsigned char* stringTable; /**< TODO */
+        ACE_Mem_Map* m_map;                                 // the .dbc or cache file
+
+        static uint64 m_cacheAddress;                       // address of the next written cache, see SetCacheAddress
 };
 #endif
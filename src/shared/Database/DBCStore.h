@@ -27,6 +27,8 @@
 
 #include "DBCFileLoader.h"
 
+#include <cstring>
+
 template<class T>
 /**
  * @brief
@@ -45,20 +47,19 @@ class DBCStorage
          *
          * @param f
          */
-        explicit DBCStorage(const char* f) : nCount(0), fieldCount(0), fmt(f), indexTable(NULL), m_dataTable(NULL) { }
+        explicit DBCStorage(const char* f) : nCount(0), fieldCount(0), fmt(f), indexTable(NULL), m_dataTable(NULL), m_mapping(NULL) { }
         /**
          * @brief
          *
          */
         ~DBCStorage() { Clear(); }
 
-		/**
-		* @brief
-		*
-		* @return uint32
-		*/
-		//uint32  GetNumRows() const { return nCount; }
-		uint32  GetNumRows() const { return loaded ? data.size() : nCount; }
+        /**
+         * @brief
+         *
+         * @return uint32
+         */
+        uint32  GetNumRows() const { return nCount; }
         /**
          * @brief
          *
@@ -72,62 +73,95 @@ class DBCStorage
          */
         uint32 GetFieldCount() const { return fieldCount; }
 
-		/**
-		* @brief
-		*
-		* @param id
-		* @return const T
-		*/
-		//T const* LookupEntry(uint32 id) const { return (id >= nCount) ? NULL : indexTable[id]; }
-		T const* LookupEntry(uint32 id) const
-		{
-            if (loaded)
-            {
-                typename std::map<uint32, T const*>::const_iterator it = data.find(id);
-                if (it != data.end())
-                    return it->second;
-            }
-            return (id >= nCount) ? NULL : indexTable[id];
-        }
         /**
          * @brief
          *
+         * @param id
+         * @return const T
+         */
+        T const* LookupEntry(uint32 id) const { return (id >= nCount) ? NULL : indexTable[id]; }
+        /**
+         * @brief loads the store, using the records of the file or cache file in place where possible
+         *
+         * Stores whose C++ structure is the record layout of the file use the mapped file directly.
+         * Other stores are converted and, with a cache file name, the converted records are written
+         * to the cache, which is then mapped and used directly at the next loading.
+         * The mappings are private, so processes loading the same files share the unchanged pages,
+         * all pages of a cache mapped at its address, see DBCFileLoader::SetCacheAddress.
+         *
          * @param fn
+         * @param cacheFn converted cache file of fn, NULL for none
          * @return bool
          */
-        bool Load(char const* fn)
+        bool Load(char const* fn, char const* cacheFn = NULL)
         {
             DBCFileLoader dbc;
+
+            if (cacheFn)
+            {
+                m_dataTable = (T*)dbc.LoadCache(cacheFn, fn, fmt, nCount, (char**&)indexTable);
+                if (m_dataTable)
+                {
+                    fieldCount = dbc.GetCols();
+                    m_mapping = dbc.ReleaseMapping();
+                    return true;
+                }
+            }
+
             // Check if load was sucessful, only then continue
             if (!dbc.Load(fn, fmt))
                 { return false; }
 
             fieldCount = dbc.GetCols();
 
+            if (dbc.IsInPlaceFormat(fmt))
+            {
+                m_dataTable = (T*)dbc.ProduceDataInPlace(fmt, nCount, (char**&)indexTable);
+                m_mapping = dbc.ReleaseMapping();
+                return indexTable != NULL;
+            }
+
             // load raw non-string data
             m_dataTable = (T*)dbc.AutoProduceData(fmt, nCount, (char**&)indexTable);
 
             // load strings from dbc data
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
+            char* stringPool = dbc.AutoProduceStrings(fmt, (char*)m_dataTable);
+            m_stringPoolList.push_back(stringPool);
+
+            if (cacheFn && indexTable && stringPool)
+                { dbc.WriteCache(cacheFn, fn, fmt, (char const*)m_dataTable, stringPool); }
 
             // error in dbc file at loading if NULL
             return indexTable != NULL;
         }
 
-        void SetEntry(uint32 id, T* t) // Cryptic they say..
+        /**
+         * @brief replaces or adds the entry of id, the index table grows for ids past its end
+         *
+         * The entry is not owned by the storage. Patching the index table keeps LookupEntry a single
+         * bounds check and array load also for stores with overridden entries.
+         *
+         * @param id
+         * @param t
+         */
+        void SetEntry(uint32 id, T* t)
         {
-            if (!loaded)
+            if (id >= nCount)
             {
-                for (uint32 i = 0; i < nCount; ++i)
+                // same allocation as DBCFileLoader::AutoProduceData, see Clear()
+                T** newIndexTable = (T**)new char*[id + 1];
+                memset(newIndexTable, 0, (id + 1) * sizeof(T*));
+                if (indexTable)
                 {
-                    T const* node = LookupEntry(i);
-                    if (!node)
-                        continue;
-                    data[i] = node;
+                    memcpy(newIndexTable, indexTable, nCount * sizeof(T*));
+                    delete[]((char*)indexTable);
                 }
-                loaded = true;
+
+                indexTable = newIndexTable;
+                nCount = id + 1;
             }
-            data[id] = t;
+
+            indexTable[id] = t;
         }
 
         /**
@@ -159,18 +193,20 @@ class DBCStorage
          */
         void Clear()
         {
-            if (loaded)
-            {
-                data.clear();
-                loaded = false;
-            }
-
             if (!indexTable)
                 { return; }
 
             delete[]((char*)indexTable);
             indexTable = NULL;
-            delete[]((char*)m_dataTable);
+
+            // data used in place belongs to the mapping
+            if (m_mapping)
+            {
+                delete m_mapping;
+                m_mapping = NULL;
+            }
+            else
+                { delete[]((char*)m_dataTable); }
             m_dataTable = NULL;
 
             while (!m_stringPoolList.empty())
@@ -201,9 +237,8 @@ class DBCStorage
         char const* fmt; /**< TODO */
         T** indexTable; /**< TODO */
         T* m_dataTable; /**< TODO */
-        std::map<uint32, T const*> data;
-        bool loaded;
         StringPoolList m_stringPoolList; /**< TODO */
+        ACE_Mem_Map* m_mapping;                             // file or cache file holding m_dataTable, NULL for heap data
 };
 
 #endif
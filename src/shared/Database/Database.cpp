@@ -25,6 +25,10 @@
 #include "DatabaseEnv.h"
 #include "Config/Config.h"
 #include "Database/SqlOperations.h"
+#include "Database/QuerySnapshot.h"
+#include "Timer.h"
+#include "Util.h"
+#include "Metrics.h"
 
 #include <ctime>
 #include <iostream>
@@ -34,7 +38,71 @@
 #define MIN_CONNECTION_POOL_SIZE 1
 #define MAX_CONNECTION_POOL_SIZE 16
 
+/**
+ * @brief streamed result owning the connection its rows are read from
+ *
+ */
+class QueryResultStreamed : public QueryResult
+{
+    public:
+        QueryResultStreamed(QueryResult* result, SqlConnection* conn, uint64 rowCount) :
+            QueryResult(rowCount, result->GetFieldCount()), m_result(result), m_conn(conn)
+        {
+            mCurrentRow = m_result->Fetch();
+        }
+
+        ~QueryResultStreamed()
+        {
+            delete m_result;                                // before the connection, it may still read rows
+            delete m_conn;
+        }
+
+        bool NextRow() override
+        {
+            bool res = m_result->NextRow();
+            mCurrentRow = m_result->Fetch();
+            return res;
+        }
+
+    private:
+        QueryResult* m_result;
+        SqlConnection* m_conn;
+};
+
+uint32 const SqlConnectionStats::LatencyLimits[SqlConnectionStats::LATENCY_BUCKETS] = { 1, 5, 20, 100, 500, 0 };
+
+void SqlConnectionStats::Reset()
+{
+    requests = 0;
+    totalTime = 0;
+    maxTime = 0;
+    memset(latency, 0, sizeof(latency));
+}
+
+void SqlConnectionStats::Add(uint32 time)
+{
+    ++requests;
+    totalTime += time;
+    if (time > maxTime)
+        { maxTime = time; }
+
+    uint32 bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && time >= LatencyLimits[bucket])
+        { ++bucket; }
+    ++latency[bucket];
+}
+
 //////////////////////////////////////////////////////////////////////////
+void SqlConnection::RecordRequest(const char* sql, uint32 startTime)
+{
+    uint32 now = WorldTimer::getMSTime();
+    m_lastActivity = now;
+
+    uint32 time = WorldTimer::getMSTimeDiff(startTime, now);
+    m_stats.Add(time);
+    m_db.OnRequestDone(sql, time);
+}
+
 SqlPreparedStatement* SqlConnection::CreateStatement(const std::string& fmt)
 {
     return new SqlPlainPreparedStatement(fmt, *this);
@@ -96,13 +164,32 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id)
     return pStmt->execute();
 }
 
+QueryResult* SqlConnection::QueryStmt(int nIndex, const SqlStmtParameters& id)
+{
+    if (nIndex == -1)
+        { return NULL; }
+
+    // get prepared statement object
+    SqlPreparedStatement* pStmt = GetStmt(nIndex);
+    if (!pStmt->isQuery())
+    {
+        sLog.outError("SQL ERROR: statement is no query: %s", m_db.GetStmtString(nIndex).c_str());
+        return NULL;
+    }
+
+    // bind parameters
+    pStmt->bind(id);
+    // execute statement and copy the rows
+    return pStmt->query();
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/, const char* replicaInfoStrings /*= NULL*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -115,6 +202,23 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
     }
 
     m_pingIntervallms = sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000);
+    m_infoString = infoString;
+
+    Tokens info = StrSplit(infoString, ";");
+    m_databaseName = info.size() > 4 ? info[4] : "";
+
+    static uint32 const queryTimeBounds[] = { 1, 5, 20, 100, 500 };
+    m_queryTimeMetric = sMetrics.GetHistogram("db_query_ms", "Duration of the database requests in ms", queryTimeBounds, countof(queryTimeBounds), "db", m_databaseName);
+
+    m_slowQueryThreshold = sConfig.GetIntDefault("SlowQueryThreshold", 0);
+    m_slowQuerySampleRate = sConfig.GetIntDefault("SlowQuerySampleRate", 1);
+    SyncQueryAudit::SetEnabled(sConfig.GetBoolDefault("SyncQueryAudit", false));
+
+    m_snapshotDir = sConfig.GetStringDefault("SnapshotDir", "");
+    if (!m_snapshotDir.empty() && m_snapshotDir.at(m_snapshotDir.length() - 1) != '/' && m_snapshotDir.at(m_snapshotDir.length() - 1) != '\\')
+        { m_snapshotDir.append("/"); }
+    if (m_slowQuerySampleRate == 0)
+        { m_slowQuerySampleRate = 1; }
 
     // create DB connections
 
@@ -139,10 +243,41 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    // create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if (!m_pAsyncConn->Initialize(infoString))
-        { return false; }
+    // create and initialize connections for async requests
+    if (nAsyncConns < MIN_CONNECTION_POOL_SIZE)
+        { nAsyncConns = MIN_CONNECTION_POOL_SIZE; }
+    else if (nAsyncConns > MAX_CONNECTION_POOL_SIZE)
+        { nAsyncConns = MAX_CONNECTION_POOL_SIZE; }
+
+    for (int i = 0; i < nAsyncConns; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConns.push_back(pConn);
+    }
+
+    m_pAsyncConn = m_pAsyncConns[0];
+
+    // read-only replicas are optional, reads fall back to the primary for any that can't be reached
+    Tokens replicas = StrSplit(replicaInfoStrings ? replicaInfoStrings : "", "|");
+    for (Tokens::const_iterator itr = replicas.begin(); itr != replicas.end() && m_pReplicaConnections.size() < MAX_CONNECTION_POOL_SIZE; ++itr)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(itr->c_str()))
+        {
+            delete pConn;
+            sLog.outError("SQL: can't connect to read-only replica %s, its reads go to the primary", itr->c_str());
+            continue;
+        }
+
+        m_pReplicaConnections.push_back(pConn);
+        m_replicaInfoStrings.push_back(*itr);
+    }
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -155,41 +290,139 @@ void Database::StopServer()
     HaltDelayThread();
 
     delete m_pResultQueue;
-    delete m_pAsyncConn;
-
     m_pResultQueue = NULL;
+
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+        { delete m_pAsyncConns[i]; }
+
+    m_pAsyncConns.clear();
     m_pAsyncConn = NULL;
 
     for (size_t i = 0; i < m_pQueryConnections.size(); ++i)
         { delete m_pQueryConnections[i]; }
 
     m_pQueryConnections.clear();
+
+    for (size_t i = 0; i < m_pReplicaConnections.size(); ++i)
+        { delete m_pReplicaConnections[i]; }
+
+    m_pReplicaConnections.clear();
+    m_replicaInfoStrings.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
+SqlDelayThread* Database::CreateDelayThread(SqlConnection* conn, bool pingDatabase)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn, pingDatabase);
 }
 
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(m_delayThreads.empty());
 
-    // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new ACE_Based::Thread(m_threadBody);
+    // New delay thread for delay execute, one per async connection, the first keeps all connections alive
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+    {
+        SqlDelayThread* threadBody = CreateDelayThread(m_pAsyncConns[i], i == 0);
+        m_threadBodies.push_back(threadBody);               // will deleted at m_delayThreads delete
+        m_delayThreads.push_back(new ACE_Based::Thread(threadBody));
+    }
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) { return; }
+    if (m_threadBodies.empty() || m_delayThreads.empty()) { return; }
+
+    m_haltingDelayThreads = true;                           // query holders are not spread anymore
+
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        { m_threadBodies[i]->Stop(); }                      // Stop event
+
+    // all threads must be finished before deleting any, a running one may still pass holder parts to the others
+    for (size_t i = 0; i < m_delayThreads.size(); ++i)
+        { m_delayThreads[i]->wait(); }                      // Wait for flush to DB
+
+    for (size_t i = 0; i < m_delayThreads.size(); ++i)
+        { delete m_delayThreads[i]; }                       // This also deletes m_threadBodies[i]
+
+    m_delayThreads.clear();
+    m_threadBodies.clear();
+    m_haltingDelayThreads = false;
+}
+
+void Database::GetOtherDelayThreads(SqlConnection* conn, std::vector<SqlDelayThread*>& threads) const
+{
+    if (m_haltingDelayThreads)
+        { return; }
+
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+    {
+        if (m_pAsyncConns[i] != conn)
+            { threads.push_back(m_threadBodies[i]); }
+    }
+}
+
+Database::AsyncOrderScope::AsyncOrderScope(Database& db, uint32 key) : m_db(db), m_prevKey(db.m_asyncOrderKey->m_key)
+{
+    m_db.m_asyncOrderKey->m_key = key;
+}
+
+Database::AsyncOrderScope::~AsyncOrderScope()
+{
+    m_db.m_asyncOrderKey->m_key = m_prevKey;
+}
+
+Database::ReplicaReadScope::ReplicaReadScope(Database& db) : m_db(db), m_prevEnabled(db.m_replicaReads->m_enabled)
+{
+    m_db.m_replicaReads->m_enabled = true;
+}
+
+Database::ReplicaReadScope::~ReplicaReadScope()
+{
+    m_db.m_replicaReads->m_enabled = m_prevEnabled;
+}
+
+/// Audit state of a thread, see SyncQueryAudit
+struct SyncQueryAuditState
+{
+    SyncQueryAuditState() : m_marked(false), m_context(NULL) {}
+
+    bool m_marked;
+    const char* m_context;                                  // innermost SyncQueryAudit::Context
+};
+
+static ACE_TSS<SyncQueryAuditState> s_syncQueryAuditState;
+
+bool SyncQueryAudit::m_enabled = false;
+
+SyncQueryAudit::Context::Context(const char* name) : m_prevName(NULL), m_active(m_enabled)
+{
+    if (!m_active)
+        { return; }
+
+    m_prevName = s_syncQueryAuditState->m_context;
+    s_syncQueryAuditState->m_context = name;
+}
+
+SyncQueryAudit::Context::~Context()
+{
+    if (m_active)
+        { s_syncQueryAuditState->m_context = m_prevName; }
+}
+
+void SyncQueryAudit::MarkThread()
+{
+    s_syncQueryAuditState->m_marked = true;
+}
+
+void SyncQueryAudit::OnRequestDone(const char* sql, uint32 time)
+{
+    if (!m_enabled || !s_syncQueryAuditState->m_marked)
+        { return; }
 
-    m_threadBody->Stop();                                   // Stop event
-    m_delayThread->wait();                                  // Wait for flush to DB
-    delete m_delayThread;                                   // This also deletes m_threadBody
-    m_delayThread = NULL;
-    m_threadBody = NULL;
+    const char* context = s_syncQueryAuditState->m_context;
+    sLog.outError("SQL: synchronous request in %s (%u ms, thread " SIZEFMTD "): %s",
+                  context ? context : "<no context>", time, size_t(ACE_Based::Thread::currentId()), sql);
 }
 
 void Database::ThreadStart()
@@ -220,6 +453,9 @@ void Database::escape_string(std::string& str)
 
 SqlConnection* Database::getQueryConnection()
 {
+    if (useReplica())
+        { return getReplicaConnection(); }
+
     int nCount = 0;
 
     if (m_nQueryCounter == long(1 << 31))
@@ -227,23 +463,148 @@ SqlConnection* Database::getQueryConnection()
     else
         { nCount = ++m_nQueryCounter; }
 
-    return m_pQueryConnections[nCount % m_nQueryConnPoolSize];
+    // least used connection, the round-robin start spreads the requests over idle ones
+    SqlConnection* pConn = m_pQueryConnections[nCount % m_nQueryConnPoolSize];
+    for (int i = 1; i < m_nQueryConnPoolSize && pConn->GetUsers() > 0; ++i)
+    {
+        SqlConnection* pOther = m_pQueryConnections[(nCount + i) % m_nQueryConnPoolSize];
+        if (pOther->GetUsers() < pConn->GetUsers())
+            { pConn = pOther; }
+    }
+
+    return pConn;
+}
+
+SqlConnection* Database::getReplicaConnection()
+{
+    if (m_pReplicaConnections.empty())
+        { return NULL; }
+
+    long nCount = ++m_nReplicaCounter;
+    if (nCount < 0)
+    {
+        m_nReplicaCounter = 0;
+        nCount = 0;
+    }
+
+    return m_pReplicaConnections[nCount % m_pReplicaConnections.size()];
+}
+
+bool Database::DelayQuery(SqlQuery* query)
+{
+    if (useReplica())
+        { query->SetConnection(getReplicaConnection()); }
+
+    return getDelayThread()->Delay(query);
 }
 
 void Database::Ping()
 {
     const char* sql = "SELECT 1";
+    uint32 now = WorldTimer::getMSTime();
 
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        if (WorldTimer::getMSTimeDiff(m_pAsyncConns[i]->GetLastActivity(), now) < m_pingIntervallms)
+            { continue; }
+
+        SqlConnection::Lock guard(m_pAsyncConns[i]);
         delete guard->Query(sql);
     }
 
     for (int i = 0; i < m_nQueryConnPoolSize; ++i)
     {
+        if (WorldTimer::getMSTimeDiff(m_pQueryConnections[i]->GetLastActivity(), now) < m_pingIntervallms)
+            { continue; }
+
         SqlConnection::Lock guard(m_pQueryConnections[i]);
         delete guard->Query(sql);
     }
+
+    for (size_t i = 0; i < m_pReplicaConnections.size(); ++i)
+    {
+        if (WorldTimer::getMSTimeDiff(m_pReplicaConnections[i]->GetLastActivity(), now) < m_pingIntervallms)
+            { continue; }
+
+        SqlConnection::Lock guard(m_pReplicaConnections[i]);
+        delete guard->Query(sql);
+    }
+}
+
+void Database::OnRequestDone(const char* sql, uint32 time)
+{
+    SyncQueryAudit::OnRequestDone(sql, time);
+
+    if (m_queryTimeMetric)
+        { m_queryTimeMetric->Add(time); }
+
+    if (!m_slowQueryThreshold || time < m_slowQueryThreshold)
+        { return; }
+
+    if (++m_slowQueries % m_slowQuerySampleRate)
+        { return; }
+
+    sLog.outError("SQL: slow request (%u ms, thread " SIZEFMTD "): %s", time, size_t(ACE_Based::Thread::currentId()), sql);
+}
+
+/**
+ * @brief formats the stats of one connection for Database::GetStatsLines
+ *
+ */
+static int FormatConnectionStats(char* buf, size_t size, const char* kind, uint32 index, SqlConnection const* pConn)
+{
+    SqlConnectionStats const& stats = pConn->GetStats();
+
+    return snprintf(buf, size, "%s %u: users %li, requests %u, avg %u ms, max %u ms, <1/<5/<20/<100/<500/more ms: %u/%u/%u/%u/%u/%u",
+                    kind, index, pConn->GetUsers(),
+                    stats.requests, stats.requests ? uint32(stats.totalTime / stats.requests) : 0, stats.maxTime,
+                    stats.latency[0], stats.latency[1], stats.latency[2], stats.latency[3], stats.latency[4], stats.latency[5]);
+}
+
+void Database::GetStatsLines(std::vector<std::string>& lines) const
+{
+    char buf[256];
+    for (size_t i = 0; i < m_pQueryConnections.size(); ++i)
+    {
+        FormatConnectionStats(buf, sizeof(buf), "sync", uint32(i), m_pQueryConnections[i]);
+        lines.push_back(buf);
+    }
+
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+    {
+        int len = FormatConnectionStats(buf, sizeof(buf), "async", uint32(i), m_pAsyncConns[i]);
+        if (len > 0 && size_t(len) < sizeof(buf) && i < m_threadBodies.size())
+            { snprintf(buf + len, sizeof(buf) - len, ", queued %li", m_threadBodies[i]->GetQueueSize()); }
+
+        lines.push_back(buf);
+    }
+
+    for (size_t i = 0; i < m_pReplicaConnections.size(); ++i)
+    {
+        FormatConnectionStats(buf, sizeof(buf), "replica", uint32(i), m_pReplicaConnections[i]);
+        lines.push_back(buf);
+    }
+}
+
+long Database::GetAsyncQueueSize() const
+{
+    long size = 0;
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        { size += m_threadBodies[i]->GetQueueSize(); }
+
+    return size;
+}
+
+void Database::ResetStats()
+{
+    for (size_t i = 0; i < m_pQueryConnections.size(); ++i)
+        { m_pQueryConnections[i]->ResetStats(); }
+
+    for (size_t i = 0; i < m_pAsyncConns.size(); ++i)
+        { m_pAsyncConns[i]->ResetStats(); }
+
+    for (size_t i = 0; i < m_pReplicaConnections.size(); ++i)
+        { m_pReplicaConnections[i]->ResetStats(); }
 }
 
 bool Database::PExecuteLog(const char* format, ...)
@@ -309,6 +670,54 @@ QueryResult* Database::PQuery(const char* format, ...)
     return Query(szQuery);
 }
 
+QueryResult* Database::QueryStreamed(const char* sql, uint64 rowCount /*= 0*/)
+{
+    // the connection is opened for this query only, so a replica is chosen here directly
+    std::string infoString = m_infoString;
+    if (useReplica())
+        { infoString = m_replicaInfoStrings[uint32(++m_nReplicaCounter) % m_replicaInfoStrings.size()]; }
+
+    SqlConnection* pConn = CreateConnection();
+    if (!pConn->Initialize(infoString.c_str()))
+    {
+        delete pConn;
+        sLog.outError("SQL: can't open a connection for streaming, running buffered: %s", sql);
+        return Query(sql);
+    }
+
+    QueryResult* result = pConn->QueryStreamed(sql);
+    if (!result)
+    {
+        delete pConn;
+        return NULL;
+    }
+
+    return new QueryResultStreamed(result, pConn, rowCount);
+}
+
+QueryResult* Database::QueryWithSnapshot(const char* name, const char* tables, const char* sql, uint64 rowCount /*= 0*/)
+{
+    if (m_snapshotDir.empty())
+        { return QueryStreamed(sql, rowCount); }
+
+    uint64 contentHash = GetTablesChecksum(tables);
+    if (!contentHash)
+        { return QueryStreamed(sql, rowCount); }
+
+    // a changed query makes another snapshot as well
+    contentHash = QuerySnapshotHeader::Hash(sql, strlen(sql), contentHash);
+
+    std::string fileName = m_snapshotDir + name + ".snapshot";
+    if (QueryResult* result = QueryResultSnapshot::Open(fileName, contentHash))
+        { return result; }
+
+    QueryResult* result = QueryStreamed(sql, rowCount);
+    if (!result)
+        { return NULL; }
+
+    return new QueryResultSnapshotWriter(result, fileName, contentHash);
+}
+
 QueryNamedResult* Database::PQueryNamed(const char* format, ...)
 {
     if (!format) { return NULL; }
@@ -346,7 +755,7 @@ bool Database::Execute(const char* sql)
             { return DirectExecute(sql); }
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        getDelayThread()->Delay(new SqlPlainRequest(sql));
     }
 
     return true;
@@ -417,7 +826,7 @@ bool Database::CommitTransaction()
         { return CommitTransactionDirect(); }
 
     // add SqlTransaction to the async queue
-    m_threadBody->Delay(m_TransStorage->detach());
+    getDelayThread()->Delay(m_TransStorage->detach());
     return true;
 }
 
@@ -540,6 +949,49 @@ bool Database::CheckRequiredField(char const* table_name, char const* required_n
     return false;
 }
 
+uint64 Database::GetTableRowCount(char const* table_name)
+{
+    QueryResult* result = PQuery("SELECT COUNT(*) FROM %s", table_name);
+    if (!result)
+        { return 0; }
+
+    uint64 count = (*result)[0].GetUInt64();
+    delete result;
+    return count;
+}
+
+uint64 Database::GetTablesChecksum(char const* tables)
+{
+#ifdef DO_POSTGRESQL
+    // no server side table checksum, a client side one would read the tables the snapshots are meant to avoid
+    return 0;
+#else
+    QueryResult* result = PQuery("CHECKSUM TABLE %s", tables);
+    if (!result)
+        { return 0; }
+
+    uint64 hash = QuerySnapshotHeader::INITIAL_HASH;
+    do
+    {
+        Field* fields = result->Fetch();
+        if (fields[1].IsNULL())                             // table doesn't exist
+        {
+            delete result;
+            return 0;
+        }
+
+        std::string table = fields[0].GetCppString();
+        uint64 checksum = fields[1].GetUInt64();
+        hash = QuerySnapshotHeader::Hash(table.c_str(), table.size(), hash);
+        hash = QuerySnapshotHeader::Hash(&checksum, sizeof(checksum), hash);
+    }
+    while (result->NextRow());
+
+    delete result;
+    return hash;
+#endif
+}
+
 bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
 {
     if (!m_pAsyncConn)
@@ -558,12 +1010,44 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
             { return DirectExecuteStmt(id, params); }
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        getDelayThread()->Delay(new SqlPreparedRequest(id.ID(), params));
     }
 
     return true;
 }
 
+bool Database::ReserveRange(const char* table, const char* column, uint32 count, uint32& first)
+{
+    if (!m_pAsyncConn)
+        { return false; }
+
+    char sql[MAX_QUERY_LEN];
+    SqlConnection::Lock guard(m_pAsyncConn);
+
+#ifdef DO_POSTGRESQL
+    snprintf(sql, MAX_QUERY_LEN, "UPDATE %s SET %s = %s + %u RETURNING %s - %u", table, column, column, count, column, count);
+    QueryResult* result = guard->Query(sql);
+#else
+    // LAST_INSERT_ID is kept per connection, the lock keeps other statements off it until it is read,
+    // it is cleared first as an update without a row leaves the value of an earlier insert
+    if (!guard->Execute("DO LAST_INSERT_ID(0)"))
+        { return false; }
+
+    snprintf(sql, MAX_QUERY_LEN, "UPDATE %s SET %s = LAST_INSERT_ID(%s) + %u", table, column, column, count);
+    if (!guard->Execute(sql))
+        { return false; }
+
+    QueryResult* result = guard->Query("SELECT LAST_INSERT_ID()");
+#endif
+
+    if (!result)
+        { return false; }
+
+    first = result->Fetch()[0].GetUInt32();
+    delete result;
+    return first != 0;
+}
+
 bool Database::DirectExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
 {
     MANGOS_ASSERT(params);
@@ -573,6 +1057,14 @@ bool Database::DirectExecuteStmt(const SqlStatementID& id, SqlStmtParameters* pa
     return _guard->ExecuteStmt(id.ID(), *params);
 }
 
+QueryResult* Database::QueryStmt(const SqlStatementID& id, SqlStmtParameters* params)
+{
+    MANGOS_ASSERT(params);
+    std::auto_ptr<SqlStmtParameters> p(params);
+    SqlConnection::Lock _guard(getQueryConnection());
+    return _guard->QueryStmt(id.ID(), *params);
+}
+
 SqlStatement Database::CreateStatement(SqlStatementID& index, const char* fmt)
 {
     int nId = -1;
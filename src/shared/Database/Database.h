@@ -34,8 +34,11 @@
 #include <ace/Atomic_Op.h>
 #include "SqlPreparedStatement.h"
 
+class MetricHistogram;
+
 class SqlTransaction;
 class SqlResultQueue;
+class SqlQuery;
 class SqlQueryHolder;
 class SqlStmtParameters;
 class SqlParamBinder;
@@ -43,6 +46,34 @@ class Database;
 
 #define MAX_QUERY_LEN   (32*1024)
 
+/**
+ * @brief timing of the requests run on one connection
+ *
+ */
+struct SqlConnectionStats
+{
+    enum
+    {
+        LATENCY_BUCKETS = 6
+    };
+
+    /**
+     * @brief upper limits in ms of the latency buckets, the last one is open
+     *
+     */
+    static uint32 const LatencyLimits[LATENCY_BUCKETS];
+
+    SqlConnectionStats() { Reset(); }
+
+    void Reset();
+    void Add(uint32 time);
+
+    uint32 requests;
+    uint64 totalTime;
+    uint32 maxTime;
+    uint32 latency[LATENCY_BUCKETS];                        // requests per latency bucket
+};
+
 /**
  * @brief
  *
@@ -77,6 +108,16 @@ class MANGOS_DLL_SPEC SqlConnection
          * @return QueryNamedResult
          */
         virtual QueryNamedResult* QueryNamed(const char* sql) = 0;
+        /**
+         * @brief query with rows fetched from the server while the result is iterated
+         *
+         * The connection can't run anything else until the result is deleted and the row count
+         * of the result is unknown (0). DBMS without support return a buffered result.
+         *
+         * @param sql
+         * @return QueryResult
+         */
+        virtual QueryResult* QueryStreamed(const char* sql) { return Query(sql); }
 
         /**
          * @brief public methods for making requests
@@ -123,6 +164,14 @@ class MANGOS_DLL_SPEC SqlConnection
          * @return bool
          */
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
+        /**
+         * @brief
+         *
+         * @param nIndex
+         * @param id
+         * @return QueryResult
+         */
+        QueryResult* QueryStmt(int nIndex, const SqlStmtParameters& id);
 
         /**
          * @brief SqlConnection object lock
@@ -136,12 +185,12 @@ class MANGOS_DLL_SPEC SqlConnection
                  *
                  * @param conn
                  */
-                Lock(SqlConnection* conn) : m_pConn(conn) { m_pConn->m_mutex.acquire(); }
+                Lock(SqlConnection* conn) : m_pConn(conn) { ++m_pConn->m_users; m_pConn->m_mutex.acquire(); }
                 /**
                  * @brief
                  *
                  */
-                ~Lock() { m_pConn->m_mutex.release(); }
+                ~Lock() { m_pConn->m_mutex.release(); --m_pConn->m_users; }
 
                 /**
                  * @brief
@@ -161,13 +210,41 @@ class MANGOS_DLL_SPEC SqlConnection
          */
         Database& DB() { return m_db; }
 
+        /**
+         * @brief accounts a finished request in the stats and the slow request log
+         *
+         * @param sql
+         * @param startTime WorldTimer::getMSTime() at the start of the request
+         */
+        void RecordRequest(const char* sql, uint32 startTime);
+
+        /**
+         * @brief stats since the last reset, updated while the connection is locked
+         *
+         * @return SqlConnectionStats
+         */
+        SqlConnectionStats const& GetStats() const { return m_stats; }
+        void ResetStats() { m_stats.Reset(); }
+        /**
+         * @brief threads holding or waiting for the connection lock
+         *
+         * @return long
+         */
+        long GetUsers() const { return m_users.value(); }
+        /**
+         * @brief WorldTimer::getMSTime() of the last finished request
+         *
+         * @return uint32
+         */
+        uint32 GetLastActivity() const { return m_lastActivity; }
+
     protected:
         /**
          * @brief
          *
          * @param db
          */
-        SqlConnection(Database& db) : m_db(db) {}
+        SqlConnection(Database& db) : m_db(db), m_users(0), m_lastActivity(0) {}
 
         /**
          * @brief
@@ -199,6 +276,9 @@ class MANGOS_DLL_SPEC SqlConnection
          */
         typedef ACE_Recursive_Thread_Mutex LOCK_TYPE;
         LOCK_TYPE m_mutex; /**< TODO */
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_users;      /**< see GetUsers() */
+        SqlConnectionStats m_stats;
+        volatile uint32 m_lastActivity;
 
         /**
          * @brief
@@ -208,6 +288,53 @@ class MANGOS_DLL_SPEC SqlConnection
         StmtHolder m_holder; /**< TODO */
 };
 
+/**
+ * @brief finds synchronous requests issued by threads that must not wait for the database
+ *
+ * The world and map update threads mark themselves with MarkThread(), packet handlers and other
+ * entry points name the work they run with a Context scope. While the audit is enabled (config
+ * SyncQueryAudit) every request a marked thread waits for is logged with the innermost context
+ * and its time, so the worst callers can be moved to AsyncQuery.
+ */
+class MANGOS_DLL_SPEC SyncQueryAudit
+{
+    public:
+        /**
+         * @brief names the work running on the current thread while it exists
+         *
+         */
+        class MANGOS_DLL_SPEC Context
+        {
+            public:
+                explicit Context(const char* name);
+                ~Context();
+
+            private:
+                const char* m_prevName;
+                bool m_active;                              // audit was enabled at construction
+        };
+
+        static void SetEnabled(bool enabled) { m_enabled = enabled; }
+        static bool IsEnabled() { return m_enabled; }
+
+        /**
+         * @brief audits the synchronous requests of the calling thread from now on
+         *
+         */
+        static void MarkThread();
+
+        /**
+         * @brief logs the request if the calling thread is audited
+         *
+         * @param sql
+         * @param time ms the thread waited for the request
+         */
+        static void OnRequestDone(const char* sql, uint32 time);
+
+    private:
+        static bool m_enabled;
+};
+
 /**
  * @brief
  *
@@ -226,20 +353,68 @@ class MANGOS_DLL_SPEC Database
          *
          * @param infoString
          * @param nConns
+         * @param nAsyncConns connections (each with its own worker thread) for async requests
+         * @param replicaInfoStrings '|' separated info strings of read-only replicas, see ReplicaReadScope
          * @return bool
          */
-        virtual bool Initialize(const char* infoString, int nConns = 1);
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncConns = 1, const char* replicaInfoStrings = NULL);
         /**
-         * @brief start worker thread for async DB request execution
+         * @brief start worker threads for async DB request execution
          *
          */
         virtual void InitDelayThread();
         /**
-         * @brief stop worker thread
+         * @brief stop worker threads
          *
          */
         virtual void HaltDelayThread();
 
+        /**
+         * @brief keeps the async requests of one key in order while it exists
+         *
+         * Async requests (queries, executes and transactions) are spread over the async connections by
+         * the key of the innermost scope of the calling thread, requests of the same key always use
+         * the same connection and so are executed in the order they were issued. Requests without a
+         * scope use key 0, that is the first connection, like all requests did before the pool existed.
+         * Requests of different keys are not ordered against each other.
+         */
+        class MANGOS_DLL_SPEC AsyncOrderScope
+        {
+            public:
+                AsyncOrderScope(Database& db, uint32 key);
+                ~AsyncOrderScope();
+
+            private:
+                Database& m_db;
+                uint32 m_prevKey;
+        };
+
+        /**
+         * @brief sends the reads of the calling thread to the read-only replicas while it exists
+         *
+         * Synchronous queries, statement queries, streamed queries and async queries issued in the
+         * scope use a replica connection, executes and transactions always stay on the primary.
+         * Only reads that can live with the replication lag belong in a scope: a row written by
+         * this server just before may not be on the replica yet. Without replicas it has no effect.
+         */
+        class MANGOS_DLL_SPEC ReplicaReadScope
+        {
+            public:
+                explicit ReplicaReadScope(Database& db);
+                ~ReplicaReadScope();
+
+            private:
+                Database& m_db;
+                bool m_prevEnabled;
+        };
+
+        /**
+         * @brief
+         *
+         * @return bool true if read-only replicas are connected
+         */
+        bool HasReplicas() const { return !m_pReplicaConnections.empty(); }
+
         /**
          * @brief Synchronous DB queries
          *
@@ -279,6 +454,34 @@ class MANGOS_DLL_SPEC Database
          */
         QueryNamedResult* PQueryNamed(const char* format, ...) ATTR_PRINTF(2, 3);
 
+        /**
+         * @brief query for loading big tables, see SqlConnection::QueryStreamed
+         *
+         * Runs on a connection of its own that lives as long as the result, so the rows are
+         * not held in client memory at once and other queries can be used while iterating.
+         *
+         * @param sql
+         * @param rowCount expected number of rows reported by GetRowCount(), e.g. for progress bars
+         * @return QueryResult
+         */
+        QueryResult* QueryStreamed(const char* sql, uint64 rowCount = 0);
+
+        /**
+         * @brief streamed query of static data, answered from a binary snapshot while its tables are unchanged
+         *
+         * With SnapshotDir set the result of the first run is written to a snapshot file (see QuerySnapshot.h)
+         * together with the checksum of the tables. Later runs map that file instead of querying while the
+         * checksum of the tables is the same. Without SnapshotDir, or if the database can't checksum the
+         * tables, this is QueryStreamed.
+         *
+         * @param name name of the snapshot file
+         * @param tables comma separated list of all tables the query reads
+         * @param sql
+         * @param rowCount see QueryStreamed
+         * @return QueryResult
+         */
+        QueryResult* QueryWithSnapshot(const char* name, const char* tables, const char* sql, uint64 rowCount = 0);
+
         /**
          * @brief
          *
@@ -302,6 +505,20 @@ class MANGOS_DLL_SPEC Database
          */
         bool DirectPExecute(const char* format, ...) ATTR_PRINTF(2, 3);
 
+        /**
+         * @brief adds count to the counter in the only row of table and returns its value before
+         *
+         * The update and the read run on the async connection under one lock, so several servers
+         * using one database never get overlapping ranges.
+         *
+         * @param table table holding a single row
+         * @param column counter column
+         * @param count size of the reserved range
+         * @param first first value of the reserved range
+         * @return bool false if the update failed or the table has no row
+         */
+        bool ReserveRange(const char* table, const char* column, uint32 count, uint32& first);
+
         /// Async queries and query holders, implemented in DatabaseImpl.h
 
         // Query / member
@@ -620,6 +837,20 @@ class MANGOS_DLL_SPEC Database
          * @return bool
          */
         bool CheckRequiredField(char const* table_name, char const* required_name);
+        /**
+         * @brief number of rows of a table, e.g. as row count of streamed queries
+         *
+         * @param table_name
+         * @return uint64
+         */
+        uint64 GetTableRowCount(char const* table_name);
+        /**
+         * @brief hash of the content of the tables, 0 if a table is missing or the database can't checksum tables
+         *
+         * @param tables comma separated list
+         * @return uint64
+         */
+        uint64 GetTablesChecksum(char const* tables);
         /**
          * @brief
          *
@@ -628,11 +859,43 @@ class MANGOS_DLL_SPEC Database
         uint32 GetPingIntervall() { return m_pingIntervallms; }
 
         /**
-         * @brief function to ping database connections
+         * @brief function to ping database connections, connections used within the ping interval are skipped
          *
          */
         void Ping();
 
+        /**
+         * @brief logs 1 of SlowQuerySampleRate requests taking at least SlowQueryThreshold ms
+         *
+         * @param sql
+         * @param time
+         */
+        void OnRequestDone(const char* sql, uint32 time);
+
+        /**
+         * @brief request stats of all connections and the queue sizes of the delay threads
+         *
+         * @param lines one line per connection
+         */
+        void GetStatsLines(std::vector<std::string>& lines) const;
+        /**
+         * @brief requests queued for the delay threads and not finished yet
+         *
+         * @return long
+         */
+        long GetAsyncQueueSize() const;
+        /**
+         * @brief name of the database from the info string, the label of its metrics
+         *
+         * @return std::string
+         */
+        std::string const& GetDatabaseName() const { return m_databaseName; }
+        /**
+         * @brief
+         *
+         */
+        void ResetStats();
+
         /**
          * @brief set this to allow async transactions
          *
@@ -650,10 +913,11 @@ class MANGOS_DLL_SPEC Database
          */
         Database() :
             m_nQueryConnPoolSize(1), m_pAsyncConn(NULL), m_pResultQueue(NULL),
-            m_threadBody(NULL), m_delayThread(NULL), m_bAllowAsyncTransactions(false),
-            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+            m_bAllowAsyncTransactions(false), m_haltingDelayThreads(false),
+            m_iStmtIndex(-1), m_logSQL(false), m_queryTimeMetric(NULL), m_pingIntervallms(0), m_slowQueryThreshold(0), m_slowQuerySampleRate(1)
         {
             m_nQueryCounter = -1;
+            m_nReplicaCounter = -1;
         }
 
         /**
@@ -673,7 +937,7 @@ class MANGOS_DLL_SPEC Database
          *
          * @return SqlDelayThread
          */
-        virtual SqlDelayThread* CreateDelayThread();
+        virtual SqlDelayThread* CreateDelayThread(SqlConnection* conn, bool pingDatabase);
 
         /**
          * @brief
@@ -725,12 +989,30 @@ class MANGOS_DLL_SPEC Database
                 SqlTransaction* m_pTrans; /**< TODO */
         };
 
+        /// Key of the innermost AsyncOrderScope of a thread
+        struct AsyncOrderKey
+        {
+            AsyncOrderKey() : m_key(0) {}
+
+            uint32 m_key;
+        };
+
+        /// Set while a ReplicaReadScope of the thread exists
+        struct ReplicaReadFlag
+        {
+            ReplicaReadFlag() : m_enabled(false) {}
+
+            bool m_enabled;
+        };
+
         /**
          * @brief per-thread based storage for SqlTransaction object initialization - no locking is required
          *
          */
         typedef ACE_TSS<Database::TransHelper> DBTransHelperTSS;
         Database::DBTransHelperTSS m_TransStorage; /**< TODO */
+        ACE_TSS<AsyncOrderKey> m_asyncOrderKey;             /**< per-thread key selecting the delay thread */
+        ACE_TSS<ReplicaReadFlag> m_replicaReads;            /**< per-thread, see ReplicaReadScope */
 
         ///< DB connections
         /**
@@ -740,11 +1022,47 @@ class MANGOS_DLL_SPEC Database
          */
         SqlConnection* getQueryConnection();
         /**
-         * @brief for now return one single connection for async requests
+         * @brief round-robin selection of a replica connection, NULL without replicas
+         *
+         * @return SqlConnection
+         */
+        SqlConnection* getReplicaConnection();
+        /**
+         * @brief true if the reads of the calling thread go to a replica
+         *
+         * @return bool
+         */
+        bool useReplica() const { return m_replicaReads->m_enabled && !m_pReplicaConnections.empty(); }
+        /**
+         * @brief queues an async query to the delay thread of the calling thread
+         *
+         * In a ReplicaReadScope the query is executed on a replica connection instead of the one of the delay thread.
+         *
+         * @param query
+         * @return bool
+         */
+        bool DelayQuery(SqlQuery* query);
+        /**
+         * @brief connection for direct executes and direct transactions, also used by the first delay thread
          *
          * @return SqlConnection
          */
         SqlConnection* getAsyncConnection() const { return m_pAsyncConn; }
+        /**
+         * @brief delay thread for the async requests of the calling thread, see AsyncOrderScope
+         *
+         * @return SqlDelayThread
+         */
+        SqlDelayThread* getDelayThread() { return m_threadBodies[m_asyncOrderKey->m_key % m_threadBodies.size()]; }
+
+        friend class SqlQueryHolderEx;
+        /**
+         * @brief delay threads a query holder executed on conn can spread its queries over, none while halting
+         *
+         * @param conn
+         * @param threads
+         */
+        void GetOtherDelayThreads(SqlConnection* conn, std::vector<SqlDelayThread*>& threads) const;
 
         friend class SqlStatement;
         // PREPARED STATEMENT API
@@ -764,6 +1082,14 @@ class MANGOS_DLL_SPEC Database
          * @return bool
          */
         bool DirectExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params);
+        /**
+         * @brief synchronous prepared query on one of the query connections
+         *
+         * @param id
+         * @param params
+         * @return QueryResult
+         */
+        QueryResult* QueryStmt(const SqlStatementID& id, SqlStmtParameters* params);
 
         // connection helper counters
         int m_nQueryConnPoolSize;                               /**< current size of query connection pool */
@@ -776,14 +1102,23 @@ class MANGOS_DLL_SPEC Database
         typedef std::vector< SqlConnection* > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections; /**< TODO */
 
-        // only one single DB connection for transactions
-        SqlConnection* m_pAsyncConn; /**< TODO */
+        // one connection per delay thread, the first one also serves direct executes and transactions
+        SqlConnectionContainer m_pAsyncConns;               /**< connections of m_threadBodies, same order */
+        SqlConnection* m_pAsyncConn;                        /**< first of m_pAsyncConns */
+
+        SqlConnectionContainer m_pReplicaConnections;       /**< read-only replicas, see ReplicaReadScope */
+        std::vector<std::string> m_replicaInfoStrings;      /**< same order, for streamed queries */
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_nReplicaCounter; /**< counter for replica selection */
 
         SqlResultQueue*     m_pResultQueue;                 /**< Transaction queues from diff. threads */
-        SqlDelayThread*     m_threadBody;                   /**< Pointer to delay sql executer (owned by m_delayThread) */
-        ACE_Based::Thread* m_delayThread;                   /**< Pointer to executer thread */
+
+        typedef std::vector<SqlDelayThread*> SqlDelayThreadContainer;
+        typedef std::vector<ACE_Based::Thread*> ThreadContainer;
+        SqlDelayThreadContainer m_threadBodies;             /**< delay sql executers (owned by m_delayThreads) */
+        ThreadContainer m_delayThreads;                     /**< executer threads */
 
         bool m_bAllowAsyncTransactions;                     /**< flag which specifies if async transactions are enabled */
+        volatile bool m_haltingDelayThreads;                /**< set while m_delayThreads are stopped */
 
         // PREPARED STATEMENT REGISTRY
         /**
@@ -812,6 +1147,13 @@ class MANGOS_DLL_SPEC Database
 
         bool m_logSQL; /**< TODO */
         std::string m_logsDir; /**< TODO */
+        std::string m_infoString; /**< used for connections opened later */
+        std::string m_databaseName;
+        MetricHistogram* m_queryTimeMetric;                 /**< db_query_ms of this database */
+        std::string m_snapshotDir;                          /**< see QueryWithSnapshot, empty for no snapshots */
         uint32 m_pingIntervallms; /**< TODO */
+        uint32 m_slowQueryThreshold;                        /**< ms, 0 for no slow request log */
+        uint32 m_slowQuerySampleRate;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_slowQueries; /**< slow requests so far, for sampling */
 };
 #endif
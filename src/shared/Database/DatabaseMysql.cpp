@@ -203,6 +203,8 @@ bool MySQLConnection::_Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD**
     *pRowCount = mysql_affected_rows(mMysql);
     *pFieldCount = mysql_field_count(mMysql);
 
+    RecordRequest(sql, _s);
+
     if (!*pResult)
         { return false; }
 
@@ -252,6 +254,41 @@ QueryNamedResult* MySQLConnection::QueryNamed(const char* sql)
     return new QueryNamedResult(queryResult, names);
 }
 
+QueryResult* MySQLConnection::QueryStreamed(const char* sql)
+{
+    if (!mMysql)
+        { return NULL; }
+
+    uint32 _s = WorldTimer::getMSTime();
+
+    if (mysql_query(mMysql, sql))
+    {
+        sLog.outErrorDb("SQL: %s", sql);
+        sLog.outErrorDb("query ERROR: %s", mysql_error(mMysql));
+        return NULL;
+    }
+
+    DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
+
+    RecordRequest(sql, _s);
+
+    // rows stay at the server until fetched one by one, so the count is unknown
+    MYSQL_RES* result = mysql_use_result(mMysql);
+    if (!result)
+        { return NULL; }
+
+    QueryResultMysql* queryResult = new QueryResultMysql(result, mysql_fetch_fields(result), 0, mysql_field_count(mMysql));
+
+    // empty results are NULL like for buffered queries
+    if (!queryResult->NextRow())
+    {
+        delete queryResult;
+        return NULL;
+    }
+
+    return queryResult;
+}
+
 bool MySQLConnection::Execute(const char* sql)
 {
     if (!mMysql)
@@ -270,6 +307,7 @@ bool MySQLConnection::Execute(const char* sql)
         {
             DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
         }
+        RecordRequest(sql, _s);
         // end guarded block
     }
 
@@ -278,6 +316,8 @@ bool MySQLConnection::Execute(const char* sql)
 
 bool MySQLConnection::_TransactionCmd(const char* sql)
 {
+    uint32 _s = WorldTimer::getMSTime();
+
     if (mysql_query(mMysql, sql))
     {
         sLog.outError("SQL: %s", sql);
@@ -288,6 +328,7 @@ bool MySQLConnection::_TransactionCmd(const char* sql)
     {
         DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "SQL: %s", sql);
     }
+    RecordRequest(sql, _s);                                 // a commit waits for the whole transaction to be written
     return true;
 }
 
@@ -383,7 +424,11 @@ bool MySqlPreparedStatement::prepare()
         /* Get total columns in the query */
         m_nColumns = mysql_num_fields(m_pResultMetadata);
 
-        // bind output buffers
+        // bind output buffers, sized by the longest value of every column at query()
+        m_pResult = new MYSQL_BIND[m_nColumns];
+
+        my_bool updateMaxLength = 1;
+        mysql_stmt_attr_set(m_stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
     }
 
     m_bPrepared = true;
@@ -469,6 +514,8 @@ bool MySqlPreparedStatement::execute()
     if (!isPrepared())
         { return false; }
 
+    uint32 _s = WorldTimer::getMSTime();
+
     if (mysql_stmt_execute(m_stmt))
     {
         sLog.outError("SQL: can not execute '%s'", m_szFmt.c_str());
@@ -476,9 +523,93 @@ bool MySqlPreparedStatement::execute()
         return false;
     }
 
+    m_pConn.RecordRequest(m_szFmt.c_str(), _s);
     return true;
 }
 
+QueryResult* MySqlPreparedStatement::query()
+{
+    if (!isQuery() || !execute())
+        { return NULL; }
+
+    if (mysql_stmt_store_result(m_stmt))
+    {
+        sLog.outError("SQL: can not store result of '%s'", m_szFmt.c_str());
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(m_stmt));
+        return NULL;
+    }
+
+    uint64 rowCount = mysql_stmt_num_rows(m_stmt);
+    if (!rowCount)
+    {
+        mysql_stmt_free_result(m_stmt);
+        return NULL;
+    }
+
+    // max_length of the metadata is updated by mysql_stmt_store_result
+    MYSQL_FIELD* fields = mysql_fetch_fields(m_pResultMetadata);
+
+    std::vector<std::vector<char> > buffers(m_nColumns);
+    std::vector<Field::NumericValue> numbers(m_nColumns);
+    std::vector<Field::NumericType> types(m_nColumns);
+    std::vector<unsigned long> lengths(m_nColumns);
+    std::vector<my_bool> nulls(m_nColumns);
+
+    memset(m_pResult, 0, sizeof(MYSQL_BIND) * m_nColumns);
+    for (uint32 i = 0; i < m_nColumns; ++i)
+    {
+        m_pResult[i].length = &lengths[i];
+        m_pResult[i].is_null = &nulls[i];
+
+        // numbers are received in binary form and not parsed again by Field
+        types[i] = QueryResultMysqlStmt::GetNumericType(fields[i]);
+        switch (types[i])
+        {
+            case Field::NUMERIC_INT:
+            case Field::NUMERIC_UINT:
+                m_pResult[i].buffer_type = MYSQL_TYPE_LONGLONG;
+                m_pResult[i].is_unsigned = types[i] == Field::NUMERIC_UINT;
+                m_pResult[i].buffer = &numbers[i];
+                break;
+            case Field::NUMERIC_DOUBLE:
+                m_pResult[i].buffer_type = MYSQL_TYPE_DOUBLE;
+                m_pResult[i].buffer = &numbers[i];
+                break;
+            default:
+                buffers[i].resize(fields[i].max_length + 1);
+                m_pResult[i].buffer_type = MYSQL_TYPE_STRING;
+                m_pResult[i].buffer = &buffers[i][0];
+                m_pResult[i].buffer_length = buffers[i].size();
+                break;
+        }
+    }
+
+    if (mysql_stmt_bind_result(m_stmt, m_pResult))
+    {
+        sLog.outError("SQL ERROR: mysql_stmt_bind_result() failed for '%s'", m_szFmt.c_str());
+        sLog.outError("SQL ERROR: %s", mysql_stmt_error(m_stmt));
+        mysql_stmt_free_result(m_stmt);
+        return NULL;
+    }
+
+    QueryResultMysqlStmt* result = new QueryResultMysqlStmt(fields, rowCount, m_nColumns);
+    while (mysql_stmt_fetch(m_stmt) == 0)
+    {
+        for (uint32 i = 0; i < m_nColumns; ++i)
+        {
+            if (types[i] != Field::NUMERIC_NONE)
+                { result->AddNumeric(i, numbers[i], nulls[i] != 0); }
+            else
+                { result->AddValue(i, nulls[i] ? NULL : &buffers[i][0], lengths[i]); }
+        }
+    }
+
+    mysql_stmt_free_result(m_stmt);
+
+    result->NextRow();
+    return result;
+}
+
 enum_field_types MySqlPreparedStatement::ToMySQLType(const SqlStmtFieldData& data, my_bool& bUnsigned)
 {
     bUnsigned = 0;
@@ -81,6 +81,12 @@ class MANGOS_DLL_SPEC MySqlPreparedStatement : public SqlPreparedStatement
          * @return bool
          */
         virtual bool execute() override;
+        /**
+         * @brief execute SELECT statement, the rows are fetched as strings like for plain queries
+         *
+         * @return QueryResult
+         */
+        virtual QueryResult* query() override;
 
     protected:
         /**
@@ -110,7 +116,7 @@ class MANGOS_DLL_SPEC MySqlPreparedStatement : public SqlPreparedStatement
         MYSQL* m_pMySQLConn; /**< TODO */
         MYSQL_STMT* m_stmt; /**< TODO */
         MYSQL_BIND* m_pInputArgs; /**< TODO */
-        MYSQL_BIND* m_pResult; /**< TODO */
+        MYSQL_BIND* m_pResult;                              /**< output buffers of query(), one per column */
         MYSQL_RES* m_pResultMetadata; /**< TODO */
 };
 
@@ -155,6 +161,13 @@ class MANGOS_DLL_SPEC MySQLConnection : public SqlConnection
          * @return QueryNamedResult
          */
         QueryNamedResult* QueryNamed(const char* sql) override;
+        /**
+         * @brief query iterated with mysql_use_result
+         *
+         * @param sql
+         * @return QueryResult
+         */
+        QueryResult* QueryStreamed(const char* sql) override;
         /**
          * @brief
          *
@@ -125,6 +125,8 @@ bool PostgreSQLConnection::_Query(const char* sql, PGresult** pResult, uint64* p
         DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
     }
 
+    RecordRequest(sql, _s);
+
     *pRowCount = PQntuples(*pResult);
     *pFieldCount = PQnfields(*pResult);
     // end guarded block
@@ -156,6 +158,49 @@ QueryResult* PostgreSQLConnection::Query(const char* sql)
     return queryResult;
 }
 
+QueryResult* PostgreSQLConnection::QueryStreamed(const char* sql)
+{
+    if (!mPGconn)
+        { return NULL; }
+
+    uint32 _s = WorldTimer::getMSTime();
+
+    if (!PQsendQuery(mPGconn, sql))
+    {
+        sLog.outErrorDb("SQL : %s", sql);
+        sLog.outErrorDb("SQL %s", PQerrorMessage(mPGconn));
+        return NULL;
+    }
+
+    // without single row mode the first result simply holds all rows
+    PQsetSingleRowMode(mPGconn);
+
+    PGresult* result = PQgetResult(mPGconn);
+    ExecStatusType status = result ? PQresultStatus(result) : PGRES_FATAL_ERROR;
+    if (status != PGRES_SINGLE_TUPLE && status != PGRES_TUPLES_OK)
+    {
+        sLog.outErrorDb("SQL : %s", sql);
+        sLog.outErrorDb("SQL %s", PQerrorMessage(mPGconn));
+        PQclear(result);
+        while ((result = PQgetResult(mPGconn)))
+            { PQclear(result); }
+        return NULL;
+    }
+
+    DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
+
+    QueryResultPostgre* queryResult = new QueryResultPostgre(mPGconn, result, PQnfields(result));
+
+    // empty results are NULL like for buffered queries
+    if (!queryResult->NextRow())
+    {
+        delete queryResult;
+        return NULL;
+    }
+
+    return queryResult;
+}
+
 QueryNamedResult* PostgreSQLConnection::QueryNamed(const char* sql)
 {
     if (!mPGconn)
@@ -197,6 +242,7 @@ bool PostgreSQLConnection::Execute(const char* sql)
         DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
     }
 
+    RecordRequest(sql, _s);
     PQclear(res);
     return true;
 }
@@ -48,18 +48,41 @@ class Field
             DB_TYPE_BOOL    = 0x04
         };
 
+        /**
+         * @brief kind of a value stored natively instead of as text
+         *
+         */
+        enum NumericType
+        {
+            NUMERIC_NONE    = 0x00,                         // value is the text of mValue
+            NUMERIC_INT     = 0x01,
+            NUMERIC_UINT    = 0x02,
+            NUMERIC_DOUBLE  = 0x03
+        };
+
         /**
          * @brief
          *
          */
-        Field() : mValue(NULL), mType(DB_TYPE_UNKNOWN) {}
+        union NumericValue
+        {
+            int64 i64;
+            uint64 ui64;
+            double d;
+        };
+
+        /**
+         * @brief
+         *
+         */
+        Field() : mValue(NULL), mType(DB_TYPE_UNKNOWN), mNumericType(NUMERIC_NONE) { mNumeric.ui64 = 0; }
         /**
          * @brief
          *
          * @param value
          * @param type
          */
-        Field(const char* value, enum DataTypes type) : mValue(value), mType(type) {}
+        Field(const char* value, enum DataTypes type) : mValue(value), mType(type), mNumericType(NUMERIC_NONE) { mNumeric.ui64 = 0; }
 
         /**
          * @brief
@@ -78,14 +101,19 @@ class Field
          *
          * @return bool
          */
-        bool IsNULL() const { return mValue == NULL; }
+        bool IsNULL() const { return mValue == NULL && mNumericType == NUMERIC_NONE; }
 
         /**
          * @brief
          *
          * @return const char
          */
-        const char* GetString() const { return mValue; }
+        const char* GetString() const
+        {
+            if (!mValue && mNumericType != NUMERIC_NONE)
+                { FormatNumeric(); }
+            return mValue;
+        }
         /**
          * @brief
          *
@@ -93,52 +121,68 @@ class Field
          */
         std::string GetCppString() const
         {
-            return mValue ? mValue : "";                    // std::string s = 0 have undefine result in C++
+            const char* value = GetString();
+            return value ? value : "";                      // std::string s = 0 have undefine result in C++
         }
         /**
          * @brief
          *
          * @return float
          */
-        float GetFloat() const { return mValue ? static_cast<float>(atof(mValue)) : 0.0f; }
+        float GetFloat() const
+        {
+            if (mNumericType != NUMERIC_NONE)
+                { return static_cast<float>(NumericAsDouble()); }
+            return mValue ? static_cast<float>(atof(mValue)) : 0.0f;
+        }
         /**
          * @brief
          *
          * @return bool
          */
-        bool GetBool() const { return mValue ? atoi(mValue) > 0 : false; }
-        double GetDouble() const { return mValue ? static_cast<double>(atof(mValue)) : 0.0f; }
-        int8 GetInt8() const { return mValue ? static_cast<int8>(atol(mValue)) : int8(0); }
+        bool GetBool() const
+        {
+            if (mNumericType != NUMERIC_NONE)
+                { return mNumericType == NUMERIC_DOUBLE ? mNumeric.d >= 1.0 : NumericAsInt64() > 0; }
+            return mValue ? atoi(mValue) > 0 : false;
+        }
+        double GetDouble() const
+        {
+            if (mNumericType != NUMERIC_NONE)
+                { return NumericAsDouble(); }
+            return mValue ? static_cast<double>(atof(mValue)) : 0.0f;
+        }
+        int8 GetInt8() const { return static_cast<int8>(GetLong()); }
         /**
          * @brief
          *
          * @return int32
          */
-        int32 GetInt32() const { return mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
+        int32 GetInt32() const { return static_cast<int32>(GetLong()); }
         /**
          * @brief
          *
          * @return uint8
          */
-        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
+        uint8 GetUInt8() const { return static_cast<uint8>(GetLong()); }
         /**
          * @brief
          *
          * @return uint16
          */
-        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
+        uint16 GetUInt16() const { return static_cast<uint16>(GetLong()); }
         /**
          * @brief
          *
          * @return int16
          */
-        int16 GetInt16() const { return mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
+        int16 GetInt16() const { return static_cast<int16>(GetLong()); }
         /**
          * @brief
          *
          * @return uint32
          */
-        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(atol(mValue)) : uint32(0); }
+        uint32 GetUInt32() const { return static_cast<uint32>(GetLong()); }
         /**
          * @brief
          *
@@ -146,6 +190,9 @@ class Field
          */
         uint64 GetUInt64() const
         {
+            if (mNumericType != NUMERIC_NONE)
+                { return mNumericType == NUMERIC_UINT ? mNumeric.ui64 : uint64(NumericAsInt64()); }
+
             uint64 value = 0;
             if (!mValue || sscanf(mValue, UI64FMTD, &value) == -1)
                 { return 0; }
@@ -155,6 +202,9 @@ class Field
 
         uint64 GetInt64() const
         {
+            if (mNumericType != NUMERIC_NONE)
+                { return NumericAsInt64(); }
+
             int64 value = 0;
             if (!mValue || sscanf(mValue, SI64FMTD, &value) == -1)
                 return 0;
@@ -176,7 +226,15 @@ class Field
          *
          * @param value
          */
-        void SetValue(const char* value) { mValue = value; }
+        void SetValue(const char* value) { mValue = value; mNumericType = NUMERIC_NONE; }
+
+        /**
+         * @brief stores a value already converted by the DBMS API, the text is only built if requested
+         *
+         * @param type NUMERIC_NONE for NULL values
+         * @param value
+         */
+        void SetNumeric(NumericType type, NumericValue value) { mValue = NULL; mNumericType = type; mNumeric = value; }
 
     private:
         /**
@@ -193,7 +251,60 @@ class Field
          */
         Field& operator=(Field const&);
 
-        const char* mValue; /**< TODO */
+        /**
+         * @brief integer getters base, atol result for text values
+         *
+         * @return int64
+         */
+        int64 GetLong() const
+        {
+            if (mNumericType != NUMERIC_NONE)
+                { return NumericAsInt64(); }
+            return mValue ? int64(atol(mValue)) : int64(0);
+        }
+
+        int64 NumericAsInt64() const
+        {
+            switch (mNumericType)
+            {
+                case NUMERIC_INT:    return mNumeric.i64;
+                case NUMERIC_UINT:   return int64(mNumeric.ui64);
+                case NUMERIC_DOUBLE: return int64(mNumeric.d);
+                default:             return 0;
+            }
+        }
+
+        double NumericAsDouble() const
+        {
+            switch (mNumericType)
+            {
+                case NUMERIC_INT:    return double(mNumeric.i64);
+                case NUMERIC_UINT:   return double(mNumeric.ui64);
+                case NUMERIC_DOUBLE: return mNumeric.d;
+                default:             return 0.0;
+            }
+        }
+
+        /**
+         * @brief builds the text of a native value for GetString()
+         *
+         */
+        void FormatNumeric() const
+        {
+            switch (mNumericType)
+            {
+                case NUMERIC_INT:    snprintf(mText, sizeof(mText), SI64FMTD, mNumeric.i64); break;
+                case NUMERIC_UINT:   snprintf(mText, sizeof(mText), UI64FMTD, mNumeric.ui64); break;
+                case NUMERIC_DOUBLE: snprintf(mText, sizeof(mText), "%.15g", mNumeric.d); break;
+                default:             return;
+            }
+            mValue = mText;
+        }
+
+        mutable const char* mValue; /**< text of the value, NULL for NULL or not yet formatted native values */
         enum DataTypes mType; /**< TODO */
+        NumericType mNumericType; /**< kind of mNumeric */
+        NumericValue mNumeric; /**< native value */
+        mutable char mText[32]; /**< text of mNumeric once requested */
 };
 #endif
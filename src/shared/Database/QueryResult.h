@@ -28,12 +28,13 @@
 #include "Common.h"
 #include "Errors.h"
 #include "Field.h"
+#include "MemoryTracker.h"
 
 /**
  * @brief
  *
  */
-class MANGOS_DLL_SPEC QueryResult
+class MANGOS_DLL_SPEC QueryResult : public MemoryTracked<MEM_TAG_QUERYRESULT>
 {
     public:
         /**
@@ -74,7 +74,7 @@ void QueryResultMysql::EndQuery()
     }
 }
 
-enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType) const
+enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType)
 {
     switch (mysqlType)
     {
@@ -104,4 +104,82 @@ enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysql
             return Field::DB_TYPE_UNKNOWN;
     }
 }
+
+QueryResultMysqlStmt::QueryResultMysqlStmt(MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount) :
+    QueryResult(rowCount, fieldCount), mColumns(fieldCount), mNextRow(0)
+{
+    mCurrentRow = new Field[mFieldCount];
+    MANGOS_ASSERT(mCurrentRow);
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        mCurrentRow[i].SetType(QueryResultMysql::ConvertNativeType(fields[i].type));
+
+        Column& column = mColumns[i];
+        column.type = GetNumericType(fields[i]);
+        if (column.type != Field::NUMERIC_NONE)
+            { column.numbers.reserve(size_t(rowCount)); }
+        else
+            { column.texts.reserve(size_t(rowCount)); }
+        column.nulls.reserve(size_t(rowCount));
+    }
+}
+
+QueryResultMysqlStmt::~QueryResultMysqlStmt()
+{
+    delete[] mCurrentRow;
+}
+
+Field::NumericType QueryResultMysqlStmt::GetNumericType(MYSQL_FIELD const& field)
+{
+    switch (field.type)
+    {
+        case FIELD_TYPE_TINY:
+        case FIELD_TYPE_SHORT:
+        case FIELD_TYPE_LONG:
+        case FIELD_TYPE_INT24:
+        case FIELD_TYPE_LONGLONG:
+        case FIELD_TYPE_YEAR:
+            return (field.flags & UNSIGNED_FLAG) ? Field::NUMERIC_UINT : Field::NUMERIC_INT;
+        case FIELD_TYPE_FLOAT:
+        case FIELD_TYPE_DOUBLE:
+            return Field::NUMERIC_DOUBLE;
+        default:                                            // decimals, dates and strings keep the text form
+            return Field::NUMERIC_NONE;
+    }
+}
+
+void QueryResultMysqlStmt::AddValue(uint32 column, const char* value, unsigned long length)
+{
+    Column& col = mColumns[column];
+    col.texts.push_back(value ? std::string(value, length) : std::string());
+    col.nulls.push_back(value == NULL);
+}
+
+void QueryResultMysqlStmt::AddNumeric(uint32 column, Field::NumericValue value, bool isNull)
+{
+    Column& col = mColumns[column];
+    col.numbers.push_back(value);
+    col.nulls.push_back(isNull);
+}
+
+bool QueryResultMysqlStmt::NextRow()
+{
+    if (mColumns.empty() || mNextRow >= mColumns[0].nulls.size())
+        { return false; }
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column const& col = mColumns[i];
+        if (col.nulls[mNextRow])
+            { mCurrentRow[i].SetValue(NULL); }
+        else if (col.type != Field::NUMERIC_NONE)
+            { mCurrentRow[i].SetNumeric(col.type, col.numbers[mNextRow]); }
+        else
+            { mCurrentRow[i].SetValue(col.texts[mNextRow].c_str()); }
+    }
+
+    ++mNextRow;
+    return true;
+}
 #endif
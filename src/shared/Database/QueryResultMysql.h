@@ -66,14 +66,15 @@ class QueryResultMysql : public QueryResult
          */
         bool NextRow() override;
 
-    private:
         /**
          * @brief
          *
          * @param mysqlType
          * @return Field::DataTypes
          */
-        enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType) const;
+        static enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType);
+
+    private:
         /**
          * @brief
          *
@@ -82,5 +83,75 @@ class QueryResultMysql : public QueryResult
 
         MYSQL_RES* mResult; /**< TODO */
 };
+
+/**
+ * @brief result of a prepared query, holds copies of all rows as the statement is reused
+ *
+ * Numeric columns are received in binary form and kept as native values column by column,
+ * Field builds their text only when it is requested.
+ *
+ */
+class QueryResultMysqlStmt : public QueryResult
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param fields
+         * @param rowCount
+         * @param fieldCount
+         */
+        QueryResultMysqlStmt(MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount);
+
+        /**
+         * @brief
+         *
+         */
+        ~QueryResultMysqlStmt();
+
+        /**
+         * @brief
+         *
+         * @return bool
+         */
+        bool NextRow() override;
+
+        /**
+         * @brief native type a column is fetched as, NUMERIC_NONE for columns fetched as text
+         *
+         * @param field
+         * @return Field::NumericType
+         */
+        static Field::NumericType GetNumericType(MYSQL_FIELD const& field);
+
+        /**
+         * @brief appends the next value of a text column
+         *
+         * @param column
+         * @param value NULL for NULL values
+         * @param length
+         */
+        void AddValue(uint32 column, const char* value, unsigned long length);
+        /**
+         * @brief appends the next value of a numeric column
+         *
+         * @param column
+         * @param value
+         * @param isNull
+         */
+        void AddNumeric(uint32 column, Field::NumericValue value, bool isNull);
+
+    private:
+        struct Column
+        {
+            Field::NumericType type;
+            std::vector<Field::NumericValue> numbers;       // values of numeric columns
+            std::vector<std::string> texts;                 // values of text columns
+            std::vector<bool> nulls;
+        };
+
+        std::vector<Column> mColumns;
+        size_t mNextRow;
+};
 #endif
 #endif
@@ -27,7 +27,18 @@
 #include "DatabaseEnv.h"
 
 QueryResultPostgre::QueryResultPostgre(PGresult* result, uint64 rowCount, uint32 fieldCount) :
-    QueryResult(rowCount, fieldCount), mResult(result),  mTableIndex(0)
+    QueryResult(rowCount, fieldCount), mResult(result), mConn(NULL), mTableIndex(0)
+{
+
+    mCurrentRow = new Field[mFieldCount];
+    MANGOS_ASSERT(mCurrentRow);
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+        { mCurrentRow[i].SetType(ConvertNativeType(PQftype(result, i))); }
+}
+
+QueryResultPostgre::QueryResultPostgre(PGconn* conn, PGresult* result, uint32 fieldCount) :
+    QueryResult(0, fieldCount), mResult(result), mConn(conn), mTableIndex(0)
 {
 
     mCurrentRow = new Field[mFieldCount];
@@ -47,10 +58,24 @@ bool QueryResultPostgre::NextRow()
     if (!mResult)
         { return false; }
 
-    if (mTableIndex >= mRowCount)
+    if (mTableIndex >= uint32(PQntuples(mResult)))
     {
-        EndQuery();
-        return false;
+        if (!mConn)
+        {
+            EndQuery();
+            return false;
+        }
+
+        // next row of a streamed result, the last result has no rows
+        PQclear(mResult);
+        mResult = PQgetResult(mConn);
+        mTableIndex = 0;
+
+        if (!mResult || PQresultStatus(mResult) != PGRES_SINGLE_TUPLE)
+        {
+            EndQuery();
+            return false;
+        }
     }
 
     char* pPQgetvalue;
@@ -77,6 +102,14 @@ void QueryResultPostgre::EndQuery()
         PQclear(mResult);
         mResult = 0;
     }
+
+    // the connection is usable again only after all results are read
+    if (mConn)
+    {
+        while (PGresult* result = PQgetResult(mConn))
+            { PQclear(result); }
+        mConn = NULL;
+    }
 }
 
 // see types in #include <postgre/pg_type.h>
@@ -81,6 +81,8 @@ class QueryResultPostgre : public QueryResult
 {
     public:
         QueryResultPostgre(PGresult* result, uint64 rowCount, uint32 fieldCount);
+        // streamed result, the further rows are read from conn in single row mode
+        QueryResultPostgre(PGconn* conn, PGresult* result, uint32 fieldCount);
 
         ~QueryResultPostgre();
 
@@ -91,6 +93,7 @@ class QueryResultPostgre : public QueryResult
         void EndQuery() override;
 
         PGresult* mResult;
+        PGconn* mConn;                                      // NULL for buffered results
         uint32 mTableIndex;
 };
 #endif
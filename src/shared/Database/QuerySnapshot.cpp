@@ -0,0 +1,342 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "Database/QuerySnapshot.h"
+#include "Log.h"
+
+#include <ace/OS_NS_stdio.h>
+#include <ace/OS_NS_unistd.h>
+
+/// Tag in front of every field value of a row
+enum SnapshotValueTag
+{
+    SNAPSHOT_NULL   = 0,
+    SNAPSHOT_INT    = 1,                                    // int64
+    SNAPSHOT_UINT   = 2,                                    // uint64
+    SNAPSHOT_DOUBLE = 3,                                    // double
+    SNAPSHOT_STRING = 4                                     // uint32 length, the bytes and a 0
+};
+
+uint64 const QuerySnapshotHeader::INITIAL_HASH = UI64LIT(0xCBF29CE484222325);
+
+uint64 QuerySnapshotHeader::Hash(void const* data, size_t size, uint64 hash)
+{
+    uint8 const* bytes = static_cast<uint8 const*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= UI64LIT(0x100000001B3);
+    }
+
+    return hash;
+}
+
+// -----------------------------------  QueryResultSnapshot  ----------------------------------- //
+
+QueryResultSnapshot::QueryResultSnapshot(uint64 rowCount, uint32 fieldCount) :
+    QueryResult(rowCount, fieldCount), m_pos(NULL), m_end(NULL), m_rowsLeft(rowCount)
+{
+    mCurrentRow = new Field[fieldCount];
+}
+
+QueryResultSnapshot::~QueryResultSnapshot()
+{
+    delete[] mCurrentRow;
+    m_map.close();
+}
+
+QueryResult* QueryResultSnapshot::Open(std::string const& fileName, uint64 contentHash)
+{
+    if (ACE_OS::access(fileName.c_str(), R_OK) != 0)
+        { return NULL; }
+
+    // check the header before mapping the whole file
+    QuerySnapshotHeader header;
+    FILE* file = ACE_OS::fopen(fileName.c_str(), "rb");
+    if (!file)
+        { return NULL; }
+
+    bool headerRead = fread(&header, sizeof(header), 1, file) == 1;
+    fclose(file);
+
+    if (!headerRead || header.magic != QuerySnapshotHeader::MAGIC || header.version != QuerySnapshotHeader::VERSION ||
+        header.byteOrder != QuerySnapshotHeader::BYTE_ORDER_MARK)
+    {
+        sLog.outError("Snapshot %s has an unknown format, reading from the database", fileName.c_str());
+        return NULL;
+    }
+
+    if (header.contentHash != contentHash)
+        { return NULL; }                                    // tables changed since the snapshot was written
+
+    if (!header.rowCount || !header.fieldCount)
+        { return NULL; }
+
+    QueryResultSnapshot* result = new QueryResultSnapshot(header.rowCount, header.fieldCount);
+    if (result->m_map.map(fileName.c_str(), static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) == -1 ||
+        result->m_map.size() != sizeof(header) + header.payloadSize)
+    {
+        sLog.outError("Snapshot %s can't be mapped or has a wrong size, reading from the database", fileName.c_str());
+        delete result;
+        return NULL;
+    }
+
+    char const* payload = static_cast<char const*>(result->m_map.addr()) + sizeof(header);
+    if (QuerySnapshotHeader::Hash(payload, size_t(header.payloadSize), QuerySnapshotHeader::INITIAL_HASH) != header.payloadHash)
+    {
+        sLog.outError("Snapshot %s is damaged, reading from the database", fileName.c_str());
+        delete result;
+        return NULL;
+    }
+
+    for (uint32 i = 0; i < header.fieldCount; ++i)
+        { result->mCurrentRow[i].SetType(Field::DataTypes(uint8(payload[i]))); }
+
+    result->m_pos = payload + header.fieldCount;
+    result->m_end = payload + header.payloadSize;
+
+    if (!result->ReadRow())
+    {
+        sLog.outError("Snapshot %s is damaged, reading from the database", fileName.c_str());
+        delete result;
+        return NULL;
+    }
+
+    return result;
+}
+
+bool QueryResultSnapshot::NextRow()
+{
+    if (!m_rowsLeft)
+        { return false; }
+
+    if (!ReadRow())
+    {
+        // the payload hash matched, so only a snapshot writer bug gets here
+        sLog.outError("Snapshot row can't be read, the rest of the rows is skipped");
+        m_rowsLeft = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool QueryResultSnapshot::ReadRow()
+{
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        if (m_pos >= m_end)
+            { return false; }
+
+        Field& field = mCurrentRow[i];
+        Field::NumericValue value;
+        uint8 tag = uint8(*m_pos++);
+
+        switch (tag)
+        {
+            case SNAPSHOT_NULL:
+                field.SetValue(NULL);
+                break;
+            case SNAPSHOT_INT:
+            case SNAPSHOT_UINT:
+            case SNAPSHOT_DOUBLE:
+            {
+                if (m_end - m_pos < ptrdiff_t(sizeof(value)))
+                    { return false; }
+
+                // all value kinds have 8 bytes, the tag selects the union member
+                memcpy(&value, m_pos, sizeof(value));
+                m_pos += sizeof(value);
+
+                field.SetNumeric(tag == SNAPSHOT_INT ? Field::NUMERIC_INT : (tag == SNAPSHOT_UINT ? Field::NUMERIC_UINT : Field::NUMERIC_DOUBLE), value);
+                break;
+            }
+            case SNAPSHOT_STRING:
+            {
+                uint32 length;
+                if (m_end - m_pos < ptrdiff_t(sizeof(length)))
+                    { return false; }
+
+                memcpy(&length, m_pos, sizeof(length));
+                m_pos += sizeof(length);
+
+                if (m_end - m_pos < ptrdiff_t(length) + 1)
+                    { return false; }
+
+                field.SetValue(m_pos);                      // 0 terminated in the mapping
+                m_pos += length + 1;
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    --m_rowsLeft;
+    return true;
+}
+
+// --------------------------------  QueryResultSnapshotWriter  -------------------------------- //
+
+QueryResultSnapshotWriter::QueryResultSnapshotWriter(QueryResult* result, std::string const& fileName, uint64 contentHash) :
+    QueryResult(result->GetRowCount(), result->GetFieldCount()), m_result(result), m_fileName(fileName),
+    m_tempFileName(fileName + ".tmp"), m_file(NULL)
+{
+    mCurrentRow = m_result->Fetch();
+
+    memset(&m_header, 0, sizeof(m_header));
+    m_header.magic = QuerySnapshotHeader::MAGIC;
+    m_header.version = QuerySnapshotHeader::VERSION;
+    m_header.byteOrder = QuerySnapshotHeader::BYTE_ORDER_MARK;
+    m_header.fieldCount = mFieldCount;
+    m_header.contentHash = contentHash;
+    m_header.payloadHash = QuerySnapshotHeader::INITIAL_HASH;
+
+    m_file = ACE_OS::fopen(m_tempFileName.c_str(), "wb");
+    if (!m_file)
+    {
+        sLog.outError("Snapshot %s can't be created, check SnapshotDir", m_tempFileName.c_str());
+        return;
+    }
+
+    // the header is written again with the sizes and hash at the end
+    fwrite(&m_header, sizeof(m_header), 1, m_file);
+
+    m_row.clear();
+    for (uint32 i = 0; i < mFieldCount; ++i)
+        { m_row += char(mCurrentRow[i].GetType()); }
+
+    WriteRow();
+}
+
+QueryResultSnapshotWriter::~QueryResultSnapshotWriter()
+{
+    // not read to the end, the snapshot would miss rows
+    if (m_file)
+    {
+        fclose(m_file);
+        ACE_OS::unlink(m_tempFileName.c_str());
+    }
+
+    delete m_result;
+}
+
+bool QueryResultSnapshotWriter::NextRow()
+{
+    bool res = m_result->NextRow();
+    mCurrentRow = m_result->Fetch();
+
+    if (res)
+        { WriteRow(); }
+    else
+        { Finish(); }
+
+    return res;
+}
+
+void QueryResultSnapshotWriter::WriteRow()
+{
+    if (!m_file)
+        { return; }
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Field const& field = mCurrentRow[i];
+        Field::NumericValue value;
+
+        if (field.IsNULL())
+        {
+            m_row += char(SNAPSHOT_NULL);
+            continue;
+        }
+
+        switch (field.GetType())
+        {
+            case Field::DB_TYPE_INTEGER:
+            case Field::DB_TYPE_BOOL:
+            {
+                char const* text = field.GetString();
+                if (text && *text == '-')
+                {
+                    m_row += char(SNAPSHOT_INT);
+                    value.i64 = field.GetInt64();
+                }
+                else
+                {
+                    m_row += char(SNAPSHOT_UINT);
+                    value.ui64 = field.GetUInt64();
+                }
+
+                m_row.append(reinterpret_cast<char const*>(&value), sizeof(value));
+                break;
+            }
+            case Field::DB_TYPE_FLOAT:
+                m_row += char(SNAPSHOT_DOUBLE);
+                value.d = field.GetDouble();
+                m_row.append(reinterpret_cast<char const*>(&value), sizeof(value));
+                break;
+            default:
+            {
+                char const* text = field.GetString();
+                uint32 length = uint32(strlen(text));
+                m_row += char(SNAPSHOT_STRING);
+                m_row.append(reinterpret_cast<char const*>(&length), sizeof(length));
+                m_row.append(text, length + 1);
+                break;
+            }
+        }
+    }
+
+    m_header.payloadHash = QuerySnapshotHeader::Hash(m_row.data(), m_row.size(), m_header.payloadHash);
+    m_header.payloadSize += m_row.size();
+    ++m_header.rowCount;
+
+    if (fwrite(m_row.data(), m_row.size(), 1, m_file) != 1)
+    {
+        sLog.outError("Snapshot %s can't be written, no snapshot of this query", m_tempFileName.c_str());
+        fclose(m_file);
+        m_file = NULL;
+        ACE_OS::unlink(m_tempFileName.c_str());
+    }
+
+    m_row.clear();
+}
+
+void QueryResultSnapshotWriter::Finish()
+{
+    if (!m_file)
+        { return; }
+
+    bool ok = fseek(m_file, 0, SEEK_SET) == 0 && fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+    ok = fclose(m_file) == 0 && ok;
+    m_file = NULL;
+
+    // replace an outdated snapshot only by a complete one
+    ACE_OS::unlink(m_fileName.c_str());
+    if (!ok || ACE_OS::rename(m_tempFileName.c_str(), m_fileName.c_str()) != 0)
+    {
+        sLog.outError("Snapshot %s can't be written, no snapshot of this query", m_fileName.c_str());
+        ACE_OS::unlink(m_tempFileName.c_str());
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_QUERYSNAPSHOT
+#define MANGOS_H_QUERYSNAPSHOT
+
+#include "Common.h"
+#include "Database/QueryResult.h"
+
+#include <ace/Mem_Map.h>
+
+#include <cstdio>
+
+/**
+ * @brief binary snapshot file of one query result, see Database::QueryWithSnapshot
+ *
+ * The file holds a header with the content hash of the tables the query read, then the column
+ * types and the rows with numbers in binary form and strings as they are. It is mapped into memory
+ * at reading, the string fields point into the mapping, so rows are neither copied nor parsed.
+ */
+struct QuerySnapshotHeader
+{
+    static uint32 const MAGIC = 0x50414E53;                 // "SNAP"
+    static uint32 const VERSION = 1;
+    static uint32 const BYTE_ORDER_MARK = 0x01020304;       // a snapshot of another byte order is not read
+
+    uint32 magic;
+    uint32 version;
+    uint32 byteOrder;
+    uint32 fieldCount;
+    uint64 contentHash;
+    uint64 rowCount;
+    uint64 payloadSize;                                     // bytes after the header: column types and rows
+    uint64 payloadHash;
+
+    /**
+     * @brief FNV-1a hash, also used for the content hash of the tables
+     *
+     * @param data
+     * @param size
+     * @param hash hash of the data before, INITIAL_HASH at start
+     * @return uint64
+     */
+    static uint64 Hash(void const* data, size_t size, uint64 hash);
+
+    static uint64 const INITIAL_HASH;
+};
+
+/**
+ * @brief query result read from a snapshot file
+ *
+ */
+class QueryResultSnapshot : public QueryResult
+{
+    public:
+        /**
+         * @brief maps the snapshot file
+         *
+         * @param fileName
+         * @param contentHash expected hash of the tables
+         * @return QueryResult NULL if the file is missing, damaged or of other content
+         */
+        static QueryResult* Open(std::string const& fileName, uint64 contentHash);
+
+        ~QueryResultSnapshot();
+
+        bool NextRow() override;
+
+    private:
+        QueryResultSnapshot(uint64 rowCount, uint32 fieldCount);
+
+        bool ReadRow();
+
+        ACE_Mem_Map m_map;
+        char const* m_pos;                                  // next row
+        char const* m_end;
+        uint64 m_rowsLeft;
+};
+
+/**
+ * @brief passes the rows of a query result through and writes them to a snapshot file meanwhile
+ *
+ * The file is written under a temporary name and renamed when the last row was fetched,
+ * a result not read to its end leaves no snapshot.
+ */
+class QueryResultSnapshotWriter : public QueryResult
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param result the query result, owned by the writer
+         * @param fileName
+         * @param contentHash hash of the tables the query read
+         */
+        QueryResultSnapshotWriter(QueryResult* result, std::string const& fileName, uint64 contentHash);
+        ~QueryResultSnapshotWriter();
+
+        bool NextRow() override;
+
+    private:
+        void WriteRow();
+        void Finish();
+
+        QueryResult* m_result;
+        std::string m_fileName;
+        std::string m_tempFileName;
+        FILE* m_file;
+        QuerySnapshotHeader m_header;
+        std::string m_row;                                  // buffer of the row being written
+};
+
+#endif
@@ -36,9 +36,47 @@ SQLStorageBase::SQLStorageBase() :
     m_recordCount(0),
     m_maxEntry(0),
     m_recordSize(0),
-    m_data(NULL)
+    m_data(NULL),
+    m_reloadChecksum(0),
+    m_trackedMemory(0)
 {}
 
+/**
+ * @brief size of a field in the records
+ *
+ * @param format destination format of the field
+ * @return uint32
+ */
+static uint32 GetRecordFieldSize(char format)
+{
+    switch (format)
+    {
+        case DBC_FF_LOGIC:
+            return sizeof(bool);
+        case DBC_FF_STRING:
+        case DBC_FF_NA_POINTER:
+            return sizeof(char*);
+        case DBC_FF_NA:
+        case DBC_FF_INT:
+            return sizeof(uint32);
+        case DBC_FF_BYTE:
+        case DBC_FF_NA_BYTE:
+            return sizeof(char);
+        case DBC_FF_FLOAT:
+        case DBC_FF_NA_FLOAT:
+            return sizeof(float);
+        case DBC_FF_IND:
+        case DBC_FF_SORT:
+            assert(false && "SQL storage not have sort field types");
+            break;
+        default:
+            assert(false && "unknown format character");
+            break;
+    }
+
+    return 0;
+}
+
 void SQLStorageBase::Initialize(const char* tableName, const char* entry_field, const char* src_format, const char* dst_format)
 {
     m_tableName = tableName;
@@ -67,62 +105,95 @@ void SQLStorageBase::prepareToLoad(uint32 maxEntry, uint32 recordCount, uint32 r
     delete[] m_data;
     m_data = new char[recordCount * m_recordSize];
     memset(m_data, 0, recordCount * m_recordSize);
+    TrackMemory(recordCount * m_recordSize);
 
     m_recordCount = 0;
+    m_reloadChecksum = 0;
 }
 
-// Function to delete the data
-void SQLStorageBase::Free()
+void SQLStorageBase::prepareToReload(uint32 maxRecordId)
 {
-    if (!m_data)
-        { return; }
+    if (maxRecordId > m_maxEntry)
+        { m_maxEntry = maxRecordId; }
+}
 
+bool SQLStorageBase::IsSameRecord(char const* left, char const* right) const
+{
     uint32 offset = 0;
     for (uint32 x = 0; x < m_dstFieldCount; ++x)
     {
+        uint32 size = GetRecordFieldSize(m_dst_format[x]);
         switch (m_dst_format[x])
         {
-            case DBC_FF_LOGIC:
-                offset += sizeof(bool);
-                break;
             case DBC_FF_STRING:
-            {
-                for (uint32 recordItr = 0; recordItr < m_recordCount; ++recordItr)
-                    { delete[] *(char**)((char*)(m_data + (recordItr * m_recordSize)) + offset); }
-
-                offset += sizeof(char*);
+                if (strcmp(*(char* const*)(left + offset), *(char* const*)(right + offset)) != 0)
+                    { return false; }
                 break;
-            }
             case DBC_FF_NA:
-            case DBC_FF_INT:
-                offset += sizeof(uint32);
-                break;
-            case DBC_FF_BYTE:
             case DBC_FF_NA_BYTE:
-                offset += sizeof(char);
-                break;
-            case DBC_FF_FLOAT:
             case DBC_FF_NA_FLOAT:
-                offset += sizeof(float);
-                break;
             case DBC_FF_NA_POINTER:
-                // TODO- possible (and small) memleak here possible
-                offset += sizeof(char*);
-                break;
-            case DBC_FF_IND:
-            case DBC_FF_SORT:
-                assert(false && "SQL storage not have sort field types");
+                // not read from the table, may be set after loading
                 break;
             default:
-                assert(false && "unknown format character");
+                if (memcmp(left + offset, right + offset, size) != 0)
+                    { return false; }
                 break;
         }
+
+        offset += size;
+    }
+
+    return true;
+}
+
+void SQLStorageBase::FreeRecordStrings(char* record) const
+{
+    uint32 offset = 0;
+    for (uint32 x = 0; x < m_dstFieldCount; ++x)
+    {
+        // DBC_FF_NA_POINTER - TODO- possible (and small) memleak here possible
+        if (m_dst_format[x] == DBC_FF_STRING)
+            { delete[] *(char**)(record + offset); }
+
+        offset += GetRecordFieldSize(m_dst_format[x]);
+    }
+}
+
+// Function to delete the data
+void SQLStorageBase::Free()
+{
+    for (std::vector<char*>::const_iterator itr = m_reloadedRecords.begin(); itr != m_reloadedRecords.end(); ++itr)
+    {
+        FreeRecordStrings(*itr);
+        delete[] *itr;
     }
+    m_reloadedRecords.clear();
+
+    if (m_trackedMemory)
+    {
+        MemoryTracker::Free(MEM_TAG_SQLSTORAGE, m_trackedMemory);
+        m_trackedMemory = 0;
+    }
+
+    if (!m_data)
+        { return; }
+
+    for (uint32 recordItr = 0; recordItr < m_recordCount; ++recordItr)
+        { FreeRecordStrings(m_data + recordItr * m_recordSize); }
+
     delete[] m_data;
     m_data = NULL;
     m_recordCount = 0;
 }
 
+void SQLStorageBase::TrackMemory(size_t bytes)
+{
+    // a loaded storage is counted as one allocation
+    MemoryTracker::Allocate(MEM_TAG_SQLSTORAGE, bytes, m_trackedMemory ? 0 : 1);
+    m_trackedMemory += bytes;
+}
+
 // -----------------------------------  SQLStorage  -------------------------------------------- //
 
 void SQLStorage::EraseEntry(uint32 id)
@@ -135,6 +206,10 @@ void SQLStorage::Free()
     SQLStorageBase::Free();
     delete[] m_Index;
     m_Index = NULL;
+
+    for (std::vector<char**>::const_iterator itr = m_retiredIndexes.begin(); itr != m_retiredIndexes.end(); ++itr)
+        { delete[] *itr; }
+    m_retiredIndexes.clear();
 }
 
 void SQLStorage::Load(bool error_at_empty /*= true*/)
@@ -143,6 +218,12 @@ void SQLStorage::Load(bool error_at_empty /*= true*/)
     loader.Load(*this, error_at_empty);
 }
 
+bool SQLStorage::Reload(std::vector<uint32>& changedIds)
+{
+    SQLStorageLoader loader;
+    return loader.Reload(*this, changedIds);
+}
+
 SQLStorage::SQLStorage(const char* fmt, const char* _entry_field, const char* sqlname)
 {
     Initialize(sqlname, _entry_field, fmt, fmt);
@@ -163,10 +244,29 @@ void SQLStorage::prepareToLoad(uint32 maxRecordId, uint32 recordCount, uint32 re
     // Set index array
     m_Index = new char*[maxRecordId];
     memset(m_Index, 0, maxRecordId * sizeof(char*));
+    TrackMemory(maxRecordId * sizeof(char*));
 
     SQLStorageBase::prepareToLoad(maxRecordId, recordCount, recordSize);
 }
 
+void SQLStorage::prepareToReload(uint32 maxRecordId)
+{
+    uint32 oldMaxEntry = GetMaxEntry();
+    if (maxRecordId > oldMaxEntry)
+    {
+        // a lookup may still run with the old array, it is freed with the storage
+        char** index = new char*[maxRecordId];
+        memcpy(index, m_Index, oldMaxEntry * sizeof(char*));
+        memset(index + oldMaxEntry, 0, (maxRecordId - oldMaxEntry) * sizeof(char*));
+
+        m_retiredIndexes.push_back(m_Index);
+        m_Index = index;
+        TrackMemory(maxRecordId * sizeof(char*));
+    }
+
+    SQLStorageBase::prepareToReload(maxRecordId);
+}
+
 // -----------------------------------  SQLHashStorage  ---------------------------------------- //
 void SQLHashStorage::Load()
 {
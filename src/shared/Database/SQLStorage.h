@@ -215,6 +215,12 @@ class SQLStorageBase
          * @param recordSize
          */
         virtual void prepareToLoad(uint32 maxRecordId, uint32 recordCount, uint32 recordSize);
+        /**
+         * @brief makes room for the entries up to maxRecordId before a reload publishes records
+         *
+         * @param maxRecordId
+         */
+        virtual void prepareToReload(uint32 maxRecordId);
         /**
          * @brief
          *
@@ -222,11 +228,32 @@ class SQLStorageBase
          * @param record
          */
         virtual void JustCreatedRecord(uint32 recordId, char* record) = 0;
+
+        /**
+         * @brief compares the fields of two records read from the table, strings by content
+         *
+         * @param left
+         * @param right
+         * @return bool
+         */
+        bool IsSameRecord(char const* left, char const* right) const;
+        /**
+         * @brief deletes the strings owned by a record
+         *
+         * @param record
+         */
+        void FreeRecordStrings(char* record) const;
         /**
          * @brief
          *
          */
         virtual void Free();
+        /**
+         * @brief counts memory of the storage for MemoryTracker, all of it is released by Free
+         *
+         * @param bytes
+         */
+        void TrackMemory(size_t bytes);
 
     private:
         /**
@@ -252,6 +279,10 @@ class SQLStorageBase
 
         // Data Storage
         char* m_data; /**< TODO */
+
+        std::vector<char*> m_reloadedRecords;               // records published by reloads, owned
+        uint64 m_reloadChecksum;                            // table checksum at the last reload, 0 for unknown
+        size_t m_trackedMemory;                             // records and indexes, see TrackMemory
 };
 
 /**
@@ -302,6 +333,38 @@ class SQLStorage : public SQLStorageBase
             return reinterpret_cast<T const*>(m_Index[id]);
         }
 
+        /**
+         * @brief collects the entries of all records, ascending
+         *
+         * @param entries
+         */
+        void GetEntries(std::vector<uint32>& entries) const
+        {
+            entries.clear();
+            entries.reserve(GetRecordCount());
+            for (uint32 id = 0; id < GetMaxEntry(); ++id)
+                if (m_Index[id])
+                    { entries.push_back(id); }
+        }
+
+        template<class T, class V>
+        /**
+         * @brief copies one field of the records of entries into a column
+         *
+         * Scans that test few fields of many records read the compact column
+         * instead of touching every record.
+         *
+         * @param entries as returned by GetEntries
+         * @param field
+         * @param column receives the value of entries[i] at i
+         */
+        void FillColumn(std::vector<uint32> const& entries, V T::* field, std::vector<V>& column) const
+        {
+            column.resize(entries.size());
+            for (size_t i = 0; i < entries.size(); ++i)
+                { column[i] = LookupEntry<T>(entries[i])->*field; }
+        }
+
         /**
          * @brief
          *
@@ -309,6 +372,14 @@ class SQLStorage : public SQLStorageBase
          */
         void Load(bool error_at_empty = true);
 
+        /**
+         * @brief reads the table again and publishes the changed rows, see SQLStorageLoaderBase::Reload
+         *
+         * @param changedIds receives the entries of the changed and added records
+         * @return bool false if the table can't be read
+         */
+        bool Reload(std::vector<uint32>& changedIds);
+
         /**
          * @brief
          *
@@ -325,6 +396,12 @@ class SQLStorage : public SQLStorageBase
          * @param recordSize
          */
         void prepareToLoad(uint32 maxRecordId, uint32 recordCount, uint32 recordSize) override;
+        /**
+         * @brief
+         *
+         * @param maxRecordId
+         */
+        void prepareToReload(uint32 maxRecordId) override;
         /**
          * @brief
          *
@@ -344,6 +421,7 @@ class SQLStorage : public SQLStorageBase
 
     private:
         char** m_Index; /**< Lookup access */
+        std::vector<char**> m_retiredIndexes;               // index arrays replaced by a larger one at reload
 };
 
 /**
@@ -644,6 +722,20 @@ class SQLStorageLoaderBase
          */
         void Load(StorageClass& storage, bool error_at_empty = true);
 
+        /**
+         * @brief reads the table of a loaded storage again and publishes only the rows that changed
+         *
+         * The checksum of the table is compared with the one of the last reload first, an unchanged
+         * table is not read at all. Changed and new rows are converted into new records that replace
+         * the old ones in the lookup (copy on write), records still referenced stay valid until the
+         * storage is freed. Rows deleted from the table are kept.
+         *
+         * @param storage
+         * @param changedIds receives the entries of the changed and added records
+         * @return bool false if the table can't be read, the storage is unchanged then
+         */
+        bool Reload(StorageClass& storage, std::vector<uint32>& changedIds);
+
         template<class S, class D>
         /**
          * @brief
@@ -716,38 +808,65 @@ class SQLStorageLoaderBase
         void convert_str_to_str(uint32 field_pos, char* src, char*& dst);
 
     private:
-        template<class V>
         /**
-         * @brief
+         * @brief converts one column of a row into a field of a record
+         *
+         * One instance exists for every pair of source and destination type,
+         * the conversion code is compiled into it.
+         */
+        typedef void (*StoreFunction)(DerivedLoader& loader, uint32 field_pos, Field const* field, char* dst);
+
+        /**
+         * @brief how one field of the records is filled
+         *
+         */
+        struct FieldPlan
+        {
+            StoreFunction store;
+            uint32 fieldPos;                                // index in the destination format
+            uint32 srcIndex;                                // column of the row, 0 for default filled fields
+            uint32 offset;                                  // in the record
+        };
+        typedef std::vector<FieldPlan> RecordPlan;
+
+        /**
+         * @brief selects the conversions of all fields from the formats of the storage
          *
-         * @param value
          * @param store
-         * @param record
-         * @param field_pos
-         * @param offset
+         * @param plan
          */
-        void storeValue(V value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
+        static void BuildPlan(StorageClass& store, RecordPlan& plan);
         /**
          * @brief
          *
-         * @param value
-         * @param store
-         * @param record
-         * @param field_pos
-         * @param offset
+         * @param dstFormat
+         * @return StoreFunction
          */
-        void storeValue(char const* value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
+        template<class S>
+        static StoreFunction GetStoreFunction(char dstFormat);
+
+        template<class S, class D>
+        static void storeField(DerivedLoader& loader, uint32 field_pos, Field const* field, char* dst);
+        template<class D>
+        static void storeDefault(DerivedLoader& loader, uint32 field_pos, Field const* field, char* dst);
+        static void storeDefaultString(DerivedLoader& loader, uint32 field_pos, Field const* field, char* dst);
 
         /**
-         * @brief trap, no body
+         * @brief converts the fields of a row into a record
          *
-         * @param value
-         * @param store
+         * @param plan
+         * @param fields
          * @param record
-         * @param field_pos
-         * @param offset
          */
-        void storeValue(char* value, StorageClass& store, char* record, uint32 field_pos, uint32& offset);
+        void storeRecord(RecordPlan const& plan, Field* fields, char* record);
+
+        template<class S, class D>
+        void storeConverted(uint32 field_pos, S src, D& dst);
+        template<class S>
+        void storeConverted(uint32 field_pos, S src, char*& dst);
+        template<class D>
+        void storeConverted(uint32 field_pos, char const* src, D& dst);
+        void storeConverted(uint32 field_pos, char const* src, char*& dst);
 };
 
 /**
@@ -124,53 +124,135 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::default_fill_to_str(uint
 }
 
 template<class DerivedLoader, class StorageClass>
-template<class V>
+template<class S, class D>
 /**
- * @brief V value-type
+ * @brief S source-type, D destination-type
  *
+ * @param x
+ * @param src
+ * @param dst
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeConverted(uint32 x, S src, D& dst)
+{
+    static_cast<DerivedLoader*>(this)->convert(x, src, dst);
+}
+
+template<class DerivedLoader, class StorageClass>
+template<class S>
+/**
+ * @brief S source-type
+ *
+ * @param x
+ * @param src
+ * @param dst
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeConverted(uint32 x, S src, char*& dst)
+{
+    static_cast<DerivedLoader*>(this)->convert_to_str(x, src, dst);
+}
+
+template<class DerivedLoader, class StorageClass>
+template<class D>
+/**
+ * @brief D destination-type
+ *
+ * @param x
+ * @param src
+ * @param dst
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeConverted(uint32 x, char const* src, D& dst)
+{
+    static_cast<DerivedLoader*>(this)->convert_from_str(x, src, dst);
+}
+
+template<class DerivedLoader, class StorageClass>
+/**
+ * @brief
+ *
+ * @param x
+ * @param src
+ * @param dst
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeConverted(uint32 x, char const* src, char*& dst)
+{
+    static_cast<DerivedLoader*>(this)->convert_str_to_str(x, src, dst);
+}
+
+/**
+ * @brief reads a column of a row as the source type of its format
+ *
+ * @param field
  * @param value
- * @param store
- * @param p
+ */
+inline void ReadSQLStorageField(Field const* field, bool& value) { value = field->GetUInt32() > 0; }
+inline void ReadSQLStorageField(Field const* field, char& value) { value = char(field->GetUInt8()); }
+inline void ReadSQLStorageField(Field const* field, uint32& value) { value = field->GetUInt32(); }
+inline void ReadSQLStorageField(Field const* field, float& value) { value = field->GetFloat(); }
+inline void ReadSQLStorageField(Field const* field, char const*& value) { value = field->GetString(); }
+
+template<class DerivedLoader, class StorageClass>
+template<class S, class D>
+/**
+ * @brief S source-type, D destination-type
+ *
+ * @param loader
  * @param x
- * @param offset
+ * @param field
+ * @param dst
  */
-void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeValue(V value, StorageClass& store, char* p, uint32 x, uint32& offset)
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeField(DerivedLoader& loader, uint32 x, Field const* field, char* dst)
 {
-    DerivedLoader* subclass = (static_cast<DerivedLoader*>(this));
-    switch (store.GetDstFormat(x))
+    S value;
+    ReadSQLStorageField(field, value);
+    loader.storeConverted(x, value, *reinterpret_cast<D*>(dst));
+}
+
+template<class DerivedLoader, class StorageClass>
+template<class D>
+/**
+ * @brief D destination-type of a default filled field
+ *
+ * @param loader
+ * @param x
+ * @param
+ * @param dst
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeDefault(DerivedLoader& loader, uint32 x, Field const* /*field*/, char* dst)
+{
+    loader.default_fill(x, D(0), *reinterpret_cast<D*>(dst));
+}
+
+template<class DerivedLoader, class StorageClass>
+/**
+ * @brief
+ *
+ * @param loader
+ * @param x
+ * @param
+ * @param dst
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeDefaultString(DerivedLoader& loader, uint32 x, Field const* /*field*/, char* dst)
+{
+    loader.default_fill_to_str(x, (char const*)NULL, *reinterpret_cast<char**>(dst));
+}
+
+template<class DerivedLoader, class StorageClass>
+template<class S>
+/**
+ * @brief the conversion from the source type S into the destination format
+ *
+ * @param dstFormat
+ * @return StoreFunction
+ */
+typename SQLStorageLoaderBase<DerivedLoader, StorageClass>::StoreFunction SQLStorageLoaderBase<DerivedLoader, StorageClass>::GetStoreFunction(char dstFormat)
+{
+    switch (dstFormat)
     {
-        case DBC_FF_LOGIC:
-            subclass->convert(x, value, *((bool*)(&p[offset])));
-            offset += sizeof(bool);
-            break;
-        case DBC_FF_BYTE:
-            subclass->convert(x, value, *((char*)(&p[offset])));
-            offset += sizeof(char);
-            break;
-        case DBC_FF_INT:
-            subclass->convert(x, value, *((uint32*)(&p[offset])));
-            offset += sizeof(uint32);
-            break;
-        case DBC_FF_FLOAT:
-            subclass->convert(x, value, *((float*)(&p[offset])));
-            offset += sizeof(float);
-            break;
-        case DBC_FF_STRING:
-            subclass->convert_to_str(x, value, *((char**)(&p[offset])));
-            offset += sizeof(char*);
-            break;
-        case DBC_FF_NA:
-            subclass->default_fill(x, value, *((uint32*)(&p[offset])));
-            offset += sizeof(uint32);
-            break;
-        case DBC_FF_NA_BYTE:
-            subclass->default_fill(x, value, *((char*)(&p[offset])));
-            offset += sizeof(char);
-            break;
-        case DBC_FF_NA_FLOAT:
-            subclass->default_fill(x, value, *((float*)(&p[offset])));
-            offset += sizeof(float);
-            break;
+        case DBC_FF_LOGIC:  return &SQLStorageLoaderBase::template storeField<S, bool>;
+        case DBC_FF_BYTE:   return &SQLStorageLoaderBase::template storeField<S, char>;
+        case DBC_FF_INT:    return &SQLStorageLoaderBase::template storeField<S, uint32>;
+        case DBC_FF_FLOAT:  return &SQLStorageLoaderBase::template storeField<S, float>;
+        case DBC_FF_STRING: return &SQLStorageLoaderBase::template storeField<S, char*>;
         case DBC_FF_IND:
         case DBC_FF_SORT:
             assert(false && "SQL storage does not have sort field types");
@@ -179,54 +261,94 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeValue(V value, Stor
             assert(false && "unknown format character");
             break;
     }
+
+    return NULL;
 }
 
 template<class DerivedLoader, class StorageClass>
 /**
  * @brief
  *
- * @param value
  * @param store
- * @param p
- * @param x
- * @param offset
+ * @param plan
  */
-void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeValue(char const* value, StorageClass& store, char* p, uint32 x, uint32& offset)
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::BuildPlan(StorageClass& store, RecordPlan& plan)
 {
-    DerivedLoader* subclass = (static_cast<DerivedLoader*>(this));
-    switch (store.GetDstFormat(x))
+    plan.clear();
+    plan.reserve(store.GetDstFieldCount());
+
+    // dependend on dest-size
+    // iterate two indexes: x over dest, y over source
+    //                      y++ If and only If x != FT_NA*
+    //                      x++ If and only If a value is stored
+    uint32 offset = 0;
+    for (uint32 x = 0, y = 0; x < store.GetDstFieldCount();)
     {
-        case DBC_FF_LOGIC:
-            subclass->convert_from_str(x, value, *((bool*)(&p[offset])));
-            offset += sizeof(bool);
-            break;
-        case DBC_FF_BYTE:
-            subclass->convert_from_str(x, value, *((char*)(&p[offset])));
-            offset += sizeof(char);
-            break;
-        case DBC_FF_INT:
-            subclass->convert_from_str(x, value, *((uint32*)(&p[offset])));
-            offset += sizeof(uint32);
-            break;
-        case DBC_FF_FLOAT:
-            subclass->convert_from_str(x, value, *((float*)(&p[offset])));
-            offset += sizeof(float);
-            break;
-        case DBC_FF_STRING:
-            subclass->convert_str_to_str(x, value, *((char**)(&p[offset])));
-            offset += sizeof(char*);
-            break;
-        case DBC_FF_NA_POINTER:
-            subclass->default_fill_to_str(x, value, *((char**)(&p[offset])));
-            offset += sizeof(char*);
-            break;
-        case DBC_FF_IND:
-        case DBC_FF_SORT:
-            assert(false && "SQL storage does not have sort field types");
-            break;
-        default:
-            assert(false && "unknown format character");
-            break;
+        FieldPlan field;
+        field.fieldPos = x;
+        field.srcIndex = 0;
+        field.offset = offset;
+
+        switch (store.GetDstFormat(x))
+        {
+            // For default fill continue and do not increase y
+            case DBC_FF_NA:         field.store = &storeDefault<uint32>;  offset += sizeof(uint32); break;
+            case DBC_FF_NA_BYTE:    field.store = &storeDefault<char>;    offset += sizeof(char);   break;
+            case DBC_FF_NA_FLOAT:   field.store = &storeDefault<float>;   offset += sizeof(float);  break;
+            case DBC_FF_NA_POINTER: field.store = &storeDefaultString;    offset += sizeof(char*);  break;
+            default:
+                field.store = NULL;
+                break;
+        }
+
+        if (field.store)
+        {
+            plan.push_back(field);
+            ++x;
+            continue;
+        }
+
+        // It is required that the input has at least as many columns set as the output requires
+        if (y >= store.GetSrcFieldCount())
+            { assert(false && "SQL storage has too few columns!"); }
+
+        field.srcIndex = y;
+        switch (store.GetSrcFormat(y))
+        {
+            case DBC_FF_LOGIC:  field.store = GetStoreFunction<bool>(store.GetDstFormat(x));        break;
+            case DBC_FF_BYTE:   field.store = GetStoreFunction<char>(store.GetDstFormat(x));        break;
+            case DBC_FF_INT:    field.store = GetStoreFunction<uint32>(store.GetDstFormat(x));      break;
+            case DBC_FF_FLOAT:  field.store = GetStoreFunction<float>(store.GetDstFormat(x));       break;
+            case DBC_FF_STRING: field.store = GetStoreFunction<char const*>(store.GetDstFormat(x)); break;
+            case DBC_FF_NA:
+            case DBC_FF_NA_BYTE:
+            case DBC_FF_NA_FLOAT:
+                // Do Not increase x
+                break;
+            case DBC_FF_IND:
+            case DBC_FF_SORT:
+            case DBC_FF_NA_POINTER:
+                assert(false && "SQL storage not have sort or pointer field types");
+                break;
+            default:
+                assert(false && "unknown format character");
+        }
+
+        if (field.store)
+        {
+            switch (store.GetDstFormat(x))
+            {
+                case DBC_FF_LOGIC:  offset += sizeof(bool);   break;
+                case DBC_FF_BYTE:   offset += sizeof(char);   break;
+                case DBC_FF_INT:    offset += sizeof(uint32); break;
+                case DBC_FF_FLOAT:  offset += sizeof(float);  break;
+                case DBC_FF_STRING: offset += sizeof(char*);  break;
+            }
+
+            plan.push_back(field);
+            ++x;
+        }
+        ++y;
     }
 }
 
@@ -261,7 +383,9 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         delete result;
     }
 
-    result = WorldDatabase.PQuery("SELECT * FROM %s", store.GetTableName());
+    // streamed, the rows are copied into the storage one by one instead of buffering the whole table first
+    std::string selectSql = std::string("SELECT * FROM ") + store.GetTableName();
+    result = WorldDatabase.QueryWithSnapshot(store.GetTableName(), store.GetTableName(), selectSql.c_str(), recordCount);
 
     if (!result)
     {
@@ -284,7 +408,6 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
     }
 
     // get struct size
-    uint32 offset = 0;
     for (uint32 x = 0; x < store.GetDstFieldCount(); ++x)
     {
         switch (store.GetDstFormat(x))
@@ -317,6 +440,10 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         }
     }
 
+    // the conversion of every field is selected once, not per row
+    RecordPlan plan;
+    BuildPlan(store, plan);
+
     // Prepare data storage and lookup storage
     store.prepareToLoad(maxRecordId, recordCount, recordsize);
 
@@ -327,55 +454,106 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         bar.step();
 
         char* record = store.createRecord(fields[0].GetUInt32());
-        offset = 0;
+        storeRecord(plan, fields, record);
+    }
+    while (result->NextRow());
 
-        // dependend on dest-size
-        // iterate two indexes: x over dest, y over source
-        //                      y++ If and only If x != FT_NA*
-        //                      x++ If and only If a value is stored
-        for (uint32 x = 0, y = 0; x < store.GetDstFieldCount();)
-        {
-            switch (store.GetDstFormat(x))
-            {
-                // For default fill continue and do not increase y
-                case DBC_FF_NA:         storeValue((uint32)0, store, record, x, offset);         ++x; continue;
-                case DBC_FF_NA_BYTE:    storeValue((char)0, store, record, x, offset);           ++x; continue;
-                case DBC_FF_NA_FLOAT:   storeValue((float)0.0f, store, record, x, offset);       ++x; continue;
-                case DBC_FF_NA_POINTER: storeValue((char const*)NULL, store, record, x, offset); ++x; continue;
-                default:
-                    break;
-            }
+    delete result;
+}
 
-            // It is required that the input has at least as many columns set as the output requires
-            if (y >= store.GetSrcFieldCount())
-                { assert(false && "SQL storage has too few columns!"); }
+template<class DerivedLoader, class StorageClass>
+/**
+ * @brief
+ *
+ * @param plan
+ * @param fields
+ * @param record
+ */
+void SQLStorageLoaderBase<DerivedLoader, StorageClass>::storeRecord(RecordPlan const& plan, Field* fields, char* record)
+{
+    DerivedLoader& subclass = *static_cast<DerivedLoader*>(this);
 
-            switch (store.GetSrcFormat(y))
-            {
-                case DBC_FF_LOGIC:  storeValue((bool)(fields[y].GetUInt32() > 0), store, record, x, offset);  ++x; break;
-                case DBC_FF_BYTE:   storeValue((char)fields[y].GetUInt8(), store, record, x, offset);         ++x; break;
-                case DBC_FF_INT:    storeValue((uint32)fields[y].GetUInt32(), store, record, x, offset);      ++x; break;
-                case DBC_FF_FLOAT:  storeValue((float)fields[y].GetFloat(), store, record, x, offset);        ++x; break;
-                case DBC_FF_STRING: storeValue((char const*)fields[y].GetString(), store, record, x, offset); ++x; break;
-                case DBC_FF_NA:
-                case DBC_FF_NA_BYTE:
-                case DBC_FF_NA_FLOAT:
-                    // Do Not increase x
-                    break;
-                case DBC_FF_IND:
-                case DBC_FF_SORT:
-                case DBC_FF_NA_POINTER:
-                    assert(false && "SQL storage not have sort or pointer field types");
-                    break;
-                default:
-                    assert(false && "unknown format character");
-            }
-            ++y;
+    for (typename RecordPlan::const_iterator itr = plan.begin(); itr != plan.end(); ++itr)
+        { itr->store(subclass, itr->fieldPos, &fields[itr->srcIndex], record + itr->offset); }
+}
+
+template<class DerivedLoader, class StorageClass>
+/**
+ * @brief
+ *
+ * @param store
+ * @param changedIds
+ * @return bool
+ */
+bool SQLStorageLoaderBase<DerivedLoader, StorageClass>::Reload(StorageClass& store, std::vector<uint32>& changedIds)
+{
+    uint64 checksum = WorldDatabase.GetTablesChecksum(store.GetTableName());
+    if (checksum && checksum == store.m_reloadChecksum)
+        { return true; }                                    // not changed since the last reload
+
+    QueryResult* result = WorldDatabase.PQuery("SELECT MAX(%s) FROM %s", store.EntryFieldName(), store.GetTableName());
+    if (!result)
+    {
+        sLog.outError("Error reloading %s table (not exist?)", store.GetTableName());
+        return false;
+    }
+
+    uint32 maxRecordId = (*result)[0].GetUInt32() + 1;
+    delete result;
+
+    std::string selectSql = std::string("SELECT * FROM ") + store.GetTableName();
+    result = WorldDatabase.QueryStreamed(selectSql.c_str());
+    if (!result)
+    {
+        // all rows deleted, they are kept like single deleted rows
+        store.m_reloadChecksum = checksum;
+        return true;
+    }
+
+    if (store.GetSrcFieldCount() != result->GetFieldCount())
+    {
+        sLog.outError("Error in %s table. Perhaps the table structure was changed. There should be %d fields in the table.", store.GetTableName(), store.GetSrcFieldCount());
+        delete result;
+        return false;
+    }
+
+    RecordPlan plan;
+    BuildPlan(store, plan);
+
+    store.prepareToReload(maxRecordId);
+
+    uint32 recordSize = store.GetRecordSize();
+    char* record = new char[recordSize];
+
+    do
+    {
+        Field* fields = result->Fetch();
+        uint32 recordId = fields[0].GetUInt32();
+
+        memset(record, 0, recordSize);
+        storeRecord(plan, fields, record);
+
+        char const* current = store.template LookupEntry<char>(recordId);
+        if (current && store.IsSameRecord(current, record))
+        {
+            store.FreeRecordStrings(record);
+            continue;
         }
+
+        // publish a new record, the old one may still be referenced
+        store.m_reloadedRecords.push_back(record);
+        store.JustCreatedRecord(recordId, record);
+        changedIds.push_back(recordId);
+
+        record = new char[recordSize];
     }
     while (result->NextRow());
 
+    delete[] record;
     delete result;
+
+    store.m_reloadChecksum = checksum;
+    return true;
 }
 
 #endif
@@ -0,0 +1,229 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "Database/SqlBatch.h"
+#include "DatabaseEnv.h"
+#include "Util.h"
+
+#include <set>
+
+/**
+ * @brief splits a comma separated column list
+ *
+ * @param columns
+ * @return Tokens
+ */
+static Tokens SplitColumns(char const* columns)
+{
+    Tokens result;
+
+    Tokens tokens = StrSplit(columns, ",");
+    for (Tokens::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+    {
+        std::string column = *itr;
+        column.erase(0, column.find_first_not_of(' '));
+        column.erase(column.find_last_not_of(' ') + 1);
+        if (!column.empty())
+            { result.push_back(column); }
+    }
+
+    return result;
+}
+
+SqlInsertBatch::SqlInsertBatch(Database& db, char const* table, char const* columns, char const* keyColumns /*= NULL*/) :
+    m_db(db), m_rows(0), m_firstValue(true)
+{
+    m_head = std::string("INSERT INTO ") + table + " (" + columns + ") VALUES ";
+
+    if (keyColumns)
+    {
+        Tokens keys = SplitColumns(keyColumns);
+        std::set<std::string> keySet(keys.begin(), keys.end());
+
+        Tokens updates;
+        Tokens all = SplitColumns(columns);
+        for (Tokens::const_iterator itr = all.begin(); itr != all.end(); ++itr)
+        {
+            if (keySet.find(*itr) == keySet.end())
+                { updates.push_back(*itr); }
+        }
+
+#ifdef DO_POSTGRESQL
+        m_tail = std::string(" ON CONFLICT (") + keyColumns + ")";
+        if (updates.empty())
+            { m_tail += " DO NOTHING"; }
+        else
+        {
+            m_tail += " DO UPDATE SET ";
+            for (Tokens::const_iterator itr = updates.begin(); itr != updates.end(); ++itr)
+                { m_tail += (itr == updates.begin() ? "" : ",") + *itr + "=EXCLUDED." + *itr; }
+        }
+#else
+        // a key only table has nothing to update, assign a key to itself to ignore duplicates
+        if (updates.empty() && !keys.empty())
+            { updates.push_back(keys.front()); }
+
+        m_tail = " ON DUPLICATE KEY UPDATE ";
+        for (Tokens::const_iterator itr = updates.begin(); itr != updates.end(); ++itr)
+            { m_tail += (itr == updates.begin() ? "" : ",") + *itr + "=VALUES(" + *itr + ")"; }
+#endif
+    }
+
+    m_sql = m_head;
+}
+
+void SqlInsertBatch::NewRow()
+{
+    if (m_rows)
+    {
+        m_sql += ')';
+
+        // keep the statements at the size of usual queries
+        if (m_sql.size() >= MAX_QUERY_LEN)
+            { Flush(); }
+    }
+
+    m_sql += m_rows ? ",(" : "(";
+    m_firstValue = true;
+    ++m_rows;
+}
+
+void SqlInsertBatch::AddValue(char const* value)
+{
+    MANGOS_ASSERT(m_rows);
+
+    if (!m_firstValue)
+        { m_sql += ','; }
+
+    m_sql += value;
+    m_firstValue = false;
+}
+
+void SqlInsertBatch::addUInt32(uint32 value)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u", value);
+    AddValue(buf);
+}
+
+void SqlInsertBatch::addInt32(int32 value)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%i", value);
+    AddValue(buf);
+}
+
+void SqlInsertBatch::addUInt64(uint64 value)
+{
+    char buf[24];
+    snprintf(buf, sizeof(buf), UI64FMTD, value);
+    AddValue(buf);
+}
+
+void SqlInsertBatch::addInt64(int64 value)
+{
+    char buf[24];
+    snprintf(buf, sizeof(buf), SI64FMTD, value);
+    AddValue(buf);
+}
+
+void SqlInsertBatch::addDouble(double value)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    AddValue(buf);
+}
+
+void SqlInsertBatch::addString(std::string const& value)
+{
+    std::string escaped = value;
+    m_db.escape_string(escaped);
+    AddValue(("'" + escaped + "'").c_str());
+}
+
+bool SqlInsertBatch::Execute()
+{
+    if (!m_rows)
+        { return true; }
+
+    m_sql += ')';
+    return Flush();
+}
+
+bool SqlInsertBatch::Flush()
+{
+    m_sql += m_tail;
+    bool res = m_db.Execute(m_sql.c_str());
+
+    m_sql = m_head;
+    m_rows = 0;
+    return res;
+}
+
+SqlDeleteBatch::SqlDeleteBatch(Database& db, char const* table, char const* keyColumn, char const* ownerColumn /*= NULL*/, uint32 owner /*= 0*/) :
+    m_db(db), m_keys(0)
+{
+    m_head = std::string("DELETE FROM ") + table + " WHERE ";
+
+    if (ownerColumn)
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u", owner);
+        m_head += std::string(ownerColumn) + " = " + buf + " AND ";
+    }
+
+    m_head += std::string(keyColumn) + " IN (";
+    m_sql = m_head;
+}
+
+SqlDeleteBatch::SqlDeleteBatch(Database& db, char const* table, char const* keyColumn, std::string const& condition) :
+    m_db(db), m_keys(0)
+{
+    m_head = std::string("DELETE FROM ") + table + " WHERE " + condition + " AND " + keyColumn + " IN (";
+    m_sql = m_head;
+}
+
+void SqlDeleteBatch::addKey(uint32 key)
+{
+    if (m_sql.size() >= MAX_QUERY_LEN)
+        { Execute(); }
+
+    char buf[16];
+    snprintf(buf, sizeof(buf), m_keys ? ",%u" : "%u", key);
+    m_sql += buf;
+    ++m_keys;
+}
+
+bool SqlDeleteBatch::Execute()
+{
+    if (!m_keys)
+        { return true; }
+
+    m_sql += ')';
+    bool res = m_db.Execute(m_sql.c_str());
+
+    m_sql = m_head;
+    m_keys = 0;
+    return res;
+}
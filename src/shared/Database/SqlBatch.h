@@ -0,0 +1,135 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_SQLBATCH
+#define MANGOS_H_SQLBATCH
+
+#include "Common.h"
+
+class Database;
+
+/**
+ * @brief builds multi-row INSERT statements from many single rows
+ *
+ * With key columns given rows replace existing rows of the same key (ON DUPLICATE KEY UPDATE,
+ * ON CONFLICT for PostgreSQL), so NEW and CHANGED rows can go into the same batch.
+ * The statements are issued with Database::Execute and so join the transaction of the calling thread.
+ *
+ */
+class SqlInsertBatch
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param db
+         * @param table
+         * @param columns comma separated list of the columns of every row
+         * @param keyColumns comma separated primary key columns for an upsert, NULL for plain inserts
+         */
+        SqlInsertBatch(Database& db, char const* table, char const* columns, char const* keyColumns = NULL);
+
+        /**
+         * @brief starts the next row, its values must be added in the order of the columns
+         *
+         */
+        void NewRow();
+
+        void addUInt8(uint8 value) { addUInt32(value); }
+        void addUInt32(uint32 value);
+        void addInt32(int32 value);
+        void addUInt64(uint64 value);
+        void addInt64(int64 value);
+        void addDouble(double value);
+        void addNull() { AddValue("NULL"); }
+        /**
+         * @brief adds an escaped and quoted string value
+         *
+         * @param value
+         */
+        void addString(std::string const& value);
+
+        /**
+         * @brief issues the statement for the rows added since the last call
+         *
+         * @return bool
+         */
+        bool Execute();
+
+    private:
+        void AddValue(char const* value);
+        bool Flush();
+
+        Database& m_db;
+        std::string m_head;                                 // INSERT INTO ... VALUES
+        std::string m_tail;                                 // upsert clause
+        std::string m_sql;                                  // m_head and the rows added so far
+        uint32 m_rows;
+        bool m_firstValue;                                  // no value added to the current row yet
+};
+
+/**
+ * @brief builds one DELETE ... IN (...) statement from many single row deletes
+ *
+ */
+class SqlDeleteBatch
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param db
+         * @param table
+         * @param keyColumn column compared with the added keys
+         * @param ownerColumn additional column all deleted rows must match, NULL for none
+         * @param owner value of ownerColumn
+         */
+        SqlDeleteBatch(Database& db, char const* table, char const* keyColumn, char const* ownerColumn = NULL, uint32 owner = 0);
+        /**
+         * @brief
+         *
+         * @param db
+         * @param table
+         * @param keyColumn column compared with the added keys
+         * @param condition additional condition all deleted rows must match
+         */
+        SqlDeleteBatch(Database& db, char const* table, char const* keyColumn, std::string const& condition);
+
+        void addKey(uint32 key);
+
+        /**
+         * @brief issues the statement for the keys added since the last call
+         *
+         * @return bool
+         */
+        bool Execute();
+
+    private:
+        Database& m_db;
+        std::string m_head;                                 // DELETE FROM ... IN (
+        std::string m_sql;
+        uint32 m_keys;
+};
+
+#endif
@@ -25,8 +25,15 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Config/Config.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase) :
+    m_queueSize(0), m_dbEngine(db), m_dbConnection(conn), m_running(true), m_pingDatabase(pingDatabase),
+    m_wakeCondition(m_wakeLock)
 {
 }
 
@@ -42,23 +49,39 @@ void SqlDelayThread::run()
     mysql_thread_init();
 #endif
 
-    const uint32 loopSleepms = 10;
+    // the delay threads of all databases take the sets in turn
+    static ACE_Atomic_Op<ACE_Thread_Mutex, long> threadIndex;
+    std::string cpuSets = sConfig.GetStringDefault("Affinity.Database", "");
+    if (!ACE_Based::Thread::setCurrentAffinity(cpuSets, (unsigned int)(threadIndex++)))
+        { sLog.outError("Affinity.Database '%s' is invalid or not supported, database thread not bound", cpuSets.c_str()); }
 
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
+    ACE_Time_Value pingInterval;
+    pingInterval.msec(long(m_dbEngine->GetPingIntervall()));
+    ACE_Time_Value nextPing = ACE_OS::gettimeofday() + pingInterval;
 
-    uint32 loopCounter = 0;
     while (m_running)
     {
-        // if the running state gets turned off while sleeping
-        // empty the queue before exiting
-        ACE_Based::Thread::Sleep(loopSleepms);
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_wakeLock);
+
+            // Delay() signals under m_wakeLock after queueing, so no request is missed between the check and the wait
+            while (m_running && m_sqlQueue.empty())
+            {
+                if (!m_pingDatabase)
+                    { m_wakeCondition.wait(); }
+                else if (m_wakeCondition.wait(&nextPing) == -1 && ACE_OS::gettimeofday() >= nextPing)
+                    { break; }
+            }
+        }
 
+        // if the running state gets turned off while waiting
+        // empty the queue before exiting
         ProcessRequests();
 
-        if ((loopCounter++) >= pingEveryLoop)
+        if (m_pingDatabase && ACE_OS::gettimeofday() >= nextPing)
         {
-            loopCounter = 0;
             m_dbEngine->Ping();
+            nextPing = ACE_OS::gettimeofday() + pingInterval;
         }
     }
 
@@ -67,9 +90,21 @@ void SqlDelayThread::run()
 #endif
 }
 
+bool SqlDelayThread::Delay(SqlOperation* sql)
+{
+    ++m_queueSize;
+    m_sqlQueue.add(sql);
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_wakeLock, true);
+    m_wakeCondition.signal();
+    return true;
+}
+
 void SqlDelayThread::Stop()
 {
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_wakeLock);
     m_running = false;
+    m_wakeCondition.broadcast();
 }
 
 void SqlDelayThread::ProcessRequests()
@@ -79,5 +114,6 @@ void SqlDelayThread::ProcessRequests()
     {
         s->Execute(m_dbConnection);
         delete s;
+        --m_queueSize;
     }
 }
@@ -26,6 +26,8 @@
 #define MANGOS_H_SQLDELAYTHREAD
 
 #include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
 #include "LockedQueue.h"
 #include "Threading.h"
 
@@ -47,9 +49,13 @@ class SqlDelayThread : public ACE_Based::Runnable
 
     private:
         SqlQueue m_sqlQueue;                                /**< Queue of SQL statements */
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_queueSize;  /**< Requests queued and not finished yet */
         Database* m_dbEngine;                               /**< Pointer to used Database engine */
         SqlConnection* m_dbConnection;                      /**< Pointer to DB connection */
         volatile bool m_running; /**< TODO */
+        bool m_pingDatabase;                                /**< Ping all connections of m_dbEngine while idle */
+        ACE_Thread_Mutex m_wakeLock;                        /**< Guards m_wakeCondition */
+        ACE_Condition_Thread_Mutex m_wakeCondition;         /**< Signaled when requests are queued or at stop */
 
         /**
          * @brief process all enqueued requests
@@ -63,8 +69,9 @@ class SqlDelayThread : public ACE_Based::Runnable
          *
          * @param db
          * @param conn
+         * @param pingDatabase keep all connections of db alive, set for one thread per database
          */
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, bool pingDatabase);
         /**
          * @brief
          *
@@ -77,7 +84,14 @@ class SqlDelayThread : public ACE_Based::Runnable
          * @param sql
          * @return bool
          */
-        bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
+        bool Delay(SqlOperation* sql);
+
+        /**
+         * @brief requests queued and not finished yet
+         *
+         * @return long
+         */
+        long GetQueueSize() const { return m_queueSize.value(); }
 
         /**
          * @brief Stop event
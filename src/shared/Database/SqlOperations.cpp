@@ -93,6 +93,9 @@ bool SqlQuery::Execute(SqlConnection* conn)
     if (!m_callback || !m_queue)
         { return false; }
 
+    if (m_conn)
+        { conn = m_conn; }
+
     LOCK_DB_CONN(conn);
     /// execute the query and store the result in the callback
     m_callback->SetResult(conn->Query(m_sql));
@@ -125,6 +128,15 @@ bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* t
     return true;
 }
 
+bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue, Database* db)
+{
+    if (!callback || !thread || !queue)
+        { return false; }
+
+    thread->Delay(new SqlQueryHolderEx(this, callback, queue, db));
+    return true;
+}
+
 bool SqlQueryHolder::SetQuery(size_t index, const char* sql)
 {
     if (m_queries.size() <= index)
@@ -133,10 +145,10 @@ bool SqlQueryHolder::SetQuery(size_t index, const char* sql)
         return false;
     }
 
-    if (m_queries[index].first != NULL)
+    if (m_queries[index].first != NULL || m_stmts[index].second != NULL)
     {
         sLog.outError("Attempt assign query to holder index (" SIZEFMTD ") where other query stored (Old: [%s] New: [%s])",
-                      index, m_queries[index].first, sql);
+                      index, m_queries[index].first ? m_queries[index].first : "prepared statement", sql);
         return false;
     }
 
@@ -168,6 +180,33 @@ bool SqlQueryHolder::SetPQuery(size_t index, const char* format, ...)
     return SetQuery(index, szQuery);
 }
 
+bool SqlQueryHolder::SetStmtQuery(size_t index, SqlStatement& stmt)
+{
+    if (m_queries.size() <= index)
+    {
+        sLog.outError("Query index (" SIZEFMTD ") out of range (size: " SIZEFMTD ") for statement %i", index, m_queries.size(), stmt.ID());
+        return false;
+    }
+
+    if (m_queries[index].first != NULL || m_stmts[index].second != NULL)
+    {
+        sLog.outError("Attempt assign statement %i to holder index (" SIZEFMTD ") where other query stored", stmt.ID(), index);
+        return false;
+    }
+
+    SqlStmtParameters* params = stmt.detach();
+    if (params->boundParams() != stmt.arguments())
+    {
+        sLog.outError("SQL ERROR: wrong amount of parameters (%i instead of %i) for statement %i", params->boundParams(), stmt.arguments(), stmt.ID());
+        delete params;
+        return false;
+    }
+
+    /// executed on the connection of the delay thread, prepared there at first use
+    m_stmts[index] = SqlStmtRequest(stmt.ID(), params);
+    return true;
+}
+
 QueryResult* SqlQueryHolder::GetResult(size_t index)
 {
     if (index < m_queries.size())
@@ -178,6 +217,11 @@ QueryResult* SqlQueryHolder::GetResult(size_t index)
             delete[](const_cast<char*>(m_queries[index].first));
             m_queries[index].first = NULL;
         }
+        if (m_stmts[index].second != NULL)
+        {
+            delete m_stmts[index].second;
+            m_stmts[index].second = NULL;
+        }
         /// when you get a result aways remember to delete it!
         return m_queries[index].second;
     }
@@ -203,6 +247,11 @@ SqlQueryHolder::~SqlQueryHolder()
             delete[](const_cast<char*>(m_queries[i].first));
             delete m_queries[i].second;
         }
+        else if (m_stmts[i].second != NULL)
+        {
+            delete m_stmts[i].second;
+            delete m_queries[i].second;
+        }
     }
 }
 
@@ -210,6 +259,24 @@ void SqlQueryHolder::SetSize(size_t size)
 {
     /// to optimize push_back, reserve the number of queries about to be executed
     m_queries.resize(size);
+    m_stmts.resize(size, SqlStmtRequest(-1, (SqlStmtParameters*)NULL));
+}
+
+void SqlQueryHolderEx::Spread(SqlConnection* conn)
+{
+    std::vector<SqlDelayThread*> threads;
+    m_db->GetOtherDelayThreads(conn, threads);
+    m_db = NULL;
+
+    size_t parts = std::min(threads.size() + 1, m_holder->m_queries.size());
+    if (parts < 2)
+        { return; }
+
+    /// this part counts too, the last finished part syncs with the caller thread
+    m_step = parts;
+    m_pendingParts = new PartCounter(long(parts));
+    for (size_t i = 1; i < parts; ++i)
+        { threads[i - 1]->Delay(new SqlQueryHolderEx(m_holder, m_callback, m_queue, i, parts, m_pendingParts)); }
 }
 
 bool SqlQueryHolderEx::Execute(SqlConnection* conn)
@@ -217,14 +284,29 @@ bool SqlQueryHolderEx::Execute(SqlConnection* conn)
     if (!m_holder || !m_callback || !m_queue)
         { return false; }
 
-    LOCK_DB_CONN(conn);
-    /// we can do this, we are friends
-    std::vector<SqlQueryHolder::SqlResultPair>& queries = m_holder->m_queries;
-    for (size_t i = 0; i < queries.size(); ++i)
+    if (m_db)
+        { Spread(conn); }
+
+    {
+        LOCK_DB_CONN(conn);
+        /// we can do this, we are friends
+        std::vector<SqlQueryHolder::SqlResultPair>& queries = m_holder->m_queries;
+        for (size_t i = m_first; i < queries.size(); i += m_step)
+        {
+            /// execute the queries of this part and pass the results, each part sets other indexes
+            char const* sql = queries[i].first;
+            if (sql) { m_holder->SetResult(i, conn->Query(sql)); }
+            else if (SqlStmtParameters const* params = m_holder->m_stmts[i].second)
+                { m_holder->SetResult(i, conn->QueryStmt(m_holder->m_stmts[i].first, *params)); }
+        }
+    }
+
+    if (m_pendingParts)
     {
-        /// execute all queries in the holder and pass the results
-        char const* sql = queries[i].first;
-        if (sql) { m_holder->SetResult(i, conn->Query(sql)); }
+        if (--(*m_pendingParts) > 0)
+            { return true; }
+
+        delete m_pendingParts;
     }
 
     /// sync with the caller thread
@@ -28,6 +28,7 @@
 #include "Common.h"
 
 #include <ace/Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
 #include "LockedQueue.h"
 #include <queue>
 #include "Utilities/Callback.h"
@@ -38,6 +39,7 @@ class Database;
 class SqlConnection;
 class SqlDelayThread;
 class SqlStmtParameters;
+class SqlStatement;
 
 /**
  * @brief
@@ -203,6 +205,7 @@ class SqlQuery : public SqlOperation
         const char* m_sql; /**< TODO */
         MaNGOS::IQueryCallback* m_callback; /**< TODO */
         SqlResultQueue* m_queue; /**< TODO */
+        SqlConnection* m_conn;                              /**< replaces the connection of the delay thread if set */
     public:
         /**
          * @brief
@@ -212,12 +215,18 @@ class SqlQuery : public SqlOperation
          * @param queue
          */
         SqlQuery(const char* sql, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue)
-            : m_sql(mangos_strdup(sql)), m_callback(callback), m_queue(queue) {}
+            : m_sql(mangos_strdup(sql)), m_callback(callback), m_queue(queue), m_conn(NULL) {}
         /**
          * @brief
          *
          */
         ~SqlQuery() { char* tofree = const_cast<char*>(m_sql); delete[] tofree; }
+        /**
+         * @brief runs the query on conn instead of the connection of the delay thread
+         *
+         * @param conn
+         */
+        void SetConnection(SqlConnection* conn) { m_conn = conn; }
         /**
          * @brief
          *
@@ -241,6 +250,12 @@ class SqlQueryHolder
          */
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries; /**< TODO */
+        /**
+         * @brief statement index and parameters of the queries set by SetStmtQuery, same indexes as m_queries
+         *
+         */
+        typedef std::pair<int, SqlStmtParameters*> SqlStmtRequest;
+        std::vector<SqlStmtRequest> m_stmts;
     public:
         /**
          * @brief
@@ -268,6 +283,14 @@ class SqlQueryHolder
          * @return bool
          */
         bool SetPQuery(size_t index, const char* format, ...) ATTR_PRINTF(3, 4);
+        /**
+         * @brief stores a prepared query with all its parameters bound
+         *
+         * @param index
+         * @param stmt
+         * @return bool
+         */
+        bool SetStmtQuery(size_t index, SqlStatement& stmt);
         /**
          * @brief
          *
@@ -297,6 +320,16 @@ class SqlQueryHolder
          * @return bool
          */
         bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue);
+        /**
+         * @brief as above, the queries may be spread over the other delay threads of db
+         *
+         * @param callback
+         * @param thread
+         * @param queue
+         * @param db
+         * @return bool
+         */
+        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue, Database* db);
 };
 
 /**
@@ -306,9 +339,32 @@ class SqlQueryHolder
 class SqlQueryHolderEx : public SqlOperation
 {
     private:
+        typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> PartCounter;
+
         SqlQueryHolder* m_holder; /**< TODO */
         MaNGOS::IQueryCallback* m_callback; /**< TODO */
         SqlResultQueue* m_queue; /**< TODO */
+        Database* m_db;                                     /**< spreads the queries over its delay threads, NULL for no spreading */
+        size_t m_first;                                     /**< executed queries: m_first, m_first + m_step, ... */
+        size_t m_step;
+        PartCounter* m_pendingParts;                        /**< parts not finished yet, shared by all parts, NULL if not spread */
+
+        /**
+         * @brief one part of a spread holder
+         *
+         */
+        SqlQueryHolderEx(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue, size_t first, size_t step, PartCounter* pendingParts)
+            : m_holder(holder), m_callback(callback), m_queue(queue), m_db(NULL), m_first(first), m_step(step), m_pendingParts(pendingParts) {}
+
+        /**
+         * @brief passes the queries from the second part on to the other delay threads of m_db
+         *
+         * Done when the holder is executed and not when it is queued, so all requests queued
+         * before the holder on the same delay thread (e.g. the logout save of a character) are finished.
+         *
+         * @param conn connection of the executing delay thread
+         */
+        void Spread(SqlConnection* conn);
     public:
         /**
          * @brief
@@ -316,9 +372,10 @@ class SqlQueryHolderEx : public SqlOperation
          * @param holder
          * @param callback
          * @param queue
+         * @param db
          */
-        SqlQueryHolderEx(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue)
-            : m_holder(holder), m_callback(callback), m_queue(queue) {}
+        SqlQueryHolderEx(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue, Database* db = NULL)
+            : m_holder(holder), m_callback(callback), m_queue(queue), m_db(db), m_first(0), m_step(1), m_pendingParts(NULL) {}
         /**
          * @brief
          *
@@ -481,6 +481,12 @@ class MANGOS_DLL_SPEC SqlStatement
          * @return bool
          */
         bool DirectExecute();
+        /**
+         * @brief synchronous query on one of the query connections
+         *
+         * @return QueryResult
+         */
+        QueryResult* Query();
 
         // templates to simplify 1-4 parameter bindings
         template<typename ParamType1>
@@ -547,6 +553,34 @@ class MANGOS_DLL_SPEC SqlStatement
             return Execute();
         }
 
+        template<typename ParamType1>
+        /**
+         * @brief
+         *
+         * @param param1
+         * @return QueryResult
+         */
+        QueryResult* PQuery(ParamType1 param1)
+        {
+            arg(param1);
+            return Query();
+        }
+
+        template<typename ParamType1, typename ParamType2>
+        /**
+         * @brief
+         *
+         * @param param1
+         * @param param2
+         * @return QueryResult
+         */
+        QueryResult* PQuery(ParamType1 param1, ParamType2 param2)
+        {
+            arg(param1);
+            arg(param2);
+            return Query();
+        }
+
         // bind parameters with specified type
         /**
          * @brief
@@ -636,6 +670,7 @@ class MANGOS_DLL_SPEC SqlStatement
     protected:
         // don't allow anyone except Database class to create static SqlStatement objects
         friend class Database;
+        friend class SqlQueryHolder;
         /**
          * @brief
          *
@@ -750,6 +785,14 @@ class MANGOS_DLL_SPEC SqlPreparedStatement
          * @return bool
          */
         virtual bool execute() = 0;
+        /**
+         * @brief execute statement with result set
+         *
+         * The rows are copied into the result, so the statement can be reused before the result is freed.
+         *
+         * @return QueryResult NULL for errors and empty results
+         */
+        virtual QueryResult* query() = 0;
 
     protected:
         /**
@@ -811,6 +854,12 @@ class MANGOS_DLL_SPEC SqlPlainPreparedStatement : public SqlPreparedStatement
          * @return bool
          */
         virtual bool execute() override;
+        /**
+         * @brief
+         *
+         * @return QueryResult
+         */
+        virtual QueryResult* query() override;
 
     protected:
         /**
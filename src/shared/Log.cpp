@@ -27,17 +27,19 @@
 #include "Policies/Singleton.h"
 #include "Config/Config.h"
 #include "Util.h"
-#include "ByteBuffer.h"
 #include "ProgressBar.h"
 
 #include <stdarg.h>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include <ace/OS_NS_unistd.h>
 
 INSTANTIATE_SINGLETON_1(Log);
 
+#define MAX_LOG_LINE_LEN 2048                               // longer lines are formatted in a heap buffer
+
 LogFilterData logFilterData[LOG_FILTER_COUNT] =
 {
     { "transport_moves",     "LogFilter_TransportMoves",     true  },
@@ -73,7 +75,7 @@ const int LogType_count = int(LogError) + 1;
 
 Log::Log() :
     raLogfile(NULL), logfile(NULL), gmLogfile(NULL), charLogfile(NULL),
-    dberLogfile(NULL), elunaErrLogfile(NULL), eventAiErLogfile(NULL), scriptErrLogFile(NULL), worldLogfile(NULL), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(NULL)
+    dberLogfile(NULL), elunaErrLogfile(NULL), eventAiErLogfile(NULL), scriptErrLogFile(NULL), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(NULL)
 {
     Initialize();
 }
@@ -223,6 +225,9 @@ void Log::SetLogFileLevel(char* level)
 
 void Log::Initialize()
 {
+    // files are reopened below, nothing may be queued for the old ones
+    m_writer.Deactivate();
+
     /// Common log files data
     m_logsDir = sConfig.GetStringDefault("LogsDir", "");
     if (!m_logsDir.empty())
@@ -272,7 +277,6 @@ void Log::Initialize()
     elunaErrLogfile = openLogFile("ElunaErrorLogFile", NULL, "a");
     eventAiErLogfile = openLogFile("EventAIErrorLogFile", NULL, "a");
     raLogfile = openLogFile("RaLogFile", NULL, "a");
-    worldLogfile = openLogFile("WorldLogFile", "WorldLogTimestamp", "a");
 
     // Main log file settings
     m_includeTime  = sConfig.GetBoolDefault("LogTime", false);
@@ -288,6 +292,17 @@ void Log::Initialize()
 
     // Char log settings
     m_charLog_Dump = sConfig.GetBoolDefault("CharLogDump", false);
+
+    // Log file writer thread
+    if (sConfig.GetBoolDefault("LogAsync", false))
+    {
+        uint32 maxRecords = sConfig.GetIntDefault("LogAsyncQueueSize", 100000);
+        LogOverflowPolicy overflow = sConfig.GetIntDefault("LogAsyncOverflow", LOG_OVERFLOW_WRITE) == LOG_OVERFLOW_DROP ? LOG_OVERFLOW_DROP : LOG_OVERFLOW_WRITE;
+        uint32 flushInterval = sConfig.GetIntDefault("LogAsyncFlushInterval", 50);
+
+        if (m_writer.Activate(maxRecords, overflow, flushInterval) == -1)
+            { fprintf(stderr, "Can't start the log writer thread, log files are written by the logging threads\n"); }
+    }
 }
 
 FILE* Log::openLogFile(char const* configFileName, char const* configTimeStampFlag, char const* mode)
@@ -359,17 +374,70 @@ std::string Log::GetTimestampStr()
     return std::string(buf);
 }
 
+std::string Log::GetLineTimestamp()
+{
+    time_t t = time(NULL);
+    tm* aTm = localtime(&t);
+    char buf[24];
+    snprintf(buf, 24, "%-4d-%02d-%02d %02d:%02d:%02d ", aTm->tm_year + 1900, aTm->tm_mon + 1, aTm->tm_mday, aTm->tm_hour, aTm->tm_min, aTm->tm_sec);
+    return std::string(buf);
+}
+
+void Log::writeLine(FILE* file, char const* prefix, char const* format, va_list ap)
+{
+    std::string text = GetLineTimestamp();
+    text += prefix;
+
+    char buf[MAX_LOG_LINE_LEN];
+
+    va_list apCopy;
+    va_copy(apCopy, ap);
+    int len = vsnprintf(buf, sizeof(buf), format, apCopy);
+    va_end(apCopy);
+
+    if (len >= 0 && size_t(len) < sizeof(buf))
+        { text.append(buf, len); }
+    else
+    {
+        // rare long lines, some platforms return -1 instead of the needed size
+        std::vector<char> longBuf(len > 0 ? size_t(len) + 1 : 32 * 1024);
+
+        va_copy(apCopy, ap);
+        len = vsnprintf(&longBuf[0], longBuf.size(), format, apCopy);
+        va_end(apCopy);
+
+        text.append(&longBuf[0], len >= 0 && size_t(len) < longBuf.size() ? size_t(len) : longBuf.size() - 1);
+    }
+
+    text += '\n';
+    m_writer.Write(file, text);
+}
+
+void Log::writeLine(FILE* file, char const* text)
+{
+    m_writer.Write(file, GetLineTimestamp() + text + "\n");
+}
+
+std::string Log::scriptLibPrefix() const
+{
+    if (!m_scriptLibName)
+        { return "<Scripting Library ERROR>: "; }
+
+    return std::string("<") + m_scriptLibName + " ERROR>: ";
+}
+
+void Log::StopAsyncWriter()
+{
+    m_writer.Deactivate();
+}
+
 void Log::outString()
 {
     if (m_includeTime)
         { outTime(); }
     printf("\n");
     if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "\n");
-        fflush(logfile);
-    }
+        { writeLine(logfile, ""); }
 
     fflush(stdout);
 }
@@ -398,14 +466,9 @@ void Log::outString(const char* str, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
+        writeLine(logfile, "", str, ap);
         va_end(ap);
-
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -434,15 +497,9 @@ void Log::outError(const char* err, ...)
     fprintf(stderr, "\n");
     if (logfile)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:");
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, "ERROR:", err, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     fflush(stderr);
@@ -456,18 +513,10 @@ void Log::outErrorDb()
     fprintf(stderr, "\n");
 
     if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:\n");
-        fflush(logfile);
-    }
+        { writeLine(logfile, "ERROR:"); }
 
     if (dberLogfile)
-    {
-        outTimestamp(dberLogfile);
-        fprintf(dberLogfile, "\n");
-        fflush(dberLogfile);
-    }
+        { writeLine(dberLogfile, ""); }
 
     fflush(stderr);
 }
@@ -496,28 +545,16 @@ void Log::outErrorDb(const char* err, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:");
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, "ERROR:", err, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     if (dberLogfile)
     {
-        outTimestamp(dberLogfile);
-
-        va_list ap;
         va_start(ap, err);
-        vfprintf(dberLogfile, err, ap);
+        writeLine(dberLogfile, "", err, ap);
         va_end(ap);
-
-        fprintf(dberLogfile, "\n");
-        fflush(dberLogfile);
     }
 
     fflush(stderr);
@@ -531,18 +568,10 @@ void Log::outErrorEluna()
     fprintf(stderr, "\n");
 
     if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR Eluna\n");
-        fflush(logfile);
-    }
+        { writeLine(logfile, "ERROR Eluna"); }
 
     if (elunaErrLogfile)
-    {
-        outTimestamp(elunaErrLogfile);
-        fprintf(elunaErrLogfile, "\n");
-        fflush(elunaErrLogfile);
-    }
+        { writeLine(elunaErrLogfile, ""); }
 
     fflush(stderr);
 }
@@ -571,28 +600,16 @@ void Log::outErrorEluna(const char* err, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR Eluna: ");
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, "ERROR Eluna: ", err, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     if (elunaErrLogfile)
     {
-        outTimestamp(elunaErrLogfile);
-
-        va_list ap;
         va_start(ap, err);
-        vfprintf(elunaErrLogfile, err, ap);
+        writeLine(elunaErrLogfile, "", err, ap);
         va_end(ap);
-
-        fprintf(elunaErrLogfile, "\n");
-        fflush(elunaErrLogfile);
     }
 
     fflush(stderr);
@@ -606,18 +623,10 @@ void Log::outErrorEventAI()
     fprintf(stderr, "\n");
 
     if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR CreatureEventAI\n");
-        fflush(logfile);
-    }
+        { writeLine(logfile, "ERROR CreatureEventAI"); }
 
     if (eventAiErLogfile)
-    {
-        outTimestamp(eventAiErLogfile);
-        fprintf(eventAiErLogfile, "\n");
-        fflush(eventAiErLogfile);
-    }
+        { writeLine(eventAiErLogfile, ""); }
 
     fflush(stderr);
 }
@@ -646,28 +655,16 @@ void Log::outErrorEventAI(const char* err, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR CreatureEventAI: ");
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, "ERROR CreatureEventAI: ", err, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     if (eventAiErLogfile)
     {
-        outTimestamp(eventAiErLogfile);
-
-        va_list ap;
         va_start(ap, err);
-        vfprintf(eventAiErLogfile, err, ap);
+        writeLine(eventAiErLogfile, "", err, ap);
         va_end(ap);
-
-        fprintf(eventAiErLogfile, "\n");
-        fflush(eventAiErLogfile);
     }
 
     fflush(stderr);
@@ -700,12 +697,9 @@ void Log::outBasic(const char* str, ...)
     if (logfile && m_logFileLevel >= LOG_LVL_BASIC)
     {
         va_list ap;
-        outTimestamp(logfile);
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
+        writeLine(logfile, "", str, ap);
         va_end(ap);
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -737,15 +731,10 @@ void Log::outDetail(const char* str, ...)
 
     if (logfile && m_logFileLevel >= LOG_LVL_DETAIL)
     {
-        outTimestamp(logfile);
-
         va_list ap;
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
+        writeLine(logfile, "", str, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -777,15 +766,10 @@ void Log::outDebug(const char* str, ...)
 
     if (logfile && m_logFileLevel >= LOG_LVL_DEBUG)
     {
-        outTimestamp(logfile);
-
         va_list ap;
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
+        writeLine(logfile, "", str, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -818,12 +802,9 @@ void Log::outCommand(uint32 account, const char* str, ...)
     if (logfile && m_logFileLevel >= LOG_LVL_DETAIL)
     {
         va_list ap;
-        outTimestamp(logfile);
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
+        writeLine(logfile, "", str, ap);
         va_end(ap);
-        fflush(logfile);
     }
 
     if (m_gmlog_per_account)
@@ -842,12 +823,9 @@ void Log::outCommand(uint32 account, const char* str, ...)
     else if (gmLogfile)
     {
         va_list ap;
-        outTimestamp(gmLogfile);
         va_start(ap, str);
-        vfprintf(gmLogfile, str, ap);
-        fprintf(gmLogfile, "\n");
+        writeLine(gmLogfile, "", str, ap);
         va_end(ap);
-        fflush(gmLogfile);
     }
 
     fflush(stdout);
@@ -861,12 +839,9 @@ void Log::outChar(const char* str, ...)
     if (charLogfile)
     {
         va_list ap;
-        outTimestamp(charLogfile);
         va_start(ap, str);
-        vfprintf(charLogfile, str, ap);
-        fprintf(charLogfile, "\n");
+        writeLine(charLogfile, "", str, ap);
         va_end(ap);
-        fflush(charLogfile);
     }
 }
 
@@ -878,21 +853,10 @@ void Log::outErrorScriptLib()
     fprintf(stderr, "\n");
 
     if (logfile)
-    {
-        outTimestamp(logfile);
-        if (m_scriptLibName)
-            { fprintf(logfile, "<%s ERROR:> ", m_scriptLibName); }
-        else
-            { fprintf(logfile, "<Scripting Library ERROR>: "); }
-        fflush(logfile);
-    }
+        { writeLine(logfile, scriptLibPrefix().c_str()); }
 
     if (scriptErrLogFile)
-    {
-        outTimestamp(scriptErrLogFile);
-        fprintf(scriptErrLogFile, "\n");
-        fflush(scriptErrLogFile);
-    }
+        { writeLine(scriptErrLogFile, ""); }
 
     fflush(stderr);
 }
@@ -921,68 +885,28 @@ void Log::outErrorScriptLib(const char* err, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-        if (m_scriptLibName)
-            { fprintf(logfile, "<%s ERROR>: ", m_scriptLibName); }
-        else
-            { fprintf(logfile, "<Scripting Library ERROR>: "); }
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, scriptLibPrefix().c_str(), err, ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     if (scriptErrLogFile)
     {
-        outTimestamp(scriptErrLogFile);
-
-        va_list ap;
         va_start(ap, err);
-        vfprintf(scriptErrLogFile, err, ap);
+        writeLine(scriptErrLogFile, "", err, ap);
         va_end(ap);
-
-        fprintf(scriptErrLogFile, "\n");
-        fflush(scriptErrLogFile);
     }
 
     fflush(stderr);
 }
 
-void Log::outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeName, ByteBuffer const* packet, bool incoming)
-{
-    if (!worldLogfile)
-        { return; }
-
-    ACE_GUARD(ACE_Thread_Mutex, GuardObj, m_worldLogMtx);
-
-    outTimestamp(worldLogfile);
-
-    fprintf(worldLogfile, "\n%s:\nSOCKET: %u\nLENGTH: %lu\nOPCODE: %s (0x%.4X)\nDATA:\n",
-            incoming ? "CLIENT" : "SERVER",
-            socket, packet->size(), opcodeName, opcode);
-
-    size_t p = 0;
-    while (p < packet->size())
-    {
-        for (size_t j = 0; j < 16 && p < packet->size(); ++j)
-            { fprintf(worldLogfile, "%.2X ", (*packet)[p++]); }
-
-        fprintf(worldLogfile, "\n");
-    }
-
-    fprintf(worldLogfile, "\n\n");
-    fflush(worldLogfile);
-}
-
 void Log::outCharDump(const char* str, uint32 account_id, uint32 guid, const char* name)
 {
     if (charLogfile)
     {
-        fprintf(charLogfile, "== START DUMP == (account: %u guid: %u name: %s )\n%s\n== END DUMP ==\n", account_id, guid, name, str);
-        fflush(charLogfile);
+        char buf[MAX_LOG_LINE_LEN];
+        snprintf(buf, sizeof(buf), "== START DUMP == (account: %u guid: %u name: %s )\n", account_id, guid, name);
+        m_writer.Write(charLogfile, std::string(buf) + str + "\n== END DUMP ==\n");
     }
 }
 
@@ -994,12 +918,9 @@ void Log::outRALog(const char* str, ...)
     if (raLogfile)
     {
         va_list ap;
-        outTimestamp(raLogfile);
         va_start(ap, str);
-        vfprintf(raLogfile, str, ap);
-        fprintf(raLogfile, "\n");
+        writeLine(raLogfile, "", str, ap);
         va_end(ap);
-        fflush(raLogfile);
     }
 
     fflush(stdout);
@@ -1033,7 +954,10 @@ void Log::setScriptLibraryErrorFile(char const* fname, char const* libName)
     m_scriptLibName = libName;
 
     if (scriptErrLogFile)
-        { fclose(scriptErrLogFile); }
+    {
+        m_writer.Flush();                                   // lines still queued for the old file
+        fclose(scriptErrLogFile);
+    }
 
     if (!fname)
     {
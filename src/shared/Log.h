@@ -27,9 +27,11 @@
 
 #include "Common.h"
 #include "Policies/Singleton.h"
+#include "LogWriter.h"
+
+#include <cstdarg>
 
 class Config;
-class ByteBuffer;
 
 /**
  * @brief various levels for logging
@@ -129,6 +131,8 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
          */
         ~Log()
         {
+            m_writer.Deactivate();
+
             if (logfile != NULL)
                 { fclose(logfile); }
             logfile = NULL;
@@ -160,10 +164,6 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
             if (raLogfile != NULL)
                 { fclose(raLogfile); }
             raLogfile = NULL;
-
-            if (worldLogfile != NULL)
-                { fclose(worldLogfile); }
-            worldLogfile = NULL;
         }
     public:
         /**
@@ -273,16 +273,6 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
          */
         void outErrorScriptLib(const char* str, ...)     ATTR_PRINTF(2, 3);
 
-        /**
-         * @brief any log level
-         *
-         * @param socket
-         * @param opcode
-         * @param opcodeName
-         * @param packet
-         * @param incoming
-         */
-        void outWorldPacketDump(uint32 socket, uint32 opcode, char const* opcodeName, ByteBuffer const* packet, bool incoming);
         /**
          * @brief any log level
          *
@@ -394,6 +384,27 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
          */
         void setScriptLibraryErrorFile(char const* fname, char const* libName);
 
+        /**
+         * @brief writes the lines queued for the log files and stops the writer thread, see LogAsync
+         *
+         * Lines logged later are written by the logging thread again.
+         */
+        void StopAsyncWriter();
+
+        /**
+         * @brief directory of the log files, empty or ending with a path separator
+         *
+         * @return std::string
+         */
+        std::string const& GetLogsDir() const { return m_logsDir; }
+
+        /**
+         * @brief writer of the log files, also for binary files like the packet capture
+         *
+         * @return LogWriter
+         */
+        LogWriter& GetWriter() { return m_writer; }
+
     private:
         /**
          * @brief
@@ -411,6 +422,36 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
          * @return FILE
          */
         FILE* openGmlogPerAccount(uint32 account);
+        /**
+         * @brief timestamp in front of the lines of the log files
+         *
+         * @return std::string
+         */
+        static std::string GetLineTimestamp();
+        /**
+         * @brief formats a line with timestamp and prefix and hands it to the writer
+         *
+         * The formatting happens in the calling thread, only the finished line is queued.
+         *
+         * @param file
+         * @param prefix
+         * @param format
+         * @param ap
+         */
+        void writeLine(FILE* file, char const* prefix, char const* format, va_list ap);
+        /**
+         * @brief writes a line of fixed text with timestamp
+         *
+         * @param file
+         * @param text
+         */
+        void writeLine(FILE* file, char const* text);
+        /**
+         * @brief prefix of the script library errors in the main log file
+         *
+         * @return std::string
+         */
+        std::string scriptLibPrefix() const;
 
         FILE* raLogfile; /**< TODO */
         FILE* logfile; /**< TODO */
@@ -420,8 +461,7 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
         FILE* elunaErrLogfile; /**< TODO */
         FILE* eventAiErLogfile; /**< TODO */
         FILE* scriptErrLogFile; /**< TODO */
-        FILE* worldLogfile; /**< TODO */
-        ACE_Thread_Mutex m_worldLogMtx; /**< TODO */
+        LogWriter m_writer; /**< writes the log files, in a thread of its own with LogAsync */
 
         LogLevel m_logLevel; /**< log/console control */
         LogLevel m_logFileLevel; /**< TODO */
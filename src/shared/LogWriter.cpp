@@ -0,0 +1,152 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "LogWriter.h"
+
+#include <ace/OS_NS_unistd.h>
+
+#include <vector>
+#include <algorithm>
+
+LogWriter::LogWriter() :
+    m_queued(0), m_dropped(0), m_maxRecords(0), m_overflow(LOG_OVERFLOW_WRITE),
+    m_flushInterval(0), m_active(false), m_stopping(false)
+{
+}
+
+LogWriter::~LogWriter()
+{
+    Deactivate();
+}
+
+int LogWriter::Activate(uint32 maxRecords, LogOverflowPolicy overflow, uint32 flushInterval)
+{
+    if (m_active || maxRecords == 0)
+        { return 0; }
+
+    m_maxRecords = maxRecords;
+    m_overflow = overflow;
+    m_flushInterval = flushInterval ? flushInterval : 1;
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1)
+        { return -1; }
+
+    m_active = true;
+    return 0;
+}
+
+void LogWriter::Deactivate()
+{
+    if (!m_active)
+        { return; }
+
+    // new lines are written by their callers from now on
+    m_active = false;
+    m_stopping = true;
+    ACE_Task_Base::wait();
+
+    // lines added while the thread stopped
+    WriteQueued();
+}
+
+void LogWriter::Write(FILE* file, std::string const& text)
+{
+    if (m_active)
+    {
+        if (m_queued.value() < long(m_maxRecords))
+        {
+            ++m_queued;
+            m_queue.add(new Record(file, text));
+            return;
+        }
+
+        if (m_overflow == LOG_OVERFLOW_DROP)
+        {
+            ++m_dropped;
+            return;
+        }
+    }
+
+    fwrite(text.data(), 1, text.size(), file);
+    fflush(file);
+}
+
+void LogWriter::Flush()
+{
+    while (m_active && m_queued.value() > 0)
+        { ACE_OS::sleep(ACE_Time_Value(0, 1000)); }
+}
+
+uint32 LogWriter::WriteQueued()
+{
+    std::vector<FILE*> files;
+
+    uint32 count = 0;
+    Record* record;
+    while (m_queue.next(record))
+    {
+        fwrite(record->text.data(), 1, record->text.size(), record->file);
+
+        if (std::find(files.begin(), files.end(), record->file) == files.end())
+            { files.push_back(record->file); }
+
+        delete record;
+        ++count;
+    }
+
+    for (std::vector<FILE*>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+        { fflush(*itr); }
+
+    // decreased after the flush, Flush() callers may close the files then
+    if (count)
+        { m_queued -= long(count); }
+
+    return count;
+}
+
+int LogWriter::svc()
+{
+    for (;;)
+    {
+        if (WriteQueued())
+            { continue; }
+
+        if (long dropped = m_dropped.value())
+        {
+            m_dropped -= dropped;
+            fprintf(stderr, "Log queue full, %ld lines were not written to the log files\n", dropped);
+            fflush(stderr);
+        }
+
+        // every line added before the stop request was written above
+        if (m_stopping)
+            { break; }
+
+        ACE_OS::sleep(ACE_Time_Value(0, m_flushInterval * 1000));
+    }
+
+    return 0;
+}
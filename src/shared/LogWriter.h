@@ -0,0 +1,117 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOSSERVER_LOGWRITER_H
+#define MANGOSSERVER_LOGWRITER_H
+
+#include "Common.h"
+#include "MPSCQueue.h"
+
+#include <ace/Task.h>
+#include <ace/Atomic_Op.h>
+
+#include <cstdio>
+
+/**
+ * @brief what happens to a log line when the queue of the writer thread is full
+ *
+ */
+enum LogOverflowPolicy
+{
+    LOG_OVERFLOW_DROP  = 0,                                 // the line is dropped and counted
+    LOG_OVERFLOW_WRITE = 1                                  // the caller writes the line itself
+};
+
+/**
+ * @brief writes the lines of the log files in a thread of its own
+ *
+ * Callers format their lines and only add them to a lock free queue. The writer thread takes
+ * all queued lines at once, writes them and flushes every touched file once per batch instead
+ * of once per line. Until Activate is called and after Deactivate lines are written by the caller.
+ */
+class LogWriter : public ACE_Task_Base
+{
+    public:
+        LogWriter();
+        ~LogWriter();
+
+        /**
+         * @brief starts the writer thread
+         *
+         * @param maxRecords lines queued at most, then the overflow policy applies
+         * @param overflow
+         * @param flushInterval milliseconds to wait for new lines while the queue is empty
+         * @return int -1 if the thread can't be started
+         */
+        int Activate(uint32 maxRecords, LogOverflowPolicy overflow, uint32 flushInterval);
+        /**
+         * @brief writes the lines still queued and stops the writer thread
+         *
+         */
+        void Deactivate();
+        bool IsActive() const { return m_active; }
+
+        /**
+         * @brief writes a formatted line, safe to call from any thread
+         *
+         * @param file
+         * @param text the complete line with timestamp and newline
+         */
+        void Write(FILE* file, std::string const& text);
+        /**
+         * @brief waits until all lines queued so far are written, so the files can be closed
+         *
+         */
+        void Flush();
+
+        int svc() override;
+
+    private:
+        struct Record
+        {
+            Record(FILE* f, std::string const& t) : file(f), text(t) {}
+
+            FILE* file;
+            std::string text;
+        };
+
+        /**
+         * @brief writes all queued lines and flushes the files they went to
+         *
+         * @return uint32 lines written
+         */
+        uint32 WriteQueued();
+
+        ACE_Based::MPSCQueue<Record*> m_queue;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_queued;     // added and not yet written
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_dropped;    // since the last report
+        uint32 m_maxRecords;
+        LogOverflowPolicy m_overflow;
+        uint32 m_flushInterval;
+        volatile bool m_active;
+        volatile bool m_stopping;
+};
+
+#endif
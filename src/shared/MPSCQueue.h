@@ -0,0 +1,197 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include "Platform/Define.h"
+
+namespace ACE_Based
+{
+    /**
+     * @brief Full barrier pointer exchange, compare and exchange and ordered pointer load/store used by MPSCQueue.
+     *
+     */
+    namespace MPSCQueueAtomic
+    {
+        template<class T>
+        inline T* Exchange(T* volatile* target, T* value)
+        {
+#if PLATFORM == PLATFORM_WINDOWS
+            return static_cast<T*>(InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(target), value));
+#else
+            __sync_synchronize();                           // __sync_lock_test_and_set is an acquire barrier only
+            return __sync_lock_test_and_set(target, value);
+#endif
+        }
+
+        template<class T>
+        inline T* CompareExchange(T* volatile* target, T* comparand, T* value)
+        {
+#if PLATFORM == PLATFORM_WINDOWS
+            return static_cast<T*>(InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(target), value, comparand));
+#else
+            return __sync_val_compare_and_swap(target, comparand, value);
+#endif
+        }
+
+        template<class T>
+        inline T* LoadAcquire(T* volatile const* source)
+        {
+            T* value = *source;
+#if PLATFORM != PLATFORM_WINDOWS
+            __sync_synchronize();
+#endif
+            return value;
+        }
+
+        template<class T>
+        inline void StoreRelease(T* volatile* target, T* value)
+        {
+#if PLATFORM != PLATFORM_WINDOWS
+            __sync_synchronize();
+#endif
+            *target = value;
+        }
+    }
+
+    template<class T>
+    /**
+     * @brief Unbounded multi producer single consumer queue without locks.
+     *
+     * Producers only exchange the head pointer, so adding never waits for the consumer or other producers.
+     * All next() calls must come from one thread at a time. Same interface as LockedQueue, so it can replace
+     * it where the queue is filled by network threads and drained by the world or a map update thread.
+     *
+     */
+    class MPSCQueue
+    {
+            /**
+             * @brief Queue node, the last consumed node stays in the queue as stub.
+             *
+             */
+            struct Node
+            {
+                Node() : next(NULL) {}
+                explicit Node(T const& i) : item(i), next(NULL) {}
+
+                T item;
+                Node* volatile next;
+            };
+
+            Node* volatile _head; /**< Last added node, written by producers. */
+            Node* _tail; /**< Stub node in front of the next item, owned by the consumer. */
+
+            MPSCQueue(MPSCQueue const&);
+            MPSCQueue& operator=(MPSCQueue const&);
+
+        public:
+
+            /**
+             * @brief Create an empty MPSCQueue.
+             *
+             */
+            MPSCQueue() : _head(new Node()), _tail(_head)
+            {
+            }
+
+            /**
+             * @brief Destroy a MPSCQueue, items still queued are dropped.
+             *
+             */
+            ~MPSCQueue()
+            {
+                T item;
+                while (next(item)) {}
+
+                delete _tail;
+            }
+
+            /**
+             * @brief Adds an item to the queue, safe to call from any thread.
+             *
+             * @param item
+             */
+            void add(T const& item)
+            {
+                Node* node = new Node(item);
+                Node* prev = MPSCQueueAtomic::Exchange(&_head, node);
+                MPSCQueueAtomic::StoreRelease(&prev->next, node);
+            }
+
+            /**
+             * @brief Gets the next item in the queue, if any.
+             *
+             * An item being added right now may not be seen yet, it is returned by a later call.
+             *
+             * @param result
+             * @return bool
+             */
+            bool next(T& result)
+            {
+                Node* next = MPSCQueueAtomic::LoadAcquire(&_tail->next);
+                if (!next)
+                    { return false; }
+
+                result = next->item;
+                delete _tail;
+                _tail = next;
+                return true;
+            }
+
+            template<class Checker>
+            /**
+             * @brief Gets the next item in the queue, if any and accepted by the checker.
+             *
+             * @param result
+             * @param check
+             * @return bool
+             */
+            bool next(T& result, Checker& check)
+            {
+                Node* next = MPSCQueueAtomic::LoadAcquire(&_tail->next);
+                if (!next)
+                    { return false; }
+
+                if (!check.Process(next->item))
+                    { return false; }
+
+                result = next->item;
+                delete _tail;
+                _tail = next;
+                return true;
+            }
+
+            /**
+             * @brief Checks if we're empty or not, only reliable in the consumer thread.
+             *
+             * @return bool
+             */
+            bool empty() const
+            {
+                return MPSCQueueAtomic::LoadAcquire(&_tail->next) == NULL;
+            }
+    };
+}
+#endif
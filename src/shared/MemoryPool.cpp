@@ -0,0 +1,232 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "MemoryPool.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+
+#define MEMORY_POOL_GRANULARITY     64                      // object sizes are rounded up to this
+#define MEMORY_POOL_SIZE_CLASSES    128                     // larger objects are not pooled
+#define MEMORY_POOL_SLAB_SIZE       (64 * 1024)
+#define MEMORY_POOL_SLAB_MIN_BLOCKS 4
+#define MEMORY_POOL_CACHE_SIZE      (64 * 1024)             // free block bytes a thread keeps per class
+
+/// Free block, linked through its first bytes
+struct MemoryPoolBlock
+{
+    MemoryPoolBlock* next;
+};
+
+/// Free blocks of one tag and size class, shared by the threads
+struct MemoryPoolClass
+{
+    MemoryPoolClass() : freeBlocks(NULL), freeCount(0) {}
+
+    ACE_Thread_Mutex lock;
+    MemoryPoolBlock* freeBlocks;
+    uint32 freeCount;
+};
+
+static MemoryPoolClass s_classes[MAX_MEMORY_TAG][MEMORY_POOL_SIZE_CLASSES];
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> s_slabBytes[MAX_MEMORY_TAG];
+
+static inline uint32 GetSizeClass(size_t size)
+{
+    return uint32((size + MEMORY_POOL_GRANULARITY - 1) / MEMORY_POOL_GRANULARITY) - 1;
+}
+
+static inline size_t GetBlockSize(uint32 sizeClass)
+{
+    return size_t(sizeClass + 1) * MEMORY_POOL_GRANULARITY;
+}
+
+static inline uint32 GetCacheLimit(uint32 sizeClass)
+{
+    return std::max(uint32(MEMORY_POOL_CACHE_SIZE / GetBlockSize(sizeClass)), uint32(2));
+}
+
+/**
+ * @brief moves count blocks from the front of a list to the shared list of the class
+ *
+ * @param tag
+ * @param sizeClass
+ * @param blocks
+ * @param count not more than the list holds
+ */
+static void ReleaseBlocks(uint32 tag, uint32 sizeClass, MemoryPoolBlock*& blocks, uint32 count)
+{
+    if (!count)
+        { return; }
+
+    MemoryPoolBlock* first = blocks;
+    MemoryPoolBlock* last = first;
+    for (uint32 i = 1; i < count; ++i)
+        { last = last->next; }
+
+    blocks = last->next;
+
+    MemoryPoolClass& poolClass = s_classes[tag][sizeClass];
+    ACE_GUARD(ACE_Thread_Mutex, guard, poolClass.lock);
+    last->next = poolClass.freeBlocks;
+    poolClass.freeBlocks = first;
+    poolClass.freeCount += count;
+}
+
+/// Free blocks of one thread by tag and size class
+struct MemoryPoolCache
+{
+    MemoryPoolCache()
+    {
+        memset(blocks, 0, sizeof(blocks));
+        memset(counts, 0, sizeof(counts));
+    }
+
+    // blocks of an ending thread are left to the others
+    ~MemoryPoolCache()
+    {
+        for (uint32 tag = 0; tag < MAX_MEMORY_TAG; ++tag)
+        {
+            for (uint32 sizeClass = 0; sizeClass < MEMORY_POOL_SIZE_CLASSES; ++sizeClass)
+                { ReleaseBlocks(tag, sizeClass, blocks[tag][sizeClass], counts[tag][sizeClass]); }
+        }
+    }
+
+    MemoryPoolBlock* blocks[MAX_MEMORY_TAG][MEMORY_POOL_SIZE_CLASSES];
+    uint32 counts[MAX_MEMORY_TAG][MEMORY_POOL_SIZE_CLASSES];
+};
+
+typedef ACE_TSS<MemoryPoolCache> MemoryPoolCacheTSS;
+static MemoryPoolCacheTSS s_cache;
+
+/**
+ * @brief fills an empty list of a thread with half its limit from the shared list, or with a new slab
+ *
+ * @param tag
+ * @param sizeClass
+ * @param blocks
+ * @return uint32 blocks in the list now
+ */
+static uint32 RefillBlocks(uint32 tag, uint32 sizeClass, MemoryPoolBlock*& blocks)
+{
+    uint32 batch = std::max(GetCacheLimit(sizeClass) / 2, uint32(1));
+
+    {
+        MemoryPoolClass& poolClass = s_classes[tag][sizeClass];
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, poolClass.lock, 0);
+
+        if (poolClass.freeCount)
+        {
+            uint32 count = std::min(batch, poolClass.freeCount);
+            MemoryPoolBlock* last = poolClass.freeBlocks;
+            for (uint32 i = 1; i < count; ++i)
+                { last = last->next; }
+
+            blocks = poolClass.freeBlocks;
+            poolClass.freeBlocks = last->next;
+            poolClass.freeCount -= count;
+            last->next = NULL;
+            return count;
+        }
+    }
+
+    size_t blockSize = GetBlockSize(sizeClass);
+    uint32 count = std::max(uint32(MEMORY_POOL_SLAB_SIZE / blockSize), uint32(MEMORY_POOL_SLAB_MIN_BLOCKS));
+    char* slab = static_cast<char*>(::operator new(count * blockSize));
+    s_slabBytes[tag] += long(count * blockSize);
+
+    blocks = NULL;
+    for (uint32 i = count; i > 0; --i)
+    {
+        MemoryPoolBlock* block = reinterpret_cast<MemoryPoolBlock*>(slab + (i - 1) * blockSize);
+        block->next = blocks;
+        blocks = block;
+    }
+
+    return count;
+}
+
+void* MemoryPool::Allocate(MemoryTag tag, size_t size)
+{
+    uint32 sizeClass = GetSizeClass(size);
+    if (sizeClass >= MEMORY_POOL_SIZE_CLASSES)
+        { return ::operator new(size); }
+
+    MemoryPoolCache* cache = s_cache;                       // created at the first use of the thread
+    MemoryPoolBlock*& blocks = cache->blocks[tag][sizeClass];
+    uint32& count = cache->counts[tag][sizeClass];
+    if (!count)
+        { count = RefillBlocks(tag, sizeClass, blocks); }
+
+    MemoryPoolBlock* block = blocks;
+    blocks = block->next;
+    --count;
+    return block;
+}
+
+void MemoryPool::Free(MemoryTag tag, void* ptr, size_t size)
+{
+    uint32 sizeClass = GetSizeClass(size);
+    if (sizeClass >= MEMORY_POOL_SIZE_CLASSES)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    // an object may be freed by another thread than it was allocated by, that thread takes the block
+    MemoryPoolCache* cache = s_cache;
+    MemoryPoolBlock*& blocks = cache->blocks[tag][sizeClass];
+    uint32& count = cache->counts[tag][sizeClass];
+
+    MemoryPoolBlock* block = static_cast<MemoryPoolBlock*>(ptr);
+    block->next = blocks;
+    blocks = block;
+
+    if (++count > GetCacheLimit(sizeClass))
+    {
+        uint32 released = count / 2;
+        ReleaseBlocks(tag, sizeClass, blocks, released);
+        count -= released;
+    }
+}
+
+uint64 MemoryPool::GetSlabBytes(MemoryTag tag)
+{
+    return uint64(s_slabBytes[tag].value());
+}
+
+uint64 MemoryPool::GetFreeBytes(MemoryTag tag)
+{
+    uint64 bytes = 0;
+    for (uint32 sizeClass = 0; sizeClass < MEMORY_POOL_SIZE_CLASSES; ++sizeClass)
+    {
+        MemoryPoolClass& poolClass = s_classes[tag][sizeClass];
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, poolClass.lock, bytes);
+        bytes += uint64(poolClass.freeCount) * GetBlockSize(sizeClass);
+    }
+
+    return bytes;
+}
@@ -0,0 +1,103 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOSSERVER_MEMORYPOOL_H
+#define MANGOSSERVER_MEMORYPOOL_H
+
+#include "MemoryTracker.h"
+
+/**
+ * @brief slab pools of the objects allocated and freed all the time during play, by tag
+ *
+ * The objects of a tag are rounded up to size classes and carved from slabs only ever holding
+ * objects of that tag and class. Slabs are not given back, a freed object leaves a block for the
+ * next of its kind instead of a hole in the heap. Every thread keeps a few free blocks per class,
+ * taking and returning them in batches from lists shared by the threads.
+ */
+class MemoryPool
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param tag
+         * @param size
+         * @return void a block of at least size bytes, from the heap for objects too large to pool
+         */
+        static void* Allocate(MemoryTag tag, size_t size);
+
+        /**
+         * @brief
+         *
+         * @param tag
+         * @param ptr
+         * @param size the size passed to Allocate
+         */
+        static void Free(MemoryTag tag, void* ptr, size_t size);
+
+        /**
+         * @brief bytes of the slabs of the tag
+         *
+         * @param tag
+         * @return uint64
+         */
+        static uint64 GetSlabBytes(MemoryTag tag);
+
+        /**
+         * @brief bytes of the free blocks in the shared lists of the tag, the threads keep a few more
+         *
+         * @param tag
+         * @return uint64
+         */
+        static uint64 GetFreeBytes(MemoryTag tag);
+};
+
+/**
+ * @brief base class counting the objects of a class under a tag, allocated from the pools of the tag
+ *
+ * The size passed to the class specific operator delete is the one of the dynamic type for
+ * classes with a virtual destructor, so derived classes are counted with their full size.
+ */
+template<MemoryTag TAG>
+class MemoryTracked
+{
+    public:
+        static void* operator new(size_t size)
+        {
+            void* p = MemoryPool::Allocate(TAG, size);
+            MemoryTracker::Allocate(TAG, size);
+            return p;
+        }
+
+        static void operator delete(void* p, size_t size)
+        {
+            if (!p)
+                { return; }
+
+            MemoryTracker::Free(TAG, size);
+            MemoryPool::Free(TAG, p, size);
+        }
+};
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "MemoryTracker.h"
+#include "Metrics.h"
+#include "Threading.h"
+
+#include <ace/OS_NS_stdio.h>
+#include <ace/OS_NS_unistd.h>
+
+/// Counters of all tags for the threads of one shard, padded to cache lines of their own
+struct MemoryTrackerShard
+{
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> liveBytes[MAX_MEMORY_TAG];
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> liveCount[MAX_MEMORY_TAG];
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> allocatedBytes[MAX_MEMORY_TAG];
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> allocations[MAX_MEMORY_TAG];
+    char pad[64];
+};
+
+static MemoryTrackerShard s_shards[METRIC_SHARDS];
+
+static char const* const s_tagNames[MAX_MEMORY_TAG] =
+{
+    "bytebuffer",
+    "packet",
+    "updatedata",
+    "queryresult",
+    "sqlstorage",
+    "creature",
+    "gameobject",
+    "player",
+    "auraholder",
+    "aura",
+    "dynobject",
+    "spell",
+    "event",
+    "gridmap",
+    "vmap",
+    "mmap"
+};
+
+static MemoryTrackerShard& GetShard()
+{
+    uint64 id = uint64(size_t(ACE_Based::Thread::currentId()));
+    return s_shards[uint32((id * UI64LIT(0x9E3779B97F4A7C15)) >> 60) % METRIC_SHARDS];
+}
+
+void MemoryTracker::Allocate(MemoryTag tag, size_t bytes, uint32 count /*= 1*/)
+{
+    MemoryTrackerShard& shard = GetShard();
+    shard.liveBytes[tag] += long(bytes);
+    shard.liveCount[tag] += long(count);
+    shard.allocatedBytes[tag] += long(bytes);
+    shard.allocations[tag] += long(count);
+}
+
+void MemoryTracker::Free(MemoryTag tag, size_t bytes, uint32 count /*= 1*/)
+{
+    // freed by another thread than the allocating one a shard goes below 0, the sum is right
+    MemoryTrackerShard& shard = GetShard();
+    shard.liveBytes[tag] -= long(bytes);
+    shard.liveCount[tag] -= long(count);
+}
+
+void MemoryTracker::GetStats(MemoryTag tag, MemoryTagStats& stats)
+{
+    stats = MemoryTagStats();
+
+    for (uint32 i = 0; i < METRIC_SHARDS; ++i)
+    {
+        MemoryTrackerShard const& shard = s_shards[i];
+        stats.liveBytes += shard.liveBytes[tag].value();
+        stats.liveCount += shard.liveCount[tag].value();
+        stats.allocatedBytes += uint64(shard.allocatedBytes[tag].value());
+        stats.allocations += uint64(shard.allocations[tag].value());
+    }
+}
+
+char const* MemoryTracker::GetTagName(MemoryTag tag)
+{
+    return tag < MAX_MEMORY_TAG ? s_tagNames[tag] : "unknown";
+}
+
+uint64 MemoryTracker::GetProcessMemory()
+{
+#if defined(__linux__)
+    FILE* file = ACE_OS::fopen("/proc/self/statm", "r");
+    if (!file)
+        { return 0; }
+
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int read = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+
+    return read == 2 ? uint64(resident) * uint64(ACE_OS::getpagesize()) : 0;
+#else
+    return 0;
+#endif
+}
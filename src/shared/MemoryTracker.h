@@ -0,0 +1,104 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOSSERVER_MEMORYTRACKER_H
+#define MANGOSSERVER_MEMORYTRACKER_H
+
+#include "Common.h"
+
+/**
+ * @brief subsystems the memory is counted for, see MemoryTracker
+ *
+ */
+enum MemoryTag
+{
+    MEM_TAG_BYTEBUFFER = 0,                                 // storage of buffers not tagged otherwise
+    MEM_TAG_PACKET,                                         // WorldPacket storage
+    MEM_TAG_UPDATEDATA,                                     // UpdateData buffers
+    MEM_TAG_QUERYRESULT,                                    // QueryResult objects, not the rows of the client library
+    MEM_TAG_SQLSTORAGE,                                     // SQLStorage records and indexes
+    MEM_TAG_CREATURE,                                       // Creature objects, pets included
+    MEM_TAG_GAMEOBJECT,
+    MEM_TAG_PLAYER,
+    MEM_TAG_AURAHOLDER,                                     // SpellAuraHolder objects
+    MEM_TAG_AURA,
+    MEM_TAG_DYNOBJECT,                                      // DynamicObject objects
+    MEM_TAG_SPELL,                                          // Spell objects
+    MEM_TAG_EVENT,                                          // BasicEvent objects of the game
+    MEM_TAG_GRIDMAP,                                        // terrain data of the loaded grids
+    MEM_TAG_VMAP,                                           // loaded model files
+    MEM_TAG_MMAP,                                           // loaded navigation mesh tiles
+    MAX_MEMORY_TAG
+};
+
+/**
+ * @brief counted memory of one tag
+ *
+ */
+struct MemoryTagStats
+{
+    MemoryTagStats() : liveBytes(0), liveCount(0), allocatedBytes(0), allocations(0) {}
+
+    int64 liveBytes;
+    int64 liveCount;                                        // allocations not freed yet
+    uint64 allocatedBytes;                                  // since start
+    uint64 allocations;                                     // since start
+};
+
+/**
+ * @brief counts live bytes and allocations of the major memory pools by subsystem
+ *
+ * The pools report their allocations and frees themselves, objects by deriving from MemoryTracked,
+ * buffers and loaded files where they are allocated. The counters are split by thread like the
+ * metrics, so counting costs an atomic add on a cache line seldom shared. Memory not counted
+ * here is the difference of the sum of all tags to the resident size of the process.
+ */
+class MemoryTracker
+{
+    public:
+        /**
+         * @brief counts an allocation
+         *
+         * @param tag
+         * @param bytes
+         * @param count allocations the bytes are made of, 0 to grow an allocation counted before
+         */
+        static void Allocate(MemoryTag tag, size_t bytes, uint32 count = 1);
+        static void Free(MemoryTag tag, size_t bytes, uint32 count = 1);
+
+        static void GetStats(MemoryTag tag, MemoryTagStats& stats);
+        static char const* GetTagName(MemoryTag tag);
+
+        /**
+         * @brief resident memory of the process
+         *
+         * @return uint64 bytes, 0 where not supported
+         */
+        static uint64 GetProcessMemory();
+};
+
+// MemoryTracked, the base class of counted objects, takes them from the pools
+#include "MemoryPool.h"
+
+#endif
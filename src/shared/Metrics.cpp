@@ -0,0 +1,489 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "Metrics.h"
+#include "Log.h"
+#include "Threading.h"
+
+#include <ace/SOCK_Stream.h>
+#include <ace/OS_NS_unistd.h>
+
+/**
+ * @brief shard of the calling thread, the thread ids are hashed as they are often aligned addresses
+ *
+ * @return uint32
+ */
+static uint32 GetShardIndex()
+{
+    uint64 id = uint64(size_t(ACE_Based::Thread::currentId()));
+    return uint32((id * UI64LIT(0x9E3779B97F4A7C15)) >> 60) % METRIC_SHARDS;
+}
+
+// -------------------------------------  MetricCounter  --------------------------------------- //
+
+void MetricCounter::Add(long value /*= 1*/)
+{
+    m_shards[GetShardIndex()].value += value;
+}
+
+uint64 MetricCounter::GetValue() const
+{
+    uint64 value = 0;
+    for (uint32 i = 0; i < METRIC_SHARDS; ++i)
+        { value += uint64(m_shards[i].value.value()); }
+
+    return value;
+}
+
+// ------------------------------------  MetricHistogram  -------------------------------------- //
+
+MetricHistogram::MetricHistogram(uint32 const* bounds, uint32 boundCount) :
+    m_boundCount(std::min(boundCount, uint32(METRIC_MAX_BUCKETS - 1)))
+{
+    for (uint32 i = 0; i < m_boundCount; ++i)
+        { m_bounds[i] = bounds[i]; }
+}
+
+void MetricHistogram::Add(uint32 value)
+{
+    uint32 bucket = 0;
+    while (bucket < m_boundCount && value > m_bounds[bucket])
+        { ++bucket; }
+
+    Shard& shard = m_shards[GetShardIndex()];
+    ++shard.buckets[bucket];
+    shard.sum += long(value);
+}
+
+uint64 MetricHistogram::GetBucketValue(uint32 bucket) const
+{
+    uint64 value = 0;
+    for (uint32 i = 0; i < METRIC_SHARDS; ++i)
+        { value += uint64(m_shards[i].buckets[bucket].value()); }
+
+    return value;
+}
+
+uint64 MetricHistogram::GetCount() const
+{
+    uint64 value = 0;
+    for (uint32 bucket = 0; bucket <= m_boundCount; ++bucket)
+        { value += GetBucketValue(bucket); }
+
+    return value;
+}
+
+uint64 MetricHistogram::GetSum() const
+{
+    uint64 value = 0;
+    for (uint32 i = 0; i < METRIC_SHARDS; ++i)
+        { value += uint64(m_shards[i].sum.value()); }
+
+    return value;
+}
+
+// ----------------------------------------  Metrics  ------------------------------------------ //
+
+Metrics& Metrics::Instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::~Metrics()
+{
+    for (EntryMap::iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr)
+    {
+        switch (itr->second.type)
+        {
+            case METRIC_COUNTER:   delete static_cast<MetricCounter*>(itr->second.metric);   break;
+            case METRIC_GAUGE:     delete static_cast<MetricGauge*>(itr->second.metric);     break;
+            case METRIC_HISTOGRAM: delete static_cast<MetricHistogram*>(itr->second.metric); break;
+        }
+    }
+}
+
+Metrics::Entry* Metrics::Find(MetricType type, char const* name, char const* help, char const* labelName, std::string const& labelValue, bool& created)
+{
+    EntryKey key(name, labelName ? labelValue : "");
+
+    EntryMap::iterator itr = m_entries.find(key);
+    if (itr != m_entries.end())
+    {
+        created = false;
+        return itr->second.type == type ? &itr->second : NULL;
+    }
+
+    Entry& entry = m_entries[key];
+    entry.type = type;
+    entry.help = help;
+    entry.labelName = labelName ? labelName : "";
+    entry.metric = NULL;
+    entry.pushedCount = 0;
+    entry.pushedSum = 0;
+
+    created = true;
+    return &entry;
+}
+
+MetricCounter* Metrics::GetCounter(char const* name, char const* help, char const* labelName /*= NULL*/, std::string const& labelValue /*= ""*/)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+
+    bool created;
+    Entry* entry = Find(METRIC_COUNTER, name, help, labelName, labelValue, created);
+    if (!entry)
+        { return NULL; }
+
+    if (created)
+        { entry->metric = new MetricCounter(); }
+
+    return static_cast<MetricCounter*>(entry->metric);
+}
+
+MetricGauge* Metrics::GetGauge(char const* name, char const* help, char const* labelName /*= NULL*/, std::string const& labelValue /*= ""*/)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+
+    bool created;
+    Entry* entry = Find(METRIC_GAUGE, name, help, labelName, labelValue, created);
+    if (!entry)
+        { return NULL; }
+
+    if (created)
+        { entry->metric = new MetricGauge(); }
+
+    return static_cast<MetricGauge*>(entry->metric);
+}
+
+MetricHistogram* Metrics::GetHistogram(char const* name, char const* help, uint32 const* bounds, uint32 boundCount,
+                                       char const* labelName /*= NULL*/, std::string const& labelValue /*= ""*/)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+
+    bool created;
+    Entry* entry = Find(METRIC_HISTOGRAM, name, help, labelName, labelValue, created);
+    if (!entry)
+        { return NULL; }
+
+    if (created)
+        { entry->metric = new MetricHistogram(bounds, boundCount); }
+
+    return static_cast<MetricHistogram*>(entry->metric);
+}
+
+/**
+ * @brief label list of a Prometheus sample
+ *
+ */
+static std::string FormatLabels(std::string const& labelName, std::string const& labelValue, char const* le = NULL)
+{
+    std::string labels;
+    if (!labelName.empty())
+    {
+        labels = labelName + "=\"";
+        for (std::string::const_iterator itr = labelValue.begin(); itr != labelValue.end(); ++itr)
+        {
+            if (*itr == '"' || *itr == '\\')
+                { labels += '\\'; }
+            labels += *itr;
+        }
+        labels += '"';
+    }
+
+    if (le)
+        { labels += std::string(labels.empty() ? "" : ",") + "le=\"" + le + "\""; }
+
+    return labels.empty() ? labels : "{" + labels + "}";
+}
+
+void Metrics::WritePrometheus(std::string const& prefix, std::string& out) const
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    char buf[64];
+    std::string lastName;
+    for (EntryMap::const_iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr)
+    {
+        Entry const& entry = itr->second;
+        std::string name = prefix + itr->first.first;
+        std::string const& labelValue = itr->first.second;
+
+        // the entries of a family follow each other in the map
+        if (name != lastName)
+        {
+            static char const* typeNames[] = { "counter", "gauge", "histogram" };
+            out += "# HELP " + name + " " + entry.help + "\n";
+            out += "# TYPE " + name + " " + typeNames[entry.type] + "\n";
+            lastName = name;
+        }
+
+        switch (entry.type)
+        {
+            case METRIC_COUNTER:
+                snprintf(buf, sizeof(buf), " " UI64FMTD "\n", static_cast<MetricCounter const*>(entry.metric)->GetValue());
+                out += name + FormatLabels(entry.labelName, labelValue) + buf;
+                break;
+            case METRIC_GAUGE:
+                snprintf(buf, sizeof(buf), " %ld\n", static_cast<MetricGauge const*>(entry.metric)->GetValue());
+                out += name + FormatLabels(entry.labelName, labelValue) + buf;
+                break;
+            case METRIC_HISTOGRAM:
+            {
+                MetricHistogram const* histogram = static_cast<MetricHistogram const*>(entry.metric);
+
+                uint64 cumulative = 0;
+                for (uint32 bucket = 0; bucket < histogram->GetBucketCount(); ++bucket)
+                {
+                    char le[16];
+                    if (bucket + 1 < histogram->GetBucketCount())
+                        { snprintf(le, sizeof(le), "%u", histogram->GetBound(bucket)); }
+                    else
+                        { snprintf(le, sizeof(le), "+Inf"); }
+
+                    cumulative += histogram->GetBucketValue(bucket);
+                    snprintf(buf, sizeof(buf), " " UI64FMTD "\n", cumulative);
+                    out += name + "_bucket" + FormatLabels(entry.labelName, labelValue, le) + buf;
+                }
+
+                snprintf(buf, sizeof(buf), " " UI64FMTD "\n", histogram->GetSum());
+                out += name + "_sum" + FormatLabels(entry.labelName, labelValue) + buf;
+                snprintf(buf, sizeof(buf), " " UI64FMTD "\n", cumulative);
+                out += name + "_count" + FormatLabels(entry.labelName, labelValue) + buf;
+                break;
+            }
+        }
+    }
+}
+
+void Metrics::WriteStatsD(std::string const& prefix, std::vector<std::string>& lines)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    char buf[64];
+    for (EntryMap::iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr)
+    {
+        Entry& entry = itr->second;
+
+        // StatsD has no labels, the label value becomes the last part of the name
+        std::string name = prefix + itr->first.first;
+        if (!entry.labelName.empty())
+            { name += "." + itr->first.second; }
+
+        switch (entry.type)
+        {
+            case METRIC_COUNTER:
+            {
+                uint64 value = static_cast<MetricCounter const*>(entry.metric)->GetValue();
+                snprintf(buf, sizeof(buf), ":" UI64FMTD "|c", value - entry.pushedCount);
+                lines.push_back(name + buf);
+                entry.pushedCount = value;
+                break;
+            }
+            case METRIC_GAUGE:
+                snprintf(buf, sizeof(buf), ":%ld|g", static_cast<MetricGauge const*>(entry.metric)->GetValue());
+                lines.push_back(name + buf);
+                break;
+            case METRIC_HISTOGRAM:
+            {
+                MetricHistogram const* histogram = static_cast<MetricHistogram const*>(entry.metric);
+                uint64 count = histogram->GetCount();
+                uint64 sum = histogram->GetSum();
+
+                snprintf(buf, sizeof(buf), ".count:" UI64FMTD "|c", count - entry.pushedCount);
+                lines.push_back(name + buf);
+                snprintf(buf, sizeof(buf), ".sum:" UI64FMTD "|c", sum - entry.pushedSum);
+                lines.push_back(name + buf);
+
+                entry.pushedCount = count;
+                entry.pushedSum = sum;
+                break;
+            }
+        }
+    }
+}
+
+// ------------------------------------  MetricsExporter  -------------------------------------- //
+
+#define METRICS_MAX_DATAGRAM        1400                    // StatsD lines per datagram stay below the usual MTU
+
+MetricsExporter::MetricsExporter() :
+    m_listening(false), m_pushing(false), m_pushInterval(0), m_active(false), m_stopping(false)
+{
+}
+
+MetricsExporter& MetricsExporter::Instance()
+{
+    static MetricsExporter exporter;
+    return exporter;
+}
+
+int MetricsExporter::Activate(uint16 port, std::string const& bindIp, std::string const& statsdAddress, uint32 pushInterval, std::string const& prefix)
+{
+    if (m_active || (!port && statsdAddress.empty()))
+        { return 0; }
+
+    m_prefix = prefix;
+    m_pushInterval = pushInterval ? pushInterval : 1;
+
+    if (port)
+    {
+        ACE_INET_Addr addr(port, bindIp.c_str());
+        if (m_acceptor.open(addr, 1) == -1)
+        {
+            sLog.outError("MetricsExporter: can't listen on port %u, metrics are not served to Prometheus", uint32(port));
+            return -1;
+        }
+
+        m_listening = true;
+    }
+
+    if (!statsdAddress.empty())
+    {
+        size_t colon = statsdAddress.find_last_of(':');
+        if (colon == std::string::npos || m_statsdAddr.set(uint16(atoi(statsdAddress.c_str() + colon + 1)), statsdAddress.substr(0, colon).c_str()) == -1 ||
+            m_statsdSocket.open(ACE_Addr::sap_any) == -1)
+        {
+            sLog.outError("MetricsExporter: invalid StatsD address %s, metrics are not pushed", statsdAddress.c_str());
+            if (m_listening)
+                { m_acceptor.close(); }
+            m_listening = false;
+            return -1;
+        }
+
+        m_pushing = true;
+    }
+
+    m_stopping = false;
+
+    if (activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1)
+    {
+        sLog.outError("MetricsExporter: can't start the thread, metrics are not exported");
+        Deactivate();
+        return -1;
+    }
+
+    m_active = true;
+    return 0;
+}
+
+void MetricsExporter::Deactivate()
+{
+    if (m_active)
+    {
+        m_stopping = true;
+        ACE_Task_Base::wait();
+        m_active = false;
+    }
+
+    if (m_listening)
+        { m_acceptor.close(); }
+
+    if (m_pushing)
+        { m_statsdSocket.close(); }
+
+    m_listening = false;
+    m_pushing = false;
+}
+
+void MetricsExporter::ServeRequest()
+{
+    ACE_SOCK_Stream stream;
+    ACE_Time_Value timeout(1);
+    if (m_acceptor.accept(stream, NULL, &timeout) == -1)
+        { return; }
+
+    // the request is not parsed, every path gets the metrics
+    char buf[4096];
+    size_t received = 0;
+    while (received < sizeof(buf))
+    {
+        ACE_Time_Value readTimeout(1);
+        ssize_t size = stream.recv(buf + received, sizeof(buf) - received, &readTimeout);
+        if (size <= 0)
+            { break; }
+
+        received += size_t(size);
+        if (std::string(buf, received).find("\r\n\r\n") != std::string::npos)
+            { break; }
+    }
+
+    std::string body;
+    sMetrics.WritePrometheus(m_prefix + "_", body);
+
+    char header[192];
+    snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " SIZEFMTD "\r\nConnection: close\r\n\r\n", body.size());
+
+    ACE_Time_Value sendTimeout(5);
+    if (stream.send_n(header, strlen(header), &sendTimeout) != -1)
+        { stream.send_n(body.data(), body.size(), &sendTimeout); }
+
+    stream.close();
+}
+
+void MetricsExporter::PushStatsD()
+{
+    std::vector<std::string> lines;
+    sMetrics.WriteStatsD(m_prefix + ".", lines);
+
+    std::string datagram;
+    for (std::vector<std::string>::const_iterator itr = lines.begin(); itr != lines.end(); ++itr)
+    {
+        if (!datagram.empty() && datagram.size() + itr->size() + 1 > METRICS_MAX_DATAGRAM)
+        {
+            m_statsdSocket.send(datagram.data(), datagram.size(), m_statsdAddr);
+            datagram.clear();
+        }
+
+        if (!datagram.empty())
+            { datagram += '\n'; }
+        datagram += *itr;
+    }
+
+    if (!datagram.empty())
+        { m_statsdSocket.send(datagram.data(), datagram.size(), m_statsdAddr); }
+}
+
+int MetricsExporter::svc()
+{
+    time_t nextPush = time(NULL) + m_pushInterval;
+
+    while (!m_stopping)
+    {
+        // waits up to a second for a connection
+        if (m_listening)
+            { ServeRequest(); }
+        else
+            { ACE_OS::sleep(1); }
+
+        if (m_pushing && time(NULL) >= nextPush)
+        {
+            PushStatsD();
+            nextPush = time(NULL) + m_pushInterval;
+        }
+    }
+
+    return 0;
+}
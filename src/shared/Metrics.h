@@ -0,0 +1,238 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOSSERVER_METRICS_H
+#define MANGOSSERVER_METRICS_H
+
+#include "Common.h"
+
+#include <ace/Task.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/SOCK_Acceptor.h>
+#include <ace/SOCK_Dgram.h>
+#include <ace/INET_Addr.h>
+
+#include <map>
+#include <vector>
+
+#define METRIC_SHARDS               16                      // counters are split so threads seldom share a cache line
+#define METRIC_MAX_BUCKETS          16
+
+/**
+ * @brief one shard of a sharded value, padded to a cache line of its own
+ *
+ */
+struct MetricShard
+{
+    MetricShard() : value(0) {}
+
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> value;
+    char pad[64];
+};
+
+/**
+ * @brief monotonic counter, safe to add to from any thread
+ *
+ */
+class MetricCounter
+{
+    public:
+        void Add(long value = 1);
+        uint64 GetValue() const;
+
+    private:
+        MetricShard m_shards[METRIC_SHARDS];
+};
+
+/**
+ * @brief value set by one thread, like a queue length
+ *
+ */
+class MetricGauge
+{
+    public:
+        MetricGauge() : m_value(0) {}
+
+        void Set(long value) { m_value = value; }
+        long GetValue() const { return m_value.value(); }
+
+    private:
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_value;
+};
+
+/**
+ * @brief distribution of values, like the duration of updates in ms, in buckets with fixed upper limits
+ *
+ */
+class MetricHistogram
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param bounds ascending upper limits of the buckets, a last open one is added
+         * @param boundCount at most METRIC_MAX_BUCKETS - 1
+         */
+        MetricHistogram(uint32 const* bounds, uint32 boundCount);
+
+        void Add(uint32 value);
+
+        uint32 GetBucketCount() const { return m_boundCount + 1; }
+        /// upper limit of the bucket, 0 for the last open one
+        uint32 GetBound(uint32 bucket) const { return bucket < m_boundCount ? m_bounds[bucket] : 0; }
+        uint64 GetBucketValue(uint32 bucket) const;
+        uint64 GetCount() const;
+        uint64 GetSum() const;
+
+    private:
+        struct Shard
+        {
+            Shard() : sum(0) {}
+
+            ACE_Atomic_Op<ACE_Thread_Mutex, long> buckets[METRIC_MAX_BUCKETS];
+            ACE_Atomic_Op<ACE_Thread_Mutex, long> sum;
+            char pad[64];
+        };
+
+        uint32 m_bounds[METRIC_MAX_BUCKETS];
+        uint32 m_boundCount;
+        Shard m_shards[METRIC_SHARDS];
+};
+
+/**
+ * @brief named metrics of the process, written in the Prometheus text format or as StatsD lines
+ *
+ * Metrics are created on first request and live as long as the registry, so callers keep the returned
+ * pointer and update it without any lock. A metric may have one label, metrics of the same name
+ * and different label values are written as one family.
+ */
+class Metrics
+{
+    public:
+        static Metrics& Instance();
+        ~Metrics();
+
+        MetricCounter* GetCounter(char const* name, char const* help, char const* labelName = NULL, std::string const& labelValue = "");
+        MetricGauge* GetGauge(char const* name, char const* help, char const* labelName = NULL, std::string const& labelValue = "");
+        MetricHistogram* GetHistogram(char const* name, char const* help, uint32 const* bounds, uint32 boundCount,
+                                      char const* labelName = NULL, std::string const& labelValue = "");
+
+        /**
+         * @brief all metrics in the Prometheus text exposition format
+         *
+         * @param prefix in front of every metric name
+         * @param out
+         */
+        void WritePrometheus(std::string const& prefix, std::string& out) const;
+        /**
+         * @brief all metrics as StatsD lines, counters as the change since the last call
+         *
+         * @param prefix
+         * @param lines
+         */
+        void WriteStatsD(std::string const& prefix, std::vector<std::string>& lines);
+
+    private:
+        Metrics() {}
+
+        enum MetricType
+        {
+            METRIC_COUNTER,
+            METRIC_GAUGE,
+            METRIC_HISTOGRAM
+        };
+
+        struct Entry
+        {
+            MetricType type;
+            std::string help;
+            std::string labelName;
+            void* metric;
+            uint64 pushedCount;                             // value at the last StatsD push
+            uint64 pushedSum;
+        };
+
+        typedef std::pair<std::string, std::string> EntryKey;   // name, label value
+        typedef std::map<EntryKey, Entry> EntryMap;
+
+        Entry* Find(MetricType type, char const* name, char const* help, char const* labelName, std::string const& labelValue, bool& created);
+
+        mutable ACE_Thread_Mutex m_lock;
+        EntryMap m_entries;
+};
+
+#define sMetrics Metrics::Instance()
+
+/**
+ * @brief serves the metrics to Prometheus and pushes them to StatsD, enabled by Metrics.PrometheusPort and Metrics.StatsDAddress
+ *
+ * One thread answers every HTTP request on the Prometheus port with the metrics and sends the StatsD
+ * datagrams every push interval.
+ */
+class MetricsExporter : protected ACE_Task_Base
+{
+    public:
+        static MetricsExporter& Instance();
+
+        /**
+         * @brief starts the exporter thread if any output is set
+         *
+         * @param port Prometheus HTTP port, 0 for none
+         * @param bindIp
+         * @param statsdAddress "host:port", empty for none
+         * @param pushInterval seconds between the StatsD pushes
+         * @param prefix in front of every metric name
+         * @return int -1 if a socket or the thread can't be opened
+         */
+        int Activate(uint16 port, std::string const& bindIp, std::string const& statsdAddress, uint32 pushInterval, std::string const& prefix);
+        /// Stops and joins the thread
+        void Deactivate();
+        bool IsActive() const { return m_active; }
+
+    protected:
+        int svc() override;
+
+    private:
+        MetricsExporter();
+
+        void ServeRequest();
+        void PushStatsD();
+
+        ACE_SOCK_Acceptor m_acceptor;
+        bool m_listening;
+        ACE_SOCK_Dgram m_statsdSocket;
+        ACE_INET_Addr m_statsdAddr;
+        bool m_pushing;
+        uint32 m_pushInterval;
+        std::string m_prefix;
+
+        bool m_active;
+        volatile bool m_stopping;
+};
+
+#define sMetricsExporter MetricsExporter::Instance()
+
+#endif
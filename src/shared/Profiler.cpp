@@ -0,0 +1,284 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "Profiler.h"
+#include "Log.h"
+
+#include <ace/OS_NS_sys_time.h>
+#include <ace/Guard_T.h>
+
+#include <algorithm>
+#include <cstdio>
+
+volatile bool TickProfiler::s_recording = false;
+
+// ----------------------------------  ProfilerThreadBuffer  ----------------------------------- //
+
+ProfilerThreadBuffer::ProfilerThreadBuffer() : m_events(NULL), m_count(0), m_recording(0), m_threadId(0), m_threadName(NULL),
+    m_activity(NULL), m_activityId(0)
+{
+    m_threadId = sTickProfiler.RegisterThread(this);
+}
+
+ProfilerThreadBuffer::~ProfilerThreadBuffer()
+{
+    sTickProfiler.UnregisterThread(this);
+    delete[] m_events;
+}
+
+void ProfilerThreadBuffer::Add(char const* name, uint64 start, uint32 duration, uint32 id, uint32 recording)
+{
+    if (!m_events)
+        { m_events = new ProfilerEvent[PROFILER_BUFFER_EVENTS]; }
+
+    // the first event of a new recording drops the events of the last one
+    if (m_recording != recording)
+    {
+        m_count = 0;
+        m_recording = recording;
+    }
+
+    ProfilerEvent& event = m_events[m_count % PROFILER_BUFFER_EVENTS];
+    event.name = name;
+    event.start = start;
+    event.duration = duration;
+    event.id = id;
+    ++m_count;                                              // counted after writing, the event is complete for readers
+}
+
+void ProfilerThreadBuffer::CollectEvents(std::vector<ProfilerEvent>& events) const
+{
+    if (!m_events)
+        { return; }
+
+    uint32 count = m_count;
+    uint32 first = count > PROFILER_BUFFER_EVENTS ? count - PROFILER_BUFFER_EVENTS : 0;
+    for (uint32 i = first; i < count; ++i)
+        { events.push_back(m_events[i % PROFILER_BUFFER_EVENTS]); }
+}
+
+// --------------------------------------  TickProfiler  --------------------------------------- //
+
+TickProfiler& TickProfiler::Instance()
+{
+    static TickProfiler profiler;
+    return profiler;
+}
+
+uint64 TickProfiler::GetTime()
+{
+    ACE_UINT64 time;
+    ACE_OS::gettimeofday().to_usec(time);
+    return uint64(time);
+}
+
+uint32 TickProfiler::RegisterThread(ProfilerThreadBuffer* buffer)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_threadsLock, 0);
+
+    m_threads.push_back(buffer);
+    return m_nextThreadId++;
+}
+
+void TickProfiler::UnregisterThread(ProfilerThreadBuffer* buffer)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
+
+    std::vector<ProfilerThreadBuffer*>::iterator itr = std::find(m_threads.begin(), m_threads.end(), buffer);
+    if (itr != m_threads.end())
+        { m_threads.erase(itr); }
+}
+
+void TickProfiler::SetThreadName(char const* name)
+{
+    m_buffers->SetThreadName(name);
+}
+
+char const* TickProfiler::SetActivity(char const* name, uint32 id, uint32& previousId)
+{
+    ProfilerThreadBuffer* buffer = m_buffers;
+    char const* previous = buffer->GetActivity();
+    previousId = buffer->GetActivityId();
+    buffer->SetActivity(name, id);
+    return previous;
+}
+
+void TickProfiler::CollectActivities(std::vector<ThreadActivity>& activities)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
+
+    for (std::vector<ProfilerThreadBuffer*>::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        ThreadActivity activity;
+        activity.threadId = (*itr)->GetThreadId();
+        activity.threadName = (*itr)->GetThreadName();
+        activity.activity = (*itr)->GetActivity();
+        activity.id = (*itr)->GetActivityId();
+        activities.push_back(activity);
+    }
+}
+
+void TickProfiler::CollectEvents(uint64 from, uint32 minDuration, ProfilerThreadEvents& events)
+{
+    if (!s_recording)
+        { return; }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
+
+    std::vector<ProfilerEvent> threadEvents;
+    for (std::vector<ProfilerThreadBuffer*>::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        if ((*itr)->GetRecording() != m_recording)
+            { continue; }
+
+        threadEvents.clear();
+        (*itr)->CollectEvents(threadEvents);
+
+        for (std::vector<ProfilerEvent>::const_iterator event = threadEvents.begin(); event != threadEvents.end(); ++event)
+        {
+            if (event->start >= from && event->duration >= minDuration)
+                { events.push_back(std::make_pair((*itr)->GetThreadId(), *event)); }
+        }
+    }
+}
+
+void TickProfiler::StartRecording()
+{
+    m_recordingStart = GetTime();
+    ++m_recording;
+    s_recording = true;
+}
+
+void TickProfiler::SetContinuous(bool on)
+{
+    m_continuous = on;
+
+    // a running trace ends as usual
+    if (m_stopTime || m_writePending)
+        { return; }
+
+    if (on && !s_recording)
+        { StartRecording(); }
+    else if (!on)
+        { s_recording = false; }
+}
+
+bool TickProfiler::Start(uint32 seconds)
+{
+    if (m_stopTime || m_writePending)
+        { return false; }
+
+    time_t now = time(NULL);
+    tm* aTm = localtime(&now);
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "profile_%04d-%02d-%02d_%02d-%02d-%02d.json",
+             aTm->tm_year + 1900, aTm->tm_mon + 1, aTm->tm_mday, aTm->tm_hour, aTm->tm_min, aTm->tm_sec);
+    m_fileName = sLog.GetLogsDir() + fileName;
+
+    m_stopTime = now + std::min(std::max(seconds, uint32(1)), uint32(PROFILER_MAX_SECONDS));
+    if (!s_recording)
+        { StartRecording(); }
+
+    m_traceStart = GetTime();
+    return true;
+}
+
+void TickProfiler::Update()
+{
+    if (m_writePending)
+    {
+        m_writePending = false;
+        WriteTrace();
+
+        if (m_continuous)
+            { StartRecording(); }
+        return;
+    }
+
+    if (m_stopTime && time(NULL) >= m_stopTime)
+    {
+        // scopes open at this moment are still recorded, the trace is written next update
+        s_recording = false;
+        m_stopTime = 0;
+        m_writePending = true;
+    }
+}
+
+void TickProfiler::Record(char const* name, uint64 start, uint32 id)
+{
+    uint64 end = GetTime();
+    if (start < m_recordingStart || end < start)
+        { return; }                                         // opened before the recording
+
+    m_buffers->Add(name, start, uint32(end - start), id, m_recording);
+}
+
+void TickProfiler::WriteTrace()
+{
+    FILE* file = fopen(m_fileName.c_str(), "w");
+    if (!file)
+    {
+        sLog.outError("TickProfiler: can't create %s", m_fileName.c_str());
+        return;
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_threadsLock);
+
+    uint32 written = 0;
+    std::vector<ProfilerEvent> events;
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    for (std::vector<ProfilerThreadBuffer*>::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        ProfilerThreadBuffer const* buffer = *itr;
+        if (buffer->GetThreadName())
+        {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    written ? ",\n" : "", buffer->GetThreadId(), buffer->GetThreadName());
+            ++written;
+        }
+
+        if (buffer->GetRecording() != m_recording)
+            { continue; }
+
+        events.clear();
+        buffer->CollectEvents(events);
+
+        for (std::vector<ProfilerEvent>::const_iterator event = events.begin(); event != events.end(); ++event)
+        {
+            if (event->start < m_traceStart)
+                { continue; }                               // recorded before the trace in continuous mode
+
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":" UI64FMTD ",\"dur\":%u,\"pid\":1,\"tid\":%u,\"args\":{\"id\":%u}}",
+                    written ? ",\n" : "", event->name, event->start - m_traceStart, event->duration, buffer->GetThreadId(), event->id);
+            ++written;
+        }
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+
+    sLog.outString("TickProfiler: %u trace events written to %s", written, m_fileName.c_str());
+}
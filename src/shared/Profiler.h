@@ -0,0 +1,247 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_PROFILER
+#define MANGOS_H_PROFILER
+
+#include "Common.h"
+
+#include <ace/TSS_T.h>
+#include <ace/Thread_Mutex.h>
+
+#include <vector>
+
+#define PROFILER_BUFFER_EVENTS      65536                   // events kept per thread, the oldest are overwritten
+#define PROFILER_MAX_SECONDS        60
+
+/**
+ * @brief one timed scope, see ProfileScope
+ *
+ */
+struct ProfilerEvent
+{
+    char const* name;                                       // static string
+    uint64 start;                                           // in microseconds
+    uint32 duration;                                        // in microseconds
+    uint32 id;                                              // map id, opcode, entry, ...
+};
+
+typedef std::vector<std::pair<uint32, ProfilerEvent> > ProfilerThreadEvents;   // thread id, event
+
+/**
+ * @brief what a thread is doing at the moment, see ThreadActivityScope
+ *
+ */
+struct ThreadActivity
+{
+    uint32 threadId;
+    char const* threadName;                                 // NULL if not named
+    char const* activity;                                   // NULL if idle
+    uint32 id;
+};
+
+/**
+ * @brief ring buffer of the events of one thread, written by that thread only
+ *
+ * The buffer knows the recording its events belong to, so starting a recording needs no access
+ * to the buffers of the other threads.
+ */
+class ProfilerThreadBuffer
+{
+    public:
+        ProfilerThreadBuffer();
+        ~ProfilerThreadBuffer();
+
+        void Add(char const* name, uint64 start, uint32 duration, uint32 id, uint32 recording);
+
+        uint32 GetThreadId() const { return m_threadId; }
+        uint32 GetRecording() const { return m_recording; }
+        char const* GetThreadName() const { return m_threadName; }
+        void SetThreadName(char const* name) { m_threadName = name; }
+
+        char const* GetActivity() const { return m_activity; }
+        uint32 GetActivityId() const { return m_activityId; }
+        void SetActivity(char const* name, uint32 id)
+        {
+            m_activity = name;
+            m_activityId = id;
+        }
+
+        /**
+         * @brief events of the last recording, the oldest first
+         *
+         * @param events
+         */
+        void CollectEvents(std::vector<ProfilerEvent>& events) const;
+
+    private:
+        ProfilerEvent* m_events;                            // PROFILER_BUFFER_EVENTS, allocated at the first event
+        volatile uint32 m_count;                            // events added in the recording
+        volatile uint32 m_recording;
+        uint32 m_threadId;
+        char const* m_threadName;
+        char const* volatile m_activity;                    // read by other threads, see TickProfiler::CollectActivities
+        volatile uint32 m_activityId;
+};
+
+/**
+ * @brief records the scopes of the tick for a few seconds and writes them as Chrome trace events
+ *
+ * While nothing is recorded a scope costs a single flag check. The trace is written by the world
+ * thread one update after the recording ended, when the scopes still open at the end are closed,
+ * and can be opened in chrome://tracing, Perfetto or speedscope.
+ *
+ * In continuous mode the profiler always records and the rings hold the last events of every
+ * thread, for the slow tick reports. A trace started meanwhile contains the events from its start.
+ */
+class TickProfiler
+{
+    public:
+        static TickProfiler& Instance();
+
+        static bool IsRecording() { return s_recording; }
+        /// microseconds of the wall clock
+        static uint64 GetTime();
+
+        /**
+         * @brief starts a trace
+         *
+         * @param seconds at most PROFILER_MAX_SECONDS
+         * @return bool false if a trace is still recorded or not written yet
+         */
+        bool Start(uint32 seconds);
+        /// ends the recording when its time is over and writes the trace, called by the world thread
+        void Update();
+        /// records all the time, only between traces if off
+        void SetContinuous(bool on);
+
+        /// file of the running or last recording
+        std::string const& GetFileName() const { return m_fileName; }
+
+        void Record(char const* name, uint64 start, uint32 id);
+        /// name of the calling thread in the trace
+        void SetThreadName(char const* name);
+
+        /**
+         * @brief events of the running recording, the event threads must not record meanwhile
+         *
+         * @param from only events started at or after this time
+         * @param minDuration only events of at least this many microseconds
+         * @param events
+         */
+        void CollectEvents(uint64 from, uint32 minDuration, ProfilerThreadEvents& events);
+
+        /**
+         * @brief marks what the calling thread is doing, returns the marker before
+         *
+         * @param name static string, NULL for idle
+         * @param id
+         * @param previousId
+         * @return char const* the activity before
+         */
+        char const* SetActivity(char const* name, uint32 id, uint32& previousId);
+        /// current activity of every thread that ever had one, safe to call from any thread
+        void CollectActivities(std::vector<ThreadActivity>& activities);
+
+    private:
+        friend class ProfilerThreadBuffer;
+
+        TickProfiler() : m_nextThreadId(1), m_recording(0), m_recordingStart(0), m_traceStart(0), m_stopTime(0),
+            m_writePending(false), m_continuous(false) {}
+
+        void StartRecording();
+
+        /// returns the id of the thread in the trace
+        uint32 RegisterThread(ProfilerThreadBuffer* buffer);
+        void UnregisterThread(ProfilerThreadBuffer* buffer);
+        void WriteTrace();
+
+        static volatile bool s_recording;
+
+        ACE_TSS<ProfilerThreadBuffer> m_buffers;
+        ACE_Thread_Mutex m_threadsLock;
+        std::vector<ProfilerThreadBuffer*> m_threads;
+        uint32 m_nextThreadId;
+
+        volatile uint32 m_recording;                        // number of the recording, 0 before the first
+        uint64 m_recordingStart;
+        uint64 m_traceStart;
+        time_t m_stopTime;                                  // 0 if no trace is recorded
+        bool m_writePending;
+        bool m_continuous;
+        std::string m_fileName;
+};
+
+#define sTickProfiler TickProfiler::Instance()
+
+/**
+ * @brief records its lifetime while the tick profiler records, use PROFILE_SCOPE
+ *
+ */
+class ProfileScope
+{
+    public:
+        explicit ProfileScope(char const* name, uint32 id = 0) :
+            m_name(name), m_id(id), m_start(TickProfiler::IsRecording() ? TickProfiler::GetTime() : 0) {}
+        ~ProfileScope()
+        {
+            if (m_start && TickProfiler::IsRecording())
+                { sTickProfiler.Record(m_name, m_start, m_id); }
+        }
+
+    private:
+        char const* m_name;
+        uint32 m_id;
+        uint64 m_start;
+};
+
+/**
+ * @brief marks the calling thread busy with a map, opcode or similar until the end of the block
+ *
+ */
+class ThreadActivityScope
+{
+    public:
+        ThreadActivityScope(char const* name, uint32 id) { m_previous = sTickProfiler.SetActivity(name, id, m_previousId); }
+        ~ThreadActivityScope()
+        {
+            uint32 id;
+            sTickProfiler.SetActivity(m_previous, m_previousId, id);
+        }
+
+    private:
+        char const* m_previous;
+        uint32 m_previousId;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+/// times the rest of the enclosing block, the name has to be a static string
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+/// as PROFILE_SCOPE, with a number shown as id in the trace
+#define PROFILE_SCOPE_ID(name, id) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, id)
+
+#endif
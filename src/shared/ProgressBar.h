@@ -59,6 +59,12 @@ class MANGOS_DLL_SPEC BarGoLink
          * @param on
          */
         static void SetOutputState(bool on);
+        /**
+         * @brief
+         *
+         * @return bool
+         */
+        static bool GetOutputState();
     private:
         /**
          * @brief
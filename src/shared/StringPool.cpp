@@ -0,0 +1,143 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#include "StringPool.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+
+INSTANTIATE_SINGLETON_1(StringPool);
+
+StringPool::Shard::Shard() : m_count(1), m_arenaLeft(0), m_bytes(0)
+{
+    memset(m_blocks, 0, sizeof(m_blocks));
+}
+
+StringPool::StringPool()
+{
+}
+
+StringPool::~StringPool()
+{
+    for (uint32 i = 0; i < SHARD_COUNT; ++i)
+    {
+        Shard& shard = m_shards[i];
+
+        for (uint32 j = 0; j < MAX_BLOCKS; ++j)
+            { delete[] shard.m_blocks[j]; }
+
+        for (std::vector<char*>::const_iterator itr = shard.m_arenas.begin(); itr != shard.m_arenas.end(); ++itr)
+            { delete[] *itr; }
+    }
+}
+
+uint32 StringPool::Hash(char const* str)
+{
+    // FNV-1a
+    uint32 hash = 2166136261u;
+    for (; *str; ++str)
+    {
+        hash ^= uint8(*str);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+uint32 StringPool::Intern(std::string const& str)
+{
+    if (str.empty())
+        { return EMPTY_STRING; }
+
+    // the high bits select the shard, the id map of the shard uses the low bits
+    uint32 shardIndex = Hash(str.c_str()) >> INDEX_BITS;
+    Shard& shard = m_shards[shardIndex];
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, shard.m_lock, EMPTY_STRING);
+
+    StringIdMap::const_iterator itr = shard.m_ids.find(str.c_str());
+    if (itr != shard.m_ids.end())
+        { return itr->second; }
+
+    uint32 index = shard.m_count;
+    if ((index >> BLOCK_BITS) >= MAX_BLOCKS)
+    {
+        sLog.outError("StringPool: shard %u is full, string '%s' is not stored", shardIndex, str.c_str());
+        return EMPTY_STRING;
+    }
+
+    char const**& block = shard.m_blocks[index >> BLOCK_BITS];
+    if (!block)
+        { block = new char const*[BLOCK_SIZE]; }
+
+    char const* stored = Store(shard, str);
+    block[index & BLOCK_MASK] = stored;
+    ++shard.m_count;
+
+    uint32 id = (shardIndex << INDEX_BITS) | index;
+    shard.m_ids.insert(StringIdMap::value_type(stored, id));
+    return id;
+}
+
+char const* StringPool::Store(Shard& shard, std::string const& str)
+{
+    size_t size = str.size() + 1;
+    char* dest;
+
+    if (size > ARENA_SIZE / 4)
+    {
+        // long strings get an allocation of their own, kept in front of the current arena
+        dest = new char[size];
+        shard.m_arenas.insert(shard.m_arenas.empty() ? shard.m_arenas.end() : shard.m_arenas.end() - 1, dest);
+    }
+    else
+    {
+        if (size > shard.m_arenaLeft)
+        {
+            shard.m_arenas.push_back(new char[ARENA_SIZE]);
+            shard.m_arenaLeft = ARENA_SIZE;
+        }
+
+        dest = shard.m_arenas.back() + (ARENA_SIZE - shard.m_arenaLeft);
+        shard.m_arenaLeft -= size;
+    }
+
+    memcpy(dest, str.c_str(), size);
+    shard.m_bytes += size;
+    return dest;
+}
+
+void StringPool::GetStats(uint32& strings, size_t& bytes)
+{
+    strings = 0;
+    bytes = 0;
+
+    for (uint32 i = 0; i < SHARD_COUNT; ++i)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_shards[i].m_lock);
+        strings += m_shards[i].m_count - 1;
+        bytes += m_shards[i].m_bytes;
+    }
+}
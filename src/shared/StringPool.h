@@ -0,0 +1,170 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+
+#ifndef MANGOS_H_STRINGPOOL
+#define MANGOS_H_STRINGPOOL
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Utilities/FlatHashMap.h"
+
+#include <ace/Thread_Mutex.h>
+
+/**
+ * @brief read-only store of the static text strings, every distinct string is kept once
+ *
+ * Strings are interned while loading and referred to by 32 bit ids afterwards. The pool is split
+ * into shards by string hash, each with its own lock, so loaders running at the same time rarely wait
+ * for each other. Interned strings are never freed, Get() takes no lock and is a few array loads.
+ */
+class StringPool : public MaNGOS::Singleton<StringPool, MaNGOS::ClassLevelLockable<StringPool, ACE_Thread_Mutex> >
+{
+        friend class MaNGOS::OperatorNew<StringPool>;
+
+    public:
+        static uint32 const EMPTY_STRING = 0;               // id of the empty string
+
+        /**
+         * @brief id of str, the string is copied into the pool at its first intern
+         *
+         * @param str
+         * @return uint32 EMPTY_STRING for an empty str
+         */
+        uint32 Intern(std::string const& str);
+
+        /**
+         * @brief the string of an id returned by Intern
+         *
+         * @param id
+         * @return const char "" for EMPTY_STRING
+         */
+        char const* Get(uint32 id) const
+        {
+            if (id == EMPTY_STRING)
+                { return ""; }
+
+            uint32 index = id & INDEX_MASK;
+            return m_shards[id >> INDEX_BITS].m_blocks[index >> BLOCK_BITS][index & BLOCK_MASK];
+        }
+
+        /// number of distinct strings and their bytes, for the load statistics
+        void GetStats(uint32& strings, size_t& bytes);
+
+    private:
+        StringPool();
+        ~StringPool();
+
+        enum
+        {
+            SHARD_BITS  = 4,
+            SHARD_COUNT = 1 << SHARD_BITS,
+            INDEX_BITS  = 32 - SHARD_BITS,
+            INDEX_MASK  = (1 << INDEX_BITS) - 1,
+            BLOCK_BITS  = 12,
+            BLOCK_SIZE  = 1 << BLOCK_BITS,
+            BLOCK_MASK  = BLOCK_SIZE - 1,
+            MAX_BLOCKS  = 256,                              // up to 1M strings per shard
+            ARENA_SIZE  = 64 * 1024                         // string bytes allocated at once
+        };
+
+        /// compares C strings by content for the id lookup
+        struct StringHash
+        {
+            uint32 operator()(char const* str) const { return StringPool::Hash(str); }
+        };
+
+        struct StringEqual
+        {
+            bool operator()(char const* left, char const* right) const { return strcmp(left, right) == 0; }
+        };
+
+        typedef FlatHashMap<char const*, uint32, StringHash, StringEqual> StringIdMap;
+
+        struct Shard
+        {
+            Shard();
+
+            ACE_Thread_Mutex m_lock;
+            char const** m_blocks[MAX_BLOCKS];              // not reallocated, so Get() needs no lock
+            uint32 m_count;                                 // index 0 is never used
+            StringIdMap m_ids;
+            std::vector<char*> m_arenas;
+            size_t m_arenaLeft;
+            size_t m_bytes;
+        };
+
+        static uint32 Hash(char const* str);
+
+        char const* Store(Shard& shard, std::string const& str);
+
+        Shard m_shards[SHARD_COUNT];
+};
+
+#define sStringPool MaNGOS::Singleton<StringPool>::Instance()
+
+/**
+ * @brief interned strings of one text in all locales, by the locale index of ObjectMgr::GetOrNewIndexForLocale
+ *
+ */
+class LocaleStrings
+{
+    public:
+        size_t size() const { return m_ids.size(); }
+        bool empty() const { return m_ids.empty(); }
+        void resize(size_t count) { m_ids.resize(count, StringPool::EMPTY_STRING); }
+
+        /**
+         * @brief stores str for the locale index, the list grows as needed
+         *
+         * @param locIdx
+         * @param str
+         */
+        void Set(size_t locIdx, std::string const& str)
+        {
+            if (m_ids.size() <= locIdx)
+                { m_ids.resize(locIdx + 1, StringPool::EMPTY_STRING); }
+
+            m_ids[locIdx] = sStringPool.Intern(str);
+        }
+
+        /**
+         * @brief the string of the locale index
+         *
+         * @param locIdx
+         * @return const char NULL if the locale has no or an empty string
+         */
+        char const* Get(size_t locIdx) const
+        {
+            if (locIdx >= m_ids.size() || m_ids[locIdx] == StringPool::EMPTY_STRING)
+                { return NULL; }
+
+            return sStringPool.Get(m_ids[locIdx]);
+        }
+
+    private:
+        std::vector<uint32> m_ids;
+};
+
+#endif
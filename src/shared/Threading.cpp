@@ -27,6 +27,11 @@
 #include <ace/OS_NS_unistd.h>
 #include <ace/Sched_Params.h>
 #include <vector>
+#include <stdlib.h>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using namespace ACE_Based;
 
@@ -239,6 +244,79 @@ void Thread::setPriority(Priority type)
 #endif
 }
 
+bool Thread::setCurrentAffinity(std::string const& cpuSets, unsigned int index)
+{
+    if (cpuSets.empty())
+        { return true; }
+
+    std::vector<std::string> sets;
+    for (std::string::size_type start = 0; start <= cpuSets.size();)
+    {
+        std::string::size_type end = cpuSets.find(';', start);
+        if (end == std::string::npos)
+            { end = cpuSets.size(); }
+
+        sets.push_back(cpuSets.substr(start, end - start));
+        start = end + 1;
+    }
+
+    std::string const& cpus = sets[index % sets.size()];
+
+    std::vector<unsigned int> cpuList;
+    char const* pos = cpus.c_str();
+    while (*pos)
+    {
+        char* end;
+        unsigned long first = strtoul(pos, &end, 10);
+        if (end == pos)
+            { return false; }
+
+        unsigned long last = first;
+        if (*end == '-')
+        {
+            pos = end + 1;
+            last = strtoul(pos, &end, 10);
+            if (end == pos || last < first)
+                { return false; }
+        }
+
+        for (unsigned long cpu = first; cpu <= last && cpu < 1024; ++cpu)
+            { cpuList.push_back(cpu); }
+
+        pos = end;
+        if (*pos == ',')
+            { ++pos; }
+        else if (*pos)
+            { return false; }
+    }
+
+    if (cpuList.empty())
+        { return false; }
+
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (size_t i = 0; i < cpuList.size(); ++i)
+    {
+        if (cpuList[i] < CPU_SETSIZE)
+            { CPU_SET(cpuList[i], &cpuSet); }
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#elif defined(WIN32)
+    DWORD_PTR mask = 0;
+    for (size_t i = 0; i < cpuList.size(); ++i)
+    {
+        if (cpuList[i] < sizeof(mask) * 8)
+            { mask |= DWORD_PTR(1) << cpuList[i]; }
+    }
+
+    return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
 void Thread::Sleep(unsigned long msecs)
 {
     ACE_OS::sleep(ACE_Time_Value(0, 1000 * msecs));
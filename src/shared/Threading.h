@@ -29,6 +29,7 @@
 #include <ace/TSS_T.h>
 #include <ace/Atomic_Op.h>
 #include <assert.h>
+#include <string>
 
 namespace ACE_Based
 {
@@ -169,6 +170,18 @@ namespace ACE_Based
              */
             void setPriority(Priority type);
 
+            /**
+             * @brief binds the calling thread to one of the CPU sets of a config option
+             *
+             * CPU sets are lists like "0-3,8" separated by ';', the thread gets set index modulo
+             * their count, so threads of one kind can be spread over the NUMA nodes.
+             *
+             * @param cpuSets empty for no binding
+             * @param index
+             * @return bool false if the sets are invalid or binding is not supported
+             */
+            static bool setCurrentAffinity(std::string const& cpuSets, unsigned int index);
+
             /**
              * @brief
              *
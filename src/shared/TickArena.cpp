@@ -0,0 +1,112 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "TickArena.h"
+
+#include <ace/TSS_T.h>
+
+#define TICK_ARENA_CHUNK_SIZE   (64 * 1024)
+#define TICK_ARENA_KEEP_CHUNKS  16                          // chunks a thread keeps after a large tick
+#define TICK_ARENA_ALIGNMENT    16
+
+typedef ACE_TSS<TickArena> TickArenaTSS;
+static TickArenaTSS s_arena;
+
+TickArena::Scope::Scope() : m_arena(s_arena.ts_object())
+{
+    ++m_arena->m_depth;
+}
+
+TickArena::Scope::~Scope()
+{
+    if (--m_arena->m_depth == 0)
+        { m_arena->Reset(); }
+}
+
+TickArena::TickArena() : m_current(0), m_pos(0), m_depth(0)
+{
+}
+
+TickArena::~TickArena()
+{
+    Reset();
+
+    for (std::vector<Chunk>::const_iterator itr = m_chunks.begin(); itr != m_chunks.end(); ++itr)
+        { delete[] itr->data; }
+}
+
+TickArena* TickArena::GetActive()
+{
+    TickArena* arena = s_arena.ts_object();
+    return arena && arena->m_depth ? arena : NULL;
+}
+
+void* TickArena::Allocate(size_t size)
+{
+    size = (size + TICK_ARENA_ALIGNMENT - 1) & ~size_t(TICK_ARENA_ALIGNMENT - 1);
+
+    // a few large blocks would waste most of the chunks
+    if (size > TICK_ARENA_CHUNK_SIZE / 4)
+    {
+        void* p = ::operator new(size);
+        m_large.push_back(p);
+        return p;
+    }
+
+    if (m_chunks.empty() || m_pos + size > m_chunks[m_current].size)
+    {
+        if (!m_chunks.empty())
+            { ++m_current; }
+
+        if (m_current == m_chunks.size())
+        {
+            Chunk chunk;
+            chunk.data = new char[TICK_ARENA_CHUNK_SIZE];
+            chunk.size = TICK_ARENA_CHUNK_SIZE;
+            m_chunks.push_back(chunk);
+        }
+
+        m_pos = 0;
+    }
+
+    void* p = m_chunks[m_current].data + m_pos;
+    m_pos += size;
+    return p;
+}
+
+void TickArena::Reset()
+{
+    for (std::vector<void*>::const_iterator itr = m_large.begin(); itr != m_large.end(); ++itr)
+        { ::operator delete(*itr); }
+    m_large.clear();
+
+    while (m_chunks.size() > TICK_ARENA_KEEP_CHUNKS)
+    {
+        delete[] m_chunks.back().data;
+        m_chunks.pop_back();
+    }
+
+    m_current = 0;
+    m_pos = 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOSSERVER_TICKARENA_H
+#define MANGOSSERVER_TICKARENA_H
+
+#include "Common.h"
+
+#include <new>
+
+/**
+ * @brief bump allocator of a thread for the short lived containers of a map update
+ *
+ * Memory is handed out from a few chunks kept by the thread and is never freed one by one,
+ * the whole arena is rewound when the outermost Scope of the thread ends. Containers using
+ * an ArenaAllocator therefore must not outlive the Scope they were created in.
+ */
+class TickArena
+{
+    public:
+        /**
+         * @brief marks the code whose transient containers are allocated from the arena of the thread
+         *
+         * Scopes may nest, only the end of the outermost one rewinds the arena.
+         */
+        class Scope
+        {
+            public:
+                Scope();
+                ~Scope();
+
+            private:
+                Scope(Scope const&);
+                Scope& operator=(Scope const&);
+
+                TickArena* m_arena;
+        };
+
+        TickArena();
+        ~TickArena();
+
+        /**
+         * @brief
+         *
+         * @return TickArena arena of the thread if inside a Scope, NULL else
+         */
+        static TickArena* GetActive();
+
+        /**
+         * @brief
+         *
+         * @param size
+         * @return void 16 byte aligned memory valid until the outermost Scope ends
+         */
+        void* Allocate(size_t size);
+
+    private:
+        TickArena(TickArena const&);
+        TickArena& operator=(TickArena const&);
+
+        friend class Scope;
+
+        void Reset();
+
+        struct Chunk
+        {
+            char* data;
+            size_t size;
+        };
+
+        std::vector<Chunk> m_chunks;                        // the first m_current + 1 are in use
+        std::vector<void*> m_large;                         // allocations too large for a chunk, freed at Reset
+        size_t m_current;
+        size_t m_pos;                                       // used bytes of the current chunk
+        uint32 m_depth;                                     // nested Scopes
+};
+
+/**
+ * @brief STL allocator taking the memory from the tick arena active at its construction
+ *
+ * An allocator constructed outside a TickArena::Scope uses the heap, so a container type with
+ * it works everywhere, it only saves the heap calls inside a map update.
+ */
+template<class T>
+class ArenaAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U> struct rebind { typedef ArenaAllocator<U> other; };
+
+        ArenaAllocator() : m_arena(TickArena::GetActive()) {}
+        ArenaAllocator(ArenaAllocator const& other) : m_arena(other.GetArena()) {}
+        template<class U> ArenaAllocator(ArenaAllocator<U> const& other) : m_arena(other.GetArena()) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, void const* /*hint*/ = NULL)
+        {
+            if (m_arena)
+                { return static_cast<pointer>(m_arena->Allocate(n * sizeof(T))); }
+
+            return static_cast<pointer>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(pointer p, size_type /*n*/)
+        {
+            if (!m_arena)
+                { ::operator delete(p); }
+        }
+
+        size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+        void construct(pointer p, const_reference value) { new(static_cast<void*>(p)) T(value); }
+        void destroy(pointer p) { p->~T(); }
+
+        TickArena* GetArena() const { return m_arena; }
+
+    private:
+        TickArena* m_arena;
+};
+
+template<class T, class U>
+inline bool operator==(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b) { return a.GetArena() == b.GetArena(); }
+
+template<class T, class U>
+inline bool operator!=(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b) { return a.GetArena() != b.GetArena(); }
+
+#endif
@@ -42,7 +42,7 @@ class WorldPacket : public ByteBuffer
          * @brief just container for later use
          *
          */
-        WorldPacket() : ByteBuffer(0), m_opcode(MSG_NULL_ACTION)
+        WorldPacket() : ByteBuffer(0, MEM_TAG_PACKET), m_opcode(MSG_NULL_ACTION)
         {
         }
         /**
@@ -51,7 +51,7 @@ class WorldPacket : public ByteBuffer
          * @param opcode
          * @param res
          */
-        explicit WorldPacket(uint16 opcode, size_t res = 200) : ByteBuffer(res), m_opcode(opcode) { }
+        explicit WorldPacket(uint16 opcode, size_t res = 200) : ByteBuffer(Opcodes::GetReserveSize(opcode, res), MEM_TAG_PACKET), m_opcode(opcode) { }
         /**
          * @brief copy constructor
          *
@@ -61,6 +61,15 @@ class WorldPacket : public ByteBuffer
         {
         }
 
+        /**
+         * @brief the final size tunes the reserve size of the next packets of the opcode
+         *
+         */
+        ~WorldPacket()
+        {
+            Opcodes::LearnPacketSize(m_opcode, size());
+        }
+
         /**
          * @brief
          *
@@ -69,8 +78,10 @@ class WorldPacket : public ByteBuffer
          */
         void Initialize(uint16 opcode, size_t newres = 200)
         {
+            Opcodes::LearnPacketSize(m_opcode, size());
             clear();
-            _storage.reserve(newres);
+            _storage.reserve(Opcodes::GetReserveSize(opcode, newres));
+            TrackStorage();
             m_opcode = opcode;
         }
 
@@ -93,6 +104,17 @@ class WorldPacket : public ByteBuffer
          */
         inline const char* GetOpcodeName() const { return LookupOpcodeName(m_opcode); }
 
+        /**
+         * @brief exchanges opcode and contents with packet without copying them
+         *
+         * @param packet
+         */
+        void swap(WorldPacket& packet)
+        {
+            ByteBuffer::swap(packet);
+            std::swap(m_opcode, packet.m_opcode);
+        }
+
     protected:
         uint16 m_opcode; /**< TODO */
 };
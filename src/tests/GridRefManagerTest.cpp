@@ -0,0 +1,222 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/// \addtogroup tests
+/// @{
+/// \file
+
+#include "GameSystem/GridRefManager.h"
+
+#include <cstdio>
+
+/// Object of a cell, counts the visits of a walk
+struct TestObject
+{
+    TestObject() : visits(0) {}
+
+    GridReference<TestObject> ref;
+    int visits;
+};
+
+static int failures = 0;
+
+#define CHECK(expr) \
+    do { if (!(expr)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); ++failures; } } while (0)
+
+static int const OBJECT_COUNT = 8;
+
+static void LinkAll(GridRefManager<TestObject>& manager, TestObject* objects)
+{
+    for (int i = 0; i < OBJECT_COUNT; ++i)
+    {
+        objects[i].visits = 0;
+        objects[i].ref.link(&manager, &objects[i]);
+    }
+}
+
+/// every object is linked once and reachable by the iterator and by next()
+static void CheckConsistent(GridRefManager<TestObject>& manager, uint32 expected)
+{
+    uint32 count = 0;
+    for (GridRefManager<TestObject>::iterator itr = manager.begin(); itr != manager.end(); ++itr)
+        { ++count; }
+    CHECK(count == expected);
+
+    count = 0;
+    for (GridReference<TestObject>* ref = manager.getFirst(); ref; ref = ref->next())
+        { ++count; }
+    CHECK(count == expected);
+    CHECK(manager.getSize() == expected);
+}
+
+/// another object moves out of the cell before it was visited, as at Map::CreatureCellRelocation
+static void TestUnlinkNotVisited()
+{
+    GridRefManager<TestObject> manager;
+    TestObject objects[OBJECT_COUNT];
+    LinkAll(manager, objects);
+
+    // the first visited object is in the last slot, removing slot 0 used to move it into the freed slot
+    TestObject* removed = NULL;
+    for (GridRefManager<TestObject>::iterator itr = manager.begin(); itr != manager.end(); ++itr)
+    {
+        TestObject* obj = itr->getSource();
+        ++obj->visits;
+        if (!removed)
+        {
+            removed = &objects[0] == obj ? &objects[1] : &objects[0];
+            removed->ref.unlink();
+        }
+    }
+
+    for (int i = 0; i < OBJECT_COUNT; ++i)
+        { CHECK(objects[i].visits == (&objects[i] == removed ? 0 : 1)); }
+
+    CheckConsistent(manager, OBJECT_COUNT - 1);
+}
+
+/// the visited object and a visited one before it leave the cell
+static void TestUnlinkVisited()
+{
+    GridRefManager<TestObject> manager;
+    TestObject objects[OBJECT_COUNT];
+    LinkAll(manager, objects);
+
+    TestObject* previous = NULL;
+    int walked = 0;
+    for (GridRefManager<TestObject>::iterator itr = manager.begin(); itr != manager.end(); ++itr)
+    {
+        TestObject* obj = itr->getSource();
+        ++obj->visits;
+        ++walked;
+        if (walked == 3)
+        {
+            obj->ref.unlink();
+            previous->ref.unlink();
+        }
+        previous = obj;
+    }
+
+    CHECK(walked == OBJECT_COUNT);
+    for (int i = 0; i < OBJECT_COUNT; ++i)
+        { CHECK(objects[i].visits == 1); }
+
+    CheckConsistent(manager, OBJECT_COUNT - 2);
+}
+
+/// an object entering the cell during the walk is visited by the next walk only
+static void TestLinkDuringWalk()
+{
+    GridRefManager<TestObject> manager;
+    TestObject objects[OBJECT_COUNT];
+    TestObject added;
+    LinkAll(manager, objects);
+
+    for (GridRefManager<TestObject>::iterator itr = manager.begin(); itr != manager.end(); ++itr)
+    {
+        ++itr->getSource()->visits;
+        if (!added.ref.isValid())
+        {
+            objects[OBJECT_COUNT / 2].ref.unlink();
+            added.ref.link(&manager, &added);
+        }
+    }
+
+    CHECK(added.visits == 0);
+    for (int i = 0; i < OBJECT_COUNT; ++i)
+        { CHECK(objects[i].visits == (i == OBJECT_COUNT / 2 ? 0 : 1)); }
+
+    CheckConsistent(manager, OBJECT_COUNT);
+}
+
+/// nested walks of one cell, the cleared slots are compacted after the outer walk only
+static void TestNestedWalks()
+{
+    GridRefManager<TestObject> manager;
+    TestObject objects[OBJECT_COUNT];
+    LinkAll(manager, objects);
+
+    int inner = 0;
+    for (GridRefManager<TestObject>::iterator itr = manager.begin(); itr != manager.end(); ++itr)
+    {
+        ++itr->getSource()->visits;
+        if (objects[OBJECT_COUNT - 1].ref.isValid())
+        {
+            for (GridRefManager<TestObject>::iterator itr2 = manager.begin(); itr2 != manager.end(); ++itr2)
+                { ++inner; }
+            objects[0].ref.unlink();
+            objects[OBJECT_COUNT - 1].ref.unlink();
+        }
+    }
+
+    CHECK(inner == OBJECT_COUNT);
+    for (int i = 1; i < OBJECT_COUNT - 1; ++i)
+        { CHECK(objects[i].visits == 1); }
+    CHECK(objects[0].visits == 0);
+
+    CheckConsistent(manager, OBJECT_COUNT - 2);
+}
+
+/// unlinking with no walk and destroying the manager first
+static void TestUnlinkOutsideWalk()
+{
+    TestObject objects[OBJECT_COUNT];
+    {
+        GridRefManager<TestObject> manager;
+        LinkAll(manager, objects);
+
+        objects[2].ref.unlink();
+        objects[5].ref.unlink();
+        CheckConsistent(manager, OBJECT_COUNT - 2);
+
+        while (!manager.isEmpty())
+            { manager.getFirst()->unlink(); }
+        CheckConsistent(manager, 0);
+
+        LinkAll(manager, objects);
+    }
+
+    for (int i = 0; i < OBJECT_COUNT; ++i)
+        { CHECK(!objects[i].ref.isValid()); }
+}
+
+int main()
+{
+    TestUnlinkNotVisited();
+    TestUnlinkVisited();
+    TestLinkDuringWalk();
+    TestNestedWalks();
+    TestUnlinkOutsideWalk();
+
+    if (failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
+
+/// @}
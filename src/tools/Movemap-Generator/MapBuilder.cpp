@@ -24,6 +24,7 @@
 
 #include <DetourNavMeshBuilder.h>
 #include <DetourCommon.h>
+#include <DetourNavMeshQuery.h>
 
 #include "MMapCommon.h"
 #include "MapBuilder.h"
@@ -31,13 +32,41 @@
 #include "MapTree.h"
 #include "ModelInstance.h"
 
+#include <zlib.h>
+
+#include <algorithm>
+
+#include <ace/Guard_T.h>
+#include <ace/High_Res_Timer.h>
+#include <ace/Task.h>
+
 using namespace VMAP;
 
 namespace MMAP
 {
+    /**
+     * @brief threads building the tiles of the tile queue of a MapBuilder
+     *
+     */
+    class TileWorkers : public ACE_Task_Base
+    {
+        public:
+            explicit TileWorkers(MapBuilder& builder) : m_builder(builder) {}
+
+            int svc() override
+            {
+                m_builder.buildQueuedTiles();
+                return 0;
+            }
+
+        private:
+            MapBuilder& m_builder;
+    };
+
     MapBuilder::MapBuilder(float maxWalkableAngle, bool skipLiquid,
                            bool skipContinents, bool skipJunkMaps, bool skipBattlegrounds,
-                           bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath) :
+                           bool debugOutput, bool bigBaseUnit, const char* offMeshFilePath, uint32 threads, bool archive,
+                           uint32 reportQueries) :
         m_terrainBuilder(NULL),
         m_debugOutput(debugOutput),
         m_skipContinents(skipContinents),
@@ -46,7 +75,11 @@ namespace MMAP
         m_maxWalkableAngle(maxWalkableAngle),
         m_bigBaseUnit(bigBaseUnit),
         m_rcContext(NULL),
-        m_offMeshFilePath(offMeshFilePath)
+        m_offMeshFilePath(offMeshFilePath),
+        m_skipLiquid(skipLiquid),
+        m_threads(threads ? threads : 1),
+        m_archive(archive),
+        m_reportQueries(reportQueries)
     {
         m_terrainBuilder = new TerrainBuilder(skipLiquid);
 
@@ -151,9 +184,18 @@ namespace MMAP
         for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
         {
             uint32 mapID = (*it).first;
-            if (!shouldSkipMap(mapID))
+            if (shouldSkipMap(mapID))
+                { continue; }
+
+            // the workers take tiles of the next maps while the last tiles of a map are built
+            if (m_threads > 1)
+                { queueMap(mapID); }
+            else
                 { buildMap(mapID); }
         }
+
+        if (m_threads > 1)
+            { runTileWorkers(); }
     }
 
     /**************************************************************************/
@@ -210,13 +252,22 @@ namespace MMAP
             return;
         }
 
-        buildTile(mapID, tileX, tileY, navMesh);
+        buildTile(mapID, tileX, tileY, navMesh, *m_terrainBuilder, *m_rcContext);
         dtFreeNavMesh(navMesh);
+
+        finishMap(mapID);
     }
 
     /**************************************************************************/
     void MapBuilder::buildMap(uint32 mapID)
     {
+        if (m_threads > 1)
+        {
+            queueMap(mapID);
+            runTileWorkers();
+            return;
+        }
+
         printf("Building map %03u:\n", mapID);
 
         set<uint32>* tiles = getTileList(mapID);
@@ -258,26 +309,436 @@ namespace MMAP
             if (shouldSkipTile(mapID, tileX, tileY))
                 { continue; }
 
-            buildTile(mapID, tileX, tileY, navMesh);
+            buildTile(mapID, tileX, tileY, navMesh, *m_terrainBuilder, *m_rcContext);
         }
 
         dtFreeNavMesh(navMesh);
 
+        finishMap(mapID);
+
         printf("Complete!                               \n\n");
     }
 
     /**************************************************************************/
-    void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
+    void MapBuilder::queueMap(uint32 mapID)
+    {
+        printf("Queueing map %03u:\n", mapID);
+
+        set<uint32>* tiles = getTileList(mapID);
+
+        // make sure we process maps which don't have tiles
+        if (!tiles->size())
+        {
+            uint32 minX, minY, maxX, maxY;
+            getGridBounds(mapID, minX, minY, maxX, maxY);
+
+            for (uint32 i = minX; i <= maxX; ++i)
+                for (uint32 j = minY; j <= maxY; ++j)
+                    { tiles->insert(StaticMapTree::packTileID(i, j)); }
+        }
+
+        if (!tiles->size())
+            { return; }
+
+        // the map file is written once here, the workers create their navmesh from its params
+        dtNavMesh* navMesh = NULL;
+        buildNavMesh(mapID, navMesh);
+        if (!navMesh)
+        {
+            printf("Failed creating navmesh!              \n");
+            return;
+        }
+
+        m_navMeshParams[mapID] = *navMesh->getParams();
+        dtFreeNavMesh(navMesh);
+
+        uint32 count = 0;
+        for (set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
+        {
+            TileJob job;
+            job.mapID = mapID;
+            StaticMapTree::unpackTileID((*it), job.tileX, job.tileY);
+
+            if (shouldSkipTile(mapID, job.tileX, job.tileY))
+                { continue; }
+
+            m_tileQueue.push_back(job);
+            ++count;
+        }
+
+        printf("We have %u tiles.                          \n", count);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::runTileWorkers()
+    {
+        if (m_tileQueue.empty())
+            { return; }
+
+        printf("Building %u tiles on %u threads...\n", (unsigned int)m_tileQueue.size(), m_threads);
+
+        TileWorkers workers(*this);
+        if (workers.activate(THR_NEW_LWP | THR_JOINABLE, int(m_threads)) == -1)
+        {
+            printf("Failed starting the threads, building the tiles on this thread\n");
+            buildQueuedTiles();
+        }
+        else
+            { workers.wait(); }
+
+        for (map<uint32, dtNavMeshParams>::const_iterator itr = m_navMeshParams.begin(); itr != m_navMeshParams.end(); ++itr)
+            { finishMap(itr->first); }
+
+        m_navMeshParams.clear();
+
+        printf("Complete!                               \n\n");
+    }
+
+    /**************************************************************************/
+    bool MapBuilder::readTileFile(uint32 mapID, uint32 x, uint32 y, MmapTileHeader& header, vector<unsigned char>& data)
+    {
+        char fileName[255];
+        sprintf(fileName, "mmaps/%03u%02u%02u.mmtile", mapID, x, y);
+        FILE* file = fopen(fileName, "rb");
+        if (!file)
+            { return false; }
+
+        bool valid = fread(&header, sizeof(MmapTileHeader), 1, file) == 1 && header.mmapMagic == MMAP_MAGIC &&
+                     header.dtVersion == DT_NAVMESH_VERSION && header.mmapVersion == MMAP_VERSION && header.size;
+        if (valid)
+        {
+            data.resize(header.size);
+            valid = fread(&data[0], header.size, 1, file) == 1;
+        }
+        fclose(file);
+
+        if (!valid)
+            { printf("Skipping %s, it is damaged or of an older version\n", fileName); }
+
+        return valid;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::finishMap(uint32 mapID)
+    {
+        if (m_archive)
+            { writeTileArchive(mapID); }
+
+        if (m_reportQueries)
+            { writeReport(mapID); }
+    }
+
+    /**************************************************************************/
+    void MapBuilder::writeReport(uint32 mapID)
+    {
+        // as mangosd calculates paths, see mmap.queryNodes and MAX_PATH_LENGTH
+        const int queryNodes = 2048;
+        const int maxPathLength = 256;
+
+        char fileName[255];
+        sprintf(fileName, "mmaps/%03u.mmap", mapID);
+        FILE* file = fopen(fileName, "rb");
+        if (!file)
+            { return; }
+
+        dtNavMeshParams params;
+        bool valid = fread(&params, sizeof(dtNavMeshParams), 1, file) == 1;
+        fclose(file);
+
+        dtNavMesh* navMesh = valid ? dtAllocNavMesh() : NULL;
+        if (!navMesh || dtStatusFailed(navMesh->init(&params)))
+        {
+            printf("Failed creating navmesh of map %03u for the report!\n", mapID);
+            dtFreeNavMesh(navMesh);
+            return;
+        }
+
+        // the navmesh uses the tile data in place, reserved so the buffers never move
+        vector<vector<unsigned char> > tileData;
+        tileData.reserve(64 * 64);
+
+        uint32 maxTileSize = 0;
+        uint64 totalTileSize = 0;
+        for (uint32 x = 0; x < 64; ++x)
+        {
+            for (uint32 y = 0; y < 64; ++y)
+            {
+                MmapTileHeader header;
+                tileData.push_back(vector<unsigned char>());
+                if (!readTileFile(mapID, x, y, header, tileData.back()) ||
+                    dtStatusFailed(navMesh->addTile(&tileData.back()[0], int(header.size), 0, 0, NULL)))
+                {
+                    tileData.pop_back();
+                    continue;
+                }
+
+                maxTileSize = std::max(maxTileSize, header.size);
+                totalTileSize += header.size;
+            }
+        }
+
+        if (tileData.empty())
+        {
+            dtFreeNavMesh(navMesh);
+            return;
+        }
+
+        // polygons, their vertices and the links to their neighbours
+        const dtNavMesh* mesh = navMesh;
+        vector<dtPolyRef> polys;
+        uint32 polyVerts = 0, polyLinks = 0, offMeshLinks = 0;
+        for (int i = 0; i < mesh->getMaxTiles(); ++i)
+        {
+            const dtMeshTile* tile = mesh->getTile(i);
+            if (!tile->header)
+                { continue; }
+
+            dtPolyRef base = mesh->getPolyRefBase(tile);
+            for (int p = 0; p < tile->header->polyCount; ++p)
+            {
+                const dtPoly& poly = tile->polys[p];
+                if (poly.getType() == DT_POLYTYPE_OFFMESH_CONNECTION)
+                {
+                    ++offMeshLinks;
+                    continue;
+                }
+
+                polys.push_back(base | dtPolyRef(p));
+                polyVerts += poly.vertCount;
+                for (unsigned int l = poly.firstLink; l != DT_NULL_LINK; l = tile->links[l].next)
+                    { ++polyLinks; }
+            }
+        }
+
+        // paths between polygon centers, the same polygons for every build of the map
+        vector<uint32> timings;
+        uint32 completePaths = 0;
+        dtNavMeshQuery* query = dtAllocNavMeshQuery();
+        if (query && polys.size() > 1 && !dtStatusFailed(query->init(navMesh, queryNodes)))
+        {
+            dtQueryFilter filter;
+            dtPolyRef path[maxPathLength];
+
+            srand(mapID);
+            for (uint32 q = 0; q < m_reportQueries; ++q)
+            {
+                dtPolyRef ends[2];
+                float pos[2][3];
+                for (int e = 0; e < 2; ++e)
+                {
+                    // rand() may have 15 bits only, maps have more polygons
+                    ends[e] = polys[(uint32(rand()) << 15 ^ uint32(rand())) % polys.size()];
+
+                    const dtMeshTile* tile;
+                    const dtPoly* poly;
+                    mesh->getTileAndPolyByRefUnsafe(ends[e], &tile, &poly);
+
+                    pos[e][0] = pos[e][1] = pos[e][2] = 0.0f;
+                    for (int v = 0; v < poly->vertCount; ++v)
+                        { dtVadd(pos[e], pos[e], &tile->verts[poly->verts[v] * 3]); }
+                    dtVscale(pos[e], pos[e], 1.0f / poly->vertCount);
+                }
+
+                int pathLength = 0;
+                ACE_Time_Value start = ACE_High_Res_Timer::gettimeofday_hr();
+                dtStatus status = query->findPath(ends[0], ends[1], pos[0], pos[1], &filter, path, &pathLength, maxPathLength);
+                ACE_UINT64 usec;
+                (ACE_High_Res_Timer::gettimeofday_hr() - start).to_usec(usec);
+
+                timings.push_back(uint32(usec));
+                if (dtStatusSucceed(status) && pathLength && path[pathLength - 1] == ends[1])
+                    { ++completePaths; }
+            }
+        }
+
+        dtFreeNavMeshQuery(query);
+        dtFreeNavMesh(navMesh);
+
+        uint32 tiles = uint32(tileData.size());
+        uint32 polyCount = uint32(polys.size());
+        float vertsPerPoly = polyCount ? float(polyVerts) / polyCount : 0.0f;
+        float linksPerPoly = polyCount ? float(polyLinks) / polyCount : 0.0f;
+
+        uint32 paths = uint32(timings.size());
+        uint64 totalTime = 0;
+        for (uint32 i = 0; i < paths; ++i)
+            { totalTime += timings[i]; }
+        sort(timings.begin(), timings.end());
+
+        uint32 avgTime = paths ? uint32(totalTime / paths) : 0;
+        uint32 medianTime = paths ? timings[paths / 2] : 0;
+        uint32 p95Time = paths ? timings[paths * 95 / 100] : 0;
+        uint32 maxTime = paths ? timings.back() : 0;
+        float completeShare = paths ? 100.0f * completePaths / paths : 0.0f;
+
+        printf("Report of map %03u:\n", mapID);
+        printf("  %u tiles, %u polygons, %.2f vertices and %.2f links per polygon, %u off mesh links\n",
+               tiles, polyCount, vertsPerPoly, linksPerPoly, offMeshLinks);
+        printf("  tile data %.1f KB on average, %.1f KB at most, %.1f MB in total\n",
+               totalTileSize / 1024.0f / tiles, maxTileSize / 1024.0f, totalTileSize / 1048576.0f);
+        printf("  %u paths, %.1f%% reach their end, %u us on average, %u us median, %u us 95%%, %u us at most\n\n",
+               paths, completeShare, avgTime, medianTime, p95Time, maxTime);
+
+        // a line per map and build, to compare builds with other parameters
+        FILE* report = fopen("mmaps-report.txt", "r");
+        bool newReport = !report;
+        if (report)
+            { fclose(report); }
+
+        report = fopen("mmaps-report.txt", "a");
+        if (!report)
+            { return; }
+
+        if (newReport)
+            { fprintf(report, "map maxAngle tiles polygons vertsPerPoly linksPerPoly offMeshLinks tileKBAvg tileKBMax paths completePct usAvg usMedian us95 usMax\n"); }
+
+        fprintf(report, "%03u %.1f %u %u %.2f %.2f %u %.1f %.1f %u %.1f %u %u %u %u\n", mapID, m_maxWalkableAngle,
+                tiles, polyCount, vertsPerPoly, linksPerPoly, offMeshLinks, totalTileSize / 1024.0f / tiles, maxTileSize / 1024.0f,
+                paths, completeShare, avgTime, medianTime, p95Time, maxTime);
+        fclose(report);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::writeTileArchive(uint32 mapID)
+    {
+        vector<MmapArchiveTile> index;
+        vector<vector<unsigned char> > tileData;
+        uint32 totalSize = 0;
+
+        // the names are MMMXXYY.mmtile in the coords mangosd loads the tiles by
+        for (uint32 x = 0; x < 64; ++x)
+        {
+            for (uint32 y = 0; y < 64; ++y)
+            {
+                MmapTileHeader header;
+                vector<unsigned char> data;
+                if (!readTileFile(mapID, x, y, header, data))
+                    { continue; }
+
+                MmapArchiveTile tile;
+                tile.tileId = x << 16 | y;
+                tile.size = header.size;
+                tile.flags = header.usesLiquids ? MMAP_ARCHIVE_TILE_LIQUIDS : 0;
+
+                // decompression is cheap, so the slow best compression is fine here
+                uLongf storedSize = compressBound(header.size);
+                vector<unsigned char> stored(storedSize);
+                if (compress2(&stored[0], &storedSize, &data[0], header.size, Z_BEST_COMPRESSION) == Z_OK && storedSize < header.size)
+                {
+                    stored.resize(storedSize);
+                    tile.flags |= MMAP_ARCHIVE_TILE_COMPRESSED;
+                }
+                else
+                    { stored.swap(data); }
+
+                tile.storedSize = uint32(stored.size());
+                totalSize += tile.size;
+
+                index.push_back(tile);
+                tileData.push_back(vector<unsigned char>());
+                tileData.back().swap(stored);
+            }
+        }
+
+        if (index.empty())
+            { return; }
+
+        MmapArchiveHeader header;
+        header.tileCount = uint32(index.size());
+
+        uint32 offset = uint32(sizeof(MmapArchiveHeader) + index.size() * sizeof(MmapArchiveTile));
+        for (uint32 i = 0; i < index.size(); ++i)
+        {
+            index[i].offset = offset;
+            offset += index[i].storedSize;
+        }
+
+        char fileName[255];
+        sprintf(fileName, "mmaps/%03u.mmtiles", mapID);
+        FILE* file = fopen(fileName, "wb");
+        if (!file)
+        {
+            char message[1024];
+            sprintf(message, "Failed to open %s for writing!\n", fileName);
+            perror(message);
+            return;
+        }
+
+        bool written = fwrite(&header, sizeof(MmapArchiveHeader), 1, file) == 1 &&
+                       fwrite(&index[0], sizeof(MmapArchiveTile), index.size(), file) == index.size();
+        for (uint32 i = 0; i < tileData.size() && written; ++i)
+            { written = fwrite(&tileData[i][0], tileData[i].size(), 1, file) == 1; }
+
+        fclose(file);
+
+        if (!written)
+        {
+            printf("Failed writing %s!\n", fileName);
+            remove(fileName);
+            return;
+        }
+
+        printf("Archived %u tiles of map %03u: %u bytes, %u uncompressed\n", header.tileCount, mapID, offset, totalSize);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildQueuedTiles()
+    {
+        TerrainBuilder terrainBuilder(m_skipLiquid);
+        rcContext context(false);
+
+        // the queue holds the tiles of a map in a row, the navmesh is replaced seldom
+        dtNavMesh* navMesh = NULL;
+        uint32 navMeshMapID = 0;
+
+        for (;;)
+        {
+            TileJob job;
+            {
+                ACE_GUARD(ACE_Thread_Mutex, guard, m_tileQueueLock);
+
+                if (m_tileQueue.empty())
+                    { break; }
+
+                job = m_tileQueue.front();
+                m_tileQueue.pop_front();
+            }
+
+            if (!navMesh || navMeshMapID != job.mapID)
+            {
+                dtFreeNavMesh(navMesh);
+                navMesh = dtAllocNavMesh();
+                navMeshMapID = job.mapID;
+
+                map<uint32, dtNavMeshParams>::const_iterator params = m_navMeshParams.find(job.mapID);
+                if (!navMesh || params == m_navMeshParams.end() || !navMesh->init(&params->second))
+                {
+                    printf("Failed creating navmesh of map %03u!     \n", job.mapID);
+                    dtFreeNavMesh(navMesh);
+                    navMesh = NULL;
+                    continue;
+                }
+            }
+
+            buildTile(job.mapID, job.tileX, job.tileY, navMesh, terrainBuilder, context);
+        }
+
+        dtFreeNavMesh(navMesh);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh,
+                               TerrainBuilder& terrainBuilder, rcContext& context)
     {
         printf("Building map %03u, tile [%02u,%02u]\n", mapID, tileX, tileY);
 
         MeshData meshData;
 
         // get heightmap data
-        m_terrainBuilder->loadMap(mapID, tileX, tileY, meshData);
+        terrainBuilder.loadMap(mapID, tileX, tileY, meshData);
 
         // get model data
-        m_terrainBuilder->loadVMap(mapID, tileY, tileX, meshData);
+        terrainBuilder.loadVMap(mapID, tileY, tileX, meshData);
 
         // if there is no data, give up now
         if (!meshData.solidVerts.size() && !meshData.liquidVerts.size())
@@ -299,10 +760,10 @@ namespace MMAP
         float bmin[3], bmax[3];
         getTileBounds(tileX, tileY, allVerts.getCArray(), allVerts.size() / 3, bmin, bmax);
 
-        m_terrainBuilder->loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
+        terrainBuilder.loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
 
         // build navmesh tile
-        buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
+        buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh, terrainBuilder, context);
     }
 
     /**************************************************************************/
@@ -384,7 +845,7 @@ namespace MMAP
     /**************************************************************************/
     void MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
                                       MeshData& meshData, float bmin[3], float bmax[3],
-                                      dtNavMesh* navMesh)
+                                      dtNavMesh* navMesh, TerrainBuilder& terrainBuilder, rcContext& context)
     {
         // console output
         char tileString[10];
@@ -407,12 +868,12 @@ namespace MMAP
         // these are WORLD UNIT based metrics
         // this are basic unit dimentions
         // value have to divide GRID_SIZE(533.33333f) ( aka: 0.5333, 0.2666, 0.3333, 0.1333, etc )
-        const static float BASE_UNIT_DIM = m_bigBaseUnit ? 0.533333f : 0.266666f;
+        const float BASE_UNIT_DIM = m_bigBaseUnit ? 0.533333f : 0.266666f;
 
         // All are in UNIT metrics!
-        const static int VERTEX_PER_MAP = int(GRID_SIZE / BASE_UNIT_DIM + 0.5f);
-        const static int VERTEX_PER_TILE = m_bigBaseUnit ? 40 : 80; // must divide VERTEX_PER_MAP
-        const static int TILES_PER_MAP = VERTEX_PER_MAP / VERTEX_PER_TILE;
+        const int VERTEX_PER_MAP = int(GRID_SIZE / BASE_UNIT_DIM + 0.5f);
+        const int VERTEX_PER_TILE = m_bigBaseUnit ? 40 : 80; // must divide VERTEX_PER_MAP
+        const int TILES_PER_MAP = VERTEX_PER_MAP / VERTEX_PER_TILE;
 
         rcConfig config;
         memset(&config, 0, sizeof(rcConfig));
@@ -469,7 +930,7 @@ namespace MMAP
 
                 // build heightfield
                 tile.solid = rcAllocHeightfield();
-                if (!tile.solid || !rcCreateHeightfield(m_rcContext, *tile.solid, tileCfg.width, tileCfg.height, tileCfg.bmin, tileCfg.bmax, tileCfg.cs, tileCfg.ch))
+                if (!tile.solid || !rcCreateHeightfield(&context, *tile.solid, tileCfg.width, tileCfg.height, tileCfg.bmin, tileCfg.bmax, tileCfg.cs, tileCfg.ch))
                 {
                     printf("%sFailed building heightfield!            \n", tileString);
                     continue;
@@ -478,45 +939,45 @@ namespace MMAP
                 // mark all walkable tiles, both liquids and solids
                 unsigned char* triFlags = new unsigned char[tTriCount];
                 memset(triFlags, NAV_GROUND, tTriCount * sizeof(unsigned char));
-                rcClearUnwalkableTriangles(m_rcContext, tileCfg.walkableSlopeAngle, tVerts, tVertCount, tTris, tTriCount, triFlags);
-                rcRasterizeTriangles(m_rcContext, tVerts, tVertCount, tTris, triFlags, tTriCount, *tile.solid, config.walkableClimb);
+                rcClearUnwalkableTriangles(&context, tileCfg.walkableSlopeAngle, tVerts, tVertCount, tTris, tTriCount, triFlags);
+                rcRasterizeTriangles(&context, tVerts, tVertCount, tTris, triFlags, tTriCount, *tile.solid, config.walkableClimb);
                 delete [] triFlags;
 
-                rcFilterLowHangingWalkableObstacles(m_rcContext, config.walkableClimb, *tile.solid);
-                rcFilterLedgeSpans(m_rcContext, tileCfg.walkableHeight, tileCfg.walkableClimb, *tile.solid);
-                rcFilterWalkableLowHeightSpans(m_rcContext, tileCfg.walkableHeight, *tile.solid);
+                rcFilterLowHangingWalkableObstacles(&context, config.walkableClimb, *tile.solid);
+                rcFilterLedgeSpans(&context, tileCfg.walkableHeight, tileCfg.walkableClimb, *tile.solid);
+                rcFilterWalkableLowHeightSpans(&context, tileCfg.walkableHeight, *tile.solid);
 
-                rcRasterizeTriangles(m_rcContext, lVerts, lVertCount, lTris, lTriFlags, lTriCount, *tile.solid, config.walkableClimb);
+                rcRasterizeTriangles(&context, lVerts, lVertCount, lTris, lTriFlags, lTriCount, *tile.solid, config.walkableClimb);
 
                 // compact heightfield spans
                 tile.chf = rcAllocCompactHeightfield();
-                if (!tile.chf || !rcBuildCompactHeightfield(m_rcContext, tileCfg.walkableHeight, tileCfg.walkableClimb, *tile.solid, *tile.chf))
+                if (!tile.chf || !rcBuildCompactHeightfield(&context, tileCfg.walkableHeight, tileCfg.walkableClimb, *tile.solid, *tile.chf))
                 {
                     printf("%sFailed compacting heightfield!            \n", tileString);
                     continue;
                 }
 
                 // build polymesh intermediates
-                if (!rcErodeWalkableArea(m_rcContext, config.walkableRadius, *tile.chf))
+                if (!rcErodeWalkableArea(&context, config.walkableRadius, *tile.chf))
                 {
                     printf("%sFailed eroding area!                    \n", tileString);
                     continue;
                 }
 
-                if (!rcBuildDistanceField(m_rcContext, *tile.chf))
+                if (!rcBuildDistanceField(&context, *tile.chf))
                 {
                     printf("%sFailed building distance field!         \n", tileString);
                     continue;
                 }
 
-                if (!rcBuildRegions(m_rcContext, *tile.chf, tileCfg.borderSize, tileCfg.minRegionArea, tileCfg.mergeRegionArea))
+                if (!rcBuildRegions(&context, *tile.chf, tileCfg.borderSize, tileCfg.minRegionArea, tileCfg.mergeRegionArea))
                 {
                     printf("%sFailed building regions!                \n", tileString);
                     continue;
                 }
 
                 tile.cset = rcAllocContourSet();
-                if (!tile.cset || !rcBuildContours(m_rcContext, *tile.chf, tileCfg.maxSimplificationError, tileCfg.maxEdgeLen, *tile.cset))
+                if (!tile.cset || !rcBuildContours(&context, *tile.chf, tileCfg.maxSimplificationError, tileCfg.maxEdgeLen, *tile.cset))
                 {
                     printf("%sFailed building contours!               \n", tileString);
                     continue;
@@ -524,14 +985,14 @@ namespace MMAP
 
                 // build polymesh
                 tile.pmesh = rcAllocPolyMesh();
-                if (!tile.pmesh || !rcBuildPolyMesh(m_rcContext, *tile.cset, tileCfg.maxVertsPerPoly, *tile.pmesh))
+                if (!tile.pmesh || !rcBuildPolyMesh(&context, *tile.cset, tileCfg.maxVertsPerPoly, *tile.pmesh))
                 {
                     printf("%sFailed building polymesh!               \n", tileString);
                     continue;
                 }
 
                 tile.dmesh = rcAllocPolyMeshDetail();
-                if (!tile.dmesh || !rcBuildPolyMeshDetail(m_rcContext, *tile.pmesh, *tile.chf, tileCfg.detailSampleDist, tileCfg    .detailSampleMaxError, *tile.dmesh))
+                if (!tile.dmesh || !rcBuildPolyMeshDetail(&context, *tile.pmesh, *tile.chf, tileCfg.detailSampleDist, tileCfg    .detailSampleMaxError, *tile.dmesh))
                 {
                     printf("%sFailed building polymesh detail!        \n", tileString);
                     continue;
@@ -588,7 +1049,7 @@ namespace MMAP
             delete [] tiles;
             return;
         }
-        rcMergePolyMeshes(m_rcContext, pmmerge, nmerge, *iv.polyMesh);
+        rcMergePolyMeshes(&context, pmmerge, nmerge, *iv.polyMesh);
 
         iv.polyMeshDetail = rcAllocPolyMeshDetail();
         if (!iv.polyMeshDetail)
@@ -597,7 +1058,7 @@ namespace MMAP
             delete [] tiles;
             return;
         }
-        rcMergePolyMeshDetails(m_rcContext, dmmerge, nmerge, *iv.polyMeshDetail);
+        rcMergePolyMeshDetails(&context, dmmerge, nmerge, *iv.polyMeshDetail);
 
         // free things up
         delete [] pmmerge;
@@ -730,7 +1191,7 @@ namespace MMAP
 
             // write header
             MmapTileHeader header;
-            header.usesLiquids = m_terrainBuilder->usesLiquids();
+            header.usesLiquids = terrainBuilder.usesLiquids();
             header.size = uint32(navDataSize);
             fwrite(&header, sizeof(MmapTileHeader), 1, file);
 
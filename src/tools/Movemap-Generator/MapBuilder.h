@@ -28,6 +28,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <deque>
 
 #include <Recast.h>
 #include <DetourNavMesh.h>
@@ -38,6 +39,8 @@
 #include "IVMapManager.h"
 #include "WorldModel.h"
 
+#include <ace/Thread_Mutex.h>
+
 using namespace std;
 using namespace VMAP;
 // G3D namespace typedefs conflicts with ACE typedefs
@@ -79,6 +82,17 @@ namespace MMAP
         rcPolyMeshDetail* dmesh; /**< TODO */
     };
 
+    /**
+     * @brief tile waiting in the queue of the tile workers
+     *
+     */
+    struct TileJob
+    {
+        uint32 mapID; /**< TODO */
+        uint32 tileX; /**< TODO */
+        uint32 tileY; /**< TODO */
+    };
+
     /**
      * @brief
      *
@@ -97,6 +111,9 @@ namespace MMAP
              * @param debugOutput
              * @param bigBaseUnit
              * @param offMeshFilePath
+             * @param threads number of threads building tiles, 1 builds them on the calling thread
+             * @param archive also write the tiles of every built map into one compressed archive
+             * @param reportQueries paths sampled for the report of every built map, 0 writes no report
              */
             MapBuilder(float maxWalkableAngle   = 60.f,
                        bool skipLiquid          = false,
@@ -105,7 +122,10 @@ namespace MMAP
                        bool skipBattlegrounds   = false,
                        bool debugOutput         = false,
                        bool bigBaseUnit         = false,
-                       const char* offMeshFilePath = NULL);
+                       const char* offMeshFilePath = NULL,
+                       uint32 threads           = 1,
+                       bool archive             = false,
+                       uint32 reportQueries     = 0);
 
             /**
              * @brief
@@ -135,6 +155,14 @@ namespace MMAP
              */
             void buildAllMaps();
 
+            /**
+             * @brief builds tiles of the queue until it is empty, run by every tile worker thread
+             *
+             * Every worker has its own Recast context, terrain builder and navmesh, so the tiles
+             * are built without locking. Only taking the next tile locks the queue.
+             */
+            void buildQueuedTiles();
+
         private:
             /**
              * @brief detect maps and tiles
@@ -157,6 +185,55 @@ namespace MMAP
              */
             void buildNavMesh(uint32 mapID, dtNavMesh*& navMesh);
 
+            /**
+             * @brief writes the navmesh params of the map and puts its tiles into the tile queue
+             *
+             * @param mapID
+             */
+            void queueMap(uint32 mapID);
+
+            /**
+             * @brief builds the tiles of the queue on the worker threads and waits for them
+             *
+             */
+            void runTileWorkers();
+
+            /**
+             * @brief writes all mmtile files of the map into mmaps/MMM.mmtiles, compressed where that is smaller
+             *
+             * @param mapID
+             */
+            void writeTileArchive(uint32 mapID);
+
+            /**
+             * @brief prints the navmesh statistics and path query timings of the map, and adds them to mmaps-report.txt
+             *
+             * The navmesh is loaded from the written files, the paths run between polygons chosen
+             * at random, but the same ones for every build of the map.
+             *
+             * @param mapID
+             */
+            void writeReport(uint32 mapID);
+
+            /**
+             * @brief writes the archive and the report of a built map, if they are asked for
+             *
+             * @param mapID
+             */
+            void finishMap(uint32 mapID);
+
+            /**
+             * @brief reads mmaps/MMMXXYY.mmtile
+             *
+             * @param mapID
+             * @param x first coord of the file name
+             * @param y second coord of the file name
+             * @param header
+             * @param data receives the navmesh data
+             * @return bool false if the file is missing, damaged or of an older version
+             */
+            bool readTileFile(uint32 mapID, uint32 x, uint32 y, MmapTileHeader& header, vector<unsigned char>& data);
+
             /**
              * @brief
              *
@@ -164,8 +241,11 @@ namespace MMAP
              * @param tileX
              * @param tileY
              * @param navMesh
+             * @param terrainBuilder
+             * @param context
              */
-            void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+            void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh,
+                           TerrainBuilder& terrainBuilder, rcContext& context);
 
             /**
              * @brief move map building
@@ -177,6 +257,8 @@ namespace MMAP
              * @param bmin[]
              * @param bmax[]
              * @param navMesh
+             * @param terrainBuilder
+             * @param context
              */
             void buildMoveMapTile(uint32 mapID,
                                   uint32 tileX,
@@ -184,7 +266,9 @@ namespace MMAP
                                   MeshData& meshData,
                                   float bmin[3],
                                   float bmax[3],
-                                  dtNavMesh* navMesh);
+                                  dtNavMesh* navMesh,
+                                  TerrainBuilder& terrainBuilder,
+                                  rcContext& context);
 
             /**
              * @brief
@@ -248,6 +332,15 @@ namespace MMAP
             bool m_bigBaseUnit; /**< TODO */
 
             rcContext* m_rcContext; /**< build performance - not really used for now */
+
+            bool m_skipLiquid; /**< TODO */
+            uint32 m_threads; /**< TODO */
+            bool m_archive; /**< see writeTileArchive */
+            uint32 m_reportQueries; /**< see writeReport */
+
+            deque<TileJob> m_tileQueue; /**< tiles left for the workers */
+            ACE_Thread_Mutex m_tileQueueLock; /**< TODO */
+            map<uint32, dtNavMeshParams> m_navMeshParams; /**< params of the queued maps, not changed while the workers run */
     };
 }
 
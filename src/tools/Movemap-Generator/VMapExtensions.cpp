@@ -58,9 +58,30 @@ namespace VMAP
     // declared in src/shared/vmap/WorldModel.h
     void GroupModel::getMeshData(vector<Vector3>& vertices, vector<MeshTriangle>& triangles, WmoLiquid*& liquid)
     {
-        vertices = this->vertices;
-        triangles = this->triangles;
         liquid = iLiquid;
+        if (!iMappedTriangles)
+        {
+            vertices = this->vertices;
+            triangles = this->triangles;
+            return;
+        }
+
+        // mapped model files only keep the quantized corners of each triangle
+        vertices.clear();
+        triangles.clear();
+        vertices.reserve(iMappedTriangleCount * 3);
+        triangles.reserve(iMappedTriangleCount);
+        for (uint32 i = 0; i < iMappedTriangleCount; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                Vector3 corner;
+                for (int c = 0; c < 3; ++c)
+                    { corner[c] = iQuantOrigin[c] + iMappedTriangles[(k * 3 + c) * iMappedTriangleCount + i] * iQuantScale[c]; }
+                vertices.push_back(corner);
+            }
+            triangles.push_back(MeshTriangle(i * 3, i * 3 + 1, i * 3 + 2));
+        }
     }
 
     // declared in src/shared/vmap/ModelInstance.h
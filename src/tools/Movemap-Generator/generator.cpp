@@ -80,6 +80,11 @@ void printUsage(char* prg)
     printf("                                     connections data\n");
     printf("   --debugOutput [true|false]        create debugging files for use with\n");
     printf("                                     RecastDemo.\n");
+    printf("   --threads [#]                     number of threads building tiles.\n");
+    printf("   --archive [true|false]            also pack the tiles of each map into a\n");
+    printf("                                     compressed mmaps/MMM.mmtiles archive.\n");
+    printf("   --report [#]                      report the navmesh of each map, timing\n");
+    printf("                                     this many paths (default 0: no report).\n");
     printf("   --silent                          No questions asked.\n");
     printf("   [#]                               Build only the map specified by #.\n");
     printf("\n");
@@ -104,7 +109,10 @@ bool handleArgs(int argc, char** argv,
                 bool& debugOutput,
                 bool& silent,
                 bool& bigBaseUnit,
-                char*& offMeshInputPath)
+                char*& offMeshInputPath,
+                int& threads,
+                bool& archive,
+                int& reportQueries)
 {
     char* param = NULL;
     for (int i = 1; i < argc; ++i)
@@ -233,6 +241,43 @@ bool handleArgs(int argc, char** argv,
 
             offMeshInputPath = param;
         }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+                { return false; }
+
+            int count = atoi(param);
+            if (count > 0 && count <= 64)
+                { threads = count; }
+            else
+                { printf("invalid option for '--threads', using default 1\n"); }
+        }
+        else if (strcmp(argv[i], "--archive") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+                { return false; }
+
+            if (strcmp(param, "true") == 0)
+                { archive = true; }
+            else if (strcmp(param, "false") == 0)
+                { archive = false; }
+            else
+                { printf("invalid option for '--archive', using default false\n"); }
+        }
+        else if (strcmp(argv[i], "--report") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+                { return false; }
+
+            int count = atoi(param);
+            if (count >= 0)
+                { reportQueries = count; }
+            else
+                { printf("invalid option for '--report', using default 0\n"); }
+        }
         else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
         {
             printUsage(argv[0]);
@@ -274,13 +319,16 @@ int main(int argc, char** argv)
          skipBattlegrounds = false,
          debugOutput = false,
          silent = false,
-         bigBaseUnit = false;
+         bigBaseUnit = false,
+         archive = false;
     char* offMeshInputPath = NULL;
+    int threads = 1;
+    int reportQueries = 0;
 
     bool validParam = handleArgs(argc, argv, mapnum,
                                  tileX, tileY, maxAngle,
                                  skipLiquid, skipContinents, skipJunkMaps, skipBattlegrounds,
-                                 debugOutput, silent, bigBaseUnit, offMeshInputPath);
+                                 debugOutput, silent, bigBaseUnit, offMeshInputPath, threads, archive, reportQueries);
 
     if (!validParam)
         { return silent ? -1 : finish("You have specified invalid parameters (use -? for more help)", -1); }
@@ -301,7 +349,7 @@ int main(int argc, char** argv)
         { return silent ? -3 : finish("Press any key to close...", -3); }
 
     MapBuilder builder(maxAngle, skipLiquid, skipContinents, skipJunkMaps,
-                       skipBattlegrounds, debugOutput, bigBaseUnit, offMeshInputPath);
+                       skipBattlegrounds, debugOutput, bigBaseUnit, offMeshInputPath, uint32(threads), archive, uint32(reportQueries));
 
     if (tileX > -1 && tileY > -1 && mapnum >= 0)
         { builder.buildSingleTile(mapnum, tileX, tileY); }
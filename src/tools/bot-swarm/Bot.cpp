@@ -0,0 +1,912 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "Bot.h"
+#include "AuthCodes.h"
+#include "Auth/Sha1.h"
+#include "Timer.h"
+#include "Util.h"
+
+#include <ace/Reactor.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/OS_NS_errno.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define BOT_CLIENT_BUILD        5875                        // 1.12.1
+#define BOT_STEP_TIMEOUT        (30 * IN_MILLISECONDS)      // for every login and logout step
+#define BOT_PING_INTERVAL       (30 * IN_MILLISECONDS)      // the server counts faster pings as overspeed
+#define BOT_HEARTBEAT_INTERVAL  500
+#define BOT_RUN_SPEED           7.0f                        // yards per second
+
+/// Values of the game opcodes the bots use, the game headers are not included
+enum BotOpcodes
+{
+    CMSG_CHAR_CREATE                = 0x036,
+    CMSG_CHAR_ENUM                  = 0x037,
+    SMSG_CHAR_CREATE                = 0x03A,
+    SMSG_CHAR_ENUM                  = 0x03B,
+    CMSG_PLAYER_LOGIN               = 0x03D,
+    CMSG_LOGOUT_REQUEST             = 0x04B,
+    SMSG_LOGOUT_RESPONSE            = 0x04C,
+    SMSG_LOGOUT_COMPLETE            = 0x04D,
+    CMSG_MESSAGECHAT                = 0x095,
+    SMSG_MESSAGECHAT                = 0x096,
+    MSG_MOVE_START_FORWARD          = 0x0B5,
+    MSG_MOVE_STOP                   = 0x0B7,
+    MSG_MOVE_SET_FACING             = 0x0DA,
+    MSG_MOVE_HEARTBEAT              = 0x0EE,
+    CMSG_PING                       = 0x1DC,
+    SMSG_PONG                       = 0x1DD,
+    SMSG_AUTH_CHALLENGE             = 0x1EC,
+    CMSG_AUTH_SESSION               = 0x1ED,
+    SMSG_AUTH_RESPONSE              = 0x1EE,
+    SMSG_LOGIN_VERIFY_WORLD         = 0x236
+};
+
+// values of SharedDefines.h and Unit.h
+#define BOT_AUTH_OK                 0x0C
+#define BOT_AUTH_WAIT_QUEUE         0x1B
+#define BOT_CHAR_CREATE_SUCCESS     0x2E
+#define BOT_CHAT_MSG_SAY            0x00
+#define BOT_LANG_COMMON             7
+#define BOT_MOVEFLAG_MOVE_FORWARD   0x00000001
+#define BOT_REALM_FLAG_OFFLINE      0x02
+
+/// Size of the realmd challenge answer with the SRP6 values, without security flag data
+#define REALM_CHALLENGE_SIZE    119
+/// Size of the realmd proof answer of 1.12 clients
+#define REALM_PROOF_SIZE        26
+
+Bot::Bot(SwarmConfig const& config, SwarmStats& stats, uint32 index, ACE_Reactor* reactor) :
+    ACE_Event_Handler(reactor), m_config(config), m_stats(stats), m_index(index), m_state(BOT_WAITING),
+    m_stateTime(0), m_phaseStart(0), m_connecting(false), m_headerDecrypted(false), m_created(false),
+    m_characterGuid(0), m_x(0.0f), m_y(0.0f), m_z(0.0f), m_o(0.0f), m_inWorldTime(0), m_nextPing(0), m_pingSeq(0),
+    m_pingTime(0), m_latency(0), m_nextAction(0), m_chatTime(0), m_moving(false), m_moveTime(0)
+{
+    char number[16];
+    snprintf(number, sizeof(number), "%u", config.firstAccount + index);
+    m_account = config.accountPrefix + number;
+    m_password = config.password.empty() ? m_account : config.password;
+
+    // the client sends both in upper case, realmd hashes them so
+    std::transform(m_account.begin(), m_account.end(), m_account.begin(), ::toupper);
+    std::transform(m_password.begin(), m_password.end(), m_password.begin(), ::toupper);
+
+    memset(m_expectedProof, 0, sizeof(m_expectedProof));
+    m_stats.AddBot();
+}
+
+Bot::~Bot()
+{
+    Disconnect();
+}
+
+ACE_HANDLE Bot::get_handle() const
+{
+    return m_peer.get_handle();
+}
+
+void Bot::SetState(BotState state)
+{
+    m_stats.ChangeState(m_state, state);
+    m_state = state;
+    m_stateTime = WorldTimer::getMSTime();
+}
+
+void Bot::Fail(char const* reason)
+{
+    if (IsFinished())
+        { return; }
+
+    m_stats.AddFailure(m_state, reason);
+    Disconnect();
+    SetState(BOT_FAILED);
+}
+
+void Bot::Stop()
+{
+    Disconnect();
+}
+
+void Bot::Update(uint32 now, uint32 elapsed)
+{
+    switch (m_state)
+    {
+        case BOT_WAITING:
+            // the starts are spread evenly at the connect rate
+            if (uint64(elapsed) * m_config.connectRate >= uint64(m_index) * IN_MILLISECONDS)
+            {
+                SetState(BOT_REALM_CONNECT);
+                m_phaseStart = now;
+                Connect(m_config.realmAddress);
+            }
+            break;
+        case BOT_IN_WORLD:
+            if (m_config.duration && WorldTimer::getMSTimeDiff(m_inWorldTime, now) >= m_config.duration * IN_MILLISECONDS)
+            {
+                if (m_moving)
+                    { SendMovement(MSG_MOVE_STOP, 0, now); }
+
+                SetState(BOT_LOGOUT);
+                SendWorldPacket(CMSG_LOGOUT_REQUEST, ByteBuffer());
+                break;
+            }
+
+            Act(now);
+            break;
+        case BOT_WORLD_AUTH:
+        case BOT_DONE:
+        case BOT_FAILED:
+            break;                                          // the login queue has no time limit
+        default:
+            if (WorldTimer::getMSTimeDiff(m_stateTime, now) >= BOT_STEP_TIMEOUT)
+                { Fail("timeout"); }
+            break;
+    }
+}
+
+// --------------------------------------  Connection  --------------------------------------- //
+
+void Bot::Connect(ACE_INET_Addr const& address)
+{
+    m_input.clear();
+    m_output.clear();
+    m_headerDecrypted = false;
+
+    ACE_SOCK_Connector connector;
+    if (connector.connect(m_peer, address, &ACE_Time_Value::zero) == 0)
+    {
+        OnConnected();
+        return;
+    }
+
+    if (ACE_OS::last_error() != EWOULDBLOCK && ACE_OS::last_error() != EINPROGRESS)
+    {
+        Fail("connect refused");
+        return;
+    }
+
+    // completed in handle_output
+    m_connecting = true;
+    if (reactor()->register_handler(this, ACE_Event_Handler::CONNECT_MASK) == -1)
+        { Fail("socket not registered"); }
+}
+
+void Bot::OnConnected()
+{
+    m_connecting = false;
+    m_peer.enable(ACE_NONBLOCK);
+
+    if (reactor()->register_handler(this, ACE_Event_Handler::READ_MASK) == -1)
+    {
+        Fail("socket not registered");
+        return;
+    }
+
+    if (m_state == BOT_REALM_CONNECT)
+    {
+        SetState(BOT_REALM_CHALLENGE);
+        SendRealmChallenge();
+    }
+    else
+        { SetState(BOT_WORLD_CHALLENGE); }                 // the server starts with SMSG_AUTH_CHALLENGE
+}
+
+void Bot::Disconnect()
+{
+    if (m_peer.get_handle() == ACE_INVALID_HANDLE)
+        { return; }
+
+    reactor()->remove_handler(this, ACE_Event_Handler::ALL_EVENTS_MASK | ACE_Event_Handler::DONT_CALL);
+    m_peer.close();
+    m_connecting = false;
+}
+
+int Bot::handle_output(ACE_HANDLE)
+{
+    if (m_connecting)
+    {
+        ACE_SOCK_Connector connector;
+        if (connector.complete(m_peer, NULL, &ACE_Time_Value::zero) == -1)
+        {
+            Fail("connect failed");
+            return 0;
+        }
+
+        reactor()->remove_handler(this, ACE_Event_Handler::ALL_EVENTS_MASK | ACE_Event_Handler::DONT_CALL);
+        OnConnected();
+        return 0;
+    }
+
+    Flush();
+    return 0;
+}
+
+int Bot::handle_input(ACE_HANDLE)
+{
+    // a failed connect may be reported as readable
+    if (m_connecting)
+        { return handle_output(); }
+
+    uint8 buf[16 * 1024];
+    ssize_t count = m_peer.recv(buf, sizeof(buf));
+
+    if (count == 0)
+    {
+        Fail("connection closed by the server");
+        return 0;
+    }
+
+    if (count < 0)
+    {
+        if (ACE_OS::last_error() != EWOULDBLOCK)
+            { Fail("receive failed"); }
+        return 0;
+    }
+
+    m_stats.CountReceived(size_t(count));
+    m_input.insert(m_input.end(), buf, buf + count);
+
+    if (m_state < BOT_WORLD_CONNECT)
+        { ProcessRealm(); }
+    else
+        { ProcessWorld(); }
+
+    return 0;
+}
+
+void Bot::Send(ByteBuffer const& data)
+{
+    if (m_peer.get_handle() == ACE_INVALID_HANDLE)
+        { return; }
+
+    m_stats.CountSent(data.size());
+
+    bool waiting = !m_output.empty();
+    m_output.insert(m_output.end(), data.contents(), data.contents() + data.size());
+
+    // the rest is sent when the socket is writable again
+    if (!waiting)
+        { Flush(); }
+}
+
+void Bot::Flush()
+{
+    if (m_output.empty())
+        { return; }
+
+    ssize_t count = m_peer.send(&m_output[0], m_output.size());
+    if (count < 0)
+    {
+        if (ACE_OS::last_error() != EWOULDBLOCK)
+        {
+            Fail("send failed");
+            return;
+        }
+
+        count = 0;
+    }
+
+    bool waiting = m_output.size() != size_t(count);
+    m_output.erase(m_output.begin(), m_output.begin() + count);
+
+    if (waiting)
+        { reactor()->schedule_wakeup(this, ACE_Event_Handler::WRITE_MASK); }
+    else
+        { reactor()->cancel_wakeup(this, ACE_Event_Handler::WRITE_MASK); }
+}
+
+// ---------------------------------------  realmd  ---------------------------------------- //
+
+void Bot::SendRealmChallenge()
+{
+    ByteBuffer packet;
+    packet << uint8(CMD_AUTH_LOGON_CHALLENGE);
+    packet << uint8(3);                                     // protocol version
+    packet << uint16(30 + m_account.size());                // size of the rest
+    packet.append("WoW", 4);
+    packet << uint8(1) << uint8(12) << uint8(1);            // client version
+    packet << uint16(BOT_CLIENT_BUILD);
+    packet.append("68x", 4);                                // platform x86, reversed like the client sends it
+    packet.append("niW", 4);                                // os Win
+    packet.append("SUne", 4);                               // locale enUS
+    packet << uint32(0);                                    // timezone bias
+    packet << uint32(0x0100007F);                           // ip, only logged
+    packet << uint8(m_account.size());
+    packet.append(m_account.c_str(), m_account.size());
+
+    Send(packet);
+}
+
+bool Bot::ProcessRealm()
+{
+    switch (m_state)
+    {
+        case BOT_REALM_CHALLENGE:
+            return HandleRealmChallenge();
+        case BOT_REALM_PROOF:
+            return HandleRealmProof();
+        case BOT_REALM_LIST:
+            return HandleRealmList();
+        default:
+            Fail("unexpected realmd data");
+            return false;
+    }
+}
+
+bool Bot::HandleRealmChallenge()
+{
+    if (m_input.size() < 3)
+        { return false; }
+
+    if (m_input[2] != WOW_SUCCESS)
+    {
+        Fail(m_input[2] == WOW_FAIL_UNKNOWN_ACCOUNT ? "unknown account" : "login refused");
+        return false;
+    }
+
+    if (m_input.size() < REALM_CHALLENGE_SIZE)
+        { return false; }
+
+    uint8 const* data = &m_input[3];
+    if (data[32] != 1 || data[34] != 32 || data[115])
+    {
+        Fail("unsupported challenge");                      // other lengths or PIN and matrix input
+        return false;
+    }
+
+    BigNumber B, g, N, s;
+    B.SetBinary(data, 32);
+    g.SetBinary(data + 33, 1);
+    N.SetBinary(data + 35, 32);
+    s.SetBinary(data + 67, 32);
+
+    // x = H(s, H(I:P)), the password hash realmd stores
+    Sha1Hash sha;
+    sha.UpdateData(m_account + ":" + m_password);
+    sha.Finalize();
+    uint8 passwordHash[SHA_DIGEST_LENGTH];
+    memcpy(passwordHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+    sha.UpdateData(passwordHash, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+    BigNumber a;
+    a.SetRand(19 * 8);
+    m_A = g.ModExp(a, N);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&m_A, &B, NULL);
+    sha.Finalize();
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    // S = (B - 3 * g^x)^(a + u * x), B + 3 * N keeps the difference positive
+    BigNumber k(3);
+    BigNumber v = g.ModExp(x, N);
+    BigNumber base = (B + N * k - v * k) % N;
+    BigNumber S = base.ModExp(a + u * x, N);
+
+    // session key, interleaved hashes of the even and odd bytes of S as realmd does
+    uint8 t[32];
+    uint8 t1[16];
+    uint8 vK[40];
+    memcpy(t, S.AsByteArray(32), 32);
+    for (int i = 0; i < 16; ++i)
+        { t1[i] = t[i * 2]; }
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        { vK[i * 2] = sha.GetDigest()[i]; }
+    for (int i = 0; i < 16; ++i)
+        { t1[i] = t[i * 2 + 1]; }
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        { vK[i * 2 + 1] = sha.GetDigest()[i]; }
+    m_K.SetBinary(vK, 40);
+
+    // M1 = H(H(N) xor H(g), H(I), s, A, B, K)
+    uint8 hash[20];
+    sha.Initialize();
+    sha.UpdateBigNumbers(&N, NULL);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, NULL);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        { hash[i] ^= sha.GetDigest()[i]; }
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(m_account);
+    sha.Finalize();
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, NULL);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &m_A, &B, &m_K, NULL);
+    sha.Finalize();
+    BigNumber M;
+    M.SetBinary(sha.GetDigest(), 20);
+
+    // M2 = H(A, M1, K), checked against the answer
+    sha.Initialize();
+    sha.UpdateBigNumbers(&m_A, &M, &m_K, NULL);
+    sha.Finalize();
+    memcpy(m_expectedProof, sha.GetDigest(), sizeof(m_expectedProof));
+
+    m_input.erase(m_input.begin(), m_input.begin() + REALM_CHALLENGE_SIZE);
+
+    ByteBuffer packet;
+    packet << uint8(CMD_AUTH_LOGON_PROOF);
+    packet.append(m_A.AsByteArray(32), 32);
+    packet.append(M.AsByteArray(20), 20);
+    for (int i = 0; i < 20; ++i)
+        { packet << uint8(0); }                             // crc hash of the client files, not checked
+    packet << uint8(0);                                     // number of keys
+    packet << uint8(0);                                     // security flags
+
+    SetState(BOT_REALM_PROOF);
+    Send(packet);
+    return true;
+}
+
+bool Bot::HandleRealmProof()
+{
+    if (m_input.size() < 2)
+        { return false; }
+
+    if (m_input[1] != 0)
+    {
+        Fail("wrong password");
+        return false;
+    }
+
+    if (m_input.size() < REALM_PROOF_SIZE)
+        { return false; }
+
+    if (memcmp(&m_input[2], m_expectedProof, sizeof(m_expectedProof)) != 0)
+    {
+        Fail("server proof mismatch");
+        return false;
+    }
+
+    m_input.erase(m_input.begin(), m_input.begin() + REALM_PROOF_SIZE);
+    m_stats.AddLatency(LATENCY_REALM_LOGIN, WorldTimer::getMSTimeDiff(m_phaseStart, WorldTimer::getMSTime()));
+
+    ByteBuffer packet;
+    packet << uint8(CMD_REALM_LIST);
+    packet << uint32(0);
+
+    SetState(BOT_REALM_LIST);
+    Send(packet);
+    return true;
+}
+
+bool Bot::HandleRealmList()
+{
+    if (m_input.size() < 3)
+        { return false; }
+
+    size_t size = 3 + (m_input[1] | (m_input[2] << 8));
+    if (m_input.size() < size)
+        { return false; }
+
+    ByteBuffer packet;
+    packet.append(&m_input[3], size - 3);
+    m_input.clear();
+
+    try
+    {
+        packet.read_skip<uint32>();
+        uint8 count = packet.read<uint8>();
+
+        for (uint8 i = 0; i < count; ++i)
+        {
+            std::string name, address;
+            packet.read_skip<uint32>();                     // icon
+            uint8 flags = packet.read<uint8>();
+            packet >> name >> address;
+            packet.read_skip<float>();                      // population
+            packet.read_skip<uint8>();                      // characters
+            packet.read_skip<uint8>();                      // timezone
+            packet.read_skip<uint8>();
+
+            if (m_config.realmName.empty() ? (flags & BOT_REALM_FLAG_OFFLINE) != 0 : name != m_config.realmName)
+                { continue; }
+
+            if (m_worldAddress.set(address.c_str()) == -1)
+            {
+                Fail("realm address not resolved");
+                return false;
+            }
+
+            Disconnect();
+            SetState(BOT_WORLD_CONNECT);
+            m_phaseStart = WorldTimer::getMSTime();
+            Connect(m_worldAddress);
+            return true;
+        }
+    }
+    catch (ByteBufferException&)
+    {
+        Fail("bad realm list");
+        return false;
+    }
+
+    Fail("realm not in the realm list");
+    return false;
+}
+
+// ------------------------------------  world server  ------------------------------------ //
+
+void Bot::SendWorldPacket(uint16 opcode, ByteBuffer const& payload)
+{
+    // client header: big endian size with the opcode, 32 bit opcode
+    uint16 size = uint16(payload.size() + 4);
+    uint8 header[AuthCrypt::CRYPTED_RECV_LEN];
+    header[0] = uint8(size >> 8);
+    header[1] = uint8(size);
+    header[2] = uint8(opcode);
+    header[3] = uint8(opcode >> 8);
+    header[4] = 0;
+    header[5] = 0;
+
+    m_crypt.EncryptClientHeader(header);
+
+    ByteBuffer packet(sizeof(header) + payload.size());
+    packet.append(header, sizeof(header));
+    if (payload.size())
+        { packet.append(payload); }
+
+    Send(packet);
+}
+
+bool Bot::ProcessWorld()
+{
+    while (m_input.size() >= AuthCrypt::CRYPTED_SEND_LEN && !IsFinished())
+    {
+        // decrypted once, the key stream moves on with every header
+        if (!m_headerDecrypted)
+        {
+            m_crypt.DecryptServerHeader(&m_input[0]);
+            m_headerDecrypted = true;
+        }
+
+        size_t size = (m_input[0] << 8) | m_input[1];
+        uint16 opcode = uint16(m_input[2] | (m_input[3] << 8));
+        if (size < 2)
+        {
+            Fail("bad packet header");
+            return false;
+        }
+
+        if (m_input.size() < 2 + size)
+            { return true; }
+
+        ByteBuffer packet(size - 2);
+        if (size > 2)
+            { packet.append(&m_input[4], size - 2); }
+
+        m_input.erase(m_input.begin(), m_input.begin() + 2 + size);
+        m_headerDecrypted = false;
+
+        try
+        {
+            HandleWorldPacket(opcode, packet);
+        }
+        catch (ByteBufferException&)
+        {
+            Fail("packet too short");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Bot::HandleWorldPacket(uint16 opcode, ByteBuffer& packet)
+{
+    switch (opcode)
+    {
+        case SMSG_AUTH_CHALLENGE:
+            HandleAuthChallenge(packet);
+            break;
+        case SMSG_AUTH_RESPONSE:
+            HandleAuthResponse(packet);
+            break;
+        case SMSG_CHAR_ENUM:
+            HandleCharEnum(packet);
+            break;
+        case SMSG_CHAR_CREATE:
+            HandleCharCreate(packet);
+            break;
+        case SMSG_LOGIN_VERIFY_WORLD:
+            HandleLoginVerifyWorld(packet);
+            break;
+        case SMSG_PONG:
+            HandlePong(packet);
+            break;
+        case SMSG_MESSAGECHAT:
+            HandleMessageChat(packet);
+            break;
+        case SMSG_LOGOUT_RESPONSE:
+            if (packet.read<uint32>() != 0)                 // refused, in combat
+            {
+                Disconnect();
+                SetState(BOT_DONE);
+            }
+            break;
+        case SMSG_LOGOUT_COMPLETE:
+            Disconnect();
+            SetState(BOT_DONE);
+            break;
+        default:
+            break;                                          // world updates, only counted
+    }
+}
+
+void Bot::HandleAuthChallenge(ByteBuffer& packet)
+{
+    if (m_state != BOT_WORLD_CHALLENGE)
+        { return; }
+
+    uint32 serverSeed = packet.read<uint32>();
+    uint32 clientSeed = uint32(rand32());
+
+    // H(I, 0, client seed, server seed, K), checked by WorldSocket::AuthenticateSession
+    Sha1Hash sha;
+    uint32 t = 0;
+    sha.UpdateData(m_account);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&m_K, NULL);
+    sha.Finalize();
+
+    ByteBuffer session;
+    session << uint32(BOT_CLIENT_BUILD);
+    session << uint32(0);
+    session << m_account;
+    session << uint32(clientSeed);
+    session.append(sha.GetDigest(), 20);
+    session << uint32(0);                                   // no addon info
+
+    SetState(BOT_WORLD_AUTH);
+    SendWorldPacket(CMSG_AUTH_SESSION, session);
+
+    // all headers after the session are encrypted, both ways
+    m_crypt.SetKey(m_K.AsByteArray(40), 40);
+    m_crypt.Init();
+}
+
+void Bot::HandleAuthResponse(ByteBuffer& packet)
+{
+    uint8 result = packet.read<uint8>();
+
+    if (result == BOT_AUTH_WAIT_QUEUE)
+        { return; }                                         // AUTH_OK follows when the queue moved on
+
+    if (result != BOT_AUTH_OK)
+    {
+        Fail("world login refused");
+        return;
+    }
+
+    m_stats.AddLatency(LATENCY_WORLD_AUTH, WorldTimer::getMSTimeDiff(m_phaseStart, WorldTimer::getMSTime()));
+
+    SetState(BOT_CHAR_ENUM);
+    SendWorldPacket(CMSG_CHAR_ENUM, ByteBuffer());
+}
+
+void Bot::HandleCharEnum(ByteBuffer& packet)
+{
+    if (m_state != BOT_CHAR_ENUM)
+        { return; }
+
+    if (packet.read<uint8>() == 0)
+    {
+        if (m_created)
+        {
+            Fail("created character not listed");
+            return;
+        }
+
+        // the name is taken from the bot number, names have letters only
+        std::string name = "Bot";
+        for (uint32 n = m_config.firstAccount + m_index; n; n /= 26)
+            { name += char('a' + n % 26); }
+
+        ByteBuffer create;
+        create << name;
+        create << uint8(1) << uint8(1);                     // human warrior
+        create << uint8(0);                                 // gender
+        create << uint8(0) << uint8(0) << uint8(0) << uint8(0) << uint8(0);
+        create << uint8(0);                                 // outfit
+
+        SetState(BOT_CHAR_CREATE);
+        SendWorldPacket(CMSG_CHAR_CREATE, create);
+        return;
+    }
+
+    m_characterGuid = packet.read<uint64>();
+
+    ByteBuffer login;
+    login << uint64(m_characterGuid);
+
+    SetState(BOT_LOGIN);
+    m_phaseStart = WorldTimer::getMSTime();
+    SendWorldPacket(CMSG_PLAYER_LOGIN, login);
+}
+
+void Bot::HandleCharCreate(ByteBuffer& packet)
+{
+    if (m_state != BOT_CHAR_CREATE)
+        { return; }
+
+    if (packet.read<uint8>() != BOT_CHAR_CREATE_SUCCESS)
+    {
+        Fail("character create refused");
+        return;
+    }
+
+    m_created = true;
+    SetState(BOT_CHAR_ENUM);
+    SendWorldPacket(CMSG_CHAR_ENUM, ByteBuffer());
+}
+
+void Bot::HandleLoginVerifyWorld(ByteBuffer& packet)
+{
+    uint32 now = WorldTimer::getMSTime();
+
+    packet.read_skip<uint32>();                             // map
+    packet >> m_x >> m_y >> m_z >> m_o;
+
+    // also sent after a teleport, only the position is taken then
+    if (m_state != BOT_LOGIN)
+        { return; }
+
+    m_stats.AddLatency(LATENCY_ENTER_WORLD, WorldTimer::getMSTimeDiff(m_phaseStart, now));
+
+    SetState(BOT_IN_WORLD);
+    m_inWorldTime = now;
+    m_nextPing = now;
+    m_nextAction = now + urand(0, m_config.actionInterval);  // not all bots act in the same update
+}
+
+void Bot::HandlePong(ByteBuffer& packet)
+{
+    if (!m_pingTime || packet.read<uint32>() != m_pingSeq)
+        { return; }
+
+    m_latency = WorldTimer::getMSTimeDiff(m_pingTime, WorldTimer::getMSTime());
+    m_pingTime = 0;
+    m_stats.AddLatency(LATENCY_PING, m_latency);
+}
+
+void Bot::HandleMessageChat(ByteBuffer& packet)
+{
+    if (!m_chatTime || packet.size() < m_chatText.size())
+        { return; }
+
+    // the echo of the own say, found by its text
+    char const* data = reinterpret_cast<char const*>(packet.contents());
+    if (std::search(data, data + packet.size(), m_chatText.begin(), m_chatText.end()) == data + packet.size())
+        { return; }
+
+    m_stats.AddLatency(LATENCY_CHAT_ECHO, WorldTimer::getMSTimeDiff(m_chatTime, WorldTimer::getMSTime()));
+    m_chatTime = 0;
+}
+
+// --------------------------------------  Behaviour  -------------------------------------- //
+
+void Bot::Act(uint32 now)
+{
+    if (int32(now - m_nextPing) >= 0)
+    {
+        ByteBuffer ping;
+        ping << uint32(++m_pingSeq);
+        ping << uint32(m_latency);                          // the server keeps it as the session latency
+
+        m_pingTime = now;
+        m_nextPing = now + BOT_PING_INTERVAL;
+        SendWorldPacket(CMSG_PING, ping);
+    }
+
+    if (m_moving && WorldTimer::getMSTimeDiff(m_moveTime, now) >= BOT_HEARTBEAT_INTERVAL)
+        { SendMovement(MSG_MOVE_HEARTBEAT, BOT_MOVEFLAG_MOVE_FORWARD, now); }
+
+    if (int32(now - m_nextAction) < 0)
+        { return; }
+
+    m_nextAction = now + m_config.actionInterval;
+
+    switch (m_config.behaviour)
+    {
+        case BEHAVIOUR_CHAT:
+        {
+            char text[64];
+            snprintf(text, sizeof(text), "swarm %u says %u", m_index, m_pingSeq + now % 1000);
+            m_chatText = text;
+
+            ByteBuffer chat;
+            chat << uint32(BOT_CHAT_MSG_SAY);
+            chat << uint32(BOT_LANG_COMMON);
+            chat << m_chatText;
+
+            m_chatTime = now;
+            SendWorldPacket(CMSG_MESSAGECHAT, chat);
+            break;
+        }
+        case BEHAVIOUR_MOVE:
+            if (m_moving)
+            {
+                SendMovement(MSG_MOVE_STOP, 0, now);
+
+                // turn around, the next run leads back
+                m_o = float(fmod(m_o + M_PI, 2 * M_PI));
+                SendMovement(MSG_MOVE_SET_FACING, 0, now);
+            }
+            else
+                { SendMovement(MSG_MOVE_START_FORWARD, BOT_MOVEFLAG_MOVE_FORWARD, now); }
+            break;
+        default:
+            break;
+    }
+}
+
+void Bot::SendMovement(uint16 opcode, uint32 flags, uint32 now)
+{
+    // the position moves on at run speed since the last packet
+    if (m_moving)
+    {
+        float distance = BOT_RUN_SPEED * WorldTimer::getMSTimeDiff(m_moveTime, now) / IN_MILLISECONDS;
+        m_x += distance * cos(m_o);
+        m_y += distance * sin(m_o);
+    }
+
+    m_moving = (flags & BOT_MOVEFLAG_MOVE_FORWARD) != 0;
+    m_moveTime = now;
+
+    ByteBuffer movement;
+    movement << uint32(flags);
+    movement << uint32(now);
+    movement << m_x << m_y << m_z << m_o;
+    movement << uint32(0);                                  // fall time
+
+    SendWorldPacket(opcode, movement);
+}
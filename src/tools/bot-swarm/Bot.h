@@ -0,0 +1,171 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_BOTSWARM_BOT
+#define MANGOS_H_BOTSWARM_BOT
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "Auth/AuthCrypt.h"
+#include "Auth/BigNumber.h"
+#include "SwarmStats.h"
+
+#include <ace/Event_Handler.h>
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Stream.h>
+
+#include <vector>
+
+/// What a bot does while in the world
+enum BotBehaviour
+{
+    BEHAVIOUR_IDLE      = 0,                                // stays, only pings
+    BEHAVIOUR_CHAT      = 1,                                // says a line every action interval and times the echo
+    BEHAVIOUR_MOVE      = 2                                 // runs for an action interval, turns and runs back
+};
+
+/// Settings of the swarm, from the command line
+struct SwarmConfig
+{
+    SwarmConfig() : realmAddress(3724, "127.0.0.1"), accountPrefix("BOT"), firstAccount(1), bots(100), connectRate(50),
+        behaviour(BEHAVIOUR_MOVE), duration(300), actionInterval(5000), threads(1) {}
+
+    ACE_INET_Addr realmAddress;
+    std::string realmName;                                  // empty for the first realm online
+    std::string accountPrefix;                              // bot n logs in as <prefix><first + n>
+    std::string password;                                   // empty for the account name
+    uint32 firstAccount;
+    uint32 bots;
+    uint32 connectRate;                                     // bot starts per second
+    BotBehaviour behaviour;
+    uint32 duration;                                        // seconds in the world before the logout
+    uint32 actionInterval;                                  // ms
+    uint32 threads;
+};
+
+/**
+ * @brief one client: SRP6 login at realmd, then an encrypted world session with one character
+ *
+ * All calls of a bot are made by the swarm thread owning its reactor: the socket events and Update
+ * for the start delay, the timeouts and the behaviour. A character is created if the account has none.
+ */
+class Bot : public ACE_Event_Handler
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param config
+         * @param stats
+         * @param index the bot number in the swarm, selects the account and the start delay
+         * @param reactor of the owning swarm thread
+         */
+        Bot(SwarmConfig const& config, SwarmStats& stats, uint32 index, ACE_Reactor* reactor);
+        ~Bot();
+
+        BotState GetState() const { return m_state; }
+        bool IsFinished() const { return m_state == BOT_DONE || m_state == BOT_FAILED; }
+
+        /**
+         * @brief starts the bot when its delay passed, runs the behaviour and the step timeouts
+         *
+         * @param now ms time
+         * @param elapsed ms since the swarm started
+         */
+        void Update(uint32 now, uint32 elapsed);
+        /// Close the connection at the end of the swarm
+        void Stop();
+
+        ACE_HANDLE get_handle() const override;
+        int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE) override;
+        int handle_output(ACE_HANDLE = ACE_INVALID_HANDLE) override;
+
+    private:
+        void SetState(BotState state);
+        void Fail(char const* reason);
+
+        void Connect(ACE_INET_Addr const& address);
+        void OnConnected();
+        void Disconnect();
+        void Send(ByteBuffer const& data);
+        void Flush();
+
+        void SendRealmChallenge();
+        bool ProcessRealm();
+        bool HandleRealmChallenge();
+        bool HandleRealmProof();
+        bool HandleRealmList();
+
+        void SendWorldPacket(uint16 opcode, ByteBuffer const& payload);
+        bool ProcessWorld();
+        void HandleWorldPacket(uint16 opcode, ByteBuffer& packet);
+        void HandleAuthChallenge(ByteBuffer& packet);
+        void HandleAuthResponse(ByteBuffer& packet);
+        void HandleCharEnum(ByteBuffer& packet);
+        void HandleCharCreate(ByteBuffer& packet);
+        void HandleLoginVerifyWorld(ByteBuffer& packet);
+        void HandlePong(ByteBuffer& packet);
+        void HandleMessageChat(ByteBuffer& packet);
+
+        void Act(uint32 now);
+        void SendMovement(uint16 opcode, uint32 flags, uint32 now);
+
+        SwarmConfig const& m_config;
+        SwarmStats& m_stats;
+        uint32 m_index;
+        std::string m_account;                              // upper case like the client sends it
+        std::string m_password;
+
+        BotState m_state;
+        uint32 m_stateTime;                                 // ms time the step started, for its timeout
+        uint32 m_phaseStart;                                // ms time of the connect or request a latency is counted from
+
+        ACE_SOCK_Stream m_peer;
+        bool m_connecting;
+        std::vector<uint8> m_input;
+        std::vector<uint8> m_output;                        // not accepted by the socket yet
+        bool m_headerDecrypted;                             // the header at the start of m_input is decrypted already
+
+        BigNumber m_A;
+        BigNumber m_K;                                      // session key
+        uint8 m_expectedProof[20];                          // M2 of realmd
+        ACE_INET_Addr m_worldAddress;
+        AuthCrypt m_crypt;
+
+        bool m_created;                                     // character created by the bot
+        uint64 m_characterGuid;
+        float m_x, m_y, m_z, m_o;
+        uint32 m_inWorldTime;
+        uint32 m_nextPing;
+        uint32 m_pingSeq;
+        uint32 m_pingTime;                                  // 0 if no ping is pending
+        uint32 m_latency;                                   // last ping time, sent with the next ping
+        uint32 m_nextAction;
+        uint32 m_chatTime;                                  // 0 if no echo is pending
+        std::string m_chatText;
+        bool m_moving;
+        uint32 m_moveTime;                                  // ms time of the last movement packet
+};
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/**
+ * Headless client swarm for network load tests of realmd and the world server: every bot logs in
+ * with SRP6, plays an encrypted world session with one character and reports the login and in world
+ * latencies it saw. See README.md for the accounts the bots need.
+ */
+
+#include "Bot.h"
+#include "SwarmStats.h"
+#include "Timer.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/Task.h>
+#include <ace/Reactor.h>
+#include <ace/TP_Reactor.h>
+#include <ace/Dev_Poll_Reactor.h>
+#include <ace/OS_NS_unistd.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+
+#define PROGRESS_INTERVAL       (10 * IN_MILLISECONDS)
+
+static volatile bool stopEvent = false;                     ///< set by SIGINT, the bots disconnect then
+
+static void OnSignal(int)
+{
+    stopEvent = true;
+}
+
+/**
+ * @brief reactor thread of a part of the bots, like the network threads of WorldSocketMgr
+ *
+ */
+class SwarmThread : protected ACE_Task_Base
+{
+    public:
+        SwarmThread() : m_reactor(NULL), m_startTime(0)
+        {
+            ACE_Reactor_Impl* imp = 0;
+
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+
+            imp = new ACE_Dev_Poll_Reactor();
+
+            imp->max_notify_iterations(128);
+            imp->restart(1);
+
+#else
+
+            imp = new ACE_TP_Reactor();
+            imp->max_notify_iterations(128);
+
+#endif
+
+            m_reactor = new ACE_Reactor(imp, 1);
+        }
+
+        ~SwarmThread()
+        {
+            for (std::vector<Bot*>::const_iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                { delete *itr; }
+
+            delete m_reactor;
+        }
+
+        ACE_Reactor* GetReactor() { return m_reactor; }
+        void AddBot(Bot* bot) { m_bots.push_back(bot); }
+
+        int Start(uint32 startTime)
+        {
+            m_startTime = startTime;
+            return activate();
+        }
+
+        void Stop() { m_reactor->end_reactor_event_loop(); }
+        void Wait() { ACE_Task_Base::wait(); }
+
+    protected:
+        int svc() override
+        {
+            while (!m_reactor->reactor_event_loop_done())
+            {
+                // the handle_events will modify interval
+                ACE_Time_Value interval(0, 10000);
+                if (m_reactor->handle_events(interval) == -1)
+                    { break; }
+
+                uint32 now = WorldTimer::getMSTime();
+                uint32 elapsed = WorldTimer::getMSTimeDiff(m_startTime, now);
+                for (std::vector<Bot*>::const_iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                    { (*itr)->Update(now, elapsed); }
+            }
+
+            // in the thread of the reactor, the sockets are not used meanwhile
+            for (std::vector<Bot*>::const_iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                { (*itr)->Stop(); }
+
+            return 0;
+        }
+
+    private:
+        ACE_Reactor* m_reactor;
+        uint32 m_startTime;
+        std::vector<Bot*> m_bots;
+};
+
+/// Print out the usage string for this program on the console.
+static void usage(char const* prog)
+{
+    printf("Usage: \n %s [<options>]\n"
+           "    -r host[:port]       realmd address, default 127.0.0.1:3724\n"
+           "    -R name              realm to play on, default the first one online\n"
+           "    -a prefix            account name prefix, bot n logs in as <prefix><first + n>, default BOT\n"
+           "    -f number            number of the first account, default 1\n"
+           "    -p password          password of all accounts, default the account name\n"
+           "    -n count             number of bots, default 100\n"
+           "    -c rate              bot starts per second, default 50\n"
+           "    -b idle|chat|move    behaviour in the world, default move\n"
+           "    -d seconds           time in the world before the logout, 0 until Ctrl-C, default 300\n"
+           "    -i ms                interval of the chat and move actions, default 5000\n"
+           "    -t threads           reactor threads the bots are spread over, default 1\n"
+           "    -h                   print this help\n", prog);
+}
+
+int main(int argc, char** argv)
+{
+    SwarmConfig config;
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":r:R:a:f:p:n:c:b:d:i:t:h");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        char const* arg = cmd_opts.opt_arg();
+        switch (option)
+        {
+            case 'r':
+            {
+                std::string address = arg;
+                if (address.find(':') == std::string::npos)
+                    { address += ":3724"; }
+
+                if (config.realmAddress.set(address.c_str()) == -1)
+                {
+                    printf("Realmd address %s can't be resolved\n", arg);
+                    return 1;
+                }
+                break;
+            }
+            case 'R':
+                config.realmName = arg;
+                break;
+            case 'a':
+                config.accountPrefix = arg;
+                break;
+            case 'f':
+                config.firstAccount = uint32(atoi(arg));
+                break;
+            case 'p':
+                config.password = arg;
+                break;
+            case 'n':
+                config.bots = uint32(atoi(arg));
+                break;
+            case 'c':
+                config.connectRate = std::max(1, atoi(arg));
+                break;
+            case 'b':
+                if (!strcmp(arg, "idle"))
+                    { config.behaviour = BEHAVIOUR_IDLE; }
+                else if (!strcmp(arg, "chat"))
+                    { config.behaviour = BEHAVIOUR_CHAT; }
+                else if (!strcmp(arg, "move"))
+                    { config.behaviour = BEHAVIOUR_MOVE; }
+                else
+                {
+                    printf("Runtime-Error: -b unsupported argument %s\n", arg);
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'd':
+                config.duration = uint32(atoi(arg));
+                break;
+            case 'i':
+                config.actionInterval = std::max(100, atoi(arg));
+                break;
+            case 't':
+                config.threads = std::max(1, atoi(arg));
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            case ':':
+                printf("Runtime-Error: -%c option requires an input argument\n", cmd_opts.opt_opt());
+                usage(argv[0]);
+                return 1;
+            default:
+                printf("Runtime-Error: bad format of commandline arguments\n");
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+#ifdef SIGPIPE
+    signal(SIGPIPE, SIG_IGN);                               // a socket closed by the server only fails the bot
+#endif
+
+    SwarmStats stats;
+    std::vector<SwarmThread*> threads;
+    for (uint32 i = 0; i < config.threads; ++i)
+        { threads.push_back(new SwarmThread()); }
+
+    for (uint32 i = 0; i < config.bots; ++i)
+    {
+        SwarmThread* thread = threads[i % threads.size()];
+        thread->AddBot(new Bot(config, stats, i, thread->GetReactor()));
+    }
+
+    printf("Starting %u bots at %u per second on %u threads against %s:%u\n", config.bots, config.connectRate,
+           config.threads, config.realmAddress.get_host_addr(), config.realmAddress.get_port_number());
+
+    uint32 startTime = WorldTimer::getMSTime();
+    for (std::vector<SwarmThread*>::const_iterator itr = threads.begin(); itr != threads.end(); ++itr)
+    {
+        if ((*itr)->Start(startTime) == -1)
+        {
+            printf("Swarm thread can't be started\n");
+            return 1;
+        }
+    }
+
+    uint32 lastProgress = startTime;
+    while (!stopEvent)
+    {
+        ACE_OS::sleep(ACE_Time_Value(0, 100000));
+
+        uint32 now = WorldTimer::getMSTime();
+        if (WorldTimer::getMSTimeDiff(lastProgress, now) >= PROGRESS_INTERVAL)
+        {
+            lastProgress = now;
+            stats.PrintProgress(WorldTimer::getMSTimeDiff(startTime, now) / IN_MILLISECONDS);
+        }
+
+        if (stats.GetStateCount(BOT_DONE) + stats.GetStateCount(BOT_FAILED) == long(config.bots))
+            { break; }
+    }
+
+    for (std::vector<SwarmThread*>::const_iterator itr = threads.begin(); itr != threads.end(); ++itr)
+        { (*itr)->Stop(); }
+
+    for (std::vector<SwarmThread*>::const_iterator itr = threads.begin(); itr != threads.end(); ++itr)
+    {
+        (*itr)->Wait();
+        delete *itr;
+    }
+
+    stats.PrintReport(WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()) / IN_MILLISECONDS);
+    return 0;
+}
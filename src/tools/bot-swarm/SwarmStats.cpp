@@ -0,0 +1,143 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "SwarmStats.h"
+
+#include <ace/Guard_T.h>
+
+#include <algorithm>
+#include <cstdio>
+
+SwarmStats::SwarmStats() : m_sentPackets(0), m_sentBytes(0), m_receivedBytes(0), m_peakInWorld(0)
+{
+    for (int i = 0; i < MAX_BOT_STATE; ++i)
+        { m_states[i] = 0; }
+}
+
+char const* SwarmStats::GetStateName(BotState state)
+{
+    static char const* const names[MAX_BOT_STATE] =
+    {
+        "waiting", "realm connect", "realm challenge", "realm proof", "realm list", "world connect", "world challenge",
+        "world auth", "character list", "character create", "login", "in world", "logout", "done", "failed"
+    };
+
+    return state < MAX_BOT_STATE ? names[state] : "unknown";
+}
+
+char const* SwarmStats::GetLatencyName(SwarmLatency latency)
+{
+    static char const* const names[MAX_SWARM_LATENCY] = { "realm login", "world auth", "enter world", "ping", "chat echo" };
+
+    return latency < MAX_SWARM_LATENCY ? names[latency] : "unknown";
+}
+
+void SwarmStats::ChangeState(BotState from, BotState to)
+{
+    --m_states[from];
+    ++m_states[to];
+}
+
+void SwarmStats::AddLatency(SwarmLatency latency, uint32 time)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_latencies[latency].push_back(time);
+}
+
+void SwarmStats::AddFailure(BotState state, char const* reason)
+{
+    std::string key = std::string(GetStateName(state)) + ": " + reason;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    ++m_failures[key];
+}
+
+void SwarmStats::CountSent(size_t bytes)
+{
+    ++m_sentPackets;
+    m_sentBytes += long(bytes);
+}
+
+void SwarmStats::CountReceived(size_t bytes)
+{
+    m_receivedBytes += long(bytes);
+}
+
+void SwarmStats::PrintProgress(uint32 elapsed)
+{
+    long inWorld = m_states[BOT_IN_WORLD].value();
+    m_peakInWorld = std::max(m_peakInWorld, inWorld);
+
+    long connecting = 0;
+    for (int i = BOT_REALM_CONNECT; i < BOT_IN_WORLD; ++i)
+        { connecting += m_states[i].value(); }
+
+    printf("%5u s: %ld waiting, %ld logging in, %ld in world, %ld logging out, %ld done, %ld failed, %ld KB sent, %ld KB received\n",
+           elapsed, m_states[BOT_WAITING].value(), connecting, inWorld, m_states[BOT_LOGOUT].value(), m_states[BOT_DONE].value(),
+           m_states[BOT_FAILED].value(), m_sentBytes.value() / 1024, m_receivedBytes.value() / 1024);
+    fflush(stdout);
+}
+
+/// Value at the percent of the sorted samples
+static uint32 GetPercentile(std::vector<uint32> const& samples, uint32 percent)
+{
+    return samples[std::min(samples.size() - 1, samples.size() * percent / 100)];
+}
+
+void SwarmStats::PrintReport(uint32 elapsed)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    printf("\nBot swarm finished after %u s, peak %ld bots in world, %ld done, %ld failed\n", elapsed, m_peakInWorld,
+           m_states[BOT_DONE].value(), m_states[BOT_FAILED].value());
+    printf("%ld packets and %ld bytes sent, %ld bytes received\n\n", m_sentPackets.value(), m_sentBytes.value(), m_receivedBytes.value());
+
+    printf("%-12s %8s %8s %8s %8s %8s %8s\n", "latency ms", "samples", "avg", "median", "95%", "99%", "max");
+    for (int i = 0; i < MAX_SWARM_LATENCY; ++i)
+    {
+        std::vector<uint32>& samples = m_latencies[i];
+        if (samples.empty())
+        {
+            printf("%-12s %8u\n", GetLatencyName(SwarmLatency(i)), 0);
+            continue;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        uint64 total = 0;
+        for (std::vector<uint32>::const_iterator itr = samples.begin(); itr != samples.end(); ++itr)
+            { total += *itr; }
+
+        printf("%-12s %8u %8.1f %8u %8u %8u %8u\n", GetLatencyName(SwarmLatency(i)), uint32(samples.size()),
+               double(total) / samples.size(), GetPercentile(samples, 50), GetPercentile(samples, 95),
+               GetPercentile(samples, 99), samples.back());
+    }
+
+    if (m_failures.empty())
+        { return; }
+
+    printf("\nfailures:\n");
+    for (std::map<std::string, uint32>::const_iterator itr = m_failures.begin(); itr != m_failures.end(); ++itr)
+        { printf("%8u  %s\n", itr->second, itr->first.c_str()); }
+}
@@ -0,0 +1,107 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_BOTSWARM_SWARMSTATS
+#define MANGOS_H_BOTSWARM_SWARMSTATS
+
+#include "Common.h"
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
+#include <map>
+#include <vector>
+
+/// Steps of a bot, from waiting for its start to the logout
+enum BotState
+{
+    BOT_WAITING         = 0,                                // start delay of the connect rate
+    BOT_REALM_CONNECT   = 1,
+    BOT_REALM_CHALLENGE = 2,
+    BOT_REALM_PROOF     = 3,
+    BOT_REALM_LIST      = 4,
+    BOT_WORLD_CONNECT   = 5,
+    BOT_WORLD_CHALLENGE = 6,
+    BOT_WORLD_AUTH      = 7,                                // also while in the login queue
+    BOT_CHAR_ENUM       = 8,
+    BOT_CHAR_CREATE     = 9,
+    BOT_LOGIN           = 10,
+    BOT_IN_WORLD        = 11,
+    BOT_LOGOUT          = 12,
+    BOT_DONE            = 13,
+    BOT_FAILED          = 14,
+    MAX_BOT_STATE       = 15
+};
+
+/// Latencies observed by the bots
+enum SwarmLatency
+{
+    LATENCY_REALM_LOGIN = 0,                                // realmd connect to the verified proof
+    LATENCY_WORLD_AUTH  = 1,                                // world connect to AUTH_OK, with the login queue
+    LATENCY_ENTER_WORLD = 2,                                // CMSG_PLAYER_LOGIN to SMSG_LOGIN_VERIFY_WORLD
+    LATENCY_PING        = 3,                                // CMSG_PING to SMSG_PONG, handled by the network thread
+    LATENCY_CHAT_ECHO   = 4,                                // CMSG_MESSAGECHAT to the echo, handled by the world thread
+    MAX_SWARM_LATENCY   = 5
+};
+
+/**
+ * @brief counters and latency samples of all bots, fed by the swarm threads
+ *
+ */
+class SwarmStats
+{
+    public:
+        SwarmStats();
+
+        static char const* GetStateName(BotState state);
+        static char const* GetLatencyName(SwarmLatency latency);
+
+        void AddBot() { ++m_states[BOT_WAITING]; }
+        void ChangeState(BotState from, BotState to);
+        long GetStateCount(BotState state) const { return m_states[state].value(); }
+
+        void AddLatency(SwarmLatency latency, uint32 time);
+        void AddFailure(BotState state, char const* reason);
+
+        void CountSent(size_t bytes);
+        void CountReceived(size_t bytes);
+
+        /// One line with the bots per state and the traffic
+        void PrintProgress(uint32 elapsed);
+        /// Latency percentiles and the failures by reason
+        void PrintReport(uint32 elapsed);
+
+    private:
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_states[MAX_BOT_STATE];
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_sentPackets;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_sentBytes;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_receivedBytes;
+        long m_peakInWorld;                                 // main thread only
+
+        ACE_Thread_Mutex m_lock;
+        std::vector<uint32> m_latencies[MAX_SWARM_LATENCY];
+        std::map<std::string, uint32> m_failures;           // "state: reason" to count
+};
+
+#endif
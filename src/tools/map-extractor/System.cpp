@@ -25,6 +25,8 @@
 #include <stdio.h>
 #include <deque>
 #include <set>
+#include <map>
+#include <string>
 #include <cstdlib>
 
 #ifdef WIN32
@@ -40,6 +42,10 @@
 #include "loadlib/wdt.h"
 #include <fcntl.h>
 
+#include <ace/Guard_T.h>
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+
 #ifndef WIN32
 #include <unistd.h>
 /* This isn't the nicest way to do things..
@@ -81,6 +87,7 @@ uint16* LiqType;                    /**< TODO */
 char output_path[128] = ".";        /**< TODO */
 char input_path[128] = ".";         /**< TODO */
 uint32 maxAreaId = 0;               /**< TODO */
+uint32 maxLiqTypeId = 0;            /**< TODO */
 
 /**
  * @brief Data types which can be extracted
@@ -102,6 +109,9 @@ float CONF_float_to_int16_limit    = 2048.0f;   /**< Max accuracy = val/65536 */
 float CONF_flat_height_delta_limit = 0.005f;    /**< If max - min less this value - surface is flat */
 float CONF_flat_liquid_delta_limit = 0.001f;    /**< If max - min less this value - liquid surface is flat */
 
+int   CONF_threads                 = 1;         /**< Number of threads converting ADT files */
+bool  CONF_incremental             = false;     /**< Skip ADT files unchanged since the last extraction */
+
 const char* CONF_mpq_list[] = /**< List MPQ for extract from */
 {
     "dbc.MPQ",
@@ -158,6 +168,8 @@ void Usage(char* prg)
     printf("                         size, but also accuracy\n");
     printf("   -e, --extract #       extract specified client data. 1 = maps, 2 = DBCs,\n");
     printf("                         3 = both. Defaults to extracting both.\n");
+    printf("   -t, --threads #       number of threads converting map files\n");
+    printf("   -u, --update          only convert map files changed since the last run\n");
     printf("\n");
     printf("Example:\n");
     printf("- use input path and do not flatten maps:\n");
@@ -230,6 +242,28 @@ bool HandleArgs(int argc, char** argv)
                 Usage(argv[0]);
             }
         }
+        else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0)
+        {
+            param = argv[++i];
+            if (!param)
+            {
+                return false;
+            }
+
+            int threads = atoi(param);
+            if (threads > 0 && threads <= 64)
+            {
+                CONF_threads = threads;
+            }
+            else
+            {
+                Usage(argv[0]);
+            }
+        }
+        else if (strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--update") == 0)
+        {
+            CONF_incremental = true;
+        }
         else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
         {
             Usage(argv[0]);
@@ -313,6 +347,7 @@ void ReadLiquidTypeTableDBC()
     size_t LiqType_maxid = dbc.getMaxId();
     LiqType = new uint16[LiqType_maxid + 1];
     memset(LiqType, 0xff, (LiqType_maxid + 1) * sizeof(uint16));
+    maxLiqTypeId = LiqType_maxid;
 
     for (uint32 x = 0; x < LiqType_count; ++x)
         { LiqType[dbc.getRecord(x).getUInt(0)] = dbc.getRecord(x).getUInt(3); }
@@ -429,36 +464,41 @@ float selectUInt16StepStore(float maxDiff)
     return 65535 / maxDiff;
 }
 
-uint16 area_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];      /**< Temporary grid data store */
-
-float V8[ADT_GRID_SIZE][ADT_GRID_SIZE];                         /**< TODO */
-float V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];                 /**< TODO */
-uint16 uint16_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];                 /**< TODO */
-uint16 uint16_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];         /**< TODO */
-uint8  uint8_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];                  /**< TODO */
-uint8  uint8_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];          /**< TODO */
-
-uint16 liquid_entry[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];    /**< TODO */
-uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];     /**< TODO */
-bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];                /**< TODO */
-float liquid_height[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];      /**< TODO */
-
 /**
- * @brief
+ * @brief Temporary grid data store of one converting thread
  *
- * @param filename
- * @param filename2
- * @param cell_y
- * @param cell_x
- * @return bool
  */
-bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x)
+struct ADTConverter
 {
-    ADT_file adt;
-
-    if (!adt.loadFile(filename))
-        { return false; }
+    uint16 area_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];      /**< TODO */
+
+    float V8[ADT_GRID_SIZE][ADT_GRID_SIZE];                         /**< TODO */
+    float V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];                 /**< TODO */
+    uint16 uint16_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];                 /**< TODO */
+    uint16 uint16_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];         /**< TODO */
+    uint8  uint8_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];                  /**< TODO */
+    uint8  uint8_V9[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];          /**< TODO */
+
+    uint16 liquid_entry[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];    /**< TODO */
+    uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];     /**< TODO */
+    bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];                /**< TODO */
+    float liquid_height[ADT_GRID_SIZE + 1][ADT_GRID_SIZE + 1];      /**< TODO */
+
+    /**
+     * @brief
+     *
+     * @param adt loaded ADT file
+     * @param filename
+     * @param filename2
+     * @param cell_y
+     * @param cell_x
+     * @return bool
+     */
+    bool ConvertADT(ADT_file& adt, char* filename, char* filename2, int cell_y, int cell_x);
+};
 
+bool ADTConverter::ConvertADT(ADT_file& adt, char* filename, char* filename2, int cell_y, int cell_x)
+{
     adt_MCIN* cells = adt.a_grid->getMCIN();
     if (!cells)
     {
@@ -993,14 +1033,211 @@ bool ConvertADT(char* filename, char* filename2, int cell_y, int cell_x)
     return true;
 }
 
+/**
+ * @brief ADT file waiting for conversion
+ *
+ */
+struct ADTJob
+{
+    uint32 map;                     /**< index in map_ids */
+    uint32 x;                       /**< TODO */
+    uint32 y;                       /**< TODO */
+};
+
+/**
+ * @brief hash of the ADT file and the conversion of each map file, by map file name
+ *
+ */
+typedef std::map<std::string, uint64> HashMap;
+
+static char const* HASH_FILE_NAME = "maps.hashes"; /**< written next to the maps directory */
+
+std::deque<ADTJob> adt_jobs;        /**< ADT files left to convert */
+ACE_Thread_Mutex adt_lock;          /**< guards adt_jobs, new_hashes and the counters */
+uint32 adt_total = 0;               /**< TODO */
+uint32 adt_converted = 0;           /**< TODO */
+uint32 adt_unchanged = 0;           /**< TODO */
+uint32 adt_failed = 0;              /**< TODO */
+HashMap old_hashes;                 /**< read from the hash file of the last run */
+HashMap new_hashes;                 /**< TODO */
+uint64 conversion_hash;             /**< hash of the map format and everything else the conversion depends on */
+
+void LoadCommonMPQFiles(ArchiveSet& archives, bool log);
+void CloseMPQFiles(ArchiveSet& archives);
+
+/**
+ * @brief FNV-1a hash
+ *
+ * @param data
+ * @param size
+ * @param hash hash of the data before
+ * @return uint64
+ */
+uint64 HashData(void const* data, size_t size, uint64 hash)
+{
+    uint8 const* bytes = static_cast<uint8 const*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief hashes the map format, the settings and the client tables a map file is converted with
+ *
+ * @return uint64
+ */
+uint64 ConversionHash()
+{
+    uint64 hash = 0xCBF29CE484222325ULL;
+    hash = HashData(MAP_VERSION_MAGIC, strlen(MAP_VERSION_MAGIC), hash);
+    hash = HashData(&CONF_allow_height_limit, sizeof(CONF_allow_height_limit), hash);
+    hash = HashData(&CONF_use_minHeight, sizeof(CONF_use_minHeight), hash);
+    hash = HashData(&CONF_allow_float_to_int, sizeof(CONF_allow_float_to_int), hash);
+    hash = HashData(&CONF_float_to_int8_limit, sizeof(CONF_float_to_int8_limit), hash);
+    hash = HashData(&CONF_float_to_int16_limit, sizeof(CONF_float_to_int16_limit), hash);
+    hash = HashData(&CONF_flat_height_delta_limit, sizeof(CONF_flat_height_delta_limit), hash);
+    hash = HashData(&CONF_flat_liquid_delta_limit, sizeof(CONF_flat_liquid_delta_limit), hash);
+    hash = HashData(areas, (maxAreaId + 1) * sizeof(uint16), hash);
+    hash = HashData(LiqType, (maxLiqTypeId + 1) * sizeof(uint16), hash);
+    return hash;
+}
+
 /**
  * @brief
  *
+ * @param filename
+ * @param hashes
  */
-void ExtractMapsFromMpq()
+void ReadHashes(std::string const& filename, HashMap& hashes)
+{
+    FILE* input = fopen(filename.c_str(), "r");
+    if (!input)
+        { return; }
+
+    char name[64];
+    uint32 high, low;
+    while (fscanf(input, "%63s %8X%8X", name, &high, &low) == 3)
+        { hashes[name] = (uint64(high) << 32) | low; }
+
+    fclose(input);
+}
+
+/**
+ * @brief
+ *
+ * @param filename
+ * @param hashes
+ */
+void WriteHashes(std::string const& filename, HashMap const& hashes)
+{
+    FILE* output = fopen(filename.c_str(), "w");
+    if (!output)
+    {
+        printf("Can not create the output file '%s'\n", filename.c_str());
+        return;
+    }
+
+    for (HashMap::const_iterator itr = hashes.begin(); itr != hashes.end(); ++itr)
+        { fprintf(output, "%s %08X%08X\n", itr->first.c_str(), uint32(itr->second >> 32), uint32(itr->second)); }
+
+    fclose(output);
+}
+
+/**
+ * @brief converts the ADT files of the queue until it is empty
+ *
+ * @param archives archives of the calling thread
+ */
+void ConvertQueuedADTs(ArchiveSet const& archives)
 {
     char mpq_filename[1024];
     char output_filename[1024];
+    char map_filename[16];
+
+    // too big for the stack of a thread
+    ADTConverter* converter = new ADTConverter;
+
+    for (;;)
+    {
+        ADTJob job;
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(adt_lock);
+            if (adt_jobs.empty())
+                { break; }
+
+            job = adt_jobs.front();
+            adt_jobs.pop_front();
+        }
+
+        map_id const& entry = map_ids[job.map];
+        sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", entry.name, entry.name, job.x, job.y);
+        sprintf(map_filename, "%03u%02u%02u.map", entry.id, job.y, job.x);
+        sprintf(output_filename, "%s/maps/%s", output_path, map_filename);
+
+        ADT_file adt;
+        bool loaded = adt.loadFile(mpq_filename, true, &archives);
+        uint64 hash = loaded ? HashData(adt.GetData(), adt.GetDataSize(), conversion_hash) : 0;
+
+        bool unchanged = false;
+        if (loaded && CONF_incremental)
+        {
+            HashMap::const_iterator itr = old_hashes.find(map_filename);
+            unchanged = itr != old_hashes.end() && itr->second == hash && FileExists(output_filename);
+        }
+
+        bool converted = loaded && !unchanged && converter->ConvertADT(adt, mpq_filename, output_filename, job.y, job.x);
+
+        ACE_Guard<ACE_Thread_Mutex> guard(adt_lock);
+        if (unchanged || converted)
+            { new_hashes[map_filename] = hash; }
+
+        if (unchanged)
+            { ++adt_unchanged; }
+        else if (converted)
+            { ++adt_converted; }
+        else
+            { ++adt_failed; }
+
+        // draw progress bar
+        printf("Processing........................%u%%\r", (100 * (adt_converted + adt_unchanged + adt_failed)) / adt_total);
+    }
+
+    delete converter;
+}
+
+/**
+ * @brief threads converting ADT files of the queue
+ *
+ */
+class ADTWorkers : public ACE_Task_Base
+{
+    public:
+        /**
+         * @brief
+         *
+         * @return int
+         */
+        int svc()
+        {
+            // a libmpq archive keeps a read position, so every thread opens the archives itself
+            ArchiveSet archives;
+            LoadCommonMPQFiles(archives, false);
+            ConvertQueuedADTs(archives);
+            CloseMPQFiles(archives);
+            return 0;
+        }
+};
+
+/**
+ * @brief
+ *
+ */
+void ExtractMapsFromMpq()
+{
     char mpq_map_name[1024];
 
     printf("Extracting maps...\n");
@@ -1014,6 +1251,11 @@ void ExtractMapsFromMpq()
     path += "/maps/";
     CreateDir(path);
 
+    std::string hashFile = std::string(output_path) + "/" + HASH_FILE_NAME;
+    conversion_hash = ConversionHash();
+    if (CONF_incremental)
+        { ReadHashes(hashFile, old_hashes); }
+
     printf("Converting map files\n");
     for (uint32 z = 0; z < map_count; ++z)
     {
@@ -1033,14 +1275,35 @@ void ExtractMapsFromMpq()
             {
                 if (!wdt.main->adt_list[y][x].exist)
                     { continue; }
-                sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", map_ids[z].name, map_ids[z].name, x, y);
-                sprintf(output_filename, "%s/maps/%03u%02u%02u.map", output_path, map_ids[z].id, y, x);
-                ConvertADT(mpq_filename, output_filename, y, x);
+
+                ADTJob job;
+                job.map = z;
+                job.x = x;
+                job.y = y;
+                adt_jobs.push_back(job);
             }
-            // draw progress bar
-            printf("Processing........................%d%%\r", (100 * (y + 1)) / WDT_MAP_SIZE);
         }
     }
+
+    adt_total = adt_jobs.size();
+    printf("Converting %u ADT files on %d threads\n", adt_total, CONF_threads);
+
+    ADTWorkers workers;
+    if (CONF_threads < 2)
+        { ConvertQueuedADTs(gOpenArchives); }
+    else if (workers.activate(THR_NEW_LWP | THR_JOINABLE, CONF_threads) == -1)
+    {
+        printf("Can not start the threads, converting on one thread\n");
+        ConvertQueuedADTs(gOpenArchives);
+    }
+    else
+        { workers.wait(); }
+
+    printf("Converted %u map files, %u unchanged, %u failed     \n", adt_converted, adt_unchanged, adt_failed);
+
+    // the hashes of this run, a later run with --update skips the unchanged files
+    WriteHashes(hashFile, new_hashes);
+
     delete [] areas;
     delete [] map_ids;
 }
@@ -1108,8 +1371,10 @@ void ExtractDBCFiles()
 /**
  * @brief
  *
+ * @param archives
+ * @param log
  */
-void LoadCommonMPQFiles()
+void LoadCommonMPQFiles(ArchiveSet& archives, bool log)
 {
     char filename[512];
     int count = sizeof(CONF_mpq_list) / sizeof(char*);
@@ -1117,18 +1382,23 @@ void LoadCommonMPQFiles()
     {
         sprintf_s(filename, "%s/Data/%s", input_path, CONF_mpq_list[i]);
         if (FileExists(filename))
-            { new MPQArchive(filename); }
+            { new MPQArchive(filename, archives, log); }
     }
 }
 
 /**
  * @brief
  *
+ * @param archives
  */
-inline void CloseMPQFiles()
+void CloseMPQFiles(ArchiveSet& archives)
 {
-    for (ArchiveSet::iterator j = gOpenArchives.begin(); j != gOpenArchives.end(); ++j) { (*j)->close(); }
-    gOpenArchives.clear();
+    for (ArchiveSet::iterator j = archives.begin(); j != archives.end(); ++j)
+    {
+        (*j)->close();
+        delete *j;
+    }
+    archives.clear();
 }
 
 /**
@@ -1148,7 +1418,7 @@ int main(int argc, char** argv)
     }
 
     // Open MPQs
-    LoadCommonMPQFiles();
+    LoadCommonMPQFiles(gOpenArchives, true);
 
     // Extract dbc
     if (CONF_extract & EXTRACT_DBC)
@@ -1159,7 +1429,7 @@ int main(int argc, char** argv)
         { ExtractMapsFromMpq(); }
 
     // Close MPQs
-    CloseMPQFiles();
+    CloseMPQFiles(gOpenArchives);
 
     return 0;
 }
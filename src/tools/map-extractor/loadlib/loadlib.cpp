@@ -41,10 +41,10 @@ FileLoader::~FileLoader()
     free();
 }
 
-bool FileLoader::loadFile(char* filename, bool log)
+bool FileLoader::loadFile(char* filename, bool log, ArchiveSet const* archives)
 {
     free();
-    MPQFile mf(filename);
+    MPQFile mf(filename, archives ? *archives : gOpenArchives);
     if (mf.isEof())
     {
         if (log)
@@ -84,8 +84,13 @@ typedef uint16_t           uint16;
 typedef uint8_t            uint8;
 #endif
 
+#include <deque>
+
 #define FILE_FORMAT_VERSION    18
 
+class MPQArchive;
+typedef std::deque<MPQArchive*> ArchiveSet;
+
 /**
  * @brief File version chunk
  *
@@ -149,9 +154,10 @@ class FileLoader
          *
          * @param filename
          * @param log
+         * @param archives archives to read from, 0 reads from all opened archives
          * @return bool
          */
-        bool loadFile(char* filename, bool log = true);
+        bool loadFile(char* filename, bool log = true, ArchiveSet const* archives = 0);
         /**
          * @brief
          *
@@ -35,6 +35,8 @@
 
 using namespace std;
 
+extern ArchiveSet gOpenArchives;    /**< archives of the main thread */
+
 /**
  * @brief
  *
@@ -49,8 +51,10 @@ class MPQArchive
          * @brief
          *
          * @param filename
+         * @param archives set the archive is added to, a thread reading files reads them of its own set
+         * @param log
          */
-        MPQArchive(const char* filename);
+        MPQArchive(const char* filename, ArchiveSet& archives = gOpenArchives, bool log = true);
         /**
          * @brief
          *
@@ -126,8 +130,9 @@ class MPQFile
          * @brief
          *
          * @param filename filenames are not case sensitive
+         * @param archives archives searched for the file
          */
-        MPQFile(const char* filename);
+        MPQFile(const char* filename, ArchiveSet const& archives = gOpenArchives);
         /**
          * @brief
          *
@@ -24,6 +24,8 @@
 
 #include <string>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
 
 #include "TileAssembler.h"
 
@@ -32,30 +34,54 @@ const char* szVMAPMagic = "VMAP_4.0";
 //=======================================================
 void Usage(char* prg)
 {
-    printf("Usage: %s [OPTION]\n\n", prg);
+    printf("Usage: %s [OPTION] <input_dir> <output_dir>\n\n", prg);
     printf("Assemble vmaps from extracted client model information.\n");
     printf("\n");
+    printf("Options:\n");
+    printf("  --los-error <yards>  add simplified meshes for line of sight checks, no vertex\n");
+    printf("                       moves more than <yards> (default 0: no simplified meshes)\n");
+    printf("  --threads <count>    convert maps and models on <count> threads (default 1)\n");
+    printf("\n");
     printf("Example:\n");
     printf("- provide source and target path:\n");
     printf("  %s Buildings vmaps\n", prg);
+    printf("- with line of sight meshes:\n");
+    printf("  %s --los-error 0.5 Buildings vmaps\n", prg);
+    printf("- on 4 threads:\n");
+    printf("  %s --threads 4 Buildings vmaps\n", prg);
 }
 
 int main(int argc, char** argv)
 {
     printf("mangos-zero vmap (version %s) assembler\n\n", szVMAPMagic);
 
-    if (argc != 3)
+    float losError = 0.0f;
+    int threads = 1;
+    int arg = 1;
+    for (; arg + 1 < argc; arg += 2)
+    {
+        if (strcmp(argv[arg], "--los-error") == 0)
+            { losError = float(atof(argv[arg + 1])); }
+        else if (strcmp(argv[arg], "--threads") == 0)
+            { threads = atoi(argv[arg + 1]); }
+        else
+            { break; }
+    }
+
+    if (argc - arg != 2 || losError < 0.0f || threads < 1 || threads > 64)
     {
         Usage(argv[0]);
         return 1;
     }
 
-    std::string src = argv[1];
-    std::string dest = argv[2];
+    std::string src = argv[arg];
+    std::string dest = argv[arg + 1];
 
     std::cout << "using " << src << " as source directory and writing output to " << dest << std::endl;
 
     VMAP::TileAssembler* ta = new VMAP::TileAssembler(src, dest);
+    ta->setLosError(losError);
+    ta->setThreads(uint32(threads));
 
     if (!ta->convertWorld2())
     {
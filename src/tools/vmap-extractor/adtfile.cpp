@@ -85,12 +85,12 @@ char const* GetExtension(char const* FileName)
     return NULL;
 }
 
-ADTFile::ADTFile(char* filename): ADT(filename)
+ADTFile::ADTFile(char* filename, ArchiveSet const& archives): ADT(filename, archives)
 {
     Adtfilename.append(filename);
 }
 
-bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY, StringSet& failedPaths)
+bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY)
 {
     if (ADT.isEof())
         { return false; }
@@ -153,9 +153,8 @@ bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY, StringSet& failed
                     fixname2(s, strlen(s));
                     string path(p);                         // Store copy after name fixed
 
-                    std::string fixedName;
-                    ExtractSingleModel(path, fixedName, failedPaths);
-                    ModelInstansName[t++] = fixedName;
+                    // the models were extracted before, see ModelQueue
+                    ModelInstansName[t++] = FixModelPath(path);
 
                     p = p + strlen(p) + 1;
                 }
@@ -221,6 +220,41 @@ bool ADTFile::init(uint32 map_num, uint32 tileX, uint32 tileY, StringSet& failed
     return true;
 }
 
+void ADTFile::collectModels(StringSet& models)
+{
+    while (!ADT.isEof())
+    {
+        char fourcc[5];
+        uint32 size;
+        ADT.read(&fourcc, 4);
+        ADT.read(&size, 4);
+        flipcc(fourcc);
+        fourcc[4] = 0;
+
+        size_t nextpos = ADT.getPos() + size;
+
+        if (!strcmp(fourcc, "MMDX") && size)
+        {
+            char* buf = new char[size];
+            ADT.read(buf, size);
+            char* p = buf;
+            while (p < buf + size)
+            {
+                fixnamen(p, strlen(p));
+                char* s = GetPlainName(p);
+                fixname2(s, strlen(s));
+                models.insert(p);
+
+                p = p + strlen(p) + 1;
+            }
+            delete[] buf;
+        }
+
+        ADT.seek(nextpos);
+    }
+    ADT.close();
+}
+
 ADTFile::~ADTFile()
 {
     ADT.close();
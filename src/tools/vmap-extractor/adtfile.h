@@ -154,8 +154,9 @@ class ADTFile
          * @brief
          *
          * @param filename
+         * @param archives archives the file is read from
          */
-        ADTFile(char* filename);
+        ADTFile(char* filename, ArchiveSet const& archives = gOpenArchives);
         /**
          * @brief
          *
@@ -171,10 +172,15 @@ class ADTFile
          * @param map_num
          * @param tileX
          * @param tileY
-         * @param failedPaths
          * @return bool
          */
-        bool init(uint32 map_num, uint32 tileX, uint32 tileY, StringSet& failedPaths);
+        bool init(uint32 map_num, uint32 tileX, uint32 tileY);
+        /**
+         * @brief reads the names of the models placed on the tile
+         *
+         * @param models paths of the models, cleaned as ExtractSingleModel needs them
+         */
+        void collectModels(StringSet& models);
         //void LoadMapChunks();
 
         //uint32 wmo_count;
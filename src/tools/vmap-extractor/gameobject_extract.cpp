@@ -26,11 +26,12 @@
 #include "dbcfile.h"
 #include "adtfile.h"
 #include "vmapexport.h"
+#include "modelqueue.h"
 
 #include <algorithm>
 #include <stdio.h>
 
-bool ExtractSingleModel(std::string& origPath, std::string& fixedName, StringSet& failedPaths)
+std::string FixModelPath(std::string& origPath)
 {
     char const* ext = GetExtension(GetPlainName(origPath.c_str()));
 
@@ -44,7 +45,12 @@ bool ExtractSingleModel(std::string& origPath, std::string& fixedName, StringSet
     // >= 3.1.0 ADT MMDX section store filename.m2 filenames for corresponded .m2 file
     // nothing do
 
-    fixedName = GetPlainName(origPath.c_str());
+    return GetPlainName(origPath.c_str());
+}
+
+bool ExtractSingleModel(std::string& origPath, std::string& fixedName, StringSet& failedPaths, ArchiveSet const& archives)
+{
+    fixedName = FixModelPath(origPath);
 
     std::string output(szWorkDirWmo);                       // Stores output filename (possible changed)
     output += "/";
@@ -54,16 +60,68 @@ bool ExtractSingleModel(std::string& origPath, std::string& fixedName, StringSet
         { return true; }
 
     Model mdl(origPath);                                    // Possible changed fname
-    if (!mdl.open(failedPaths))
+    if (!mdl.open(failedPaths, archives))
         { return false; }
 
     return mdl.ConvertToVMAPModel(output.c_str());
 }
 
-void ExtractGameobjectModels()
+/**
+ * @brief reads the model of a GameObjectDisplayInfo.dbc record
+ *
+ * @param record
+ * @param path path of the model, cleaned with fixnamen and fixname2
+ * @return const char plain name of the model, NULL if the record has no model
+ */
+static char* GetGameobjectModel(DBCFile::Record const& record, std::string& path)
+{
+    path = record.getString(1);
+
+    if (path.length() < 4)
+        { return NULL; }
+
+    fixnamen((char*)path.c_str(), path.size());
+    char* name = GetPlainName((char*)path.c_str());
+    fixname2(name, strlen(name));
+
+    char const* ch_ext = GetExtension(name);
+    if (!ch_ext)
+        { return NULL; }
+
+    // TODO: extract .mdl files, if needed
+    if (!strcmp(ch_ext, ".mdl"))
+        { return NULL; }
+
+    return name;
+}
+
+void QueueGameobjectModels(ModelQueue& queue)
+{
+    DBCFile dbc("DBFilesClient\\GameObjectDisplayInfo.dbc");
+    if (!dbc.open())
+    {
+        printf("Fatal error: Invalid GameObjectDisplayInfo.dbc file format!\n");
+        exit(1);
+    }
+
+    std::string path;
+    for (DBCFile::Iterator it = dbc.begin(); it != dbc.end(); ++it)
+    {
+        char* name = GetGameobjectModel(*it, path);
+        if (!name)
+            { continue; }
+
+        if (!strcmp(GetExtension(name), ".wmo"))
+            { queue.AddWmo(path); }
+        else //if (!strcmp(ch_ext, ".mdx") || !strcmp(ch_ext, ".m2"))
+            { queue.AddModel(path); }
+    }
+}
+
+void ExtractGameobjectModels(ModelQueue const& queue)
 {
     printf("\n");
-    printf("Extracting GameObject models...\n");
+    printf("Writing GameObject models...\n");
     DBCFile dbc("DBFilesClient\\GameObjectDisplayInfo.dbc");
     if (!dbc.open())
     {
@@ -74,45 +132,25 @@ void ExtractGameobjectModels()
     std::string basepath = szWorkDirWmo;
     basepath += "/";
     std::string path;
-    StringSet failedPaths;
 
     FILE* model_list = fopen((basepath + "temp_gameobject_models").c_str(), "wb");
 
     for (DBCFile::Iterator it = dbc.begin(); it != dbc.end(); ++it)
     {
-        path = it->getString(1);
-
-        if (path.length() < 4)
-            { continue; }
-
-        fixnamen((char*)path.c_str(), path.size());
-        char* name = GetPlainName((char*)path.c_str());
-        fixname2(name, strlen(name));
-
-        char const* ch_ext = GetExtension(name);
-        if (!ch_ext)
+        char* name = GetGameobjectModel(*it, path);
+        if (!name)
             { continue; }
 
-        //strToLower(ch_ext);
-
-        bool result = false;
-        if (!strcmp(ch_ext, ".wmo"))
-        {
-            result = ExtractSingleWmo(path);
-        }
-        else if (!strcmp(ch_ext, ".mdl"))
-        {
-            // TODO: extract .mdl files, if needed
-            continue;
-        }
-        else //if (!strcmp(ch_ext, ".mdx") || !strcmp(ch_ext, ".m2"))
-        {
-            std::string fixedName;
-            result = ExtractSingleModel(path, fixedName, failedPaths);
-        }
+        // the models were extracted by the queue, only the extracted ones are listed
+        bool result;
+        if (!strcmp(GetExtension(name), ".wmo"))
+            { result = queue.IsExtracted(GetWmoOutputPath(path)); }
+        else
+            { result = queue.IsExtracted(basepath + FixModelPath(path)); }
 
         if (result)
         {
+            name = GetPlainName((char*)path.c_str());
             uint32 displayId = it->getUInt(0);
             uint32 path_length = strlen(name);
             fwrite(&displayId, sizeof(uint32), 1, model_list);
@@ -123,13 +161,5 @@ void ExtractGameobjectModels()
 
     fclose(model_list);
 
-    if (!failedPaths.empty())
-    {
-        printf("Warning: Some models could not be extracted, see below\n");
-        for (StringSet::const_iterator itr = failedPaths.begin(); itr != failedPaths.end(); ++itr)
-            { printf("Could not find file of model %s\n", itr->c_str()); }
-        printf("A few of these warnings are expected to happen, so be not alarmed!\n");
-    }
-
     printf("Done!\n");
 }
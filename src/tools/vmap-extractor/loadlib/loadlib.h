@@ -84,8 +84,15 @@ typedef uint16_t           uint16;
 typedef uint8_t            uint8;
 #endif
 
+#include <deque>
+
 #define FILE_FORMAT_VERSION    18
 
+class MPQArchive;
+typedef std::deque<MPQArchive*> ArchiveSet;
+
+extern ArchiveSet gOpenArchives;    /**< archives of the main thread */
+
 /**
  * @brief File version chunk
  *
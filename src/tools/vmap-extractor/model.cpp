@@ -34,9 +34,9 @@ Model::Model(std::string& filename) : filename(filename), vertices(0), indices(0
 {
 }
 
-bool Model::open(StringSet& failedPaths)
+bool Model::open(StringSet& failedPaths, ArchiveSet const& archives)
 {
-    MPQFile f(filename.c_str());
+    MPQFile f(filename.c_str(), archives);
 
     ok = !f.isEof();
 
@@ -59,9 +59,10 @@ class Model
          * @brief
          *
          * @param failedPaths
+         * @param archives archives the model is read from
          * @return bool
          */
-        bool open(StringSet& failedPaths);
+        bool open(StringSet& failedPaths, ArchiveSet const& archives = gOpenArchives);
         /**
          * @brief
          *
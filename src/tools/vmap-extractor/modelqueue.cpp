@@ -0,0 +1,197 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "modelqueue.h"
+#include "adtfile.h"
+#include "mpq_libmpq.h"
+
+#include "ProgressBar.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Task.h>
+
+/**
+ * @brief threads running the rounds of a ModelQueue
+ *
+ */
+class ModelQueueThreads : public ACE_Task_Base
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param queue
+         */
+        explicit ModelQueueThreads(ModelQueue& queue) : m_queue(queue) {}
+
+        /**
+         * @brief
+         *
+         * @return int
+         */
+        int svc()
+        {
+            // a libmpq archive keeps a read position, so every thread opens the archives itself
+            ArchiveSet archives;
+            std::vector<std::string> const& names = m_queue.GetArchiveNames();
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                MPQArchive* archive = new MPQArchive(names[i].c_str(), archives, false);
+                if (archives.empty() || archives.front() != archive)
+                    { delete archive; }
+            }
+
+            m_queue.RunJobs(archives);
+
+            for (ArchiveSet::iterator itr = archives.begin(); itr != archives.end(); ++itr)
+            {
+                (*itr)->close();
+                delete *itr;
+            }
+            return 0;
+        }
+
+    private:
+        ModelQueue& m_queue; /**< TODO */
+};
+
+ModelQueue::ModelQueue(std::vector<std::string> const& archiveNames) :
+    m_archiveNames(archiveNames), m_success(true), m_bar(NULL)
+{
+}
+
+void ModelQueue::AddWmo(std::string const& path)
+{
+    Add(JOB_WMO, path, GetWmoOutputPath(path));
+}
+
+void ModelQueue::AddModel(std::string const& path)
+{
+    std::string fixedPath = path;
+    std::string output = std::string(szWorkDirWmo) + "/" + FixModelPath(fixedPath);
+    Add(JOB_MODEL, path, output);
+}
+
+void ModelQueue::AddADT(std::string const& path)
+{
+    Add(JOB_ADT, path, std::string());
+}
+
+void ModelQueue::Add(JobType type, std::string const& path, std::string const& outputPath)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+
+    if (!outputPath.empty() && !m_queued.insert(outputPath).second)
+        { return; }                                         // extracted by another job
+
+    Job job;
+    job.type = type;
+    job.path = path;
+    job.outputPath = outputPath;
+    m_jobs.push_back(job);
+}
+
+bool ModelQueue::Run(int threads)
+{
+    while (!m_jobs.empty() && m_success)
+    {
+        m_round.swap(m_jobs);
+
+        BarGoLink bar(int(m_round.size()));
+        m_bar = &bar;
+
+        ModelQueueThreads workers(*this);
+        if (threads < 2)
+            { RunJobs(gOpenArchives); }
+        else if (workers.activate(THR_NEW_LWP | THR_JOINABLE, threads) == -1)
+        {
+            printf("Can not start the threads, extracting on one thread\n");
+            RunJobs(gOpenArchives);
+        }
+        else
+            { workers.wait(); }
+
+        m_bar = NULL;
+    }
+
+    return m_success;
+}
+
+void ModelQueue::RunJobs(ArchiveSet const& archives)
+{
+    for (;;)
+    {
+        Job job;
+        {
+            ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+            if (m_round.empty() || !m_success)
+                { break; }
+
+            job = m_round.front();
+            m_round.pop_front();
+        }
+
+        bool result = true;
+        StringSet models;
+        StringSet failedPaths;
+
+        switch (job.type)
+        {
+            case JOB_WMO:
+                result = ExtractSingleWmo(job.path, archives);
+                break;
+            case JOB_MODEL:
+            {
+                std::string fixedName;
+                result = ExtractSingleModel(job.path, fixedName, failedPaths, archives);
+                break;
+            }
+            case JOB_ADT:
+            {
+                ADTFile adt((char*)job.path.c_str(), archives);
+                adt.collectModels(models);
+                break;
+            }
+        }
+
+        // the models of a tile run in the next round
+        for (StringSet::const_iterator itr = models.begin(); itr != models.end(); ++itr)
+            { AddModel(*itr); }
+
+        ACE_Guard<ACE_Thread_Mutex> guard(m_lock);
+
+        if (result && !job.outputPath.empty())
+            { m_extracted.insert(job.outputPath); }
+        else if (!result && job.type == JOB_WMO)
+            { m_success = false; }                          // output file can not be written
+
+        m_failedPaths.insert(failedPaths.begin(), failedPaths.end());
+        m_bar->step();
+    }
+}
+
+bool ModelQueue::IsExtracted(std::string const& outputPath) const
+{
+    return m_extracted.find(outputPath) != m_extracted.end();
+}
@@ -0,0 +1,155 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2014  MaNGOS project <http://getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MODELQUEUE_H
+#define MODELQUEUE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+
+#include <ace/Thread_Mutex.h>
+
+#include "vmapexport.h"
+
+class BarGoLink;
+
+/**
+ * @brief list of the models to extract, run by a pool of threads
+ *
+ * A model is queued once by the name of its extracted file, however many tiles and
+ * gameobjects use it. Scanning a tile queues its models for the next round of the
+ * threads, the queue is done when a round queued nothing new.
+ */
+class ModelQueue
+{
+    public:
+        /**
+         * @brief
+         *
+         * @param archiveNames archives every thread opens for itself
+         */
+        explicit ModelQueue(std::vector<std::string> const& archiveNames);
+
+        /**
+         * @brief queues a WMO file, its group files are extracted with it
+         *
+         * @param path path in the archives
+         */
+        void AddWmo(std::string const& path);
+        /**
+         * @brief queues an M2 model
+         *
+         * @param path path in the archives, cleaned with fixnamen and fixname2
+         */
+        void AddModel(std::string const& path);
+        /**
+         * @brief queues the scan of an ADT file for the models placed on it
+         *
+         * @param path path in the archives
+         */
+        void AddADT(std::string const& path);
+
+        /**
+         * @brief extracts the queued models
+         *
+         * @param threads
+         * @return bool false if an output file could not be written
+         */
+        bool Run(int threads);
+
+        /**
+         * @brief runs jobs until the round is done, run by every thread
+         *
+         * @param archives archives of the calling thread
+         */
+        void RunJobs(ArchiveSet const& archives);
+
+        /**
+         * @brief
+         *
+         * @param outputPath path of the extracted file
+         * @return bool true if it was extracted by this queue or before
+         */
+        bool IsExtracted(std::string const& outputPath) const;
+
+        /**
+         * @brief
+         *
+         * @return const StringSet paths of the models not found in the archives
+         */
+        StringSet const& GetFailedPaths() const { return m_failedPaths; }
+
+        /**
+         * @brief
+         *
+         * @return const std::vector<std::string>
+         */
+        std::vector<std::string> const& GetArchiveNames() const { return m_archiveNames; }
+
+    private:
+        /**
+         * @brief
+         *
+         */
+        enum JobType
+        {
+            JOB_WMO,
+            JOB_MODEL,
+            JOB_ADT
+        };
+
+        /**
+         * @brief
+         *
+         */
+        struct Job
+        {
+            JobType type; /**< TODO */
+            std::string path; /**< path in the archives */
+            std::string outputPath; /**< TODO */
+        };
+
+        /**
+         * @brief
+         *
+         * @param type
+         * @param path
+         * @param outputPath empty for jobs which write no file
+         */
+        void Add(JobType type, std::string const& path, std::string const& outputPath);
+
+        std::vector<std::string> m_archiveNames; /**< TODO */
+
+        std::deque<Job> m_jobs; /**< jobs of the next round */
+        std::deque<Job> m_round; /**< jobs of the running round */
+        StringSet m_queued; /**< output paths of all queued models */
+        StringSet m_extracted; /**< TODO */
+        StringSet m_failedPaths; /**< TODO */
+        bool m_success; /**< TODO */
+        BarGoLink* m_bar; /**< progress of the running round */
+        ACE_Thread_Mutex m_lock; /**< guards all of the above while the threads run */
+};
+
+#endif
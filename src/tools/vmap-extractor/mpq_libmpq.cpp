@@ -28,10 +28,11 @@
 
 ArchiveSet gOpenArchives;
 
-MPQArchive::MPQArchive(const char* filename)
+MPQArchive::MPQArchive(const char* filename, ArchiveSet& archives, bool log)
 {
     int result = libmpq__archive_open(&mpq_a, filename, -1);
-    printf("Opening %s\n", filename);
+    if (log)
+        { printf("Opening %s\n", filename); }
     if (result)
     {
         switch (result)
@@ -57,7 +58,7 @@ MPQArchive::MPQArchive(const char* filename)
         }
         return;
     }
-    gOpenArchives.push_front(this);
+    archives.push_front(this);
 }
 
 void MPQArchive::close()
@@ -66,13 +67,13 @@ void MPQArchive::close()
     libmpq__archive_close(mpq_a);
 }
 
-MPQFile::MPQFile(const char* filename):
+MPQFile::MPQFile(const char* filename, ArchiveSet const& archives):
     eof(false),
     buffer(0),
     pointer(0),
     size(0)
 {
-    for (ArchiveSet::iterator i = gOpenArchives.begin(); i != gOpenArchives.end(); ++i)
+    for (ArchiveSet::const_iterator i = archives.begin(); i != archives.end(); ++i)
     {
         mpq_archive* mpq_a = (*i)->mpq_a;
 
@@ -49,8 +49,10 @@ class MPQArchive
          * @brief
          *
          * @param filename
+         * @param archives set the archive is added to, a thread reading files reads them of its own set
+         * @param log
          */
-        MPQArchive(const char* filename);
+        MPQArchive(const char* filename, ArchiveSet& archives = gOpenArchives, bool log = true);
         /**
          * @brief
          *
@@ -91,11 +93,6 @@ class MPQArchive
             delete[] buffer;
         }
 };
-/**
- * @brief
- *
- */
-typedef std::deque<MPQArchive*> ArchiveSet;
 
 /**
  * @brief
@@ -126,8 +123,9 @@ class MPQFile
          * @brief
          *
          * @param filename filenames are not case sensitive
+         * @param archives archives searched for the file
          */
-        MPQFile(const char* filename);
+        MPQFile(const char* filename, ArchiveSet const& archives = gOpenArchives);
         /**
          * @brief
          *
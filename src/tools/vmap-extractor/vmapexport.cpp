@@ -53,6 +53,7 @@
 #include "mpq_libmpq.h"
 
 #include "vmapexport.h"
+#include "modelqueue.h"
 
 //------------------------------------------------------------------------------
 // Defines
@@ -76,6 +77,7 @@ char output_path[128] = ".";
 char input_path[1024] = ".";
 bool hasInputPathParam = false;
 bool preciseVectorData = false;
+int threadCount = 1;
 
 // Constants
 
@@ -126,36 +128,36 @@ void ReadLiquidTypeTableDBC()
     printf("Done! (%u LiqTypes loaded)\n", (unsigned int)LiqType_count);
 }
 
-bool ExtractWmo()
+void QueueWmo(ModelQueue& queue)
 {
-    bool success = true;
-
-    for (ArchiveSet::const_iterator ar_itr = gOpenArchives.begin(); ar_itr != gOpenArchives.end() && success; ++ar_itr)
+    for (ArchiveSet::const_iterator ar_itr = gOpenArchives.begin(); ar_itr != gOpenArchives.end(); ++ar_itr)
     {
         vector<string> filelist;
 
         (*ar_itr)->GetFileListTo(filelist);
-        for (vector<string>::iterator fname = filelist.begin(); fname != filelist.end() && success; ++fname)
+        for (vector<string>::iterator fname = filelist.begin(); fname != filelist.end(); ++fname)
         {
             if (fname->find(".wmo") != string::npos)
-                { success = ExtractSingleWmo(*fname); }
+                { queue.AddWmo(*fname); }
         }
     }
+}
 
-    if (success)
-        { printf("\nExtract wmo complete (No (fatal) errors)\n"); }
-
-    return success;
+std::string GetWmoOutputPath(std::string const& fname)
+{
+    char szLocalFile[1024];
+    sprintf(szLocalFile, "%s/%s", szWorkDirWmo, GetPlainName(fname.c_str()));
+    fixnamen(szLocalFile, strlen(szLocalFile));
+    return szLocalFile;
 }
 
-bool ExtractSingleWmo(std::string& fname)
+bool ExtractSingleWmo(std::string& fname, ArchiveSet const& archives)
 {
     // Copy files from archive
 
     char szLocalFile[1024];
     const char* plain_name = GetPlainName(fname.c_str());
-    sprintf(szLocalFile, "%s/%s", szWorkDirWmo, plain_name);
-    fixnamen(szLocalFile, strlen(szLocalFile));
+    strcpy(szLocalFile, GetWmoOutputPath(fname).c_str());
 
     if (FileExists(szLocalFile))
         { return true; }
@@ -179,9 +181,8 @@ bool ExtractSingleWmo(std::string& fname)
         { return true; }
 
     bool file_ok = true;
-    std::cout << "Extracting " << fname << std::endl;
     WMORoot froot(fname);
-    if (!froot.open())
+    if (!froot.open(archives))
     {
         printf("Couldn't open RootWmo!!!\n");
         return true;
@@ -208,7 +209,7 @@ bool ExtractSingleWmo(std::string& fname)
 
             string s = groupFileName;
             WMOGroup fgroup(s);
-            if (!fgroup.open())
+            if (!fgroup.open(archives))
             {
                 printf("Could not open all Group file for: %s\n", plain_name);
                 file_ok = false;
@@ -229,12 +230,32 @@ bool ExtractSingleWmo(std::string& fname)
     return true;
 }
 
+void QueueMapModels(ModelQueue& queue)
+{
+    char fn[512];
+    for (unsigned int i = 0; i < map_count; ++i)
+    {
+        sprintf(fn, "World\\Maps\\%s\\%s.wdt", map_ids[i].name, map_ids[i].name);
+        MPQFile wdt(fn);
+        if (wdt.isEof())
+            { continue; }
+
+        for (int x = 0; x < 64; ++x)
+        {
+            for (int y = 0; y < 64; ++y)
+            {
+                sprintf(fn, "World\\Maps\\%s\\%s_%d_%d.adt", map_ids[i].name, map_ids[i].name, x, y);
+                queue.AddADT(fn);
+            }
+        }
+    }
+}
+
 void ParsMapFiles()
 {
     char fn[512];
     //char id_filename[64];
     char id[10];
-    StringSet failedPaths;
     for (unsigned int i = 0; i < map_count; ++i)
     {
         sprintf(id, "%03u", map_ids[i].id);
@@ -250,7 +271,7 @@ void ParsMapFiles()
                     if (ADTFile* ADT = WDT.GetMap(x, y))
                     {
                         //sprintf(id_filename,"%02u %02u %03u",x,y,map_ids[i].id);//!!!!!!!!!
-                        ADT->init(map_ids[i].id, x, y, failedPaths);
+                        ADT->init(map_ids[i].id, x, y);
                         delete ADT;
                     }
                 }
@@ -260,14 +281,6 @@ void ParsMapFiles()
             printf("]\n");
         }
     }
-
-    if (!failedPaths.empty())
-    {
-        printf("Warning: Some models could not be extracted, see below\n");
-        for (StringSet::const_iterator itr = failedPaths.begin(); itr != failedPaths.end(); ++itr)
-            { printf("Could not find file of model %s\n", itr->c_str()); }
-        printf("A few not found models can be expected and are not alarming.\n");
-    }
 }
 
 void getGamePath()
@@ -351,6 +364,7 @@ void Usage(char* prg)
     printf("                         size by ~ 500MB\n");
     printf("   -l, --large           extract larger vmaps with full data. Increases\n");
     printf("                         size by ~ 500MB\n");
+    printf("   -t, --threads #       number of threads extracting models\n");
     printf("\n");
     printf("Example:\n");
     printf("- use data path and create larger vmaps:\n");
@@ -381,6 +395,17 @@ bool processArgv(int argc, char** argv)
             result = true;
             preciseVectorData = true;
         }
+        else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--threads") == 0 )
+        {
+            param = argv[++i];
+            if (!param || atoi(param) < 1 || atoi(param) > 64)
+            {
+                result = false;
+                break;
+            }
+
+            threadCount = atoi(param);
+        }
         else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--data") == 0 )
         {
             param = argv[++i];
@@ -475,10 +500,6 @@ int main(int argc, char** argv)
     }
     ReadLiquidTypeTableDBC();
 
-    // extract data
-    if (success)
-        { success = ExtractWmo(); }
-
     //xxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
     //map.dbc
     if (success)
@@ -501,11 +522,35 @@ int main(int argc, char** argv)
 
 
         delete dbc;
-        ParsMapFiles();
+
+        // every model is extracted once, however many tiles and gameobjects use it
+        ModelQueue queue(archiveNames);
+        QueueWmo(queue);
+        QueueGameobjectModels(queue);
+        QueueMapModels(queue);
+
+        printf("Extracting models on %d threads...\n", threadCount);
+        success = queue.Run(threadCount);
+
+        StringSet const& failedPaths = queue.GetFailedPaths();
+        if (!failedPaths.empty())
+        {
+            printf("Warning: Some models could not be extracted, see below\n");
+            for (StringSet::const_iterator itr = failedPaths.begin(); itr != failedPaths.end(); ++itr)
+                { printf("Could not find file of model %s\n", itr->c_str()); }
+            printf("A few not found models can be expected and are not alarming.\n");
+        }
+
+        if (success)
+        {
+            printf("\nExtract models complete (No (fatal) errors)\n");
+
+            ParsMapFiles();
+            //nError = ERROR_SUCCESS;
+            // List models, listed in DameObjectDisplayInfo.dbc
+            ExtractGameobjectModels(queue);
+        }
         delete [] map_ids;
-        //nError = ERROR_SUCCESS;
-        // Extract models, listed in DameObjectDisplayInfo.dbc
-        ExtractGameobjectModels();
     }
 
     printf("\n");
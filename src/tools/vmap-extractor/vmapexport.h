@@ -28,6 +28,10 @@
 #include <string>
 #include <set>
 
+#include "loadlib/loadlib.h"
+
+class ModelQueue;
+
 /**
  * @brief
  *
@@ -62,13 +66,30 @@ bool FileExists(const char* file);
  */
 void strToLower(char* str);
 
+/**
+ * @brief path of the extracted file of a WMO
+ *
+ * @param fname path of the WMO in the archives
+ * @return std::string
+ */
+std::string GetWmoOutputPath(std::string const& fname);
+
 /**
  * @brief
  *
  * @param fname
+ * @param archives archives the WMO is read from
  * @return bool
  */
-bool ExtractSingleWmo(std::string& fname);
+bool ExtractSingleWmo(std::string& fname, ArchiveSet const& archives = gOpenArchives);
+
+/**
+ * @brief name of the extracted file of a model, .mdx models are read from their .m2 file
+ *
+ * @param origPath original path of the model, cleaned with fixnamen and fixname2, changed to the .m2 path
+ * @return std::string
+ */
+std::string FixModelPath(std::string& origPath);
 
 /**
  * @brief
@@ -76,14 +97,23 @@ bool ExtractSingleWmo(std::string& fname);
  * @param origPath original path of the model, cleaned with fixnamen and fixname2
  * @param fixedName will store the translated name (if changed)
  * @param failedPaths Set to collect errors
+ * @param archives archives the model is read from
  * @return bool
  */
-bool ExtractSingleModel(std::string& origPath, std::string& fixedName, StringSet& failedPaths);
+bool ExtractSingleModel(std::string& origPath, std::string& fixedName, StringSet& failedPaths, ArchiveSet const& archives = gOpenArchives);
 
 /**
- * @brief
+ * @brief queues the models listed in GameObjectDisplayInfo.dbc
+ *
+ * @param queue
+ */
+void QueueGameobjectModels(ModelQueue& queue);
+
+/**
+ * @brief writes the list of the extracted gameobject models
  *
+ * @param queue the queue the models were extracted by
  */
-void ExtractGameobjectModels();
+void ExtractGameobjectModels(ModelQueue const& queue);
 
 #endif
@@ -41,9 +41,9 @@ WMORoot::WMORoot(std::string& filename) : filename(filename)
 {
 }
 
-bool WMORoot::open()
+bool WMORoot::open(ArchiveSet const& archives)
 {
-    MPQFile f(filename.c_str());
+    MPQFile f(filename.c_str(), archives);
     if (f.isEof())
     {
         printf("No such file %s.\n", filename.c_str());
@@ -147,9 +147,9 @@ WMOGroup::WMOGroup(std::string& filename) : filename(filename),
 {
 }
 
-bool WMOGroup::open()
+bool WMOGroup::open(ArchiveSet const& archives)
 {
-    MPQFile f(filename.c_str());
+    MPQFile f(filename.c_str(), archives);
     if (f.isEof())
     {
         printf("No such file.\n");
@@ -81,9 +81,10 @@ class WMORoot
         /**
          * @brief
          *
+         * @param archives archives the file is read from
          * @return bool
          */
-        bool open();
+        bool open(ArchiveSet const& archives = gOpenArchives);
         /**
          * @brief
          *
@@ -167,9 +168,10 @@ class WMOGroup
         /**
          * @brief
          *
+         * @param archives archives the file is read from
          * @return bool
          */
-        bool open();
+        bool open(ArchiveSet const& archives = gOpenArchives);
         /**
          * @brief
          *